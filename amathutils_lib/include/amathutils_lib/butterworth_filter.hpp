@@ -138,4 +138,54 @@ private:
   std::vector<double> u_filtered;
 };
 
+/*
+ * Filters several channels with the same discrete time coefficients, such as the ones of a ButterworthFilter.
+ * The history of all the channels is kept in circular buffers and each sample of the channels is filtered in
+ * one pass over the channels, which the compiler vectorizes. Each channel gives the same values as
+ * ButterworthFilter::filter.
+ */
+class MultiChannelButterworthFilter
+{
+public:
+  // An and Bn are the coefficients of ButterworthFilter::getAnBn
+  MultiChannelButterworthFilter(const DifferenceAnBn &AnBn, size_t channels);
+
+  size_t getChannels() const;
+
+  // sets the history of each channel to the value of u, as filtVector with init_first_value
+  void initializeHistory(const std::vector<double> &u);
+
+  // filters one sample u of each channel into u_f, both of getChannels() values
+  void filter(const double *u, double *u_f);
+  void filter(const std::vector<double> &u, std::vector<double> &u_f);
+
+  /*
+   * Zero phase filtering of recorded samples: the samples are filtered forwards, then the result is filtered
+   * backwards. t and u hold the samples one after another, each of getChannels() values. The history is
+   * initialized to the first sample for the forward pass and to the last one for the backward pass.
+   */
+  void filtFilt(const std::vector<double> &t, std::vector<double> &u);
+
+private:
+  int mOrder;
+  size_t mChannels;
+  std::vector<double> mAn;
+  std::vector<double> mBn;
+
+  // mOrder samples of the channels, the latest one in slot mHead
+  std::vector<double> mUnfiltered;
+  std::vector<double> mFiltered;
+  int mHead = 0;
+  std::vector<double> mAccumulator;
+
+  // channels filtered together, two SSE2 or four AVX registers of doubles
+  static constexpr size_t LANES = 4;
+
+  // filtered sample of the channels c0 to c0 + N - 1 into acc
+  template <size_t N>
+  void accumulate(const double *u, double *acc, size_t c0) const;
+
+  void filtSamples(const double *t, double *u, size_t samples, bool backward);
+};
+
 #endif  // AMATHUTILS_LIB_BUTTERWORTH_FILTER_HPP
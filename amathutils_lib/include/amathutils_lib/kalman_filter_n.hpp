@@ -0,0 +1,214 @@
+/*
+ * Copyright 2018-2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef AMATHUTILS_LIB_KALMAN_FILTER_N_HPP
+#define AMATHUTILS_LIB_KALMAN_FILTER_N_HPP
+
+#include <eigen3/Eigen/Core>
+#include <eigen3/Eigen/LU>
+
+/**
+ * @file kalman_filter_n.hpp
+ * @brief kalman filter class with dimensions fixed at compile time
+ */
+
+/**
+ * @brief KalmanFilter with NX states, NU inputs and NY measurements. The matrices have fixed sizes,
+ * so predict and update do not allocate memory and the dimensions are checked at compile time.
+ * The matrices are zero until they are initialized.
+ */
+template <int NX, int NU, int NY>
+class KalmanFilterN
+{
+public:
+  using VectorX = Eigen::Matrix<double, NX, 1>;
+  using VectorU = Eigen::Matrix<double, NU, 1>;
+  using VectorY = Eigen::Matrix<double, NY, 1>;
+  using MatrixA = Eigen::Matrix<double, NX, NX>;
+  using MatrixB = Eigen::Matrix<double, NX, NU>;
+  using MatrixC = Eigen::Matrix<double, NY, NX>;
+  using MatrixQ = Eigen::Matrix<double, NX, NX>;
+  using MatrixR = Eigen::Matrix<double, NY, NY>;
+  using MatrixP = Eigen::Matrix<double, NX, NX>;
+
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+  /**
+   * @brief No initialization constructor.
+   */
+  KalmanFilterN()
+    : x_(VectorX::Zero()), A_(MatrixA::Zero()), B_(MatrixB::Zero()), C_(MatrixC::Zero()),
+      Q_(MatrixQ::Zero()), R_(MatrixR::Zero()), P_(MatrixP::Zero())
+  {
+  }
+
+  /**
+   * @brief constructor with initialization
+   * @param x initial state
+   * @param A coefficient matrix of x for process model
+   * @param B coefficient matrix of u for process model
+   * @param C coefficient matrix of x for measurement model
+   * @param Q covariace matrix for process model
+   * @param R covariance matrix for measurement model
+   * @param P initial covariance of estimated state
+   */
+  KalmanFilterN(const VectorX &x, const MatrixA &A, const MatrixB &B, const MatrixC &C,
+                const MatrixQ &Q, const MatrixR &R, const MatrixP &P)
+  {
+    init(x, A, B, C, Q, R, P);
+  }
+
+  /**
+   * @brief initialization of kalman filter
+   * @param x initial state
+   * @param A coefficient matrix of x for process model
+   * @param B coefficient matrix of u for process model
+   * @param C coefficient matrix of x for measurement model
+   * @param Q covariace matrix for process model
+   * @param R covariance matrix for measurement model
+   * @param P initial covariance of estimated state
+   */
+  bool init(const VectorX &x, const MatrixA &A, const MatrixB &B, const MatrixC &C,
+            const MatrixQ &Q, const MatrixR &R, const MatrixP &P)
+  {
+    x_ = x;
+    A_ = A;
+    B_ = B;
+    C_ = C;
+    Q_ = Q;
+    R_ = R;
+    P_ = P;
+    return true;
+  }
+
+  /**
+   * @brief initialization of kalman filter
+   * @param x initial state
+   * @param P initial covariance of estimated state
+   */
+  bool init(const VectorX &x, const MatrixP &P0)
+  {
+    x_ = x;
+    P_ = P0;
+    return true;
+  }
+
+  void setA(const MatrixA &A) { A_ = A; }
+  void setB(const MatrixB &B) { B_ = B; }
+  void setC(const MatrixC &C) { C_ = C; }
+  void setQ(const MatrixQ &Q) { Q_ = Q; }
+  void setR(const MatrixR &R) { R_ = R; }
+  void getX(VectorX &x) { x = x_; }
+  void getP(MatrixP &P) { P = P_; }
+  double getXelement(unsigned int i) { return x_(i); }
+
+  /**
+   * @brief calculate kalman filter state and covariance by prediction model with A, B, Q matrix.
+   * @param u input for model
+   * @param A coefficient matrix of x for process model
+   * @param B coefficient matrix of u for process model
+   * @param Q covariace matrix for process model
+   * @return bool to check matrix operations are being performed properly
+   */
+  bool predict(const VectorU &u, const MatrixA &A, const MatrixB &B, const MatrixQ &Q)
+  {
+    const VectorX x_next = A * x_ + B * u;
+    return predict(x_next, A, Q);
+  }
+
+  /**
+   * @brief calculate kalman filter covariance with prediction model with x, A, Q matrix.
+   * @param x_next predicted state
+   * @param A coefficient matrix of x for process model
+   * @param Q covariace matrix for process model
+   * @return bool to check matrix operations are being performed properly
+   */
+  bool predict(const VectorX &x_next, const MatrixA &A, const MatrixQ &Q)
+  {
+    x_ = x_next;
+    P_ = A * P_ * A.transpose() + Q;
+    return true;
+  }
+
+  /**
+   * @brief calculate kalman filter covariance with prediction model with x, A and Q being class menber variable.
+   * @param x_next predicted state
+   * @param A coefficient matrix of x for process model
+   * @return bool to check matrix operations are being performed properly
+   */
+  bool predict(const VectorX &x_next, const MatrixA &A) { return predict(x_next, A, Q_); }
+
+  /**
+   * @brief calculate kalman filter state by prediction model with A, B and Q being class menber variables.
+   * @param u input for the model
+   * @return bool to check matrix operations are being performed properly
+   */
+  bool predict(const VectorU &u) { return predict(u, A_, B_, Q_); }
+
+  /**
+   * @brief calculate kalman filter state by measurement model with y_pred, C and R matrix.
+   * @param y measured values
+   * @param y_pred output values expected from measurement model
+   * @param C coefficient matrix of x for measurement model
+   * @param R covariance matrix for measurement model
+   * @return bool to check matrix operations are being performed properly
+   */
+  bool update(const VectorY &y, const VectorY &y_pred, const MatrixC &C, const MatrixR &R)
+  {
+    const Eigen::Matrix<double, NX, NY> PCT = P_ * C.transpose();
+    const Eigen::Matrix<double, NX, NY> K = PCT * ((R + C * PCT).inverse());
+
+    if (!K.allFinite())
+    {
+      return false;
+    }
+
+    x_ = x_ + K * (y - y_pred);
+    P_ = P_ - K * (C * P_);
+    return true;
+  }
+
+  /**
+   * @brief calculate kalman filter state by measurement model with C and R matrix.
+   * @param y measured values
+   * @param C coefficient matrix of x for measurement model
+   * @param R covariance matrix for measurement model
+   * @return bool to check matrix operations are being performed properly
+   */
+  bool update(const VectorY &y, const MatrixC &C, const MatrixR &R)
+  {
+    const VectorY y_pred = C * x_;
+    return update(y, y_pred, C, R);
+  }
+
+  /**
+   * @brief calculate kalman filter state by measurement model with C and R being class menber variables.
+   * @param y measured values
+   * @return bool to check matrix operations are being performed properly
+   */
+  bool update(const VectorY &y) { return update(y, C_, R_); }
+
+protected:
+  VectorX x_;  //!< @brief current estimated state
+  MatrixA A_;  //!< @brief coefficient matrix of x for process model x[k+1] = A*x[k] + B*u[k]
+  MatrixB B_;  //!< @brief coefficient matrix of u for process model x[k+1] = A*x[k] + B*u[k]
+  MatrixC C_;  //!< @brief coefficient matrix of x for measurement model y[k] = C * x[k]
+  MatrixQ Q_;  //!< @brief covariace matrix for process model x[k+1] = A*x[k] + B*u[k]
+  MatrixR R_;  //!< @brief covariance matrix for measurement model y[k] = C * x[k]
+  MatrixP P_;  //!< @brief covariance of estimated state
+};
+
+#endif  // AMATHUTILS_LIB_KALMAN_FILTER_N_HPP
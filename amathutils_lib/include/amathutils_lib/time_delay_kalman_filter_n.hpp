@@ -0,0 +1,137 @@
+/*
+ * Copyright 2018-2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef AMATHUTILS_LIB_TIME_DELAY_KALMAN_FILTER_N_HPP
+#define AMATHUTILS_LIB_TIME_DELAY_KALMAN_FILTER_N_HPP
+
+#include <iostream>
+#include <eigen3/Eigen/Core>
+#include <eigen3/Eigen/LU>
+#include "amathutils_lib/kalman_filter_n.hpp"
+
+/**
+ * @file time_delay_kalman_filter_n.hpp
+ * @brief kalman filter with delayed measurement class with dimensions fixed at compile time
+ */
+
+/**
+ * @brief TimeDelayKalmanFilter with NX states, NY measurements and MAX_DELAY_STEP delay steps. The
+ * extended state has NX * MAX_DELAY_STEP elements, Eigen limits its covariance to 128 kB, which is
+ * NX * MAX_DELAY_STEP up to 128.
+ */
+template <int NX, int NY, int MAX_DELAY_STEP>
+class TimeDelayKalmanFilterN : public KalmanFilterN<NX * MAX_DELAY_STEP, 1, NY>
+{
+  static_assert(MAX_DELAY_STEP > 0, "MAX_DELAY_STEP must be positive");
+  static constexpr int DIM_X_EX = NX * MAX_DELAY_STEP;
+  static constexpr int D_DIM_X = DIM_X_EX - NX;
+  using Base = KalmanFilterN<DIM_X_EX, 1, NY>;
+
+public:
+  using VectorX = Eigen::Matrix<double, NX, 1>;
+  using VectorY = Eigen::Matrix<double, NY, 1>;
+  using MatrixA = Eigen::Matrix<double, NX, NX>;
+  using MatrixC = Eigen::Matrix<double, NY, NX>;
+  using MatrixQ = Eigen::Matrix<double, NX, NX>;
+  using MatrixR = Eigen::Matrix<double, NY, NY>;
+  using MatrixP = Eigen::Matrix<double, NX, NX>;
+
+  /**
+   * @brief initialization of kalman filter
+   * @param x initial state
+   * @param P0 initial covariance of estimated state
+   */
+  void init(const VectorX &x, const MatrixP &P0)
+  {
+    this->x_.setZero();
+    this->P_.setZero();
+    for (int i = 0; i < MAX_DELAY_STEP; ++i)
+    {
+      this->x_.template segment<NX>(i * NX) = x;
+      this->P_.template block<NX, NX>(i * NX, i * NX) = P0;
+    }
+  }
+
+  /**
+   * @brief get latest time estimated state
+   * @param x latest time estimated state
+   */
+  void getLatestX(VectorX &x) { x = this->x_.template head<NX>(); }
+
+  /**
+   * @brief get latest time estimation covariance
+   * @param P latest time estimation covariance
+   */
+  void getLatestP(MatrixP &P) { P = this->P_.template topLeftCorner<NX, NX>(); }
+
+  /**
+   * @brief calculate kalman filter covariance by predicion model with time delay, as
+   * TimeDelayKalmanFilter::predictWithDelay
+   * @param x_next predicted state by prediction model
+   * @param A coefficient matrix of x for process model
+   * @param Q covariace matrix for process model
+   */
+  bool predictWithDelay(const VectorX &x_next, const MatrixA &A, const MatrixQ &Q)
+  {
+    auto &x = this->x_;
+    auto &P = this->P_;
+
+    /* slide states in the time direction, from the oldest one */
+    for (int i = MAX_DELAY_STEP - 1; i > 0; --i)
+    {
+      x.template segment<NX>(i * NX) = x.template segment<NX>((i - 1) * NX);
+    }
+    x.template head<NX>() = x_next;
+
+    /* update P with delayed measurement A matrix structure, in place from the bottom right block */
+    const MatrixP P11 = A * P.template topLeftCorner<NX, NX>() * A.transpose() + Q;
+    if (MAX_DELAY_STEP > 1)
+    {
+      P.template bottomRightCorner<D_DIM_X, D_DIM_X>() = P.template topLeftCorner<D_DIM_X, D_DIM_X>().eval();
+      // the previous P11 and P12 are now in the second block row
+      P.template bottomLeftCorner<D_DIM_X, NX>() = P.template block<D_DIM_X, NX>(NX, NX) * A.transpose();
+      P.template topRightCorner<NX, D_DIM_X>() = A * P.template block<NX, D_DIM_X>(NX, NX);
+    }
+    P.template topLeftCorner<NX, NX>() = P11;
+
+    return true;
+  }
+
+  /**
+   * @brief calculate kalman filter covariance by measurement model with time delay.
+   * @param y measured values
+   * @param C coefficient matrix of x for measurement model
+   * @param R covariance matrix for measurement model
+   * @param delay_step measurement delay
+   */
+  bool updateWithDelay(const VectorY &y, const MatrixC &C, const MatrixR &R, const int delay_step)
+  {
+    if (delay_step < 0 || delay_step >= MAX_DELAY_STEP)
+    {
+      std::cerr << "delay step is larger than max_delay_step. ignore update." << std::endl;
+      return false;
+    }
+
+    /* set measurement matrix */
+    typename Base::MatrixC C_ex = Base::MatrixC::Zero();
+    C_ex.template block<NY, NX>(0, NX * delay_step) = C;
+
+    /* update */
+    return Base::update(y, C_ex, R);
+  }
+};
+
+#endif  // AMATHUTILS_LIB_TIME_DELAY_KALMAN_FILTER_N_HPP
@@ -448,3 +448,109 @@ void ButterworthFilter::filtFiltVector(const std::vector<double> &t,
     u[i] = (u[i] + u_rev[i]) * 0.5;
   }
 }
+
+MultiChannelButterworthFilter::MultiChannelButterworthFilter(const DifferenceAnBn &AnBn, size_t channels)
+  : mOrder(static_cast<int>(AnBn.An.size()) - 1), mChannels(channels), mAn(AnBn.An), mBn(AnBn.Bn)
+{
+  mOrder = std::max(mOrder, 0);
+  mAn.resize(mOrder + 1, 0.0);
+  mBn.resize(mOrder + 1, 0.0);
+  mUnfiltered.resize(std::max(mOrder, 1) * mChannels, 0.0);
+  mFiltered.resize(std::max(mOrder, 1) * mChannels, 0.0);
+  mAccumulator.resize(mChannels, 0.0);
+}
+
+size_t MultiChannelButterworthFilter::getChannels() const
+{
+  return mChannels;
+}
+
+void MultiChannelButterworthFilter::initializeHistory(const std::vector<double> &u)
+{
+  for (size_t i = 0; i < mUnfiltered.size(); ++i)
+  {
+    mUnfiltered[i] = u[i % mChannels];
+    mFiltered[i] = u[i % mChannels];
+  }
+}
+
+void MultiChannelButterworthFilter::filter(const double *u, double *u_f)
+{
+  const size_t channels = mChannels;
+  double *acc = mAccumulator.data();
+
+  // same order of operations as ButterworthFilter::filter, one channel per lane. The channels go by blocks of
+  // LANES so that the compiler vectorizes the block loops without a runtime alias check, as at -O2.
+  size_t c0 = 0;
+  for (; c0 + LANES <= channels; c0 += LANES)
+    accumulate<LANES>(u, acc, c0);
+  for (; c0 < channels; ++c0)
+    accumulate<1>(u, acc, c0);
+
+  if (mOrder > 0)
+  {
+    // the oldest slot becomes the latest one
+    mHead = (mHead + mOrder - 1) % mOrder;
+    std::copy(u, u + channels, mUnfiltered.begin() + mHead * channels);
+    std::copy(acc, acc + channels, mFiltered.begin() + mHead * channels);
+  }
+  std::copy(acc, acc + channels, u_f);
+}
+
+template <size_t N>
+void MultiChannelButterworthFilter::accumulate(const double *u, double *acc, size_t c0) const
+{
+  double block[N];
+  const double b0 = mBn[0];
+  for (size_t c = 0; c < N; ++c)
+    block[c] = b0 * u[c0 + c];
+
+  for (int i = 1; i < mOrder + 1; i++)
+  {
+    // sample i steps before
+    const size_t slot = (mHead + i - 1) % mOrder;
+    const double *u_unfiltered = mUnfiltered.data() + slot * mChannels + c0;
+    const double *u_filtered = mFiltered.data() + slot * mChannels + c0;
+    const double b = mBn[i];
+    const double a = mAn[i];
+    for (size_t c = 0; c < N; ++c)
+    {
+      block[c] += b * u_unfiltered[c];
+      block[c] -= a * u_filtered[c];
+    }
+  }
+
+  std::copy(block, block + N, acc + c0);
+}
+
+void MultiChannelButterworthFilter::filter(const std::vector<double> &u, std::vector<double> &u_f)
+{
+  u_f.resize(mChannels);
+  filter(u.data(), u_f.data());
+}
+
+void MultiChannelButterworthFilter::filtSamples(const double *t, double *u, size_t samples, bool backward)
+{
+  for (size_t k = 0; k < samples; ++k)
+  {
+    const size_t i = backward ? samples - 1 - k : k;
+    filter(t + i * mChannels, u + i * mChannels);
+  }
+}
+
+void MultiChannelButterworthFilter::filtFilt(const std::vector<double> &t, std::vector<double> &u)
+{
+  const size_t samples = (mChannels > 0) ? t.size() / mChannels : 0;
+  u.resize(samples * mChannels);
+  if (samples == 0)
+    return;
+
+  // forward filtering
+  std::vector<double> u_forward(samples * mChannels);
+  initializeHistory(std::vector<double>(t.begin(), t.begin() + mChannels));
+  filtSamples(t.data(), u_forward.data(), samples, false);
+
+  // backward filtering
+  initializeHistory(std::vector<double>(u_forward.end() - mChannels, u_forward.end()));
+  filtSamples(u_forward.data(), u.data(), samples, true);
+}
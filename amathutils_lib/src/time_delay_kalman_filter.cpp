@@ -58,18 +58,18 @@ bool TimeDelayKalmanFilter::predictWithDelay(const Eigen::MatrixXd &x_next, cons
   const int d_dim_x = dim_x_ex_ - dim_x_;
 
   /* slide states in the time direction */
-  Eigen::MatrixXd x_tmp = Eigen::MatrixXd::Zero(dim_x_ex_, 1);
-  x_tmp.block(0, 0, dim_x_, 1) = x_next;
-  x_tmp.block(dim_x_, 0, d_dim_x, 1) = x_.block(0, 0, d_dim_x, 1);
-  x_ = x_tmp;
-
-  /* update P with delayed measurement A matrix structure */
-  Eigen::MatrixXd P_tmp = Eigen::MatrixXd::Zero(dim_x_ex_, dim_x_ex_);
-  P_tmp.block(0, 0, dim_x_, dim_x_) = A * P_.block(0, 0, dim_x_, dim_x_) * A.transpose() + Q;
-  P_tmp.block(0, dim_x_, dim_x_, d_dim_x) = A * P_.block(0, 0, dim_x_, d_dim_x);
-  P_tmp.block(dim_x_, 0, d_dim_x, dim_x_) = P_.block(0, 0, d_dim_x, dim_x_) * A.transpose();
-  P_tmp.block(dim_x_, dim_x_, d_dim_x, d_dim_x) = P_.block(0, 0, d_dim_x, d_dim_x);
-  P_ = P_tmp;
+  x_.block(dim_x_, 0, d_dim_x, 1) = x_.block(0, 0, d_dim_x, 1).eval();
+  x_.block(0, 0, dim_x_, 1) = x_next;
+
+  /* update P with delayed measurement A matrix structure, only the blocks of the latest state are multiplied */
+  const Eigen::MatrixXd A_P11 = A * P_.block(0, 0, dim_x_, dim_x_);
+  const Eigen::MatrixXd P11_next = A_P11 * A.transpose() + Q;
+  const Eigen::MatrixXd A_P12 = A * P_.block(0, 0, dim_x_, d_dim_x);
+  const Eigen::MatrixXd P21_next = P_.block(0, 0, d_dim_x, dim_x_) * A.transpose();
+  P_.block(dim_x_, dim_x_, d_dim_x, d_dim_x) = P_.block(0, 0, d_dim_x, d_dim_x).eval();
+  P_.block(0, 0, dim_x_, dim_x_) = P11_next;
+  P_.block(0, dim_x_, dim_x_, d_dim_x) = A_P12;
+  P_.block(dim_x_, 0, d_dim_x, dim_x_) = P21_next;
 
   return true;
 }
@@ -84,14 +84,27 @@ bool TimeDelayKalmanFilter::updateWithDelay(const Eigen::MatrixXd &y, const Eige
   }
 
   const int dim_y = y.rows();
+  if (C.rows() != dim_y || C.cols() != dim_x_ || R.rows() != dim_y || R.cols() != dim_y)
+  {
+    return false;
+  }
 
-  /* set measurement matrix */
-  Eigen::MatrixXd C_ex = Eigen::MatrixXd::Zero(dim_y, dim_x_ex_);
-  C_ex.block(0, dim_x_ * delay_step, dim_y, dim_x_) = C;
+  /*
+   * the measurement matrix C_ex = [0 .. C .. 0] has C in the columns of the delayed state,
+   * only the corresponding blocks of x and P are multiplied
+   */
+  const int offset = dim_x_ * delay_step;
+  const Eigen::MatrixXd y_pred = C * x_.block(offset, 0, dim_x_, 1);
+  const Eigen::MatrixXd PCT = P_.block(0, offset, dim_x_ex_, dim_x_) * C.transpose();
+  const Eigen::MatrixXd K = PCT * ((R + C * PCT.block(offset, 0, dim_x_, dim_y)).inverse());
 
-  /* update */
-  if (!update(y, C_ex, R))
+  if (isnan(K.array()).any() || isinf(K.array()).any())
+  {
     return false;
+  }
 
+  x_.noalias() += K * (y - y_pred);
+  const Eigen::MatrixXd CP = C * P_.block(offset, 0, dim_x_, dim_x_ex_);
+  P_.noalias() -= K * CP;
   return true;
 }
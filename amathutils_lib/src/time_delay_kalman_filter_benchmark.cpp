@@ -0,0 +1,100 @@
+/*
+ * Copyright 2018-2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file time_delay_kalman_filter_benchmark.cpp
+ * @brief compares TimeDelayKalmanFilter with a KalmanFilter on the dense augmented model
+ *
+ * time_delay_kalman_filter_benchmark [dim_x] [dim_y] [iterations]
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <eigen3/Eigen/Core>
+#include "amathutils_lib/kalman_filter.hpp"
+#include "amathutils_lib/time_delay_kalman_filter.hpp"
+
+int main(int argc, char **argv)
+{
+  const int dim_x = (argc > 1) ? std::atoi(argv[1]) : 6;
+  const int dim_y = (argc > 2) ? std::atoi(argv[2]) : 2;
+  const int iterations = (argc > 3) ? std::atoi(argv[3]) : 200;
+  if (dim_x <= 0 || dim_y <= 0 || iterations <= 0)
+  {
+    std::printf("usage: %s [dim_x] [dim_y] [iterations]\n", argv[0]);
+    return 1;
+  }
+
+  std::printf("dim_x %d, dim_y %d, predict and update per iteration\n", dim_x, dim_y);
+  std::printf("%10s %16s %16s %10s\n", "delay", "dense [us]", "structured [us]", "max diff");
+  for (const int max_delay_step : { 5, 10, 20, 50, 100 })
+  {
+    const int dim_x_ex = dim_x * max_delay_step;
+    const Eigen::MatrixXd A = Eigen::MatrixXd::Identity(dim_x, dim_x) + 0.01 * Eigen::MatrixXd::Random(dim_x, dim_x);
+    const Eigen::MatrixXd Q = 0.01 * Eigen::MatrixXd::Identity(dim_x, dim_x);
+    const Eigen::MatrixXd C = Eigen::MatrixXd::Random(dim_y, dim_x);
+    const Eigen::MatrixXd R = Eigen::MatrixXd::Identity(dim_y, dim_y);
+    const Eigen::MatrixXd x0 = Eigen::MatrixXd::Zero(dim_x, 1);
+    const Eigen::MatrixXd P0 = Eigen::MatrixXd::Identity(dim_x, dim_x);
+
+    /* augmented model of the time delay, see TimeDelayKalmanFilter::predictWithDelay */
+    Eigen::MatrixXd A_ex = Eigen::MatrixXd::Zero(dim_x_ex, dim_x_ex);
+    A_ex.block(0, 0, dim_x, dim_x) = A;
+    A_ex.block(dim_x, 0, dim_x_ex - dim_x, dim_x_ex - dim_x) = Eigen::MatrixXd::Identity(dim_x_ex - dim_x, dim_x_ex - dim_x);
+    Eigen::MatrixXd Q_ex = Eigen::MatrixXd::Zero(dim_x_ex, dim_x_ex);
+    Q_ex.block(0, 0, dim_x, dim_x) = Q;
+
+    TimeDelayKalmanFilter structured;
+    structured.init(x0, P0, max_delay_step);
+    Eigen::MatrixXd x_ex, P_ex;
+    structured.getX(x_ex);
+    structured.getP(P_ex);
+    KalmanFilter dense;
+    dense.init(x_ex, P_ex);
+
+    double dense_us = 0.0, structured_us = 0.0;
+    for (int i = 0; i < iterations; ++i)
+    {
+      const Eigen::MatrixXd x_next = Eigen::MatrixXd::Random(dim_x, 1);
+      const Eigen::MatrixXd y = Eigen::MatrixXd::Random(dim_y, 1);
+      const int delay_step = i % max_delay_step;
+
+      const auto start = std::chrono::steady_clock::now();
+      dense.getX(x_ex);
+      Eigen::MatrixXd x_ex_next = A_ex * x_ex;
+      x_ex_next.block(0, 0, dim_x, 1) = x_next;
+      dense.predict(x_ex_next, A_ex, Q_ex);
+      Eigen::MatrixXd C_ex = Eigen::MatrixXd::Zero(dim_y, dim_x_ex);
+      C_ex.block(0, dim_x * delay_step, dim_y, dim_x) = C;
+      dense.update(y, C_ex, R);
+      const auto middle = std::chrono::steady_clock::now();
+      structured.predictWithDelay(x_next, A, Q);
+      structured.updateWithDelay(y, C, R, delay_step);
+      const auto end = std::chrono::steady_clock::now();
+
+      dense_us += std::chrono::duration<double, std::micro>(middle - start).count();
+      structured_us += std::chrono::duration<double, std::micro>(end - middle).count();
+    }
+
+    Eigen::MatrixXd P_dense, P_structured;
+    dense.getP(P_dense);
+    structured.getP(P_structured);
+    std::printf("%10d %16.1f %16.1f %10.1e\n", max_delay_step, dense_us / iterations, structured_us / iterations,
+                (P_dense - P_structured).cwiseAbs().maxCoeff());
+  }
+  return 0;
+}
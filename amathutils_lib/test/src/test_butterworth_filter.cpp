@@ -16,6 +16,7 @@
  * Authors: Ali Boyali, Simon Thompson
  */
 
+#include <algorithm>
 #include <cmath>
 #include <complex>
 #include <iostream>
@@ -166,6 +167,67 @@ TEST_F(TestSuite, FilterTest)
   }
 }
 
+TEST_F(TestSuite, MultiChannelFilterTest)
+{
+  const size_t channels = 5;
+  const size_t samples = 200;
+  ButterworthFilter bf;
+  bf.setOrder(3);
+  bf.setCuttoffFrequency(5, 100);
+  bf.computeContinuousTimeTF(true);
+  bf.computeDiscreteTimeTF(true);
+
+  // a different signal on each channel
+  std::vector<std::vector<double>> data(channels, std::vector<double>(samples));
+  std::vector<double> interleaved(samples * channels);
+  for (size_t c = 0; c < channels; ++c)
+  {
+    for (size_t i = 0; i < samples; ++i)
+    {
+      data[c][i] = std::sin(0.05 * (c + 1) * i) + 0.1 * std::cos(2.3 * i + c) + c;
+      interleaved[i * channels + c] = data[c][i];
+    }
+  }
+
+  // each channel is filtered as by ButterworthFilter::filtVector
+  MultiChannelButterworthFilter mbf(bf.getAnBn(), channels);
+  ASSERT_EQ(channels, mbf.getChannels());
+  mbf.initializeHistory(std::vector<double>(interleaved.begin(), interleaved.begin() + channels));
+  std::vector<std::vector<double>> filtered(channels, std::vector<double>(samples));
+  for (size_t c = 0; c < channels; ++c)
+  {
+    bf.initializeForFiltering();
+    bf.filtVector(data[c], filtered[c], true);
+  }
+  std::vector<double> u(channels), u_f;
+  for (size_t i = 0; i < samples; ++i)
+  {
+    std::copy(interleaved.begin() + i * channels, interleaved.begin() + (i + 1) * channels, u.begin());
+    mbf.filter(u, u_f);
+    for (size_t c = 0; c < channels; ++c)
+      ASSERT_DOUBLE_EQ(filtered[c][i], u_f[c]) << "channel " << c << ", sample " << i;
+  }
+
+  // zero phase filtering is the forward filtering of the reversed forward filtering
+  std::vector<double> filtfilt;
+  mbf.filtFilt(interleaved, filtfilt);
+  ASSERT_EQ(interleaved.size(), filtfilt.size());
+  for (size_t c = 0; c < channels; ++c)
+  {
+    std::vector<double> reversed(filtered[c].rbegin(), filtered[c].rend());
+    std::vector<double> backward(samples);
+    bf.filtVector(reversed, backward, true);
+    for (size_t i = 0; i < samples; ++i)
+      ASSERT_DOUBLE_EQ(backward[samples - 1 - i], filtfilt[i * channels + c]) << "channel " << c << ", sample " << i;
+  }
+
+  // a constant signal is not changed
+  std::vector<double> constant(samples * channels, 2.0), constant_filtfilt;
+  mbf.filtFilt(constant, constant_filtfilt);
+  for (const double value : constant_filtfilt)
+    ASSERT_NEAR(2.0, value, 1e-9);
+}
+
 int main(int argc, char **argv)
 {
     testing::InitGoogleTest(&argc, argv);
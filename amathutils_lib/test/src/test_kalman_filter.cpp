@@ -20,6 +20,8 @@
 
 #include "amathutils_lib/kalman_filter.hpp"
 #include "amathutils_lib/time_delay_kalman_filter.hpp"
+#include "amathutils_lib/kalman_filter_n.hpp"
+#include "amathutils_lib/time_delay_kalman_filter_n.hpp"
 
 class KalmanFilterTestSuite :
   public ::testing::Test
@@ -157,6 +159,158 @@ TEST_F(KalmanFilterTestSuite, delayedMeasurement)
   ASSERT_EQ(false, tdkf.updateWithDelay(y, C, R, delay_step));
 }
 
+TEST_F(KalmanFilterTestSuite, delayedMeasurementStructure)
+{
+  const int dim_x = 3;
+  const int dim_y = 2;
+  const int max_delay_step = 4;
+  const int dim_x_ex = dim_x * max_delay_step;
+  Eigen::MatrixXd x = Eigen::MatrixXd::Zero(dim_x, 1);
+  Eigen::MatrixXd x_next = Eigen::MatrixXd::Zero(dim_x, 1);
+  Eigen::MatrixXd y = Eigen::MatrixXd::Zero(dim_y, 1);
+  Eigen::MatrixXd P = Eigen::MatrixXd::Identity(dim_x, dim_x);
+  Eigen::MatrixXd A = Eigen::MatrixXd::Identity(dim_x, dim_x);
+  A(0, 1) = 0.1;
+  A(1, 2) = 0.1;
+  Eigen::MatrixXd Q = Eigen::MatrixXd::Identity(dim_x, dim_x) * 0.1;
+  Eigen::MatrixXd C = Eigen::MatrixXd::Zero(dim_y, dim_x);
+  C(0, 0) = 1.0;
+  C(1, 2) = 1.0;
+  Eigen::MatrixXd R = Eigen::MatrixXd::Identity(dim_y, dim_y);
+
+  // the dense augmented model of the time delay
+  Eigen::MatrixXd A_ex = Eigen::MatrixXd::Zero(dim_x_ex, dim_x_ex);
+  A_ex.block(0, 0, dim_x, dim_x) = A;
+  A_ex.block(dim_x, 0, dim_x_ex - dim_x, dim_x_ex - dim_x) =
+    Eigen::MatrixXd::Identity(dim_x_ex - dim_x, dim_x_ex - dim_x);
+  Eigen::MatrixXd Q_ex = Eigen::MatrixXd::Zero(dim_x_ex, dim_x_ex);
+  Q_ex.block(0, 0, dim_x, dim_x) = Q;
+
+  TimeDelayKalmanFilter tdkf;
+  tdkf.init(x, P, max_delay_step);
+  Eigen::MatrixXd x_ex, P_ex;
+  tdkf.getX(x_ex);
+  tdkf.getP(P_ex);
+  KalmanFilter kf;
+  kf.init(x_ex, P_ex);
+
+  for (int i = 0; i < 3 * max_delay_step; ++i)
+  {
+    x_next << 1.0 * i, 2.0, -1.0 * i;
+    y << 0.5 * i, 1.0;
+    const int delay_step = (3 * i) % max_delay_step;
+
+    tdkf.predictWithDelay(x_next, A, Q);
+    kf.getX(x_ex);
+    Eigen::MatrixXd x_ex_next = A_ex * x_ex;
+    x_ex_next.block(0, 0, dim_x, 1) = x_next;
+    kf.predict(x_ex_next, A_ex, Q_ex);
+
+    Eigen::MatrixXd C_ex = Eigen::MatrixXd::Zero(dim_y, dim_x_ex);
+    C_ex.block(0, dim_x * delay_step, dim_y, dim_x) = C;
+    ASSERT_EQ(true, tdkf.updateWithDelay(y, C, R, delay_step));
+    ASSERT_EQ(true, kf.update(y, C_ex, R));
+  }
+
+  Eigen::MatrixXd X_expected, P_expected, X_actual, P_actual;
+  kf.getX(X_expected);
+  kf.getP(P_expected);
+  tdkf.getX(X_actual);
+  tdkf.getP(P_actual);
+  ASSERT_TRUE((X_actual - X_expected).norm() < 1.0E-9) << "X_actual^T : "
+    << X_actual.transpose() << ", X_expected^T : " << X_expected.transpose();
+  ASSERT_TRUE((P_actual - P_expected).norm() < 1.0E-9);
+
+  Eigen::MatrixXd C_bad_dim = Eigen::MatrixXd::Identity(dim_y, dim_x + 1);
+  ASSERT_EQ(false, tdkf.updateWithDelay(y, C_bad_dim, R, 0)) << "C dimension problem, false expected";
+}
+
+TEST_F(KalmanFilterTestSuite, fixedSizeCase)
+{
+  KalmanFilter kf;
+  KalmanFilterN<3, 2, 3> kf_n;
+  Eigen::MatrixXd x = Eigen::MatrixXd::Zero(3, 1);
+  Eigen::MatrixXd P = Eigen::MatrixXd::Identity(3, 3);
+  Eigen::MatrixXd A = Eigen::MatrixXd::Identity(3, 3);
+  A(0, 1) = 0.1;
+  Eigen::MatrixXd B = Eigen::MatrixXd::Zero(3, 2);
+  B(1, 0) = 0.1;
+  B(2, 1) = 0.1;
+  Eigen::MatrixXd C = Eigen::MatrixXd::Identity(3, 3);
+  Eigen::MatrixXd Q = Eigen::MatrixXd::Identity(3, 3) * 0.01;
+  Eigen::MatrixXd R = Eigen::MatrixXd::Identity(3, 3);
+  Eigen::MatrixXd u(2, 1), y(3, 1);
+  u << 1.0, -1.0;
+  y << 1.0, 2.0, 3.0;
+
+  kf.init(x, A, B, C, Q, R, P);
+  ASSERT_EQ(true, kf_n.init(x, A, B, C, Q, R, P));
+  for (int i = 0; i < 10; ++i)
+  {
+    ASSERT_EQ(true, kf.predict(u));
+    ASSERT_EQ(true, kf_n.predict(u));
+    ASSERT_EQ(true, kf.update(y));
+    ASSERT_EQ(true, kf_n.update(y));
+  }
+  Eigen::MatrixXd X_expected, P_expected;
+  kf.getX(X_expected);
+  kf.getP(P_expected);
+  KalmanFilterN<3, 2, 3>::VectorX X_actual;
+  KalmanFilterN<3, 2, 3>::MatrixP P_actual;
+  kf_n.getX(X_actual);
+  kf_n.getP(P_actual);
+  ASSERT_TRUE((X_actual - X_expected).norm() < 1.0E-9) << "X_actual^T : "
+    << X_actual.transpose() << ", X_expected^T : " << X_expected.transpose();
+  ASSERT_TRUE((P_actual - P_expected).norm() < 1.0E-9) << "P_actual : "
+    << P_actual << ", P_expected : " << P_expected;
+
+  KalmanFilterN<3, 2, 3>::MatrixR R0 = KalmanFilterN<3, 2, 3>::MatrixR::Zero();
+  KalmanFilterN<3, 2, 3>::MatrixP P0 = KalmanFilterN<3, 2, 3>::MatrixP::Zero();
+  kf_n.init(X_actual, P0);
+  ASSERT_EQ(false, kf_n.update(y, y, C, R0)) << "R0 inverse problem, false expected";
+}
+
+TEST_F(KalmanFilterTestSuite, fixedSizeDelayedMeasurement)
+{
+  const int max_delay_step = 5;
+  TimeDelayKalmanFilter tdkf;
+  TimeDelayKalmanFilterN<3, 3, max_delay_step> tdkf_n;
+  Eigen::MatrixXd x = Eigen::MatrixXd::Zero(3, 1);
+  Eigen::MatrixXd x_next = Eigen::MatrixXd::Zero(3, 1);
+  Eigen::MatrixXd y = Eigen::MatrixXd::Zero(3, 1);
+  Eigen::MatrixXd P = Eigen::MatrixXd::Identity(3, 3);
+  Eigen::MatrixXd A = Eigen::MatrixXd::Identity(3, 3) * 2.0;
+  A(0, 2) = 0.5;
+  Eigen::MatrixXd Q = Eigen::MatrixXd::Identity(3, 3);
+  Eigen::MatrixXd C = Eigen::MatrixXd::Identity(3, 3);
+  Eigen::MatrixXd R = Eigen::MatrixXd::Identity(3, 3);
+
+  tdkf.init(x, P, max_delay_step);
+  tdkf_n.init(x, P);
+  for (int i = 0; i < 2 * max_delay_step; ++i)
+  {
+    x_next << 1.0 * i, 2.0, 3.0;
+    y << 1.0, 2.0 * i, 3.0;
+    tdkf.predictWithDelay(x_next, A, Q);
+    tdkf_n.predictWithDelay(x_next, A, Q);
+    ASSERT_EQ(true, tdkf.updateWithDelay(y, C, R, i % max_delay_step));
+    ASSERT_EQ(true, tdkf_n.updateWithDelay(y, C, R, i % max_delay_step));
+  }
+  Eigen::MatrixXd X_expected, P_expected;
+  tdkf.getX(X_expected);
+  tdkf.getP(P_expected);
+  Eigen::Matrix<double, 3 * max_delay_step, 1> X_actual;
+  Eigen::Matrix<double, 3 * max_delay_step, 3 * max_delay_step> P_actual;
+  tdkf_n.getX(X_actual);
+  tdkf_n.getP(P_actual);
+  ASSERT_TRUE((X_actual - X_expected).norm() < 1.0E-9) << "X_actual^T : "
+    << X_actual.transpose() << ", X_expected^T : " << X_expected.transpose();
+  ASSERT_TRUE((P_actual - P_expected).norm() < 1.0E-9);
+
+  ASSERT_EQ(false, tdkf_n.updateWithDelay(y, C, R, max_delay_step));
+  ASSERT_EQ(false, tdkf_n.updateWithDelay(y, C, R, max_delay_step + 1));
+}
+
 int main(int argc, char **argv)
 {
   testing::InitGoogleTest(&argc, argv);
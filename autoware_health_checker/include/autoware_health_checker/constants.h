@@ -53,6 +53,12 @@ using ThreshType = std::string;
 constexpr double BUFFER_DURATION = 0.5;
 constexpr double NODE_STATUS_UPDATE_RATE = 10.0;
 constexpr double SYSTEM_UPDATE_RATE = 30.0;
+/**
+ * \brief key of the diagnostic on the time spent by the health checker,
+ * reported when the health_checker_profile parameter is set.
+ */
+const ErrorKey HEALTH_CHECKER_OVERHEAD_KEY = "health_checker_overhead";
+constexpr double DEFAULT_OVERHEAD_BUDGET = 0.01;
 }  // namespace autoware_health_checker
 
 #endif  // AUTOWARE_HEALTH_CHECKER_CONSTANTS_H
@@ -27,6 +27,7 @@
 // headers in Autoware
 #include <autoware_health_checker/constants.h>
 #include <autoware_health_checker/health_checker/param_manager.h>
+#include <autoware_health_checker/health_checker/shm_node_status.h>
 #include <autoware_health_checker/health_aggregator/status_monitor.h>
 #include <autoware_system_msgs/NodeStatus.h>
 #include <autoware_system_msgs/SystemStatus.h>
@@ -38,9 +39,14 @@
 #include <boost/property_tree/ptree.hpp>
 
 // headers in STL
+#include <atomic>
 #include <map>
+#include <memory>
 #include <mutex>
 #include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 class HealthAggregator
@@ -48,6 +54,7 @@ class HealthAggregator
 public:
   using ErrorLevel = autoware_health_checker::ErrorLevel;
   HealthAggregator(ros::NodeHandle nh, ros::NodeHandle pnh);
+  ~HealthAggregator();
   void run();
 
 private:
@@ -64,27 +71,43 @@ private:
 
   ros::NodeHandle nh_;
   ros::NodeHandle pnh_;
-  ros::Publisher system_status_pub_;
+  ros::Publisher system_status_pub_, system_status_delta_pub_;
   std::map<ErrorLevel, ros::Publisher> text_pub_;
   ros::Subscriber node_status_sub_;
   ros::Subscriber diagnostic_array_sub_;
-  ros::Timer system_status_timer_, vital_timer_, ros_observer_timer_;
+  ros::Timer system_status_timer_, ros_observer_timer_;
+  // node discovery runs in its own thread, the last snapshot is published
+  std::thread node_discovery_thread_;
+  std::atomic<bool> is_shutdown_;
+  std::mutex discovery_mtx_;
   std::vector<std::string> detected_nodes_;
+  TimeoutManager discovery_timer_;
+  double node_discovery_rate_;
+  AwDiagStatusArray getDiscoveryStatus(const ros::Time& current) const;
   StatusMonitor status_monitor_;
   void updateNodeStatus(const autoware_system_msgs::NodeStatus& node_status);
   void publishSystemStatus(const ros::TimerEvent& event);
   void nodeStatusCallback(const AwNodeStatus::ConstPtr& msg);
+  void receiveNodeStatus(const AwNodeStatus& node_status);
+  // node statuses of this host, the others come from node_status
+  std::unique_ptr<autoware_health_checker::ShmNodeStatusReader> shm_reader_;
   void diagnosticArrayCallback(const RosDiagArr::ConstPtr& msg);
-  std::string generateText(const std::vector<AwDiagStatus>& status);
+  std::string generateText(const AwSysStatus& status, const ErrorLevel level);
   jsk_rviz_plugins::OverlayText
     generateOverlayText(const AwSysStatus& status, const ErrorLevel level);
-  std::vector<AwDiagStatus>
-    filterNodeStatus(const AwSysStatus& status, const ErrorLevel level);
+  void publishSystemStatusDelta();
   boost::optional<AwHwStatusArray> convert(const RosDiagArr::ConstPtr& msg);
   AwSysStatus system_status_;
+  // index of each node in system_status_.node_status
+  std::unordered_map<std::string, size_t> node_index_;
+  // nodes whose status changed since the last delta
+  std::unordered_set<size_t> changed_nodes_;
+  bool hardware_status_changed_;
+  std::vector<std::string> published_nodes_;
+  bool publish_delta_;
   autoware_health_checker::ParamManager param_manager_;
   std::mutex mtx_;
-  void updateConnectionStatus(const ros::TimerEvent& event);
+  void updateConnectionStatus();
   void rosObserverVitalCheck(const ros::TimerEvent& event);
   double hardware_diag_rate_;
   std::string hardware_diag_node_;
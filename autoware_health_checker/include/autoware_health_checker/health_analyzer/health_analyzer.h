@@ -25,7 +25,11 @@
 
 // headers in STL
 #include <map>
+#include <set>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
 #include <vector>
 
 // headers in Autoware
@@ -76,20 +80,33 @@ private:
   ros::NodeHandle pnh_;
   void systemStatusCallback(
     const autoware_system_msgs::SystemStatus::ConstPtr& msg);
-  void generateDependGraph(const autoware_system_msgs::SystemStatus& status);
-  void addDepend(const rosgraph_msgs::TopicStatistics& statistics);
+  // (node_sub, node_pub) of a dependency
+  using Depend = std::pair<std::string, std::string>;
+  void updateDependGraph(const autoware_system_msgs::SystemStatus& status);
+  void addDepend(const Depend& depend);
+  void removeDepend(const Depend& depend);
   autoware_system_msgs::SystemStatus filterSystemStatus(
     const autoware_system_msgs::SystemStatus& status);
-  std::vector<std::string> findWarningNodes(
-    const autoware_system_msgs::SystemStatus& status);
+  void updateWarningNodes(const autoware_system_msgs::SystemStatus& status);
   std::vector<std::string> findErrorNodes(
     const autoware_system_msgs::SystemStatus& status);
-  std::vector<std::string> findRootNodes(
-    const std::vector<std::string>& target_nodes);
+  void updateRootNodes();
+  void setDirty(const std::string& node_name);
   boost::optional<vertex_t> getTargetNode(const std::string& target_node);
+  vertex_t getOrAddVertex(const std::string& node_name);
   int countWarn(const autoware_system_msgs::SystemStatus& msg);
   void writeDot();
+  // the graph is kept between the messages and only the dependencies which
+  // appeared or disappeared are applied, the vertices are never removed
   graph_t depend_graph_;
+  std::unordered_map<std::string, vertex_t> vertex_index_;
+  std::set<Depend> depends_;
+  // nodes of the last message with a diagnostic over WARN
+  std::unordered_set<std::string> warning_nodes_;
+  // warning nodes none of whose publishers is a warning node
+  std::unordered_set<std::string> root_nodes_;
+  // nodes whose root state has to be computed again
+  std::unordered_set<std::string> dirty_nodes_;
   int warn_nodes_count_threshold_;
   template <typename T> bool
     isAlreadyExist(const std::vector<T>& vector, const T& target) const
@@ -24,7 +24,8 @@
 #include <autoware_system_msgs/DiagnosticStatusArray.h>
 
 // headers in STL
-#include <map>
+#include <array>
+#include <deque>
 #include <mutex>
 #include <string>
 #include <vector>
@@ -46,14 +47,17 @@ public:
 
 private:
   using AwDiagStatus = autoware_system_msgs::DiagnosticStatus;
+  // FATAL, ERROR, WARN, OK and UNDEFINED, in the order of the output for equal timestamps
+  static constexpr size_t LEVEL_COUNT = 5;
+  static const std::array<ErrorLevel, LEVEL_COUNT> levels_;
   std::mutex mtx_;
   ErrorLevel getErrorLevel();
+  // removes the expired diagnostics from the front of each buffer
   void updateBuffer();
   ErrorKey key_;
   ros::Duration buffer_duration_;
-  std::map<ErrorLevel, autoware_system_msgs::DiagnosticStatusArray> buffer_;
-  autoware_system_msgs::DiagnosticStatusArray filterBuffer(
-    ros::Time now, ErrorLevel level);
+  // one buffer per level, each sorted by timestamp
+  std::array<std::deque<AwDiagStatus>, LEVEL_COUNT> buffer_;
   ros::Publisher status_pub_;
   bool isOlderTimestamp(const autoware_system_msgs::DiagnosticStatus &a,
                         const autoware_system_msgs::DiagnosticStatus &b);
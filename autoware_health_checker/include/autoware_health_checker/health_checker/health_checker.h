@@ -26,12 +26,15 @@
 #include <autoware_health_checker/constants.h>
 #include <autoware_health_checker/health_checker/diag_buffer.h>
 #include <autoware_health_checker/health_checker/rate_checker.h>
+#include <autoware_health_checker/health_checker/shm_node_status.h>
+#include <autoware_health_checker/health_checker/value_checker.h>
 #include <autoware_health_checker/health_checker/value_manager.h>
 #include <autoware_system_msgs/NodeStatus.h>
 
 // headers in STL
 #include <functional>
 #include <map>
+#include <set>
 #include <memory>
 #include <sstream>
 #include <string>
@@ -51,6 +54,21 @@
 namespace autoware_health_checker
 {
 using MinMax = std::pair<double, double>;
+/**
+ * \brief time spent by a health checker since its construction,
+ * counted only when the health_checker_profile parameter is set.
+ */
+struct OverheadStats
+{
+  // CHECK_* and SET_DIAG_STATUS, in the threads of the caller
+  uint64_t calls;
+  double check_us;
+  double max_check_us;
+  // node status cycles, in the status thread
+  uint64_t cycles;
+  double publish_us;
+  double max_publish_us;
+};
 class HealthChecker
 {
 public:
@@ -74,6 +92,7 @@ public:
     std::function<boost::property_tree::ptree(T value)> value_json_func,
     const std::string& description)
   {
+    ProfileScope scope(*this);
     value_manager_.addCandidate(key);
     if (value_manager_.isNotFound(key))
     {
@@ -99,22 +118,57 @@ public:
     const ErrorLevel level, const std::string& description);
   ErrorLevel SET_DIAG_STATUS(
     const autoware_system_msgs::DiagnosticStatus& status);
+  /**
+   * \brief registration once of the checks done at a high rate, the checks
+   * through the returned handle lock nothing and look no parameter up,
+   * the thresholds are refreshed by the status thread.
+   * A key registered again returns the same handle.
+   */
+  ValueCheckerPtr registerMinValue(const ErrorKey& key,
+    const double warn_value, const double error_value,
+    const double fatal_value, const std::string& description);
+  ValueCheckerPtr registerMaxValue(const ErrorKey& key,
+    const double warn_value, const double error_value,
+    const double fatal_value, const std::string& description);
+  ValueCheckerPtr registerRange(const ErrorKey& key,
+    const MinMax warn_value, const MinMax error_value,
+    const MinMax fatal_value, const std::string& description);
+  // handle->check(value, level) records value with the level, as CHECK_TRUE
+  ValueCheckerPtr registerTrue(const ErrorKey& key,
+    const std::string& description);
   void NODE_ACTIVATE()
   {
-    std::lock_guard<std::mutex> lock(mtx_);
     node_activated_ = true;
   };
   void NODE_DEACTIVATE()
   {
-    std::lock_guard<std::mutex> lock(mtx_);
     node_activated_ = false;
   };
   bool getNodeStatus()
   {
     return node_activated_;
   };
+  bool isProfiling() const
+  {
+    return profile_;
+  };
+  OverheadStats getOverheadStats() const;
 
 private:
+  /**
+   * \brief times the outermost check of the calling thread while profiling,
+   * the checks called by another check are not counted twice.
+   */
+  class ProfileScope
+  {
+  public:
+    explicit ProfileScope(HealthChecker& checker);
+    ~ProfileScope();
+
+  private:
+    HealthChecker* checker_;
+    std::chrono::steady_clock::time_point start_;
+  };
   std::vector<ErrorKey> getKeys();
   std::vector<ErrorKey> getRateCheckerKeys();
   ros::NodeHandle nh_;
@@ -123,7 +177,18 @@ private:
   ValueManager value_manager_;
   std::map<ErrorKey, std::unique_ptr<DiagBuffer>> diag_buffers_;
   std::map<ErrorKey, std::unique_ptr<RateChecker>> rate_checkers_;
-  ros::Publisher status_pub_;
+  std::map<ErrorKey, ValueCheckerPtr> value_checkers_;
+  ValueCheckerPtr registerValueChecker(const ErrorKey& key,
+    const ErrorType type, const std::string& description,
+    const bool boolean_value);
+  void updateValueChecker(ValueChecker& checker);
+  ros::Publisher status_pub_, emergency_pub_;
+  // used instead of status_pub_ while health_aggregator reads it
+  ShmNodeStatusWriter shm_writer_;
+  // keys whose last diagnostic is ERROR or FATAL
+  std::set<ErrorKey> emergency_keys_;
+  void updateEmergency(const AwDiagStatus& status);
+  void publishEmergency(const AwDiagStatus& status);
   bool keyExist(const ErrorKey& key) const;
   bool addNewBuffer(const ErrorKey& key, const ErrorType type,
     const std::string& description);
@@ -139,7 +204,16 @@ private:
     return ss.str();
   }
   void publishStatus();
-  bool node_activated_;
+  autoware_system_msgs::NodeStatus collectStatus(const ros::Time& now);
+  AwDiagStatusArray getOverheadStatus(const ros::Time& now,
+    const OverheadStats& prev_stats, const double elapsed_us) const;
+  static void updateMax(std::atomic<uint64_t>& max_ns, const uint64_t ns);
+  bool profile_;
+  double overhead_budget_;
+  std::atomic<uint64_t> check_calls_, check_ns_, max_check_ns_;
+  std::atomic<uint64_t> publish_cycles_, publish_ns_, max_publish_ns_;
+  // set from the node's threads, read by the publisher and the emergency path without mtx_
+  std::atomic<bool> node_activated_;
   std::atomic<bool> is_shutdown_;
   std::mutex mtx_;
 };
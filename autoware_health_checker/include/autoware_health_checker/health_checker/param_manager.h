@@ -17,14 +17,33 @@
 #ifndef AUTOWARE_HEALTH_CHECKER_HEALTH_CHECKER_PARAM_MANAGER_H
 #define AUTOWARE_HEALTH_CHECKER_HEALTH_CHECKER_PARAM_MANAGER_H
 
+#include <array>
+#include <atomic>
+#include <memory>
 #include <string>
 #include <set>
 #include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <boost/optional.hpp>
 #include <ros/ros.h>
 #include <autoware_health_checker/constants.h>
 
 namespace autoware_health_checker
 {
+/**
+ * \brief Thresholds of the health_checker parameters, resolved once per parameter update.
+ */
+struct ParamTable
+{
+  // warn, error and fatal values, none when the parameter leaves the default one
+  using Thresholds = std::array<boost::optional<double>, 3>;
+  std::unordered_map<ErrorKey, std::unordered_map<ThreshType, Thresholds>> thresholds;
+  // members of each key, for the keys that are in a namespace
+  std::unordered_map<ErrorKey, std::unordered_set<ErrorKey>> members;
+};
+
 class ParamManager
 {
 public:
@@ -33,14 +52,24 @@ public:
   bool isNotFound(const ErrorKey& ns, const ErrorKey& key);
   void addCandidate(const ErrorKey& key);
   const XmlRpc::XmlRpcValue& getParams();
+  /**
+   * \brief The current table when health_checker_param_table is set, nullptr otherwise.
+   * The read is lock-free, a table stays valid as long as the manager.
+   */
+  const ParamTable* getTable() const;
 private:
   void getParams(const ros::TimerEvent& event);
   void setParams(const ros::TimerEvent& event);
+  void updateTable(const XmlRpc::XmlRpcValue& params);
   ros::NodeHandle nh_, pnh_;
   ros::Timer get_timer_, set_timer_;
   std::set<ErrorKey> cached_candidate_key_;
   XmlRpc::XmlRpcValue params_;
   std::mutex param_mtx_, key_mtx_;
+  bool use_table_;
+  std::atomic<const ParamTable*> table_;
+  // the tables replaced by an update are kept, the readers may still hold them
+  std::vector<std::unique_ptr<const ParamTable>> tables_;
 };
 }  // namespace autoware_health_checker
 #endif  // AUTOWARE_HEALTH_CHECKER_HEALTH_CHECKER_PARAM_MANAGER_H
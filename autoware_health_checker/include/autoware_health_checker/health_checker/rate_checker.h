@@ -23,7 +23,9 @@
 #include <ros/ros.h>
 
 // headers in STL
-#include <mutex>
+#include <array>
+#include <atomic>
+#include <cstdint>
 #include <vector>
 #include <string>
 #include <utility>
@@ -52,14 +54,18 @@ public:
 
 private:
   using AwDiagStatus = autoware_system_msgs::DiagnosticStatus;
+  // the window is split into BUCKET_COUNT buckets, one more keeps the bucket partly out of the window
+  static constexpr int64_t BUCKET_COUNT = 50;
+  static constexpr int COUNT_BITS = 24;
   ros::Time start_time_;
-  void update();
-  std::vector<ros::Time> data_;
+  int64_t getBucketIndex(const ros::Time& time) const;
+  // each bucket packs its index since start_time_ and its count, so that check() updates both in one exchange
+  std::array<std::atomic<uint64_t>, BUCKET_COUNT + 1> buckets_;
   double buffer_duration_;
-  double warn_rate_;
-  double error_rate_;
-  double fatal_rate_;
-  std::mutex mtx_;
+  double bucket_duration_;
+  std::atomic<double> warn_rate_;
+  std::atomic<double> error_rate_;
+  std::atomic<double> fatal_rate_;
 };
 }  // namespace autoware_health_checker
 #endif  // AUTOWARE_HEALTH_CHECKER_HEALTH_CHECKER_RATE_CHECKER_H
@@ -0,0 +1,121 @@
+/*
+ * Copyright 2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *
+ * v1.0 Masaya Kataoka
+ */
+
+#ifndef AUTOWARE_HEALTH_CHECKER_HEALTH_CHECKER_SHM_NODE_STATUS_H
+#define AUTOWARE_HEALTH_CHECKER_HEALTH_CHECKER_SHM_NODE_STATUS_H
+// headers in ROS
+#include <ros/ros.h>
+
+// headers in Autoware
+#include <autoware_system_msgs/NodeStatus.h>
+
+// headers in boost
+#include <boost/interprocess/managed_shared_memory.hpp>
+#include <boost/interprocess/sync/interprocess_mutex.hpp>
+
+// headers in STL
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace autoware_health_checker
+{
+/**
+ * \brief Node statuses exchanged through shared memory on one host.
+ * health_aggregator creates the segment, then each HealthChecker of the host
+ * serializes its NodeStatus into a ring of its own instead of publishing it,
+ * and health_aggregator reads the latest status of each ring. The segment is
+ * named after the ROS master, the rings are never freed and are taken back
+ * by a node of the same name.
+ */
+constexpr size_t SHM_NODE_STATUS_MAX_NODES = 256;
+constexpr size_t SHM_NODE_STATUS_NAME_LENGTH = 256;
+constexpr uint64_t SHM_NODE_STATUS_SLOT_COUNT = 4;
+// the writers publish again when health_aggregator stops reading
+constexpr double SHM_NODE_STATUS_TIMEOUT = 1.0;
+
+// sequence of a slot is 2 * ticket + 1 while it is written,
+// 2 * ticket + 2 once it is complete
+struct ShmNodeStatusRing
+{
+  char node_name[SHM_NODE_STATUS_NAME_LENGTH];
+  std::atomic<bool> closed;
+  std::atomic<uint64_t> write_ticket;
+  std::atomic<uint64_t> sequence[SHM_NODE_STATUS_SLOT_COUNT];
+  std::atomic<uint32_t> size[SHM_NODE_STATUS_SLOT_COUNT];
+  // SHM_NODE_STATUS_SLOT_COUNT slots of slot_capacity bytes follow
+};
+
+struct ShmNodeStatusDirectory
+{
+  using handle_t = boost::interprocess::managed_shared_memory::handle_t;
+  explicit ShmNodeStatusDirectory(const uint32_t capacity)
+    : slot_capacity(capacity), heartbeat_nsec(0), ring_count(0) {}
+  const uint32_t slot_capacity;
+  // steady clock of the last read, common to the processes of the host
+  std::atomic<int64_t> heartbeat_nsec;
+  boost::interprocess::interprocess_mutex mutex;
+  uint32_t ring_count;
+  handle_t rings[SHM_NODE_STATUS_MAX_NODES];
+};
+
+std::string getShmNodeStatusName();
+
+class ShmNodeStatusWriter
+{
+public:
+  explicit ShmNodeStatusWriter(const std::string& node_name);
+  ~ShmNodeStatusWriter();
+  /**
+   * \brief false when no health_aggregator reads the node statuses on this
+   * host or status does not fit, status has to be published then
+   */
+  bool write(const autoware_system_msgs::NodeStatus& status);
+
+private:
+  const std::string node_name_;
+  std::unique_ptr<boost::interprocess::managed_shared_memory> shm_;
+  ShmNodeStatusDirectory* directory_;
+  ShmNodeStatusRing* ring_;
+  std::chrono::steady_clock::time_point next_attempt_;
+  bool attemptToOpen();
+  bool isReaderAlive() const;
+};
+
+class ShmNodeStatusReader
+{
+public:
+  ShmNodeStatusReader(const size_t segment_size, const uint32_t slot_capacity);
+  /**
+   * \brief latest status of each ring written since the previous call
+   */
+  std::vector<autoware_system_msgs::NodeStatus> read();
+
+private:
+  boost::interprocess::managed_shared_memory shm_;
+  ShmNodeStatusDirectory* directory_;
+  std::map<ShmNodeStatusDirectory::handle_t, uint64_t> read_tickets_;
+  std::vector<uint8_t> buffer_;
+};
+}  // namespace autoware_health_checker
+#endif  // AUTOWARE_HEALTH_CHECKER_HEALTH_CHECKER_SHM_NODE_STATUS_H
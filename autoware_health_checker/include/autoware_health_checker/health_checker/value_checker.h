@@ -0,0 +1,110 @@
+/*
+ * Copyright 2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *
+ * v1.0 Masaya Kataoka
+ */
+
+#ifndef AUTOWARE_HEALTH_CHECKER_HEALTH_CHECKER_VALUE_CHECKER_H
+#define AUTOWARE_HEALTH_CHECKER_HEALTH_CHECKER_VALUE_CHECKER_H
+// headers in ROS
+#include <ros/ros.h>
+
+// headers in STL
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+
+// headers in Autoware
+#include <autoware_health_checker/constants.h>
+#include <autoware_system_msgs/DiagnosticStatusArray.h>
+
+namespace autoware_health_checker
+{
+/**
+ * \brief Check of one key registered once, for the callbacks checking a value
+ * at a high rate. check() computes the level from thresholds refreshed by the
+ * status thread and writes the sample into a preallocated ring without lock,
+ * getAndClearData() harvests the samples on the status thread.
+ */
+class ValueChecker
+{
+public:
+  ValueChecker(const ErrorKey& key, const ErrorType type,
+    const std::string& description, const bool boolean_value = false);
+  /**
+   * \brief level of value from the thresholds, UNDEFINED while the key is
+   * not configured
+   */
+  ErrorLevel check(const double value);
+  /**
+   * \brief record value with a level computed by the caller, as CHECK_TRUE
+   */
+  ErrorLevel check(const double value, const ErrorLevel level);
+  using AlarmCallback =
+    std::function<void(const autoware_system_msgs::DiagnosticStatus&)>;
+  /**
+   * \brief callback called by check() when the level becomes ERROR or FATAL,
+   * only once until a lower level is checked. Set it before check() is called.
+   */
+  void setAlarmCallback(const AlarmCallback& callback);
+  // thresholds FATAL, ERROR and WARN, a value below a min or above
+  // a max one has this level
+  void setMinValue(double warn_value, double error_value, double fatal_value);
+  void setMaxValue(double warn_value, double error_value, double fatal_value);
+  void setEnabled(bool enabled);
+  bool hasMinValue() const;
+  bool hasMaxValue() const;
+  /**
+   * \brief samples checked since the previous call, oldest first. The oldest
+   * ones are dropped when more than CAPACITY were checked in between.
+   */
+  autoware_system_msgs::DiagnosticStatusArray getAndClearData();
+  const ErrorKey key;
+  const ErrorType type;
+  const std::string description;
+
+private:
+  using AwDiagStatus = autoware_system_msgs::DiagnosticStatus;
+  static constexpr uint64_t CAPACITY = 64;
+  // sequence is 2 * ticket + 1 while the sample is written,
+  // 2 * ticket + 2 once it is complete
+  struct Sample
+  {
+    std::atomic<uint64_t> sequence;
+    std::atomic<double> value;
+    std::atomic<ErrorLevel> level;
+    std::atomic<int64_t> stamp_nsec;
+  };
+  std::unique_ptr<Sample[]> samples_;
+  std::atomic<uint64_t> write_ticket_;
+  uint64_t read_ticket_;
+  std::array<std::atomic<double>, 3> min_value_;
+  std::array<std::atomic<double>, 3> max_value_;
+  bool has_min_value_;
+  bool has_max_value_;
+  std::atomic<bool> enabled_;
+  const bool boolean_value_;
+  std::atomic<bool> alarmed_;
+  AlarmCallback alarm_callback_;
+  AwDiagStatus toStatus(const double value, const ErrorLevel level,
+    const ros::Time& stamp) const;
+};
+using ValueCheckerPtr = std::shared_ptr<ValueChecker>;
+}  // namespace autoware_health_checker
+#endif  // AUTOWARE_HEALTH_CHECKER_HEALTH_CHECKER_VALUE_CHECKER_H
@@ -54,6 +54,8 @@ public:
 private:
   using AwDiagStatus = autoware_system_msgs::DiagnosticStatus;
   std::map<ErrorSummary, double> error_details_;
+  boost::optional<double> getTableValue(const ParamTable& table,
+    const ErrorKey& key, const ThreshType& thresh_type, const ErrorLevel level);
 };
 }  // namespace autoware_health_checker
 #endif  // AUTOWARE_HEALTH_CHECKER_HEALTH_CHECKER_VALUE_MANAGER_H
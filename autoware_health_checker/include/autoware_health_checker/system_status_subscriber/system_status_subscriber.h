@@ -38,8 +38,12 @@ class SystemStatusSubscriber
 public:
   SystemStatusSubscriber(ros::NodeHandle nh, ros::NodeHandle pnh);
   void enable();
+  // each callback gets its own copy of the status, for callbacks that modify it
   void
   addCallback(std::function<void(std::shared_ptr<autoware_system_msgs::SystemStatus>)> func);
+  // all the shared callbacks get the received status itself, without a copy
+  void
+  addSharedCallback(std::function<void(const autoware_system_msgs::SystemStatus::ConstPtr&)> func);
 
 private:
   void
@@ -48,6 +52,7 @@ private:
   ros::NodeHandle nh_;
   ros::NodeHandle pnh_;
   std::vector<std::function<void(std::shared_ptr<autoware_system_msgs::SystemStatus>)>> functions_;
+  std::vector<std::function<void(const autoware_system_msgs::SystemStatus::ConstPtr&)>> shared_functions_;
 };
 }  // namespace autoware_health_checker
 
@@ -17,6 +17,10 @@
  * v1.0 Masaya Kataoka
  */
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
 #include <string>
 #include <vector>
 #include <regex>
@@ -53,19 +57,72 @@ boost::optional <std::string> getValidName(const std::string& orig)
   return ros::names::validate(changed, error) ?
     boost::optional<std::string>(changed) : boost::none;
 }
+
+// same diagnostics apart from the stamps
+bool isSameStatus(const autoware_system_msgs::NodeStatus& lhs,
+  const autoware_system_msgs::NodeStatus& rhs)
+{
+  if (lhs.node_activated != rhs.node_activated ||
+    lhs.status.size() != rhs.status.size())
+  {
+    return false;
+  }
+  for (size_t i = 0; i < lhs.status.size(); ++i)
+  {
+    const auto& lhs_array = lhs.status[i].status;
+    const auto& rhs_array = rhs.status[i].status;
+    if (lhs_array.size() != rhs_array.size())
+    {
+      return false;
+    }
+    for (size_t j = 0; j < lhs_array.size(); ++j)
+    {
+      if (lhs_array[j].level != rhs_array[j].level ||
+        lhs_array[j].key != rhs_array[j].key ||
+        lhs_array[j].value != rhs_array[j].value)
+      {
+        return false;
+      }
+    }
+  }
+  return true;
+}
 }  // namespace
 
 HealthAggregator::HealthAggregator(ros::NodeHandle nh, ros::NodeHandle pnh)
-  : nh_(nh), pnh_(pnh), param_manager_(nh_, pnh)
+  : nh_(nh), pnh_(pnh), is_shutdown_(false), hardware_status_changed_(false),
+    param_manager_(nh_, pnh)
 {
   nh_.param("hardware_diag_node",
     hardware_diag_node_, std::string("diagnostic_aggregator"));
   nh_.param(hardware_diag_node_ + "/pub_rate", hardware_diag_rate_, 1.0);
+  pnh_.param("publish_delta", publish_delta_, false);
+  pnh_.param("node_discovery_rate", node_discovery_rate_, 1.0);
+  if (node_discovery_rate_ <= 0.0)
+  {
+    ROS_WARN("node_discovery_rate must be positive, 1.0 is used");
+    node_discovery_rate_ = 1.0;
+  }
+  discovery_timer_ = TimeoutManager(2.0 / node_discovery_rate_);
+}
+
+HealthAggregator::~HealthAggregator()
+{
+  is_shutdown_.store(true);
+  if (node_discovery_thread_.joinable())
+  {
+    node_discovery_thread_.join();
+  }
 }
 
 void HealthAggregator::run()
 {
   system_status_pub_ = nh_.advertise<AwSysStatus>("system_status", 10);
+  if (publish_delta_)
+  {
+    system_status_delta_pub_ =
+      nh_.advertise<AwSysStatus>("system_status_delta", 10);
+  }
   auto registerTextPublisher = [this](ErrorLevel level, std::string topic)
   {
     text_pub_[level] = pnh_.advertise<jsk_rviz_plugins::OverlayText>(topic, 1);
@@ -77,6 +134,24 @@ void HealthAggregator::run()
   registerTextPublisher(AwDiagStatus::FATAL, "fatal_text");
   node_status_sub_ = nh_.subscribe("node_status", 10,
     &HealthAggregator::nodeStatusCallback, this);
+  bool use_shm_node_status;
+  pnh_.param("use_shm_node_status", use_shm_node_status, false);
+  if (use_shm_node_status)
+  {
+    int segment_size, slot_capacity;
+    pnh_.param("shm_segment_size", segment_size, 16 * 1024 * 1024);
+    pnh_.param("shm_slot_capacity", slot_capacity, 64 * 1024);
+    try
+    {
+      shm_reader_.reset(new autoware_health_checker::ShmNodeStatusReader(
+        segment_size, slot_capacity));
+    }
+    catch (const boost::interprocess::interprocess_exception& ex)
+    {
+      ROS_ERROR("shared memory for the node statuses is not available: %s",
+        ex.what());
+    }
+  }
   // ros::master::getNodes will continue to wait for a response from the master
   // if the master goes down unless a timeout is specified.
   // To avoid this, it is necessary to set a timeout.
@@ -87,8 +162,8 @@ void HealthAggregator::run()
   ros::Duration duration(1.0 / autoware_health_checker::SYSTEM_UPDATE_RATE);
   system_status_timer_ =
     nh_.createTimer(duration, &HealthAggregator::publishSystemStatus, this);
-  vital_timer_ =
-    nh_.createTimer(duration, &HealthAggregator::updateConnectionStatus, this);
+  node_discovery_thread_ =
+    std::thread(&HealthAggregator::updateConnectionStatus, this);
   ros_observer_timer_ =
     nh_.createTimer(duration, &HealthAggregator::rosObserverVitalCheck, this);
 }
@@ -97,28 +172,75 @@ void HealthAggregator::updateNodeStatus(
   const autoware_system_msgs::NodeStatus& node_status)
 {
   auto& node_status_array = system_status_.node_status;
-  auto identify = [&node_status](const autoware_system_msgs::NodeStatus& status)
-  {
-    return status.node_name == node_status.node_name;
-  };
-  auto result =
-    std::find_if(node_status_array.begin(), node_status_array.end(), identify);
-  if (result != node_status_array.end())
+  const auto result = node_index_.emplace(
+    node_status.node_name, node_status_array.size());
+  if (!result.second)
   {
-    *result = node_status;
+    auto& stored = node_status_array[result.first->second];
+    if (publish_delta_ && !isSameStatus(stored, node_status))
+    {
+      changed_nodes_.emplace(result.first->second);
+    }
+    stored = node_status;
   }
   else
   {
+    changed_nodes_.emplace(node_status_array.size());
     node_status_array.emplace_back(node_status);
   }
 }
+
+void HealthAggregator::publishSystemStatusDelta()
+{
+  AwSysStatus delta;
+  delta.header = system_status_.header;
+  if (published_nodes_ != system_status_.available_nodes)
+  {
+    delta.available_nodes = system_status_.available_nodes;
+    published_nodes_ = system_status_.available_nodes;
+  }
+  if (hardware_status_changed_)
+  {
+    delta.hardware_status = system_status_.hardware_status;
+    hardware_status_changed_ = false;
+  }
+  delta.node_status.reserve(changed_nodes_.size());
+  for (const auto index : changed_nodes_)
+  {
+    delta.node_status.emplace_back(system_status_.node_status[index]);
+  }
+  changed_nodes_.clear();
+  system_status_delta_pub_.publish(delta);
+}
+
 void HealthAggregator::publishSystemStatus(const ros::TimerEvent& event)
 {
   std::lock_guard<std::mutex> lock(mtx_);
   system_status_.header.stamp = ros::Time::now();
-  updateNodeStatus(status_monitor_.getMonitorStatus());
-  system_status_.available_nodes = detected_nodes_;
+  if (shm_reader_)
+  {
+    for (const auto& node_status : shm_reader_->read())
+    {
+      receiveNodeStatus(node_status);
+    }
+  }
+  auto monitor_status = status_monitor_.getMonitorStatus();
+  {
+    std::lock_guard<std::mutex> discovery_lock(discovery_mtx_);
+    system_status_.available_nodes = detected_nodes_;
+    monitor_status.status.emplace_back(
+      getDiscoveryStatus(system_status_.header.stamp));
+  }
+  updateNodeStatus(monitor_status);
   system_status_pub_.publish(system_status_);
+  if (publish_delta_)
+  {
+    publishSystemStatusDelta();
+  }
+  else
+  {
+    changed_nodes_.clear();
+  }
   static const std::array<ErrorLevel, 4> level_array =
   {
     AwDiagStatus::OK,
@@ -142,20 +264,58 @@ void HealthAggregator::rosObserverVitalCheck(const ros::TimerEvent& event)
   shm_HAvmon.run();
 }
 
-void HealthAggregator::updateConnectionStatus(const ros::TimerEvent& event)
+void HealthAggregator::updateConnectionStatus()
 {
-  std::vector<std::string> detected_nodes;
-  ros::master::getNodes(detected_nodes);
-  detected_nodes_ = detected_nodes;
+  const auto period = std::chrono::microseconds(
+    std::lround(1.0 / node_discovery_rate_ * 1e6));
+  const double timeout = 2.0 / node_discovery_rate_;
+  auto until_time = std::chrono::steady_clock::now();
+  while (ros::ok() && !is_shutdown_.load())
+  {
+    std::vector<std::string> detected_nodes;
+    // the previous snapshot is kept while the master does not answer
+    if (ros::master::getNodes(detected_nodes))
+    {
+      std::lock_guard<std::mutex> lock(discovery_mtx_);
+      detected_nodes_ = std::move(detected_nodes);
+      discovery_timer_ = TimeoutManager(timeout);
+    }
+    until_time = std::max(until_time + period, std::chrono::steady_clock::now());
+    std::this_thread::sleep_until(until_time);
+  }
+}
+
+// age of available_nodes in seconds, ERROR when discovery is late
+HealthAggregator::AwDiagStatusArray
+  HealthAggregator::getDiscoveryStatus(const ros::Time& current) const
+{
+  AwDiagStatus status;
+  status.header.stamp = discovery_timer_.getStartTime();
+  status.key = "node_discovery_stale";
+  status.description = "node discovery stale";
+  status.type = AwDiagStatus::UNEXPECTED_RATE;
+  status.level = discovery_timer_.isOverLimit(current) ?
+    AwDiagStatus::ERROR : AwDiagStatus::OK;
+  std::stringstream ss;
+  ss << discovery_timer_.getDuration(current);
+  status.value = ss.str();
+  AwDiagStatusArray status_array;
+  status_array.status.emplace_back(status);
+  return status_array;
 }
 
 void HealthAggregator::nodeStatusCallback(const AwNodeStatus::ConstPtr& msg)
 {
   std::lock_guard<std::mutex> lock(mtx_);
-  updateNodeStatus(*msg);
+  receiveNodeStatus(*msg);
+}
+
+void HealthAggregator::receiveNodeStatus(const AwNodeStatus& node_status)
+{
+  updateNodeStatus(node_status);
   static const double timeout =
     1.0 / autoware_health_checker::NODE_STATUS_UPDATE_RATE * 2.0;
-  status_monitor_.updateStamp(changeToKeyFormat(msg->node_name), timeout);
+  status_monitor_.updateStamp(changeToKeyFormat(node_status.node_name), timeout);
 }
 
 void HealthAggregator::diagnosticArrayCallback(const RosDiagArr::ConstPtr& msg)
@@ -165,19 +325,48 @@ void HealthAggregator::diagnosticArrayCallback(const RosDiagArr::ConstPtr& msg)
   if (status)
   {
     system_status_.hardware_status = status.get();
+    hardware_status_changed_ = true;
   }
   static const double timeout = 1.0 / hardware_diag_rate_ * 2.0;
   status_monitor_.updateStamp(changeToKeyFormat(hardware_diag_node_), timeout);
 }
 
+// descriptions of the activated nodes' diagnostics of level, one per line
 std::string HealthAggregator::generateText(
-  const std::vector<AwDiagStatus>& status)
+  const AwSysStatus& status, const HealthAggregator::ErrorLevel level)
 {
+  auto for_each_diag = [&status, level](
+    const std::function<void(const AwDiagStatus&)>& func)
+  {
+    for (const auto& node_status : status.node_status)
+    {
+      if (!node_status.node_activated)
+      {
+        continue;
+      }
+      for (const auto& node_status_array : node_status.status)
+      {
+        for (const auto& diag_status : node_status_array.status)
+        {
+          if (diag_status.level == level)
+          {
+            func(diag_status);
+          }
+        }
+      }
+    }
+  };
+  size_t length = 0;
+  for_each_diag([&length](const AwDiagStatus& diag)
+  {
+    length += diag.description.size() + 1;
+  });
   std::string text;
-  for (const auto& s : status)
+  text.reserve(length);
+  for_each_diag([&text](const AwDiagStatus& diag)
   {
-    text = text + s.description + "\n";
-  }
+    text.append(diag.description).push_back('\n');
+  });
   return text;
 }
 
@@ -202,7 +391,7 @@ HealthAggregator::generateOverlayText(const AwSysStatus& status,
     text.fg_color.g = 0.0;
     text.fg_color.b = 1.0;
     text.fg_color.a = 1.0;
-    text.text = generateText(filterNodeStatus(status, level));
+    text.text = generateText(status, level);
   }
   else if (level == AwDiagStatus::WARN)
   {
@@ -211,7 +400,7 @@ HealthAggregator::generateOverlayText(const AwSysStatus& status,
     text.fg_color.g = 1.0;
     text.fg_color.b = 0.0;
     text.fg_color.a = 1.0;
-    text.text = generateText(filterNodeStatus(status, level));
+    text.text = generateText(status, level);
   }
   else if (level == AwDiagStatus::ERROR)
   {
@@ -220,7 +409,7 @@ HealthAggregator::generateOverlayText(const AwSysStatus& status,
     text.fg_color.g = 0.0;
     text.fg_color.b = 0.0;
     text.fg_color.a = 1.0;
-    text.text = generateText(filterNodeStatus(status, level));
+    text.text = generateText(status, level);
   }
   else if (level == AwDiagStatus::FATAL)
   {
@@ -229,36 +418,11 @@ HealthAggregator::generateOverlayText(const AwSysStatus& status,
     text.fg_color.g = 1.0;
     text.fg_color.b = 1.0;
     text.fg_color.a = 1.0;
-    text.text = generateText(filterNodeStatus(status, level));
+    text.text = generateText(status, level);
   }
   return text;
 }
 
-std::vector<HealthAggregator::AwDiagStatus>
-HealthAggregator::filterNodeStatus(const AwSysStatus& status,
-  const HealthAggregator::ErrorLevel level)
-{
-  std::vector<AwDiagStatus> ret;
-  for (const auto& node_status : status.node_status)
-  {
-    if (!node_status.node_activated)
-    {
-      continue;
-    }
-    for (const auto& node_status_array : node_status.status)
-    {
-      for (const auto& diag_status : node_status_array.status)
-      {
-        if (diag_status.level == level)
-        {
-          ret.emplace_back(diag_status);
-        }
-      }
-    }
-  }
-  return ret;
-}
-
 const HealthAggregator::ErrorLevel
   HealthAggregator::convertHardwareLevel(const ErrorLevel& level) const
 {
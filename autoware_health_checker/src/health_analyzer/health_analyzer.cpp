@@ -17,6 +17,7 @@
  * v1.0 Masaya Kataoka
  */
 
+#include <set>
 #include <string>
 #include <vector>
 #include <autoware_health_checker/health_analyzer/health_analyzer.h>
@@ -69,10 +70,9 @@ int HealthAnalyzer::countWarn(const autoware_system_msgs::SystemStatus& msg)
   return count;
 }
 
-std::vector<std::string> HealthAnalyzer::findWarningNodes(
+void HealthAnalyzer::updateWarningNodes(
   const autoware_system_msgs::SystemStatus& sys_status)
 {
-  std::vector<std::string> ret;
   auto isOverWarn = [](autoware_health_checker::ErrorLevel level)
   {
     return (
@@ -80,24 +80,42 @@ std::vector<std::string> HealthAnalyzer::findWarningNodes(
       level == AwDiagStatus::ERROR ||
       level == AwDiagStatus::FATAL);
   };
+  std::unordered_set<std::string> warning_nodes;
   for (const auto& node_status : sys_status.node_status)
   {
+    if (warning_nodes.count(node_status.node_name) != 0)
+    {
+      continue;
+    }
+    bool over_warn = false;
     for (const auto& status_array : node_status.status)
     {
       for (const auto& status : status_array.status)
       {
-        if (isAlreadyExist(ret, node_status.node_name))
-        {
-          continue;
-        }
-        else if (isOverWarn(status.level))
-        {
-          ret.emplace_back(node_status.node_name);
-        }
+        over_warn |= isOverWarn(status.level);
       }
     }
+    if (over_warn)
+    {
+      warning_nodes.emplace(node_status.node_name);
+    }
   }
-  return ret;
+  // only the nodes which became warning nodes or stopped being ones
+  for (const auto& node : warning_nodes)
+  {
+    if (warning_nodes_.count(node) == 0)
+    {
+      setDirty(node);
+    }
+  }
+  for (const auto& node : warning_nodes_)
+  {
+    if (warning_nodes.count(node) == 0)
+    {
+      setDirty(node);
+    }
+  }
+  warning_nodes_.swap(warning_nodes);
 }
 
 std::vector<std::string> HealthAnalyzer::findErrorNodes(
@@ -131,34 +149,56 @@ std::vector<std::string> HealthAnalyzer::findErrorNodes(
   return ret;
 }
 
-std::vector<std::string> HealthAnalyzer::findRootNodes(
-  const std::vector<std::string>& target_nodes)
+// the root state of node and of its subscribers depends on node
+void HealthAnalyzer::setDirty(const std::string& node_name)
 {
-  std::vector<std::string> ret;
-  for (const auto& node : target_nodes)
+  dirty_nodes_.emplace(node_name);
+  const auto vertex = getTargetNode(node_name);
+  if (!vertex)
   {
-    std::vector<std::string> pub_nodes;
-    bool depend_found = false;
-    adjacency_iterator_t vi, vi_end;
-    auto vertex = getTargetNode(node);
-    if (!vertex)
-    {
-      continue;
-    }
-    boost::tie(vi, vi_end) = adjacent_vertices(vertex.get(), depend_graph_);
-    for (; vi != vi_end; ++vi)
+    return;
+  }
+  boost::graph_traits<graph_t>::in_edge_iterator ei, ei_end;
+  boost::tie(ei, ei_end) = boost::in_edges(vertex.get(), depend_graph_);
+  for (; ei != ei_end; ++ei)
+  {
+    dirty_nodes_.emplace(
+      depend_graph_[boost::source(*ei, depend_graph_)].node_name);
+  }
+}
+
+void HealthAnalyzer::updateRootNodes()
+{
+  for (const auto& node : dirty_nodes_)
+  {
+    bool is_root = false;
+    const auto vertex = getTargetNode(node);
+    // nodes without any dependency are not in the graph
+    if (vertex && warning_nodes_.count(node) != 0 &&
+      boost::degree(vertex.get(), depend_graph_) != 0)
     {
-      if (isAlreadyExist(target_nodes, depend_graph_[*vi].node_name))
+      is_root = true;
+      adjacency_iterator_t vi, vi_end;
+      boost::tie(vi, vi_end) = adjacent_vertices(vertex.get(), depend_graph_);
+      for (; vi != vi_end; ++vi)
       {
-        depend_found = true;
+        if (warning_nodes_.count(depend_graph_[*vi].node_name) != 0)
+        {
+          is_root = false;
+          break;
+        }
       }
     }
-    if (!depend_found)
+    if (is_root)
+    {
+      root_nodes_.emplace(node);
+    }
+    else
     {
-      ret.emplace_back(node);
+      root_nodes_.erase(node);
     }
   }
-  return ret;
+  dirty_nodes_.clear();
 }
 
 autoware_system_msgs::SystemStatus HealthAnalyzer::filterSystemStatus(
@@ -169,10 +209,11 @@ autoware_system_msgs::SystemStatus HealthAnalyzer::filterSystemStatus(
   filtered_status.detect_too_match_warning =
     (warn_count >= warn_nodes_count_threshold_);
   filtered_status.node_status.clear();
-  std::vector<std::string> root_nodes(findRootNodes(findWarningNodes(status)));
+  updateWarningNodes(status);
+  updateRootNodes();
   for (const auto& node_status : status.node_status)
   {
-    if (isAlreadyExist(root_nodes, node_status.node_name))
+    if (root_nodes_.count(node_status.node_name) != 0)
     {
       filtered_status.node_status.emplace_back(node_status);
     }
@@ -183,18 +224,40 @@ autoware_system_msgs::SystemStatus HealthAnalyzer::filterSystemStatus(
 void HealthAnalyzer::systemStatusCallback(
     const autoware_system_msgs::SystemStatus::ConstPtr& msg)
 {
-  generateDependGraph(*msg);
+  updateDependGraph(*msg);
   system_status_summary_pub_.publish(filterSystemStatus(*msg));
 }
 
-void HealthAnalyzer::generateDependGraph(
+void HealthAnalyzer::updateDependGraph(
   const autoware_system_msgs::SystemStatus& status)
 {
-  depend_graph_ = graph_t();
+  std::set<Depend> depends;
   for (const auto& el : status.topic_statistics)
   {
-    addDepend(el);
+    if (el.node_pub != el.node_sub)
+    {
+      depends.emplace(el.node_sub, el.node_pub);
+    }
+  }
+  if (depends == depends_)
+  {
+    return;
+  }
+  for (const auto& depend : depends_)
+  {
+    if (depends.count(depend) == 0)
+    {
+      removeDepend(depend);
+    }
   }
+  for (const auto& depend : depends)
+  {
+    if (depends_.count(depend) == 0)
+    {
+      addDepend(depend);
+    }
+  }
+  depends_.swap(depends);
 }
 
 void HealthAnalyzer::writeDot()
@@ -209,46 +272,47 @@ void HealthAnalyzer::writeDot()
 boost::optional<HealthAnalyzer::vertex_t>
   HealthAnalyzer::getTargetNode(const std::string& target_node)
 {
-  vertex_t ret;
-  auto vertex_range = boost::vertices(depend_graph_);
-  for (auto first = vertex_range.first, last = vertex_range.second;
-       first != last; ++first)
+  const auto result = vertex_index_.find(target_node);
+  if (result == vertex_index_.end())
   {
-    vertex_t v = *first;
-    if (depend_graph_[v].node_name == target_node)
-    {
-      ret = v;
-      return ret;
-    }
+    return boost::none;
   }
-  return boost::none;
+  return result->second;
 }
 
-void HealthAnalyzer::addDepend(
-  const rosgraph_msgs::TopicStatistics& statistics)
+HealthAnalyzer::vertex_t
+  HealthAnalyzer::getOrAddVertex(const std::string& node_name)
 {
-  if (statistics.node_pub == statistics.node_sub)
+  const auto vertex = getTargetNode(node_name);
+  if (vertex)
   {
-    return;
+    return vertex.get();
   }
-  vertex_t node_sub;
-  vertex_t node_pub;
+  const vertex_t added = boost::add_vertex(depend_graph_);
+  depend_graph_[added].node_name = node_name;
+  vertex_index_.emplace(node_name, added);
+  return added;
+}
+
+void HealthAnalyzer::addDepend(const Depend& depend)
+{
+  const vertex_t sub_vertex = getOrAddVertex(depend.first);
+  const vertex_t pub_vertex = getOrAddVertex(depend.second);
   edge_t topic;
-  auto pub_vertex = getTargetNode(statistics.node_pub);
-  auto sub_vertex = getTargetNode(statistics.node_sub);
-  if (!pub_vertex)
-  {
-    pub_vertex = boost::add_vertex(depend_graph_);
-    depend_graph_[pub_vertex.get()].node_name = statistics.node_pub;
-  }
-  if (!sub_vertex)
-  {
-    sub_vertex = boost::add_vertex(depend_graph_);
-    depend_graph_[sub_vertex.get()].node_name = statistics.node_sub;
-  }
   bool inserted = false;
   boost::tie(topic, inserted) =
-    boost::add_edge(sub_vertex.get(), pub_vertex.get(), depend_graph_);
-  depend_graph_[topic].node_sub = statistics.node_sub;
-  depend_graph_[topic].node_pub = statistics.node_pub;
+    boost::add_edge(sub_vertex, pub_vertex, depend_graph_);
+  depend_graph_[topic].node_sub = depend.first;
+  depend_graph_[topic].node_pub = depend.second;
+  setDirty(depend.first);
+  setDirty(depend.second);
+}
+
+void HealthAnalyzer::removeDepend(const Depend& depend)
+{
+  // the subscribers of both are marked before the edge goes
+  setDirty(depend.first);
+  setDirty(depend.second);
+  boost::remove_edge(vertex_index_.at(depend.first),
+    vertex_index_.at(depend.second), depend_graph_);
 }
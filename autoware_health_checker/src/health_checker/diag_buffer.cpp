@@ -20,11 +20,23 @@
 #include <string>
 #include <vector>
 #include <algorithm>
+#include <functional>
+#include <utility>
 #include <autoware_health_checker/health_checker/diag_buffer.h>
 
 namespace autoware_health_checker
 {
 
+constexpr size_t DiagBuffer::LEVEL_COUNT;
+const std::array<ErrorLevel, DiagBuffer::LEVEL_COUNT> DiagBuffer::levels_ =
+{
+  AwDiagStatus::FATAL,
+  AwDiagStatus::ERROR,
+  AwDiagStatus::WARN,
+  AwDiagStatus::OK,
+  AwDiagStatus::UNDEFINED
+};
+
 DiagBuffer::DiagBuffer(ErrorKey key, ErrorType type,
   std::string description, double buffer_duration)
   : type(type)
@@ -35,90 +47,84 @@ DiagBuffer::DiagBuffer(ErrorKey key, ErrorType type,
 void DiagBuffer::addDiag(autoware_system_msgs::DiagnosticStatus status)
 {
   std::lock_guard<std::mutex> lock(mtx_);
-  buffer_[status.level].status.emplace_back(status);
+  const auto level = std::find(levels_.begin(), levels_.end(), status.level);
+  if (level != levels_.end())
+  {
+    // diagnostics mostly come in time order, they are then appended
+    auto& buf = buffer_[level - levels_.begin()];
+    if (buf.empty() || !isOlderTimestamp(status, buf.back()))
+    {
+      buf.emplace_back(std::move(status));
+    }
+    else
+    {
+      const auto pos = std::upper_bound(buf.begin(), buf.end(), status,
+        std::bind(&DiagBuffer::isOlderTimestamp, this,
+        std::placeholders::_1, std::placeholders::_2));
+      buf.emplace(pos, std::move(status));
+    }
+  }
   updateBuffer();
 }
 
 autoware_system_msgs::DiagnosticStatusArray DiagBuffer::getAndClearData()
 {
-  static const std::array<ErrorLevel, 4> level_array =
-  {
-    AwDiagStatus::ERROR,
-    AwDiagStatus::WARN,
-    AwDiagStatus::OK,
-    AwDiagStatus::UNDEFINED
-  };
   std::lock_guard<std::mutex> lock(mtx_);
   updateBuffer();
-  auto data = buffer_.at(AwDiagStatus::FATAL);
-  auto& status = data.status;
-  for (const auto& level : level_array)
+  autoware_system_msgs::DiagnosticStatusArray data;
+  size_t total = 0;
+  for (const auto& buf : buffer_)
   {
-    const auto& buf_status = buffer_.at(level).status;
-    status.insert(status.end(), buf_status.begin(), buf_status.end());
+    total += buf.size();
   }
-  std::sort(status.begin(), status.end(),
-    std::bind(&DiagBuffer::isOlderTimestamp, this,
-    std::placeholders::_1, std::placeholders::_2));
-  buffer_.clear();
-  return data;
-}
+  data.status.reserve(total);
 
-ErrorLevel DiagBuffer::getErrorLevel()
-{
-  static const std::array<ErrorLevel, 4> level_array =
+  // merge of the sorted buffers, the first level wins on equal timestamps
+  std::array<size_t, LEVEL_COUNT> next = {};
+  while (data.status.size() < total)
   {
-    AwDiagStatus::FATAL,
-    AwDiagStatus::ERROR,
-    AwDiagStatus::WARN,
-    AwDiagStatus::OK
-  };
-  std::lock_guard<std::mutex> lock(mtx_);
-  updateBuffer();
-  for (const auto& level : level_array)
-  {
-    if (!buffer_.at(level).status.empty())
+    size_t oldest = LEVEL_COUNT;
+    for (size_t i = 0; i < LEVEL_COUNT; ++i)
     {
-      return level;
+      if (next[i] < buffer_[i].size() && (oldest == LEVEL_COUNT ||
+        isOlderTimestamp(buffer_[i][next[i]], buffer_[oldest][next[oldest]])))
+      {
+        oldest = i;
+      }
     }
+    data.status.emplace_back(std::move(buffer_[oldest][next[oldest]++]));
   }
-  return AwDiagStatus::OK;
+  for (auto& buf : buffer_)
+  {
+    buf.clear();
+  }
+  return data;
 }
 
-// filter data from timestamp and level
-autoware_system_msgs::DiagnosticStatusArray
-DiagBuffer::filterBuffer(ros::Time now, ErrorLevel level)
+ErrorLevel DiagBuffer::getErrorLevel()
 {
-  autoware_system_msgs::DiagnosticStatusArray filtered_data;
-  if (buffer_.count(level) != 0)
-  {
-    filtered_data = buffer_.at(level);
-  }
-  autoware_system_msgs::DiagnosticStatusArray ret;
-  for (const auto& data : filtered_data.status)
+  std::lock_guard<std::mutex> lock(mtx_);
+  updateBuffer();
+  // UNDEFINED is not an error level
+  for (size_t i = 0; i + 1 < LEVEL_COUNT; ++i)
   {
-    if ((data.header.stamp + buffer_duration_) > now)
+    if (!buffer_[i].empty())
     {
-      ret.status.emplace_back(data);
+      return levels_[i];
     }
   }
-  return ret;
+  return AwDiagStatus::OK;
 }
 
 void DiagBuffer::updateBuffer()
 {
-  static const std::array<ErrorLevel, 5> level_array =
-  {
-    AwDiagStatus::FATAL,
-    AwDiagStatus::ERROR,
-    AwDiagStatus::WARN,
-    AwDiagStatus::OK,
-    AwDiagStatus::UNDEFINED
-  };
   ros::Time now = ros::Time::now();
-  for (const auto& level : level_array)
+  for (auto& buf : buffer_)
   {
-    buffer_[level] = filterBuffer(now, level);
+    while (!buf.empty() && (buf.front().header.stamp + buffer_duration_) <= now)
+    {
+      buf.pop_front();
+    }
   }
 }
 
@@ -17,21 +17,62 @@
  * v1.0 Masaya Kataoka
  */
 
+#include <functional>
 #include <string>
 #include <vector>
 #include <autoware_health_checker/health_checker/health_checker.h>
 
 namespace autoware_health_checker
 {
+namespace
+{
+// checks of the thread being timed, CHECK_* call SET_DIAG_STATUS
+thread_local int profile_depth = 0;
+}  // namespace
+
+HealthChecker::ProfileScope::ProfileScope(HealthChecker& checker)
+  : checker_(checker.profile_ ? &checker : nullptr)
+{
+  if (checker_ && profile_depth++ == 0)
+  {
+    start_ = std::chrono::steady_clock::now();
+  }
+}
+
+HealthChecker::ProfileScope::~ProfileScope()
+{
+  if (!checker_ || --profile_depth != 0)
+  {
+    return;
+  }
+  const uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now() - start_).count();
+  checker_->check_ns_ += ns;
+  checker_->check_calls_++;
+  updateMax(checker_->max_check_ns_, ns);
+}
+
 HealthChecker::HealthChecker(ros::NodeHandle nh, ros::NodeHandle pnh)
   : value_manager_(nh, pnh)
   , node_activated_(false)
   , nh_(nh)
   , pnh_(pnh)
+  , shm_writer_(ros::this_node::getName())
   , is_shutdown_(false)
+  , check_calls_(0)
+  , check_ns_(0)
+  , max_check_ns_(0)
+  , publish_cycles_(0)
+  , publish_ns_(0)
+  , max_publish_ns_(0)
 {
+  nh_.param<bool>("health_checker_profile", profile_, false);
+  nh_.param<double>(
+    "health_checker_budget", overhead_budget_, DEFAULT_OVERHEAD_BUDGET);
   status_pub_ =
     nh_.advertise<autoware_system_msgs::NodeStatus>("node_status", 10);
+  emergency_pub_ = nh_.advertise<autoware_system_msgs::NodeStatus>(
+    "emergency_node_status", 10);
 }
 
 HealthChecker::~HealthChecker()
@@ -47,10 +88,11 @@ void HealthChecker::publishStatus()
 {
   const int loop_usec =
     std::round(1.0 / autoware_health_checker::NODE_STATUS_UPDATE_RATE * 1e6);
-  const std::string node_name = ros::this_node::getName();
 
   auto prev_time = std::chrono::system_clock::now();
   ros::Time prev_ros_time = ros::Time::now();
+  auto prev_cycle_start = std::chrono::steady_clock::now();
+  OverheadStats prev_stats = getOverheadStats();
   while (ros::ok() && !is_shutdown_.load())
   {
     const auto until_time = prev_time + std::chrono::microseconds(loop_usec);
@@ -64,42 +106,78 @@ void HealthChecker::publishStatus()
     }
     prev_ros_time = now;
 
-    autoware_system_msgs::NodeStatus status;
-    status.node_name = node_name;
-
-    status.node_activated = node_activated_;
-    status.header.stamp = now;
-    std::lock_guard<std::mutex> lock(mtx_);
-    const auto checker_keys = getRateCheckerKeys();
-    // iterate Rate checker and publish rate_check result
-    for (const auto& key : checker_keys)
+    const auto cycle_start = std::chrono::steady_clock::now();
+    autoware_system_msgs::NodeStatus status = collectStatus(now);
+    if (profile_)
+    {
+      const std::chrono::duration<double, std::micro> elapsed =
+        cycle_start - prev_cycle_start;
+      status.status.emplace_back(
+        getOverheadStatus(now, prev_stats, elapsed.count()));
+      prev_stats = getOverheadStats();
+    }
+    prev_cycle_start = cycle_start;
+    if (!shm_writer_.write(status))
     {
-      const auto result = rate_checkers_[key]->getErrorLevelAndRate();
-      if (result)
-      {
-        AwDiagStatusArray diag_array;
-        AwDiagStatus diag = setValueCommon(
-          key, result->second, rate_checkers_.at(key)->description);
-        diag.header.stamp = now;
-        diag.level = result->first;
-        diag.type = AwDiagStatus::UNEXPECTED_RATE;
-        diag_array.status.emplace_back(diag);
-        status.status.emplace_back(diag_array);
-      }
+      status_pub_.publish(status);
     }
-    // iterate Diagnostic Buffer and publish all diagnostic data
-    const auto keys = getKeys();
-    for (const auto& key : keys)
+    if (profile_)
+    {
+      const uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - cycle_start).count();
+      publish_ns_ += ns;
+      publish_cycles_++;
+      updateMax(max_publish_ns_, ns);
+    }
+  }
+}
+
+autoware_system_msgs::NodeStatus HealthChecker::collectStatus(
+  const ros::Time& now)
+{
+  static const std::string node_name = ros::this_node::getName();
+  autoware_system_msgs::NodeStatus status;
+  status.node_name = node_name;
+
+  status.node_activated = node_activated_;
+  status.header.stamp = now;
+  std::lock_guard<std::mutex> lock(mtx_);
+  const auto checker_keys = getRateCheckerKeys();
+  // iterate Rate checker and publish rate_check result
+  for (const auto& key : checker_keys)
+  {
+    const auto result = rate_checkers_[key]->getErrorLevelAndRate();
+    if (result)
     {
-      status.status.emplace_back(diag_buffers_.at(key)->getAndClearData());
+      AwDiagStatusArray diag_array;
+      AwDiagStatus diag = setValueCommon(
+        key, result->second, rate_checkers_.at(key)->description);
+      diag.header.stamp = now;
+      diag.level = result->first;
+      diag.type = AwDiagStatus::UNEXPECTED_RATE;
+      diag_array.status.emplace_back(diag);
+      status.status.emplace_back(diag_array);
     }
-    status_pub_.publish(status);
   }
+  // iterate Diagnostic Buffer and publish all diagnostic data
+  const auto keys = getKeys();
+  for (const auto& key : keys)
+  {
+    status.status.emplace_back(diag_buffers_.at(key)->getAndClearData());
+  }
+  // harvest the registered checks, then refresh their thresholds
+  for (const auto& checker : value_checkers_)
+  {
+    status.status.emplace_back(checker.second->getAndClearData());
+    updateValueChecker(*checker.second);
+  }
+  return status;
 }
 
 ErrorLevel HealthChecker::SET_DIAG_STATUS(
   const autoware_system_msgs::DiagnosticStatus& status)
 {
+  ProfileScope scope(*this);
   value_manager_.addCandidate(status.key);
   if (value_manager_.isNotFound(status.key))
   {
@@ -117,13 +195,47 @@ ErrorLevel HealthChecker::SET_DIAG_STATUS(
   std::lock_guard<std::mutex> lock(mtx_);
   addNewBuffer(status.key, status.type, status.description);
   diag_buffers_.at(status.key)->addDiag(status);
+  updateEmergency(status);
   return status.level;
 }
 
+// ERROR and FATAL are also sent at once, bypassing the node status rate
+// and the aggregation, when the level of the key becomes one of them
+void HealthChecker::updateEmergency(const AwDiagStatus& status)
+{
+  if (status.level != AwDiagStatus::ERROR &&
+    status.level != AwDiagStatus::FATAL)
+  {
+    emergency_keys_.erase(status.key);
+  }
+  else if (emergency_keys_.emplace(status.key).second)
+  {
+    publishEmergency(status);
+  }
+}
+
+void HealthChecker::publishEmergency(const AwDiagStatus& status)
+{
+  if (!node_activated_)
+  {
+    return;
+  }
+  autoware_system_msgs::NodeStatus node_status;
+  static const std::string node_name = ros::this_node::getName();
+  node_status.node_name = node_name;
+  node_status.node_activated = true;
+  node_status.header.stamp = status.header.stamp;
+  AwDiagStatusArray diag_array;
+  diag_array.status.emplace_back(status);
+  node_status.status.emplace_back(diag_array);
+  emergency_pub_.publish(node_status);
+}
+
 ErrorLevel HealthChecker::CHECK_TRUE(
   const ErrorKey& key, const bool value,
   const ErrorLevel level, const std::string& description)
 {
+  ProfileScope scope(*this);
   value_manager_.addCandidate(key);
   if (value_manager_.isNotFound(key))
   {
@@ -187,6 +299,7 @@ ErrorLevel HealthChecker::CHECK_MIN_VALUE(const ErrorKey& key,
   const double value, const double warn_value, const double error_value,
   const double fatal_value, const std::string& description)
 {
+  ProfileScope scope(*this);
   value_manager_.addCandidate(key);
   if (value_manager_.isNotFound(key))
   {
@@ -212,6 +325,7 @@ ErrorLevel HealthChecker::CHECK_MAX_VALUE(const ErrorKey& key,
   const double value, const double warn_value, const double error_value,
   const double fatal_value, const std::string& description)
 {
+  ProfileScope scope(*this);
   value_manager_.addCandidate(key);
   if (value_manager_.isNotFound(key))
   {
@@ -237,6 +351,7 @@ ErrorLevel HealthChecker::CHECK_RANGE(const ErrorKey& key,
   const double value, const MinMax warn_value, const MinMax error_value,
   const MinMax fatal_value, const std::string& description)
 {
+  ProfileScope scope(*this);
   value_manager_.addCandidate(key);
   if (value_manager_.isNotFound(key))
   {
@@ -264,6 +379,7 @@ void HealthChecker::CHECK_RATE(const ErrorKey& key,
   const double warn_rate, const double error_rate,
   const double fatal_rate, const std::string& description)
 {
+  ProfileScope scope(*this);
   value_manager_.addCandidate(key);
   if (value_manager_.isNotFound(key))
   {
@@ -286,6 +402,169 @@ void HealthChecker::CHECK_RATE(const ErrorKey& key,
   addNewBuffer(key, AwDiagStatus::UNEXPECTED_RATE, description);
 }
 
+ValueCheckerPtr HealthChecker::registerMinValue(const ErrorKey& key,
+  const double warn_value, const double error_value,
+  const double fatal_value, const std::string& description)
+{
+  value_manager_.setDefaultValue(
+    key, "min", warn_value, error_value, fatal_value);
+  auto checker = registerValueChecker(
+    key, AwDiagStatus::OUT_OF_RANGE, description, false);
+  checker->setMinValue(warn_value, error_value, fatal_value);
+  updateValueChecker(*checker);
+  return checker;
+}
+
+ValueCheckerPtr HealthChecker::registerMaxValue(const ErrorKey& key,
+  const double warn_value, const double error_value,
+  const double fatal_value, const std::string& description)
+{
+  value_manager_.setDefaultValue(
+    key, "max", warn_value, error_value, fatal_value);
+  auto checker = registerValueChecker(
+    key, AwDiagStatus::OUT_OF_RANGE, description, false);
+  checker->setMaxValue(warn_value, error_value, fatal_value);
+  updateValueChecker(*checker);
+  return checker;
+}
+
+ValueCheckerPtr HealthChecker::registerRange(const ErrorKey& key,
+  const MinMax warn_value, const MinMax error_value,
+  const MinMax fatal_value, const std::string& description)
+{
+  value_manager_.setDefaultValue(key, "min", warn_value.first,
+    error_value.first, fatal_value.first);
+  value_manager_.setDefaultValue(key, "max", warn_value.second,
+    error_value.second, fatal_value.second);
+  auto checker = registerValueChecker(
+    key, AwDiagStatus::OUT_OF_RANGE, description, false);
+  checker->setMinValue(warn_value.first, error_value.first, fatal_value.first);
+  checker->setMaxValue(
+    warn_value.second, error_value.second, fatal_value.second);
+  updateValueChecker(*checker);
+  return checker;
+}
+
+ValueCheckerPtr HealthChecker::registerTrue(
+  const ErrorKey& key, const std::string& description)
+{
+  auto checker = registerValueChecker(
+    key, AwDiagStatus::INVALID_VALUE, description, true);
+  updateValueChecker(*checker);
+  return checker;
+}
+
+ValueCheckerPtr HealthChecker::registerValueChecker(const ErrorKey& key,
+  const ErrorType type, const std::string& description,
+  const bool boolean_value)
+{
+  value_manager_.addCandidate(key);
+  std::lock_guard<std::mutex> lock(mtx_);
+  auto& checker = value_checkers_[key];
+  if (!checker)
+  {
+    checker = std::make_shared<ValueChecker>(
+      key, type, description, boolean_value);
+    checker->setAlarmCallback(
+      std::bind(&HealthChecker::publishEmergency, this, std::placeholders::_1));
+  }
+  return checker;
+}
+
+// thresholds of the parameters if they are set, default ones otherwise
+void HealthChecker::updateValueChecker(ValueChecker& checker)
+{
+  const bool enabled = !value_manager_.isNotFound(checker.key);
+  checker.setEnabled(enabled);
+  if (!enabled)
+  {
+    return;
+  }
+  auto get_values = [this, &checker](const ThreshType& thresh_type)
+  {
+    return std::array<boost::optional<double>, 3>
+    {
+      value_manager_.getValue(checker.key, thresh_type, AwDiagStatus::WARN),
+      value_manager_.getValue(checker.key, thresh_type, AwDiagStatus::ERROR),
+      value_manager_.getValue(checker.key, thresh_type, AwDiagStatus::FATAL)
+    };
+  };
+  // the parameters can be gone since isNotFound()
+  if (checker.hasMinValue())
+  {
+    const auto values = get_values("min");
+    if (values[0] && values[1] && values[2])
+    {
+      checker.setMinValue(values[0].get(), values[1].get(), values[2].get());
+    }
+  }
+  if (checker.hasMaxValue())
+  {
+    const auto values = get_values("max");
+    if (values[0] && values[1] && values[2])
+    {
+      checker.setMaxValue(values[0].get(), values[1].get(), values[2].get());
+    }
+  }
+}
+
+void HealthChecker::updateMax(
+  std::atomic<uint64_t>& max_ns, const uint64_t ns)
+{
+  uint64_t prev = max_ns.load();
+  while (prev < ns && !max_ns.compare_exchange_weak(prev, ns))
+  {
+  }
+}
+
+OverheadStats HealthChecker::getOverheadStats() const
+{
+  OverheadStats stats;
+  stats.calls = check_calls_.load();
+  stats.check_us = check_ns_.load() * 1e-3;
+  stats.max_check_us = max_check_ns_.load() * 1e-3;
+  stats.cycles = publish_cycles_.load();
+  stats.publish_us = publish_ns_.load() * 1e-3;
+  stats.max_publish_us = max_publish_ns_.load() * 1e-3;
+  return stats;
+}
+
+// share of the wall time spent in the checks since the previous cycle,
+// WARN over health_checker_budget. Not looked up in the thresholds, the
+// parameter enables it.
+HealthChecker::AwDiagStatusArray HealthChecker::getOverheadStatus(
+  const ros::Time& now, const OverheadStats& prev_stats,
+  const double elapsed_us) const
+{
+  const OverheadStats stats = getOverheadStats();
+  const double check_us = stats.check_us - prev_stats.check_us;
+  const uint64_t cycles = stats.cycles - prev_stats.cycles;
+  const double ratio = (elapsed_us > 0.0) ? check_us / elapsed_us : 0.0;
+  boost::property_tree::ptree pt;
+  pt.put("ratio", ratio);
+  pt.put("budget", overhead_budget_);
+  pt.put("calls", stats.calls - prev_stats.calls);
+  pt.put("check_us", check_us);
+  pt.put("max_check_us", stats.max_check_us);
+  pt.put("publish_us", (cycles > 0) ?
+    (stats.publish_us - prev_stats.publish_us) / cycles : 0.0);
+  pt.put("max_publish_us", stats.max_publish_us);
+  std::stringstream ss;
+  write_json(ss, pt);
+
+  AwDiagStatus diag;
+  diag.header.stamp = now;
+  diag.key = HEALTH_CHECKER_OVERHEAD_KEY;
+  diag.value = ss.str();
+  diag.description = "time spent by the health checker";
+  diag.type = AwDiagStatus::OUT_OF_RANGE;
+  diag.level = (ratio > overhead_budget_) ? AwDiagStatus::WARN :
+    AwDiagStatus::OK;
+  AwDiagStatusArray diag_array;
+  diag_array.status.emplace_back(diag);
+  return diag_array;
+}
+
 template <typename T>
   autoware_system_msgs::DiagnosticStatus HealthChecker::setValueCommon(
     const ErrorKey& key, const T& value, const std::string& desc)
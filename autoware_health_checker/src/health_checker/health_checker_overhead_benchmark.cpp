@@ -0,0 +1,161 @@
+/*
+ * Copyright 2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Measures what a node pays for its health checker: the time of one call of each CHECK_* and of a
+// registered check, then the time of the status thread while the node checks all its keys at a
+// callback rate. The time is read from the profile mode (health_checker_profile), which is also
+// measured against the checks without it. The checker reads its thresholds from the master.
+//
+// usage: roslaunch autoware_health_checker health_checker_overhead_benchmark.launch
+//   [keys:=<keys per check>] [iterations:=<calls per check>] [rate:=<callback rate>] [duration:=<s>]
+
+#include <ros/ros.h>
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+#include <autoware_health_checker/health_checker/health_checker.h>
+
+namespace
+{
+using autoware_health_checker::HealthChecker;
+using autoware_health_checker::ValueCheckerPtr;
+using AwDiagStatus = autoware_system_msgs::DiagnosticStatus;
+
+std::vector<std::string> createKeys(const std::string& prefix, const int keys)
+{
+  std::vector<std::string> names;
+  for (int i = 0; i < keys; i++)
+  {
+    names.emplace_back(prefix + std::to_string(i));
+    // monitored with the default thresholds
+    ros::param::set("health_checker/" + names.back(), "default");
+  }
+  return names;
+}
+
+// nanoseconds per call, the keys are checked in turn
+double measure(const int keys, const int iterations, const std::function<void(int, double)>& check)
+{
+  const auto start = std::chrono::steady_clock::now();
+  for (int n = 0; n < iterations; n++)
+  {
+    check(n % keys, (n % 100) * 0.01);
+  }
+  const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+  return elapsed.count() / iterations;
+}
+
+void runChecks(HealthChecker& checker, const std::vector<std::string>& min_keys,
+               const std::vector<std::string>& max_keys, const std::vector<std::string>& rate_keys,
+               const int iterations)
+{
+  const double min_ns = measure(min_keys.size(), iterations, [&](int i, double value) {
+    checker.CHECK_MIN_VALUE(min_keys[i], value, -1.0, -2.0, -3.0, "min");
+  });
+  const double max_ns = measure(max_keys.size(), iterations, [&](int i, double value) {
+    checker.CHECK_MAX_VALUE(max_keys[i], value, 1.0, 2.0, 3.0, "max");
+  });
+  const double range_ns = measure(max_keys.size(), iterations, [&](int i, double value) {
+    checker.CHECK_RANGE(max_keys[i], value, { -1.0, 1.0 }, { -2.0, 2.0 }, { -3.0, 3.0 }, "range");  // NOLINT
+  });
+  const double true_ns = measure(min_keys.size(), iterations, [&](int i, double value) {
+    checker.CHECK_TRUE(min_keys[i], value < 1.0, AwDiagStatus::OK, "true");
+  });
+  const double rate_ns = measure(rate_keys.size(), iterations, [&](int i, double value) {
+    checker.CHECK_RATE(rate_keys[i], 5.0, 3.0, 1.0, "rate");
+  });
+  std::cout << "  CHECK_MIN_VALUE: " << min_ns << " ns" << std::endl
+            << "  CHECK_MAX_VALUE: " << max_ns << " ns" << std::endl
+            << "  CHECK_RANGE: " << range_ns << " ns" << std::endl
+            << "  CHECK_TRUE: " << true_ns << " ns" << std::endl
+            << "  CHECK_RATE: " << rate_ns << " ns" << std::endl;
+}
+}  // namespace
+
+int main(int argc, char** argv)
+{
+  ros::init(argc, argv, "health_checker_overhead_benchmark");
+  ros::NodeHandle nh;
+  ros::NodeHandle pnh("~");
+  int keys, iterations;
+  double rate, duration;
+  pnh.param<int>("keys", keys, 10);
+  pnh.param<int>("iterations", iterations, 100000);
+  pnh.param<double>("rate", rate, 100.0);
+  pnh.param<double>("duration", duration, 5.0);
+  if (keys <= 0 || iterations <= 0 || rate <= 0.0 || duration <= 0.0)
+  {
+    ROS_FATAL("keys, iterations, rate and duration must be positive");
+    return 1;
+  }
+
+  const auto min_keys = createKeys("benchmark_min_", keys);
+  const auto max_keys = createKeys("benchmark_max_", keys);
+  const auto rate_keys = createKeys("benchmark_rate_", keys);
+  const auto handle_keys = createKeys("benchmark_handle_", keys);
+
+  std::cout << keys << " keys per check, " << iterations << " calls per check" << std::endl;
+  {
+    HealthChecker checker(nh, pnh);
+    checker.NODE_ACTIVATE();
+    std::cout << "per call:" << std::endl;
+    runChecks(checker, min_keys, max_keys, rate_keys, iterations);
+  }
+
+  ros::param::set("health_checker_profile", true);
+  HealthChecker checker(nh, pnh);
+  ros::param::set("health_checker_profile", false);
+  checker.NODE_ACTIVATE();
+  std::cout << "per call, profiled:" << std::endl;
+  runChecks(checker, min_keys, max_keys, rate_keys, iterations);
+
+  std::vector<ValueCheckerPtr> handles;
+  for (const auto& key : handle_keys)
+  {
+    handles.emplace_back(checker.registerMaxValue(key, 1.0, 2.0, 3.0, "handle"));
+  }
+  const double handle_ns = measure(keys, iterations, [&handles](int i, double value) { handles[i]->check(value); });
+  std::cout << "  registered check: " << handle_ns << " ns" << std::endl;
+
+  // a node checking each of its keys in its callbacks while the status thread runs
+  const auto before = checker.getOverheadStats();
+  checker.ENABLE();
+  ros::Rate loop_rate(rate);
+  const ros::WallTime end = ros::WallTime::now() + ros::WallDuration(duration);
+  const auto start = std::chrono::steady_clock::now();
+  while (ros::ok() && ros::WallTime::now() < end)
+  {
+    for (int i = 0; i < keys; i++)
+    {
+      checker.CHECK_MAX_VALUE(max_keys[i], 0.5, 1.0, 2.0, 3.0, "max");
+      checker.CHECK_RATE(rate_keys[i], 5.0, 3.0, 1.0, "rate");
+      handles[i]->check(0.5);
+    }
+    loop_rate.sleep();
+  }
+  const std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+  const auto after = checker.getOverheadStats();
+  const uint64_t cycles = after.cycles - before.cycles;
+  std::cout << "at " << rate << " Hz for " << duration << " s:" << std::endl
+            << "  checks: " << (after.check_us - before.check_us) / elapsed.count() * 100.0 << " % of the time, "
+            << after.calls - before.calls << " calls, max " << after.max_check_us << " us" << std::endl
+            << "  status cycle: " << ((cycles > 0) ? (after.publish_us - before.publish_us) / cycles : 0.0)
+            << " us, max " << after.max_publish_us << " us, " << cycles << " cycles" << std::endl;
+  return 0;
+}
@@ -19,11 +19,37 @@
 
 namespace autoware_health_checker
 {
+namespace
+{
+boost::optional<double> toDouble(XmlRpc::XmlRpcValue& value)
+{
+  if (value.getType() == XmlRpc::XmlRpcValue::TypeDouble)
+  {
+    return static_cast<double>(value);
+  }
+  if (value.getType() == XmlRpc::XmlRpcValue::TypeInt)
+  {
+    return static_cast<double>(static_cast<int>(value));
+  }
+  return boost::none;
+}
+}  // namespace
 
 ParamManager::ParamManager(ros::NodeHandle nh, ros::NodeHandle pnh)
-  : nh_(nh), pnh_(pnh)
+  : nh_(nh), pnh_(pnh), table_(nullptr)
 {
-  nh_.getParam("health_checker", params_);
+  // the parameter tree is resolved into a table when it changes, and the
+  // master pushes its changes instead of being asked for the tree every second
+  nh_.param<bool>("health_checker_param_table", use_table_, false);
+  if (use_table_)
+  {
+    nh_.getParamCached("health_checker", params_);
+    updateTable(params_);
+  }
+  else
+  {
+    nh_.getParam("health_checker", params_);
+  }
   get_timer_ =
     nh_.createTimer(ros::Duration(1.0), &ParamManager::getParams, this);
   set_timer_ =
@@ -38,12 +64,21 @@ void ParamManager::addCandidate(const ErrorKey& key)
 
 bool ParamManager::isNotFound(const ErrorKey& key)
 {
+  if (const auto table = getTable())
+  {
+    return table->thresholds.count(key) == 0;
+  }
   std::lock_guard<std::mutex> lock(param_mtx_);
   return !params_.valid() || !params_.hasMember(key);
 }
 
 bool ParamManager::isNotFound(const ErrorKey& ns, const ErrorKey& key)
 {
+  if (const auto table = getTable())
+  {
+    const auto found = table->members.find(ns);
+    return found == table->members.end() || found->second.count(key) == 0;
+  }
   std::lock_guard<std::mutex> lock(param_mtx_);
   return !params_.valid() || !params_.hasMember(ns)
     ? true : !params_[ns].hasMember(key);
@@ -55,9 +90,27 @@ const XmlRpc::XmlRpcValue& ParamManager::getParams()
   return params_;
 }
 
+const ParamTable* ParamManager::getTable() const
+{
+  return table_.load(std::memory_order_acquire);
+}
+
 void ParamManager::getParams(const ros::TimerEvent& event)
 {
   XmlRpc::XmlRpcValue param;
+  if (use_table_)
+  {
+    // answered from the cache of roscpp until the master pushes an update
+    nh_.getParamCached("health_checker", param);
+    std::lock_guard<std::mutex> lock(param_mtx_);
+    if (param == params_)
+    {
+      return;
+    }
+    params_ = param;
+    updateTable(params_);
+    return;
+  }
   nh_.getParam("health_checker", param);
   // Even if it is delayed at the time of getParam(),
   // it is necessary to prevent the delay from affecting getValue().
@@ -65,6 +118,43 @@ void ParamManager::getParams(const ros::TimerEvent& event)
   params_ = param;
 }
 
+void ParamManager::updateTable(const XmlRpc::XmlRpcValue& params)
+{
+  std::unique_ptr<ParamTable> table(new ParamTable());
+  // the accessors of XmlRpcValue are not const
+  XmlRpc::XmlRpcValue tree = params;
+  if (tree.getType() == XmlRpc::XmlRpcValue::TypeStruct)
+  {
+    const char* level_names[] = { "warn", "error", "fatal" };
+    for (auto& param : tree)
+    {
+      auto& thresholds = table->thresholds[param.first];
+      if (param.second.getType() != XmlRpc::XmlRpcValue::TypeStruct)
+      {
+        continue;
+      }
+      auto& members = table->members[param.first];
+      for (auto& member : param.second)
+      {
+        members.emplace(member.first);
+        if (member.second.getType() != XmlRpc::XmlRpcValue::TypeStruct)
+        {
+          continue;
+        }
+        auto& values = thresholds[member.first];
+        for (size_t i = 0; i < values.size(); i++)
+        {
+          if (member.second.hasMember(level_names[i]))
+          {
+            values[i] = toDouble(member.second[level_names[i]]);
+          }
+        }
+      }
+    }
+  }
+  table_.store(table.get(), std::memory_order_release);
+  tables_.emplace_back(std::move(table));
+}
 void ParamManager::setParams(const ros::TimerEvent& event)
 {
   std::set<ErrorKey> keys;
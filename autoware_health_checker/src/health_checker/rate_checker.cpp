@@ -17,18 +17,29 @@
  * v1.0 Masaya Kataoka
  */
 
+#include <algorithm>
 #include <string>
 #include <vector>
 #include <autoware_health_checker/health_checker/rate_checker.h>
 
 namespace autoware_health_checker
 {
+constexpr int64_t RateChecker::BUCKET_COUNT;
+constexpr int RateChecker::COUNT_BITS;
+
 RateChecker::RateChecker(
   double buffer_duration, double warn_rate, double error_rate,
   double fatal_rate, std::string description)
-  : buffer_duration_(buffer_duration), warn_rate_(warn_rate),
+  : buffer_duration_(buffer_duration),
+    bucket_duration_(buffer_duration / BUCKET_COUNT), warn_rate_(warn_rate),
     error_rate_(error_rate), fatal_rate_(fatal_rate),
-    description(description), start_time_(ros::Time::now()) {}
+    description(description), start_time_(ros::Time::now())
+{
+  for (auto& bucket : buckets_)
+  {
+    bucket.store(0);
+  }
+}
 
 boost::optional<LevelRatePair> RateChecker::getErrorLevelAndRate()
 {
@@ -58,8 +69,6 @@ boost::optional<ErrorLevel> RateChecker::getErrorLevel()
 void RateChecker::setRate(
   double warn_rate, double error_rate, double fatal_rate)
 {
-  update();
-  std::lock_guard<std::mutex> lock(mtx_);
   warn_rate_ = warn_rate;
   error_rate_ = error_rate;
   fatal_rate_ = fatal_rate;
@@ -67,35 +76,52 @@ void RateChecker::setRate(
 
 void RateChecker::check()
 {
-  update();
-  std::lock_guard<std::mutex> lock(mtx_);
-  data_.emplace_back(ros::Time::now());
+  const uint64_t index = getBucketIndex(ros::Time::now());
+  auto& bucket = buckets_[index % buckets_.size()];
+  uint64_t value = bucket.load();
+  uint64_t next;
+  do
+  {
+    // a bucket of an older index is out of the window, it starts over
+    next = ((value >> COUNT_BITS) == index) ?
+      value + 1 : ((index << COUNT_BITS) | 1);
+  } while (!bucket.compare_exchange_weak(value, next));
 }
 
-void RateChecker::update()
+int64_t RateChecker::getBucketIndex(const ros::Time& time) const
 {
-  std::lock_guard<std::mutex> lock(mtx_);
-  std::vector<ros::Time> buffer;
-  for (const auto& el : data_)
-  {
-    if (el + ros::Duration(buffer_duration_) > ros::Time::now())
-    {
-      buffer.emplace_back(el);
-    }
-  }
-  data_ = buffer;
+  // time can go back with the simulated time
+  const double elapsed = std::max((time - start_time_).toSec(), 0.0);
+  return static_cast<int64_t>(elapsed / bucket_duration_);
 }
 
 boost::optional<double> RateChecker::getRate()
 {
-  boost::optional<double> rate;
-  if (ros::Time::now() < start_time_ + ros::Duration(buffer_duration_))
+  const ros::Time now = ros::Time::now();
+  if (now < start_time_ + ros::Duration(buffer_duration_))
   {
     return boost::none;
   }
-  update();
-  std::lock_guard<std::mutex> lock(mtx_);
-  rate = data_.size() / buffer_duration_;
-  return rate;
+  const int64_t index = getBucketIndex(now);
+  const uint64_t count_mask = (uint64_t(1) << COUNT_BITS) - 1;
+  double count = 0.0;
+  for (const auto& bucket : buckets_)
+  {
+    const uint64_t value = bucket.load();
+    const int64_t age = index - static_cast<int64_t>(value >> COUNT_BITS);
+    if (age < 0 || age > BUCKET_COUNT)
+    {
+      continue;
+    }
+    double weight = 1.0;
+    if (age == BUCKET_COUNT)
+    {
+      // the oldest bucket counts for the part of it still in the window
+      const double elapsed = std::max((now - start_time_).toSec(), 0.0);
+      weight = 1.0 - (elapsed / bucket_duration_ - index);
+    }
+    count += weight * (value & count_mask);
+  }
+  return count / buffer_duration_;
 }
 }  // namespace autoware_health_checker
@@ -0,0 +1,250 @@
+/*
+ * Copyright 2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *
+ * v1.0 Masaya Kataoka
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <new>
+#include <string>
+#include <vector>
+#include <autoware_health_checker/health_checker/shm_node_status.h>
+#include <ros/serialization.h>
+
+#include <boost/interprocess/sync/scoped_lock.hpp>
+
+namespace autoware_health_checker
+{
+namespace
+{
+using boost::interprocess::interprocess_exception;
+using boost::interprocess::interprocess_mutex;
+using boost::interprocess::managed_shared_memory;
+using boost::interprocess::scoped_lock;
+
+constexpr const char* SHM_NODE_STATUS_DIRECTORY = "directory";
+
+int64_t getSteadyNSec()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+uint8_t* getSlotData(ShmNodeStatusRing* ring, const uint64_t slot,
+  const uint32_t slot_capacity)
+{
+  return reinterpret_cast<uint8_t*>(ring) + sizeof(ShmNodeStatusRing) +
+    slot * slot_capacity;
+}
+}  // namespace
+
+std::string getShmNodeStatusName()
+{
+  return "AwNodeStatus_" +
+    std::to_string(std::hash<std::string>()(ros::master::getURI()));
+}
+
+ShmNodeStatusWriter::ShmNodeStatusWriter(const std::string& node_name)
+  : node_name_(node_name), directory_(nullptr), ring_(nullptr),
+    next_attempt_(std::chrono::steady_clock::now())
+{
+}
+
+ShmNodeStatusWriter::~ShmNodeStatusWriter()
+{
+  if (ring_)
+  {
+    ring_->closed.store(true);
+  }
+}
+
+bool ShmNodeStatusWriter::attemptToOpen()
+{
+  if (node_name_.size() >= SHM_NODE_STATUS_NAME_LENGTH)
+  {
+    return false;
+  }
+  try
+  {
+    shm_.reset(new managed_shared_memory(
+      boost::interprocess::open_only, getShmNodeStatusName().c_str()));
+    directory_ =
+      shm_->find<ShmNodeStatusDirectory>(SHM_NODE_STATUS_DIRECTORY).first;
+    if (!directory_)
+    {
+      shm_.reset();
+      return false;
+    }
+    scoped_lock<interprocess_mutex> lock(directory_->mutex);
+    for (uint32_t i = 0; i < directory_->ring_count && !ring_; ++i)
+    {
+      auto ring = static_cast<ShmNodeStatusRing*>(
+        shm_->get_address_from_handle(directory_->rings[i]));
+      if (node_name_ == ring->node_name)
+      {
+        ring_ = ring;
+      }
+    }
+    if (!ring_)
+    {
+      if (directory_->ring_count == SHM_NODE_STATUS_MAX_NODES)
+      {
+        shm_.reset();
+        return false;
+      }
+      void* address = shm_->allocate(sizeof(ShmNodeStatusRing) +
+        SHM_NODE_STATUS_SLOT_COUNT * directory_->slot_capacity, std::nothrow);
+      if (!address)
+      {
+        shm_.reset();
+        return false;
+      }
+      // value initialization clears the counters and sequences
+      ring_ = new (address) ShmNodeStatusRing();
+      std::strncpy(
+        ring_->node_name, node_name_.c_str(), SHM_NODE_STATUS_NAME_LENGTH);
+      directory_->rings[directory_->ring_count++] =
+        shm_->get_handle_from_address(address);
+    }
+    ring_->closed.store(false);
+    return true;
+  }
+  catch (const interprocess_exception& ex)
+  {
+    shm_.reset();
+    ring_ = nullptr;
+    return false;
+  }
+}
+
+bool ShmNodeStatusWriter::isReaderAlive() const
+{
+  const int64_t heartbeat = directory_->heartbeat_nsec.load();
+  return (getSteadyNSec() - heartbeat) * 1e-9 <= SHM_NODE_STATUS_TIMEOUT;
+}
+
+bool ShmNodeStatusWriter::write(const autoware_system_msgs::NodeStatus& status)
+{
+  if (!ring_)
+  {
+    const auto now = std::chrono::steady_clock::now();
+    if (now < next_attempt_)
+    {
+      return false;
+    }
+    next_attempt_ = now + std::chrono::seconds(1);
+    if (!attemptToOpen())
+    {
+      return false;
+    }
+  }
+  if (!isReaderAlive())
+  {
+    return false;
+  }
+  const uint32_t size = ros::serialization::serializationLength(status);
+  if (size > directory_->slot_capacity)
+  {
+    ROS_WARN_THROTTLE(1.0, "node status of %u bytes is published, "
+      "it exceeds the shared memory slot", size);
+    return false;
+  }
+  const uint64_t ticket = ring_->write_ticket.fetch_add(1);
+  const uint64_t slot = ticket % SHM_NODE_STATUS_SLOT_COUNT;
+  ring_->sequence[slot].store(2 * ticket + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  ros::serialization::OStream stream(
+    getSlotData(ring_, slot, directory_->slot_capacity), size);
+  ros::serialization::serialize(stream, status);
+  ring_->size[slot].store(size, std::memory_order_relaxed);
+  ring_->sequence[slot].store(2 * ticket + 2, std::memory_order_release);
+  return true;
+}
+
+ShmNodeStatusReader::ShmNodeStatusReader(
+  const size_t segment_size, const uint32_t slot_capacity)
+  : shm_(boost::interprocess::open_or_create,
+      getShmNodeStatusName().c_str(), segment_size)
+  , directory_(shm_.find_or_construct<ShmNodeStatusDirectory>(
+      SHM_NODE_STATUS_DIRECTORY)(slot_capacity))
+{
+}
+
+std::vector<autoware_system_msgs::NodeStatus> ShmNodeStatusReader::read()
+{
+  directory_->heartbeat_nsec.store(getSteadyNSec());
+  std::vector<ShmNodeStatusDirectory::handle_t> handles;
+  {
+    scoped_lock<interprocess_mutex> lock(directory_->mutex);
+    handles.assign(
+      directory_->rings, directory_->rings + directory_->ring_count);
+  }
+  const uint32_t slot_capacity = directory_->slot_capacity;
+  std::vector<autoware_system_msgs::NodeStatus> statuses;
+  for (const auto& handle : handles)
+  {
+    auto ring =
+      static_cast<ShmNodeStatusRing*>(shm_.get_address_from_handle(handle));
+    if (ring->closed.load())
+    {
+      continue;
+    }
+    const uint64_t write_ticket =
+      ring->write_ticket.load(std::memory_order_acquire);
+    uint64_t& read_ticket = read_tickets_[handle];
+    const uint64_t oldest_ticket = std::max(read_ticket,
+      write_ticket > SHM_NODE_STATUS_SLOT_COUNT ?
+        write_ticket - SHM_NODE_STATUS_SLOT_COUNT : 0);
+    // the latest complete slot, the older ones are overwritten as
+    // the topic callbacks did
+    for (uint64_t ticket = write_ticket; ticket > oldest_ticket; --ticket)
+    {
+      const uint64_t slot = (ticket - 1) % SHM_NODE_STATUS_SLOT_COUNT;
+      const uint64_t sequence =
+        ring->sequence[slot].load(std::memory_order_acquire);
+      const uint32_t size = ring->size[slot].load(std::memory_order_relaxed);
+      if (sequence != 2 * ticket || size > slot_capacity)
+      {
+        continue;
+      }
+      buffer_.resize(size);
+      std::memcpy(buffer_.data(),
+        getSlotData(ring, slot, slot_capacity), size);
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (ring->sequence[slot].load(std::memory_order_relaxed) != sequence)
+      {
+        continue;
+      }
+      autoware_system_msgs::NodeStatus status;
+      try
+      {
+        ros::serialization::IStream stream(buffer_.data(), size);
+        ros::serialization::deserialize(stream, status);
+      }
+      catch (const ros::Exception& ex)
+      {
+        continue;
+      }
+      statuses.emplace_back(status);
+      read_ticket = ticket;
+      break;
+    }
+  }
+  return statuses;
+}
+}  // namespace autoware_health_checker
@@ -0,0 +1,194 @@
+/*
+ * Copyright 2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *
+ * v1.0 Masaya Kataoka
+ */
+
+#include <limits>
+#include <sstream>
+#include <string>
+#include <autoware_health_checker/health_checker/value_checker.h>
+
+#include <boost/property_tree/json_parser.hpp>
+#include <boost/property_tree/ptree.hpp>
+
+namespace autoware_health_checker
+{
+constexpr uint64_t ValueChecker::CAPACITY;
+
+ValueChecker::ValueChecker(const ErrorKey& key, const ErrorType type,
+  const std::string& description, const bool boolean_value)
+  : key(key), type(type), description(description),
+    samples_(new Sample[CAPACITY]), write_ticket_(0), read_ticket_(0),
+    has_min_value_(false), has_max_value_(false), enabled_(false),
+    boolean_value_(boolean_value), alarmed_(false)
+{
+  for (uint64_t i = 0; i < CAPACITY; ++i)
+  {
+    samples_[i].sequence.store(0);
+  }
+  for (auto& value : min_value_)
+  {
+    value.store(-std::numeric_limits<double>::infinity());
+  }
+  for (auto& value : max_value_)
+  {
+    value.store(std::numeric_limits<double>::infinity());
+  }
+}
+
+ErrorLevel ValueChecker::check(const double value)
+{
+  // FATAL, ERROR, WARN as min_value_ and max_value_
+  static const std::array<ErrorLevel, 3> level_array =
+  {
+    AwDiagStatus::FATAL,
+    AwDiagStatus::ERROR,
+    AwDiagStatus::WARN
+  };
+  ErrorLevel level = AwDiagStatus::OK;
+  for (size_t i = 0; i < level_array.size(); ++i)
+  {
+    if (value < min_value_[i].load(std::memory_order_relaxed) ||
+      value > max_value_[i].load(std::memory_order_relaxed))
+    {
+      level = level_array[i];
+      break;
+    }
+  }
+  return check(value, level);
+}
+
+ErrorLevel ValueChecker::check(const double value, const ErrorLevel level)
+{
+  if (!enabled_.load(std::memory_order_relaxed))
+  {
+    return AwDiagStatus::UNDEFINED;
+  }
+  const bool over_error =
+    (level == AwDiagStatus::ERROR || level == AwDiagStatus::FATAL);
+  if (over_error != alarmed_.load(std::memory_order_relaxed) &&
+    alarmed_.exchange(over_error) != over_error &&
+    over_error && alarm_callback_)
+  {
+    alarm_callback_(toStatus(value, level, ros::Time::now()));
+  }
+  const uint64_t ticket = write_ticket_.fetch_add(1);
+  Sample& sample = samples_[ticket % CAPACITY];
+  sample.sequence.store(2 * ticket + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  sample.value.store(value, std::memory_order_relaxed);
+  sample.level.store(level, std::memory_order_relaxed);
+  sample.stamp_nsec.store(ros::Time::now().toNSec(), std::memory_order_relaxed);
+  sample.sequence.store(2 * ticket + 2, std::memory_order_release);
+  return level;
+}
+
+void ValueChecker::setMinValue(
+  double warn_value, double error_value, double fatal_value)
+{
+  has_min_value_ = true;
+  min_value_[0] = fatal_value;
+  min_value_[1] = error_value;
+  min_value_[2] = warn_value;
+}
+
+void ValueChecker::setMaxValue(
+  double warn_value, double error_value, double fatal_value)
+{
+  has_max_value_ = true;
+  max_value_[0] = fatal_value;
+  max_value_[1] = error_value;
+  max_value_[2] = warn_value;
+}
+
+void ValueChecker::setAlarmCallback(const AlarmCallback& callback)
+{
+  alarm_callback_ = callback;
+}
+
+void ValueChecker::setEnabled(bool enabled)
+{
+  enabled_ = enabled;
+}
+
+bool ValueChecker::hasMinValue() const
+{
+  return has_min_value_;
+}
+
+bool ValueChecker::hasMaxValue() const
+{
+  return has_max_value_;
+}
+
+autoware_system_msgs::DiagnosticStatusArray ValueChecker::getAndClearData()
+{
+  autoware_system_msgs::DiagnosticStatusArray data;
+  const uint64_t write_ticket = write_ticket_.load(std::memory_order_acquire);
+  if (write_ticket > read_ticket_ + CAPACITY)
+  {
+    read_ticket_ = write_ticket - CAPACITY;
+  }
+  for (; read_ticket_ < write_ticket; ++read_ticket_)
+  {
+    const Sample& sample = samples_[read_ticket_ % CAPACITY];
+    const uint64_t sequence = sample.sequence.load(std::memory_order_acquire);
+    if (sequence < 2 * read_ticket_ + 2)
+    {
+      // still written, it is harvested next time
+      break;
+    }
+    const double value = sample.value.load(std::memory_order_relaxed);
+    const ErrorLevel level = sample.level.load(std::memory_order_relaxed);
+    ros::Time stamp;
+    stamp.fromNSec(sample.stamp_nsec.load(std::memory_order_relaxed));
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (sample.sequence.load(std::memory_order_relaxed) != sequence ||
+      sequence != 2 * read_ticket_ + 2)
+    {
+      // overwritten by a newer sample while it was read
+      continue;
+    }
+    data.status.emplace_back(toStatus(value, level, stamp));
+  }
+  return data;
+}
+
+autoware_system_msgs::DiagnosticStatus ValueChecker::toStatus(
+  const double value, const ErrorLevel level, const ros::Time& stamp) const
+{
+  std::stringstream ss;
+  boost::property_tree::ptree pt;
+  if (boolean_value_)
+  {
+    pt.put("value", value != 0.0);
+  }
+  else
+  {
+    pt.put("value", value);
+  }
+  write_json(ss, pt);
+  AwDiagStatus status;
+  status.header.stamp = stamp;
+  status.key = key;
+  status.value = ss.str();
+  status.description = description;
+  status.type = type;
+  status.level = level;
+  return status;
+}
+}  // namespace autoware_health_checker
@@ -37,6 +37,10 @@ void ValueManager::setDefaultValue(
 boost::optional<double> ValueManager::getValue(const ErrorKey& key,
   const ThreshType& thresh_type, const ErrorLevel level)
 {
+  if (const auto table = getTable())
+  {
+    return getTableValue(*table, key, thresh_type, level);
+  }
   const std::string level_name =
     (level == AwDiagStatus::WARN) ? "warn" :
     (level == AwDiagStatus::ERROR) ? "error" :
@@ -54,4 +58,26 @@ boost::optional<double> ValueManager::getValue(const ErrorKey& key,
     static_cast<double>(diag_params[key][thresh_type][level_name]) :
     error_details_.at(std::make_pair(category, level));
 }
+
+boost::optional<double> ValueManager::getTableValue(const ParamTable& table,
+  const ErrorKey& key, const ThreshType& thresh_type, const ErrorLevel level)
+{
+  const int index =
+    (level == AwDiagStatus::WARN) ? 0 :
+    (level == AwDiagStatus::ERROR) ? 1 :
+    (level == AwDiagStatus::FATAL) ? 2 :
+    -1;
+  const auto found_key = table.thresholds.find(key);
+  if (index < 0 || found_key == table.thresholds.end())
+  {
+    return boost::none;
+  }
+  const auto found_type = found_key->second.find(thresh_type);
+  if (found_type != found_key->second.end() && found_type->second[index])
+  {
+    return found_type->second[index];
+  }
+  const auto category = std::make_pair(key, thresh_type);
+  return error_details_.at(std::make_pair(category, level));
+}
 }  // namespace autoware_health_checker
@@ -0,0 +1,149 @@
+/*
+ * Copyright 2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Measures the cost of handing one system status to the callbacks of SystemStatusSubscriber, with a copy
+// per callback (addCallback) and with the received status shared by all of them (addSharedCallback).
+// The status is built like the one of health_aggregator: every node reports several diagnostic arrays
+// whose values are json strings. No ROS master is needed.
+//
+// usage: system_status_fanout_benchmark [nodes] [diagnostics per node] [callbacks] [iterations]
+
+#include <ros/ros.h>
+#include <boost/make_shared.hpp>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <autoware_system_msgs/SystemStatus.h>
+
+namespace
+{
+using autoware_system_msgs::DiagnosticStatus;
+using autoware_system_msgs::DiagnosticStatusArray;
+using autoware_system_msgs::NodeStatus;
+using autoware_system_msgs::SystemStatus;
+
+SystemStatus::ConstPtr createSystemStatus(const int nodes, const int diagnostics)
+{
+  auto status = boost::make_shared<SystemStatus>();
+  status->header.stamp = ros::Time::now();
+  for (int i = 0; i < nodes; i++)
+  {
+    NodeStatus node_status;
+    node_status.header = status->header;
+    node_status.node_name = "/node_" + std::to_string(i);
+    node_status.node_activated = true;
+    for (int j = 0; j < diagnostics; j++)
+    {
+      DiagnosticStatus diag;
+      diag.header = status->header;
+      diag.key = "value_" + std::to_string(j) + "_high";
+      std::stringstream ss;
+      ss << "{\"value\": " << j * 0.5 << ", \"warn\": 1.0, \"error\": 2.0, \"fatal\": 3.0}";
+      diag.value = ss.str();
+      diag.description = "value " + std::to_string(j) + " of " + node_status.node_name + " is too high";
+      diag.type = DiagnosticStatus::OUT_OF_RANGE;
+      diag.level = DiagnosticStatus::OK;
+      DiagnosticStatusArray array;
+      array.status.emplace_back(diag);
+      node_status.status.emplace_back(array);
+    }
+    status->node_status.emplace_back(node_status);
+    status->available_nodes.emplace_back(node_status.node_name);
+  }
+  return status;
+}
+
+// reads the status as the emergency_handler filters do
+int countErrors(const SystemStatus& status)
+{
+  int errors = 0;
+  for (const auto& node_status : status.node_status)
+  {
+    for (const auto& array : node_status.status)
+    {
+      for (const auto& diag : array.status)
+      {
+        errors += (diag.level >= DiagnosticStatus::ERROR) ? 1 : 0;
+      }
+    }
+  }
+  return errors;
+}
+
+// microseconds per status, the loops are the ones of SystemStatusSubscriber::systemStatusCallback
+double measure(const SystemStatus::ConstPtr& msg, const int callbacks, const int iterations, const bool shared,
+               int* errors)
+{
+  std::vector<std::function<void(std::shared_ptr<SystemStatus>)>> functions;
+  std::vector<std::function<void(const SystemStatus::ConstPtr&)>> shared_functions;
+  for (int i = 0; i < callbacks; i++)
+  {
+    if (shared)
+    {
+      shared_functions.emplace_back(
+        [errors](const SystemStatus::ConstPtr& status) { *errors += countErrors(*status); });  // NOLINT
+    }
+    else
+    {
+      functions.emplace_back(
+        [errors](std::shared_ptr<SystemStatus> status) { *errors += countErrors(*status); });  // NOLINT
+    }
+  }
+
+  const auto start = std::chrono::steady_clock::now();
+  for (int n = 0; n < iterations; n++)
+  {
+    for (auto& func : shared_functions)
+    {
+      func(msg);
+    }
+    for (auto& func : functions)
+    {
+      auto pmsg = std::make_shared<SystemStatus>(*msg);
+      func(pmsg);
+    }
+  }
+  const std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+  return elapsed.count() / iterations;
+}
+}  // namespace
+
+int main(int argc, char** argv)
+{
+  const int nodes = (argc > 1) ? std::atoi(argv[1]) : 50;
+  const int diagnostics = (argc > 2) ? std::atoi(argv[2]) : 10;
+  const int callbacks = (argc > 3) ? std::atoi(argv[3]) : 2;
+  const int iterations = (argc > 4) ? std::atoi(argv[4]) : 1000;
+  ros::Time::init();
+
+  const auto msg = createSystemStatus(nodes, diagnostics);
+  std::cout << nodes << " nodes, " << diagnostics << " diagnostics per node, "
+            << ros::serialization::serializationLength(*msg) << " bytes serialized, " << callbacks << " callbacks"
+            << std::endl;
+
+  int errors = 0;
+  const double copy_us = measure(msg, callbacks, iterations, false, &errors);
+  const double shared_us = measure(msg, callbacks, iterations, true, &errors);
+  std::cout << "copy per callback: " << copy_us << " us per status" << std::endl;
+  std::cout << "shared status: " << shared_us << " us per status" << std::endl;
+  // keeps the reads of the callbacks from being optimized out
+  return (errors == 0) ? 0 : 1;
+}
@@ -34,6 +34,10 @@ void SystemStatusSubscriber::enable()
 void SystemStatusSubscriber::systemStatusCallback(
   const autoware_system_msgs::SystemStatus::ConstPtr msg)
 {
+  for (auto& func : shared_functions_)
+  {
+    func(msg);
+  }
   for (auto& func : functions_)
   {
     auto pmsg = std::make_shared<autoware_system_msgs::SystemStatus>(*msg);
@@ -46,4 +50,10 @@ void SystemStatusSubscriber::addCallback(
 {
   functions_.emplace_back(func);
 }
+
+void SystemStatusSubscriber::addSharedCallback(
+  std::function<void(const autoware_system_msgs::SystemStatus::ConstPtr&)> func)
+{
+  shared_functions_.emplace_back(func);
+}
 }  // namespace autoware_health_checker
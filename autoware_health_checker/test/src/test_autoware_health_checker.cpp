@@ -233,6 +233,112 @@ TEST_F(AutowareHealthCheckerTestSuite, NODE_STATUS)
   ASSERT_EQ(ret_inactive, false) << "The value must be true";
 }
 
+/*
+  test for diag buffer, diagnostics of all levels come out in time order
+*/
+TEST_F(AutowareHealthCheckerTestSuite, DIAG_BUFFER)
+{
+  autoware_health_checker::DiagBuffer buffer("test", AwDiagStatus::OUT_OF_RANGE, "test", 10.0);
+  const ros::Time now = ros::Time::now();
+  const std::vector<std::pair<ErrorLevel, double>> dataset =
+  {
+    std::make_pair(AwDiagStatus::OK, 0.3),
+    std::make_pair(AwDiagStatus::ERROR, 0.1),
+    std::make_pair(AwDiagStatus::OK, 0.2),
+    std::make_pair(AwDiagStatus::FATAL, 0.4),
+    std::make_pair(AwDiagStatus::WARN, 0.0)
+  };
+  autoware_system_msgs::DiagnosticStatus status;
+  for (const auto& data : dataset)
+  {
+    status.level = data.first;
+    status.header.stamp = now - ros::Duration(data.second);
+    buffer.addDiag(status);
+  }
+  const auto ret = buffer.getAndClearData();
+  ASSERT_EQ(ret.status.size(), dataset.size()) << "All diagnostics must be returned.";
+  for (size_t i = 1; i < ret.status.size(); ++i)
+  {
+    ASSERT_LE(ret.status[i - 1].header.stamp, ret.status[i].header.stamp)
+      << "Diagnostics must be sorted by timestamp.";
+  }
+  ASSERT_EQ(ret.status.front().level, AwDiagStatus::FATAL) << "The oldest diagnostic must come first.";
+  ASSERT_TRUE(buffer.getAndClearData().status.empty()) << "The buffer must be empty after getAndClearData.";
+}
+
+/*
+  test for value checker, levels are computed from the thresholds and the
+  samples are harvested once
+*/
+TEST_F(AutowareHealthCheckerTestSuite, VALUE_CHECKER)
+{
+  autoware_health_checker::ValueChecker checker("test", AwDiagStatus::OUT_OF_RANGE, "test");
+  checker.setMaxValue(1.0, 2.0, 3.0);
+  ASSERT_EQ(checker.check(0.5), AwDiagStatus::UNDEFINED) << "A disabled checker must return UNDEFINED.";
+  ASSERT_TRUE(checker.getAndClearData().status.empty()) << "A disabled checker must not record values.";
+  checker.setEnabled(true);
+  ASSERT_EQ(checker.check(0.5), AwDiagStatus::OK) << "The value must be OK.";
+  ASSERT_EQ(checker.check(1.5), AwDiagStatus::WARN) << "The value must be WARN.";
+  ASSERT_EQ(checker.check(2.5), AwDiagStatus::ERROR) << "The value must be ERROR.";
+  ASSERT_EQ(checker.check(3.5), AwDiagStatus::FATAL) << "The value must be FATAL.";
+  const auto ret = checker.getAndClearData();
+  ASSERT_EQ(ret.status.size(), 4u) << "All checked values must be returned.";
+  ASSERT_EQ(ret.status.back().level, AwDiagStatus::FATAL) << "The values must come in check order.";
+  ASSERT_EQ(ret.status.back().key, "test") << "The key must be set.";
+  ASSERT_TRUE(checker.getAndClearData().status.empty()) << "The checker must be empty after getAndClearData.";
+}
+
+/*
+  test for the threshold table, parameters are resolved once and the
+  default values are used for the missing levels
+*/
+TEST_F(AutowareHealthCheckerTestSuite, PARAM_TABLE)
+{
+  ros::param::set("health_checker_param_table", true);
+  ros::param::set("health_checker/test_table/max/warn", 10);
+  ros::param::set("health_checker/test_table/max/error", 20.5);
+  ros::param::set("health_checker/test_ns/local_key", "default");
+  autoware_health_checker::ValueManager value_manager(test_obj_.nh, test_obj_.pnh);
+  ros::param::set("health_checker_param_table", false);
+  ASSERT_TRUE(value_manager.getTable() != nullptr) << "The table must be built.";
+  value_manager.setDefaultValue("test_table", "max", 1.0, 2.0, 3.0);
+  ASSERT_FALSE(value_manager.isNotFound("test_table")) << "The key must be found.";
+  ASSERT_TRUE(value_manager.isNotFound("test_none")) << "The key must not be found.";
+  ASSERT_FALSE(value_manager.isNotFound("test_ns", "local_key")) << "The member must be found.";
+  ASSERT_TRUE(value_manager.isNotFound("test_ns", "none")) << "The member must not be found.";
+  ASSERT_EQ(value_manager.getValue("test_table", "max", AwDiagStatus::WARN).get(), 10.0)
+    << "An integer parameter must be read as a double.";
+  ASSERT_EQ(value_manager.getValue("test_table", "max", AwDiagStatus::ERROR).get(), 20.5)
+    << "The parameter must be used.";
+  ASSERT_EQ(value_manager.getValue("test_table", "max", AwDiagStatus::FATAL).get(), 3.0)
+    << "The default value must be used for a missing level.";
+  ASSERT_FALSE(value_manager.getValue("test_none", "max", AwDiagStatus::WARN))
+    << "A missing key must have no value.";
+}
+
+/*
+  test for the profile mode, a check is timed once even if it calls
+  another check
+*/
+TEST_F(AutowareHealthCheckerTestSuite, PROFILE)
+{
+  auto& checker = *test_obj_.health_checker_ptr;
+  ASSERT_FALSE(checker.isProfiling()) << "Profiling must be disabled by default.";
+  checker.CHECK_MAX_VALUE("test", 0.0, 1.0, 2.0, 3.0, "test");
+  ASSERT_EQ(checker.getOverheadStats().calls, 0u) << "Checks must not be timed without profiling.";
+
+  ros::param::set("health_checker_profile", true);
+  autoware_health_checker::HealthChecker profiled(test_obj_.nh, test_obj_.pnh);
+  ros::param::set("health_checker_profile", false);
+  ASSERT_TRUE(profiled.isProfiling()) << "Profiling must be enabled by the parameter.";
+  profiled.CHECK_MAX_VALUE("test", 0.0, 1.0, 2.0, 3.0, "test");
+  profiled.CHECK_TRUE("test", true, AwDiagStatus::OK, "test");
+  const auto stats = profiled.getOverheadStats();
+  ASSERT_EQ(stats.calls, 2u) << "Each check must be timed once.";
+  ASSERT_GE(stats.check_us, stats.max_check_us) << "The total time must include the longest check.";
+  ASSERT_GT(stats.max_check_us, 0.0) << "The checks must take some time.";
+}
+
 int main(int argc, char **argv)
 {
   testing::InitGoogleTest(&argc, argv);
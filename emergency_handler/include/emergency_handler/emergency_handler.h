@@ -16,6 +16,8 @@
  * limitations under the License.
  */
 #include <ros/ros.h>
+#include <ros/callback_queue.h>
+#include <condition_variable>
 #include <map>
 #include <memory>
 #include <boost/thread.hpp>
@@ -25,7 +27,7 @@
 #include <emergency_handler/libsystem_status_filter.h>
 #include <emergency_handler/emergency_planner.h>
 
-typedef std::function<int(std::shared_ptr<SystemStatus> const)> FilterFunc;
+typedef std::function<int(const SystemStatus::ConstPtr&)> FilterFunc;
 
 struct EmergencyHandlingPriority
 {
@@ -58,6 +60,20 @@ protected:
   ros::Subscriber vehicle_cmd_sub_;
   void vehicleCmdCallback(const autoware_msgs::VehicleCmd::ConstPtr& vehicle_cmd);
 
+  // ERROR and FATAL sent at once by the health checkers, handled in their own thread
+  bool use_emergency_node_status_;
+  ros::CallbackQueue emergency_queue_;
+  std::unique_ptr<ros::AsyncSpinner> emergency_spinner_;
+  ros::Subscriber emergency_status_sub_;
+  void emergencyStatusCallback(const autoware_system_msgs::NodeStatus::ConstPtr& node_status);
+  std::mutex event_mutex_;
+  std::condition_variable event_cv_;
+  bool is_event_received_;
+  ros::Timer cycle_timer_;
+  bool is_cycle_elapsed_;
+  void cycleTimerCallback(const ros::TimerEvent& event);
+  void waitForNextCycle(ros::Rate* rate);
+
   autoware_system_msgs::DiagnosticStatusArray error_status_;
   autoware_system_msgs::DiagnosticStatusArray genNoStatusMsg(void);
 
@@ -74,7 +90,7 @@ protected:
 
   autoware_msgs::VehicleCmd vehicle_cmd_;
 
-  void wrapFunc(FilterFunc func, std::shared_ptr<SystemStatus> const status);
+  void wrapFunc(FilterFunc func, const SystemStatus::ConstPtr& status);
 
   bool is_system_status_received_;
 };
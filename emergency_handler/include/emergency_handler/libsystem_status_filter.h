@@ -51,14 +51,18 @@ class SystemStatusFilter
 public:
   SystemStatusFilter();
 
+  // the status is shared by all the filters, a filter that modifies it works on its own copy
+  virtual int selectPriority(const SystemStatus::ConstPtr& status);
+  // deprecated, the filters that still override it get their own copy of the status
   virtual int selectPriority(std::shared_ptr<SystemStatus> const status);
   static const DiagnosticStatusArray& getFactorStatusArray();
+  static void addFactorStatus(const DiagnosticStatus& status);
   static void resetFactorStatusArray();
-  const std::function<int(std::shared_ptr<SystemStatus> const)>& getFunc() const;
+  const std::function<int(const SystemStatus::ConstPtr&)>& getFunc() const;
   static VitalMonitor vital_monitor_;
 
 protected:
-  std::function<int(std::shared_ptr<SystemStatus> const)> callback_;
+  std::function<int(const SystemStatus::ConstPtr&)> callback_;
   static FactorStatusArray factor_status_array_;
   static constexpr int normal_behavior_ = INT_MAX;
 
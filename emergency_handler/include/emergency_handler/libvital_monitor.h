@@ -20,6 +20,8 @@
 #include <vector>
 #include <set>
 #include <map>
+#include <unordered_map>
+#include <unordered_set>
 #include <algorithm>
 #include <autoware_system_msgs/SystemStatus.h>
 
@@ -54,8 +56,11 @@ class VitalMonitor
 {
 public:
   void initMonitoredNodeList(const ros::NodeHandle& pnh);
+  void addMonitoredNode(const std::string& node_name, double timeout_sec, int level);
   void updateNodeStatus(const std::vector<std::string>& available_nodes);
   void addDeadNodes(std::shared_ptr<autoware_system_msgs::SystemStatus> const status) const;
+  // copy of status with the dead nodes, kept in a buffer reused by the next call
+  const autoware_system_msgs::SystemStatus& addDeadNodes(const autoware_system_msgs::SystemStatus& status);
   const std::map<std::string, int>& getDeadNodes();
   autoware_system_msgs::DiagnosticStatusArray
     createDiagnosticStatusArray(std::string dead_node_name, std_msgs::Header* const header, int level) const;
@@ -65,6 +70,12 @@ public:
 private:
   std::map<std::string, LifeTime> required_nodes_;
   std::map<std::string, int> dead_nodes_;
+  std::unordered_set<std::string> available_nodes_;
+  std::unordered_map<std::string, size_t> node_index_;
+  autoware_system_msgs::SystemStatus status_buffer_;
+
+  void appendDeadNodes(autoware_system_msgs::SystemStatus* const status,
+                       std::unordered_map<std::string, size_t>* const node_index) const;
 };
 
 #endif  // EMERGENCY_HANDLER_LIBVITAL_MONITOR_H
@@ -20,13 +20,15 @@
 class SimpleHardwareFilter : public SystemStatusFilter
 {
 public:
-  int selectPriority(std::shared_ptr<SystemStatus> const status);
+  using SystemStatusFilter::selectPriority;
+  int selectPriority(const SystemStatus::ConstPtr& status) override;
 };
 
 class SimpleNodeFilter : public SystemStatusFilter
 {
 public:
-  int selectPriority(std::shared_ptr<SystemStatus> const status);
+  using SystemStatusFilter::selectPriority;
+  int selectPriority(const SystemStatus::ConstPtr& status) override;
 };
 
 #endif  //  EMERGENCY_HANDLER_SYSTEM_STATUS_FILTER_H
@@ -41,10 +41,17 @@ void FactorStatusArray::reset()
 }
 
 SystemStatusFilter::SystemStatusFilter()
-  : callback_(std::bind(&SystemStatusFilter::selectPriority, this, std::placeholders::_1))
+  : callback_(std::bind(static_cast<int (SystemStatusFilter::*)(const SystemStatus::ConstPtr&)>(
+                            &SystemStatusFilter::selectPriority),
+                        this, std::placeholders::_1))
 {
 }
 
+int SystemStatusFilter::selectPriority(const SystemStatus::ConstPtr& status)
+{
+  return selectPriority(std::make_shared<SystemStatus>(*status));
+}
+
 int SystemStatusFilter::selectPriority(std::shared_ptr<SystemStatus> const status)
 {
   return normal_behavior_;
@@ -55,13 +62,19 @@ const DiagnosticStatusArray& SystemStatusFilter::getFactorStatusArray()
   return factor_status_array_.dataset_;
 }
 
+void SystemStatusFilter::addFactorStatus(const DiagnosticStatus& status)
+{
+  std::lock_guard<std::mutex> lock(factor_status_mutex_);
+  factor_status_array_.add(status);
+}
+
 void SystemStatusFilter::resetFactorStatusArray()
 {
   std::lock_guard<std::mutex> lock(factor_status_mutex_);
   factor_status_array_.reset();
 }
 
-const std::function<int(std::shared_ptr<SystemStatus> const)>& SystemStatusFilter::getFunc() const
+const std::function<int(const SystemStatus::ConstPtr&)>& SystemStatusFilter::getFunc() const
 {
   return callback_;
 }
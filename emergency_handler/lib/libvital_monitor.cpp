@@ -16,6 +16,7 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <unordered_map>
 #include <emergency_handler/libvital_monitor.h>
 
 const std::map<std::string, int>& VitalMonitor::getDeadNodes()
@@ -30,21 +31,28 @@ void VitalMonitor::updateNodeStatus(const std::vector<std::string>& available_no
   const double diff = (current - previous).toSec();
   previous = current;
 
-  for (const auto& node : available_nodes)
+  // built once per update, the buckets are kept from one update to the next
+  available_nodes_.clear();
+  available_nodes_.insert(available_nodes.begin(), available_nodes.end());
+
+  for (auto it = dead_nodes_.begin(); it != dead_nodes_.end();)
   {
-    if (dead_nodes_.count(node) != 0)
+    if (available_nodes_.count(it->first) != 0)
     {
-      ROS_INFO("%s is switched to be available", node.c_str());
-      required_nodes_.at(node).reset();
-      dead_nodes_.erase(node);
+      ROS_INFO("%s is switched to be available", it->first.c_str());
+      required_nodes_.at(it->first).reset();
+      it = dead_nodes_.erase(it);
+    }
+    else
+    {
+      ++it;
     }
   }
 
   for (auto& node : required_nodes_)
   {
-    const std::string node_name = node.first;
-    const auto& found = std::find(available_nodes.begin(), available_nodes.end(), node_name);
-    if (found == available_nodes.end())
+    const std::string& node_name = node.first;
+    if (available_nodes_.count(node_name) == 0)
     {
       node.second.spend(diff);
     }
@@ -52,12 +60,7 @@ void VitalMonitor::updateNodeStatus(const std::vector<std::string>& available_no
     {
       node.second.activate();
     }
-  }
-
-  for (const auto& node : required_nodes_)
-  {
-    const std::string node_name = node.first;
-    if (dead_nodes_.count(node_name) == 0 && node.second.isDead())
+    if (node.second.isDead() && dead_nodes_.count(node_name) == 0)
     {
       ROS_INFO("%s is not available", node_name.c_str());
       dead_nodes_.emplace(node_name, node.second.level_);
@@ -75,11 +78,16 @@ void VitalMonitor::initMonitoredNodeList(const ros::NodeHandle& pnh)
     auto val = param.second;
     const double timeout_sec = val.hasMember("timeout") ? static_cast<double>(val["timeout"]) : 0.1;
     const int level = val.hasMember("level") ? static_cast<int>(val["level"]) : 1;
-    required_nodes_.emplace(node_name, LifeTime(timeout_sec, level));
+    addMonitoredNode(node_name, timeout_sec, level);
   }
   dead_nodes_.clear();
 }
 
+void VitalMonitor::addMonitoredNode(const std::string& node_name, double timeout_sec, int level)
+{
+  required_nodes_.emplace(node_name, LifeTime(timeout_sec, level));
+}
+
 autoware_system_msgs::DiagnosticStatusArray VitalMonitor::createDiagnosticStatusArray(std::string dead_node_name,
                                                                                       std_msgs::Header* const header,
                                                                                       int level) const
@@ -113,21 +121,41 @@ autoware_system_msgs::NodeStatus VitalMonitor::createNodeStatus(std::string dead
 
 void VitalMonitor::addDeadNodes(std::shared_ptr<autoware_system_msgs::SystemStatus> const status) const
 {
-  for (auto& node : dead_nodes_)
+  std::unordered_map<std::string, size_t> node_index;
+  appendDeadNodes(status.get(), &node_index);
+}
+
+const autoware_system_msgs::SystemStatus& VitalMonitor::addDeadNodes(const autoware_system_msgs::SystemStatus& status)
+{
+  // the assignment reuses the vectors and strings of the previous status
+  status_buffer_ = status;
+  appendDeadNodes(&status_buffer_, &node_index_);
+  return status_buffer_;
+}
+
+void VitalMonitor::appendDeadNodes(autoware_system_msgs::SystemStatus* const status,
+                                   std::unordered_map<std::string, size_t>* const node_index) const
+{
+  auto& array = status->node_status;
+  node_index->clear();
+  for (size_t i = 0; i < array.size(); i++)
+  {
+    node_index->emplace(array[i].node_name, i);
+  }
+  for (const auto& node : dead_nodes_)
   {
-    const std::string name = node.first;
+    const std::string& name = node.first;
     const int level = node.second;
-    auto& array = status->node_status;
-    auto found = std::find_if(array.begin(), array.end(),
-    [&](autoware_system_msgs::NodeStatus& stat) {return (name == stat.node_name);});  // NOLINT
-    if (found == array.end())
+    const auto found = node_index->find(name);
+    if (found == node_index->end())
     {
       array.emplace_back(createNodeStatus(name, &status->header, level));
     }
     else
     {
-      found->node_activated = true;
-      found->status.emplace_back(createDiagnosticStatusArray(name, &status->header, level));
+      auto& node_status = array[found->second];
+      node_status.node_activated = true;
+      node_status.status.emplace_back(createDiagnosticStatusArray(name, &status->header, level));
     }
   }
 }
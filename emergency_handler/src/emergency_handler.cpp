@@ -17,7 +17,9 @@
 #include <string>
 #include <map>
 #include <algorithm>
+#include <chrono>
 #include <functional>
+#include <iterator>
 #include <utility>
 #include <emergency_handler/emergency_handler.h>
 #include <emergency_handler/emergency_stop_planner.h>
@@ -31,6 +33,7 @@ EmergencyHandler::EmergencyHandler(const ros::NodeHandle& nh, const ros::NodeHan
   : nh_(nh), pnh_(pnh), status_sub_(nh, pnh)
 {
   pnh_.param<bool>("emergency_planner_enabled", is_emergency_planner_enabled_, false);
+  pnh_.param<bool>("use_emergency_node_status", use_emergency_node_status_, false);
 
   std::map<std::string, int> emergency_handling_priority;
   pnh_.getParam("emergency_handling_priority", emergency_handling_priority);
@@ -52,6 +55,20 @@ EmergencyHandler::EmergencyHandler(const ros::NodeHandle& nh, const ros::NodeHan
   }
 
   vehicle_cmd_sub_ = nh_.subscribe("vehicle_cmd", 1, &EmergencyHandler::vehicleCmdCallback, this);
+  is_event_received_ = false;
+  is_cycle_elapsed_ = false;
+  if (use_emergency_node_status_)
+  {
+    ros::NodeHandle emergency_nh(nh_);
+    emergency_nh.setCallbackQueue(&emergency_queue_);
+    emergency_status_sub_ = emergency_nh.subscribe("emergency_node_status", 10,
+                                                   &EmergencyHandler::emergencyStatusCallback, this,
+                                                   ros::TransportHints().tcpNoDelay());
+    // the cycle follows the ROS time as ros::Rate does, so use_sim_time and the rosbag playback keep their timing
+    cycle_timer_ = emergency_nh.createTimer(ros::Duration(1.0 / autoware_health_checker::SYSTEM_UPDATE_RATE),
+                                            &EmergencyHandler::cycleTimerCallback, this, false, false);
+    emergency_spinner_.reset(new ros::AsyncSpinner(1, &emergency_queue_));
+  }
   EmergencyHandler::setupPublisher();
 
   priority_ = priority_table.no_error;
@@ -106,54 +123,105 @@ void EmergencyHandler::registerEmergencyPlanners(void)
 }
 
 // Find Appropriate emergency planner based upon the priority required by system
+// the planners are sorted by priority at the registration, so it is a search of the map without allocation
 std::shared_ptr<EmergencyPlanner> EmergencyHandler::find_target_emergency_planner(int req_priority)
 {
-  std::shared_ptr<EmergencyPlanner> target_emergency_planner(nullptr);
-
   if (emergency_planner_map_.empty())
   {
     ROS_ERROR("No Emergency Planner Found");
+    return nullptr;
   }
-  else
+
+  // the planner of the highest priority not above the required one
+  auto itr = emergency_planner_map_.upper_bound(req_priority);
+  if (itr == emergency_planner_map_.begin())
   {
-    std::map<int, std::shared_ptr<EmergencyPlanner>, std::greater<int>> available_planner;
+    ROS_ERROR("No Available Planner Found");
+    return emergency_planner_map_.begin()->second;
+  }
+  return std::prev(itr)->second;
+}
 
-    for (auto itr = emergency_planner_map_.begin(); itr != emergency_planner_map_.end(); itr++)
+void EmergencyHandler::vehicleCmdCallback(const autoware_msgs::VehicleCmd::ConstPtr& vehicle_cmd)
+{
+  vehicle_cmd_ = *vehicle_cmd;
+}
+
+// Raise the priority as the node filter would, and wake run() up without waiting for the system status
+void EmergencyHandler::emergencyStatusCallback(const autoware_system_msgs::NodeStatus::ConstPtr& node_status)
+{
+  if (!node_status->node_activated)
+  {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(priority_mutex_);
+    bool is_error_detected = false;
+    for (const auto& st_array : node_status->status)
     {
-      if (itr->first <= req_priority)
+      for (const auto& status : st_array.status)
       {
-        available_planner.emplace(itr->first, itr->second);
+        if (status.level >= autoware_system_msgs::DiagnosticStatus::ERROR)
+        {
+          SystemStatusFilter::addFactorStatus(status);
+          is_error_detected = true;
+        }
       }
     }
-
-    if (available_planner.empty())
+    if (!is_error_detected)
     {
-      ROS_ERROR("No Available Planner Found");
-      target_emergency_planner = emergency_planner_map_.begin()->second;
-    }
-    else
-    {
-      target_emergency_planner = available_planner.begin()->second;
+      return;
     }
+    priority_ = std::min(static_cast<int>(priority_table.node_error), priority_);
+  }
+  {
+    std::lock_guard<std::mutex> lock(event_mutex_);
+    is_event_received_ = true;
   }
-  return target_emergency_planner;
+  event_cv_.notify_one();
 }
 
-void EmergencyHandler::vehicleCmdCallback(const autoware_msgs::VehicleCmd::ConstPtr& vehicle_cmd)
+void EmergencyHandler::cycleTimerCallback(const ros::TimerEvent& event)
 {
-  vehicle_cmd_ = *vehicle_cmd;
+  {
+    std::lock_guard<std::mutex> lock(event_mutex_);
+    is_cycle_elapsed_ = true;
+  }
+  event_cv_.notify_one();
+}
+
+void EmergencyHandler::waitForNextCycle(ros::Rate* rate)
+{
+  if (!use_emergency_node_status_)
+  {
+    rate->sleep();
+    return;
+  }
+  // the wall timeout only checks the shutdown while the ROS clock is paused
+  std::unique_lock<std::mutex> lock(event_mutex_);
+  while (!is_event_received_ && !is_cycle_elapsed_ && ros::ok())
+  {
+    event_cv_.wait_for(lock, std::chrono::milliseconds(100));
+  }
+  is_event_received_ = false;
+  is_cycle_elapsed_ = false;
 }
 
 // Add Filter
 void EmergencyHandler::addFilter(const SystemStatusFilter& filter)
 {
-  status_sub_.addCallback(boost::bind(&EmergencyHandler::wrapFunc, this, filter.getFunc(), _1));
+  status_sub_.addSharedCallback(boost::bind(&EmergencyHandler::wrapFunc, this, filter.getFunc(), _1));
 }
 
 // Run
 void EmergencyHandler::run(void)
 {
   status_sub_.enable();
+  if (emergency_spinner_)
+  {
+    emergency_spinner_->start();
+    cycle_timer_.start();
+  }
   ros::Duration wait_for_subscriber(0.5);  // TBC
   wait_for_subscriber.sleep();
 
@@ -227,12 +295,12 @@ void EmergencyHandler::run(void)
     }
     shm_vmon.run();
 
-    rate.sleep();
+    waitForNextCycle(&rate);
   }
 }
 
 // Wrap Function
-void EmergencyHandler::wrapFunc(FilterFunc func, std::shared_ptr<SystemStatus> const status)
+void EmergencyHandler::wrapFunc(FilterFunc func, const SystemStatus::ConstPtr& status)
 {
   std::lock_guard<std::mutex> lock(priority_mutex_);
   latest_priority_ = func(status);
@@ -0,0 +1,216 @@
+/*
+ * Copyright 2015-2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Measures the time from the detection of an ERROR by a health checker to the emergency of a running
+// emergency_handler (record_cmd), through the system status of health_aggregator and through
+// emergency_node_status. The health checker and health_aggregator are emulated: a detected ERROR is
+// published in the next node status (NODE_STATUS_UPDATE_RATE), which is aggregated into the next system
+// status (SYSTEM_UPDATE_RATE).
+
+#include <ros/ros.h>
+#include <std_msgs/Header.h>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <string>
+#include <vector>
+#include <autoware_health_checker/constants.h>
+#include <autoware_system_msgs/NodeStatus.h>
+#include <autoware_system_msgs/SystemStatus.h>
+
+namespace
+{
+using autoware_system_msgs::DiagnosticStatus;
+using autoware_system_msgs::NodeStatus;
+using autoware_system_msgs::SystemStatus;
+
+class LatencyBenchmark
+{
+public:
+  LatencyBenchmark(ros::NodeHandle nh, ros::NodeHandle pnh) : nh_(nh), error_stamp_(0.0), is_error_(false)
+  {
+    std::string handler_name;
+    pnh.param<std::string>("handler_name", handler_name, "/emergency_handler");
+    // the monitored nodes are reported available, so the vital monitor does not trigger the emergency
+    XmlRpc::XmlRpcValue params;
+    if (ros::param::get(handler_name + "/vital_monitor", params) && params.getType() == XmlRpc::XmlRpcValue::TypeStruct)
+    {
+      for (const auto& param : params)
+      {
+        available_nodes_.emplace_back("/" + param.first);
+      }
+    }
+    system_status_pub_ = nh_.advertise<SystemStatus>("system_status", 1);
+    emergency_status_pub_ = nh_.advertise<NodeStatus>("emergency_node_status", 10);
+    record_cmd_sub_ = nh_.subscribe("record_cmd", 1, &LatencyBenchmark::recordCmdCallback, this);
+    system_status_timer_ = nh_.createWallTimer(ros::WallDuration(1.0 / autoware_health_checker::SYSTEM_UPDATE_RATE),
+                                               &LatencyBenchmark::publishSystemStatus, this);
+  }
+
+  // latency in milliseconds of one trial, negative on timeout
+  double measure(const bool use_emergency_node_status, std::mt19937* rng)
+  {
+    // the ERROR happens at any phase of the node status cycle
+    const double node_status_period = 1.0 / autoware_health_checker::NODE_STATUS_UPDATE_RATE;
+    std::uniform_real_distribution<double> phase(0.0, node_status_period);
+    ros::WallDuration(phase(*rng)).sleep();
+
+    {
+      std::lock_guard<std::mutex> lock(mtx_);
+      detect_time_ = ros::WallTime::now();
+      stop_time_ = ros::WallTime();
+      error_stamp_ = ros::Time::now();
+    }
+    if (use_emergency_node_status)
+    {
+      std_msgs::Header header;
+      header.stamp = error_stamp_;
+      emergency_status_pub_.publish(createNodeStatus(header, DiagnosticStatus::ERROR));
+    }
+    else
+    {
+      // node status of the health checker, on its next cycle
+      const double detect_sec = detect_time_.toSec();
+      const double next_node_status = std::ceil(detect_sec / node_status_period) * node_status_period;
+      ros::WallDuration(next_node_status - detect_sec).sleep();
+      is_error_ = true;
+    }
+
+    std::unique_lock<std::mutex> lock(mtx_);
+    const bool stopped = cv_.wait_for(lock, std::chrono::seconds(2), [this]() { return !stop_time_.isZero(); });
+    is_error_ = false;
+    if (!stopped)
+    {
+      return -1.0;
+    }
+    return (stop_time_ - detect_time_).toSec() * 1e3;
+  }
+
+private:
+  ros::NodeHandle nh_;
+  ros::Publisher system_status_pub_, emergency_status_pub_;
+  ros::Subscriber record_cmd_sub_;
+  ros::WallTimer system_status_timer_;
+  std::vector<std::string> available_nodes_;
+  std::mutex mtx_;
+  std::condition_variable cv_;
+  ros::WallTime detect_time_, stop_time_;
+  ros::Time error_stamp_;
+  std::atomic<bool> is_error_;
+
+  NodeStatus createNodeStatus(const std_msgs::Header& header, const int level) const
+  {
+    DiagnosticStatus diag;
+    diag.header = header;
+    diag.key = "emergency_latency_benchmark";
+    diag.description = "emergency latency benchmark";
+    diag.type = DiagnosticStatus::INTERNAL;
+    diag.level = level;
+    NodeStatus node_status;
+    node_status.header = header;
+    node_status.node_name = ros::this_node::getName();
+    node_status.node_activated = true;
+    node_status.status.resize(1);
+    node_status.status[0].status.emplace_back(diag);
+    return node_status;
+  }
+
+  void publishSystemStatus(const ros::WallTimerEvent& event)
+  {
+    SystemStatus status;
+    status.header.stamp = ros::Time::now();
+    status.available_nodes = available_nodes_;
+    const int level = is_error_ ? DiagnosticStatus::ERROR : DiagnosticStatus::OK;
+    status.node_status.emplace_back(createNodeStatus(status.header, level));
+    system_status_pub_.publish(status);
+  }
+
+  void recordCmdCallback(const std_msgs::Header::ConstPtr& msg)
+  {
+    // record_cmd is latched, an earlier emergency is not this one
+    std::lock_guard<std::mutex> lock(mtx_);
+    if (error_stamp_.isZero() || msg->stamp < error_stamp_ || !stop_time_.isZero())
+    {
+      return;
+    }
+    stop_time_ = ros::WallTime::now();
+    cv_.notify_one();
+  }
+};
+
+void printResult(const std::string& name, std::vector<double> latencies, const int timeouts)
+{
+  if (latencies.empty())
+  {
+    std::cout << name << ": no emergency, " << timeouts << " timeouts" << std::endl;
+    return;
+  }
+  std::sort(latencies.begin(), latencies.end());
+  double sum = 0;
+  for (const auto l : latencies)
+  {
+    sum += l;
+  }
+  std::cout << name << ": best " << latencies.front() << " ms, median " << latencies[latencies.size() / 2]
+            << " ms, mean " << sum / latencies.size() << " ms, worst " << latencies.back() << " ms, " << timeouts
+            << " timeouts" << std::endl;
+}
+}  // namespace
+
+int main(int argc, char** argv)
+{
+  ros::init(argc, argv, "emergency_latency_benchmark");
+  ros::NodeHandle nh;
+  ros::NodeHandle pnh("~");
+  int repeats;
+  double release_time;
+  pnh.param<int>("repeats", repeats, 5);
+  // emergency_handler stays in emergency for 10 s after each detection
+  pnh.param<double>("release_time", release_time, 11.0);
+
+  ros::AsyncSpinner spinner(2);
+  spinner.start();
+  LatencyBenchmark benchmark(nh, pnh);
+  // lets emergency_handler receive the system status before the first trial
+  ros::WallDuration(release_time).sleep();
+
+  std::mt19937 rng(0);
+  for (const bool use_emergency_node_status : { false, true })
+  {
+    std::vector<double> latencies;
+    int timeouts = 0;
+    for (int i = 0; i < repeats && ros::ok(); i++)
+    {
+      const double latency = benchmark.measure(use_emergency_node_status, &rng);
+      if (latency < 0)
+      {
+        timeouts++;
+      }
+      else
+      {
+        latencies.push_back(latency);
+      }
+      ros::WallDuration(release_time).sleep();
+    }
+    printResult(use_emergency_node_status ? "emergency_node_status" : "system_status", latencies, timeouts);
+  }
+  ros::shutdown();
+  return 0;
+}
@@ -19,7 +19,7 @@
 
 static constexpr int DIAG_ERROR = autoware_system_msgs::DiagnosticStatus::ERROR;
 
-int SimpleHardwareFilter::selectPriority(std::shared_ptr<SystemStatus> const status)
+int SimpleHardwareFilter::selectPriority(const SystemStatus::ConstPtr& status)
 {
   const bool is_hardware_error_detected = !(checkAllHardwareSimply(status->hardware_status, DIAG_ERROR));
 
@@ -27,11 +27,13 @@ int SimpleHardwareFilter::selectPriority(std::shared_ptr<SystemStatus> const sta
                                       EmergencyHandler::priority_table.no_error;
 }
 
-int SimpleNodeFilter::selectPriority(std::shared_ptr<SystemStatus> const status)
+int SimpleNodeFilter::selectPriority(const SystemStatus::ConstPtr& status)
 {
   vital_monitor_.updateNodeStatus(status->available_nodes);
-  vital_monitor_.addDeadNodes(status);
-  const bool is_node_error_detected = !(checkAllNodeSimply(status->node_status, DIAG_ERROR));
+  // the dead nodes are added to a copy, only when there are some
+  const SystemStatus& checked_status =
+    vital_monitor_.getDeadNodes().empty() ? *status : vital_monitor_.addDeadNodes(*status);
+  const bool is_node_error_detected = !(checkAllNodeSimply(checked_status.node_status, DIAG_ERROR));
 
   return is_node_error_detected ? EmergencyHandler::priority_table.node_error :
                                   EmergencyHandler::priority_table.no_error;
@@ -0,0 +1,143 @@
+/*
+ * Copyright 2015-2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Measures one status cycle of the vital monitor of emergency_handler (updateNodeStatus and addDeadNodes)
+// on a system status of health_aggregator where every node is monitored and a part of them is dead.
+// The linear scan of the available nodes it replaced is measured on the same input for comparison.
+// No ROS master is needed.
+//
+// usage: vital_monitor_benchmark [nodes] [dead nodes] [iterations]
+
+#include <ros/ros.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <autoware_system_msgs/SystemStatus.h>
+#include <emergency_handler/libvital_monitor.h>
+
+namespace
+{
+using autoware_system_msgs::DiagnosticStatus;
+using autoware_system_msgs::NodeStatus;
+using autoware_system_msgs::SystemStatus;
+
+SystemStatus createSystemStatus(const std::vector<std::string>& node_names, const int diagnostics)
+{
+  SystemStatus status;
+  status.header.stamp = ros::Time::now();
+  for (const auto& node_name : node_names)
+  {
+    NodeStatus node_status;
+    node_status.header = status.header;
+    node_status.node_name = node_name;
+    node_status.node_activated = true;
+    node_status.status.resize(diagnostics);
+    for (auto& array : node_status.status)
+    {
+      DiagnosticStatus diag;
+      diag.header = status.header;
+      diag.key = "value_" + node_name + "_high";
+      diag.value = "{\"value\": 0.5, \"warn\": 1.0, \"error\": 2.0, \"fatal\": 3.0}";
+      diag.type = DiagnosticStatus::OUT_OF_RANGE;
+      diag.level = DiagnosticStatus::OK;
+      array.status.emplace_back(diag);
+    }
+    status.node_status.emplace_back(node_status);
+    status.available_nodes.emplace_back(node_name);
+  }
+  return status;
+}
+
+// the lookups of the previous updateNodeStatus and addDeadNodes, without their bookkeeping
+int scanReference(const std::vector<std::string>& required_nodes, const std::vector<std::string>& dead_nodes,
+                  const SystemStatus& status)
+{
+  int found_nodes = 0;
+  for (const auto& node_name : required_nodes)
+  {
+    const auto& available = status.available_nodes;
+    found_nodes += (std::find(available.begin(), available.end(), node_name) != available.end()) ? 1 : 0;
+  }
+  SystemStatus copy = status;
+  for (const auto& node_name : dead_nodes)
+  {
+    auto& array = copy.node_status;
+    const auto found = std::find_if(array.begin(), array.end(),
+                                    [&](const NodeStatus& stat) { return node_name == stat.node_name; });  // NOLINT
+    found_nodes += (found != array.end()) ? 1 : 0;
+  }
+  return found_nodes;
+}
+
+template <typename F>
+double measure(const int iterations, F func)
+{
+  const auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; i++)
+  {
+    func();
+  }
+  const std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+  return elapsed.count() / iterations;
+}
+}  // namespace
+
+int main(int argc, char** argv)
+{
+  const int nodes = (argc > 1) ? std::atoi(argv[1]) : 300;
+  const int dead = std::min((argc > 2) ? std::atoi(argv[2]) : 10, nodes);
+  const int iterations = (argc > 3) ? std::atoi(argv[3]) : 1000;
+  ros::Time::init();
+
+  std::vector<std::string> node_names, dead_names;
+  for (int i = 0; i < nodes; i++)
+  {
+    node_names.emplace_back("/node_" + std::to_string(i));
+  }
+  dead_names.assign(node_names.end() - dead, node_names.end());
+
+  // the dead nodes report once, then disappear from the system status and out-live their timeout
+  VitalMonitor vital_monitor;
+  for (const auto& node_name : node_names)
+  {
+    vital_monitor.addMonitoredNode(node_name, 1e-6, DiagnosticStatus::ERROR);
+  }
+  const SystemStatus all_alive = createSystemStatus(node_names, 3);
+  vital_monitor.updateNodeStatus(all_alive.available_nodes);
+  const SystemStatus status =
+    createSystemStatus(std::vector<std::string>(node_names.begin(), node_names.end() - dead), 3);
+  ros::WallDuration(0.01).sleep();
+  vital_monitor.updateNodeStatus(status.available_nodes);
+
+  size_t status_nodes = 0;
+  const double hashed_us = measure(iterations, [&]() {  // NOLINT
+    vital_monitor.updateNodeStatus(status.available_nodes);
+    status_nodes += vital_monitor.addDeadNodes(status).node_status.size();
+  });
+  int found_nodes = 0;
+  const double scan_us = measure(iterations, [&]() {  // NOLINT
+    found_nodes += scanReference(node_names, dead_names, status);
+  });
+
+  std::cout << nodes << " monitored nodes, " << vital_monitor.getDeadNodes().size() << " dead" << std::endl;
+  std::cout << "vital monitor: " << hashed_us << " us per status" << std::endl;
+  std::cout << "linear scan reference: " << scan_us << " us per status" << std::endl;
+  // keeps the results from being optimized out
+  return (status_nodes > 0 && found_nodes > 0) ? 0 : 1;
+}
@@ -17,6 +17,7 @@
 #include <iostream>
 #include <algorithm>
 #include <gtest/gtest.h>
+#include <boost/make_shared.hpp>
 #include <emergency_handler/emergency_handler.h>
 #include <emergency_handler/emergency_stop_planner.h>
 #include <emergency_handler/system_status_filter.h>
@@ -92,6 +93,10 @@ public:
 
     target = myobj_->find_target_emergency_planner(2);
     ASSERT_STREQ(target->planner_name().c_str(), "semi-emergency_stop_planner");
+
+    // below all the planners, the one of the highest priority
+    target = myobj_->find_target_emergency_planner(-1);
+    ASSERT_STREQ(target->planner_name().c_str(), "emergency_stop_planner");
   }
 
   void updatePriorityTest(void)
@@ -247,6 +252,22 @@ public:
 
     ASSERT_EQ(myobj_->priority_, 0.0);
   }
+
+  void emergencyStatusCallback(void)
+  {
+    myobj_->priority_ = myobj_->priority_table.no_error;
+    std_msgs::Header header;
+    header.stamp = ros::Time::now();
+    auto node_status = boost::make_shared<autoware_system_msgs::NodeStatus>(
+        SystemStatusFilter::vital_monitor_.createNodeStatus("Test", &header, 2));
+    myobj_->emergencyStatusCallback(node_status);
+    ASSERT_EQ(myobj_->priority_, myobj_->priority_table.no_error);
+
+    node_status->status[0].status[0].level = 3;
+    myobj_->emergencyStatusCallback(node_status);
+    ASSERT_EQ(myobj_->priority_, myobj_->priority_table.node_error);
+    ASSERT_TRUE(myobj_->is_event_received_);
+  }
 };
 
 TEST_F(EmergencyHandlerTestSuite, LoadParamTest)
@@ -294,6 +315,11 @@ TEST_F(EmergencyHandlerTestSuite, NodeStatusCallback)
   nodeStatusCallback();
 }
 
+TEST_F(EmergencyHandlerTestSuite, EmergencyStatusCallback)
+{
+  emergencyStatusCallback();
+}
+
 // Run all the tests that were declared with TEST()
 int main(int argc, char** argv)
 {
@@ -17,6 +17,83 @@
 #include <gnss/geo_pos_conv.hpp>
 
 #include <cmath>
+#include <vector>
+
+namespace
+{
+// WGS84 constants of the Gauss-Kruger projection of conv_llh2xyz, which do not depend on the plane
+struct GaussKrugerConstants
+{
+  double Pmo;    // scale factor on the central meridian
+  double AW;     // semimajor axis
+  double Pe2;    // square of the first eccentricity
+  double Pet2;   // square of the second eccentricity
+  double PB[9];  // meridian arc length is PB[0] * lat + PB[k] * sin(2 * k * lat)
+};
+
+GaussKrugerConstants computeGaussKrugerConstants()
+{
+  // PA to PI of conv_llh2xyz, coefficients of Pe^2 to Pe^16
+  static const double series[9][8] = {
+    { 3.0 / 4.0, 45.0 / 64.0, 175.0 / 256.0, 11025.0 / 16384.0, 43659.0 / 65536.0, 693693.0 / 1048576.0,
+      19324305.0 / 29360128.0, 4927697775.0 / 7516192768.0 },
+    { 3.0 / 4.0, 15.0 / 16.0, 525.0 / 512.0, 2205.0 / 2048.0, 72765.0 / 65536.0, 297297.0 / 262144.0,
+      135270135.0 / 117440512.0, 547521975.0 / 469762048.0 },
+    { 0.0, 15.0 / 64.0, 105.0 / 256.0, 2205.0 / 4096.0, 10395.0 / 16384.0, 1486485.0 / 2097152.0,
+      45090045.0 / 58720256.0, 766530765.0 / 939524096.0 },
+    { 0.0, 0.0, 35.0 / 512.0, 315.0 / 2048.0, 31185.0 / 131072.0, 165165.0 / 524288.0, 45090045.0 / 117440512.0,
+      209053845.0 / 469762048.0 },
+    { 0.0, 0.0, 0.0, 315.0 / 16384.0, 3465.0 / 65536.0, 99099.0 / 1048576.0, 4099095.0 / 29360128.0,
+      348423075.0 / 1879048192.0 },
+    { 0.0, 0.0, 0.0, 0.0, 693.0 / 131072.0, 9009.0 / 524288.0, 4099095.0 / 117440512.0, 26801775.0 / 469762048.0 },
+    { 0.0, 0.0, 0.0, 0.0, 0.0, 3003.0 / 2097152.0, 315315.0 / 58720256.0, 11486475.0 / 939524096.0 },
+    { 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 45045.0 / 117440512.0, 765765.0 / 469762048.0 },
+    { 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 765765.0 / 7516192768.0 },
+  };
+
+  GaussKrugerConstants c;
+  c.Pmo = 0.9999;
+  c.AW = 6378137.0;
+  const double FW = 1.0 / 298.257222101;
+  c.Pe2 = 2.0 * FW - FW * FW;
+  c.Pet2 = c.Pe2 / (1.0 - c.Pe2);
+  for (int k = 0; k < 9; ++k)
+  {
+    // PA starts with 1
+    double sum = (k == 0) ? 1.0 : 0.0;
+    double Pe2n = 1.0;
+    for (int n = 0; n < 8; ++n)
+    {
+      Pe2n *= c.Pe2;
+      sum += series[k][n] * Pe2n;
+    }
+    // PB1 to PB9, divided by 1, -2, 4, -6, ...
+    const double divisor = (k == 0) ? 1.0 : ((k % 2 == 0) ? 2.0 * k : -2.0 * k);
+    c.PB[k] = c.AW * (1.0 - c.Pe2) * sum / divisor;
+  }
+  return c;
+}
+
+const GaussKrugerConstants& gaussKrugerConstants()
+{
+  static const GaussKrugerConstants constants = computeGaussKrugerConstants();
+  return constants;
+}
+
+// meridian arc length from the equator to lat, the sum of sines by the Clenshaw recurrence
+double meridianArcLength(const GaussKrugerConstants& c, const double lat)
+{
+  const double cos_2lat = std::cos(2.0 * lat);
+  double b1 = 0.0, b2 = 0.0;
+  for (int k = 8; k >= 1; --k)
+  {
+    const double b0 = c.PB[k] + 2.0 * cos_2lat * b1 - b2;
+    b2 = b1;
+    b1 = b0;
+  }
+  return c.PB[0] * lat + b1 * std::sin(2.0 * lat);
+}
+}  // namespace
 
 geo_pos_conv::geo_pos_conv()
     : m_x(0)
@@ -27,6 +104,7 @@ geo_pos_conv::geo_pos_conv()
     , m_h(0)
     , m_PLato(0)
     , m_PLo(0)
+    , m_PSo(0)
 {
 }
 
@@ -49,6 +127,7 @@ void geo_pos_conv::set_plane(double lat, double lon)
 {
   m_PLato = lat;
   m_PLo = lon;
+  m_PSo = meridianArcLength(gaussKrugerConstants(), m_PLato);
 }
 
 void geo_pos_conv::set_plane(int num)
@@ -198,6 +277,7 @@ void geo_pos_conv::set_plane(int num)
   // swap longitude and latitude
   m_PLo = M_PI * (static_cast<double>(lat_deg) + static_cast<double>(lat_min) / 60.0) / 180.0;
   m_PLato = M_PI * (static_cast<double>(lon_deg) + static_cast<double>(lon_min) / 60.0) / 180;
+  m_PSo = meridianArcLength(gaussKrugerConstants(), m_PLato);
 }
 
 void geo_pos_conv::set_xyz(double cx, double cy, double cz)
@@ -352,5 +432,111 @@ void geo_pos_conv::conv_llh2xyz(void)
 
 void geo_pos_conv::conv_xyz2llh(void)
 {
-  // n/a
+  const LLH llh = xyz2llh(XYZ{ m_x, m_y, m_z });
+  m_lat = llh.lat;
+  m_lon = llh.lon;
+  m_h = llh.h;
+}
+
+geo_pos_conv::XYZ geo_pos_conv::llh2xyz(const LLH& llh) const
+{
+  // series of conv_llh2xyz in powers of (cos(lat) * PDL)^2, evaluated by Horner's method
+  const GaussKrugerConstants& c = gaussKrugerConstants();
+  const double sin_lat = std::sin(llh.lat);
+  const double cos_lat = std::cos(llh.lat);
+  const double Pt = sin_lat / cos_lat;
+  const double Pt2 = Pt * Pt;
+  const double Pnn2 = c.Pet2 * cos_lat * cos_lat;
+  const double PN = c.AW / std::sqrt(1.0 - c.Pe2 * sin_lat * sin_lat);
+  const double cos_PDL = cos_lat * (llh.lon - m_PLo);
+  const double u = cos_PDL * cos_PDL;
+
+  const double x4 = (5.0 - Pt2 + 9.0 * Pnn2 + 4.0 * Pnn2 * Pnn2) / 24.0;
+  const double x6 = -(-61.0 + 58.0 * Pt2 - Pt2 * Pt2 - 270.0 * Pnn2 + 330.0 * Pt2 * Pnn2) / 720.0;
+  const double x8 = -(-1385.0 + 3111.0 * Pt2 - 543.0 * Pt2 * Pt2 + Pt2 * Pt2 * Pt2) / 40320.0;
+  const double y3 = -(-1.0 + Pt2 - Pnn2) / 6.0;
+  const double y5 = -(-5.0 + 18.0 * Pt2 - Pt2 * Pt2 - 14.0 * Pnn2 + 58.0 * Pt2 * Pnn2) / 120.0;
+  const double y7 = -(-61.0 + 479.0 * Pt2 - 179.0 * Pt2 * Pt2 + Pt2 * Pt2 * Pt2) / 5040.0;
+
+  XYZ xyz;
+  xyz.x = ((meridianArcLength(c, llh.lat) - m_PSo) + PN * Pt * u * (0.5 + u * (x4 + u * (x6 + u * x8)))) * c.Pmo;
+  xyz.y = PN * cos_PDL * (1.0 + u * (y3 + u * (y5 + u * y7))) * c.Pmo;
+  xyz.z = llh.h;
+  return xyz;
+}
+
+geo_pos_conv::LLH geo_pos_conv::xyz2llh(const XYZ& xyz) const
+{
+  const GaussKrugerConstants& c = gaussKrugerConstants();
+
+  // footpoint latitude, whose meridian arc length is the one of x, by Newton's method
+  const double arc = xyz.x / c.Pmo + m_PSo;
+  double lat1 = arc / c.PB[0];
+  for (int i = 0; i < 10; ++i)
+  {
+    const double sin_lat = std::sin(lat1);
+    const double W2 = 1.0 - c.Pe2 * sin_lat * sin_lat;
+    // radius of curvature of the meridian, derivative of the arc length
+    const double PM = c.AW * (1.0 - c.Pe2) / (W2 * std::sqrt(W2));
+    const double step = (meridianArcLength(c, lat1) - arc) / PM;
+    lat1 -= step;
+    if (std::fabs(step) < 1e-14)
+    {
+      break;
+    }
+  }
+
+  const double sin_lat = std::sin(lat1);
+  const double cos_lat = std::cos(lat1);
+  const double Pt = sin_lat / cos_lat;
+  const double Pt2 = Pt * Pt;
+  const double Pt4 = Pt2 * Pt2;
+  const double Pnn2 = c.Pet2 * cos_lat * cos_lat;
+  const double PN = c.AW / std::sqrt(1.0 - c.Pe2 * sin_lat * sin_lat);
+  const double y_PN = xyz.y / c.Pmo / PN;
+  const double w = y_PN * y_PN;
+
+  const double lat4 = (5.0 + 3.0 * Pt2 + 6.0 * Pnn2 - 6.0 * Pt2 * Pnn2 - 3.0 * Pnn2 * Pnn2 -
+                       9.0 * Pt2 * Pnn2 * Pnn2) / 24.0;
+  const double lat6 = (61.0 + 90.0 * Pt2 + 45.0 * Pt4 + 107.0 * Pnn2 - 162.0 * Pt2 * Pnn2 - 45.0 * Pt4 * Pnn2) / 720.0;
+  const double lat8 = (1385.0 + 3633.0 * Pt2 + 4095.0 * Pt4 + 1575.0 * Pt4 * Pt2) / 40320.0;
+  const double lon3 = (1.0 + 2.0 * Pt2 + Pnn2) / 6.0;
+  const double lon5 = (5.0 + 28.0 * Pt2 + 24.0 * Pt4 + 6.0 * Pnn2 + 8.0 * Pt2 * Pnn2) / 120.0;
+  const double lon7 = (61.0 + 662.0 * Pt2 + 1320.0 * Pt4 + 720.0 * Pt4 * Pt2) / 5040.0;
+
+  LLH llh;
+  llh.lat = lat1 - (1.0 + Pnn2) * Pt * w * (0.5 - w * (lat4 - w * (lat6 - w * lat8)));
+  llh.lon = m_PLo + y_PN / cos_lat * (1.0 - w * (lon3 - w * (lon5 - w * lon7)));
+  llh.h = xyz.z;
+  return llh;
+}
+
+void geo_pos_conv::llh2xyz(const LLH* llh, XYZ* xyz, size_t size) const
+{
+  for (size_t i = 0; i < size; ++i)
+  {
+    xyz[i] = llh2xyz(llh[i]);
+  }
+}
+
+void geo_pos_conv::xyz2llh(const XYZ* xyz, LLH* llh, size_t size) const
+{
+  for (size_t i = 0; i < size; ++i)
+  {
+    llh[i] = xyz2llh(xyz[i]);
+  }
+}
+
+std::vector<geo_pos_conv::XYZ> geo_pos_conv::llh2xyz(const std::vector<LLH>& llh) const
+{
+  std::vector<XYZ> xyz(llh.size());
+  llh2xyz(llh.data(), xyz.data(), llh.size());
+  return xyz;
+}
+
+std::vector<geo_pos_conv::LLH> geo_pos_conv::xyz2llh(const std::vector<XYZ>& xyz) const
+{
+  std::vector<LLH> llh(xyz.size());
+  xyz2llh(xyz.data(), llh.data(), xyz.size());
+  return llh;
 }
@@ -0,0 +1,86 @@
+/*
+ * Copyright 2015-2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Compares the conversion of recorded points by llh_to_xyz, one point at a time through the object, with the
+// batch llh2xyz, and times its inverse xyz2llh.
+//
+// geo_pos_conv_benchmark [points] [plane]
+
+#include <gnss/geo_pos_conv.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+int main(int argc, char** argv)
+{
+  const int points = (argc > 1) ? std::atoi(argv[1]) : 1000000;
+  const int plane = (argc > 2) ? std::atoi(argv[2]) : 7;
+  if (points <= 0 || plane < 0 || plane > 19)
+  {
+    std::printf("usage: %s [points] [plane]\n", argv[0]);
+    return 1;
+  }
+
+  geo_pos_conv geo;
+  geo.set_plane(plane);
+  // points within about 50 km of the origin of the plane
+  const geo_pos_conv::LLH origin = geo.xyz2llh(geo_pos_conv::XYZ{ 0.0, 0.0, 0.0 });
+  std::mt19937 rng(0);
+  std::uniform_real_distribution<double> offset(-0.008, 0.008);
+  std::vector<geo_pos_conv::LLH> llh(points);
+  for (auto& p : llh)
+  {
+    p.lat = origin.lat + offset(rng);
+    p.lon = origin.lon + offset(rng);
+    p.h = 50.0;
+  }
+
+  const auto start = std::chrono::steady_clock::now();
+  std::vector<geo_pos_conv::XYZ> setter(points);
+  for (int i = 0; i < points; ++i)
+  {
+    geo.llh_to_xyz(llh[i].lat * 180 / M_PI, llh[i].lon * 180 / M_PI, llh[i].h);
+    setter[i] = geo_pos_conv::XYZ{ geo.x(), geo.y(), geo.z() };
+  }
+  const auto setter_end = std::chrono::steady_clock::now();
+  const std::vector<geo_pos_conv::XYZ> xyz = geo.llh2xyz(llh);
+  const auto batch_end = std::chrono::steady_clock::now();
+  const std::vector<geo_pos_conv::LLH> inverse = geo.xyz2llh(xyz);
+  const auto inverse_end = std::chrono::steady_clock::now();
+
+  double max_diff = 0.0, max_round_trip = 0.0;
+  for (int i = 0; i < points; ++i)
+  {
+    max_diff = std::max(max_diff, std::max(std::fabs(xyz[i].x - setter[i].x), std::fabs(xyz[i].y - setter[i].y)));
+    const geo_pos_conv::XYZ back = geo.llh2xyz(inverse[i]);
+    max_round_trip = std::max(max_round_trip, std::hypot(back.x - xyz[i].x, back.y - xyz[i].y));
+  }
+
+  const auto ns_per_point = [points](std::chrono::steady_clock::duration d) {
+    return std::chrono::duration<double, std::nano>(d).count() / points;
+  };
+  std::printf("%d points on plane %d\n", points, plane);
+  std::printf("llh_to_xyz %10.1f ns/point\n", ns_per_point(setter_end - start));
+  std::printf("llh2xyz    %10.1f ns/point, max diff %g m\n", ns_per_point(batch_end - setter_end), max_diff);
+  std::printf("xyz2llh    %10.1f ns/point, max round trip %g m\n", ns_per_point(inverse_end - batch_end),
+              max_round_trip);
+  return 0;
+}
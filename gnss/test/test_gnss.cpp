@@ -17,6 +17,9 @@
 #include <ros/ros.h>
 #include <gtest/gtest.h>
 
+#include <cmath>
+#include <vector>
+
 #include "gnss/geo_pos_conv.hpp"
 
 TEST(TestSuite, llhNmeaDegreesTest)
@@ -59,6 +62,39 @@ TEST(TestSuite, llhNmeaDegreesTest)
   ASSERT_FLOAT_EQ(10.124025, geo_.geo_pos_conv::z());
 }
 
+TEST(TestSuite, batchConversionTest)
+{
+  geo_pos_conv geo_;
+  geo_.set_plane(9);
+  const geo_pos_conv::LLH origin = geo_.xyz2llh(geo_pos_conv::XYZ{ 0.0, 0.0, 0.0 });
+
+  std::vector<geo_pos_conv::LLH> llh;
+  for (int i = -5; i <= 5; ++i)
+  {
+    // up to about 50 km from the origin of the plane
+    llh.push_back(geo_pos_conv::LLH{ origin.lat + 0.0015 * i, origin.lon - 0.0017 * i, 10.0 * i });
+  }
+  const std::vector<geo_pos_conv::XYZ> xyz = geo_.llh2xyz(llh);
+  const std::vector<geo_pos_conv::LLH> inverse = geo_.xyz2llh(xyz);
+  ASSERT_EQ(llh.size(), xyz.size());
+  ASSERT_EQ(llh.size(), inverse.size());
+
+  for (size_t i = 0; i < llh.size(); ++i)
+  {
+    geo_pos_conv reference;
+    reference.set_plane(9);
+    reference.llh_to_xyz(llh[i].lat * 180 / M_PI, llh[i].lon * 180 / M_PI, llh[i].h);
+    ASSERT_NEAR(reference.x(), xyz[i].x, 1e-6);
+    ASSERT_NEAR(reference.y(), xyz[i].y, 1e-6);
+    ASSERT_DOUBLE_EQ(llh[i].h, xyz[i].z);
+
+    // 1e-9 rad is about 6 mm
+    ASSERT_NEAR(llh[i].lat, inverse[i].lat, 1e-9);
+    ASSERT_NEAR(llh[i].lon, inverse[i].lon, 1e-9);
+    ASSERT_DOUBLE_EQ(llh[i].h, inverse[i].h);
+  }
+}
+
 int main(int argc, char **argv)
 {
   testing::InitGoogleTest(&argc, argv);
@@ -32,6 +32,16 @@ class AutowareOsmParser : public OsmParser
 public:
   using OsmParser::OsmParser;
 
+  /**
+   * [ParseTimings time spent in each phase of parse() in milliseconds]
+   */
+  struct ParseTimings
+  {
+    double osm_parse_ms = 0.0;          // reading and projecting the osm file with the default OsmParser
+    double local_coordinates_ms = 0.0;  // overwriting x and y with local_x and local_y tags
+    double align_ms = 0.0;              // aligning the bounds of the lanelets
+  };
+
   /**
    * [parse parse osm file to laneletMap. It is generally same as default
    * OsmParser, but it will overwrite x and y value with local_x and local_y
@@ -42,6 +52,18 @@ public:
    */
   std::unique_ptr<LaneletMap> parse(const std::string& filename, ErrorMessages& errors) const;  // NOLINT
 
+  /**
+   * [parse same as above. Points and lanelets are post processed in chunks on
+   * "num_threads" threads of the parser configuration (0 or missing: hardware
+   * threads)]
+   * @param  filename [path to osm file]
+   * @param  errors   [any errors catched during parsing]
+   * @param  timings  [time spent in each phase, ignored if null]
+   * @return          [returns LaneletMap]
+   */
+  std::unique_ptr<LaneletMap> parse(const std::string& filename, ErrorMessages& errors,  // NOLINT
+                                    ParseTimings* timings) const;
+
   /**
    * [parseVersions parses MetaInfo tags from osm file]
    * @param filename       [path to osm file]
@@ -25,6 +25,7 @@
 #include <lanelet2_io/Projection.h>
 
 #include <string>
+#include <vector>
 
 namespace lanelet
 {
@@ -51,6 +52,16 @@ public:
    */
   BasicPoint3d forward(const GPSPoint& gps, const int precision) const;
 
+  /**
+   * [MGRSProjector::forward projects list of gps lat/lon to MGRS xyz
+   * coordinate, same as projecting them one by one]
+   * @param  gps_points [points with latitude longitude information]
+   * @param  precision  [resolution of MGRS Grid 0=100km, 1=10km, 2=1km,
+   * 3=100m, 4=10m, 5=1m]
+   * @return            [projected points in MGRS coordinate]
+   */
+  std::vector<BasicPoint3d> forward(const std::vector<GPSPoint>& gps_points, const int precision = 0) const;
+
   /**
    * [MGRSProjector::reverse projects point within MGRS 100km grid into gps
    * lat/lon (WGS84)]
@@ -113,6 +124,24 @@ private:
    * reverse function will use this if isMGRSCodeSet() returns false.
    */
   mutable std::string projected_grid_;
+
+  /**
+   * utm zone, latitude band and cell of projected_grid_, so that points in the
+   * same grid are projected without generating the mgrs code again
+   */
+  mutable bool is_grid_cached_;
+  mutable int cached_zone_;
+  mutable bool cached_northp_;
+  mutable int cached_band_;
+  mutable int cached_precision_;
+  mutable double cached_cell_x_;
+  mutable double cached_cell_y_;
+  mutable double cached_cell_size_;
+
+  bool isInCachedGrid(const int zone, const bool northp, const BasicPoint3d& utm_point, const double lat,
+                      const int precision) const;
+  void cacheGrid(const int zone, const bool northp, const BasicPoint3d& utm_point, const double lat,
+                 const int precision) const;
 };
 
 }  // namespace projection
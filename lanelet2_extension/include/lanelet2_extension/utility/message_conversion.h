@@ -25,6 +25,8 @@
 #include <lanelet2_core/LaneletMap.h>
 #include <autoware_lanelet2_msgs/MapBin.h>
 
+#include <string>
+
 namespace lanelet
 {
 namespace utils
@@ -47,6 +49,33 @@ void toBinMsg(const lanelet::LaneletMapPtr& map, autoware_lanelet2_msgs::MapBin*
  */
 void fromBinMsg(const autoware_lanelet2_msgs::MapBin& msg, lanelet::LaneletMapPtr map);
 
+/**
+ * [toSharedMap copies the data of a bin message into a read only shared
+ * memory segment, so that nodes on the same host can read the map image
+ * without receiving the message. The segment name is derived from the checksum
+ * of the data and the segment stays until removeSharedMap() is called]
+ * @param msg [bin message filled by toBinMsg()]
+ * @return    [segment name, empty if the segment could not be created]
+ */
+std::string toSharedMap(const autoware_lanelet2_msgs::MapBin& msg);
+
+/**
+ * [fromSharedMap converts the map image of a shared memory segment into
+ * lanelet2 data, the image is deserialized in place]
+ * @param name [segment name returned by toSharedMap()]
+ * @param map  [converted lanelet2 data]
+ * @return     [false if the segment does not exist on this host or its data
+ * does not match its checksum, the bin message has to be used then]
+ */
+bool fromSharedMap(const std::string& name, lanelet::LaneletMapPtr map);
+
+/**
+ * [removeSharedMap removes a segment created by toSharedMap(), nodes which
+ * have it open keep their mapping]
+ * @param name [segment name]
+ */
+void removeSharedMap(const std::string& name);
+
 /**
  * [toGeomMsgPt converts various point types to geometry_msgs point]
  * @param src [input point(geometry_msgs::Point3,
@@ -26,8 +26,10 @@
 
 #include <lanelet2_extension/regulatory_elements/autoware_traffic_light.h>
 
-#include <vector>
 #include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace lanelet
 {
@@ -141,6 +143,115 @@ std::vector<lanelet::ConstLineString3d> getRightOfWayStopLines(const lanelet::Co
  */
 std::vector<lanelet::ConstLineString3d> getAllWayStopStopLines(const lanelet::ConstLanelets lanelets);
 
+/**
+ * [QueryContext precomputes the lanelets of a map per subtype so that the
+ * queries run every cycle return references instead of filtering and copying
+ * the lanelet layer. Subtypes are interned into ids, the map must not be
+ * modified while the context is used]
+ */
+class QueryContext
+{
+public:
+  /**
+   * [LaneletRegulatoryElements regulatory elements and stop lines of a
+   * lanelet, as returned by the query functions for this lanelet alone]
+   */
+  struct LaneletRegulatoryElements
+  {
+    std::vector<lanelet::TrafficLightConstPtr> traffic_lights;
+    std::vector<lanelet::AutowareTrafficLightConstPtr> autoware_traffic_lights;
+    std::vector<lanelet::ConstLineString3d> traffic_light_stop_lines;
+    std::vector<lanelet::ConstLineString3d> traffic_sign_stop_lines;
+    std::vector<lanelet::ConstLineString3d> right_of_way_stop_lines;
+    std::vector<lanelet::ConstLineString3d> all_way_stop_stop_lines;
+  };
+
+  /**
+   * @param ll_map       [input lanelet map]
+   * @param stop_sign_id [sign id of stop sign for the traffic sign stop lines]
+   */
+  explicit QueryContext(const lanelet::LaneletMapConstPtr ll_map, const std::string& stop_sign_id = "stop_sign");
+
+  /**
+   * [laneletLayer all lanelets of the map, same as query::laneletLayer()]
+   */
+  const lanelet::ConstLanelets& laneletLayer() const;
+
+  /**
+   * [getSubtypeId interned id of a subtype attribute value]
+   * @param  subtype [subtype (e.g. lanelet::AttributeValueString::Road)]
+   * @return         [id, -1 if no lanelet of the map has this subtype]
+   */
+  int getSubtypeId(const std::string& subtype) const;
+
+  /**
+   * [getLaneletSubtypeId interned subtype of a lanelet of the map]
+   * @param  lanelet_id [id of the lanelet]
+   * @return            [subtype id, -1 if the lanelet has no subtype or is not in the map]
+   */
+  int getLaneletSubtypeId(const lanelet::Id lanelet_id) const;
+
+  /**
+   * [subtypeLanelets lanelets that have given subtype attribute, same as
+   * query::subtypeLanelets(laneletLayer(), subtype)]
+   */
+  const lanelet::ConstLanelets& subtypeLanelets(const std::string& subtype) const;
+  const lanelet::ConstLanelets& subtypeLanelets(const int subtype_id) const;
+  const lanelet::ConstLanelets& roadLanelets() const;
+  const lanelet::ConstLanelets& crosswalkLanelets() const;
+
+  /**
+   * [nearestLanelets searches the n nearest lanelets of each point in the
+   * R-tree of the map]
+   * @param points  [search points]
+   * @param n       [number of lanelets per point]
+   * @param results [distance and lanelet sorted by distance, one vector per point]
+   */
+  void nearestLanelets(const std::vector<lanelet::BasicPoint2d>& points, const size_t n,
+                       std::vector<std::vector<std::pair<double, lanelet::ConstLanelet> > >* results) const;
+
+  /**
+   * [contactingLanelets lanelets which have distance 0m to each point]
+   * @param points     [search points]
+   * @param subtype_id [only lanelets of this subtype, -1 for all]
+   * @param results    [contacting lanelets, one vector per point]
+   */
+  void contactingLanelets(const std::vector<lanelet::BasicPoint2d>& points, const int subtype_id,
+                          std::vector<lanelet::ConstLanelets>* results) const;
+
+  /**
+   * [regulatoryElements indexed regulatory elements of a lanelet of the map]
+   * @param  lanelet_id [id of the lanelet]
+   * @return            [elements of the lanelet, empty if it has none or is not in the map]
+   */
+  const LaneletRegulatoryElements& regulatoryElements(const lanelet::Id lanelet_id) const;
+
+  /**
+   * [same results as the query functions of the same name, looked up in the
+   * index. The stop sign id is the one of the constructor]
+   */
+  std::vector<lanelet::TrafficLightConstPtr> trafficLights(const lanelet::ConstLanelets& lanelets) const;
+  std::vector<lanelet::AutowareTrafficLightConstPtr> autowareTrafficLights(
+      const lanelet::ConstLanelets& lanelets) const;
+  std::vector<lanelet::ConstLineString3d> getTrafficLightStopLines(const lanelet::ConstLanelets& lanelets) const;
+  std::vector<lanelet::ConstLineString3d> getStopSignStopLines(const lanelet::ConstLanelets& lanelets) const;
+  std::vector<lanelet::ConstLineString3d> getTrafficSignStopLines(const lanelet::ConstLanelets& lanelets) const;
+  std::vector<lanelet::ConstLineString3d> getRightOfWayStopLines(const lanelet::ConstLanelets& lanelets) const;
+  std::vector<lanelet::ConstLineString3d> getAllWayStopStopLines(const lanelet::ConstLanelets& lanelets) const;
+
+private:
+  lanelet::LaneletMapConstPtr ll_map_;
+  lanelet::ConstLanelets lanelets_;
+  std::unordered_map<std::string, int> subtype_ids_;
+  std::vector<lanelet::ConstLanelets> subtype_lanelets_;
+  std::unordered_map<lanelet::Id, int> lanelet_subtype_ids_;
+  int road_subtype_id_;
+  int crosswalk_subtype_id_;
+  std::unordered_map<lanelet::Id, LaneletRegulatoryElements> regulatory_elements_;
+
+  void indexRegulatoryElements(const lanelet::ConstLanelet& ll, const std::string& stop_sign_id);
+};
+
 }  // namespace query
 }  // namespace utils
 }  // namespace lanelet
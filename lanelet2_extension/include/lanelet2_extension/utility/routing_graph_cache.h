@@ -0,0 +1,126 @@
+/*
+ * Copyright 2015-2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LANELET2_EXTENSION_UTILITY_ROUTING_GRAPH_CACHE_H
+#define LANELET2_EXTENSION_UTILITY_ROUTING_GRAPH_CACHE_H
+
+#include <lanelet2_core/LaneletMap.h>
+#include <lanelet2_routing/RoutingGraph.h>
+#include <lanelet2_traffic_rules/TrafficRules.h>
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace lanelet
+{
+namespace utils
+{
+/**
+ * [computeMapFingerprint hash of what the routing graph is built from: the
+ * lanelets with their attributes, regulatory elements and bound points. Two
+ * maps with the same fingerprint give the same routing graph]
+ */
+uint64_t computeMapFingerprint(const lanelet::LaneletMap& lanelet_map);
+
+/**
+ * [getRoutingGraphPath file of the routing relations saved next to a map
+ * file, for the traffic rules of the location and participant]
+ */
+std::string getRoutingGraphPath(const std::string& map_path, const std::string& location,
+                                const std::string& participant);
+
+/**
+ * @brief  Relations of the routing graph between lanelet ids, as the routing
+ * graph built for a map and traffic rules gives them. They are saved once
+ * next to the map and loaded by the nodes, so the nodes that only follow
+ * the lanelets do not build the routing graph.
+ * File format, in the byte order of the writer: magic "LLRG", format
+ * version, byte order mark, map fingerprint, location and participant of the
+ * traffic rules, then for every lanelet its id and the ids of its following,
+ * previous, left and right lanelets.
+ */
+class RoutingRelations
+{
+public:
+  static const uint32_t FORMAT_VERSION = 1;
+
+  RoutingRelations();
+
+  /**
+   * [build relations of routing_graph for the lanelets of lanelet_map]
+   */
+  void build(const lanelet::LaneletMap& lanelet_map, const lanelet::routing::RoutingGraph& routing_graph,
+             const lanelet::traffic_rules::TrafficRules& traffic_rules);
+
+  bool save(const std::string& path) const;
+
+  /**
+   * [load relations saved by save(), false if the file is missing or damaged,
+   * or if it was saved for another map or other traffic rules]
+   * @param lanelet_map   [map the relations are used with]
+   * @param traffic_rules [traffic rules the relations are used with]
+   */
+  bool load(const std::string& path, const lanelet::LaneletMap& lanelet_map,
+            const lanelet::traffic_rules::TrafficRules& traffic_rules);
+
+  bool empty() const;
+  uint64_t getMapFingerprint() const;
+
+  /**
+   * @brief  Ids of the related lanelets, empty for an unknown id
+   */
+  const std::vector<lanelet::Id>& following(const lanelet::Id id) const;
+  const std::vector<lanelet::Id>& previous(const lanelet::Id id) const;
+  const std::vector<lanelet::Id>& left(const lanelet::Id id) const;
+  const std::vector<lanelet::Id>& right(const lanelet::Id id) const;
+
+private:
+  struct Relations
+  {
+    std::vector<lanelet::Id> following;
+    std::vector<lanelet::Id> previous;
+    std::vector<lanelet::Id> left;
+    std::vector<lanelet::Id> right;
+  };
+
+  const Relations* find(const lanelet::Id id) const;
+
+  uint64_t map_fingerprint_;
+  std::string location_;
+  std::string participant_;
+  std::unordered_map<lanelet::Id, Relations> relations_;
+};
+
+/**
+ * [getRoutingGraph routing graph of lanelet_map for traffic_rules, built once
+ * per process. Later calls for the same map object and traffic rules get the
+ * same graph as long as the map keeps its fingerprint, the graph of an edited
+ * map is built again]
+ */
+lanelet::routing::RoutingGraphPtr getRoutingGraph(const lanelet::LaneletMapPtr& lanelet_map,
+                                                  const lanelet::traffic_rules::TrafficRules& traffic_rules);
+
+/**
+ * [clearRoutingGraphCache drop the graphs kept by getRoutingGraph()]
+ */
+void clearRoutingGraphCache();
+
+}  // namespace utils
+}  // namespace lanelet
+
+#endif  // LANELET2_EXTENSION_UTILITY_ROUTING_GRAPH_CACHE_H
@@ -23,10 +23,15 @@
 
 #include <lanelet2_routing/Route.h>
 #include <lanelet2_routing/RoutingGraph.h>
+#include <lanelet2_traffic_rules/TrafficRules.h>
 
 #include <autoware_msgs/LaneArray.h>
 
+#include <lanelet2_extension/utility/routing_graph_cache.h>
+
 #include <map>
+#include <unordered_map>
+#include <vector>
 
 namespace lanelet
 {
@@ -45,6 +50,95 @@ void matchWaypointAndLanelet(const lanelet::LaneletMapPtr lanelet_map,
                              const autoware_msgs::LaneArray& lane_array,
                              std::map<int, lanelet::Id>* waypointid2laneletid);
 
+/**
+ * [matchWaypointAndLanelet Matches waypoints and lanelets, dense version of
+ * the above for gids running from 0. The candidate lanelets of the waypoints
+ * are searched in parallel]
+ * @param lanelet_map          [pointer to lanelet2 map]
+ * @param routing_graph        [roughting graph of the map]
+ * @param lane_array           [lane array containing waypoints]
+ * @param waypointid2laneletid [lanelet id indexed by gid(gobal_id) of
+ * waypoints, lanelet::InvalId for unmatched gids. Its size is the largest gid
+ * + 1, negative gids are skipped]
+ */
+void matchWaypointAndLanelet(const lanelet::LaneletMapPtr lanelet_map,
+                             const lanelet::routing::RoutingGraphPtr routing_graph,
+                             const autoware_msgs::LaneArray& lane_array,
+                             std::vector<lanelet::Id>* waypointid2laneletid);
+
+/**
+ * [matchWaypointAndLanelet same as the above with the routing relations
+ * loaded from the file saved next to the map, instead of the routing graph]
+ */
+void matchWaypointAndLanelet(const lanelet::LaneletMapPtr lanelet_map, const RoutingRelations& routing_relations,
+                             const autoware_msgs::LaneArray& lane_array,
+                             std::map<int, lanelet::Id>* waypointid2laneletid);
+void matchWaypointAndLanelet(const lanelet::LaneletMapPtr lanelet_map, const RoutingRelations& routing_relations,
+                             const autoware_msgs::LaneArray& lane_array,
+                             std::vector<lanelet::Id>* waypointid2laneletid);
+
+/**
+ * [WaypointLaneletMatcher matches waypoints and lanelets like
+ * matchWaypointAndLanelet(), and keeps the candidates of every waypoint for
+ * the next lane array. Only the waypoints that are new or moved are searched
+ * again. The routing graph pruning is run again only from the changed
+ * waypoints on (forward pass) and back (backward pass) until the candidates
+ * are the same as before, so an extended route is matched by the cost of its
+ * new part. The waypoints are keyed by gid, lane arrays where a gid appears
+ * more than once are matched from scratch]
+ */
+class WaypointLaneletMatcher
+{
+public:
+  WaypointLaneletMatcher(const lanelet::LaneletMapPtr lanelet_map,
+                         const lanelet::routing::RoutingGraphPtr routing_graph);
+
+  /**
+   * [match same result as matchWaypointAndLanelet()]
+   * @param lane_array           [lane array containing waypoints]
+   * @param waypointid2laneletid [object with key:"gid(gobal_id) of waypoints"
+   * value:"lanelet id"]
+   */
+  void match(const autoware_msgs::LaneArray& lane_array, std::map<int, lanelet::Id>* waypointid2laneletid);
+
+  /**
+   * @brief  Forget the waypoints of the previous lane arrays
+   */
+  void clear();
+
+  /**
+   * @brief  Number of waypoints whose contacting lanelets were searched by the last match()
+   */
+  size_t getNumberOfSearchedWaypoints() const;
+
+  /**
+   * @brief  Number of waypoints whose candidates were pruned again by the last match()
+   */
+  size_t getNumberOfPrunedWaypoints() const;
+
+private:
+  struct MatchedWaypoint
+  {
+    double x;
+    double y;
+    int prev_gid;
+    int next_gid;
+    std::vector<int> contacting_ids;  // lanelets at distance 0
+    std::vector<int> forward_ids;     // after forward pruning
+    std::vector<int> candidate_ids;   // after backward pruning
+    bool searched;
+    bool forward_changed;
+    bool pruned;
+  };
+
+  lanelet::LaneletMapPtr lanelet_map_;
+  lanelet::routing::RoutingGraphPtr routing_graph_;
+  lanelet::traffic_rules::TrafficRulesPtr traffic_rules_;
+  std::unordered_map<int, MatchedWaypoint> matched_waypoints_;
+  size_t num_searched_waypoints_;
+  size_t num_pruned_waypoints_;
+};
+
 /**
  * @brief  Apply a patch for centerline because the original implementation
  * doesn't have enough quality
@@ -29,6 +29,7 @@
 #include <lanelet2_extension/utility/query.h>
 
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace lanelet
@@ -37,7 +38,8 @@ namespace visualization
 {
 /**
  * [polygon2Triangle converts polygon into vector of triangles. Used for
- * triangulation]
+ * triangulation. Simple polygons are partitioned into monotone polygons in
+ * O(n log n), others fall back to ear clipping]
  * @param polygon        [input polygon]
  * @param triangles [array of polygon message, each containing 3 vertices]
  */
@@ -50,6 +52,35 @@ void polygon2Triangle(const geometry_msgs::Polygon& polygon,
  * @param triangles [array of polygon message, each containing 3 vertices]
  */
 void lanelet2Triangle(const lanelet::ConstLanelet& ll, std::vector<geometry_msgs::Polygon>* triangles);
+
+/**
+ * [LaneletTriangleCache keeps triangles of lanelets by lanelet id, so that
+ * markers of a map can be built again without triangulating its lanelets. A
+ * lanelet is triangulated again if its shape changed]
+ */
+class LaneletTriangleCache
+{
+public:
+  /**
+   * [triangles returns same triangles as lanelet2Triangle()]
+   * @param  ll [input lanelet]
+   * @return    [array of polygon message, each containing 3 vertices]
+   */
+  const std::vector<geometry_msgs::Polygon>& triangles(const lanelet::ConstLanelet& ll);
+
+  void clear();
+
+  size_t size() const;
+
+private:
+  struct Entry
+  {
+    geometry_msgs::Polygon polygon;
+    std::vector<geometry_msgs::Polygon> triangles;
+  };
+  std::unordered_map<lanelet::Id, Entry> entries_;
+};
+
 /**
  * [lanelet2Polygon converts lanelet into a polygon]
  * @param ll      [input lanelet]
@@ -69,6 +100,20 @@ void lanelet2Polygon(const lanelet::ConstLanelet& ll, geometry_msgs::Polygon* po
 void lineString2Marker(const lanelet::ConstLineString3d ls, visualization_msgs::Marker* line_strip,
                        const std::string frame_id, const std::string ns, const std_msgs::ColorRGBA c,
                        const float lss = 0.1);
+
+/**
+ * [lineStrings2LineListMarker creates one LINE_LIST marker with the segments of
+ * all the linestrings, a single message instead of one marker per linestring]
+ * @param line_strings [input linestrings]
+ * @param line_list    [output marker message]
+ * @param frame_id     [frame id of the marker]
+ * @param ns           [namespace of the marker]
+ * @param c            [color of the marker]
+ * @param lss          [thickness of the marker]
+ */
+void lineStrings2LineListMarker(const std::vector<lanelet::ConstLineString3d>& line_strings,
+                                visualization_msgs::Marker* line_list, const std::string frame_id,
+                                const std::string ns, const std_msgs::ColorRGBA c, const float lss = 0.1);
 /**
  * [trafficLight2TriangleMarker creates marker to visualize shape of traffic
  * lights]
@@ -88,10 +133,13 @@ void trafficLight2TriangleMarker(const lanelet::ConstLineString3d ls, visualizat
  * @param  lanelets       [input lanelets]
  * @param  c              [color of the boundary]
  * @param  viz_centerline [flag to visuazlize centerline or not]
+ * @param  batch          [one LINE_LIST marker per kind of line instead of
+ *                         one LINE_STRIP marker per line]
  * @return                [created marker array]
  */
 visualization_msgs::MarkerArray laneletsBoundaryAsMarkerArray(const lanelet::ConstLanelets& lanelets,
-                                                              const std_msgs::ColorRGBA c, const bool viz_centerline);
+                                                              const std_msgs::ColorRGBA c, const bool viz_centerline,
+                                                              const bool batch = false);
 /**
  * [laneletsAsTriangleMarkerArray create marker array to visualize shape of the
  * lanelet]
@@ -103,6 +151,19 @@ visualization_msgs::MarkerArray laneletsBoundaryAsMarkerArray(const lanelet::Con
 visualization_msgs::MarkerArray laneletsAsTriangleMarkerArray(const std::string ns,
                                                               const lanelet::ConstLanelets& lanelets,
                                                               const std_msgs::ColorRGBA c);
+/**
+ * [laneletsAsTriangleMarkerArray same as above, triangles are taken from the
+ * cache and added to it]
+ * @param  ns       [namespace of the marker]
+ * @param  lanelets [input lanelets]
+ * @param  c        [color of the marker]
+ * @param  cache    [triangles of lanelets]
+ * @return          [created marker]
+ */
+visualization_msgs::MarkerArray laneletsAsTriangleMarkerArray(const std::string ns,
+                                                              const lanelet::ConstLanelets& lanelets,
+                                                              const std_msgs::ColorRGBA c,
+                                                              LaneletTriangleCache* cache);
 
 /**
  * [laneletDirectionAsMarkerArray create marker array to visualize direction of
@@ -119,11 +180,88 @@ visualization_msgs::MarkerArray laneletDirectionAsMarkerArray(const lanelet::Con
  * @param  name_space   [namespace of the marker]
  * @param  c            [color of the marker]
  * @param  lss          [thickness of the marker]
+ * @param  batch        [one LINE_LIST marker instead of one LINE_STRIP marker
+ *                       per linestring]
  * @return              [created marker array]
  */
 visualization_msgs::MarkerArray lineStringsAsMarkerArray(const std::vector<lanelet::ConstLineString3d> line_strings,
                                                          const std::string name_space, const std_msgs::ColorRGBA c,
-                                                         const double lss);
+                                                         const double lss, const bool batch = false);
+
+/**
+ * [TrafficLightMarkerCache keeps markers of traffic lights by regulatory element
+ * id, so that the shapes and bulbs of a light are built once and only their
+ * colors are written when the light state changes. Lights missing from the
+ * cache are built in parallel. Clear it when another map is loaded]
+ */
+class TrafficLightMarkerCache
+{
+public:
+  /**
+   * [markers returns same markers as autowareTrafficLightsAsMarkerArray(), with
+   * the bulbs in the colors set by setBulbColor()]
+   * @param  tl_reg_elems [traffic light regulatory elements]
+   * @param  c            [color of the shape markers]
+   * @param  duration     [lifetime of the marker]
+   * @return              [created marker array]
+   */
+  visualization_msgs::MarkerArray markers(const std::vector<lanelet::AutowareTrafficLightConstPtr>& tl_reg_elems,
+                                          const std_msgs::ColorRGBA& c, const ros::Duration duration = ros::Duration(),
+                                          const double scale = 1.0);
+
+  /**
+   * [triangleMarkers returns same markers as trafficLightsAsTriangleMarkerArray()]
+   * @param  tl_reg_elems [traffic light regulatory elements]
+   * @param  c            [color of the shape markers]
+   * @param  duration     [lifetime of the marker]
+   * @return              [created marker array]
+   */
+  visualization_msgs::MarkerArray triangleMarkers(const std::vector<lanelet::TrafficLightConstPtr>& tl_reg_elems,
+                                                  const std_msgs::ColorRGBA& c,
+                                                  const ros::Duration duration = ros::Duration(),
+                                                  const double scale = 1.0);
+
+  /**
+   * [setBulbColor sets color of a bulb of a cached traffic light, e.g. to show
+   * which bulbs are lit]
+   * @param  tl_id   [id of the traffic light regulatory element]
+   * @param  bulb_id [id of the point of the bulb]
+   * @param  c       [color of the bulb]
+   * @return         [false if the light or its bulb is not in the cache]
+   */
+  bool setBulbColor(const lanelet::Id tl_id, const lanelet::Id bulb_id, const std_msgs::ColorRGBA& c);
+
+  /**
+   * [resetBulbColors sets bulbs of a cached traffic light back to the color of
+   * their color attribute]
+   * @param  tl_id [id of the traffic light regulatory element]
+   */
+  void resetBulbColors(const lanelet::Id tl_id);
+
+  void clear();
+
+  size_t size() const;
+
+private:
+  struct Entry
+  {
+    // shape markers first, then one marker per bulb
+    visualization_msgs::MarkerArray markers;
+    size_t num_shapes = 0;
+    std::vector<std_msgs::ColorRGBA> bulb_colors;
+    ros::Duration duration;
+    double scale = 1.0;
+  };
+
+  template <class TrafficLightConstPtr, class BuildFunction>
+  visualization_msgs::MarkerArray cachedMarkers(std::unordered_map<lanelet::Id, Entry>* entries,
+                                                const std::vector<TrafficLightConstPtr>& tl_reg_elems,
+                                                const std_msgs::ColorRGBA& c, const ros::Duration duration,
+                                                const double scale, const BuildFunction& build);
+
+  std::unordered_map<lanelet::Id, Entry> entries_;
+  std::unordered_map<lanelet::Id, Entry> triangle_entries_;
+};
 
 /**
  * [autowareTrafficLightsAsMarkerArray creates marker array to visualize traffic
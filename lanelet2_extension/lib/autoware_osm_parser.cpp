@@ -23,36 +23,104 @@
 #include <lanelet2_io/io_handlers/OsmFile.h>
 #include <lanelet2_io/io_handlers/OsmHandler.h>
 
+#include <algorithm>
+#include <chrono>
 #include <string>
+#include <thread>
+#include <vector>
 
 namespace lanelet
 {
 namespace io_handlers
 {
+namespace
+{
+double elapsedMilliseconds(const std::chrono::steady_clock::time_point& start)
+{
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// calls f(begin, end) for consecutive chunks of [0, n), one chunk per thread
+template <class Function>
+void parallelChunks(const size_t n, const size_t num_threads, const Function& f)
+{
+  const size_t num_chunks = std::max<size_t>(1, std::min(num_threads, n));
+  if (num_chunks == 1)
+  {
+    f(0, n);
+    return;
+  }
+
+  std::vector<std::thread> threads;
+  threads.reserve(num_chunks);
+  for (size_t c = 0; c < num_chunks; c++)
+  {
+    threads.emplace_back(f, n * c / num_chunks, n * (c + 1) / num_chunks);
+  }
+  for (auto& thread : threads)
+  {
+    thread.join();
+  }
+}
+}  // namespace
+
 std::unique_ptr<LaneletMap> AutowareOsmParser::parse(const std::string& filename, ErrorMessages& errors) const
 {
+  return parse(filename, errors, nullptr);
+}
+
+std::unique_ptr<LaneletMap> AutowareOsmParser::parse(const std::string& filename, ErrorMessages& errors,
+                                                     ParseTimings* timings) const
+{
+  size_t num_threads = std::max(1u, std::thread::hardware_concurrency());
+  auto num_threads_it = config().find("num_threads");
+  if (num_threads_it != config().end() && num_threads_it->second.asInt().get_value_or(0) > 0)
+  {
+    num_threads = num_threads_it->second.asInt().get();
+  }
+
+  ParseTimings phase_timings;
+  auto start = std::chrono::steady_clock::now();
   auto map = OsmParser::parse(filename, errors);
+  phase_timings.osm_parse_ms = elapsedMilliseconds(start);
 
   // overwrite x and y values if there are local_x, local_y tags
-  for (Point3d point : map->pointLayer)
-  {
-    if (point.hasAttribute("local_x"))
+  start = std::chrono::steady_clock::now();
+  std::vector<Point3d> points(map->pointLayer.begin(), map->pointLayer.end());
+  parallelChunks(points.size(), num_threads, [&points](const size_t begin, const size_t end) {
+    for (size_t i = begin; i < end; i++)
     {
-      point.x() = point.attribute("local_x").asDouble().value();
+      Point3d& point = points[i];
+      if (point.hasAttribute("local_x"))
+      {
+        point.x() = point.attribute("local_x").asDouble().value();
+      }
+      if (point.hasAttribute("local_y"))
+      {
+        point.y() = point.attribute("local_y").asDouble().value();
+      }
     }
-    if (point.hasAttribute("local_y"))
+  });
+  phase_timings.local_coordinates_ms = elapsedMilliseconds(start);
+
+  // rerun align function in just in case
+  start = std::chrono::steady_clock::now();
+  std::vector<Lanelet> lanelets(map->laneletLayer.begin(), map->laneletLayer.end());
+  parallelChunks(lanelets.size(), num_threads, [&lanelets](const size_t begin, const size_t end) {
+    for (size_t i = begin; i < end; i++)
     {
-      point.y() = point.attribute("local_y").asDouble().value();
+      Lanelet& lanelet = lanelets[i];
+      LineString3d new_left, new_right;
+      std::tie(new_left, new_right) = geometry::align(lanelet.leftBound(), lanelet.rightBound());
+      lanelet.setLeftBound(new_left);
+      lanelet.setRightBound(new_right);
     }
-  }
+  });
+  phase_timings.align_ms = elapsedMilliseconds(start);
 
-  // rerun align function in just in case
-  for (Lanelet& lanelet : map->laneletLayer)
+  if (timings != nullptr)
   {
-    LineString3d new_left, new_right;
-    std::tie(new_left, new_right) = geometry::align(lanelet.leftBound(), lanelet.rightBound());
-    lanelet.setLeftBound(new_left);
-    lanelet.setRightBound(new_right);
+    *timings = phase_timings;
   }
 
   return map;
@@ -30,8 +30,13 @@
 
 #include <boost/archive/binary_iarchive.hpp>
 #include <boost/archive/binary_oarchive.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <boost/interprocess/shared_memory_object.hpp>
 
+#include <cstring>
+#include <iomanip>
 #include <sstream>
+#include <streambuf>
 #include <string>
 
 namespace lanelet
@@ -40,6 +45,85 @@ namespace utils
 {
 namespace conversion
 {
+namespace
+{
+// stream buffer appending to the data of a MapBin message
+class MapBinOutBuf : public std::streambuf
+{
+public:
+  explicit MapBinOutBuf(autoware_lanelet2_msgs::MapBin::_data_type* data) : data_(data)
+  {
+  }
+
+protected:
+  std::streamsize xsputn(const char* s, std::streamsize n) override
+  {
+    const int8_t* begin = reinterpret_cast<const int8_t*>(s);
+    data_->insert(data_->end(), begin, begin + n);
+    return n;
+  }
+
+  int_type overflow(int_type c) override
+  {
+    if (!traits_type::eq_int_type(c, traits_type::eof()))
+    {
+      data_->push_back(static_cast<int8_t>(traits_type::to_char_type(c)));
+    }
+    return traits_type::not_eof(c);
+  }
+
+private:
+  autoware_lanelet2_msgs::MapBin::_data_type* data_;
+};
+
+// read only stream buffer over the data of a MapBin message or a shared map image, nothing is copied
+class MapBinInBuf : public std::streambuf
+{
+public:
+  MapBinInBuf(const void* data, const std::size_t size)
+  {
+    // the get area is never written through, std::streambuf just has no const interface
+    char* begin = const_cast<char*>(static_cast<const char*>(data));
+    setg(begin, begin, begin + size);
+  }
+};
+
+void fromBinData(const void* data, const std::size_t size, lanelet::LaneletMapPtr map)
+{
+  MapBinInBuf buf(data, size);
+  boost::archive::binary_iarchive oa(buf);
+  oa >> *map;
+  lanelet::Id id_counter;
+  oa >> id_counter;
+  lanelet::utils::registerId(id_counter);
+}
+
+// start of a shared memory segment written by toSharedMap(), the map image follows
+struct SharedMapHeader
+{
+  uint32_t magic;
+  uint32_t version;
+  uint64_t size;
+  uint64_t checksum;
+};
+
+constexpr uint32_t SHARED_MAP_MAGIC = 0x4d4c4c53;  // "SLLM"
+constexpr uint32_t SHARED_MAP_VERSION = 1;
+
+// FNV-1a 64
+uint64_t computeChecksum(const void* data, const std::size_t size)
+{
+  const uint8_t* bytes = static_cast<const uint8_t*>(data);
+  uint64_t hash = 14695981039346656037ULL;
+  for (std::size_t i = 0; i < size; ++i)
+  {
+    hash ^= bytes[i];
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+}  // namespace
+
 void toBinMsg(const lanelet::LaneletMapPtr& map, autoware_lanelet2_msgs::MapBin* msg)
 {
   if (msg == nullptr)
@@ -48,16 +132,13 @@ void toBinMsg(const lanelet::LaneletMapPtr& map, autoware_lanelet2_msgs::MapBin*
     return;
   }
 
-  std::stringstream ss;
-  boost::archive::binary_oarchive oa(ss);
+  // the archive is written straight into msg->data, the capacity of a reused message is kept
+  msg->data.clear();
+  MapBinOutBuf buf(&msg->data);
+  boost::archive::binary_oarchive oa(buf);
   oa << *map;
   auto id_counter = lanelet::utils::getId();
   oa << id_counter;
-
-  std::string data_str(ss.str());
-
-  msg->data.clear();
-  msg->data.assign(data_str.begin(), data_str.end());
 }
 
 void fromBinMsg(const autoware_lanelet2_msgs::MapBin& msg, lanelet::LaneletMapPtr map)
@@ -68,19 +149,90 @@ void fromBinMsg(const autoware_lanelet2_msgs::MapBin& msg, lanelet::LaneletMapPt
     return;
   }
 
-  std::string data_str;
-  data_str.assign(msg.data.begin(), msg.data.end());
-
-  std::stringstream ss;
-  ss << data_str;
-  boost::archive::binary_iarchive oa(ss);
-  oa >> *map;
-  lanelet::Id id_counter;
-  oa >> id_counter;
-  lanelet::utils::registerId(id_counter);
+  fromBinData(msg.data.data(), msg.data.size(), map);
   // *map = std::move(laneletMap);
 }
 
+std::string toSharedMap(const autoware_lanelet2_msgs::MapBin& msg)
+{
+  SharedMapHeader header;
+  header.magic = SHARED_MAP_MAGIC;
+  header.version = SHARED_MAP_VERSION;
+  header.size = msg.data.size();
+  header.checksum = computeChecksum(msg.data.data(), msg.data.size());
+
+  std::ostringstream name;
+  name << "lanelet2_map_" << std::hex << std::setw(16) << std::setfill('0') << header.checksum;
+
+  try
+  {
+    // a segment of the same name from an earlier run holds the same image, it is simply written again
+    boost::interprocess::shared_memory_object::remove(name.str().c_str());
+    boost::interprocess::shared_memory_object shm(boost::interprocess::create_only, name.str().c_str(),
+                                                  boost::interprocess::read_write);
+    shm.truncate(sizeof(header) + msg.data.size());
+    boost::interprocess::mapped_region region(shm, boost::interprocess::read_write);
+    char* dst = static_cast<char*>(region.get_address());
+    std::memcpy(dst + sizeof(header), msg.data.data(), msg.data.size());
+    // the header goes last, readers opening the segment before see a zero magic
+    std::memcpy(dst, &header, sizeof(header));
+  }
+  catch (boost::interprocess::interprocess_exception& ex)
+  {
+    ROS_ERROR_STREAM(__FUNCTION__ << ": failed to create shared memory " << name.str() << ": " << ex.what());
+    boost::interprocess::shared_memory_object::remove(name.str().c_str());
+    return std::string();
+  }
+  return name.str();
+}
+
+bool fromSharedMap(const std::string& name, lanelet::LaneletMapPtr map)
+{
+  if (!map)
+  {
+    ROS_ERROR_STREAM(__FUNCTION__ << ": map is null pointer!");
+    return false;
+  }
+
+  try
+  {
+    boost::interprocess::shared_memory_object shm(boost::interprocess::open_only, name.c_str(),
+                                                  boost::interprocess::read_only);
+    boost::interprocess::mapped_region region(shm, boost::interprocess::read_only);
+    if (region.get_size() < sizeof(SharedMapHeader))
+    {
+      return false;
+    }
+
+    SharedMapHeader header;
+    const char* src = static_cast<const char*>(region.get_address());
+    std::memcpy(&header, src, sizeof(header));
+    if (header.magic != SHARED_MAP_MAGIC || header.version != SHARED_MAP_VERSION ||
+        header.size > region.get_size() - sizeof(header) ||
+        header.checksum != computeChecksum(src + sizeof(header), header.size))
+    {
+      ROS_WARN_STREAM(__FUNCTION__ << ": shared memory " << name << " does not hold a valid map image");
+      return false;
+    }
+
+    fromBinData(src + sizeof(header), header.size, map);
+  }
+  catch (boost::interprocess::interprocess_exception& ex)
+  {
+    // not created on this host
+    return false;
+  }
+  return true;
+}
+
+void removeSharedMap(const std::string& name)
+{
+  if (!name.empty())
+  {
+    boost::interprocess::shared_memory_object::remove(name.c_str());
+  }
+}
+
 void toGeomMsgPt(const geometry_msgs::Point32& src, geometry_msgs::Point* dst)
 {
   if (dst == nullptr)
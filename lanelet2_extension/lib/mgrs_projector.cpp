@@ -19,6 +19,8 @@
 #include <lanelet2_extension/projection/mgrs_projector.h>
 #include <ros/ros.h>
 
+#include <algorithm>
+#include <cmath>
 #include <vector>
 #include <set>
 #include <string>
@@ -27,7 +29,30 @@ namespace lanelet
 {
 namespace projection
 {
-MGRSProjector::MGRSProjector(Origin origin) : Projector(origin)
+namespace
+{
+// distance from the cell border within which the mgrs code is always generated, so that rounding in
+// GeographicLib::MGRS::Forward cannot put the point into the neighbouring cell
+constexpr double CELL_BORDER_MARGIN = 1e-3;
+
+// same latitude band index as GeographicLib::MGRS
+int latitudeBand(const double lat)
+{
+  int ilat = static_cast<int>(std::floor(lat));
+  return std::max(-10, std::min(9, (ilat + 80) / 8 - 10));
+}
+}  // namespace
+
+MGRSProjector::MGRSProjector(Origin origin)
+  : Projector(origin)
+  , is_grid_cached_(false)
+  , cached_zone_(0)
+  , cached_northp_(false)
+  , cached_band_(0)
+  , cached_precision_(0)
+  , cached_cell_x_(0.0)
+  , cached_cell_y_(0.0)
+  , cached_cell_size_(0.0)
 {
 }
 
@@ -39,8 +64,6 @@ BasicPoint3d MGRSProjector::forward(const GPSPoint& gps) const
 
 BasicPoint3d MGRSProjector::forward(const GPSPoint& gps, const int precision) const
 {
-  std::string prev_projected_grid = projected_grid_;
-
   BasicPoint3d mgrs_point{ 0., 0., gps.ele };
   BasicPoint3d utm_point{ 0., 0., gps.ele };
   int zone;
@@ -50,7 +73,6 @@ BasicPoint3d MGRSProjector::forward(const GPSPoint& gps, const int precision) co
   try
   {
     GeographicLib::UTMUPS::Forward(gps.lat, gps.lon, zone, northp, utm_point.x(), utm_point.y());
-    GeographicLib::MGRS::Forward(zone, northp, utm_point.x(), utm_point.y(), gps.lat, precision, mgrs_code);
   }
   catch (GeographicLib::GeographicErr err)
   {
@@ -61,7 +83,26 @@ BasicPoint3d MGRSProjector::forward(const GPSPoint& gps, const int precision) co
   // get mgrs values from utm values
   mgrs_point.x() = fmod(utm_point.x(), 1e5);
   mgrs_point.y() = fmod(utm_point.y(), 1e5);
+
+  // nearly all points of a map are in the same grid, so its code does not have to be generated again
+  if (isInCachedGrid(zone, northp, utm_point, gps.lat, precision))
+  {
+    return mgrs_point;
+  }
+
+  try
+  {
+    GeographicLib::MGRS::Forward(zone, northp, utm_point.x(), utm_point.y(), gps.lat, precision, mgrs_code);
+  }
+  catch (GeographicLib::GeographicErr err)
+  {
+    ROS_ERROR_STREAM(err.what());
+    return BasicPoint3d{ 0., 0., gps.ele };
+  }
+
+  std::string prev_projected_grid = projected_grid_;
   projected_grid_ = mgrs_code;
+  cacheGrid(zone, northp, utm_point, gps.lat, precision);
 
   if (!prev_projected_grid.empty() && prev_projected_grid != projected_grid_)
   {
@@ -74,6 +115,45 @@ BasicPoint3d MGRSProjector::forward(const GPSPoint& gps, const int precision) co
   return mgrs_point;
 }
 
+std::vector<BasicPoint3d> MGRSProjector::forward(const std::vector<GPSPoint>& gps_points, const int precision) const
+{
+  std::vector<BasicPoint3d> mgrs_points;
+  mgrs_points.reserve(gps_points.size());
+  for (const auto& gps : gps_points)
+  {
+    mgrs_points.push_back(forward(gps, precision));
+  }
+  return mgrs_points;
+}
+
+bool MGRSProjector::isInCachedGrid(const int zone, const bool northp, const BasicPoint3d& utm_point, const double lat,
+                                   const int precision) const
+{
+  if (!is_grid_cached_ || zone != cached_zone_ || northp != cached_northp_ || precision != cached_precision_ ||
+      latitudeBand(lat) != cached_band_)
+  {
+    return false;
+  }
+  const double dx = utm_point.x() - cached_cell_x_;
+  const double dy = utm_point.y() - cached_cell_y_;
+  return dx >= CELL_BORDER_MARGIN && dx <= cached_cell_size_ - CELL_BORDER_MARGIN && dy >= CELL_BORDER_MARGIN &&
+         dy <= cached_cell_size_ - CELL_BORDER_MARGIN;
+}
+
+void MGRSProjector::cacheGrid(const int zone, const bool northp, const BasicPoint3d& utm_point, const double lat,
+                              const int precision) const
+{
+  // mgrs grid of polar regions is not aligned with utm cells
+  is_grid_cached_ = zone != GeographicLib::UTMUPS::UPS;
+  cached_zone_ = zone;
+  cached_northp_ = northp;
+  cached_band_ = latitudeBand(lat);
+  cached_precision_ = precision;
+  cached_cell_size_ = pow(10, 5 - precision);
+  cached_cell_x_ = std::floor(utm_point.x() / cached_cell_size_) * cached_cell_size_;
+  cached_cell_y_ = std::floor(utm_point.y() / cached_cell_size_) * cached_cell_size_;
+}
+
 GPSPoint MGRSProjector::reverse(const BasicPoint3d& mgrs_point) const
 {
   GPSPoint gps{ 0., 0., 0. };
@@ -20,11 +20,16 @@
 
 #include <Eigen/Eigen>
 
+#include <lanelet2_core/geometry/Lanelet.h>
+#include <lanelet2_core/geometry/LaneletMap.h>
+
 #include <lanelet2_extension/utility/message_conversion.h>
 #include <lanelet2_extension/utility/query.h>
 
 #include <set>
 #include <string>
+#include <unordered_set>
+#include <utility>
 #include <vector>
 
 namespace lanelet
@@ -294,5 +299,260 @@ std::vector<lanelet::ConstLineString3d> query::getAllWayStopStopLines(const lane
   return stoplines;
 }
 
+query::QueryContext::QueryContext(const lanelet::LaneletMapConstPtr ll_map, const std::string& stop_sign_id)
+  : ll_map_(ll_map), road_subtype_id_(-1), crosswalk_subtype_id_(-1)
+{
+  if (!ll_map_)
+  {
+    ROS_WARN("No map received!");
+    return;
+  }
+
+  lanelets_.reserve(ll_map_->laneletLayer.size());
+  lanelet_subtype_ids_.reserve(ll_map_->laneletLayer.size());
+  for (const auto& ll : ll_map_->laneletLayer)
+  {
+    lanelets_.push_back(ll);
+    indexRegulatoryElements(ll, stop_sign_id);
+    if (!ll.hasAttribute(lanelet::AttributeName::Subtype))
+    {
+      continue;
+    }
+
+    // intern the subtype, each one has a bucket
+    auto subtype = subtype_ids_.emplace(ll.attribute(lanelet::AttributeName::Subtype).value(),
+                                        static_cast<int>(subtype_ids_.size()));
+    if (subtype.second)
+    {
+      subtype_lanelets_.emplace_back();
+    }
+    subtype_lanelets_[subtype.first->second].push_back(ll);
+    lanelet_subtype_ids_[ll.id()] = subtype.first->second;
+  }
+
+  road_subtype_id_ = getSubtypeId(lanelet::AttributeValueString::Road);
+  crosswalk_subtype_id_ = getSubtypeId(lanelet::AttributeValueString::Crosswalk);
+}
+
+const lanelet::ConstLanelets& query::QueryContext::laneletLayer() const
+{
+  return lanelets_;
+}
+
+int query::QueryContext::getSubtypeId(const std::string& subtype) const
+{
+  auto it = subtype_ids_.find(subtype);
+  return (it != subtype_ids_.end()) ? it->second : -1;
+}
+
+int query::QueryContext::getLaneletSubtypeId(const lanelet::Id lanelet_id) const
+{
+  auto it = lanelet_subtype_ids_.find(lanelet_id);
+  return (it != lanelet_subtype_ids_.end()) ? it->second : -1;
+}
+
+const lanelet::ConstLanelets& query::QueryContext::subtypeLanelets(const std::string& subtype) const
+{
+  return subtypeLanelets(getSubtypeId(subtype));
+}
+
+const lanelet::ConstLanelets& query::QueryContext::subtypeLanelets(const int subtype_id) const
+{
+  static const lanelet::ConstLanelets empty_lanelets;
+  if (subtype_id < 0 || subtype_id >= static_cast<int>(subtype_lanelets_.size()))
+  {
+    return empty_lanelets;
+  }
+  return subtype_lanelets_[subtype_id];
+}
+
+const lanelet::ConstLanelets& query::QueryContext::roadLanelets() const
+{
+  return subtypeLanelets(road_subtype_id_);
+}
+
+const lanelet::ConstLanelets& query::QueryContext::crosswalkLanelets() const
+{
+  return subtypeLanelets(crosswalk_subtype_id_);
+}
+
+void query::QueryContext::nearestLanelets(
+    const std::vector<lanelet::BasicPoint2d>& points, const size_t n,
+    std::vector<std::vector<std::pair<double, lanelet::ConstLanelet> > >* results) const
+{
+  if (results == nullptr)
+  {
+    ROS_ERROR_STREAM(__FUNCTION__ << " results is null pointer!");
+    return;
+  }
+
+  results->resize(points.size());
+  for (size_t i = 0; i < points.size(); ++i)
+  {
+    (*results)[i].clear();
+    if (ll_map_)
+    {
+      (*results)[i] = lanelet::geometry::findNearest(ll_map_->laneletLayer, points[i], n);
+    }
+  }
+}
+
+void query::QueryContext::contactingLanelets(const std::vector<lanelet::BasicPoint2d>& points, const int subtype_id,
+                                             std::vector<lanelet::ConstLanelets>* results) const
+{
+  if (results == nullptr)
+  {
+    ROS_ERROR_STREAM(__FUNCTION__ << " results is null pointer!");
+    return;
+  }
+
+  const double epsilon = 1e-6;
+  results->resize(points.size());
+  for (size_t i = 0; i < points.size(); ++i)
+  {
+    auto& contacting_lanelets = (*results)[i];
+    contacting_lanelets.clear();
+    if (!ll_map_)
+    {
+      continue;
+    }
+
+    // the R-tree gives the lanelets whose bounding box contains the point
+    for (const auto& ll : ll_map_->laneletLayer.search(lanelet::BoundingBox2d(points[i], points[i])))
+    {
+      if (subtype_id >= 0 && getLaneletSubtypeId(ll.id()) != subtype_id)
+      {
+        continue;
+      }
+      if (lanelet::geometry::distance2d(ll, points[i]) < epsilon)
+      {
+        contacting_lanelets.push_back(ll);
+      }
+    }
+  }
+}
+
+void query::QueryContext::indexRegulatoryElements(const lanelet::ConstLanelet& ll, const std::string& stop_sign_id)
+{
+  if (ll.regulatoryElements().empty())
+  {
+    return;
+  }
+
+  // one lanelet alone, so the lookups below give the same results as the query functions
+  const lanelet::ConstLanelets lls{ ll };
+  LaneletRegulatoryElements elements;
+  elements.traffic_lights = query::trafficLights(lls);
+  elements.autoware_traffic_lights = query::autowareTrafficLights(lls);
+  elements.traffic_light_stop_lines = query::getTrafficLightStopLines(ll);
+  elements.traffic_sign_stop_lines = query::getTrafficSignStopLines(lls, stop_sign_id);
+  elements.right_of_way_stop_lines = query::getRightOfWayStopLines(lls);
+  elements.all_way_stop_stop_lines = query::getAllWayStopStopLines(lls);
+  regulatory_elements_.emplace(ll.id(), std::move(elements));
+}
+
+const query::QueryContext::LaneletRegulatoryElements&
+query::QueryContext::regulatoryElements(const lanelet::Id lanelet_id) const
+{
+  static const LaneletRegulatoryElements empty_elements;
+  auto it = regulatory_elements_.find(lanelet_id);
+  return (it != regulatory_elements_.end()) ? it->second : empty_elements;
+}
+
+namespace
+{
+lanelet::Id getElementId(const lanelet::TrafficLightConstPtr& item)
+{
+  return item->id();
+}
+
+lanelet::Id getElementId(const lanelet::AutowareTrafficLightConstPtr& item)
+{
+  return item->id();
+}
+
+lanelet::Id getElementId(const lanelet::ConstLineString3d& item)
+{
+  return item.id();
+}
+
+// concatenation of one member of the indexed elements of lanelets, dropping the items whose id was already added
+// when unique is set
+template <class T, class Member>
+std::vector<T> collectElements(const query::QueryContext& context, const lanelet::ConstLanelets& lanelets,
+                               Member member, const bool unique)
+{
+  std::vector<T> items;
+  std::unordered_set<lanelet::Id> ids;
+  for (const auto& ll : lanelets)
+  {
+    for (const auto& item : context.regulatoryElements(ll.id()).*member)
+    {
+      if (!unique || ids.insert(getElementId(item)).second)
+      {
+        items.push_back(item);
+      }
+    }
+  }
+  return items;
+}
+}  // namespace
+
+std::vector<lanelet::TrafficLightConstPtr>
+query::QueryContext::trafficLights(const lanelet::ConstLanelets& lanelets) const
+{
+  return collectElements<lanelet::TrafficLightConstPtr>(*this, lanelets, &LaneletRegulatoryElements::traffic_lights,
+                                                        true);
+}
+
+std::vector<lanelet::AutowareTrafficLightConstPtr>
+query::QueryContext::autowareTrafficLights(const lanelet::ConstLanelets& lanelets) const
+{
+  return collectElements<lanelet::AutowareTrafficLightConstPtr>(
+      *this, lanelets, &LaneletRegulatoryElements::autoware_traffic_lights, true);
+}
+
+std::vector<lanelet::ConstLineString3d>
+query::QueryContext::getTrafficLightStopLines(const lanelet::ConstLanelets& lanelets) const
+{
+  return collectElements<lanelet::ConstLineString3d>(*this, lanelets,
+                                                     &LaneletRegulatoryElements::traffic_light_stop_lines, false);
+}
+
+std::vector<lanelet::ConstLineString3d>
+query::QueryContext::getTrafficSignStopLines(const lanelet::ConstLanelets& lanelets) const
+{
+  return collectElements<lanelet::ConstLineString3d>(*this, lanelets,
+                                                     &LaneletRegulatoryElements::traffic_sign_stop_lines, true);
+}
+
+std::vector<lanelet::ConstLineString3d>
+query::QueryContext::getRightOfWayStopLines(const lanelet::ConstLanelets& lanelets) const
+{
+  return collectElements<lanelet::ConstLineString3d>(*this, lanelets,
+                                                     &LaneletRegulatoryElements::right_of_way_stop_lines, false);
+}
+
+std::vector<lanelet::ConstLineString3d>
+query::QueryContext::getAllWayStopStopLines(const lanelet::ConstLanelets& lanelets) const
+{
+  return collectElements<lanelet::ConstLineString3d>(*this, lanelets,
+                                                     &LaneletRegulatoryElements::all_way_stop_stop_lines, false);
+}
+
+std::vector<lanelet::ConstLineString3d>
+query::QueryContext::getStopSignStopLines(const lanelet::ConstLanelets& lanelets) const
+{
+  std::vector<lanelet::ConstLineString3d> all_stoplines = getTrafficSignStopLines(lanelets);
+  std::vector<lanelet::ConstLineString3d> right_of_way_stoplines = getRightOfWayStopLines(lanelets);
+  std::vector<lanelet::ConstLineString3d> all_way_stop_stoplines = getAllWayStopStopLines(lanelets);
+
+  all_stoplines.reserve(all_stoplines.size() + right_of_way_stoplines.size() + all_way_stop_stoplines.size());
+  all_stoplines.insert(all_stoplines.end(), right_of_way_stoplines.begin(), right_of_way_stoplines.end());
+  all_stoplines.insert(all_stoplines.end(), all_way_stop_stoplines.begin(), all_way_stop_stoplines.end());
+
+  return all_stoplines;
+}
+
 }  // namespace utils
 }  // namespace lanelet
@@ -0,0 +1,477 @@
+/*
+ * Copyright 2015-2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <lanelet2_extension/utility/routing_graph_cache.h>
+
+#include <ros/ros.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace lanelet
+{
+namespace utils
+{
+namespace
+{
+const char ROUTING_MAGIC[4] = { 'L', 'L', 'R', 'G' };
+const uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+// FNV-1a, the fingerprint must not depend on the process
+class Fingerprint
+{
+public:
+  Fingerprint() : hash_(14695981039346656037ULL)
+  {
+  }
+
+  void add(const void* data, const size_t size)
+  {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; ++i)
+    {
+      hash_ = (hash_ ^ bytes[i]) * 1099511628211ULL;
+    }
+  }
+
+  template <typename T>
+  void add(const T& value)
+  {
+    add(&value, sizeof(value));
+  }
+
+  void add(const std::string& value)
+  {
+    add(static_cast<uint64_t>(value.size()));
+    add(value.data(), value.size());
+  }
+
+  void add(const lanelet::AttributeMap& attributes)
+  {
+    add(static_cast<uint64_t>(attributes.size()));
+    for (const auto& attribute : attributes)
+    {
+      add(attribute.first);
+      add(attribute.second.value());
+    }
+  }
+
+  void add(const lanelet::ConstLineString3d& line)
+  {
+    add(line.id());
+    add(line.inverted());
+    add(line.attributes());
+    add(static_cast<uint64_t>(line.size()));
+    for (const auto& point : line)
+    {
+      add(point.id());
+      add(point.x());
+      add(point.y());
+      add(point.z());
+    }
+  }
+
+  uint64_t get() const
+  {
+    return hash_;
+  }
+
+private:
+  uint64_t hash_;
+};
+
+template <class Layer>
+std::vector<typename Layer::ConstPrimitiveT> sortedById(const Layer& layer)
+{
+  std::vector<typename Layer::ConstPrimitiveT> primitives(layer.begin(), layer.end());
+  std::sort(primitives.begin(), primitives.end(),
+            [](const typename Layer::ConstPrimitiveT& a, const typename Layer::ConstPrimitiveT& b) {  // NOLINT
+              return a.id() < b.id();
+            });
+  return primitives;
+}
+
+void addRegulatoryElements(const lanelet::RegulatoryElementConstPtrs& regulatory_elements, Fingerprint* fingerprint)
+{
+  fingerprint->add(static_cast<uint64_t>(regulatory_elements.size()));
+  for (const auto& regulatory_element : regulatory_elements)
+  {
+    fingerprint->add(regulatory_element->id());
+    fingerprint->add(regulatory_element->attributes());
+  }
+}
+
+void toIds(const lanelet::ConstLanelets& lanelets, std::vector<lanelet::Id>* ids)
+{
+  ids->clear();
+  for (const auto& lanelet : lanelets)
+  {
+    ids->push_back(lanelet.id());
+  }
+  std::sort(ids->begin(), ids->end());
+}
+
+void toIds(const lanelet::Optional<lanelet::ConstLanelet>& lanelet, std::vector<lanelet::Id>* ids)
+{
+  ids->clear();
+  if (lanelet)
+  {
+    ids->push_back(lanelet->id());
+  }
+}
+
+template <typename T>
+void write(std::ofstream& file, const T& value)
+{
+  file.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void write(std::ofstream& file, const std::string& value)
+{
+  write(file, static_cast<uint32_t>(value.size()));
+  file.write(value.data(), value.size());
+}
+
+void write(std::ofstream& file, const std::vector<lanelet::Id>& ids)
+{
+  write(file, static_cast<uint32_t>(ids.size()));
+  file.write(reinterpret_cast<const char*>(ids.data()), ids.size() * sizeof(lanelet::Id));
+}
+
+template <typename T>
+bool read(std::ifstream& file, T* value)
+{
+  return static_cast<bool>(file.read(reinterpret_cast<char*>(value), sizeof(*value)));
+}
+
+// the sizes are checked against the bytes left, so a damaged file can't ask for a huge allocation
+bool read(std::ifstream& file, const uint64_t file_size, std::string* value)
+{
+  uint32_t size;
+  if (!read(file, &size) || static_cast<uint64_t>(file.tellg()) + size > file_size)
+  {
+    return false;
+  }
+  value->resize(size);
+  return static_cast<bool>(file.read(&(*value)[0], size));
+}
+
+bool read(std::ifstream& file, const uint64_t file_size, std::vector<lanelet::Id>* ids)
+{
+  uint32_t size;
+  if (!read(file, &size) || static_cast<uint64_t>(file.tellg()) + size * sizeof(lanelet::Id) > file_size)
+  {
+    return false;
+  }
+  ids->resize(size);
+  return static_cast<bool>(file.read(reinterpret_cast<char*>(ids->data()), size * sizeof(lanelet::Id)));
+}
+
+struct CachedRoutingGraph
+{
+  std::weak_ptr<lanelet::LaneletMap> lanelet_map;
+  const lanelet::LaneletMap* lanelet_map_address;
+  std::string location;
+  std::string participant;
+  uint64_t map_fingerprint;
+  lanelet::routing::RoutingGraphPtr routing_graph;
+};
+
+std::mutex g_routing_graph_mutex;
+std::vector<CachedRoutingGraph> g_routing_graphs;
+}  // namespace
+
+uint64_t computeMapFingerprint(const lanelet::LaneletMap& lanelet_map)
+{
+  Fingerprint fingerprint;
+  const auto lanelets = sortedById(lanelet_map.laneletLayer);
+  fingerprint.add(static_cast<uint64_t>(lanelets.size()));
+  for (const auto& lanelet : lanelets)
+  {
+    fingerprint.add(lanelet.id());
+    fingerprint.add(lanelet.inverted());
+    fingerprint.add(lanelet.attributes());
+    fingerprint.add(lanelet.leftBound());
+    fingerprint.add(lanelet.rightBound());
+    addRegulatoryElements(lanelet.regulatoryElements(), &fingerprint);
+  }
+  // areas are passable parts of the routing graph too
+  const auto areas = sortedById(lanelet_map.areaLayer);
+  fingerprint.add(static_cast<uint64_t>(areas.size()));
+  for (const auto& area : areas)
+  {
+    fingerprint.add(area.id());
+    fingerprint.add(area.attributes());
+    for (const auto& bound : area.outerBound())
+    {
+      fingerprint.add(bound);
+    }
+    addRegulatoryElements(area.regulatoryElements(), &fingerprint);
+  }
+  return fingerprint.get();
+}
+
+std::string getRoutingGraphPath(const std::string& map_path, const std::string& location,
+                                const std::string& participant)
+{
+  std::string path = map_path + "." + location + "_" + participant + ".routing";
+  std::replace(path.begin() + map_path.size(), path.end(), ':', '_');
+  return path;
+}
+
+RoutingRelations::RoutingRelations() : map_fingerprint_(0)
+{
+}
+
+void RoutingRelations::build(const lanelet::LaneletMap& lanelet_map,
+                             const lanelet::routing::RoutingGraph& routing_graph,
+                             const lanelet::traffic_rules::TrafficRules& traffic_rules)
+{
+  map_fingerprint_ = computeMapFingerprint(lanelet_map);
+  location_ = traffic_rules.location();
+  participant_ = traffic_rules.participant();
+  relations_.clear();
+  relations_.reserve(lanelet_map.laneletLayer.size());
+  for (const auto& lanelet : lanelet_map.laneletLayer)
+  {
+    Relations& relations = relations_[lanelet.id()];
+    toIds(routing_graph.following(lanelet), &relations.following);
+    toIds(routing_graph.previous(lanelet), &relations.previous);
+    toIds(routing_graph.left(lanelet), &relations.left);
+    toIds(routing_graph.right(lanelet), &relations.right);
+  }
+}
+
+bool RoutingRelations::save(const std::string& path) const
+{
+  // written aside and renamed, so a reader never sees a partial file
+  const std::string tmp_path = path + ".tmp";
+  {
+    std::ofstream file(tmp_path, std::ios::binary | std::ios::trunc);
+    if (!file)
+    {
+      ROS_ERROR_STREAM("Failed to open " << tmp_path << " to save the routing graph");
+      return false;
+    }
+    file.write(ROUTING_MAGIC, sizeof(ROUTING_MAGIC));
+    write(file, FORMAT_VERSION);
+    write(file, BYTE_ORDER_MARK);
+    write(file, map_fingerprint_);
+    write(file, location_);
+    write(file, participant_);
+
+    // sorted by id so the same relations always give the same file
+    std::vector<lanelet::Id> ids;
+    ids.reserve(relations_.size());
+    for (const auto& relations : relations_)
+    {
+      ids.push_back(relations.first);
+    }
+    std::sort(ids.begin(), ids.end());
+    write(file, static_cast<uint64_t>(ids.size()));
+    for (const auto id : ids)
+    {
+      const Relations& relations = relations_.at(id);
+      write(file, id);
+      write(file, relations.following);
+      write(file, relations.previous);
+      write(file, relations.left);
+      write(file, relations.right);
+    }
+    if (!file.flush())
+    {
+      ROS_ERROR_STREAM("Failed to write the routing graph to " << tmp_path);
+      std::remove(tmp_path.c_str());
+      return false;
+    }
+  }
+  if (std::rename(tmp_path.c_str(), path.c_str()) != 0)
+  {
+    ROS_ERROR_STREAM("Failed to rename " << tmp_path << " to " << path);
+    std::remove(tmp_path.c_str());
+    return false;
+  }
+  return true;
+}
+
+bool RoutingRelations::load(const std::string& path, const lanelet::LaneletMap& lanelet_map,
+                            const lanelet::traffic_rules::TrafficRules& traffic_rules)
+{
+  relations_.clear();
+  map_fingerprint_ = 0;
+
+  std::ifstream file(path, std::ios::binary | std::ios::ate);
+  if (!file)
+  {
+    return false;
+  }
+  const uint64_t file_size = file.tellg();
+  file.seekg(0);
+
+  char magic[sizeof(ROUTING_MAGIC)];
+  uint32_t version, byte_order_mark;
+  uint64_t map_fingerprint;
+  std::string location, participant;
+  if (!file.read(magic, sizeof(magic)) || !std::equal(magic, magic + sizeof(magic), ROUTING_MAGIC) ||
+      !read(file, &version) || version != FORMAT_VERSION || !read(file, &byte_order_mark) ||
+      byte_order_mark != BYTE_ORDER_MARK || !read(file, &map_fingerprint) || !read(file, file_size, &location) ||
+      !read(file, file_size, &participant))
+  {
+    ROS_WARN_STREAM(path << " is not a routing graph of this format version and byte order");
+    return false;
+  }
+  if (location != traffic_rules.location() || participant != traffic_rules.participant())
+  {
+    ROS_WARN_STREAM(path << " is the routing graph of " << location << " " << participant << ", not of "
+                         << traffic_rules.location() << " " << traffic_rules.participant());
+    return false;
+  }
+  if (map_fingerprint != computeMapFingerprint(lanelet_map))
+  {
+    ROS_WARN_STREAM(path << " is the routing graph of another version of the map");
+    return false;
+  }
+
+  uint64_t count;
+  if (!read(file, &count) || count > file_size)
+  {
+    ROS_WARN_STREAM(path << " is damaged");
+    return false;
+  }
+  std::unordered_map<lanelet::Id, Relations> relations_map;
+  relations_map.reserve(count);
+  for (uint64_t i = 0; i < count; ++i)
+  {
+    lanelet::Id id;
+    Relations relations;
+    if (!read(file, &id) || !read(file, file_size, &relations.following) ||
+        !read(file, file_size, &relations.previous) || !read(file, file_size, &relations.left) ||
+        !read(file, file_size, &relations.right))
+    {
+      ROS_WARN_STREAM(path << " is damaged");
+      return false;
+    }
+    relations_map.emplace(id, std::move(relations));
+  }
+
+  map_fingerprint_ = map_fingerprint;
+  location_ = location;
+  participant_ = participant;
+  relations_.swap(relations_map);
+  return true;
+}
+
+bool RoutingRelations::empty() const
+{
+  return relations_.empty();
+}
+
+uint64_t RoutingRelations::getMapFingerprint() const
+{
+  return map_fingerprint_;
+}
+
+const RoutingRelations::Relations* RoutingRelations::find(const lanelet::Id id) const
+{
+  const auto found = relations_.find(id);
+  return (found == relations_.end()) ? nullptr : &found->second;
+}
+
+const std::vector<lanelet::Id>& RoutingRelations::following(const lanelet::Id id) const
+{
+  static const std::vector<lanelet::Id> none;
+  const Relations* relations = find(id);
+  return relations ? relations->following : none;
+}
+
+const std::vector<lanelet::Id>& RoutingRelations::previous(const lanelet::Id id) const
+{
+  static const std::vector<lanelet::Id> none;
+  const Relations* relations = find(id);
+  return relations ? relations->previous : none;
+}
+
+const std::vector<lanelet::Id>& RoutingRelations::left(const lanelet::Id id) const
+{
+  static const std::vector<lanelet::Id> none;
+  const Relations* relations = find(id);
+  return relations ? relations->left : none;
+}
+
+const std::vector<lanelet::Id>& RoutingRelations::right(const lanelet::Id id) const
+{
+  static const std::vector<lanelet::Id> none;
+  const Relations* relations = find(id);
+  return relations ? relations->right : none;
+}
+
+lanelet::routing::RoutingGraphPtr getRoutingGraph(const lanelet::LaneletMapPtr& lanelet_map,
+                                                  const lanelet::traffic_rules::TrafficRules& traffic_rules)
+{
+  if (!lanelet_map)
+  {
+    ROS_ERROR_STREAM("No lanelet map is set!");
+    return nullptr;
+  }
+
+  // the fingerprint is linear in the map, far cheaper than building the graph
+  const uint64_t map_fingerprint = computeMapFingerprint(*lanelet_map);
+
+  std::lock_guard<std::mutex> lock(g_routing_graph_mutex);
+  g_routing_graphs.erase(std::remove_if(g_routing_graphs.begin(), g_routing_graphs.end(),
+                                        [](const CachedRoutingGraph& cached) {  // NOLINT
+                                          return cached.lanelet_map.expired();
+                                        }),
+                         g_routing_graphs.end());
+  for (auto& cached : g_routing_graphs)
+  {
+    if (cached.lanelet_map_address != lanelet_map.get() || cached.location != traffic_rules.location() ||
+        cached.participant != traffic_rules.participant())
+    {
+      continue;
+    }
+    if (cached.map_fingerprint != map_fingerprint)
+    {
+      cached.routing_graph = lanelet::routing::RoutingGraph::build(*lanelet_map, traffic_rules);
+      cached.map_fingerprint = map_fingerprint;
+    }
+    return cached.routing_graph;
+  }
+
+  CachedRoutingGraph cached;
+  cached.lanelet_map = lanelet_map;
+  cached.lanelet_map_address = lanelet_map.get();
+  cached.location = traffic_rules.location();
+  cached.participant = traffic_rules.participant();
+  cached.map_fingerprint = map_fingerprint;
+  cached.routing_graph = lanelet::routing::RoutingGraph::build(*lanelet_map, traffic_rules);
+  g_routing_graphs.push_back(cached);
+  return cached.routing_graph;
+}
+
+void clearRoutingGraphCache()
+{
+  std::lock_guard<std::mutex> lock(g_routing_graph_mutex);
+  g_routing_graphs.clear();
+}
+
+}  // namespace utils
+}  // namespace lanelet
@@ -26,7 +26,13 @@
 #include <ros/ros.h>
 
 #include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <iterator>
+#include <limits>
 #include <map>
+#include <thread>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -42,111 +48,172 @@ bool exists(const std::vector<int>& array, const int element)
 }
 
 /**
- * [removeImpossibleCandidates eliminates the impossible lanelet id candidates
- * according to lanelet routing graph information ]
- * @method removeImpossibleCandidates
- * @param  waypoints [list of waypoints]
- * @param  wp_candidate_lanelets  list of lanelet id candidates for each
- * waypoint
+ * [isConnected whether a lanelet of prev_wp_candidate_ids feeds into the
+ * candidate lanelet, or follows it in reverse]
  */
-void removeImpossibleCandidates(const lanelet::LaneletMapPtr lanelet_map,
-                                const lanelet::routing::RoutingGraphPtr routing_graph,
-                                const std::vector<autoware_msgs::Waypoint>& waypoints,
-                                std::map<int, std::vector<int> >* wp_candidate_lanelets, const bool reverse)
+bool isConnected(const lanelet::LaneletMapPtr lanelet_map, const lanelet::routing::RoutingGraphPtr routing_graph,
+                 const int candidate_id, const std::vector<int>& prev_wp_candidate_ids, const bool reverse)
 {
-  if (!lanelet_map)
+  auto candidate_lanelet = lanelet_map->laneletLayer.get(candidate_id);
+
+  // Get previous connecting lanelets from routing graph
+  lanelet::ConstLanelets previous_lanelets;
+  if (reverse)
   {
-    ROS_ERROR_STREAM("No lanelet map is set!");
-    return;
+    previous_lanelets = routing_graph->following(candidate_lanelet);
+  }
+  else
+  {
+    previous_lanelets = routing_graph->previous(candidate_lanelet);
   }
 
-  int prev_wp_gid;
-  bool first_wp = true;
+  // Loop over all lanelets that connect (feed into) to the current lanelet
+  // candidate.
+  for (const auto& connecting_lanelet : previous_lanelets)
+  {
+    if (exists(prev_wp_candidate_ids, connecting_lanelet.id()))
+    {
+      return true;
+    }
+  }
+  return false;
+}
 
-  // Loop over each waypoint
-  for (const auto& wp : waypoints)
+bool isConnected(const lanelet::LaneletMapPtr lanelet_map, const RoutingRelations& routing_relations,
+                 const int candidate_id, const std::vector<int>& prev_wp_candidate_ids, const bool reverse)
+{
+  const auto& previous_ids =
+      reverse ? routing_relations.following(candidate_id) : routing_relations.previous(candidate_id);
+  for (const auto connecting_id : previous_ids)
   {
-    if (first_wp)
+    if (exists(prev_wp_candidate_ids, connecting_id))
     {
-      prev_wp_gid = wp.gid;
-      first_wp = false;
-      continue;
+      return true;
     }
+  }
+  return false;
+}
 
-    // Pointer to vector of candidate lanelet ids for the current waypoint
-    auto candidate_ids_ptr = &wp_candidate_lanelets->at(wp.gid);
+/**
+ * [removeImpossibleCandidates eliminates the candidates of a waypoint that
+ * cannot be reached from the candidates of the previous waypoint according to
+ * lanelet routing graph information]
+ * @param  routing_graph         [routing graph, or routing relations loaded from a file]
+ * @param  prev_wp_candidate_ids [lanelet id candidates of the previous waypoint]
+ * @param  candidate_ids         [lanelet id candidates of the waypoint]
+ * @param  reverse               [previous waypoint is the next one of the lane]
+ */
+template <class RoutingGraphT>
+void removeImpossibleCandidates(const lanelet::LaneletMapPtr lanelet_map, const RoutingGraphT& routing_graph,
+                                const std::vector<int>& prev_wp_candidate_ids, std::vector<int>* candidate_ids,
+                                const bool reverse)
+{
+  // Do not remove candidates if previous waypoint does not have any candidates
+  if (prev_wp_candidate_ids.empty())
+  {
+    return;
+  }
 
-    // Pointer to vector of candidate lanelet ids for the previous waypoint
-    const auto prev_wp_candidate_ids_ptr = &wp_candidate_lanelets->at(prev_wp_gid);
+  // Skip if there is only one candidate lanelet for this waypoint
+  if (candidate_ids->size() == 1)
+  {
+    return;
+  }
+
+  std::vector<int> removing_ids;
 
-    // Do not remove candidates if previous waypoint does not have any candidates
-    if (prev_wp_candidate_ids_ptr->empty())
+  // Loop over each candidate lanelet id
+  for (const auto candidate_id : *candidate_ids)
+  {
+    // Do not remove candidate if the candidate lanelet id exists in the
+    // candidates of the previous waypoint
+    // This is to prevent removing a candidate that is the same lanelet as
+    // the previous waypoint's lanelet
+    if (exists(prev_wp_candidate_ids, candidate_id))
     {
-      prev_wp_gid = wp.gid;
       continue;
     }
 
-    // Skip if there is only one candidate lanelet for this waypoint
-    if (candidate_ids_ptr->size() == 1)
+    // Remove candidate if previous waypoint's candidate lanelets don't
+    // connect to the current candidate lanelet.
+    if (!isConnected(lanelet_map, routing_graph, candidate_id, prev_wp_candidate_ids, reverse))
     {
-      prev_wp_gid = wp.gid;
-      continue;
+      removing_ids.push_back(candidate_id);
     }
+  }
 
-    std::vector<int> removing_ids;
+  // declare function for remove_if separately, because roslint is not supporting lambda functions very well.
+  auto remove_existing_func = [removing_ids](int id) { return exists(removing_ids, id); };
 
-    // Loop over each candidate lanelet id
-    for (const auto candidate_id : *candidate_ids_ptr)
-    {
-      // Do not remove candidate if the candidate lanelet id exists in the
-      // candidates of the previous waypoint
-      // This is to prevent removing a candidate that is the same lanelet as
-      // the previous waypoint's lanelet
-      if (exists(*prev_wp_candidate_ids_ptr, candidate_id))
-      {
-        continue;
-      }
-
-      auto candidate_lanelet = lanelet_map->laneletLayer.get(candidate_id);
+  // Remove candidate lanelet ids
+  auto shortened_end = std::remove_if(candidate_ids->begin(), candidate_ids->end(), remove_existing_func);
+  candidate_ids->erase(shortened_end, candidate_ids->end());
+}
 
-      // Get previous connecting lanelets from routing graph
-      lanelet::ConstLanelets previous_lanelets;
-      if (reverse)
-      {
-        previous_lanelets = routing_graph->following(candidate_lanelet);
-      }
-      else
-      {
-        previous_lanelets = routing_graph->previous(candidate_lanelet);
-      }
+/**
+ * [removeImpossibleCandidates eliminates the impossible lanelet id candidates
+ * according to lanelet routing graph information ]
+ * @method removeImpossibleCandidates
+ * @param  first, last [range of candidate slots of a lane, reverse iterators for the backward pass]
+ * @param  wp_candidate_lanelets  list of lanelet id candidates for each
+ * slot
+ */
+template <class RoutingGraphT, class SlotIterator>
+void removeImpossibleCandidates(const lanelet::LaneletMapPtr lanelet_map, const RoutingGraphT& routing_graph,
+                                SlotIterator first, SlotIterator last,
+                                std::vector<std::vector<int> >* wp_candidate_lanelets,
+                                const bool reverse)
+{
+  if (!lanelet_map)
+  {
+    ROS_ERROR_STREAM("No lanelet map is set!");
+    return;
+  }
 
-      // Loop over all lanelets that connect (feed into) to the current lanelet
-      // candidate.
-      bool connection_possible = false;
-      for (const auto& connecting_lanelet : previous_lanelets)
-      {
-        // Remove candidate if previous waypoint's candidate lanelets don't
-        // connect to the current candidate lanelet.
-        if (exists(*prev_wp_candidate_ids_ptr, connecting_lanelet.id()))
-        {
-          connection_possible = true;
-          break;
-        }
-      }
-      if (!connection_possible)
-      {
-        removing_ids.push_back(candidate_id);
-      }
-    }
+  if (first == last)
+  {
+    return;
+  }
 
-    // declare function for remove_if separately, because roslint is not supporting lambda functions very well.
-    auto remove_existing_func = [removing_ids](int id) { return exists(removing_ids, id); };
+  // Loop over each waypoint, the first one has no previous waypoint
+  for (auto prev = first, it = std::next(first); it != last; prev = it++)
+  {
+    removeImpossibleCandidates(lanelet_map, routing_graph, wp_candidate_lanelets->at(*prev),
+                               &wp_candidate_lanelets->at(*it), reverse);
+  }
+}
 
-    // Remove candidate lanelet ids
-    auto shortened_end = std::remove_if(candidate_ids_ptr->begin(), candidate_ids_ptr->end(), remove_existing_func);
-    candidate_ids_ptr->erase(shortened_end, candidate_ids_ptr->end());
+/**
+ * [parallelFor calls f(i) for i in [0, n) on the hardware threads]
+ */
+template <class Function>
+void parallelFor(const size_t n, const Function& f)
+{
+  const size_t num_threads = std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()), n);
+  if (num_threads <= 1)
+  {
+    for (size_t i = 0; i < n; ++i)
+    {
+      f(i);
+    }
+    return;
+  }
 
-    prev_wp_gid = wp.gid;
+  std::atomic<size_t> next(0);
+  std::vector<std::thread> threads;
+  threads.reserve(num_threads);
+  for (size_t t = 0; t < num_threads; ++t)
+  {
+    threads.emplace_back([&]() {
+      for (size_t i = next++; i < n; i = next++)
+      {
+        f(i);
+      }
+    });
+  }
+  for (auto& thread : threads)
+  {
+    thread.join();
   }
 }
 
@@ -219,62 +286,20 @@ void getContactingLanelets(const lanelet::LaneletMapPtr lanelet_map,
   }
 }
 
-std::vector<double> calculateSegmentDistances(const lanelet::ConstLineString3d& line_string)
+std::vector<double> calculateAccumulatedLengths(const lanelet::ConstLineString3d& line_string)
 {
-  std::vector<double> segment_distances;
-  segment_distances.reserve(line_string.size() - 1);
+  std::vector<double> accumulated_lengths{ 0 };
+  accumulated_lengths.reserve(line_string.size());
 
   for (size_t i = 1; i < line_string.size(); ++i)
   {
     const auto distance = lanelet::geometry::distance2d(line_string[i], line_string[i - 1]);
-    segment_distances.push_back(distance);
+    accumulated_lengths.push_back(accumulated_lengths.back() + distance);
   }
 
-  return segment_distances;
-}
-
-std::vector<double> calculateAccumulatedLengths(const lanelet::ConstLineString3d& line_string)
-{
-  const auto segment_distances = calculateSegmentDistances(line_string);
-
-  std::vector<double> accumulated_lengths{ 0 };
-  accumulated_lengths.reserve(segment_distances.size() + 1);
-  std::partial_sum(std::begin(segment_distances), std::end(segment_distances), std::back_inserter(accumulated_lengths));
-
   return accumulated_lengths;
 }
 
-std::pair<size_t, size_t> findNearestIndexPair(const std::vector<double>& accumulated_lengths,
-                                               const double target_length)
-{
-  // List size
-  const auto N = accumulated_lengths.size();
-
-  // Front
-  if (target_length < accumulated_lengths.at(1))
-  {
-    return std::make_pair(0, 1);
-  }
-
-  // Back
-  if (target_length > accumulated_lengths.at(N - 2))
-  {
-    return std::make_pair(N - 2, N - 1);
-  }
-
-  // Middle
-  for (auto i = 1; i < N; ++i)
-  {
-    if (accumulated_lengths.at(i - 1) <= target_length && target_length <= accumulated_lengths.at(i))
-    {
-      return std::make_pair(i - 1, i);
-    }
-  }
-
-  // Throw an exception because this never happens
-  throw std::runtime_error("No nearest point found.");
-}
-
 std::vector<lanelet::BasicPoint3d> resamplePoints(const lanelet::ConstLineString3d& line_string, const int num_segments)
 {
   // Calculate length
@@ -282,14 +307,23 @@ std::vector<lanelet::BasicPoint3d> resamplePoints(const lanelet::ConstLineString
 
   // Calculate accumulated lengths
   const auto accumulated_lengths = calculateAccumulatedLengths(line_string);
+  const auto N = accumulated_lengths.size();
 
   // Create each segment
+  // target lengths are increasing, so the nearest index pair only moves forward: it is the first segment whose end
+  // is not before the target length, the first and the last segments also take the targets before and after them
   std::vector<lanelet::BasicPoint3d> resampled_points;
+  resampled_points.reserve(num_segments + 1);
+  size_t front_index = 1;
   for (auto i = 0; i <= num_segments; ++i)
   {
     // Find two nearest points
     const auto target_length = (static_cast<double>(i) / num_segments) * line_length;
-    const auto index_pair = findNearestIndexPair(accumulated_lengths, target_length);
+    while (front_index < N - 1 && accumulated_lengths.at(front_index) < target_length)
+    {
+      ++front_index;
+    }
+    const auto index_pair = std::make_pair(front_index - 1, front_index);
 
     // Apply linear interpolation
     const lanelet::BasicPoint3d back_point = line_string[index_pair.first];
@@ -308,7 +342,7 @@ std::vector<lanelet::BasicPoint3d> resamplePoints(const lanelet::ConstLineString
   return resampled_points;
 }
 
-lanelet::LineString3d generateFineCenterline(const lanelet::ConstLanelet& lanelet_obj)
+int getFineCenterlineSegments(const lanelet::ConstLanelet& lanelet_obj)
 {
   // Parameter
   constexpr double point_interval = 1.0;  // [m]
@@ -317,23 +351,186 @@ lanelet::LineString3d generateFineCenterline(const lanelet::ConstLanelet& lanele
   const double left_length = lanelet::geometry::length(lanelet_obj.leftBound());
   const double right_length = lanelet::geometry::length(lanelet_obj.rightBound());
   const double longer_distance = (left_length > right_length) ? left_length : right_length;
-  const int num_segments = std::max(static_cast<int>(ceil(longer_distance / point_interval)), 1);
+  return std::max(static_cast<int>(ceil(longer_distance / point_interval)), 1);
+}
 
+/**
+ * [generateFineCenterline resamples the bounds in num_segments segments and
+ * averages them]
+ * @param first_id [id of the centerline, its points get the next num_segments + 1 ids]
+ */
+lanelet::LineString3d generateFineCenterline(const lanelet::ConstLanelet& lanelet_obj, const int num_segments,
+                                             const lanelet::Id first_id)
+{
   // Resample points
   const auto left_points = resamplePoints(lanelet_obj.leftBound(), num_segments);
   const auto right_points = resamplePoints(lanelet_obj.rightBound(), num_segments);
 
   // Create centerline
-  lanelet::LineString3d centerline(lanelet::utils::getId());
+  lanelet::Points3d center_points;
+  center_points.reserve(num_segments + 1);
   for (int i = 0; i < num_segments + 1; i++)
   {
     // Add ID for the average point of left and right
     const auto center_basic_point = (right_points.at(i) + left_points.at(i)) / 2;
-    const lanelet::Point3d center_point(lanelet::utils::getId(), center_basic_point.x(), center_basic_point.y(),
-                                        center_basic_point.z());
-    centerline.push_back(center_point);
+    center_points.emplace_back(first_id + 1 + i, center_basic_point.x(), center_basic_point.y(),
+                               center_basic_point.z());
+  }
+  return lanelet::LineString3d(first_id, center_points);
+}
+
+/**
+ * [matchWaypointCandidates finds the candidate lanelets of the waypoints, the
+ * candidates of the waypoints sharing a gid are kept in one slot]
+ * @param slot_gids                [gid of each slot]
+ * @param wp_candidate_lanelet_ids [candidate lanelet ids of each slot]
+ */
+template <class RoutingGraphT>
+void matchWaypointCandidates(const lanelet::LaneletMapPtr lanelet_map, const RoutingGraphT& routing_graph,
+                             const autoware_msgs::LaneArray& lane_array, std::vector<int>* slot_gids,
+                             std::vector<std::vector<int> >* wp_candidate_lanelet_ids)
+{
+  // lane_slots = slot of each waypoint of each lane
+  std::vector<std::vector<size_t> > lane_slots(lane_array.lanes.size());
+  std::unordered_map<int, size_t> gid_slots;
+  std::vector<const autoware_msgs::Waypoint*> waypoints;
+  for (size_t l = 0; l < lane_array.lanes.size(); ++l)
+  {
+    lane_slots[l].reserve(lane_array.lanes[l].waypoints.size());
+    for (const auto& wp : lane_array.lanes[l].waypoints)
+    {
+      auto inserted = gid_slots.emplace(wp.gid, slot_gids->size());
+      if (inserted.second)
+      {
+        slot_gids->push_back(wp.gid);
+      }
+      lane_slots[l].push_back(inserted.first->second);
+      waypoints.push_back(&wp);
+    }
+  }
+
+  lanelet::traffic_rules::TrafficRulesPtr traffic_rules =
+      lanelet::traffic_rules::TrafficRulesFactory::create(lanelet::Locations::Germany, lanelet::Participants::Vehicle);
+
+  // get possible candidates of lanelets for each waypoint
+  // "candidate lanelets" means lanelets that have 0 distance with waypoint.
+  // multiple candidates could appear at intersections.
+  // the searches only read the map, they run in parallel.
+  std::vector<std::vector<int> > wp_contacting_lanelet_ids(waypoints.size());
+  parallelFor(waypoints.size(), [&](const size_t i) {
+    lanelet::BasicPoint2d search_point(waypoints[i]->pose.pose.position.x, waypoints[i]->pose.pose.position.y);
+    getContactingLanelets(lanelet_map, traffic_rules, search_point, 5, &wp_contacting_lanelet_ids[i]);
+  });
+
+  // the last waypoint of a gid gives its candidates
+  wp_candidate_lanelet_ids->assign(slot_gids->size(), std::vector<int>());
+  size_t i = 0;
+  for (const auto& slots : lane_slots)
+  {
+    for (const auto slot : slots)
+    {
+      (*wp_candidate_lanelet_ids)[slot] = std::move(wp_contacting_lanelet_ids[i++]);
+    }
+  }
+
+  // eliminate impossible candidates using routing graph. (forward direction)
+  for (const auto& slots : lane_slots)
+  {
+    removeImpossibleCandidates(lanelet_map, routing_graph, slots.begin(), slots.end(), wp_candidate_lanelet_ids,
+                               false);
+  }
+
+  // eliminate impossible candidates using routing graph. (reverse direction)
+  for (const auto& slots : lane_slots)
+  {
+    removeImpossibleCandidates(lanelet_map, routing_graph, slots.rbegin(), slots.rend(), wp_candidate_lanelet_ids,
+                               true);
+  }
+}
+
+template <class RoutingGraphT>
+void matchWaypoints(const lanelet::LaneletMapPtr lanelet_map, const RoutingGraphT& routing_graph,
+                    const autoware_msgs::LaneArray& lane_array,
+                    std::map<int, lanelet::Id>* waypointid2laneletid)
+{
+  if (!lanelet_map)
+  {
+    ROS_ERROR_STREAM("No lanelet map is set!");
+    return;
+  }
+
+  if (waypointid2laneletid == nullptr)
+  {
+    ROS_ERROR_STREAM("matchWaypointAndLanelet: waypointid2laneletid null pointer!");
+    return;
+  }
+
+  std::vector<int> slot_gids;
+  std::vector<std::vector<int> > wp_candidate_lanelet_ids;
+  matchWaypointCandidates(lanelet_map, routing_graph, lane_array, &slot_gids, &wp_candidate_lanelet_ids);
+
+  for (size_t slot = 0; slot < slot_gids.size(); ++slot)
+  {
+    const auto& candidates = wp_candidate_lanelet_ids[slot];
+    if (candidates.empty())
+    {
+      ROS_WARN_STREAM("No lanelet was matched for waypoint with gid: " << slot_gids[slot]);
+      continue;
+    }
+    if (candidates.size() >= 2)
+    {
+      ROS_WARN("ambiguous waypoint. Randomly choosing from candidates");
+    }
+    (*waypointid2laneletid)[slot_gids[slot]] = candidates.front();
+  }
+}
+
+template <class RoutingGraphT>
+void matchWaypoints(const lanelet::LaneletMapPtr lanelet_map, const RoutingGraphT& routing_graph,
+                    const autoware_msgs::LaneArray& lane_array,
+                    std::vector<lanelet::Id>* waypointid2laneletid)
+{
+  if (!lanelet_map)
+  {
+    ROS_ERROR_STREAM("No lanelet map is set!");
+    return;
+  }
+
+  if (waypointid2laneletid == nullptr)
+  {
+    ROS_ERROR_STREAM("matchWaypointAndLanelet: waypointid2laneletid null pointer!");
+    return;
+  }
+
+  std::vector<int> slot_gids;
+  std::vector<std::vector<int> > wp_candidate_lanelet_ids;
+  matchWaypointCandidates(lanelet_map, routing_graph, lane_array, &slot_gids, &wp_candidate_lanelet_ids);
+
+  waypointid2laneletid->clear();
+  if (!slot_gids.empty())
+  {
+    waypointid2laneletid->resize(std::max(*std::max_element(slot_gids.begin(), slot_gids.end()) + 1, 0),
+                                 lanelet::InvalId);
+  }
+  for (size_t slot = 0; slot < slot_gids.size(); ++slot)
+  {
+    const auto& candidates = wp_candidate_lanelet_ids[slot];
+    if (candidates.empty())
+    {
+      ROS_WARN_STREAM("No lanelet was matched for waypoint with gid: " << slot_gids[slot]);
+      continue;
+    }
+    if (slot_gids[slot] < 0)
+    {
+      ROS_WARN_STREAM("Skipping waypoint with negative gid: " << slot_gids[slot]);
+      continue;
+    }
+    if (candidates.size() >= 2)
+    {
+      ROS_WARN("ambiguous waypoint. Randomly choosing from candidates");
+    }
+    (*waypointid2laneletid)[slot_gids[slot]] = candidates.front();
   }
-  return centerline;
 }
 
 }  // namespace
@@ -343,7 +540,58 @@ void matchWaypointAndLanelet(const lanelet::LaneletMapPtr lanelet_map,
                              const autoware_msgs::LaneArray& lane_array,
                              std::map<int, lanelet::Id>* waypointid2laneletid)
 {
-  if (!lanelet_map)
+  matchWaypoints(lanelet_map, routing_graph, lane_array, waypointid2laneletid);
+}
+
+void matchWaypointAndLanelet(const lanelet::LaneletMapPtr lanelet_map,
+                             const lanelet::routing::RoutingGraphPtr routing_graph,
+                             const autoware_msgs::LaneArray& lane_array,
+                             std::vector<lanelet::Id>* waypointid2laneletid)
+{
+  matchWaypoints(lanelet_map, routing_graph, lane_array, waypointid2laneletid);
+}
+
+void matchWaypointAndLanelet(const lanelet::LaneletMapPtr lanelet_map, const RoutingRelations& routing_relations,
+                             const autoware_msgs::LaneArray& lane_array,
+                             std::map<int, lanelet::Id>* waypointid2laneletid)
+{
+  matchWaypoints(lanelet_map, routing_relations, lane_array, waypointid2laneletid);
+}
+
+void matchWaypointAndLanelet(const lanelet::LaneletMapPtr lanelet_map, const RoutingRelations& routing_relations,
+                             const autoware_msgs::LaneArray& lane_array,
+                             std::vector<lanelet::Id>* waypointid2laneletid)
+{
+  matchWaypoints(lanelet_map, routing_relations, lane_array, waypointid2laneletid);
+}
+
+WaypointLaneletMatcher::WaypointLaneletMatcher(const lanelet::LaneletMapPtr lanelet_map,
+                                               const lanelet::routing::RoutingGraphPtr routing_graph)
+  : lanelet_map_(lanelet_map), routing_graph_(routing_graph), num_searched_waypoints_(0), num_pruned_waypoints_(0)
+{
+  traffic_rules_ =
+      lanelet::traffic_rules::TrafficRulesFactory::create(lanelet::Locations::Germany, lanelet::Participants::Vehicle);
+}
+
+void WaypointLaneletMatcher::clear()
+{
+  matched_waypoints_.clear();
+}
+
+size_t WaypointLaneletMatcher::getNumberOfSearchedWaypoints() const
+{
+  return num_searched_waypoints_;
+}
+
+size_t WaypointLaneletMatcher::getNumberOfPrunedWaypoints() const
+{
+  return num_pruned_waypoints_;
+}
+
+void WaypointLaneletMatcher::match(const autoware_msgs::LaneArray& lane_array,
+                                   std::map<int, lanelet::Id>* waypointid2laneletid)
+{
+  if (!lanelet_map_)
   {
     ROS_ERROR_STREAM("No lanelet map is set!");
     return;
@@ -355,67 +603,177 @@ void matchWaypointAndLanelet(const lanelet::LaneletMapPtr lanelet_map,
     return;
   }
 
-  // map of waypoint_id to lanelet_id
-  // first item = gid of waypoint
-  // second item = lanelet_ids
-  std::map<int, std::vector<int> > wp_candidate_lanelet_ids;
+  constexpr int no_gid = std::numeric_limits<int>::min();
+  constexpr double epsilon = 1e-6;
 
-  lanelet::traffic_rules::TrafficRulesPtr traffic_rules =
-      lanelet::traffic_rules::TrafficRulesFactory::create(lanelet::Locations::Germany, lanelet::Participants::Vehicle);
+  num_searched_waypoints_ = 0;
+  num_pruned_waypoints_ = 0;
 
-  // get possible candidates of lanelets for each waypoint
-  // "candidate lanelets" means lanelets that have 0 distance with waypoint.
-  // multiple candidates could appear at intersections.
-  for (auto& lane : lane_array.lanes)
+  std::unordered_map<int, MatchedWaypoint> matched_waypoints;
+  bool unique_gids = true;
+  for (const auto& lane : lane_array.lanes)
   {
-    for (auto& wp : lane.waypoints)
+    for (auto it = lane.waypoints.begin(); it != lane.waypoints.end(); ++it)
     {
-      std::vector<int> contacting_lanelet_ids;
-      lanelet::BasicPoint2d search_point(wp.pose.pose.position.x, wp.pose.pose.position.y);
-      getContactingLanelets(lanelet_map, traffic_rules, search_point, 5, &contacting_lanelet_ids);
-      wp_candidate_lanelet_ids[wp.gid] = contacting_lanelet_ids;
+      MatchedWaypoint matched_wp;
+      matched_wp.x = it->pose.pose.position.x;
+      matched_wp.y = it->pose.pose.position.y;
+      matched_wp.prev_gid = (it == lane.waypoints.begin()) ? no_gid : std::prev(it)->gid;
+      matched_wp.next_gid = (std::next(it) == lane.waypoints.end()) ? no_gid : std::next(it)->gid;
+      matched_wp.searched = false;
+      matched_wp.forward_changed = false;
+      matched_wp.pruned = false;
+      unique_gids &= matched_waypoints.emplace(it->gid, matched_wp).second;
     }
   }
 
-  // eliminate impossible candidates using routing graph. (forward direction)
-  for (const auto& lane : lane_array.lanes)
+  // candidates of a gid shared by several waypoints depend on all of them
+  if (!unique_gids)
   {
-    removeImpossibleCandidates(lanelet_map, routing_graph, lane.waypoints, &wp_candidate_lanelet_ids, false);
+    ROS_WARN_STREAM(__FUNCTION__ << ": gids of waypoints are not unique, matching all waypoints again");
+    matched_waypoints_.clear();
+    matchWaypointAndLanelet(lanelet_map_, routing_graph_, lane_array, waypointid2laneletid);
+    num_searched_waypoints_ = matched_waypoints.size();
+    num_pruned_waypoints_ = matched_waypoints.size();
+    return;
   }
 
-  // eliminate impossible candidates using routing graph. (reverse direction)
+  // contacting lanelets of the new and moved waypoints
+  std::vector<MatchedWaypoint*> searching_waypoints;
+  for (auto& item : matched_waypoints)
+  {
+    auto& matched_wp = item.second;
+    const auto prev_wp = matched_waypoints_.find(item.first);
+    if (prev_wp != matched_waypoints_.end() && std::fabs(prev_wp->second.x - matched_wp.x) < epsilon &&
+        std::fabs(prev_wp->second.y - matched_wp.y) < epsilon)
+    {
+      matched_wp.contacting_ids = std::move(prev_wp->second.contacting_ids);
+    }
+    else
+    {
+      matched_wp.searched = true;
+      searching_waypoints.push_back(&matched_wp);
+    }
+  }
+  parallelFor(searching_waypoints.size(), [&](const size_t i) {
+    lanelet::BasicPoint2d search_point(searching_waypoints[i]->x, searching_waypoints[i]->y);
+    getContactingLanelets(lanelet_map_, traffic_rules_, search_point, 5, &searching_waypoints[i]->contacting_ids);
+  });
+  num_searched_waypoints_ = searching_waypoints.size();
+
   for (const auto& lane : lane_array.lanes)
   {
-    auto reverse_waypoints = lane.waypoints;
-    std::reverse(reverse_waypoints.begin(), reverse_waypoints.end());
-    removeImpossibleCandidates(lanelet_map, routing_graph, reverse_waypoints, &wp_candidate_lanelet_ids, true);
+    // forward pass, the candidates of a waypoint depend on the previous waypoint only
+    const MatchedWaypoint* prev_matched_wp = nullptr;
+    bool prev_changed = false;
+    for (const auto& wp : lane.waypoints)
+    {
+      auto& matched_wp = matched_waypoints.at(wp.gid);
+      const auto prev_wp = matched_waypoints_.find(wp.gid);
+      const bool known = prev_wp != matched_waypoints_.end();
+      if (known && !matched_wp.searched && !prev_changed && prev_wp->second.prev_gid == matched_wp.prev_gid)
+      {
+        matched_wp.forward_ids = prev_wp->second.forward_ids;
+      }
+      else
+      {
+        matched_wp.forward_ids = matched_wp.contacting_ids;
+        if (prev_matched_wp != nullptr)
+        {
+          removeImpossibleCandidates(lanelet_map_, routing_graph_, prev_matched_wp->forward_ids,
+                                     &matched_wp.forward_ids, false);
+        }
+        matched_wp.forward_changed = !known || prev_wp->second.forward_ids != matched_wp.forward_ids;
+        matched_wp.pruned = true;
+      }
+      prev_changed = matched_wp.forward_changed;
+      prev_matched_wp = &matched_wp;
+    }
+
+    // backward pass, the candidates of a waypoint depend on the next waypoint only
+    const MatchedWaypoint* next_matched_wp = nullptr;
+    bool next_changed = false;
+    for (auto it = lane.waypoints.rbegin(); it != lane.waypoints.rend(); ++it)
+    {
+      auto& matched_wp = matched_waypoints.at(it->gid);
+      const auto prev_wp = matched_waypoints_.find(it->gid);
+      const bool known = prev_wp != matched_waypoints_.end();
+      if (known && !matched_wp.forward_changed && !next_changed && prev_wp->second.next_gid == matched_wp.next_gid)
+      {
+        matched_wp.candidate_ids = prev_wp->second.candidate_ids;
+        next_changed = false;
+      }
+      else
+      {
+        matched_wp.candidate_ids = matched_wp.forward_ids;
+        if (next_matched_wp != nullptr)
+        {
+          removeImpossibleCandidates(lanelet_map_, routing_graph_, next_matched_wp->candidate_ids,
+                                     &matched_wp.candidate_ids, true);
+        }
+        next_changed = !known || prev_wp->second.candidate_ids != matched_wp.candidate_ids;
+        matched_wp.pruned = true;
+      }
+      next_matched_wp = &matched_wp;
+    }
   }
 
-  for (auto candidate : wp_candidate_lanelet_ids)
+  for (const auto& item : matched_waypoints)
   {
-    if (candidate.second.empty())
+    const auto& candidates = item.second.candidate_ids;
+    num_pruned_waypoints_ += item.second.pruned ? 1 : 0;
+    if (candidates.empty())
     {
-      ROS_WARN_STREAM("No lanelet was matched for waypoint with gid: " << candidate.first);
+      ROS_WARN_STREAM("No lanelet was matched for waypoint with gid: " << item.first);
       continue;
     }
-    if (candidate.second.size() >= 2)
+    if (candidates.size() >= 2)
     {
       ROS_WARN("ambiguous waypoint. Randomly choosing from candidates");
     }
-    (*waypointid2laneletid)[candidate.first] = candidate.second.front();
+    (*waypointid2laneletid)[item.first] = candidates.front();
   }
+
+  matched_waypoints_.swap(matched_waypoints);
 }
 
 void overwriteLaneletsCenterline(lanelet::LaneletMapPtr lanelet_map, const bool force_overwrite)
 {
+  std::vector<lanelet::Lanelet> lanelets;
   for (auto& lanelet_obj : lanelet_map->laneletLayer)
   {
     if (force_overwrite || !lanelet_obj.hasCustomCenterline())
     {
-      const auto fine_center_line = generateFineCenterline(lanelet_obj);
-      lanelet_obj.setCenterline(fine_center_line);
+      lanelets.push_back(lanelet_obj);
     }
   }
+  if (lanelets.empty())
+  {
+    return;
+  }
+
+  std::vector<int> num_segments(lanelets.size());
+  parallelFor(lanelets.size(), [&](const size_t i) { num_segments[i] = getFineCenterlineSegments(lanelets[i]); });
+
+  // reserve the ids of every centerline and its points up front, they are the same as when generated one by one
+  std::vector<lanelet::Id> first_ids(lanelets.size());
+  lanelet::Id next_id = lanelet::utils::getId();
+  for (size_t i = 0; i < lanelets.size(); ++i)
+  {
+    first_ids[i] = next_id;
+    next_id += num_segments[i] + 2;
+  }
+  lanelet::utils::registerId(next_id - 1);
+
+  std::vector<lanelet::LineString3d> fine_center_lines(lanelets.size());
+  parallelFor(lanelets.size(), [&](const size_t i) {
+    fine_center_lines[i] = generateFineCenterline(lanelets[i], num_segments[i], first_ids[i]);
+  });
+
+  for (size_t i = 0; i < lanelets.size(); ++i)
+  {
+    lanelets[i].setCenterline(fine_center_lines[i]);
+  }
 }
 
 }  // namespace utils
@@ -22,7 +22,16 @@
 
 #include <Eigen/Eigen>
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <set>
 #include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include <lanelet2_extension/utility/message_conversion.h>
@@ -75,6 +84,32 @@ bool isLaneletAttributeValue(const lanelet::ConstLanelet ll, const std::string a
   return false;
 }
 
+std_msgs::ColorRGBA lightColor(const lanelet::ConstPoint3d& p)
+{
+  std_msgs::ColorRGBA color;
+  color.r = 0.0f;
+  color.g = 0.0f;
+  color.b = 0.0f;
+  color.a = 1.0f;
+
+  if (isAttributeValue(p, "color", "red"))
+    color.r = 1.0f;
+  else if (isAttributeValue(p, "color", "green"))
+    color.g = 1.0f;
+  else if (isAttributeValue(p, "color", "yellow"))
+  {
+    color.r = 1.0f;
+    color.g = 1.0f;
+  }
+  else
+  {
+    color.r = 1.0f;
+    color.g = 1.0f;
+    color.b = 1.0f;
+  }
+  return color;
+}
+
 void lightAsMarker(lanelet::ConstPoint3d p, visualization_msgs::Marker* marker, const std::string ns)
 {
   if (marker == nullptr)
@@ -98,29 +133,81 @@ void lightAsMarker(lanelet::ConstPoint3d p, visualization_msgs::Marker* marker,
   marker->scale.y = s;
   marker->scale.z = s;
 
-  marker->color.r = 0.0f;
-  marker->color.g = 0.0f;
-  marker->color.b = 0.0f;
-  marker->color.a = 1.0f;
+  marker->color = lightColor(p);
+  marker->lifetime = ros::Duration();
+}
 
-  if (isAttributeValue(p, "color", "red"))
-    marker->color.r = 1.0f;
-  else if (isAttributeValue(p, "color", "green"))
-    marker->color.g = 1.0f;
-  else if (isAttributeValue(p, "color", "yellow"))
+void trafficLightShapesAsMarkers(const lanelet::ConstLineStringsOrPolygons3d& lights, const std_msgs::ColorRGBA c,
+                                 const ros::Duration duration, const double scale,
+                                 visualization_msgs::MarkerArray* marker_array)
+{
+  for (const auto& lsp : lights)
   {
-    marker->color.r = 1.0f;
-    marker->color.g = 1.0f;
+    if (lsp.isLineString())  // traffic ligths can either polygons or
+    {                        // linestrings
+      lanelet::ConstLineString3d ls = static_cast<lanelet::ConstLineString3d>(lsp);
+
+      visualization_msgs::Marker marker;
+      lanelet::visualization::trafficLight2TriangleMarker(ls, &marker, "traffic_light_triangle", c, duration, scale);
+      marker_array->markers.push_back(marker);
+    }
   }
-  else
+}
+
+void lightBulbsAsMarkers(const lanelet::ConstLineStrings3d& light_bulbs, visualization_msgs::MarkerArray* marker_array)
+{
+  for (const auto& ls : light_bulbs)
   {
-    marker->color.r = 1.0f;
-    marker->color.g = 1.0f;
-    marker->color.b = 1.0f;
+    for (const auto& pt : ls)
+    {
+      if (pt.hasAttribute("color"))
+      {
+        visualization_msgs::Marker marker;
+        lightAsMarker(pt, &marker, "traffic_light");
+        marker_array->markers.push_back(marker);
+      }
+    }
+  }
+}
+
+/**
+ * [parallelFor calls f(i) for i in [0, n) on the hardware threads, with at
+ * least min_per_thread calls per thread]
+ */
+template <class Function>
+void parallelFor(const size_t n, const size_t min_per_thread, const Function& f)
+{
+  const size_t num_threads = std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()), n / min_per_thread);
+  if (num_threads <= 1)
+  {
+    for (size_t i = 0; i < n; ++i)
+    {
+      f(i);
+    }
+    return;
+  }
+
+  std::atomic<size_t> next(0);
+  std::vector<std::thread> threads;
+  threads.reserve(num_threads);
+  for (size_t t = 0; t < num_threads; ++t)
+  {
+    threads.emplace_back([&]() {
+      for (size_t i = next++; i < n; i = next++)
+      {
+        f(i);
+      }
+    });
+  }
+  for (auto& thread : threads)
+  {
+    thread.join();
   }
-  marker->lifetime = ros::Duration();
 }
 
+// traffic lights built by one thread at least, fewer are not worth a thread
+constexpr size_t MIN_TRAFFIC_LIGHTS_PER_THREAD = 16;
+
 void laneletDirectionAsMarker(const lanelet::ConstLanelet ll, visualization_msgs::Marker* marker, const int id,
                               const std::string ns)
 {
@@ -240,26 +327,9 @@ bool isWithinTriangle(const geometry_msgs::Point32& a, const geometry_msgs::Poin
   return (side1 > 0.0 && side2 > 0.0 && side3 > 0.0) || (side1 < 0.0 && side2 < 0.0 && side3 < 0.0);
 }
 
-}  // anonymous namespace
 
-namespace lanelet
-{
-void visualization::lanelet2Triangle(const lanelet::ConstLanelet& ll, std::vector<geometry_msgs::Polygon>* triangles)
-{
-  if (triangles == nullptr)
-  {
-    ROS_ERROR_STREAM(__FUNCTION__ << ": triangles is null pointer!");
-    return;
-  }
-
-  triangles->clear();
-  geometry_msgs::Polygon ll_poly;
-  lanelet2Polygon(ll, &ll_poly);
-  polygon2Triangle(ll_poly, triangles);
-}
-
-void visualization::polygon2Triangle(const geometry_msgs::Polygon& polygon,
-                                     std::vector<geometry_msgs::Polygon>* triangles)
+// O(n^2) ear clipping, used if the polygon could not be partitioned into monotone polygons
+void earClippingTriangulation(const geometry_msgs::Polygon& polygon, std::vector<geometry_msgs::Polygon>* triangles)
 {
   geometry_msgs::Polygon poly = polygon;
   // ear clipping: find smallest internal angle in polygon
@@ -348,6 +418,526 @@ void visualization::polygon2Triangle(const geometry_msgs::Polygon& polygon,
   }
 }
 
+double cross(const geometry_msgs::Point32& o, const geometry_msgs::Point32& a, const geometry_msgs::Point32& b)
+{
+  return (static_cast<double>(a.x) - o.x) * (static_cast<double>(b.y) - o.y) -
+         (static_cast<double>(a.y) - o.y) * (static_cast<double>(b.x) - o.x);
+}
+
+double signedArea(const std::vector<geometry_msgs::Point32>& points)
+{
+  double area = 0.0;
+  for (size_t i = 0; i < points.size(); i++)
+  {
+    const auto& p = points[i];
+    const auto& q = points[(i + 1) % points.size()];
+    area += static_cast<double>(p.x) * q.y - static_cast<double>(q.x) * p.y;
+  }
+  return area / 2.0;
+}
+
+// sweep order of monotone partition: higher y first, lower x first on the same y
+bool isAbove(const geometry_msgs::Point32& p, const geometry_msgs::Point32& q)
+{
+  return p.y > q.y || (p.y == q.y && p.x < q.x);
+}
+
+/**
+ * [MonotoneTriangulator triangulates a simple counter clockwise polygon by
+ * partitioning it into y-monotone polygons with a sweep line and
+ * triangulating each of them in linear time, O(n log n) in total]
+ */
+class MonotoneTriangulator
+{
+public:
+  explicit MonotoneTriangulator(const std::vector<geometry_msgs::Point32>& points)
+    : points_(points), n_(points.size()), sweep_y_(0.0), query_x_(0.0)
+  {
+  }
+
+  // triangles as vertex indices in counter clockwise order, false if the polygon could not be partitioned
+  bool triangulate(std::vector<std::array<size_t, 3>>* triangles)
+  {
+    adjacency_.assign(n_, std::vector<size_t>());
+    for (size_t i = 0; i < n_; i++)
+    {
+      adjacency_[i].push_back(next(i));
+      adjacency_[i].push_back(prev(i));
+    }
+    if (!partition())
+    {
+      return false;
+    }
+    std::vector<std::vector<size_t>> faces;
+    if (!traceFaces(&faces))
+    {
+      return false;
+    }
+    for (const auto& face : faces)
+    {
+      triangulateMonotone(face, triangles);
+    }
+    return true;
+  }
+
+private:
+  static constexpr size_t QUERY_EDGE = std::numeric_limits<size_t>::max();
+
+  const std::vector<geometry_msgs::Point32>& points_;
+  const size_t n_;
+  std::vector<std::vector<size_t>> adjacency_;  // polygon edges and diagonals
+  double sweep_y_;
+  double query_x_;
+
+  size_t next(const size_t i) const
+  {
+    return (i + 1) % n_;
+  }
+
+  size_t prev(const size_t i) const
+  {
+    return (i + n_ - 1) % n_;
+  }
+
+  // x of edge i -> i + 1 on the sweep line, x of the queried vertex for QUERY_EDGE
+  double edgeX(const size_t e) const
+  {
+    if (e == QUERY_EDGE)
+    {
+      return query_x_;
+    }
+    const auto& a = points_[e];
+    const auto& b = points_[next(e)];
+    if (a.y == b.y)
+    {
+      return std::min(a.x, b.x);
+    }
+    const double t = (sweep_y_ - a.y) / (static_cast<double>(b.y) - a.y);
+    return a.x + t * (static_cast<double>(b.x) - a.x);
+  }
+
+  struct EdgeLess
+  {
+    const MonotoneTriangulator* triangulator;
+    bool operator()(const size_t a, const size_t b) const
+    {
+      return triangulator->edgeX(a) < triangulator->edgeX(b);
+    }
+  };
+
+  void addDiagonal(const size_t a, const size_t b)
+  {
+    adjacency_[a].push_back(b);
+    adjacency_[b].push_back(a);
+  }
+
+  // adds the diagonals which split the polygon into y-monotone polygons
+  bool partition()
+  {
+    std::vector<size_t> order(n_);
+    for (size_t i = 0; i < n_; i++)
+    {
+      order[i] = i;
+    }
+    std::sort(order.begin(), order.end(),
+              [this](const size_t a, const size_t b) { return isAbove(points_[a], points_[b]); });
+
+    // edges with the interior of the polygon on their right, ordered by x on the sweep line
+    typedef std::set<size_t, EdgeLess> Status;
+    Status status(EdgeLess{ this });
+    std::vector<Status::iterator> status_its(n_, status.end());
+    std::vector<size_t> helper(n_, 0);
+    std::vector<bool> is_merge(n_, false);
+
+    auto find_left_edge = [&](const size_t v) -> Status::iterator {
+      query_x_ = points_[v].x;
+      const size_t query_edge = QUERY_EDGE;
+      auto it = status.lower_bound(query_edge);
+      if (it == status.begin())
+      {
+        return status.end();
+      }
+      return --it;
+    };
+    // edge e starts at vertex e, which is its first helper
+    auto insert_edge = [&](const size_t e) {
+      auto inserted = status.insert(e);
+      status_its[e] = inserted.first;
+      helper[e] = e;
+      return inserted.second;
+    };
+    auto erase_edge = [&](const size_t e) {
+      status.erase(status_its[e]);
+      status_its[e] = status.end();
+    };
+    auto fix_up = [&](const size_t v, const size_t e) {
+      if (is_merge[helper[e]])
+      {
+        addDiagonal(v, helper[e]);
+      }
+    };
+
+    for (const size_t v : order)
+    {
+      sweep_y_ = points_[v].y;
+      const size_t p = prev(v);
+      const size_t q = next(v);
+      const bool prev_below = isAbove(points_[v], points_[p]);
+      const bool next_below = isAbove(points_[v], points_[q]);
+      const bool is_convex = cross(points_[p], points_[v], points_[q]) > 0.0;
+
+      if (prev_below && next_below)
+      {
+        if (!is_convex)
+        {
+          // split vertex
+          auto it = find_left_edge(v);
+          if (it == status.end())
+          {
+            return false;
+          }
+          addDiagonal(v, helper[*it]);
+          helper[*it] = v;
+        }
+        // start vertex and split vertex
+        if (!insert_edge(v))
+        {
+          return false;
+        }
+      }
+      else if (!prev_below && !next_below)
+      {
+        // end vertex and merge vertex
+        if (status_its[p] == status.end())
+        {
+          return false;
+        }
+        fix_up(v, p);
+        erase_edge(p);
+        if (!is_convex)
+        {
+          is_merge[v] = true;
+          auto it = find_left_edge(v);
+          if (it == status.end())
+          {
+            return false;
+          }
+          fix_up(v, *it);
+          helper[*it] = v;
+        }
+      }
+      else if (prev_below)
+      {
+        // regular vertex on the right chain, interior on its left
+        auto it = find_left_edge(v);
+        if (it == status.end())
+        {
+          return false;
+        }
+        fix_up(v, *it);
+        helper[*it] = v;
+      }
+      else
+      {
+        // regular vertex on the left chain, interior on its right
+        if (status_its[p] == status.end())
+        {
+          return false;
+        }
+        fix_up(v, p);
+        erase_edge(p);
+        if (!insert_edge(v))
+        {
+          return false;
+        }
+      }
+    }
+    return true;
+  }
+
+  // splits the polygon along the diagonals, every face is counter clockwise
+  bool traceFaces(std::vector<std::vector<size_t>>* faces) const
+  {
+    // neighbours of each vertex in counter clockwise order
+    std::vector<std::vector<size_t>> sorted(adjacency_);
+    for (size_t v = 0; v < n_; v++)
+    {
+      const auto& o = points_[v];
+      std::sort(sorted[v].begin(), sorted[v].end(), [&](const size_t a, const size_t b) {
+        return std::atan2(points_[a].y - o.y, points_[a].x - o.x) < std::atan2(points_[b].y - o.y, points_[b].x - o.x);
+      });
+    }
+
+    std::set<std::pair<size_t, size_t>> visited;
+    for (size_t start = 0; start < n_; start++)
+    {
+      // every face has a polygon edge, which is traversed from i to i + 1
+      if (visited.count(std::make_pair(start, next(start))) > 0)
+      {
+        continue;
+      }
+      std::vector<size_t> face;
+      size_t from = start;
+      size_t to = next(start);
+      while (visited.insert(std::make_pair(from, to)).second)
+      {
+        face.push_back(from);
+        if (face.size() > n_)
+        {
+          return false;
+        }
+        // next edge is the first one clockwise from the edge back
+        const auto& neighbours = sorted[to];
+        auto it = std::find(neighbours.begin(), neighbours.end(), from);
+        const size_t next_to = (it == neighbours.begin()) ? neighbours.back() : *(--it);
+        from = to;
+        to = next_to;
+      }
+      if (from != start || face.size() < 3)
+      {
+        return false;
+      }
+      faces->push_back(face);
+    }
+    return true;
+  }
+
+  // triangulates a counter clockwise y-monotone polygon
+  void triangulateMonotone(const std::vector<size_t>& face, std::vector<std::array<size_t, 3>>* triangles) const
+  {
+    const size_t m = face.size();
+    if (m == 3)
+    {
+      triangles->push_back({ face[0], face[1], face[2] });
+      return;
+    }
+
+    size_t top = 0;
+    size_t bottom = 0;
+    for (size_t i = 1; i < m; i++)
+    {
+      if (isAbove(points_[face[i]], points_[face[top]]))
+      {
+        top = i;
+      }
+      if (isAbove(points_[face[bottom]], points_[face[i]]))
+      {
+        bottom = i;
+      }
+    }
+
+    // left chain runs from top to bottom in counter clockwise order, right chain from bottom to top
+    std::vector<std::pair<size_t, bool>> sorted;  // vertex and whether it is on the left chain
+    sorted.reserve(m);
+    size_t l = top;
+    size_t r = top;
+    sorted.emplace_back(face[top], true);
+    while (sorted.size() < m)
+    {
+      const size_t l_next = (l + 1) % m;
+      const size_t r_next = (r + m - 1) % m;
+      if (l != bottom && (r == bottom || isAbove(points_[face[l_next]], points_[face[r_next]])))
+      {
+        l = l_next;
+        sorted.emplace_back(face[l], l != bottom);
+      }
+      else
+      {
+        r = r_next;
+        sorted.emplace_back(face[r], false);
+      }
+    }
+    // bottom closes both chains
+    sorted.back().second = true;
+
+    auto add_triangle = [&](const size_t a, const size_t b, const size_t c) {
+      // keep counter clockwise order
+      if (cross(points_[a], points_[b], points_[c]) >= 0.0)
+      {
+        triangles->push_back({ a, b, c });
+      }
+      else
+      {
+        triangles->push_back({ a, c, b });
+      }
+    };
+
+    std::vector<std::pair<size_t, bool>> stack{ sorted[0], sorted[1] };
+    for (size_t j = 2; j + 1 < m; j++)
+    {
+      const auto& u = sorted[j];
+      if (u.second != stack.back().second)
+      {
+        for (size_t k = 0; k + 1 < stack.size(); k++)
+        {
+          add_triangle(u.first, stack[k].first, stack[k + 1].first);
+        }
+        const auto last = stack.back();
+        stack.clear();
+        stack.push_back(last);
+        stack.push_back(u);
+      }
+      else
+      {
+        auto last = stack.back();
+        stack.pop_back();
+        while (!stack.empty())
+        {
+          const auto& b = stack.back();
+          // triangle is inside if the last vertex is convex
+          const double turn = u.second ? cross(points_[b.first], points_[last.first], points_[u.first]) :
+                                         cross(points_[u.first], points_[last.first], points_[b.first]);
+          if (turn <= 0.0)
+          {
+            break;
+          }
+          add_triangle(u.first, last.first, b.first);
+          last = b;
+          stack.pop_back();
+        }
+        stack.push_back(last);
+        stack.push_back(u);
+      }
+    }
+    const size_t bottom_vertex = sorted.back().first;
+    for (size_t k = 0; k + 1 < stack.size(); k++)
+    {
+      add_triangle(bottom_vertex, stack[k].first, stack[k + 1].first);
+    }
+  }
+};
+
+// triangles in the vertex order of the polygon, false if the polygon is degenerated or not simple
+bool monotoneTriangulation(const geometry_msgs::Polygon& polygon, std::vector<geometry_msgs::Polygon>* triangles)
+{
+  const size_t n = polygon.points.size();
+  if (n < 3)
+  {
+    return true;
+  }
+
+  const double area = signedArea(polygon.points);
+  if (area == 0.0)
+  {
+    return false;
+  }
+  const bool is_clockwise = area < 0.0;
+  std::vector<geometry_msgs::Point32> points(polygon.points);
+  if (is_clockwise)
+  {
+    std::reverse(points.begin(), points.end());
+  }
+
+  std::vector<std::array<size_t, 3>> indices;
+  MonotoneTriangulator triangulator(points);
+  if (!triangulator.triangulate(&indices) || indices.size() != n - 2)
+  {
+    return false;
+  }
+
+  // triangles must cover the polygon exactly once
+  double triangles_area = 0.0;
+  for (const auto& t : indices)
+  {
+    triangles_area += cross(points[t[0]], points[t[1]], points[t[2]]) / 2.0;
+  }
+  if (std::fabs(triangles_area - std::fabs(area)) > 1e-6 * std::max(1.0, std::fabs(area)))
+  {
+    return false;
+  }
+
+  for (const auto& t : indices)
+  {
+    geometry_msgs::Polygon triangle;
+    if (is_clockwise)
+    {
+      triangle.points = { points[t[2]], points[t[1]], points[t[0]] };
+    }
+    else
+    {
+      triangle.points = { points[t[0]], points[t[1]], points[t[2]] };
+    }
+    triangles->push_back(triangle);
+  }
+  return true;
+}
+
+
+bool isSamePolygon(const geometry_msgs::Polygon& a, const geometry_msgs::Polygon& b)
+{
+  if (a.points.size() != b.points.size())
+  {
+    return false;
+  }
+  for (size_t i = 0; i < a.points.size(); i++)
+  {
+    if (a.points[i].x != b.points[i].x || a.points[i].y != b.points[i].y || a.points[i].z != b.points[i].z)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // anonymous namespace
+
+namespace lanelet
+{
+void visualization::lanelet2Triangle(const lanelet::ConstLanelet& ll, std::vector<geometry_msgs::Polygon>* triangles)
+{
+  if (triangles == nullptr)
+  {
+    ROS_ERROR_STREAM(__FUNCTION__ << ": triangles is null pointer!");
+    return;
+  }
+
+  triangles->clear();
+  geometry_msgs::Polygon ll_poly;
+  lanelet2Polygon(ll, &ll_poly);
+  polygon2Triangle(ll_poly, triangles);
+}
+
+void visualization::polygon2Triangle(const geometry_msgs::Polygon& polygon,
+                                     std::vector<geometry_msgs::Polygon>* triangles)
+{
+  std::vector<geometry_msgs::Polygon> monotone_triangles;
+  if (monotoneTriangulation(polygon, &monotone_triangles))
+  {
+    triangles->insert(triangles->end(), monotone_triangles.begin(), monotone_triangles.end());
+    return;
+  }
+  earClippingTriangulation(polygon, triangles);
+}
+
+const std::vector<geometry_msgs::Polygon>& visualization::LaneletTriangleCache::triangles(
+    const lanelet::ConstLanelet& ll)
+{
+  geometry_msgs::Polygon polygon;
+  lanelet2Polygon(ll, &polygon);
+
+  auto it = entries_.find(ll.id());
+  if (it != entries_.end() && isSamePolygon(it->second.polygon, polygon))
+  {
+    return it->second.triangles;
+  }
+
+  Entry& entry = entries_[ll.id()];
+  entry.triangles.clear();
+  polygon2Triangle(polygon, &entry.triangles);
+  entry.polygon = polygon;
+  return entry.triangles;
+}
+
+void visualization::LaneletTriangleCache::clear()
+{
+  entries_.clear();
+}
+
+size_t visualization::LaneletTriangleCache::size() const
+{
+  return entries_.size();
+}
+
 void visualization::lanelet2Polygon(const lanelet::ConstLanelet& ll, geometry_msgs::Polygon* polygon)
 {
   if (polygon == nullptr)
@@ -399,52 +989,150 @@ visualization_msgs::MarkerArray visualization::autowareTrafficLightsAsMarkerArra
 {
   visualization_msgs::MarkerArray tl_marker_array;
 
-  int tl_count = 0;
-  for (auto tli = tl_reg_elems.begin(); tli != tl_reg_elems.end(); tli++)
+  for (const auto& tl : tl_reg_elems)
   {
-    lanelet::ConstLineStrings3d light_bulbs;
-    lanelet::AutowareTrafficLightConstPtr tl = *tli;
+    trafficLightShapesAsMarkers(tl->trafficLights(), c, duration, scale, &tl_marker_array);
+    lightBulbsAsMarkers(tl->lightBulbs(), &tl_marker_array);
+  }
 
-    const auto lights = tl->trafficLights();
-    for (const auto& lsp : lights)
-    {
-      if (lsp.isLineString())  // traffic ligths can either polygons or
-      {                        // linestrings
-        lanelet::ConstLineString3d ls = static_cast<lanelet::ConstLineString3d>(lsp);
+  return (tl_marker_array);
+}
 
-        visualization_msgs::Marker marker;
-        visualization::trafficLight2TriangleMarker(ls, &marker, "traffic_light_triangle", c, duration, scale);
-        tl_marker_array.markers.push_back(marker);
-      }
+template <class TrafficLightConstPtr, class BuildFunction>
+visualization_msgs::MarkerArray visualization::TrafficLightMarkerCache::cachedMarkers(
+    std::unordered_map<lanelet::Id, Entry>* entries, const std::vector<TrafficLightConstPtr>& tl_reg_elems,
+    const std_msgs::ColorRGBA& c, const ros::Duration duration, const double scale, const BuildFunction& build)
+{
+  // lights missing from the cache or cached with another lifetime or scale
+  std::vector<size_t> missing;
+  for (size_t i = 0; i < tl_reg_elems.size(); i++)
+  {
+    auto it = entries->find(tl_reg_elems[i]->id());
+    if (it == entries->end() || it->second.duration != duration || it->second.scale != scale)
+    {
+      missing.push_back(i);
     }
+  }
+
+  std::vector<Entry> built(missing.size());
+  parallelFor(missing.size(), MIN_TRAFFIC_LIGHTS_PER_THREAD, [&](const size_t i) {
+    Entry& entry = built[i];
+    build(*tl_reg_elems[missing[i]], c, duration, scale, &entry);
+    entry.duration = duration;
+    entry.scale = scale;
+  });
+  for (size_t i = 0; i < missing.size(); i++)
+  {
+    (*entries)[tl_reg_elems[missing[i]]->id()] = std::move(built[i]);
+  }
 
-    light_bulbs = tl->lightBulbs();
-    for (auto ls : light_bulbs)
+  visualization_msgs::MarkerArray marker_array;
+  for (const auto& tl : tl_reg_elems)
+  {
+    const Entry& entry = entries->at(tl->id());
+    const size_t first = marker_array.markers.size();
+    marker_array.markers.insert(marker_array.markers.end(), entry.markers.markers.begin(),
+                                entry.markers.markers.end());
+    for (size_t i = first; i < first + entry.num_shapes; i++)
     {
-      lanelet::ConstLineString3d l = static_cast<lanelet::ConstLineString3d>(ls);
+      std::fill(marker_array.markers[i].colors.begin(), marker_array.markers[i].colors.end(), c);
+    }
+  }
+  return marker_array;
+}
 
-      for (auto pt : l)
-      {
-        if (pt.hasAttribute("color"))
-        {
-          visualization_msgs::Marker marker;
-          lightAsMarker(pt, &marker, "traffic_light");
-          tl_marker_array.markers.push_back(marker);
+visualization_msgs::MarkerArray visualization::TrafficLightMarkerCache::markers(
+    const std::vector<lanelet::AutowareTrafficLightConstPtr>& tl_reg_elems, const std_msgs::ColorRGBA& c,
+    const ros::Duration duration, const double scale)
+{
+  return cachedMarkers(&entries_, tl_reg_elems, c, duration, scale,
+                       [](const lanelet::autoware::AutowareTrafficLight& tl, const std_msgs::ColorRGBA& c,
+                          const ros::Duration duration, const double scale, Entry* entry) {
+                         trafficLightShapesAsMarkers(tl.trafficLights(), c, duration, scale, &entry->markers);
+                         entry->num_shapes = entry->markers.markers.size();
+                         lightBulbsAsMarkers(tl.lightBulbs(), &entry->markers);
+                         for (size_t i = entry->num_shapes; i < entry->markers.markers.size(); i++)
+                         {
+                           entry->bulb_colors.push_back(entry->markers.markers[i].color);
+                         }
+                       });
+}
 
-          tl_count++;
-        }
-      }
+visualization_msgs::MarkerArray visualization::TrafficLightMarkerCache::triangleMarkers(
+    const std::vector<lanelet::TrafficLightConstPtr>& tl_reg_elems, const std_msgs::ColorRGBA& c,
+    const ros::Duration duration, const double scale)
+{
+  return cachedMarkers(&triangle_entries_, tl_reg_elems, c, duration, scale,
+                       [](const lanelet::TrafficLight& tl, const std_msgs::ColorRGBA& c,
+                          const ros::Duration duration, const double scale, Entry* entry) {
+                         trafficLightShapesAsMarkers(tl.trafficLights(), c, duration, scale, &entry->markers);
+                         entry->num_shapes = entry->markers.markers.size();
+                       });
+}
+
+bool visualization::TrafficLightMarkerCache::setBulbColor(const lanelet::Id tl_id, const lanelet::Id bulb_id,
+                                                          const std_msgs::ColorRGBA& c)
+{
+  auto it = entries_.find(tl_id);
+  if (it == entries_.end())
+  {
+    return false;
+  }
+
+  bool found = false;
+  auto& markers = it->second.markers.markers;
+  for (size_t i = it->second.num_shapes; i < markers.size(); i++)
+  {
+    if (markers[i].id == bulb_id)
+    {
+      markers[i].color = c;
+      found = true;
     }
   }
+  return found;
+}
+
+void visualization::TrafficLightMarkerCache::resetBulbColors(const lanelet::Id tl_id)
+{
+  auto it = entries_.find(tl_id);
+  if (it == entries_.end())
+  {
+    return;
+  }
 
-  return (tl_marker_array);
+  Entry& entry = it->second;
+  for (size_t i = 0; i < entry.bulb_colors.size(); i++)
+  {
+    entry.markers.markers[entry.num_shapes + i].color = entry.bulb_colors[i];
+  }
+}
+
+void visualization::TrafficLightMarkerCache::clear()
+{
+  entries_.clear();
+  triangle_entries_.clear();
+}
+
+size_t visualization::TrafficLightMarkerCache::size() const
+{
+  return entries_.size() + triangle_entries_.size();
 }
 
 visualization_msgs::MarkerArray
 visualization::lineStringsAsMarkerArray(const std::vector<lanelet::ConstLineString3d> line_strings,
-                                        const std::string name_space, const std_msgs::ColorRGBA c, const double lss)
+                                        const std::string name_space, const std_msgs::ColorRGBA c, const double lss,
+                                        const bool batch)
 {
   visualization_msgs::MarkerArray ls_marker_array;
+  if (batch)
+  {
+    visualization_msgs::Marker ls_marker;
+    visualization::lineStrings2LineListMarker(line_strings, &ls_marker, "map", name_space, c, 0.2);
+    if (!ls_marker.points.empty())
+      ls_marker_array.markers.push_back(ls_marker);
+    return (ls_marker_array);
+  }
+
   for (auto i = line_strings.begin(); i != line_strings.end(); i++)
   {
     lanelet::ConstLineString3d ls = *i;
@@ -460,10 +1148,36 @@ visualization::lineStringsAsMarkerArray(const std::vector<lanelet::ConstLineStri
 
 visualization_msgs::MarkerArray visualization::laneletsBoundaryAsMarkerArray(const lanelet::ConstLanelets& lanelets,
                                                                              const std_msgs::ColorRGBA c,
-                                                                             const bool viz_centerline)
+                                                                             const bool viz_centerline,
+                                                                             const bool batch)
 {
   double lss = 0.2;  // line string size
   visualization_msgs::MarkerArray marker_array;
+  if (batch)
+  {
+    std::vector<lanelet::ConstLineString3d> left_lss, right_lss, center_lss;
+    for (const auto& lll : lanelets)
+    {
+      left_lss.push_back(lll.leftBound());
+      right_lss.push_back(lll.rightBound());
+      if (viz_centerline)
+        center_lss.push_back(lll.centerline());
+    }
+
+    visualization_msgs::Marker left_line_list, right_line_list, center_line_list;
+    visualization::lineStrings2LineListMarker(left_lss, &left_line_list, "map", "left_lane_bound", c, lss);
+    visualization::lineStrings2LineListMarker(right_lss, &right_line_list, "map", "right_lane_bound", c, lss);
+    marker_array.markers.push_back(left_line_list);
+    marker_array.markers.push_back(right_line_list);
+    if (viz_centerline)
+    {
+      visualization::lineStrings2LineListMarker(center_lss, &center_line_list, "map", "center_lane_line", c,
+                                                lss * 0.5);
+      marker_array.markers.push_back(center_line_list);
+    }
+    return marker_array;
+  }
+
   for (auto li = lanelets.begin(); li != lanelets.end(); li++)
   {
     lanelet::ConstLanelet lll = *li;
@@ -491,31 +1205,11 @@ visualization_msgs::MarkerArray visualization::trafficLightsAsTriangleMarkerArra
     const std::vector<lanelet::TrafficLightConstPtr> tl_reg_elems, const std_msgs::ColorRGBA c,
     const ros::Duration duration, const double scale)
 {
-  // convert to to an array of linestrings and publish as marker array using
-  // exisitng function
-
-  int tl_count = 0;
-  std::vector<lanelet::ConstLineString3d> line_strings;
   visualization_msgs::MarkerArray marker_array;
 
-  for (auto tli = tl_reg_elems.begin(); tli != tl_reg_elems.end(); tli++)
+  for (const auto& tl : tl_reg_elems)
   {
-    lanelet::TrafficLightConstPtr tl = *tli;
-    lanelet::LineString3d ls;
-
-    auto lights = tl->trafficLights();
-    for (auto lsp : lights)
-    {
-      if (lsp.isLineString())  // traffic ligths can either polygons or
-      {                        // linestrings
-        lanelet::ConstLineString3d ls = static_cast<lanelet::ConstLineString3d>(lsp);
-
-        visualization_msgs::Marker marker;
-        visualization::trafficLight2TriangleMarker(ls, &marker, "traffic_light_triangle", c, duration, scale);
-        marker_array.markers.push_back(marker);
-        tl_count++;
-      }
-    }
+    trafficLightShapesAsMarkers(tl->trafficLights(), c, duration, scale, &marker_array);
   }
 
   return (marker_array);
@@ -524,6 +1218,14 @@ visualization_msgs::MarkerArray visualization::trafficLightsAsTriangleMarkerArra
 visualization_msgs::MarkerArray visualization::laneletsAsTriangleMarkerArray(const std::string ns,
                                                                              const lanelet::ConstLanelets& lanelets,
                                                                              const std_msgs::ColorRGBA c)
+{
+  return laneletsAsTriangleMarkerArray(ns, lanelets, c, nullptr);
+}
+
+visualization_msgs::MarkerArray visualization::laneletsAsTriangleMarkerArray(const std::string ns,
+                                                                             const lanelet::ConstLanelets& lanelets,
+                                                                             const std_msgs::ColorRGBA c,
+                                                                             LaneletTriangleCache* cache)
 {
   visualization_msgs::MarkerArray marker_array;
   visualization_msgs::Marker marker;
@@ -547,10 +1249,15 @@ visualization_msgs::MarkerArray visualization::laneletsAsTriangleMarkerArray(con
 
   for (auto ll : lanelets)
   {
-    std::vector<geometry_msgs::Polygon> triangles;
-    lanelet2Triangle(ll, &triangles);
+    std::vector<geometry_msgs::Polygon> lanelet_triangles;
+    if (cache == nullptr)
+    {
+      lanelet2Triangle(ll, &lanelet_triangles);
+    }
+    const std::vector<geometry_msgs::Polygon>& triangles =
+        (cache == nullptr) ? lanelet_triangles : cache->triangles(ll);
 
-    for (auto tri : triangles)
+    for (const auto& tri : triangles)
     {
       geometry_msgs::Point tri0[3];
 
@@ -680,4 +1387,53 @@ void visualization::lineString2Marker(const lanelet::ConstLineString3d ls, visua
   }
 }
 
+void visualization::lineStrings2LineListMarker(const std::vector<lanelet::ConstLineString3d>& line_strings,
+                                               visualization_msgs::Marker* line_list, const std::string frame_id,
+                                               const std::string ns, const std_msgs::ColorRGBA c, const float lss)
+{
+  if (line_list == nullptr)
+  {
+    ROS_ERROR_STREAM(__FUNCTION__ << ": line_list is null pointer!");
+    return;
+  }
+
+  line_list->header.frame_id = frame_id;
+  line_list->header.stamp = ros::Time();
+  line_list->ns = ns;
+  line_list->action = visualization_msgs::Marker::ADD;
+
+  line_list->pose.orientation.w = 1.0;
+  line_list->id = 0;
+
+  line_list->type = visualization_msgs::Marker::LINE_LIST;
+
+  line_list->scale.x = lss;
+
+  line_list->color = c;
+
+  // every segment of every linestring, as pairs of points
+  size_t point_count = 0;
+  for (const auto& ls : line_strings)
+  {
+    if (ls.size() > 1)
+      point_count += 2 * (ls.size() - 1);
+  }
+  line_list->points.reserve(point_count);
+  for (const auto& ls : line_strings)
+  {
+    for (size_t i = 1; i < ls.size(); i++)
+    {
+      geometry_msgs::Point p0, p1;
+      p0.x = ls[i - 1].x();
+      p0.y = ls[i - 1].y();
+      p0.z = ls[i - 1].z();
+      p1.x = ls[i].x();
+      p1.y = ls[i].y();
+      p1.z = ls[i].z();
+      line_list->points.push_back(p0);
+      line_list->points.push_back(p1);
+    }
+  }
+}
+
 }  // namespace lanelet
@@ -0,0 +1,183 @@
+/*
+ * Copyright 2015-2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <lanelet2_core/primitives/Lanelet.h>
+#include <lanelet2_core/utility/Utilities.h>
+#include <lanelet2_io/Io.h>
+#include <lanelet2_io/io_handlers/Serialize.h>
+
+#include <lanelet2_extension/projection/mgrs_projector.h>
+#include <lanelet2_extension/utility/message_conversion.h>
+
+#include <boost/archive/binary_iarchive.hpp>
+#include <boost/archive/binary_oarchive.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <ros/ros.h>
+
+namespace
+{
+// conversion through std::stringstream and std::string as toBinMsg/fromBinMsg used to do, kept as reference
+void toBinMsgCopy(const lanelet::LaneletMapPtr& map, autoware_lanelet2_msgs::MapBin* msg)
+{
+  std::stringstream ss;
+  boost::archive::binary_oarchive oa(ss);
+  oa << *map;
+  auto id_counter = lanelet::utils::getId();
+  oa << id_counter;
+
+  std::string data_str(ss.str());
+
+  msg->data.clear();
+  msg->data.assign(data_str.begin(), data_str.end());
+}
+
+void fromBinMsgCopy(const autoware_lanelet2_msgs::MapBin& msg, lanelet::LaneletMapPtr map)
+{
+  std::string data_str;
+  data_str.assign(msg.data.begin(), msg.data.end());
+
+  std::stringstream ss;
+  ss << data_str;
+  boost::archive::binary_iarchive oa(ss);
+  oa >> *map;
+  lanelet::Id id_counter;
+  oa >> id_counter;
+  lanelet::utils::registerId(id_counter);
+}
+
+// rows x columns lanelets of 10m x 3.5m, every bound has points_per_bound points
+lanelet::LaneletMapPtr createGridMap(const int rows, const int columns, const int points_per_bound)
+{
+  lanelet::LaneletMapPtr map(new lanelet::LaneletMap);
+  const double length = 10.0;
+  const double width = 3.5;
+  const int n = std::max(points_per_bound, 2);
+
+  auto create_bound = [&](const double x, const double y) {
+    lanelet::Points3d points;
+    for (int i = 0; i < n; i++)
+    {
+      points.emplace_back(lanelet::utils::getId(), x + length * i / (n - 1), y, 0.0);
+    }
+    return lanelet::LineString3d(lanelet::utils::getId(), points);
+  };
+
+  for (int r = 0; r < rows; r++)
+  {
+    for (int c = 0; c < columns; c++)
+    {
+      lanelet::Lanelet lanelet(lanelet::utils::getId(), create_bound(c * length, (r + 1) * width),
+                               create_bound(c * length, r * width));
+      lanelet.attributes()[lanelet::AttributeName::Subtype] = lanelet::AttributeValueString::Road;
+      map->add(lanelet);
+    }
+  }
+  return map;
+}
+
+// best and mean time of repeats calls in milliseconds
+void measure(const std::string& name, const int repeats, const std::function<void()>& f)
+{
+  std::vector<double> times;
+  for (int i = 0; i < repeats; i++)
+  {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    auto end = std::chrono::steady_clock::now();
+    times.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+  }
+  double sum = 0;
+  for (const auto t : times)
+  {
+    sum += t;
+  }
+  std::cout << name << ": best " << *std::min_element(times.begin(), times.end()) << " ms, mean " << sum / repeats
+            << " ms" << std::endl;
+}
+}  // namespace
+
+int main(int argc, char* argv[])
+{
+  ros::init(argc, argv, "lanelet2_bin_msg_benchmark");
+  ros::NodeHandle pnh("~");
+
+  std::string map_file_path;
+  int rows, columns, points_per_bound, repeats;
+  pnh.param<std::string>("map_file", map_file_path, "");
+  pnh.param<int>("rows", rows, 20);
+  pnh.param<int>("columns", columns, 500);
+  pnh.param<int>("points_per_bound", points_per_bound, 5);
+  pnh.param<int>("repeats", repeats, 10);
+  repeats = std::max(repeats, 1);
+
+  lanelet::LaneletMapPtr map;
+  if (map_file_path.empty())
+  {
+    map = createGridMap(rows, columns, points_per_bound);
+  }
+  else
+  {
+    lanelet::ErrorMessages errors;
+    lanelet::projection::MGRSProjector projector;
+    map = lanelet::load(map_file_path, "autoware_osm_handler", projector, &errors);
+  }
+  if (!map)
+  {
+    ROS_FATAL_STREAM("failed to load " << map_file_path);
+    return 1;
+  }
+
+  autoware_lanelet2_msgs::MapBin copy_msg, stream_msg;
+  toBinMsgCopy(map, &copy_msg);
+  lanelet::utils::conversion::toBinMsg(map, &stream_msg);
+  std::cout << map->laneletLayer.size() << " lanelets, " << map->pointLayer.size() << " points, "
+            << stream_msg.data.size() << " bytes" << std::endl;
+  // only the trailing id counter may differ, getId() is called by each conversion
+  if (copy_msg.data.size() != stream_msg.data.size() ||
+      !std::equal(copy_msg.data.begin(), copy_msg.data.end() - sizeof(lanelet::Id), stream_msg.data.begin()))
+  {
+    ROS_ERROR_STREAM("streaming and copying conversions do not produce the same data");
+    return 1;
+  }
+
+  // a fresh message each time, as a node publishing the map only once would do
+  measure("toBinMsg (copies)", repeats, [&]() {
+    autoware_lanelet2_msgs::MapBin msg;
+    toBinMsgCopy(map, &msg);
+  });
+  measure("toBinMsg (streaming)", repeats, [&]() {
+    autoware_lanelet2_msgs::MapBin msg;
+    lanelet::utils::conversion::toBinMsg(map, &msg);
+  });
+  measure("fromBinMsg (copies)", repeats, [&]() {
+    lanelet::LaneletMapPtr regenerated_map(new lanelet::LaneletMap);
+    fromBinMsgCopy(stream_msg, regenerated_map);
+  });
+  measure("fromBinMsg (streaming)", repeats, [&]() {
+    lanelet::LaneletMapPtr regenerated_map(new lanelet::LaneletMap);
+    lanelet::utils::conversion::fromBinMsg(stream_msg, regenerated_map);
+  });
+
+  return 0;
+}
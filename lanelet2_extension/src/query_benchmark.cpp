@@ -0,0 +1,304 @@
+/*
+ * Copyright 2015-2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Map query layer on a synthetic map: query functions, QueryContext, matchWaypointAndLanelet,
+// overwriteLaneletsCenterline and the binary message conversion. Needs no ROS master.
+// Results are written as JSON to stdout or to the output file, in the format of vector_map_query_benchmark:
+// {"benchmark": ..., "map": {...}, "repeats": n, "results": [{"name", "operations", "best_ms", "mean_ms",
+// "ns_per_operation", "items"}]}, best and mean over the repeats, items is a count of what was found
+
+#include <lanelet2_core/primitives/Lanelet.h>
+#include <lanelet2_core/utility/Utilities.h>
+#include <lanelet2_routing/RoutingGraph.h>
+#include <lanelet2_traffic_rules/TrafficRulesFactory.h>
+
+#include <lanelet2_extension/regulatory_elements/autoware_traffic_light.h>
+#include <lanelet2_extension/utility/message_conversion.h>
+#include <lanelet2_extension/utility/query.h>
+#include <lanelet2_extension/utility/utilities.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace
+{
+struct Result
+{
+  std::string name;
+  size_t operations;
+  double best_ms;
+  double mean_ms;
+  size_t items;
+};
+
+const double LANELET_LENGTH = 10.0;
+const double LANELET_WIDTH = 3.5;
+const int POINTS_PER_BOUND = 5;
+
+// rows x columns road lanelets of 10m x 3.5m sharing their bounds, a traffic light with its stop line every
+// 10 lanelets of a row and a crosswalk lanelet every 20 columns
+lanelet::LaneletMapPtr createCityMap(const int rows, const int columns)
+{
+  lanelet::LaneletMapPtr map(new lanelet::LaneletMap);
+  const int n = POINTS_PER_BOUND;
+
+  // bounds[r][c] is the right bound of the lanelet of row r and column c, the left bound of row r - 1
+  std::vector<std::vector<lanelet::LineString3d>> bounds(rows + 1);
+  for (int r = 0; r <= rows; r++)
+  {
+    lanelet::Point3d first(lanelet::utils::getId(), 0.0, r * LANELET_WIDTH, 0.0);
+    for (int c = 0; c < columns; c++)
+    {
+      lanelet::Points3d points{ first };
+      for (int i = 1; i < n; i++)
+      {
+        points.emplace_back(lanelet::utils::getId(), LANELET_LENGTH * (c + static_cast<double>(i) / (n - 1)),
+                            r * LANELET_WIDTH, 0.0);
+      }
+      first = points.back();
+      bounds[r].emplace_back(lanelet::utils::getId(), points);
+    }
+  }
+
+  for (int r = 0; r < rows; r++)
+  {
+    for (int c = 0; c < columns; c++)
+    {
+      lanelet::Lanelet lanelet(lanelet::utils::getId(), bounds[r + 1][c], bounds[r][c]);
+      lanelet.attributes()[lanelet::AttributeName::Subtype] = lanelet::AttributeValueString::Road;
+      if (c % 10 == 9)
+      {
+        const double x = LANELET_LENGTH * (c + 1);
+        const double y = r * LANELET_WIDTH;
+        lanelet::Point3d base_start(lanelet::utils::getId(), x, y, 4.0);
+        lanelet::Point3d base_end(lanelet::utils::getId(), x, y + 1, 4.0);
+        lanelet::LineStringOrPolygon3d base(lanelet::LineString3d(lanelet::utils::getId(), { base_start, base_end }));
+        lanelet::LineString3d bulbs(lanelet::utils::getId(),
+                                    { lanelet::Point3d(lanelet::utils::getId(), x, y, 4.5),
+                                      lanelet::Point3d(lanelet::utils::getId(), x, y + 0.5, 4.5),
+                                      lanelet::Point3d(lanelet::utils::getId(), x, y + 1, 4.5) });
+        bulbs[0].attributes()["color"] = "red";
+        bulbs[1].attributes()["color"] = "yellow";
+        bulbs[2].attributes()["color"] = "green";
+        lanelet::LineString3d stop_line(lanelet::utils::getId(),
+                                        { lanelet::Point3d(lanelet::utils::getId(), x - 1, y, 0.0),
+                                          lanelet::Point3d(lanelet::utils::getId(), x - 1, y + LANELET_WIDTH, 0.0) });
+        lanelet.addRegulatoryElement(lanelet::autoware::AutowareTrafficLight::make(
+            lanelet::utils::getId(), lanelet::AttributeMap(), { base }, stop_line, { bulbs }));
+      }
+      map->add(lanelet);
+    }
+  }
+
+  for (int c = 19; c < columns; c += 20)
+  {
+    const double x = LANELET_LENGTH * c;
+    const double height = rows * LANELET_WIDTH;
+    lanelet::LineString3d left(lanelet::utils::getId(), { lanelet::Point3d(lanelet::utils::getId(), x, 0.0, 0.0),
+                                                          lanelet::Point3d(lanelet::utils::getId(), x, height, 0.0) });
+    lanelet::LineString3d right(lanelet::utils::getId(),
+                                { lanelet::Point3d(lanelet::utils::getId(), x + 3, 0.0, 0.0),
+                                  lanelet::Point3d(lanelet::utils::getId(), x + 3, height, 0.0) });
+    lanelet::Lanelet crosswalk(lanelet::utils::getId(), left, right);
+    crosswalk.attributes()[lanelet::AttributeName::Subtype] = lanelet::AttributeValueString::Crosswalk;
+    map->add(crosswalk);
+  }
+  return map;
+}
+
+// one lane of waypoints every 2m along the middle of each row, gids from 0
+autoware_msgs::LaneArray createLaneArray(const int rows, const int columns)
+{
+  autoware_msgs::LaneArray lane_array;
+  int gid = 0;
+  for (int r = 0; r < rows; r++)
+  {
+    autoware_msgs::Lane lane;
+    for (double x = 1.0; x < columns * LANELET_LENGTH; x += 2.0)
+    {
+      autoware_msgs::Waypoint waypoint;
+      waypoint.gid = gid++;
+      waypoint.pose.pose.position.x = x;
+      waypoint.pose.pose.position.y = (r + 0.5) * LANELET_WIDTH;
+      lane.waypoints.push_back(waypoint);
+    }
+    lane_array.lanes.push_back(lane);
+  }
+  return lane_array;
+}
+
+Result measure(const std::string& name, const int repeats, const size_t operations,
+               const std::function<size_t()>& f)
+{
+  Result result{ name, operations, 0.0, 0.0, 0 };
+  std::vector<double> times;
+  for (int i = 0; i < repeats; i++)
+  {
+    auto start = std::chrono::steady_clock::now();
+    result.items = f();
+    auto end = std::chrono::steady_clock::now();
+    times.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+  }
+  result.best_ms = *std::min_element(times.begin(), times.end());
+  double sum = 0;
+  for (const auto t : times)
+  {
+    sum += t;
+  }
+  result.mean_ms = sum / repeats;
+  return result;
+}
+
+void writeJson(std::ostream& os, const lanelet::LaneletMapPtr& map, const size_t waypoints, const int repeats,
+               const std::vector<Result>& results)
+{
+  os << "{\n"
+     << "  \"benchmark\": \"lanelet2_query\",\n"
+     << "  \"map\": {\"lanelets\": " << map->laneletLayer.size() << ", \"points\": " << map->pointLayer.size()
+     << ", \"regulatory_elements\": " << map->regulatoryElementLayer.size() << ", \"waypoints\": " << waypoints
+     << "},\n"
+     << "  \"repeats\": " << repeats << ",\n"
+     << "  \"results\": [\n";
+  for (size_t i = 0; i < results.size(); i++)
+  {
+    const Result& r = results[i];
+    os << "    {\"name\": \"" << r.name << "\", \"operations\": " << r.operations << ", \"best_ms\": " << r.best_ms
+       << ", \"mean_ms\": " << r.mean_ms << ", \"ns_per_operation\": " << r.best_ms * 1e6 / r.operations
+       << ", \"items\": " << r.items << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+  }
+  os << "  ]\n"
+     << "}\n";
+}
+}  // namespace
+
+int main(int argc, char* argv[])
+{
+  const int rows = (argc > 1) ? std::atoi(argv[1]) : 20;
+  const int columns = (argc > 2) ? std::atoi(argv[2]) : 500;
+  const int repeats = (argc > 3) ? std::atoi(argv[3]) : 10;
+  const std::string output_file = (argc > 4) ? argv[4] : "";
+  if (rows <= 0 || columns <= 0 || repeats <= 0)
+  {
+    std::printf("usage: %s [rows] [columns] [repeats] [output.json]\n", argv[0]);
+    return 1;
+  }
+
+  lanelet::LaneletMapPtr map = createCityMap(rows, columns);
+  const autoware_msgs::LaneArray lane_array = createLaneArray(rows, columns);
+  size_t waypoints = 0;
+  for (const auto& lane : lane_array.lanes)
+  {
+    waypoints += lane.waypoints.size();
+  }
+
+  std::vector<Result> results;
+  lanelet::ConstLanelets all_lanelets, road_lanelets;
+
+  results.push_back(measure("query::laneletLayer", repeats, 1, [&]() {
+    all_lanelets = lanelet::utils::query::laneletLayer(map);
+    return all_lanelets.size();
+  }));
+  results.push_back(measure("query::roadLanelets", repeats, 1, [&]() {
+    road_lanelets = lanelet::utils::query::roadLanelets(all_lanelets);
+    return road_lanelets.size();
+  }));
+  results.push_back(measure("query::crosswalkLanelets", repeats, 1, [&]() {
+    return lanelet::utils::query::crosswalkLanelets(all_lanelets).size();
+  }));
+  results.push_back(measure("query::trafficLights", repeats, 1, [&]() {
+    return lanelet::utils::query::trafficLights(all_lanelets).size();
+  }));
+  results.push_back(measure("query::autowareTrafficLights", repeats, 1, [&]() {
+    return lanelet::utils::query::autowareTrafficLights(all_lanelets).size();
+  }));
+  results.push_back(measure("query::getTrafficLightStopLines", repeats, 1, [&]() {
+    return lanelet::utils::query::getTrafficLightStopLines(road_lanelets).size();
+  }));
+  results.push_back(measure("query::getStopSignStopLines", repeats, 1, [&]() {
+    return lanelet::utils::query::getStopSignStopLines(road_lanelets).size();
+  }));
+
+  std::unique_ptr<lanelet::utils::query::QueryContext> context;
+  results.push_back(measure("QueryContext::QueryContext", repeats, 1, [&]() {
+    context.reset(new lanelet::utils::query::QueryContext(map));
+    return context->laneletLayer().size();
+  }));
+  results.push_back(measure("QueryContext::autowareTrafficLights", repeats, 1, [&]() {
+    return context->autowareTrafficLights(road_lanelets).size();
+  }));
+  results.push_back(measure("QueryContext::getTrafficLightStopLines", repeats, 1, [&]() {
+    return context->getTrafficLightStopLines(road_lanelets).size();
+  }));
+
+  lanelet::traffic_rules::TrafficRulesPtr traffic_rules = lanelet::traffic_rules::TrafficRulesFactory::create(
+      lanelet::Locations::Germany, lanelet::Participants::Vehicle);
+  lanelet::routing::RoutingGraphPtr routing_graph;
+  results.push_back(measure("RoutingGraph::build", repeats, 1, [&]() {
+    routing_graph = lanelet::routing::RoutingGraph::build(*map, *traffic_rules);
+    return map->laneletLayer.size();
+  }));
+  results.push_back(measure("matchWaypointAndLanelet (map)", repeats, waypoints, [&]() {
+    std::map<int, lanelet::Id> waypointid2laneletid;
+    lanelet::utils::matchWaypointAndLanelet(map, routing_graph, lane_array, &waypointid2laneletid);
+    return waypointid2laneletid.size();
+  }));
+  results.push_back(measure("matchWaypointAndLanelet (vector)", repeats, waypoints, [&]() {
+    std::vector<lanelet::Id> waypointid2laneletid;
+    lanelet::utils::matchWaypointAndLanelet(map, routing_graph, lane_array, &waypointid2laneletid);
+    return static_cast<size_t>(std::count_if(waypointid2laneletid.begin(), waypointid2laneletid.end(),
+                                             [](const lanelet::Id id) { return id != lanelet::InvalId; }));
+  }));
+
+  results.push_back(measure("overwriteLaneletsCenterline", repeats, map->laneletLayer.size(), [&]() {
+    lanelet::utils::overwriteLaneletsCenterline(map, true);
+    return map->laneletLayer.size();
+  }));
+
+  autoware_lanelet2_msgs::MapBin msg;
+  results.push_back(measure("conversion::toBinMsg", repeats, 1, [&]() {
+    msg = autoware_lanelet2_msgs::MapBin();
+    lanelet::utils::conversion::toBinMsg(map, &msg);
+    return msg.data.size();
+  }));
+  results.push_back(measure("conversion::fromBinMsg", repeats, 1, [&]() {
+    lanelet::LaneletMapPtr regenerated_map(new lanelet::LaneletMap);
+    lanelet::utils::conversion::fromBinMsg(msg, regenerated_map);
+    return regenerated_map->laneletLayer.size();
+  }));
+
+  if (output_file.empty())
+  {
+    writeJson(std::cout, map, waypoints, repeats, results);
+    return 0;
+  }
+  std::ofstream ofs(output_file);
+  writeJson(ofs, map, waypoints, repeats, results);
+  if (!ofs)
+  {
+    std::fprintf(stderr, "failed to write %s\n", output_file.c_str());
+    return 1;
+  }
+  return 0;
+}
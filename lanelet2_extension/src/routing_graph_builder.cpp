@@ -0,0 +1,98 @@
+/*
+ * Copyright 2015-2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <lanelet2_io/Io.h>
+#include <lanelet2_routing/RoutingGraph.h>
+#include <lanelet2_traffic_rules/TrafficRulesFactory.h>
+
+#include <lanelet2_extension/projection/mgrs_projector.h>
+#include <lanelet2_extension/utility/routing_graph_cache.h>
+
+#include <chrono>
+#include <iostream>
+#include <string>
+
+#include <ros/ros.h>
+
+void printUsage()
+{
+  std::cout << "Usage:" << std::endl
+            << "rosrun lanelet2_extension lanelet2_routing_graph_builder"
+               " _map_file:=<path to osm file>"
+               " [_location:=<traffic rules location>] [_participant:=<traffic rules participant>]"
+               " [_output_file:=<path to routing file>]"
+            << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+  ros::init(argc, argv, "lanelet2_routing_graph_builder");
+  ros::NodeHandle private_rosnode("~");
+
+  if (!private_rosnode.hasParam("map_file"))
+  {
+    ROS_FATAL_STREAM("failed find map_file parameter! No file to load");
+    printUsage();
+    return 1;
+  }
+
+  std::string map_path, location, participant, output_path;
+  private_rosnode.getParam("map_file", map_path);
+  private_rosnode.param<std::string>("location", location, lanelet::Locations::Germany);
+  private_rosnode.param<std::string>("participant", participant, lanelet::Participants::Vehicle);
+  private_rosnode.param<std::string>("output_file", output_path,
+                                     lanelet::utils::getRoutingGraphPath(map_path, location, participant));
+
+  lanelet::ErrorMessages errors;
+  lanelet::projection::MGRSProjector projector;
+  lanelet::LaneletMapPtr lanelet_map = lanelet::load(map_path, "autoware_osm_handler", projector, &errors);
+  if (!lanelet_map)
+  {
+    ROS_FATAL_STREAM("Missing map. Are you sure you set correct path for map?");
+    return 1;
+  }
+
+  lanelet::traffic_rules::TrafficRulesPtr traffic_rules =
+      lanelet::traffic_rules::TrafficRulesFactory::create(location, participant);
+
+  const auto start = std::chrono::steady_clock::now();
+  lanelet::routing::RoutingGraphPtr routing_graph = lanelet::routing::RoutingGraph::build(*lanelet_map, *traffic_rules);
+  const auto built = std::chrono::steady_clock::now();
+
+  lanelet::utils::RoutingRelations relations;
+  relations.build(*lanelet_map, *routing_graph, *traffic_rules);
+  if (!relations.save(output_path))
+  {
+    return 1;
+  }
+
+  // loaded back as a node would, so the file is known to be valid for this map
+  lanelet::utils::RoutingRelations loaded;
+  const auto load_start = std::chrono::steady_clock::now();
+  if (!loaded.load(output_path, *lanelet_map, *traffic_rules))
+  {
+    ROS_FATAL_STREAM("Failed to load " << output_path << " back");
+    return 1;
+  }
+  const auto loaded_time = std::chrono::steady_clock::now();
+
+  const std::chrono::duration<double, std::milli> build_ms = built - start;
+  const std::chrono::duration<double, std::milli> load_ms = loaded_time - load_start;
+  std::cout << "saved the routing graph of " << lanelet_map->laneletLayer.size() << " lanelets to " << output_path
+            << std::endl
+            << "build " << build_ms.count() << " ms, load " << load_ms.count() << " ms" << std::endl;
+  return 0;
+}
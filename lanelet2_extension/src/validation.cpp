@@ -26,8 +26,16 @@
 #include <lanelet2_extension/projection/mgrs_projector.h>
 #include <lanelet2_extension/regulatory_elements/autoware_traffic_light.h>
 
+#include <algorithm>
+#include <future>
 #include <iostream>
+#include <sstream>
 #include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
 
 #include <ros/ros.h>
 
@@ -50,11 +58,265 @@ void printUsage()
   std::cout << "Usage:" << std::endl
             << "rosrun lanelet2_extension autoware_lanelet2_validation"
                "_map_file:=<path to osm file>"
+               " [_reference_map_file:=<path to osm file>] [_num_threads:=<number of threads>]"
             << std::endl;
 }
+
+struct ValidationIssue
+{
+  bool is_error;
+  std::string message;
+};
+typedef std::vector<ValidationIssue> ValidationIssues;
+
+size_t g_num_threads = 1;
+
+// calls f(i, thread) for i in [0, n) in one chunk per thread
+template <class Function>
+void parallelChunks(const size_t n, const Function& f)
+{
+  const size_t num_chunks = std::max<size_t>(1, std::min(g_num_threads, n));
+  auto run_chunk = [&](const size_t c) {
+    for (size_t i = n * c / num_chunks; i < n * (c + 1) / num_chunks; i++)
+    {
+      f(i, c);
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (size_t c = 1; c < num_chunks; c++)
+  {
+    threads.emplace_back(run_chunk, c);
+  }
+  run_chunk(0);
+  for (auto& thread : threads)
+  {
+    thread.join();
+  }
+}
+
+// calls check(item, issues) for every item, issues are printed in the order of the items so that the output does
+// not depend on the number of threads
+template <class T, class Check>
+void checkPartitioned(const std::vector<T>& items, const Check& check)
+{
+  std::vector<ValidationIssues> chunk_issues(g_num_threads);
+  parallelChunks(items.size(), [&](const size_t i, const size_t c) { check(items[i], &chunk_issues[c]); });
+
+  for (const auto& issues : chunk_issues)
+  {
+    for (const auto& issue : issues)
+    {
+      if (issue.is_error)
+        ROS_ERROR_STREAM(issue.message);
+      else
+        ROS_WARN_STREAM(issue.message);
+    }
+  }
+}
+
+// FNV-1a hash of the members of an element, a changed hash means that the element or one of its members changed
+class FingerprintBuilder
+{
+public:
+  FingerprintBuilder() : hash_(14695981039346656037ULL)
+  {
+  }
+
+  FingerprintBuilder& add(const void* data, const size_t size)
+  {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; i++)
+    {
+      hash_ = (hash_ ^ bytes[i]) * 1099511628211ULL;
+    }
+    return *this;
+  }
+
+  FingerprintBuilder& add(const std::string& value)
+  {
+    // size first so that consecutive strings cannot be shifted into each other
+    add(static_cast<uint64_t>(value.size()));
+    return add(value.data(), value.size());
+  }
+
+  FingerprintBuilder& add(const double value)
+  {
+    return add(&value, sizeof(value));
+  }
+
+  FingerprintBuilder& add(const int64_t value)
+  {
+    return add(&value, sizeof(value));
+  }
+
+  FingerprintBuilder& add(const uint64_t value)
+  {
+    return add(&value, sizeof(value));
+  }
+
+  FingerprintBuilder& add(const lanelet::AttributeMap& attributes)
+  {
+    add(static_cast<uint64_t>(attributes.size()));
+    for (const auto& attribute : attributes)
+    {
+      add(attribute.first).add(attribute.second.value());
+    }
+    return *this;
+  }
+
+  FingerprintBuilder& add(const lanelet::ConstPoint3d& point)
+  {
+    return add(static_cast<int64_t>(point.id())).add(point.x()).add(point.y()).add(point.z()).add(point.attributes());
+  }
+
+  FingerprintBuilder& add(const lanelet::ConstLineString3d& line_string)
+  {
+    add(static_cast<int64_t>(line_string.id())).add(line_string.attributes());
+    add(static_cast<uint64_t>(line_string.size()));
+    for (const auto& point : line_string)
+    {
+      add(point);
+    }
+    return *this;
+  }
+
+  uint64_t value() const
+  {
+    return hash_;
+  }
+
+private:
+  uint64_t hash_;
+};
+
+uint64_t fingerprint(const lanelet::ConstPoint3d& point)
+{
+  return FingerprintBuilder().add(point).value();
+}
+
+uint64_t fingerprint(const lanelet::ConstLanelet& lanelet)
+{
+  FingerprintBuilder f;
+  f.add(static_cast<int64_t>(lanelet.id())).add(lanelet.attributes());
+  f.add(lanelet.leftBound()).add(lanelet.rightBound());
+  for (const auto& reg_elem : lanelet.regulatoryElements())
+  {
+    f.add(static_cast<int64_t>(reg_elem->id()));
+  }
+  return f.value();
+}
+
+uint64_t fingerprint(const lanelet::autoware::AutowareTrafficLightConstPtr& light)
+{
+  FingerprintBuilder f;
+  f.add(static_cast<int64_t>(light->id())).add(light->attributes());
+  for (const auto& base_string_or_poly : light->trafficLights())
+  {
+    f.add(static_cast<int64_t>(base_string_or_poly.id()));
+    if (base_string_or_poly.isLineString())
+    {
+      f.add(static_cast<lanelet::ConstLineString3d>(base_string_or_poly));
+    }
+  }
+  for (const auto& light_bulb : light->lightBulbs())
+  {
+    f.add(light_bulb);
+  }
+  auto stop_line = light->stopLine();
+  if (!!stop_line)
+  {
+    f.add(stop_line.get());
+  }
+  return f.value();
+}
+
+std::vector<lanelet::autoware::AutowareTrafficLightConstPtr> autowareTrafficLights(
+    const lanelet::LaneletMapPtr lanelet_map)
+{
+  std::vector<lanelet::autoware::AutowareTrafficLightConstPtr> lights;
+  for (const auto& reg_elem : lanelet_map->regulatoryElementLayer)
+  {
+    auto light = std::dynamic_pointer_cast<const lanelet::autoware::AutowareTrafficLight>(reg_elem);
+    if (light)
+    {
+      lights.push_back(light);
+    }
+  }
+  return lights;
+}
+
+lanelet::Id elementId(const lanelet::ConstPoint3d& point)
+{
+  return point.id();
+}
+
+lanelet::Id elementId(const lanelet::ConstLanelet& lanelet)
+{
+  return lanelet.id();
+}
+
+lanelet::Id elementId(const lanelet::autoware::AutowareTrafficLightConstPtr& light)
+{
+  return light->id();
+}
+
+/**
+ * [ChangedElements ids of elements which are new or changed since the
+ * reference map. Empty sets and is_incremental false validate every element]
+ */
+struct ChangedElements
+{
+  bool is_incremental = false;
+  std::unordered_set<lanelet::Id> points;
+  std::unordered_set<lanelet::Id> lanelets;
+  std::unordered_set<lanelet::Id> traffic_lights;
+
+  bool isPointChanged(const lanelet::Id id) const
+  {
+    return !is_incremental || points.count(id) > 0;
+  }
+  bool isLaneletChanged(const lanelet::Id id) const
+  {
+    return !is_incremental || lanelets.count(id) > 0;
+  }
+  bool isTrafficLightChanged(const lanelet::Id id) const
+  {
+    return !is_incremental || traffic_lights.count(id) > 0;
+  }
+};
+
+// ids of elements whose fingerprint is not the same in the reference elements
+template <class T>
+void findChangedElements(const std::vector<T>& elements, const std::vector<T>& reference_elements,
+                         std::unordered_set<lanelet::Id>* changed_ids)
+{
+  auto get_id = [](const T& element) { return elementId(element); };
+  std::vector<uint64_t> fingerprints(elements.size());
+  std::vector<uint64_t> reference_fingerprints(reference_elements.size());
+  parallelChunks(elements.size(), [&](const size_t i, const size_t) { fingerprints[i] = fingerprint(elements[i]); });
+  parallelChunks(reference_elements.size(), [&](const size_t i, const size_t) {
+    reference_fingerprints[i] = fingerprint(reference_elements[i]);
+  });
+
+  std::unordered_map<lanelet::Id, uint64_t> reference_by_id;
+  for (size_t i = 0; i < reference_elements.size(); i++)
+  {
+    reference_by_id[get_id(reference_elements[i])] = reference_fingerprints[i];
+  }
+  for (size_t i = 0; i < elements.size(); i++)
+  {
+    auto it = reference_by_id.find(get_id(elements[i]));
+    if (it == reference_by_id.end() || it->second != fingerprints[i])
+    {
+      changed_ids->insert(get_id(elements[i]));
+    }
+  }
+}
+
 }  // namespace
 
-void validateElevationTag(const std::string filename)
+void validateElevationTag(const std::string filename, const ChangedElements& changed)
 {
   pugi::xml_document doc;
   auto result = doc.load_file(filename.c_str());
@@ -65,91 +327,144 @@ void validateElevationTag(const std::string filename)
   }
 
   auto osmNode = doc.child("osm");
+  std::vector<pugi::xml_node> nodes;
   for (auto node = osmNode.child(keyword::Node); node;  // NOLINT
        node = node.next_sibling(keyword::Node))
   {
+    if (changed.isPointChanged(node.attribute(keyword::Id).as_llong(lanelet::InvalId)))
+    {
+      nodes.push_back(node);
+    }
+  }
+
+  checkPartitioned(nodes, [](const pugi::xml_node& node, ValidationIssues* issues) {
     const auto id = node.attribute(keyword::Id).as_llong(lanelet::InvalId);
     if (!node.find_child_by_attribute(keyword::Tag, keyword::Key, keyword::Elevation))
     {
-      ROS_ERROR_STREAM("failed to find elevation tag for node: " << id);
+      std::ostringstream ss;
+      ss << "failed to find elevation tag for node: " << id;
+      issues->push_back(ValidationIssue{ true, ss.str() });
     }
-  }
+  });
 }
 
-void validateTrafficLight(const lanelet::LaneletMapPtr lanelet_map)
+void validateTrafficLight(const lanelet::LaneletMapPtr lanelet_map, const ChangedElements& changed)
 {
-  if (!lanelet_map)
+  // every traffic light once, even if it is referred by several lanelets
+  std::vector<lanelet::autoware::AutowareTrafficLightConstPtr> lights;
+  for (const auto& light : autowareTrafficLights(lanelet_map))
   {
-    ROS_FATAL_STREAM("Missing map. Are you sure you set correct path for map?");
-    exit(1);
+    if (changed.isTrafficLightChanged(light->id()))
+    {
+      lights.push_back(light);
+    }
   }
 
-  for (auto lanelet : lanelet_map->laneletLayer)
-  {
-    auto autoware_traffic_lights = lanelet.regulatoryElementsAs<lanelet::autoware::AutowareTrafficLight>();
-    if (autoware_traffic_lights.empty())
-      continue;
-    for (auto light : autoware_traffic_lights)
+  checkPartitioned(lights, [](const lanelet::autoware::AutowareTrafficLightConstPtr& light,
+                              ValidationIssues* issues) {
+    if (light->lightBulbs().size() == 0)
     {
-      if (light->lightBulbs().size() == 0)
+      std::ostringstream ss;
+      ss << "regulatory element traffic light " << light->id()
+         << " is missing optional light_bulb member. You won't be able to use region_tlr node with this map";
+      issues->push_back(ValidationIssue{ false, ss.str() });
+    }
+    for (auto light_string : light->lightBulbs())
+    {
+      if (!light_string.hasAttribute("traffic_light_id"))
       {
-        ROS_WARN_STREAM("regulatory element traffic light " << light->id()
-                                                            << " is missing optional light_bulb member. You won't "
-                                                               "be able to use region_tlr node with this map");
+        std::ostringstream ss;
+        ss << "light_bulb " << light_string.id() << " is missing traffic_light_id tag";
+        issues->push_back(ValidationIssue{ true, ss.str() });
       }
-      for (auto light_string : light->lightBulbs())
+    }
+    for (auto base_string_or_poly : light->trafficLights())
+    {
+      if (!base_string_or_poly.isLineString())
       {
-        if (!light_string.hasAttribute("traffic_light_id"))
-        {
-          ROS_ERROR_STREAM("light_bulb " << light_string.id() << " is missing traffic_light_id tag");
-        }
+        std::ostringstream ss;
+        ss << "traffic_light " << base_string_or_poly.id()
+           << " is polygon, and only linestring class is currently supported for traffic lights";
+        issues->push_back(ValidationIssue{ true, ss.str() });
       }
-      for (auto base_string_or_poly : light->trafficLights())
+      auto base_string = static_cast<lanelet::ConstLineString3d>(base_string_or_poly);
+      if (!base_string.hasAttribute("height"))
       {
-        if (!base_string_or_poly.isLineString())
-        {
-          ROS_ERROR_STREAM("traffic_light " << base_string_or_poly.id()
-                                            << " is polygon, and only linestring class is currently supported for "
-                                               "traffic lights");
-        }
-        auto base_string = static_cast<lanelet::LineString3d>(base_string_or_poly);
-        if (!base_string.hasAttribute("height"))
-        {
-          ROS_ERROR_STREAM("traffic_light " << base_string.id() << " is missing height tag");
-        }
+        std::ostringstream ss;
+        ss << "traffic_light " << base_string.id() << " is missing height tag";
+        issues->push_back(ValidationIssue{ true, ss.str() });
       }
     }
-  }
+  });
 }
 
-void validateTurnDirection(const lanelet::LaneletMapPtr lanelet_map)
+void validateTurnDirection(const lanelet::LaneletMapPtr lanelet_map,
+                           const lanelet::traffic_rules::TrafficRulesPtr& traffic_rules,
+                           const lanelet::routing::RoutingGraphPtr& vehicle_graph, const ChangedElements& changed)
 {
-  if (!lanelet_map)
+  // a changed lanelet can also make its conflicting lanelets need turn_direction
+  std::unordered_set<lanelet::Id> lanelet_ids;
+  if (changed.is_incremental)
   {
-    ROS_FATAL_STREAM("Missing map. Are you sure you set correct path for map?");
-    exit(1);
+    for (const auto id : changed.lanelets)
+    {
+      const auto lanelet = lanelet_map->laneletLayer.get(id);
+      lanelet_ids.insert(id);
+      if (!traffic_rules->canPass(lanelet))
+      {
+        continue;
+      }
+      for (const auto& conflicting : vehicle_graph->conflicting(lanelet))
+      {
+        lanelet_ids.insert(conflicting.id());
+      }
+    }
   }
 
-  lanelet::traffic_rules::TrafficRulesPtr traffic_rules =
-      lanelet::traffic_rules::TrafficRulesFactory::create(lanelet::Locations::Germany, lanelet::Participants::Vehicle);
-  lanelet::routing::RoutingGraphPtr vehicle_graph = lanelet::routing::RoutingGraph::build(*lanelet_map, *traffic_rules);
-
+  lanelet::ConstLanelets lanelets;
   for (const auto& lanelet : lanelet_map->laneletLayer)
   {
+    if (!changed.is_incremental || lanelet_ids.count(lanelet.id()) > 0)
+    {
+      lanelets.push_back(lanelet);
+    }
+  }
+
+  checkPartitioned(lanelets, [&](const lanelet::ConstLanelet& lanelet, ValidationIssues* issues) {
     if (!traffic_rules->canPass(lanelet))
     {
-      continue;
+      return;
     }
 
     const auto conflicting_lanelets_or_areas = vehicle_graph->conflicting(lanelet);
     if (conflicting_lanelets_or_areas.size() == 0)
-      continue;
+      return;
     if (!lanelet.hasAttribute("turn_direction"))
     {
-      ROS_ERROR_STREAM("lanelet " << lanelet.id() << " seems to be intersecting other lanelet, but does "
-                                                     "not have turn_direction tagging.");
+      std::ostringstream ss;
+      ss << "lanelet " << lanelet.id() << " seems to be intersecting other lanelet, but does not have "
+                                          "turn_direction tagging.";
+      issues->push_back(ValidationIssue{ true, ss.str() });
     }
-  }
+  });
+}
+
+ChangedElements findChangedElements(const lanelet::LaneletMapPtr lanelet_map,
+                                    const lanelet::LaneletMapPtr reference_map)
+{
+  ChangedElements changed;
+  changed.is_incremental = true;
+
+  typedef std::vector<lanelet::ConstPoint3d> ConstPoints3d;
+  findChangedElements(ConstPoints3d(lanelet_map->pointLayer.begin(), lanelet_map->pointLayer.end()),
+                      ConstPoints3d(reference_map->pointLayer.begin(), reference_map->pointLayer.end()),
+                      &changed.points);
+  findChangedElements(lanelet::ConstLanelets(lanelet_map->laneletLayer.begin(), lanelet_map->laneletLayer.end()),
+                      lanelet::ConstLanelets(reference_map->laneletLayer.begin(), reference_map->laneletLayer.end()),
+                      &changed.lanelets);
+  findChangedElements(autowareTrafficLights(lanelet_map), autowareTrafficLights(reference_map),
+                      &changed.traffic_lights);
+  return changed;
 }
 
 int main(int argc, char* argv[])
@@ -168,16 +483,55 @@ int main(int argc, char* argv[])
   std::string map_path = "";
   private_rosnode.getParam("map_file", map_path);
 
+  // only elements which are new or changed since the reference map are validated
+  std::string reference_map_path = "";
+  private_rosnode.getParam("reference_map_file", reference_map_path);
+
+  int num_threads = 0;
+  private_rosnode.getParam("num_threads", num_threads);
+  g_num_threads = (num_threads > 0) ? num_threads : std::max(1u, std::thread::hardware_concurrency());
+
   lanelet::LaneletMapPtr lanelet_map;
   lanelet::ErrorMessages errors;
   lanelet::projection::MGRSProjector projector;
   lanelet_map = lanelet::load(map_path, "autoware_osm_handler", projector, &errors);
+  if (!lanelet_map)
+  {
+    ROS_FATAL_STREAM("Missing map. Are you sure you set correct path for map?");
+    return 1;
+  }
+
+  // the routing graph is only needed by the last check, so it is built while the others run
+  lanelet::traffic_rules::TrafficRulesPtr traffic_rules =
+      lanelet::traffic_rules::TrafficRulesFactory::create(lanelet::Locations::Germany, lanelet::Participants::Vehicle);
+  std::future<lanelet::routing::RoutingGraphPtr> vehicle_graph =
+      std::async(std::launch::async, [&]() -> lanelet::routing::RoutingGraphPtr {
+        return lanelet::routing::RoutingGraph::build(*lanelet_map, *traffic_rules);
+      });
+
+  ChangedElements changed;
+  if (!reference_map_path.empty())
+  {
+    lanelet::ErrorMessages reference_errors;
+    lanelet::projection::MGRSProjector reference_projector;
+    lanelet::LaneletMapPtr reference_map =
+        lanelet::load(reference_map_path, "autoware_osm_handler", reference_projector, &reference_errors);
+    if (!reference_map)
+    {
+      ROS_FATAL_STREAM("Missing reference map. Are you sure you set correct path for reference_map_file?");
+      return 1;
+    }
+    changed = findChangedElements(lanelet_map, reference_map);
+    std::cout << "validating changes since " << reference_map_path << ": " << changed.points.size() << " points, "
+              << changed.lanelets.size() << " lanelets, " << changed.traffic_lights.size() << " traffic lights"
+              << std::endl;
+  }
 
   std::cout << "starting validation" << std::endl;
 
-  validateElevationTag(map_path);
-  validateTrafficLight(lanelet_map);
-  validateTurnDirection(lanelet_map);
+  validateElevationTag(map_path, changed);
+  validateTrafficLight(lanelet_map, changed);
+  validateTurnDirection(lanelet_map, traffic_rules, vehicle_graph.get(), changed);
 
   std::cout << "finished validation" << std::endl;
 
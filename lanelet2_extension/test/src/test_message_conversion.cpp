@@ -20,6 +20,13 @@
 
 #include <lanelet2_extension/utility/message_conversion.h>
 #include <lanelet2_extension/utility/query.h>
+#include <lanelet2_io/io_handlers/Serialize.h>
+
+#include <boost/archive/binary_oarchive.hpp>
+
+#include <algorithm>
+#include <sstream>
+#include <string>
 
 using lanelet::Lanelet;
 using lanelet::LineString3d;
@@ -73,6 +80,52 @@ TEST_F(TestSuite, BinMsgConversion)
   ASSERT_EQ(original_lanelet.front().id(), regenerated_lanelet.front().id()) << "regerated map has different id";
 }
 
+TEST_F(TestSuite, BinMsgConversionReusedMessage)
+{
+  // the archive is written in place, so data must match a plain boost archive of the map whatever the message held
+  autoware_lanelet2_msgs::MapBin bin_msg;
+  bin_msg.data.assign(1024, 1);
+  lanelet::utils::conversion::toBinMsg(single_lanelet_map_ptr, &bin_msg);
+
+  std::stringstream ss;
+  boost::archive::binary_oarchive oa(ss);
+  oa << *single_lanelet_map_ptr;
+  auto id_counter = lanelet::utils::getId();
+  oa << id_counter;
+  std::string data_str(ss.str());
+
+  ASSERT_EQ(data_str.size(), bin_msg.data.size()) << "converted bin message has a different size than the archive";
+  // the trailing id counter differs, getId() was called once more
+  ASSERT_TRUE(std::equal(data_str.begin(), data_str.end() - sizeof(lanelet::Id),
+                         reinterpret_cast<const char*>(bin_msg.data.data())))
+      << "converted bin message has different data than the archive";
+
+  lanelet::LaneletMapPtr regenerated_map(new lanelet::LaneletMap);
+  lanelet::utils::conversion::fromBinMsg(bin_msg, regenerated_map);
+  ASSERT_EQ(single_lanelet_map_ptr->laneletLayer.size(), regenerated_map->laneletLayer.size())
+      << "regenerated map has different number of lanelets";
+}
+
+TEST_F(TestSuite, SharedMapConversion)
+{
+  autoware_lanelet2_msgs::MapBin bin_msg;
+  lanelet::utils::conversion::toBinMsg(single_lanelet_map_ptr, &bin_msg);
+
+  std::string name = lanelet::utils::conversion::toSharedMap(bin_msg);
+  ASSERT_FALSE(name.empty()) << "failed to create shared memory";
+
+  lanelet::LaneletMapPtr regenerated_map(new lanelet::LaneletMap);
+  ASSERT_TRUE(lanelet::utils::conversion::fromSharedMap(name, regenerated_map)) << "failed to read shared memory";
+
+  auto original_lanelet = lanelet::utils::query::laneletLayer(single_lanelet_map_ptr);
+  auto regenerated_lanelet = lanelet::utils::query::laneletLayer(regenerated_map);
+  ASSERT_EQ(original_lanelet.front().id(), regenerated_lanelet.front().id()) << "regerated map has different id";
+
+  lanelet::utils::conversion::removeSharedMap(name);
+  lanelet::LaneletMapPtr missing_map(new lanelet::LaneletMap);
+  ASSERT_FALSE(lanelet::utils::conversion::fromSharedMap(name, missing_map)) << "removed shared memory was read";
+}
+
 TEST_F(TestSuite, ToGeomMsgPt)
 {
   Point3d lanelet_pt(getId(), -0.1, 0.2, 3.0);
@@ -19,6 +19,8 @@
 #include <gtest/gtest.h>
 #include <math.h>
 
+#include <vector>
+
 #include <lanelet2_extension/projection/mgrs_projector.h>
 
 class TestSuite : public ::testing::Test
@@ -79,6 +81,36 @@ TEST(TestSuite, ReverseProjection)
   ASSERT_DOUBLE_EQ(rounded_lon, 139.83947721) << "Reverse projected longitude value should be " << 139.83947721;
 }
 
+TEST(TestSuite, ForwardProjectionCachedGrid)
+{
+  lanelet::projection::MGRSProjector projector;
+  std::vector<lanelet::GPSPoint> gps_points;
+  // points around Tokyo in grid 54SUE, then one in Osaka in another grid
+  for (int i = 0; i < 10; i++)
+  {
+    gps_points.push_back(lanelet::GPSPoint{ 35.652832 + i * 1e-3, 139.839478 - i * 1e-3, 0.1 * i });
+  }
+  gps_points.push_back(lanelet::GPSPoint{ 34.702485, 135.495951, 0.0 });
+
+  std::vector<lanelet::BasicPoint3d> mgrs_points = projector.forward(gps_points);
+  ASSERT_EQ(gps_points.size(), mgrs_points.size()) << "Every point should be projected";
+  ASSERT_NE(projector.getProjectedMGRSGrid(), "54SUE") << "Projected grid should follow the last point";
+
+  for (size_t i = 0; i < gps_points.size(); i++)
+  {
+    // a new projector generates the mgrs code for its first point
+    lanelet::projection::MGRSProjector reference_projector;
+    lanelet::BasicPoint3d reference_point = reference_projector.forward(gps_points.at(i));
+    ASSERT_DOUBLE_EQ(reference_point.x(), mgrs_points.at(i).x()) << "Cached grid changed projected x value";
+    ASSERT_DOUBLE_EQ(reference_point.y(), mgrs_points.at(i).y()) << "Cached grid changed projected y value";
+    ASSERT_DOUBLE_EQ(reference_point.z(), mgrs_points.at(i).z()) << "Cached grid changed projected z value";
+
+    projector.forward(gps_points.at(i));
+    ASSERT_EQ(reference_projector.getProjectedMGRSGrid(), projector.getProjectedMGRSGrid())
+        << "Cached grid changed projected grid";
+  }
+}
+
 int main(int argc, char** argv)
 {
   testing::InitGoogleTest(&argc, argv);
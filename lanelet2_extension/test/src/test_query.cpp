@@ -19,6 +19,9 @@
 #include <math.h>
 #include <ros/ros.h>
 
+#include <utility>
+#include <vector>
+
 using lanelet::Lanelet;
 using lanelet::LineString3d;
 using lanelet::LineStringOrPolygon3d;
@@ -101,6 +104,40 @@ TEST_F(TestSuite, QueryLanelets)
   ASSERT_EQ(1, crosswalk_lanelets.size()) << "failed to retrieve crosswalk lanelets";
 }
 
+TEST_F(TestSuite, QueryContext)
+{
+  lanelet::utils::query::QueryContext context(sample_map_ptr);
+  ASSERT_EQ(2, context.laneletLayer().size()) << "failed to retrieve all lanelets";
+  ASSERT_EQ(1, context.roadLanelets().size()) << "failed to retrieve road lanelets";
+  ASSERT_EQ(1, context.crosswalkLanelets().size()) << "failed to retrieve crosswalk lanelets";
+  ASSERT_EQ(1, context.subtypeLanelets(lanelet::AttributeValueString::Road).size())
+      << "failed to retrieve road lanelet by subtypeLanelets";
+  ASSERT_TRUE(context.subtypeLanelets(lanelet::AttributeValueString::Walkway).empty())
+      << "subtype which is not in the map should not have lanelets";
+  ASSERT_EQ(-1, context.getSubtypeId(lanelet::AttributeValueString::Walkway)) << "unknown subtype has an id";
+
+  const int road_id = context.getSubtypeId(lanelet::AttributeValueString::Road);
+  ASSERT_EQ(road_id, context.getLaneletSubtypeId(context.roadLanelets().front().id()))
+      << "road lanelet has a different subtype id";
+
+  std::vector<lanelet::BasicPoint2d> points{ lanelet::BasicPoint2d(0.5, 0.5), lanelet::BasicPoint2d(3.0, 0.5) };
+
+  std::vector<lanelet::ConstLanelets> contacting_lanelets;
+  context.contactingLanelets(points, -1, &contacting_lanelets);
+  ASSERT_EQ(2, contacting_lanelets.size()) << "one result per point is expected";
+  ASSERT_EQ(2, contacting_lanelets.at(0).size()) << "failed to retrieve contacting lanelets";
+  ASSERT_TRUE(contacting_lanelets.at(1).empty()) << "point out of the lanelets has contacting lanelets";
+
+  context.contactingLanelets(points, road_id, &contacting_lanelets);
+  ASSERT_EQ(1, contacting_lanelets.at(0).size()) << "failed to retrieve contacting road lanelets";
+
+  std::vector<std::vector<std::pair<double, lanelet::ConstLanelet> > > nearest_lanelets;
+  context.nearestLanelets(points, 1, &nearest_lanelets);
+  ASSERT_EQ(2, nearest_lanelets.size()) << "one result per point is expected";
+  ASSERT_EQ(1, nearest_lanelets.at(1).size()) << "failed to retrieve nearest lanelet";
+  ASSERT_DOUBLE_EQ(2.0, nearest_lanelets.at(1).front().first) << "wrong distance to nearest lanelet";
+}
+
 TEST_F(TestSuite, QueryTrafficLights)
 {
   lanelet::ConstLanelets all_lanelets = lanelet::utils::query::laneletLayer(sample_map_ptr);
@@ -124,6 +161,34 @@ TEST_F(TestSuite, QueryStopLine)
   ASSERT_EQ(1, stop_lines2.size()) << "failed to retrieve stop lines from a lanelet";
 }
 
+TEST_F(TestSuite, QueryContextRegulatoryElements)
+{
+  lanelet::ConstLanelets all_lanelets = lanelet::utils::query::laneletLayer(sample_map_ptr);
+  lanelet::ConstLanelets road_lanelets = lanelet::utils::query::roadLanelets(all_lanelets);
+  lanelet::utils::query::QueryContext context(sample_map_ptr);
+
+  const auto& elements = context.regulatoryElements(road_lanelets.front().id());
+  ASSERT_EQ(1, elements.autoware_traffic_lights.size()) << "failed to index autoware traffic lights of a lanelet";
+  ASSERT_EQ(1, elements.traffic_light_stop_lines.size()) << "failed to index stop lines of a lanelet";
+  ASSERT_TRUE(context.regulatoryElements(lanelet::InvalId).traffic_lights.empty())
+      << "unknown lanelet must have no regulatory elements";
+
+  ASSERT_EQ(lanelet::utils::query::trafficLights(all_lanelets).size(), context.trafficLights(all_lanelets).size())
+      << "indexed traffic lights differ from query";
+  ASSERT_EQ(lanelet::utils::query::autowareTrafficLights(all_lanelets).size(),
+            context.autowareTrafficLights(all_lanelets).size())
+      << "indexed autoware traffic lights differ from query";
+
+  auto stop_lines = lanelet::utils::query::getTrafficLightStopLines(all_lanelets);
+  auto indexed_stop_lines = context.getTrafficLightStopLines(all_lanelets);
+  ASSERT_EQ(stop_lines.size(), indexed_stop_lines.size()) << "indexed stop lines differ from query";
+  ASSERT_EQ(stop_lines.front().id(), indexed_stop_lines.front().id()) << "indexed stop lines differ from query";
+
+  ASSERT_EQ(lanelet::utils::query::getStopSignStopLines(all_lanelets).size(),
+            context.getStopSignStopLines(all_lanelets).size())
+      << "indexed stop sign stop lines differ from query";
+}
+
 int main(int argc, char** argv)
 {
   testing::InitGoogleTest(&argc, argv);
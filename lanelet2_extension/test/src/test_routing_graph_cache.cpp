@@ -0,0 +1,154 @@
+/*
+ * Copyright 2015-2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+#include <lanelet2_extension/utility/routing_graph_cache.h>
+#include <lanelet2_extension/utility/utilities.h>
+#include <lanelet2_traffic_rules/TrafficRulesFactory.h>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+#include <ros/ros.h>
+
+using lanelet::Lanelet;
+using lanelet::LineString3d;
+using lanelet::Point3d;
+using lanelet::utils::getId;
+
+class TestSuite : public ::testing::Test
+{
+public:
+  TestSuite() : sample_map_ptr(new lanelet::LaneletMap()), path("/tmp/test_routing_graph_cache.routing")
+  {  // NOLINT
+    // three chained lanelets
+    Point3d p1(getId(), 0., 0., 0.);
+    Point3d p2(getId(), 0., 1., 0.);
+    Point3d p3(getId(), 1., 0., 0.);
+    Point3d p4(getId(), 1., 1., 0.);
+    Point3d p5(getId(), 0., 2., 0.);
+    Point3d p6(getId(), 1., 2., 0.);
+    Point3d p7(getId(), 0., 3., 0.);
+    Point3d p8(getId(), 1., 3., 0.);
+
+    road_lanelet = Lanelet(getId(), LineString3d(getId(), { p1, p2 }), LineString3d(getId(), { p3, p4 }));  // NOLINT
+    next_lanelet = Lanelet(getId(), LineString3d(getId(), { p2, p5 }), LineString3d(getId(), { p4, p6 }));  // NOLINT
+    next_lanelet2 = Lanelet(getId(), LineString3d(getId(), { p5, p7 }), LineString3d(getId(), { p6, p8 }));  // NOLINT
+    for (auto lanelet : { road_lanelet, next_lanelet, next_lanelet2 })  // NOLINT
+    {
+      lanelet.attributes()[lanelet::AttributeName::Subtype] = lanelet::AttributeValueString::Road;
+      sample_map_ptr->add(lanelet);
+    }
+
+    traffic_rules = lanelet::traffic_rules::TrafficRulesFactory::create(lanelet::Locations::Germany,
+                                                                        lanelet::Participants::Vehicle);
+  }
+  ~TestSuite()
+  {
+    std::remove(path.c_str());
+  }
+
+  lanelet::LaneletMapPtr sample_map_ptr;
+  lanelet::traffic_rules::TrafficRulesPtr traffic_rules;
+  std::string path;
+  Lanelet road_lanelet;
+  Lanelet next_lanelet;
+  Lanelet next_lanelet2;
+};
+
+TEST_F(TestSuite, SaveAndLoadRelations)
+{
+  lanelet::routing::RoutingGraphPtr routing_graph =
+      lanelet::routing::RoutingGraph::build(*sample_map_ptr, *traffic_rules);
+  lanelet::utils::RoutingRelations relations;
+  relations.build(*sample_map_ptr, *routing_graph, *traffic_rules);
+  ASSERT_TRUE(relations.save(path)) << "failed to save the routing relations";
+
+  lanelet::utils::RoutingRelations loaded;
+  ASSERT_TRUE(loaded.load(path, *sample_map_ptr, *traffic_rules)) << "failed to load the routing relations";
+  ASSERT_EQ(relations.getMapFingerprint(), loaded.getMapFingerprint()) << "fingerprint differs";
+  ASSERT_EQ(std::vector<lanelet::Id>{ next_lanelet.id() }, loaded.following(road_lanelet.id()));  // NOLINT
+  ASSERT_EQ(std::vector<lanelet::Id>{ road_lanelet.id() }, loaded.previous(next_lanelet.id()));  // NOLINT
+  ASSERT_TRUE(loaded.following(next_lanelet2.id()).empty()) << "last lanelet has a following lanelet";
+  ASSERT_TRUE(loaded.following(getId()).empty()) << "unknown lanelet has a following lanelet";
+
+  // other traffic rules
+  lanelet::traffic_rules::TrafficRulesPtr pedestrian_rules = lanelet::traffic_rules::TrafficRulesFactory::create(
+      lanelet::Locations::Germany, lanelet::Participants::Pedestrian);
+  ASSERT_FALSE(loaded.load(path, *sample_map_ptr, *pedestrian_rules)) << "relations of other traffic rules loaded";
+  ASSERT_TRUE(loaded.empty()) << "failed load must leave no relations";
+
+  // edited map
+  next_lanelet2.attributes()[lanelet::AttributeName::OneWay] = "no";
+  ASSERT_FALSE(loaded.load(path, *sample_map_ptr, *traffic_rules)) << "relations of another map version loaded";
+
+  // damaged file
+  ASSERT_TRUE(relations.save(path));
+  std::ofstream(path, std::ios::binary | std::ios::in | std::ios::out).write("XXXX", 4);
+  ASSERT_FALSE(loaded.load(path, *sample_map_ptr, *traffic_rules)) << "damaged file loaded";
+}
+
+TEST_F(TestSuite, MatchWaypointAndLaneletWithRelations)
+{
+  autoware_msgs::LaneArray lane_array;
+  autoware_msgs::Lane lane;
+  autoware_msgs::Waypoint waypoint;
+  for (int i = 1; i < 4; i++)
+  {
+    waypoint.gid = i;
+    waypoint.pose.pose.position.x = 0.5;
+    waypoint.pose.pose.position.y = i - 0.5;
+    lane.waypoints.push_back(waypoint);
+  }
+  lane_array.lanes.push_back(lane);
+
+  lanelet::routing::RoutingGraphPtr routing_graph =
+      lanelet::routing::RoutingGraph::build(*sample_map_ptr, *traffic_rules);
+  lanelet::utils::RoutingRelations relations;
+  relations.build(*sample_map_ptr, *routing_graph, *traffic_rules);
+
+  std::map<int, lanelet::Id> expected, matched;
+  lanelet::utils::matchWaypointAndLanelet(sample_map_ptr, routing_graph, lane_array, &expected);
+  lanelet::utils::matchWaypointAndLanelet(sample_map_ptr, relations, lane_array, &matched);
+  ASSERT_EQ(3, matched.size()) << "failed to match waypoints with lanelets";
+  ASSERT_EQ(expected, matched) << "routing relations and routing graph results differ";
+}
+
+TEST_F(TestSuite, RoutingGraphSharedPerMap)
+{
+  lanelet::utils::clearRoutingGraphCache();
+  lanelet::routing::RoutingGraphPtr first = lanelet::utils::getRoutingGraph(sample_map_ptr, *traffic_rules);
+  lanelet::routing::RoutingGraphPtr second = lanelet::utils::getRoutingGraph(sample_map_ptr, *traffic_rules);
+  ASSERT_TRUE(first != nullptr) << "failed to build the routing graph";
+  ASSERT_EQ(first, second) << "routing graph of the same map was built again";
+
+  lanelet::traffic_rules::TrafficRulesPtr pedestrian_rules = lanelet::traffic_rules::TrafficRulesFactory::create(
+      lanelet::Locations::Germany, lanelet::Participants::Pedestrian);
+  ASSERT_NE(first, lanelet::utils::getRoutingGraph(sample_map_ptr, *pedestrian_rules))
+      << "routing graph of other traffic rules was shared";
+
+  next_lanelet2.attributes()[lanelet::AttributeName::OneWay] = "no";
+  ASSERT_NE(first, lanelet::utils::getRoutingGraph(sample_map_ptr, *traffic_rules))
+      << "routing graph of an edited map was shared";
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  ros::init(argc, argv, "TestNode");
+  return RUN_ALL_TESTS();
+}
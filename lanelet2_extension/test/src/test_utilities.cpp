@@ -19,6 +19,8 @@
 #include <lanelet2_routing/RoutingGraphContainer.h>
 #include <lanelet2_traffic_rules/TrafficRulesFactory.h>
 #include <map>
+#include <set>
+#include <vector>
 #include <ros/ros.h>
 
 using lanelet::Lanelet;
@@ -127,6 +129,103 @@ TEST_F(TestSuite, MatchWaypointAndLanelet)
   ASSERT_EQ(next_lanelet2.id(), waypointid2laneletid.at(3)) << "failed to match waypoints with lanelet";
 }
 
+TEST_F(TestSuite, MatchWaypointAndLaneletDense)
+{
+  std::vector<lanelet::Id> waypointid2laneletid;
+  autoware_msgs::LaneArray lane_array;
+  autoware_msgs::Lane lane;
+  autoware_msgs::Waypoint waypoint;
+
+  // many waypoints that overlap with road_lanelet, next_lanelet and next_lanelet2
+  const int num_waypoints = 300;
+  for (int i = 0; i < num_waypoints; i++)
+  {
+    waypoint.gid = i;
+    waypoint.pose.pose.position.x = 0.5;
+    waypoint.pose.pose.position.y = (i + 0.5) * 3.0 / num_waypoints;
+    lane.waypoints.push_back(waypoint);
+  }
+
+  // waypoint that overlaps with no lanelet
+  waypoint.gid = num_waypoints + 1;
+  waypoint.pose.pose.position.x = 1.5;
+  waypoint.pose.pose.position.y = 1.5;
+  lane.waypoints.push_back(waypoint);
+
+  lane_array.lanes.push_back(lane);
+
+  lanelet::traffic_rules::TrafficRulesPtr traffic_rules =
+      lanelet::traffic_rules::TrafficRulesFactory::create(lanelet::Locations::Germany, lanelet::Participants::Vehicle);
+  lanelet::routing::RoutingGraphPtr routing_graph =
+      lanelet::routing::RoutingGraph::build(*sample_map_ptr, *traffic_rules);
+
+  lanelet::utils::matchWaypointAndLanelet(sample_map_ptr, routing_graph, lane_array, &waypointid2laneletid);
+
+  std::map<int, lanelet::Id> waypointid2laneletid_map;
+  lanelet::utils::matchWaypointAndLanelet(sample_map_ptr, routing_graph, lane_array, &waypointid2laneletid_map);
+
+  ASSERT_EQ(num_waypoints + 2, waypointid2laneletid.size()) << "dense result is not sized by the largest gid";
+  ASSERT_EQ(lanelet::InvalId, waypointid2laneletid.at(num_waypoints)) << "gid without waypoint was matched";
+  ASSERT_EQ(lanelet::InvalId, waypointid2laneletid.at(num_waypoints + 1)) << "waypoint out of lanelets was matched";
+  ASSERT_EQ(road_lanelet.id(), waypointid2laneletid.front()) << "failed to match waypoints with lanelet";
+  ASSERT_EQ(next_lanelet2.id(), waypointid2laneletid.at(num_waypoints - 1)) << "failed to match waypoints with lanelet";
+  ASSERT_EQ(num_waypoints, waypointid2laneletid_map.size()) << "failed to match waypoints with lanelets";
+  for (const auto& match : waypointid2laneletid_map)
+  {
+    ASSERT_EQ(match.second, waypointid2laneletid.at(match.first)) << "dense and map results differ";
+  }
+}
+
+TEST_F(TestSuite, WaypointLaneletMatcher)
+{
+  autoware_msgs::LaneArray lane_array;
+  autoware_msgs::Lane lane;
+  autoware_msgs::Waypoint waypoint;
+
+  // waypoints that overlap with road_lanelet and next_lanelet
+  for (int i = 1; i < 3; i++)
+  {
+    waypoint.gid = i;
+    waypoint.pose.pose.position.x = 0.5;
+    waypoint.pose.pose.position.y = i - 0.5;
+    lane.waypoints.push_back(waypoint);
+  }
+  lane_array.lanes.push_back(lane);
+
+  lanelet::traffic_rules::TrafficRulesPtr traffic_rules =
+      lanelet::traffic_rules::TrafficRulesFactory::create(lanelet::Locations::Germany, lanelet::Participants::Vehicle);
+  lanelet::routing::RoutingGraphPtr routing_graph =
+      lanelet::routing::RoutingGraph::build(*sample_map_ptr, *traffic_rules);
+
+  lanelet::utils::WaypointLaneletMatcher matcher(sample_map_ptr, routing_graph);
+  std::map<int, lanelet::Id> waypointid2laneletid;
+  matcher.match(lane_array, &waypointid2laneletid);
+  ASSERT_EQ(2, matcher.getNumberOfSearchedWaypoints()) << "all waypoints should be searched first";
+
+  // extend the route to next_lanelet2
+  waypoint.gid = 3;
+  waypoint.pose.pose.position.x = 0.5;
+  waypoint.pose.pose.position.y = 2.5;
+  lane_array.lanes.front().waypoints.push_back(waypoint);
+
+  waypointid2laneletid.clear();
+  matcher.match(lane_array, &waypointid2laneletid);
+  ASSERT_EQ(1, matcher.getNumberOfSearchedWaypoints()) << "only the new waypoint should be searched";
+
+  std::map<int, lanelet::Id> expected_waypointid2laneletid;
+  lanelet::utils::matchWaypointAndLanelet(sample_map_ptr, routing_graph, lane_array, &expected_waypointid2laneletid);
+  ASSERT_EQ(expected_waypointid2laneletid, waypointid2laneletid) << "incremental matching differs from matching";
+  ASSERT_EQ(next_lanelet2.id(), waypointid2laneletid.at(3)) << "failed to match waypoints with lanelet";
+
+  // move a waypoint out of the lanelets
+  lane_array.lanes.front().waypoints.at(1).pose.pose.position.x = 1.5;
+
+  waypointid2laneletid.clear();
+  matcher.match(lane_array, &waypointid2laneletid);
+  ASSERT_EQ(1, matcher.getNumberOfSearchedWaypoints()) << "only the moved waypoint should be searched";
+  ASSERT_EQ(0, waypointid2laneletid.count(2)) << "moved waypoint should not be matched";
+}
+
 TEST_F(TestSuite, OverwriteLaneletsCenterline)
 {
   lanelet::utils::overwriteLaneletsCenterline(sample_map_ptr);
@@ -137,6 +236,26 @@ TEST_F(TestSuite, OverwriteLaneletsCenterline)
   }
 }
 
+TEST_F(TestSuite, OverwriteLaneletsCenterlineIds)
+{
+  lanelet::utils::overwriteLaneletsCenterline(sample_map_ptr, true);
+  const lanelet::Id next_id = getId();
+
+  std::set<lanelet::Id> ids;
+  for (const auto& lanelet : sample_map_ptr->laneletLayer)
+  {
+    const auto centerline = lanelet.centerline();
+    ASSERT_EQ(2, centerline.size()) << "1m long lanelets should have a centerline of one segment";
+    ASSERT_TRUE(ids.insert(centerline.id()).second) << "centerline ids are not unique";
+    for (const auto& point : centerline)
+    {
+      ASSERT_TRUE(ids.insert(point.id()).second) << "centerline point ids are not unique";
+      ASSERT_LT(point.id(), next_id) << "centerline point id was not reserved";
+    }
+    ASSERT_DOUBLE_EQ(0.5, centerline.front().x()) << "centerline is not in the middle of the bounds";
+  }
+}
+
 int main(int argc, char** argv)
 {
   testing::InitGoogleTest(&argc, argv);
@@ -0,0 +1,224 @@
+/*
+ * Copyright 2015-2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+#include <lanelet2_core/utility/Utilities.h>
+#include <lanelet2_extension/visualization/visualization.h>
+#include <math.h>
+#include <vector>
+#include <ros/ros.h>
+
+using lanelet::Lanelet;
+using lanelet::LineString3d;
+using lanelet::Point3d;
+using lanelet::utils::getId;
+
+namespace
+{
+double triangleArea(const geometry_msgs::Polygon& triangle)
+{
+  const auto& a = triangle.points.at(0);
+  const auto& b = triangle.points.at(1);
+  const auto& c = triangle.points.at(2);
+  return ((b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x)) / 2.0;
+}
+
+geometry_msgs::Point32 createPoint32(const float x, const float y)
+{
+  geometry_msgs::Point32 p;
+  p.x = x;
+  p.y = y;
+  return p;
+}
+
+lanelet::AutowareTrafficLightConstPtr createTrafficLight(const double x)
+{
+  lanelet::LineStringOrPolygon3d base(
+      LineString3d(getId(), { Point3d(getId(), x, 1., 4.), Point3d(getId(), x + 1., 1., 4.) }));
+  LineString3d bulbs(getId(), { Point3d(getId(), x, 1., 4.5), Point3d(getId(), x + 0.5, 1., 4.5),
+                                Point3d(getId(), x + 1., 1., 4.5) });
+  bulbs[0].attributes()["color"] = "red";
+  bulbs[1].attributes()["color"] = "yellow";
+  bulbs[2].attributes()["color"] = "green";
+  return lanelet::autoware::AutowareTrafficLight::make(getId(), lanelet::AttributeMap(), { base }, {}, { bulbs });
+}
+
+std_msgs::ColorRGBA createColor(const float r, const float g, const float b, const float a)
+{
+  std_msgs::ColorRGBA c;
+  c.r = r;
+  c.g = g;
+  c.b = b;
+  c.a = a;
+  return c;
+}
+
+bool isSameColor(const std_msgs::ColorRGBA& c0, const std_msgs::ColorRGBA& c1)
+{
+  return c0.r == c1.r && c0.g == c1.g && c0.b == c1.b && c0.a == c1.a;
+}
+
+bool isSameMarker(const visualization_msgs::Marker& m0, const visualization_msgs::Marker& m1)
+{
+  if (m0.ns != m1.ns || m0.id != m1.id || !isSameColor(m0.color, m1.color) || m0.points.size() != m1.points.size() ||
+      m0.colors.size() != m1.colors.size())
+  {
+    return false;
+  }
+  for (size_t i = 0; i < m0.points.size(); i++)
+  {
+    if (m0.points[i].x != m1.points[i].x || m0.points[i].y != m1.points[i].y || m0.points[i].z != m1.points[i].z ||
+        !isSameColor(m0.colors[i], m1.colors[i]))
+    {
+      return false;
+    }
+  }
+  return true;
+}
+}  // namespace
+
+class TestSuite : public ::testing::Test
+{
+public:
+  TestSuite()
+  {  // NOLINT
+    // curved lanelet with collinear points on its bounds
+    Points3dFromXY(&left_points, { { 0., 1. }, { 1., 1. }, { 2., 1. }, { 3., 1.5 }, { 3.5, 2.5 }, { 3.5, 4. } });
+    Points3dFromXY(&right_points, { { 0., 0. }, { 1., 0. }, { 2., 0. }, { 3.5, 0.5 }, { 4.5, 2. }, { 4.5, 4. } });
+    sample_lanelet = Lanelet(getId(), LineString3d(getId(), left_points), LineString3d(getId(), right_points));
+  }
+  ~TestSuite()
+  {
+  }
+
+  lanelet::Points3d left_points, right_points;
+  Lanelet sample_lanelet;
+
+private:
+  static void Points3dFromXY(lanelet::Points3d* points, const std::vector<std::vector<double>>& xy)
+  {
+    for (const auto& p : xy)
+    {
+      points->push_back(Point3d(getId(), p.at(0), p.at(1), 0.));
+    }
+  }
+};
+
+TEST_F(TestSuite, PolygonToTriangle)
+{
+  // clockwise comb, which has split and merge vertices in the sweep
+  geometry_msgs::Polygon polygon;
+  polygon.points = { createPoint32(0, 0), createPoint32(0, 3), createPoint32(1, 3), createPoint32(1, 1),
+                     createPoint32(2, 1), createPoint32(2, 3), createPoint32(3, 3), createPoint32(3, 0) };
+
+  std::vector<geometry_msgs::Polygon> triangles;
+  lanelet::visualization::polygon2Triangle(polygon, &triangles);
+  ASSERT_EQ(polygon.points.size() - 2, triangles.size()) << "polygon with n vertices should have n - 2 triangles";
+
+  double area = 0.0;
+  for (const auto& triangle : triangles)
+  {
+    ASSERT_LE(triangleArea(triangle), 0.0) << "triangles should keep the clockwise order of the polygon";
+    area += triangleArea(triangle);
+  }
+  ASSERT_DOUBLE_EQ(-7.0, area) << "triangles should cover the polygon";
+}
+
+TEST_F(TestSuite, LaneletTriangleCache)
+{
+  std::vector<geometry_msgs::Polygon> triangles;
+  lanelet::visualization::lanelet2Triangle(sample_lanelet, &triangles);
+
+  lanelet::visualization::LaneletTriangleCache cache;
+  const auto& cached_triangles = cache.triangles(sample_lanelet);
+  ASSERT_EQ(triangles.size(), cached_triangles.size()) << "cache should give the same triangles";
+  ASSERT_EQ(&cached_triangles, &cache.triangles(sample_lanelet)) << "cached triangles should be reused";
+  ASSERT_EQ(1, cache.size());
+
+  double area = 0.0;
+  for (const auto& triangle : cached_triangles)
+  {
+    area += triangleArea(triangle);
+  }
+
+  // moving a point changes the shape of the lanelet
+  left_points.back().y() = 5.;
+  double moved_area = 0.0;
+  for (const auto& triangle : cache.triangles(sample_lanelet))
+  {
+    moved_area += triangleArea(triangle);
+  }
+  ASSERT_GT(fabs(moved_area - area), 0.1) << "lanelet should be triangulated again after its shape changed";
+
+  cache.clear();
+  ASSERT_EQ(0, cache.size());
+}
+
+TEST_F(TestSuite, TrafficLightMarkerCache)
+{
+  // enough lights to build them on several threads
+  std::vector<lanelet::AutowareTrafficLightConstPtr> lights;
+  for (int i = 0; i < 40; i++)
+  {
+    lights.push_back(createTrafficLight(2. * i));
+  }
+  const std_msgs::ColorRGBA c = createColor(0.7, 0.7, 0.7, 0.8);
+
+  lanelet::visualization::TrafficLightMarkerCache cache;
+  const auto expected = lanelet::visualization::autowareTrafficLightsAsMarkerArray(lights, c);
+  const auto cached = cache.markers(lights, c);
+  ASSERT_EQ(4 * lights.size(), expected.markers.size()) << "each light should have a shape and three bulbs";
+  ASSERT_EQ(expected.markers.size(), cached.markers.size()) << "cache should give the same markers";
+  for (size_t i = 0; i < expected.markers.size(); i++)
+  {
+    ASSERT_TRUE(isSameMarker(expected.markers[i], cached.markers[i])) << "marker " << i << " differs";
+  }
+  ASSERT_EQ(lights.size(), cache.size());
+
+  // lit bulb of one light
+  const lanelet::AutowareTrafficLightConstPtr& tl = lights.front();
+  const lanelet::Id red_bulb = tl->lightBulbs().front().front().id();
+  const std_msgs::ColorRGBA lit = createColor(1.0, 0.5, 0.5, 1.0);
+  ASSERT_TRUE(cache.setBulbColor(tl->id(), red_bulb, lit));
+  ASSERT_FALSE(cache.setBulbColor(tl->id(), getId(), lit)) << "unknown bulb should not be set";
+  ASSERT_FALSE(cache.setBulbColor(getId(), red_bulb, lit)) << "unknown light should not be set";
+
+  const std_msgs::ColorRGBA shape_color = createColor(0.2, 0.2, 0.2, 1.0);
+  const auto state = cache.markers({ tl }, shape_color);
+  ASSERT_EQ(4, state.markers.size());
+  ASSERT_TRUE(isSameColor(shape_color, state.markers[0].colors.front())) << "shape should take the color of the call";
+  ASSERT_EQ(red_bulb, state.markers[1].id);
+  ASSERT_TRUE(isSameColor(lit, state.markers[1].color)) << "bulb should keep the color that was set";
+  ASSERT_TRUE(isSameColor(expected.markers[2].color, state.markers[2].color)) << "other bulbs should keep their color";
+
+  cache.resetBulbColors(tl->id());
+  ASSERT_TRUE(isSameColor(expected.markers[1].color, cache.markers({ tl }, c).markers[1].color))
+      << "bulb should be back to the color of its attribute";
+
+  std::vector<lanelet::TrafficLightConstPtr> triangle_lights(lights.begin(), lights.end());
+  ASSERT_EQ(lanelet::visualization::trafficLightsAsTriangleMarkerArray(triangle_lights, c).markers.size(),
+            cache.triangleMarkers(triangle_lights, c).markers.size());
+
+  cache.clear();
+  ASSERT_EQ(0, cache.size());
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  ros::init(argc, argv, "TestNode");
+  return RUN_ALL_TESTS();
+}
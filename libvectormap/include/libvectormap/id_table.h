@@ -0,0 +1,94 @@
+/*
+ * Copyright 2018-2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LIBVECTORMAP_ID_TABLE_H
+#define LIBVECTORMAP_ID_TABLE_H
+
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Copy of a std::map<int, T> for lookups by id: a dense array indexed by id - first id when the ids are mostly
+ * contiguous, at least half of the range used, a hash table otherwise.
+ */
+template <typename T>
+class IdTable
+{
+public:
+  IdTable() :
+    first_id_(0), dense_(true) {}
+
+  void build(const std::map<int, T>& elements)
+  {
+    values_.clear();
+    present_.clear();
+    sparse_.clear();
+    if (elements.empty())
+    {
+      dense_ = true;
+      return;
+    }
+
+    first_id_ = elements.begin()->first;
+    long range = static_cast<long>(elements.rbegin()->first) - first_id_ + 1;
+    dense_ = range <= 2 * static_cast<long>(elements.size());
+    if (dense_)
+    {
+      values_.resize(range);
+      present_.resize(range, 0);
+      for (const auto& element : elements)
+      {
+        values_[element.first - first_id_] = element.second;
+        present_[element.first - first_id_] = 1;
+      }
+    }
+    else
+    {
+      sparse_.reserve(elements.size());
+      sparse_.insert(elements.begin(), elements.end());
+    }
+  }
+
+  /**
+   * nullptr when there is no element with this id
+   */
+  const T* find(const int id) const
+  {
+    if (dense_)
+    {
+      long i = static_cast<long>(id) - first_id_;
+      return i >= 0 && i < static_cast<long>(values_.size()) && present_[i] ? &values_[i] : nullptr;
+    }
+
+    typename std::unordered_map<int, T>::const_iterator it = sparse_.find(id);
+    return it == sparse_.end() ? nullptr : &it->second;
+  }
+
+  bool isDense() const
+  {
+    return dense_;
+  }
+
+private:
+  int first_id_;
+  bool dense_;
+  std::vector<T> values_;
+  std::vector<char> present_;
+  std::unordered_map<int, T> sparse_;
+};
+
+#endif  // LIBVECTORMAP_ID_TABLE_H
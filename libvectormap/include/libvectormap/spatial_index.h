@@ -0,0 +1,57 @@
+/*
+ * Copyright 2018-2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LIBVECTORMAP_SPATIAL_INDEX_H
+#define LIBVECTORMAP_SPATIAL_INDEX_H
+
+#include <vector>
+
+#include "Math.h"
+
+/**
+ * Static 2D k-d tree over points given by index, built once in O(N log N).
+ * A radius search visits O(log N) nodes plus the ones near the circle.
+ */
+class KdTree2
+{
+public:
+  void build(const std::vector<Point2>& points);
+
+  /**
+   * Indices of the points within radius of center, in no particular order
+   */
+  void radiusSearch(const Point2& center, const float radius, std::vector<int>& indices) const;
+
+  bool empty() const
+  {
+    return nodes_.empty();
+  }
+
+private:
+  struct Node
+  {
+    Point2 point;
+    int index;
+  };
+
+  std::vector<Node> nodes_;
+
+  void build(const int begin, const int end, const int axis);
+  void radiusSearch(const int begin, const int end, const int axis, const Point2& center, const float radius,
+                    std::vector<int>& indices) const;
+};
+
+#endif  // LIBVECTORMAP_SPATIAL_INDEX_H
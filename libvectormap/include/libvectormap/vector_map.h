@@ -25,6 +25,8 @@
 #include <string>
 
 #include "Math.h"
+#include "spatial_index.h"
+#include "id_table.h"
 
 #include <vector_map/vector_map.h>
 
@@ -126,6 +128,21 @@ typedef struct
 }
 Lane;
 
+/**
+ * Signal with the position and angles of its vector
+ */
+typedef struct
+{
+  int id;
+  int plid;
+  int type;
+  int linkid;
+  Point3 position;
+  double hang;
+  double vang;
+}
+ResolvedSignal;
+
 class VectorMap
 {
 public:
@@ -147,17 +164,90 @@ public:
   void load_dtlanes(const vector_map::DTLaneArray& msg);
 
   VectorMap() :
-    loaded(false) {}
+    loaded(false), index_dirty_(true), max_lane_half_length_(0), indexed_points_(0), indexed_vectors_(0),
+    indexed_signals_(0), indexed_lanes_(0), indexed_dtlanes_(0) {}
 
+  /**
+   * Zero for an unknown point, as the default point operator[] used to insert. The id is no longer inserted into
+   * points, so looking up unknown ids does not grow the map nor rebuild the id tables
+   */
   inline Point3 getPoint(const int idx)
   {
-    Point3 p;
-    Point psrc = points[idx];
-    p.x() = psrc.bx;
-    p.y() = psrc.ly;
-    p.z() = psrc.h;
+    Point3 p(0, 0, 0);
+    const Point* psrc = findPoint(idx);
+    if (psrc)
+    {
+      p.x() = psrc->bx;
+      p.y() = psrc->ly;
+      p.z() = psrc->h;
+    }
     return p;
   }
+
+  /**
+   * Lookups in the id tables of the maps, nullptr for an unknown id
+   */
+  const Point* findPoint(const int pid);
+  const Vector* findVector(const int vid);
+  const Signal* findSignal(const int id);
+  const Lane* findLane(const int lnid);
+  const DTLane* findDTLane(const int did);
+
+  /**
+   * Signals with a known vector and point, in id order, resolved once per load
+   */
+  const std::vector<ResolvedSignal>& getResolvedSignals();
+  const ResolvedSignal* findResolvedSignal(const int id);
+
+  /**
+   * Ids of the signals within range (m) of camera_position and inside the cone of full angle fov (degrees)
+   * around camera_direction. The candidates come from a k-d tree of the signal positions.
+   */
+  std::vector<int> signalsInFrustum(const Point3& camera_position, const Vector3& camera_direction, const float fov,
+                                    const float range);
+
+  /**
+   * lnid of the lanes whose segment, from its DTLane point to the one of its forward lane, is within range of position
+   */
+  std::vector<int> lanesInRange(const Point2& position, const float range);
+
+  /**
+   * The id tables, resolved signals and spatial index are built again by the first lookup or query after a load, or
+   * after an element was added to or erased from points, vectors, signals, lanes or dtlanes. Call it after changing
+   * an element of those maps in place
+   */
+  void buildIndex();
+
+private:
+  bool index_dirty_;
+  IdTable<Point> point_table_;
+  IdTable<Vector> vector_table_;
+  IdTable<Signal> signal_table_;
+  IdTable<Lane> lane_table_;
+  IdTable<DTLane> dtlane_table_;
+  std::vector<ResolvedSignal> resolved_signals_;
+  IdTable<int> resolved_signal_table_;
+  KdTree2 signal_index_;
+  KdTree2 lane_index_;
+  std::vector<int> lane_ids_;
+  std::vector<Point2> lane_starts_;
+  std::vector<Point2> lane_ends_;
+  float max_lane_half_length_;
+  // sizes of the maps the index was built from
+  size_t indexed_points_;
+  size_t indexed_vectors_;
+  size_t indexed_signals_;
+  size_t indexed_lanes_;
+  size_t indexed_dtlanes_;
+
+  void updateIndex()
+  {
+    if (index_dirty_ || points.size() != indexed_points_ || vectors.size() != indexed_vectors_ ||
+        signals.size() != indexed_signals_ || lanes.size() != indexed_lanes_ || dtlanes.size() != indexed_dtlanes_)
+      buildIndex();
+  }
+
+  bool findLanePoint(const int lnid, Point2& p) const;
 };
 
 #endif  // LIBVECTORMAP_VECTOR_MAP_H
@@ -0,0 +1,67 @@
+/*
+ * Copyright 2018-2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "libvectormap/spatial_index.h"
+
+#include <algorithm>
+
+void KdTree2::build(const std::vector<Point2>& points)
+{
+  nodes_.resize(points.size());
+  for (size_t i = 0; i < points.size(); i++)
+  {
+    nodes_[i].point = points[i];
+    nodes_[i].index = i;
+  }
+  build(0, nodes_.size(), 0);
+}
+
+// the median of [begin, end) on axis is at the middle, the two halves split on the other axis
+void KdTree2::build(const int begin, const int end, const int axis)
+{
+  if (end - begin <= 1)
+    return;
+
+  int mid = begin + (end - begin) / 2;
+  std::nth_element(nodes_.begin() + begin, nodes_.begin() + mid, nodes_.begin() + end,
+                   [axis](const Node& n1, const Node& n2) { return n1.point[axis] < n2.point[axis]; });
+  build(begin, mid, 1 - axis);
+  build(mid + 1, end, 1 - axis);
+}
+
+void KdTree2::radiusSearch(const Point2& center, const float radius, std::vector<int>& indices) const
+{
+  indices.clear();
+  radiusSearch(0, nodes_.size(), 0, center, radius, indices);
+}
+
+void KdTree2::radiusSearch(const int begin, const int end, const int axis, const Point2& center, const float radius,
+                           std::vector<int>& indices) const
+{
+  if (begin >= end)
+    return;
+
+  int mid = begin + (end - begin) / 2;
+  const Node& node = nodes_[mid];
+  if ((node.point - center).squaredNorm() <= radius * radius)
+    indices.push_back(node.index);
+
+  float diff = center[axis] - node.point[axis];
+  if (diff <= radius)
+    radiusSearch(begin, mid, 1 - axis, center, radius, indices);
+  if (diff >= -radius)
+    radiusSearch(mid + 1, end, 1 - axis, center, radius, indices);
+}
@@ -21,6 +21,7 @@
 #include <cmath>
 #include <vector>
 #include <map>
+#include <algorithm>
 
 void VectorMap::load_points(const vector_map::PointArray& msg)
 {
@@ -40,6 +41,7 @@ void VectorMap::load_points(const vector_map::PointArray& msg)
     points.insert(std::map<int, Point>::value_type(tmp.pid, tmp));
   }
 
+  index_dirty_ = true;
   std::cout << "load points complete. element num: " << points.size() << std::endl;
 } /* void VectorMap::load_points() */
 
@@ -57,6 +59,7 @@ void VectorMap::load_lines(const vector_map::LineArray& msg)
     lines.insert(std::map<int, Line>::value_type(tmp.lid, tmp));
   }
 
+  index_dirty_ = true;
   std::cout << "load lines complete." << std::endl;
 } /* void VectorMap::load_lines() */
 
@@ -86,6 +89,7 @@ void VectorMap::load_lanes(const vector_map::LaneArray& msg)
     lanes.insert(std::map<int, Lane>::value_type(tmp.lnid, tmp));
   }
 
+  index_dirty_ = true;
   std::cout << "load lanes complete." << std::endl;
 } /* void VectorMap::load_lanes() */
 
@@ -102,6 +106,7 @@ void VectorMap::load_vectors(const vector_map::VectorArray& msg)
     vectors.insert(std::map<int, Vector>::value_type(tmp.vid, tmp));
   }
 
+  index_dirty_ = true;
   std::cout << "load vectors complete. element num: " << vectors.size() << std::endl;
 } /* void VectorMap::load_vectors() */
 
@@ -119,6 +124,7 @@ void VectorMap::load_signals(const vector_map::SignalArray& msg)
     signals.insert(std::map<int, Signal>::value_type(tmp.id, tmp));
   }
 
+  index_dirty_ = true;
   std::cout << "load signals complete. element num: " << signals.size() << std::endl;
 } /* void VectorMap::load_signals() */
 
@@ -137,6 +143,7 @@ void VectorMap::load_whitelines(const vector_map::WhiteLineArray& msg)
     whitelines.insert(std::map<int, WhiteLine>::value_type(tmp.id, tmp));
   }
 
+  index_dirty_ = true;
   std::cout << "load whitelines complete." << std::endl;
 } /* void VectorMap::load_whitelines() */
 
@@ -159,5 +166,161 @@ void VectorMap::load_dtlanes(const vector_map::DTLaneArray& msg)
     dtlanes.insert(std::map<int, DTLane>::value_type(tmp.did, tmp));
   }
 
+  index_dirty_ = true;
   std::cout << "load dtlanes complete." << std::endl;
 } /* void VectorMap::load_dtlanes() */
+
+const Point* VectorMap::findPoint(const int pid)
+{
+  updateIndex();
+  return point_table_.find(pid);
+}
+
+const Vector* VectorMap::findVector(const int vid)
+{
+  updateIndex();
+  return vector_table_.find(vid);
+}
+
+const Signal* VectorMap::findSignal(const int id)
+{
+  updateIndex();
+  return signal_table_.find(id);
+}
+
+const Lane* VectorMap::findLane(const int lnid)
+{
+  updateIndex();
+  return lane_table_.find(lnid);
+}
+
+const DTLane* VectorMap::findDTLane(const int did)
+{
+  updateIndex();
+  return dtlane_table_.find(did);
+}
+
+const std::vector<ResolvedSignal>& VectorMap::getResolvedSignals()
+{
+  updateIndex();
+  return resolved_signals_;
+}
+
+const ResolvedSignal* VectorMap::findResolvedSignal(const int id)
+{
+  updateIndex();
+  const int* i = resolved_signal_table_.find(id);
+  return i ? &resolved_signals_[*i] : nullptr;
+}
+
+bool VectorMap::findLanePoint(const int lnid, Point2& p) const
+{
+  const Lane* lane = lane_table_.find(lnid);
+  const DTLane* dtlane = lane ? dtlane_table_.find(lane->did) : nullptr;
+  const Point* point = dtlane ? point_table_.find(dtlane->pid) : nullptr;
+  if (!point)
+    return false;
+
+  p = Point2(point->bx, point->ly);
+  return true;
+}
+
+void VectorMap::buildIndex()
+{
+  index_dirty_ = false;
+  indexed_points_ = points.size();
+  indexed_vectors_ = vectors.size();
+  indexed_signals_ = signals.size();
+  indexed_lanes_ = lanes.size();
+  indexed_dtlanes_ = dtlanes.size();
+  point_table_.build(points);
+  vector_table_.build(vectors);
+  signal_table_.build(signals);
+  lane_table_.build(lanes);
+  dtlane_table_.build(dtlanes);
+
+  resolved_signals_.clear();
+  std::map<int, int> resolved_ids;
+  std::vector<Point2> positions;
+  for (const auto& signal : signals)
+  {
+    const Vector* vector = vector_table_.find(signal.second.vid);
+    const Point* point = vector ? point_table_.find(vector->pid) : nullptr;
+    if (!point)
+      continue;
+
+    ResolvedSignal resolved;
+    resolved.id = signal.first;
+    resolved.plid = signal.second.plid;
+    resolved.type = signal.second.type;
+    resolved.linkid = signal.second.linkid;
+    resolved.position = Point3(point->bx, point->ly, point->h);
+    resolved.hang = vector->hang;
+    resolved.vang = vector->vang;
+    resolved_ids[resolved.id] = resolved_signals_.size();
+    resolved_signals_.push_back(resolved);
+    positions.push_back(Point2(point->bx, point->ly));
+  }
+  resolved_signal_table_.build(resolved_ids);
+  signal_index_.build(positions);
+
+  lane_ids_.clear();
+  lane_starts_.clear();
+  lane_ends_.clear();
+  positions.clear();
+  max_lane_half_length_ = 0;
+  for (const auto& lane : lanes)
+  {
+    Point2 start, end;
+    if (!findLanePoint(lane.first, start))
+      continue;
+    if (!findLanePoint(lane.second.flid, end))
+      end = start;
+
+    lane_ids_.push_back(lane.first);
+    lane_starts_.push_back(start);
+    lane_ends_.push_back(end);
+    positions.push_back((start + end) * 0.5f);
+    max_lane_half_length_ = std::max(max_lane_half_length_, (end - start).norm() * 0.5f);
+  }
+  lane_index_.build(positions);
+}
+
+std::vector<int> VectorMap::signalsInFrustum(const Point3& camera_position, const Vector3& camera_direction,
+                                             const float fov, const float range)
+{
+  updateIndex();
+
+  std::vector<int> candidates, ids;
+  signal_index_.radiusSearch(Point2(camera_position.x(), camera_position.y()), range, candidates);
+
+  Vector3 direction = camera_direction.normalized();
+  float cos_half_fov = std::cos(degreeToRadian(fov * 0.5f));
+  for (const int i : candidates)
+  {
+    Vector3 v = resolved_signals_[i].position - camera_position;
+    float d = v.norm();
+    if (d <= range && (d == 0 || direction.dot(v) >= d * cos_half_fov))
+      ids.push_back(resolved_signals_[i].id);
+  }
+
+  return ids;
+}
+
+std::vector<int> VectorMap::lanesInRange(const Point2& position, const float range)
+{
+  updateIndex();
+
+  std::vector<int> candidates, ids;
+  lane_index_.radiusSearch(position, range + max_lane_half_length_, candidates);
+  for (const int i : candidates)
+  {
+    Vector2 segment = lane_ends_[i] - lane_starts_[i];
+    float length2 = segment.squaredNorm();
+    float t = length2 > 0 ? std::min(1.0f, std::max(0.0f, (position - lane_starts_[i]).dot(segment) / length2)) : 0;
+    if ((lane_starts_[i] + segment * t - position).norm() <= range)
+      ids.push_back(lane_ids_[i]);
+  }
+
+  return ids;
+}
@@ -18,6 +18,7 @@
 #define LIBWAYPOINT_FOLLOWER_LIBWAYPOINT_FOLLOWER_H
 
 #define EIGEN_MPL2_ONLY
+#include <Eigen/Core>
 #include <tf/transform_datatypes.h>
 #include <tf2/utils.h>
 
@@ -32,6 +33,7 @@
 #include <tf/transform_broadcaster.h>
 #include <tf/transform_listener.h>
 #include <autoware_msgs/Lane.h>
+#include "libwaypoint_follower/pose_array_view.h"
 
 constexpr double ERROR = 1e-6;
 
@@ -107,12 +109,13 @@ double calcLateralError2D(const geometry_msgs::Point &a_start, const geometry_ms
 double calcRadius(const geometry_msgs::Point &target, const geometry_msgs::Pose &current_pose);
 std::vector<geometry_msgs::Pose> extractPoses(const autoware_msgs::Lane &lane);
 std::vector<geometry_msgs::Pose> extractPoses(const std::vector<autoware_msgs::Waypoint> &wps);
-std::pair<bool, int32_t> findClosestIdxWithDistAngThr(const std::vector<geometry_msgs::Pose> &curr_ps,
+// the functions taking a PoseArrayView also take pose vectors, lanes and waypoint vectors without copying them
+std::pair<bool, int32_t> findClosestIdxWithDistAngThr(const PoseArrayView &curr_ps,
                                                       const geometry_msgs::Pose &curr_pose,
                                                       double dist_thr = 3.0,
                                                       double angle_thr = M_PI_2);
 geometry_msgs::Quaternion getQuaternionFromYaw(const double &_yaw);
-bool isDirectionForward(const std::vector<geometry_msgs::Pose> &poses);
+bool isDirectionForward(const PoseArrayView &poses);
 double normalizeEulerAngle(double euler);
 geometry_msgs::Point transformToAbsoluteCoordinate2D(const geometry_msgs::Point &point,
                                                                       const geometry_msgs::Pose &current_pose);
@@ -123,4 +126,19 @@ geometry_msgs::Point transformToRelativeCoordinate2D(const geometry_msgs::Point
 geometry_msgs::Point transformToRelativeCoordinate3D(const geometry_msgs::Point &point,
                                                                       const geometry_msgs::Pose &current_pose);
 
+// poses in contiguous arrays, for the controllers evaluating many candidate poses at once
+struct Poses2D
+{
+  Eigen::ArrayXd x;
+  Eigen::ArrayXd y;
+  Eigen::ArrayXd yaw;
+};
+Poses2D toPoses2D(const PoseArrayView &poses);
+// batch versions of the functions above, one value for each of the poses
+void transformToRelativeCoordinate2D(const geometry_msgs::Point &point, const Poses2D &origins,
+                                     Eigen::ArrayXd *x, Eigen::ArrayXd *y);
+Eigen::ArrayXd calcLateralError2D(const geometry_msgs::Point &line_s, const geometry_msgs::Point &line_e,
+                                  const Poses2D &poses);
+Eigen::ArrayXd calcCurvature(const geometry_msgs::Point &target, const Poses2D &poses);
+
 #endif  // LIBWAYPOINT_FOLLOWER_LIBWAYPOINT_FOLLOWER_H
@@ -0,0 +1,100 @@
+/*
+ * Copyright 2015-2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LIBWAYPOINT_FOLLOWER_POSE_ARRAY_VIEW_H
+#define LIBWAYPOINT_FOLLOWER_POSE_ARRAY_VIEW_H
+
+// ROS includes
+#include <autoware_msgs/Lane.h>
+#include <geometry_msgs/Pose.h>
+
+// C++ includes
+#include <cstddef>
+#include <iterator>
+#include <stdexcept>
+#include <vector>
+
+// read only view of the poses of an array without copying them, a pose every stride bytes.
+// it is valid as long as the viewed array is not modified or destroyed.
+class PoseArrayView
+{
+public:
+  class const_iterator
+  {
+  public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef geometry_msgs::Pose value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef const geometry_msgs::Pose *pointer;
+    typedef const geometry_msgs::Pose &reference;
+
+    const_iterator() : ptr_(nullptr), stride_(0) {}
+    const_iterator(const char *ptr, size_t stride) : ptr_(ptr), stride_(stride) {}
+    const geometry_msgs::Pose &operator*() const { return *reinterpret_cast<const geometry_msgs::Pose *>(ptr_); }
+    const geometry_msgs::Pose *operator->() const { return reinterpret_cast<const geometry_msgs::Pose *>(ptr_); }
+    const_iterator &operator++()
+    {
+      ptr_ += stride_;
+      return *this;
+    }
+    const_iterator operator++(int)
+    {
+      const_iterator it = *this;
+      ptr_ += stride_;
+      return it;
+    }
+    bool operator==(const const_iterator &it) const { return ptr_ == it.ptr_; }
+    bool operator!=(const const_iterator &it) const { return ptr_ != it.ptr_; }
+
+  private:
+    const char *ptr_;
+    size_t stride_;
+  };
+
+  PoseArrayView() : data_(nullptr), stride_(sizeof(geometry_msgs::Pose)), size_(0) {}
+  PoseArrayView(const geometry_msgs::Pose *data, size_t stride, size_t size)
+    : data_(reinterpret_cast<const char *>(data)), stride_(stride), size_(size) {}
+  // implicit, so the functions taking a view also take the pose vectors
+  PoseArrayView(const std::vector<geometry_msgs::Pose> &poses)  // NOLINT(runtime/explicit)
+    : PoseArrayView(poses.data(), sizeof(geometry_msgs::Pose), poses.size()) {}
+  PoseArrayView(const std::vector<autoware_msgs::Waypoint> &wps)  // NOLINT(runtime/explicit)
+    : PoseArrayView(wps.empty() ? nullptr : &wps.front().pose.pose, sizeof(autoware_msgs::Waypoint), wps.size()) {}
+  PoseArrayView(const autoware_msgs::Lane &lane) : PoseArrayView(lane.waypoints) {}  // NOLINT(runtime/explicit)
+
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+  const geometry_msgs::Pose &operator[](size_t i) const
+  {
+    return *reinterpret_cast<const geometry_msgs::Pose *>(data_ + i * stride_);
+  }
+  const geometry_msgs::Pose &at(size_t i) const
+  {
+    if (i >= size_)
+      throw std::out_of_range("PoseArrayView::at");
+    return (*this)[i];
+  }
+  const geometry_msgs::Pose &front() const { return at(0); }
+  const geometry_msgs::Pose &back() const { return at(size_ - 1); }
+  const_iterator begin() const { return const_iterator(data_, stride_); }
+  const_iterator end() const { return const_iterator(data_ + size_ * stride_, stride_); }
+
+private:
+  const char *data_;
+  size_t stride_;
+  size_t size_;
+};
+
+#endif  // LIBWAYPOINT_FOLLOWER_POSE_ARRAY_VIEW_H
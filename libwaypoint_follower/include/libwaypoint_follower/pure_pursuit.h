@@ -20,7 +20,9 @@
 #define EIGEN_MPL2_ONLY
 
 // ROS includes
+#include <autoware_msgs/Lane.h>
 #include <geometry_msgs/Pose.h>
+#include "libwaypoint_follower/pose_array_view.h"
 
 // C++ includes
 #include <memory>
@@ -30,14 +32,21 @@
 class PurePursuit
 {
 public:
-  PurePursuit() : use_lerp_(false), lookahead_distance_(0.0), clst_thr_dist_(3.0), clst_thr_ang_(M_PI/4) {}
+  PurePursuit()
+    : use_lerp_(false), lookahead_distance_(0.0), clst_thr_dist_(3.0), clst_thr_ang_(M_PI/4),
+      tracking_window_(0), clst_idx_(-1) {}
 
   // setter
   void setUseLerp(bool ul);
   void setCurrentPose(const geometry_msgs::Pose &msg);
   void setWaypoints(const std::vector<geometry_msgs::Pose> &msg);
+  // without copying the poses, the message is kept until the next waypoints
+  void setWaypoints(const autoware_msgs::LaneConstPtr &msg);
   void setLookaheadDistance(double ld);
   void setClosestThreshold(double clst_thr_dist, double clst_thr_ang);
+  // search the closest waypoint in the tracking_window waypoints from the previous closest one,
+  // and in all of them when none is found there. 0 always searches all of them.
+  void setTrackingWindow(int32_t tracking_window);
 
   // getter
   geometry_msgs::Point getLocationOfNextWaypoint();
@@ -54,10 +63,21 @@ private:
   // variables got from outside
   bool use_lerp_;
   double lookahead_distance_, clst_thr_dist_, clst_thr_ang_;
-  std::shared_ptr<std::vector<geometry_msgs::Pose>> curr_wps_ptr_;
+  // poses of the waypoints, in the message or vector kept alive by curr_wps_owner_
+  std::shared_ptr<const void> curr_wps_owner_;
+  PoseArrayView curr_wps_;
   std::shared_ptr<geometry_msgs::Pose> curr_pose_ptr_;
+  int32_t tracking_window_;
+
+  // yaw of each waypoint, computed in setWaypoints
+  std::vector<double> curr_wps_yaw_;
+  // closest waypoint of the previous run, -1 for new waypoints
+  int32_t clst_idx_;
 
   // functions
+  void setWaypointsView(const std::shared_ptr<const void> &owner, const PoseArrayView &wps);
+  std::pair<bool, int32_t> findClosestIdx();
+  std::pair<bool, int32_t> findClosestIdxInRange(int32_t begin, int32_t end) const;
   int32_t findNextPointIdx(int32_t search_start_idx);
   std::pair<bool, geometry_msgs::Point> lerpNextTarget(int32_t next_wp_idx);
 };
@@ -374,31 +374,23 @@ double calcRadius(const geometry_msgs::Point &target, const geometry_msgs::Pose
 
 std::vector<geometry_msgs::Pose> extractPoses(const autoware_msgs::Lane &lane)
 {
-  std::vector<geometry_msgs::Pose> poses;
-
-  for (const auto &el : lane.waypoints)
-    poses.push_back(el.pose.pose);
-
-  return poses;
+  return extractPoses(lane.waypoints);
 }
 
 std::vector<geometry_msgs::Pose> extractPoses(const std::vector<autoware_msgs::Waypoint> &wps)
 {
-  std::vector<geometry_msgs::Pose> poses;
-
-  for (const auto &el : wps)
-    poses.push_back(el.pose.pose);
-
-  return poses;
+  const PoseArrayView view(wps);
+  return std::vector<geometry_msgs::Pose>(view.begin(), view.end());
 }
 
-std::pair<bool, int32_t> findClosestIdxWithDistAngThr(const std::vector<geometry_msgs::Pose> &curr_ps,
+std::pair<bool, int32_t> findClosestIdxWithDistAngThr(const PoseArrayView &curr_ps,
                                                       const geometry_msgs::Pose &curr_pose,
                                                       double dist_thr,
                                                       double angle_thr)
 {
   double dist_squared_min = std::numeric_limits<double>::max();
   int32_t idx_min = -1;
+  const double yaw_pose = tf2::getYaw(curr_pose.orientation);
 
   for (int32_t i = 0; i < static_cast<int32_t>(curr_ps.size()); ++i)
   {
@@ -406,7 +398,6 @@ std::pair<bool, int32_t> findClosestIdxWithDistAngThr(const std::vector<geometry
     if (ds > dist_thr * dist_thr)
       continue;
 
-    double yaw_pose = tf2::getYaw(curr_pose.orientation);
     double yaw_ps = tf2::getYaw(curr_ps.at(i).orientation);
     double yaw_diff = normalizeEulerAngle(yaw_pose - yaw_ps);
     if (std::fabs(yaw_diff) > angle_thr)
@@ -429,7 +420,7 @@ geometry_msgs::Quaternion getQuaternionFromYaw(const double &_yaw)
   return tf2::toMsg(q);
 }
 
-bool isDirectionForward(const std::vector<geometry_msgs::Pose> &poses)
+bool isDirectionForward(const PoseArrayView &poses)
 {
   geometry_msgs::Point rel_p = transformToRelativeCoordinate2D(poses.at(2).position, poses.at(1));
   bool is_forward = (rel_p.x > 0.0) ? true : false;
@@ -515,3 +506,54 @@ geometry_msgs::Point transformToRelativeCoordinate3D(const geometry_msgs::Point
   geometry_msgs::Point transformed_p = tf2::toMsg(transformed_v);
   return transformed_p;
 }
+
+Poses2D toPoses2D(const PoseArrayView &poses)
+{
+  Poses2D res;
+  res.x.resize(poses.size());
+  res.y.resize(poses.size());
+  res.yaw.resize(poses.size());
+  for (size_t i = 0; i < poses.size(); ++i)
+  {
+    res.x(i) = poses.at(i).position.x;
+    res.y(i) = poses.at(i).position.y;
+    res.yaw(i) = tf2::getYaw(poses.at(i).orientation);
+  }
+  return res;
+}
+
+void transformToRelativeCoordinate2D(const geometry_msgs::Point &point, const Poses2D &origins,
+                                     Eigen::ArrayXd *x, Eigen::ArrayXd *y)
+{
+  const Eigen::ArrayXd trans_x = point.x - origins.x;
+  const Eigen::ArrayXd trans_y = point.y - origins.y;
+  const Eigen::ArrayXd cos_yaw = origins.yaw.cos();
+  const Eigen::ArrayXd sin_yaw = origins.yaw.sin();
+  *x = cos_yaw * trans_x + sin_yaw * trans_y;
+  *y = cos_yaw * trans_y - sin_yaw * trans_x;
+}
+
+Eigen::ArrayXd calcLateralError2D(const geometry_msgs::Point &line_s, const geometry_msgs::Point &line_e,
+                                  const Poses2D &poses)
+{
+  const double a_x = line_e.x - line_s.x;
+  const double a_y = line_e.y - line_s.y;
+  const double a_length = std::hypot(a_x, a_y);
+  if (!(a_length > 0))
+    return Eigen::ArrayXd::Zero(poses.x.size());
+
+  return (a_x * (poses.y - line_s.y) - a_y * (poses.x - line_s.x)) / a_length;
+}
+
+Eigen::ArrayXd calcCurvature(const geometry_msgs::Point &target, const Poses2D &poses)
+{
+  // same limits as calcRadius and calcCurvature
+  constexpr double RADIUS_MAX = 1e9;
+  constexpr double KAPPA_MAX = 1e9;
+  Eigen::ArrayXd rel_x, rel_y;
+  transformToRelativeCoordinate2D(target, poses, &rel_x, &rel_y);
+  const Eigen::ArrayXd numerator = (target.x - poses.x).square() + (target.y - poses.y).square();
+  const Eigen::ArrayXd denominator = 2.0 * rel_y;
+  const Eigen::ArrayXd radius = (denominator.abs() > 0).select(numerator / denominator, RADIUS_MAX);
+  return (radius.abs() > 0).select(radius.inverse(), KAPPA_MAX);
+}
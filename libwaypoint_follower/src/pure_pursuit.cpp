@@ -17,6 +17,7 @@
 #include "libwaypoint_follower/pure_pursuit.h"
 #include "libwaypoint_follower/libwaypoint_follower.h"
 
+#include <algorithm>
 #include <limits>
 #include <utility>
 #include <vector>
@@ -33,13 +34,15 @@ void PurePursuit::setClosestThreshold(double clst_thr_dist, double clst_thr_ang)
   clst_thr_ang_ = clst_thr_ang;
 }
 
+void PurePursuit::setTrackingWindow(int32_t tracking_window) { tracking_window_ = std::max(tracking_window, 0); }
+
 geometry_msgs::Point PurePursuit::getLocationOfNextWaypoint() { return loc_next_wp_; }
 
 geometry_msgs::Point PurePursuit::getLocationOfNextTarget() { return loc_next_tgt_; }
 
 bool PurePursuit::isRequirementsSatisfied()
 {
-  return (curr_wps_ptr_  && curr_pose_ptr_) ? true : false;
+  return (curr_wps_owner_ && curr_pose_ptr_) ? true : false;
 }
 
 std::pair<bool, double> PurePursuit::run()
@@ -48,7 +51,7 @@ std::pair<bool, double> PurePursuit::run()
   if (!isRequirementsSatisfied())
     return error;
 
-  auto clst_pair = findClosestIdxWithDistAngThr(*curr_wps_ptr_, *curr_pose_ptr_, clst_thr_dist_, clst_thr_ang_);
+  auto clst_pair = findClosestIdx();
 
   if (!clst_pair.first)
   {
@@ -63,13 +66,13 @@ std::pair<bool, double> PurePursuit::run()
     return error;
   }
 
-  loc_next_wp_ = curr_wps_ptr_->at(next_wp_idx).position;
+  loc_next_wp_ = curr_wps_.at(next_wp_idx).position;
 
   geometry_msgs::Point next_tgt_pos;
   // if use_lerp_ is false or next waypoint is first
   if (!use_lerp_ || next_wp_idx == 0)
   {
-    next_tgt_pos = curr_wps_ptr_->at(next_wp_idx).position;
+    next_tgt_pos = curr_wps_.at(next_wp_idx).position;
   }
   else
   {
@@ -96,8 +99,8 @@ std::pair<bool, geometry_msgs::Point> PurePursuit::lerpNextTarget(int32_t next_w
 {
   std::pair<bool, geometry_msgs::Point> error = std::make_pair(false, geometry_msgs::Point());
   constexpr double ERROR2 = 1e-5;  // 0.00001
-  const geometry_msgs::Point &vec_end = curr_wps_ptr_->at(next_wp_idx).position;
-  const geometry_msgs::Point &vec_start = curr_wps_ptr_->at(next_wp_idx - 1).position;
+  const geometry_msgs::Point &vec_end = curr_wps_.at(next_wp_idx).position;
+  const geometry_msgs::Point &vec_start = curr_wps_.at(next_wp_idx - 1).position;
   const geometry_msgs::Pose &curr_pose = *curr_pose_ptr_;
 
   Eigen::Vector3d vec_a((vec_end.x - vec_start.x),
@@ -142,38 +145,87 @@ std::pair<bool, geometry_msgs::Point> PurePursuit::lerpNextTarget(int32_t next_w
   }
 }
 
+std::pair<bool, int32_t> PurePursuit::findClosestIdx()
+{
+  const int32_t size = static_cast<int32_t>(curr_wps_.size());
+  std::pair<bool, int32_t> clst_pair = std::make_pair(false, -1);
+  if (tracking_window_ > 0)
+  {
+    // the vehicle moves along the waypoints, the closest one is not behind the previous one
+    const int32_t begin = std::max(clst_idx_, 0);
+    clst_pair = findClosestIdxInRange(begin, std::min(begin + tracking_window_, size));
+  }
+  if (!clst_pair.first)
+  {
+    clst_pair = findClosestIdxInRange(0, size);
+  }
+  clst_idx_ = clst_pair.second;
+  return clst_pair;
+}
+
+// same as findClosestIdxWithDistAngThr, in [begin, end) of the waypoints
+std::pair<bool, int32_t> PurePursuit::findClosestIdxInRange(int32_t begin, int32_t end) const
+{
+  const double dist_thr_squared = clst_thr_dist_ * clst_thr_dist_;
+  const double yaw_pose = tf2::getYaw(curr_pose_ptr_->orientation);
+  double dist_squared_min = std::numeric_limits<double>::max();
+  int32_t idx_min = -1;
+
+  for (int32_t i = begin; i < end; ++i)
+  {
+    const double ds = calcDistSquared2D(curr_wps_.at(i).position, curr_pose_ptr_->position);
+    if (ds > dist_thr_squared)
+      continue;
+
+    const double yaw_diff = normalizeEulerAngle(yaw_pose - curr_wps_yaw_[i]);
+    if (std::fabs(yaw_diff) > clst_thr_ang_)
+      continue;
+
+    if (ds < dist_squared_min)
+    {
+      dist_squared_min = ds;
+      idx_min = i;
+    }
+  }
+
+  return std::make_pair(idx_min >= 0, idx_min);
+}
+
 int32_t PurePursuit::findNextPointIdx(int32_t search_start_idx)
 {
   // if waypoints are not given, do nothing.
-  if (curr_wps_ptr_->size() < 3 || search_start_idx == -1)
+  if (curr_wps_.size() < 3 || search_start_idx == -1)
     return -1;
 
+  const bool is_forward = isDirectionForward(curr_wps_);
+  const double lookahead_distance_squared = std::pow(lookahead_distance_, 2);
+
   // look for the next waypoint.
-  for (int32_t i = search_start_idx; i < static_cast<int32_t>(curr_wps_ptr_->size()); i++)
+  for (int32_t i = search_start_idx; i < static_cast<int32_t>(curr_wps_.size()); i++)
   {
     // if search waypoint is the last
-    if (i == static_cast<int32_t>(curr_wps_ptr_->size() - 1))
+    if (i == static_cast<int32_t>(curr_wps_.size() - 1))
     {
       return i;
     }
 
     // if waypoint is  not on the front
-    if (isDirectionForward(*curr_wps_ptr_))
+    if (is_forward)
     {
-      if (transformToRelativeCoordinate2D(curr_wps_ptr_->at(i).position, *curr_pose_ptr_).x < 0)
+      if (transformToRelativeCoordinate2D(curr_wps_.at(i).position, *curr_pose_ptr_).x < 0)
         continue;
     }
     else
     {
-      if (transformToRelativeCoordinate2D(curr_wps_ptr_->at(i).position, *curr_pose_ptr_).x > 0)
+      if (transformToRelativeCoordinate2D(curr_wps_.at(i).position, *curr_pose_ptr_).x > 0)
         continue;
     }
 
-    const geometry_msgs::Point &curr_motion_point = curr_wps_ptr_->at(i).position;
+    const geometry_msgs::Point &curr_motion_point = curr_wps_.at(i).position;
     const geometry_msgs::Point &curr_pose_point = curr_pose_ptr_->position;
     // if there exists an effective waypoint
     const double ds = calcDistSquared2D(curr_motion_point, curr_pose_point);
-    if (ds > std::pow(lookahead_distance_, 2))
+    if (ds > lookahead_distance_squared)
       return i;
   }
 
@@ -190,7 +242,31 @@ void PurePursuit::setCurrentPose(const geometry_msgs::Pose &msg)
 
 void PurePursuit::setWaypoints(const std::vector<geometry_msgs::Pose> &msg)
 {
-  curr_wps_ptr_ = std::make_shared<std::vector<geometry_msgs::Pose>>();
-  *curr_wps_ptr_ = msg;
+  auto wps_ptr = std::make_shared<const std::vector<geometry_msgs::Pose>>(msg);
+  setWaypointsView(wps_ptr, *wps_ptr);
+}
+
+void PurePursuit::setWaypoints(const autoware_msgs::LaneConstPtr &msg)
+{
+  if (!msg)
+  {
+    setWaypointsView(nullptr, PoseArrayView());
+    return;
+  }
+  // the message pointer is a boost one, the deleter keeps a copy of it
+  std::shared_ptr<const void> owner(msg.get(), [msg](const void *) {});
+  setWaypointsView(owner, *msg);
+}
+
+void PurePursuit::setWaypointsView(const std::shared_ptr<const void> &owner, const PoseArrayView &wps)
+{
+  curr_wps_owner_ = owner;
+  curr_wps_ = wps;
+  curr_wps_yaw_.clear();
+  curr_wps_yaw_.reserve(wps.size());
+  for (const auto &pose : wps)
+    curr_wps_yaw_.push_back(tf2::getYaw(pose.orientation));
+  // final_waypoints start from the vehicle, the search starts from their beginning
+  clst_idx_ = -1;
 }
 
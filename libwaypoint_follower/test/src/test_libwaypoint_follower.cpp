@@ -320,6 +320,46 @@ TEST_F(LibWaypointFollowerTestSuite, extractPoses_Waypoint)
   ASSERT_NEAR(-999.0, test.at(2).pose.pose.position.x, ERROR);
 }
 
+TEST_F(LibWaypointFollowerTestSuite, PoseArrayView)
+{
+  autoware_msgs::Lane test;
+  for (int i = 0; i < 5; ++i)
+  {
+    test.waypoints.emplace_back();
+    test.waypoints.back().pose.pose.position.x = i * 2.0;
+    test.waypoints.back().pose.pose.orientation.w = 1.0;
+    test.waypoints.back().twist.twist.linear.x = 100.0 + i;
+  }
+
+  // the poses of the waypoints, not copied
+  const PoseArrayView view(test);
+  ASSERT_EQ(test.waypoints.size(), view.size());
+  for (size_t i = 0; i < view.size(); ++i)
+    ASSERT_EQ(&test.waypoints.at(i).pose.pose, &view.at(i));
+  ASSERT_EQ(&test.waypoints.back().pose.pose, &view.back());
+
+  size_t n = 0;
+  for (const auto &pose : view)
+    ASSERT_NEAR(n++ * 2.0, pose.position.x, ERROR);
+  ASSERT_EQ(view.size(), n);
+  ASSERT_THROW(view.at(view.size()), std::out_of_range);
+
+  // same results as on the extracted poses
+  const std::vector<geometry_msgs::Pose> poses = extractPoses(test);
+  geometry_msgs::Pose curr_pose;
+  curr_pose.position.x = 4.9;
+  curr_pose.orientation.w = 1.0;
+  ASSERT_EQ(findClosestIdxWithDistAngThr(poses, curr_pose), findClosestIdxWithDistAngThr(view, curr_pose));
+  ASSERT_EQ(isDirectionForward(poses), isDirectionForward(view));
+  const Poses2D poses_2d = toPoses2D(view);
+  ASSERT_EQ(poses.size(), static_cast<size_t>(poses_2d.x.size()));
+  ASSERT_NEAR(8.0, poses_2d.x(4), ERROR);
+
+  const PoseArrayView empty_view(std::vector<autoware_msgs::Waypoint>{});
+  ASSERT_TRUE(empty_view.empty());
+  ASSERT_TRUE(empty_view.begin() == empty_view.end());
+}
+
 TEST_F(LibWaypointFollowerTestSuite, findClosestIdxWithDistAngThr)
 {
   std::vector<geometry_msgs::Pose> curr_ps;
@@ -496,6 +536,50 @@ TEST_F(LibWaypointFollowerTestSuite, transformToRelativeCoordinate2D)
   ASSERT_NEAR(0.0, res.z, ERROR);
 }
 
+TEST_F(LibWaypointFollowerTestSuite, batch)
+{
+  // candidate poses around the origin, including one at the target
+  std::vector<geometry_msgs::Pose> poses;
+  tf2::Quaternion tf_q;
+  for (int i = 0; i < 11; ++i)
+  {
+    geometry_msgs::Pose pose;
+    pose.position.x = -5.0 + i;
+    pose.position.y = 0.3 * i - 1.0;
+    tf_q.setRPY(0.0, 0.0, (i - 5) * 30 * M_PI / 180);
+    pose.orientation = tf2::toMsg(tf_q);
+    poses.push_back(pose);
+  }
+  geometry_msgs::Point target;
+  target.x = 3.0;
+  target.y = 1.4;
+  poses.back().position = target;
+  geometry_msgs::Point line_s, line_e;
+  line_s.x = 2.0;
+  line_s.y = 4.0;
+  line_e.x = 7.0;
+  line_e.y = 3.0;
+
+  // each value is the one of the function for one pose
+  const Poses2D poses_2d = toPoses2D(poses);
+  Eigen::ArrayXd rel_x, rel_y;
+  transformToRelativeCoordinate2D(target, poses_2d, &rel_x, &rel_y);
+  const Eigen::ArrayXd lat_err = calcLateralError2D(line_s, line_e, poses_2d);
+  const Eigen::ArrayXd kappa = calcCurvature(target, poses_2d);
+  ASSERT_EQ(poses.size(), static_cast<size_t>(kappa.size()));
+  for (size_t i = 0; i < poses.size(); ++i)
+  {
+    const geometry_msgs::Point rel = transformToRelativeCoordinate2D(target, poses.at(i));
+    ASSERT_NEAR(rel.x, rel_x(i), ERROR) << "at index " << i;
+    ASSERT_NEAR(rel.y, rel_y(i), ERROR) << "at index " << i;
+    ASSERT_NEAR(calcLateralError2D(line_s, line_e, poses.at(i).position), lat_err(i), ERROR) << "at index " << i;
+    ASSERT_NEAR(calcCurvature(target, poses.at(i)), kappa(i), ERROR) << "at index " << i;
+  }
+
+  // the length of line is zero
+  ASSERT_NEAR(0.0, calcLateralError2D(line_s, line_s, poses_2d).abs().maxCoeff(), ERROR);
+}
+
 int main(int argc, char **argv)
 {
   testing::InitGoogleTest(&argc, argv);
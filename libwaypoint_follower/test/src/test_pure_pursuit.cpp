@@ -45,6 +45,57 @@ TEST_F(TestSuite, PurePursuit_is_requirements_safisfied)
   pp.setCurrentPose(pose_ptr->pose);
   pp.setWaypoints(extractPoses(*wps_ptr));
   ASSERT_EQ(true, pp.isRequirementsSatisfied());
+
+  PurePursuit pp_lane;
+  pp_lane.setCurrentPose(pose_ptr->pose);
+  pp_lane.setWaypoints(autoware_msgs::LaneConstPtr());
+  ASSERT_EQ(false, pp_lane.isRequirementsSatisfied());
+  pp_lane.setWaypoints(wps_ptr);
+  ASSERT_EQ(true, pp_lane.isRequirementsSatisfied());
+}
+
+TEST_F(TestSuite, PurePursuit_lane_waypoints)
+{
+  // curved waypoints, set as poses and as the lane message
+  autoware_msgs::LanePtr lane_ptr(new autoware_msgs::Lane());
+  std::vector<geometry_msgs::Pose> wps;
+  for (int i = 0; i < 60; ++i)
+  {
+    autoware_msgs::Waypoint wp;
+    const double yaw = 0.01 * i;
+    wp.pose.pose.position.x = 20.0 * std::sin(yaw) / 0.2;
+    wp.pose.pose.position.y = 20.0 * (1.0 - std::cos(yaw)) / 0.2;
+    wp.pose.pose.orientation = getQuaternionFromYaw(yaw);
+    lane_ptr->waypoints.push_back(wp);
+    wps.push_back(wp.pose.pose);
+  }
+
+  PurePursuit pp, pp_lane;
+  pp.setWaypoints(wps);
+  pp_lane.setWaypoints(autoware_msgs::LaneConstPtr(lane_ptr));
+  pp.setLookaheadDistance(4.0);
+  pp_lane.setLookaheadDistance(4.0);
+  pp.setUseLerp(true);
+  pp_lane.setUseLerp(true);
+
+  // the lane is kept alive by PurePursuit
+  const autoware_msgs::Lane *lane_raw = lane_ptr.get();
+  lane_ptr.reset();
+
+  for (int i = 0; i < 50; i += 3)
+  {
+    geometry_msgs::Pose pose = lane_raw->waypoints.at(i).pose.pose;
+    pose.position.y += 0.2;
+    pp.setCurrentPose(pose);
+    pp_lane.setCurrentPose(pose);
+    auto res = pp.run();
+    auto res_lane = pp_lane.run();
+    ASSERT_EQ(true, res.first);
+    ASSERT_EQ(res.first, res_lane.first);
+    ASSERT_DOUBLE_EQ(res.second, res_lane.second);
+    ASSERT_DOUBLE_EQ(pp.getLocationOfNextTarget().x, pp_lane.getLocationOfNextTarget().x);
+    ASSERT_DOUBLE_EQ(pp.getLocationOfNextTarget().y, pp_lane.getLocationOfNextTarget().y);
+  }
 }
 
 TEST_F(TestSuite, PurePursuit_run)
@@ -54,6 +105,46 @@ TEST_F(TestSuite, PurePursuit_run)
   ASSERT_EQ(false, res.first);
 }
 
+TEST_F(TestSuite, PurePursuit_tracking_window)
+{
+  // straight waypoints every 1 m along x, the vehicle drives along them
+  std::vector<geometry_msgs::Pose> wps(100);
+  for (size_t i = 0; i < wps.size(); ++i)
+  {
+    wps.at(i).position.x = static_cast<double>(i);
+    wps.at(i).orientation.w = 1.0;
+  }
+  PurePursuit pp, pp_tracking;
+  pp.setWaypoints(wps);
+  pp_tracking.setWaypoints(wps);
+  pp.setLookaheadDistance(5.0);
+  pp_tracking.setLookaheadDistance(5.0);
+  pp_tracking.setTrackingWindow(5);
+
+  geometry_msgs::Pose pose;
+  pose.orientation.w = 1.0;
+  for (double x = 0.0; x < 90.0; x += 0.7)
+  {
+    pose.position.x = x;
+    pose.position.y = 0.3;
+    pp.setCurrentPose(pose);
+    pp_tracking.setCurrentPose(pose);
+    auto res = pp.run();
+    auto res_tracking = pp_tracking.run();
+    ASSERT_EQ(true, res.first);
+    ASSERT_EQ(res.first, res_tracking.first);
+    ASSERT_DOUBLE_EQ(res.second, res_tracking.second);
+    ASSERT_DOUBLE_EQ(pp.getLocationOfNextWaypoint().x, pp_tracking.getLocationOfNextWaypoint().x);
+  }
+
+  // a jump beyond the window falls back to all the waypoints
+  pose.position.x = 10.0;
+  pp.setCurrentPose(pose);
+  pp_tracking.setCurrentPose(pose);
+  ASSERT_DOUBLE_EQ(pp.run().second, pp_tracking.run().second);
+  ASSERT_DOUBLE_EQ(pp.getLocationOfNextWaypoint().x, pp_tracking.getLocationOfNextWaypoint().x);
+}
+
 int main(int argc, char **argv)
 {
   testing::InitGoogleTest(&argc, argv);
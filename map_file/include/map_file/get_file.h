@@ -18,13 +18,23 @@
 #define _GET_FILE_H_
 
 #include <cstdint>
+#include <map>
 #include <string>
+#include <vector>
 #include <netinet/in.h>
 
 #define HTTP_HOSTNAME     "133.6.148.90"
 #define HTTP_PORT         (80)
 #define HTTP_USER         ""
 #define HTTP_PASSWORD     ""
+#define HTTP_CONNECTIONS  (4)
+
+// Expected size and FNV-1a 64 checksum of a file, keyed by its path on the server
+struct ManifestEntry {
+  uint64_t size;
+  uint64_t checksum;
+};
+typedef std::map<std::string, ManifestEntry> Manifest;
 
 class GetFile {
 private:
@@ -35,11 +45,29 @@ private:
   int sock;
   struct sockaddr_in server;
 
+  int Fetch(void* curl, const std::string& value) const;
+
 public:
   GetFile();
   explicit GetFile(const std::string& host_name, int port, const std::string& user, const std::string& password);
 
+  // Downloads value to /tmp/value through /tmp/value.part, a partial file left by a failed
+  // transfer is resumed with a range request
   int GetHTTPFile(const std::string& value);
+
+  // Downloads values on up to connections parallel connections, returns the GetHTTPFile result of each.
+  // The files listed in manifest are verified, a file that does not match is removed and fails with -6.
+  std::vector<int> GetHTTPFiles(const std::vector<std::string>& values, int connections = HTTP_CONNECTIONS,
+                                const Manifest* manifest = NULL);
+
+  // Downloads and reads a manifest, one "<path> <size> <checksum in hex>" line per file,
+  // the paths are relative to the directory of the manifest
+  int GetHTTPManifest(const std::string& value, Manifest& manifest);
+
+  static uint64_t ComputeChecksum(const std::string& filepath);
+
+  // true if filepath matches its entry of manifest or the path is not listed
+  static bool VerifyFile(const std::string& value, const std::string& filepath, const Manifest& manifest);
 };
 
 
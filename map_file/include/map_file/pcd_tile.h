@@ -0,0 +1,52 @@
+/*
+ * Copyright 2015-2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _PCD_TILE_H_
+#define _PCD_TILE_H_
+
+#include <cstdint>
+#include <string>
+
+#include <sensor_msgs/PointCloud2.h>
+
+// Pre-converted point cloud tile (.pct), a header with the PointCloud2 layout followed by the PointCloud2 data.
+// The data is stored as is or LZ4 compressed, reading a tile maps the file and copies or decompresses the data
+// straight into the message, there is no parsing or point conversion.
+namespace map_file
+{
+constexpr uint32_t PCD_TILE_VERSION = 1;
+const std::string PCD_TILE_EXTENSION = ".pct";
+
+bool isPcdTile(const std::string& path);
+
+// The tile of path.pcd is path.pct, it is used instead of the pcd when it is not older
+std::string getPcdTilePath(const std::string& pcd_path);
+bool hasPcdTile(const std::string& pcd_path);
+
+// true if tile_path exists and is not older than source_path
+bool isPcdTileUpToDate(const std::string& tile_path, const std::string& source_path);
+
+bool writePcdTile(const std::string& path, const sensor_msgs::PointCloud2& cloud, bool compress);
+bool readPcdTile(const std::string& path, sensor_msgs::PointCloud2& cloud);
+
+// The layout of the tile without its data, data_size is the size of its data once read
+bool readPcdTileHeader(const std::string& path, sensor_msgs::PointCloud2& cloud, uint64_t& data_size);
+
+// The data of the tile read or decompressed straight into data, size must be its data_size
+bool readPcdTileData(const std::string& path, uint8_t* data, uint64_t size);
+}  // namespace map_file
+
+#endif /* _PCD_TILE_H_ */
@@ -43,7 +43,6 @@
 #include <tf2_ros/transform_listener.h>
 
 // headers in PCL
-#include <pcl/filters/passthrough.h>
 #include <pcl/point_types.h>
 #include <pcl_conversions/pcl_conversions.h>
 #include <pcl_ros/point_cloud.h>
@@ -52,8 +51,13 @@
 #include <boost/optional.hpp>
 
 // headers in STL
+#include <condition_variable>
 #include <mutex>
 #include <regex>
+#include <set>
+#include <thread>
+#include <unordered_map>
+#include <utility>
 
 class points_map_filter {
 public:
@@ -63,20 +67,53 @@ public:
   void run();
 
 private:
-  pcl::PassThrough<pcl::PointXYZ> pass_;
   ros::Subscriber map_sub_;
   ros::Subscriber pose_sub_;
   ros::Publisher map_pub_;
-  std::mutex mtx_;
+  ros::Publisher entering_pub_;
+  ros::Publisher leaving_pub_;
+  std::mutex mtx_; // guards the map and the parameters
   ros::NodeHandle nh_, pnh_;
   void map_callback_(const sensor_msgs::PointCloud2::ConstPtr msg);
   void current_pose_callback_(const geometry_msgs::PoseStamped::ConstPtr msg);
   double load_grid_size_;
   double load_trigger_distance_;
+  double bucket_size_;
+  bool sliding_window_;
+  bool publish_diff_;
   std::string map_frame_;
   boost::optional<geometry_msgs::PoseStamped> last_load_pose_;
   pcl::PointCloud<pcl::PointXYZ>::Ptr map_cloud_;
   volatile bool map_recieved_;
+  // map_cloud_ is sorted by 2D bucket of bucket_size_, each bucket is a range
+  // of it
+  std::unordered_map<int64_t, std::pair<size_t, size_t>> buckets_;
+  void build_buckets_(const pcl::PointCloud<pcl::PointXYZ> &cloud);
+  int64_t bucket_key_(int64_t ix, int64_t iy) const;
+  void buckets_in_square_(double x, double y,
+                          std::vector<int64_t> &keys) const;
+  void append_bucket_(int64_t key,
+                      pcl::PointCloud<pcl::PointXYZ> &cloud) const;
+  void extract_submap_(double x, double y,
+                       pcl::PointCloud<pcl::PointXYZ> &submap) const;
+  // sliding window mode, the submap is made of whole buckets, the ones
+  // entering and leaving it since the last update are the diff
+  std::set<int64_t> window_buckets_;
+  void update_window_(double x, double y,
+                      pcl::PointCloud<pcl::PointXYZ> &submap,
+                      pcl::PointCloud<pcl::PointXYZ> &entering,
+                      pcl::PointCloud<pcl::PointXYZ> &leaving);
+  void publish_cloud_(const ros::Publisher &pub,
+                      const pcl::PointCloud<pcl::PointXYZ> &cloud,
+                      const ros::Time &stamp);
+  // the submaps are extracted and published by worker_, the pose callback
+  // only hands over the pose
+  std::thread worker_;
+  std::mutex request_mtx_; // guards last_load_pose_ and the request
+  std::condition_variable request_cv_;
+  boost::optional<geometry_msgs::PoseStamped> requested_pose_;
+  bool shutdown_;
+  void worker_loop_();
 };
 
 #endif // POINTS_MAP_FILTER_H_INCLUDED
\ No newline at end of file
@@ -0,0 +1,266 @@
+/*
+ * Copyright 2015-2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef POINTS_MAP_LOADER_H_INCLUDED
+#define POINTS_MAP_LOADER_H_INCLUDED
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <autoware_health_checker/health_checker/health_checker.h>
+#include <diagnostic_msgs/DiagnosticArray.h>
+#include <geometry_msgs/PoseStamped.h>
+#include <geometry_msgs/PoseWithCovarianceStamped.h>
+#include <geometry_msgs/TwistStamped.h>
+#include <ros/ros.h>
+#include <sensor_msgs/PointCloud2.h>
+#include <std_msgs/Bool.h>
+
+#include "autoware_msgs/LaneArray.h"
+
+#include "map_file/get_file.h"
+
+namespace map_file
+{
+namespace points_map_loader
+{
+class RequestQueue
+{
+private:
+  std::queue<geometry_msgs::Point> queue_;  // takes priority over look_ahead_queue_
+  std::queue<geometry_msgs::Point> look_ahead_queue_;
+  std::mutex mtx_;
+  std::condition_variable cv_;
+  bool shutdown_ = false;
+
+public:
+  void enqueue(const geometry_msgs::Point& p);
+  void enqueue_look_ahead(const geometry_msgs::Point& p);
+  void clear_look_ahead();
+  void shutdown();
+  // false once shut down
+  bool dequeue(geometry_msgs::Point& p);
+};
+
+// Holds only the latest pose, older requests are dropped while the tiles of a previous one are loading
+class PcdRequest
+{
+private:
+  geometry_msgs::Point point_;
+  bool pending_ = false;
+  std::mutex mtx_;
+  std::condition_variable cv_;
+  bool shutdown_ = false;
+
+public:
+  void set(const geometry_msgs::Point& p);
+  void shutdown();
+  // false once shut down
+  bool wait(geometry_msgs::Point& p);
+};
+
+// Decoded tiles keyed by path, the least recently used ones are dropped when the total size exceeds the budget
+class TileCache
+{
+private:
+  struct Entry
+  {
+    sensor_msgs::PointCloud2::ConstPtr cloud;
+    size_t size;
+    std::list<std::string>::iterator lru;
+  };
+
+  std::unordered_map<std::string, Entry> tiles_;
+  std::list<std::string> lru_;  // most recently used first
+  size_t size_ = 0;
+  size_t budget_ = 0;
+  uint64_t hits_ = 0;
+  uint64_t misses_ = 0;
+  uint64_t evictions_ = 0;
+  std::mutex mtx_;
+
+  static size_t cloudSize(const sensor_msgs::PointCloud2& cloud);
+  void evict(size_t budget);
+
+public:
+  void setBudget(size_t bytes);
+  sensor_msgs::PointCloud2::ConstPtr find(const std::string& path);
+  bool contains(const std::string& path);
+  void insert(const std::string& path, const sensor_msgs::PointCloud2::ConstPtr& cloud);
+  diagnostic_msgs::DiagnosticStatus getStatus();
+};
+
+// Load times and sizes of the tiles read from storage and durations of the publishes, for /diagnostics and the
+// health checker. The checks use what was recorded since the previous check
+class LoadMetrics
+{
+private:
+  struct Window
+  {
+    uint64_t tiles = 0;
+    uint64_t bytes = 0;
+    double seconds = 0;  // sum of the tile load times, bytes / seconds is the throughput of one load thread
+    double max_tile_seconds = 0;
+    std::string slowest_tile;
+  };
+
+  Window total_;
+  Window window_;
+  uint64_t failures_ = 0;
+  uint64_t publishes_ = 0;
+  double last_publish_seconds_ = 0;
+  double max_publish_seconds_ = 0;
+  uint32_t last_publish_points_ = 0;
+  bool published_ = false;  // since the previous check
+  std::mutex mtx_;
+
+  static void add(Window& window, const std::string& path, uint64_t bytes, double seconds);
+
+public:
+  void recordTile(const std::string& path, uint64_t bytes, double seconds, bool loaded);
+  void recordPublish(double seconds, uint32_t points);
+  diagnostic_msgs::DiagnosticStatus getStatus();
+  void check(autoware_health_checker::HealthChecker& checker);
+};
+
+struct Area
+{
+  std::string path;
+  double x_min;
+  double y_min;
+  double z_min;
+  double x_max;
+  double y_max;
+  double z_max;
+};
+
+typedef std::vector<Area> AreaList;
+
+}  // namespace points_map_loader
+
+// Publishes the points map of the pcd files, or of the tiles around the vehicle in the area modes
+class PointsMapLoader
+{
+public:
+  /*!
+   * @param[in] nh Handle of the topics, the one of the nodelet when loaded in a manager
+   * @param[in] pnh Handle of the parameters
+   */
+  PointsMapLoader(ros::NodeHandle nh, ros::NodeHandle pnh);
+  // Stops and joins the publisher, prefetcher and downloader threads
+  ~PointsMapLoader();
+
+  // Reads the parameters, publishes the map of the noupdate mode or starts the threads of the area modes.
+  // false when the area parameter is invalid
+  bool init();
+
+private:
+  ros::NodeHandle nh_;
+  ros::NodeHandle pnh_;
+
+  int update_rate_;
+  int fallback_rate_;
+  double margin_;
+  bool can_download_;
+  int load_threads_;
+  double prefetch_time_ = 0;
+  std::vector<double> pyramid_leaf_sizes_;
+  std::string pyramid_cache_dir_;
+  double lod_leaf_size_ = 0;
+
+  ros::Time gnss_time_;
+  ros::Time current_time_;
+
+  ros::Publisher pcd_pub_;
+  ros::Publisher stat_pub_;
+  ros::Publisher diag_pub_;
+  std::vector<ros::Publisher> pyramid_pubs_;
+  std_msgs::Bool stat_msg_;
+
+  ros::Subscriber gnss_sub_;
+  ros::Subscriber current_sub_;
+  ros::Subscriber initial_sub_;
+  ros::Subscriber waypoints_sub_;
+  ros::Subscriber planned_lanes_sub_;
+  ros::Subscriber velocity_sub_;
+
+  points_map_loader::AreaList all_areas_;
+  points_map_loader::AreaList downloaded_areas_;
+  std::mutex downloaded_areas_mtx_;
+  std::vector<std::string> cached_arealist_paths_;
+
+  GetFile gf_;
+  int connections_;
+  Manifest manifest_;  // only used by the download thread
+  points_map_loader::RequestQueue request_queue_;
+  points_map_loader::PcdRequest pcd_request_;
+  points_map_loader::PcdRequest prefetch_request_;
+  points_map_loader::TileCache tile_cache_;
+  points_map_loader::LoadMetrics load_metrics_;
+  std::unique_ptr<autoware_health_checker::HealthChecker> health_checker_;
+
+  std::vector<autoware_msgs::Lane> planned_lanes_;
+  std::mutex planned_lanes_mtx_;
+  std::atomic<double> current_speed_;
+
+  std::atomic<bool> running_;  // cleared by the destructor, the threads and the loads stop on it
+  std::thread publisher_;
+  std::thread prefetcher_;
+  std::thread downloader_;
+
+  void download_map();
+  void parallel_for(size_t n, const std::function<void(size_t)>& f);
+  std::vector<sensor_msgs::PointCloud2> load_pcds(const std::vector<std::string>& paths, int* ret_err = NULL);
+  std::string get_level_path(const std::string& path, double leaf_size) const;
+  sensor_msgs::PointCloud2::ConstPtr create_level(const std::string& path, double leaf_size,
+                                                  const sensor_msgs::PointCloud2& full) const;
+  bool load_pcds_in_place(const std::vector<std::string>& paths, sensor_msgs::PointCloud2& pcd);
+  void downsample_parts(std::vector<sensor_msgs::PointCloud2::ConstPtr>& parts);
+  void create_levels(const std::vector<std::string>& paths,
+                     const std::vector<sensor_msgs::PointCloud2::ConstPtr>& parts,
+                     std::vector<sensor_msgs::PointCloud2>& levels);
+  sensor_msgs::PointCloud2 create_pcd(const geometry_msgs::Point& p,
+                                      std::vector<sensor_msgs::PointCloud2>* levels = NULL);
+  sensor_msgs::PointCloud2 create_pcd(const std::vector<std::string>& pcd_paths, int* ret_err = NULL,
+                                      std::vector<sensor_msgs::PointCloud2>* levels = NULL);
+  void publish_pcd(sensor_msgs::PointCloud2 pcd, const int* errp = NULL);
+  void publish_levels(std::vector<sensor_msgs::PointCloud2>& levels);
+  void publish_diagnostics(bool with_cache);
+  void load_and_publish(const std::function<sensor_msgs::PointCloud2(std::vector<sensor_msgs::PointCloud2>*)>& create,
+                        const int* errp = NULL);
+  void publish_map();
+  std::vector<geometry_msgs::Point> predict_route(const geometry_msgs::Point& p);
+  void prefetch_map();
+  void update_planned_lanes(const autoware_msgs::LaneArray& msg);
+  void update_current_speed(const geometry_msgs::TwistStamped& msg);
+  void publish_gnss_pcd(const geometry_msgs::PoseStamped& msg);
+  void publish_current_pcd(const geometry_msgs::PoseStamped& msg);
+  void publish_dragged_pcd(const geometry_msgs::PoseWithCovarianceStamped& msg);
+  void request_lookahead_download(const autoware_msgs::LaneArray& msg);
+};
+
+}  // namespace map_file
+
+#endif  // POINTS_MAP_LOADER_H_INCLUDED
@@ -19,10 +19,13 @@
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
 #include <string>
 #include <fstream>
 #include <sstream>
-#include <ext/stdio_filebuf.h>
+#include <thread>
 #include <curl/curl.h>
 
 #include <map_file/get_file.h>
@@ -38,68 +41,190 @@ GetFile::GetFile(const std::string& host_name, int port, const std::string& user
 {
 }
 
-typedef std::basic_ofstream<char>::__filebuf_type buffer_t;
-typedef __gnu_cxx::stdio_filebuf<char> io_buffer_t; 
-static FILE* cfile(buffer_t* const fb) {
-  return (static_cast<io_buffer_t* const>(fb))->file();
+namespace {
+
+std::once_flag curl_init_flag;
+
+// curl_global_init is not thread safe, it must run before the first handle is created
+void InitCurl()
+{
+  std::call_once(curl_init_flag, []() { curl_global_init(CURL_GLOBAL_ALL); });
 }
 
-int GetFile::GetHTTPFile(const std::string& value) 
+std::string ManifestKey(const std::string& value)
 {
-  CURL *curl;
+  std::string::size_type begin = value.find_first_not_of('/');
+  return begin == std::string::npos ? std::string() : value.substr(begin);
+}
 
-  curl = curl_easy_init();
-  if (! curl) {
-    std::cerr << "curl_easy_init failed" << std::endl;
-    return -1;
-  }
+} // namespace
 
+int GetFile::Fetch(void* handle, const std::string& value) const
+{
+  CURL *curl = static_cast<CURL*>(handle);
   std::string filepath("/tmp/" + value);
-  std::ofstream ofs;
-  ofs.open(filepath);
-  if (! ofs.is_open()) {
-    std::cerr << "cannot open /tmp/" << value << std::endl;
-    curl_easy_cleanup(curl);
-    return -2;
-  }
+  std::string partpath(filepath + ".part");
 
-  std::ostringstream urlss;
-  urlss << "http://" << host_name_ << ":" << port_ << "/" << value;
-  curl_easy_setopt(curl, CURLOPT_URL, urlss.str().c_str());
-  curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1);
-  curl_easy_setopt(curl, CURLOPT_MAXREDIRS, 5);
-  curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, fwrite);
-  curl_easy_setopt(curl, CURLOPT_WRITEDATA, cfile(ofs.rdbuf()));
-  if (user_ != "" && password_ != "") {
+  for (int attempt = 0; attempt < 2; ++attempt) {
+    FILE* fp = fopen(partpath.c_str(), "ab");
+    if (fp == NULL) {
+      std::cerr << "cannot open " << partpath << std::endl;
+      return -2;
+    }
+    fseek(fp, 0, SEEK_END);
+    long offset = ftell(fp);
+
+    std::ostringstream urlss;
+    urlss << "http://" << host_name_ << ":" << port_ << "/" << value;
+    curl_easy_reset(curl);
+    curl_easy_setopt(curl, CURLOPT_URL, urlss.str().c_str());
+    curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1);
+    curl_easy_setopt(curl, CURLOPT_MAXREDIRS, 5);
+    curl_easy_setopt(curl, CURLOPT_FAILONERROR, 1);
+    curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1);
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, fwrite);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, fp);
+    curl_easy_setopt(curl, CURLOPT_RESUME_FROM_LARGE, static_cast<curl_off_t>(offset));
     std::string userpwd = user_ + ":" + password_;
-    curl_easy_setopt(curl, CURLOPT_HTTPAUTH, CURLAUTH_DIGEST);
-    curl_easy_setopt(curl, CURLOPT_USERPWD, userpwd.c_str());
+    if (user_ != "" && password_ != "") {
+      curl_easy_setopt(curl, CURLOPT_HTTPAUTH, CURLAUTH_DIGEST);
+      curl_easy_setopt(curl, CURLOPT_USERPWD, userpwd.c_str());
+    }
+    CURLcode res = curl_easy_perform(curl);
+    fclose(fp);
+
+    long response_code = 0;
+    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response_code);
+    // the server does not support ranges or the partial file is longer than the remote file, start over
+    if (offset > 0 && (res == CURLE_RANGE_ERROR || response_code == 416)) {
+      unlink(partpath.c_str());
+      continue;
+    }
+    if (res == CURLE_HTTP_RETURNED_ERROR) {
+      unlink(partpath.c_str());
+      return -5;
+    }
+    if (res != CURLE_OK) {
+      // the partial file is kept, the next call resumes it
+      std::cerr << "curl_easy_perform failed: " <<
+        curl_easy_strerror(res) << std::endl;
+      return -3;
+    }
+    if (response_code != 200 && response_code != 206) {
+      unlink(partpath.c_str());
+      return -5;
+    }
+    if (rename(partpath.c_str(), filepath.c_str()) != 0) {
+      unlink(partpath.c_str());
+      return -2;
+    }
+    return 0;
   }
-  CURLcode res = curl_easy_perform(curl);
-  if (res != CURLE_OK) {
-    std::cerr << "curl_easy_perform failed: " <<
-      curl_easy_strerror(res) << std::endl;
-    curl_easy_cleanup(curl);
-    ofs.close();
-    unlink(filepath.c_str());
-    return -3;
+
+  return -5;
+}
+
+int GetFile::GetHTTPFile(const std::string& value) 
+{
+  InitCurl();
+  CURL *curl = curl_easy_init();
+  if (! curl) {
+    std::cerr << "curl_easy_init failed" << std::endl;
+    return -1;
   }
-  long response_code;
-  res = curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response_code);
-  if (res != CURLE_OK) {
-    std::cerr << "curl_easy_getinfo failed: " <<
-      curl_easy_strerror(res) << std::endl;
+
+  int ret = Fetch(curl, value);
+  curl_easy_cleanup(curl);
+  return ret;
+}
+
+std::vector<int> GetFile::GetHTTPFiles(const std::vector<std::string>& values, int connections,
+                                       const Manifest* manifest)
+{
+  InitCurl();
+  std::vector<int> results(values.size(), -1);
+  std::atomic<size_t> next(0);
+
+  // each worker keeps one handle, curl reuses its connection for the next file
+  auto work = [&]() {
+    CURL *curl = curl_easy_init();
+    if (! curl) {
+      std::cerr << "curl_easy_init failed" << std::endl;
+      return;
+    }
+    for (size_t i = next++; i < values.size(); i = next++) {
+      results[i] = Fetch(curl, values[i]);
+      if (results[i] == 0 && manifest != NULL && ! VerifyFile(values[i], "/tmp/" + values[i], *manifest)) {
+        std::cerr << "verification failed: " << values[i] << std::endl;
+        unlink(("/tmp/" + values[i]).c_str());
+        results[i] = -6;
+      }
+    }
     curl_easy_cleanup(curl);
-    ofs.close();
-    unlink(filepath.c_str());
-    return -4;
+  };
+
+  size_t n = std::min(values.size(), static_cast<size_t>(std::max(connections, 1)));
+  std::vector<std::thread> workers;
+  for (size_t i = 1; i < n; ++i)
+    workers.emplace_back(work);
+  if (n > 0)
+    work();
+  for (std::thread& worker : workers)
+    worker.join();
+
+  return results;
+}
+
+int GetFile::GetHTTPManifest(const std::string& value, Manifest& manifest)
+{
+  // always fetched again, an old manifest is never trusted
+  unlink(("/tmp/" + value).c_str());
+  unlink(("/tmp/" + value + ".part").c_str());
+  int ret = GetHTTPFile(value);
+  if (ret != 0)
+    return ret;
+
+  std::string dir = ManifestKey(value);
+  std::string::size_type slash = dir.find_last_of('/');
+  dir = (slash == std::string::npos) ? std::string() : dir.substr(0, slash + 1);
+
+  std::ifstream ifs(("/tmp/" + value).c_str());
+  std::string line;
+  while (std::getline(ifs, line)) {
+    std::istringstream iss(line);
+    std::string path, checksum;
+    ManifestEntry entry;
+    if (! (iss >> path >> entry.size >> checksum))
+      continue;
+    entry.checksum = std::strtoull(checksum.c_str(), NULL, 16);
+    manifest[dir + ManifestKey(path)] = entry;
   }
-  curl_easy_cleanup(curl);
-  ofs.close();
-  if (response_code != 200) {
-    unlink(filepath.c_str());
-    return -5;
+  return 0;
+}
+
+uint64_t GetFile::ComputeChecksum(const std::string& filepath)
+{
+  uint64_t hash = 14695981039346656037ULL;
+  std::ifstream ifs(filepath.c_str(), std::ios::binary);
+  char buf[65536];
+  while (ifs) {
+    ifs.read(buf, sizeof(buf));
+    for (std::streamsize i = 0; i < ifs.gcount(); ++i) {
+      hash ^= static_cast<unsigned char>(buf[i]);
+      hash *= 1099511628211ULL;
+    }
   }
+  return hash;
+}
 
-  return 0;
+bool GetFile::VerifyFile(const std::string& value, const std::string& filepath, const Manifest& manifest)
+{
+  Manifest::const_iterator it = manifest.find(ManifestKey(value));
+  if (it == manifest.end())
+    return true;
+
+  std::ifstream ifs(filepath.c_str(), std::ios::binary | std::ios::ate);
+  if (! ifs || static_cast<uint64_t>(ifs.tellg()) != it->second.size)
+    return false;
+  return ComputeChecksum(filepath) == it->second.checksum;
 }
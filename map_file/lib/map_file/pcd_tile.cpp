@@ -0,0 +1,307 @@
+/*
+ * Copyright 2015-2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <lz4.h>
+
+#include <map_file/pcd_tile.h>
+
+namespace map_file
+{
+namespace
+{
+constexpr uint32_t MAGIC = 0x54435050;  // "PPCT"
+constexpr uint32_t FLAG_LZ4 = 1;
+
+template <class T>
+void append(std::string& buf, const T& value)
+{
+  buf.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+class Reader
+{
+private:
+  const uint8_t* pos_;
+  const uint8_t* end_;
+
+public:
+  Reader(const uint8_t* begin, size_t size) : pos_(begin), end_(begin + size)
+  {
+  }
+
+  template <class T>
+  bool read(T& value)
+  {
+    if (static_cast<size_t>(end_ - pos_) < sizeof(value))
+      return false;
+    std::memcpy(&value, pos_, sizeof(value));
+    pos_ += sizeof(value);
+    return true;
+  }
+
+  bool read(std::string& value, size_t size)
+  {
+    if (static_cast<size_t>(end_ - pos_) < size)
+      return false;
+    value.assign(reinterpret_cast<const char*>(pos_), size);
+    pos_ += size;
+    return true;
+  }
+
+  const uint8_t* pos() const
+  {
+    return pos_;
+  }
+
+  size_t left() const
+  {
+    return end_ - pos_;
+  }
+};
+
+// Read only mapping of a whole file
+class MappedFile
+{
+private:
+  void* addr_ = MAP_FAILED;
+  size_t size_ = 0;
+
+public:
+  explicit MappedFile(const std::string& path)
+  {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+      return;
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size > 0)
+    {
+      size_ = st.st_size;
+      addr_ = mmap(NULL, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (addr_ != MAP_FAILED)
+        madvise(addr_, size_, MADV_SEQUENTIAL);
+    }
+    close(fd);
+  }
+
+  ~MappedFile()
+  {
+    if (addr_ != MAP_FAILED)
+      munmap(addr_, size_);
+  }
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  bool isOpen() const
+  {
+    return addr_ != MAP_FAILED;
+  }
+
+  const uint8_t* data() const
+  {
+    return static_cast<const uint8_t*>(addr_);
+  }
+
+  size_t size() const
+  {
+    return size_;
+  }
+};
+}  // namespace
+
+bool isPcdTile(const std::string& path)
+{
+  return path.size() > PCD_TILE_EXTENSION.size() &&
+         path.compare(path.size() - PCD_TILE_EXTENSION.size(), PCD_TILE_EXTENSION.size(), PCD_TILE_EXTENSION) == 0;
+}
+
+std::string getPcdTilePath(const std::string& pcd_path)
+{
+  std::string::size_type dot = pcd_path.find_last_of('.');
+  std::string::size_type slash = pcd_path.find_last_of('/');
+  if (dot == std::string::npos || (slash != std::string::npos && dot < slash))
+    return pcd_path + PCD_TILE_EXTENSION;
+  return pcd_path.substr(0, dot) + PCD_TILE_EXTENSION;
+}
+
+bool hasPcdTile(const std::string& pcd_path)
+{
+  return isPcdTileUpToDate(getPcdTilePath(pcd_path), pcd_path);
+}
+
+bool isPcdTileUpToDate(const std::string& tile_path, const std::string& source_path)
+{
+  struct stat source_st, tile_st;
+  if (stat(tile_path.c_str(), &tile_st) != 0)
+    return false;
+  if (stat(source_path.c_str(), &source_st) != 0)
+    return true;
+  return tile_st.st_mtime >= source_st.st_mtime;
+}
+
+bool writePcdTile(const std::string& path, const sensor_msgs::PointCloud2& cloud, bool compress)
+{
+  std::string payload;
+  uint32_t flags = 0;
+  if (compress && !cloud.data.empty() && cloud.data.size() <= LZ4_MAX_INPUT_SIZE)
+  {
+    payload.resize(LZ4_compressBound(cloud.data.size()));
+    int size = LZ4_compress_default(reinterpret_cast<const char*>(cloud.data.data()), &payload[0], cloud.data.size(),
+                                    payload.size());
+    if (size > 0)
+    {
+      payload.resize(size);
+      flags |= FLAG_LZ4;
+    }
+  }
+
+  std::string header;
+  append(header, MAGIC);
+  append(header, PCD_TILE_VERSION);
+  append(header, flags);
+  append(header, cloud.height);
+  append(header, cloud.width);
+  append(header, cloud.point_step);
+  append(header, cloud.row_step);
+  append(header, static_cast<uint8_t>(cloud.is_bigendian));
+  append(header, static_cast<uint8_t>(cloud.is_dense));
+  append(header, static_cast<uint32_t>(cloud.fields.size()));
+  for (const sensor_msgs::PointField& field : cloud.fields)
+  {
+    append(header, static_cast<uint32_t>(field.name.size()));
+    header.append(field.name);
+    append(header, field.offset);
+    append(header, field.datatype);
+    append(header, field.count);
+  }
+  append(header, static_cast<uint64_t>(cloud.data.size()));
+  append(header, static_cast<uint64_t>((flags & FLAG_LZ4) ? payload.size() : cloud.data.size()));
+
+  // Written next to the tile and renamed, a reader never sees a partial file
+  std::string tmp_path = path + ".tmp";
+  FILE* fp = fopen(tmp_path.c_str(), "wb");
+  if (fp == NULL)
+    return false;
+  bool ok = fwrite(header.data(), 1, header.size(), fp) == header.size();
+  if (flags & FLAG_LZ4)
+    ok = ok && fwrite(payload.data(), 1, payload.size(), fp) == payload.size();
+  else
+    ok = ok && fwrite(cloud.data.data(), 1, cloud.data.size(), fp) == cloud.data.size();
+  ok = (fclose(fp) == 0) && ok;
+  if (!ok || rename(tmp_path.c_str(), path.c_str()) != 0)
+  {
+    unlink(tmp_path.c_str());
+    return false;
+  }
+  return true;
+}
+
+namespace
+{
+// Reads the layout of the tile up to its payload
+bool readHeader(Reader& reader, sensor_msgs::PointCloud2& cloud, uint32_t& flags, uint64_t& raw_size,
+                uint64_t& payload_size)
+{
+  uint32_t magic, version, num_fields;
+  uint8_t is_bigendian, is_dense;
+  if (!reader.read(magic) || magic != MAGIC || !reader.read(version) || version != PCD_TILE_VERSION ||
+      !reader.read(flags) || !reader.read(cloud.height) || !reader.read(cloud.width) ||
+      !reader.read(cloud.point_step) || !reader.read(cloud.row_step) || !reader.read(is_bigendian) ||
+      !reader.read(is_dense) || !reader.read(num_fields))
+    return false;
+  cloud.is_bigendian = is_bigendian;
+  cloud.is_dense = is_dense;
+
+  cloud.fields.resize(num_fields);
+  for (sensor_msgs::PointField& field : cloud.fields)
+  {
+    uint32_t name_size;
+    if (!reader.read(name_size) || !reader.read(field.name, name_size) || !reader.read(field.offset) ||
+        !reader.read(field.datatype) || !reader.read(field.count))
+      return false;
+  }
+
+  return reader.read(raw_size) && reader.read(payload_size) && payload_size == reader.left();
+}
+
+// data has raw_size bytes
+bool readData(const Reader& reader, uint32_t flags, uint64_t raw_size, uint64_t payload_size, uint8_t* data)
+{
+  if (flags & FLAG_LZ4)
+  {
+    if (raw_size > LZ4_MAX_INPUT_SIZE || payload_size > LZ4_MAX_INPUT_SIZE)
+      return false;
+    int size = LZ4_decompress_safe(reinterpret_cast<const char*>(reader.pos()), reinterpret_cast<char*>(data),
+                                   payload_size, raw_size);
+    return size >= 0 && static_cast<uint64_t>(size) == raw_size;
+  }
+
+  if (payload_size != raw_size)
+    return false;
+  std::memcpy(data, reader.pos(), payload_size);
+  return true;
+}
+}  // namespace
+
+bool readPcdTile(const std::string& path, sensor_msgs::PointCloud2& cloud)
+{
+  MappedFile file(path);
+  if (!file.isOpen())
+    return false;
+
+  Reader reader(file.data(), file.size());
+  uint32_t flags;
+  uint64_t raw_size, payload_size;
+  if (!readHeader(reader, cloud, flags, raw_size, payload_size))
+    return false;
+  if ((flags & FLAG_LZ4) && raw_size > LZ4_MAX_INPUT_SIZE)
+    return false;
+  cloud.data.resize(raw_size);
+  return readData(reader, flags, raw_size, payload_size, cloud.data.data());
+}
+
+bool readPcdTileHeader(const std::string& path, sensor_msgs::PointCloud2& cloud, uint64_t& data_size)
+{
+  MappedFile file(path);
+  if (!file.isOpen())
+    return false;
+
+  Reader reader(file.data(), file.size());
+  uint32_t flags;
+  uint64_t payload_size;
+  return readHeader(reader, cloud, flags, data_size, payload_size);
+}
+
+bool readPcdTileData(const std::string& path, uint8_t* data, uint64_t size)
+{
+  MappedFile file(path);
+  if (!file.isOpen())
+    return false;
+
+  Reader reader(file.data(), file.size());
+  sensor_msgs::PointCloud2 cloud;
+  uint32_t flags;
+  uint64_t raw_size, payload_size;
+  return readHeader(reader, cloud, flags, raw_size, payload_size) && raw_size == size &&
+         readData(reader, flags, raw_size, payload_size, data);
+}
+}  // namespace map_file
@@ -18,6 +18,7 @@
  */
 
 #include <ros/ros.h>
+#include <ros/serialization.h>
 
 #include <lanelet2_projection/UTM.h>
 #include <lanelet2_io/Io.h>
@@ -29,9 +30,86 @@
 #include <lanelet2_extension/utility/utilities.h>
 
 #include <autoware_lanelet2_msgs/MapBin.h>
+#include <std_msgs/String.h>
 
+#include <cstdio>
+#include <fstream>
 #include <string>
+#include <vector>
 #include <boost/filesystem.hpp>
+#include <boost/version.hpp>
+
+namespace
+{
+// Bumped whenever the message built from the same osm file changes
+const uint32_t MAP_CACHE_VERSION = 1;
+
+// The projector, the centerline overwrite and the boost archive format are part of the cached data
+const std::string MAP_CACHE_SETTINGS = "mgrs;overwrite_centerline=0;boost=" BOOST_LIB_VERSION;
+
+uint64_t computeMapChecksum(const std::string& file_path)
+{
+  uint64_t checksum = 14695981039346656037ULL ^ MAP_CACHE_VERSION;
+  auto combine = [&checksum](const char* data, size_t size) {
+    for (size_t i = 0; i < size; ++i)
+      checksum = (checksum ^ static_cast<uint8_t>(data[i])) * 1099511628211ULL;
+  };
+  combine(MAP_CACHE_SETTINGS.c_str(), MAP_CACHE_SETTINGS.size() + 1);
+
+  std::ifstream ifs(file_path.c_str(), std::ios::binary);
+  std::vector<char> buffer(1 << 16);
+  while (ifs.read(buffer.data(), buffer.size()) || ifs.gcount() > 0)
+    combine(buffer.data(), ifs.gcount());
+  return checksum;
+}
+
+bool loadMapCache(const std::string& cache_path, autoware_lanelet2_msgs::MapBin& map_bin_msg)
+{
+  std::ifstream ifs(cache_path.c_str(), std::ios::binary);
+  uint32_t version = 0;
+  uint32_t length = 0;
+  if (!ifs.read(reinterpret_cast<char*>(&version), sizeof(version)) || version != MAP_CACHE_VERSION ||
+      !ifs.read(reinterpret_cast<char*>(&length), sizeof(length)))
+    return false;
+
+  std::vector<uint8_t> buffer(length);
+  if (!ifs.read(reinterpret_cast<char*>(buffer.data()), length))
+    return false;
+  try
+  {
+    ros::serialization::IStream stream(buffer.data(), length);
+    ros::serialization::deserialize(stream, map_bin_msg);
+  }
+  catch (const ros::Exception& e)
+  {
+    ROS_WARN_STREAM("[lanelet2_map_loader] broken map cache " << cache_path << ": " << e.what());
+    map_bin_msg.data.clear();
+    return false;
+  }
+  return true;
+}
+
+bool saveMapCache(const std::string& cache_path, const autoware_lanelet2_msgs::MapBin& map_bin_msg)
+{
+  uint32_t version = MAP_CACHE_VERSION;
+  uint32_t length = ros::serialization::serializationLength(map_bin_msg);
+  std::vector<uint8_t> buffer(length);
+  ros::serialization::OStream stream(buffer.data(), length);
+  ros::serialization::serialize(stream, map_bin_msg);
+
+  // written aside and renamed, a loader started at the same time never reads a partial file
+  std::string tmp_path = cache_path + ".tmp";
+  {
+    std::ofstream ofs(tmp_path.c_str(), std::ios::binary | std::ios::trunc);
+    ofs.write(reinterpret_cast<const char*>(&version), sizeof(version));
+    ofs.write(reinterpret_cast<const char*>(&length), sizeof(length));
+    ofs.write(reinterpret_cast<const char*>(buffer.data()), length);
+    if (!ofs)
+      return false;
+  }
+  return std::rename(tmp_path.c_str(), cache_path.c_str()) == 0;
+}
+}  // namespace
 
 int main(int argc, char** argv)
 {
@@ -42,6 +120,15 @@ int main(int argc, char** argv)
   std::string lanelet2_path;
   pnh.param<std::string>("lanelet2_path", lanelet2_path, "");
 
+  // Directory of the binary maps cached per osm file checksum, no cache when empty
+  std::string map_cache_dir;
+  pnh.param<std::string>("map_cache_dir", map_cache_dir, "");
+
+  // Also put the map image in shared memory for the nodes of this host, its name is published on
+  // /lanelet_map_bin/shared. The bin message is still published for the other hosts.
+  bool shared_map;
+  pnh.param<bool>("shared_map", shared_map, false);
+
   std::string lanelet2_file_path;
   boost::filesystem::path path(lanelet2_path);
   if (boost::filesystem::is_regular_file(path))
@@ -85,36 +172,75 @@ int main(int argc, char** argv)
 
   ROS_INFO("[lanelet2_map_loader] Will load %s", lanelet2_file_path.c_str());
 
-  lanelet::ErrorMessages errors;
-
-  lanelet::projection::MGRSProjector projector;
-  lanelet::LaneletMapPtr map = lanelet::load(lanelet2_file_path, projector, &errors);
-
-  for (const auto& error : errors)
+  std::string map_cache_path;
+  if (!map_cache_dir.empty())
   {
-    ROS_ERROR_STREAM(error);
+    boost::system::error_code ec;
+    boost::filesystem::create_directories(map_cache_dir, ec);
+    char checksum[17];
+    snprintf(checksum, sizeof(checksum), "%016llx",
+             static_cast<unsigned long long>(computeMapChecksum(lanelet2_file_path)));
+    if (!ec)
+      map_cache_path = map_cache_dir + "/" + checksum + ".bin";
   }
-  if (!errors.empty())
+
+  ros::Publisher map_bin_pub = nh.advertise<autoware_lanelet2_msgs::MapBin>("/lanelet_map_bin", 1, true);
+  autoware_lanelet2_msgs::MapBin map_bin_msg;
+  if (!map_cache_path.empty() && loadMapCache(map_cache_path, map_bin_msg))
   {
-    return EXIT_FAILURE;
+    ROS_INFO("[lanelet2_map_loader] Loaded %s from %s", lanelet2_file_path.c_str(), map_cache_path.c_str());
   }
+  else
+  {
+    lanelet::ErrorMessages errors;
 
-  lanelet::utils::overwriteLaneletsCenterline(map, false);
+    lanelet::projection::MGRSProjector projector;
+    lanelet::LaneletMapPtr map = lanelet::load(lanelet2_file_path, projector, &errors);
 
-  std::string format_version, map_version;
-  lanelet::io_handlers::AutowareOsmParser::parseVersions(lanelet2_file_path, &format_version, &map_version);
+    for (const auto& error : errors)
+    {
+      ROS_ERROR_STREAM(error);
+    }
+    if (!errors.empty())
+    {
+      return EXIT_FAILURE;
+    }
 
-  ros::Publisher map_bin_pub = nh.advertise<autoware_lanelet2_msgs::MapBin>("/lanelet_map_bin", 1, true);
-  autoware_lanelet2_msgs::MapBin map_bin_msg;
+    lanelet::utils::overwriteLaneletsCenterline(map, false);
+
+    std::string format_version, map_version;
+    lanelet::io_handlers::AutowareOsmParser::parseVersions(lanelet2_file_path, &format_version, &map_version);
+
+    map_bin_msg.format_version = format_version;
+    map_bin_msg.map_version = map_version;
+    lanelet::utils::conversion::toBinMsg(map, &map_bin_msg);
+
+    if (!map_cache_path.empty() && !saveMapCache(map_cache_path, map_bin_msg))
+      ROS_WARN("[lanelet2_map_loader] Failed to write %s", map_cache_path.c_str());
+  }
   map_bin_msg.header.stamp = ros::Time::now();
   map_bin_msg.header.frame_id = "map";
-  map_bin_msg.format_version = format_version;
-  map_bin_msg.map_version = map_version;
-  lanelet::utils::conversion::toBinMsg(map, &map_bin_msg);
 
   map_bin_pub.publish(map_bin_msg);
 
+  std::string shared_map_name;
+  ros::Publisher shared_map_pub;
+  if (shared_map)
+  {
+    shared_map_name = lanelet::utils::conversion::toSharedMap(map_bin_msg);
+    if (!shared_map_name.empty())
+    {
+      shared_map_pub = nh.advertise<std_msgs::String>("/lanelet_map_bin/shared", 1, true);
+      std_msgs::String shared_map_msg;
+      shared_map_msg.data = shared_map_name;
+      shared_map_pub.publish(shared_map_msg);
+      ROS_INFO("[lanelet2_map_loader] Shared map image %s", shared_map_name.c_str());
+    }
+  }
+
   ros::spin();
 
+  lanelet::utils::conversion::removeSharedMap(shared_map_name);
+
   return 0;
 }
@@ -21,19 +21,61 @@
 
 #include <visualization_msgs/MarkerArray.h>
 
+#include <geometry_msgs/PoseStamped.h>
 #include <lanelet2_projection/UTM.h>
 #include <lanelet2_core/LaneletMap.h>
+#include <lanelet2_core/geometry/Lanelet.h>
 #include <autoware_lanelet2_msgs/MapBin.h>
+#include <std_msgs/String.h>
 
 #include <lanelet2_extension/utility/message_conversion.h>
 #include <lanelet2_extension/utility/query.h>
 #include <lanelet2_extension/visualization/visualization.h>
 #include <lanelet2_extension/regulatory_elements/autoware_traffic_light.h>
 
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
 #include <vector>
 
 static bool g_viz_lanelets_centerline = true;
+static bool g_batch_line_markers = false;
 static ros::Publisher g_map_pub;
+static ros::Subscriber g_bin_map_sub;
+// with use_shared_map, /lanelet_map_bin is subscribed too when no shared map is attached after a timeout
+static bool g_is_shared_map_attached = false;
+static ros::WallTimer g_shared_map_timer;
+// triangles of lanelets stay valid when the same map is received again
+static lanelet::visualization::LaneletTriangleCache g_triangle_cache;
+// markers of traffic lights, built again for each map
+static lanelet::visualization::TrafficLightMarkerCache g_tl_marker_cache;
+static std_msgs::ColorRGBA g_cl_road, g_cl_cross, g_cl_ll_borders, g_cl_tl_stoplines, g_cl_ss_stoplines,
+    g_cl_trafficlights;
+
+// viewport mode: only the lanelets within g_viewport_radius of the ego pose are published
+static double g_viewport_radius = 0.0;
+static double g_viewport_update_distance = 0.0;
+static lanelet::LaneletMapPtr g_viewport_map;
+static std::unique_ptr<lanelet::utils::query::QueryContext> g_viewport_context;
+static bool g_has_ego_position = false;
+static lanelet::BasicPoint2d g_ego_position;
+static bool g_has_viewport_position = false;
+static lanelet::BasicPoint2d g_viewport_position;
+static int g_next_marker_id = 0;
+
+enum ViewportItemType
+{
+  ROAD_LANELET,
+  CROSSWALK_LANELET,
+  TRAFFIC_LIGHT_STOP_LINE,
+  STOP_SIGN_STOP_LINE,
+  TRAFFIC_LIGHT
+};
+typedef std::pair<ViewportItemType, lanelet::Id> ViewportItem;
+// namespace and id of the markers published for each item in the viewport
+static std::map<ViewportItem, std::vector<std::pair<std::string, int>>> g_viewport_markers;
 
 void insertMarkerArray(visualization_msgs::MarkerArray* a1, const visualization_msgs::MarkerArray& a2)
 {
@@ -48,11 +90,161 @@ void setColor(std_msgs::ColorRGBA* cl, double r, double g, double b, double a)
   cl->a = a;
 }
 
-void binMapCallback(autoware_lanelet2_msgs::MapBin msg)
+void setMapColors()
 {
-  lanelet::LaneletMapPtr viz_lanelet_map(new lanelet::LaneletMap);
+  setColor(&g_cl_road, 0.2, 0.7, 0.7, 0.3);
+  setColor(&g_cl_cross, 0.2, 0.7, 0.2, 0.3);
+  setColor(&g_cl_ll_borders, 1.0, 1.0, 1.0, 1.0);
+  setColor(&g_cl_tl_stoplines, 1.0, 0.5, 0.0, 0.5);
+  setColor(&g_cl_ss_stoplines, 1.0, 0.0, 0.0, 0.5);
+  setColor(&g_cl_trafficlights, 0.7, 0.7, 0.7, 0.8);
+}
+
+visualization_msgs::MarkerArray roadLaneletMarkers(const lanelet::ConstLanelet& ll)
+{
+  visualization_msgs::MarkerArray marker_array;
+  lanelet::ConstLanelets lanelets{ ll };
+  insertMarkerArray(&marker_array, lanelet::visualization::laneletsBoundaryAsMarkerArray(
+    lanelets, g_cl_ll_borders, g_viz_lanelets_centerline, g_batch_line_markers));
+  insertMarkerArray(&marker_array, lanelet::visualization::laneletsAsTriangleMarkerArray(
+    "road_lanelets", lanelets, g_cl_road, &g_triangle_cache));
+  insertMarkerArray(&marker_array, lanelet::visualization::laneletDirectionAsMarkerArray(lanelets));
+  return marker_array;
+}
+
+void updateViewport(const lanelet::BasicPoint2d& position)
+{
+  g_has_viewport_position = true;
+  g_viewport_position = position;
+
+  // items within the radius
+  const lanelet::BasicPoint2d offset(g_viewport_radius, g_viewport_radius);
+  const lanelet::BasicPoint2d min_corner = position - offset;
+  const lanelet::BasicPoint2d max_corner = position + offset;
+  lanelet::ConstLanelets viewport_lanelets;
+  for (const auto& ll : g_viewport_map->laneletLayer.search(lanelet::BoundingBox2d(min_corner, max_corner)))
+  {
+    if (lanelet::geometry::distance2d(ll, position) <= g_viewport_radius)
+    {
+      viewport_lanelets.push_back(ll);
+    }
+  }
+  lanelet::ConstLanelets road_lanelets = lanelet::utils::query::roadLanelets(viewport_lanelets);
+  lanelet::ConstLanelets crosswalk_lanelets = lanelet::utils::query::crosswalkLanelets(viewport_lanelets);
+
+  // builds the markers of each item, only called when the item enters the viewport
+  std::map<ViewportItem, std::function<visualization_msgs::MarkerArray()>> items;
+  for (const auto& ll : road_lanelets)
+  {
+    items[ViewportItem(ROAD_LANELET, ll.id())] = [ll]() { return roadLaneletMarkers(ll); };
+  }
+  for (const auto& ll : crosswalk_lanelets)
+  {
+    items[ViewportItem(CROSSWALK_LANELET, ll.id())] = [ll]() {
+      return lanelet::visualization::laneletsAsTriangleMarkerArray("crosswalk_lanelets", { ll }, g_cl_cross,
+                                                                   &g_triangle_cache);
+    };
+  }
+  for (const auto& ls : g_viewport_context->getTrafficLightStopLines(road_lanelets))
+  {
+    items[ViewportItem(TRAFFIC_LIGHT_STOP_LINE, ls.id())] = [ls]() {
+      return lanelet::visualization::lineStringsAsMarkerArray({ ls }, "traffic_light_stop_lines", g_cl_tl_stoplines,
+                                                              0.5, g_batch_line_markers);
+    };
+  }
+  for (const auto& ls : g_viewport_context->getStopSignStopLines(road_lanelets))
+  {
+    items[ViewportItem(STOP_SIGN_STOP_LINE, ls.id())] = [ls]() {
+      return lanelet::visualization::lineStringsAsMarkerArray({ ls }, "stop_sign_stop_lines", g_cl_ss_stoplines, 0.5,
+                                                              g_batch_line_markers);
+    };
+  }
+  for (const auto& tl : g_viewport_context->autowareTrafficLights(viewport_lanelets))
+  {
+    items[ViewportItem(TRAFFIC_LIGHT, tl->id())] = [tl]() {
+      return g_tl_marker_cache.markers({ tl }, g_cl_trafficlights);
+    };
+  }
+
+  visualization_msgs::MarkerArray marker_array;
+
+  // delete markers of items which left the viewport
+  for (auto it = g_viewport_markers.begin(); it != g_viewport_markers.end();)
+  {
+    if (items.count(it->first) > 0)
+    {
+      ++it;
+      continue;
+    }
+    for (const auto& ns_id : it->second)
+    {
+      visualization_msgs::Marker marker;
+      marker.header.frame_id = "map";
+      marker.ns = ns_id.first;
+      marker.id = ns_id.second;
+      marker.action = visualization_msgs::Marker::DELETE;
+      marker_array.markers.push_back(marker);
+    }
+    it = g_viewport_markers.erase(it);
+  }
+
+  // add markers of items which entered the viewport, marker ids are unique across all items
+  for (const auto& item : items)
+  {
+    if (g_viewport_markers.count(item.first) > 0)
+      continue;
+    auto& ns_ids = g_viewport_markers[item.first];
+    for (auto& marker : item.second().markers)
+    {
+      marker.id = g_next_marker_id++;
+      ns_ids.emplace_back(marker.ns, marker.id);
+      marker_array.markers.push_back(marker);
+    }
+  }
+
+  if (!marker_array.markers.empty())
+    g_map_pub.publish(marker_array);
+}
+
+void clearViewport()
+{
+  visualization_msgs::MarkerArray marker_array;
+  visualization_msgs::Marker marker;
+  marker.header.frame_id = "map";
+  marker.action = visualization_msgs::Marker::DELETEALL;
+  marker_array.markers.push_back(marker);
+  g_map_pub.publish(marker_array);
+
+  g_viewport_markers.clear();
+  g_has_viewport_position = false;
+}
+
+void egoPoseCallback(const geometry_msgs::PoseStamped& msg)
+{
+  g_has_ego_position = true;
+  g_ego_position = lanelet::BasicPoint2d(msg.pose.position.x, msg.pose.position.y);
+  if (!g_viewport_map)
+    return;
+  if (g_has_viewport_position && (g_ego_position - g_viewport_position).norm() < g_viewport_update_distance)
+    return;
+  updateViewport(g_ego_position);
+}
+
+void visualizeMap(const lanelet::LaneletMapPtr& viz_lanelet_map)
+{
+  g_tl_marker_cache.clear();
+
+  if (g_viewport_radius > 0.0)
+  {
+    ROS_INFO("Map loaded, visualizing lanelets within %.1f m of the ego pose", g_viewport_radius);
+    clearViewport();
+    g_viewport_map = viz_lanelet_map;
+    g_viewport_context.reset(new lanelet::utils::query::QueryContext(g_viewport_map));
+    if (g_has_ego_position)
+      updateViewport(g_ego_position);
+    return;
+  }
 
-  lanelet::utils::conversion::fromBinMsg(msg, viz_lanelet_map);
   ROS_INFO("Map loaded");
 
   // get lanelets etc to visualize
@@ -66,30 +258,21 @@ void binMapCallback(autoware_lanelet2_msgs::MapBin msg)
   std::vector<lanelet::AutowareTrafficLightConstPtr> aw_tl_reg_elems =
       lanelet::utils::query::autowareTrafficLights(all_lanelets);
 
-  std_msgs::ColorRGBA cl_road, cl_cross, cl_ll_borders, cl_tl_stoplines, cl_ss_stoplines, cl_trafficlights;
-  setColor(&cl_road, 0.2, 0.7, 0.7, 0.3);
-  setColor(&cl_cross, 0.2, 0.7, 0.2, 0.3);
-  setColor(&cl_ll_borders, 1.0, 1.0, 1.0, 1.0);
-  setColor(&cl_tl_stoplines, 1.0, 0.5, 0.0, 0.5);
-  setColor(&cl_ss_stoplines, 1.0, 0.0, 0.0, 0.5);
-  setColor(&cl_trafficlights, 0.7, 0.7, 0.7, 0.8);
-
   visualization_msgs::MarkerArray map_marker_array;
 
   insertMarkerArray(&map_marker_array, lanelet::visualization::laneletsBoundaryAsMarkerArray(
-    road_lanelets, cl_ll_borders, g_viz_lanelets_centerline));
+    road_lanelets, g_cl_ll_borders, g_viz_lanelets_centerline, g_batch_line_markers));
   insertMarkerArray(&map_marker_array, lanelet::visualization::laneletsAsTriangleMarkerArray(
-    "road_lanelets", road_lanelets, cl_road));
+    "road_lanelets", road_lanelets, g_cl_road, &g_triangle_cache));
   insertMarkerArray(&map_marker_array, lanelet::visualization::laneletsAsTriangleMarkerArray(
-    "crosswalk_lanelets", crosswalk_lanelets, cl_cross));
+    "crosswalk_lanelets", crosswalk_lanelets, g_cl_cross, &g_triangle_cache));
   insertMarkerArray(&map_marker_array, lanelet::visualization::laneletDirectionAsMarkerArray(
     road_lanelets));
   insertMarkerArray(&map_marker_array, lanelet::visualization::lineStringsAsMarkerArray(
-    tl_stop_lines, "traffic_light_stop_lines", cl_tl_stoplines, 0.5));
+    tl_stop_lines, "traffic_light_stop_lines", g_cl_tl_stoplines, 0.5, g_batch_line_markers));
   insertMarkerArray(&map_marker_array, lanelet::visualization::lineStringsAsMarkerArray(
-    ss_stop_lines, "stop_sign_stop_lines", cl_ss_stoplines, 0.5));
-  insertMarkerArray(&map_marker_array, lanelet::visualization::autowareTrafficLightsAsMarkerArray(
-    aw_tl_reg_elems, cl_trafficlights));
+    ss_stop_lines, "stop_sign_stop_lines", g_cl_ss_stoplines, 0.5, g_batch_line_markers));
+  insertMarkerArray(&map_marker_array, g_tl_marker_cache.markers(aw_tl_reg_elems, g_cl_trafficlights));
 
   ROS_INFO("Visualizing lanelet2 map with %lu lanelets, %lu stop lines, and %lu traffic lights",
     all_lanelets.size(), tl_stop_lines.size() + ss_stop_lines.size(), aw_tl_reg_elems.size());
@@ -97,14 +280,89 @@ void binMapCallback(autoware_lanelet2_msgs::MapBin msg)
   g_map_pub.publish(map_marker_array);
 }
 
+void binMapCallback(autoware_lanelet2_msgs::MapBin msg)
+{
+  lanelet::LaneletMapPtr viz_lanelet_map(new lanelet::LaneletMap);
+  lanelet::utils::conversion::fromBinMsg(msg, viz_lanelet_map);
+  visualizeMap(viz_lanelet_map);
+}
+
+void subscribeBinMap()
+{
+  if (!g_bin_map_sub)
+  {
+    ros::NodeHandle rosnode;
+    g_bin_map_sub = rosnode.subscribe("/lanelet_map_bin", 1, binMapCallback);
+  }
+}
+
+void sharedMapCallback(const std_msgs::String& msg)
+{
+  lanelet::LaneletMapPtr viz_lanelet_map(new lanelet::LaneletMap);
+  if (lanelet::utils::conversion::fromSharedMap(msg.data, viz_lanelet_map))
+  {
+    g_is_shared_map_attached = true;
+    g_shared_map_timer.stop();
+    g_bin_map_sub.shutdown();
+    visualizeMap(viz_lanelet_map);
+  }
+  else if (!g_bin_map_sub)
+  {
+    // loader on another host
+    ROS_INFO("Shared map %s not available, waiting for /lanelet_map_bin", msg.data.c_str());
+    subscribeBinMap();
+  }
+}
+
+void sharedMapTimerCallback(const ros::WallTimerEvent& event)
+{
+  // loader without shared_map, or its segment could not be created
+  if (!g_is_shared_map_attached && !g_bin_map_sub)
+  {
+    ROS_INFO("No shared map announced, waiting for /lanelet_map_bin");
+    subscribeBinMap();
+  }
+}
+
 int main(int argc, char** argv)
 {
   ros::init(argc, argv, "lanelet_map_visualizer");
   ros::NodeHandle rosnode;
-  ros::Subscriber bin_map_sub;
+  ros::NodeHandle private_nh("~");
+  ros::Subscriber shared_map_sub;
+  ros::Subscriber ego_pose_sub;
+
+  setMapColors();
+
+  // one LINE_LIST marker per kind of line instead of one LINE_STRIP marker per line
+  private_nh.param<bool>("batch_line_markers", g_batch_line_markers, false);
+
+  // read the map image shared by lanelet2_map_loader and subscribe to /lanelet_map_bin only if it is not on this host
+  // or if none is announced within shared_map_timeout seconds
+  bool use_shared_map;
+  private_nh.param<bool>("use_shared_map", use_shared_map, false);
+
+  double shared_map_timeout;
+  private_nh.param<double>("shared_map_timeout", shared_map_timeout, 2.0);
+
+  if (use_shared_map)
+  {
+    shared_map_sub = rosnode.subscribe("/lanelet_map_bin/shared", 1, sharedMapCallback);
+    g_shared_map_timer = rosnode.createWallTimer(ros::WallDuration(shared_map_timeout), sharedMapTimerCallback, true);
+  }
+  else
+    g_bin_map_sub = rosnode.subscribe("/lanelet_map_bin", 1, binMapCallback);
+
+  // publish only the lanelets around the ego pose and update them as it moves, whole map if 0
+  std::string ego_pose_topic;
+  private_nh.param<double>("viewport_radius", g_viewport_radius, 0.0);
+  private_nh.param<double>("viewport_update_distance", g_viewport_update_distance, 10.0);
+  private_nh.param<std::string>("ego_pose_topic", ego_pose_topic, "/current_pose");
+  if (g_viewport_radius > 0.0)
+    ego_pose_sub = rosnode.subscribe(ego_pose_topic, 1, egoPoseCallback);
 
-  bin_map_sub = rosnode.subscribe("/lanelet_map_bin", 1, binMapCallback);
-  g_map_pub = rosnode.advertise<visualization_msgs::MarkerArray>("lanelet2_map_viz", 1, true);
+  // latched for the whole map only, a latched viewport update would hold just the last increment
+  g_map_pub = rosnode.advertise<visualization_msgs::MarkerArray>("lanelet2_map_viz", 1, g_viewport_radius <= 0.0);
 
   ros::spin();
 
@@ -0,0 +1,103 @@
+/*
+ * Copyright 2015-2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Converts .pcd files to .pct tiles next to them, points_map_loader then loads the tiles instead of the pcd files.
+// usage: pcd_tile_converter [--lz4] <pcd file or directory>...
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <boost/filesystem.hpp>
+
+#include <pcl/io/pcd_io.h>
+
+#include "map_file/pcd_tile.h"
+
+namespace
+{
+bool is_pcd(const boost::filesystem::path& path)
+{
+  return boost::filesystem::is_regular_file(path) && path.extension() == ".pcd";
+}
+
+bool convert(const std::string& pcd_path, bool compress)
+{
+  sensor_msgs::PointCloud2 cloud;
+  if (pcl::io::loadPCDFile(pcd_path, cloud) == -1)
+  {
+    std::cerr << "Failed to load: " << pcd_path << std::endl;
+    return false;
+  }
+
+  std::string tile_path = map_file::getPcdTilePath(pcd_path);
+  if (!map_file::writePcdTile(tile_path, cloud, compress))
+  {
+    std::cerr << "Failed to write: " << tile_path << std::endl;
+    return false;
+  }
+  std::cout << "Converted " << pcd_path << " to " << tile_path << std::endl;
+  return true;
+}
+}  // namespace
+
+int main(int argc, char** argv)
+{
+  bool compress = false;
+  std::vector<std::string> pcd_paths;
+  for (int i = 1; i < argc; ++i)
+  {
+    std::string arg(argv[i]);
+    if (arg == "--lz4")
+    {
+      compress = true;
+      continue;
+    }
+
+    boost::filesystem::path path(arg);
+    if (is_pcd(path))
+    {
+      pcd_paths.push_back(arg);
+    }
+    else if (boost::filesystem::is_directory(path))
+    {
+      for (const boost::filesystem::path& entry :
+           boost::make_iterator_range(boost::filesystem::recursive_directory_iterator(path), {}))
+      {
+        if (is_pcd(entry))
+          pcd_paths.push_back(entry.generic_string());
+      }
+    }
+    else
+    {
+      std::cerr << "Not a pcd file or directory: " << arg << std::endl;
+    }
+  }
+
+  if (pcd_paths.empty())
+  {
+    std::cerr << "usage: pcd_tile_converter [--lz4] <pcd file or directory>..." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  int failures = 0;
+  for (const std::string& pcd_path : pcd_paths)
+  {
+    if (!convert(pcd_path, compress))
+      ++failures;
+  }
+
+  return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -34,21 +34,44 @@
 
 #include <map_file/points_map_filter.h>
 
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <set>
+
 points_map_filter::points_map_filter(ros::NodeHandle nh, ros::NodeHandle pnh) {
   map_cloud_ =
       pcl::PointCloud<pcl::PointXYZ>::Ptr(new pcl::PointCloud<pcl::PointXYZ>());
   nh_ = nh;
   pnh_ = pnh;
+  shutdown_ = false;
 }
 
-points_map_filter::~points_map_filter() {}
+points_map_filter::~points_map_filter() {
+  {
+    std::lock_guard<std::mutex> lock(request_mtx_);
+    shutdown_ = true;
+  }
+  request_cv_.notify_all();
+  if (worker_.joinable())
+    worker_.join();
+}
 
 void points_map_filter::init() {
   std::lock_guard<std::mutex> lock(mtx_);
   pnh_.param("load_grid_size", load_grid_size_, 100.0);
   pnh_.param("load_trigger_distance", load_trigger_distance_, 20.0);
+  pnh_.param("bucket_size", bucket_size_, 10.0);
   pnh_.param("map_frame", map_frame_, std::string("map"));
-  last_load_pose_ = boost::none;
+  pnh_.param("sliding_window", sliding_window_, false);
+  pnh_.param("publish_diff", publish_diff_, false);
+  if (bucket_size_ <= 0)
+    bucket_size_ = 10.0;
+  {
+    std::lock_guard<std::mutex> request_lock(request_mtx_);
+    last_load_pose_ = boost::none;
+    requested_pose_ = boost::none;
+  }
   map_sub_.shutdown();
   pose_sub_.shutdown();
   map_recieved_ = false;
@@ -59,75 +82,237 @@ void points_map_filter::run() {
   std::lock_guard<std::mutex> lock(mtx_);
   map_pub_ =
       nh_.advertise<sensor_msgs::PointCloud2>("/points_map/filtered", 10);
+  if (sliding_window_ && publish_diff_) {
+    entering_pub_ = nh_.advertise<sensor_msgs::PointCloud2>(
+        "/points_map/filtered/entering", 10);
+    leaving_pub_ = nh_.advertise<sensor_msgs::PointCloud2>(
+        "/points_map/filtered/leaving", 10);
+  }
   map_sub_ =
       nh_.subscribe("/points_map", 1, &points_map_filter::map_callback_, this);
   pose_sub_ = nh_.subscribe("/current_pose", 1,
                             &points_map_filter::current_pose_callback_, this);
+  if (!worker_.joinable())
+    worker_ = std::thread(&points_map_filter::worker_loop_, this);
   return;
 }
 
+int64_t points_map_filter::bucket_key_(int64_t ix, int64_t iy) const {
+  return (ix << 32) ^ (iy & 0xffffffff);
+}
+
+void points_map_filter::build_buckets_(
+    const pcl::PointCloud<pcl::PointXYZ> &cloud) {
+  std::vector<size_t> points;
+  std::vector<int64_t> keys;
+  points.reserve(cloud.size());
+  keys.reserve(cloud.size());
+  for (size_t i = 0; i < cloud.size(); ++i) {
+    const pcl::PointXYZ &p = cloud[i];
+    if (!std::isfinite(p.x) || !std::isfinite(p.y) || !std::isfinite(p.z))
+      continue;
+    points.push_back(i);
+    keys.push_back(
+        bucket_key_(static_cast<int64_t>(std::floor(p.x / bucket_size_)),
+                    static_cast<int64_t>(std::floor(p.y / bucket_size_))));
+  }
+  std::vector<size_t> order(points.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(),
+                   [&keys](size_t a, size_t b) { return keys[a] < keys[b]; });
+
+  map_cloud_->clear();
+  map_cloud_->reserve(order.size());
+  buckets_.clear();
+  for (size_t i = 0; i < order.size(); ++i) {
+    map_cloud_->push_back(cloud[points[order[i]]]);
+    std::pair<size_t, size_t> &range =
+        buckets_.emplace(keys[order[i]], std::make_pair(i, i)).first->second;
+    range.second = i + 1;
+  }
+}
+
+void points_map_filter::buckets_in_square_(
+    double x, double y, std::vector<int64_t> &keys) const {
+  int64_t ix_min = static_cast<int64_t>(
+      std::floor((x - (load_grid_size_ / 2)) / bucket_size_));
+  int64_t ix_max = static_cast<int64_t>(
+      std::floor((x + (load_grid_size_ / 2)) / bucket_size_));
+  int64_t iy_min = static_cast<int64_t>(
+      std::floor((y - (load_grid_size_ / 2)) / bucket_size_));
+  int64_t iy_max = static_cast<int64_t>(
+      std::floor((y + (load_grid_size_ / 2)) / bucket_size_));
+
+  keys.clear();
+  double cells =
+      static_cast<double>(ix_max - ix_min + 1) * (iy_max - iy_min + 1);
+  if (cells > buckets_.size()) {
+    for (const auto &bucket : buckets_) {
+      int64_t ix = bucket.first >> 32;
+      int64_t iy = static_cast<int32_t>(bucket.first & 0xffffffff);
+      if (ix_min <= ix && ix <= ix_max && iy_min <= iy && iy <= iy_max)
+        keys.push_back(bucket.first);
+    }
+  } else {
+    for (int64_t ix = ix_min; ix <= ix_max; ++ix) {
+      for (int64_t iy = iy_min; iy <= iy_max; ++iy) {
+        if (buckets_.count(bucket_key_(ix, iy)) != 0)
+          keys.push_back(bucket_key_(ix, iy));
+      }
+    }
+  }
+  // same order as map_cloud_
+  std::sort(keys.begin(), keys.end());
+}
+
+void points_map_filter::append_bucket_(
+    int64_t key, pcl::PointCloud<pcl::PointXYZ> &cloud) const {
+  const std::pair<size_t, size_t> &range = buckets_.at(key);
+  cloud.points.insert(cloud.points.end(),
+                      map_cloud_->points.begin() + range.first,
+                      map_cloud_->points.begin() + range.second);
+}
+
+void points_map_filter::extract_submap_(
+    double x, double y, pcl::PointCloud<pcl::PointXYZ> &submap) const {
+  double x_min = x - (load_grid_size_ / 2);
+  double x_max = x + (load_grid_size_ / 2);
+  double y_min = y - (load_grid_size_ / 2);
+  double y_max = y + (load_grid_size_ / 2);
+  std::vector<int64_t> keys;
+  buckets_in_square_(x, y, keys);
+
+  // buckets inside the square are copied whole, only the border ones are
+  // filtered point by point
+  submap.clear();
+  for (int64_t key : keys) {
+    int64_t ix = key >> 32;
+    int64_t iy = static_cast<int32_t>(key & 0xffffffff);
+    bool inside = ix * bucket_size_ >= x_min &&
+                  (ix + 1) * bucket_size_ <= x_max &&
+                  iy * bucket_size_ >= y_min &&
+                  (iy + 1) * bucket_size_ <= y_max;
+    if (inside) {
+      append_bucket_(key, submap);
+      continue;
+    }
+    const std::pair<size_t, size_t> &range = buckets_.at(key);
+    for (size_t i = range.first; i < range.second; ++i) {
+      const pcl::PointXYZ &p = (*map_cloud_)[i];
+      if (x_min <= p.x && p.x <= x_max && y_min <= p.y && p.y <= y_max)
+        submap.points.push_back(p);
+    }
+  }
+  submap.width = submap.points.size();
+  submap.height = 1;
+  submap.is_dense = true;
+}
+
+void points_map_filter::update_window_(
+    double x, double y, pcl::PointCloud<pcl::PointXYZ> &submap,
+    pcl::PointCloud<pcl::PointXYZ> &entering,
+    pcl::PointCloud<pcl::PointXYZ> &leaving) {
+  std::vector<int64_t> keys;
+  buckets_in_square_(x, y, keys);
+  std::set<int64_t> window(keys.begin(), keys.end());
+
+  submap.clear();
+  entering.clear();
+  leaving.clear();
+  for (int64_t key : window) {
+    append_bucket_(key, submap);
+    if (window_buckets_.count(key) == 0)
+      append_bucket_(key, entering);
+  }
+  for (int64_t key : window_buckets_) {
+    if (window.count(key) == 0)
+      append_bucket_(key, leaving);
+  }
+  window_buckets_.swap(window);
+
+  for (pcl::PointCloud<pcl::PointXYZ> *cloud :
+       {&submap, &entering, &leaving}) {
+    cloud->width = cloud->points.size();
+    cloud->height = 1;
+    cloud->is_dense = true;
+  }
+}
+
+void points_map_filter::publish_cloud_(
+    const ros::Publisher &pub, const pcl::PointCloud<pcl::PointXYZ> &cloud,
+    const ros::Time &stamp) {
+  // published by pointer, subscribers in the same process receive it without
+  // serialization
+  sensor_msgs::PointCloud2::Ptr msg(new sensor_msgs::PointCloud2);
+  pcl::toROSMsg(cloud, *msg);
+  msg->header.frame_id = map_frame_;
+  msg->header.stamp = stamp;
+  pub.publish(msg);
+}
+
+void points_map_filter::worker_loop_() {
+  while (true) {
+    geometry_msgs::PoseStamped pose;
+    {
+      std::unique_lock<std::mutex> lock(request_mtx_);
+      request_cv_.wait(lock, [this] { return shutdown_ || requested_pose_; });
+      if (shutdown_)
+        return;
+      pose = requested_pose_.get();
+      requested_pose_ = boost::none;
+    }
+    pcl::PointCloud<pcl::PointXYZ> cloud_filtered, entering, leaving;
+    {
+      std::lock_guard<std::mutex> lock(mtx_);
+      if (sliding_window_)
+        update_window_(pose.pose.position.x, pose.pose.position.y,
+                       cloud_filtered, entering, leaving);
+      else
+        extract_submap_(pose.pose.position.x, pose.pose.position.y,
+                        cloud_filtered);
+    }
+    ROS_INFO_STREAM("update map");
+    publish_cloud_(map_pub_, cloud_filtered, pose.header.stamp);
+    if (sliding_window_ && publish_diff_) {
+      publish_cloud_(entering_pub_, entering, pose.header.stamp);
+      publish_cloud_(leaving_pub_, leaving, pose.header.stamp);
+    }
+  }
+}
+
 void points_map_filter::map_callback_(
     const sensor_msgs::PointCloud2::ConstPtr msg) {
-  std::lock_guard<std::mutex> lock(mtx_);
   ROS_INFO_STREAM("loading map started.");
-  pcl::fromROSMsg(*msg, *map_cloud_);
-  map_recieved_ = true;
-  map_pub_.publish(*msg);
+  pcl::PointCloud<pcl::PointXYZ> cloud;
+  pcl::fromROSMsg(*msg, cloud);
+  {
+    std::lock_guard<std::mutex> lock(mtx_);
+    build_buckets_(cloud);
+    window_buckets_.clear();
+    map_recieved_ = true;
+  }
+  map_pub_.publish(msg);
   ROS_INFO_STREAM("loading map finished");
   return;
 }
 
 void points_map_filter::current_pose_callback_(
     const geometry_msgs::PoseStamped::ConstPtr msg) {
-  std::lock_guard<std::mutex> lock(mtx_);
   ROS_INFO_STREAM("pose received");
-  if (!last_load_pose_ && map_recieved_) {
-    last_load_pose_ = *msg;
-    pcl::PointCloud<pcl::PointXYZ>::Ptr cloud_filtered(
-        new pcl::PointCloud<pcl::PointXYZ>);
-    pass_.setInputCloud(map_cloud_);
-    pass_.setFilterFieldName("x");
-    pass_.setFilterLimits(
-        last_load_pose_.get().pose.position.x - (load_grid_size_ / 2),
-        last_load_pose_.get().pose.position.x + (load_grid_size_ / 2));
-    pass_.filter(*cloud_filtered);
-    pass_.setInputCloud(cloud_filtered);
-    pass_.setFilterFieldName("y");
-    pass_.setFilterLimits(
-        last_load_pose_.get().pose.position.y - (load_grid_size_ / 2),
-        last_load_pose_.get().pose.position.y + (load_grid_size_ / 2));
-    pass_.filter(*cloud_filtered);
-    sensor_msgs::PointCloud2 msg;
-    pcl::toROSMsg(*cloud_filtered, msg);
-    ROS_INFO_STREAM("update map");
-    map_pub_.publish(msg);
-  } else if (last_load_pose_ && map_recieved_) {
+  if (!map_recieved_)
+    return;
+  std::lock_guard<std::mutex> lock(request_mtx_);
+  if (last_load_pose_) {
     double dist = std::sqrt(
         std::pow(last_load_pose_.get().pose.position.x - msg->pose.position.x,
                  2) +
         std::pow(last_load_pose_.get().pose.position.y - msg->pose.position.y,
                  2));
-    if (dist > load_trigger_distance_) {
-      last_load_pose_ = *msg;
-      pcl::PointCloud<pcl::PointXYZ>::Ptr cloud_filtered(
-          new pcl::PointCloud<pcl::PointXYZ>);
-      pass_.setInputCloud(map_cloud_);
-      pass_.setFilterFieldName("x");
-      pass_.setFilterLimits(
-          last_load_pose_.get().pose.position.x - (load_grid_size_ / 2),
-          last_load_pose_.get().pose.position.x + (load_grid_size_ / 2));
-      pass_.filter(*cloud_filtered);
-      pass_.setInputCloud(cloud_filtered);
-      pass_.setFilterFieldName("y");
-      pass_.setFilterLimits(
-          last_load_pose_.get().pose.position.y - (load_grid_size_ / 2),
-          last_load_pose_.get().pose.position.y + (load_grid_size_ / 2));
-      pass_.filter(*cloud_filtered);
-      sensor_msgs::PointCloud2 msg;
-      pcl::toROSMsg(*cloud_filtered, msg);
-      map_pub_.publish(msg);
-      ROS_INFO_STREAM("update map");
-    }
+    if (dist <= load_trigger_distance_)
+      return;
   }
+  last_load_pose_ = *msg;
+  requested_pose_ = *msg;
+  request_cv_.notify_one();
   return;
-}
\ No newline at end of file
+}
@@ -14,37 +14,24 @@
  * limitations under the License.
  */
 
-#include <condition_variable>
-#include <queue>
-#include <thread>
+
+#include <cfloat>
+#include <cstring>
 #include <boost/filesystem.hpp>
+#include <boost/make_shared.hpp>
 
-#include <geometry_msgs/PoseWithCovarianceStamped.h>
+#include <pcl/filters/voxel_grid.h>
+#include <pcl/io/pcd_io.h>
 #include <pcl_conversions/pcl_conversions.h>
-#include <std_msgs/Bool.h>
 #include <tf/transform_listener.h>
 
-#include "autoware_msgs/LaneArray.h"
-
-#include "map_file/get_file.h"
+#include "map_file/pcd_tile.h"
+#include "map_file/points_map_loader.h"
 
-namespace
+namespace map_file
 {
-class RequestQueue
+namespace points_map_loader
 {
-private:
-  std::queue<geometry_msgs::Point> queue_;  // takes priority over look_ahead_queue_
-  std::queue<geometry_msgs::Point> look_ahead_queue_;
-  std::mutex mtx_;
-  std::condition_variable cv_;
-
-public:
-  void enqueue(const geometry_msgs::Point& p);
-  void enqueue_look_ahead(const geometry_msgs::Point& p);
-  void clear_look_ahead();
-  geometry_msgs::Point dequeue();
-};
-
 void RequestQueue::enqueue(const geometry_msgs::Point& p)
 {
   std::unique_lock<std::mutex> lock(mtx_);
@@ -66,65 +53,248 @@ void RequestQueue::clear_look_ahead()
     look_ahead_queue_.pop();
 }
 
-geometry_msgs::Point RequestQueue::dequeue()
+void RequestQueue::shutdown()
+{
+  std::unique_lock<std::mutex> lock(mtx_);
+  shutdown_ = true;
+  cv_.notify_all();
+}
+
+bool RequestQueue::dequeue(geometry_msgs::Point& p)
 {
   std::unique_lock<std::mutex> lock(mtx_);
-  while (queue_.empty() && look_ahead_queue_.empty())
+  while (queue_.empty() && look_ahead_queue_.empty() && !shutdown_)
     cv_.wait(lock);
+  if (shutdown_)
+    return false;
   if (!queue_.empty())
   {
-    geometry_msgs::Point p = queue_.front();
+    p = queue_.front();
     queue_.pop();
-    return p;
   }
   else
   {
-    geometry_msgs::Point p = look_ahead_queue_.front();
+    p = look_ahead_queue_.front();
     look_ahead_queue_.pop();
-    return p;
   }
+  return true;
+}
+
+void PcdRequest::set(const geometry_msgs::Point& p)
+{
+  std::unique_lock<std::mutex> lock(mtx_);
+  point_ = p;
+  pending_ = true;
+  cv_.notify_all();
+}
+
+void PcdRequest::shutdown()
+{
+  std::unique_lock<std::mutex> lock(mtx_);
+  shutdown_ = true;
+  cv_.notify_all();
+}
+
+bool PcdRequest::wait(geometry_msgs::Point& p)
+{
+  std::unique_lock<std::mutex> lock(mtx_);
+  while (!pending_ && !shutdown_)
+    cv_.wait(lock);
+  if (shutdown_)
+    return false;
+  pending_ = false;
+  p = point_;
+  return true;
+}
+
+size_t TileCache::cloudSize(const sensor_msgs::PointCloud2& cloud)
+{
+  return sizeof(cloud) + cloud.data.size();
 }
 
-struct Area
+void TileCache::evict(size_t budget)
 {
-  std::string path;
-  double x_min;
-  double y_min;
-  double z_min;
-  double x_max;
-  double y_max;
-  double z_max;
-};
+  while (size_ > budget && !lru_.empty())
+  {
+    auto it = tiles_.find(lru_.back());
+    size_ -= it->second.size;
+    tiles_.erase(it);
+    lru_.pop_back();
+    ++evictions_;
+  }
+}
 
-typedef std::vector<Area> AreaList;
+void TileCache::setBudget(size_t bytes)
+{
+  std::unique_lock<std::mutex> lock(mtx_);
+  budget_ = bytes;
+  evict(budget_);
+}
+
+sensor_msgs::PointCloud2::ConstPtr TileCache::find(const std::string& path)
+{
+  std::unique_lock<std::mutex> lock(mtx_);
+  auto it = tiles_.find(path);
+  if (it == tiles_.end())
+  {
+    ++misses_;
+    return sensor_msgs::PointCloud2::ConstPtr();
+  }
+  ++hits_;
+  lru_.splice(lru_.begin(), lru_, it->second.lru);
+  return it->second.cloud;
+}
+
+bool TileCache::contains(const std::string& path)
+{
+  std::unique_lock<std::mutex> lock(mtx_);
+  return tiles_.count(path) != 0;
+}
+
+void TileCache::insert(const std::string& path, const sensor_msgs::PointCloud2::ConstPtr& cloud)
+{
+  std::unique_lock<std::mutex> lock(mtx_);
+  size_t size = cloudSize(*cloud);
+  if (size > budget_ || tiles_.count(path) != 0)
+    return;
+  evict(budget_ - size);
+  lru_.push_front(path);
+  tiles_[path] = { cloud, size, lru_.begin() };
+  size_ += size;
+}
+
+diagnostic_msgs::DiagnosticStatus TileCache::getStatus()
+{
+  std::unique_lock<std::mutex> lock(mtx_);
+  diagnostic_msgs::DiagnosticStatus status;
+  status.level = diagnostic_msgs::DiagnosticStatus::OK;
+  status.name = "points_map_loader: tile cache";
+  status.hardware_id = "points_map_loader";
+  status.message = std::to_string(tiles_.size()) + " tiles, " + std::to_string(size_ >> 20) + " MB";
+
+  auto add = [&status](const std::string& key, uint64_t value) {
+    diagnostic_msgs::KeyValue kv;
+    kv.key = key;
+    kv.value = std::to_string(value);
+    status.values.push_back(kv);
+  };
+  add("tiles", tiles_.size());
+  add("size_mb", size_ >> 20);
+  add("budget_mb", budget_ >> 20);
+  add("hits", hits_);
+  add("misses", misses_);
+  add("evictions", evictions_);
+  return status;
+}
+
+void LoadMetrics::add(Window& window, const std::string& path, uint64_t bytes, double seconds)
+{
+  ++window.tiles;
+  window.bytes += bytes;
+  window.seconds += seconds;
+  if (seconds > window.max_tile_seconds)
+  {
+    window.max_tile_seconds = seconds;
+    window.slowest_tile = path;
+  }
+}
+
+void LoadMetrics::recordTile(const std::string& path, uint64_t bytes, double seconds, bool loaded)
+{
+  std::unique_lock<std::mutex> lock(mtx_);
+  if (!loaded)
+  {
+    ++failures_;
+    return;
+  }
+  add(total_, path, bytes, seconds);
+  add(window_, path, bytes, seconds);
+}
+
+void LoadMetrics::recordPublish(double seconds, uint32_t points)
+{
+  std::unique_lock<std::mutex> lock(mtx_);
+  ++publishes_;
+  last_publish_seconds_ = seconds;
+  max_publish_seconds_ = std::max(max_publish_seconds_, seconds);
+  last_publish_points_ = points;
+  published_ = true;
+}
+
+diagnostic_msgs::DiagnosticStatus LoadMetrics::getStatus()
+{
+  std::unique_lock<std::mutex> lock(mtx_);
+  diagnostic_msgs::DiagnosticStatus status;
+  status.level = failures_ == 0 ? diagnostic_msgs::DiagnosticStatus::OK : diagnostic_msgs::DiagnosticStatus::WARN;
+  status.name = "points_map_loader: load";
+  status.hardware_id = "points_map_loader";
+  status.message = std::to_string(total_.tiles) + " tiles, " + std::to_string(total_.bytes >> 20) + " MB read";
+
+  auto add = [&status](const std::string& key, const std::string& value) {
+    diagnostic_msgs::KeyValue kv;
+    kv.key = key;
+    kv.value = value;
+    status.values.push_back(kv);
+  };
+  add("tiles_loaded", std::to_string(total_.tiles));
+  add("tiles_failed", std::to_string(failures_));
+  add("bytes_read", std::to_string(total_.bytes));
+  add("mean_tile_load_ms", std::to_string(total_.tiles == 0 ? 0 : total_.seconds * 1000 / total_.tiles));
+  add("max_tile_load_ms", std::to_string(total_.max_tile_seconds * 1000));
+  add("slowest_tile", total_.slowest_tile);
+  add("read_throughput_mb_s", std::to_string(total_.seconds > 0 ? total_.bytes / total_.seconds / (1 << 20) : 0));
+  add("publishes", std::to_string(publishes_));
+  add("last_publish_ms", std::to_string(last_publish_seconds_ * 1000));
+  add("max_publish_ms", std::to_string(max_publish_seconds_ * 1000));
+  add("last_publish_points", std::to_string(last_publish_points_));
+  return status;
+}
+
+void LoadMetrics::check(autoware_health_checker::HealthChecker& checker)
+{
+  Window window;
+  bool published;
+  double publish_seconds;
+  {
+    std::unique_lock<std::mutex> lock(mtx_);
+    window = window_;
+    window_ = Window();
+    published = published_;
+    published_ = false;
+    publish_seconds = last_publish_seconds_;
+  }
+
+  if (window.tiles > 0)
+  {
+    checker.CHECK_MAX_VALUE("value_points_map_tile_load_time_high", window.max_tile_seconds * 1000, 500, 2000, 10000,
+                            "slowest tile load (ms): " + window.slowest_tile);
+    if (window.seconds > 0)
+      checker.CHECK_MIN_VALUE("value_points_map_read_throughput_low", window.bytes / window.seconds / (1 << 20), 50,
+                              10, 1, "tile read throughput of a load thread (MB/s)");
+  }
+  if (published)
+    checker.CHECK_MAX_VALUE("value_points_map_publish_time_high", publish_seconds * 1000, 5000, 20000, 60000,
+                            "points_map load and publish time (ms)");
+}
+
+}  // namespace points_map_loader
+
+using namespace points_map_loader;
+
+namespace
+{
 typedef std::vector<std::vector<std::string>> Tbl;
 
 constexpr int DEFAULT_UPDATE_RATE = 1000;  // ms
+constexpr int DEFAULT_CACHE_SIZE = 1024;   // MB
+constexpr double DEFAULT_PREFETCH_TIME = 10;  // sec
+constexpr double MIN_PREFETCH_SPEED = 1;      // m/s
 constexpr double MARGIN_UNIT = 100;        // meter
 constexpr int ROUNDING_UNIT = 1000;        // meter
 const std::string AREALIST_FILENAME = "arealist.txt";
+const std::string MANIFEST_FILENAME = "manifest.txt";
 const std::string TEMPORARY_DIRNAME = "/tmp/";
 
-int update_rate;
-int fallback_rate;
-double margin;
-bool can_download;
-
-ros::Time gnss_time;
-ros::Time current_time;
-
-ros::Publisher pcd_pub;
-ros::Publisher stat_pub;
-std_msgs::Bool stat_msg;
-
-AreaList all_areas;
-AreaList downloaded_areas;
-std::mutex downloaded_areas_mtx;
-std::vector<std::string> cached_arealist_paths;
-
-GetFile gf;
-RequestQueue request_queue;
-
 Tbl read_csv(const std::string& path)
 {
   std::ifstream ifs(path.c_str());
@@ -224,7 +394,7 @@ void cache_arealist(const Area& area, AreaList& areas)
   areas.push_back(area);
 }
 
-int download(GetFile gf, const std::string& tmp, const std::string& loc, const std::string& filename)
+void create_local_directories(const std::string& tmp, const std::string& loc)
 {
   std::string pathname;
   pathname += tmp;
@@ -235,22 +405,343 @@ int download(GetFile gf, const std::string& tmp, const std::string& loc, const s
     pathname += col + "/";
     mkdir(pathname.c_str(), 0755);
   }
+}
+
+uint64_t get_file_size(const std::string& path)
+{
+  boost::system::error_code ec;
+  uintmax_t size = boost::filesystem::file_size(path, ec);
+  return ec ? 0 : size;
+}
+
+sensor_msgs::PointCloud2 downsample_pcd(const sensor_msgs::PointCloud2& cloud, double leaf_size)
+{
+  pcl::PCLPointCloud2::Ptr input(new pcl::PCLPointCloud2);
+  pcl_conversions::toPCL(cloud, *input);
+  pcl::VoxelGrid<pcl::PCLPointCloud2> voxel_grid;
+  voxel_grid.setInputCloud(input);
+  voxel_grid.setLeafSize(leaf_size, leaf_size, leaf_size);
+  pcl::PCLPointCloud2 output;
+  voxel_grid.filter(output);
+
+  sensor_msgs::PointCloud2 ret;
+  pcl_conversions::moveFromPCL(output, ret);
+  return ret;
+}
+
+// The first loaded part gives the fields, the points of the others are appended to it.
+// parts are released while they are appended, so tiles that are not cached are freed early.
+sensor_msgs::PointCloud2 concatenate_pcds(std::vector<sensor_msgs::PointCloud2::ConstPtr>& parts)
+{
+  sensor_msgs::PointCloud2 pcd;
+  size_t data_size = 0;
+  for (const sensor_msgs::PointCloud2::ConstPtr& part : parts)
+    data_size += part->data.size();
+  pcd.data.reserve(data_size);
+
+  for (sensor_msgs::PointCloud2::ConstPtr& part : parts)
+  {
+    if (part->width == 0)
+      continue;
+    if (pcd.width == 0)
+    {
+      pcd.header = part->header;
+      pcd.height = part->height;
+      pcd.width = part->width;
+      pcd.fields = part->fields;
+      pcd.is_bigendian = part->is_bigendian;
+      pcd.point_step = part->point_step;
+      pcd.row_step = part->row_step;
+      pcd.is_dense = part->is_dense;
+    }
+    else
+    {
+      pcd.width += part->width;
+      pcd.row_step += part->row_step;
+    }
+    pcd.data.insert(pcd.data.end(), part->data.begin(), part->data.end());
+    part.reset();
+  }
+
+  return pcd;
+}
+
+// The file read for path, a .pcd with an up to date .pct tile next to it is read from the tile
+std::string get_source_path(const std::string& path)
+{
+  if (!map_file::isPcdTile(path) && map_file::hasPcdTile(path))
+    return map_file::getPcdTilePath(path);
+  return path;
+}
+
+bool read_pcd_header(const std::string& path, sensor_msgs::PointCloud2& header, uint64_t& data_size)
+{
+  if (map_file::isPcdTile(path))
+    return map_file::readPcdTileHeader(path, header, data_size);
+
+  pcl::PCLPointCloud2 cloud;
+  Eigen::Vector4f origin;
+  Eigen::Quaternionf orientation;
+  int pcd_version, data_type;
+  unsigned int data_idx;
+  pcl::PCDReader reader;
+  if (reader.readHeader(path, cloud, origin, orientation, pcd_version, data_type, data_idx) != 0)
+    return false;
+  pcl_conversions::moveFromPCL(cloud, header);
+  data_size = static_cast<uint64_t>(header.width) * header.height * header.point_step;
+  return true;
+}
+
+bool has_same_layout(const sensor_msgs::PointCloud2& a, const sensor_msgs::PointCloud2& b)
+{
+  if (a.point_step != b.point_step || a.is_bigendian != b.is_bigendian || a.fields.size() != b.fields.size())
+    return false;
+  for (size_t i = 0; i < a.fields.size(); ++i)
+  {
+    if (a.fields[i].name != b.fields[i].name || a.fields[i].offset != b.fields[i].offset ||
+        a.fields[i].datatype != b.fields[i].datatype || a.fields[i].count != b.fields[i].count)
+      return false;
+  }
+  return true;
+}
+
+}  // namespace
+
+PointsMapLoader::PointsMapLoader(ros::NodeHandle nh, ros::NodeHandle pnh)
+  : nh_(nh), pnh_(pnh), current_speed_(0), running_(true)
+{
+}
+
+PointsMapLoader::~PointsMapLoader()
+{
+  running_ = false;
+  request_queue_.shutdown();
+  pcd_request_.shutdown();
+  prefetch_request_.shutdown();
+  for (std::thread* thread : { &publisher_, &prefetcher_, &downloader_ })
+  {
+    if (thread->joinable())
+      thread->join();
+  }
+}
+
+bool PointsMapLoader::init()
+{
+  // Get parameters
+  std::string area;
+  pnh_.param<std::string>("area", area, "noupdate");
+
+  std::string mode;
+  pnh_.param<std::string>("mode", mode, "");
+
+  std::vector<std::string> pcd_paths;
+  pnh_.getParam("pcd_paths", pcd_paths);
+
+  std::string arealist_path;
+  pnh_.param<std::string>("arealist_path", arealist_path, "");
+
+  pnh_.param<int>("load_threads", load_threads_, 0);
+  if (load_threads_ <= 0)
+    load_threads_ = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+
+  // Search all files in pcd_paths
+  std::vector<std::string> pcd_file_paths;
+  for (const std::string& pcd_path : pcd_paths)
+  {
+    // Search all files in each path in pcd_paths
+    boost::filesystem::path path(pcd_path);
+    if (boost::filesystem::is_regular_file(path))
+    {
+      // If file
+      pcd_file_paths.push_back(pcd_path);
+    }
+    else if (boost::filesystem::is_directory(path))
+    {
+      // If directory
+      for (const boost::filesystem::path& entry :
+           boost::make_iterator_range(boost::filesystem::recursive_directory_iterator(path), {}))
+      {
+        // The tile converted from a pcd of the directory is loaded in place of that pcd
+        if (boost::filesystem::is_regular_file(entry) &&
+            !(entry.extension() == map_file::PCD_TILE_EXTENSION &&
+              boost::filesystem::exists(boost::filesystem::path(entry).replace_extension(".pcd"))))
+        {
+          pcd_file_paths.push_back(entry.generic_string());
+        }
+      }
+    }
+  }
+
+  if (area == "noupdate")
+    margin_ = -1;
+  else if (area == "1x1")
+    margin_ = 0;
+  else if (area == "3x3")
+    margin_ = MARGIN_UNIT * 1;
+  else if (area == "5x5")
+    margin_ = MARGIN_UNIT * 2;
+  else if (area == "7x7")
+    margin_ = MARGIN_UNIT * 3;
+  else if (area == "9x9")
+    margin_ = MARGIN_UNIT * 4;
+  else
+  {
+    ROS_ERROR("[points_map_loader] parameter area is not set.");
+    return false;
+  }
+
+  if (margin_ < 0)
+  {
+    can_download_ = false;
+  }
+  else
+  {
+    if (mode == "download")
+    {
+      can_download_ = true;
+      std::string host_name;
+      pnh_.param<std::string>("host_name", host_name, HTTP_HOSTNAME);
+      int port;
+      pnh_.param<int>("port", port, HTTP_PORT);
+      std::string user;
+      pnh_.param<std::string>("user", user, HTTP_USER);
+      std::string password;
+      pnh_.param<std::string>("password", password, HTTP_PASSWORD);
+      gf_ = GetFile(host_name, port, user, password);
+      pnh_.param<int>("connections", connections_, HTTP_CONNECTIONS);
+    }
+    else
+    {
+      can_download_ = false;
+    }
+  }
+
+  pcd_pub_ = nh_.advertise<sensor_msgs::PointCloud2>("points_map", 1, true);
+  stat_pub_ = nh_.advertise<std_msgs::Bool>("pmap_stat", 1, true);
+  diag_pub_ = nh_.advertise<diagnostic_msgs::DiagnosticArray>("/diagnostics", 10);
+  health_checker_.reset(new autoware_health_checker::HealthChecker(nh_, pnh_));
+  health_checker_->ENABLE();
+
+  // Level i is published on points_map/level_<i + 1>, downsampled with the leaf size i
+  pnh_.getParam("pyramid_leaf_sizes", pyramid_leaf_sizes_);
+  pnh_.param<std::string>("pyramid_cache_dir", pyramid_cache_dir_, "");
+  pyramid_leaf_sizes_.erase(std::remove_if(pyramid_leaf_sizes_.begin(), pyramid_leaf_sizes_.end(),
+                                           [](double leaf_size) { return leaf_size <= 0; }),
+                            pyramid_leaf_sizes_.end());
+  for (size_t i = 0; i < pyramid_leaf_sizes_.size(); ++i)
+  {
+    std::string topic = "points_map/level_" + std::to_string(i + 1);
+    pyramid_pubs_.push_back(nh_.advertise<sensor_msgs::PointCloud2>(topic, 1, true));
+  }
+  if (!pyramid_cache_dir_.empty())
+  {
+    boost::system::error_code ec;
+    boost::filesystem::create_directories(pyramid_cache_dir_, ec);
+    if (ec)
+    {
+      ROS_WARN("Failed to create %s, downsampled tiles are not cached on disk", pyramid_cache_dir_.c_str());
+      pyramid_cache_dir_.clear();
+    }
+  }
+
+  stat_msg_.data = false;
+  stat_pub_.publish(stat_msg_);
+
+  if (margin_ < 0)
+  {
+    // The published map downsampled tile by tile with this leaf size while it is loaded, none when 0
+    pnh_.param<double>("lod_leaf_size", lod_leaf_size_, 0);
+    int err = 0;
+    load_and_publish(
+        [&](std::vector<sensor_msgs::PointCloud2>* levels) { return create_pcd(pcd_file_paths, &err, levels); }, &err);
+    publish_diagnostics(false);
+  }
+  else
+  {
+    pnh_.param<int>("update_rate", update_rate_, DEFAULT_UPDATE_RATE);
+    fallback_rate_ = update_rate_ * 2;  // XXX better way?
+
+    int cache_size;
+    pnh_.param<int>("cache_size", cache_size, DEFAULT_CACHE_SIZE);
+    tile_cache_.setBudget(static_cast<size_t>(std::max(cache_size, 0)) << 20);
+
+    // Prefetching needs room in the tile cache
+    pnh_.param<double>("prefetch_time", prefetch_time_, DEFAULT_PREFETCH_TIME);
+    if (cache_size <= 0)
+      prefetch_time_ = 0;
+
+    if (!can_download_)
+    {
+      AreaList areas = read_arealist(arealist_path);
+      for (const Area& area : areas)
+      {
+        for (const std::string& path : pcd_file_paths)
+        {
+          if (path == area.path)
+            cache_arealist(area, downloaded_areas_);
+        }
+      }
+    }
+
+    gnss_time_ = current_time_ = ros::Time::now();
+
+    try
+    {
+      publisher_ = std::thread(&PointsMapLoader::publish_map, this);
+    }
+    catch (std::exception& ex)
+    {
+      ROS_ERROR_STREAM("failed to create thread from " << ex.what());
+    }
+
+    if (prefetch_time_ > 0)
+    {
+      planned_lanes_sub_ = nh_.subscribe("traffic_waypoints_array", 1, &PointsMapLoader::update_planned_lanes, this);
+      velocity_sub_ = nh_.subscribe("current_velocity", 1, &PointsMapLoader::update_current_speed, this);
+      try
+      {
+        prefetcher_ = std::thread(&PointsMapLoader::prefetch_map, this);
+      }
+      catch (std::exception& ex)
+      {
+        ROS_ERROR_STREAM("failed to create thread from " << ex.what());
+      }
+    }
+
+    if (can_download_)
+    {
+      waypoints_sub_ = nh_.subscribe("traffic_waypoints_array", 1, &PointsMapLoader::request_lookahead_download, this);
+      try
+      {
+        downloader_ = std::thread(&PointsMapLoader::download_map, this);
+      }
+      catch (std::exception& ex)
+      {
+        ROS_ERROR_STREAM("failed to create thread from " << ex.what());
+      }
+    }
+
+    // subscribed last, the pose callbacks use the state set above
+    gnss_sub_ = nh_.subscribe("gnss_pose", 1000, &PointsMapLoader::publish_gnss_pcd, this);
+    current_sub_ = nh_.subscribe("current_pose", 1000, &PointsMapLoader::publish_current_pcd, this);
+    initial_sub_ = nh_.subscribe("initialpose", 1, &PointsMapLoader::publish_dragged_pcd, this);
+  }
 
-  return gf.GetHTTPFile(loc + filename);
+  return true;
 }
 
-void download_map()
+void PointsMapLoader::download_map()
 {
-  while (true)
+  geometry_msgs::Point p;
+  while (request_queue_.dequeue(p))
   {
-    geometry_msgs::Point p = request_queue.dequeue();
 
     int x = static_cast<int>(p.x);
     int y = static_cast<int>(p.y);
-    int x_min = static_cast<int>(p.x - margin);
-    int y_min = static_cast<int>(p.y - margin);
-    int x_max = static_cast<int>(p.x + margin);
-    int y_max = static_cast<int>(p.y + margin);
+    int x_min = static_cast<int>(p.x - margin_);
+    int y_min = static_cast<int>(p.y - margin_);
+    int x_max = static_cast<int>(p.x + margin_);
+    int y_max = static_cast<int>(p.y + margin_);
 
     std::vector<std::string> locs;
     locs.push_back(create_location(x, y));
@@ -258,158 +749,559 @@ void download_map()
     locs.push_back(create_location(x_min, y_max));
     locs.push_back(create_location(x_max, y_min));
     locs.push_back(create_location(x_max, y_max));
+
+    std::vector<std::string> fetch_locs;
     for (const std::string& loc : locs)
     {  // XXX better way?
       std::string arealist_path = TEMPORARY_DIRNAME + loc + AREALIST_FILENAME;
-
-      bool cached = false;
-      for (const std::string& path : cached_arealist_paths)
-      {
-        if (path == arealist_path)
-        {
-          cached = true;
-          break;
-        }
-      }
-      if (cached)
+      if (std::find(cached_arealist_paths_.begin(), cached_arealist_paths_.end(), arealist_path) !=
+              cached_arealist_paths_.end() ||
+          std::find(fetch_locs.begin(), fetch_locs.end(), loc) != fetch_locs.end())
         continue;
 
-      AreaList areas;
       if (is_downloaded(arealist_path))
-        areas = read_arealist(arealist_path);
+      {
+        for (const Area& area : read_arealist(arealist_path))
+          cache_arealist(area, all_areas_);
+        cached_arealist_paths_.push_back(arealist_path);
+      }
       else
       {
-        if (download(gf, TEMPORARY_DIRNAME, loc, AREALIST_FILENAME) != 0)
-          continue;
-        areas = read_arealist(arealist_path);
-        for (Area& area : areas)
-          area.path = TEMPORARY_DIRNAME + loc + basename(area.path.c_str());
-        write_arealist(arealist_path, areas);
+        fetch_locs.push_back(loc);
       }
+    }
+
+    // The arealists of the new locations are fetched together, with the manifest of each location
+    std::vector<std::string> values;
+    for (const std::string& loc : fetch_locs)
+    {
+      create_local_directories(TEMPORARY_DIRNAME, loc);
+      values.push_back(loc + AREALIST_FILENAME);
+    }
+    std::vector<int> results = gf_.GetHTTPFiles(values, connections_);
+    for (size_t i = 0; i < fetch_locs.size(); ++i)
+    {
+      if (results[i] != 0)
+        continue;
+      const std::string& loc = fetch_locs[i];
+      if (gf_.GetHTTPManifest(loc + MANIFEST_FILENAME, manifest_) != 0)
+        ROS_INFO("No manifest_ for %s, its files are not verified", loc.c_str());
+
+      std::string arealist_path = TEMPORARY_DIRNAME + values[i];
+      AreaList areas = read_arealist(arealist_path);
+      for (Area& area : areas)
+        area.path = TEMPORARY_DIRNAME + loc + basename(area.path.c_str());
+      write_arealist(arealist_path, areas);
       for (const Area& area : areas)
-        cache_arealist(area, all_areas);
-      cached_arealist_paths.push_back(arealist_path);
+        cache_arealist(area, all_areas_);
+      cached_arealist_paths_.push_back(arealist_path);
     }
 
-    for (const Area& area : all_areas)
+    AreaList fetch_areas;
+    values.clear();
+    for (const Area& area : all_areas_)
     {
-      if (is_in_area(p.x, p.y, area, margin))
+      if (!is_in_area(p.x, p.y, area, margin_))
+        continue;
+      if (is_downloaded(area.path))
       {
-        int x_area = static_cast<int>(area.x_max - MARGIN_UNIT);
-        int y_area = static_cast<int>(area.y_max - MARGIN_UNIT);
-        std::string loc = create_location(x_area, y_area);
-        if (is_downloaded(area.path) || download(gf, TEMPORARY_DIRNAME, loc, basename(area.path.c_str())) == 0)
-        {
-          std::unique_lock<std::mutex> lock(downloaded_areas_mtx);
-          cache_arealist(area, downloaded_areas);
-        }
+        std::unique_lock<std::mutex> lock(downloaded_areas_mtx_);
+        cache_arealist(area, downloaded_areas_);
+        continue;
       }
+      int x_area = static_cast<int>(area.x_max - MARGIN_UNIT);
+      int y_area = static_cast<int>(area.y_max - MARGIN_UNIT);
+      std::string loc = create_location(x_area, y_area);
+      create_local_directories(TEMPORARY_DIRNAME, loc);
+      fetch_areas.push_back(area);
+      values.push_back(loc + basename(area.path.c_str()));
     }
-  }
-}
 
-sensor_msgs::PointCloud2 create_pcd(const geometry_msgs::Point& p)
-{
-  sensor_msgs::PointCloud2 pcd, part;
-  std::unique_lock<std::mutex> lock(downloaded_areas_mtx);
-  for (const Area& area : downloaded_areas)
-  {
-    if (is_in_area(p.x, p.y, area, margin))
+    results = gf_.GetHTTPFiles(values, connections_, &manifest_);
+    for (size_t i = 0; i < fetch_areas.size(); ++i)
     {
-      if (pcd.width == 0)
-        pcl::io::loadPCDFile(area.path.c_str(), pcd);
+      if (results[i] == 0)
+      {
+        std::unique_lock<std::mutex> lock(downloaded_areas_mtx_);
+        cache_arealist(fetch_areas[i], downloaded_areas_);
+      }
       else
       {
-        pcl::io::loadPCDFile(area.path.c_str(), part);
-        pcd.width += part.width;
-        pcd.row_step += part.row_step;
-        pcd.data.insert(pcd.data.end(), part.data.begin(), part.data.end());
+        ROS_ERROR("download failure: %s", values[i].c_str());
       }
     }
   }
+}
 
-  return pcd;
+// Runs f(0) to f(n - 1) on up to load_threads threads
+void PointsMapLoader::parallel_for(size_t n, const std::function<void(size_t)>& f)
+{
+  std::atomic<size_t> next(0);
+  auto run = [&]() {
+    for (size_t i = next++; i < n && running_ && ros::ok(); i = next++)
+      f(i);
+  };
+
+  size_t threads = std::min(static_cast<size_t>(std::max(load_threads_, 1)), n);
+  std::vector<std::thread> workers;
+  for (size_t i = 1; i < threads; ++i)
+    workers.emplace_back(run);
+  run();
+  for (std::thread& worker : workers)
+    worker.join();
 }
 
-sensor_msgs::PointCloud2 create_pcd(const std::vector<std::string>& pcd_paths, int* ret_err = NULL)
+// Loads the files on load_threads threads, parts keeps the order of paths.
+// A .pcd with an up to date .pct tile next to it is read from the tile.
+std::vector<sensor_msgs::PointCloud2> PointsMapLoader::load_pcds(const std::vector<std::string>& paths, int* ret_err)
 {
-  sensor_msgs::PointCloud2 pcd, part;
-  for (const std::string& path : pcd_paths)
-  {
+  std::vector<sensor_msgs::PointCloud2> parts(paths.size());
+  std::atomic<bool> failed(false);
+  parallel_for(paths.size(), [&](size_t i) {
     // Following outputs are used for progress bar of Runtime Manager.
-    if (pcd.width == 0)
+    ros::WallTime start = ros::WallTime::now();
+    std::string source = paths[i];
+    bool loaded;
+    if (map_file::isPcdTile(paths[i]))
+    {
+      loaded = map_file::readPcdTile(paths[i], parts[i]);
+    }
+    else if (map_file::hasPcdTile(paths[i]))
     {
-      if (pcl::io::loadPCDFile(path.c_str(), pcd) == -1)
+      source = map_file::getPcdTilePath(paths[i]);
+      loaded = map_file::readPcdTile(source, parts[i]);
+      if (!loaded)
       {
-        ROS_ERROR("Failed to load: %s", path.c_str());
-        if (ret_err)
-          *ret_err = 1;
+        source = paths[i];
+        loaded = pcl::io::loadPCDFile(paths[i].c_str(), parts[i]) != -1;
       }
     }
     else
     {
-      if (pcl::io::loadPCDFile(path.c_str(), part) == -1)
+      loaded = pcl::io::loadPCDFile(paths[i].c_str(), parts[i]) != -1;
+    }
+    load_metrics_.recordTile(paths[i], get_file_size(source), (ros::WallTime::now() - start).toSec(), loaded);
+    if (!loaded)
+    {
+      ROS_ERROR("Failed to load: %s", paths[i].c_str());
+      parts[i] = sensor_msgs::PointCloud2();
+      failed = true;
+    }
+    ROS_INFO("Loaded %s", paths[i].c_str());
+  });
+
+  if (failed && ret_err)
+    *ret_err = 1;
+  return parts;
+}
+
+// Downsampled tiles are cached in pyramid_cache_dir, named after the FNV-1a hash of the tile path
+std::string PointsMapLoader::get_level_path(const std::string& path, double leaf_size) const
+{
+  uint64_t hash = 14695981039346656037ULL;
+  for (char c : path)
+  {
+    hash ^= static_cast<unsigned char>(c);
+    hash *= 1099511628211ULL;
+  }
+  char name[64];
+  snprintf(name, sizeof(name), "%016llx_%dmm", static_cast<unsigned long long>(hash),
+           static_cast<int>(std::round(leaf_size * 1000)));
+  return pyramid_cache_dir_ + "/" + name + map_file::PCD_TILE_EXTENSION;
+}
+
+sensor_msgs::PointCloud2::ConstPtr PointsMapLoader::create_level(const std::string& path, double leaf_size,
+                                                                 const sensor_msgs::PointCloud2& full) const
+{
+  sensor_msgs::PointCloud2::Ptr level = boost::make_shared<sensor_msgs::PointCloud2>();
+  std::string level_path = pyramid_cache_dir_.empty() ? "" : get_level_path(path, leaf_size);
+  if (!level_path.empty() && map_file::isPcdTileUpToDate(level_path, path) &&
+      map_file::readPcdTile(level_path, *level))
+    return level;
+
+  *level = downsample_pcd(full, leaf_size);
+  if (!level_path.empty() && !map_file::writePcdTile(level_path, *level, false))
+    ROS_WARN("Failed to write: %s", level_path.c_str());
+  return level;
+}
+
+// The output is sized from the headers of the files, then each file is read on load_threads threads straight to its
+// offset in it, so the points are never copied from a part to the output. false when a header can't be read, the
+// files do not share one layout of unorganized points or a file does not match its header, the caller then loads
+// the parts and concatenates them
+bool PointsMapLoader::load_pcds_in_place(const std::vector<std::string>& paths, sensor_msgs::PointCloud2& pcd)
+{
+  std::vector<std::string> sources(paths.size());
+  std::vector<sensor_msgs::PointCloud2> headers(paths.size());
+  std::vector<uint64_t> sizes(paths.size(), 0);
+  std::atomic<bool> failed(false);
+  parallel_for(paths.size(), [&](size_t i) {
+    sources[i] = get_source_path(paths[i]);
+    if (!read_pcd_header(sources[i], headers[i], sizes[i]))
+      failed = true;
+  });
+  if (failed)
+    return false;
+
+  const sensor_msgs::PointCloud2* layout;
+  std::vector<uint64_t> offsets(paths.size());
+  uint64_t data_size = 0;
+  uint32_t width = 0;
+  for (size_t i = 0; i < paths.size(); ++i)
+  {
+    const sensor_msgs::PointCloud2& header = headers[i];
+    if (header.width == 0)
+      continue;
+    if (header.height != 1 || sizes[i] != static_cast<uint64_t>(header.width) * header.point_step ||
+        (layout && !has_same_layout(*layout, header)) || width > UINT32_MAX - header.width)
+      return false;
+    if (!layout)
+      layout = &header;
+    offsets[i] = data_size;
+    data_size += sizes[i];
+    width += header.width;
+  }
+  if (!layout)
+    return false;
+
+  pcd.header = layout->header;
+  pcd.height = 1;
+  pcd.width = width;
+  pcd.fields = layout->fields;
+  pcd.is_bigendian = layout->is_bigendian;
+  pcd.point_step = layout->point_step;
+  pcd.row_step = width * layout->point_step;
+  pcd.is_dense = true;
+  pcd.data.resize(data_size);
+  std::atomic<bool> not_dense(false);
+  parallel_for(paths.size(), [&](size_t i) {
+    if (headers[i].width == 0)
+      return;
+    ros::WallTime start = ros::WallTime::now();
+    uint8_t* data = pcd.data.data() + offsets[i];
+    bool loaded;
+    if (map_file::isPcdTile(sources[i]))
+    {
+      loaded = map_file::readPcdTileData(sources[i], data, sizes[i]);
+      if (!headers[i].is_dense)
+        not_dense = true;
+    }
+    else
+    {
+      sensor_msgs::PointCloud2 part;
+      loaded = pcl::io::loadPCDFile(sources[i].c_str(), part) != -1 && part.data.size() == sizes[i] &&
+               has_same_layout(part, *layout);
+      if (loaded)
+        std::memcpy(data, part.data.data(), sizes[i]);
+      if (!part.is_dense)
+        not_dense = true;
+    }
+    load_metrics_.recordTile(paths[i], get_file_size(sources[i]), (ros::WallTime::now() - start).toSec(), loaded);
+    if (!loaded)
+    {
+      failed = true;
+      return;
+    }
+    // Following outputs are used for progress bar of Runtime Manager.
+    ROS_INFO("Loaded %s", paths[i].c_str());
+  });
+  if (failed)
+  {
+    pcd = sensor_msgs::PointCloud2();
+    return false;
+  }
+  pcd.is_dense = !not_dense;
+  return true;
+}
+
+// Every part downsampled with lod_leaf_size, in parallel
+void PointsMapLoader::downsample_parts(std::vector<sensor_msgs::PointCloud2::ConstPtr>& parts)
+{
+  parallel_for(parts.size(), [&](size_t i) {
+    if (parts[i]->width != 0)
+      parts[i] = boost::make_shared<sensor_msgs::PointCloud2>(downsample_pcd(*parts[i], lod_leaf_size_));
+  });
+}
+
+// One cloud per pyramid level, made of the downsampled parts
+void PointsMapLoader::create_levels(const std::vector<std::string>& paths,
+                                    const std::vector<sensor_msgs::PointCloud2::ConstPtr>& parts,
+                                    std::vector<sensor_msgs::PointCloud2>& levels)
+{
+  levels.clear();
+  for (double leaf_size : pyramid_leaf_sizes_)
+  {
+    std::vector<sensor_msgs::PointCloud2::ConstPtr> level_parts(paths.size());
+    parallel_for(paths.size(), [&](size_t i) {
+      std::string key = paths[i] + "@" + std::to_string(leaf_size);
+      level_parts[i] = tile_cache_.find(key);
+      if (level_parts[i])
+        return;
+      if (parts[i]->width == 0)
       {
-        ROS_ERROR("Failed to load: %s", path.c_str());
-        if (ret_err)
-          *ret_err = 1;
+        level_parts[i] = parts[i];
+        return;
       }
-      pcd.width += part.width;
-      pcd.row_step += part.row_step;
-      pcd.data.insert(pcd.data.end(), part.data.begin(), part.data.end());
+      level_parts[i] = create_level(paths[i], leaf_size, *parts[i]);
+      tile_cache_.insert(key, level_parts[i]);
+    });
+    levels.push_back(concatenate_pcds(level_parts));
+  }
+}
+
+sensor_msgs::PointCloud2 PointsMapLoader::create_pcd(const geometry_msgs::Point& p,
+                                                     std::vector<sensor_msgs::PointCloud2>* levels)
+{
+  std::vector<std::string> paths;
+  {
+    std::unique_lock<std::mutex> lock(downloaded_areas_mtx_);
+    for (const Area& area : downloaded_areas_)
+    {
+      if (is_in_area(p.x, p.y, area, margin_))
+        paths.push_back(area.path);
     }
-    ROS_INFO("Loaded %s", path.c_str());
-    if (!ros::ok())
-      break;
   }
 
-  return pcd;
+  // Only the tiles missing from the cache are read from disk
+  std::vector<sensor_msgs::PointCloud2::ConstPtr> parts(paths.size());
+  std::vector<std::string> load_paths;
+  std::vector<size_t> load_indices;
+  for (size_t i = 0; i < paths.size(); ++i)
+  {
+    parts[i] = tile_cache_.find(paths[i]);
+    if (!parts[i])
+    {
+      load_paths.push_back(paths[i]);
+      load_indices.push_back(i);
+    }
+  }
+
+  std::vector<sensor_msgs::PointCloud2> loaded = load_pcds(load_paths);
+  for (size_t i = 0; i < loaded.size(); ++i)
+  {
+    parts[load_indices[i]] = boost::make_shared<sensor_msgs::PointCloud2>(std::move(loaded[i]));
+    if (parts[load_indices[i]]->width != 0)
+      tile_cache_.insert(load_paths[i], parts[load_indices[i]]);
+  }
+
+  if (levels)
+    create_levels(paths, parts, *levels);
+  return concatenate_pcds(parts);
 }
 
-void publish_pcd(sensor_msgs::PointCloud2 pcd, const int* errp = NULL)
+sensor_msgs::PointCloud2 PointsMapLoader::create_pcd(const std::vector<std::string>& pcd_paths, int* ret_err,
+                                                     std::vector<sensor_msgs::PointCloud2>* levels)
+{
+  // the parts are only needed for the pyramid and the level of detail
+  if (!levels && lod_leaf_size_ <= 0)
+  {
+    sensor_msgs::PointCloud2 pcd;
+    if (load_pcds_in_place(pcd_paths, pcd))
+      return pcd;
+  }
+
+  std::vector<sensor_msgs::PointCloud2> loaded = load_pcds(pcd_paths, ret_err);
+  std::vector<sensor_msgs::PointCloud2::ConstPtr> parts;
+  for (sensor_msgs::PointCloud2& part : loaded)
+    parts.push_back(boost::make_shared<sensor_msgs::PointCloud2>(std::move(part)));
+  loaded.clear();
+  // the pyramid is made of the full tiles, like its cache
+  if (levels)
+    create_levels(pcd_paths, parts, *levels);
+  if (lod_leaf_size_ > 0)
+    downsample_parts(parts);
+  return concatenate_pcds(parts);
+}
+
+void PointsMapLoader::publish_pcd(sensor_msgs::PointCloud2 pcd, const int* errp)
 {
   if (pcd.width != 0)
   {
     pcd.header.frame_id = "map";
-    pcd_pub.publish(pcd);
+    // published by pointer, subscribers in the same process receive the map without serialization
+    pcd_pub_.publish(boost::make_shared<sensor_msgs::PointCloud2>(std::move(pcd)));
 
     if (errp == NULL || *errp == 0)
     {
-      stat_msg.data = true;
-      stat_pub.publish(stat_msg);
+      stat_msg_.data = true;
+      stat_pub_.publish(stat_msg_);
+    }
+  }
+}
+
+void PointsMapLoader::publish_levels(std::vector<sensor_msgs::PointCloud2>& levels)
+{
+  for (size_t i = 0; i < levels.size() && i < pyramid_pubs_.size(); ++i)
+  {
+    if (levels[i].width == 0)
+      continue;
+    levels[i].header.frame_id = "map";
+    pyramid_pubs_[i].publish(boost::make_shared<sensor_msgs::PointCloud2>(std::move(levels[i])));
+  }
+}
+
+void PointsMapLoader::publish_diagnostics(bool with_cache)
+{
+  diagnostic_msgs::DiagnosticArray diag;
+  diag.header.stamp = ros::Time::now();
+  if (with_cache)
+    diag.status.push_back(tile_cache_.getStatus());
+  diag.status.push_back(load_metrics_.getStatus());
+  diag_pub_.publish(diag);
+  load_metrics_.check(*health_checker_);
+}
+
+// Loads the map (of the tiles around p in the area modes), publishes it and records the time it took
+void PointsMapLoader::load_and_publish(
+    const std::function<sensor_msgs::PointCloud2(std::vector<sensor_msgs::PointCloud2>*)>& create, const int* errp)
+{
+  ros::WallTime start = ros::WallTime::now();
+  std::vector<sensor_msgs::PointCloud2> levels;
+  sensor_msgs::PointCloud2 pcd = create(pyramid_leaf_sizes_.empty() ? NULL : &levels);
+  uint32_t points = pcd.width * pcd.height;
+  publish_pcd(std::move(pcd), errp);
+  publish_levels(levels);
+  load_metrics_.recordPublish((ros::WallTime::now() - start).toSec(), points);
+}
+
+// Loads and publishes the tiles around the requested poses so the pose callbacks never wait for the disk
+void PointsMapLoader::publish_map()
+{
+  geometry_msgs::Point p;
+  while (pcd_request_.wait(p) && ros::ok())
+  {
+    load_and_publish([this, &p](std::vector<sensor_msgs::PointCloud2>* levels) { return create_pcd(p, levels); });
+    publish_diagnostics(true);
+  }
+}
+
+// The waypoints of the planned lanes the vehicle reaches within prefetch_time from p
+std::vector<geometry_msgs::Point> PointsMapLoader::predict_route(const geometry_msgs::Point& p)
+{
+  double horizon = std::max(current_speed_.load(), MIN_PREFETCH_SPEED) * prefetch_time_;
+  double step = MARGIN_UNIT / 2;
+  std::vector<geometry_msgs::Point> route;
+
+  std::unique_lock<std::mutex> lock(planned_lanes_mtx_);
+  for (const autoware_msgs::Lane& l : planned_lanes_)
+  {
+    if (l.waypoints.empty())
+      continue;
+
+    size_t nearest = 0;
+    double nearest_distance = DBL_MAX;
+    for (size_t i = 0; i < l.waypoints.size(); ++i)
+    {
+      const geometry_msgs::Point& q = l.waypoints[i].pose.pose.position;
+      double d = hypot(q.x - p.x, q.y - p.y);
+      if (d < nearest_distance)
+      {
+        nearest = i;
+        nearest_distance = d;
+      }
+    }
+
+    double distance = 0;
+    double sampled = 0;
+    for (size_t i = nearest + 1; i < l.waypoints.size() && distance < horizon; ++i)
+    {
+      const geometry_msgs::Point& p1 = l.waypoints[i].pose.pose.position;
+      const geometry_msgs::Point& p2 = l.waypoints[i - 1].pose.pose.position;
+      double d = hypot(p2.x - p1.x, p2.y - p1.y);
+      distance += d;
+      sampled += d;
+      if (sampled >= step || distance >= horizon || i + 1 == l.waypoints.size())
+      {
+        route.push_back(p1);
+        sampled = 0;
+      }
+    }
+  }
+
+  return route;
+}
+
+// Decodes into the tile cache the local tiles along the predicted route that are not cached yet
+void PointsMapLoader::prefetch_map()
+{
+  geometry_msgs::Point p;
+  while (prefetch_request_.wait(p) && ros::ok())
+  {
+    std::vector<geometry_msgs::Point> route = predict_route(p);
+    if (route.empty())
+      continue;
+
+    std::vector<std::string> paths;
+    {
+      std::unique_lock<std::mutex> lock(downloaded_areas_mtx_);
+      for (const Area& area : downloaded_areas_)
+      {
+        if (tile_cache_.contains(area.path))
+          continue;
+        for (const geometry_msgs::Point& q : route)
+        {
+          if (is_in_area(q.x, q.y, area, margin_))
+          {
+            paths.push_back(area.path);
+            break;
+          }
+        }
+      }
+    }
+
+    std::vector<sensor_msgs::PointCloud2> loaded = load_pcds(paths);
+    for (size_t i = 0; i < loaded.size(); ++i)
+    {
+      if (loaded[i].width != 0)
+        tile_cache_.insert(paths[i], boost::make_shared<sensor_msgs::PointCloud2>(std::move(loaded[i])));
     }
   }
 }
 
-void publish_gnss_pcd(const geometry_msgs::PoseStamped& msg)
+void PointsMapLoader::update_planned_lanes(const autoware_msgs::LaneArray& msg)
+{
+  std::unique_lock<std::mutex> lock(planned_lanes_mtx_);
+  planned_lanes_ = msg.lanes;
+}
+
+void PointsMapLoader::update_current_speed(const geometry_msgs::TwistStamped& msg)
+{
+  current_speed_ = std::fabs(msg.twist.linear.x);
+}
+
+void PointsMapLoader::publish_gnss_pcd(const geometry_msgs::PoseStamped& msg)
 {
   ros::Time now = ros::Time::now();
-  if (((now - current_time).toSec() * 1000) < fallback_rate)
+  if (((now - current_time_).toSec() * 1000) < fallback_rate_)
     return;
-  if (((now - gnss_time).toSec() * 1000) < update_rate)
+  if (((now - gnss_time_).toSec() * 1000) < update_rate_)
     return;
-  gnss_time = now;
+  gnss_time_ = now;
 
-  if (can_download)
-    request_queue.enqueue(msg.pose.position);
+  if (can_download_)
+    request_queue_.enqueue(msg.pose.position);
 
-  publish_pcd(create_pcd(msg.pose.position));
+  pcd_request_.set(msg.pose.position);
+  if (prefetch_time_ > 0)
+    prefetch_request_.set(msg.pose.position);
 }
 
-void publish_current_pcd(const geometry_msgs::PoseStamped& msg)
+void PointsMapLoader::publish_current_pcd(const geometry_msgs::PoseStamped& msg)
 {
   ros::Time now = ros::Time::now();
-  if (((now - current_time).toSec() * 1000) < update_rate)
+  if (((now - current_time_).toSec() * 1000) < update_rate_)
     return;
-  current_time = now;
+  current_time_ = now;
 
-  if (can_download)
-    request_queue.enqueue(msg.pose.position);
+  if (can_download_)
+    request_queue_.enqueue(msg.pose.position);
 
-  publish_pcd(create_pcd(msg.pose.position));
+  pcd_request_.set(msg.pose.position);
+  if (prefetch_time_ > 0)
+    prefetch_request_.set(msg.pose.position);
 }
 
-void publish_dragged_pcd(const geometry_msgs::PoseWithCovarianceStamped& msg)
+void PointsMapLoader::publish_dragged_pcd(const geometry_msgs::PoseWithCovarianceStamped& msg)
 {
   tf::TransformListener listener;
   tf::StampedTransform transform;
@@ -428,21 +1320,21 @@ void publish_dragged_pcd(const geometry_msgs::PoseWithCovarianceStamped& msg)
   p.x = msg.pose.pose.position.x + transform.getOrigin().x();
   p.y = msg.pose.pose.position.y + transform.getOrigin().y();
 
-  if (can_download)
-    request_queue.enqueue(p);
+  if (can_download_)
+    request_queue_.enqueue(p);
 
-  publish_pcd(create_pcd(p));
+  pcd_request_.set(p);
 }
 
-void request_lookahead_download(const autoware_msgs::LaneArray& msg)
+void PointsMapLoader::request_lookahead_download(const autoware_msgs::LaneArray& msg)
 {
-  request_queue.clear_look_ahead();
+  request_queue_.clear_look_ahead();
 
   for (const autoware_msgs::Lane& l : msg.lanes)
   {
     size_t end = l.waypoints.size() - 1;
     double distance = 0;
-    double threshold = (MARGIN_UNIT / 2) + margin;  // XXX better way?
+    double threshold = (MARGIN_UNIT / 2) + margin_;  // XXX better way?
     for (size_t i = 0; i <= end; ++i)
     {
       if (i == 0 || i == end)
@@ -450,7 +1342,7 @@ void request_lookahead_download(const autoware_msgs::LaneArray& msg)
         geometry_msgs::Point p;
         p.x = l.waypoints[i].pose.pose.position.x;
         p.y = l.waypoints[i].pose.pose.position.y;
-        request_queue.enqueue_look_ahead(p);
+        request_queue_.enqueue_look_ahead(p);
       }
       else
       {
@@ -462,7 +1354,7 @@ void request_lookahead_download(const autoware_msgs::LaneArray& msg)
         distance += hypot(p2.x - p1.x, p2.y - p1.y);
         if (distance > threshold)
         {
-          request_queue.enqueue_look_ahead(p1);
+          request_queue_.enqueue_look_ahead(p1);
           distance = 0;
         }
       }
@@ -470,150 +1362,4 @@ void request_lookahead_download(const autoware_msgs::LaneArray& msg)
   }
 }
 
-}  // namespace
-
-int main(int argc, char** argv)
-{
-  ros::init(argc, argv, "points_map_loader");
-
-  ros::NodeHandle nh;
-  ros::NodeHandle pnh("~");
-
-  // Get parameters
-  std::string area;
-  pnh.param<std::string>("area", area, "noupdate");
-
-  std::string mode;
-  pnh.param<std::string>("mode", mode, "");
-
-  std::vector<std::string> pcd_paths;
-  pnh.getParam("pcd_paths", pcd_paths);
-
-  std::string arealist_path;
-  pnh.param<std::string>("arealist_path", arealist_path, "");
-
-  // Search all files in pcd_paths
-  std::vector<std::string> pcd_file_paths;
-  for (const std::string& pcd_path : pcd_paths)
-  {
-    // Search all files in each path in pcd_paths
-    boost::filesystem::path path(pcd_path);
-    if (boost::filesystem::is_regular_file(path))
-    {
-      // If file
-      pcd_file_paths.push_back(pcd_path);
-    }
-    else if (boost::filesystem::is_directory(path))
-    {
-      // If directory
-      for (const boost::filesystem::path& entry :
-           boost::make_iterator_range(boost::filesystem::recursive_directory_iterator(path), {}))
-      {
-        if (boost::filesystem::is_regular_file(entry))
-        {
-          pcd_file_paths.push_back(entry.generic_string());
-        }
-      }
-    }
-  }
-
-  if (area == "noupdate")
-    margin = -1;
-  else if (area == "1x1")
-    margin = 0;
-  else if (area == "3x3")
-    margin = MARGIN_UNIT * 1;
-  else if (area == "5x5")
-    margin = MARGIN_UNIT * 2;
-  else if (area == "7x7")
-    margin = MARGIN_UNIT * 3;
-  else if (area == "9x9")
-    margin = MARGIN_UNIT * 4;
-  else
-  {
-    ROS_ERROR("[points_map_loader] parameter area is not set.");
-    return EXIT_FAILURE;
-  }
-
-  if (margin < 0)
-  {
-    can_download = false;
-  }
-  else
-  {
-    if (mode == "download")
-    {
-      can_download = true;
-      std::string host_name;
-      pnh.param<std::string>("host_name", host_name, HTTP_HOSTNAME);
-      int port;
-      pnh.param<int>("port", port, HTTP_PORT);
-      std::string user;
-      pnh.param<std::string>("user", user, HTTP_USER);
-      std::string password;
-      pnh.param<std::string>("password", password, HTTP_PASSWORD);
-      gf = GetFile(host_name, port, user, password);
-    }
-    else
-    {
-      can_download = false;
-    }
-  }
-
-  pcd_pub = nh.advertise<sensor_msgs::PointCloud2>("points_map", 1, true);
-  stat_pub = nh.advertise<std_msgs::Bool>("pmap_stat", 1, true);
-
-  stat_msg.data = false;
-  stat_pub.publish(stat_msg);
-
-  ros::Subscriber gnss_sub;
-  ros::Subscriber current_sub;
-  ros::Subscriber initial_sub;
-  ros::Subscriber waypoints_sub;
-  if (margin < 0)
-  {
-    int err = 0;
-    publish_pcd(create_pcd(pcd_file_paths, &err), &err);
-  }
-  else
-  {
-    pnh.param<int>("update_rate", update_rate, DEFAULT_UPDATE_RATE);
-    fallback_rate = update_rate * 2;  // XXX better way?
-
-    gnss_sub = nh.subscribe("gnss_pose", 1000, publish_gnss_pcd);
-    current_sub = nh.subscribe("current_pose", 1000, publish_current_pcd);
-    initial_sub = nh.subscribe("initialpose", 1, publish_dragged_pcd);
-
-    if (can_download)
-    {
-      waypoints_sub = nh.subscribe("traffic_waypoints_array", 1, request_lookahead_download);
-      try
-      {
-        std::thread downloader(download_map);
-        downloader.detach();
-      }
-      catch (std::exception& ex)
-      {
-        ROS_ERROR_STREAM("failed to create thread from " << ex.what());
-      }
-    }
-    else
-    {
-      AreaList areas = read_arealist(arealist_path);
-      for (const Area& area : areas)
-      {
-        for (const std::string& path : pcd_file_paths)
-        {
-          if (path == area.path)
-            cache_arealist(area, downloaded_areas);
-        }
-      }
-    }
-
-    gnss_time = current_time = ros::Time::now();
-  }
-
-  ros::spin();
-
-  return 0;
-}
+}  // namespace map_file
@@ -0,0 +1,42 @@
+/*
+ * Copyright 2015-2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// headers for ros
+#include <nodelet/nodelet.h>
+#include <pluginlib/class_list_macros.h>
+
+#include "map_file/points_map_loader.h"
+
+#include <memory>
+
+namespace map_file
+{
+// points_map_loader in a nodelet manager, the points map is passed by pointer to the other nodelets of the manager
+class PointsMapLoaderNodelet : public nodelet::Nodelet
+{
+private:
+  std::unique_ptr<PointsMapLoader> loader_;
+
+  void onInit() override
+  {
+    loader_.reset(new PointsMapLoader(getNodeHandle(), getPrivateNodeHandle()));
+    if (!loader_->init())
+      loader_.reset();
+  }
+};
+}  // namespace map_file
+
+PLUGINLIB_EXPORT_CLASS(map_file::PointsMapLoaderNodelet, nodelet::Nodelet)
@@ -15,12 +15,27 @@
  */
 
 #include <ros/console.h>
+#include <geometry_msgs/Pose.h>
 #include <std_msgs/Bool.h>
+#include <std_msgs/UInt8MultiArray.h>
 #include <visualization_msgs/MarkerArray.h>
 #include <vector_map/vector_map.h>
 #include <map_file/get_file.h>
+#include <ros/serialization.h>
 #include <sys/stat.h>
 
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <future>
+#include <iterator>
+#include <map>
+#include <string>
+#include <tuple>
+#include <vector>
+
 using vector_map::VectorMap;
 using vector_map::Category;
 using vector_map::Color;
@@ -119,6 +134,96 @@ bool isDownloaded(const std::string& local_path)
   return stat(local_path.c_str(), &st) == 0;
 }
 
+void createDirectories(const std::string& path)
+{
+  std::istringstream iss(path);
+  std::string column;
+  std::string mkdir_path;
+  std::getline(iss, mkdir_path, '/');
+  while (std::getline(iss, column, '/'))
+  {
+    mkdir_path += "/" + column;
+    mkdir(mkdir_path.c_str(), 0755);
+  }
+}
+
+// bump when the markers created from the same csv files change, so that the old cache files are not used
+const uint32_t MARKER_CACHE_VERSION = 1;
+
+// FNV-1a over the name and the content of every csv file, in file name order
+uint64_t computeMapChecksum(const std::vector<std::string>& file_paths)
+{
+  std::vector<std::string> sorted_paths(file_paths);
+  std::sort(sorted_paths.begin(), sorted_paths.end(), [](const std::string& a, const std::string& b) {
+    return a.substr(a.find_last_of('/') + 1) < b.substr(b.find_last_of('/') + 1);
+  });
+
+  uint64_t checksum = 14695981039346656037ULL ^ MARKER_CACHE_VERSION;
+  auto combine = [&checksum](const char* data, size_t size) {
+    for (size_t i = 0; i < size; ++i)
+      checksum = (checksum ^ static_cast<uint8_t>(data[i])) * 1099511628211ULL;
+  };
+  std::vector<char> buffer(1 << 16);
+  for (const auto& file_path : sorted_paths)
+  {
+    std::ifstream ifs(file_path.c_str(), std::ios::binary);
+    if (!ifs)
+      continue;
+    std::string file_name = file_path.substr(file_path.find_last_of('/') + 1);
+    combine(file_name.c_str(), file_name.size() + 1);
+    while (ifs.read(buffer.data(), buffer.size()) || ifs.gcount() > 0)
+      combine(buffer.data(), ifs.gcount());
+  }
+  return checksum;
+}
+
+bool loadMarkerCache(const std::string& cache_path, visualization_msgs::MarkerArray& marker_array)
+{
+  std::ifstream ifs(cache_path.c_str(), std::ios::binary);
+  uint32_t version = 0;
+  uint32_t length = 0;
+  if (!ifs.read(reinterpret_cast<char*>(&version), sizeof(version)) || version != MARKER_CACHE_VERSION ||
+      !ifs.read(reinterpret_cast<char*>(&length), sizeof(length)))
+    return false;
+
+  std::vector<uint8_t> buffer(length);
+  if (!ifs.read(reinterpret_cast<char*>(buffer.data()), length))
+    return false;
+  try
+  {
+    ros::serialization::IStream stream(buffer.data(), length);
+    ros::serialization::deserialize(stream, marker_array);
+  }
+  catch (const ros::Exception& e)
+  {
+    ROS_WARN_STREAM("broken marker cache " << cache_path << ": " << e.what());
+    marker_array.markers.clear();
+    return false;
+  }
+  return true;
+}
+
+bool saveMarkerCache(const std::string& cache_path, const visualization_msgs::MarkerArray& marker_array)
+{
+  uint32_t version = MARKER_CACHE_VERSION;
+  uint32_t length = ros::serialization::serializationLength(marker_array);
+  std::vector<uint8_t> buffer(length);
+  ros::serialization::OStream stream(buffer.data(), length);
+  ros::serialization::serialize(stream, marker_array);
+
+  // written aside and renamed, a loader started at the same time never reads a partial file
+  std::string tmp_path = cache_path + ".tmp";
+  {
+    std::ofstream ofs(tmp_path.c_str(), std::ios::binary | std::ios::trunc);
+    ofs.write(reinterpret_cast<const char*>(&version), sizeof(version));
+    ofs.write(reinterpret_cast<const char*>(&length), sizeof(length));
+    ofs.write(reinterpret_cast<const char*>(buffer.data()), length);
+    if (!ofs)
+      return false;
+  }
+  return std::rename(tmp_path.c_str(), cache_path.c_str()) == 0;
+}
+
 template <class T, class U>
 vector_map::category_t registerVectormapPortion(
   const std::string& file_path, ros::Publisher *publisher,
@@ -922,9 +1027,78 @@ visualization_msgs::MarkerArray createRailCrossingMarkerArray(const VectorMap& v
   return marker_array;
 }
 
-void insertMarkerArray(visualization_msgs::MarkerArray& a1, const visualization_msgs::MarkerArray& a2)
+template <class F, class... Args>
+std::future<visualization_msgs::MarkerArray> createMarkerArrayAsync(F create, const VectorMap& vmap, Args... colors)
+{
+  return std::async(std::launch::async, create, std::cref(vmap), colors...);
+}
+
+// the categories are received and indexed in parallel
+void subscribeVectorMap(ros::NodeHandle& nh, VectorMap& vmap, vector_map::category_t category)
+{
+  std::shared_future<void> ready = vmap.subscribeAsync(nh, category);
+  while (ros::ok() && ready.wait_for(std::chrono::seconds(1)) != std::future_status::ready)
+    continue;
+}
+
+bool isIdentityPose(const geometry_msgs::Pose& pose)
 {
-  a1.markers.insert(a1.markers.end(), a2.markers.begin(), a2.markers.end());
+  return pose.position.x == 0 && pose.position.y == 0 && pose.position.z == 0 && pose.orientation.x == 0 &&
+         pose.orientation.y == 0 && pose.orientation.z == 0;
+}
+
+// The LINE_STRIP markers of the same namespace, color and width are merged in one LINE_LIST marker,
+// the other markers are kept as they are
+visualization_msgs::MarkerArray createLineListMarkerArray(const visualization_msgs::MarkerArray& marker_array)
+{
+  std::map<std::string, int> next_ids;  // line lists get ids after the kept markers of their namespace
+  for (const auto& marker : marker_array.markers)
+  {
+    auto it = next_ids.find(marker.ns);
+    if (it == next_ids.end())
+      next_ids[marker.ns] = marker.id + 1;
+    else
+      it->second = std::max(it->second, marker.id + 1);
+  }
+
+  visualization_msgs::MarkerArray line_list_marker_array;
+  std::map<std::tuple<std::string, float, float, float, float, double>, size_t> line_lists;
+  for (const auto& marker : marker_array.markers)
+  {
+    if (marker.type != visualization_msgs::Marker::LINE_STRIP || marker.points.size() < 2 ||
+        !isIdentityPose(marker.pose))
+    {
+      line_list_marker_array.markers.push_back(marker);
+      continue;
+    }
+
+    auto key = std::make_tuple(marker.ns, marker.color.r, marker.color.g, marker.color.b, marker.color.a,
+                               marker.scale.x);
+    auto it = line_lists.find(key);
+    if (it == line_lists.end())
+    {
+      visualization_msgs::Marker line_list = marker;
+      line_list.id = next_ids[marker.ns]++;
+      line_list.type = visualization_msgs::Marker::LINE_LIST;
+      line_list.points.clear();
+      it = line_lists.emplace(key, line_list_marker_array.markers.size()).first;
+      line_list_marker_array.markers.push_back(line_list);
+    }
+
+    auto& points = line_list_marker_array.markers[it->second].points;
+    for (size_t i = 1; i < marker.points.size(); ++i)
+    {
+      points.push_back(marker.points[i - 1]);
+      points.push_back(marker.points[i]);
+    }
+  }
+  return line_list_marker_array;
+}
+
+void insertMarkerArray(visualization_msgs::MarkerArray& a1, visualization_msgs::MarkerArray&& a2)
+{
+  a1.markers.insert(a1.markers.end(), std::make_move_iterator(a2.markers.begin()),
+                    std::make_move_iterator(a2.markers.end()));
 }
 } // namespace
 
@@ -981,6 +1155,33 @@ int main(int argc, char **argv)
   std::string map_dir;
   pnh.param<std::string>("map_dir", map_dir, "");
 
+  // Directory of the marker arrays cached per map checksum, no cache when empty
+  std::string marker_cache_dir;
+  pnh.param<std::string>("marker_cache_dir", marker_cache_dir, "");
+
+  // One LINE_LIST marker per namespace and color instead of one LINE_STRIP marker per line
+  bool batch_line_markers;
+  pnh.param<bool>("batch_line_markers", batch_line_markers, false);
+
+  // Every category also published in tiles of tile_size meters on their own topics, see VectorMap::subscribeTiles
+  bool publish_tiles;
+  pnh.param<bool>("publish_tiles", publish_tiles, false);
+  double tile_size;
+  pnh.param<double>("tile_size", tile_size, 100.0);
+  bool compress_tiles;
+  pnh.param<bool>("compress_tiles", compress_tiles, true);
+  if (publish_tiles && !(tile_size > 0))
+  {
+    ROS_ERROR_STREAM("invalid tile_size " << tile_size << ", the tiles are not published");
+    publish_tiles = false;
+  }
+
+  // Snapshot of the loaded map for VectorMap::loadSnapshot, none when empty
+  std::string snapshot_file;
+  pnh.param<std::string>("snapshot_file", snapshot_file, "");
+  double snapshot_cell_size;
+  pnh.param<double>("snapshot_cell_size", snapshot_cell_size, 10.0);
+
   // Vector map publishers will be initialized later as data is loaded.
   ros::Publisher area_pub;
   ros::Publisher box_pub;
@@ -1071,6 +1272,8 @@ int main(int argc, char **argv)
     pnh.param<std::string>("user", user, HTTP_USER);
     std::string password;
     pnh.param<std::string>("password", password, HTTP_PASSWORD);
+    int connections;
+    pnh.param<int>("connections", connections, HTTP_CONNECTIONS);
     GetFile gf = GetFile(host_name, port, user, password);
 
     std::string remote_path = "/data/map";
@@ -1082,24 +1285,23 @@ int main(int argc, char **argv)
 
     std::string local_path = "/tmp" + remote_path;
     if (!isDownloaded(local_path))
-    {
-      std::istringstream iss(remote_path);
-      std::string column;
-      std::getline(iss, column, '/');
-      std::string mkdir_path = "/tmp";
-      while (std::getline(iss, column, '/'))
-      {
-        mkdir_path += "/" + column;
-        mkdir(mkdir_path.c_str(), 0755);
-      }
-    }
+      createDirectories(local_path);
 
+    // The files listed in the manifest of the directory are verified, without one they are taken as is
+    Manifest manifest;
+    if (gf.GetHTTPManifest(remote_path + "/manifest.txt", manifest) != 0)
+      ROS_INFO_STREAM("no manifest in " << remote_path << ", the files are not verified");
+
+    std::vector<std::string> values;
     for (const auto& file_name : file_names)
+      values.push_back(remote_path + "/" + file_name);
+    std::vector<int> results = gf.GetHTTPFiles(values, connections, &manifest);
+    for (size_t i = 0; i < values.size(); ++i)
     {
-      if (gf.GetHTTPFile(remote_path + "/" + file_name) == 0)
-        file_paths.push_back("/tmp" + remote_path + "/" + file_name);
+      if (results[i] == 0)
+        file_paths.push_back("/tmp" + values[i]);
       else
-        ROS_ERROR_STREAM("download failure: " << remote_path + "/" + file_name);
+        ROS_ERROR_STREAM("download failure: " << values[i]);
     }
   }
   else if (load_mode == LoadMode::DIRECTORY)
@@ -1129,7 +1331,8 @@ int main(int argc, char **argv)
     }
   }
 
-  vector_map::category_t category = Category::NONE;
+  // every csv file is parsed and published by its own task, a category is published as soon as it is parsed
+  std::vector<std::future<vector_map::category_t>> tasks;
   for (const auto& file_path : file_paths)
   {
     std::string file_name(basename(file_path.c_str()));
@@ -1139,131 +1342,131 @@ int main(int argc, char **argv)
     }
     else if (file_name == "point.csv")
     {
-      category |= registerVectormapPortion<Point, PointArray>(file_path, &point_pub, "vector_map_info/point", Category::POINT, &nh);
+      tasks.push_back(std::async(std::launch::async, registerVectormapPortion<Point, PointArray>, file_path, &point_pub, "vector_map_info/point", Category::POINT, &nh));
     }
     else if (file_name == "vector.csv")
     {
-      category |= registerVectormapPortion<Vector, VectorArray>(file_path, &vector_pub, "vector_map_info/vector", Category::VECTOR, &nh);
+      tasks.push_back(std::async(std::launch::async, registerVectormapPortion<Vector, VectorArray>, file_path, &vector_pub, "vector_map_info/vector", Category::VECTOR, &nh));
     }
     else if (file_name == "line.csv")
     {
-      category |= registerVectormapPortion<Line, LineArray>(file_path, &line_pub, "vector_map_info/line", Category::LINE, &nh);
+      tasks.push_back(std::async(std::launch::async, registerVectormapPortion<Line, LineArray>, file_path, &line_pub, "vector_map_info/line", Category::LINE, &nh));
     }
     else if (file_name == "area.csv")
     {
-      category |= registerVectormapPortion<Area, AreaArray>(file_path, &area_pub, "vector_map_info/area", Category::AREA, &nh);
+      tasks.push_back(std::async(std::launch::async, registerVectormapPortion<Area, AreaArray>, file_path, &area_pub, "vector_map_info/area", Category::AREA, &nh));
     }
     else if (file_name == "pole.csv")
     {
-      category |= registerVectormapPortion<Pole, PoleArray>(file_path, &pole_pub, "vector_map_info/pole", Category::POLE, &nh);
+      tasks.push_back(std::async(std::launch::async, registerVectormapPortion<Pole, PoleArray>, file_path, &pole_pub, "vector_map_info/pole", Category::POLE, &nh));
     }
     else if (file_name == "box.csv")
     {
-      category |= registerVectormapPortion<Box, BoxArray>(file_path, &box_pub, "vector_map_info/box", Category::BOX, &nh);
+      tasks.push_back(std::async(std::launch::async, registerVectormapPortion<Box, BoxArray>, file_path, &box_pub, "vector_map_info/box", Category::BOX, &nh));
     }
     else if (file_name == "dtlane.csv")
     {
-      category |= registerVectormapPortion<DTLane, DTLaneArray>(file_path, &dtlane_pub, "vector_map_info/dtlane", Category::DTLANE, &nh);
+      tasks.push_back(std::async(std::launch::async, registerVectormapPortion<DTLane, DTLaneArray>, file_path, &dtlane_pub, "vector_map_info/dtlane", Category::DTLANE, &nh));
     }
     else if (file_name == "node.csv")
     {
-      category |= registerVectormapPortion<Node, NodeArray>(file_path, &node_pub, "vector_map_info/node", Category::NODE, &nh);
+      tasks.push_back(std::async(std::launch::async, registerVectormapPortion<Node, NodeArray>, file_path, &node_pub, "vector_map_info/node", Category::NODE, &nh));
     }
     else if (file_name == "lane.csv")
     {
-      category |= registerVectormapPortion<Lane, LaneArray>(file_path, &lane_pub, "vector_map_info/lane", Category::LANE, &nh);
+      tasks.push_back(std::async(std::launch::async, registerVectormapPortion<Lane, LaneArray>, file_path, &lane_pub, "vector_map_info/lane", Category::LANE, &nh));
     }
     else if (file_name == "wayarea.csv")
     {
-      category |= registerVectormapPortion<WayArea, WayAreaArray>(file_path, &way_area_pub, "vector_map_info/way_area", Category::WAY_AREA, &nh);
+      tasks.push_back(std::async(std::launch::async, registerVectormapPortion<WayArea, WayAreaArray>, file_path, &way_area_pub, "vector_map_info/way_area", Category::WAY_AREA, &nh));
     }
     else if (file_name == "roadedge.csv")
     {
-      category |= registerVectormapPortion<RoadEdge, RoadEdgeArray>(file_path, &road_edge_pub, "vector_map_info/road_edge", Category::ROAD_EDGE, &nh);
+      tasks.push_back(std::async(std::launch::async, registerVectormapPortion<RoadEdge, RoadEdgeArray>, file_path, &road_edge_pub, "vector_map_info/road_edge", Category::ROAD_EDGE, &nh));
     }
     else if (file_name == "gutter.csv")
     {
-      category |= registerVectormapPortion<Gutter, GutterArray>(file_path, &gutter_pub, "vector_map_info/gutter", Category::GUTTER, &nh);
+      tasks.push_back(std::async(std::launch::async, registerVectormapPortion<Gutter, GutterArray>, file_path, &gutter_pub, "vector_map_info/gutter", Category::GUTTER, &nh));
     }
     else if (file_name == "curb.csv")
     {
-      category |= registerVectormapPortion<Curb, CurbArray>(file_path, &curb_pub, "vector_map_info/curb", Category::CURB, &nh);
+      tasks.push_back(std::async(std::launch::async, registerVectormapPortion<Curb, CurbArray>, file_path, &curb_pub, "vector_map_info/curb", Category::CURB, &nh));
     }
     else if (file_name == "whiteline.csv")
     {
-      category |= registerVectormapPortion<WhiteLine, WhiteLineArray>(file_path, &white_line_pub, "vector_map_info/white_line", Category::WHITE_LINE, &nh);
+      tasks.push_back(std::async(std::launch::async, registerVectormapPortion<WhiteLine, WhiteLineArray>, file_path, &white_line_pub, "vector_map_info/white_line", Category::WHITE_LINE, &nh));
     }
     else if (file_name == "stopline.csv")
     {
-      category |= registerVectormapPortion<StopLine, StopLineArray>(file_path, &stop_line_pub, "vector_map_info/stop_line", Category::STOP_LINE, &nh);
+      tasks.push_back(std::async(std::launch::async, registerVectormapPortion<StopLine, StopLineArray>, file_path, &stop_line_pub, "vector_map_info/stop_line", Category::STOP_LINE, &nh));
     }
     else if (file_name == "zebrazone.csv")
     {
-      category |= registerVectormapPortion<ZebraZone, ZebraZoneArray>(file_path, &zebra_zone_pub, "vector_map_info/zebra_zone", Category::ZEBRA_ZONE, &nh);
+      tasks.push_back(std::async(std::launch::async, registerVectormapPortion<ZebraZone, ZebraZoneArray>, file_path, &zebra_zone_pub, "vector_map_info/zebra_zone", Category::ZEBRA_ZONE, &nh));
     }
     else if (file_name == "crosswalk.csv")
     {
-      category |= registerVectormapPortion<CrossWalk, CrossWalkArray>(file_path, &cross_walk_pub, "vector_map_info/cross_walk", Category::CROSS_WALK, &nh);
+      tasks.push_back(std::async(std::launch::async, registerVectormapPortion<CrossWalk, CrossWalkArray>, file_path, &cross_walk_pub, "vector_map_info/cross_walk", Category::CROSS_WALK, &nh));
     }
     else if (file_name == "road_surface_mark.csv")
     {
-      category |= registerVectormapPortion<RoadMark, RoadMarkArray>(file_path, &road_mark_pub, "vector_map_info/road_mark", Category::ROAD_MARK, &nh);
+      tasks.push_back(std::async(std::launch::async, registerVectormapPortion<RoadMark, RoadMarkArray>, file_path, &road_mark_pub, "vector_map_info/road_mark", Category::ROAD_MARK, &nh));
     }
     else if (file_name == "poledata.csv")
     {
-      category |= registerVectormapPortion<RoadPole, RoadPoleArray>(file_path, &road_pole_pub, "vector_map_info/road_pole", Category::ROAD_POLE, &nh);
+      tasks.push_back(std::async(std::launch::async, registerVectormapPortion<RoadPole, RoadPoleArray>, file_path, &road_pole_pub, "vector_map_info/road_pole", Category::ROAD_POLE, &nh));
     }
     else if (file_name == "roadsign.csv")
     {
-      category |= registerVectormapPortion<RoadSign, RoadSignArray>(file_path, &road_sign_pub, "vector_map_info/road_sign", Category::ROAD_SIGN, &nh);
+      tasks.push_back(std::async(std::launch::async, registerVectormapPortion<RoadSign, RoadSignArray>, file_path, &road_sign_pub, "vector_map_info/road_sign", Category::ROAD_SIGN, &nh));
     }
     else if (file_name == "signaldata.csv")
     {
-      category |= registerVectormapPortion<Signal, SignalArray>(file_path, &signal_pub, "vector_map_info/signal", Category::SIGNAL, &nh);
+      tasks.push_back(std::async(std::launch::async, registerVectormapPortion<Signal, SignalArray>, file_path, &signal_pub, "vector_map_info/signal", Category::SIGNAL, &nh));
     }
     else if (file_name == "streetlight.csv")
     {
-      category |= registerVectormapPortion<StreetLight, StreetLightArray>(file_path, &street_light_pub, "vector_map_info/street_light", Category::STREET_LIGHT, &nh);
+      tasks.push_back(std::async(std::launch::async, registerVectormapPortion<StreetLight, StreetLightArray>, file_path, &street_light_pub, "vector_map_info/street_light", Category::STREET_LIGHT, &nh));
     }
     else if (file_name == "utilitypole.csv")
     {
-      category |= registerVectormapPortion<UtilityPole, UtilityPoleArray>(file_path, &utility_pole_pub, "vector_map_info/utility_pole", Category::UTILITY_POLE, &nh);
+      tasks.push_back(std::async(std::launch::async, registerVectormapPortion<UtilityPole, UtilityPoleArray>, file_path, &utility_pole_pub, "vector_map_info/utility_pole", Category::UTILITY_POLE, &nh));
     }
     else if (file_name == "guardrail.csv")
     {
-      category |= registerVectormapPortion<GuardRail, GuardRailArray>(file_path, &guard_rail_pub, "vector_map_info/guard_rail", Category::GUARD_RAIL, &nh);
+      tasks.push_back(std::async(std::launch::async, registerVectormapPortion<GuardRail, GuardRailArray>, file_path, &guard_rail_pub, "vector_map_info/guard_rail", Category::GUARD_RAIL, &nh));
     }
     else if (file_name == "sidewalk.csv")
     {
-      category |= registerVectormapPortion<SideWalk, SideWalkArray>(file_path, &side_walk_pub, "vector_map_info/side_walk", Category::SIDE_WALK, &nh);
+      tasks.push_back(std::async(std::launch::async, registerVectormapPortion<SideWalk, SideWalkArray>, file_path, &side_walk_pub, "vector_map_info/side_walk", Category::SIDE_WALK, &nh));
     }
     else if (file_name == "driveon_portion.csv")
     {
-      category |= registerVectormapPortion<DriveOnPortion, DriveOnPortionArray>(file_path, &drive_on_portion_pub, "vector_map_info/drive_on_portion", Category::DRIVE_ON_PORTION, &nh);
+      tasks.push_back(std::async(std::launch::async, registerVectormapPortion<DriveOnPortion, DriveOnPortionArray>, file_path, &drive_on_portion_pub, "vector_map_info/drive_on_portion", Category::DRIVE_ON_PORTION, &nh));
     }
     else if (file_name == "intersection.csv")
     {
-      category |= registerVectormapPortion<CrossRoad, CrossRoadArray>(file_path, &cross_road_pub, "vector_map_info/cross_road", Category::CROSS_ROAD, &nh);
+      tasks.push_back(std::async(std::launch::async, registerVectormapPortion<CrossRoad, CrossRoadArray>, file_path, &cross_road_pub, "vector_map_info/cross_road", Category::CROSS_ROAD, &nh));
     }
     else if (file_name == "sidestrip.csv")
     {
-      category |= registerVectormapPortion<SideStrip, SideStripArray>(file_path, &side_strip_pub, "vector_map_info/side_strip", Category::SIDE_STRIP, &nh);
+      tasks.push_back(std::async(std::launch::async, registerVectormapPortion<SideStrip, SideStripArray>, file_path, &side_strip_pub, "vector_map_info/side_strip", Category::SIDE_STRIP, &nh));
     }
     else if (file_name == "curvemirror.csv")
     {
-      category |= registerVectormapPortion<CurveMirror, CurveMirrorArray>(file_path, &curve_mirror_pub, "vector_map_info/curve_mirror", Category::CURVE_MIRROR, &nh);
+      tasks.push_back(std::async(std::launch::async, registerVectormapPortion<CurveMirror, CurveMirrorArray>, file_path, &curve_mirror_pub, "vector_map_info/curve_mirror", Category::CURVE_MIRROR, &nh));
     }
     else if (file_name == "wall.csv")
     {
-      category |= registerVectormapPortion<Wall, WallArray>(file_path, &wall_pub, "vector_map_info/wall", Category::WALL, &nh);
+      tasks.push_back(std::async(std::launch::async, registerVectormapPortion<Wall, WallArray>, file_path, &wall_pub, "vector_map_info/wall", Category::WALL, &nh));
     }
     else if (file_name == "fence.csv")
     {
-      category |= registerVectormapPortion<Fence, FenceArray>(file_path, &fence_pub, "vector_map_info/fence", Category::FENCE, &nh);
+      tasks.push_back(std::async(std::launch::async, registerVectormapPortion<Fence, FenceArray>, file_path, &fence_pub, "vector_map_info/fence", Category::FENCE, &nh));
     }
     else if (file_name == "railroad_crossing.csv")
     {
-      category |= registerVectormapPortion<RailCrossing, RailCrossingArray>(file_path, &rail_crossing_pub, "vector_map_info/rail_crossing", Category::RAIL_CROSSING, &nh);
+      tasks.push_back(std::async(std::launch::async, registerVectormapPortion<RailCrossing, RailCrossingArray>, file_path, &rail_crossing_pub, "vector_map_info/rail_crossing", Category::RAIL_CROSSING, &nh));
     }
     else
     {
@@ -1271,35 +1474,113 @@ int main(int argc, char **argv)
     }
   }
 
+  vector_map::category_t category = Category::NONE;
+  for (auto& task : tasks)
+    category |= task.get();
   ROS_INFO("Published vector_map_info topics");
 
+  // the tiles and the visualization are built from the published categories
   VectorMap vmap;
-  vmap.subscribe(nh, category);
+  bool subscribed = publish_tiles || !snapshot_file.empty();
+  if (!snapshot_file.empty())
+    vmap.enableSpatialIndex(snapshot_cell_size);
+  if (subscribed)
+    subscribeVectorMap(nh, vmap, category);
+
+  if (!snapshot_file.empty())
+  {
+    if (vmap.saveSnapshot(snapshot_file, category))
+      ROS_INFO_STREAM("Saved vector map snapshot " << snapshot_file);
+    else
+      ROS_ERROR_STREAM("failed to save vector map snapshot " << snapshot_file);
+  }
+
+  std::vector<ros::Publisher> tile_pubs;
+  ros::Publisher tile_index_pub;
+  if (publish_tiles)
+  {
+
+    vector_map::TileIndex tile_index;
+    std::vector<std::pair<std::string, std_msgs::UInt8MultiArray>> chunks;
+    vector_map::createTileChunks(vmap, category, tile_size, compress_tiles, tile_index, chunks);
+    size_t bytes = 0;
+    for (const auto& chunk : chunks)
+    {
+      tile_pubs.push_back(nh.advertise<std_msgs::UInt8MultiArray>(chunk.first, 1, true));
+      tile_pubs.back().publish(chunk.second);
+      bytes += chunk.second.data.size();
+    }
+
+    // published last, a subscriber finds every tile it lists
+    std_msgs::UInt8MultiArray tile_index_msg;
+    vector_map::encodeTileIndex(tile_index, tile_index_msg);
+    tile_index_pub = nh.advertise<std_msgs::UInt8MultiArray>(vector_map::TILE_INDEX_TOPIC, 1, true);
+    tile_index_pub.publish(tile_index_msg);
+    ROS_INFO_STREAM("Published " << chunks.size() << " vector_map_info tiles, " << bytes << " bytes");
+  }
 
   visualization_msgs::MarkerArray marker_array;
-  insertMarkerArray(marker_array, createRoadEdgeMarkerArray(vmap, Color::GRAY));
-  insertMarkerArray(marker_array, createGutterMarkerArray(vmap, Color::GRAY, Color::GRAY, Color::GRAY));
-  insertMarkerArray(marker_array, createCurbMarkerArray(vmap, Color::GRAY));
-  insertMarkerArray(marker_array, createWhiteLineMarkerArray(vmap, Color::WHITE, Color::YELLOW));
-  insertMarkerArray(marker_array, createStopLineMarkerArray(vmap, Color::WHITE));
-  insertMarkerArray(marker_array, createZebraZoneMarkerArray(vmap, Color::WHITE));
-  insertMarkerArray(marker_array, createCrossWalkMarkerArray(vmap, Color::WHITE));
-  insertMarkerArray(marker_array, createRoadMarkMarkerArray(vmap, Color::WHITE));
-  insertMarkerArray(marker_array, createRoadPoleMarkerArray(vmap, Color::GRAY));
-  insertMarkerArray(marker_array, createRoadSignMarkerArray(vmap, Color::GREEN, Color::GRAY));
-  insertMarkerArray(marker_array, createSignalMarkerArray(vmap, Color::RED, Color::BLUE, Color::YELLOW, Color::CYAN,
-                                                          Color::GRAY));
-  insertMarkerArray(marker_array, createStreetLightMarkerArray(vmap, Color::YELLOW, Color::GRAY));
-  insertMarkerArray(marker_array, createUtilityPoleMarkerArray(vmap, Color::GRAY));
-  insertMarkerArray(marker_array, createGuardRailMarkerArray(vmap, Color::LIGHT_BLUE));
-  insertMarkerArray(marker_array, createSideWalkMarkerArray(vmap, Color::GRAY));
-  insertMarkerArray(marker_array, createDriveOnPortionMarkerArray(vmap, Color::LIGHT_CYAN));
-  insertMarkerArray(marker_array, createCrossRoadMarkerArray(vmap, Color::LIGHT_GREEN));
-  insertMarkerArray(marker_array, createSideStripMarkerArray(vmap, Color::GRAY));
-  insertMarkerArray(marker_array, createCurveMirrorMarkerArray(vmap, Color::MAGENTA, Color::GRAY));
-  insertMarkerArray(marker_array, createWallMarkerArray(vmap, Color::LIGHT_YELLOW));
-  insertMarkerArray(marker_array, createFenceMarkerArray(vmap, Color::LIGHT_RED));
-  insertMarkerArray(marker_array, createRailCrossingMarkerArray(vmap, Color::LIGHT_MAGENTA));
+  std::string marker_cache_path;
+  if (!marker_cache_dir.empty())
+  {
+    createDirectories(marker_cache_dir);
+    char checksum[17];
+    snprintf(checksum, sizeof(checksum), "%016llx", static_cast<unsigned long long>(computeMapChecksum(file_paths)));
+    marker_cache_path = marker_cache_dir + "/" + checksum + ".markers";
+  }
+
+  if (!marker_cache_path.empty() && loadMarkerCache(marker_cache_path, marker_array))
+  {
+    ROS_INFO_STREAM("Loaded vector_map visualization from " << marker_cache_path);
+  }
+  else
+  {
+    if (!subscribed)
+      subscribeVectorMap(nh, vmap, category);
+
+    // vmap is not updated anymore (no spin until the end), the marker arrays are built in parallel from it
+    std::vector<std::future<visualization_msgs::MarkerArray>> marker_tasks;
+    marker_tasks.push_back(createMarkerArrayAsync(createRoadEdgeMarkerArray, vmap, Color::GRAY));
+    marker_tasks.push_back(createMarkerArrayAsync(createGutterMarkerArray, vmap, Color::GRAY, Color::GRAY,
+                                                  Color::GRAY));
+    marker_tasks.push_back(createMarkerArrayAsync(createCurbMarkerArray, vmap, Color::GRAY));
+    marker_tasks.push_back(createMarkerArrayAsync(createWhiteLineMarkerArray, vmap, Color::WHITE, Color::YELLOW));
+    marker_tasks.push_back(createMarkerArrayAsync(createStopLineMarkerArray, vmap, Color::WHITE));
+    marker_tasks.push_back(createMarkerArrayAsync(createZebraZoneMarkerArray, vmap, Color::WHITE));
+    marker_tasks.push_back(createMarkerArrayAsync(createCrossWalkMarkerArray, vmap, Color::WHITE));
+    marker_tasks.push_back(createMarkerArrayAsync(createRoadMarkMarkerArray, vmap, Color::WHITE));
+    marker_tasks.push_back(createMarkerArrayAsync(createRoadPoleMarkerArray, vmap, Color::GRAY));
+    marker_tasks.push_back(createMarkerArrayAsync(createRoadSignMarkerArray, vmap, Color::GREEN, Color::GRAY));
+    marker_tasks.push_back(createMarkerArrayAsync(createSignalMarkerArray, vmap, Color::RED, Color::BLUE, Color::YELLOW,
+                                                  Color::CYAN, Color::GRAY));
+    marker_tasks.push_back(createMarkerArrayAsync(createStreetLightMarkerArray, vmap, Color::YELLOW, Color::GRAY));
+    marker_tasks.push_back(createMarkerArrayAsync(createUtilityPoleMarkerArray, vmap, Color::GRAY));
+    marker_tasks.push_back(createMarkerArrayAsync(createGuardRailMarkerArray, vmap, Color::LIGHT_BLUE));
+    marker_tasks.push_back(createMarkerArrayAsync(createSideWalkMarkerArray, vmap, Color::GRAY));
+    marker_tasks.push_back(createMarkerArrayAsync(createDriveOnPortionMarkerArray, vmap, Color::LIGHT_CYAN));
+    marker_tasks.push_back(createMarkerArrayAsync(createCrossRoadMarkerArray, vmap, Color::LIGHT_GREEN));
+    marker_tasks.push_back(createMarkerArrayAsync(createSideStripMarkerArray, vmap, Color::GRAY));
+    marker_tasks.push_back(createMarkerArrayAsync(createCurveMirrorMarkerArray, vmap, Color::MAGENTA, Color::GRAY));
+    marker_tasks.push_back(createMarkerArrayAsync(createWallMarkerArray, vmap, Color::LIGHT_YELLOW));
+    marker_tasks.push_back(createMarkerArrayAsync(createFenceMarkerArray, vmap, Color::LIGHT_RED));
+    marker_tasks.push_back(createMarkerArrayAsync(createRailCrossingMarkerArray, vmap, Color::LIGHT_MAGENTA));
+
+    std::vector<visualization_msgs::MarkerArray> marker_arrays;
+    size_t marker_count = 0;
+    for (auto& marker_task : marker_tasks)
+    {
+      marker_arrays.push_back(marker_task.get());
+      marker_count += marker_arrays.back().markers.size();
+    }
+    marker_array.markers.reserve(marker_count);
+    for (auto& created_marker_array : marker_arrays)
+      insertMarkerArray(marker_array, std::move(created_marker_array));
+
+    if (!marker_cache_path.empty() && !saveMarkerCache(marker_cache_path, marker_array))
+      ROS_WARN_STREAM("failed to write marker cache " << marker_cache_path);
+  }
+  if (batch_line_markers)
+    marker_array = createLineListMarkerArray(marker_array);
   marker_array_pub.publish(marker_array);
   ROS_INFO("Published vector_map visualization");
 
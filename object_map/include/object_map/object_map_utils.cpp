@@ -18,8 +18,183 @@
 
 #include "object_map/object_map_utils.hpp"
 
+#include <opencv2/imgproc/imgproc.hpp>
+
+#include <boost/make_shared.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
 namespace object_map
 {
+  namespace
+  {
+    // fixed point bits of the vertices given to cv::fillConvexPoly
+    constexpr int kFillShift = 8;
+
+    int FloorDivide(int in_value, int in_divisor)
+    {
+      int quotient = in_value / in_divisor;
+      return (in_value % in_divisor < 0) ? quotient - 1 : quotient;
+    }
+  }  // namespace
+
+  WayareaRasterCache::WayareaRasterCache(double in_resolution, int in_tile_size) :
+      resolution_(in_resolution), tile_size_(in_tile_size)
+  {
+  }
+
+  void WayareaRasterCache::Rasterize(const std::vector<std::vector<geometry_msgs::Point>> &in_area_points)
+  {
+    tiles_.clear();
+
+    for (const auto &points : in_area_points)
+    {
+      if (points.empty())
+        continue;
+
+      // pixel (u, v) covers [u, u + 1) x [v, v + 1) resolutions, its center is at (u, v) for opencv
+      std::vector<cv::Point2d> pixels;
+      double min_u = std::numeric_limits<double>::max();
+      double min_v = std::numeric_limits<double>::max();
+      double max_u = std::numeric_limits<double>::lowest();
+      double max_v = std::numeric_limits<double>::lowest();
+      for (const auto &p : points)
+      {
+        pixels.emplace_back(p.x / resolution_ - 0.5, p.y / resolution_ - 0.5);
+        min_u = std::min(min_u, pixels.back().x);
+        min_v = std::min(min_v, pixels.back().y);
+        max_u = std::max(max_u, pixels.back().x);
+        max_v = std::max(max_v, pixels.back().y);
+      }
+
+      int min_tile_x = FloorDivide(static_cast<int>(std::floor(min_u)), tile_size_);
+      int min_tile_y = FloorDivide(static_cast<int>(std::floor(min_v)), tile_size_);
+      int max_tile_x = FloorDivide(static_cast<int>(std::ceil(max_u)), tile_size_);
+      int max_tile_y = FloorDivide(static_cast<int>(std::ceil(max_v)), tile_size_);
+
+      std::vector<cv::Point> cv_points(pixels.size());
+      for (int tile_y = min_tile_y; tile_y <= max_tile_y; tile_y++)
+      {
+        for (int tile_x = min_tile_x; tile_x <= max_tile_x; tile_x++)
+        {
+          cv::Mat &tile = tiles_[std::make_pair(tile_x, tile_y)];
+          if (tile.empty())
+            tile = cv::Mat::zeros(tile_size_, tile_size_, CV_8UC1);
+
+          for (size_t i = 0; i < pixels.size(); i++)
+          {
+            cv_points[i] = cv::Point(std::lround((pixels[i].x - tile_x * tile_size_) * (1 << kFillShift)),
+                                     std::lround((pixels[i].y - tile_y * tile_size_) * (1 << kFillShift)));
+          }
+          cv::fillConvexPoly(tile, cv_points.data(), static_cast<int>(cv_points.size()), cv::Scalar(255), cv::LINE_8, kFillShift);
+        }
+      }
+    }
+
+    // the bounding box of an area may reach tiles the area does not
+    for (auto it = tiles_.begin(); it != tiles_.end();)
+    {
+      if (cv::countNonZero(it->second) == 0)
+        it = tiles_.erase(it);
+      else
+        ++it;
+    }
+  }
+
+  bool WayareaRasterCache::IsWayarea(double in_x, double in_y) const
+  {
+    int u = static_cast<int>(std::floor(in_x / resolution_));
+    int v = static_cast<int>(std::floor(in_y / resolution_));
+    int tile_x = FloorDivide(u, tile_size_);
+    int tile_y = FloorDivide(v, tile_size_);
+
+    auto it = tiles_.find(std::make_pair(tile_x, tile_y));
+    if (it == tiles_.end())
+      return false;
+
+    return it->second.at<unsigned char>(v - tile_y * tile_size_, u - tile_x * tile_size_) != 0;
+  }
+
+  bool WayareaRasterCache::Empty() const
+  {
+    return tiles_.empty();
+  }
+
+  WayareaSpatialIndex::WayareaSpatialIndex(double in_bucket_size) : bucket_size_(in_bucket_size)
+  {
+  }
+
+  void WayareaSpatialIndex::Build(const std::vector<std::vector<geometry_msgs::Point>> &in_area_points)
+  {
+    boxes_.clear();
+    buckets_.clear();
+
+    for (size_t i = 0; i < in_area_points.size(); i++)
+    {
+      Box box;
+      box.min_x = std::numeric_limits<double>::max();
+      box.min_y = std::numeric_limits<double>::max();
+      box.max_x = std::numeric_limits<double>::lowest();
+      box.max_y = std::numeric_limits<double>::lowest();
+      for (const auto &p : in_area_points[i])
+      {
+        box.min_x = std::min(box.min_x, p.x);
+        box.min_y = std::min(box.min_y, p.y);
+        box.max_x = std::max(box.max_x, p.x);
+        box.max_y = std::max(box.max_y, p.y);
+      }
+      boxes_.push_back(box);
+
+      // empty areas are in no bucket
+      if (in_area_points[i].empty())
+        continue;
+      for (int y = Bucket(box.min_y); y <= Bucket(box.max_y); y++)
+      {
+        for (int x = Bucket(box.min_x); x <= Bucket(box.max_x); x++)
+          buckets_[std::make_pair(x, y)].push_back(i);
+      }
+    }
+  }
+
+  std::vector<size_t> WayareaSpatialIndex::Search(double in_min_x, double in_min_y,
+                                                  double in_max_x, double in_max_y) const
+  {
+    std::vector<size_t> areas;
+    for (int y = Bucket(in_min_y); y <= Bucket(in_max_y); y++)
+    {
+      for (int x = Bucket(in_min_x); x <= Bucket(in_max_x); x++)
+      {
+        auto it = buckets_.find(std::make_pair(x, y));
+        if (it == buckets_.end())
+          continue;
+
+        for (const auto i : it->second)
+        {
+          const Box &box = boxes_[i];
+          if (box.min_x <= in_max_x && in_min_x <= box.max_x && box.min_y <= in_max_y && in_min_y <= box.max_y)
+            areas.push_back(i);
+        }
+      }
+    }
+
+    // an area is in every bucket its box overlaps
+    std::sort(areas.begin(), areas.end());
+    areas.erase(std::unique(areas.begin(), areas.end()), areas.end());
+    return areas;
+  }
+
+  bool WayareaSpatialIndex::Empty() const
+  {
+    return buckets_.empty();
+  }
+
+  int WayareaSpatialIndex::Bucket(double in_coordinate) const
+  {
+    return static_cast<int>(std::floor(in_coordinate / bucket_size_));
+  }
+
   geometry_msgs::Point TransformPoint(const geometry_msgs::Point &in_point, const tf::Transform &in_tf)
   {
     tf::Point tf_point;
@@ -35,8 +210,9 @@ namespace object_map
 
   void PublishGridMap(const grid_map::GridMap &in_gridmap, const ros::Publisher &in_publisher)
   {
-    grid_map_msgs::GridMap message;
-    grid_map::GridMapRosConverter::toMessage(in_gridmap, message);
+    // published by pointer, subscribers in the same process receive it without serialization
+    boost::shared_ptr<grid_map_msgs::GridMap> message = boost::make_shared<grid_map_msgs::GridMap>();
+    grid_map::GridMapRosConverter::toMessage(in_gridmap, *message);
     in_publisher.publish(message);
   }
 
@@ -47,12 +223,145 @@ namespace object_map
                             double in_max_value,
                             double in_height)
   {
-    nav_msgs::OccupancyGrid message;
-    grid_map::GridMapRosConverter::toOccupancyGrid(in_gridmap, in_layer, in_min_value, in_max_value, message );
-    message.info.origin.position.z = in_height;
+    boost::shared_ptr<nav_msgs::OccupancyGrid> message = boost::make_shared<nav_msgs::OccupancyGrid>();
+    ToOccupancyGrid(in_gridmap, in_layer, in_min_value, in_max_value, *message);
+    message->info.origin.position.z = in_height;
     in_publisher.publish(message);
   }
 
+  cv::Mat LayerImageView(grid_map::GridMap &in_grid_map, const std::string &in_layer)
+  {
+    if (!in_grid_map.getStartIndex().isZero())
+      in_grid_map.convertToDefaultStartIndex();
+
+    grid_map::Matrix &data = in_grid_map[in_layer];
+    return cv::Mat(data.cols(), data.rows(), CV_32FC1, data.data());
+  }
+
+  cv::Mat LayerToImage(grid_map::GridMap &in_grid_map, const std::string &in_layer,
+                       float in_lower_value, float in_upper_value)
+  {
+    if (!in_grid_map.getStartIndex().isZero())
+      in_grid_map.convertToDefaultStartIndex();
+
+    const grid_map::Matrix &data = in_grid_map[in_layer];
+    cv::Mat image(data.cols(), data.rows(), CV_8UC1);
+    const float *values = data.data();
+    unsigned char *pixels = image.ptr<unsigned char>();
+    const float image_max = std::numeric_limits<unsigned char>::max();
+    for (int i = 0; i < data.size(); i++)
+    {
+      float value = values[i];
+      if (!std::isfinite(value))
+      {
+        pixels[i] = 0;
+        continue;
+      }
+      value = std::min(std::max(value, in_lower_value), in_upper_value);
+      pixels[i] = static_cast<unsigned char>(((value - in_lower_value) / (in_upper_value - in_lower_value)) * image_max);
+    }
+    return image;
+  }
+
+  void ImageToLayer(const cv::Mat &in_image, float in_lower_value, float in_upper_value,
+                    grid_map::GridMap &out_grid_map, const std::string &in_layer)
+  {
+    if (!out_grid_map.exists(in_layer))
+      out_grid_map.add(in_layer);
+    if (!out_grid_map.getStartIndex().isZero())
+      out_grid_map.convertToDefaultStartIndex();
+
+    grid_map::Matrix &data = out_grid_map[in_layer];
+    if (in_image.rows != data.cols() || in_image.cols != data.rows() || in_image.type() != CV_8UC1)
+    {
+      ROS_ERROR("Image does not match the %s layer", in_layer.c_str());
+      return;
+    }
+
+    const float image_max = std::numeric_limits<unsigned char>::max();
+    const float difference = in_upper_value - in_lower_value;
+    float *values = data.data();
+    for (int y = 0; y < in_image.rows; y++)
+    {
+      const unsigned char *row = in_image.ptr<unsigned char>(y);
+      float *row_values = values + y * in_image.cols;
+      for (int x = 0; x < in_image.cols; x++)
+        row_values[x] = in_lower_value + difference * (static_cast<float>(row[x]) / image_max);
+    }
+  }
+
+  void FromOccupancyGrid(const nav_msgs::OccupancyGrid &in_occupancy_grid, const std::string &in_layer,
+                         grid_map::GridMap &out_grid_map)
+  {
+    const double resolution = in_occupancy_grid.info.resolution;
+    grid_map::Length length(in_occupancy_grid.info.width * resolution, in_occupancy_grid.info.height * resolution);
+    grid_map::Position position(in_occupancy_grid.info.origin.position.x + 0.5 * length.x(),
+                                in_occupancy_grid.info.origin.position.y + 0.5 * length.y());
+
+    out_grid_map.setFrameId(in_occupancy_grid.header.frame_id);
+    out_grid_map.setTimestamp(in_occupancy_grid.header.stamp.toNSec());
+    out_grid_map.setGeometry(length, resolution, position);
+    if (!out_grid_map.exists(in_layer))
+      out_grid_map.add(in_layer);
+
+    grid_map::Matrix &data = out_grid_map[in_layer];
+    if (static_cast<size_t>(data.size()) != in_occupancy_grid.data.size())
+    {
+      ROS_ERROR("OccupancyGrid data does not match its size");
+      return;
+    }
+
+    // the occupancy grid starts at the origin corner, the grid map at the opposite one
+    const size_t cell_count = in_occupancy_grid.data.size();
+    float *values = data.data();
+    for (size_t i = 0; i < cell_count; i++)
+    {
+      const int8_t occupancy = in_occupancy_grid.data[cell_count - i - 1];
+      values[i] = (occupancy != -1) ? occupancy : NAN;
+    }
+  }
+
+  void ToOccupancyGrid(const grid_map::GridMap &in_grid_map, const std::string &in_layer, float in_min_value,
+                       float in_max_value, nav_msgs::OccupancyGrid &out_occupancy_grid)
+  {
+    if (!in_grid_map.getStartIndex().isZero())
+    {
+      grid_map::GridMapRosConverter::toOccupancyGrid(in_grid_map, in_layer, in_min_value, in_max_value,
+                                                     out_occupancy_grid);
+      return;
+    }
+
+    out_occupancy_grid.header.frame_id = in_grid_map.getFrameId();
+    out_occupancy_grid.header.stamp.fromNSec(in_grid_map.getTimestamp());
+    out_occupancy_grid.info.map_load_time = out_occupancy_grid.header.stamp;
+    out_occupancy_grid.info.resolution = in_grid_map.getResolution();
+    out_occupancy_grid.info.width = in_grid_map.getSize()(0);
+    out_occupancy_grid.info.height = in_grid_map.getSize()(1);
+    grid_map::Position position = in_grid_map.getPosition() - 0.5 * in_grid_map.getLength().matrix();
+    out_occupancy_grid.info.origin.position.x = position.x();
+    out_occupancy_grid.info.origin.position.y = position.y();
+    out_occupancy_grid.info.origin.position.z = 0.0;
+    out_occupancy_grid.info.origin.orientation.x = 0.0;
+    out_occupancy_grid.info.origin.orientation.y = 0.0;
+    out_occupancy_grid.info.origin.orientation.z = 0.0;
+    out_occupancy_grid.info.origin.orientation.w = 1.0;
+
+    // occupancy is in [0, 100], unknown is -1
+    const grid_map::Matrix &data = in_grid_map[in_layer];
+    const size_t cell_count = data.size();
+    const float *values = data.data();
+    out_occupancy_grid.data.resize(cell_count);
+    for (size_t i = 0; i < cell_count; i++)
+    {
+      float value = (values[i] - in_min_value) / (in_max_value - in_min_value);
+      if (std::isnan(value))
+        value = -1;
+      else
+        value = 100.0f * std::min(std::max(0.0f, value), 1.0f);
+      out_occupancy_grid.data[cell_count - i - 1] = value;
+    }
+  }
+
   tf::StampedTransform FindTransform(const std::string &in_target_frame, const std::string &in_source_frame,
                                      const tf::TransformListener &in_tf_listener)
   {
@@ -79,95 +388,172 @@ namespace object_map
     if (in_area.aid == 0)
       return area_points_empty;
 
-    vector_map_msgs::Line line = in_vectormap.findByKey(vector_map::Key<vector_map_msgs::Line>(in_area.slid));
+    const vector_map_msgs::Line* line = in_vectormap.findPtrByKey(vector_map::Key<vector_map_msgs::Line>(in_area.slid));
     // must set beginning line
-    if (line.lid == 0 || line.blid != 0)
+    if (line == nullptr || line->blid != 0)
       return area_points_empty;
 
     // Search all lines in in_area
-    while (line.flid != 0)
+    while (line->flid != 0)
     {
-      vector_map_msgs::Point bp = in_vectormap.findByKey(vector_map::Key<vector_map_msgs::Point>(line.bpid));
-      if (bp.pid == 0)
+      const vector_map_msgs::Point* bp = in_vectormap.findPtrByKey(vector_map::Key<vector_map_msgs::Point>(line->bpid));
+      if (bp == nullptr)
         return area_points_empty;
 
-      vector_map_msgs::Point fp = in_vectormap.findByKey(vector_map::Key<vector_map_msgs::Point>(line.fpid));
-      if (fp.pid == 0)
+      const vector_map_msgs::Point* fp = in_vectormap.findPtrByKey(vector_map::Key<vector_map_msgs::Point>(line->fpid));
+      if (fp == nullptr)
         return area_points_empty;
 
       // 2 points of line
-      area_points.push_back(vector_map::convertPointToGeomPoint(bp));
-      area_points.push_back(vector_map::convertPointToGeomPoint(fp));
+      area_points.push_back(vector_map::convertPointToGeomPoint(*bp));
+      area_points.push_back(vector_map::convertPointToGeomPoint(*fp));
 
-      line = in_vectormap.findByKey(vector_map::Key<vector_map_msgs::Line>(line.flid));
-      if (line.lid == 0)
+      line = in_vectormap.findPtrByKey(vector_map::Key<vector_map_msgs::Line>(line->flid));
+      if (line == nullptr)
         return area_points_empty;
     }
 
-    vector_map_msgs::Point bp = in_vectormap.findByKey(vector_map::Key<vector_map_msgs::Point>(line.bpid));
-    vector_map_msgs::Point fp = in_vectormap.findByKey(vector_map::Key<vector_map_msgs::Point>(line.fpid));
-    if (bp.pid == 0 || fp.pid == 0)
+    const vector_map_msgs::Point* bp = in_vectormap.findPtrByKey(vector_map::Key<vector_map_msgs::Point>(line->bpid));
+    const vector_map_msgs::Point* fp = in_vectormap.findPtrByKey(vector_map::Key<vector_map_msgs::Point>(line->fpid));
+    if (bp == nullptr || fp == nullptr)
       return area_points_empty;
 
-    area_points.push_back(vector_map::convertPointToGeomPoint(bp));
-    area_points.push_back(vector_map::convertPointToGeomPoint(fp));
+    area_points.push_back(vector_map::convertPointToGeomPoint(*bp));
+    area_points.push_back(vector_map::convertPointToGeomPoint(*fp));
 
     return area_points;
   }
 
+  namespace
+  {
+    // fills the areas of in_area_index intersecting the grid, or all the areas if in_area_index is null
+    void FillSelectedPolygonAreas(grid_map::GridMap &out_grid_map,
+                                  const std::vector<std::vector<geometry_msgs::Point>> &in_area_points,
+                                  const WayareaSpatialIndex *in_area_index,
+                                  const std::string &in_grid_layer_name, const int in_layer_background_value,
+                                  const int in_layer_min_value, const int in_fill_color, const int in_layer_max_value,
+                                  const std::string &in_tf_target_frame, const std::string &in_tf_source_frame,
+                                  const tf::TransformListener &in_tf_listener)
+    {
+      if(!out_grid_map.exists(in_grid_layer_name))
+      {
+        out_grid_map.add(in_grid_layer_name);
+      }
+      out_grid_map[in_grid_layer_name].setConstant(in_layer_background_value);
+
+      cv::Mat filled_image = LayerToImage(out_grid_map, in_grid_layer_name, in_layer_min_value, in_layer_max_value);
+
+      tf::StampedTransform tf = FindTransform(in_tf_target_frame, in_tf_source_frame, in_tf_listener);
+
+      // calculate out_grid_map position
+      grid_map::Position map_pos = out_grid_map.getPosition();
+      double origin_x_offset = out_grid_map.getLength().x() / 2.0 - map_pos.x();
+      double origin_y_offset = out_grid_map.getLength().y() / 2.0 - map_pos.y();
+
+      std::vector<size_t> selection;
+      if (in_area_index != nullptr)
+      {
+        // bounding box of the grid corners in the frame of the areas
+        tf::Transform inverse_tf = tf.inverse();
+        double min_x = std::numeric_limits<double>::max();
+        double min_y = std::numeric_limits<double>::max();
+        double max_x = std::numeric_limits<double>::lowest();
+        double max_y = std::numeric_limits<double>::lowest();
+        for (const double sign_x : {-1.0, 1.0})
+        {
+          for (const double sign_y : {-1.0, 1.0})
+          {
+            tf::Point corner = inverse_tf * tf::Point(map_pos.x() + sign_x * out_grid_map.getLength().x() / 2.0,
+                                                      map_pos.y() + sign_y * out_grid_map.getLength().y() / 2.0, 0.0);
+            min_x = std::min(min_x, corner.x());
+            min_y = std::min(min_y, corner.y());
+            max_x = std::max(max_x, corner.x());
+            max_y = std::max(max_y, corner.y());
+          }
+        }
+        selection = in_area_index->Search(min_x, min_y, max_x, max_y);
+      }
+      size_t area_count = (in_area_index != nullptr) ? selection.size() : in_area_points.size();
+
+      for (size_t i = 0; i < area_count; i++)
+      {
+        const auto &points = in_area_points[(in_area_index != nullptr) ? selection[i] : i];
+        std::vector<cv::Point> cv_points;
+
+        for (const auto &p : points)
+        {
+          // transform to GridMap coordinate
+          geometry_msgs::Point tf_point = TransformPoint(p, tf);
+
+          // coordinate conversion for cv image, columns are the grid rows as in LayerImageView()
+          double cv_x = (out_grid_map.getLength().x() - origin_x_offset - tf_point.x) / out_grid_map.getResolution();
+          double cv_y = (out_grid_map.getLength().y() - origin_y_offset - tf_point.y) / out_grid_map.getResolution();
+          cv_points.emplace_back(cv::Point(cv_x, cv_y));
+        }
+
+        // the index selects by bounding box in the frame of the areas, small areas such as the lanelet
+        // triangles are mostly outside of the grid when it is rotated
+        if (cv_points.empty())
+          continue;
+        cv::Rect bounds = cv::boundingRect(cv_points);
+        if ((bounds & cv::Rect(0, 0, filled_image.cols, filled_image.rows)).area() == 0)
+          continue;
+
+        cv::fillConvexPoly(filled_image, cv_points.data(), cv_points.size(), cv::Scalar(in_fill_color));
+      }
+
+      // convert to ROS msg
+      ImageToLayer(filled_image, in_layer_min_value, in_layer_max_value, out_grid_map, in_grid_layer_name);
+    }
+  }  // namespace
+
   void FillPolygonAreas(grid_map::GridMap &out_grid_map, const std::vector<std::vector<geometry_msgs::Point>> &in_area_points,
                           const std::string &in_grid_layer_name, const int in_layer_background_value,
                           const int in_layer_min_value, const int in_fill_color, const int in_layer_max_value,
                           const std::string &in_tf_target_frame, const std::string &in_tf_source_frame,
                           const tf::TransformListener &in_tf_listener)
+  {
+    FillSelectedPolygonAreas(out_grid_map, in_area_points, nullptr, in_grid_layer_name, in_layer_background_value,
+                             in_layer_min_value, in_fill_color, in_layer_max_value, in_tf_target_frame,
+                             in_tf_source_frame, in_tf_listener);
+  }
+
+  void FillPolygonAreas(grid_map::GridMap &out_grid_map, const std::vector<std::vector<geometry_msgs::Point>> &in_area_points,
+                        const WayareaSpatialIndex &in_area_index,
+                        const std::string &in_grid_layer_name, const int in_layer_background_value,
+                        const int in_layer_min_value, const int in_fill_color, const int in_layer_max_value,
+                        const std::string &in_tf_target_frame, const std::string &in_tf_source_frame,
+                        const tf::TransformListener &in_tf_listener)
+  {
+    FillSelectedPolygonAreas(out_grid_map, in_area_points, &in_area_index, in_grid_layer_name,
+                             in_layer_background_value, in_layer_min_value, in_fill_color, in_layer_max_value,
+                             in_tf_target_frame, in_tf_source_frame, in_tf_listener);
+  }
+
+  void FillPolygonAreas(grid_map::GridMap &out_grid_map, const WayareaRasterCache &in_raster_cache,
+                        const std::string &in_grid_layer_name, const int in_layer_background_value,
+                        const int in_fill_value, const std::string &in_tf_target_frame,
+                        const std::string &in_tf_source_frame, const tf::TransformListener &in_tf_listener)
   {
     if(!out_grid_map.exists(in_grid_layer_name))
     {
       out_grid_map.add(in_grid_layer_name);
     }
-    out_grid_map[in_grid_layer_name].setConstant(in_layer_background_value);
-
-    cv::Mat original_image;
-    grid_map::GridMapCvConverter::toImage<unsigned char, 1>(out_grid_map,
-                                                            in_grid_layer_name,
-                                                            CV_8UC1,
-                                                            in_layer_min_value,
-                                                            in_layer_max_value,
-                                                            original_image);
-
-    cv::Mat filled_image = original_image.clone();
+    grid_map::Matrix &layer = out_grid_map[in_grid_layer_name];
 
-    tf::StampedTransform tf = FindTransform(in_tf_target_frame, in_tf_source_frame, in_tf_listener);
+    // cell centers are transformed into the frame of the wayareas
+    tf::Transform tf = FindTransform(in_tf_target_frame, in_tf_source_frame, in_tf_listener).inverse();
 
-    // calculate out_grid_map position
-    grid_map::Position map_pos = out_grid_map.getPosition();
-    double origin_x_offset = out_grid_map.getLength().x() / 2.0 - map_pos.x();
-    double origin_y_offset = out_grid_map.getLength().y() / 2.0 - map_pos.y();
-
-    for (const auto &points : in_area_points)
+    for (grid_map::GridMapIterator it(out_grid_map); !it.isPastEnd(); ++it)
     {
-      std::vector<cv::Point> cv_points;
-
-      for (const auto &p : points)
-      {
-        // transform to GridMap coordinate
-        geometry_msgs::Point tf_point = TransformPoint(p, tf);
-
-        // coordinate conversion for cv image
-        double cv_x = (out_grid_map.getLength().y() - origin_y_offset - tf_point.y) / out_grid_map.getResolution();
-        double cv_y = (out_grid_map.getLength().x() - origin_x_offset - tf_point.x) / out_grid_map.getResolution();
-        cv_points.emplace_back(cv::Point(cv_x, cv_y));
-      }
+      grid_map::Position position;
+      out_grid_map.getPosition(*it, position);
+      tf::Point tf_point = tf * tf::Point(position.x(), position.y(), 0.0);
 
-      cv::fillConvexPoly(filled_image, cv_points.data(), cv_points.size(), cv::Scalar(in_fill_color));
+      const grid_map::Index &index = *it;
+      layer(index(0), index(1)) =
+          in_raster_cache.IsWayarea(tf_point.x(), tf_point.y()) ? in_fill_value : in_layer_background_value;
     }
-
-    // convert to ROS msg
-    grid_map::GridMapCvConverter::addLayerFromImage<unsigned char, 1>(filled_image,
-                                                                      in_grid_layer_name,
-                                                                      out_grid_map,
-                                                                      in_layer_min_value,
-                                                                      in_layer_max_value);
   }
 
   void LoadRoadAreasFromVectorMap(ros::NodeHandle& in_private_node_handle,
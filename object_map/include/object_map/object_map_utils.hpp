@@ -28,9 +28,92 @@
 #include <grid_map_ros/grid_map_ros.hpp>
 #include <grid_map_msgs/GridMap.h>
 #include <grid_map_cv/grid_map_cv.hpp>
+#include <nav_msgs/OccupancyGrid.h>
+
+#include <opencv2/core/core.hpp>
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
 
 namespace object_map
 {
+  /*!
+   * Way areas rasterized once in the frame of their points. The pixels are stored in square tiles and only
+   * the tiles reached by an area are kept, so asking for a position far from the areas costs no memory.
+   */
+  class WayareaRasterCache
+  {
+  public:
+    /*!
+     * @param[in] in_resolution Size of a pixel in meters
+     * @param[in] in_tile_size Number of pixels of a tile side
+     */
+    explicit WayareaRasterCache(double in_resolution = 0.1, int in_tile_size = 256);
+
+    /*!
+     * Rasterizes the areas, the previous ones are discarded
+     * @param[in] in_area_points Array of points containing the wayareas
+     */
+    void Rasterize(const std::vector<std::vector<geometry_msgs::Point>> &in_area_points);
+
+    /*!
+     * @param[in] in_x X coordinate in the frame of the areas
+     * @param[in] in_y Y coordinate in the frame of the areas
+     * @return true if the pixel containing the position is inside a wayarea
+     */
+    bool IsWayarea(double in_x, double in_y) const;
+
+    bool Empty() const;
+
+  private:
+    double resolution_;
+    int tile_size_;
+    std::map<std::pair<int, int>, cv::Mat> tiles_;
+  };
+
+  /*!
+   * Bounding boxes of the wayareas, bucketed on a regular grid so that the areas around a region are found
+   * without going through all of them
+   */
+  class WayareaSpatialIndex
+  {
+  public:
+    /*!
+     * @param[in] in_bucket_size Side of a bucket in meters
+     */
+    explicit WayareaSpatialIndex(double in_bucket_size = 50.0);
+
+    /*!
+     * Indexes the areas, the previous ones are discarded
+     * @param[in] in_area_points Array of points containing the wayareas
+     */
+    void Build(const std::vector<std::vector<geometry_msgs::Point>> &in_area_points);
+
+    /*!
+     * @return Indices in increasing order of the areas whose bounding box intersects the given box
+     */
+    std::vector<size_t> Search(double in_min_x, double in_min_y, double in_max_x, double in_max_y) const;
+
+    bool Empty() const;
+
+  private:
+    struct Box
+    {
+      double min_x;
+      double min_y;
+      double max_x;
+      double max_y;
+    };
+
+    int Bucket(double in_coordinate) const;
+
+    double bucket_size_;
+    std::vector<Box> boxes_;
+    std::map<std::pair<int, int>, std::vector<size_t>> buckets_;
+  };
+
   /*!
    * Transforms a point using the given transformation
    * @param[in] in_point Point to transform
@@ -72,6 +155,60 @@ namespace object_map
                                      const std::string &in_source_frame,
                                      const tf::TransformListener &in_tf_listener);
 
+  /*!
+   * Wraps the storage of a layer as a single channel float image, without copying it. The layers are stored column
+   * major, so cell index (i, j) is the pixel at column i and row j, the transpose of GridMapCvConverter::toImage().
+   * The start index of in_grid_map is reset to zero if needed.
+   * @param[in] in_grid_map GridMap object containing the layer
+   * @param[in] in_layer Name of the layer
+   * @return Image sharing the memory of the layer
+   */
+  cv::Mat LayerImageView(grid_map::GridMap &in_grid_map, const std::string &in_layer);
+
+  /*!
+   * Converts a layer into an 8 bit image laid out as LayerImageView(), in a single pass and with the value mapping
+   * of GridMapCvConverter::toImage(), which copies the whole grid map first
+   * @param[in] in_grid_map GridMap object containing the layer
+   * @param[in] in_layer Name of the layer
+   * @param[in] in_lower_value Layer value mapped to 0, lower values are clamped
+   * @param[in] in_upper_value Layer value mapped to 255, upper values are clamped
+   * @return Image, non finite cells are 0
+   */
+  cv::Mat LayerToImage(grid_map::GridMap &in_grid_map, const std::string &in_layer,
+                       float in_lower_value, float in_upper_value);
+
+  /*!
+   * Writes an 8 bit image laid out as LayerImageView() into a layer, in a single pass and with the value mapping of
+   * GridMapCvConverter::addLayerFromImage()
+   * @param[in] in_image Image of the size of out_grid_map
+   * @param[in] in_lower_value Layer value of 0
+   * @param[in] in_upper_value Layer value of 255
+   * @param[out] out_grid_map GridMap object to add the layer
+   * @param[in] in_layer Name of the layer, added if needed
+   */
+  void ImageToLayer(const cv::Mat &in_image, float in_lower_value, float in_upper_value,
+                    grid_map::GridMap &out_grid_map, const std::string &in_layer);
+
+  /*!
+   * Same as GridMapRosConverter::fromOccupancyGrid(), but the occupancy values are written into the layer directly
+   * @param[in] in_occupancy_grid OccupancyGrid to convert, unknown cells become NaN
+   * @param[in] in_layer Name of the layer
+   * @param[out] out_grid_map GridMap object whose geometry is set from the OccupancyGrid
+   */
+  void FromOccupancyGrid(const nav_msgs::OccupancyGrid &in_occupancy_grid, const std::string &in_layer,
+                         grid_map::GridMap &out_grid_map);
+
+  /*!
+   * Same as GridMapRosConverter::toOccupancyGrid(), but the occupancy values are written in a single linear pass
+   * @param[in] in_grid_map GridMap object to extract the layer
+   * @param[in] in_layer Name of the layer to convert
+   * @param[in] in_min_value Layer value of occupancy 0
+   * @param[in] in_max_value Layer value of occupancy 100
+   * @param[out] out_occupancy_grid Converted OccupancyGrid
+   */
+  void ToOccupancyGrid(const grid_map::GridMap &in_grid_map, const std::string &in_layer, float in_min_value,
+                       float in_max_value, nav_msgs::OccupancyGrid &out_occupancy_grid);
+
   /*!
      * Loads regions defined as road inside the vector map, according to the field named "wayarea"
      */
@@ -111,7 +248,43 @@ namespace object_map
                         const std::string &in_tf_source_frame,
                         const tf::TransformListener &in_tf_listener);
 
+  /*!
+   * Same as FillPolygonAreas() above, but only the areas of in_area_index whose bounding box intersects
+   * out_grid_map are filled
+   * @param[in] in_area_index Index built from in_area_points
+   */
+  void FillPolygonAreas(grid_map::GridMap &out_grid_map,
+                        const std::vector<std::vector<geometry_msgs::Point>> &in_area_points,
+                        const WayareaSpatialIndex &in_area_index,
+                        const std::string &in_grid_layer_name,
+                        const int in_layer_background_value,
+                        const int in_fill_color,
+                        const int in_layer_min_value,
+                        const int in_layer_max_value,
+                        const std::string &in_tf_target_frame,
+                        const std::string &in_tf_source_frame,
+                        const tf::TransformListener &in_tf_listener);
 
+  /*!
+   * Fills the cells of out_grid_map from the wayareas cached in in_raster_cache, instead of filling every area again.
+   * Each cell takes the value of the cached pixel containing its center.
+   * @param[out] out_grid_map GridMap object to add the road grid
+   * @param[in] in_raster_cache Wayareas rasterized in in_tf_source_frame
+   * @param[in] in_grid_layer_name Name to assign to the layer
+   * @param[in] in_layer_background_value Value of the cells outside the wayareas
+   * @param[in] in_fill_value Value of the cells inside the wayareas
+   * @param[in] in_tf_target_frame Frame of out_grid_map
+   * @param[in] in_tf_source_frame Frame of the wayareas
+   * @param[in] in_tf_listener Valid listener to obtain the transformation
+   */
+  void FillPolygonAreas(grid_map::GridMap &out_grid_map,
+                        const WayareaRasterCache &in_raster_cache,
+                        const std::string &in_grid_layer_name,
+                        const int in_layer_background_value,
+                        const int in_fill_value,
+                        const std::string &in_tf_target_frame,
+                        const std::string &in_tf_source_frame,
+                        const tf::TransformListener &in_tf_listener);
 
 } // namespace object_map
 
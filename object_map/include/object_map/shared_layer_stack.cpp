@@ -0,0 +1,120 @@
+/*
+ * Copyright 2018-2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ********************/
+
+#include "object_map/shared_layer_stack.hpp"
+
+namespace object_map
+{
+
+  std::shared_ptr<SharedLayerStack> SharedLayerStack::Get(const std::string &in_name)
+  {
+    // the stacks live as long as one of their users
+    static std::mutex stacks_mutex;
+    static std::map<std::string, std::weak_ptr<SharedLayerStack>> stacks;
+
+    std::lock_guard<std::mutex> lock(stacks_mutex);
+    std::shared_ptr<SharedLayerStack> stack = stacks[in_name].lock();
+    if (!stack)
+    {
+      stack = std::make_shared<SharedLayerStack>();
+      stacks[in_name] = stack;
+    }
+    return stack;
+  }
+
+  SharedLayerStack::LayerPtr SharedLayerStack::Acquire(const std::string &in_name)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = layers_.find(in_name);
+
+    // the spare version is no longer handed out, it is free once its last reader let it go
+    if (it != layers_.end() && it->second.spare && it->second.spare.use_count() == 1)
+    {
+      LayerPtr layer = it->second.spare;
+      it->second.spare.reset();
+      return layer;
+    }
+    return std::make_shared<Layer>();
+  }
+
+  void SharedLayerStack::Commit(const std::string &in_name, const LayerPtr &in_layer)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Slot &slot = layers_[in_name];
+    slot.spare = slot.current;
+    slot.current = in_layer;
+  }
+
+  void SharedLayerStack::CommitLayer(const std::string &in_name, const grid_map::GridMap &in_grid_map,
+                                     const std::string &in_layer)
+  {
+    LayerPtr layer = Acquire(in_name);
+    layer->frame_id = in_grid_map.getFrameId();
+    layer->stamp.fromNSec(in_grid_map.getTimestamp());
+    layer->length = in_grid_map.getLength();
+    layer->resolution = in_grid_map.getResolution();
+    layer->position = in_grid_map.getPosition();
+
+    if (in_grid_map.getStartIndex().isZero())
+    {
+      // same size as the previous version, the buffer is reused
+      layer->data = in_grid_map[in_layer];
+    }
+    else
+    {
+      grid_map::GridMap default_start_map = in_grid_map;
+      default_start_map.convertToDefaultStartIndex();
+      layer->data = default_start_map[in_layer];
+    }
+    Commit(in_name, layer);
+  }
+
+  SharedLayerStack::LayerConstPtr SharedLayerStack::GetLayer(const std::string &in_name) const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = layers_.find(in_name);
+    if (it == layers_.end())
+      return LayerConstPtr();
+    return it->second.current;
+  }
+
+  bool SharedLayerStack::CopyLayerTo(const std::string &in_name, grid_map::GridMap &out_grid_map,
+                                     const std::string &in_layer) const
+  {
+    LayerConstPtr layer = GetLayer(in_name);
+    if (!layer || layer->frame_id != out_grid_map.getFrameId() || layer->resolution != out_grid_map.getResolution()
+        || layer->position != out_grid_map.getPosition() || layer->data.rows() != out_grid_map.getSize()(0)
+        || layer->data.cols() != out_grid_map.getSize()(1))
+    {
+      return false;
+    }
+
+    if (!out_grid_map.getStartIndex().isZero())
+      out_grid_map.convertToDefaultStartIndex();
+    out_grid_map.add(in_layer, layer->data);
+    return true;
+  }
+
+  std::vector<std::string> SharedLayerStack::GetLayerNames() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<std::string> names;
+    for (const auto &layer : layers_)
+      names.push_back(layer.first);
+    return names;
+  }
+
+}  // namespace object_map
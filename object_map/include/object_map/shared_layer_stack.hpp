@@ -0,0 +1,111 @@
+/*
+ * Copyright 2018-2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ********************/
+#ifndef OBJECT_MAP_SHARED_LAYER_STACK_H
+#define OBJECT_MAP_SHARED_LAYER_STACK_H
+
+#include <ros/ros.h>
+
+#include <grid_map_ros/grid_map_ros.hpp>
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace object_map
+{
+
+  /*!
+   * Named grid layers shared by the producers and consumers of one process, such as the nodelets of a manager.
+   * A producer commits a new version of a layer, consumers keep the version they read through a shared pointer
+   * for as long as they need it. Layers are neither serialized nor copied between them, and each layer is double
+   * buffered: a producer writes in place into the version before the current one once no consumer holds it anymore.
+   */
+  class SharedLayerStack
+  {
+  public:
+    struct Layer
+    {
+      std::string frame_id;
+      ros::Time stamp;
+      grid_map::Length length;
+      double resolution = 0.0;
+      grid_map::Position position;
+      grid_map::Matrix data; // default start index
+    };
+    typedef std::shared_ptr<Layer> LayerPtr;
+    typedef std::shared_ptr<const Layer> LayerConstPtr;
+
+    /*!
+     * @param[in] in_name Name of the stack
+     * @return Stack of this process with the given name, created on first use
+     */
+    static std::shared_ptr<SharedLayerStack> Get(const std::string &in_name);
+
+    /*!
+     * Returns a layer to fill before committing it as in_name. It is the version before the current one if
+     * nobody holds it anymore, with its previous content, so that its buffers are reused
+     * @param[in] in_name Name of the layer
+     * @return Writable layer, never null
+     */
+    LayerPtr Acquire(const std::string &in_name);
+
+    /*!
+     * Makes in_layer the current version of in_name, the caller must not modify it anymore
+     * @param[in] in_name Name of the layer
+     * @param[in] in_layer Layer returned by Acquire()
+     */
+    void Commit(const std::string &in_name, const LayerPtr &in_layer);
+
+    /*!
+     * Commits in_layer of in_grid_map as in_name, with a single copy of its data
+     * @param[in] in_name Name of the layer in the stack
+     * @param[in] in_grid_map GridMap containing the layer
+     * @param[in] in_layer Name of the layer in in_grid_map
+     */
+    void CommitLayer(const std::string &in_name, const grid_map::GridMap &in_grid_map, const std::string &in_layer);
+
+    /*!
+     * @param[in] in_name Name of the layer
+     * @return Current version of the layer, null if it was never committed
+     */
+    LayerConstPtr GetLayer(const std::string &in_name) const;
+
+    /*!
+     * Copies the current version of in_name into in_layer of out_grid_map if both have the same frame and geometry
+     * @param[in] in_name Name of the layer in the stack
+     * @param[out] out_grid_map GridMap to add the layer to
+     * @param[in] in_layer Name of the layer in out_grid_map
+     * @return False if the layer does not exist or does not match out_grid_map
+     */
+    bool CopyLayerTo(const std::string &in_name, grid_map::GridMap &out_grid_map, const std::string &in_layer) const;
+
+    std::vector<std::string> GetLayerNames() const;
+
+  private:
+    struct Slot
+    {
+      LayerPtr current;
+      LayerPtr spare;
+    };
+
+    mutable std::mutex mutex_;
+    std::map<std::string, Slot> layers_;
+  };
+
+}  // namespace object_map
+#endif  // OBJECT_MAP_SHARED_LAYER_STACK_H
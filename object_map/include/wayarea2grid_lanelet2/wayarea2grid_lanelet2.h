@@ -25,6 +25,7 @@
 #include <cv_bridge/cv_bridge.h>
 #include <geometry_msgs/TwistStamped.h>
 #include <ros/ros.h>
+#include <std_msgs/String.h>
 #include <tf/transform_listener.h>
 
 // Headers from Autoware
@@ -38,6 +39,7 @@
 #include <grid_map_cv/grid_map_cv.hpp>
 #include <grid_map_ros/grid_map_ros.hpp>
 #include <object_map/object_map_utils.hpp>
+#include <object_map/shared_layer_stack.hpp>
 
 // Headers from opencv
 #include <opencv2/highgui/highgui.hpp>
@@ -66,6 +68,8 @@ private:
 
   bool loaded_lanelet_map_ = false;
   lanelet::LaneletMapPtr lanelet_map_;
+  bool use_shared_map_;
+  ros::Subscriber sub_lanelet_bin_map_;
 
   std::string sensor_frame_;
   std::string grid_frame_;
@@ -78,6 +82,7 @@ private:
   double grid_position_x_;
   double grid_position_y_;
   double grid_position_z_;
+  double wayarea_cache_resolution_;
 
   tf::TransformListener tf_listener_;
 
@@ -85,12 +90,18 @@ private:
   const int grid_max_value_ = 255;
 
   std::vector<std::vector<geometry_msgs::Point>> area_points_;
+  WayareaRasterCache wayarea_cache_;
+  WayareaSpatialIndex area_index_;
+
+  // wayarea layer shared with the consumers of this process, null when ~layer_stack is empty
+  std::shared_ptr<SharedLayerStack> layer_stack_;
 
   /*!
    * Initializes ROS Publisher, Subscribers and sets the configuration parameters
    */
   void InitializeROSIo();
   void laneletBinMapCallback(const autoware_lanelet2_msgs::MapBin& msg);
+  void laneletSharedMapCallback(const std_msgs::String& msg);
   void initAreaPointsFromLaneletMap();
 };
 
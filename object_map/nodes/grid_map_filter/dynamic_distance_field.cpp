@@ -0,0 +1,208 @@
+/*
+ * Copyright 2018-2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ********************/
+
+#include "dynamic_distance_field.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace object_map
+{
+
+  namespace
+  {
+    const int INFINITE_DISTANCE = std::numeric_limits<int>::max();
+    const int NEIGHBOR_X[8] = {-1, 0, 1, -1, 1, -1, 0, 1};
+    const int NEIGHBOR_Y[8] = {-1, -1, -1, 0, 0, 1, 1, 1};
+  }  // namespace
+
+  DynamicDistanceField::DynamicDistanceField() :
+      size_x_(0), size_y_(0), max_distance_(0.0), max_squared_distance_(0)
+  {
+  }
+
+  void DynamicDistanceField::Reset(int in_size_x, int in_size_y, double in_max_distance)
+  {
+    size_x_ = in_size_x;
+    size_y_ = in_size_y;
+    max_distance_ = in_max_distance;
+    max_squared_distance_ = static_cast<int>(std::floor(in_max_distance * in_max_distance));
+
+    const size_t cells = static_cast<size_t>(size_x_) * size_y_;
+    squared_distance_.assign(cells, INFINITE_DISTANCE);
+    nearest_obstacle_.assign(cells, -1);
+    obstacle_.assign(cells, 0);
+    to_raise_.assign(cells, 0);
+    changed_.assign(cells, 0);
+    changed_cells_.clear();
+    open_ = decltype(open_)();
+  }
+
+  void DynamicDistanceField::Update(const unsigned char *in_obstacles)
+  {
+    for (int cell : changed_cells_)
+      changed_[cell] = 0;
+    changed_cells_.clear();
+
+    const int cells = size_x_ * size_y_;
+    for (int i = 0; i < cells; i++)
+    {
+      const unsigned char obstacle = in_obstacles[i] != 0;
+      if (obstacle == obstacle_[i])
+        continue;
+
+      obstacle_[i] = obstacle;
+      if (obstacle)
+        SetObstacle(i);
+      else
+        RemoveObstacle(i);
+    }
+
+    // a cell can be queued several times, stale entries are harmless as both waves re-read the current state
+    while (!open_.empty())
+    {
+      const int cell = open_.top().second;
+      open_.pop();
+
+      if (to_raise_[cell])
+        Raise(cell);
+      else if (IsValidObstacle(nearest_obstacle_[cell]))
+        Lower(cell);
+    }
+  }
+
+  double DynamicDistanceField::GetDistance(int in_index) const
+  {
+    const int squared_distance = squared_distance_[in_index];
+    if (squared_distance == INFINITE_DISTANCE)
+      return max_distance_;
+
+    return std::min(std::sqrt(static_cast<double>(squared_distance)), max_distance_);
+  }
+
+  const std::vector<int> &DynamicDistanceField::GetChangedCells() const
+  {
+    return changed_cells_;
+  }
+
+  int DynamicDistanceField::GetSizeX() const
+  {
+    return size_x_;
+  }
+
+  int DynamicDistanceField::GetSizeY() const
+  {
+    return size_y_;
+  }
+
+  bool DynamicDistanceField::IsValidObstacle(int in_index) const
+  {
+    return in_index >= 0 && obstacle_[in_index] && nearest_obstacle_[in_index] == in_index;
+  }
+
+  void DynamicDistanceField::SetObstacle(int in_index)
+  {
+    squared_distance_[in_index] = 0;
+    nearest_obstacle_[in_index] = in_index;
+    to_raise_[in_index] = 0;
+    MarkChanged(in_index);
+    open_.emplace(0, in_index);
+  }
+
+  void DynamicDistanceField::RemoveObstacle(int in_index)
+  {
+    ClearCell(in_index);
+    to_raise_[in_index] = 1;
+    open_.emplace(0, in_index);
+  }
+
+  void DynamicDistanceField::ClearCell(int in_index)
+  {
+    squared_distance_[in_index] = INFINITE_DISTANCE;
+    nearest_obstacle_[in_index] = -1;
+    MarkChanged(in_index);
+  }
+
+  void DynamicDistanceField::MarkChanged(int in_index)
+  {
+    if (changed_[in_index])
+      return;
+
+    changed_[in_index] = 1;
+    changed_cells_.push_back(in_index);
+  }
+
+  void DynamicDistanceField::Raise(int in_index)
+  {
+    const int x = in_index % size_x_;
+    const int y = in_index / size_x_;
+    for (int k = 0; k < 8; k++)
+    {
+      const int neighbor_x = x + NEIGHBOR_X[k];
+      const int neighbor_y = y + NEIGHBOR_Y[k];
+      if (neighbor_x < 0 || neighbor_x >= size_x_ || neighbor_y < 0 || neighbor_y >= size_y_)
+        continue;
+
+      const int neighbor = neighbor_x + neighbor_y * size_x_;
+      if (nearest_obstacle_[neighbor] < 0 || to_raise_[neighbor])
+        continue;
+
+      const int squared_distance = squared_distance_[neighbor];
+      if (!IsValidObstacle(nearest_obstacle_[neighbor]))
+      {
+        // its obstacle is gone, the raise wave goes on through it
+        ClearCell(neighbor);
+        to_raise_[neighbor] = 1;
+      }
+      // either way it has to lower its neighbors, which were cleared by this wave
+      open_.emplace(squared_distance, neighbor);
+    }
+    to_raise_[in_index] = 0;
+  }
+
+  void DynamicDistanceField::Lower(int in_index)
+  {
+    const int obstacle = nearest_obstacle_[in_index];
+    const int obstacle_x = obstacle % size_x_;
+    const int obstacle_y = obstacle / size_x_;
+    const int x = in_index % size_x_;
+    const int y = in_index / size_x_;
+    for (int k = 0; k < 8; k++)
+    {
+      const int neighbor_x = x + NEIGHBOR_X[k];
+      const int neighbor_y = y + NEIGHBOR_Y[k];
+      if (neighbor_x < 0 || neighbor_x >= size_x_ || neighbor_y < 0 || neighbor_y >= size_y_)
+        continue;
+
+      const int neighbor = neighbor_x + neighbor_y * size_x_;
+      if (to_raise_[neighbor])
+        continue;
+
+      const int dx = neighbor_x - obstacle_x;
+      const int dy = neighbor_y - obstacle_y;
+      const int squared_distance = dx * dx + dy * dy;
+      if (squared_distance < squared_distance_[neighbor] && squared_distance <= max_squared_distance_)
+      {
+        squared_distance_[neighbor] = squared_distance;
+        nearest_obstacle_[neighbor] = obstacle;
+        MarkChanged(neighbor);
+        open_.emplace(squared_distance, neighbor);
+      }
+    }
+  }
+
+}  // namespace object_map
@@ -0,0 +1,93 @@
+/*
+ * Copyright 2018-2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ********************/
+#ifndef DYNAMIC_DISTANCE_FIELD_H
+#define DYNAMIC_DISTANCE_FIELD_H
+
+#include <functional>
+#include <queue>
+#include <utility>
+#include <vector>
+
+namespace object_map
+{
+
+  /*!
+   * Euclidean distance to the nearest obstacle cell, updated incrementally (Lau et al., dynamic brushfire).
+   * Only the cells around the obstacles added or removed since the previous update are visited,
+   * distances are capped at a maximum distance, cells further away keep the maximum.
+   * Cells are addressed by linear index x + y * size_x.
+   */
+  class DynamicDistanceField
+  {
+  public:
+    DynamicDistanceField();
+
+    /*!
+     * Resizes the field and removes all obstacles
+     * @param[in] in_size_x Number of cells along x
+     * @param[in] in_size_y Number of cells along y
+     * @param[in] in_max_distance Distance cap, in cells
+     */
+    void Reset(int in_size_x, int in_size_y, double in_max_distance);
+
+    /*!
+     * Sets the obstacles and propagates the changes since the previous update
+     * @param[in] in_obstacles size_x * size_y values, non zero cells are obstacles
+     */
+    void Update(const unsigned char *in_obstacles);
+
+    /*!
+     * @param[in] in_index Linear index of the cell
+     * @return Distance in cells to the nearest obstacle, at most the distance cap
+     */
+    double GetDistance(int in_index) const;
+
+    /*!
+     * @return Linear indices of the cells whose distance changed during the last Update(), each listed once
+     */
+    const std::vector<int> &GetChangedCells() const;
+
+    int GetSizeX() const;
+    int GetSizeY() const;
+
+  private:
+    typedef std::pair<int, int> QueueEntry; // squared distance, cell
+
+    int size_x_;
+    int size_y_;
+    double max_distance_;
+    int max_squared_distance_;
+
+    std::vector<int> squared_distance_;
+    std::vector<int> nearest_obstacle_; // -1 when there is none within the cap
+    std::vector<unsigned char> obstacle_;
+    std::vector<unsigned char> to_raise_;
+    std::vector<unsigned char> changed_;
+    std::vector<int> changed_cells_;
+
+    std::priority_queue<QueueEntry, std::vector<QueueEntry>, std::greater<QueueEntry>> open_;
+
+    bool IsValidObstacle(int in_index) const;
+    void SetObstacle(int in_index);
+    void RemoveObstacle(int in_index);
+    void ClearCell(int in_index);
+    void MarkChanged(int in_index);
+    void Raise(int in_index);
+    void Lower(int in_index);
+  };
+
+}  // namespace object_map
+#endif  // DYNAMIC_DISTANCE_FIELD_H
@@ -21,10 +21,16 @@ namespace object_map
 
 // Constructor
   GridMapFilter::GridMapFilter() :
-      private_node_handle_("~")
+      GridMapFilter(ros::NodeHandle(), ros::NodeHandle("~"))
+  {
+  }
+
+  GridMapFilter::GridMapFilter(ros::NodeHandle in_node_handle, ros::NodeHandle in_private_node_handle) :
+      nh_(in_node_handle), private_node_handle_(in_private_node_handle)
   {
     InitializeROSIo();
     LoadRoadAreasFromVectorMap(private_node_handle_, area_points_);
+    area_index_.Build(area_points_);
   }
 
   void GridMapFilter::InitializeROSIo()
@@ -33,11 +39,17 @@ namespace object_map
     private_node_handle_.param<std::string>("map_topic", map_topic_, "/realtime_cost_map");
     private_node_handle_.param<double>("dist_transform_distance", dist_transform_distance_, 3.0);
     private_node_handle_.param<bool>("use_dist_transform", use_dist_transform_, false);
+    private_node_handle_.param<bool>("use_incremental_dist_transform", use_incremental_dist_transform_, false);
     private_node_handle_.param<bool>("use_wayarea", use_wayarea_, false);
     private_node_handle_.param<bool>("use_fill_circle", use_fill_circle_, false);
     private_node_handle_.param<int>("fill_circle_cost_threshold", fill_circle_cost_thresh_, 20);
     private_node_handle_.param<double>("circle_radius", circle_radius_, 1.7);
 
+    std::string layer_stack;
+    private_node_handle_.param<std::string>("layer_stack", layer_stack, "");
+    if (!layer_stack.empty())
+      layer_stack_ = SharedLayerStack::Get(layer_stack);
+
     occupancy_grid_sub_ = nh_.subscribe<nav_msgs::OccupancyGrid>(map_topic_, 10,
                                                                  &GridMapFilter::OccupancyGridCallback, this);
 
@@ -61,7 +73,7 @@ namespace object_map
     grid_map::GridMap map({original_layer, "distance_transform", "wayarea", "dist_wayarea", "circle"});
 
     //store costmap map_topic_ into the original layer
-    grid_map::GridMapRosConverter::fromOccupancyGrid(*in_message, "original", map);
+    FromOccupancyGrid(*in_message, "original", map);
 
     // apply distance transform to OccupancyGrid
     if (use_dist_transform_)
@@ -69,13 +81,18 @@ namespace object_map
       CreateDistanceTransformLayer(map, original_layer);
     }
 
-    // fill polygon
-    if (!area_points_.empty() && use_wayarea_)
+    // fill polygon, unless a wayarea2grid of this process already filled a grid of the same geometry
+    if (use_wayarea_)
     {
-      FillPolygonAreas(map, area_points_, grid_road_layer_, OCCUPANCY_NO_ROAD, OCCUPANCY_ROAD, grid_min_value_,
-                       grid_max_value_, map.getFrameId(), map_frame_, tf_listener_);
+      bool shared_wayarea = layer_stack_ && layer_stack_->CopyLayerTo(grid_road_layer_, map, grid_road_layer_);
+      if (!shared_wayarea && !area_points_.empty())
+      {
+        FillPolygonAreas(map, area_points_, area_index_, grid_road_layer_, OCCUPANCY_NO_ROAD, OCCUPANCY_ROAD,
+                         grid_min_value_, grid_max_value_, map.getFrameId(), map_frame_, tf_listener_);
+      }
 
-      map["dist_wayarea"] = map["distance_transform"] + map["wayarea"];
+      if (shared_wayarea || !area_points_.empty())
+        map["dist_wayarea"] = map["distance_transform"] + map["wayarea"];
     }
 
     // fill circle
@@ -87,6 +104,12 @@ namespace object_map
       DrawCirclesInLayer(map, original_layer, cost_threshold, radius);
     }
 
+    if (layer_stack_)
+    {
+      for (const std::string layer : {"distance_transform", "dist_wayarea", "circle"})
+        layer_stack_->CommitLayer(layer, map, layer);
+    }
+
     // publish grid map as ROS message
     PublishGridMap(map, grid_map_pub_);
 
@@ -98,16 +121,20 @@ namespace object_map
 
   void GridMapFilter::CreateDistanceTransformLayer(grid_map::GridMap &out_grid_map, const std::string &in_layer)
   {
-    cv::Mat original_image;
     if (!out_grid_map.exists(in_layer))
     {
       ROS_INFO("%s layer not yet available", in_layer.c_str());
       return;
     }
-    grid_map::GridMapCvConverter::toImage<unsigned char, 1>(out_grid_map,
-                                                            in_layer,
-                                                            CV_8UC1,
-                                                            original_image);
+    const grid_map::Matrix &layer = out_grid_map[in_layer];
+    cv::Mat original_image = LayerToImage(out_grid_map, in_layer, layer.minCoeffOfFinites(),
+                                          layer.maxCoeffOfFinites());
+
+    if (use_incremental_dist_transform_)
+    {
+      UpdateIncrementalDistanceTransformLayer(out_grid_map, original_image);
+      return;
+    }
 
     cv::Mat binary_image;
     cv::threshold(original_image,
@@ -122,38 +149,62 @@ namespace object_map
     cv::Mat dt_image;
     cv::distanceTransform(binary_image, dt_image, CV_DIST_L2, 5);
 
-    // Convert to int...
-    cv::Mat dt_int_image(dt_image.size(), CV_8UC1);
-    cv::Mat dt_int_inv_image(dt_image.size(), CV_8UC1);
-
-    // max distance for cost propagation
-    double max_dist = dist_transform_distance_; // meter
     double resolution = out_grid_map.getResolution();
 
+    // write into the layer directly, with the value mapping of ImageToLayer()
+    cv::Mat dt_layer = LayerImageView(out_grid_map, "distance_transform");
+
     for (int y = 0; y < dt_image.rows; y++)
     {
       for (int x = 0; x < dt_image.cols; x++)
       {
         // actual distance [meter]
-        double dist = dt_image.at<float>(y, x) * resolution;
-        if (dist > max_dist)
-          dist = max_dist;
+        dt_layer.at<float>(y, x) = DistanceToLayerValue(dt_image.at<float>(y, x) * resolution);
+      }
+    }
+  }
 
-        // Make value range 0 ~ 255
-        int round_dist = dist / max_dist * grid_max_value_;
-        int inv_round_dist = grid_max_value_ - round_dist;
+  void GridMapFilter::UpdateIncrementalDistanceTransformLayer(grid_map::GridMap &out_grid_map,
+                                                              const cv::Mat &in_image)
+  {
+    const grid_map::Size size = out_grid_map.getSize();
+    const double resolution = out_grid_map.getResolution();
+    const grid_map::Position &position = out_grid_map.getPosition();
 
-        dt_int_image.at<unsigned char>(y, x) = round_dist;
-        dt_int_inv_image.at<unsigned char>(y, x) = inv_round_dist;
-      }
+    // image columns are the first grid index, so image and layer share their linear indices
+    if (distance_field_.GetSizeX() != size(0) || distance_field_.GetSizeY() != size(1)
+        || distance_field_resolution_ != resolution || distance_field_position_ != position)
+    {
+      distance_field_.Reset(size(0), size(1), dist_transform_distance_ / resolution);
+      distance_layer_.setConstant(size(0), size(1), DistanceToLayerValue(dist_transform_distance_));
+      distance_field_resolution_ = resolution;
+      distance_field_position_ = position;
     }
 
-    // convert to ROS msg
-    grid_map::GridMapCvConverter::addLayerFromImage<unsigned char, 1>(dt_int_inv_image,
-                                                                      "distance_transform",
-                                                                      out_grid_map,
-                                                                      grid_min_value_,
-                                                                      grid_max_value_);
+    cv::Mat obstacles = in_image > fill_circle_cost_thresh_;
+    distance_field_.Update(obstacles.ptr<unsigned char>());
+
+    for (int cell : distance_field_.GetChangedCells())
+    {
+      distance_layer_(cell) = DistanceToLayerValue(distance_field_.GetDistance(cell) * resolution);
+    }
+    out_grid_map["distance_transform"] = distance_layer_;
+  }
+
+  float GridMapFilter::DistanceToLayerValue(double in_distance) const
+  {
+    // max distance for cost propagation
+    double max_dist = dist_transform_distance_; // meter
+    double dist = in_distance;
+    if (dist > max_dist)
+      dist = max_dist;
+
+    // Make value range 0 ~ 255
+    int round_dist = dist / max_dist * grid_max_value_;
+    int inv_round_dist = grid_max_value_ - round_dist;
+
+    const float value_difference = grid_max_value_ - grid_min_value_;
+    return grid_min_value_ + value_difference * (inv_round_dist / 255.0f);
   }
 
   void GridMapFilter::DrawCirclesInLayer(grid_map::GridMap &out_gridmap,
@@ -161,36 +212,29 @@ namespace object_map
                                          double in_draw_threshold,
                                          double in_radius)
   {
-    cv::Mat original_image;
+    cv::Mat filled_image = LayerToImage(out_gridmap, in_layer_name, costmap_min_, costmap_max_);
 
-    grid_map::GridMapCvConverter::toImage<unsigned char, 1>(out_gridmap,
-                                                            in_layer_name,
-                                                            CV_8UC1,
-                                                            costmap_min_,
-                                                            costmap_max_,
-                                                            original_image);
-
-    cv::Mat filled_image = original_image.clone();
-
-    for (int y = 0; y < original_image.rows; y++)
+    // centers are found before drawing, so that the circles are drawn into the image they are read from
+    std::vector<cv::Point> centers;
+    for (int y = 0; y < filled_image.rows; y++)
     {
-      for (int x = 0; x < original_image.cols; x++)
+      for (int x = 0; x < filled_image.cols; x++)
       {
         // uchar -> int
-        int data = original_image.at<unsigned char>(y, x);
+        int data = filled_image.at<unsigned char>(y, x);
 
         if (data > fill_circle_cost_thresh_)
         {
-          cv::circle(filled_image, cv::Point(x, y), in_radius, cv::Scalar(OCCUPANCY_CIRCLE), -1, CV_AA);
+          centers.emplace_back(x, y);
         }
       }
     }
+    for (const auto &center : centers)
+    {
+      cv::circle(filled_image, center, in_radius, cv::Scalar(OCCUPANCY_CIRCLE), -1, CV_AA);
+    }
     // convert to ROS msg
-    grid_map::GridMapCvConverter::addLayerFromImage<unsigned char, 1>(filled_image,
-                                                                      "circle",
-                                                                      out_gridmap,
-                                                                      grid_min_value_,
-                                                                      grid_max_value_);
+    ImageToLayer(filled_image, grid_min_value_, grid_max_value_, out_gridmap, "circle");
   }
 
 
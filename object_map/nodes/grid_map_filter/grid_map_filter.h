@@ -35,6 +35,8 @@
 #include <opencv2/highgui/highgui.hpp>
 
 #include "object_map/object_map_utils.hpp"
+#include "object_map/shared_layer_stack.hpp"
+#include "dynamic_distance_field.h"
 
 namespace object_map
 {
@@ -44,6 +46,12 @@ namespace object_map
   public:
     GridMapFilter();
 
+    /*!
+     * @param[in] in_node_handle Handle of the topics, the one of the nodelet when loaded in a manager
+     * @param[in] in_private_node_handle Handle of the parameters
+     */
+    GridMapFilter(ros::NodeHandle in_node_handle, ros::NodeHandle in_private_node_handle);
+
     void Run();
 
   private:
@@ -59,6 +67,7 @@ namespace object_map
     const std::string               grid_road_layer_    = "wayarea";
     double                          dist_transform_distance_;
     bool                            use_dist_transform_;
+    bool                            use_incremental_dist_transform_;
     bool                            use_wayarea_;
     bool                            use_fill_circle_;
     int                             fill_circle_cost_thresh_;
@@ -75,6 +84,15 @@ namespace object_map
     tf::TransformListener           tf_listener_;
 
     std::vector<std::vector<geometry_msgs::Point>> area_points_;
+    WayareaSpatialIndex             area_index_;
+
+    // wayarea layer read from and filtered layers shared with this process, null when ~layer_stack is empty
+    std::shared_ptr<SharedLayerStack> layer_stack_;
+
+    DynamicDistanceField            distance_field_;
+    grid_map::Matrix                distance_layer_;
+    grid_map::Position              distance_field_position_;
+    double                          distance_field_resolution_ = 0.0;
 
     void OccupancyGridCallback(const nav_msgs::OccupancyGridConstPtr &in_message);
 
@@ -90,6 +108,21 @@ namespace object_map
      */
     void CreateDistanceTransformLayer(grid_map::GridMap &out_grid_map, const std::string &in_layer);
 
+    /*!
+     * Updates the distance field only around the obstacle cells that changed since the previous map,
+     * the field starts over when the size, resolution or position of the map changes
+     * @param[out] out_grid_map GridMap object to add the layer
+     * @param[in] in_image Image of the layer to use for the transform
+     */
+    void UpdateIncrementalDistanceTransformLayer(grid_map::GridMap &out_grid_map, const cv::Mat &in_image);
+
+    /*!
+     * Maps a distance to the value range of the distance_transform layer, far cells get the lowest value
+     * @param[in] in_distance Distance in meters
+     * @return Layer value
+     */
+    float DistanceToLayerValue(double in_distance) const;
+
     /*!
      * Draws a circle in the specified layer in the given GridMap if the cell value is larger than a threshold
      * @param[out] out_gridmap GridMap object to modify
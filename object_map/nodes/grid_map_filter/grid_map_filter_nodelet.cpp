@@ -0,0 +1,46 @@
+/*
+ * Copyright 2018-2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ********************/
+
+
+#include <nodelet/nodelet.h>
+#include <pluginlib/class_list_macros.h>
+
+#include <memory>
+
+#include "grid_map_filter.h"
+
+namespace object_map
+{
+
+  /*!
+   * grid_map_filter in a nodelet manager, the costmap and the filtered grid map are passed by pointer
+   * to the other nodelets of the manager
+   */
+  class GridMapFilterNodelet : public nodelet::Nodelet
+  {
+  private:
+    std::unique_ptr<GridMapFilter> grid_map_filter_;
+
+    void onInit() override
+    {
+      // waits for the vector map as the node does, its messages arrive through the manager threads
+      grid_map_filter_.reset(new GridMapFilter(getNodeHandle(), getPrivateNodeHandle()));
+    }
+  };
+
+}  // namespace object_map
+
+PLUGINLIB_EXPORT_CLASS(object_map::GridMapFilterNodelet, nodelet::Nodelet)
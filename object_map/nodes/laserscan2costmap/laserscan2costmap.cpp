@@ -14,56 +14,25 @@
  * limitations under the License.
  */
 
-#include <iostream>
-#include <vector>
-#include <string>
 #include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
 
-#include <ros/ros.h>
-#include <sensor_msgs/LaserScan.h>
-#include <tf/transform_listener.h>
-#include <nav_msgs/OccupancyGrid.h>
+#include <boost/bind.hpp>
 
-namespace
-{
-constexpr auto OGM_FRAME = "/map";
-constexpr int OCCUPIED_MAX = 8;
-constexpr int OCCUPIED_MIN = -8;
-constexpr int OCCUPIED_INCREMENT = 2;
-constexpr int FREE_INCREMENT = 1;
-std::string g_sensor_frame = "/velodyne";  // sensor which publihes lasescan message
-std::string g_scan_topic = "/scan";        // laser scan topic
-double g_resolution = 0.1;                 // [m]
-int g_scan_size_x = 1000;                  // actual scanning size
-int g_scan_size_y = 1000;
-int g_map_size_x = 500;  // publishing occupancy grid map size
-int g_map_size_y = 500;
+#include "laserscan2costmap.h"
 
-struct Grid
+namespace object_map
 {
-  int index;
-  int index_x, index_y;
-  double x, y;
-  double weight;
-  double range;
-
-  void calcCoordinate();
-  void calcRange();
-  int calcGlobalIndex(const tf::StampedTransform& transform) const;
-};
-
-struct Cost
+namespace laserscan2costmap
+{
+namespace
 {
-  int occupied = 0;
-  int free     = 0;
-  bool unknown = true;
-
-  void accumulateCost(int occ, int free);
-};
-
-ros::Publisher g_map_pub;
-tf::TransformListener* g_tf_listenerp;
-
 double calcYawFromQuaternion(const tf::Quaternion& q)
 {
   tf::Matrix3x3 m(q);
@@ -74,6 +43,86 @@ double calcYawFromQuaternion(const tf::Quaternion& q)
 }
 
 // Accumulate cost value
+int positiveModulo(int value, int size)
+{
+  int m = value % size;
+  return m < 0 ? m + size : m;
+}
+
+int calcCell(double coordinate, double resolution)
+{
+  return static_cast<int>(std::floor(coordinate / resolution));
+}
+
+int8_t toOccupancyValue(const Cost& cost)
+{
+  if (cost.unknown)
+    return -1;
+  return (cost.occupied + 8) * 6;
+}
+
+// Cast the beams [begin, end) of scan, add_cost is called with the global cell and the increments
+template <typename AddCost>
+void castBeams(const sensor_msgs::LaserScan& scan, const PrecastTable& precast_table,
+               const tf::StampedTransform& transform, size_t begin, size_t end, const AddCost& add_cost)
+{
+  // Vehicle's orientation
+  double yaw = calcYawFromQuaternion(transform.getRotation());
+
+  // Original yaw is -PI ~ PI, so make its range 0 ~ 2PI
+  if (yaw < 0)
+    yaw += 2 * M_PI;
+  double laser_offset = fabs(scan.angle_min);
+
+  // For tough_urg
+  // static double manual_offset = -10.0 / 180 * M_PI + M_PI;
+  // int index_offset = (yaw + laser_offset + manual_offset) / scan.angle_increment;
+
+  int index_offset = (yaw + laser_offset) / scan.angle_increment;
+  int iangle_size = precast_table.beamSize();
+
+  for (size_t i = begin; i < end; i++)
+  {
+    double range = scan.ranges[i];
+
+    // Ignore 0 ranges
+    if (range == 0)
+      continue;
+
+    // If laserscan does not reach objects, make a range max
+    if (scan.ranges[i] > scan.range_max)
+      range = scan.range_max;
+
+    int precasted_index = (i + index_offset) % iangle_size;
+    const Grid* begin_grid = precast_table.beamBegin(precasted_index);
+    const Grid* end_grid = precast_table.beamEnd(precasted_index);
+    if (begin_grid == end_grid)
+      continue;
+
+    const Grid* g = begin_grid;
+    for (; g != end_grid; g++)
+    {
+      if (g->range > range)
+        break;
+
+      // Free range
+      int cell_x, cell_y;
+      g->calcGlobalCell(transform, precast_table.resolution, &cell_x, &cell_y);
+      add_cost(cell_x, cell_y, 0, FREE_INCREMENT);
+    }
+    // The first grid beyond the range, or the last one
+    if (g == end_grid)
+      g--;
+
+    // Obstacle
+    int cell_x, cell_y;
+    g->calcGlobalCell(transform, precast_table.resolution, &cell_x, &cell_y);
+    add_cost(cell_x, cell_y, OCCUPIED_INCREMENT, 0);
+  }
+}
+
+}  // namespace
+
 void Cost::accumulateCost(int occupied_inc, int free_inc)
 {
   occupied += occupied_inc - free_inc;
@@ -87,170 +136,338 @@ void Cost::accumulateCost(int occupied_inc, int free_inc)
     occupied = OCCUPIED_MIN;
 }
 
+void Cost::applyDelta(const CostDelta& delta)
+{
+  occupied = std::min(delta.max_occupied, std::max(delta.min_occupied, occupied + delta.offset));
+  free    += delta.free;
+  unknown  = false;
+}
+
+void CostDelta::accumulateCost(int occupied_inc, int free_inc)
+{
+  CostDelta next;
+  next.offset = occupied_inc - free_inc;
+  next.free = free_inc;
+  append(next);
+}
+
+void CostDelta::append(const CostDelta& next)
+{
+  offset += next.offset;
+  min_occupied = std::min(next.max_occupied, std::max(next.min_occupied, min_occupied + next.offset));
+  max_occupied = std::min(next.max_occupied, std::max(next.min_occupied, max_occupied + next.offset));
+  free += next.free;
+}
+
 // Calcurate grid's coordinate in sensor frame
-void Grid::calcCoordinate()
+void Grid::calcCoordinate(int scan_size_x, int scan_size_y, double resolution)
 {
   // index coordinate
-  index_x = index % g_scan_size_x;
-  index_y = (index - index_x) / g_scan_size_x;
+  index_x = index % scan_size_x;
+  index_y = (index - index_x) / scan_size_x;
 
   // actual coordinate
-  x = (index_x - g_scan_size_x / 2.0) * g_resolution;
-  y = (index_y - g_scan_size_y / 2.0) * g_resolution;
+  x = (index_x - scan_size_x / 2.0) * resolution;
+  y = (index_y - scan_size_y / 2.0) * resolution;
 }
 
 // Calculate a range from sensor in a certain grid
-void Grid::calcRange()
+void Grid::calcRange(int scan_size_x, int scan_size_y, double resolution)
 {
-  double distance_x = g_resolution * fabs(g_scan_size_x / 2 - index_x);
-  double distance_y = g_resolution * fabs(g_scan_size_y / 2 - index_y);
+  double distance_x = resolution * fabs(scan_size_x / 2 - index_x);
+  double distance_y = resolution * fabs(scan_size_y / 2 - index_y);
 
   range = sqrt(distance_x * distance_x + distance_y * distance_y);
 }
 
-// Change local index into global index
-int Grid::calcGlobalIndex(const tf::StampedTransform& transform) const
+// Change local coordinate into global cell
+void Grid::calcGlobalCell(const tf::StampedTransform& transform, double resolution, int* cell_x, int* cell_y) const
 {
-  // Calculate index in global frame
-  int ix = (x + transform.getOrigin().x()) / g_resolution;
-  int iy = (y + transform.getOrigin().y()) / g_resolution;
+  *cell_x = calcCell(x + transform.getOrigin().x(), resolution);
+  *cell_y = calcCell(y + transform.getOrigin().y(), resolution);
+}
 
-  // Make indexes positive value
-  int global_grid_x = (ix + 100000 * g_scan_size_x) % g_scan_size_x;
-  int global_grid_y = (iy + 100000 * g_scan_size_y) % g_scan_size_y;
+void RollingCostMap::init(int size_x, int size_y)
+{
+  size_x_ = size_x;
+  size_y_ = size_y;
+  initialized_ = false;
+  costs_.assign(size_x_ * size_y_, Cost());
+  changed_.assign(size_x_ * size_y_, false);
+  changed_cells_.clear();
+}
 
-  int global_index = global_grid_x + global_grid_y * g_scan_size_x;
+// Center the window on global cell (center_x, center_y)
+void RollingCostMap::moveTo(int center_x, int center_y)
+{
+  int origin_x = center_x - size_x_ / 2;
+  int origin_y = center_y - size_y_ / 2;
+  if (!initialized_)
+  {
+    origin_x_ = origin_x;
+    origin_y_ = origin_y;
+    initialized_ = true;
+    return;
+  }
 
-  return global_index;
+  int shift_x = origin_x - origin_x_;
+  int shift_y = origin_y - origin_y_;
+  if (std::abs(shift_x) >= size_x_ || std::abs(shift_y) >= size_y_)
+  {
+    std::fill(costs_.begin(), costs_.end(), Cost());
+  }
+  else
+  {
+    // Columns and rows entering the window reuse the memory of the ones leaving it
+    int begin_x = shift_x > 0 ? origin_x_ + size_x_ : origin_x;
+    int end_x = shift_x > 0 ? origin_x + size_x_ : origin_x_;
+    for (int x = begin_x; x < end_x; x++)
+      clearColumn(x);
+
+    int begin_y = shift_y > 0 ? origin_y_ + size_y_ : origin_y;
+    int end_y = shift_y > 0 ? origin_y + size_y_ : origin_y_;
+    for (int y = begin_y; y < end_y; y++)
+      clearRow(y);
+  }
+  origin_x_ = origin_x;
+  origin_y_ = origin_y;
 }
 
-int calcGlobalIndex(int grid_x, int grid_y, const tf::StampedTransform& transform)
+bool RollingCostMap::isInside(int x, int y) const
 {
-  // Point coordinate in velodyne(local) frame
-  double local_x = (grid_x - g_scan_size_x / 2.0) * g_resolution;
-  double local_y = (grid_y - g_scan_size_y / 2.0) * g_resolution;
+  return origin_x_ <= x && x < origin_x_ + size_x_ && origin_y_ <= y && y < origin_y_ + size_y_;
+}
 
-  // Calculate index in global coordinate
-  int ix = (local_x + transform.getOrigin().x()) / g_resolution;
-  int iy = (local_y + transform.getOrigin().y()) / g_resolution;
+const Cost& RollingCostMap::at(int x, int y) const
+{
+  return costs_[index(x, y)];
+}
 
-  // Make indexes positive value
-  int global_grid_x = (ix + 100000 * g_scan_size_x) % g_scan_size_x;
-  int global_grid_y = (iy + 100000 * g_scan_size_y) % g_scan_size_y;
+void RollingCostMap::accumulateCost(int x, int y, int occupied_inc, int free_inc)
+{
+  int i = index(x, y);
+  costs_[i].accumulateCost(occupied_inc, free_inc);
+  if (!changed_[i])
+  {
+    changed_[i] = true;
+    changed_cells_.emplace_back(x, y);
+  }
+}
 
-  int global_index = global_grid_x + global_grid_y * g_scan_size_x;
+void RollingCostMap::applyDelta(int x, int y, const CostDelta& delta)
+{
+  int i = index(x, y);
+  costs_[i].applyDelta(delta);
+  if (!changed_[i])
+  {
+    changed_[i] = true;
+    changed_cells_.emplace_back(x, y);
+  }
+}
 
-  return global_index;
+void RollingCostMap::clearChangedCells()
+{
+  for (const auto& cell : changed_cells_)
+    changed_[index(cell.first, cell.second)] = false;
+  changed_cells_.clear();
 }
 
-void preCasting(const sensor_msgs::LaserScan& scan, std::vector<std::vector<Grid>>* precasted_grids)
+void CostDeltas::resize(size_t size)
 {
-  int iangle_size = 2 * M_PI / scan.angle_increment;
-  // We decide if a grid is passed by laser by this search_step
-  double search_step = g_resolution / 10.0;
+  deltas.resize(size);
+  changed.resize(size, false);
+}
 
-  // Grid indexes for each laser
-  std::vector<std::vector<int>> grid_indexes(iangle_size);
+CostDelta& CostDeltas::at(int index, int x, int y)
+{
+  if (!changed[index])
+  {
+    changed[index] = true;
+    changed_cells.emplace_back(x, y);
+  }
+  return deltas[index];
+}
 
-  for (int iangle = 0; iangle < iangle_size; iangle++)
+void CostDeltas::clear(const RollingCostMap& cost_map)
+{
+  for (const auto& cell : changed_cells)
   {
-    // Angle of each laser from Lidar
-    double angle = scan.angle_increment * iangle;  // + scan.angle_min;
-    double step = 0;
+    int index = cost_map.index(cell.first, cell.second);
+    deltas[index] = CostDelta();
+    changed[index] = false;
+  }
+  changed_cells.clear();
+}
 
-    while (1)
-    {
-      step += search_step;
+int RollingCostMap::index(int x, int y) const
+{
+  return positiveModulo(x, size_x_) + positiveModulo(y, size_y_) * size_x_;
+}
 
-      // Calculate a grid index passed by laser scan
-      int grid_x = step * cos(angle) / g_resolution + g_scan_size_x / 2.0;
-      int grid_y = step * sin(angle) / g_resolution + g_scan_size_y / 2.0;
+void RollingCostMap::clearColumn(int x)
+{
+  int column = positiveModulo(x, size_x_);
+  for (int row = 0; row < size_y_; row++)
+    costs_[column + row * size_x_] = Cost();
+}
 
-      if (grid_x >= g_scan_size_x || grid_x < 0 || grid_y >= g_scan_size_y || grid_y < 0)
-        break;
+void RollingCostMap::clearRow(int y)
+{
+  auto row = costs_.begin() + positiveModulo(y, size_y_) * size_x_;
+  std::fill(row, row + size_x_, Cost());
+}
 
-      grid_indexes[iangle].push_back(grid_x + grid_y * g_scan_size_x);
-    }
+bool PrecastTable::matches(const sensor_msgs::LaserScan& scan, double resolution, int scan_size_x,
+                           int scan_size_y) const
+{
+  return angle_increment == scan.angle_increment && range_max == scan.range_max && this->resolution == resolution &&
+         this->scan_size_x == scan_size_x && this->scan_size_y == scan_size_y;
+}
+
+}  // namespace laserscan2costmap
+
+using namespace laserscan2costmap;
+
+LaserScanToCostMap::LaserScanToCostMap(ros::NodeHandle nh, ros::NodeHandle private_nh)
+{
+  private_nh.param<double>("resolution", resolution_, 0.1);
+  private_nh.param<int>("scan_size_x", scan_size_x_, 1000);
+  private_nh.param<int>("scan_size_y", scan_size_y_, 1000);
+  private_nh.param<int>("map_size_x", map_size_x_, 500);
+  private_nh.param<int>("map_size_y", map_size_y_, 500);
+  private_nh.param<std::string>("scan_topic", scan_topic_, "/scan");
+  private_nh.param<std::string>("sensor_frame", sensor_frame_, "/velodyne");
+  private_nh.param<int>("num_threads", num_threads_, 1);
+
+  std::string layer_stack;
+  private_nh.param<std::string>("layer_stack", layer_stack, "");
+  if (!layer_stack.empty())
+    layer_stack_ = SharedLayerStack::Get(layer_stack);
+
+  // Several sources are fused into one grid, published on each scan of the first source
+  std::vector<std::string> scan_topics, sensor_frames;
+  private_nh.param<std::vector<std::string>>("scan_topics", scan_topics, std::vector<std::string>());
+  private_nh.param<std::vector<std::string>>("sensor_frames", sensor_frames, std::vector<std::string>());
+  if (scan_topics.empty())
+  {
+    scan_topics.push_back(scan_topic_);
+    sensor_frames.assign(1, sensor_frame_);
+  }
+  sources_.resize(scan_topics.size());
+  for (size_t i = 0; i < scan_topics.size(); i++)
+  {
+    sources_[i].topic = scan_topics[i];
+    // Empty frames are taken from the scan header
+    if (i < sensor_frames.size())
+      sources_[i].sensor_frame = sensor_frames[i];
   }
 
-  // Erase overlapping values
-  auto unique_grid_indexes = grid_indexes;
-  for (auto& vec : unique_grid_indexes)
-    vec.erase(std::unique(vec.begin(), vec.end()), vec.end());
+  // The published grid is read from the cost map, it cannot be larger
+  if (map_size_x_ > scan_size_x_ || map_size_y_ > scan_size_y_)
+  {
+    ROS_WARN("map_size is larger than scan_size, it is reduced to scan_size");
+    map_size_x_ = std::min(map_size_x_, scan_size_x_);
+    map_size_y_ = std::min(map_size_y_, scan_size_y_);
+  }
 
-  // Max size of step counts
-  // Precated laser steps for each grid are less than this value
-  // int max_count = g_resolution / search_step * sqrt(2) + 1;
+  map_pub_ = nh.advertise<nav_msgs::OccupancyGrid>("/ring_ogm", 1);
 
-  for (int i = 0; i < iangle_size; i++)
+  for (size_t i = 0; i < sources_.size(); i++)
   {
-    // Push grid indexes for each laser
-    // Each index has weight which is decided by passing laser rate
-    for (const auto& unique_index : unique_grid_indexes[i])
-    {
-      Grid g;
-      g.index = unique_index;
-      // g.weight = 1.0 * std::count(grid_indexes[i].begin(), grid_indexes[i].end(), unique_index) / max_count;
-      g.calcCoordinate();
-      g.calcRange();
-      precasted_grids->at(i).push_back(g);
-    }
+    laserscan_subs_.push_back(nh.subscribe<sensor_msgs::LaserScan>(
+        sources_[i].topic, 1, boost::bind(&LaserScanToCostMap::laserScanCallback, this, _1, i)));
   }
 }
 
-
-// Delete old cost values
-void deleteOldData(std::vector<Cost>* cost_map, double current_x, double current_y, double prev_x, double prev_y)
+int LaserScanToCostMap::calcCell(double coordinate) const
 {
-  double begin_x = current_x;
-  double begin_y = current_y;
-  double end_x = prev_x;
-  double end_y = prev_y;
+  return laserscan2costmap::calcCell(coordinate, resolution_);
+}
 
-  if (begin_x > end_x)
-    std::swap(begin_x, end_x);
-  if (begin_y > end_y)
-    std::swap(begin_y, end_y);
+PrecastTableConstPtr LaserScanToCostMap::preCasting(const sensor_msgs::LaserScan& scan) const
+{
+  auto table = std::make_shared<PrecastTable>();
+  table->angle_increment = scan.angle_increment;
+  table->range_max = scan.range_max;
+  table->resolution = resolution_;
+  table->scan_size_x = scan_size_x_;
+  table->scan_size_y = scan_size_y_;
 
-  int ibegin_x = begin_x / g_resolution + g_scan_size_x / 2;
-  int ibegin_y = begin_y / g_resolution + g_scan_size_y / 2;
-  int iend_x = end_x / g_resolution + g_scan_size_x / 2;
-  int iend_y = end_y / g_resolution + g_scan_size_y / 2;
+  int iangle_size = 2 * M_PI / scan.angle_increment;
+  // We decide if a grid is passed by laser by this search_step
+  double search_step = resolution_ / 10.0;
 
-  for (int i = ibegin_x; i < iend_x; i++)
+  table->offsets.reserve(iangle_size + 1);
+  table->offsets.push_back(0);
+  for (int iangle = 0; iangle < iangle_size; iangle++)
   {
-    for (int j = 0; j < g_scan_size_y; j++)
+    // Angle of each laser from Lidar
+    double angle = scan.angle_increment * iangle;  // + scan.angle_min;
+    double step = 0;
+    int last_index = -1;
+
+    while (1)
     {
-      int global_grid_x = (i + 100000 * g_scan_size_x) % g_scan_size_x;
-      cost_map->at(global_grid_x + j * g_scan_size_x).occupied = 0;
-      cost_map->at(global_grid_x + j * g_scan_size_x).free     = 0;
-      cost_map->at(global_grid_x + j * g_scan_size_x).unknown  = true;
+      step += search_step;
+
+      // Calculate a grid index passed by laser scan
+      int grid_x = step * cos(angle) / resolution_ + scan_size_x_ / 2.0;
+      int grid_y = step * sin(angle) / resolution_ + scan_size_y_ / 2.0;
+
+      if (grid_x >= scan_size_x_ || grid_x < 0 || grid_y >= scan_size_y_ || grid_y < 0)
+        break;
+
+      // Consecutive steps in the same grid are counted once
+      int index = grid_x + grid_y * scan_size_x_;
+      if (index == last_index)
+        continue;
+      last_index = index;
+
+      Grid g;
+      g.index = index;
+      g.calcCoordinate(scan_size_x_, scan_size_y_, resolution_);
+      g.calcRange(scan_size_x_, scan_size_y_, resolution_);
+      table->grids.push_back(g);
+      if (g.range > scan.range_max)
+        break;
     }
+    table->offsets.push_back(table->grids.size());
   }
+  table->grids.shrink_to_fit();
+  return table;
+}
 
-  for (int i = 0; i < g_scan_size_x; i++)
+// Table of the geometry of scan, built only when no source has it yet
+PrecastTableConstPtr LaserScanToCostMap::getPrecastTable(const sensor_msgs::LaserScan& scan)
+{
+  // Tables no longer used by any source are dropped
+  precast_tables_.erase(std::remove_if(precast_tables_.begin(), precast_tables_.end(),
+                                        [](const PrecastTableConstPtr& table) { return table.use_count() == 1; }),
+                         precast_tables_.end());
+  for (const auto& table : precast_tables_)
   {
-    for (int j = ibegin_y; j < iend_y; j++)
-    {
-      int global_grid_y = (j + 100000 * g_scan_size_y) % g_scan_size_y;
-      cost_map->at(i + global_grid_y * g_scan_size_x).occupied = 0;
-      cost_map->at(i + global_grid_y * g_scan_size_x).free     = 0;
-      cost_map->at(i + global_grid_y * g_scan_size_x).unknown  = true;
-    }
+    if (table->matches(scan, resolution_, scan_size_x_, scan_size_y_))
+      return table;
   }
+  ros::WallTime start = ros::WallTime::now();
+  precast_tables_.push_back(preCasting(scan));
+  ROS_INFO("Precasted %zu beams into %zu grids in %.1f ms", precast_tables_.back()->beamSize(),
+           precast_tables_.back()->grids.size(), (ros::WallTime::now() - start).toSec() * 1000.0);
+  return precast_tables_.back();
 }
 
-void setOccupancyGridMap(nav_msgs::OccupancyGrid* map, const std_msgs::Header& header,
-                         const tf::StampedTransform& transform)
+// origin_x and origin_y are the global cell at the origin of the grid
+void LaserScanToCostMap::setOccupancyGridMap(nav_msgs::OccupancyGrid* map, const std_msgs::Header& header,
+                                             const tf::StampedTransform& transform, int origin_x, int origin_y) const
 {
   map->header.stamp = header.stamp;
   map->header.frame_id = OGM_FRAME;
   map->info.map_load_time = header.stamp;
-  map->info.resolution = g_resolution;
-  map->info.height = g_map_size_y;
-  map->info.width = g_map_size_x;
-  map->info.origin.position.x = transform.getOrigin().x() - (g_map_size_x / 2) * g_resolution;
-  map->info.origin.position.y = transform.getOrigin().y() - (g_map_size_y / 2) * g_resolution;
+  map->info.resolution = resolution_;
+  map->info.height = map_size_y_;
+  map->info.width = map_size_x_;
+  map->info.origin.position.x = origin_x * resolution_;
+  map->info.origin.position.y = origin_y * resolution_;
   map->info.origin.position.z = transform.getOrigin().z() - 5;
   map->info.origin.orientation.x = 0;
   map->info.origin.orientation.y = 0;
@@ -258,158 +475,211 @@ void setOccupancyGridMap(nav_msgs::OccupancyGrid* map, const std_msgs::Header& h
   map->info.origin.orientation.w = 1;
 }
 
-void createCostMap(const sensor_msgs::LaserScan& scan, const std::vector<std::vector<Grid>>& precasted_grids)
+// Shift the grid data by (shift_x, shift_y) cells to its new origin, only the cells entering the grid are read
+// from the cost map
+void LaserScanToCostMap::moveOccupancyGridMap(int origin_x, int origin_y, int shift_x, int shift_y,
+                                              nav_msgs::OccupancyGrid* map, std::vector<int8_t>* buffer) const
 {
-  tf::StampedTransform transform;
+  buffer->resize(map->data.size());
+  int begin_x = std::max(0, -shift_x);
+  int end_x = std::min(map_size_x_, map_size_x_ - shift_x);
+  for (int i = 0; i < map_size_y_; i++)
+  {
+    int prev_i = i + shift_y;
+    auto row = buffer->begin() + i * map_size_x_;
+    if (0 <= prev_i && prev_i < map_size_y_ && begin_x < end_x)
+    {
+      auto prev_row = map->data.begin() + prev_i * map_size_x_;
+      std::copy(prev_row + begin_x + shift_x, prev_row + end_x + shift_x, row + begin_x);
+      for (int j = 0; j < begin_x; j++)
+        row[j] = toOccupancyValue(cost_map_.at(origin_x + j, origin_y + i));
+      for (int j = end_x; j < map_size_x_; j++)
+        row[j] = toOccupancyValue(cost_map_.at(origin_x + j, origin_y + i));
+    }
+    else
+    {
+      for (int j = 0; j < map_size_x_; j++)
+        row[j] = toOccupancyValue(cost_map_.at(origin_x + j, origin_y + i));
+    }
+  }
+  map->data.swap(*buffer);
+}
 
+bool LaserScanToCostMap::lookupSensorTransform(const std::string& sensor_frame, tf::StampedTransform* transform) const
+{
   try
   {
     // What time should we use?
-    g_tf_listenerp->lookupTransform(OGM_FRAME, g_sensor_frame, ros::Time(0), transform);
+    tf_listener_.lookupTransform(OGM_FRAME, sensor_frame, ros::Time(0), *transform);
   }
   catch (tf::TransformException ex)
   {
     ROS_ERROR("%s", ex.what());
-    return;
+    return false;
   }
+  return true;
+}
 
-  // Save costs in this variable
-  static std::vector<Cost> cost_map(g_scan_size_x * g_scan_size_y);
-
-  static bool initialized_map = false;
-  static double prev_x = transform.getOrigin().x();
-  static double prev_y = transform.getOrigin().y();
-  static nav_msgs::OccupancyGrid map;
-  setOccupancyGridMap(&map, scan.header, transform);
-  if (!initialized_map)
+// Accumulate grid costs for each laser scan
+void LaserScanToCostMap::accumulateScan(const sensor_msgs::LaserScan& scan, const PrecastTable& precast_table,
+                                        const tf::StampedTransform& transform)
+{
+  if (num_threads_ <= 1 || scan.ranges.size() < static_cast<size_t>(num_threads_))
   {
-    map.data.resize(g_map_size_x * g_map_size_y, -1);
-    initialized_map = true;
+    castBeams(scan, precast_table, transform, 0, scan.ranges.size(), [&](int x, int y, int occupied, int free) {
+      if (cost_map_.isInside(x, y))
+        cost_map_.accumulateCost(x, y, occupied, free);
+    });
+    return;
   }
 
-  // Since we implement as ring buffer, we have to delete old data regularly
-  deleteOldData(&cost_map, transform.getOrigin().x(), transform.getOrigin().y(), prev_x, prev_y);
-  prev_x = transform.getOrigin().x();
-  prev_y = transform.getOrigin().y();
+  // Each thread casts a part of the beams into its own deltas
+  std::vector<CostDeltas>& deltas = deltas_;
+  deltas.resize(num_threads_);
+  for (auto& d : deltas)
+    d.resize(cost_map_.size());
 
-  // Vehicle's orientation
-  double yaw = calcYawFromQuaternion(transform.getRotation());
+  std::vector<std::thread> threads;
+  size_t chunk = (scan.ranges.size() + num_threads_ - 1) / num_threads_;
+  for (int t = 0; t < num_threads_; t++)
+  {
+    size_t begin = std::min(t * chunk, scan.ranges.size());
+    size_t end = std::min(begin + chunk, scan.ranges.size());
+    threads.emplace_back([&, t, begin, end]() {
+      castBeams(scan, precast_table, transform, begin, end, [&](int x, int y, int occupied, int free) {
+        if (cost_map_.isInside(x, y))
+          deltas[t].at(cost_map_.index(x, y), x, y).accumulateCost(occupied, free);
+      });
+    });
+  }
+  for (auto& thread : threads)
+    thread.join();
 
-  // Original yaw is -PI ~ PI, so make its range 0 ~ 2PI
-  if (yaw < 0)
-    yaw += 2 * M_PI;
-  static double laser_offset = fabs(scan.angle_min);
+  // Threads have consecutive beams, appending their deltas in order gives the same costs as a single thread
+  for (int t = 1; t < num_threads_; t++)
+  {
+    for (const auto& cell : deltas[t].changed_cells)
+    {
+      int i = cost_map_.index(cell.first, cell.second);
+      deltas[0].at(i, cell.first, cell.second).append(deltas[t].deltas[i]);
+    }
+    deltas[t].clear(cost_map_);
+  }
+  for (const auto& cell : deltas[0].changed_cells)
+  {
+    int i = cost_map_.index(cell.first, cell.second);
+    cost_map_.applyDelta(cell.first, cell.second, deltas[0].deltas[i]);
+  }
+  deltas[0].clear(cost_map_);
+}
 
-  // For tough_urg
-  // static double manual_offset = -10.0 / 180 * M_PI + M_PI;
-  // int index_offset = (yaw + laser_offset + manual_offset) / scan.angle_increment;
+// Integrate the pending scans of all sources into the window around the first source and publish
+void LaserScanToCostMap::createCostMap()
+{
+  tf::StampedTransform transform;
+  if (!lookupSensorTransform(sources_[0].sensor_frame, &transform))
+    return;
 
-  int index_offset = (yaw + laser_offset) / scan.angle_increment;
-  static int iangle_size = 2 * M_PI / scan.angle_increment;
+  // A subscriber of this process still holds the last grid, the next one starts from a copy
+  if (!map_)
+    map_.reset(new nav_msgs::OccupancyGrid);
+  else if (!map_.unique())
+    map_.reset(new nav_msgs::OccupancyGrid(*map_));
+  nav_msgs::OccupancyGrid& map = *map_;
+
+  // Since we implement as ring buffer, moving only clears the cells entering the window
+  int center_x = calcCell(transform.getOrigin().x());
+  int center_y = calcCell(transform.getOrigin().y());
+  if (!initialized_map_)
+    cost_map_.init(scan_size_x_, scan_size_y_);
+  cost_map_.moveTo(center_x, center_y);
+
+  int origin_x = center_x - map_size_x_ / 2;
+  int origin_y = center_y - map_size_y_ / 2;
+  if (!initialized_map_)
+  {
+    map.data.resize(map_size_x_ * map_size_y_, -1);
+    initialized_map_ = true;
+  }
+  else if (origin_x != map_origin_x_ || origin_y != map_origin_y_)
+  {
+    moveOccupancyGridMap(origin_x, origin_y, origin_x - map_origin_x_, origin_y - map_origin_y_, &map, &map_buffer_);
+  }
+  map_origin_x_ = origin_x;
+  map_origin_y_ = origin_y;
+  setOccupancyGridMap(&map, sources_[0].scan->header, transform, map_origin_x_, map_origin_y_);
 
   //----------------- RING OCCUPANCY GRID MAPPING --------------
-  // Accumulate grid costs for each laser scan
-  for (size_t i = 0; i < scan.ranges.size(); i++)
+  for (size_t i = 0; i < sources_.size(); i++)
   {
-    double range = scan.ranges[i];
-
-    // Ignore 0 ranges
-    if (range == 0)
+    auto& source = sources_[i];
+    if (!source.scan)
       continue;
 
-    // If laserscan does not reach objects, make a range max
-    if (scan.ranges[i] > scan.range_max)
-      range = scan.range_max;
-
-    int precasted_index = (i + index_offset) % iangle_size;
-    int obstacle_index = -1;
-    for (const auto& g : precasted_grids[precasted_index])
-    {
-      obstacle_index++;
-
-      if (g.range > range)
-        break;
-
-      // Free range
-      int global_index = g.calcGlobalIndex(transform);
-      cost_map[global_index].accumulateCost(0, FREE_INCREMENT);
-    }
-
-    // Obstacle
-    int global_index = precasted_grids[precasted_index][obstacle_index].calcGlobalIndex(transform);
-    cost_map[global_index].accumulateCost(OCCUPIED_INCREMENT, 0);
-
+    tf::StampedTransform sensor_transform = transform;
+    if (i == 0 || lookupSensorTransform(source.sensor_frame, &sensor_transform))
+      accumulateScan(*source.scan, *source.precast_table, sensor_transform);
+    source.scan.reset();
   }
 
+  // Write the cells changed by the scans into the grid
+  for (const auto& cell : cost_map_.changedCells())
+  {
+    int j = cell.first - map_origin_x_;
+    int i = cell.second - map_origin_y_;
+    if (0 <= j && j < map_size_x_ && 0 <= i && i < map_size_y_)
+      map.data[j + i * map_size_x_] = toOccupancyValue(cost_map_.at(cell.first, cell.second));
+  }
+  cost_map_.clearChangedCells();
 
-  // Begining of grid index of publishing OGM
-  static int origin_index_x = (g_scan_size_x - g_map_size_x) / 2.0;
-  static int origin_index_y = (g_scan_size_y - g_map_size_y) / 2.0;
-  // static int origin_index = origin_index_x + origin_index_y * g_scan_size_x;
+  map_pub_.publish(map_);
+  if (layer_stack_)
+    commitLayer(map);
+}
 
-  // Set cost values for publishing OccuppancyGridMap
-  for (int i = 0; i < g_map_size_y; i++)
+// Commit the grid as the ring_ogm layer, unknown cells are NAN as in the GridMaps converted from an OccupancyGrid
+void LaserScanToCostMap::commitLayer(const nav_msgs::OccupancyGrid& map) const
+{
+  SharedLayerStack::LayerPtr layer = layer_stack_->Acquire("ring_ogm");
+  layer->frame_id = map.header.frame_id;
+  layer->stamp = map.header.stamp;
+  layer->resolution = map.info.resolution;
+  layer->length = grid_map::Length(map.info.width * map.info.resolution, map.info.height * map.info.resolution);
+  layer->position = grid_map::Position(map.info.origin.position.x + layer->length.x() / 2,
+                                       map.info.origin.position.y + layer->length.y() / 2);
+
+  // The first index of the layer runs along -x and the second along -y
+  layer->data.resize(map.info.width, map.info.height);
+  for (int y = 0; y < static_cast<int>(map.info.height); y++)
   {
-    for (int j = 0; j < g_map_size_x; j++)
+    for (int x = 0; x < static_cast<int>(map.info.width); x++)
     {
-      int scanmap_index_x = origin_index_x + j;
-      int scanmap_index_y = origin_index_y + i;
-
-      int global_index = calcGlobalIndex(scanmap_index_x, scanmap_index_y, transform);
-      if (cost_map[global_index].unknown)
-        map.data[j + i * g_map_size_x] = -1;
-      else
-        map.data[j + i * g_map_size_x] = (cost_map[global_index].occupied + 8) * 6;
+      int8_t value = map.data[x + y * map.info.width];
+      layer->data(map.info.width - 1 - x, map.info.height - 1 - y) = value < 0 ? NAN : value;
     }
   }
-
-  g_map_pub.publish(map);
+  layer_stack_->Commit("ring_ogm", layer);
 }
 
-// Make CostMap from LaserScan message
-void laserScanCallback(const sensor_msgs::LaserScanConstPtr& msg)
+// Make CostMap from LaserScan message, the scans of the other sources are kept until the next scan of the first
+void LaserScanToCostMap::laserScanCallback(const sensor_msgs::LaserScanConstPtr& msg, size_t source_index)
 {
-  static bool precasted = false;
-  static int iangle_size = 2 * M_PI / msg->angle_increment;
-  static std::vector<std::vector<Grid>> precasted_grids(iangle_size);
-
-  if (!precasted)
+  auto& source = sources_[source_index];
+  // The beams are cast again only when the geometry of the scans changes
+  if (!source.precast_table || !source.precast_table->matches(*msg, resolution_, scan_size_x_, scan_size_y_))
   {
-    preCasting(*msg, &precasted_grids);
-    precasted = true;
+    source.precast_table.reset();
+    source.precast_table = getPrecastTable(*msg);
   }
+  if (source.sensor_frame.empty())
+    source.sensor_frame = msg->header.frame_id;
+  source.scan = msg;
 
   // Create costmap and publish
-  createCostMap(*msg, precasted_grids);
+  if (source_index == 0)
+    createCostMap();
 
   return;
 }
 
-}  // namespace
-
-int main(int argc, char** argv)
-{
-  ros::init(argc, argv, "laserscan2costmap");
-
-  tf::TransformListener tf_listener;
-  g_tf_listenerp = &tf_listener;
-
-  ros::NodeHandle nh;
-  ros::NodeHandle private_nh("~");
-
-  private_nh.param<double>("resolution", g_resolution, 0.1);
-  private_nh.param<int>("scan_size_x", g_scan_size_x, 1000);
-  private_nh.param<int>("scan_size_y", g_scan_size_y, 1000);
-  private_nh.param<int>("map_size_x", g_map_size_x, 500);
-  private_nh.param<int>("map_size_y", g_map_size_y, 500);
-  private_nh.param<std::string>("scan_topic", g_scan_topic, "/scan");
-  private_nh.param<std::string>("sensor_frame", g_sensor_frame, "/velodyne");
-
-  ros::Subscriber laserscan_sub = nh.subscribe(g_scan_topic, 1, laserScanCallback);
-
-  g_map_pub = nh.advertise<nav_msgs::OccupancyGrid>("/ring_ogm", 1);
-
-  ros::spin();
-
-  return 0;
-}
+}  // namespace object_map
@@ -0,0 +1,227 @@
+/*
+ * Copyright 2015-2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef LASERSCAN_TO_COSTMAP_H
+#define LASERSCAN_TO_COSTMAP_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <ros/ros.h>
+#include <sensor_msgs/LaserScan.h>
+#include <tf/transform_listener.h>
+#include <nav_msgs/OccupancyGrid.h>
+
+#include "object_map/shared_layer_stack.hpp"
+
+namespace object_map
+{
+namespace laserscan2costmap
+{
+constexpr auto OGM_FRAME = "/map";
+constexpr int OCCUPIED_MAX = 8;
+constexpr int OCCUPIED_MIN = -8;
+constexpr int OCCUPIED_INCREMENT = 2;
+constexpr int FREE_INCREMENT = 1;
+
+struct Grid
+{
+  int index;
+  int index_x, index_y;
+  double x, y;
+  double weight;
+  double range;
+
+  void calcCoordinate(int scan_size_x, int scan_size_y, double resolution);
+  void calcRange(int scan_size_x, int scan_size_y, double resolution);
+  void calcGlobalCell(const tf::StampedTransform& transform, double resolution, int* cell_x, int* cell_y) const;
+};
+
+struct CostDelta;
+
+struct Cost
+{
+  int occupied = 0;
+  int free     = 0;
+  bool unknown = true;
+
+  void accumulateCost(int occ, int free);
+  void applyDelta(const CostDelta& delta);
+};
+
+// Change of a cost by a sequence of accumulateCost(), occupied becomes
+// min(max_occupied, max(min_occupied, occupied + offset)) so that the clamping of each step is kept
+struct CostDelta
+{
+  int offset = 0;
+  int min_occupied = OCCUPIED_MIN;
+  int max_occupied = OCCUPIED_MAX;
+  int free = 0;
+
+  void accumulateCost(int occupied_inc, int free_inc);
+  // Append the steps of next after these
+  void append(const CostDelta& next);
+};
+
+// Costs of the size_x x size_y cells around the sensor. Global cell (x, y) is stored at
+// (x mod size_x, y mod size_y), so moving the window only clears the cells entering it
+class RollingCostMap
+{
+public:
+  void init(int size_x, int size_y);
+  void moveTo(int center_x, int center_y);
+  bool isInside(int x, int y) const;
+  const Cost& at(int x, int y) const;
+  void accumulateCost(int x, int y, int occupied_inc, int free_inc);
+  void applyDelta(int x, int y, const CostDelta& delta);
+
+  // Cells whose cost changed since the last clearChangedCells()
+  const std::vector<std::pair<int, int>>& changedCells() const
+  {
+    return changed_cells_;
+  }
+  void clearChangedCells();
+
+  int index(int x, int y) const;
+  size_t size() const
+  {
+    return costs_.size();
+  }
+
+private:
+  void clearColumn(int x);
+  void clearRow(int y);
+
+  int size_x_ = 0;
+  int size_y_ = 0;
+  int origin_x_ = 0;
+  int origin_y_ = 0;
+  bool initialized_ = false;
+  std::vector<Cost> costs_;
+  std::vector<bool> changed_;
+  std::vector<std::pair<int, int>> changed_cells_;
+};
+
+// Cost changes of the cells hit by a part of the beams, indexed as the cost map
+struct CostDeltas
+{
+  std::vector<CostDelta> deltas;
+  std::vector<bool> changed;
+  std::vector<std::pair<int, int>> changed_cells;
+
+  void resize(size_t size);
+  CostDelta& at(int index, int x, int y);
+  void clear(const RollingCostMap& cost_map);
+};
+
+// Grids passed by the beams of a scan geometry, beam i passes grids[offsets[i]] to grids[offsets[i + 1] - 1].
+// The beams stop at the first grid beyond range_max, the farther grids are never reached
+struct PrecastTable
+{
+  double angle_increment;
+  float range_max;
+  double resolution;
+  int scan_size_x, scan_size_y;
+  std::vector<size_t> offsets;
+  std::vector<Grid> grids;
+
+  bool matches(const sensor_msgs::LaserScan& scan, double resolution, int scan_size_x, int scan_size_y) const;
+  size_t beamSize() const
+  {
+    return offsets.size() - 1;
+  }
+  const Grid* beamBegin(size_t beam) const
+  {
+    return grids.data() + offsets[beam];
+  }
+  const Grid* beamEnd(size_t beam) const
+  {
+    return grids.data() + offsets[beam + 1];
+  }
+};
+
+using PrecastTableConstPtr = std::shared_ptr<const PrecastTable>;
+
+struct ScanSource
+{
+  std::string topic;
+  std::string sensor_frame;
+  PrecastTableConstPtr precast_table;
+  sensor_msgs::LaserScanConstPtr scan;  // not integrated yet
+};
+
+}  // namespace laserscan2costmap
+
+// Ring occupancy grid of the LaserScan messages around the sensor, published on /ring_ogm
+class LaserScanToCostMap
+{
+public:
+  /*!
+   * @param[in] nh Handle of the topics, the one of the nodelet when loaded in a manager
+   * @param[in] private_nh Handle of the parameters
+   */
+  LaserScanToCostMap(ros::NodeHandle nh, ros::NodeHandle private_nh);
+
+private:
+  std::string sensor_frame_;  // sensor which publihes lasescan message
+  std::string scan_topic_;    // laser scan topic
+  double resolution_;         // [m]
+  int scan_size_x_;           // actual scanning size
+  int scan_size_y_;
+  int map_size_x_;  // publishing occupancy grid map size
+  int map_size_y_;
+  int num_threads_;  // threads casting the beams of a scan
+
+  std::vector<laserscan2costmap::ScanSource> sources_;
+  // Tables of the scan geometries in use, shared by the sources of the same geometry
+  std::vector<laserscan2costmap::PrecastTableConstPtr> precast_tables_;
+  std::vector<ros::Subscriber> laserscan_subs_;
+  ros::Publisher map_pub_;
+  tf::TransformListener tf_listener_;
+
+  // Save costs in this variable
+  laserscan2costmap::RollingCostMap cost_map_;
+  std::vector<laserscan2costmap::CostDeltas> deltas_;
+
+  bool initialized_map_ = false;
+  int map_origin_x_ = 0;
+  int map_origin_y_ = 0;
+  // Published by pointer, copied before the next update only while a subscriber of this process still holds it
+  nav_msgs::OccupancyGridPtr map_;
+  std::vector<int8_t> map_buffer_;
+  // ring_ogm layer shared with the consumers of this process, null when ~layer_stack is empty
+  std::shared_ptr<SharedLayerStack> layer_stack_;
+
+  int calcCell(double coordinate) const;
+  laserscan2costmap::PrecastTableConstPtr preCasting(const sensor_msgs::LaserScan& scan) const;
+  laserscan2costmap::PrecastTableConstPtr getPrecastTable(const sensor_msgs::LaserScan& scan);
+  void setOccupancyGridMap(nav_msgs::OccupancyGrid* map, const std_msgs::Header& header,
+                           const tf::StampedTransform& transform, int origin_x, int origin_y) const;
+  void moveOccupancyGridMap(int origin_x, int origin_y, int shift_x, int shift_y, nav_msgs::OccupancyGrid* map,
+                            std::vector<int8_t>* buffer) const;
+  bool lookupSensorTransform(const std::string& sensor_frame, tf::StampedTransform* transform) const;
+  void accumulateScan(const sensor_msgs::LaserScan& scan, const laserscan2costmap::PrecastTable& precast_table,
+                      const tf::StampedTransform& transform);
+  void createCostMap();
+  void commitLayer(const nav_msgs::OccupancyGrid& map) const;
+  void laserScanCallback(const sensor_msgs::LaserScanConstPtr& msg, size_t source_index);
+};
+
+}  // namespace object_map
+
+#endif  // LASERSCAN_TO_COSTMAP_H
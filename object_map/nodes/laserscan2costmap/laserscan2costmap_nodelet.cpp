@@ -0,0 +1,45 @@
+/*
+ * Copyright 2015-2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <nodelet/nodelet.h>
+#include <pluginlib/class_list_macros.h>
+
+#include <memory>
+
+#include "laserscan2costmap.h"
+
+namespace object_map
+{
+
+  /*!
+   * laserscan2costmap in a nodelet manager, the scans and the ring occupancy grid are passed by pointer
+   * to the other nodelets of the manager. The callbacks of the scan sources run one at a time on the
+   * single threaded queue of the nodelet.
+   */
+  class LaserScanToCostMapNodelet : public nodelet::Nodelet
+  {
+  private:
+    std::unique_ptr<LaserScanToCostMap> laserscan2costmap_;
+
+    void onInit() override
+    {
+      laserscan2costmap_.reset(new LaserScanToCostMap(getNodeHandle(), getPrivateNodeHandle()));
+    }
+  };
+
+}  // namespace object_map
+
+PLUGINLIB_EXPORT_CLASS(object_map::LaserScanToCostMapNodelet, nodelet::Nodelet)
@@ -1,74 +1,15 @@
-#include "tf/transform_listener.h"
-#include <cmath>
-#include <geometry_msgs/PointStamped.h>
-#include <grid_map_msgs/GridMap.h>
-#include <grid_map_ros/grid_map_ros.hpp>
-#include <iostream>
-#include <jsk_recognition_msgs/BoundingBox.h>
-#include <jsk_recognition_msgs/BoundingBoxArray.h>
-#include "autoware_msgs/DetectedObject.h"
-#include "autoware_msgs/DetectedObjectArray.h"
-#include <pcl_conversions/pcl_conversions.h>
-#include <ros/ros.h>
-#include <sensor_msgs/PointCloud2.h>
-#include <visualization_msgs/Marker.h>
-#include <visualization_msgs/MarkerArray.h>
+#include "potential_field.h"
 
-using namespace grid_map;
-
-class PotentialField {
-private:
-  ros::NodeHandle nh_;
-  ros::Publisher publisher_;
-  ros::Subscriber waypoint_subscriber_;
-  ros::Subscriber vscan_subscriber_;
-  ros::Subscriber obj_subscriber_;
-  bool use_target_waypoint_;
-  bool use_obstacle_box_;
-  bool use_vscan_points_;
-  double map_x_size_;
-  double map_y_size_;
-  double map_resolution_;
-  double tf_x_;
-  double tf_z_;
-  double map_x_offset_;
-  GridMap map_;
-  class ObstacleFieldParameter {
-  public:
-    ObstacleFieldParameter() : ver_x_p(0.9), ver_y_p(0.9) {}
-    double ver_x_p;
-    double ver_y_p;
-  };
-  class TargetWaypointFieldParamater {
-  public:
-    TargetWaypointFieldParamater() : ver_x_p(1.0), ver_y_p(1.0) {}
-    double ver_x_p;
-    double ver_y_p;
-  };
-  class VscanPointsFieldParamater {
-  public:
-    VscanPointsFieldParamater() : around_x(0.5), around_y(0.5) {}
-    double around_x;
-    double around_y;
-  };
-
-  void obj_callback(autoware_msgs::DetectedObjectArray::ConstPtr obj_msg);
-  void target_waypoint_callback(
-      visualization_msgs::Marker::ConstPtr target_point_msgs);
-  void vscan_points_callback(sensor_msgs::PointCloud2::ConstPtr vscan_msg);
-  void publish_potential_field();
-
-public:
-  PotentialField();
-  void run();
-  void init();
-};
+namespace object_map {
 
 PotentialField::PotentialField()
-    : tf_x_(1.2), tf_z_(2.0),
+    : PotentialField(ros::NodeHandle(), ros::NodeHandle("~")) {}
+
+PotentialField::PotentialField(ros::NodeHandle nh, ros::NodeHandle private_nh)
+    : nh_(nh), tf_x_(1.2), tf_z_(2.0),
       map_({"potential_field", "obstacle_field", "target_waypoint_field",
-            "vscan_points_field"}) {
-  ros::NodeHandle private_nh("~");
+            "vscan_points_field"}),
+      is_all_changed_(true), has_target_waypoint_(false) {
   if (!private_nh.getParam("use_obstacle_box", use_obstacle_box_)) {
     ROS_INFO("use obstacle_box");
     use_obstacle_box_ = true;
@@ -97,6 +38,39 @@ PotentialField::PotentialField()
     map_x_offset_ = 10.0;
     ROS_INFO("map x offset %f", map_x_offset_);
   }
+  if (!private_nh.getParam("use_object_rasterization",
+                           use_object_rasterization_)) {
+    ROS_INFO("don't use object rasterization");
+    use_object_rasterization_ = false;
+  }
+  if (!private_nh.getParam("obstacle_field_cutoff", obstacle_field_cutoff_)) {
+    obstacle_field_cutoff_ = 1e-3;
+    ROS_INFO("obstacle field cutoff %f", obstacle_field_cutoff_);
+  }
+  if (obstacle_field_cutoff_ <= 0.0 || 1.0 <= obstacle_field_cutoff_) {
+    ROS_WARN("obstacle field cutoff %f is out of (0, 1), use 1e-3",
+             obstacle_field_cutoff_);
+    obstacle_field_cutoff_ = 1e-3;
+  }
+  if (!private_nh.getParam("obstacle_update_threshold",
+                           obstacle_update_threshold_)) {
+    obstacle_update_threshold_ = 0.05;
+    ROS_INFO("obstacle update threshold %f", obstacle_update_threshold_);
+  }
+  if (!private_nh.getParam("obstacle_update_yaw_threshold",
+                           obstacle_update_yaw_threshold_)) {
+    obstacle_update_yaw_threshold_ = 0.02;
+    ROS_INFO("obstacle update yaw threshold %f",
+             obstacle_update_yaw_threshold_);
+  }
+  if (!private_nh.getParam("publish_changed_layers", publish_changed_layers_)) {
+    ROS_INFO("publish all layers");
+    publish_changed_layers_ = false;
+  }
+  std::string layer_stack;
+  private_nh.param<std::string>("layer_stack", layer_stack, "");
+  if (!layer_stack.empty())
+    layer_stack_ = SharedLayerStack::Get(layer_stack);
   publisher_ =
       nh_.advertise<grid_map_msgs::GridMap>("/potential_field", 1, true);
 
@@ -124,6 +98,8 @@ void PotentialField::init() {
     map_.at("vscan_points_field", *it) = 0.0;
     map_.at("potential_field", *it) = 0.0;
   }
+  changed_layers_ = {"obstacle_field", "target_waypoint_field",
+                     "vscan_points_field"};
   ROS_INFO("Created map with size %f x %f m (%i x %i cells).",
            map_.getLength().x(), map_.getLength().y(), map_.getSize()(0),
            map_.getSize()(1));
@@ -131,16 +107,200 @@ void PotentialField::init() {
 void PotentialField::run() { ros::spin(); }
 
 void PotentialField::publish_potential_field() {
-  grid_map_msgs::GridMap message;
+  // published by pointer, subscribers in the same process receive the map
+  // without serialization
+  grid_map_msgs::GridMapPtr message(new grid_map_msgs::GridMap);
 
-  map_["potential_field"] =
-      map_["obstacle_field"].cwiseMax(map_["vscan_points_field"]) +
-      map_["target_waypoint_field"];
-  GridMapRosConverter::toMessage(map_, message);
+  const Matrix &obstacle_field = map_["obstacle_field"];
+  const Matrix &vscan_points_field = map_["vscan_points_field"];
+  const Matrix &target_waypoint_field = map_["target_waypoint_field"];
+  Matrix &potential_field = map_["potential_field"];
+  if (is_all_changed_) {
+    potential_field = obstacle_field.cwiseMax(vscan_points_field) +
+                      target_waypoint_field;
+  } else {
+    for (const auto &region : changed_regions_) {
+      const Index &i = region.start;
+      const Size &n = region.size;
+      potential_field.block(i(0), i(1), n(0), n(1)) =
+          obstacle_field.block(i(0), i(1), n(0), n(1))
+              .cwiseMax(vscan_points_field.block(i(0), i(1), n(0), n(1))) +
+          target_waypoint_field.block(i(0), i(1), n(0), n(1));
+    }
+  }
+  if (publish_changed_layers_) {
+    std::vector<std::string> layers{"potential_field"};
+    layers.insert(layers.end(), changed_layers_.begin(),
+                  changed_layers_.end());
+    GridMapRosConverter::toMessage(map_, layers, *message);
+  } else {
+    GridMapRosConverter::toMessage(map_, *message);
+  }
   publisher_.publish(message);
+  if (layer_stack_)
+    layer_stack_->CommitLayer("potential_field", map_, "potential_field");
+  changed_layers_.clear();
+  changed_regions_.clear();
+  is_all_changed_ = false;
   ROS_INFO_THROTTLE(1.0, "Grid map (timestamp %f) published.",
-                    message.info.header.stamp.toSec());
+                    message->info.header.stamp.toSec());
+}
+double PotentialField::obstacle_field_value(const ObstacleBox &box,
+                                            const Position &position,
+                                            double ver_x_p,
+                                            double ver_y_p) const {
+  double pos_x = box.pos_x;
+  double pos_y = box.pos_y;
+  double len_x = box.len_x;
+  double len_y = box.len_y;
+  double rotated_pos_x = box.cos_yaw * (position.x() - pos_x) -
+                         box.sin_yaw * (position.y() - pos_y) + pos_x;
+  double rotated_pos_y = box.sin_yaw * (position.x() - pos_x) +
+                         box.cos_yaw * (position.y() - pos_y) + pos_y;
+
+  // cells matching none of the cases are left as they are
+  if (pos_x - len_x < rotated_pos_x && rotated_pos_x < pos_x + len_x) {
+    if (pos_y - len_y < rotated_pos_y && rotated_pos_y < pos_y + len_y) {
+      return std::exp(0.0);
+    } else if (rotated_pos_y < pos_y - len_y) {
+      return std::exp(
+          (-1.0 * (std::pow((rotated_pos_y - (pos_y - len_y)), 2.0) /
+                   std::pow(2.0 * ver_y_p, 2.0))));
+    } else if (pos_y + len_y < rotated_pos_y) {
+      return std::exp(
+          (-1.0 * (std::pow((rotated_pos_y - (pos_y + len_y)), 2.0) /
+                   std::pow(2.0 * ver_y_p, 2.0))));
+    }
+  } else if (rotated_pos_x < pos_x - len_x) {
+    if (rotated_pos_y < pos_y - len_y) {
+      return std::exp(
+          (-1.0 * (std::pow((rotated_pos_y - (pos_y - len_y)), 2.0) /
+                   std::pow(2.0 * ver_y_p, 2.0))) +
+          (-1.0 * (std::pow((rotated_pos_x - (pos_x - len_x)), 2.0) /
+                   std::pow(2.0 * ver_x_p, 2.0))));
+    } else if (pos_y + len_y < rotated_pos_y) {
+      return std::exp(
+          (-1.0 * (std::pow((rotated_pos_y - (pos_y + len_y)), 2.0) /
+                   std::pow(2.0 * ver_y_p, 2.0))) +
+          (-1.0 * (std::pow((rotated_pos_x - (pos_x - len_x)), 2.0) /
+                   std::pow(2.0 * ver_x_p, 2.0))));
+    } else if (pos_y - len_y < rotated_pos_y && rotated_pos_y < pos_y + len_y) {
+      return std::exp(
+          (-1.0 * (std::pow((rotated_pos_x - (pos_x - len_x)), 2.0) /
+                   std::pow(2.0 * ver_x_p, 2.0))));
+    }
+  } else if (pos_x + len_x < rotated_pos_x) {
+    if (rotated_pos_y < pos_y - len_y) {
+      return std::exp(
+          (-1.0 * (std::pow((rotated_pos_y - (pos_y - len_y)), 2.0) /
+                   std::pow(2.0 * ver_y_p, 2.0))) +
+          (-1.0 * (std::pow((rotated_pos_x - (pos_x + len_x)), 2.0) /
+                   std::pow(2.0 * ver_x_p, 2.0))));
+    } else if (pos_y + len_y / 2.0 < rotated_pos_y) {
+      return std::exp(
+          (-1.0 * (std::pow((rotated_pos_y - (pos_y + len_y)), 2.0) /
+                   std::pow(2.0 * ver_y_p, 2.0))) +
+          (-1.0 * (std::pow((rotated_pos_x - (pos_x + len_x)), 2.0) /
+                   std::pow(2.0 * ver_x_p, 2.0))));
+    } else if (pos_y - len_y < rotated_pos_y && rotated_pos_y < pos_y + len_y) {
+      return std::exp(
+          (-1.0 * (std::pow((rotated_pos_x - (pos_x + len_x)), 2.0) /
+                   std::pow(2.0 * ver_x_p, 2.0))));
+    }
+  }
+  return 0.0;
+}
+
+// boxes within the update thresholds are not stamped again
+bool PotentialField::is_same_box(const ObstacleBox &a,
+                                 const ObstacleBox &b) const {
+  double yaw_diff = std::remainder(a.yaw - b.yaw, 2.0 * M_PI);
+  return std::fabs(a.pos_x - b.pos_x) <= obstacle_update_threshold_ &&
+         std::fabs(a.pos_y - b.pos_y) <= obstacle_update_threshold_ &&
+         std::fabs(a.len_x - b.len_x) <= obstacle_update_threshold_ &&
+         std::fabs(a.len_y - b.len_y) <= obstacle_update_threshold_ &&
+         std::fabs(yaw_diff) <= obstacle_update_yaw_threshold_;
+}
+
+// cells of the axis aligned bounds of the footprint grown by the margins
+bool PotentialField::obstacle_box_region(const ObstacleBox &box,
+                                         double margin_x, double margin_y,
+                                         CellRegion *region) const {
+  double map_min_x = map_.getPosition().x() - map_.getLength().x() / 2.0;
+  double map_max_x = map_.getPosition().x() + map_.getLength().x() / 2.0;
+  double map_min_y = map_.getPosition().y() - map_.getLength().y() / 2.0;
+  double map_max_y = map_.getPosition().y() + map_.getLength().y() / 2.0;
+
+  double around_x = box.len_x + margin_x;
+  double around_y = box.len_y + margin_y;
+  double half_x =
+      std::fabs(box.cos_yaw) * around_x + std::fabs(box.sin_yaw) * around_y;
+  double half_y =
+      std::fabs(box.sin_yaw) * around_x + std::fabs(box.cos_yaw) * around_y;
+  double min_x = std::max(box.pos_x - half_x, map_min_x);
+  double max_x = std::min(box.pos_x + half_x, map_max_x);
+  double min_y = std::max(box.pos_y - half_y, map_min_y);
+  double max_y = std::min(box.pos_y + half_y, map_max_y);
+  if (max_x <= min_x || max_y <= min_y)
+    return false;
+
+  bool is_success;
+  SubmapGeometry submap(
+      map_, Position((min_x + max_x) / 2.0, (min_y + max_y) / 2.0),
+      Length(max_x - min_x, max_y - min_y), is_success);
+  if (!is_success)
+    return false;
+  region->start = submap.getStartIndex();
+  region->size = submap.getSize();
+  return true;
+}
+
+// clear the regions and stamp again the boxes overlapping them, a cell gets
+// the value it would have if the whole layer was stamped
+void PotentialField::stamp_obstacle_boxes(
+    const std::vector<CellRegion> &regions, double ver_x_p, double ver_y_p) {
+  Matrix &obstacle_field = map_["obstacle_field"];
+  for (const auto &region : regions) {
+    obstacle_field
+        .block(region.start(0), region.start(1), region.size(0),
+               region.size(1))
+        .setZero();
+  }
+  for (const auto &stamped : stamped_boxes_) {
+    if (!stamped.in_map ||
+        std::none_of(regions.begin(), regions.end(),
+                     [&stamped](const CellRegion &region) {
+                       return region.overlaps(stamped.region);
+                     }))
+      continue;
+    for (SubmapIterator it(map_, stamped.region.start, stamped.region.size);
+         !it.isPastEnd(); ++it) {
+      bool is_changed = false;
+      for (const auto &region : regions) {
+        if (region.contains(*it)) {
+          is_changed = true;
+          break;
+        }
+      }
+      if (!is_changed)
+        continue;
+      Position position;
+      map_.getPosition(*it, position);
+      float &cell = obstacle_field((*it)(0), (*it)(1));
+      cell = std::max(
+          obstacle_field_value(stamped.box, position, ver_x_p, ver_y_p),
+          static_cast<double>(cell));
+    }
+  }
+  changed_regions_.insert(changed_regions_.end(), regions.begin(),
+                          regions.end());
 }
+
+void PotentialField::set_layer_changed(const std::string &layer) {
+  changed_layers_.insert(layer);
+  is_all_changed_ = true;
+}
+
 void PotentialField::obj_callback(
     autoware_msgs::DetectedObjectArray::ConstPtr obj_msg) { // Create grid map.
   static ObstacleFieldParameter param;
@@ -150,106 +310,92 @@ void PotentialField::obj_callback(
   // Add data to grid map.
   ros::Time time = ros::Time::now();
 
-  for (GridMapIterator it(map_); !it.isPastEnd(); ++it) {
+  std::vector<ObstacleBox> boxes;
+  boxes.reserve(obj_msg->objects.size());
+  for (int i(0); i < (int)obj_msg->objects.size(); ++i) {
+    ObstacleBox box;
+    box.pos_x = obj_msg->objects.at(i).pose.position.x + tf_x_ - map_x_offset_;
+    box.pos_y = obj_msg->objects.at(i).pose.position.y;
+    box.len_x = obj_msg->objects.at(i).dimensions.x / 2.0;
+    box.len_y = obj_msg->objects.at(i).dimensions.y / 2.0;
 
-    Position position;
-    map_.getPosition(*it, position);
-    map_.at("obstacle_field", *it) = 0.0;
-    for (int i(0); i < (int)obj_msg->objects.size(); ++i) {
-      double pos_x =
-          obj_msg->objects.at(i).pose.position.x + tf_x_ - map_x_offset_;
-      double pos_y = obj_msg->objects.at(i).pose.position.y;
-      double len_x = obj_msg->objects.at(i).dimensions.x / 2.0;
-      double len_y = obj_msg->objects.at(i).dimensions.y / 2.0;
+    if (-0.5 < box.pos_x && box.pos_x < 4.0) {
+      if (-1.0 < box.pos_y && box.pos_y < 1.0)
+        continue;
+    }
 
-      double r, p, y;
-      tf::Quaternion quat(obj_msg->objects.at(i).pose.orientation.x,
-                          obj_msg->objects.at(i).pose.orientation.y,
-                          obj_msg->objects.at(i).pose.orientation.z,
-                          obj_msg->objects.at(i).pose.orientation.w);
-      tf::Matrix3x3(quat).getRPY(r, p, y);
+    double r, p, y;
+    tf::Quaternion quat(obj_msg->objects.at(i).pose.orientation.x,
+                        obj_msg->objects.at(i).pose.orientation.y,
+                        obj_msg->objects.at(i).pose.orientation.z,
+                        obj_msg->objects.at(i).pose.orientation.w);
+    tf::Matrix3x3(quat).getRPY(r, p, y);
+    box.yaw = y;
+    box.cos_yaw = std::cos(-1.0 * y);
+    box.sin_yaw = std::sin(-1.0 * y);
+    boxes.push_back(box);
+  }
 
-      double rotated_pos_x = std::cos(-1.0 * y) * (position.x() - pos_x) -
-                             std::sin(-1.0 * y) * (position.y() - pos_y) +
-                             pos_x;
-      double rotated_pos_y = std::sin(-1.0 * y) * (position.x() - pos_x) +
-                             std::cos(-1.0 * y) * (position.y() - pos_y) +
-                             pos_y;
+  // distance from the footprint at which the falloff drops below the cutoff
+  double margin_x =
+      2.0 * ver_x_p * std::sqrt(-1.0 * std::log(obstacle_field_cutoff_));
+  double margin_y =
+      2.0 * ver_y_p * std::sqrt(-1.0 * std::log(obstacle_field_cutoff_));
 
-      if (-0.5 < pos_x && pos_x < 4.0) {
-        if (-1.0 < pos_y && pos_y < 1.0)
-          continue;
-      }
-      if (pos_x - len_x < rotated_pos_x && rotated_pos_x < pos_x + len_x) {
-        if (pos_y - len_y < rotated_pos_y && rotated_pos_y < pos_y + len_y) {
-          map_.at("obstacle_field", *it) =
-              std::max(std::exp(0.0),
-                       static_cast<double>(map_.at("obstacle_field", *it)));
-        } else if (rotated_pos_y < pos_y - len_y) {
-          map_.at("obstacle_field", *it) = std::max(
-              std::exp(
-                  (-1.0 * (std::pow((rotated_pos_y - (pos_y - len_y)), 2.0) /
-                           std::pow(2.0 * ver_y_p, 2.0)))),
-              static_cast<double>(map_.at("obstacle_field", *it)));
-        } else if (pos_y + len_y < rotated_pos_y) {
-          map_.at("obstacle_field", *it) = std::max(
-              std::exp(
-                  (-1.0 * (std::pow((rotated_pos_y - (pos_y + len_y)), 2.0) /
-                           std::pow(2.0 * ver_y_p, 2.0)))),
-              static_cast<double>(map_.at("obstacle_field", *it)));
-        }
-      } else if (rotated_pos_x < pos_x - len_x) {
-        if (rotated_pos_y < pos_y - len_y) {
-          map_.at("obstacle_field", *it) = std::max(
-              std::exp(
-                  (-1.0 * (std::pow((rotated_pos_y - (pos_y - len_y)), 2.0) /
-                           std::pow(2.0 * ver_y_p, 2.0))) +
-                  (-1.0 * (std::pow((rotated_pos_x - (pos_x - len_x)), 2.0) /
-                           std::pow(2.0 * ver_x_p, 2.0)))),
-              static_cast<double>(map_.at("obstacle_field", *it)));
-        } else if (pos_y + len_y < rotated_pos_y) {
-          map_.at("obstacle_field", *it) = std::max(
-              std::exp(
-                  (-1.0 * (std::pow((rotated_pos_y - (pos_y + len_y)), 2.0) /
-                           std::pow(2.0 * ver_y_p, 2.0))) +
-                  (-1.0 * (std::pow((rotated_pos_x - (pos_x - len_x)), 2.0) /
-                           std::pow(2.0 * ver_x_p, 2.0)))),
-              static_cast<double>(map_.at("obstacle_field", *it)));
-        } else if (pos_y - len_y < rotated_pos_y &&
-                   rotated_pos_y < pos_y + len_y) {
-          map_.at("obstacle_field", *it) = std::max(
-              std::exp(
-                  (-1.0 * (std::pow((rotated_pos_x - (pos_x - len_x)), 2.0) /
-                           std::pow(2.0 * ver_x_p, 2.0)))),
-              static_cast<double>(map_.at("obstacle_field", *it)));
-        }
-      } else if (pos_x + len_x < rotated_pos_x) {
-        if (rotated_pos_y < pos_y - len_y) {
-          map_.at("obstacle_field", *it) = std::max(
-              std::exp(
-                  (-1.0 * (std::pow((rotated_pos_y - (pos_y - len_y)), 2.0) /
-                           std::pow(2.0 * ver_y_p, 2.0))) +
-                  (-1.0 * (std::pow((rotated_pos_x - (pos_x + len_x)), 2.0) /
-                           std::pow(2.0 * ver_x_p, 2.0)))),
-              static_cast<double>(map_.at("obstacle_field", *it)));
-        } else if (pos_y + len_y / 2.0 < rotated_pos_y) {
-          map_.at("obstacle_field", *it) = std::max(
-              std::exp(
-                  (-1.0 * (std::pow((rotated_pos_y - (pos_y + len_y)), 2.0) /
-                           std::pow(2.0 * ver_y_p, 2.0))) +
-                  (-1.0 * (std::pow((rotated_pos_x - (pos_x + len_x)), 2.0) /
-                           std::pow(2.0 * ver_x_p, 2.0)))),
-              static_cast<double>(map_.at("obstacle_field", *it)));
-        } else if (pos_y - len_y < rotated_pos_y &&
-                   rotated_pos_y < pos_y + len_y) {
-          map_.at("obstacle_field", *it) = std::max(
-              std::exp(
-                  (-1.0 * (std::pow((rotated_pos_x - (pos_x + len_x)), 2.0) /
-                           std::pow(2.0 * ver_x_p, 2.0)))),
-              static_cast<double>(map_.at("obstacle_field", *it)));
+  // the boxes matching a stamped box are kept as they were stamped, the
+  // cells of the other ones and of the boxes gone are stamped again
+  std::vector<StampedBox> stamped_boxes;
+  std::vector<bool> is_kept(stamped_boxes_.size(), false);
+  std::vector<CellRegion> changed_regions;
+  bool is_changed = false;
+  for (const auto &box : boxes) {
+    size_t j = 0;
+    while (j < stamped_boxes_.size() &&
+           (is_kept[j] || !is_same_box(stamped_boxes_[j].box, box)))
+      ++j;
+    if (j < stamped_boxes_.size()) {
+      is_kept[j] = true;
+      stamped_boxes.push_back(stamped_boxes_[j]);
+      continue;
+    }
+    StampedBox stamped;
+    stamped.box = box;
+    stamped.in_map =
+        obstacle_box_region(box, margin_x, margin_y, &stamped.region);
+    if (stamped.in_map)
+      changed_regions.push_back(stamped.region);
+    stamped_boxes.push_back(stamped);
+    is_changed = true;
+  }
+  for (size_t j = 0; j < stamped_boxes_.size(); ++j) {
+    if (is_kept[j])
+      continue;
+    if (stamped_boxes_[j].in_map)
+      changed_regions.push_back(stamped_boxes_[j].region);
+    is_changed = true;
+  }
+  stamped_boxes_.swap(stamped_boxes);
+
+  if (!use_object_rasterization_) {
+    // every cell depends on every box
+    if (is_changed) {
+      Matrix &obstacle_field = map_["obstacle_field"];
+      obstacle_field.setZero();
+      for (GridMapIterator it(map_); !it.isPastEnd(); ++it) {
+        Position position;
+        map_.getPosition(*it, position);
+        float &cell = obstacle_field((*it)(0), (*it)(1));
+        for (const auto &stamped : stamped_boxes_) {
+          cell = std::max(
+              obstacle_field_value(stamped.box, position, ver_x_p, ver_y_p),
+              static_cast<double>(cell));
         }
       }
+      set_layer_changed("obstacle_field");
     }
+  } else if (!changed_regions.empty()) {
+    stamp_obstacle_boxes(changed_regions, ver_x_p, ver_y_p);
+    changed_layers_.insert("obstacle_field");
   }
   // Publish grid map.
   map_.setTimestamp(time.toNSec());
@@ -276,6 +422,13 @@ void PotentialField::target_waypoint_callback(
   } catch (tf::TransformException &ex) {
     ROS_ERROR("%s", ex.what());
   }
+  if (has_target_waypoint_ &&
+      std::hypot(out.point.x - target_waypoint_.x,
+                 out.point.y - target_waypoint_.y) <=
+          obstacle_update_threshold_)
+    return;
+  has_target_waypoint_ = true;
+  target_waypoint_ = out.point;
 
   for (GridMapIterator it(map_); !it.isPastEnd(); ++it) {
     Position position;
@@ -287,6 +440,7 @@ void PotentialField::target_waypoint_callback(
                        (-1.0 * (std::pow((position.x() - (out.point.x)), 2.0) /
                                 std::pow(2.0 * ver_x_p, 2.0))));
   }
+  set_layer_changed("target_waypoint_field");
   map_.setTimestamp(time.toNSec());
 }
 
@@ -326,15 +480,9 @@ void PotentialField::vscan_points_callback(
       }
     }
   }
+  set_layer_changed("vscan_points_field");
   map_.setTimestamp(time.toNSec());
   publish_potential_field();
 }
 
-int main(int argc, char **argv) {
-  ros::init(argc, argv, "potential_field");
-
-  PotentialField potential_field;
-  potential_field.init();
-  potential_field.run();
-  return 0;
-}
+} // namespace object_map
@@ -0,0 +1,159 @@
+/*
+ * Copyright 2015-2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef POTENTIAL_FIELD_H
+#define POTENTIAL_FIELD_H
+
+#include "tf/transform_listener.h"
+#include <algorithm>
+#include <cmath>
+#include <geometry_msgs/PointStamped.h>
+#include <grid_map_msgs/GridMap.h>
+#include <grid_map_ros/grid_map_ros.hpp>
+#include <iostream>
+#include <set>
+#include <string>
+#include <jsk_recognition_msgs/BoundingBox.h>
+#include <jsk_recognition_msgs/BoundingBoxArray.h>
+#include "autoware_msgs/DetectedObject.h"
+#include "autoware_msgs/DetectedObjectArray.h"
+#include <pcl_conversions/pcl_conversions.h>
+#include <ros/ros.h>
+#include <sensor_msgs/PointCloud2.h>
+#include <visualization_msgs/Marker.h>
+#include <visualization_msgs/MarkerArray.h>
+#include <memory>
+#include <vector>
+
+#include "object_map/shared_layer_stack.hpp"
+
+namespace object_map {
+
+using namespace grid_map;
+
+class PotentialField {
+private:
+  ros::NodeHandle nh_;
+  ros::Publisher publisher_;
+  ros::Subscriber waypoint_subscriber_;
+  ros::Subscriber vscan_subscriber_;
+  ros::Subscriber obj_subscriber_;
+  bool use_target_waypoint_;
+  bool use_obstacle_box_;
+  bool use_vscan_points_;
+  double map_x_size_;
+  double map_y_size_;
+  double map_resolution_;
+  double tf_x_;
+  double tf_z_;
+  double map_x_offset_;
+  bool use_object_rasterization_;
+  double obstacle_field_cutoff_;
+  double obstacle_update_threshold_;
+  double obstacle_update_yaw_threshold_;
+  bool publish_changed_layers_;
+  // potential_field layer shared with the consumers of this process, null
+  // when ~layer_stack is empty
+  std::shared_ptr<SharedLayerStack> layer_stack_;
+  GridMap map_;
+  class ObstacleFieldParameter {
+  public:
+    ObstacleFieldParameter() : ver_x_p(0.9), ver_y_p(0.9) {}
+    double ver_x_p;
+    double ver_y_p;
+  };
+  class TargetWaypointFieldParamater {
+  public:
+    TargetWaypointFieldParamater() : ver_x_p(1.0), ver_y_p(1.0) {}
+    double ver_x_p;
+    double ver_y_p;
+  };
+  class VscanPointsFieldParamater {
+  public:
+    VscanPointsFieldParamater() : around_x(0.5), around_y(0.5) {}
+    double around_x;
+    double around_y;
+  };
+  // detected object in potential_field_link, cos_yaw and sin_yaw rotate a
+  // position into the object frame
+  struct ObstacleBox {
+    double pos_x;
+    double pos_y;
+    double len_x;
+    double len_y;
+    double yaw;
+    double cos_yaw;
+    double sin_yaw;
+  };
+  // cells from start to start + size - 1, the map does not move so the
+  // indexes do not wrap around
+  struct CellRegion {
+    Index start;
+    Size size;
+    bool contains(const Index &index) const {
+      return start(0) <= index(0) && index(0) < start(0) + size(0) &&
+             start(1) <= index(1) && index(1) < start(1) + size(1);
+    }
+    bool overlaps(const CellRegion &other) const {
+      return start(0) < other.start(0) + other.size(0) &&
+             other.start(0) < start(0) + size(0) &&
+             start(1) < other.start(1) + other.size(1) &&
+             other.start(1) < start(1) + size(1);
+    }
+  };
+  // box as it is in obstacle_field, in_map is false if it has no cell
+  struct StampedBox {
+    ObstacleBox box;
+    CellRegion region;
+    bool in_map;
+  };
+  std::vector<StampedBox> stamped_boxes_;
+  // changes of the layers since the last publish, the potential_field is
+  // computed again only in the changed cells
+  std::set<std::string> changed_layers_;
+  std::vector<CellRegion> changed_regions_;
+  bool is_all_changed_;
+  bool has_target_waypoint_;
+  geometry_msgs::Point target_waypoint_;
+
+  double obstacle_field_value(const ObstacleBox &box, const Position &position,
+                              double ver_x_p, double ver_y_p) const;
+  bool is_same_box(const ObstacleBox &a, const ObstacleBox &b) const;
+  bool obstacle_box_region(const ObstacleBox &box, double margin_x,
+                           double margin_y, CellRegion *region) const;
+  void stamp_obstacle_boxes(const std::vector<CellRegion> &regions,
+                            double ver_x_p, double ver_y_p);
+  void set_layer_changed(const std::string &layer);
+  void obj_callback(autoware_msgs::DetectedObjectArray::ConstPtr obj_msg);
+  void target_waypoint_callback(
+      visualization_msgs::Marker::ConstPtr target_point_msgs);
+  void vscan_points_callback(sensor_msgs::PointCloud2::ConstPtr vscan_msg);
+  void publish_potential_field();
+
+public:
+  PotentialField();
+  /*!
+   * @param[in] nh Handle of the topics, the one of the nodelet when loaded in
+   * a manager
+   * @param[in] private_nh Handle of the parameters
+   */
+  PotentialField(ros::NodeHandle nh, ros::NodeHandle private_nh);
+  void run();
+  void init();
+};
+
+} // namespace object_map
+
+#endif // POTENTIAL_FIELD_H
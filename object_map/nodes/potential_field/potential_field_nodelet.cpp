@@ -0,0 +1,43 @@
+/*
+ * Copyright 2015-2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <nodelet/nodelet.h>
+#include <pluginlib/class_list_macros.h>
+
+#include <memory>
+
+#include "potential_field.h"
+
+namespace object_map {
+
+/*!
+ * potential_field in a nodelet manager, the detected objects and the field are
+ * passed by pointer to the other nodelets of the manager
+ */
+class PotentialFieldNodelet : public nodelet::Nodelet {
+private:
+  std::unique_ptr<PotentialField> potential_field_;
+
+  void onInit() override {
+    potential_field_.reset(
+        new PotentialField(getNodeHandle(), getPrivateNodeHandle()));
+    potential_field_->init();
+  }
+};
+
+} // namespace object_map
+
+PLUGINLIB_EXPORT_CLASS(object_map::PotentialFieldNodelet, nodelet::Nodelet)
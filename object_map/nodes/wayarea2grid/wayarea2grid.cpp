@@ -20,10 +20,23 @@ namespace object_map
 {
 
   WayareaToGrid::WayareaToGrid() :
-      private_node_handle_("~")
+      WayareaToGrid(ros::NodeHandle(), ros::NodeHandle("~"))
+  {
+  }
+
+  WayareaToGrid::WayareaToGrid(ros::NodeHandle in_node_handle, ros::NodeHandle in_private_node_handle) :
+      node_handle_(in_node_handle), private_node_handle_(in_private_node_handle)
   {
     InitializeROSIo();
     LoadRoadAreasFromVectorMap(private_node_handle_, area_points_);
+    area_index_.Build(area_points_);
+
+    // the wayareas do not move in the map frame, they are rasterized once
+    if (wayarea_cache_resolution_ > 0 && !area_points_.empty())
+    {
+      wayarea_cache_ = WayareaRasterCache(wayarea_cache_resolution_);
+      wayarea_cache_.Rasterize(area_points_);
+    }
   }
 
 
@@ -37,6 +50,12 @@ namespace object_map
     private_node_handle_.param<double>("grid_position_x", grid_position_x_, 20);
     private_node_handle_.param<double>("grid_position_y", grid_position_y_, 0);
     private_node_handle_.param<double>("grid_position_z", grid_position_z_, -2.f);
+    private_node_handle_.param<double>("wayarea_cache_resolution", wayarea_cache_resolution_, grid_resolution_ / 2.0);
+
+    std::string layer_stack;
+    private_node_handle_.param<std::string>("layer_stack", layer_stack, "");
+    if (!layer_stack.empty())
+      layer_stack_ = SharedLayerStack::Get(layer_stack);
 
     publisher_grid_map_ = node_handle_.advertise<grid_map_msgs::GridMap>("grid_map_wayarea", 1, true);
     publisher_occupancy_ = node_handle_.advertise<nav_msgs::OccupancyGrid>("occupancy_wayarea", 1, true);
@@ -44,40 +63,50 @@ namespace object_map
 
   void WayareaToGrid::Run()
   {
-    bool set_map = false;
     ros::Rate loop_rate(10);
 
     while (ros::ok())
     {
-      if (!set_map)
-      {
-        gridmap_.add(grid_layer_name_);
-        gridmap_.setFrameId(sensor_frame_);
-        gridmap_.setGeometry(grid_map::Length(grid_length_x_, grid_length_y_),
-                        grid_resolution_,
-                        grid_map::Position(grid_position_x_, grid_position_y_));
-        set_map = true;
-      }
-
-      // timer start
-      //auto start = std::chrono::system_clock::now();
-
-      if (!area_points_.empty())
-      {
-        FillPolygonAreas(gridmap_, area_points_, grid_layer_name_, OCCUPANCY_NO_ROAD, OCCUPANCY_ROAD, grid_min_value_,
-                         grid_max_value_, sensor_frame_, map_frame_,
-                         tf_listener_);
-        PublishGridMap(gridmap_, publisher_grid_map_);
-        PublishOccupancyGrid(gridmap_, publisher_occupancy_, grid_layer_name_, grid_min_value_, grid_max_value_, grid_position_z_);
-      }
-
-      // timer end
-      //auto end = std::chrono::system_clock::now();
-      //auto usec = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
-      //std::cout << "time: " << usec / 1000.0 << " [msec]" << std::endl;
+      Update();
 
       loop_rate.sleep();
     }
   }
 
+  void WayareaToGrid::Update()
+  {
+    if (!set_map_)
+    {
+      gridmap_.add(grid_layer_name_);
+      gridmap_.setFrameId(sensor_frame_);
+      gridmap_.setGeometry(grid_map::Length(grid_length_x_, grid_length_y_),
+                      grid_resolution_,
+                      grid_map::Position(grid_position_x_, grid_position_y_));
+      set_map_ = true;
+    }
+
+    // timer start
+    //auto start = std::chrono::system_clock::now();
+
+    if (!area_points_.empty())
+    {
+      if (wayarea_cache_resolution_ > 0)
+        FillPolygonAreas(gridmap_, wayarea_cache_, grid_layer_name_, OCCUPANCY_NO_ROAD, OCCUPANCY_ROAD,
+                         sensor_frame_, map_frame_, tf_listener_);
+      else
+        FillPolygonAreas(gridmap_, area_points_, area_index_, grid_layer_name_, OCCUPANCY_NO_ROAD, OCCUPANCY_ROAD,
+                         grid_min_value_, grid_max_value_, sensor_frame_, map_frame_,
+                         tf_listener_);
+      if (layer_stack_)
+        layer_stack_->CommitLayer(grid_layer_name_, gridmap_, grid_layer_name_);
+      PublishGridMap(gridmap_, publisher_grid_map_);
+      PublishOccupancyGrid(gridmap_, publisher_occupancy_, grid_layer_name_, grid_min_value_, grid_max_value_, grid_position_z_);
+    }
+
+    // timer end
+    //auto end = std::chrono::system_clock::now();
+    //auto usec = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+    //std::cout << "time: " << usec / 1000.0 << " [msec]" << std::endl;
+  }
+
 }  // namespace object_map
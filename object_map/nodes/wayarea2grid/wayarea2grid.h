@@ -36,6 +36,7 @@
 #include <opencv2/highgui/highgui.hpp>
 
 #include "object_map/object_map_utils.hpp"
+#include "object_map/shared_layer_stack.hpp"
 
 namespace object_map
 {
@@ -45,8 +46,19 @@ namespace object_map
   public:
     WayareaToGrid();
 
+    /*!
+     * @param[in] in_node_handle Handle of the topics, the one of the nodelet when loaded in a manager
+     * @param[in] in_private_node_handle Handle of the parameters
+     */
+    WayareaToGrid(ros::NodeHandle in_node_handle, ros::NodeHandle in_private_node_handle);
+
     void Run();
 
+    /*!
+     * Fills and publishes the grid once, Run() calls it at 10 Hz
+     */
+    void Update();
+
   private:
     // handle
     ros::NodeHandle         node_handle_;
@@ -68,15 +80,23 @@ namespace object_map
     double                  grid_position_x_;
     double                  grid_position_y_;
     double                  grid_position_z_;
+    double                  wayarea_cache_resolution_;
 
     tf::TransformListener   tf_listener_;
 
+    bool                    set_map_ = false;
+
     int                     OCCUPANCY_ROAD      = 128;
     int                     OCCUPANCY_NO_ROAD   = 255;
     const int               grid_min_value_     = 0;
     const int               grid_max_value_     = 255;
 
     std::vector<std::vector<geometry_msgs::Point>> area_points_;
+    WayareaRasterCache      wayarea_cache_;
+    WayareaSpatialIndex     area_index_;
+
+    // wayarea layer shared with the consumers of this process, null when ~layer_stack is empty
+    std::shared_ptr<SharedLayerStack> layer_stack_;
 
     /*!
      * Initializes ROS Publisher, Subscribers and sets the configuration parameters
@@ -0,0 +1,49 @@
+/*
+ * Copyright 2018-2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ********************/
+
+
+#include <nodelet/nodelet.h>
+#include <pluginlib/class_list_macros.h>
+
+#include <memory>
+
+#include "wayarea2grid.h"
+
+namespace object_map
+{
+
+  /*!
+   * wayarea2grid in a nodelet manager, the grid is updated by a timer instead of the loop of the node
+   */
+  class WayareaToGridNodelet : public nodelet::Nodelet
+  {
+  private:
+    std::unique_ptr<WayareaToGrid> wayarea2grid_;
+    ros::Timer timer_;
+
+    void onInit() override
+    {
+      wayarea2grid_.reset(new WayareaToGrid(getNodeHandle(), getPrivateNodeHandle()));
+      timer_ = getNodeHandle().createTimer(ros::Duration(0.1), [this](const ros::TimerEvent &)
+                                           {
+                                             wayarea2grid_->Update();
+                                           });
+    }
+  };
+
+}  // namespace object_map
+
+PLUGINLIB_EXPORT_CLASS(object_map::WayareaToGridNodelet, nodelet::Nodelet)
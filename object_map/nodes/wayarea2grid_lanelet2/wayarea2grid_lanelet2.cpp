@@ -29,14 +29,21 @@ WayareaToGridLanelet2::WayareaToGridLanelet2() : private_node_handle_("~")
 
 void WayareaToGridLanelet2::initAreaPointsFromLaneletMap()
 {
-  ros::Subscriber sub_lanelet_bin_map =
-      node_handle_.subscribe("lanelet_map_bin", 1, &WayareaToGridLanelet2::laneletBinMapCallback, this);
+  // the bin message is only received when the map image shared by lanelet2_map_loader is not on this host
+  ros::Subscriber sub_lanelet_shared_map;
+  if (use_shared_map_)
+    sub_lanelet_shared_map =
+        node_handle_.subscribe("lanelet_map_bin/shared", 1, &WayareaToGridLanelet2::laneletSharedMapCallback, this);
+  else
+    sub_lanelet_bin_map_ =
+        node_handle_.subscribe("lanelet_map_bin", 1, &WayareaToGridLanelet2::laneletBinMapCallback, this);
 
   while (ros::ok() && !loaded_lanelet_map_)
   {
     ros::spinOnce();
     ros::Duration(0.1).sleep();
   }
+  sub_lanelet_bin_map_.shutdown();
 
   // use all lanelets in map of subtype road to give way area
   lanelet::ConstLanelets all_lanelets = lanelet::utils::query::laneletLayer(lanelet_map_);
@@ -50,6 +57,15 @@ void WayareaToGridLanelet2::initAreaPointsFromLaneletMap()
 
     for (const auto& triangle : triangles)
     {
+      // degenerate triangles fill no cell but would still be indexed and scan-converted every cycle
+      if (triangle.points.size() < 3)
+        continue;
+      const auto& a = triangle.points[0];
+      const auto& b = triangle.points[1];
+      const auto& c = triangle.points[2];
+      if ((b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x) == 0.0)
+        continue;
+
       std::vector<geometry_msgs::Point> poly_pts;
       for (const auto& p : triangle.points)
       {
@@ -63,6 +79,15 @@ void WayareaToGridLanelet2::initAreaPointsFromLaneletMap()
       area_points_.push_back(poly_pts);
     }
   }
+
+  area_index_.Build(area_points_);
+
+  // the lanelets do not move in the map frame, they are rasterized once
+  if (wayarea_cache_resolution_ > 0 && !area_points_.empty())
+  {
+    wayarea_cache_ = WayareaRasterCache(wayarea_cache_resolution_);
+    wayarea_cache_.Rasterize(area_points_);
+  }
 }
 
 void WayareaToGridLanelet2::InitializeROSIo()
@@ -75,6 +100,13 @@ void WayareaToGridLanelet2::InitializeROSIo()
   private_node_handle_.param<double>("grid_position_x", grid_position_x_, 20);
   private_node_handle_.param<double>("grid_position_y", grid_position_y_, 0);
   private_node_handle_.param<double>("grid_position_z", grid_position_z_, -2.f);
+  private_node_handle_.param<bool>("use_shared_map", use_shared_map_, false);
+  private_node_handle_.param<double>("wayarea_cache_resolution", wayarea_cache_resolution_, grid_resolution_ / 2.0);
+
+  std::string layer_stack;
+  private_node_handle_.param<std::string>("layer_stack", layer_stack, "");
+  if (!layer_stack.empty())
+    layer_stack_ = SharedLayerStack::Get(layer_stack);
 
   publisher_grid_map_ = node_handle_.advertise<grid_map_msgs::GridMap>("grid_map_wayarea", 1, true);
   publisher_occupancy_ = node_handle_.advertise<nav_msgs::OccupancyGrid>("occupancy_wayarea", 1, true);
@@ -87,6 +119,21 @@ void WayareaToGridLanelet2::laneletBinMapCallback(const autoware_lanelet2_msgs::
   loaded_lanelet_map_ = true;
 }
 
+void WayareaToGridLanelet2::laneletSharedMapCallback(const std_msgs::String& msg)
+{
+  lanelet_map_ = std::make_shared<lanelet::LaneletMap>();
+  if (lanelet::utils::conversion::fromSharedMap(msg.data, lanelet_map_))
+  {
+    loaded_lanelet_map_ = true;
+  }
+  else if (!sub_lanelet_bin_map_)
+  {
+    ROS_INFO("Shared map %s not available, waiting for lanelet_map_bin", msg.data.c_str());
+    sub_lanelet_bin_map_ =
+        node_handle_.subscribe("lanelet_map_bin", 1, &WayareaToGridLanelet2::laneletBinMapCallback, this);
+  }
+}
+
 void WayareaToGridLanelet2::Run()
 {
   ros::Rate loop_rate(10);
@@ -100,8 +147,14 @@ void WayareaToGridLanelet2::Run()
   {
     if (!area_points_.empty())
     {
-      FillPolygonAreas(gridmap_, area_points_, grid_layer_name_, occupancy_no_road, occupancy_road, grid_min_value_,
-                       grid_max_value_, sensor_frame_, grid_frame_, tf_listener_);
+      if (wayarea_cache_resolution_ > 0)
+        FillPolygonAreas(gridmap_, wayarea_cache_, grid_layer_name_, occupancy_no_road, occupancy_road, sensor_frame_,
+                         grid_frame_, tf_listener_);
+      else
+        FillPolygonAreas(gridmap_, area_points_, area_index_, grid_layer_name_, occupancy_no_road, occupancy_road,
+                         grid_min_value_, grid_max_value_, sensor_frame_, grid_frame_, tf_listener_);
+      if (layer_stack_)
+        layer_stack_->CommitLayer(grid_layer_name_, gridmap_, grid_layer_name_);
       PublishGridMap(gridmap_, publisher_grid_map_);
       PublishOccupancyGrid(gridmap_, publisher_occupancy_, grid_layer_name_, grid_min_value_, grid_max_value_,
                            grid_position_z_);
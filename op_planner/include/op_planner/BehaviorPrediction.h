@@ -14,6 +14,8 @@
 #include "PlannerH.h"
 #include "op_utility/UtilityH.h"
 #include "PassiveDecisionMaker.h"
+#include "op_utility/TaskScheduler.h"
+#include <unordered_map>
 
 namespace PlannerHNS
 {
@@ -33,6 +35,7 @@ namespace PlannerHNS
 #define KEEP_PERCENTAGE 0.85
 
 #define MAX_PREDICTION_SPEED 10.0
+#define PREDICTION_CACHE_CONSUMED_RATIO 0.25 // cached trajectories are searched again once the object moved this part of the prediction distance along them
 
 #define POSE_FACTOR 0.1
 #define DIRECTION_FACTOR 0.1
@@ -60,7 +63,6 @@ class TrajectoryTracker;
 class Particle
 {
 public:
-  bool bDeleted;
   BEH_STATE_TYPE beh; //[Stop, Yielding, Forward, Branching]
   double vel; //[0 -> Stop,1 -> moving]
   double vel_prev_big;
@@ -78,15 +80,12 @@ public:
   double acl_w;
   double ind_w;
   TrajectoryTracker* pTraj;
-  int original_index;
 
   Particle()
   {
     prev_time_diff = 0;
     vel_prev_big = 0;
-    original_index = 0;
     bStopLine = false;
-    bDeleted = false;
     pTraj = nullptr;
     w = 0;
     w_raw = 0;
@@ -103,6 +102,153 @@ public:
   }
 };
 
+/**
+ * @brief Particles of one object stored as a structure of arrays, each field is contiguous so the weight loops run over plain arrays.
+ * Only the position, heading and speed of the pose are kept. Removing a particle moves the last one into its place, so the order is not kept.
+ */
+class ParticleBuffer
+{
+public:
+  std::vector<double> x;
+  std::vector<double> y;
+  std::vector<double> a;
+  std::vector<double> v; // speed of the pose, used to move the particle
+  std::vector<double> vel;
+  std::vector<double> vel_prev_big;
+  std::vector<double> prev_time_diff;
+  std::vector<double> acc_raw;
+  std::vector<int> acc;
+  std::vector<int> indicator;
+  std::vector<BEH_STATE_TYPE> beh;
+  std::vector<TrajectoryTracker*> pTraj;
+
+  std::vector<double> w;
+  std::vector<double> w_raw;
+  std::vector<double> pose_w;
+  std::vector<double> dir_w;
+  std::vector<double> vel_w;
+  std::vector<double> acl_w;
+  std::vector<double> ind_w;
+
+  unsigned int size() const
+  {
+    return x.size();
+  }
+
+  void Clear()
+  {
+    Resize(0);
+  }
+
+  void Reserve(const unsigned int& n)
+  {
+    x.reserve(n); y.reserve(n); a.reserve(n); v.reserve(n);
+    vel.reserve(n); vel_prev_big.reserve(n); prev_time_diff.reserve(n); acc_raw.reserve(n);
+    acc.reserve(n); indicator.reserve(n); beh.reserve(n); pTraj.reserve(n);
+    w.reserve(n); w_raw.reserve(n); pose_w.reserve(n); dir_w.reserve(n); vel_w.reserve(n); acl_w.reserve(n); ind_w.reserve(n);
+  }
+
+  void Add(const Particle& p, TrajectoryTracker* pTrack)
+  {
+    x.push_back(p.pose.pos.x); y.push_back(p.pose.pos.y); a.push_back(p.pose.pos.a); v.push_back(p.pose.v);
+    vel.push_back(p.vel); vel_prev_big.push_back(p.vel_prev_big); prev_time_diff.push_back(p.prev_time_diff); acc_raw.push_back(p.acc_raw);
+    acc.push_back(p.acc); indicator.push_back(p.indicator); beh.push_back(p.beh); pTraj.push_back(pTrack);
+    w.push_back(p.w); w_raw.push_back(p.w_raw); pose_w.push_back(p.pose_w); dir_w.push_back(p.dir_w); vel_w.push_back(p.vel_w); acl_w.push_back(p.acl_w); ind_w.push_back(p.ind_w);
+  }
+
+  Particle Get(const unsigned int& i) const
+  {
+    Particle p;
+    p.pose.pos.x = x.at(i); p.pose.pos.y = y.at(i); p.pose.pos.a = a.at(i); p.pose.v = v.at(i);
+    p.vel = vel.at(i); p.vel_prev_big = vel_prev_big.at(i); p.prev_time_diff = prev_time_diff.at(i); p.acc_raw = acc_raw.at(i);
+    p.acc = acc.at(i); p.indicator = indicator.at(i); p.beh = beh.at(i); p.pTraj = pTraj.at(i);
+    p.w = w.at(i); p.w_raw = w_raw.at(i); p.pose_w = pose_w.at(i); p.dir_w = dir_w.at(i); p.vel_w = vel_w.at(i); p.acl_w = acl_w.at(i); p.ind_w = ind_w.at(i);
+    return p;
+  }
+
+  void Set(const unsigned int& i, const Particle& p)
+  {
+    x[i] = p.pose.pos.x; y[i] = p.pose.pos.y; a[i] = p.pose.pos.a; v[i] = p.pose.v;
+    vel[i] = p.vel; vel_prev_big[i] = p.vel_prev_big; prev_time_diff[i] = p.prev_time_diff; acc_raw[i] = p.acc_raw;
+    acc[i] = p.acc; indicator[i] = p.indicator; beh[i] = p.beh;
+    w[i] = p.w; w_raw[i] = p.w_raw; pose_w[i] = p.pose_w; dir_w[i] = p.dir_w; vel_w[i] = p.vel_w; acl_w[i] = p.acl_w; ind_w[i] = p.ind_w;
+  }
+
+  /**
+   * @brief Copy particle from into to, both indices must exist
+   */
+  void Copy(const unsigned int& from, const unsigned int& to)
+  {
+    x[to] = x[from]; y[to] = y[from]; a[to] = a[from]; v[to] = v[from];
+    vel[to] = vel[from]; vel_prev_big[to] = vel_prev_big[from]; prev_time_diff[to] = prev_time_diff[from]; acc_raw[to] = acc_raw[from];
+    acc[to] = acc[from]; indicator[to] = indicator[from]; beh[to] = beh[from]; pTraj[to] = pTraj[from];
+    w[to] = w[from]; w_raw[to] = w_raw[from]; pose_w[to] = pose_w[from]; dir_w[to] = dir_w[from]; vel_w[to] = vel_w[from]; acl_w[to] = acl_w[from]; ind_w[to] = ind_w[from];
+  }
+
+  /**
+   * @brief O(1) removal, the last particle takes the place of particle i
+   */
+  void Remove(const unsigned int& i)
+  {
+    unsigned int last = size() - 1;
+    if(i != last)
+      Copy(last, i);
+    Resize(last);
+  }
+
+  /**
+   * @brief Keep the particles listed in indices (repetitions allowed) in that order
+   */
+  void Select(const std::vector<unsigned int>& indices)
+  {
+    ParticleBuffer selected;
+    selected.Reserve(indices.size());
+    for(unsigned int i = 0; i < indices.size(); i++)
+      selected.Add(Get(indices.at(i)), pTraj.at(indices.at(i)));
+    *this = selected;
+  }
+
+  /**
+   * @brief Systematic resampling of the weights w, u0 in [0, 1) is the single random draw.
+   * Returns size() indices, particle i is picked in proportion to w[i]. Empty when the weights sum to zero.
+   */
+  void GetSystematicSamples(const double& u0, std::vector<unsigned int>& indices) const
+  {
+    indices.clear();
+    const unsigned int n = size();
+    double total = 0;
+    for(unsigned int i = 0; i < n; i++)
+      total += w[i];
+
+    if(n == 0 || total <= 0) return;
+
+    indices.resize(n);
+    double step = total/(double)n;
+    double u = u0*step;
+    double c = w[0];
+    unsigned int j = 0;
+    for(unsigned int i = 0; i < n; i++)
+    {
+      while(u > c && j < n-1)
+      {
+        j++;
+        c += w[j];
+      }
+      indices[i] = j;
+      u += step;
+    }
+  }
+
+private:
+  void Resize(const unsigned int& n)
+  {
+    x.resize(n); y.resize(n); a.resize(n); v.resize(n);
+    vel.resize(n); vel_prev_big.resize(n); prev_time_diff.resize(n); acc_raw.resize(n);
+    acc.resize(n); indicator.resize(n); beh.resize(n); pTraj.resize(n);
+    w.resize(n); w_raw.resize(n); pose_w.resize(n); dir_w.resize(n); vel_w.resize(n); acl_w.resize(n); ind_w.resize(n);
+  }
+};
+
 class TrajectoryTracker
 {
 public:
@@ -116,11 +262,6 @@ public:
   double rms_error;
   std::vector<WayPoint> trajectory;
 
-  std::vector<Particle> m_ForwardPart;
-  std::vector<Particle> m_StopPart;
-  std::vector<Particle> m_YieldPart;
-  std::vector<Particle> m_LeftPart;
-  std::vector<Particle> m_RightPart;
   BehaviorState m_CurrBehavior;
 
   int nAliveStop;
@@ -202,11 +343,6 @@ public:
     best_p = obj.best_p;
     m_SinglePathDecisionMaker = obj.m_SinglePathDecisionMaker;
 
-    m_ForwardPart = obj.m_ForwardPart;
-    m_StopPart = obj.m_StopPart;
-    m_YieldPart = obj.m_YieldPart;
-    m_LeftPart = obj.m_LeftPart;
-    m_RightPart = obj.m_RightPart;
     m_CurrBehavior = obj.m_CurrBehavior;
 
     w_avg_forward = obj.w_avg_forward;
@@ -365,115 +501,67 @@ public:
     return totalMatch;
   }
 
-  void InsertNewParticle(const Particle& p)
+  /**
+   * @brief Count one more particle of behavior b, false when the behavior already has BEH_PARTICLES_NUM particles
+   */
+  bool AddAlive(const BEH_STATE_TYPE& b)
   {
-    if(p.beh == PlannerHNS::BEH_STOPPING_STATE && nAliveStop < BEH_PARTICLES_NUM)
-    {
-      m_StopPart.push_back(p);
-      m_StopPart.at(m_StopPart.size()-1).pTraj = this;
-      nAliveStop++;
-    }
-    else if(p.beh == PlannerHNS::BEH_YIELDING_STATE && nAliveYield < BEH_PARTICLES_NUM)
-    {
-      m_YieldPart.push_back(p);
-      m_YieldPart.at(m_YieldPart.size()-1).pTraj = this;
-      nAliveYield++;
-    }
-    else if(p.beh == PlannerHNS::BEH_FORWARD_STATE && nAliveForward < BEH_PARTICLES_NUM)
-    {
-      m_ForwardPart.push_back(p);
-      m_ForwardPart.at(m_ForwardPart.size()-1).pTraj = this;
-      nAliveForward++;
-    }
-    else if(p.beh == PlannerHNS::BEH_BRANCH_LEFT_STATE && nAliveLeft < BEH_PARTICLES_NUM)
-    {
-      m_LeftPart.push_back(p);
-      m_LeftPart.at(m_LeftPart.size()-1).pTraj = this;
-      nAliveLeft++;
-    }
-    else if(p.beh == PlannerHNS::BEH_BRANCH_RIGHT_STATE && nAliveRight < BEH_PARTICLES_NUM)
-    {
-      m_RightPart.push_back(p);
-      m_RightPart.at(m_RightPart.size()-1).pTraj = this;
-      nAliveRight++;
-    }
+    int* pAlive = GetAliveCount(b);
+    if(pAlive == nullptr || *pAlive >= BEH_PARTICLES_NUM) return false;
+    (*pAlive)++;
+    return true;
   }
 
-  void DeleteParticle(const Particle& p, const int& _i)
+  /**
+   * @brief Count one particle less of behavior b, false when the behavior is already at BEH_MIN_PARTICLE_NUM
+   */
+  bool RemoveAlive(const BEH_STATE_TYPE& b)
   {
-    if(p.beh == PlannerHNS::BEH_STOPPING_STATE && nAliveStop > BEH_MIN_PARTICLE_NUM)
-    {
-      m_StopPart.erase(m_StopPart.begin()+_i);
-      nAliveStop--;
-    }
-    else if(p.beh == PlannerHNS::BEH_YIELDING_STATE && nAliveYield > BEH_MIN_PARTICLE_NUM)
-    {
-      m_YieldPart.erase(m_YieldPart.begin()+_i);
-      nAliveYield--;
-    }
-    else if(p.beh == PlannerHNS::BEH_FORWARD_STATE && nAliveForward > BEH_MIN_PARTICLE_NUM)
-    {
-      m_ForwardPart.erase(m_ForwardPart.begin()+_i);
-      nAliveForward--;
-    }
-    else if(p.beh == PlannerHNS::BEH_BRANCH_LEFT_STATE && nAliveLeft > BEH_MIN_PARTICLE_NUM)
-    {
-      m_LeftPart.erase(m_LeftPart.begin()+_i);
-      nAliveLeft--;
-    }
-    else if(p.beh == PlannerHNS::BEH_BRANCH_RIGHT_STATE && nAliveRight > BEH_MIN_PARTICLE_NUM)
-    {
-      m_RightPart.erase(m_RightPart.begin()+_i);
-      nAliveRight--;
-    }
+    int* pAlive = GetAliveCount(b);
+    if(pAlive == nullptr || *pAlive <= BEH_MIN_PARTICLE_NUM) return false;
+    (*pAlive)--;
+    return true;
   }
 
-  void CalcAverages()
+  void ResetAlive()
   {
-    w_avg_forward = 0;
-    double avg_sum = 0;
-    for(unsigned int i = 0; i < m_ForwardPart.size(); i++)
-    {
-      avg_sum += m_ForwardPart.at(i).w;
-    }
-    if(m_ForwardPart.size() > 0)
-      w_avg_forward = avg_sum/(double)m_ForwardPart.size();
-
-    w_avg_left = 0;
-    avg_sum = 0;
-    for(unsigned int i = 0; i < m_LeftPart.size(); i++)
-    {
-      avg_sum += m_LeftPart.at(i).w;
-    }
-    if(m_LeftPart.size() > 0)
-      w_avg_left = avg_sum/(double)m_LeftPart.size();
-
-    w_avg_right = 0;
-    avg_sum = 0;
-    for(unsigned int i = 0; i < m_RightPart.size(); i++)
-    {
-      avg_sum += m_RightPart.at(i).w;
-    }
-    if(m_RightPart.size() > 0)
-      w_avg_right = avg_sum/(double)m_RightPart.size();
+    nAliveStop = 0;
+    nAliveYield = 0;
+    nAliveForward = 0;
+    nAliveLeft = 0;
+    nAliveRight = 0;
+  }
 
-    w_avg_stop = 0;
-    avg_sum = 0;
-    for(unsigned int i = 0; i < m_StopPart.size(); i++)
-    {
-      avg_sum += m_StopPart.at(i).w;
-    }
-    if(m_StopPart.size() > 0)
-      w_avg_stop = avg_sum/(double)m_StopPart.size();
+  int* GetAliveCount(const BEH_STATE_TYPE& b)
+  {
+    if(b == PlannerHNS::BEH_STOPPING_STATE)
+      return &nAliveStop;
+    else if(b == PlannerHNS::BEH_YIELDING_STATE)
+      return &nAliveYield;
+    else if(b == PlannerHNS::BEH_FORWARD_STATE)
+      return &nAliveForward;
+    else if(b == PlannerHNS::BEH_BRANCH_LEFT_STATE)
+      return &nAliveLeft;
+    else if(b == PlannerHNS::BEH_BRANCH_RIGHT_STATE)
+      return &nAliveRight;
+    else
+      return nullptr;
+  }
 
-    w_avg_yield = 0;
-    avg_sum = 0;
-    for(unsigned int i = 0; i < m_YieldPart.size(); i++)
-    {
-      avg_sum += m_YieldPart.at(i).w;
-    }
-    if(m_YieldPart.size() > 0)
-      w_avg_yield = avg_sum/(double)m_YieldPart.size();
+  double* GetAverageWeight(const BEH_STATE_TYPE& b)
+  {
+    if(b == PlannerHNS::BEH_STOPPING_STATE)
+      return &w_avg_stop;
+    else if(b == PlannerHNS::BEH_YIELDING_STATE)
+      return &w_avg_yield;
+    else if(b == PlannerHNS::BEH_FORWARD_STATE)
+      return &w_avg_forward;
+    else if(b == PlannerHNS::BEH_BRANCH_LEFT_STATE)
+      return &w_avg_left;
+    else if(b == PlannerHNS::BEH_BRANCH_RIGHT_STATE)
+      return &w_avg_right;
+    else
+      return nullptr;
   }
 
   void CalcProbabilities()
@@ -519,7 +607,7 @@ public:
   std::vector<TrajectoryTracker*> m_TrajectoryTracker;
   std::vector<TrajectoryTracker*> m_TrajectoryTracker_temp;
 
-  std::vector<Particle*> m_AllParticles;
+  ParticleBuffer m_Particles; // particles of all the trajectories
 
   TrajectoryTracker* best_beh_track;
   int i_best_track;
@@ -561,6 +649,15 @@ public:
   double p_left_branch;
   double p_right_branch;
 
+  bool bCanDecide; // the weights of the last step separate the trajectories
+
+  // trajectories of the last search in the map, reused while the object stays on the same lanes
+  std::vector<std::vector<WayPoint> > m_CachedTrajectories;
+  std::vector<int> m_CachedLaneIds; // sorted lane ids of the closest waypoints of that search
+  unsigned long m_CachedMapVersion;
+  double m_CachedPredictionDistance;
+  bool bTrajectoriesFromCache;
+
   virtual ~ObjParticles()
   {
     DeleteTheRest(m_TrajectoryTracker);
@@ -605,6 +702,93 @@ public:
     p_yield = 0;
     p_left_branch = 0;
     p_right_branch = 0;
+
+    bCanDecide = true;
+
+    m_CachedMapVersion = 0;
+    m_CachedPredictionDistance = 0;
+    bTrajectoriesFromCache = false;
+  }
+
+  /**
+   * @brief Add p to the particles of pTrack, ignored when its behavior is full
+   */
+  void InsertNewParticle(TrajectoryTracker* pTrack, const Particle& p)
+  {
+    if(pTrack->AddAlive(p.beh))
+      m_Particles.Add(p, pTrack);
+  }
+
+  /**
+   * @brief Remove particle i (the last particle moves to i), false when its behavior is already at the minimum count
+   */
+  bool DeleteParticle(const unsigned int& i)
+  {
+    if(!m_Particles.pTraj.at(i)->RemoveAlive(m_Particles.beh.at(i)))
+      return false;
+    m_Particles.Remove(i);
+    return true;
+  }
+
+  void DeleteTrackParticles(const TrajectoryTracker* pTrack)
+  {
+    for(unsigned int i = 0; i < m_Particles.size(); )
+    {
+      if(m_Particles.pTraj.at(i) == pTrack)
+        m_Particles.Remove(i);
+      else
+        i++;
+    }
+  }
+
+  /**
+   * @brief Recount the alive particles of every trajectory, particles over BEH_PARTICLES_NUM of their behavior are removed
+   */
+  void RecountAlive()
+  {
+    for(unsigned int t = 0; t < m_TrajectoryTracker.size(); t++)
+      m_TrajectoryTracker.at(t)->ResetAlive();
+
+    for(unsigned int i = 0; i < m_Particles.size(); )
+    {
+      if(m_Particles.pTraj.at(i)->AddAlive(m_Particles.beh.at(i)))
+        i++;
+      else
+        m_Particles.Remove(i);
+    }
+  }
+
+  /**
+   * @brief Average weight per trajectory and behavior, in one pass over the particles
+   */
+  void CalcAverages()
+  {
+    for(unsigned int t = 0; t < m_TrajectoryTracker.size(); t++)
+    {
+      TrajectoryTracker* pTrack = m_TrajectoryTracker.at(t);
+      pTrack->w_avg_forward = 0;
+      pTrack->w_avg_stop = 0;
+      pTrack->w_avg_yield = 0;
+      pTrack->w_avg_left = 0;
+      pTrack->w_avg_right = 0;
+    }
+
+    for(unsigned int i = 0; i < m_Particles.size(); i++)
+    {
+      double* pAvg = m_Particles.pTraj[i]->GetAverageWeight(m_Particles.beh[i]);
+      if(pAvg != nullptr)
+        *pAvg += m_Particles.w[i];
+    }
+
+    for(unsigned int t = 0; t < m_TrajectoryTracker.size(); t++)
+    {
+      TrajectoryTracker* pTrack = m_TrajectoryTracker.at(t);
+      if(pTrack->nAliveForward > 0) pTrack->w_avg_forward /= (double)pTrack->nAliveForward;
+      if(pTrack->nAliveStop > 0) pTrack->w_avg_stop /= (double)pTrack->nAliveStop;
+      if(pTrack->nAliveYield > 0) pTrack->w_avg_yield /= (double)pTrack->nAliveYield;
+      if(pTrack->nAliveLeft > 0) pTrack->w_avg_left /= (double)pTrack->nAliveLeft;
+      if(pTrack->nAliveRight > 0) pTrack->w_avg_right /= (double)pTrack->nAliveRight;
+    }
   }
 
 //  void CalculateProbabilities()
@@ -774,6 +958,8 @@ public:
 
     MatchWithMax(matching_list,delete_me_track, m_TrajectoryTracker_temp);
     m_TrajectoryTracker.clear();
+    for(unsigned int k = 0; k < delete_me_track.size(); k++)
+      DeleteTrackParticles(delete_me_track.at(k));
     DeleteTheRest(delete_me_track);
     m_TrajectoryTracker = m_TrajectoryTracker_temp;
   }
@@ -784,7 +970,7 @@ class BehaviorPrediction
 public:
   BehaviorPrediction();
   virtual ~BehaviorPrediction();
-  void DoOneStep(const std::vector<DetectedObject>& obj_list, const WayPoint& currPose, const double& minSpeed, const double& maxDeceleration, RoadNetwork& map);
+  void DoOneStep(const std::vector<DetectedObject>& obj_list, const WayPoint& currPose, const double& minSpeed, const double& maxDeceleration, const RoadNetwork& map);
 
 public:
   std::vector<PassiveDecisionMaker*> m_d_makers;
@@ -810,6 +996,22 @@ public:
   bool m_bFirstMove;
   bool m_bDebugOut;
 
+  PlannerH m_Planner; // keeps the search arena between predictions
+
+  int m_nThreads; // objects are predicted on this many threads, 1 runs them in order on the caller thread, 0 uses the hardware concurrency
+  unsigned int m_RandomSeed; // seed of the fresh particles, mixed with the object id, 0 seeds every step from the clock
+  bool m_bSystematicResampling; // resample the particles in proportion to their weights instead of removing the ones under KEEP_PERCENTAGE
+  bool m_bCacheTrajectories; // reuse the trajectories of a tracked object until it changes lanes or consumes them
+
+  unsigned long m_nTrajectoryCacheHits;
+  unsigned long m_nTrajectoryCacheMisses;
+
+  /**
+   * @brief Part of the trajectory extractions served from the cache since the counters were reset, 0 before any extraction
+   */
+  double GetTrajectoryCacheHitRate() const;
+  void ResetTrajectoryCacheCounters();
+
 
 protected:
   //int GetTrajectoryPredictedDirection(const std::vector<WayPoint>& path, const PlannerHNS::WayPoint& pose, const double& pred_distance);
@@ -819,31 +1021,41 @@ protected:
   double CalcAccelerationWeight(int p_acl, int obj_acl);
 
   void CalPredictionTimeForObject(ObjParticles* pCarPart);
-  void PredictCurrentTrajectory(RoadNetwork& map, ObjParticles* pCarPart);
-  void FilterObservations(const std::vector<DetectedObject>& obj_list, RoadNetwork& map, std::vector<DetectedObject>& filtered_list);
-  void ExtractTrajectoriesFromMap(const std::vector<DetectedObject>& obj_list, RoadNetwork& map, std::vector<ObjParticles*>& old_list);
+  /**
+   * @brief Update filtered_list with the moving objects of obj_list, matched by id, and drop the entries whose id is not in obj_list.
+   * Linear in the sizes of both lists, the order of the kept entries doesn't change.
+   */
+  void FilterObservations(const std::vector<DetectedObject>& obj_list, const RoadNetwork& map, std::vector<DetectedObject>& filtered_list);
+  void ExtractTrajectoriesFromMap(const std::vector<DetectedObject>& obj_list, const RoadNetwork& map, std::vector<ObjParticles*>& old_list);
   void CalculateCollisionTimes(const double& minSpeed);
 
   void ParticleFilterSteps(std::vector<ObjParticles*>& part_info);
 
-  void SamplesFreshParticles(ObjParticles* pParts);
-  void MoveParticles(ObjParticles* parts);
+  /**
+   * @brief Run task(i) for every object index, on the shared task scheduler when more than one thread is configured.
+   * Each task only touches its own object, so the results don't depend on the number of threads.
+   */
+  void ForEachObject(const int& nObjects, const std::function<void(const int&)>& task);
+  int GetNumberOfWorkers();
+
+  void PredictCurrentTrajectory(const RoadNetwork& map, ObjParticles* pCarPart, PlannerH& planner);
+  bool IsTrajectoryCacheValid(const ObjParticles* pCarPart, const std::vector<int>& laneIds, const RoadNetwork& map);
+  void SamplesFreshParticles(ObjParticles* pParts, const unsigned int& seed);
+  void MoveParticles(ObjParticles* parts, const double& dt);
+
+  /**
+   * @brief Raw weights of every particle against the observed object, then normalized by the range of each factor.
+   * Each pass is a branch free loop over the particle arrays.
+   */
   void CalculateWeights(ObjParticles* pParts);
-
-  void CalOnePartWeight(ObjParticles* pParts,Particle& p);
-  void NormalizeOnePartWeight(ObjParticles* pParts,Particle& p);
-
-  void CollectParticles(ObjParticles* pParts);
+  void NormalizeWeights(ObjParticles* pParts);
 
   void RemoveWeakParticles(ObjParticles* pParts);
+  void RemoveFarParticles(ObjParticles* pParts);
+  void ResampleParticles(ObjParticles* pParts, const unsigned int& seed);
   void FindBest(ObjParticles* pParts);
   void CalculateAveragesAndProbabilities(ObjParticles* pParts);
 
-  static bool sort_weights(const Particle* p1, const Particle* p2)
-  {
-    return p1->w > p2->w;
-  }
-
   static bool sort_trajectories(const std::pair<int, double>& p1, const std::pair<int, double>& p2)
   {
     return p1.second > p2.second;
@@ -873,6 +1085,19 @@ public:
 
     delete_me.clear();
   }
+
+private:
+  std::vector<PlannerH*> m_WorkerPlanners; // one search arena per extra thread, m_Planner serves the first one
+
+  std::unordered_map<int, int> m_ObservationSlots; // id -> index in the filtered list
+  std::unordered_map<int, unsigned int> m_ObservationGenerations; // id -> last FilterObservations call that observed it
+  unsigned int m_ObservationGeneration;
+  std::unordered_map<int, int> m_ParticleSlots; // id -> first unmatched tracked object with that id
+  std::vector<int> m_NextParticleSlot; // next tracked object with the same id, -1 for the last one
+  std::vector<char> m_bParticleMatched;
+
+  BehaviorPrediction(const BehaviorPrediction&);
+  BehaviorPrediction& operator=(const BehaviorPrediction&);
 };
 
 
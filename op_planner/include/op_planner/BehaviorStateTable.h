@@ -0,0 +1,66 @@
+/// \file BehaviorStateTable.h
+/// \brief Table driven version of the DecisionMaker behavior state machine, the states are STATE_TYPE values
+/// \date Oct 14, 2026
+
+#ifndef BEHAVIORSTATETABLE_H_
+#define BEHAVIORSTATETABLE_H_
+
+#include "RoadNetwork.h"
+
+namespace PlannerHNS
+{
+
+#define BEHAVIOR_STATES_NUMBER (BRANCH_RIGHT_STATE + 1)
+
+/**
+ * @brief Same decisions as the "II" BehaviorStateMachine states wired by DecisionMaker::InitBehaviorStates, without heap allocated states.
+ * The transition function and the allowed next states of every STATE_TYPE are constant tables indexed by the state,
+ * so a step is one indirect call and one mask test. A transition that is not allowed returns INITIAL_STATE,
+ * as DecisionMaker does when FindBehaviorState returns null.
+ * The state timer restarts on every decision that is not held by the decision making time of the state.
+ */
+class BehaviorStateTable
+{
+public:
+  BehaviorStateTable();
+
+  /**
+   * @brief One decision from current, the conditions in pre are updated the same way the state classes do
+   */
+  STATE_TYPE GetNextState(const STATE_TYPE& current, const PlanningParams& params, PreCalculatedConditions& pre);
+
+  /**
+   * @brief Minimum time (seconds) in state before its next decision, 0 for all states by default
+   */
+  void SetDecisionMakingTime(const STATE_TYPE& state, const double& time);
+  void ResetTimer();
+
+  static bool IsTransitionAllowed(const STATE_TYPE& from, const STATE_TYPE& to);
+
+  double m_ZeroVelocity;
+
+  typedef STATE_TYPE (*TransitionFunction)(const STATE_TYPE& current, const PlanningParams& params, PreCalculatedConditions& pre, const double& zeroVelocity);
+
+private:
+  static const TransitionFunction m_Transitions[BEHAVIOR_STATES_NUMBER];
+  static const unsigned int m_AllowedNextStates[BEHAVIOR_STATES_NUMBER];
+
+  double m_DecisionMakingTime[BEHAVIOR_STATES_NUMBER];
+  STATE_TYPE m_LastState;
+  timespec m_StateTimer;
+
+  static STATE_TYPE KeepState(const STATE_TYPE& current, const PlanningParams& params, PreCalculatedConditions& pre, const double& zeroVelocity);
+  static STATE_TYPE ForwardNext(const STATE_TYPE& current, const PlanningParams& params, PreCalculatedConditions& pre, const double& zeroVelocity);
+  static STATE_TYPE FollowNext(const STATE_TYPE& current, const PlanningParams& params, PreCalculatedConditions& pre, const double& zeroVelocity);
+  static STATE_TYPE SwerveNext(const STATE_TYPE& current, const PlanningParams& params, PreCalculatedConditions& pre, const double& zeroVelocity);
+  static STATE_TYPE InitNext(const STATE_TYPE& current, const PlanningParams& params, PreCalculatedConditions& pre, const double& zeroVelocity);
+  static STATE_TYPE GoalNext(const STATE_TYPE& current, const PlanningParams& params, PreCalculatedConditions& pre, const double& zeroVelocity);
+  static STATE_TYPE StopSignStopNext(const STATE_TYPE& current, const PlanningParams& params, PreCalculatedConditions& pre, const double& zeroVelocity);
+  static STATE_TYPE StopSignWaitNext(const STATE_TYPE& current, const PlanningParams& params, PreCalculatedConditions& pre, const double& zeroVelocity);
+  static STATE_TYPE TrafficLightStopNext(const STATE_TYPE& current, const PlanningParams& params, PreCalculatedConditions& pre, const double& zeroVelocity);
+  static STATE_TYPE TrafficLightWaitNext(const STATE_TYPE& current, const PlanningParams& params, PreCalculatedConditions& pre, const double& zeroVelocity);
+};
+
+} /* namespace PlannerHNS */
+
+#endif /* BEHAVIORSTATETABLE_H_ */
@@ -0,0 +1,179 @@
+/// \file CompactRoadNetwork.h
+/// \brief Compact storage of a large RoadNetwork, waypoints in flat arrays with their links as indices, expanded on demand
+/// \date Oct 14, 2026
+
+#ifndef COMPACTROADNETWORK_H_
+#define COMPACTROADNETWORK_H_
+
+#include "RoadNetwork.h"
+#include "WayPointArena.h"
+#include <unordered_map>
+
+namespace PlannerHNS
+{
+
+/**
+ * @brief The waypoints of a linked RoadNetwork stored field by field in flat arrays, the waypoint links (pFronts, pBacks, pLeft, pRight, pLane)
+ * as indices and the variable size fields (toIds, fromIds, pFronts, pBacks, actionCost) in CSR form.
+ * lat/lon/alt/dir, iOriginalIndex, gid, laneId, pLane, stopLineID and originalMapID have an array only when a waypoint has them
+ * different from x/y/z/a, 0, 0, the id and the address of its lane, -1 and -1, toIds only when they are not the ids of pFronts,
+ * rot and the planning costs and states are kept only for the waypoints where they are not at their defaults, so Expand gives back the same map.
+ * Road segments, lanes (without their points) and map objects keep their classes, their pointers are moved into this copy.
+ * Waypoints are numbered in map order (segment, lane, point).
+ */
+class CompactRoadNetwork
+{
+public:
+  CompactRoadNetwork();
+  virtual ~CompactRoadNetwork();
+
+  void Build(const RoadNetwork& map);
+
+  /**
+   * @brief Replace map with the linked RoadNetwork this was built from, the spatial and id indexes are rebuilt and the map gets a new version
+   */
+  void Expand(RoadNetwork& map) const;
+
+  void Clear();
+
+  unsigned int GetNumberOfPoints() const;
+  unsigned int GetNumberOfLanes() const;
+
+  /**
+   * @brief Lane in map order, with the lane fields, links and objects but no points
+   */
+  Lane* GetLane(const int& iLane);
+  int GetLaneIndexOfPoint(const int& iPoint) const;
+
+  /**
+   * @brief Waypoint iPoint with all its fields except the pointers (pLane, pLeft, pRight, pFronts and pBacks are empty)
+   */
+  void GetWayPoint(const int& iPoint, WayPoint& wp) const;
+
+  /**
+   * @brief Indices of the pFronts / pBacks of waypoint iPoint, nullptr when n is 0
+   */
+  const int* GetFronts(const int& iPoint, int& n) const;
+  const int* GetBacks(const int& iPoint, int& n) const;
+  int GetLeft(const int& iPoint) const;
+  int GetRight(const int& iPoint) const;
+  int GetPointLane(const int& iPoint) const;
+
+  /**
+   * @brief Index of the first waypoint with id pointId in map order, -1 if there is none
+   */
+  int FindPointIndex(const int& pointId) const;
+
+  /**
+   * @brief Bytes held by the arrays of this compact map, the lanes and map objects included
+   */
+  size_t GetMemoryBytes() const;
+
+  /**
+   * @brief Bytes held by the lanes, waypoints and map objects of map, counted from the vectors capacities.
+   * The allocator overhead of each vector, large for the small vectors inside every waypoint, is not counted.
+   */
+  static size_t GetMemoryBytes(const RoadNetwork& map);
+
+private:
+  // fields of a waypoint that are rarely set in a map
+  class PointExtras
+  {
+  public:
+    int iPoint;
+    Rotation rot;
+    double cost;
+    double timeCost;
+    double totalReward;
+    double collisionCost;
+    double laneChangeCost;
+    int bDir;
+    int state;
+    int beh_state;
+  };
+
+  // lists of the few waypoints that have one, CSR over their sorted indices
+  class SparseLists
+  {
+  public:
+    std::vector<int> points;
+    std::vector<int> start; // points.size() + 1
+
+    void Clear();
+    // the list of iPoint ends at the current size of the values
+    void Add(const int& iPoint, const int& nValues);
+    // range [iBegin, iEnd) of the values of iPoint, false if it has no list
+    bool Find(const int& iPoint, int& iBegin, int& iEnd) const;
+    size_t GetMemoryBytes() const;
+  };
+
+  RoadNetwork m_Objects; // road segments with the lanes without points, and the map objects
+  std::vector<int> m_LaneFirstPoint; // lanes in map order, nLanes + 1
+
+  std::vector<double> m_X, m_Y, m_Z, m_A, m_V;
+  std::vector<double> m_Lat, m_Lon, m_Alt, m_Dir; // empty when equal to x, y, z, a for every waypoint
+  std::vector<int> m_OriginalIndices, m_Gids; // empty when 0 for every waypoint
+  std::vector<int> m_LaneIds, m_PointLane; // empty when every waypoint has the id and is in pLane of its own lane
+  std::vector<int> m_StopLineIds, m_OriginalMapIds; // empty when -1 for every waypoint
+  std::vector<int> m_Ids, m_LeftPointIds, m_RightPointIds, m_LeftLnIds, m_RightLnIds;
+  std::vector<int> m_Left, m_Right; // indices of pLeft and pRight (and of the pLane lane in m_PointLane), -1 for null
+
+  std::vector<int> m_FrontStart, m_Fronts;
+  std::vector<int> m_FromIdStart, m_FromIds;
+  SparseLists m_BackLists; // of m_Backs, map waypoints rarely have pBacks
+  std::vector<int> m_Backs;
+  SparseLists m_ToIdLists; // of m_ToIds, only for the waypoints whose toIds are not the ids of their pFronts
+  std::vector<int> m_ToIds;
+  SparseLists m_ActionLists; // of m_ActionTypes and m_ActionCosts
+  std::vector<unsigned char> m_ActionTypes;
+  std::vector<double> m_ActionCosts;
+
+  std::vector<PointExtras> m_Extras; // sorted by iPoint
+  std::vector<std::pair<int, int> > m_IdIndex; // (id, point index) sorted
+
+  std::vector<Lane*> m_Lanes;
+
+  const PointExtras* FindExtras(const int& iPoint) const;
+  void IndexLanes();
+
+  CompactRoadNetwork(const CompactRoadNetwork&);
+  CompactRoadNetwork& operator=(const CompactRoadNetwork&);
+};
+
+/**
+ * @brief WayPoint nodes of one search over a CompactRoadNetwork. A node is created the first time its waypoint is asked for,
+ * with the fields of the map waypoint, its pLane points to the lane of the compact map and its other pointers are empty
+ * until LinkNeighbors creates the nodes of its fronts, backs, left and right waypoints.
+ * The planning fields of a node can be changed freely, the compact map is not modified. Reset releases all the nodes.
+ */
+class CompactSearchOverlay
+{
+public:
+  CompactSearchOverlay(CompactRoadNetwork& map, const unsigned int& blockSize = 1024);
+  virtual ~CompactSearchOverlay();
+
+  WayPoint* GetWayPoint(const int& iPoint);
+
+  /**
+   * @brief Fill pFronts, pBacks, pLeft and pRight of pNode with nodes of this overlay, created if needed
+   */
+  void LinkNeighbors(WayPoint* pNode);
+
+  /**
+   * @brief Waypoint index of a node of this overlay, -1 for other waypoints
+   */
+  int GetPointIndex(const WayPoint* pNode) const;
+
+  void Reset();
+  unsigned int GetNumberOfNodes() const;
+
+private:
+  CompactRoadNetwork& m_Map;
+  WayPointArena m_Arena;
+  std::unordered_map<int, WayPoint*> m_Nodes;
+  std::unordered_map<const WayPoint*, int> m_NodeIndex;
+};
+
+} /* namespace PlannerHNS */
+
+#endif /* COMPACTROADNETWORK_H_ */
@@ -0,0 +1,65 @@
+/// \file ContourCorridor.h
+/// \brief Broad phase for the contour cost evaluation, bounding boxes around the part of the paths the contour points can affect
+/// \date Oct 14, 2026
+
+#ifndef CONTOURCORRIDOR_H_
+#define CONTOURCORRIDOR_H_
+
+#include "RoadNetwork.h"
+
+#define CORRIDOR_BOX_POINTS 8 // path points covered by one bounding box
+
+namespace PlannerHNS
+{
+
+/**
+ * @brief Union of bounding boxes over the paths, from backDistance behind the car to frontDistance ahead of it, inflated by a lateral margin
+ * plus twice the longest segment of the window (the projection of a point on a path can fall one segment away from its closest point).
+ * When the window reaches one end of a path, the path is extended along its end heading for the rest of the window.
+ * A contour point outside every box can't be within the lateral margin of the window, so it doesn't change any roll out cost.
+ */
+class ContourCorridor
+{
+public:
+  ContourCorridor();
+
+  void Clear();
+
+  /**
+   * @brief Add the window of path around car_info (the relative info of the car on path)
+   */
+  void AddPath(const std::vector<WayPoint>& path, const RelativeInfo& car_info, const double& backDistance, const double& frontDistance, const double& lateralMargin);
+
+  bool IsInside(const GPSPoint& p) const;
+
+  /**
+   * @brief true when a box is closer than distance to p, a circle of radius distance around p outside the corridor can't hold a kept point
+   */
+  bool IsNear(const GPSPoint& p, const double& distance) const;
+
+  /**
+   * @brief Copy to filtered the contour points inside the corridor, the order is kept. The points of one object are consecutive with the same id,
+   * an object slower than minSpeed is kept or dropped as a whole (its far points stop its evaluation in the narrow phase),
+   * the points of a moving object are dropped one by one. Returns the number of dropped points.
+   */
+  unsigned int Filter(const std::vector<WayPoint>& contourPoints, const double& minSpeed, std::vector<WayPoint>& filtered) const;
+
+  unsigned int GetNumberOfBoxes() const;
+
+private:
+  class Box
+  {
+  public:
+    double min_x;
+    double min_y;
+    double max_x;
+    double max_y;
+  };
+
+  std::vector<Box> m_Boxes;
+  std::vector<GPSPoint> m_Window;
+};
+
+} /* namespace PlannerHNS */
+
+#endif /* CONTOURCORRIDOR_H_ */
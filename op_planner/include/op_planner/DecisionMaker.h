@@ -9,8 +9,15 @@
 #define BEHAVIOR_DECISION_MAKER
 
 #include "op_planner/BehaviorStateMachine.h"
+#include "op_planner/BehaviorStateTable.h"
 #include "op_planner/PlannerCommonDef.h"
 #include "op_planner/RoadNetwork.h"
+#include "op_planner/SharedRoadNetwork.h"
+#include "op_planner/TrajectoryCursor.h"
+#include "op_planner/LaneTracker.h"
+#include "op_planner/PathEventsTable.h"
+#include "op_planner/PathHorizon.h"
+#include "op_utility/StageTimer.h"
 
 namespace PlannerHNS
 {
@@ -23,11 +30,12 @@ public:
   ControllerParams m_ControlParams;
   std::vector<WayPoint> m_Path;
   PlannerHNS::RoadNetwork m_Map;
+  RoadNetworkSnapshotPtr m_pSharedMap; // searched instead of m_Map when set, refreshed by the owner with SharedRoadNetwork::Update
 
   double m_MaxLaneSearchDistance;
   int m_iCurrentTotalPathId;
   std::vector<std::vector<WayPoint> > m_RollOuts;
-  Lane* pLane;
+  const Lane* pLane;
 
   BehaviorStateMachine*     m_pCurrentBehaviorState;
   StopState*           m_pStopState;
@@ -44,6 +52,10 @@ public:
   StopSignStopStateII*       m_pStopSignStopState;
   StopSignWaitStateII*       m_pStopSignWaitState;
 
+  bool m_bUseStateTable; // decide with m_StateTable, m_pCurrentBehaviorState still points to the state object of the decided behavior
+  BehaviorStateTable m_StateTable;
+  BehaviorStateMachine* m_pStatesByType[BEHAVIOR_STATES_NUMBER];
+
   void InitBehaviorStates();
 
   //For Simulation
@@ -51,6 +63,8 @@ public:
   UtilityHNS::PIDController   m_pidStopping;
   UtilityHNS::PIDController   m_pidFollowing;
 
+  UtilityHNS::StageLatencyRecorder m_StageLatency; // one histogram per PLANNING_STAGE of DoOneStep
+
 public:
 
   DecisionMaker();
@@ -59,8 +73,17 @@ public:
   void CalculateImportantParameterForDecisionMaking(const VehicleState& car_state,
       const int& goalID, const bool& bEmergencyStop, const std::vector<TrafficLight>& detectedLights,
       const TrajectoryCost& bestTrajectory);
+  /**
+   * @brief Take globalPath as the new global path, always, even when it is the current one
+   */
   void SetNewGlobalPath(const std::vector<std::vector<WayPoint> >& globalPath);
 
+  /**
+   * @brief fingerprint is PlanningHelpers::GetPathFingerprint of globalPath, computed by the producer of the path.
+   * A path re-sent with the fingerprint of the current one is ignored, the derived paths and tables are kept.
+   */
+  void SetNewGlobalPath(const std::vector<std::vector<WayPoint> >& globalPath, const unsigned long long& fingerprint);
+
   BehaviorState DoOneStep(
       const double& dt,
       const PlannerHNS::WayPoint currPose,
@@ -71,20 +94,38 @@ public:
       const bool& bEmergencyStop);
 
 protected:
+  //set m_TotalOriginalPath and rebuild what is derived from it
+  void UpdateGlobalPath(const std::vector<std::vector<WayPoint> >& globalPath);
   bool GetNextTrafficLight(const int& prevTrafficLightId, const std::vector<TrafficLight>& trafficLights, TrafficLight& trafficL);
   void UpdateCurrentLane(const double& search_distance);
   bool SelectSafeTrajectory();
   BehaviorState GenerateBehaviorState(const VehicleState& vehicleState);
   double UpdateVelocityDirectlyToTrajectory(const BehaviorState& beh, const VehicleState& CurrStatus, const double& dt);
   bool ReachEndOfGlobalPath(const double& min_distance, const int& iGlobalPathIndex);
+  void ExtractTotalPath();
 
 
 
-  std::vector<PlannerHNS::WayPoint> t_centerTrajectorySmoothed;
+  std::vector<PathHorizon> m_TotalPathHorizons; // resampled part of each m_TotalOriginalPath, extended by ExtractTotalPath
   std::vector<std::vector<WayPoint> > m_TotalOriginalPath;
   std::vector<std::vector<WayPoint> > m_TotalPath;
   PlannerHNS::PlanningParams m_params;
 
+  //warm started closest point search of the car position on m_Path, m_TotalPath and m_TotalOriginalPath
+  TrajectoryCursor m_PathCursor;
+  TrajectoryCursor m_TotalPathCursor;
+  TrajectoryCursor m_TotalOriginalPathCursor;
+
+  //current lane when the global path has no lane information, m_LaneTracker.m_nFallbacks counts the map searches
+  LaneTracker m_LaneTracker;
+
+  //stop lines of each m_TotalOriginalPath, built by SetNewGlobalPath
+  std::vector<PathEventsTable> m_TotalPathEvents;
+
+  //fingerprint of m_TotalOriginalPath, valid once a path is set
+  unsigned long long m_GlobalPathFingerprint;
+  bool m_bGlobalPathFingerprint;
+
 };
 
 } /* namespace PlannerHNS */
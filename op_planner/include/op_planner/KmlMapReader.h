@@ -0,0 +1,141 @@
+/// \file KmlMapReader.h
+/// \brief Streaming reader of the KML map files, the map data is parsed while the file is read, no XML document is built
+/// \date Oct 14, 2026
+
+#ifndef KMLMAPREADER_H_
+#define KMLMAPREADER_H_
+
+#include "RoadNetwork.h"
+#include <cstdio>
+
+namespace PlannerHNS
+{
+
+#define KML_READ_BUFFER_SIZE 1048576 // bytes read from the file at once
+
+/**
+ * @brief Reads the same data as the TinyXML functions of MappingHelpers::LoadKML (GetLanesList, GetStopLinesList, ...)
+ * in one pass over the file, in chunks of KML_READ_BUFFER_SIZE. Only the text of the elements these functions read is kept,
+ * one record (lane folder or placemark) at a time, and the coordinates and ids are parsed in place.
+ * The text is condensed as TinyXML does by default. The name of a data folder has to come before its records,
+ * as in the files the map editor writes; records read before the name of their folder are skipped.
+ */
+class KmlMapReader
+{
+public:
+  std::vector<RoadSegment> roadSegments;
+  std::vector<Lane> lanes;
+  std::vector<TrafficLight> trafficLights;
+  std::vector<StopLine> stopLines;
+  std::vector<TrafficSign> signs;
+  std::vector<Crossing> crossings;
+  std::vector<Marking> markings;
+  std::vector<Boundary> boundaries;
+  std::vector<Curb> curbs;
+
+  KmlMapReader();
+  virtual ~KmlMapReader();
+
+  /**
+   * @brief Read kmlFile, bVersionZero reads the lane waypoints as GetCenterLaneDataVer0.
+   * @return false when the file can't be opened, the lists are empty then
+   */
+  bool ReadFile(const std::string& kmlFile, const bool& bVersionZero = false);
+
+  unsigned long GetNumberOfElements() const;
+
+  /**
+   * @brief Same result as MappingHelpers::GetIDsFromPrefix on the n characters of str
+   */
+  static void GetIDsFromPrefix(const char* str, const size_t& n, const char* prefix, const char* postfix, std::vector<int>& ids);
+  static void GetDoubleFromPrefix(const char* str, const size_t& n, const char* prefix, const char* postfix, std::vector<double>& nums);
+  static std::pair<ACTION_TYPE, double> GetActionPairFromPrefix(const char* str, const size_t& n, const char* prefix, const char* postfix);
+
+  /**
+   * @brief Same points as MappingHelpers::GetPointsData on the condensed coordinates text
+   */
+  static void GetPointsData(const std::string& coordinates, std::vector<GPSPoint>& points);
+
+private:
+  enum ELEMENT_ROLE {ROLE_OTHER, ROLE_ROOT, ROLE_TOP_FOLDER, ROLE_HEAD, ROLE_DOCUMENT, ROLE_FOLDER,
+    ROLE_FOLDER_NAME, ROLE_RECORD, ROLE_RECORD_NAME, ROLE_RECORD_LINE, ROLE_RECORD_COORDINATES,
+    ROLE_LANE_PLACEMARK, ROLE_LANE_LINE, ROLE_LANE_FOLDER, ROLE_LANE_INFO};
+
+  enum DATA_FOLDER {FOLDER_UNKNOWN = -1, FOLDER_LANES, FOLDER_ROAD_SEGMENTS, FOLDER_TRAFFIC_LIGHTS, FOLDER_STOP_LINES, FOLDER_TRAFFIC_SIGNS,
+    FOLDER_CROSSINGS, FOLDER_MARKINGS, FOLDER_BOUNDARIES, FOLDER_CURBS, FOLDERS_COUNT};
+
+  // the data folders of the three elements GetHeadElement can return, only one is kept at the end
+  enum DATA_SCOPE {SCOPE_HEAD, SCOPE_HEAD_DOCUMENT, SCOPE_TOP_DOCUMENT, SCOPES_COUNT};
+
+  class Frame
+  {
+  public:
+    ELEMENT_ROLE role;
+    int scope;
+    int folder;
+    unsigned int seenChildren; // bit of each child name already seen, only the first child of each name is read
+  };
+
+  class ScopeData
+  {
+  public:
+    bool bFolderRead[FOLDERS_COUNT];
+    std::vector<RoadSegment> roadSegments;
+    std::vector<Lane> lanes;
+    std::vector<TrafficLight> trafficLights;
+    std::vector<StopLine> stopLines;
+    std::vector<TrafficSign> signs;
+    std::vector<Crossing> crossings;
+    std::vector<Marking> markings;
+    std::vector<Boundary> boundaries;
+    std::vector<Curb> curbs;
+  };
+
+  FILE* m_pFile;
+  std::vector<char> m_Buffer;
+  size_t m_iBuffer;
+  size_t m_nBuffer;
+  bool m_bVersionZero;
+  unsigned long m_nElements;
+
+  std::vector<Frame> m_Stack;
+  bool m_bRootSeen;
+  bool m_bHeadFolderSeen;
+  bool m_bHeadDocumentSeen;
+  bool m_bTopDocumentSeen;
+  ScopeData m_Scopes[SCOPES_COUNT];
+
+  std::string m_TagName;
+  std::string m_Entity;
+  std::string* m_pText; // text of the element being read, nullptr when its text is not needed
+  bool m_bPendingSpace;
+  std::string m_FolderName;
+  std::string m_RecordName;
+  std::string m_Coordinates;
+  std::string m_LaneInfo;
+  bool m_bRecordName; // the record has the element of its ids
+  bool m_bCoordinates; // the record has its coordinates element
+  std::vector<GPSPoint> m_Points;
+  std::vector<int> m_Ids;
+  std::vector<double> m_Nums;
+
+  bool NextChar(char& c);
+  bool SkipPast(const char* end, std::string* pContent);
+  void Parse();
+  void ReadMarkup();
+  void ReadText(const char& c);
+  void AppendText(const char& c);
+
+  void StartElement(const std::string& name);
+  void EndElement();
+  int GetChildBit(const std::string& name) const;
+  static int GetFolderType(const std::string& name);
+
+  void AddRecord(const Frame& record);
+  void AddLane(ScopeData& data);
+  void Clear();
+};
+
+} /* namespace PlannerHNS */
+
+#endif /* KMLMAPREADER_H_ */
@@ -0,0 +1,85 @@
+/// \file LaneContractionHierarchy.h
+/// \brief Contraction hierarchy over the lane graph (Lane::toLanes), for fast lane level routing on large maps
+/// \date Oct 14, 2026
+
+#ifndef LANECONTRACTIONHIERARCHY_H_
+#define LANECONTRACTIONHIERARCHY_H_
+
+#include "RoadNetwork.h"
+#include <unordered_map>
+
+namespace PlannerHNS
+{
+
+/**
+ * @brief Lane graph with one node per lane and an edge from each lane to its toLanes, the weight is the length of the lane the edge leaves.
+ * With lane change enabled the left and right lanes are linked as well, with LANE_CHANGE_MIN_DISTANCE as weight.
+ * Build contracts the lanes in edge difference order and adds the shortcuts, GetLaneRoute runs a bidirectional upward search.
+ * Only lane ids are stored, so the hierarchy can be saved next to the map file and loaded for any copy of the same map.
+ */
+class LaneContractionHierarchy
+{
+public:
+  LaneContractionHierarchy();
+  virtual ~LaneContractionHierarchy();
+
+  void Clear();
+  bool IsBuilt() const;
+
+  /**
+   * @brief true if the hierarchy has the same lanes, in the same order, as map
+   */
+  bool IsBuiltFor(const RoadNetwork& map) const;
+  bool IsLaneChangeEnabled() const;
+
+  void Build(const RoadNetwork& map, const bool& bEnableLaneChange = false);
+
+  /**
+   * @brief Lane ids from the start lane to the goal lane (both included) of the shortest lane route, false if the goal lane can't be reached
+   */
+  bool GetLaneRoute(const int& startLaneId, const int& goalLaneId, std::vector<int>& laneIds, double& cost) const;
+
+  bool SaveToFile(const std::string& fileName) const;
+
+  /**
+   * @brief Load a hierarchy saved with SaveToFile, false (and cleared) if the file can't be read or was built for different lanes than map
+   */
+  bool LoadFromFile(const std::string& fileName, const RoadNetwork& map);
+
+  unsigned int GetNumberOfLanes() const;
+  unsigned int GetNumberOfShortcuts() const;
+
+private:
+  class Edge
+  {
+  public:
+    int from;
+    int to;
+    double weight;
+    int middle; // contracted lane index of a shortcut, -1 for lane graph edges
+  };
+
+  bool m_bLaneChange;
+  std::vector<int> m_LaneIds;
+  std::vector<int> m_Rank;
+  std::vector<Edge> m_Edges;
+  std::vector<std::vector<int> > m_UpEdges; // edges to higher rank lanes, forward search
+  std::vector<std::vector<int> > m_DownEdges; // edges coming from higher rank lanes, backward search
+  std::unordered_map<int, int> m_LaneIndex;
+  std::unordered_map<long long, int> m_EdgeIndex;
+  std::vector<std::unordered_map<int, int> > m_OutEdges; // build time adjacency, lane index -> edge index
+  std::vector<std::unordered_map<int, int> > m_InEdges;
+
+  static long long GetEdgeKey(const int& from, const int& to);
+  static void GetLaneIds(const RoadNetwork& map, std::vector<int>& laneIds);
+  void AddEdge(const int& from, const int& to, const double& weight, const int& middle);
+  void WitnessSearch(const int& source, const int& ignore, const double& maxCost, const std::vector<bool>& contracted,
+      std::unordered_map<int, double>& dist) const;
+  int ContractLane(const int& v, const std::vector<bool>& contracted, const bool& bAddShortcuts);
+  void BuildSearchGraph();
+  void UnpackEdge(const int& iEdge, std::vector<int>& lanes) const;
+};
+
+} /* namespace PlannerHNS */
+
+#endif /* LANECONTRACTIONHIERARCHY_H_ */
@@ -0,0 +1,64 @@
+/// \file LaneGraph.h
+/// \brief Lane level graph of a RoadNetwork, for coarse routing before the waypoint search
+/// \date Oct 14, 2026
+
+#ifndef LANEGRAPH_H_
+#define LANEGRAPH_H_
+
+#include "RoadNetwork.h"
+#include <unordered_map>
+
+namespace PlannerHNS
+{
+
+/**
+ * @brief One node per lane and an edge from each lane to its toLanes, the weight is the length of the lane the edge leaves.
+ * With lane change enabled the left and right lanes are linked as well, with LANE_CHANGE_MIN_DISTANCE as weight, the
+ * same graph LaneContractionHierarchy contracts. Build is linear in the number of lanes and edges, so the graph can be
+ * rebuilt for every new map version, GetLaneRoute is a Dijkstra search over the adjacency arrays.
+ */
+class LaneGraph
+{
+public:
+  LaneGraph();
+  virtual ~LaneGraph();
+
+  void Clear();
+  bool IsBuilt() const;
+
+  /**
+   * @brief true if built for this map object and its version, always false for maps with version 0
+   */
+  bool IsBuiltFor(const RoadNetwork& map) const;
+  bool IsLaneChangeEnabled() const;
+
+  void Build(const RoadNetwork& map, const bool& bEnableLaneChange = false);
+
+  /**
+   * @brief Lane ids from the start lane to the goal lane (both included) of the shortest lane route, false if the goal lane can't be reached
+   */
+  bool GetLaneRoute(const int& startLaneId, const int& goalLaneId, std::vector<int>& laneIds, double& cost) const;
+
+  /**
+   * @brief Length of the lane points, -1 for a lane that is not in the graph
+   */
+  double GetLaneLength(const int& laneId) const;
+
+  unsigned int GetNumberOfLanes() const;
+  unsigned int GetNumberOfEdges() const;
+
+private:
+  const RoadNetwork* m_pMap;
+  unsigned long m_MapVersion;
+  bool m_bLaneChange;
+  std::vector<int> m_LaneIds;
+  std::vector<double> m_LaneLengths;
+  std::vector<int> m_FirstEdge; // edges of lane i are [m_FirstEdge[i], m_FirstEdge[i+1])
+  std::vector<int> m_EdgeTo;
+  std::vector<double> m_EdgeWeight;
+  std::unordered_map<int, int> m_LaneIndex;
+};
+
+} /* namespace PlannerHNS */
+
+#endif /* LANEGRAPH_H_ */
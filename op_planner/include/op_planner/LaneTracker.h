@@ -0,0 +1,68 @@
+/// \file LaneTracker.h
+/// \brief Current lane of the car between planning cycles, searched on the previous lane and its neighbors before the map
+/// \date Oct 14, 2026
+
+#ifndef LANETRACKER_H_
+#define LANETRACKER_H_
+
+#include "RoadNetwork.h"
+#include "SharedRoadNetwork.h"
+#include "TrajectoryCursor.h"
+
+namespace PlannerHNS
+{
+
+/**
+ * @brief The car rarely changes lane between two cycles, so the lane found last time is checked first, then the
+ * lanes it leads to and its left and right lanes. A lane is kept when the car projects inside it, is less than half
+ * the lane width from its center line and drives in its direction (the angle rule of MappingHelpers::GetClosestLaneFromMap).
+ * Only when none of them matches the map is searched with MappingHelpers::GetClosestLaneFromMap, which uses the
+ * spatial index of the map when it is built.
+ * One tracker should follow one car on one map, it starts again from the map search when the map changes, which is
+ * another map object or a new RoadNetwork::version of the same one. A map reloaded in place without a new version
+ * (version 0) needs a Reset.
+ */
+class LaneTracker
+{
+public:
+  double m_DefaultLaneWidth; // for the lanes without width
+  unsigned long m_nHits; // lanes found from the previous lane
+  unsigned long m_nFallbacks; // searches of the whole map
+
+  LaneTracker();
+  virtual ~LaneTracker();
+
+  /**
+   * @brief Forget the previous lane, call it when the map is reloaded in place
+   */
+  void Reset();
+
+  /**
+   * @brief Lane of pos, same as MappingHelpers::GetClosestLaneFromMap(pos, map, search_distance) when the car is
+   * not on the previous lane or one of its neighbors, 0 if there is no lane closer than search_distance
+   */
+  const Lane* GetCurrentLane(const WayPoint& pos, const RoadNetwork& map, const double& search_distance);
+
+  /**
+   * @brief Same, on a shared map snapshot. The snapshot is kept until the next call so the previous lane stays valid.
+   */
+  const Lane* GetCurrentLane(const WayPoint& pos, const RoadNetworkSnapshotPtr& pMap, const double& search_distance);
+
+  const Lane* GetLastLane() const { return m_pLane; }
+
+private:
+  const RoadNetwork* m_pMap;
+  unsigned long m_MapVersion; // version of m_pMap when m_pLane was found
+  RoadNetworkSnapshotPtr m_pSnapshot;
+  const Lane* m_pLane;
+  TrajectoryCursor m_LaneCursor; // on the points of m_pLane
+
+  /**
+   * @return true if pos is on pL, perp_distance is then its distance to the center line
+   */
+  bool IsOnLane(const Lane* pL, const WayPoint& pos, const double& search_distance, double& perp_distance);
+};
+
+} /* namespace PlannerHNS */
+
+#endif /* LANETRACKER_H_ */
@@ -12,6 +12,9 @@
 #include "PlannerCommonDef.h"
 #include "RoadNetwork.h"
 #include "TrajectoryCosts.h"
+#include "TrajectoryCursor.h"
+#include "LaneTracker.h"
+#include "op_utility/StageTimer.h"
 
 #define AVOIDANCE_SPEED_FACTOR 0.75
 namespace PlannerHNS
@@ -28,6 +31,7 @@ public:
   std::vector<WayPoint> m_OriginalLocalPath;
   std::vector<std::vector<WayPoint> > m_TotalPath;
   std::vector<std::vector<WayPoint> > m_TotalOriginalPath;
+  std::vector<PathGeometry> m_TotalOriginalPathGeometry;
   std::vector<DetectedObject> m_PredictedTrajectoryObstacles;
   int m_iCurrentTotalPathId;
   int m_iSafeTrajectory;
@@ -36,15 +40,24 @@ public:
 //  std::vector<std::vector<WayPoint> > m_PredictedPath;
   std::vector<std::vector<std::vector<WayPoint> > > m_RollOuts;
   std::string carId;
-  Lane* pLane;
+  const Lane* pLane;
   double m_SimulationSteeringDelayFactor; //second , time that every degree change in the steering wheel takes
   timespec m_SteerDelayTimer;
   double m_PredictionTime;
   double m_CostCalculationTime;
   double m_BehaviorGenTime;
   double m_RollOutsGenerationTime;
+  UtilityHNS::StageLatencyRecorder m_StageLatency; // one histogram per PLANNING_STAGE of DoOneStep
   int m_PrevBrakingWayPoint;
 
+  //warm started closest point search of the car position on m_Path, m_TotalPath and m_TotalOriginalPath
+  TrajectoryCursor m_PathCursor;
+  TrajectoryCursor m_TotalPathCursor;
+  TrajectoryCursor m_TotalOriginalPathCursor;
+
+  //current lane when the global path has no lane information, m_LaneTracker.m_nFallbacks counts the map searches
+  LaneTracker m_LaneTracker;
+
   BehaviorStateMachine*     m_pCurrentBehaviorState;
   ForwardState *         m_pGoToGoalState;
   StopState*           m_pStopState;
@@ -130,6 +143,13 @@ public:
 
   void SimulateOdoPosition(const double& dt, const VehicleState& vehicleState);
 
+  /**
+   * @brief Set m_TotalOriginalPath and bNewGlobalPath. fingerprint is PlanningHelpers::GetPathFingerprint of
+   * globalPath, computed by the producer of the path. A path re-sent with the fingerprint of the current one is
+   * ignored, so the smoothed path and its speed profile are not computed again.
+   */
+  void SetNewGlobalPath(const std::vector<std::vector<WayPoint> >& globalPath, const unsigned long long& fingerprint);
+
 private:
 
   //Obstacle avoidance functionalities
@@ -161,6 +181,10 @@ private:
   bool NoWayTest(const double& min_distance, const int& iGlobalPathIndex);
 
   PlannerHNS::PlanningParams m_params;
+
+  //fingerprint of the path received by SetNewGlobalPath, m_TotalOriginalPath is smoothed afterwards
+  unsigned long long m_GlobalPathFingerprint;
+  bool m_bGlobalPathFingerprint;
 };
 
 } /* namespace PlannerHNS */
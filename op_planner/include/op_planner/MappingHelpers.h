@@ -19,6 +19,53 @@
 namespace PlannerHNS {
 
 
+/**
+ * A lane near a position and its closest point, LANE is const Lane for the lanes of a const map
+ */
+template <class LANE>
+class NearLaneInfoT
+{
+public:
+  LANE* pLane;
+  double min_distance;
+  int min_index;
+
+  NearLaneInfoT()
+  {
+    pLane = nullptr;
+    min_distance = 0;
+    min_index = 0;
+  }
+};
+
+typedef NearLaneInfoT<Lane> NearLaneInfo;
+typedef NearLaneInfoT<const Lane> ConstNearLaneInfo;
+
+/**
+ * Last occupancy grid applied to a map by the incremental UpdateMapWithOccupancyGrid, the next grid is compared against it
+ */
+class OccupancyGridHistory
+{
+public:
+  OccupancyToGridMap grid_info;
+  std::vector<int> data;
+  const RoadNetwork* pMap;
+  unsigned long mapVersion;
+
+  OccupancyGridHistory()
+  {
+    pMap = nullptr;
+    mapVersion = 0;
+  }
+
+  void Clear()
+  {
+    data.clear();
+    pMap = nullptr;
+    mapVersion = 0;
+  }
+};
+
 class MappingHelpers {
 public:
   MappingHelpers();
@@ -66,10 +113,54 @@ public:
         const bool& bFindLaneChangeLanes = false,
         const bool& bFindCurbsAndWayArea = false);
 
-  static void ConstructRoadNetworkFromDataFiles(const std::string vectoMapPath, RoadNetwork& map, const bool& bZeroOrigin = false);
+  /**
+   * @brief Build the map straight from the vector map message arrays, with the same result as ConstructRoadNetworkFromROSMessageV2.
+   * Each array is converted once into the records of its reader, sized up front and indexed by id in place, and the builder reads
+   * those records directly, so no second copy of the vector map is made next to the readers. Empty arrays are allowed.
+   */
+  static void ConstructRoadNetworkFromROSMessages(const vector_map_msgs::LaneArray& lanes,
+      const vector_map_msgs::PointArray& points,
+      const vector_map_msgs::DTLaneArray& dt_lanes,
+      const vector_map_msgs::CrossRoadArray& intersections,
+      const vector_map_msgs::AreaArray& areas,
+      const vector_map_msgs::LineArray& lines,
+      const vector_map_msgs::StopLineArray& stop_lines,
+      const vector_map_msgs::SignalArray& signals,
+      const vector_map_msgs::VectorArray& vectors,
+      const vector_map_msgs::CurbArray& curbs,
+      const vector_map_msgs::RoadEdgeArray& road_edges,
+      const vector_map_msgs::WayAreaArray& way_areas,
+      const vector_map_msgs::CrossWalkArray& cross_walks,
+      const vector_map_msgs::NodeArray& nodes,
+      const GPSPoint& origin, RoadNetwork& map,
+      const bool& bFindLaneChangeLanes = false,
+      const bool& bFindCurbsAndWayArea = false);
+
+  /**
+   * @brief Build the map from the vector map csv files in vectoMapPath.
+   * With bUseSnapshot the map is loaded from the binary snapshot next to the csv files when it is up to date,
+   * otherwise it is built from the csv files and the snapshot is written for the next load. Off by default, the map
+   * folder can be read only or shared.
+   */
+  static void ConstructRoadNetworkFromDataFiles(const std::string vectoMapPath, RoadNetwork& map, const bool& bZeroOrigin = false,
+      const bool& bUseSnapshot = false);
 
   static void UpdateMapWithOccupancyGrid(OccupancyToGridMap& map_info, const std::vector<int>& data, RoadNetwork& map, std::vector<WayPoint*>& updated_list);
 
+  /**
+   * @brief Incremental version, only the waypoints around the cells that changed since the grid kept in history are checked,
+   * using map.spatialIndex, and updated_list has only the waypoints blocked by this grid that were not blocked by the previous one.
+   * Falls back to the full update (and updated_list with every blocked waypoint) on the first grid, when the grid geometry changes,
+   * when the map or its version is not the one the history was taken from, or when the spatial index is not built.
+   */
+  static void UpdateMapWithOccupancyGrid(OccupancyToGridMap& map_info, const std::vector<int>& data, RoadNetwork& map,
+      std::vector<WayPoint*>& updated_list, OccupancyGridHistory& history);
+
+  /**
+   * @brief Give the map a version number no other map had, results cached for the old version are not used anymore
+   */
+  static void UpdateMapVersion(RoadNetwork& map);
+
   static bool GetWayPoint(const int& id, const int& laneID,const double& refVel, const int& did,
       const std::vector<UtilityHNS::AisanCenterLinesFileReader::AisanCenterLine>& dtpoints,
       const std::vector<UtilityHNS::AisanPointsFileReader::AisanPoints>& points,
@@ -77,24 +168,56 @@ public:
 
   static void LoadKML(const std::string& kmlMap, RoadNetwork& map);
 
+  /**
+   * @brief Same map as LoadKML, the file is parsed while it is read (KmlMapReader) instead of loading a TinyXML document first
+   */
+  static void LoadKMLStreaming(const std::string& kmlMap, RoadNetwork& map);
+
+  /**
+   * @brief The lanes of the KML map in every road segment, then the pointers, lane change and stop line links of LoadKML
+   */
+  static void LinkKMLMap(RoadNetwork& map, std::vector<Lane>& laneLinksList);
+
   static TiXmlElement* GetHeadElement(TiXmlElement* pMainElem);
   static TiXmlElement* GetDataFolder(const std::string& folderName, TiXmlElement* pMainElem);
 
 
+  /**
+   * @brief List the lanes that have at least one waypoint closer than distance to pos, in map order, with the closest point of each lane.
+   * Uses map.spatialIndex when it is built, otherwise scans every waypoint.
+   */
+  static void GetNearLanesFromMap(const WayPoint& pos, RoadNetwork& map, const double& distance, std::vector<NearLaneInfo>& lanes_list);
+  static void GetNearLanesFromMap(const WayPoint& pos, const RoadNetwork& map, const double& distance, std::vector<ConstNearLaneInfo>& lanes_list);
+
   static Lane* GetClosestLaneFromMap(const WayPoint& pos, RoadNetwork& map, const double& distance = 5.0, const bool bDirectionBased = true);
+  /**
+   * @brief Same search on a map that must not change, a shared map snapshot for example
+   */
+  static const Lane* GetClosestLaneFromMap(const WayPoint& pos, const RoadNetwork& map, const double& distance = 5.0, const bool bDirectionBased = true);
   static std::vector<Lane*> GetClosestLanesListFromMap(const WayPoint& pos, RoadNetwork& map, const double& distance = 2.0, const bool bDirectionBased = true);
+  static std::vector<const Lane*> GetClosestLanesListFromMap(const WayPoint& pos, const RoadNetwork& map, const double& distance = 2.0, const bool bDirectionBased = true);
   static Lane* GetClosestLaneFromMapDirectionBased(const WayPoint& pos, RoadNetwork& map, const double& distance = 5.0);
   static std::vector<Lane*> GetClosestMultipleLanesFromMap(const WayPoint& pos, RoadNetwork& map, const double& distance = 5.0);
   static WayPoint* GetClosestWaypointFromMap(const WayPoint& pos, RoadNetwork& map, const bool bDirectionBased = true);
+  static const WayPoint* GetClosestWaypointFromMap(const WayPoint& pos, const RoadNetwork& map, const bool bDirectionBased = true);
   static std::vector<Lane*> GetClosestLanesFast(const WayPoint& pos, RoadNetwork& map, const double& distance = 10.0);
 
   static std::vector<WayPoint*> GetClosestWaypointsListFromMap(const WayPoint& center, RoadNetwork& map, const double& distance = 2.0, const bool bDirectionBased = true);
+  static std::vector<const WayPoint*> GetClosestWaypointsListFromMap(const WayPoint& center, const RoadNetwork& map, const double& distance = 2.0, const bool bDirectionBased = true);
 
   static WayPoint* GetClosestBackWaypointFromMap(const WayPoint& pos, RoadNetwork& map);
   static WayPoint GetFirstWaypoint(RoadNetwork& map);
   static WayPoint* GetLastWaypoint(RoadNetwork& map);
   static void FindAdjacentLanes(RoadNetwork& map);
-  static void FindAdjacentLanesV2(RoadNetwork& map);
+
+  /**
+   * @brief Link the left and right waypoints and lanes of parallel lanes in the same road segment.
+   * The point to lane search runs on at most nThreads threads of the shared task scheduler (0 for all of them), the links are the same as a sequential run.
+   * Each waypoint is checked only against the lanes with a point nearby and a close heading, from a grid of the segment waypoints.
+   * bExhaustive checks it against every lane of the segment instead.
+   */
+  static void FindAdjacentLanesV2(RoadNetwork& map, const int& nThreads = 0, const bool& bExhaustive = false);
+
   static void ExtractSignalData(const std::vector<UtilityHNS::AisanSignalFileReader::AisanSignal>& signal_data,
       const std::vector<UtilityHNS::AisanVectorFileReader::AisanVector>& vector_data,
       const std::vector<UtilityHNS::AisanPointsFileReader::AisanPoints>& points_data,
@@ -123,7 +246,7 @@ public:
   static void ExtractCurbDataV2(const std::vector<UtilityHNS::AisanCurbFileReader::AisanCurb>& curb_data,
           UtilityHNS::AisanLinesFileReader* pLinedata,
           UtilityHNS::AisanPointsFileReader* pPointsData,
-          const GPSPoint& origin, RoadNetwork& map);
+          const GPSPoint& origin, RoadNetwork& map, const int& nThreads = 0);
 
   static void ExtractWayArea(const std::vector<UtilityHNS::AisanAreasFileReader::AisanArea>& area_data,
       const std::vector<UtilityHNS::AisanWayareaFileReader::AisanWayarea>& wayarea_data,
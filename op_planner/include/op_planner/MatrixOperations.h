@@ -9,7 +9,9 @@
 #define MATRIXOPERATIONS_H_
 
 #include "RoadNetwork.h"
+#include "op_utility/FastAngle.h"
 #include <math.h>
+#include <vector>
 
 
 namespace PlannerHNS {
@@ -46,8 +48,8 @@ public:
 
   Mat3(double rotation_angle)
   {
-    double c = cos(rotation_angle);
-    double s = sin(rotation_angle);
+    double c = 0, s = 0;
+    UtilityHNS::PlannerAngle::SinCos(rotation_angle, s, c);
     m[0][0] = c; m[0][1] = -s; m[0][2] =  0;
     m[1][0] = s; m[1][1] =  c; m[1][2] =  0;
     m[2][0] = 0; m[2][1] =  0; m[2][2] =  1;
@@ -55,8 +57,8 @@ public:
 
   Mat3(GPSPoint rotationCenter)
   {
-    double c = cos(rotationCenter.a);
-    double s = sin(rotationCenter.a);
+    double c = 0, s = 0;
+    UtilityHNS::PlannerAngle::SinCos(rotationCenter.a, s, c);
     double u = rotationCenter.x;
     double v = rotationCenter.y;
     m[0][0] = c; m[0][1] = -s; m[0][2] = -u*c + v*s + u;
@@ -74,6 +76,100 @@ public:
   }
 };
 
+/**
+ * @brief Rotation by an angle followed by a translation, p' = R*p + t. Gives the same points as translationMat*(rotationMat*p)
+ * with two Mat3 without the products of the identity and zero entries, and the batch functions transform contiguous points in one loop.
+ */
+class RigidTransform2D
+{
+public:
+  double c, s; // cos and sin of the rotation angle
+  double tx, ty;
+
+  RigidTransform2D() : c(1), s(0), tx(0), ty(0)
+  {
+  }
+
+  RigidTransform2D(const double& rotation_angle, const double& transX, const double& transY)
+  {
+    UtilityHNS::PlannerAngle::SinCos(rotation_angle, s, c);
+    tx = transX;
+    ty = transY;
+  }
+
+  /**
+   * @brief From the frame of pose to the frame pose is given in, rotation by pose.a then translation by (pose.x, pose.y)
+   */
+  RigidTransform2D(const GPSPoint& pose)
+  {
+    UtilityHNS::PlannerAngle::SinCos(pose.a, s, c);
+    tx = pose.x;
+    ty = pose.y;
+  }
+
+  RigidTransform2D Inverse() const
+  {
+    RigidTransform2D inv;
+    inv.c = c;
+    inv.s = -s;
+    inv.tx = -(c*tx + s*ty);
+    inv.ty = s*tx - c*ty;
+    return inv;
+  }
+
+  GPSPoint operator * (GPSPoint v) const
+  {
+    Transform(v);
+    return v;
+  }
+
+  void Transform(GPSPoint& v) const
+  {
+    double x = v.x;
+    v.x = c*x - s*v.y + tx;
+    v.y = s*x + c*v.y + ty;
+  }
+
+  void Transform(const GPSPoint* points, GPSPoint* out_points, const unsigned int& n) const
+  {
+    for(unsigned int i = 0; i < n; i++)
+    {
+      double x = points[i].x, y = points[i].y;
+      out_points[i] = points[i];
+      out_points[i].x = c*x - s*y + tx;
+      out_points[i].y = s*x + c*y + ty;
+    }
+  }
+
+  void Transform(std::vector<GPSPoint>& points) const
+  {
+    if(points.size() > 0)
+      Transform(points.data(), points.data(), points.size());
+  }
+
+  /**
+   * @brief Transform the pos of each waypoint, the heading pos.a is not changed (same as Mat3)
+   */
+  void Transform(std::vector<WayPoint>& points) const
+  {
+    for(unsigned int i = 0; i < points.size(); i++)
+      Transform(points.at(i).pos);
+  }
+
+  /**
+   * @brief Columns version (PathSoA x and y), no aliasing between the input and output columns except in place
+   */
+  void Transform(const double* x, const double* y, double* out_x, double* out_y, const unsigned int& n) const
+  {
+    for(unsigned int i = 0; i < n; i++)
+    {
+      double px = x[i], py = y[i];
+      out_x[i] = c*px - s*py + tx;
+      out_y[i] = s*px + c*py + ty;
+    }
+  }
+};
+
 } /* namespace PlannerHNS */
 
 #endif /* MATRIXOPERATIONS_H_ */
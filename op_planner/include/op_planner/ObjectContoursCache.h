@@ -0,0 +1,58 @@
+/// \file ObjectContoursCache.h
+/// \brief Contours of the detected objects kept between planning cycles, recomputed only when an object moves or changes shape
+/// \date Oct 14, 2026
+
+#ifndef OBJECTCONTOURSCACHE_H_
+#define OBJECTCONTOURSCACHE_H_
+
+#include "RoadNetwork.h"
+#include <unordered_map>
+
+namespace PlannerHNS
+{
+
+/**
+ * @brief Oriented rectangle contour of each object id, with the center and the size it was computed for.
+ * The cached contour is used while they are exactly the same, so it is the contour a new computation would give.
+ */
+class ObjectContoursCache
+{
+public:
+  ObjectContoursCache();
+
+  void Clear();
+
+  /**
+   * @brief Contour of obj, computed on the first access and when the center or the size of obj changed since
+   */
+  const std::vector<GPSPoint>& GetContour(const DetectedObject& obj);
+
+  /**
+   * @brief Remove the objects not accessed since the last call, call once per cycle
+   */
+  void RemoveUnused();
+
+  unsigned int GetNumberOfObjects() const;
+  unsigned long GetNumberOfHits() const;
+  unsigned long GetNumberOfComputations() const;
+
+private:
+  class Entry
+  {
+  public:
+    GPSPoint center;
+    double w;
+    double l;
+    double h;
+    std::vector<GPSPoint> contour;
+    bool bUsed;
+  };
+
+  std::unordered_map<int, Entry> m_Entries;
+  unsigned long m_nHits;
+  unsigned long m_nComputations;
+};
+
+} /* namespace PlannerHNS */
+
+#endif /* OBJECTCONTOURSCACHE_H_ */
@@ -0,0 +1,65 @@
+/// \file ObjectOccupancyGrid.h
+/// \brief Uniform grid of the predicted trajectory points of one object, for the roll out collision checks
+/// \date Oct 14, 2026
+
+#ifndef OBJECTOCCUPANCYGRID_H_
+#define OBJECTOCCUPANCYGRID_H_
+
+#include "RoadNetwork.h"
+
+namespace PlannerHNS
+{
+
+/**
+ * @brief The points of all the predTrajectories of an object, with their heading and time, bucketed in square cells
+ * over their bounding box. Build once per object and prediction update, then each roll out point out of the box is
+ * rejected at once and the others only check the cells around them instead of every predicted point.
+ * The points of a cell keep the order of predTrajectories (trajectory, then point). Buffers are kept between builds.
+ */
+class ObjectOccupancyGrid
+{
+public:
+  ObjectOccupancyGrid();
+  virtual ~ObjectOccupancyGrid();
+
+  void Clear();
+
+  /**
+   * @brief cellSize is the collision distance the grid is queried with, at least 0.1 m
+   */
+  void Build(const DetectedObject& obj, const double& cellSize);
+
+  unsigned int GetNumberOfPoints() const;
+
+  /**
+   * @brief Lowest index path point with a predicted point within distance, the same collision as a scan of every
+   * predicted point for every path point in predTrajectories order.
+   * @param iPredicted first predicted point (in predTrajectories order) within distance of that path point
+   * @return path index, -1 when no point collides
+   */
+  int FindFirstCollision(const std::vector<WayPoint>& path, const double& distance, int& iPredicted, double& collisionDistance) const;
+
+  /**
+   * @brief Heading and time of a predicted point returned by FindFirstCollision
+   */
+  double GetHeading(const int& iPredicted) const;
+  double GetTime(const int& iPredicted) const;
+
+private:
+  double m_CellSize;
+  double m_MinX; // lower corner of the cells
+  double m_MinY;
+  int m_nCellsX;
+  int m_nCellsY;
+  std::vector<int> m_CellStart; // points of cell (ix, iy) are [m_CellStart[iy*m_nCellsX+ix], m_CellStart[iy*m_nCellsX+ix+1])
+  std::vector<double> m_X; // sorted by cell, then by predTrajectories order
+  std::vector<double> m_Y;
+  std::vector<double> m_A;
+  std::vector<double> m_T;
+  std::vector<int> m_Order;
+  std::vector<std::pair<int, int> > m_SortBuffer; // cell, predTrajectories order
+};
+
+} /* namespace PlannerHNS */
+
+#endif /* OBJECTOCCUPANCYGRID_H_ */
@@ -11,6 +11,8 @@
 #include "BehaviorStateMachine.h"
 #include "PlannerCommonDef.h"
 #include "RoadNetwork.h"
+#include "TrajectoryCursor.h"
+#include "PathEventsTable.h"
 
 namespace PlannerHNS
 {
@@ -25,10 +27,27 @@ public:
   PlannerHNS::BehaviorState MoveStep(const double& dt, PlannerHNS::WayPoint& currPose, const std::vector<WayPoint>& path, const CAR_BASIC_INFO& carInfo);
   PlannerHNS::ParticleInfo MoveStepSimple(const double& dt, PlannerHNS::WayPoint& currPose, const std::vector<WayPoint>& path, const CAR_BASIC_INFO& carInfo);
 
+  /**
+   * @brief MoveStep of each pose of poses on the same path. The stop lines of the path are collected once per call and the closest
+   * point search of each pose is warm started from the previous pose, so poses close to each other (the particles of one trajectory) are cheap.
+   */
+  void MoveSteps(const double& dt, std::vector<WayPoint>& poses, const std::vector<WayPoint>& path, const CAR_BASIC_INFO& carInfo,
+      std::vector<BehaviorState>& behs);
+
+  /**
+   * @brief MoveStepSimple of each pose of poses on the same path, as MoveSteps. The indicator is computed again only when the speed changes.
+   */
+  void MoveStepsSimple(const double& dt, std::vector<WayPoint>& poses, const std::vector<WayPoint>& path, const CAR_BASIC_INFO& carInfo,
+      std::vector<ParticleInfo>& behs);
+
 private:
+  TrajectoryCursor m_PathCursor;
+  PathEventsTable m_StopLines;
+
   double GetVelocity(PlannerHNS::WayPoint& currPose, const std::vector<WayPoint>& path, const CAR_BASIC_INFO& carInfo, const RelativeInfo& info);
   double GetSteerAngle(PlannerHNS::WayPoint& currPose, const std::vector<WayPoint>& path, const RelativeInfo& info);
   bool CheckForStopLine(PlannerHNS::WayPoint& currPose, const std::vector<WayPoint>& path, const CAR_BASIC_INFO& carInfo);
+  bool CheckForStopLineInTable(PlannerHNS::WayPoint& currPose, const std::vector<WayPoint>& path, const CAR_BASIC_INFO& carInfo);
 
 };
 
@@ -0,0 +1,64 @@
+/// \file PathEventsTable.h
+/// \brief Stop lines of a global path with their arc length positions, built once per path and read with a cursor every cycle
+/// \date Oct 14, 2026
+
+#ifndef PATHEVENTSTABLE_H_
+#define PATHEVENTSTABLE_H_
+
+#include "RoadNetwork.h"
+#include "TrajectoryCursor.h"
+
+namespace PlannerHNS
+{
+
+class PathEvent
+{
+public:
+  int waypointIndex; // path waypoint with the stop line id
+  double distance; // arc length from the first path point to the stop line projected on the path
+  int stopLineID;
+  int stopSignID;
+  int trafficLightID;
+};
+
+/**
+ * @brief Build collects the path waypoints with a stopLineID that matches a stop line of their lane, in path order, as
+ * PlanningHelpers::GetDistanceToClosestStopLineAndCheck finds them. GetDistanceToNextStopLine then only locates the
+ * car with a warm started TrajectoryCursor and moves the event cursor past the events behind iBack or closer than
+ * giveUpDistance, so it expects the car to move forward along the path; it starts over from the first event when the
+ * car moves back.
+ */
+class PathEventsTable
+{
+public:
+  std::vector<PathEvent> m_Events;
+
+  PathEventsTable();
+  virtual ~PathEventsTable();
+
+  void Clear();
+  void Build(const std::vector<WayPoint>& path);
+
+  /**
+   * @brief true if Build was called for this vector and it kept its data pointer and size
+   */
+  bool IsBuiltFor(const std::vector<WayPoint>& path) const;
+
+  /**
+   * @brief Same result as PlanningHelpers::GetDistanceToClosestStopLineAndCheck on the path of Build,
+   * -1 when there is no next stop line or it is further than maxDistance (when maxDistance > 0)
+   */
+  double GetDistanceToNextStopLine(const std::vector<WayPoint>& path, const WayPoint& p, const double& giveUpDistance,
+      const double& maxDistance, int& stopLineID, int& stopSignID, int& trafficLightID);
+
+private:
+  const WayPoint* m_pData;
+  unsigned int m_Size;
+  unsigned int m_iNextEvent;
+  double m_LastCarDistance;
+  TrajectoryCursor m_Cursor;
+};
+
+} /* namespace PlannerHNS */
+
+#endif /* PATHEVENTSTABLE_H_ */
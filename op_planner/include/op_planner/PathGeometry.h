@@ -0,0 +1,74 @@
+/// \file PathGeometry.h
+/// \brief Side car geometry columns (arc length, heading, curvature) of a WayPoint path, computed once per path update
+/// \date Oct 14, 2026
+
+#ifndef PATHGEOMETRY_H_
+#define PATHGEOMETRY_H_
+
+#include "RoadNetwork.h"
+
+namespace PlannerHNS
+{
+
+/**
+ * @brief Structure of arrays that holds the geometry of a path, index i belongs to path point i.
+ * s is the cumulative arc length from the first point, heading is the (not normalized) atan2 angle to the next point,
+ * the last point copies the heading before it. kappa is 1/R of the circle through i-1, i, i+1, the first and last points copy their neighbors.
+ * Functions that move points mark the changed range with Invalidate, Update recomputes only the marked range.
+ */
+class PathGeometry
+{
+public:
+  std::vector<double> s;
+  std::vector<double> heading;
+  std::vector<double> kappa;
+
+  PathGeometry();
+  virtual ~PathGeometry();
+
+  void Clear();
+
+  /**
+   * @brief Mark the whole path as changed
+   */
+  void Invalidate();
+
+  /**
+   * @brief Mark the points [start, end] as moved, the point count must not change
+   */
+  void Invalidate(const int& start, const int& end);
+
+  /**
+   * @brief true if the columns are up to date with a path of this size
+   */
+  bool IsValid(const std::vector<WayPoint>& path) const;
+
+  /**
+   * @brief Recompute the changed range, or everything if the path size changed
+   */
+  void Update(const std::vector<WayPoint>& path);
+
+  /**
+   * @brief First point index with s >= distance, binary search on s
+   */
+  int GetIndexAtDistance(const double& distance) const;
+
+  double GetTotalLength() const;
+
+  /**
+   * @brief Range of points that moved compared to the old positions, start = -1 if nothing changed.
+   * If the sizes are different the range covers the whole path.
+   */
+  static void GetChangedRange(const std::vector<GPSPoint>& before, const std::vector<WayPoint>& after, int& start, int& end);
+
+private:
+  int m_DirtyStart;
+  int m_DirtyEnd;
+
+  void UpdateHeading(const std::vector<WayPoint>& path, const int& start, const int& end);
+  void UpdateCurvature(const std::vector<WayPoint>& path, const int& start, const int& end);
+};
+
+} /* namespace PlannerHNS */
+
+#endif /* PATHGEOMETRY_H_ */
@@ -0,0 +1,123 @@
+/// \file PathHorizon.h
+/// \brief Views on a part of a path, and the resampled horizon of a global path extended as the car advances
+/// \date Oct 14, 2026
+
+#ifndef PATHHORIZON_H_
+#define PATHHORIZON_H_
+
+#include "RoadNetwork.h"
+
+namespace PlannerHNS
+{
+
+/**
+ * @brief The points [offset, offset + size) of a path, without copying them.
+ * A view is valid until the path it references is changed.
+ */
+class PathView
+{
+public:
+  PathView() : m_pPath(0), m_Offset(0), m_Size(0){}
+  PathView(const std::vector<WayPoint>& path, const unsigned int& offset, const unsigned int& size)
+    : m_pPath(&path), m_Offset(offset), m_Size(size){}
+
+  unsigned int size() const { return m_Size; }
+  bool empty() const { return m_Size == 0; }
+  const WayPoint& at(const unsigned int& i) const { return m_pPath->at(m_Offset + i); }
+  const WayPoint& operator[](const unsigned int& i) const { return (*m_pPath)[m_Offset + i]; }
+  const WayPoint& front() const { return at(0); }
+  const WayPoint& back() const { return at(m_Size - 1); }
+
+  /**
+   * @brief Index of the first point of the view in the referenced path
+   */
+  unsigned int GetOffset() const { return m_Offset; }
+  const std::vector<WayPoint>* GetPath() const { return m_pPath; }
+
+  /**
+   * @brief Copy the points into path, path keeps its memory between calls.
+   * The costs are moved so the first point has cost 0, like the extracted paths of PlanningHelpers.
+   */
+  void CopyTo(std::vector<WayPoint>& path) const;
+
+private:
+  const std::vector<WayPoint>* m_pPath;
+  unsigned int m_Offset;
+  unsigned int m_Size;
+};
+
+/**
+ * @brief Resampled copy of a global path around the car, same result as
+ * PlanningHelpers::ExtractPartFromPointToDistanceDirectionFast without resampling the whole window each cycle.
+ * The original points are resampled with the FixPathDensity rule once, when the horizon reaches them,
+ * and the resampled points more than 10 meters behind the car are dropped. Headings and costs are
+ * computed for the new points only, the cost of a point is its distance from where the resampling started.
+ * The resampling starts again from the car (as ExtractPartFromPointToDistanceDirectionFast does) on the first call,
+ * when the path or the density change, and when the car leaves the resampled part.
+ * The resample phase is kept from the start, so the points can be shifted up to one density step from the
+ * points of the per cycle extraction, the path they follow is the same.
+ */
+class PathHorizon
+{
+public:
+  PathHorizon();
+  virtual ~PathHorizon();
+
+  /**
+   * @brief Forget the resampled points, call it when the original path is replaced in place
+   */
+  void Reset();
+
+  /**
+   * @brief Resampled points from 10 meters behind the closest point to pos to minDistance ahead of it.
+   * The view references the resampled points kept by this object, it is valid until the next call.
+   * @return false if originalPath has less than 2 points, view is then empty
+   */
+  bool Extract(const std::vector<WayPoint>& originalPath, const WayPoint& pos, const double& minDistance,
+      const double& pathDensity, PathView& view);
+
+  /**
+   * @brief All the resampled points currently kept
+   */
+  const std::vector<WayPoint>& GetResampledPoints() const { return m_Resampled; }
+
+  /**
+   * @brief Index in the original path of the point the resampling started from
+   */
+  int GetResampleStart() const { return m_iResampleStart; }
+
+  unsigned long m_nRestarts; // times the resampling started from the car again
+  unsigned long m_nAddedPoints; // resampled points added, over all the calls
+
+private:
+  //the original path and density the points were resampled for
+  const WayPoint* m_pData;
+  unsigned int m_Size;
+  GPSPoint m_First;
+  GPSPoint m_Last;
+  double m_Density;
+
+  std::vector<WayPoint> m_Resampled;
+  int m_iResampleStart;
+  bool m_bFinished; // all the original points were resampled
+
+  //state of the FixPathDensity loop between two extensions, the loop moves the start point of a segment
+  unsigned int m_si;
+  unsigned int m_ei;
+  double m_d;
+  double m_Remaining;
+  GPSPoint m_StartPos;
+
+  bool IsResampledFor(const std::vector<WayPoint>& originalPath, const double& pathDensity) const;
+  /**
+   * @return distance on the original path from the start of the resampling to the point after the closest one
+   */
+  double Restart(const std::vector<WayPoint>& originalPath, const WayPoint& pos, const double& pathDensity);
+  const GPSPoint& GetPos(const std::vector<WayPoint>& originalPath, const unsigned int& i) const;
+  bool ResampleNextPoint(const std::vector<WayPoint>& originalPath);
+  void UpdateAngleAndCost(const unsigned int& first_new);
+};
+
+} /* namespace PlannerHNS */
+
+#endif /* PATHHORIZON_H_ */
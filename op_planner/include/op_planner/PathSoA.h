@@ -0,0 +1,48 @@
+/// \file PathSoA.h
+/// \brief Compact structure of arrays copy of a WayPoint path (x, y, yaw, v, s, time), for the roll out and cost evaluation loops
+/// \date Oct 14, 2026
+
+#ifndef PATHSOA_H_
+#define PATHSOA_H_
+
+#include "RoadNetwork.h"
+
+namespace PlannerHNS
+{
+
+/**
+ * @brief Contiguous columns of the WayPoint fields read by the trajectory cost loops.
+ * Index i belongs to point i of the WayPoint path it was built from, s is the cumulative arc length and t is the timeCost.
+ * The WayPoint path stays the reference for visualization and ROS conversion.
+ */
+class PathSoA
+{
+public:
+  std::vector<double> x;
+  std::vector<double> y;
+  std::vector<double> yaw;
+  std::vector<double> v;
+  std::vector<double> s;
+  std::vector<double> t;
+
+  PathSoA();
+  PathSoA(const std::vector<WayPoint>& path);
+  virtual ~PathSoA();
+
+  unsigned int size() const { return x.size(); }
+  bool empty() const { return x.empty(); }
+
+  void Clear();
+  void Reserve(const unsigned int& n);
+  void PushBack(const WayPoint& wp);
+  void Assign(const std::vector<WayPoint>& path);
+
+  /**
+   * @brief Light WayPoint with only the fields kept in the columns
+   */
+  WayPoint GetWayPoint(const unsigned int& i) const;
+};
+
+} /* namespace PlannerHNS */
+
+#endif /* PATHSOA_H_ */
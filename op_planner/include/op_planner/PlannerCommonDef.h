@@ -23,6 +23,50 @@ enum MAP_SOURCE_TYPE
   MAP_LANES_CSV_FILES
 };
 
+/**
+ * @brief Stages of a local planning cycle, each one is the stage index in the planner's latency recorder
+ */
+enum PLANNING_STAGE
+{
+  STAGE_TOTAL_PATH,
+  STAGE_ROLL_OUTS,
+  STAGE_TRAJECTORY_COSTS,
+  STAGE_BEHAVIOR_STATE,
+  STAGE_VELOCITY_PROFILE,
+  STAGE_COUNT
+};
+
+inline const char* GetPlanningStageName(const PLANNING_STAGE& stage)
+{
+  switch(stage)
+  {
+  case STAGE_TOTAL_PATH: return "total_path";
+  case STAGE_ROLL_OUTS: return "roll_outs";
+  case STAGE_TRAJECTORY_COSTS: return "trajectory_costs";
+  case STAGE_BEHAVIOR_STATE: return "behavior_state";
+  case STAGE_VELOCITY_PROFILE: return "velocity_profile";
+  default: return "unknown";
+  }
+}
+
+/**
+ * @brief Solver of the path and profile smoothers, both minimize the same objective with the end points fixed
+ */
+enum SMOOTHING_METHOD
+{
+  SMOOTHING_GRADIENT_DESCENT, //!< iterate until the change is under the tolerance
+  SMOOTHING_DIRECT //!< solve the tridiagonal system in one pass, fixed run time, the tolerance is not used
+};
+
+/**
+ * @brief Speed profile of PlanningHelpers::GenerateRecommendedSpeed and SmoothGlobalPathSpeed
+ */
+enum VELOCITY_PROFILE_METHOD
+{
+  VELOCITY_PROFILE_SMOOTHING, //!< curvature ratio speeds smoothed with SmoothSpeedProfiles
+  VELOCITY_PROFILE_SWEEP //!< GenerateVelocityProfile, one forward acceleration and one backward deceleration pass, linear run time
+};
+
 enum CAR_TYPE
 {
   Mv2Car, //!< Mv2Car
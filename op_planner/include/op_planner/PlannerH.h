@@ -10,16 +10,29 @@
 #define LANE_CHANGE_SMOOTH_FACTOR_DISTANCE 8 // meters
 
 #include "RoadNetwork.h"
+#include "RollOutsCache.h"
+#include "WayPointArena.h"
+#include "RouteCache.h"
+#include "LaneContractionHierarchy.h"
+#include "LaneGraph.h"
 
 namespace PlannerHNS
 {
 
 enum PLANDIRECTION {MOVE_FORWARD_ONLY, MOVE_BACKWARD_ONLY,   MOVE_FREE};
 enum HeuristicConstrains {EUCLIDEAN, NEIGBORHOOD,DIRECTION };
+enum SEARCH_TREE_TYPE {DP_SEARCH_TREE, ASTAR_SEARCH_TREE};
 
 class PlannerH
 {
 public:
+  WayPointArena m_SearchArena; // search tree nodes, reset at the start of each search. Node count and peak bytes for profiling
+  SEARCH_TREE_TYPE m_SearchType; // search used by PlanUsingDP, DP expands the whole tree, A* stops at the goal
+  RouteCache m_RouteCache; // plans of PlanUsingDP for versioned maps, not used when the caller asks for the search tree nodes
+  LaneContractionHierarchy m_LaneHierarchy; // when built for the map, PlanUsingDP without a global path searches only the lanes of the hierarchy route
+  bool m_bLaneGraphRouting; // without the hierarchy, PlanUsingDP without a global path searches only the lanes of the m_LaneGraph route
+  LaneGraph m_LaneGraph; // built again by PlanUsingDP for each new map version, every call for maps with version 0
+
   PlannerH();
   virtual ~PlannerH();
 
@@ -32,11 +45,35 @@ public:
         std::vector<std::vector<std::vector<WayPoint> > >& rollOutsPaths,
         std::vector<WayPoint>& sampledPoints);
 
+  /**
+   * @brief Incremental generation, caches keeps the roll outs of each reference path between calls (see PlanningHelpers::CalculateRollInTrajectories)
+   */
+  void GenerateRunoffTrajectory(const std::vector<std::vector<WayPoint> >& referencePaths, const WayPoint& carPos, const bool& bEnableLaneChange, const double& speed, const double& microPlanDistance,
+        const double& maxSpeed,const double& minSpeed, const double&  carTipMargin, const double& rollInMargin,
+        const double& rollInSpeedFactor, const double& pathDensity, const double& rollOutDensity,
+        const int& rollOutNumber, const double& SmoothDataWeight, const double& SmoothWeight,
+        const double& SmoothTolerance, const double& speedProfileFactor, const bool& bHeadingSmooth,
+        const int& iCurrGlobalPath, const int& iCurrLocalTraj,
+        std::vector<std::vector<std::vector<WayPoint> > >& rollOutsPaths,
+        std::vector<RollOutsCache>& caches,
+        std::vector<WayPoint>& sampledPoints);
+
   double PlanUsingDP(const WayPoint& carPos,const WayPoint& goalPos,
       const double& maxPlanningDistance, const bool bEnableLaneChange, const std::vector<int>& globalPath,
-      RoadNetwork& map, std::vector<std::vector<WayPoint> >& paths, std::vector<WayPoint*>* all_cell_to_delete = 0,
+      const RoadNetwork& map, std::vector<std::vector<WayPoint> >& paths, std::vector<WayPoint*>* all_cell_to_delete = 0,
       double fallback_min_goal_distance_th = 0.0);
 
+  /**
+   * @brief Routes from carPos to each goal from one search tree (PlanningHelpers::BuildPlanningSearchTreeMultiGoal)
+   * instead of one PlanUsingDP search per goal. paths and costs get one entry for each goal: the alternatives as
+   * PlanUsingDP extracts them and the route cost, empty and 0 when the goal is not found on the map, further than
+   * GOAL_POINT_MAX_DISTANCE from its lane or not reached within maxPlanningDistance.
+   * @return number of goals with a route
+   */
+  int PlanUsingDPMultiGoal(const WayPoint& carPos, const std::vector<WayPoint>& goals,
+      const double& maxPlanningDistance, const bool bEnableLaneChange, const std::vector<int>& globalPath,
+      const RoadNetwork& map, std::vector<std::vector<std::vector<WayPoint> > >& paths, std::vector<double>& costs);
+
    double PlanUsingDPRandom(const WayPoint& start,
         const double& maxPlanningDistance,
         RoadNetwork& map,
@@ -47,9 +84,19 @@ public:
 
   double PredictPlanUsingDP(const WayPoint& startPose, WayPoint* closestWP, const double& maxPlanningDistance, std::vector<std::vector<WayPoint> >& paths, const bool& bFindBranches = true);
 
-  double PredictTrajectoriesUsingDP(const WayPoint& startPose, std::vector<WayPoint*> closestWPs, const double& maxPlanningDistance, std::vector<std::vector<WayPoint> >& paths, const bool& bFindBranches = true, const bool bDirectionBased = false, const bool pathDensity = 1.0);
+  double PredictTrajectoriesUsingDP(const WayPoint& startPose, const std::vector<const WayPoint*>& closestWPs, const double& maxPlanningDistance, std::vector<std::vector<WayPoint> >& paths, const bool& bFindBranches = true, const bool bDirectionBased = false, const bool pathDensity = 1.0);
 
   void DeleteWaypoints(std::vector<WayPoint*>& wps);
+
+private:
+  /**
+   * @brief Search tree from pStart to pGoal and extraction of the alternative paths, without the start and goal extensions.
+   * false if no path is found, paths is then not changed. The straight backup plan is tried only if bUseBackupPlan is set.
+   */
+  bool SearchGlobalRoute(const WayPoint* pStart, const WayPoint* pGoal,
+      const double& maxPlanningDistance, const bool bEnableLaneChange, const std::vector<int>& globalPath,
+      std::vector<std::vector<WayPoint> >& paths, double& totalPlanningDistance,
+      std::vector<WayPoint*>* all_cell_to_delete, double fallback_min_goal_distance_th, const bool& bUseBackupPlan = true);
 };
 
 }
@@ -0,0 +1,78 @@
+/// \file PlanningBenchmark.h
+/// \brief Replay of a recorded scenario through the planning modules with per stage latency percentiles, no ROS node needed
+/// \date Oct 14, 2026
+
+#ifndef PLANNINGBENCHMARK_H_
+#define PLANNINGBENCHMARK_H_
+
+#include "RoadNetwork.h"
+#include "PlannerCommonDef.h"
+#include "op_utility/StageTimer.h"
+
+namespace PlannerHNS
+{
+
+/**
+ * @brief Recorded scenario, all of it is loaded before the replay so file reading is never timed.
+ * Scenario folder (path ends with /):
+ * map.snapshot (RoadNetworkSnapshot written with source signature 0) or map.kml or else the vector map csv files of the folder,
+ * ego.csv the ego poses in the LocalizationPathReader format (x, y, z, a, v),
+ * objects.csv the detected objects in the ObjectsLogReader format, frame is the row of ego.csv (optional).
+ */
+class PlanningScenario
+{
+public:
+  RoadNetwork map;
+  std::vector<WayPoint> egoTrajectory;
+  std::vector<std::vector<DetectedObject> > objectFrames; // one list per ego pose
+
+  bool LoadFromFolder(const std::string& folder);
+  bool SaveToFolder(const std::string& folder) const;
+
+  /**
+   * @brief nLanes parallel straight lanes of length meters, the ego drives the first one at speed
+   * and nObjects cars drive the other lanes, frames are dt seconds apart
+   */
+  static void CreateSynthetic(const int& nLanes, const double& length, const int& nObjects, const double& speed,
+      const double& dt, PlanningScenario& scenario);
+};
+
+enum BENCHMARK_STAGE {BENCH_GLOBAL_PLAN, BENCH_PREDICTION, BENCH_ROLL_OUTS, BENCH_TRAJECTORY_COSTS, BENCH_DECISION, BENCH_CYCLE, BENCH_STAGES_COUNT};
+
+/**
+ * @brief Each repeat plans the global path from the first to the last ego pose with PlannerH (route cache off),
+ * then every frame runs BehaviorPrediction, the roll outs generation, TrajectoryDynamicCosts and DecisionMaker
+ * on the recorded pose and objects. The planning does not drive the ego, so every repeat sees the same inputs.
+ */
+class PlanningBenchmark
+{
+public:
+  PlanningParams m_Params;
+  ControllerParams m_CtrlParams;
+  CAR_BASIC_INFO m_CarInfo;
+  int m_nRepeats;
+  int m_nThreads; // TrajectoryDynamicCosts and BehaviorPrediction threads
+  double m_FrameTime; // dt passed to DecisionMaker
+
+  PlanningBenchmark();
+  virtual ~PlanningBenchmark();
+
+  /**
+   * @brief Replay scenario m_nRepeats times, false when the global plan fails or there are less than two ego poses
+   */
+  bool Run(PlanningScenario& scenario);
+
+  const UtilityHNS::StageLatencyRecorder& GetLatency() const;
+
+  /**
+   * @brief One line per stage: number of calls, calls per second, p50, p90, p99 and max in milliseconds
+   */
+  std::string GetReport() const;
+
+private:
+  UtilityHNS::StageLatencyRecorder m_Latency;
+};
+
+} /* namespace PlannerHNS */
+
+#endif /* PLANNINGBENCHMARK_H_ */
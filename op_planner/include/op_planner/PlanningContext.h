@@ -0,0 +1,49 @@
+/// \file PlanningContext.h
+/// \brief Scratch buffers, settings and debug outputs of the PlanningHelpers functions for one planning thread
+/// \date Oct 14, 2026
+
+#ifndef PLANNINGCONTEXT_H_
+#define PLANNINGCONTEXT_H_
+
+#include "RoadNetwork.h"
+#include "PlannerCommonDef.h"
+#include "RollOutsCache.h"
+
+namespace PlannerHNS
+{
+
+/**
+ * @brief Everything the PlanningHelpers overloads that take a context read or write besides their arguments.
+ * Each thread (roll out evaluation task, predicted object) keeps its own context, the helpers never touch the PlanningHelpers static members
+ * through it. The buffers keep their memory, so reusing the context makes the calls allocation free once the buffers reached the path sizes.
+ */
+class PlanningContext
+{
+public:
+  SMOOTHING_METHOD smoothingMethod;
+
+  std::vector<WayPoint> pathBuffer; // FixPathDensity output, gradient descent smoothing copy
+  std::vector<double> x, y; // direct smoothing columns
+  std::vector<double> solverBuffer; // SmoothValuesDirect scratch
+  std::vector<double> rollInSteps, rollInOffsets; // per roll out lateral step and accumulated offset of the roll in
+  std::vector<std::vector<WayPoint> > excludedPaths; // roll outs points kept out of the smoothing
+  RollOutsTemplate rollOutsTemplate;
+
+  std::vector<std::pair<GPSPoint, GPSPoint> > testingClosestPoint; // debug output, replaces PlanningHelpers::m_TestingClosestPoint
+
+  PlanningContext(const SMOOTHING_METHOD& method = SMOOTHING_GRADIENT_DESCENT) : smoothingMethod(method)
+  {
+  }
+
+  /**
+   * @brief Clear the debug outputs, the buffers keep their memory
+   */
+  void Reset()
+  {
+    testingClosestPoint.clear();
+  }
+};
+
+} /* namespace PlannerHNS */
+
+#endif /* PLANNINGCONTEXT_H_ */
@@ -9,8 +9,17 @@
 #define PLANNINGHELPERS_H_
 
 #include "RoadNetwork.h"
+#include "PathGeometry.h"
+#include "PathHorizon.h"
+#include "RollOutsCache.h"
+#include "PlanningContext.h"
+#include "ObjectContoursCache.h"
+#include "ContourCorridor.h"
+#include "PlannerCommonDef.h"
+#include "WayPointArena.h"
 #include "op_utility/UtilityH.h"
 #include "op_utility/DataRW.h"
+#include "op_utility/AsyncLogger.h"
 #include "tinyxml.h"
 
 
@@ -29,7 +38,10 @@ class PlanningHelpers
 {
 
 public:
-  static std::vector<std::pair<GPSPoint, GPSPoint> > m_TestingClosestPoint;
+  static std::vector<std::pair<GPSPoint, GPSPoint> > m_TestingClosestPoint; // not written any more, see PlanningContext::testingClosestPoint
+  static SMOOTHING_METHOD m_SmoothingMethod; // used by SmoothPath and the speed, curvature and direction profile smoothers
+  static VELOCITY_PROFILE_METHOD m_VelocityProfileMethod;
+  static double m_ProfileMaxAcceleration, m_ProfileMaxDeceleration, m_ProfileMaxLateralAcceleration; // limits of the VELOCITY_PROFILE_SWEEP profile
 
 public:
   PlanningHelpers();
@@ -37,6 +49,11 @@ public:
 
   static bool GetRelativeInfo(const std::vector<WayPoint>& trajectory, const WayPoint& p, RelativeInfo& info, const int& prevIndex = 0);
 
+  /**
+   * @brief Fill the relative info of p from an already known next point index, shared with TrajectoryCursor. trajectory must have at least 2 points
+   */
+  static void GetRelativeInfoFromIndex(const std::vector<WayPoint>& trajectory, const WayPoint& p, const int& iFront, RelativeInfo& info);
+
   static bool GetRelativeInfoRange(const std::vector<std::vector<WayPoint> >& trajectories, const WayPoint& p, const double& searchDistance, RelativeInfo& info);
 
   static bool GetRelativeInfoLimited(const std::vector<WayPoint>& trajectory, const WayPoint& p, RelativeInfo& info, const int& prevIndex = 0);
@@ -71,8 +88,42 @@ public:
 
   static void FixPathDensity(std::vector<WayPoint>& path, const double& distanceDensity);
 
+  static void FixPathDensity(std::vector<WayPoint>& path, const double& distanceDensity, PathGeometry& geometry);
+
+  /**
+   * @brief FixPathDensity that builds the new path in buffer, path and buffer keep their memory between calls
+   */
+  static void FixPathDensity(std::vector<WayPoint>& path, const double& distanceDensity, std::vector<WayPoint>& buffer);
+
+  static void FixPathDensity(std::vector<WayPoint>& path, const double& distanceDensity, PlanningContext& context);
+
+  static void SetSmoothingMethod(const SMOOTHING_METHOD& method);
+  static SMOOTHING_METHOD GetSmoothingMethod();
+
+  /**
+   * @brief Acceleration limits (m/s2, magnitudes) are used by the VELOCITY_PROFILE_SWEEP method only
+   */
+  static void SetVelocityProfileMethod(const VELOCITY_PROFILE_METHOD& method, const double& max_acceleration = 1.5,
+      const double& max_deceleration = 1.5, const double& max_lateral_acceleration = 2.0);
+  static VELOCITY_PROFILE_METHOD GetVelocityProfileMethod();
+
+  /**
+   * @brief Direct smoother, values becomes the point where the gradient descent smoothers converge (first and last values fixed):
+   * wd*(in_i - y_i) + weight_smooth*(y_i-1 + y_i+1 - 2*y_i) = 0 with wd = weight_data*(1 - 2*weight_smooth),
+   * the minimum of wd*sum((in_i - y_i)^2) + weight_smooth*sum((y_i+1 - y_i)^2). O(N) tridiagonal solve, buffer is scratch memory.
+   */
+  static void SmoothValuesDirect(std::vector<double>& values, const double& weight_data, const double& weight_smooth, std::vector<double>& buffer);
+
   static void SmoothPath(std::vector<WayPoint>& path, double weight_data =0.25,double weight_smooth = 0.25,double tolerance = 0.01);
 
+  static void SmoothPath(std::vector<WayPoint>& path, PathGeometry& geometry, double weight_data =0.25,double weight_smooth = 0.25,double tolerance = 0.01);
+
+  /**
+   * @brief Re-entrant SmoothPath, smoothing method and scratch memory from context
+   */
+  static void SmoothPath(std::vector<WayPoint>& path, const double& weight_data, const double& weight_smooth, const double& tolerance,
+      PlanningContext& context);
+
   static double CalcCircle(const GPSPoint& pt1, const GPSPoint& pt2, const GPSPoint& pt3, GPSPoint& center);
 
   static void FixAngleOnly(std::vector<WayPoint>& path);
@@ -81,21 +132,43 @@ public:
 
   //static double CalcAngleAndCostSimple(std::vector<WayPoint>& path, const double& lastCost = 0);
 
+  static double CalcAngleAndCost(std::vector<WayPoint>& path, PathGeometry& geometry, const double& lastCost = 0);
+
   static double CalcAngleAndCostAndCurvatureAnd2D(std::vector<WayPoint>& path, const double& lastCost = 0);
 
+  static double CalcAngleAndCostAndCurvatureAnd2D(std::vector<WayPoint>& path, PathGeometry& geometry, const double& lastCost = 0);
+
   static void PredictConstantTimeCostForTrajectory(std::vector<PlannerHNS::WayPoint>& path, const PlannerHNS::WayPoint& currPose, const double& minVelocity, const double& minDist);
 
   static double GetAccurateDistanceOnTrajectory(std::vector<WayPoint>& path, const int& start_index, const WayPoint& p);
 
+  static double GetAccurateDistanceOnTrajectory(const std::vector<WayPoint>& path, const PathGeometry& geometry, const int& start_index, const WayPoint& p);
+
   static void ExtractPartFromPointToDistance(const std::vector<WayPoint>& originalPath, const WayPoint& pos, const double& minDistance,
       const double& pathDensity, std::vector<WayPoint>& extractedPath, const double& SmoothDataWeight, const double& SmoothWeight, const double& SmoothTolerance);
 
   static void ExtractPartFromPointToDistanceFast(const std::vector<WayPoint>& originalPath, const WayPoint& pos, const double& minDistance,
         const double& pathDensity, std::vector<WayPoint>& extractedPath, const double& SmoothDataWeight, const double& SmoothWeight, const double& SmoothTolerance);
 
+  static void ExtractPartFromPointToDistanceFast(const std::vector<WayPoint>& originalPath, const PathGeometry& originalGeometry, const WayPoint& pos, const double& minDistance,
+        const double& pathDensity, std::vector<WayPoint>& extractedPath, PathGeometry& extractedGeometry);
+
   static void ExtractPartFromPointToDistanceDirectionFast(const std::vector<WayPoint>& originalPath, const WayPoint& pos, const double& minDistance,
       const double& pathDensity, std::vector<WayPoint>& extractedPath);
 
+  /**
+   * @brief Same extraction, buffer is the density scratch path, reusing extractedPath and buffer between calls avoids allocations
+   */
+  static void ExtractPartFromPointToDistanceDirectionFast(const std::vector<WayPoint>& originalPath, const WayPoint& pos, const double& minDistance,
+      const double& pathDensity, std::vector<WayPoint>& extractedPath, std::vector<WayPoint>& buffer);
+
+  /**
+   * @brief The range of originalPath that ExtractPartFromPointToDistanceDirectionFast resamples, as a view
+   * without copying the points. Use PathHorizon for the resampled points kept between cycles.
+   */
+  static void ExtractPartFromPointToDistanceDirectionFast(const std::vector<WayPoint>& originalPath, const WayPoint& pos, const double& minDistance,
+      PathView& extractedView);
+
   static void CalculateRollInTrajectories(const WayPoint& carPos, const double& speed, const std::vector<WayPoint>& originalCenter, int& start_index,
       int& end_index, std::vector<double>& end_laterals ,
       std::vector<std::vector<WayPoint> >& rollInPaths, const double& max_roll_distance,
@@ -105,8 +178,60 @@ public:
       const double& SmoothTolerance, const bool& bHeadingSmooth,
       std::vector<WayPoint>& sampledPoints);
 
+  /**
+   * @brief Same as above with the end laterals and center normals of rollOutsTemplate, only rebuilt when the parameters or the center headings change
+   */
+  static void CalculateRollInTrajectories(const WayPoint& carPos, const double& speed, const std::vector<WayPoint>& originalCenter, int& start_index,
+      int& end_index, std::vector<double>& end_laterals ,
+      std::vector<std::vector<WayPoint> >& rollInPaths, const double& max_roll_distance,
+      const double& maxSpeed, const double&  carTipMargin, const double& rollInMargin,
+      const double& rollInSpeedFactor, const double& pathDensity, const double& rollOutDensity,
+      const int& rollOutNumber, const double& SmoothDataWeight, const double& SmoothWeight,
+      const double& SmoothTolerance, const bool& bHeadingSmooth, RollOutsTemplate& rollOutsTemplate,
+      std::vector<WayPoint>& sampledPoints);
+
+  /**
+   * @brief Re-entrant version, the template, smoothing method and scratch memory are the ones of context.
+   * rollInPaths keeps the memory of its paths when it is reused.
+   */
+  static void CalculateRollInTrajectories(const WayPoint& carPos, const double& speed, const std::vector<WayPoint>& originalCenter, int& start_index,
+      int& end_index, std::vector<double>& end_laterals ,
+      std::vector<std::vector<WayPoint> >& rollInPaths, const double& max_roll_distance,
+      const double& maxSpeed, const double&  carTipMargin, const double& rollInMargin,
+      const double& rollInSpeedFactor, const double& pathDensity, const double& rollOutDensity,
+      const int& rollOutNumber, const double& SmoothDataWeight, const double& SmoothWeight,
+      const double& SmoothTolerance, const bool& bHeadingSmooth, PlanningContext& context,
+      std::vector<WayPoint>& sampledPoints);
+
+  /**
+   * @brief Incremental version, while the car moves along the same center line the roll outs of cache are shifted to the car
+   * and only the new horizon is appended and smoothed (with the last ROLL_OUTS_TAIL_OVERLAP kept points).
+   * Full generation (stored in cache) when the center line changes, the car lateral offset changes more than ROLL_OUTS_MAX_LATERAL_SHIFT
+   * or the car or the roll in end moved more than ROLL_OUTS_MAX_SHIFT_RATIO*carTipMargin since the last full generation.
+   * sampledPoints only gets the new points when shifting. Returns true when the roll outs were shifted.
+   */
+  static bool CalculateRollInTrajectories(const WayPoint& carPos, const double& speed, const std::vector<WayPoint>& originalCenter, int& start_index,
+      int& end_index, std::vector<double>& end_laterals ,
+      std::vector<std::vector<WayPoint> >& rollInPaths, const double& max_roll_distance,
+      const double& maxSpeed, const double&  carTipMargin, const double& rollInMargin,
+      const double& rollInSpeedFactor, const double& pathDensity, const double& rollOutDensity,
+      const int& rollOutNumber, const double& SmoothDataWeight, const double& SmoothWeight,
+      const double& SmoothTolerance, const bool& bHeadingSmooth, RollOutsCache& cache,
+      std::vector<WayPoint>& sampledPoints);
+
+  /**
+   * @brief Center line indices used by CalculateRollInTrajectories: closest back point of the car, end of the roll in
+   * and last point of the roll outs horizon, lateral is the car perpendicular distance to the center line
+   */
+  static void GetRollOutsIndices(const WayPoint& carPos, const double& speed, const std::vector<WayPoint>& originalCenter,
+      const double& max_roll_distance, const double&  carTipMargin, const double& rollInMargin, const double& rollInSpeedFactor,
+      int& close_index, int& far_index, int& last_index, double& lateral);
+
   static void SmoothSpeedProfiles(std::vector<WayPoint>& path_in, double weight_data, double weight_smooth, double tolerance  = 0.1);
 
+  static void SmoothSpeedProfiles(std::vector<WayPoint>& path_in, const double& weight_data, const double& weight_smooth, const double& tolerance,
+      PlanningContext& context);
+
   static void SmoothCurvatureProfiles(std::vector<WayPoint>& path_in, double weight_data, double weight_smooth, double tolerance = 0.1);
 
   static void SmoothWayPointsDirections(std::vector<WayPoint>& path_in, double weight_data, double weight_smooth, double tolerance  = 0.1);
@@ -115,28 +240,70 @@ public:
 
   static void GenerateRecommendedSpeed(std::vector<WayPoint>& path, const double& max_speed, const double& speedProfileFactor);
 
+  /**
+   * @brief Highest speed of each point (global path or roll out) that keeps the acceleration limits, in two passes over the path.
+   * The cap of a point is max_speed, its current v when it is lower and not negative (map speed limits, stop points)
+   * and sqrt(max_lateral_acceleration*R) on curves. The forward pass limits the speed gain from the previous point to max_acceleration,
+   * the backward pass limits the speed loss to the next point to max_deceleration.
+   * A limit <= 0 is not applied, start_speed and end_speed are not applied when negative.
+   */
+  static void GenerateVelocityProfile(std::vector<WayPoint>& path, const double& max_speed, const double& max_acceleration,
+      const double& max_deceleration, const double& max_lateral_acceleration, const double& start_speed = -1, const double& end_speed = -1);
+
 //  static WayPoint* BuildPlanningSearchTree(Lane* l, const WayPoint& prevWayPointIndex,
 //      const WayPoint& startPos, const WayPoint& goalPos,
 //      const std::vector<int>& globalPath, const double& DistanceLimit,
 //      int& nMaxLeftBranches, int& nMaxRightBranches,
 //      std::vector<WayPoint*>& all_cells_to_delete );
 
-  static WayPoint* BuildPlanningSearchTreeV2(WayPoint* pStart,
+  /**
+   * @brief The search functions below allocate the tree nodes from pArena when it is given, the nodes are then released
+   * with pArena->Reset() and must not be deleted. Without an arena each node is created with new and the caller deletes
+   * the nodes listed in all_cells_to_delete.
+   */
+  static WayPoint* BuildPlanningSearchTreeV2(const WayPoint* pStart,
+      const WayPoint& goalPos,
+      const std::vector<int>& globalPath, const double& DistanceLimit,
+      const bool& bEnableLaneChange,
+      std::vector<WayPoint*>& all_cells_to_delete,
+      double fallback_min_goal_distance_th = 0.0, WayPointArena* pArena = nullptr);
+
+  /**
+   * @brief Same inputs and output tree as BuildPlanningSearchTreeV2, searched with A* (binary heap open list,
+   * hash closed set keyed by lane id and waypoint id, Euclidean distance to the goal as heuristic).
+   * A tree node is created only when it is expanded, with the lowest cost parent. The action costs must not be negative.
+   * The distance limit applies to the cost of the expanded node.
+   */
+  static WayPoint* BuildPlanningSearchTreeAStar(const WayPoint* pStart,
       const WayPoint& goalPos,
       const std::vector<int>& globalPath, const double& DistanceLimit,
       const bool& bEnableLaneChange,
       std::vector<WayPoint*>& all_cells_to_delete,
-      double fallback_min_goal_distance_th = 0.0 );
+      double fallback_min_goal_distance_th = 0.0, WayPointArena* pArena = nullptr);
+
+  /**
+   * @brief One Dijkstra search from pStart for all the goals, with the neighbors and goal test of
+   * BuildPlanningSearchTreeAStar. It stops when every goal is reached or the expanded cost is over DistanceLimit.
+   * goalCells gets the tree node of each goal, nullptr when it is not reached, the goals share one tree.
+   * @return number of goals reached
+   */
+  static int BuildPlanningSearchTreeMultiGoal(const WayPoint* pStart,
+      const std::vector<WayPoint>& goals,
+      const std::vector<int>& globalPath, const double& DistanceLimit,
+      const bool& bEnableLaneChange,
+      std::vector<WayPoint*>& all_cells_to_delete,
+      std::vector<WayPoint*>& goalCells, WayPointArena* pArena = nullptr);
 
-  static WayPoint* BuildPlanningSearchTreeStraight(WayPoint* pStart,
+  static WayPoint* BuildPlanningSearchTreeStraight(const WayPoint* pStart,
       const double& DistanceLimit,
-      std::vector<WayPoint*>& all_cells_to_delete );
+      std::vector<WayPoint*>& all_cells_to_delete, WayPointArena* pArena = nullptr);
 
-  static int PredictiveDP(WayPoint* pStart, const double& DistanceLimit,
-      std::vector<WayPoint*>& all_cells_to_delete, std::vector<WayPoint*>& end_waypoints);
+  static int PredictiveDP(const WayPoint* pStart, const double& DistanceLimit,
+      std::vector<WayPoint*>& all_cells_to_delete, std::vector<WayPoint*>& end_waypoints, WayPointArena* pArena = nullptr);
 
-  static int PredictiveIgnorIdsDP(WayPoint* pStart, const double& DistanceLimit,
-        std::vector<WayPoint*>& all_cells_to_delete, std::vector<WayPoint*>& end_waypoints, std::vector<int>& lanes_ids);
+  static int PredictiveIgnorIdsDP(const WayPoint* pStart, const double& DistanceLimit,
+        std::vector<WayPoint*>& all_cells_to_delete, std::vector<WayPoint*>& end_waypoints, std::vector<int>& lanes_ids,
+        WayPointArena* pArena = nullptr);
 
   static bool CheckLaneIdExits(const std::vector<int>& lanes, const Lane* pL);
 
@@ -154,7 +321,7 @@ public:
 
   static WayPoint* GetMinCostCell(const std::vector<WayPoint*>& cells, const std::vector<int>& globalPathIds);
 
-  static void TraversePathTreeBackwards(WayPoint* pHead, WayPoint* pStartWP, const std::vector<int>& globalPathIds,
+  static void TraversePathTreeBackwards(WayPoint* pHead, const WayPoint* pStartWP, const std::vector<int>& globalPathIds,
       std::vector<WayPoint>& localPath, std::vector<std::vector<WayPoint> >& localPaths);
 
   static void ExtractPlanAlernatives(const std::vector<WayPoint>& singlePath, std::vector<std::vector<WayPoint> >& allPaths);
@@ -169,16 +336,40 @@ public:
 
   static void CalcContourPointsForDetectedObjects(const WayPoint& currPose, std::vector<DetectedObject>& obj_list, const double& filterDistance = 100);
 
+  /**
+   * @brief Same objects as CalcContourPointsForDetectedObjects, the contours come from cache (see ObjectContoursCache).
+   * With pCorridor, an object that can't have a corner in the corridor keeps an empty contour,
+   * cache.GetContour computes it if it is needed later.
+   */
+  static void CalcContourPointsForDetectedObjects(const WayPoint& currPose, std::vector<DetectedObject>& obj_list, const double& filterDistance,
+      ObjectContoursCache& cache, const ContourCorridor* pCorridor = nullptr);
+
   static double GetVelocityAhead(const std::vector<WayPoint>& path, const RelativeInfo& info,int& prev_index, const double& reasonable_brake_distance);
 
   static bool CompareTrajectories(const std::vector<WayPoint>& path1, const std::vector<WayPoint>& path2);
 
+  /**
+   * @brief 64 bit FNV-1a hash of the size, the lanes and stop lines of all the points and the position,
+   * heading and speed of every sampleStep'th point and of the last one. Computed once by the producer of a path
+   * and sent with it, an equal fingerprint tells a consumer the path didn't change without comparing the points.
+   * A change only in the points between two samples isn't detected, use sampleStep = 1 to hash all of them.
+   */
+  static unsigned long long GetPathFingerprint(const std::vector<WayPoint>& path, const unsigned int& sampleStep = 8);
+  static unsigned long long GetPathFingerprint(const std::vector<std::vector<WayPoint> >& paths, const unsigned int& sampleStep = 8);
+
   static double GetDistanceToClosestStopLineAndCheck(const std::vector<WayPoint>& path, const WayPoint& p, const double& giveUpDistance, int& stopLineID,int& stopSignID, int& trafficLightID, const int& prevIndex = 0);
 
   static bool GetThreePointsInfo(const WayPoint& p0, const WayPoint& p1, const WayPoint& p2, WayPoint& perp_p, double& long_d, double lat_d);
 
   static void WritePathToFile(const std::string& fileName, const std::vector<WayPoint>& path);
 
+  /**
+   * @brief Log of paths in the WritePathToFile columns, LogPath queues one record per waypoint and returns,
+   * the paths follow each other in title.csv once converted by AsyncLogger::ConvertToText.
+   */
+  static int AddPathLog(UtilityHNS::AsyncLogger& logger, const std::string& title);
+  static void LogPath(UtilityHNS::AsyncLogger& logger, const int& log, const std::vector<WayPoint>& path);
+
   static LIGHT_INDICATOR GetIndicatorsFromPath(const std::vector<WayPoint>& path, const WayPoint& pose, const double& seachDistance);
 
   static PlannerHNS::WayPoint GetRealCenter(const PlannerHNS::WayPoint& currState, const double& wheel_base);
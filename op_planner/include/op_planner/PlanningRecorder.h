@@ -0,0 +1,164 @@
+/// \file PlanningRecorder.h
+/// \brief Binary recording of the converted planner inputs and their replay through the planning modules, no ROS node needed
+/// \date Oct 14, 2026
+
+#ifndef PLANNINGRECORDER_H_
+#define PLANNINGRECORDER_H_
+
+#include "RoadNetwork.h"
+#include "PlannerCommonDef.h"
+#include "op_utility/StageTimer.h"
+#include <fstream>
+#include <memory>
+#include <mutex>
+
+namespace PlannerHNS
+{
+
+enum PLANNING_RECORD_TYPE {RECORD_MAP = 1, RECORD_EGO_STATE = 2, RECORD_DETECTED_OBJECTS = 3, RECORD_GLOBAL_PATHS = 4};
+
+/**
+ * @brief One recorded input, only the fields of its type are set
+ */
+class PlanningRecord
+{
+public:
+  PLANNING_RECORD_TYPE type;
+  timespec stamp;
+  unsigned long mapVersion; // RECORD_MAP, version of the live map
+  int mapIndex; // RECORD_MAP, index of the map snapshot file saved with the recording, -1 when maps are not saved
+  WayPoint pose; // RECORD_EGO_STATE
+  VehicleState vehicleState; // RECORD_EGO_STATE
+  std::vector<DetectedObject> objects; // RECORD_DETECTED_OBJECTS
+  std::vector<std::vector<WayPoint> > globalPaths; // RECORD_GLOBAL_PATHS
+
+  PlanningRecord()
+  {
+    type = RECORD_EGO_STATE;
+    stamp.tv_sec = 0;
+    stamp.tv_nsec = 0;
+    mapVersion = 0;
+    mapIndex = -1;
+  }
+};
+
+/**
+ * @brief Appends the planner inputs to a binary file, all values in the byte order of the writer:
+ * header (magic, format version, byte order mark), then records (type, stamp, payload size, payload).
+ * Doubles are written as is so the replay sees the same bits. Waypoints keep their values and ids, not their links;
+ * the map is recorded as its version when it changes and, when bSaveMaps is set, as a RoadNetworkSnapshot file next to the recording.
+ * Every Record function is thread safe and writes a whole record, a closed or failed recorder ignores them.
+ */
+class PlanningRecorder
+{
+public:
+  static const unsigned int FORMAT_VERSION = 1;
+
+  PlanningRecorder();
+  virtual ~PlanningRecorder();
+
+  bool Open(const std::string& fileName, const bool& bSaveMaps = true);
+  void Close();
+  bool IsOpen() const;
+
+  /**
+   * @brief Records the map only when its version differs from the last recorded one
+   */
+  void RecordMap(const timespec& stamp, const RoadNetwork& map);
+  void RecordEgoState(const timespec& stamp, const WayPoint& pose, const VehicleState& vehicleState);
+  void RecordDetectedObjects(const timespec& stamp, const std::vector<DetectedObject>& objects);
+  void RecordGlobalPaths(const timespec& stamp, const std::vector<std::vector<WayPoint> >& paths);
+
+  unsigned long GetNumberOfRecords() const;
+
+  /**
+   * @brief File of the map snapshot mapIndex of the recording fileName
+   */
+  static std::string GetMapFileName(const std::string& fileName, const int& mapIndex);
+
+private:
+  mutable std::mutex m_Mutex;
+  std::ofstream m_File;
+  std::string m_FileName;
+  std::string m_Buffer; // payload of the record being written
+  bool m_bSaveMaps;
+  bool m_bMapRecorded;
+  unsigned long m_LastMapVersion;
+  int m_nMaps;
+  unsigned long m_nRecords;
+
+  void WriteRecord(const PLANNING_RECORD_TYPE& type, const timespec& stamp);
+
+  PlanningRecorder(const PlanningRecorder&);
+  PlanningRecorder& operator=(const PlanningRecorder&);
+};
+
+class PlanningRecordReader
+{
+public:
+  PlanningRecordReader();
+  virtual ~PlanningRecordReader();
+
+  /**
+   * @brief false if the file is missing or is not a recording of this format version and byte order
+   */
+  bool Open(const std::string& fileName);
+  void Close();
+
+  /**
+   * @brief Next record of the file, false at the end of the file or at a truncated or damaged record
+   */
+  bool ReadNext(PlanningRecord& record);
+
+  static bool ReadAll(const std::string& fileName, std::vector<PlanningRecord>& records);
+
+private:
+  std::ifstream m_File;
+  std::string m_Buffer;
+};
+
+enum REPLAY_STAGE {REPLAY_PREDICTION, REPLAY_ROLL_OUTS, REPLAY_TRAJECTORY_COSTS, REPLAY_DECISION, REPLAY_CYCLE, REPLAY_STAGES_COUNT};
+
+/**
+ * @brief Feeds a recording to BehaviorPrediction and DecisionMaker. Each ego state record is one planning cycle:
+ * prediction of the last recorded objects, roll outs of the last recorded global paths, TrajectoryDynamicCosts and DecisionMaker,
+ * with dt the time between two ego states. The map of each map record is loaded from its snapshot file before the replay starts.
+ * The planning does not drive the ego, so two replays of the same recording give the same behaviors whatever their speed.
+ */
+class PlanningReplay
+{
+public:
+  PlanningParams m_Params;
+  ControllerParams m_CtrlParams;
+  CAR_BASIC_INFO m_CarInfo;
+  double m_SpeedFactor; // 1 replays at the recorded rate, 2 twice as fast, 0 as fast as possible
+  int m_nThreads; // TrajectoryDynamicCosts and BehaviorPrediction threads
+  std::vector<BehaviorState> m_Behaviors; // DecisionMaker output of each cycle of the last Run
+  std::vector<int> m_SelectedRollOuts; // TrajectoryDynamicCosts index of each cycle of the last Run
+
+  PlanningReplay();
+  virtual ~PlanningReplay();
+
+  /**
+   * @brief Read the recording and its map snapshots, false if the file can't be read, if a map snapshot is missing
+   * or if there is no map to replay on
+   */
+  bool Load(const std::string& fileName);
+
+  /**
+   * @brief Replay the loaded recording from its start, returns the number of planning cycles
+   */
+  int Run();
+
+  const std::vector<PlanningRecord>& GetRecords() const;
+  const UtilityHNS::StageLatencyRecorder& GetLatency() const;
+
+private:
+  std::vector<PlanningRecord> m_Records;
+  std::vector<std::shared_ptr<RoadNetwork> > m_Maps; // one per RECORD_MAP of m_Records
+  UtilityHNS::StageLatencyRecorder m_Latency;
+};
+
+} /* namespace PlannerHNS */
+
+#endif /* PLANNINGRECORDER_H_ */
@@ -0,0 +1,60 @@
+/// \file PolygonGeometry.h
+/// \brief Vectorized point in polygon, polygon overlap and polygon expansion for contours and safety borders
+/// \date Oct 14, 2026
+
+#ifndef POLYGONGEOMETRY_H_
+#define POLYGONGEOMETRY_H_
+
+#include "RoadNetwork.h"
+
+namespace PlannerHNS
+{
+
+/**
+ * @brief Polygon kernels used by the planner, the tracker and the costs, AVX2, SSE2 or NEON depending on the compile flags,
+ * with a scalar fallback. The batched point in polygon gives the same result as the scalar crossing test for every point.
+ */
+class PolygonGeometry
+{
+public:
+  /**
+   * @brief Crossing number test, 1 inside, 0 outside, -1 for an empty polygon
+   */
+  static int PointInsidePolygon(const std::vector<GPSPoint>& polygon, const GPSPoint& p);
+
+  /**
+   * @brief PointInsidePolygon of the points xs[0..n-1], ys[0..n-1], the results are written in inside[0..n-1]
+   */
+  static void PointsInsidePolygon(const std::vector<GPSPoint>& polygon, const double* xs, const double* ys, const int& n, int* inside);
+
+  static void PointsInsidePolygon(const std::vector<GPSPoint>& polygon, const std::vector<GPSPoint>& points, std::vector<int>& inside);
+
+  static void PointsInsidePolygon(const std::vector<GPSPoint>& polygon, const std::vector<WayPoint>& points, std::vector<int>& inside);
+
+  /**
+   * @brief Separating axis test of two convex polygons (any winding), touching polygons overlap. false if one of them is empty
+   */
+  static bool PolygonsOverlap(const std::vector<GPSPoint>& polygon_a, const std::vector<GPSPoint>& polygon_b);
+
+  /**
+   * @brief Move every edge of a convex polygon distance meters outward (inward when negative), vertices are kept on the edges miter
+   */
+  static void ExpandPolygon(const std::vector<GPSPoint>& polygon, const double& distance, std::vector<GPSPoint>& expanded);
+
+  /**
+   * @brief Corners of a width x length rectangle rotated by center.a around center, left bottom, right bottom, right top, left top
+   */
+  static void GetOrientedRectangle(const GPSPoint& center, const double& width, const double& length, const double& z, std::vector<GPSPoint>& rectangle);
+
+  /**
+   * @brief Name of the kernel selected at compile time, "avx2", "sse2", "neon" or "scalar"
+   */
+  static const char* GetKernelName();
+
+private:
+  static void GetProjectionRange(const double* xs, const double* ys, const int& n, const double& ax, const double& ay, double& min_p, double& max_p);
+};
+
+} /* namespace PlannerHNS */
+
+#endif /* POLYGONGEOMETRY_H_ */
@@ -0,0 +1,41 @@
+/// \file PolylineDistance.h
+/// \brief Vectorized closest vertex search of a point against a polyline stored as contiguous x, y arrays
+/// \date Oct 14, 2026
+
+#ifndef POLYLINEDISTANCE_H_
+#define POLYLINEDISTANCE_H_
+
+#include "PathSoA.h"
+
+namespace PlannerHNS
+{
+
+/**
+ * @brief Point to polyline distance kernels, AVX2, SSE2 or NEON depending on the compile flags, with a scalar fallback.
+ * All kernels return the same index as a scalar strict less than scan, the lowest index wins on ties.
+ */
+class PolylineDistance
+{
+public:
+  /**
+   * @brief Closest vertex among xs[0..n-1], ys[0..n-1] to (px, py)
+   * @return vertex index, -1 if n <= 0. min_d_sqr is the squared distance to it
+   */
+  static int GetClosestVertex(const double* xs, const double* ys, const int& n, const double& px, const double& py, double& min_d_sqr);
+
+  static int GetClosestVertexScalar(const double* xs, const double* ys, const int& n, const double& px, const double& py, double& min_d_sqr);
+
+  /**
+   * @brief Closest vertex of the polyline for each point
+   */
+  static void GetClosestVertices(const PathSoA& polyline, const std::vector<WayPoint>& points, std::vector<int>& indices, std::vector<double>& min_d_sqr);
+
+  /**
+   * @brief Name of the kernel selected at compile time, "avx2", "sse2", "neon" or "scalar"
+   */
+  static const char* GetKernelName();
+};
+
+} /* namespace PlannerHNS */
+
+#endif /* POLYLINEDISTANCE_H_ */
@@ -11,6 +11,7 @@
 #include <string>
 #include <vector>
 #include <sstream>
+#include <unordered_map>
 #include "op_utility/UtilityH.h"
 
 #define OPENPLANNER_ENABLE_LOGS
@@ -162,43 +163,10 @@ class PolygonShape
 public:
   std::vector<GPSPoint> points;
 
-  inline int PointInsidePolygon(const PolygonShape& polygon,const GPSPoint& p)
-  {
-    int counter = 0;
-      int i;
-      double xinters;
-      GPSPoint p1,p2;
-      int N = polygon.points.size();
-      if(N <=0 ) return -1;
-
-      p1 = polygon.points.at(0);
-      for (i=1;i<=N;i++)
-      {
-        p2 = polygon.points.at(i % N);
-
-        if (p.y > MIN(p1.y,p2.y))
-        {
-          if (p.y <= MAX(p1.y,p2.y))
-          {
-            if (p.x <= MAX(p1.x,p2.x))
-            {
-              if (p1.y != p2.y)
-              {
-                xinters = (p.y-p1.y)*(p2.x-p1.x)/(p2.y-p1.y)+p1.x;
-                if (p1.x == p2.x || p.x <= xinters)
-                  counter++;
-              }
-            }
-          }
-        }
-        p1 = p2;
-      }
-
-      if (counter % 2 == 0)
-        return 0;
-      else
-        return 1;
-  }
+  /**
+   * @brief 1 if p is inside polygon, 0 outside, -1 for an empty polygon (PolygonGeometry::PointInsidePolygon)
+   */
+  int PointInsidePolygon(const PolygonShape& polygon,const GPSPoint& p);
 };
 
 class MapItem
@@ -749,6 +717,94 @@ public:
 
 };
 
+/**
+ * Uniform grid over all lane waypoints of a RoadNetwork, built once after the map is constructed.
+ * Entries keep (segment, lane, point) indices instead of pointers, so a copied RoadNetwork keeps a valid index.
+ */
+class MapSpatialIndex
+{
+public:
+  class Entry
+  {
+  public:
+    double x;
+    double y;
+    int iSegment;
+    int iLane;
+    int iPoint;
+  };
+
+  double cell_size;
+  std::vector<Entry> entries; // grouped by cell, map order inside each cell
+  std::unordered_map<long long, std::pair<int, int> > cells; // cell key -> [first entry, last entry)
+
+  MapSpatialIndex()
+  {
+    cell_size = 4.0;
+  }
+
+  bool IsBuilt() const
+  {
+    return entries.size() > 0;
+  }
+
+  void Clear()
+  {
+    entries.clear();
+    cells.clear();
+  }
+
+  void Build(const std::vector<RoadSegment>& segments, const double& cellSize = 4.0);
+
+  /**
+   * @brief Collect the entries of every cell overlapping the square [p - radius, p + radius], no exact distance filtering.
+   */
+  void GetCandidates(const GPSPoint& p, const double& radius, std::vector<const Entry*>& candidates) const;
+
+  long long GetCellKey(const double& x, const double& y) const;
+  long long GetCellKey(const long long& ix, const long long& iy) const;
+};
+
+/**
+ * Hash indexes from lane id and waypoint id to their (segment, lane, point) indices, for the id lookups used while the map is linked.
+ * IsValid only compares the number of segments and lanes, the MappingHelpers lookups check the id found at the location
+ * and fall back to the linear scan when it does not match or the id is not indexed.
+ */
+class MapIdIndex
+{
+public:
+  class Location
+  {
+  public:
+    int iSegment;
+    int iLane;
+    int iPoint;
+  };
+
+  std::unordered_map<int, std::vector<Location> > lanes; // every lane with the id, map order, iPoint is -1
+  std::unordered_map<int, std::vector<Location> > waypoints; // every waypoint with the id, map order
+  unsigned int nSegments;
+  unsigned int nLanes;
+
+  MapIdIndex()
+  {
+    nSegments = 0;
+    nLanes = 0;
+  }
+
+  void Clear()
+  {
+    lanes.clear();
+    waypoints.clear();
+    nSegments = 0;
+    nLanes = 0;
+  }
+
+  void Build(const std::vector<RoadSegment>& segments);
+
+  bool IsValid(const std::vector<RoadSegment>& segments) const;
+};
+
 class RoadNetwork
 {
 public:
@@ -760,6 +816,15 @@ public:
   std::vector<Crossing> crossings;
   std::vector<Marking> markings;
   std::vector<TrafficSign> signs;
+
+  MapSpatialIndex spatialIndex;
+  MapIdIndex idIndex;
+  unsigned long version; // new value every time the map is built or its costs change, 0 for maps never versioned
+
+  RoadNetwork()
+  {
+    version = 0;
+  }
 };
 
 class VehicleState : public ObjTimeStamp
@@ -821,7 +886,7 @@ public:
   std::vector<WayPoint> centers_list;
   std::vector<GPSPoint> contour;
   std::vector<std::vector<WayPoint> > predTrajectories;
-  std::vector<WayPoint*> pClosestWaypoints;
+  std::vector<const WayPoint*> pClosestWaypoints;
   double w;
   double l;
   double h;
@@ -909,6 +974,7 @@ public:
   bool   enableStopSignBehavior;
 
   bool   enabTrajectoryVelocities;
+  bool   enableIncrementalRollOuts; // shift the previous roll outs while the center line does not change
   double minIndicationDistance;
 
   PlanningParams()
@@ -948,6 +1014,7 @@ public:
     enableLaneChange         = false;
     enableStopSignBehavior      = false;
     enabTrajectoryVelocities     = false;
+    enableIncrementalRollOuts    = false;
     minIndicationDistance      = 15;
   }
 };
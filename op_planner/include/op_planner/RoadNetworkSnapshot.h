@@ -0,0 +1,46 @@
+/// \file RoadNetworkSnapshot.h
+/// \brief Versioned binary snapshot of a fully linked RoadNetwork, pointers are stored as indices and resolved at load time
+/// \date Oct 14, 2026
+
+#ifndef ROADNETWORKSNAPSHOT_H_
+#define ROADNETWORKSNAPSHOT_H_
+
+#include "RoadNetwork.h"
+
+namespace PlannerHNS
+{
+
+/**
+ * @brief Snapshot file layout, all values in the byte order of the writer:
+ * header (magic, format version, byte order mark, source signature, payload size),
+ * shape (number of segments, lanes per segment and points per lane), then the segments, lanes and waypoints records
+ * followed by the map level traffic lights, stop lines, curbs, boundaries, crossings, markings and signs.
+ * Links to segments, lanes and waypoints are indices in map order (segment, lane, point), -1 for null or for pointers out of the map.
+ * The loader sizes every container from the shape first, so each link is resolved while its record is read.
+ */
+class RoadNetworkSnapshot
+{
+public:
+  static const unsigned int FORMAT_VERSION = 1;
+
+  /**
+   * @brief Write map to fileName (through a temporary file and a rename), sourceSignature identifies the data the map was built from
+   */
+  static bool SaveToFile(const std::string& fileName, const RoadNetwork& map, const unsigned long long& sourceSignature);
+
+  /**
+   * @brief Replace map with the snapshot in fileName, false (map unchanged) if the file is missing, damaged,
+   * of another format version or byte order, or written for another sourceSignature.
+   * The spatial and id indexes are rebuilt and the map gets a new version.
+   */
+  static bool LoadFromFile(const std::string& fileName, const unsigned long long& sourceSignature, RoadNetwork& map);
+
+  /**
+   * @brief Hash of the names, sizes and modification times of the files, missing files are part of the hash too
+   */
+  static unsigned long long GetFilesSignature(const std::vector<std::string>& fileNames);
+};
+
+} /* namespace PlannerHNS */
+
+#endif /* ROADNETWORKSNAPSHOT_H_ */
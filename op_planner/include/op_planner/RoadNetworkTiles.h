@@ -0,0 +1,121 @@
+/// \file RoadNetworkTiles.h
+/// \brief Tiled storage of a RoadNetwork, only the tiles around the ego pose are kept in memory and linked into the active map
+/// \date Oct 14, 2026
+
+#ifndef ROADNETWORKTILES_H_
+#define ROADNETWORKTILES_H_
+
+#include "RoadNetwork.h"
+#include <map>
+#include <set>
+#include <future>
+
+namespace PlannerHNS
+{
+
+/**
+ * @brief Square tiles of a built map. Each tile is a RoadNetworkSnapshot file with the lanes (grouped by their road segment id)
+ * and the map objects whose middle point falls inside it, the catalog file lists the tiles and the tile of every lane.
+ * The active map holds the tiles within the load radius of the ego pose, every time that set changes the active map is rebuilt
+ * from the tiles in memory and all the links are resolved again from the ids. Links leaving the active tiles stay null
+ * until the tile they point to is activated. Tiles farther than the evict radius (load radius + tile size) are dropped from memory.
+ */
+class RoadNetworkTiles
+{
+public:
+  static const unsigned int FORMAT_VERSION = 1;
+
+  RoadNetworkTiles();
+  virtual ~RoadNetworkTiles();
+
+  /**
+   * @brief Split map in tiles of tileSize meters, the tile files and the catalog are written in folder (path ends with /)
+   */
+  static bool WriteTiles(const RoadNetwork& map, const double& tileSize, const std::string& folder);
+
+  /**
+   * @brief Reset every pointer of map and resolve them again from the lane and waypoint ids, links to missing lanes stay null.
+   * The spatial and id indexes are rebuilt and the map gets a new version.
+   */
+  static void RelinkFromIds(RoadNetwork& map);
+
+  /**
+   * @brief Read the catalog written by WriteTiles, no tile is loaded yet
+   */
+  bool Open(const std::string& folder);
+  void Close();
+  bool IsOpen() const;
+
+  void SetLoadRadius(const double& radius);
+  double GetLoadRadius() const;
+  double GetTileSize() const;
+
+  /**
+   * @brief Activate the tiles within the load radius of pose and evict the distant ones.
+   * map is rebuilt only when the active tiles changed, returns true in that case.
+   */
+  bool UpdateActiveTiles(const WayPoint& pose, RoadNetwork& map);
+
+  /**
+   * @brief Load in the background the tiles within the load radius of path that are not in memory,
+   * they are kept until the next prefetch or until they fall outside the evict radius of the pose.
+   */
+  void PrefetchAlongPath(const std::vector<WayPoint>& path);
+
+  /**
+   * @brief Block until the background loads are done
+   */
+  void WaitForPrefetch();
+
+  /**
+   * @brief Follow a link out of the active tiles, the tile of laneId is loaded if needed, activated and map rebuilt.
+   * false if the lane is not in the catalog. The tile stays active until the pose moves out of its evict radius.
+   */
+  bool ActivateLaneTile(const int& laneId, RoadNetwork& map);
+
+  bool IsLaneActive(const int& laneId) const;
+  unsigned int GetNumberOfTiles() const;
+  unsigned int GetNumberOfLoadedTiles() const;
+  unsigned int GetNumberOfActiveTiles() const;
+
+private:
+  class Tile
+  {
+  public:
+    int ix;
+    int iy;
+    std::string fileName;
+    bool bLoaded;
+    RoadNetwork map;
+    std::future<bool> loading; // valid while the tile is loaded in the background
+
+    Tile()
+    {
+      ix = 0;
+      iy = 0;
+      bLoaded = false;
+    }
+  };
+
+  std::string m_Folder;
+  double m_TileSize;
+  double m_LoadRadius;
+  std::map<long long, Tile> m_Tiles;
+  std::unordered_map<int, long long> m_LaneTiles;
+  std::set<long long> m_ActiveTiles;
+  std::set<long long> m_LinkedTiles; // activated through ActivateLaneTile
+  std::set<long long> m_PrefetchTiles;
+  unsigned long m_ActiveMapVersion;
+
+  static long long GetTileKey(const int& ix, const int& iy);
+  static std::string GetCatalogFileName(const std::string& folder);
+  void GetTilesInRadius(const GPSPoint& p, const double& radius, std::set<long long>& keys) const;
+  double GetDistanceToTile(const GPSPoint& p, const Tile& tile) const;
+  bool LoadTile(Tile& tile);
+  void EvictTiles(const GPSPoint& p);
+  void BuildActiveMap(RoadNetwork& map);
+};
+
+} /* namespace PlannerHNS */
+
+#endif /* ROADNETWORKTILES_H_ */
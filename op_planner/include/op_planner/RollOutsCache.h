@@ -0,0 +1,132 @@
+/// \file RollOutsCache.h
+/// \brief Roll outs of the previous planning cycle kept for the incremental roll out generation
+/// \date Oct 14, 2026
+
+#ifndef ROLLOUTSCACHE_H_
+#define ROLLOUTSCACHE_H_
+
+#include "RoadNetwork.h"
+#include <math.h>
+
+namespace PlannerHNS
+{
+
+#define ROLL_OUTS_MAX_SHIFT_RATIO 0.5 // of carTipMargin, distance the car can move from the last full generation before the next one
+#define ROLL_OUTS_MAX_LATERAL_SHIFT 0.1 // meters, change of the car lateral offset that forces a full generation
+#define ROLL_OUTS_TAIL_OVERLAP 10 // already smoothed points smoothed again with the new tail
+
+/**
+ * @brief Parts of the roll outs that do not change between cycles: the end lateral offset of each roll out, rebuilt when
+ * rollOutNumber or rollOutDensity change, and the unit normals (cos and sin of heading + pi/2) of the center points,
+ * rebuilt when a center heading changes. The roll out points are center + offset*normal, so the trigonometry runs once per center point.
+ */
+class RollOutsTemplate
+{
+public:
+  std::vector<double> endLaterals; // rollOutDensity*(i - rollOutNumber/2)
+  std::vector<double> normalX;
+  std::vector<double> normalY;
+  int rollOutNumber;
+  double rollOutDensity;
+  std::vector<double> centerHeadings; // headings the normals were computed from
+
+  unsigned int nBuilds; // end laterals builds
+  unsigned int nCenterBuilds; // normals builds
+
+  RollOutsTemplate()
+  {
+    rollOutNumber = -1;
+    rollOutDensity = 0;
+    nBuilds = 0;
+    nCenterBuilds = 0;
+  }
+
+  void SetParams(const int& number, const double& density)
+  {
+    if(number == rollOutNumber && density == rollOutDensity && (int)endLaterals.size() == number+1) return;
+
+    rollOutNumber = number;
+    rollOutDensity = density;
+    int centralTrajectoryIndex = number/2;
+    endLaterals.resize(number+1);
+    for(int i=0; i< number+1; i++)
+      endLaterals.at(i) = density*(i - centralTrajectoryIndex);
+    nBuilds++;
+  }
+
+  void SetCenter(const std::vector<WayPoint>& center)
+  {
+    bool bSame = center.size() == centerHeadings.size();
+    for(unsigned int j = 0; j < center.size() && bSame; j++)
+      bSame = center.at(j).pos.a == centerHeadings.at(j);
+    if(bSame) return;
+
+    centerHeadings.resize(center.size());
+    normalX.resize(center.size());
+    normalY.resize(center.size());
+    for(unsigned int j = 0; j < center.size(); j++)
+    {
+      centerHeadings.at(j) = center.at(j).pos.a;
+      normalX.at(j) = cos(center.at(j).pos.a + M_PI_2);
+      normalY.at(j) = sin(center.at(j).pos.a + M_PI_2);
+    }
+    nCenterBuilds++;
+  }
+};
+
+/**
+ * @brief Smoothed roll outs generated for one center line, point k of every roll out comes from center point iStart + k.
+ * The center line is identified by its size and end points, any other center line forces a full generation.
+ */
+class RollOutsCache
+{
+public:
+  std::vector<std::vector<WayPoint> > rollOuts;
+  int iStart; // center index of the first roll out point
+  int iEnd; // center index of the last roll out point
+  int iAnchorStart; // iStart of the last full generation
+  int iAnchorFar; // center index where the roll in of the last full generation ends
+  double anchorLateral; // car lateral offset at the last full generation
+  int rollOutNumber;
+  double rollOutDensity;
+  unsigned int centerSize;
+  GPSPoint centerFront;
+  GPSPoint centerBack;
+  bool bValid;
+
+  unsigned int nShifts; // cycles served by shifting the cached roll outs
+  unsigned int nGenerations; // full generations
+
+  std::vector<WayPoint> tail; // smoothing scratch
+  RollOutsTemplate offsets;
+
+  RollOutsCache()
+  {
+    iStart = iEnd = 0;
+    iAnchorStart = iAnchorFar = 0;
+    anchorLateral = 0;
+    rollOutNumber = 0;
+    rollOutDensity = 0;
+    centerSize = 0;
+    bValid = false;
+    nShifts = 0;
+    nGenerations = 0;
+  }
+
+  void Reset()
+  {
+    rollOuts.clear();
+    bValid = false;
+  }
+
+  bool IsSameCenter(const std::vector<WayPoint>& center) const
+  {
+    return center.size() == centerSize && center.size() > 0
+        && center.front().pos.x == centerFront.x && center.front().pos.y == centerFront.y
+        && center.back().pos.x == centerBack.x && center.back().pos.y == centerBack.y;
+  }
+};
+
+} /* namespace PlannerHNS */
+
+#endif /* ROLLOUTSCACHE_H_ */
@@ -0,0 +1,100 @@
+/// \file RouteCache.h
+/// \brief Least recently used cache of global plans, keyed on the start and goal map waypoints and the map version
+/// \date Oct 14, 2026
+
+#ifndef ROUTECACHE_H_
+#define ROUTECACHE_H_
+
+#include "RoadNetwork.h"
+#include <list>
+
+namespace PlannerHNS
+{
+
+class RouteCacheKey
+{
+public:
+  const RoadNetwork* pMap;
+  unsigned long mapVersion;
+  int startLaneId;
+  int startWaypointId;
+  int goalLaneId;
+  int goalWaypointId;
+  double maxPlanningDistance;
+  bool bEnableLaneChange;
+  int searchType;
+  double fallbackGoalDistance;
+  std::vector<int> globalPath;
+
+  RouteCacheKey()
+  {
+    pMap = nullptr;
+    mapVersion = 0;
+    startLaneId = 0;
+    startWaypointId = 0;
+    goalLaneId = 0;
+    goalWaypointId = 0;
+    maxPlanningDistance = 0;
+    bEnableLaneChange = false;
+    searchType = 0;
+    fallbackGoalDistance = 0;
+  }
+
+  bool operator==(const RouteCacheKey& key) const
+  {
+    return pMap == key.pMap && mapVersion == key.mapVersion
+        && startLaneId == key.startLaneId && startWaypointId == key.startWaypointId
+        && goalLaneId == key.goalLaneId && goalWaypointId == key.goalWaypointId
+        && maxPlanningDistance == key.maxPlanningDistance && bEnableLaneChange == key.bEnableLaneChange
+        && searchType == key.searchType && fallbackGoalDistance == key.fallbackGoalDistance
+        && globalPath == key.globalPath;
+  }
+};
+
+/**
+ * @brief Keeps the last capacity extracted plans. Entries of a map with an older version than the looked up key are dropped
+ * on Find, so any map change that updates RoadNetwork::version invalidates them. The cached waypoints point into the map.
+ */
+class RouteCache
+{
+public:
+  unsigned long m_nHits;
+  unsigned long m_nMisses;
+
+  RouteCache(const unsigned int& capacity = 16);
+  virtual ~RouteCache();
+
+  /**
+   * @brief Set the number of plans to keep, 0 disables the cache
+   */
+  void SetCapacity(const unsigned int& capacity);
+  unsigned int GetCapacity() const;
+  unsigned int GetSize() const;
+  void Clear();
+
+  /**
+   * @brief Copy the cached plan into paths and mark it as the most recently used, false if the key is not cached
+   */
+  bool Find(const RouteCacheKey& key, std::vector<std::vector<WayPoint> >& paths, double& totalDistance);
+
+  /**
+   * @brief Add or replace the plan of key, the least recently used plan is dropped when the cache is full
+   */
+  void Insert(const RouteCacheKey& key, const std::vector<std::vector<WayPoint> >& paths, const double& totalDistance);
+
+private:
+  class Entry
+  {
+  public:
+    RouteCacheKey key;
+    std::vector<std::vector<WayPoint> > paths;
+    double totalDistance;
+  };
+
+  std::list<Entry> m_Entries; // most recently used first
+  unsigned int m_Capacity;
+};
+
+} /* namespace PlannerHNS */
+
+#endif /* ROUTECACHE_H_ */
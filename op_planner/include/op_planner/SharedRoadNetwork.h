@@ -0,0 +1,63 @@
+/// \file SharedRoadNetwork.h
+/// \brief One read only RoadNetwork per process shared by the planners, replaced as a whole when a new map arrives
+/// \date Oct 14, 2026
+
+#ifndef SHAREDROADNETWORK_H_
+#define SHAREDROADNETWORK_H_
+
+#include "RoadNetwork.h"
+#include <atomic>
+#include <memory>
+
+namespace PlannerHNS
+{
+
+typedef std::shared_ptr<const RoadNetwork> RoadNetworkSnapshotPtr;
+
+/**
+ * @brief Holder of the current map snapshot. Publish moves a finalised map into a new snapshot and swaps it in atomically,
+ * the old snapshot lives until its last reader releases it, so a planner can finish its cycle on the map it started with.
+ * Readers keep their own RoadNetworkSnapshotPtr and call Update once per cycle, it only reads an atomic version number
+ * unless the map has changed. Snapshots are never modified after Publish.
+ */
+class SharedRoadNetwork
+{
+public:
+  SharedRoadNetwork();
+  virtual ~SharedRoadNetwork();
+
+  /**
+   * @brief Map shared by all the components of this process
+   */
+  static SharedRoadNetwork& GetProcessMap();
+
+  /**
+   * @brief Take the content of map (left empty) as the new snapshot, with a new version, returns that version
+   */
+  unsigned long Publish(RoadNetwork& map);
+
+  /**
+   * @brief Current snapshot, empty pointer before the first Publish
+   */
+  RoadNetworkSnapshotPtr GetSnapshot() const;
+
+  /**
+   * @brief Replace pMap with the current snapshot when it is not the same map, returns true if pMap changed
+   */
+  bool Update(RoadNetworkSnapshotPtr& pMap) const;
+
+  unsigned long GetVersion() const;
+
+  void Clear();
+
+private:
+  RoadNetworkSnapshotPtr m_pMap; // only accessed through std::atomic_load / std::atomic_store
+  std::atomic<unsigned long> m_Version;
+
+  SharedRoadNetwork(const SharedRoadNetwork&);
+  SharedRoadNetwork& operator=(const SharedRoadNetwork&);
+};
+
+} /* namespace PlannerHNS */
+
+#endif /* SHAREDROADNETWORK_H_ */
@@ -32,6 +32,7 @@ public:
   double m_SimulationSteeringDelayFactor; //second , time that every degree change in the steering wheel takes
   timespec m_SteerDelayTimer;
   PlannerHNS::TrajectoryDynamicCosts m_TrajectoryCostsCalculator;
+  std::vector<RollOutsCache> m_RollOutsCaches; // one per m_TotalPath, used when m_params.enableIncrementalRollOuts
 
   void ReInitializePlanner(const WayPoint& start_pose);
   void InitPolygons();
@@ -11,6 +11,7 @@
 #include "RoadNetwork.h"
 #include "PlannerCommonDef.h"
 #include "PlanningHelpers.h"
+#include "ContourCorridor.h"
 
 using namespace std;
 
@@ -40,14 +41,22 @@ public:
   double m_WeightLat;
   double m_WeightLaneChange;
   double m_LateralSkipDistance;
+  bool m_bUseContourCorridor; // drop the contour points out of the paths corridor before the cost loop
+  unsigned int m_nCulledContourPoints; // contour points dropped in the last step
 
 
 
 private:
+  ContourCorridor m_ContourCorridor;
+  vector<WayPoint> m_CorridorContourPoints;
+  vector<int> m_ContourInsideSafetyBorder;
+
   bool ValidateRollOutsInput(const vector<vector<vector<WayPoint> > >& rollOuts);
   vector<TrajectoryCost> CalculatePriorityAndLaneChangeCosts(const vector<vector<WayPoint> >& laneRollOuts, const int& lane_index, const PlanningParams& params);
   void NormalizeCosts(vector<TrajectoryCost>& trajectoryCosts);
   void CalculateLateralAndLongitudinalCosts(vector<TrajectoryCost>& trajectoryCosts, const vector<vector<vector<WayPoint> > >& rollOuts, const vector<vector<WayPoint> >& totalPaths, const WayPoint& currState, const vector<WayPoint>& contourPoints, const PlanningParams& params, const CAR_BASIC_INFO& carInfo, const VehicleState& vehicleState);
+  void AddToContourCorridor(const vector<WayPoint>& totalPath, const WayPoint& currState, const PlanningParams& params, const CAR_BASIC_INFO& carInfo);
+  const vector<WayPoint>& FilterContourPoints(const PlanningParams& params);
   void CalculateTransitionCosts(vector<TrajectoryCost>& trajectoryCosts, const int& currTrajectoryIndex, const PlanningParams& params);
 };
 
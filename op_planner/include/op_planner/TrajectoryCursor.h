@@ -0,0 +1,84 @@
+/// \file TrajectoryCursor.h
+/// \brief Warm started closest point search on a trajectory, caches the last match and the cumulative arc length
+/// \date Oct 14, 2026
+
+#ifndef TRAJECTORYCURSOR_H_
+#define TRAJECTORYCURSOR_H_
+
+#include "RoadNetwork.h"
+
+namespace PlannerHNS
+{
+
+/**
+ * @brief Keeps the state of repeated closest point queries on the same trajectory.
+ * Each query searches a bounded window around the last matched index, and falls back to a full scan
+ * on the first query, after the trajectory changes, or when the window minimum lies on the window border.
+ * The cumulative arc length is built once per trajectory so distances on it are O(1).
+ * The point coordinates are copied to contiguous x, y arrays so the distance scans run on the PolylineDistance kernel.
+ * One cursor should follow one trajectory and one moving query point (the car, or one object).
+ */
+class TrajectoryCursor
+{
+public:
+  int m_SearchWindow; // number of points searched before and after the last match
+  int m_LastIndex; // closest point index of the last query, before the next point correction
+  std::vector<double> m_CumulativeDistance; // arc length from the first point to each point
+  unsigned long m_nWindowHits;
+  unsigned long m_nFullScans;
+
+  TrajectoryCursor(const int& searchWindow = 20);
+  virtual ~TrajectoryCursor();
+
+  /**
+   * @brief Forget the last match and the cached arc length, call it when the trajectory is replaced in place
+   */
+  void Reset();
+
+  /**
+   * @brief Rebuild the cached arc length if the trajectory is not the one seen last time
+   * @return true if the cache was rebuilt
+   */
+  bool Sync(const std::vector<WayPoint>& trajectory);
+
+  /**
+   * @brief Same result contract as PlanningHelpers::GetClosestNextPointIndexFast, warm started from the last match
+   */
+  int GetClosestNextPointIndex(const std::vector<WayPoint>& trajectory, const WayPoint& p);
+
+  /**
+   * @brief Same result contract as PlanningHelpers::GetClosestNextPointIndexDirectionFast, warm started from the last match
+   */
+  int GetClosestNextPointIndexDirection(const std::vector<WayPoint>& trajectory, const WayPoint& p);
+
+  /**
+   * @brief Same result contract as PlanningHelpers::GetRelativeInfo, warm started from the last match
+   */
+  bool GetRelativeInfo(const std::vector<WayPoint>& trajectory, const WayPoint& p, RelativeInfo& info);
+
+  /**
+   * @brief Same result as PlanningHelpers::GetExactDistanceOnTrajectory using the cached arc length
+   */
+  double GetExactDistanceOnTrajectory(const std::vector<WayPoint>& trajectory, const RelativeInfo& p1, const RelativeInfo& p2);
+
+  /**
+   * @brief Arc length between two points of the trajectory, negative if to_index is behind from_index
+   */
+  double GetDistanceBetweenIndices(const std::vector<WayPoint>& trajectory, const int& from_index, const int& to_index);
+
+private:
+  const WayPoint* m_pData;
+  unsigned int m_Size;
+  GPSPoint m_First;
+  GPSPoint m_Middle;
+  GPSPoint m_Last;
+  std::vector<double> m_X;
+  std::vector<double> m_Y;
+
+  int FullScan(const std::vector<WayPoint>& trajectory, const WayPoint& p, const bool& bDirection, double& minD);
+  int CorrectToNextPoint(const std::vector<WayPoint>& trajectory, const WayPoint& p, const int& min_index, const int& max_index);
+};
+
+} /* namespace PlannerHNS */
+
+#endif /* TRAJECTORYCURSOR_H_ */
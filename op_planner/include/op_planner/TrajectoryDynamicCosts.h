@@ -11,6 +11,12 @@
 #include "RoadNetwork.h"
 #include "PlannerCommonDef.h"
 #include "PlanningHelpers.h"
+#include "ContourCorridor.h"
+#include "TrajectoryCursor.h"
+#include "PathSoA.h"
+#include "ObjectOccupancyGrid.h"
+#include "op_utility/TaskScheduler.h"
+#include <memory>
 
 using namespace std;
 
@@ -35,6 +41,24 @@ public:
       const WayPoint& currState, const PlanningParams& params, const CAR_BASIC_INFO& carInfo, const VehicleState& vehicleState,
       const std::vector<PlannerHNS::DetectedObject>& obj_list, const int& iCurrentIndex = -1);
 
+  /**
+   * @brief Evaluate the roll outs of DoOneStep and DoOneStepStatic on nThreads threads (the caller included).
+   * Each roll out accumulates its own TrajectoryCost in the same order as the sequential loop, so the result is bit identical.
+   * nThreads <= 1 goes back to the sequential evaluation.
+   */
+  void SetNumberOfThreads(const int& nThreads);
+
+  /**
+   * @brief DoOneStepDynamic mode, the moving objects are evaluated after the static ones, nearest first (by a lower bound of the
+   * distance along the path of any collision with their predicted trajectories). A blocked roll out stops at the first object
+   * that can't be closer than its closest collision, objects that can't collide before minFollowingDistance are skipped.
+   * bBlocked and closest_obj_distance are the same as the full evaluation, closest_obj_velocity comes from the closest collision
+   * instead of the last object in the list and m_CollisionPoints only has the evaluated collisions.
+   */
+  void SetNearestObjectsFirst(const bool& bNearestFirst);
+
+  unsigned long m_nSkippedObjectChecks; // object and roll out pairs not evaluated in the nearest objects first mode
+
 public:
   int m_PrevCostIndex;
   int m_PrevIndex;
@@ -50,24 +74,59 @@ public:
   double m_WeightLaneChange;
   double m_LateralSkipDistance;
   double m_CollisionTimeDiff;
+  bool m_bUseContourCorridor; // drop the contour points out of the paths corridor before the cost loop
+  unsigned int m_nCulledContourPoints; // contour points dropped in the last step
+  bool m_bUseOccupancyGrid; // check the roll outs against a grid of the predicted points of each moving object, same collisions as the full scan
 
 
 
 private:
+  vector<PathSoA> m_RollOutsSoA;
+  ContourCorridor m_ContourCorridor;
+  vector<WayPoint> m_CorridorContourPoints;
+  vector<int> m_ContourInsideSafetyBorder;
+  bool m_bNearestObjectsFirst;
+  vector<int> m_DynamicObjects;
+  vector<std::pair<double, int> > m_DynamicObjectsOrder; // collision distance lower bound, object index
+  vector<vector<WayPoint> > m_RollOutCollisionPoints;
+  vector<unsigned long> m_RollOutSkippedChecks;
+  vector<ObjectOccupancyGrid> m_ObjectGrids; // one per moving object of the current step
+  int m_nThreads; // at most, on the shared task scheduler
+
+  /**
+   * @brief DoOneStepDynamic on the PathSoA copies of the roll outs, the public version copies them to m_RollOutsSoA (its memory is reused)
+   */
+  TrajectoryCost DoOneStepDynamic(const vector<vector<WayPoint> >& rollOuts, const vector<PathSoA>& rollOutsSoA, const vector<WayPoint>& totalPaths,
+      const WayPoint& currState, const PlanningParams& params, const CAR_BASIC_INFO& carInfo, const VehicleState& vehicleState,
+      const std::vector<PlannerHNS::DetectedObject>& obj_list, const int& iCurrentIndex);
+
+  void RunRollOutTasks(const int& nTasks, const std::function<void(const int&)>& task);
+
   bool ValidateRollOutsInput(const vector<vector<vector<WayPoint> > >& rollOuts);
   vector<TrajectoryCost> CalculatePriorityAndLaneChangeCosts(const vector<vector<WayPoint> >& laneRollOuts, const int& lane_index, const PlanningParams& params);
   void NormalizeCosts(vector<TrajectoryCost>& trajectoryCosts);
   void CalculateLateralAndLongitudinalCosts(vector<TrajectoryCost>& trajectoryCosts, const vector<vector<vector<WayPoint> > >& rollOuts, const vector<vector<WayPoint> >& totalPaths, const WayPoint& currState, const vector<WayPoint>& contourPoints, const PlanningParams& params, const CAR_BASIC_INFO& carInfo, const VehicleState& vehicleState);
   void CalculateLateralAndLongitudinalCostsStatic(vector<TrajectoryCost>& trajectoryCosts, const vector<vector<WayPoint> >& rollOuts, const vector<WayPoint>& totalPaths, const WayPoint& currState, const vector<WayPoint>& contourPoints, const PlanningParams& params, const CAR_BASIC_INFO& carInfo, const VehicleState& vehicleState);
+  void AddToContourCorridor(const vector<WayPoint>& totalPath, const WayPoint& currState, const PlanningParams& params, const CAR_BASIC_INFO& carInfo);
+  const vector<WayPoint>& FilterContourPoints(const PlanningParams& params);
   void CalculateTransitionCosts(vector<TrajectoryCost>& trajectoryCosts, const int& currTrajectoryIndex, const PlanningParams& params);
+  void CalculateContourRelativeInfo(TrajectoryCursor& path_cursor, const vector<WayPoint>& totalPaths, const RelativeInfo& car_info,
+      const vector<WayPoint>& contourPoints, vector<RelativeInfo>& contour_info, vector<double>& contour_long_dist);
+  void CalculateRollOutContourCosts(TrajectoryCost& trajectoryCost, const vector<WayPoint>& contourPoints, const vector<RelativeInfo>& contour_info,
+      const vector<double>& contour_long_dist, const vector<int>& contour_inside, const PlanningParams& params, const CAR_BASIC_INFO& carInfo, const double& c_lateral_d, const double& c_long_front_d);
   
   void CalculateIntersectionVelocities(const std::vector<WayPoint>& path, const DetectedObject& obj, const WayPoint& currPose, const CAR_BASIC_INFO& carInfo, const double& c_lateral_d, WayPoint& collisionPoint, TrajectoryCost& trajectoryCosts);
+  void CalculateIntersectionVelocities(const std::vector<WayPoint>& path, const PathSoA& path_soa, const DetectedObject& obj, const WayPoint& currPose, const CAR_BASIC_INFO& carInfo, const double& c_lateral_d, WayPoint& collisionPoint, TrajectoryCost& trajectoryCosts);
+  void CalculateIntersectionVelocities(const std::vector<WayPoint>& path, const ObjectOccupancyGrid& grid, const DetectedObject& obj, const WayPoint& currPose, const double& c_lateral_d, WayPoint& collisionPoint, TrajectoryCost& trajectoryCosts);
   int GetCurrentRollOutIndex(const std::vector<WayPoint>& path, const WayPoint& currState, const PlanningParams& params);
   void InitializeCosts(const vector<vector<WayPoint> >& rollOuts, const PlanningParams& params);
   void InitializeSafetyPolygon(const WayPoint& currState, const CAR_BASIC_INFO& carInfo, const VehicleState& vehicleState, const double& c_lateral_d, const double& c_long_front_d, const double& c_long_back_d);
-  void CalculateLateralAndLongitudinalCostsDynamic(const std::vector<PlannerHNS::DetectedObject>& obj_list, const vector<vector<WayPoint> >& rollOuts, const vector<WayPoint>& totalPaths,
+  void CalculateLateralAndLongitudinalCostsDynamic(const std::vector<PlannerHNS::DetectedObject>& obj_list, const vector<vector<WayPoint> >& rollOuts, const vector<PathSoA>& rollOutsSoA, const vector<WayPoint>& totalPaths,
       const WayPoint& currState, const PlanningParams& params, const CAR_BASIC_INFO& carInfo,
       const VehicleState& vehicleState, const double& c_lateral_d, const double& c_long_front_d, const double& c_long_back_d );
+  void CalculateDynamicCostsNearestFirst(const std::vector<PlannerHNS::DetectedObject>& obj_list, const vector<vector<WayPoint> >& rollOuts, const vector<PathSoA>& rollOutsSoA,
+      const vector<WayPoint>& totalPaths, TrajectoryCursor& path_cursor, const RelativeInfo& car_info, const WayPoint& currState, const PlanningParams& params,
+      const CAR_BASIC_INFO& carInfo, const double& c_lateral_d, const double& c_long_front_d);
 
 };
 
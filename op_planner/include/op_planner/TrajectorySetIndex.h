@@ -0,0 +1,87 @@
+/// \file TrajectorySetIndex.h
+/// \brief Bounding volume hierarchy over the segments of a set of trajectories, for closest point queries in logarithmic time
+/// \date Oct 14, 2026
+
+#ifndef TRAJECTORYSETINDEX_H_
+#define TRAJECTORYSETINDEX_H_
+
+#include "RoadNetwork.h"
+
+namespace PlannerHNS
+{
+
+/**
+ * @brief Built once for a set of trajectories (the roll-outs or the global paths of one generation, the predicted
+ * paths of an object), then queried with many points. Each trajectory gets a binary tree of bounding boxes over
+ * halves of its consecutive points, a leaf holds m_LeafSize segments, so a query visits O(log n) nodes instead of
+ * scanning every point. The point coordinates are copied into the index, the trajectories must not change until the
+ * next Build. The build costs about as much as 25 scans of the same points, and GetRelativeInfoFromIndex dominates a
+ * query on paths of a few hundred points. The index pays when one build serves many queries on paths of thousands
+ * of points, not for one query per planning cycle.
+ */
+class TrajectorySetIndex
+{
+public:
+  int m_LeafSize; // segments in each leaf
+
+  TrajectorySetIndex(const int& leafSize = 8);
+  virtual ~TrajectorySetIndex();
+
+  void Clear();
+
+  void Build(const std::vector<std::vector<WayPoint> >& trajectories);
+
+  unsigned int GetTrajectoriesNumber() const { return m_Roots.size(); }
+
+  /**
+   * @brief Closest point of trajectory iTrajectory to p, the lowest index wins on ties as with PolylineDistance::GetClosestVertex
+   * @return point index, -1 if the trajectory is empty. min_d_sqr is the squared distance to it
+   */
+  int GetClosestVertex(const int& iTrajectory, const GPSPoint& p, double& min_d_sqr) const;
+
+  /**
+   * @brief Closest segment to p over all the trajectories, segment i goes from point i to point i+1
+   * @return false if no trajectory has a segment. distance is the distance from p to the segment
+   */
+  bool GetClosestSegment(const GPSPoint& p, int& iTrajectory, int& iSegment, double& distance) const;
+
+  /**
+   * @brief Same result contract as PlanningHelpers::GetRelativeInfo on trajectories.at(iTrajectory), with the exact closest point
+   */
+  bool GetRelativeInfo(const std::vector<std::vector<WayPoint> >& trajectories, const int& iTrajectory, const WayPoint& p,
+      RelativeInfo& info) const;
+
+  /**
+   * @brief Same result contract as PlanningHelpers::GetRelativeInfoRange, with the exact closest point on each trajectory
+   */
+  bool GetRelativeInfoRange(const std::vector<std::vector<WayPoint> >& trajectories, const WayPoint& p,
+      const double& searchDistance, RelativeInfo& info) const;
+
+private:
+  class Node
+  {
+  public:
+    double min_x;
+    double min_y;
+    double max_x;
+    double max_y;
+    int left; // -1 for a leaf
+    int right;
+    int iFirst; // first and last point of the node, the segments are iFirst to iLast-1
+    int iLast;
+  };
+
+  std::vector<Node> m_Nodes;
+  std::vector<int> m_Roots; // root node of each trajectory, -1 if it is empty
+  std::vector<int> m_Offsets; // first point of each trajectory in m_X, m_Y
+  std::vector<double> m_X;
+  std::vector<double> m_Y;
+
+  int BuildNode(const int& offset, const int& iFirst, const int& iLast);
+  double GetBoxDistanceSqr(const Node& node, const GPSPoint& p) const;
+  double GetSegmentDistanceSqr(const int& i, const GPSPoint& p) const;
+};
+
+} /* namespace PlannerHNS */
+
+#endif /* TRAJECTORYSETINDEX_H_ */
@@ -0,0 +1,63 @@
+/// \file WayPointArena.h
+/// \brief Block allocated WayPoint nodes for the planning search trees, released all at once with Reset
+/// \date Oct 14, 2026
+
+#ifndef WAYPOINTARENA_H_
+#define WAYPOINTARENA_H_
+
+#include "RoadNetwork.h"
+
+namespace PlannerHNS
+{
+
+/**
+ * @brief Owns the WayPoint nodes of one search tree. Nodes live in fixed size blocks, so their addresses never change,
+ * Reset releases every node in one step and keeps the blocks (and the vectors inside the nodes) for the next search.
+ * Node pointers are invalid after Reset, they must not be deleted by the caller.
+ */
+class WayPointArena
+{
+public:
+  WayPointArena(const unsigned int& blockSize = 1024);
+  virtual ~WayPointArena();
+
+  /**
+   * @brief New node, a copy of wp
+   */
+  WayPoint* Create(const WayPoint& wp);
+
+  /**
+   * @brief Release all nodes, the storage is kept
+   */
+  void Reset();
+
+  /**
+   * @brief Release all nodes and the storage, the statistics start again
+   */
+  void Clear();
+
+  /**
+   * @brief Nodes created since the last Reset
+   */
+  unsigned int GetNodeCount() const;
+
+  /**
+   * @brief Largest node count reached by a single search
+   */
+  unsigned int GetPeakNodeCount() const;
+
+  /**
+   * @brief Bytes of node storage held by the arena, the heap memory owned by vectors inside the nodes is not counted
+   */
+  size_t GetPeakBytes() const;
+
+private:
+  std::vector<std::vector<WayPoint> > m_Blocks;
+  unsigned int m_BlockSize;
+  unsigned int m_nNodes;
+  unsigned int m_nPeakNodes;
+};
+
+} /* namespace PlannerHNS */
+
+#endif /* WAYPOINTARENA_H_ */
@@ -10,6 +10,7 @@
 #include "op_planner/MappingHelpers.h"
 #include "op_planner/PlanningHelpers.h"
 #include "op_planner/MatrixOperations.h"
+#include <algorithm>
 
 
 namespace PlannerHNS
@@ -28,59 +29,98 @@ BehaviorPrediction::BehaviorPrediction()
   UtilityHNS::UtilityH::GetTickCount(m_ResamplingTimer);
   m_bFirstMove = true;
   m_bDebugOut = false;
+  m_nThreads = 1;
+  m_RandomSeed = 0;
+  m_bSystematicResampling = false;
+  m_bCacheTrajectories = true;
+  m_nTrajectoryCacheHits = 0;
+  m_nTrajectoryCacheMisses = 0;
+  m_ObservationGeneration = 0;
 }
 
 BehaviorPrediction::~BehaviorPrediction()
 {
+  for(unsigned int i=0; i < m_WorkerPlanners.size(); i++)
+    delete m_WorkerPlanners.at(i);
 }
 
-void BehaviorPrediction::FilterObservations(const std::vector<DetectedObject>& obj_list, RoadNetwork& map, std::vector<DetectedObject>& filtered_list)
+int BehaviorPrediction::GetNumberOfWorkers()
 {
+  if(m_nThreads <= 1) return 1;
+
+  return std::min(m_nThreads, UtilityHNS::TaskScheduler::GetShared().GetNumberOfThreads());
+}
+
+void BehaviorPrediction::ForEachObject(const int& nObjects, const std::function<void(const int&)>& task)
+{
+  int nWorkers = GetNumberOfWorkers();
+  if(nWorkers < 2 || nObjects < 2)
+  {
+    for(int i=0; i < nObjects; i++)
+      task(i);
+  }
+  else
+  {
+    UtilityHNS::TaskScheduler::GetShared().ParallelFor(nObjects, task, nWorkers);
+  }
+}
+
+void BehaviorPrediction::FilterObservations(const std::vector<DetectedObject>& obj_list, const RoadNetwork& map, std::vector<DetectedObject>& filtered_list)
+{
+  m_ObservationGeneration++;
+
+  //first slot of each id, as a scan from the start would find it
+  m_ObservationSlots.clear();
+  for(unsigned int ip=0; ip < filtered_list.size(); ip++)
+    m_ObservationSlots.emplace(filtered_list.at(ip).id, ip);
+
   for(unsigned int i=0; i < obj_list.size(); i++)
   {
+    //slow objects are not added but keep their filtered entry
+    m_ObservationGenerations[obj_list.at(i).id] = m_ObservationGeneration;
+
     if(obj_list.at(i).t == SIDEWALK || obj_list.at(i).center.v < 1.0)
       continue;
 
-    bool bFound = false;
-    int found_index = 0;
-    for(unsigned int ip=0; ip < filtered_list.size(); ip++)
+    std::unordered_map<int, int>::iterator slot = m_ObservationSlots.find(obj_list.at(i).id);
+    if(slot != m_ObservationSlots.end())
     {
-      if(filtered_list.at(ip).id == obj_list.at(i).id)
-      {
-        found_index = ip;
-        bFound = true;
-        break;
-      }
+      filtered_list.at(slot->second) = obj_list.at(i);
     }
-
-    if(bFound)
-      filtered_list.at(found_index) = obj_list.at(i);
     else
+    {
+      m_ObservationSlots.emplace(obj_list.at(i).id, filtered_list.size());
       filtered_list.push_back(obj_list.at(i));
+    }
   }
 
-  for(int ip=0; ip < (int)filtered_list.size(); ip++)
+  //keep the entries observed by this call, in order
+  unsigned int nKept = 0;
+  for(unsigned int ip=0; ip < filtered_list.size(); ip++)
   {
-    //check for cleaning
-    bool bRevFound = false;
-    for(unsigned int ic=0; ic < obj_list.size(); ic++)
-    {
-      if(filtered_list.at(ip).id == obj_list.at(ic).id)
-      {
-        bRevFound = true;
-        break;
-      }
-    }
+    if(m_ObservationGenerations[filtered_list.at(ip).id] != m_ObservationGeneration)
+      continue;
+
+    if(nKept != ip)
+      filtered_list.at(nKept) = filtered_list.at(ip);
+    nKept++;
+  }
+  filtered_list.erase(filtered_list.begin()+nKept, filtered_list.end());
 
-    if(!bRevFound)
+  //forget the ids of the objects gone for good, so the generations don't grow with every id ever seen
+  if(m_ObservationGenerations.size() > 2*obj_list.size() + 64)
+  {
+    for(std::unordered_map<int, unsigned int>::iterator it = m_ObservationGenerations.begin(); it != m_ObservationGenerations.end();)
     {
-      filtered_list.erase(filtered_list.begin()+ip);
-      ip--;
+      if(it->second != m_ObservationGeneration)
+        it = m_ObservationGenerations.erase(it);
+      else
+        it++;
     }
   }
 }
 
-void BehaviorPrediction::DoOneStep(const std::vector<DetectedObject>& obj_list, const WayPoint& currPose, const double& minSpeed, const double& maxDeceleration, RoadNetwork& map)
+void BehaviorPrediction::DoOneStep(const std::vector<DetectedObject>& obj_list, const WayPoint& currPose, const double& minSpeed, const double& maxDeceleration, const RoadNetwork& map)
 {
   if(!m_bUseFixedPrediction && maxDeceleration !=0)
     m_PredictionDistance = -pow(currPose.v, 2)/(maxDeceleration);
@@ -96,55 +136,46 @@ void BehaviorPrediction::DoOneStep(const std::vector<DetectedObject>& obj_list,
 
 void BehaviorPrediction::CalculateCollisionTimes(const double& minSpeed)
 {
-  for(unsigned int i=0; i < m_ParticleInfo_II.size(); i++)
+  ForEachObject(m_ParticleInfo_II.size(), [&](const int& i)
   {
     for(unsigned int j=0; j < m_ParticleInfo_II.at(i)->obj.predTrajectories.size(); j++)
     {
       PlannerHNS::PlanningHelpers::PredictConstantTimeCostForTrajectory(m_ParticleInfo_II.at(i)->obj.predTrajectories.at(j), m_ParticleInfo_II.at(i)->obj.center, minSpeed, m_PredictionDistance);
 //      PlannerHNS::PlanningHelpers::CalcAngleAndCost(m_PredictedObjects.at(i).predTrajectories.at(j));
     }
-  }
+  });
 }
 
-void BehaviorPrediction::ExtractTrajectoriesFromMap(const std::vector<DetectedObject>& curr_obj_list,RoadNetwork& map, std::vector<ObjParticles*>& old_obj_list)
+void BehaviorPrediction::ExtractTrajectoriesFromMap(const std::vector<DetectedObject>& curr_obj_list,const RoadNetwork& map, std::vector<ObjParticles*>& old_obj_list)
 {
-  PlannerH planner;
   m_temp_list_ii.clear();
 
-  std::vector<ObjParticles*> delete_me_list = old_obj_list;
+  //tracked objects of each id in their order, every current object takes the first unmatched one
+  m_ParticleSlots.clear();
+  m_NextParticleSlot.assign(old_obj_list.size(), -1);
+  m_bParticleMatched.assign(old_obj_list.size(), 0);
+  for(int ip = (int)old_obj_list.size()-1; ip >= 0; ip--)
+  {
+    std::pair<std::unordered_map<int, int>::iterator, bool> slot = m_ParticleSlots.emplace(old_obj_list.at(ip)->obj.id, ip);
+    if(!slot.second)
+    {
+      m_NextParticleSlot.at(ip) = slot.first->second;
+      slot.first->second = ip;
+    }
+  }
 
   for(unsigned int i=0; i < curr_obj_list.size(); i++)
   {
-    bool bMatch = false;
-    for(unsigned int ip=0; ip < old_obj_list.size(); ip++)
+    std::unordered_map<int, int>::iterator slot = m_ParticleSlots.find(curr_obj_list.at(i).id);
+    if(slot != m_ParticleSlots.end() && slot->second >= 0)
     {
-      if(old_obj_list.at(ip)->obj.id == curr_obj_list.at(i).id)
-      {
-        bool bFound = false;
-        for(unsigned int k=0; k < m_temp_list_ii.size(); k++)
-        {
-          if(m_temp_list_ii.at(k) == old_obj_list.at(ip))
-          {
-            bFound = true;
-            break;
-          }
-        }
-
-        if(!bFound)
-        {
-          old_obj_list.at(ip)->obj = curr_obj_list.at(i);
-          m_temp_list_ii.push_back(old_obj_list.at(ip));
-        }
-
-        DeleteFromList(delete_me_list, old_obj_list.at(ip));
-
-        old_obj_list.erase(old_obj_list.begin()+ip);
-        bMatch = true;
-        break;
-      }
+      int ip = slot->second;
+      slot->second = m_NextParticleSlot.at(ip);
+      m_bParticleMatched.at(ip) = 1;
+      old_obj_list.at(ip)->obj = curr_obj_list.at(i);
+      m_temp_list_ii.push_back(old_obj_list.at(ip));
     }
-
-    if(!bMatch)
+    else
     {
       ObjParticles* pNewObj = new  ObjParticles();
       pNewObj->obj = curr_obj_list.at(i);
@@ -152,17 +183,54 @@ void BehaviorPrediction::ExtractTrajectoriesFromMap(const std::vector<DetectedOb
     }
   }
 
-  DeleteTheRest(delete_me_list);
+  for(unsigned int ip=0; ip < old_obj_list.size(); ip++)
+  {
+    if(!m_bParticleMatched.at(ip))
+      delete old_obj_list.at(ip);
+  }
+
   old_obj_list.clear();
   old_obj_list = m_temp_list_ii;
 
-  //m_PredictedObjects.clear();
-  for(unsigned int ip=0; ip < old_obj_list.size(); ip++)
+  //the objects are split in contiguous chunks, one per thread, so each chunk reuses the search arena of its own planner
+  int nChunks = std::max(1, std::min(GetNumberOfWorkers(), (int)old_obj_list.size()));
+
+  while((int)m_WorkerPlanners.size() < nChunks - 1)
+    m_WorkerPlanners.push_back(new PlannerH());
+
+  int nObjects = old_obj_list.size();
+  ForEachObject(nChunks, [&](const int& c)
   {
-    PredictCurrentTrajectory(map, old_obj_list.at(ip));
-    //m_PredictedObjects.push_back(old_obj_list.at(ip)->obj);
-    old_obj_list.at(ip)->MatchTrajectories();
+    PlannerH& planner = c == 0 ? m_Planner : *m_WorkerPlanners.at(c - 1);
+    for(int ip = c * nObjects / nChunks; ip < (c + 1) * nObjects / nChunks; ip++)
+    {
+      PredictCurrentTrajectory(map, old_obj_list.at(ip), planner);
+      old_obj_list.at(ip)->MatchTrajectories();
+    }
+  });
+
+  for(unsigned int ip = 0; ip < old_obj_list.size(); ip++)
+  {
+    if(old_obj_list.at(ip)->bTrajectoriesFromCache)
+      m_nTrajectoryCacheHits++;
+    else
+      m_nTrajectoryCacheMisses++;
   }
+}
+
+double BehaviorPrediction::GetTrajectoryCacheHitRate() const
+{
+  unsigned long total = m_nTrajectoryCacheHits + m_nTrajectoryCacheMisses;
+  if(total == 0)
+    return 0;
+
+  return (double)m_nTrajectoryCacheHits/(double)total;
+}
+
+void BehaviorPrediction::ResetTrajectoryCacheCounters()
+{
+  m_nTrajectoryCacheHits = 0;
+  m_nTrajectoryCacheMisses = 0;
 
 }
 
@@ -174,26 +242,57 @@ void BehaviorPrediction::CalPredictionTimeForObject(ObjParticles* pCarPart)
     pCarPart->m_PredictionTime = MIN_PREDICTION_TIME;
 }
 
-void BehaviorPrediction::PredictCurrentTrajectory(RoadNetwork& map, ObjParticles* pCarPart)
+bool BehaviorPrediction::IsTrajectoryCacheValid(const ObjParticles* pCarPart, const std::vector<int>& laneIds, const RoadNetwork& map)
+{
+  if(!m_bCacheTrajectories || laneIds.size() == 0 || pCarPart->m_CachedTrajectories.size() == 0)
+    return false;
+
+  if(pCarPart->m_CachedLaneIds != laneIds || pCarPart->m_CachedMapVersion != map.version || pCarPart->m_CachedPredictionDistance != m_PredictionDistance)
+    return false;
+
+  //the first trajectory follows the lane, once the object drove a part of it or left it the search is repeated
+  const std::vector<WayPoint>& path = pCarPart->m_CachedTrajectories.at(0);
+  if(path.size() < 2)
+    return false;
+
+  RelativeInfo info;
+  PlanningHelpers::GetRelativeInfo(path, pCarPart->obj.center, info);
+  if(fabs(info.perp_distance) > m_MaxLaneDetectionDistance || info.bAfter)
+    return false;
+
+  return path.at(info.iFront).cost <= m_PredictionDistance*PREDICTION_CACHE_CONSUMED_RATIO;
+}
+
+void BehaviorPrediction::PredictCurrentTrajectory(const RoadNetwork& map, ObjParticles* pCarPart, PlannerH& planner)
 {
   pCarPart->obj.predTrajectories.clear();
-  PlannerH planner;
-  if(pCarPart->obj.bDirection && pCarPart->obj.bVelocity)
+  pCarPart->bTrajectoriesFromCache = false;
+  WayPoint start_pose = pCarPart->obj.center;
+  pCarPart->obj.pClosestWaypoints = MappingHelpers::GetClosestWaypointsListFromMap(pCarPart->obj.center, map, m_MaxLaneDetectionDistance, pCarPart->obj.bDirection);
+  if(!(pCarPart->obj.bDirection && pCarPart->obj.bVelocity))
+  {
+    if(pCarPart->obj.pClosestWaypoints.size()>0)
+      pCarPart->obj.center.pos.a = pCarPart->obj.pClosestWaypoints.at(0)->pos.a;
+    start_pose = pCarPart->obj.center;
+  }
+
+  std::vector<int> lane_ids;
+  for(unsigned int i = 0; i < pCarPart->obj.pClosestWaypoints.size(); i++)
+    lane_ids.push_back(pCarPart->obj.pClosestWaypoints.at(i)->laneId);
+  std::sort(lane_ids.begin(), lane_ids.end());
+
+  if(IsTrajectoryCacheValid(pCarPart, lane_ids, map))
   {
-    PlannerHNS::WayPoint fake_pose = pCarPart->obj.center;
-    pCarPart->obj.pClosestWaypoints = MappingHelpers::GetClosestWaypointsListFromMap(fake_pose, map, m_MaxLaneDetectionDistance, pCarPart->obj.bDirection);
-    planner.PredictTrajectoriesUsingDP(fake_pose, pCarPart->obj.pClosestWaypoints, m_PredictionDistance, pCarPart->obj.predTrajectories, m_bGenerateBranches, pCarPart->obj.bDirection);
+    pCarPart->obj.predTrajectories = pCarPart->m_CachedTrajectories;
+    pCarPart->bTrajectoriesFromCache = true;
   }
   else
   {
-    bool bLocalDirectionSearch = false;
-    pCarPart->obj.pClosestWaypoints = MappingHelpers::GetClosestWaypointsListFromMap(pCarPart->obj.center, map, m_MaxLaneDetectionDistance, pCarPart->obj.bDirection);
-    if(pCarPart->obj.pClosestWaypoints.size()>0)
-    {
-      pCarPart->obj.center.pos.a = pCarPart->obj.pClosestWaypoints.at(0)->pos.a;
-      bLocalDirectionSearch = true;
-    }
-    planner.PredictTrajectoriesUsingDP(pCarPart->obj.center, pCarPart->obj.pClosestWaypoints, m_PredictionDistance, pCarPart->obj.predTrajectories, m_bGenerateBranches, pCarPart->obj.bDirection);
+    planner.PredictTrajectoriesUsingDP(start_pose, pCarPart->obj.pClosestWaypoints, m_PredictionDistance, pCarPart->obj.predTrajectories, m_bGenerateBranches, pCarPart->obj.bDirection);
+    pCarPart->m_CachedTrajectories = pCarPart->obj.predTrajectories;
+    pCarPart->m_CachedLaneIds = lane_ids;
+    pCarPart->m_CachedMapVersion = map.version;
+    pCarPart->m_CachedPredictionDistance = m_PredictionDistance;
   }
 
 
@@ -212,16 +311,45 @@ void BehaviorPrediction::PredictCurrentTrajectory(RoadNetwork& map, ObjParticles
 
 void BehaviorPrediction::ParticleFilterSteps(std::vector<ObjParticles*>& part_info)
 {
-  for(unsigned int i=0; i < part_info.size(); i++)
+  //the step time and the random seed are taken once, every object moves by the same time step
+  double dt = 0.08;
+  bool bMove = true;
+  if(!m_bStepByStep)
+  {
+    dt = UtilityHNS::UtilityH::GetTimeDiffNow(m_ResamplingTimer);
+    UtilityHNS::UtilityH::GetTickCount(m_ResamplingTimer);
+    if(m_bFirstMove)
+    {
+      m_bFirstMove  = false;
+      bMove = false;
+    }
+  }
+
+  unsigned int seed = m_RandomSeed;
+  if(seed == 0)
   {
-    SamplesFreshParticles(part_info.at(i));
-    CollectParticles(part_info.at(i));
-    MoveParticles(part_info.at(i));
+    timespec _time;
+    UtilityHNS::UtilityH::GetTickCount(_time);
+    seed = _time.tv_nsec;
+  }
+
+  ForEachObject(part_info.size(), [&](const int& i)
+  {
+    unsigned int obj_seed = seed ^ ((unsigned int)part_info.at(i)->obj.id * 2654435761u);
+    SamplesFreshParticles(part_info.at(i), obj_seed);
+    if(bMove)
+      MoveParticles(part_info.at(i), dt);
     CalculateWeights(part_info.at(i));
-    RemoveWeakParticles(part_info.at(i));
+    if(m_bSystematicResampling)
+      ResampleParticles(part_info.at(i), obj_seed + 1);
+    else
+      RemoveWeakParticles(part_info.at(i));
     CalculateAveragesAndProbabilities(part_info.at(i));
     FindBest(part_info.at(i));
-  }
+  });
+
+  if(part_info.size() > 0)
+    m_bCanDecide = part_info.back()->bCanDecide;
 }
 
 int BehaviorPrediction::FromIndicatorToNumber(const PlannerHNS::LIGHT_INDICATOR& indi)
@@ -270,172 +398,169 @@ double BehaviorPrediction::CalcAccelerationWeight(int p_acl, int obj_acl)
     return 0.01;
 }
 
-void BehaviorPrediction::CalOnePartWeight(ObjParticles* pParts,Particle& p)
-{
-  if(p.bDeleted) return;
-
-  //p.pose_w = exp(-(0.5*pow((p.pose.pos.x - pParts->obj.center.pos.x),2)/(2*MEASURE_POSE_ERROR*MEASURE_POSE_ERROR)+ pow((p.pose.pos.y - pParts->obj.center.pos.y),2)/(2*MEASURE_POSE_ERROR*MEASURE_POSE_ERROR)));
-  p.pose_w = 1.0/hypot(0.5*(p.pose.pos.y - pParts->obj.center.pos.y), 0.5*(p.pose.pos.x - pParts->obj.center.pos.x));
-  //p.dir_w  = exp(-(pow(fabs(UtilityHNS::UtilityH::AngleBetweenTwoAnglesPositive(p.pose.pos.a,  pParts->obj.center.pos.a)),2)/(2*MEASURE_ANGLE_ERROR*MEASURE_ANGLE_ERROR)));
-  p.dir_w  = M_PI_2 - fabs(UtilityHNS::UtilityH::AngleBetweenTwoAnglesPositive(p.pose.pos.a,  pParts->obj.center.pos.a));
-  p.vel_w  = exp(-(pow((p.vel - pParts->obj.center.v),2)/(2*MEASURE_VEL_ERROR*MEASURE_VEL_ERROR)));
-  //p.vel_w = fabs(p.vel - pParts->obj.center.v);
-  p.ind_w  = CalcIndicatorWeight(FromNumbertoIndicator(p.indicator), pParts->obj.indicator_state);
-  p.ind_w  -= p.ind_w*MEASURE_IND_ERROR;
-  p.acl_w = CalcAccelerationWeight(p.acc, pParts->obj.acceleration_desc);
-
-  //std::cout << p.beh << "|" << p.vel_w <<"|" <<p.vel << "|" << pParts->obj.center.v;
-
-  pParts->pose_w_t += p.pose_w;
-  pParts->dir_w_t += p.dir_w;
-  pParts->vel_w_t += p.vel_w;
-  pParts->ind_w_t += p.ind_w;
-  pParts->acl_w_t += p.acl_w;
-
-  if(p.pose_w > pParts->pose_w_max)
-    pParts->pose_w_max = p.pose_w;
-  if(p.dir_w > pParts->dir_w_max)
-    pParts->dir_w_max = p.dir_w;
-  if(p.vel_w > pParts->vel_w_max)
-    pParts->vel_w_max = p.vel_w;
-  if(p.ind_w > pParts->ind_w_max)
-    pParts->ind_w_max = p.ind_w;
-  if(p.acl_w > pParts->acl_w_max)
-    pParts->acl_w_max = p.acl_w;
-
-  if(p.pose_w < pParts->pose_w_min)
-    pParts->pose_w_min = p.pose_w;
-  if(p.dir_w < pParts->dir_w_min)
-    pParts->dir_w_min = p.dir_w;
-  if(p.vel_w < pParts->vel_w_min)
-    pParts->vel_w_min = p.vel_w;
-  if(p.ind_w < pParts->ind_w_min)
-    pParts->ind_w_min = p.ind_w;
-  if(p.acl_w < pParts->acl_w_min)
-    pParts->acl_w_min = p.acl_w;
-
-  p.w_raw = p.pose_w*POSE_FACTOR + p.dir_w*DIRECTION_FACTOR + p.vel_w*VELOCITY_FACTOR + p.ind_w*INDICATOR_FACTOR + p.acl_w*ACCELERATE_FACTOR;
-
-  if(p.w_raw >= pParts->max_w_raw)
-    pParts->max_w_raw = p.w_raw;
-
-  if(p.w_raw <= pParts->min_w_raw)
-    pParts->min_w_raw = p.w_raw;
-}
-
-void BehaviorPrediction::NormalizeOnePartWeight(ObjParticles* pParts,Particle& p)
-{
-  if(p.bDeleted) return;
-
-  double pose_diff  = pParts->pose_w_max-pParts->pose_w_min;
-  double dir_diff = pParts->dir_w_max-pParts->dir_w_min;
-  double vel_diff = pParts->vel_w_max-pParts->vel_w_min;
-  double ind_diff = pParts->ind_w_max-pParts->ind_w_min;
-  double acl_diff = pParts->acl_w_max-pParts->acl_w_min;
-
-  double epsilon = 0.05;
-
-  if(fabs(pose_diff) > epsilon)
-    p.pose_w = p.pose_w/pose_diff;
-  else
-    p.pose_w = 0;
-
-  if(p.pose_w > 1.0 ) p.pose_w = 1.0;
-
-  if(fabs(dir_diff) > epsilon)
-    p.dir_w = (p.dir_w - pParts->dir_w_min)/dir_diff;
-  else
-    p.dir_w = 0;
-
-  if(p.dir_w > 1.0 ) p.dir_w = 1.0;
-
-  if(fabs(vel_diff) > epsilon)
-    p.vel_w = (p.vel_w-pParts->vel_w_min)/vel_diff;
-  else
-    p.vel_w = 0;
-
-  if(p.vel_w > 1.0) p.vel_w = 1.0;
-
-  if(fabs(ind_diff) > epsilon)
-    p.ind_w = (p.ind_w - pParts->ind_w_min)/ind_diff;
-  else
-    p.ind_w = 0;
-
-  if(p.ind_w > 1.0) p.ind_w = 1.0;
-
-  if(fabs(acl_diff) > epsilon)
-    p.acl_w = (p.acl_w - pParts->acl_w_min)/acl_diff;
-  else
-    p.acl_w = 0;
-
-  if(p.acl_w > 1.0) p.acl_w = 1.0;
-
-  p.w = p.pose_w*POSE_FACTOR + p.dir_w*DIRECTION_FACTOR + p.vel_w*VELOCITY_FACTOR + p.ind_w*INDICATOR_FACTOR + p.acl_w*ACCELERATE_FACTOR;
-  //p.w = p.pose_w*0.1 + p.vel_w*0.2 + p.dir_w * 0.2 + p.ind_w + 0.5;
-
-  if(p.w >= pParts->max_w)
-    pParts->max_w = p.w;
-
-  if(p.w <= pParts->min_w)
-    pParts->min_w = p.w;
-
-    pParts->all_w += p.w;
-}
-
 void BehaviorPrediction::CalculateWeights(ObjParticles* pParts)
 {
-  pParts->all_w = 0;
+  ParticleBuffer& parts = pParts->m_Particles;
+  const int n = parts.size();
+
   pParts->pose_w_t = 0;
   pParts->dir_w_t = 0;
   pParts->vel_w_t = 0;
+  pParts->ind_w_t = 0;
   pParts->acl_w_t = 0;
 
   pParts->pose_w_max = -99999999;
   pParts->dir_w_max = -99999999;
   pParts->vel_w_max = -99999999;
+  pParts->ind_w_max = -99999999;
   pParts->acl_w_max = -99999999;
 
   pParts->pose_w_min = 99999999;
   pParts->dir_w_min = 99999999;
   pParts->vel_w_min = 99999999;
+  pParts->ind_w_min = 99999999;
   pParts->acl_w_min = 99999999;
 
   pParts->max_w_raw = DBL_MIN;
   pParts->min_w_raw = DBL_MAX;
 
-  //std::cout << "Acceleration Diff: ";
-  for(unsigned int i = 0 ; i < pParts->m_AllParticles.size(); i++)
+  const double obj_x = pParts->obj.center.pos.x;
+  const double obj_y = pParts->obj.center.pos.y;
+  const double obj_a = pParts->obj.center.pos.a;
+  const double obj_v = pParts->obj.center.v;
+  const double vel_k = 1.0/(2*MEASURE_VEL_ERROR*MEASURE_VEL_ERROR);
+
+  //indicator and acceleration weights only depend on the particle state, see CalcIndicatorWeight and CalcAccelerationWeight
+  const int obj_ind = FromIndicatorToNumber(pParts->obj.indicator_state);
+  const bool bIndKnown = pParts->obj.indicator_state == PlannerHNS::INDICATOR_LEFT || pParts->obj.indicator_state == PlannerHNS::INDICATOR_RIGHT
+      || pParts->obj.indicator_state == PlannerHNS::INDICATOR_NONE;
+  const double ind_match = 0.99 - 0.99*MEASURE_IND_ERROR;
+  const double ind_miss = 0.01 - 0.01*MEASURE_IND_ERROR;
+  const int obj_acl = pParts->obj.acceleration_desc;
+
+  const double* x = parts.x.data();
+  const double* y = parts.y.data();
+  const double* a = parts.a.data();
+  const double* vel = parts.vel.data();
+  const int* ind = parts.indicator.data();
+  const int* acc = parts.acc.data();
+  double* pose_w = parts.pose_w.data();
+  double* dir_w = parts.dir_w.data();
+  double* vel_w = parts.vel_w.data();
+  double* ind_w = parts.ind_w.data();
+  double* acl_w = parts.acl_w.data();
+  double* w_raw = parts.w_raw.data();
+
+  for(int i = 0; i < n; i++)
   {
-    //  std::cout << "(" << pParts->m_AllParticles.at(i)->pTraj->index <<",";
-      CalOnePartWeight(pParts, *pParts->m_AllParticles.at(i));
-      //std::cout << ")";
+    double dx = 0.5*(x[i] - obj_x);
+    double dy = 0.5*(y[i] - obj_y);
+    pose_w[i] = 1.0/sqrt(dx*dx + dy*dy);
+
+    double da = fabs(a[i] - obj_a);
+    da = da > M_PI ? 2.0*M_PI - da : da;
+    dir_w[i] = M_PI_2 - da;
+
+    double dv = vel[i] - obj_v;
+    vel_w[i] = exp(-(dv*dv)*vel_k);
+
+    ind_w[i] = (bIndKnown && ind[i] == obj_ind) ? ind_match : ind_miss;
+    acl_w[i] = ((acc[i] > 0 && obj_acl > 0) || (acc[i] < 0 && obj_acl < 0)) ? 0.99 : 0.01;
+
+    w_raw[i] = pose_w[i]*POSE_FACTOR + dir_w[i]*DIRECTION_FACTOR + vel_w[i]*VELOCITY_FACTOR + ind_w[i]*INDICATOR_FACTOR + acl_w[i]*ACCELERATE_FACTOR;
   }
 
-  //std::cout << "Befor Normalize: Max: " <<  pParts->acl_w_max << ", Min: " << pParts->acl_w_min << std::endl;
-  //std::cout << std::endl;
+  for(int i = 0; i < n; i++)
+  {
+    pParts->pose_w_t += pose_w[i];
+    pParts->dir_w_t += dir_w[i];
+    pParts->vel_w_t += vel_w[i];
+    pParts->ind_w_t += ind_w[i];
+    pParts->acl_w_t += acl_w[i];
+
+    pParts->pose_w_max = std::max(pParts->pose_w_max, pose_w[i]);
+    pParts->dir_w_max = std::max(pParts->dir_w_max, dir_w[i]);
+    pParts->vel_w_max = std::max(pParts->vel_w_max, vel_w[i]);
+    pParts->ind_w_max = std::max(pParts->ind_w_max, ind_w[i]);
+    pParts->acl_w_max = std::max(pParts->acl_w_max, acl_w[i]);
+
+    pParts->pose_w_min = std::min(pParts->pose_w_min, pose_w[i]);
+    pParts->dir_w_min = std::min(pParts->dir_w_min, dir_w[i]);
+    pParts->vel_w_min = std::min(pParts->vel_w_min, vel_w[i]);
+    pParts->ind_w_min = std::min(pParts->ind_w_min, ind_w[i]);
+    pParts->acl_w_min = std::min(pParts->acl_w_min, acl_w[i]);
+
+    pParts->max_w_raw = std::max(pParts->max_w_raw, w_raw[i]);
+    pParts->min_w_raw = std::min(pParts->min_w_raw, w_raw[i]);
+  }
 
   //if((pParts->m_TrajectoryTracker.size() > 1 && pParts->min_w_raw < 0.5) || pParts->max_w_raw == 0 || fabs(pParts->max_w_raw - pParts->min_w_raw) < 0.1 )
   if((pParts->max_w_raw == 0 || fabs(pParts->max_w_raw - pParts->min_w_raw) < 0.1 || pParts->min_w_raw > 0.5) && pParts->m_TrajectoryTracker.size() > 1)
-    m_bCanDecide = false;
+    pParts->bCanDecide = false;
   else
-    m_bCanDecide = true;
+    pParts->bCanDecide = true;
+
+  NormalizeWeights(pParts);
+}
+
+void BehaviorPrediction::NormalizeWeights(ObjParticles* pParts)
+{
+  ParticleBuffer& parts = pParts->m_Particles;
+  const int n = parts.size();
+
+  //a factor that barely changes between the particles doesn't count
+  const double epsilon = 0.05;
+  const double pose_diff = pParts->pose_w_max - pParts->pose_w_min;
+  const double dir_diff = pParts->dir_w_max - pParts->dir_w_min;
+  const double vel_diff = pParts->vel_w_max - pParts->vel_w_min;
+  const double ind_diff = pParts->ind_w_max - pParts->ind_w_min;
+  const double acl_diff = pParts->acl_w_max - pParts->acl_w_min;
+
+  const double pose_k = fabs(pose_diff) > epsilon ? 1.0/pose_diff : 0;
+  const double dir_k = fabs(dir_diff) > epsilon ? 1.0/dir_diff : 0;
+  const double vel_k = fabs(vel_diff) > epsilon ? 1.0/vel_diff : 0;
+  const double ind_k = fabs(ind_diff) > epsilon ? 1.0/ind_diff : 0;
+  const double acl_k = fabs(acl_diff) > epsilon ? 1.0/acl_diff : 0;
+
+  const double dir_min = pParts->dir_w_min;
+  const double vel_min = pParts->vel_w_min;
+  const double ind_min = pParts->ind_w_min;
+  const double acl_min = pParts->acl_w_min;
+
+  double* pose_w = parts.pose_w.data();
+  double* dir_w = parts.dir_w.data();
+  double* vel_w = parts.vel_w.data();
+  double* ind_w = parts.ind_w.data();
+  double* acl_w = parts.acl_w.data();
+  double* w = parts.w.data();
+
+  for(int i = 0; i < n; i++)
+  {
+    pose_w[i] = std::min(1.0, pose_w[i]*pose_k);
+    dir_w[i] = std::min(1.0, (dir_w[i] - dir_min)*dir_k);
+    vel_w[i] = std::min(1.0, (vel_w[i] - vel_min)*vel_k);
+    ind_w[i] = std::min(1.0, (ind_w[i] - ind_min)*ind_k);
+    acl_w[i] = std::min(1.0, (acl_w[i] - acl_min)*acl_k);
+
+    w[i] = pose_w[i]*POSE_FACTOR + dir_w[i]*DIRECTION_FACTOR + vel_w[i]*VELOCITY_FACTOR + ind_w[i]*INDICATOR_FACTOR + acl_w[i]*ACCELERATE_FACTOR;
+  }
 
-  //Normalize
   pParts->max_w = -9999999;
   pParts->min_w = 9999999;
   pParts->all_w = 0;
-
-  for(unsigned int i = 0 ; i < pParts->m_AllParticles.size(); i++)
+  for(int i = 0; i < n; i++)
   {
-    NormalizeOnePartWeight(pParts, *pParts->m_AllParticles.at(i));
+    pParts->max_w = std::max(pParts->max_w, w[i]);
+    pParts->min_w = std::min(pParts->min_w, w[i]);
+    pParts->all_w += w[i];
   }
 }
 
 void BehaviorPrediction::CalculateAveragesAndProbabilities(ObjParticles* pParts)
 {
+  pParts->CalcAverages();
   for(unsigned int t=0; t < pParts->m_TrajectoryTracker.size(); t++)
   {
-    pParts->m_TrajectoryTracker.at(t)->CalcAverages();
     pParts->m_TrajectoryTracker.at(t)->CalcProbabilities();
   }
 }
@@ -453,20 +578,49 @@ void BehaviorPrediction::RemoveWeakParticles(ObjParticles* pParts)
 //  else if(pParts->obj.acceleration  < 0 )
 //    std::cout << "Brake Eeeeee Eeeeeeee: " << std::endl;
 
-  for(int i =0 ; i < pParts->m_AllParticles.size(); i++)
+  ParticleBuffer& parts = pParts->m_Particles;
+  for(unsigned int i = 0; i < parts.size(); )
   {
     //also delete far particle
-    double d = hypot(pParts->obj.center.pos.y - pParts->m_AllParticles.at(i)->pose.pos.y, pParts->obj.center.pos.x - pParts->m_AllParticles.at(i)->pose.pos.x);
+    double d = hypot(pParts->obj.center.pos.y - parts.y.at(i), pParts->obj.center.pos.x - parts.x.at(i));
 
-    if(pParts->m_AllParticles.at(i)->w < critical_val || d > m_PredictionDistance)
-    {
-      pParts->m_AllParticles.at(i)->pTraj->DeleteParticle(*(pParts->m_AllParticles.at(i)), pParts->m_AllParticles.at(i)->original_index);
-      pParts->m_AllParticles.erase(pParts->m_AllParticles.begin()+i);
-      i--;
-    }
+    if((parts.w.at(i) < critical_val || d > m_PredictionDistance) && pParts->DeleteParticle(i))
+      continue; // the last particle moved to i
+
+    i++;
   }
 }
 
+void BehaviorPrediction::RemoveFarParticles(ObjParticles* pParts)
+{
+  ParticleBuffer& parts = pParts->m_Particles;
+  for(unsigned int i = 0; i < parts.size(); )
+  {
+    double d = hypot(pParts->obj.center.pos.y - parts.y.at(i), pParts->obj.center.pos.x - parts.x.at(i));
+
+    if(d > m_PredictionDistance && pParts->DeleteParticle(i))
+      continue;
+
+    i++;
+  }
+}
+
+void BehaviorPrediction::ResampleParticles(ObjParticles* pParts, const unsigned int& seed)
+{
+  RemoveFarParticles(pParts);
+
+  ENG eng(seed);
+  boost::uniform_01<ENG&> u(eng);
+
+  std::vector<unsigned int> indices;
+  pParts->m_Particles.GetSystematicSamples(u(), indices);
+  if(indices.size() == 0) return;
+
+  //the copies keep the trajectory and behavior of their parent, so the trajectories with the heavier particles get more of them
+  pParts->m_Particles.Select(indices);
+  pParts->RecountAlive();
+}
+
 void BehaviorPrediction::FindBest(ObjParticles* pParts)
 {
   if(pParts->m_TrajectoryTracker.size() > 0)
@@ -500,7 +654,7 @@ void BehaviorPrediction::FindBest(ObjParticles* pParts)
     }
   }
 
-  if(m_bCanDecide && pParts->best_beh_track != nullptr)
+  if(pParts->bCanDecide && pParts->best_beh_track != nullptr)
   {
     std::string str_beh = "Unknown";
     if(pParts->best_beh_track->best_beh == BEH_STOPPING_STATE)
@@ -535,13 +689,9 @@ void BehaviorPrediction::FindBest(ObjParticles* pParts)
   }
 }
 
-void BehaviorPrediction::SamplesFreshParticles(ObjParticles* pParts)
+void BehaviorPrediction::SamplesFreshParticles(ObjParticles* pParts, const unsigned int& seed)
 {
-  timespec _time;
-  UtilityHNS::UtilityH::GetTickCount(_time);
-  srand(_time.tv_nsec);
-
-  ENG eng(_time.tv_nsec);
+  ENG eng(seed);
   NormalDIST dist_x(0, MOTION_POSE_ERROR);
   VariatGEN gen_x(eng, dist_x);
   NormalDIST vel(MOTION_VEL_ERROR, MOTION_VEL_ERROR);
@@ -556,13 +706,6 @@ void BehaviorPrediction::SamplesFreshParticles(ObjParticles* pParts)
   p.vel = 0;
   p.acc = 0;
   p.indicator = 0;
-  bool bRegenerate = true;
-
-  if(UtilityHNS::UtilityH::GetTimeDiffNow(m_GenerationTimer) > 2)
-  {
-    UtilityHNS::UtilityH::GetTickCount(m_GenerationTimer);
-    bRegenerate = true;
-  }
 
 //  for(unsigned int t=0; t < pParts->m_TrajectoryTracker.size(); t++)
 //  {
@@ -590,7 +733,7 @@ void BehaviorPrediction::SamplesFreshParticles(ObjParticles* pParts)
         p_new.pose.pos.a += gen_a();
         p_new.vel = pParts->obj.center.v + fabs(gen_v());
         p_new.pose.v = p_new.vel;
-        pParts->m_TrajectoryTracker.at(t)->InsertNewParticle(p_new);
+        pParts->InsertNewParticle(pParts->m_TrajectoryTracker.at(t), p_new);
       }
     }
 
@@ -607,49 +750,14 @@ void BehaviorPrediction::SamplesFreshParticles(ObjParticles* pParts)
         p_new.pose.pos.a += gen_a();
         p_new.vel = 0;
         p_new.pose.v = pParts->obj.center.v + fabs(gen_v());
-        pParts->m_TrajectoryTracker.at(t)->InsertNewParticle(p_new);
+        pParts->InsertNewParticle(pParts->m_TrajectoryTracker.at(t), p_new);
       }
     }
   }
 }
 
-void BehaviorPrediction::CollectParticles(ObjParticles* pParts)
-{
-  pParts->m_AllParticles.clear();
-  for(unsigned int t=0; t < pParts->m_TrajectoryTracker.size(); t++)
-  {
-    for(unsigned int i=0; i < pParts->m_TrajectoryTracker.at(t)->m_ForwardPart.size(); i++)
-    {
-      pParts->m_TrajectoryTracker.at(t)->m_ForwardPart.at(i).original_index = i;
-      pParts->m_AllParticles.push_back(&pParts->m_TrajectoryTracker.at(t)->m_ForwardPart.at(i));
-    }
-
-    for(unsigned int i=0; i < pParts->m_TrajectoryTracker.at(t)->m_StopPart.size(); i++)
-    {
-      pParts->m_TrajectoryTracker.at(t)->m_StopPart.at(i).original_index = i;
-      pParts->m_AllParticles.push_back(&pParts->m_TrajectoryTracker.at(t)->m_StopPart.at(i));
-    }
-  }
-}
-
-void BehaviorPrediction::MoveParticles(ObjParticles* pParts)
+void BehaviorPrediction::MoveParticles(ObjParticles* pParts, const double& dt)
 {
-  double dt = 0.01;
-  if(m_bStepByStep)
-  {
-    dt = 0.08;
-  }
-  else
-  {
-    dt = UtilityHNS::UtilityH::GetTimeDiffNow(m_ResamplingTimer);
-    UtilityHNS::UtilityH::GetTickCount(m_ResamplingTimer);
-    if(m_bFirstMove)
-    {
-      m_bFirstMove  = false;
-      return;
-    }
-  }
-
   PlannerHNS::BehaviorState curr_behavior;
   PlannerHNS::ParticleInfo curr_part_info;
   PlannerHNS::VehicleState control_u;
@@ -679,82 +787,133 @@ void BehaviorPrediction::MoveParticles(ObjParticles* pParts)
 //  else
 //    std::cout << "Acceleration: " << pParts->obj.acceleration_raw << ", Cruising  : " << pParts->obj.acceleration_desc << std::endl;
 
-  for(unsigned int i=0; i < pParts->m_AllParticles.size(); i++)
+  //the particles of one trajectory are moved together, they share the trajectory geometry and stop lines
+  ParticleBuffer& parts = pParts->m_Particles;
+  std::vector<unsigned int> order(parts.size());
+  for(unsigned int i=0; i < order.size(); i++)
+    order.at(i) = i;
+  std::stable_sort(order.begin(), order.end(), [&parts](const unsigned int& i1, const unsigned int& i2) { return parts.pTraj.at(i1) < parts.pTraj.at(i2); });
+
+  std::vector<PlannerHNS::ParticleInfo> parts_info(parts.size());
+  std::vector<PlannerHNS::BehaviorState> behaviors(parts.size());
+  std::vector<WayPoint> poses;
+  std::vector<PlannerHNS::ParticleInfo> batch_info;
+  std::vector<PlannerHNS::BehaviorState> batch_behaviors;
+  unsigned int iStart = 0;
+  while(iStart < order.size())
   {
-    Particle* p = pParts->m_AllParticles.at(i);
+    TrajectoryTracker* pTraj = parts.pTraj.at(order.at(iStart));
+    unsigned int iEnd = iStart;
+    poses.clear();
+    for(; iEnd < order.size() && parts.pTraj.at(order.at(iEnd)) == pTraj; iEnd++)
+    {
+      unsigned int i = order.at(iEnd);
+      WayPoint pose;
+      pose.pos.x = parts.x.at(i);
+      pose.pos.y = parts.y.at(i);
+      pose.pos.a = parts.a.at(i);
+      pose.v = (USE_OPEN_PLANNER_MOVE == 0) ? pParts->obj.center.v : parts.v.at(i);
+      poses.push_back(pose);
+    }
+
+    if(USE_OPEN_PLANNER_MOVE == 0)
+      decision_make.MoveStepsSimple(dt, poses, pTraj->trajectory, carInfo, batch_info);
+    else
+      decision_make.MoveSteps(dt, poses, pTraj->trajectory, carInfo, batch_behaviors);
+
+    for(unsigned int k = 0; k < poses.size(); k++)
+    {
+      unsigned int i = order.at(iStart + k);
+      parts.x.at(i) = poses.at(k).pos.x;
+      parts.y.at(i) = poses.at(k).pos.y;
+      parts.a.at(i) = poses.at(k).pos.a;
+      parts.v.at(i) = poses.at(k).v;
+      if(USE_OPEN_PLANNER_MOVE == 0)
+        parts_info.at(i) = batch_info.at(k);
+      else
+        behaviors.at(i) = batch_behaviors.at(k);
+    }
+    iStart = iEnd;
+  }
+
+  //the rest of the motion model works on a Particle, each particle is copied out of the buffer and back
+  for(unsigned int i=0; i < pParts->m_Particles.size(); i++)
+  {
+    Particle p = pParts->m_Particles.Get(i);
 
     if(USE_OPEN_PLANNER_MOVE == 0)
       {
-      p->pose.v = pParts->obj.center.v;
-      curr_part_info = decision_make.MoveStepSimple(dt, p->pose, p->pTraj->trajectory,carInfo);
-      if(p->prev_time_diff > ACCELERATION_CALC_TIME)
+      curr_part_info = parts_info.at(i);
+      if(p.prev_time_diff > ACCELERATION_CALC_TIME)
       {
-        p->acc_raw = (curr_part_info.vel - p->vel_prev_big)/p->prev_time_diff;
-        p->vel_prev_big = curr_part_info.vel;
-        p->prev_time_diff = 0;
+        p.acc_raw = (curr_part_info.vel - p.vel_prev_big)/p.prev_time_diff;
+        p.vel_prev_big = curr_part_info.vel;
+        p.prev_time_diff = 0;
       }
       else
       {
-        p->prev_time_diff += dt;
+        p.prev_time_diff += dt;
       }
 
-      if(fabs(p->acc_raw) < ACCELERATION_DECISION_VALUE)
-        p->acc = 0;
-      else if(p->acc_raw > ACCELERATION_DECISION_VALUE)
-        p->acc = 1;
-      else if(p->acc_raw < -ACCELERATION_DECISION_VALUE)
-        p->acc = -1;
-
-      p->indicator = FromIndicatorToNumber(curr_part_info.indicator);
-
-//      if(curr_behavior.state == PlannerHNS::STOPPING_STATE && p->beh == PlannerHNS::BEH_YIELDING_STATE)
-//        p->vel += 1;
-//      else if(p->beh == PlannerHNS::BEH_YIELDING_STATE)
-//        p->vel = p->vel/2.0;
-//      else if(curr_behavior.state != PlannerHNS::STOPPING_STATE && p->beh == PlannerHNS::BEH_STOPPING_STATE)
-//        p->vel += 1;
-//      else if(p->beh == PlannerHNS::BEH_STOPPING_STATE)
-//        p->vel = 0;
-
-//      if(curr_behavior.state != PlannerHNS::STOPPING_STATE && p->beh == PlannerHNS::BEH_STOPPING_STATE)
-//        p->vel += 1;
-      if(p->beh == PlannerHNS::BEH_STOPPING_STATE)
+      if(fabs(p.acc_raw) < ACCELERATION_DECISION_VALUE)
+        p.acc = 0;
+      else if(p.acc_raw > ACCELERATION_DECISION_VALUE)
+        p.acc = 1;
+      else if(p.acc_raw < -ACCELERATION_DECISION_VALUE)
+        p.acc = -1;
+
+      p.indicator = FromIndicatorToNumber(curr_part_info.indicator);
+
+//      if(curr_behavior.state == PlannerHNS::STOPPING_STATE && p.beh == PlannerHNS::BEH_YIELDING_STATE)
+//        p.vel += 1;
+//      else if(p.beh == PlannerHNS::BEH_YIELDING_STATE)
+//        p.vel = p.vel/2.0;
+//      else if(curr_behavior.state != PlannerHNS::STOPPING_STATE && p.beh == PlannerHNS::BEH_STOPPING_STATE)
+//        p.vel += 1;
+//      else if(p.beh == PlannerHNS::BEH_STOPPING_STATE)
+//        p.vel = 0;
+
+//      if(curr_behavior.state != PlannerHNS::STOPPING_STATE && p.beh == PlannerHNS::BEH_STOPPING_STATE)
+//        p.vel += 1;
+      if(p.beh == PlannerHNS::BEH_STOPPING_STATE)
       {
-        p->vel = 0;
-        if(p->acc == 0)
-          p->acc = -1;
-        else if(p->acc == 1)
-          p->acc = 0;
+        p.vel = 0;
+        if(p.acc == 0)
+          p.acc = -1;
+        else if(p.acc == 1)
+          p.acc = 0;
       }
 
       }
     else
       {
-      curr_behavior = decision_make.MoveStep(dt, p->pose, p->pTraj->trajectory,carInfo);
-      p->acc = UtilityHNS::UtilityH::GetSign(curr_behavior.maxVelocity - p->vel_prev_big);
-      p->vel = curr_behavior.maxVelocity;
-      if(fabs(p->vel - p->vel_prev_big) > 0.5)
-        p->vel_prev_big = p->vel;
-      p->indicator = FromIndicatorToNumber(curr_behavior.indicator);
-//      if(p->indicator == 0)
+      curr_behavior = behaviors.at(i);
+      p.acc = UtilityHNS::UtilityH::GetSign(curr_behavior.maxVelocity - p.vel_prev_big);
+      p.vel = curr_behavior.maxVelocity;
+      if(fabs(p.vel - p.vel_prev_big) > 0.5)
+        p.vel_prev_big = p.vel;
+      p.indicator = FromIndicatorToNumber(curr_behavior.indicator);
+//      if(p.indicator == 0)
 //        std::cout << ", Off";
-//      else if(p->indicator == 1)
+//      else if(p.indicator == 1)
 //        std::cout << ", Left";
-//      else if(p->indicator == 2)
+//      else if(p.indicator == 2)
 //        std::cout << ", Right";
 
-      if(curr_behavior.state == PlannerHNS::STOPPING_STATE && p->beh == PlannerHNS::BEH_YIELDING_STATE)
-        p->vel += 1;
-      else if(p->beh == PlannerHNS::BEH_YIELDING_STATE)
-        p->vel = p->vel/2.0;
-      else if(curr_behavior.state != PlannerHNS::STOPPING_STATE && p->beh == PlannerHNS::BEH_STOPPING_STATE)
-        p->vel += 1;
-      else if(p->beh == PlannerHNS::BEH_STOPPING_STATE)
+      if(curr_behavior.state == PlannerHNS::STOPPING_STATE && p.beh == PlannerHNS::BEH_YIELDING_STATE)
+        p.vel += 1;
+      else if(p.beh == PlannerHNS::BEH_YIELDING_STATE)
+        p.vel = p.vel/2.0;
+      else if(curr_behavior.state != PlannerHNS::STOPPING_STATE && p.beh == PlannerHNS::BEH_STOPPING_STATE)
+        p.vel += 1;
+      else if(p.beh == PlannerHNS::BEH_STOPPING_STATE)
       {
-        p->vel = 0;
+        p.vel = 0;
       }
 
       }
+
+    pParts->m_Particles.Set(i, p);
   }
   //std::cout << "End Motion Status ------ " << std::endl;
 }
@@ -0,0 +1,242 @@
+/// \file BehaviorStateTable.cpp
+/// \brief Table driven version of the DecisionMaker behavior state machine, the states are STATE_TYPE values
+/// \date Oct 14, 2026
+
+#include "op_planner/BehaviorStateTable.h"
+#include "op_utility/UtilityH.h"
+
+using namespace UtilityHNS;
+
+namespace PlannerHNS
+{
+
+static constexpr unsigned int StateBit(const STATE_TYPE& state)
+{
+  return 1u << state;
+}
+
+const BehaviorStateTable::TransitionFunction BehaviorStateTable::m_Transitions[BEHAVIOR_STATES_NUMBER] =
+{
+  &BehaviorStateTable::InitNext,             // INITIAL_STATE
+  &BehaviorStateTable::KeepState,            // WAITING_STATE
+  &BehaviorStateTable::ForwardNext,          // FORWARD_STATE
+  &BehaviorStateTable::KeepState,            // STOPPING_STATE
+  &BehaviorStateTable::KeepState,            // EMERGENCY_STATE
+  &BehaviorStateTable::TrafficLightStopNext, // TRAFFIC_LIGHT_STOP_STATE
+  &BehaviorStateTable::TrafficLightWaitNext, // TRAFFIC_LIGHT_WAIT_STATE
+  &BehaviorStateTable::StopSignStopNext,     // STOP_SIGN_STOP_STATE
+  &BehaviorStateTable::StopSignWaitNext,     // STOP_SIGN_WAIT_STATE
+  &BehaviorStateTable::FollowNext,           // FOLLOW_STATE
+  &BehaviorStateTable::KeepState,            // LANE_CHANGE_STATE
+  &BehaviorStateTable::SwerveNext,           // OBSTACLE_AVOIDANCE_STATE
+  &BehaviorStateTable::GoalNext,             // GOAL_STATE
+  &BehaviorStateTable::KeepState,            // FINISH_STATE
+  &BehaviorStateTable::KeepState,            // YIELDING_STATE
+  &BehaviorStateTable::KeepState,            // BRANCH_LEFT_STATE
+  &BehaviorStateTable::KeepState             // BRANCH_RIGHT_STATE
+};
+
+//the pNextStates lists built by DecisionMaker::InitBehaviorStates, every state can return to itself
+const unsigned int BehaviorStateTable::m_AllowedNextStates[BEHAVIOR_STATES_NUMBER] =
+{
+  StateBit(INITIAL_STATE) | StateBit(FORWARD_STATE),
+  StateBit(WAITING_STATE),
+  StateBit(FORWARD_STATE) | StateBit(GOAL_STATE) | StateBit(OBSTACLE_AVOIDANCE_STATE) | StateBit(STOP_SIGN_STOP_STATE)
+    | StateBit(TRAFFIC_LIGHT_STOP_STATE) | StateBit(FOLLOW_STATE),
+  StateBit(STOPPING_STATE),
+  StateBit(EMERGENCY_STATE),
+  StateBit(TRAFFIC_LIGHT_STOP_STATE) | StateBit(FORWARD_STATE) | StateBit(TRAFFIC_LIGHT_WAIT_STATE),
+  StateBit(TRAFFIC_LIGHT_WAIT_STATE) | StateBit(FORWARD_STATE) | StateBit(TRAFFIC_LIGHT_STOP_STATE) | StateBit(GOAL_STATE),
+  StateBit(STOP_SIGN_STOP_STATE) | StateBit(STOP_SIGN_WAIT_STATE),
+  StateBit(STOP_SIGN_WAIT_STATE) | StateBit(FORWARD_STATE) | StateBit(STOP_SIGN_STOP_STATE) | StateBit(GOAL_STATE),
+  StateBit(FOLLOW_STATE) | StateBit(FORWARD_STATE) | StateBit(OBSTACLE_AVOIDANCE_STATE) | StateBit(STOP_SIGN_STOP_STATE)
+    | StateBit(TRAFFIC_LIGHT_STOP_STATE) | StateBit(GOAL_STATE),
+  StateBit(LANE_CHANGE_STATE),
+  StateBit(OBSTACLE_AVOIDANCE_STATE) | StateBit(FORWARD_STATE),
+  StateBit(GOAL_STATE) | StateBit(FINISH_STATE) | StateBit(FORWARD_STATE),
+  StateBit(FINISH_STATE),
+  StateBit(YIELDING_STATE),
+  StateBit(BRANCH_LEFT_STATE),
+  StateBit(BRANCH_RIGHT_STATE)
+};
+
+BehaviorStateTable::BehaviorStateTable()
+{
+  m_ZeroVelocity = 0.1;
+  m_LastState = INITIAL_STATE;
+  for(int i = 0; i < BEHAVIOR_STATES_NUMBER; i++)
+    m_DecisionMakingTime[i] = 0;
+  UtilityH::GetTickCount(m_StateTimer);
+}
+
+void BehaviorStateTable::SetDecisionMakingTime(const STATE_TYPE& state, const double& time)
+{
+  m_DecisionMakingTime[state] = time;
+}
+
+void BehaviorStateTable::ResetTimer()
+{
+  UtilityH::GetTickCount(m_StateTimer);
+}
+
+bool BehaviorStateTable::IsTransitionAllowed(const STATE_TYPE& from, const STATE_TYPE& to)
+{
+  return (m_AllowedNextStates[from] & StateBit(to)) != 0;
+}
+
+STATE_TYPE BehaviorStateTable::GetNextState(const STATE_TYPE& current, const PlanningParams& params, PreCalculatedConditions& pre)
+{
+  //entered from outside the table
+  if(current != m_LastState)
+  {
+    m_LastState = current;
+    ResetTimer();
+  }
+
+  if(m_DecisionMakingTime[current] > 0 && UtilityH::GetTimeDiffNow(m_StateTimer) < m_DecisionMakingTime[current])
+    return current;
+
+  STATE_TYPE next = m_Transitions[current](current, params, pre, m_ZeroVelocity);
+  if(!IsTransitionAllowed(current, next))
+    next = INITIAL_STATE;
+
+  m_LastState = next;
+  ResetTimer();
+  return next;
+}
+
+STATE_TYPE BehaviorStateTable::KeepState(const STATE_TYPE& current, const PlanningParams& /*params*/, PreCalculatedConditions& /*pre*/, const double& /*zeroVelocity*/)
+{
+  return current;
+}
+
+STATE_TYPE BehaviorStateTable::ForwardNext(const STATE_TYPE& current, const PlanningParams& params, PreCalculatedConditions& pre, const double& /*zeroVelocity*/)
+{
+  if(pre.currentGoalID != pre.prevGoalID)
+    return GOAL_STATE;
+
+  else if(params.enableTrafficLightBehavior
+        && pre.currentTrafficLightID > 0
+        && pre.bTrafficIsRed
+        && pre.currentTrafficLightID != pre.prevTrafficLightID)
+      return TRAFFIC_LIGHT_STOP_STATE;
+
+  else if(params.enableStopSignBehavior
+      && pre.currentStopSignID > 0
+      && pre.currentStopSignID != pre.prevStopSignID)
+    return STOP_SIGN_STOP_STATE;
+
+  else if(params.enableFollowing && pre.bFullyBlock)
+    return FOLLOW_STATE;
+
+  else if(params.enableSwerving
+      && pre.distanceToNext <= params.minDistanceToAvoid
+      && !pre.bFullyBlock
+      && pre.iCurrSafeTrajectory != pre.iPrevSafeTrajectory)
+    return OBSTACLE_AVOIDANCE_STATE;
+
+  else
+    return current;
+}
+
+STATE_TYPE BehaviorStateTable::FollowNext(const STATE_TYPE& current, const PlanningParams& params, PreCalculatedConditions& pre, const double& /*zeroVelocity*/)
+{
+  if(pre.currentGoalID != pre.prevGoalID)
+    return GOAL_STATE;
+
+  else if(params.enableTrafficLightBehavior
+        && pre.currentTrafficLightID > 0
+        && pre.bTrafficIsRed
+        && pre.currentTrafficLightID != pre.prevTrafficLightID)
+      return TRAFFIC_LIGHT_STOP_STATE;
+
+  else if(params.enableStopSignBehavior
+      && pre.currentStopSignID > 0
+      && pre.currentStopSignID != pre.prevStopSignID)
+    return STOP_SIGN_STOP_STATE;
+
+  else if(params.enableSwerving
+      && pre.distanceToNext <= params.minDistanceToAvoid
+      && !pre.bFullyBlock
+      && pre.iCurrSafeTrajectory != pre.iPrevSafeTrajectory)
+    return OBSTACLE_AVOIDANCE_STATE;
+
+  else if(!pre.bFullyBlock)
+    return FORWARD_STATE;
+
+  else
+    return current;
+}
+
+STATE_TYPE BehaviorStateTable::SwerveNext(const STATE_TYPE& /*current*/, const PlanningParams& /*params*/, PreCalculatedConditions& pre, const double& /*zeroVelocity*/)
+{
+  pre.iPrevSafeTrajectory = pre.iCurrSafeTrajectory;
+  pre.bRePlan = true;
+
+  return FORWARD_STATE;
+}
+
+STATE_TYPE BehaviorStateTable::InitNext(const STATE_TYPE& current, const PlanningParams& /*params*/, PreCalculatedConditions& pre, const double& /*zeroVelocity*/)
+{
+  if(pre.currentGoalID > 0)
+    return FORWARD_STATE;
+  else
+    return current;
+}
+
+STATE_TYPE BehaviorStateTable::GoalNext(const STATE_TYPE& /*current*/, const PlanningParams& /*params*/, PreCalculatedConditions& pre, const double& /*zeroVelocity*/)
+{
+  if(pre.currentGoalID == -1)
+    return FINISH_STATE;
+
+  pre.prevGoalID = pre.currentGoalID;
+  return FORWARD_STATE;
+}
+
+STATE_TYPE BehaviorStateTable::StopSignStopNext(const STATE_TYPE& current, const PlanningParams& /*params*/, PreCalculatedConditions& pre, const double& zeroVelocity)
+{
+  if(pre.currentGoalID != pre.prevGoalID)
+    return GOAL_STATE;
+
+  else if(pre.currentVelocity < zeroVelocity)
+    return STOP_SIGN_WAIT_STATE;
+
+  else
+    return current;
+}
+
+STATE_TYPE BehaviorStateTable::StopSignWaitNext(const STATE_TYPE& /*current*/, const PlanningParams& /*params*/, PreCalculatedConditions& pre, const double& /*zeroVelocity*/)
+{
+  pre.prevStopSignID = pre.currentStopSignID;
+
+  return FORWARD_STATE;
+}
+
+STATE_TYPE BehaviorStateTable::TrafficLightStopNext(const STATE_TYPE& current, const PlanningParams& /*params*/, PreCalculatedConditions& pre, const double& zeroVelocity)
+{
+  if(!pre.bTrafficIsRed)
+  {
+    pre.prevTrafficLightID = pre.currentTrafficLightID;
+    return FORWARD_STATE;
+  }
+
+  else if(pre.bTrafficIsRed && pre.currentVelocity <= zeroVelocity)
+    return TRAFFIC_LIGHT_WAIT_STATE;
+
+  else
+    return current;
+}
+
+STATE_TYPE BehaviorStateTable::TrafficLightWaitNext(const STATE_TYPE& current, const PlanningParams& /*params*/, PreCalculatedConditions& pre, const double& /*zeroVelocity*/)
+{
+  if(!pre.bTrafficIsRed)
+  {
+    pre.prevTrafficLightID = pre.currentTrafficLightID;
+    return FORWARD_STATE;
+  }
+
+  else
+    return current;
+}
+
+} /* namespace PlannerHNS */
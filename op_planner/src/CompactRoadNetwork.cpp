@@ -0,0 +1,687 @@
+/// \file CompactRoadNetwork.cpp
+/// \brief Compact storage of a large RoadNetwork, waypoints in flat arrays with their links as indices, expanded on demand
+/// \date Oct 14, 2026
+
+#include "op_planner/CompactRoadNetwork.h"
+#include "op_planner/MappingHelpers.h"
+#include <algorithm>
+#include <climits>
+
+namespace PlannerHNS
+{
+
+template<typename T> static size_t GetVectorBytes(const std::vector<T>& v)
+{
+  return v.capacity() * sizeof(T);
+}
+
+template<typename T> static void MoveLink(const std::unordered_map<const T*, T*>& index, T*& pObj)
+{
+  typename std::unordered_map<const T*, T*>::const_iterator it = index.find(pObj);
+  pObj = it != index.end() ? it->second : nullptr;
+}
+
+template<typename T> static void MoveLinks(const std::unordered_map<const T*, T*>& index, std::vector<T*>& objs)
+{
+  for(unsigned int i = 0; i < objs.size(); i++)
+    MoveLink(index, objs.at(i));
+}
+
+//the lane and segment pointers of dst that point into src are moved to the same element of dst, null when they point out of src.
+//src and dst have the same segments and lanes
+static void MoveMapLinks(const RoadNetwork& src, RoadNetwork& dst)
+{
+  std::unordered_map<const RoadSegment*, RoadSegment*> segments;
+  std::unordered_map<const Lane*, Lane*> lanes;
+  for(unsigned int rs = 0; rs < src.roadSegments.size(); rs++)
+  {
+    segments[&src.roadSegments.at(rs)] = &dst.roadSegments.at(rs);
+    for(unsigned int i = 0; i < src.roadSegments.at(rs).Lanes.size(); i++)
+      lanes[&src.roadSegments.at(rs).Lanes.at(i)] = &dst.roadSegments.at(rs).Lanes.at(i);
+  }
+
+  for(unsigned int rs = 0; rs < dst.roadSegments.size(); rs++)
+  {
+    RoadSegment& seg = dst.roadSegments.at(rs);
+    MoveLink(segments, seg.boundary.pSegment);
+    MoveLink(segments, seg.start_crossing.pSegment);
+    MoveLink(segments, seg.finish_crossing.pSegment);
+    MoveLinks(segments, seg.fromLanes);
+    MoveLinks(segments, seg.toLanes);
+    for(unsigned int i = 0; i < seg.Lanes.size(); i++)
+    {
+      Lane& l = seg.Lanes.at(i);
+      MoveLinks(lanes, l.fromLanes);
+      MoveLinks(lanes, l.toLanes);
+      MoveLink(lanes, l.pLeftLane);
+      MoveLink(lanes, l.pRightLane);
+      MoveLink(segments, l.pRoad);
+      MoveLink(lanes, l.waitingLine.pLane);
+      for(unsigned int j = 0; j < l.trafficlights.size(); j++)
+        MoveLinks(lanes, l.trafficlights.at(j).pLanes);
+      for(unsigned int j = 0; j < l.stopLines.size(); j++)
+        MoveLink(lanes, l.stopLines.at(j).pLane);
+    }
+  }
+
+  for(unsigned int i = 0; i < dst.trafficLights.size(); i++)
+    MoveLinks(lanes, dst.trafficLights.at(i).pLanes);
+  for(unsigned int i = 0; i < dst.stopLines.size(); i++)
+    MoveLink(lanes, dst.stopLines.at(i).pLane);
+  for(unsigned int i = 0; i < dst.curbs.size(); i++)
+    MoveLink(lanes, dst.curbs.at(i).pLane);
+  for(unsigned int i = 0; i < dst.boundaries.size(); i++)
+    MoveLink(segments, dst.boundaries.at(i).pSegment);
+  for(unsigned int i = 0; i < dst.crossings.size(); i++)
+    MoveLink(segments, dst.crossings.at(i).pSegment);
+  for(unsigned int i = 0; i < dst.markings.size(); i++)
+    MoveLink(lanes, dst.markings.at(i).pLane);
+  for(unsigned int i = 0; i < dst.signs.size(); i++)
+    MoveLink(lanes, dst.signs.at(i).pLane);
+}
+
+//ids are the ids of the waypoints, in the same order, none of them null
+static bool HasIdsOf(const std::vector<int>& ids, const std::vector<WayPoint*>& points)
+{
+  if(ids.size() != points.size()) return false;
+  for(unsigned int i = 0; i < ids.size(); i++)
+  {
+    if(points.at(i) == nullptr || points.at(i)->id != ids.at(i))
+      return false;
+  }
+  return true;
+}
+
+//every field of the lane except its points
+static void CopyLaneWithoutPoints(const Lane& src, Lane& dst)
+{
+  dst.id = src.id;
+  dst.roadId = src.roadId;
+  dst.areaId = src.areaId;
+  dst.fromAreaId = src.fromAreaId;
+  dst.toAreaId = src.toAreaId;
+  dst.fromIds = src.fromIds;
+  dst.toIds = src.toIds;
+  dst.num = src.num;
+  dst.speed = src.speed;
+  dst.length = src.length;
+  dst.dir = src.dir;
+  dst.type = src.type;
+  dst.width = src.width;
+  dst.points.clear();
+  dst.trafficlights = src.trafficlights;
+  dst.stopLines = src.stopLines;
+  dst.waitingLine = src.waitingLine;
+  dst.fromLanes = src.fromLanes;
+  dst.toLanes = src.toLanes;
+  dst.pLeftLane = src.pLeftLane;
+  dst.pRightLane = src.pRightLane;
+  dst.pRoad = src.pRoad;
+}
+
+static void CopySegmentWithoutPoints(const RoadSegment& src, RoadSegment& dst)
+{
+  dst.id = src.id;
+  dst.roadType = src.roadType;
+  dst.boundary = src.boundary;
+  dst.start_crossing = src.start_crossing;
+  dst.finish_crossing = src.finish_crossing;
+  dst.avgWidth = src.avgWidth;
+  dst.fromIds = src.fromIds;
+  dst.toIds = src.toIds;
+  dst.fromLanes = src.fromLanes;
+  dst.toLanes = src.toLanes;
+  dst.Lanes.resize(src.Lanes.size());
+  for(unsigned int i = 0; i < src.Lanes.size(); i++)
+    CopyLaneWithoutPoints(src.Lanes.at(i), dst.Lanes.at(i));
+}
+
+void CompactRoadNetwork::SparseLists::Clear()
+{
+  points.clear();
+  start.assign(1, 0);
+}
+
+void CompactRoadNetwork::SparseLists::Add(const int& iPoint, const int& nValues)
+{
+  points.push_back(iPoint);
+  start.push_back(nValues);
+}
+
+bool CompactRoadNetwork::SparseLists::Find(const int& iPoint, int& iBegin, int& iEnd) const
+{
+  std::vector<int>::const_iterator it = std::lower_bound(points.begin(), points.end(), iPoint);
+  if(it == points.end() || *it != iPoint) return false;
+  int i = it - points.begin();
+  iBegin = start.at(i);
+  iEnd = start.at(i + 1);
+  return true;
+}
+
+size_t CompactRoadNetwork::SparseLists::GetMemoryBytes() const
+{
+  return GetVectorBytes(points) + GetVectorBytes(start);
+}
+
+CompactRoadNetwork::CompactRoadNetwork()
+{
+  Clear();
+}
+
+CompactRoadNetwork::~CompactRoadNetwork()
+{
+}
+
+void CompactRoadNetwork::Clear()
+{
+  m_Objects = RoadNetwork();
+  m_LaneFirstPoint.assign(1, 0);
+  m_X.clear(); m_Y.clear(); m_Z.clear(); m_A.clear(); m_V.clear();
+  m_Lat.clear(); m_Lon.clear(); m_Alt.clear(); m_Dir.clear();
+  m_OriginalIndices.clear(); m_Gids.clear();
+  m_Ids.clear(); m_LaneIds.clear(); m_LeftPointIds.clear(); m_RightPointIds.clear();
+  m_LeftLnIds.clear(); m_RightLnIds.clear(); m_StopLineIds.clear(); m_OriginalMapIds.clear();
+  m_PointLane.clear(); m_Left.clear(); m_Right.clear();
+  m_FrontStart.assign(1, 0); m_Fronts.clear();
+  m_FromIdStart.assign(1, 0); m_FromIds.clear();
+  m_BackLists.Clear(); m_Backs.clear();
+  m_ToIdLists.Clear(); m_ToIds.clear();
+  m_ActionLists.Clear(); m_ActionTypes.clear(); m_ActionCosts.clear();
+  m_Extras.clear();
+  m_IdIndex.clear();
+  m_Lanes.clear();
+}
+
+void CompactRoadNetwork::IndexLanes()
+{
+  m_Lanes.clear();
+  for(unsigned int rs = 0; rs < m_Objects.roadSegments.size(); rs++)
+    for(unsigned int i = 0; i < m_Objects.roadSegments.at(rs).Lanes.size(); i++)
+      m_Lanes.push_back(&m_Objects.roadSegments.at(rs).Lanes.at(i));
+}
+
+void CompactRoadNetwork::Build(const RoadNetwork& map)
+{
+  Clear();
+
+  m_Objects.roadSegments.resize(map.roadSegments.size());
+  for(unsigned int rs = 0; rs < map.roadSegments.size(); rs++)
+    CopySegmentWithoutPoints(map.roadSegments.at(rs), m_Objects.roadSegments.at(rs));
+  m_Objects.trafficLights = map.trafficLights;
+  m_Objects.stopLines = map.stopLines;
+  m_Objects.curbs = map.curbs;
+  m_Objects.boundaries = map.boundaries;
+  m_Objects.crossings = map.crossings;
+  m_Objects.markings = map.markings;
+  m_Objects.signs = map.signs;
+  m_Objects.version = map.version;
+  MoveMapLinks(map, m_Objects);
+  IndexLanes();
+
+  std::unordered_map<const Lane*, int> lane_index;
+  std::unordered_map<const WayPoint*, int> point_index;
+  int nPoints = 0;
+  for(unsigned int rs = 0; rs < map.roadSegments.size(); rs++)
+  {
+    for(unsigned int i = 0; i < map.roadSegments.at(rs).Lanes.size(); i++)
+    {
+      const Lane& l = map.roadSegments.at(rs).Lanes.at(i);
+      lane_index[&l] = m_LaneFirstPoint.size() - 1;
+      for(unsigned int p = 0; p < l.points.size(); p++)
+        point_index[&l.points.at(p)] = nPoints++;
+      m_LaneFirstPoint.push_back(nPoints);
+    }
+  }
+
+  m_X.reserve(nPoints); m_Y.reserve(nPoints); m_Z.reserve(nPoints); m_A.reserve(nPoints); m_V.reserve(nPoints);
+  m_Lat.reserve(nPoints); m_Lon.reserve(nPoints); m_Alt.reserve(nPoints); m_Dir.reserve(nPoints);
+  m_OriginalIndices.reserve(nPoints); m_Gids.reserve(nPoints);
+  m_Ids.reserve(nPoints); m_LaneIds.reserve(nPoints); m_LeftPointIds.reserve(nPoints); m_RightPointIds.reserve(nPoints);
+  m_LeftLnIds.reserve(nPoints); m_RightLnIds.reserve(nPoints); m_StopLineIds.reserve(nPoints); m_OriginalMapIds.reserve(nPoints);
+  m_PointLane.reserve(nPoints); m_Left.reserve(nPoints); m_Right.reserve(nPoints);
+  m_FrontStart.reserve(nPoints + 1); m_FromIdStart.reserve(nPoints + 1);
+  m_IdIndex.reserve(nPoints);
+
+  bool bLat = false, bLon = false, bAlt = false, bDir = false, bOriginalIndices = false, bGids = false;
+  bool bLaneIds = false, bPointLane = false, bStopLineIds = false, bOriginalMapIds = false;
+  const WayPoint def;
+  for(unsigned int rs = 0; rs < map.roadSegments.size(); rs++)
+  {
+    for(unsigned int i = 0; i < map.roadSegments.at(rs).Lanes.size(); i++)
+    {
+      const Lane& l = map.roadSegments.at(rs).Lanes.at(i);
+      for(unsigned int p = 0; p < l.points.size(); p++)
+      {
+        const WayPoint& wp = l.points.at(p);
+        int iPoint = m_X.size();
+        m_X.push_back(wp.pos.x);
+        m_Y.push_back(wp.pos.y);
+        m_Z.push_back(wp.pos.z);
+        m_A.push_back(wp.pos.a);
+        m_V.push_back(wp.v);
+        m_Lat.push_back(wp.pos.lat);
+        m_Lon.push_back(wp.pos.lon);
+        m_Alt.push_back(wp.pos.alt);
+        m_Dir.push_back(wp.pos.dir);
+        m_OriginalIndices.push_back(wp.iOriginalIndex);
+        m_Gids.push_back(wp.gid);
+        bLat |= wp.pos.lat != wp.pos.x;
+        bLon |= wp.pos.lon != wp.pos.y;
+        bAlt |= wp.pos.alt != wp.pos.z;
+        bDir |= wp.pos.dir != wp.pos.a;
+        bOriginalIndices |= wp.iOriginalIndex != 0;
+        bGids |= wp.gid != 0;
+        m_Ids.push_back(wp.id);
+        m_LaneIds.push_back(wp.laneId);
+        m_LeftPointIds.push_back(wp.LeftPointId);
+        m_RightPointIds.push_back(wp.RightPointId);
+        m_LeftLnIds.push_back(wp.LeftLnId);
+        m_RightLnIds.push_back(wp.RightLnId);
+        m_StopLineIds.push_back(wp.stopLineID);
+        m_OriginalMapIds.push_back(wp.originalMapID);
+        m_IdIndex.push_back(std::make_pair(wp.id, iPoint));
+
+        std::unordered_map<const Lane*, int>::const_iterator it_lane = lane_index.find(wp.pLane);
+        m_PointLane.push_back(it_lane != lane_index.end() ? it_lane->second : -1);
+        bLaneIds |= wp.laneId != l.id;
+        bPointLane |= wp.pLane != &l;
+        bStopLineIds |= wp.stopLineID != -1;
+        bOriginalMapIds |= wp.originalMapID != -1;
+        std::unordered_map<const WayPoint*, int>::const_iterator it_point = point_index.find(wp.pLeft);
+        m_Left.push_back(it_point != point_index.end() ? it_point->second : -1);
+        it_point = point_index.find(wp.pRight);
+        m_Right.push_back(it_point != point_index.end() ? it_point->second : -1);
+
+        for(unsigned int j = 0; j < wp.pFronts.size(); j++)
+        {
+          it_point = point_index.find(wp.pFronts.at(j));
+          m_Fronts.push_back(it_point != point_index.end() ? it_point->second : -1);
+        }
+        m_FrontStart.push_back(m_Fronts.size());
+        m_FromIds.insert(m_FromIds.end(), wp.fromIds.begin(), wp.fromIds.end());
+        m_FromIdStart.push_back(m_FromIds.size());
+
+        if(wp.pBacks.size() > 0)
+        {
+          for(unsigned int j = 0; j < wp.pBacks.size(); j++)
+          {
+            it_point = point_index.find(wp.pBacks.at(j));
+            m_Backs.push_back(it_point != point_index.end() ? it_point->second : -1);
+          }
+          m_BackLists.Add(iPoint, m_Backs.size());
+        }
+
+        if(!HasIdsOf(wp.toIds, wp.pFronts))
+        {
+          m_ToIds.insert(m_ToIds.end(), wp.toIds.begin(), wp.toIds.end());
+          m_ToIdLists.Add(iPoint, m_ToIds.size());
+        }
+
+        if(wp.actionCost.size() > 0)
+        {
+          for(unsigned int j = 0; j < wp.actionCost.size(); j++)
+          {
+            m_ActionTypes.push_back(wp.actionCost.at(j).first);
+            m_ActionCosts.push_back(wp.actionCost.at(j).second);
+          }
+          m_ActionLists.Add(iPoint, m_ActionTypes.size());
+        }
+
+        if(wp.rot.x != def.rot.x || wp.rot.y != def.rot.y || wp.rot.z != def.rot.z || wp.rot.w != def.rot.w
+            || wp.cost != def.cost || wp.timeCost != def.timeCost || wp.totalReward != def.totalReward
+            || wp.collisionCost != def.collisionCost || wp.laneChangeCost != def.laneChangeCost
+            || wp.bDir != def.bDir || wp.state != def.state || wp.beh_state != def.beh_state)
+        {
+          PointExtras extras;
+          extras.iPoint = iPoint;
+          extras.rot = wp.rot;
+          extras.cost = wp.cost;
+          extras.timeCost = wp.timeCost;
+          extras.totalReward = wp.totalReward;
+          extras.collisionCost = wp.collisionCost;
+          extras.laneChangeCost = wp.laneChangeCost;
+          extras.bDir = wp.bDir;
+          extras.state = wp.state;
+          extras.beh_state = wp.beh_state;
+          m_Extras.push_back(extras);
+        }
+      }
+    }
+  }
+
+  if(!bLat) std::vector<double>().swap(m_Lat);
+  if(!bLon) std::vector<double>().swap(m_Lon);
+  if(!bAlt) std::vector<double>().swap(m_Alt);
+  if(!bDir) std::vector<double>().swap(m_Dir);
+  if(!bOriginalIndices) std::vector<int>().swap(m_OriginalIndices);
+  if(!bGids) std::vector<int>().swap(m_Gids);
+  if(!bLaneIds) std::vector<int>().swap(m_LaneIds);
+  if(!bPointLane) std::vector<int>().swap(m_PointLane);
+  if(!bStopLineIds) std::vector<int>().swap(m_StopLineIds);
+  if(!bOriginalMapIds) std::vector<int>().swap(m_OriginalMapIds);
+
+  //the ids are sorted with their map order, so the first match is the first waypoint of the map with the id
+  std::sort(m_IdIndex.begin(), m_IdIndex.end());
+  m_Fronts.shrink_to_fit();
+  m_FromIds.shrink_to_fit();
+  m_Backs.shrink_to_fit();
+  m_ToIds.shrink_to_fit();
+  m_ActionTypes.shrink_to_fit();
+  m_ActionCosts.shrink_to_fit();
+  m_Extras.shrink_to_fit();
+}
+
+void CompactRoadNetwork::Expand(RoadNetwork& map) const
+{
+  RoadNetwork expanded;
+  expanded.roadSegments = m_Objects.roadSegments;
+  expanded.trafficLights = m_Objects.trafficLights;
+  expanded.stopLines = m_Objects.stopLines;
+  expanded.curbs = m_Objects.curbs;
+  expanded.boundaries = m_Objects.boundaries;
+  expanded.crossings = m_Objects.crossings;
+  expanded.markings = m_Objects.markings;
+  expanded.signs = m_Objects.signs;
+  MoveMapLinks(m_Objects, expanded);
+
+  std::vector<Lane*> lanes;
+  std::vector<WayPoint*> points(GetNumberOfPoints());
+  for(unsigned int rs = 0; rs < expanded.roadSegments.size(); rs++)
+  {
+    for(unsigned int i = 0; i < expanded.roadSegments.at(rs).Lanes.size(); i++)
+    {
+      Lane* pL = &expanded.roadSegments.at(rs).Lanes.at(i);
+      int iFirst = m_LaneFirstPoint.at(lanes.size());
+      int iEnd = m_LaneFirstPoint.at(lanes.size() + 1);
+      lanes.push_back(pL);
+      pL->points.resize(iEnd - iFirst);
+      for(int p = iFirst; p < iEnd; p++)
+      {
+        GetWayPoint(p, pL->points.at(p - iFirst));
+        points.at(p) = &pL->points.at(p - iFirst);
+      }
+    }
+  }
+
+  for(unsigned int p = 0; p < points.size(); p++)
+  {
+    WayPoint* pWP = points.at(p);
+    int iLane = GetPointLane(p);
+    pWP->pLane = iLane >= 0 ? lanes.at(iLane) : nullptr;
+    pWP->pLeft = m_Left.at(p) >= 0 ? points.at(m_Left.at(p)) : nullptr;
+    pWP->pRight = m_Right.at(p) >= 0 ? points.at(m_Right.at(p)) : nullptr;
+    for(int j = m_FrontStart.at(p); j < m_FrontStart.at(p + 1); j++)
+      pWP->pFronts.push_back(m_Fronts.at(j) >= 0 ? points.at(m_Fronts.at(j)) : nullptr);
+    int n = 0;
+    const int* pBacks = GetBacks(p, n);
+    for(int j = 0; j < n; j++)
+      pWP->pBacks.push_back(pBacks[j] >= 0 ? points.at(pBacks[j]) : nullptr);
+  }
+
+  //moving the vectors keeps the addresses of their elements, the links stay valid
+  map = std::move(expanded);
+  map.spatialIndex.Build(map.roadSegments);
+  map.idIndex.Build(map.roadSegments);
+  MappingHelpers::UpdateMapVersion(map);
+}
+
+unsigned int CompactRoadNetwork::GetNumberOfPoints() const
+{
+  return m_X.size();
+}
+
+unsigned int CompactRoadNetwork::GetNumberOfLanes() const
+{
+  return m_Lanes.size();
+}
+
+Lane* CompactRoadNetwork::GetLane(const int& iLane)
+{
+  if(iLane < 0 || iLane >= (int)m_Lanes.size()) return nullptr;
+  return m_Lanes.at(iLane);
+}
+
+int CompactRoadNetwork::GetLaneIndexOfPoint(const int& iPoint) const
+{
+  if(iPoint < 0 || iPoint >= (int)GetNumberOfPoints()) return -1;
+  return std::upper_bound(m_LaneFirstPoint.begin(), m_LaneFirstPoint.end(), iPoint) - m_LaneFirstPoint.begin() - 1;
+}
+
+const CompactRoadNetwork::PointExtras* CompactRoadNetwork::FindExtras(const int& iPoint) const
+{
+  int i0 = 0, i1 = m_Extras.size();
+  while(i0 < i1)
+  {
+    int im = (i0 + i1) / 2;
+    if(m_Extras.at(im).iPoint < iPoint)
+      i0 = im + 1;
+    else
+      i1 = im;
+  }
+
+  if(i0 < (int)m_Extras.size() && m_Extras.at(i0).iPoint == iPoint)
+    return &m_Extras.at(i0);
+  return nullptr;
+}
+
+void CompactRoadNetwork::GetWayPoint(const int& iPoint, WayPoint& wp) const
+{
+  wp = WayPoint(m_X.at(iPoint), m_Y.at(iPoint), m_Z.at(iPoint), m_A.at(iPoint));
+  wp.pos.lat = m_Lat.size() > 0 ? m_Lat.at(iPoint) : wp.pos.x;
+  wp.pos.lon = m_Lon.size() > 0 ? m_Lon.at(iPoint) : wp.pos.y;
+  wp.pos.alt = m_Alt.size() > 0 ? m_Alt.at(iPoint) : wp.pos.z;
+  wp.pos.dir = m_Dir.size() > 0 ? m_Dir.at(iPoint) : wp.pos.a;
+  wp.iOriginalIndex = m_OriginalIndices.size() > 0 ? m_OriginalIndices.at(iPoint) : 0;
+  wp.gid = m_Gids.size() > 0 ? m_Gids.at(iPoint) : 0;
+  wp.v = m_V.at(iPoint);
+  wp.id = m_Ids.at(iPoint);
+  wp.laneId = m_LaneIds.size() > 0 ? m_LaneIds.at(iPoint) : m_Lanes.at(GetLaneIndexOfPoint(iPoint))->id;
+  wp.LeftPointId = m_LeftPointIds.at(iPoint);
+  wp.RightPointId = m_RightPointIds.at(iPoint);
+  wp.LeftLnId = m_LeftLnIds.at(iPoint);
+  wp.RightLnId = m_RightLnIds.at(iPoint);
+  wp.stopLineID = m_StopLineIds.size() > 0 ? m_StopLineIds.at(iPoint) : -1;
+  wp.originalMapID = m_OriginalMapIds.size() > 0 ? m_OriginalMapIds.at(iPoint) : -1;
+  wp.fromIds.assign(m_FromIds.begin() + m_FromIdStart.at(iPoint), m_FromIds.begin() + m_FromIdStart.at(iPoint + 1));
+
+  int iBegin = 0, iEnd = 0;
+  if(m_ToIdLists.Find(iPoint, iBegin, iEnd))
+  {
+    wp.toIds.assign(m_ToIds.begin() + iBegin, m_ToIds.begin() + iEnd);
+  }
+  else
+  {
+    for(int j = m_FrontStart.at(iPoint); j < m_FrontStart.at(iPoint + 1); j++)
+      wp.toIds.push_back(m_Ids.at(m_Fronts.at(j)));
+  }
+
+  if(m_ActionLists.Find(iPoint, iBegin, iEnd))
+  {
+    for(int j = iBegin; j < iEnd; j++)
+      wp.actionCost.push_back(std::make_pair((ACTION_TYPE)m_ActionTypes.at(j), m_ActionCosts.at(j)));
+  }
+
+  const PointExtras* pExtras = FindExtras(iPoint);
+  if(pExtras != nullptr)
+  {
+    wp.rot = pExtras->rot;
+    wp.cost = pExtras->cost;
+    wp.timeCost = pExtras->timeCost;
+    wp.totalReward = pExtras->totalReward;
+    wp.collisionCost = pExtras->collisionCost;
+    wp.laneChangeCost = pExtras->laneChangeCost;
+    wp.bDir = (DIRECTION_TYPE)pExtras->bDir;
+    wp.state = (STATE_TYPE)pExtras->state;
+    wp.beh_state = (BEH_STATE_TYPE)pExtras->beh_state;
+  }
+}
+
+const int* CompactRoadNetwork::GetFronts(const int& iPoint, int& n) const
+{
+  n = m_FrontStart.at(iPoint + 1) - m_FrontStart.at(iPoint);
+  return n > 0 ? &m_Fronts.at(m_FrontStart.at(iPoint)) : nullptr;
+}
+
+const int* CompactRoadNetwork::GetBacks(const int& iPoint, int& n) const
+{
+  int iBegin = 0, iEnd = 0;
+  n = 0;
+  if(!m_BackLists.Find(iPoint, iBegin, iEnd)) return nullptr;
+  n = iEnd - iBegin;
+  return n > 0 ? &m_Backs.at(iBegin) : nullptr;
+}
+
+int CompactRoadNetwork::GetLeft(const int& iPoint) const
+{
+  return m_Left.at(iPoint);
+}
+
+int CompactRoadNetwork::GetRight(const int& iPoint) const
+{
+  return m_Right.at(iPoint);
+}
+
+int CompactRoadNetwork::GetPointLane(const int& iPoint) const
+{
+  if(m_PointLane.size() > 0)
+    return m_PointLane.at(iPoint);
+  return GetLaneIndexOfPoint(iPoint);
+}
+
+int CompactRoadNetwork::FindPointIndex(const int& pointId) const
+{
+  std::vector<std::pair<int, int> >::const_iterator it = std::lower_bound(m_IdIndex.begin(), m_IdIndex.end(), std::make_pair(pointId, INT_MIN));
+  if(it != m_IdIndex.end() && it->first == pointId)
+    return it->second;
+  return -1;
+}
+
+size_t CompactRoadNetwork::GetMemoryBytes() const
+{
+  size_t bytes = sizeof(*this) + GetMemoryBytes(m_Objects) + GetVectorBytes(m_LaneFirstPoint) + GetVectorBytes(m_Lanes);
+  bytes += GetVectorBytes(m_X) + GetVectorBytes(m_Y) + GetVectorBytes(m_Z) + GetVectorBytes(m_A) + GetVectorBytes(m_V);
+  bytes += GetVectorBytes(m_Lat) + GetVectorBytes(m_Lon) + GetVectorBytes(m_Alt) + GetVectorBytes(m_Dir);
+  bytes += GetVectorBytes(m_OriginalIndices) + GetVectorBytes(m_Gids);
+  bytes += GetVectorBytes(m_Ids) + GetVectorBytes(m_LaneIds) + GetVectorBytes(m_LeftPointIds) + GetVectorBytes(m_RightPointIds);
+  bytes += GetVectorBytes(m_LeftLnIds) + GetVectorBytes(m_RightLnIds) + GetVectorBytes(m_StopLineIds) + GetVectorBytes(m_OriginalMapIds);
+  bytes += GetVectorBytes(m_PointLane) + GetVectorBytes(m_Left) + GetVectorBytes(m_Right);
+  bytes += GetVectorBytes(m_FrontStart) + GetVectorBytes(m_Fronts) + GetVectorBytes(m_FromIdStart) + GetVectorBytes(m_FromIds);
+  bytes += m_BackLists.GetMemoryBytes() + GetVectorBytes(m_Backs) + m_ToIdLists.GetMemoryBytes() + GetVectorBytes(m_ToIds);
+  bytes += m_ActionLists.GetMemoryBytes() + GetVectorBytes(m_ActionTypes) + GetVectorBytes(m_ActionCosts);
+  bytes += GetVectorBytes(m_Extras) + GetVectorBytes(m_IdIndex);
+  return bytes;
+}
+
+size_t CompactRoadNetwork::GetMemoryBytes(const RoadNetwork& map)
+{
+  size_t bytes = sizeof(RoadNetwork) + GetVectorBytes(map.roadSegments);
+  for(unsigned int rs = 0; rs < map.roadSegments.size(); rs++)
+  {
+    const RoadSegment& seg = map.roadSegments.at(rs);
+    bytes += GetVectorBytes(seg.Lanes) + GetVectorBytes(seg.fromIds) + GetVectorBytes(seg.toIds);
+    bytes += GetVectorBytes(seg.fromLanes) + GetVectorBytes(seg.toLanes);
+    bytes += GetVectorBytes(seg.boundary.points) + GetVectorBytes(seg.start_crossing.points) + GetVectorBytes(seg.finish_crossing.points);
+    for(unsigned int i = 0; i < seg.Lanes.size(); i++)
+    {
+      const Lane& l = seg.Lanes.at(i);
+      bytes += GetVectorBytes(l.fromIds) + GetVectorBytes(l.toIds) + GetVectorBytes(l.fromLanes) + GetVectorBytes(l.toLanes);
+      bytes += GetVectorBytes(l.trafficlights) + GetVectorBytes(l.stopLines) + GetVectorBytes(l.waitingLine.points);
+      for(unsigned int j = 0; j < l.trafficlights.size(); j++)
+        bytes += GetVectorBytes(l.trafficlights.at(j).laneIds) + GetVectorBytes(l.trafficlights.at(j).pLanes);
+      for(unsigned int j = 0; j < l.stopLines.size(); j++)
+        bytes += GetVectorBytes(l.stopLines.at(j).points);
+
+      bytes += GetVectorBytes(l.points);
+      for(unsigned int p = 0; p < l.points.size(); p++)
+      {
+        const WayPoint& wp = l.points.at(p);
+        bytes += GetVectorBytes(wp.toIds) + GetVectorBytes(wp.fromIds) + GetVectorBytes(wp.pFronts) + GetVectorBytes(wp.pBacks);
+        bytes += GetVectorBytes(wp.actionCost);
+      }
+    }
+  }
+
+  bytes += GetVectorBytes(map.trafficLights) + GetVectorBytes(map.stopLines) + GetVectorBytes(map.curbs) + GetVectorBytes(map.boundaries);
+  bytes += GetVectorBytes(map.crossings) + GetVectorBytes(map.markings) + GetVectorBytes(map.signs);
+  for(unsigned int i = 0; i < map.trafficLights.size(); i++)
+    bytes += GetVectorBytes(map.trafficLights.at(i).laneIds) + GetVectorBytes(map.trafficLights.at(i).pLanes);
+  for(unsigned int i = 0; i < map.stopLines.size(); i++)
+    bytes += GetVectorBytes(map.stopLines.at(i).points);
+  for(unsigned int i = 0; i < map.curbs.size(); i++)
+    bytes += GetVectorBytes(map.curbs.at(i).points);
+  for(unsigned int i = 0; i < map.boundaries.size(); i++)
+    bytes += GetVectorBytes(map.boundaries.at(i).points);
+  for(unsigned int i = 0; i < map.crossings.size(); i++)
+    bytes += GetVectorBytes(map.crossings.at(i).points);
+  for(unsigned int i = 0; i < map.markings.size(); i++)
+    bytes += GetVectorBytes(map.markings.at(i).points);
+
+  return bytes;
+}
+
+CompactSearchOverlay::CompactSearchOverlay(CompactRoadNetwork& map, const unsigned int& blockSize) : m_Map(map), m_Arena(blockSize)
+{
+}
+
+CompactSearchOverlay::~CompactSearchOverlay()
+{
+}
+
+WayPoint* CompactSearchOverlay::GetWayPoint(const int& iPoint)
+{
+  if(iPoint < 0 || iPoint >= (int)m_Map.GetNumberOfPoints()) return nullptr;
+
+  std::unordered_map<int, WayPoint*>::const_iterator it = m_Nodes.find(iPoint);
+  if(it != m_Nodes.end())
+    return it->second;
+
+  WayPoint wp;
+  m_Map.GetWayPoint(iPoint, wp);
+  wp.pLane = m_Map.GetLane(m_Map.GetPointLane(iPoint));
+  WayPoint* pNode = m_Arena.Create(wp);
+  m_Nodes[iPoint] = pNode;
+  m_NodeIndex[pNode] = iPoint;
+  return pNode;
+}
+
+void CompactSearchOverlay::LinkNeighbors(WayPoint* pNode)
+{
+  int iPoint = GetPointIndex(pNode);
+  if(iPoint < 0) return;
+
+  int n = 0;
+  const int* pFronts = m_Map.GetFronts(iPoint, n);
+  pNode->pFronts.clear();
+  for(int i = 0; i < n; i++)
+    pNode->pFronts.push_back(GetWayPoint(pFronts[i]));
+
+  const int* pBacks = m_Map.GetBacks(iPoint, n);
+  pNode->pBacks.clear();
+  for(int i = 0; i < n; i++)
+    pNode->pBacks.push_back(GetWayPoint(pBacks[i]));
+
+  pNode->pLeft = GetWayPoint(m_Map.GetLeft(iPoint));
+  pNode->pRight = GetWayPoint(m_Map.GetRight(iPoint));
+}
+
+int CompactSearchOverlay::GetPointIndex(const WayPoint* pNode) const
+{
+  std::unordered_map<const WayPoint*, int>::const_iterator it = m_NodeIndex.find(pNode);
+  if(it != m_NodeIndex.end())
+    return it->second;
+  return -1;
+}
+
+void CompactSearchOverlay::Reset()
+{
+  m_Arena.Reset();
+  m_Nodes.clear();
+  m_NodeIndex.clear();
+}
+
+unsigned int CompactSearchOverlay::GetNumberOfNodes() const
+{
+  return m_Nodes.size();
+}
+
+} /* namespace PlannerHNS */
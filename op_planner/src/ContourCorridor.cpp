@@ -0,0 +1,162 @@
+/// \file ContourCorridor.cpp
+/// \brief Broad phase for the contour cost evaluation, bounding boxes around the part of the paths the contour points can affect
+/// \date Oct 14, 2026
+
+#include "op_planner/ContourCorridor.h"
+#include <cmath>
+#include <algorithm>
+
+using namespace std;
+
+namespace PlannerHNS
+{
+
+ContourCorridor::ContourCorridor()
+{
+}
+
+void ContourCorridor::Clear()
+{
+  m_Boxes.clear();
+}
+
+void ContourCorridor::AddPath(const std::vector<WayPoint>& path, const RelativeInfo& car_info, const double& backDistance, const double& frontDistance, const double& lateralMargin)
+{
+  if(path.size() < 2) return;
+
+  int iBack = std::min(std::max(car_info.iBack, 0), (int)path.size()-1);
+  int iFront = std::min(std::max(car_info.iFront, 0), (int)path.size()-1);
+
+  double d = hypot(path.at(iBack).pos.y - car_info.perp_point.pos.y, path.at(iBack).pos.x - car_info.perp_point.pos.x);
+  while(iBack > 0 && d <= backDistance)
+  {
+    d += hypot(path.at(iBack).pos.y - path.at(iBack-1).pos.y, path.at(iBack).pos.x - path.at(iBack-1).pos.x);
+    iBack--;
+  }
+  double back_left = std::max(backDistance - d, 0.0);
+
+  d = hypot(path.at(iFront).pos.y - car_info.perp_point.pos.y, path.at(iFront).pos.x - car_info.perp_point.pos.x);
+  while(iFront < (int)path.size()-1 && d <= frontDistance)
+  {
+    d += hypot(path.at(iFront+1).pos.y - path.at(iFront).pos.y, path.at(iFront+1).pos.x - path.at(iFront).pos.x);
+    iFront++;
+  }
+  double front_left = std::max(frontDistance - d, 0.0);
+
+  //one more point on each side for the projection on the end segments
+  iBack = std::max(iBack-1, 0);
+  iFront = std::min(iFront+1, (int)path.size()-1);
+
+  m_Window.clear();
+  if(iBack == 0)
+  {
+    double a = atan2(path.at(1).pos.y - path.at(0).pos.y, path.at(1).pos.x - path.at(0).pos.x);
+    double ext = back_left + lateralMargin;
+    m_Window.push_back(GPSPoint(path.at(0).pos.x - ext*cos(a), path.at(0).pos.y - ext*sin(a), 0, a));
+  }
+
+  for(int i = iBack; i <= iFront; i++)
+    m_Window.push_back(path.at(i).pos);
+
+  if(iFront == (int)path.size()-1)
+  {
+    int i = path.size()-1;
+    double a = atan2(path.at(i).pos.y - path.at(i-1).pos.y, path.at(i).pos.x - path.at(i-1).pos.x);
+    double ext = front_left + lateralMargin;
+    m_Window.push_back(GPSPoint(path.at(i).pos.x + ext*cos(a), path.at(i).pos.y + ext*sin(a), 0, a));
+  }
+
+  double max_segment = 0;
+  for(unsigned int i = 1; i < m_Window.size(); i++)
+    max_segment = std::max(max_segment, hypot(m_Window.at(i).y - m_Window.at(i-1).y, m_Window.at(i).x - m_Window.at(i-1).x));
+
+  double margin = lateralMargin + 2.0*max_segment;
+
+  //consecutive boxes share their end point, so every segment is inside one box
+  for(unsigned int i = 0; i + 1 < m_Window.size(); i += CORRIDOR_BOX_POINTS)
+  {
+    unsigned int iEnd = std::min(i + CORRIDOR_BOX_POINTS, (unsigned int)m_Window.size()-1);
+    Box box;
+    box.min_x = box.max_x = m_Window.at(i).x;
+    box.min_y = box.max_y = m_Window.at(i).y;
+    for(unsigned int j = i+1; j <= iEnd; j++)
+    {
+      box.min_x = std::min(box.min_x, m_Window.at(j).x);
+      box.min_y = std::min(box.min_y, m_Window.at(j).y);
+      box.max_x = std::max(box.max_x, m_Window.at(j).x);
+      box.max_y = std::max(box.max_y, m_Window.at(j).y);
+    }
+    box.min_x -= margin;
+    box.min_y -= margin;
+    box.max_x += margin;
+    box.max_y += margin;
+    m_Boxes.push_back(box);
+  }
+}
+
+bool ContourCorridor::IsInside(const GPSPoint& p) const
+{
+  for(unsigned int i = 0; i < m_Boxes.size(); i++)
+  {
+    if(p.x >= m_Boxes.at(i).min_x && p.x <= m_Boxes.at(i).max_x && p.y >= m_Boxes.at(i).min_y && p.y <= m_Boxes.at(i).max_y)
+      return true;
+  }
+  return false;
+}
+
+bool ContourCorridor::IsNear(const GPSPoint& p, const double& distance) const
+{
+  for(unsigned int i = 0; i < m_Boxes.size(); i++)
+  {
+    if(p.x >= m_Boxes.at(i).min_x - distance && p.x <= m_Boxes.at(i).max_x + distance
+        && p.y >= m_Boxes.at(i).min_y - distance && p.y <= m_Boxes.at(i).max_y + distance)
+      return true;
+  }
+  return false;
+}
+
+unsigned int ContourCorridor::Filter(const std::vector<WayPoint>& contourPoints, const double& minSpeed, std::vector<WayPoint>& filtered) const
+{
+  filtered.clear();
+  unsigned int nCulled = 0;
+  unsigned int i = 0;
+  while(i < contourPoints.size())
+  {
+    unsigned int iEnd = i+1;
+    while(iEnd < contourPoints.size() && contourPoints.at(iEnd).id == contourPoints.at(i).id)
+      iEnd++;
+
+    if(contourPoints.at(i).v < minSpeed)
+    {
+      bool bInside = false;
+      for(unsigned int j = i; j < iEnd && !bInside; j++)
+        bInside = IsInside(contourPoints.at(j).pos);
+
+      if(bInside)
+        filtered.insert(filtered.end(), contourPoints.begin()+i, contourPoints.begin()+iEnd);
+      else
+        nCulled += iEnd - i;
+    }
+    else
+    {
+      for(unsigned int j = i; j < iEnd; j++)
+      {
+        if(IsInside(contourPoints.at(j).pos))
+          filtered.push_back(contourPoints.at(j));
+        else
+          nCulled++;
+      }
+    }
+
+    i = iEnd;
+  }
+
+  return nCulled;
+}
+
+unsigned int ContourCorridor::GetNumberOfBoxes() const
+{
+  return m_Boxes.size();
+}
+
+} /* namespace PlannerHNS */
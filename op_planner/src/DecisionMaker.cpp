@@ -19,6 +19,8 @@ DecisionMaker::DecisionMaker()
 {
   m_iCurrentTotalPathId = 0;
   pLane = 0;
+  m_GlobalPathFingerprint = 0;
+  m_bGlobalPathFingerprint = false;
   m_pCurrentBehaviorState = 0;
   m_pGoToGoalState = 0;
   m_pStopState= 0;
@@ -39,6 +41,13 @@ DecisionMaker::DecisionMaker()
   m_pInitState = 0;
   m_pFollowState = 0;
   m_pAvoidObstacleState = 0;
+
+  m_bUseStateTable = false;
+  for(int i = 0; i < BEHAVIOR_STATES_NUMBER; i++)
+    m_pStatesByType[i] = 0;
+
+  for(int i = 0; i < STAGE_COUNT; i++)
+    m_StageLatency.AddStage(GetPlanningStageName((PLANNING_STAGE)i));
 }
 
 DecisionMaker::~DecisionMaker()
@@ -73,6 +82,7 @@ void DecisionMaker::Init(const ControllerParams& ctrlParams, const PlannerHNS::P
     m_pidFollowing.Setlimit(m_params.minFollowingDistance, 0);
 
     InitBehaviorStates();
+    m_LaneTracker.Reset();
 
     if(m_pCurrentBehaviorState)
       m_pCurrentBehaviorState->SetBehaviorsParams(&m_params);
@@ -122,6 +132,16 @@ void DecisionMaker::InitBehaviorStates()
   m_pInitState->decisionMakingCount = 0;//m_params.nReliableCount;
 
   m_pCurrentBehaviorState = m_pInitState;
+
+  BehaviorStateMachine* states[] = {m_pStopState, m_pMissionCompleteState, m_pGoalState, m_pGoToGoalState, m_pInitState, m_pFollowState,
+      m_pAvoidObstacleState, m_pStopSignWaitState, m_pStopSignStopState, m_pTrafficLightWaitState, m_pTrafficLightStopState};
+  for(int i = 0; i < BEHAVIOR_STATES_NUMBER; i++)
+    m_pStatesByType[i] = 0;
+  for(unsigned int i = 0; i < sizeof(states)/sizeof(states[0]); i++)
+    m_pStatesByType[states[i]->m_Behavior] = states[i];
+
+  m_StateTable.SetDecisionMakingTime(STOP_SIGN_WAIT_STATE, m_params.stopSignStopTime);
+  m_StateTable.ResetTimer();
 }
 
  bool DecisionMaker::GetNextTrafficLight(const int& prevTrafficLightId, const std::vector<PlannerHNS::TrafficLight>& trafficLights, PlannerHNS::TrafficLight& trafficL)
@@ -202,6 +222,11 @@ void DecisionMaker::InitBehaviorStates()
    bool bGreenTrafficLight = true;
 
 
+  //the table of the original path when SetNewGlobalPath built it, up to the horizon of the extracted total path
+  int iLane = pValues->iCurrSafeLane;
+  if(iLane >= 0 && iLane < (int)m_TotalPathEvents.size() && iLane < (int)m_TotalOriginalPath.size() && m_TotalPathEvents.at(iLane).IsBuiltFor(m_TotalOriginalPath.at(iLane)))
+    distanceToClosestStopLine = m_TotalPathEvents.at(iLane).GetDistanceToNextStopLine(m_TotalOriginalPath.at(iLane), state, m_params.giveUpDistance, m_params.horizonDistance, stopLineID, stopSignID, trafficLightID) - critical_long_front_distance;
+  else
     distanceToClosestStopLine = PlanningHelpers::GetDistanceToClosestStopLineAndCheck(m_TotalPath.at(pValues->iCurrSafeLane), state, m_params.giveUpDistance, stopLineID, stopSignID, trafficLightID) - critical_long_front_distance;
 
     //std::cout << "StopLineID" << stopLineID << ", StopSignID: " << stopSignID << ", TrafficLightID: " << trafficLightID << ", Distance: " << distanceToClosestStopLine << ", MinStopDistance: " << pValues->minStoppingDistance << std::endl;
@@ -242,13 +267,16 @@ void DecisionMaker::InitBehaviorStates()
 
  void DecisionMaker::UpdateCurrentLane(const double& search_distance)
  {
-   PlannerHNS::Lane* pMapLane = 0;
+   const PlannerHNS::Lane* pMapLane = 0;
   PlannerHNS::Lane* pPathLane = 0;
   pPathLane = MappingHelpers::GetLaneFromPath(state, m_TotalPath.at(m_iCurrentTotalPathId));
   if(!pPathLane)
   {
     std::cout << "Performance Alert: Can't Find Lane Information in Global Path, Searching the Map :( " << std::endl;
-    pMapLane  = MappingHelpers::GetClosestLaneFromMap(state, m_Map, search_distance);
+    if(m_pSharedMap)
+      pMapLane  = m_LaneTracker.GetCurrentLane(state, m_pSharedMap, search_distance);
+    else
+      pMapLane  = m_LaneTracker.GetCurrentLane(state, m_Map, search_distance);
   }
 
   if(pPathLane)
@@ -264,28 +292,62 @@ void DecisionMaker::InitBehaviorStates()
    if(m_TotalPath.size()==0) return false;
 
    PlannerHNS::RelativeInfo info;
-   PlanningHelpers::GetRelativeInfo(m_TotalPath.at(iGlobalPathIndex), state, info);
+   const std::vector<WayPoint>& path = m_TotalPath.at(iGlobalPathIndex);
+   m_TotalPathCursor.GetRelativeInfo(path, state, info);
 
-   double d = 0;
-   for(unsigned int i = info.iFront; i < m_TotalPath.at(iGlobalPathIndex).size()-1; i++)
+   double d = m_TotalPathCursor.GetDistanceBetweenIndices(path, info.iFront, path.size()-1);
+
+   return d <= min_distance;
+ }
+
+ void DecisionMaker::ExtractTotalPath()
+ {
+   //each part is copied in place so the paths keep their memory from the previous cycle,
+   //only the original points the horizon reached since the last cycle are resampled
+   m_TotalPath.resize(m_TotalOriginalPath.size());
+   m_TotalPathHorizons.resize(m_TotalOriginalPath.size());
+   for(unsigned int i = 0; i < m_TotalOriginalPath.size(); i++)
    {
-     d+= hypot(m_TotalPath.at(iGlobalPathIndex).at(i+1).pos.y - m_TotalPath.at(iGlobalPathIndex).at(i).pos.y, m_TotalPath.at(iGlobalPathIndex).at(i+1).pos.x - m_TotalPath.at(iGlobalPathIndex).at(i).pos.x);
-     if(d > min_distance)
-       return false;
+     PathView view;
+     m_TotalPathHorizons.at(i).Extract(m_TotalOriginalPath.at(i), state, m_params.horizonDistance, m_params.pathDensity, view);
+     view.CopyTo(m_TotalPath.at(i));
    }
-
-   return true;
  }
 
  void DecisionMaker::SetNewGlobalPath(const std::vector<std::vector<WayPoint> >& globalPath)
  {
+   //always taken, the caller may have found a change the sampled fingerprint doesn't see
    if(m_pCurrentBehaviorState)
    {
-     m_pCurrentBehaviorState->GetCalcParams()->bNewGlobalPath = true;
-     m_TotalOriginalPath = globalPath;
+     m_bGlobalPathFingerprint = false;
+     UpdateGlobalPath(globalPath);
    }
  }
 
+ void DecisionMaker::SetNewGlobalPath(const std::vector<std::vector<WayPoint> >& globalPath, const unsigned long long& fingerprint)
+ {
+   if(m_pCurrentBehaviorState)
+   {
+     if(m_bGlobalPathFingerprint && fingerprint == m_GlobalPathFingerprint && globalPath.size() == m_TotalOriginalPath.size())
+       return;
+
+     m_GlobalPathFingerprint = fingerprint;
+     m_bGlobalPathFingerprint = true;
+     UpdateGlobalPath(globalPath);
+   }
+ }
+
+ void DecisionMaker::UpdateGlobalPath(const std::vector<std::vector<WayPoint> >& globalPath)
+ {
+   m_pCurrentBehaviorState->GetCalcParams()->bNewGlobalPath = true;
+   m_TotalOriginalPath = globalPath;
+   for(unsigned int i = 0; i < m_TotalPathHorizons.size(); i++)
+     m_TotalPathHorizons.at(i).Reset();
+   m_TotalPathEvents.resize(m_TotalOriginalPath.size());
+   for(unsigned int i = 0; i < m_TotalOriginalPath.size(); i++)
+     m_TotalPathEvents.at(i).Build(m_TotalOriginalPath.at(i));
+ }
+
  bool DecisionMaker::SelectSafeTrajectory()
  {
    bool bNewTrajectory = false;
@@ -293,7 +355,7 @@ void DecisionMaker::InitBehaviorStates()
 
    if(!preCalcPrams || m_RollOuts.size() == 0) return bNewTrajectory;
 
-  int currIndex = PlannerHNS::PlanningHelpers::GetClosestNextPointIndexFast(m_Path, state);
+  int currIndex = m_PathCursor.GetClosestNextPointIndex(m_Path, state);
   int index_limit = 0;
   if(index_limit<=0)
     index_limit =  m_Path.size()/2.0;
@@ -303,6 +365,7 @@ void DecisionMaker::InitBehaviorStates()
   {
     std::cout << "New Local Plan !! " << currIndex << ", "<< preCalcPrams->bRePlan << ", " << preCalcPrams->bNewGlobalPath  << ", " <<  m_TotalOriginalPath.at(0).size() << ", PrevLocal: " << m_Path.size();
     m_Path = m_RollOuts.at(preCalcPrams->iCurrSafeTrajectory);
+    m_PathCursor.Reset();
     std::cout << ", NewLocal: " << m_Path.size() << std::endl;
 
     preCalcPrams->bNewGlobalPath = false;
@@ -317,7 +380,14 @@ void DecisionMaker::InitBehaviorStates()
  {
   PlannerHNS::PreCalculatedConditions *preCalcPrams = m_pCurrentBehaviorState->GetCalcParams();
 
-  m_pCurrentBehaviorState = m_pCurrentBehaviorState->GetNextState();
+  if(m_bUseStateTable)
+  {
+    STATE_TYPE next = m_StateTable.GetNextState(m_pCurrentBehaviorState->m_Behavior, *m_pCurrentBehaviorState->m_pParams, *preCalcPrams);
+    m_pCurrentBehaviorState = m_pStatesByType[next];
+  }
+  else
+    m_pCurrentBehaviorState = m_pCurrentBehaviorState->GetNextState();
+
   if(m_pCurrentBehaviorState==0)
     m_pCurrentBehaviorState = m_pInitState;
 
@@ -349,8 +419,8 @@ void DecisionMaker::InitBehaviorStates()
   if(m_TotalOriginalPath.size() ==0 ) return 0;
 
   RelativeInfo info, total_info;
-  PlanningHelpers::GetRelativeInfo(m_TotalOriginalPath.at(m_iCurrentTotalPathId), state, total_info);
-  PlanningHelpers::GetRelativeInfo(m_Path, state, info);
+  m_TotalOriginalPathCursor.GetRelativeInfo(m_TotalOriginalPath.at(m_iCurrentTotalPathId), state, total_info);
+  m_PathCursor.GetRelativeInfo(m_Path, state, info);
   double average_braking_distance = -pow(CurrStatus.speed, 2)/(m_CarInfo.max_deceleration) + m_params.additionalBrakingDistance;
   double max_velocity  = PlannerHNS::PlanningHelpers::GetVelocityAhead(m_TotalOriginalPath.at(m_iCurrentTotalPathId), total_info, total_info.iBack, average_braking_distance);
 
@@ -461,25 +531,28 @@ void DecisionMaker::InitBehaviorStates()
 {
    PlannerHNS::BehaviorState beh;
    state = currPose;
-   m_TotalPath.clear();
-  for(unsigned int i = 0; i < m_TotalOriginalPath.size(); i++)
   {
-    t_centerTrajectorySmoothed.clear();
-    PlannerHNS::PlanningHelpers::ExtractPartFromPointToDistanceDirectionFast(m_TotalOriginalPath.at(i), state, m_params.horizonDistance ,  m_params.pathDensity , t_centerTrajectorySmoothed);
-    m_TotalPath.push_back(t_centerTrajectorySmoothed);
+    OP_STAGE_TIMER(&m_StageLatency, STAGE_TOTAL_PATH);
+    ExtractTotalPath();
   }
 
   if(m_TotalPath.size()==0) return beh;
 
-  UpdateCurrentLane(m_MaxLaneSearchDistance);
+  {
+    OP_STAGE_TIMER(&m_StageLatency, STAGE_BEHAVIOR_STATE);
+    UpdateCurrentLane(m_MaxLaneSearchDistance);
 
-  CalculateImportantParameterForDecisionMaking(vehicleState, goalID, bEmergencyStop, trafficLight, tc);
+    CalculateImportantParameterForDecisionMaking(vehicleState, goalID, bEmergencyStop, trafficLight, tc);
 
-  beh = GenerateBehaviorState(vehicleState);
+    beh = GenerateBehaviorState(vehicleState);
 
-  beh.bNewPlan = SelectSafeTrajectory();
+    beh.bNewPlan = SelectSafeTrajectory();
+  }
 
-  beh.maxVelocity = UpdateVelocityDirectlyToTrajectory(beh, vehicleState, dt);
+  {
+    OP_STAGE_TIMER(&m_StageLatency, STAGE_VELOCITY_PROFILE);
+    beh.maxVelocity = UpdateVelocityDirectlyToTrajectory(beh, vehicleState, dt);
+  }
 
   //std::cout << "Eval_i: " << tc.index << ", Curr_i: " <<  m_pCurrentBehaviorState->GetCalcParams()->iCurrSafeTrajectory << ", Prev_i: " << m_pCurrentBehaviorState->GetCalcParams()->iPrevSafeTrajectory << std::endl;
 
@@ -0,0 +1,893 @@
+/// \file KmlMapReader.cpp
+/// \brief Streaming reader of the KML map files, the map data is parsed while the file is read, no XML document is built
+/// \date Oct 14, 2026
+
+#include "op_planner/KmlMapReader.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+
+namespace PlannerHNS
+{
+
+enum KML_CHILD_NAME {CHILD_FOLDER, CHILD_DOCUMENT, CHILD_NAME, CHILD_DESCRIPTION, CHILD_PLACEMARK, CHILD_LINE_STRING, CHILD_POINT, CHILD_COORDINATES};
+
+static const char* KML_FOLDER_NAMES[] = {"Lanes", "RoadSegments", "TrafficLights", "StopLines", "TrafficSigns", "Crossings", "Markings", "Boundaries", "CurbsLines"};
+
+//std::string::find on the n characters of str
+static size_t FindInView(const char* str, const size_t& n, const char* pattern, const size_t& from)
+{
+  size_t m = strlen(pattern);
+  if(from > n || m > n - from) return std::string::npos;
+  for(size_t i = from; i + m <= n; i++)
+  {
+    if(memcmp(str + i, pattern, m) == 0)
+      return i;
+  }
+  return std::string::npos;
+}
+
+//the characters of MappingHelpers::GetIDsFromPrefix between prefix and postfix
+static void GetPrefixRange(const char* str, const size_t& n, const char* prefix, const char* postfix, size_t& iStart, size_t& count)
+{
+  int index1 = FindInView(str, n, prefix, 0) + strlen(prefix);
+  int index2 = FindInView(str, n, postfix, index1);
+  if(index2 < 0  || strlen(postfix) == 0)
+    index2 = n;
+
+  if((size_t)index1 > n)
+    throw std::out_of_range("KmlMapReader prefix position out of range");
+
+  iStart = index1;
+  count = std::min<size_t>((size_t)(index2 - index1), n - iStart);
+}
+
+//the parts of MappingHelpers::SplitString, each part starts after one token
+template <class F>
+static void ForEachPart(const char* str, const size_t& n, const char& token, F f)
+{
+  const char* pEnd = str + n;
+  const char* pFirst = (const char*)memchr(str, token, n);
+  while(pFirst)
+  {
+    pFirst++;
+    const char* pSecond = (const char*)memchr(pFirst, token, pEnd - pFirst);
+    f(pFirst, (pSecond ? pSecond : pEnd) - pFirst);
+    pFirst = pSecond;
+  }
+}
+
+static int ToInt(const char* str, const size_t& n)
+{
+  char buffer[64];
+  if(n < sizeof(buffer))
+  {
+    memcpy(buffer, str, n);
+    buffer[n] = 0;
+    return atoi(buffer);
+  }
+  return atoi(std::string(str, n).c_str());
+}
+
+static double ToDouble(const char* str, const size_t& n)
+{
+  char buffer[64];
+  if(n < sizeof(buffer))
+  {
+    memcpy(buffer, str, n);
+    buffer[n] = 0;
+    return atof(buffer);
+  }
+  return atof(std::string(str, n).c_str());
+}
+
+KmlMapReader::KmlMapReader()
+{
+  m_pFile = nullptr;
+  m_iBuffer = 0;
+  m_nBuffer = 0;
+  m_bVersionZero = false;
+  m_nElements = 0;
+  m_pText = nullptr;
+  m_bPendingSpace = false;
+  m_bRecordName = false;
+  m_bCoordinates = false;
+  Clear();
+}
+
+KmlMapReader::~KmlMapReader()
+{
+  if(m_pFile)
+    fclose(m_pFile);
+}
+
+void KmlMapReader::Clear()
+{
+  roadSegments.clear();
+  lanes.clear();
+  trafficLights.clear();
+  stopLines.clear();
+  signs.clear();
+  crossings.clear();
+  markings.clear();
+  boundaries.clear();
+  curbs.clear();
+
+  m_Stack.clear();
+  m_bRootSeen = false;
+  m_bHeadFolderSeen = false;
+  m_bHeadDocumentSeen = false;
+  m_bTopDocumentSeen = false;
+  for(int i = 0; i < SCOPES_COUNT; i++)
+  {
+    m_Scopes[i] = ScopeData();
+    for(int j = 0; j < FOLDERS_COUNT; j++)
+      m_Scopes[i].bFolderRead[j] = false;
+  }
+  m_nElements = 0;
+  m_pText = nullptr;
+}
+
+unsigned long KmlMapReader::GetNumberOfElements() const
+{
+  return m_nElements;
+}
+
+bool KmlMapReader::ReadFile(const std::string& kmlFile, const bool& bVersionZero)
+{
+  Clear();
+  m_bVersionZero = bVersionZero;
+  m_pFile = fopen(kmlFile.c_str(), "rb");
+  if(!m_pFile)
+    return false;
+
+  m_Buffer.resize(KML_READ_BUFFER_SIZE);
+  m_iBuffer = m_nBuffer = 0;
+  Parse();
+  fclose(m_pFile);
+  m_pFile = nullptr;
+  std::vector<char>().swap(m_Buffer);
+
+  //the element MappingHelpers::GetHeadElement returns
+  int scope = -1;
+  if(m_bHeadFolderSeen)
+    scope = m_bHeadDocumentSeen ? SCOPE_HEAD_DOCUMENT : SCOPE_HEAD;
+  else if(m_bTopDocumentSeen)
+    scope = SCOPE_TOP_DOCUMENT;
+
+  if(scope >= 0)
+  {
+    ScopeData& data = m_Scopes[scope];
+    roadSegments.swap(data.roadSegments);
+    lanes.swap(data.lanes);
+    trafficLights.swap(data.trafficLights);
+    stopLines.swap(data.stopLines);
+    signs.swap(data.signs);
+    crossings.swap(data.crossings);
+    markings.swap(data.markings);
+    boundaries.swap(data.boundaries);
+    curbs.swap(data.curbs);
+  }
+
+  for(int i = 0; i < SCOPES_COUNT; i++)
+    m_Scopes[i] = ScopeData();
+
+  return true;
+}
+
+bool KmlMapReader::NextChar(char& c)
+{
+  if(m_iBuffer >= m_nBuffer)
+  {
+    m_nBuffer = fread(m_Buffer.data(), 1, m_Buffer.size(), m_pFile);
+    m_iBuffer = 0;
+    if(m_nBuffer == 0)
+      return false;
+  }
+
+  c = m_Buffer[m_iBuffer++];
+  return true;
+}
+
+bool KmlMapReader::SkipPast(const char* end, std::string* pContent)
+{
+  size_t n = strlen(end);
+  std::string window;
+  char c = 0;
+  while(NextChar(c))
+  {
+    window.push_back(c);
+    if(window.size() > n)
+    {
+      if(pContent)
+        pContent->push_back(window.at(0));
+      window.erase(0, 1);
+    }
+    if(window.size() == n && window.compare(end) == 0)
+      return true;
+  }
+  return false;
+}
+
+void KmlMapReader::Parse()
+{
+  while(true)
+  {
+    if(m_iBuffer >= m_nBuffer)
+    {
+      m_nBuffer = fread(m_Buffer.data(), 1, m_Buffer.size(), m_pFile);
+      m_iBuffer = 0;
+      if(m_nBuffer == 0)
+        break;
+    }
+
+    if(!m_pText)
+    {
+      //text nobody reads, jump to the next markup
+      const char* pStart = m_Buffer.data() + m_iBuffer;
+      const char* pMarkup = (const char*)memchr(pStart, '<', m_nBuffer - m_iBuffer);
+      if(!pMarkup)
+      {
+        m_iBuffer = m_nBuffer;
+        continue;
+      }
+      m_iBuffer += pMarkup - pStart + 1;
+      ReadMarkup();
+    }
+    else
+    {
+      char c = m_Buffer[m_iBuffer++];
+      if(c == '<')
+        ReadMarkup();
+      else
+        ReadText(c);
+    }
+  }
+}
+
+void KmlMapReader::ReadMarkup()
+{
+  char c = 0;
+  if(!NextChar(c))
+    return;
+
+  if(c == '?')
+  {
+    SkipPast("?>", nullptr);
+  }
+  else if(c == '!')
+  {
+    //comment, CDATA or declaration
+    std::string start;
+    while(start.size() < 7 && NextChar(c))
+    {
+      start.push_back(c);
+      if(start.compare(0, 2, "--") == 0 || start.compare("[CDATA[") == 0 || c == '>')
+        break;
+    }
+
+    if(start.compare(0, 2, "--") == 0)
+    {
+      //a comment is a child node, the text of the element ends
+      m_pText = nullptr;
+      SkipPast("-->", nullptr);
+    }
+    else if(start.compare("[CDATA[") == 0)
+    {
+      std::string content;
+      SkipPast("]]>", &content);
+      if(m_pText)
+      {
+        m_pText->append(content);
+        m_pText = nullptr;
+      }
+    }
+    else if(c != '>')
+    {
+      SkipPast(">", nullptr);
+    }
+  }
+  else if(c == '/')
+  {
+    SkipPast(">", nullptr);
+    EndElement();
+  }
+  else
+  {
+    m_TagName.clear();
+    while(c != '>' && c != '/' && !isspace((unsigned char)c))
+    {
+      m_TagName.push_back(c);
+      if(!NextChar(c))
+        return;
+    }
+
+    //attributes are not read, only the end of the tag
+    char quote = 0;
+    char last = c;
+    while(c != '>' || quote != 0)
+    {
+      if(!NextChar(c))
+        return;
+      if(quote != 0)
+      {
+        if(c == quote)
+          quote = 0;
+      }
+      else if(c == '"' || c == '\'')
+      {
+        quote = c;
+      }
+      else if(c != '>' && !isspace((unsigned char)c))
+      {
+        last = c;
+      }
+    }
+
+    StartElement(m_TagName);
+    if(last == '/')
+      EndElement();
+  }
+}
+
+void KmlMapReader::ReadText(const char& c)
+{
+  if(c != '&')
+  {
+    AppendText(c);
+    return;
+  }
+
+  m_Entity.clear();
+  char e = 0;
+  while(m_Entity.size() < 10 && NextChar(e) && e != ';')
+    m_Entity.push_back(e);
+
+  if(m_Entity.compare("amp") == 0) AppendText('&');
+  else if(m_Entity.compare("lt") == 0) AppendText('<');
+  else if(m_Entity.compare("gt") == 0) AppendText('>');
+  else if(m_Entity.compare("quot") == 0) AppendText('"');
+  else if(m_Entity.compare("apos") == 0) AppendText('\'');
+  else if(m_Entity.size() > 1 && m_Entity.at(0) == '#')
+  {
+    long code = (m_Entity.at(1) == 'x') ? strtol(m_Entity.c_str() + 2, nullptr, 16) : strtol(m_Entity.c_str() + 1, nullptr, 10);
+    AppendText((char)code);
+  }
+  else
+  {
+    AppendText('&');
+    for(unsigned int i = 0; i < m_Entity.size(); i++)
+      AppendText(m_Entity.at(i));
+    if(e == ';')
+      AppendText(';');
+  }
+}
+
+void KmlMapReader::AppendText(const char& c)
+{
+  //TinyXML condensed white space, leading and trailing white space removed, inner runs replaced by one space
+  if(isspace((unsigned char)c))
+  {
+    if(m_pText->size() > 0)
+      m_bPendingSpace = true;
+    return;
+  }
+
+  if(m_bPendingSpace)
+  {
+    m_pText->push_back(' ');
+    m_bPendingSpace = false;
+  }
+  m_pText->push_back(c);
+}
+
+int KmlMapReader::GetChildBit(const std::string& name) const
+{
+  if(name.compare("Folder") == 0) return CHILD_FOLDER;
+  if(name.compare("Document") == 0) return CHILD_DOCUMENT;
+  if(name.compare("name") == 0) return CHILD_NAME;
+  if(name.compare("description") == 0) return CHILD_DESCRIPTION;
+  if(name.compare("Placemark") == 0) return CHILD_PLACEMARK;
+  if(name.compare("LineString") == 0) return CHILD_LINE_STRING;
+  if(name.compare("Point") == 0) return CHILD_POINT;
+  if(name.compare("coordinates") == 0) return CHILD_COORDINATES;
+  return -1;
+}
+
+int KmlMapReader::GetFolderType(const std::string& name)
+{
+  for(int i = 0; i < FOLDERS_COUNT; i++)
+  {
+    if(name.compare(KML_FOLDER_NAMES[i]) == 0)
+      return i;
+  }
+  return FOLDER_UNKNOWN;
+}
+
+void KmlMapReader::StartElement(const std::string& name)
+{
+  m_nElements++;
+  m_pText = nullptr;
+
+  Frame f;
+  f.role = ROLE_OTHER;
+  f.scope = -1;
+  f.folder = FOLDER_UNKNOWN;
+  f.seenChildren = 0;
+
+  std::string* pText = nullptr;
+  if(m_Stack.size() == 0)
+  {
+    if(!m_bRootSeen)
+      f.role = ROLE_ROOT;
+    m_bRootSeen = true;
+  }
+  else
+  {
+    Frame& parent = m_Stack.back();
+    f.scope = parent.scope;
+    f.folder = parent.folder;
+
+    //FirstChildElement(name) only finds the first child with that name
+    int bit = GetChildBit(name);
+    bool bFirst = bit >= 0 && (parent.seenChildren & (1u << bit)) == 0;
+    if(bit >= 0)
+      parent.seenChildren |= (1u << bit);
+
+    switch(parent.role)
+    {
+    case ROLE_ROOT:
+      if(bFirst && bit == CHILD_FOLDER)
+        f.role = ROLE_TOP_FOLDER;
+      break;
+    case ROLE_TOP_FOLDER:
+      if(bFirst && bit == CHILD_FOLDER)
+      {
+        f.role = ROLE_HEAD;
+        f.scope = SCOPE_HEAD;
+        m_bHeadFolderSeen = true;
+      }
+      else if(bFirst && bit == CHILD_DOCUMENT)
+      {
+        f.role = ROLE_DOCUMENT;
+        f.scope = SCOPE_TOP_DOCUMENT;
+        m_bTopDocumentSeen = true;
+      }
+      break;
+    case ROLE_HEAD:
+      if(bFirst && bit == CHILD_DOCUMENT)
+      {
+        f.role = ROLE_DOCUMENT;
+        f.scope = SCOPE_HEAD_DOCUMENT;
+        m_bHeadDocumentSeen = true;
+      }
+      else if(parent.seenChildren & (1u << CHILD_FOLDER))
+      {
+        //GetDataFolder checks the first Folder and all the elements after it
+        f.role = ROLE_FOLDER;
+        f.folder = FOLDER_UNKNOWN;
+      }
+      break;
+    case ROLE_DOCUMENT:
+      if(parent.seenChildren & (1u << CHILD_FOLDER))
+      {
+        f.role = ROLE_FOLDER;
+        f.folder = FOLDER_UNKNOWN;
+      }
+      break;
+    case ROLE_FOLDER:
+      if(bFirst && bit == CHILD_NAME)
+      {
+        f.role = ROLE_FOLDER_NAME;
+        pText = &m_FolderName;
+      }
+      else if(parent.folder != FOLDER_UNKNOWN
+          && (parent.seenChildren & (1u << (parent.folder == FOLDER_LANES ? CHILD_FOLDER : CHILD_PLACEMARK))))
+      {
+        f.role = ROLE_RECORD;
+        m_RecordName.clear();
+        m_Coordinates.clear();
+        m_LaneInfo.clear();
+        m_bRecordName = false;
+        m_bCoordinates = false;
+      }
+      break;
+    case ROLE_RECORD:
+      if(bFirst && bit == ((parent.folder == FOLDER_LANES || parent.folder == FOLDER_ROAD_SEGMENTS) ? CHILD_DESCRIPTION : CHILD_NAME))
+      {
+        f.role = ROLE_RECORD_NAME;
+        pText = &m_RecordName;
+        m_bRecordName = true;
+      }
+      else if(parent.folder == FOLDER_LANES)
+      {
+        if(bFirst && bit == CHILD_PLACEMARK)
+          f.role = ROLE_LANE_PLACEMARK;
+        else if(bFirst && bit == CHILD_FOLDER)
+          f.role = ROLE_LANE_FOLDER;
+      }
+      else if(bFirst && bit == (parent.folder == FOLDER_TRAFFIC_LIGHTS ? CHILD_POINT : CHILD_LINE_STRING))
+      {
+        f.role = ROLE_RECORD_LINE;
+      }
+      break;
+    case ROLE_RECORD_LINE:
+    case ROLE_LANE_LINE:
+      if(bFirst && bit == CHILD_COORDINATES)
+      {
+        f.role = ROLE_RECORD_COORDINATES;
+        pText = &m_Coordinates;
+        m_bCoordinates = true;
+      }
+      break;
+    case ROLE_LANE_PLACEMARK:
+      if(bFirst && bit == CHILD_LINE_STRING)
+        f.role = ROLE_LANE_LINE;
+      break;
+    case ROLE_LANE_FOLDER:
+      if(bFirst && bit == CHILD_DESCRIPTION)
+      {
+        f.role = ROLE_LANE_INFO;
+        pText = &m_LaneInfo;
+      }
+      break;
+    default:
+      break;
+    }
+  }
+
+  m_Stack.push_back(f);
+  if(pText)
+  {
+    pText->clear();
+    m_bPendingSpace = false;
+    m_pText = pText;
+  }
+}
+
+void KmlMapReader::EndElement()
+{
+  m_pText = nullptr;
+  if(m_Stack.size() == 0)
+    return;
+
+  Frame f = m_Stack.back();
+  m_Stack.pop_back();
+
+  if(f.role == ROLE_FOLDER_NAME && m_Stack.size() > 0)
+  {
+    //GetDataFolder returns the first folder with the name
+    Frame& folder = m_Stack.back();
+    int type = GetFolderType(m_FolderName);
+    if(type != FOLDER_UNKNOWN && folder.scope >= 0 && !m_Scopes[folder.scope].bFolderRead[type])
+    {
+      folder.folder = type;
+      m_Scopes[folder.scope].bFolderRead[type] = true;
+    }
+  }
+  else if(f.role == ROLE_RECORD && f.scope >= 0)
+  {
+    AddRecord(f);
+  }
+}
+
+void KmlMapReader::AddRecord(const Frame& record)
+{
+  ScopeData& data = m_Scopes[record.scope];
+  const char* str = m_RecordName.c_str();
+  size_t n = m_RecordName.size();
+
+  if(record.folder == FOLDER_LANES)
+  {
+    if(m_bRecordName)
+      AddLane(data);
+    return;
+  }
+
+  if(record.folder == FOLDER_ROAD_SEGMENTS)
+  {
+    RoadSegment rl;
+    GetIDsFromPrefix(str, n, "RSID", "", m_Ids);
+    rl.id = m_Ids.at(0);
+    data.roadSegments.push_back(rl);
+    return;
+  }
+
+  if(!m_bRecordName)
+    return;
+
+  GetPointsData(m_Coordinates, m_Points);
+
+  switch(record.folder)
+  {
+  case FOLDER_TRAFFIC_LIGHTS:
+  {
+    TrafficLight tl;
+    GetIDsFromPrefix(str, n, "TLID", "LnID", m_Ids);
+    tl.id = m_Ids.at(0);
+    GetIDsFromPrefix(str, n, "LnID", "", tl.laneIds);
+    tl.pos = m_Points.at(0);
+    data.trafficLights.push_back(tl);
+    break;
+  }
+  case FOLDER_STOP_LINES:
+  {
+    StopLine sl;
+    GetIDsFromPrefix(str, n, "SLID", "LnID", m_Ids);
+    sl.id = m_Ids.at(0);
+    GetIDsFromPrefix(str, n, "LnID", "TSID", m_Ids);
+    sl.laneId = m_Ids.at(0);
+    GetIDsFromPrefix(str, n, "TSID", "TLID", m_Ids);
+    sl.stopSignID = m_Ids.at(0);
+    GetIDsFromPrefix(str, n, "TLID", "", m_Ids);
+    sl.trafficLightID = m_Ids.at(0);
+    sl.points = m_Points;
+    data.stopLines.push_back(sl);
+    break;
+  }
+  case FOLDER_TRAFFIC_SIGNS:
+  {
+    TrafficSign ts;
+    GetIDsFromPrefix(str, n, "TSID", "LnID", m_Ids);
+    ts.id = m_Ids.at(0);
+    GetIDsFromPrefix(str, n, "LnID", "RdID", m_Ids);
+    ts.laneId = m_Ids.at(0);
+    GetIDsFromPrefix(str, n, "RdID", "Type", m_Ids);
+    ts.roadId = m_Ids.at(0);
+    GetIDsFromPrefix(str, n, "Type", "", m_Ids);
+    switch(m_Ids.at(0))
+    {
+    case 0:
+      ts.signType = UNKNOWN_SIGN;
+      break;
+    case 1:
+      ts.signType = STOP_SIGN;
+      break;
+    case 2:
+      ts.signType = MAX_SPEED_SIGN;
+      break;
+    case 3:
+      ts.signType = MIN_SPEED_SIGN;
+      break;
+    default:
+      ts.signType = STOP_SIGN;
+      break;
+    }
+    ts.pos = m_Points.at(0);
+    data.signs.push_back(ts);
+    break;
+  }
+  case FOLDER_CROSSINGS:
+  {
+    Crossing cross;
+    GetIDsFromPrefix(str, n, "CRID", "RdID", m_Ids);
+    cross.id = m_Ids.at(0);
+    GetIDsFromPrefix(str, n, "RdID", "", m_Ids);
+    cross.roadId = m_Ids.at(0);
+    cross.points = m_Points;
+    data.crossings.push_back(cross);
+    break;
+  }
+  case FOLDER_MARKINGS:
+  {
+    Marking m;
+    GetIDsFromPrefix(str, n, "MID", "LnID", m_Ids);
+    m.id = m_Ids.at(0);
+    GetIDsFromPrefix(str, n, "LnID", "RdID", m_Ids);
+    m.laneId = m_Ids.at(0);
+    GetIDsFromPrefix(str, n, "RdID", "", m_Ids);
+    m.roadId = m_Ids.at(0);
+    m.points = m_Points;
+    if(m.points.size() > 0)
+    {
+      //first item is the center of the marking
+      m.center = m.points.at(0);
+      m.points.erase(m.points.begin()+0);
+    }
+    data.markings.push_back(m);
+    break;
+  }
+  case FOLDER_BOUNDARIES:
+  {
+    Boundary b;
+    GetIDsFromPrefix(str, n, "BID", "RdID", m_Ids);
+    b.id = m_Ids.at(0);
+    GetIDsFromPrefix(str, n, "RdID", "", m_Ids);
+    b.roadId = m_Ids.at(0);
+    b.points = m_Points;
+    data.boundaries.push_back(b);
+    break;
+  }
+  case FOLDER_CURBS:
+  {
+    Curb c;
+    GetIDsFromPrefix(str, n, "BID", "LnID", m_Ids);
+    c.id = m_Ids.at(0);
+    GetIDsFromPrefix(str, n, "LnID", "RdID", m_Ids);
+    c.laneId = m_Ids.at(0);
+    GetIDsFromPrefix(str, n, "RdID", "", m_Ids);
+    c.roadId = m_Ids.at(0);
+    c.points = m_Points;
+    data.curbs.push_back(c);
+    break;
+  }
+  default:
+    break;
+  }
+}
+
+void KmlMapReader::AddLane(ScopeData& data)
+{
+  const char* str = m_RecordName.c_str();
+  size_t n = m_RecordName.size();
+
+  data.lanes.push_back(Lane());
+  Lane& ll = data.lanes.back();
+  GetIDsFromPrefix(str, n, "LID", "RSID", m_Ids);
+  ll.id = m_Ids.at(0);
+  GetIDsFromPrefix(str, n, "RSID", "NUM", m_Ids);
+  ll.roadId = m_Ids.at(0);
+  GetIDsFromPrefix(str, n, "NUM", "From", m_Ids);
+  ll.num = m_Ids.at(0);
+  GetIDsFromPrefix(str, n, "From", "To", ll.fromIds);
+  GetIDsFromPrefix(str, n, "To", "Vel", ll.toIds);
+  GetIDsFromPrefix(str, n, "Vel", "", m_Ids);
+  ll.speed = m_Ids.at(0);
+
+  if(!m_bCoordinates)
+    return;
+
+  GetPointsData(m_Coordinates, m_Points);
+  ll.points.resize(m_Points.size());
+  for(unsigned int i = 0; i < m_Points.size(); i++)
+  {
+    WayPoint& wp = ll.points.at(i);
+    wp.pos.x = wp.pos.lat = m_Points.at(i).x;
+    wp.pos.y = wp.pos.lon = m_Points.at(i).y;
+    wp.pos.z = wp.pos.alt = m_Points.at(i).z;
+    wp.laneId = ll.id;
+  }
+
+  //GetCenterLaneData adds a comma in front and removes the last character, then reads the part after each comma
+  m_LaneInfo.insert(m_LaneInfo.begin(), ',');
+  m_LaneInfo.erase(m_LaneInfo.end()-1);
+  unsigned int nParts = 0;
+  ForEachPart(m_LaneInfo.c_str(), m_LaneInfo.size(), ',', [&nParts](const char*, const size_t&) { nParts++; });
+  if(nParts != ll.points.size())
+    return;
+
+  unsigned int i = 0;
+  ForEachPart(m_LaneInfo.c_str(), m_LaneInfo.size(), ',', [&](const char* part, const size_t& len)
+  {
+    WayPoint& wp = ll.points.at(i++);
+    if(m_bVersionZero)
+    {
+      GetIDsFromPrefix(part, len, "WPID", "C", m_Ids);
+      wp.id = m_Ids.at(0);
+      GetIDsFromPrefix(part, len, "From", "To", wp.fromIds);
+      GetIDsFromPrefix(part, len, "To", "Vel", wp.toIds);
+      GetDoubleFromPrefix(part, len, "Vel", "Dir", m_Nums);
+      wp.v = m_Nums.at(0);
+      GetDoubleFromPrefix(part, len, "Dir", "", m_Nums);
+      wp.pos.a = wp.pos.dir = m_Nums.at(0);
+      return;
+    }
+
+    GetIDsFromPrefix(part, len, "WPID", "AC", m_Ids);
+    wp.id = m_Ids.at(0);
+    wp.actionCost.push_back(GetActionPairFromPrefix(part, len, "AC", "From"));
+    GetIDsFromPrefix(part, len, "From", "To", wp.fromIds);
+    GetIDsFromPrefix(part, len, "To", "Lid", wp.toIds);
+
+    GetIDsFromPrefix(part, len, "Lid", "Rid", m_Ids);
+    if(m_Ids.size() > 0)
+      wp.LeftPointId = m_Ids.at(0);
+
+    GetIDsFromPrefix(part, len, "Rid", "Vel", m_Ids);
+    if(m_Ids.size() > 0)
+      wp.RightPointId = m_Ids.at(0);
+
+    GetDoubleFromPrefix(part, len, "Vel", "Dir", m_Nums);
+    if(m_Nums.size() > 0)
+      wp.v = m_Nums.at(0);
+
+    GetDoubleFromPrefix(part, len, "Dir", "", m_Nums);
+    if(m_Nums.size() > 0)
+      wp.pos.a = wp.pos.dir = m_Nums.at(0);
+  });
+}
+
+void KmlMapReader::GetIDsFromPrefix(const char* str, const size_t& n, const char* prefix, const char* postfix, std::vector<int>& ids)
+{
+  ids.clear();
+  size_t iStart = 0, count = 0;
+  GetPrefixRange(str, n, prefix, postfix, iStart, count);
+  ForEachPart(str + iStart, count, '_', [&ids](const char* part, const size_t& len)
+  {
+    if(len > 0)
+      ids.push_back(ToInt(part, len));
+  });
+}
+
+void KmlMapReader::GetDoubleFromPrefix(const char* str, const size_t& n, const char* prefix, const char* postfix, std::vector<double>& nums)
+{
+  nums.clear();
+  size_t iStart = 0, count = 0;
+  GetPrefixRange(str, n, prefix, postfix, iStart, count);
+  ForEachPart(str + iStart, count, '_', [&nums](const char* part, const size_t& len)
+  {
+    if(len > 0)
+      nums.push_back(ToDouble(part, len));
+  });
+}
+
+std::pair<ACTION_TYPE, double> KmlMapReader::GetActionPairFromPrefix(const char* str, const size_t& n, const char* prefix, const char* postfix)
+{
+  std::pair<ACTION_TYPE, double> act_cost;
+  act_cost.first = FORWARD_ACTION;
+  act_cost.second = 0;
+
+  size_t iStart = 0, count = 0;
+  GetPrefixRange(str, n, prefix, postfix, iStart, count);
+  const char* parts[2] = {nullptr, nullptr};
+  size_t lengths[2] = {0, 0};
+  int nParts = 0;
+  ForEachPart(str + iStart, count, '_', [&](const char* part, const size_t& len)
+  {
+    if(nParts < 2)
+    {
+      parts[nParts] = part;
+      lengths[nParts] = len;
+    }
+    nParts++;
+  });
+
+  if(nParts >= 2)
+  {
+    if(lengths[0] > 0 && parts[0][0] == 'L')
+      act_cost.first = LEFT_TURN_ACTION;
+    else if(lengths[0] > 0 && parts[0][0] == 'R')
+      act_cost.first = RIGHT_TURN_ACTION;
+    if(lengths[1] > 0)
+      act_cost.second = ToDouble(parts[1], lengths[1]);
+  }
+
+  return act_cost;
+}
+
+void KmlMapReader::GetPointsData(const std::string& coordinates, std::vector<GPSPoint>& points)
+{
+  points.clear();
+  const char* p = coordinates.c_str();
+  const char* pEnd = p + coordinates.size();
+  while(p < pEnd)
+  {
+    //one point per space separated token, its first three comma separated values
+    const char* pToken = (const char*)memchr(p, ' ', pEnd - p);
+    if(!pToken)
+      pToken = pEnd;
+
+    double values[3] = {0, 0, 0};
+    const char* pValue = p;
+    for(int i = 0; i < 3 && pValue <= pToken; i++)
+    {
+      const char* pComma = (const char*)memchr(pValue, ',', pToken - pValue);
+      if(!pComma)
+        pComma = pToken;
+      values[i] = ToDouble(pValue, pComma - pValue);
+      pValue = pComma + 1;
+    }
+
+    GPSPoint gp;
+    gp.x = gp.lat = values[0];
+    gp.y = gp.lon = values[1];
+    gp.z = gp.alt = values[2];
+    points.push_back(gp);
+
+    p = pToken + 1;
+  }
+}
+
+} /* namespace PlannerHNS */
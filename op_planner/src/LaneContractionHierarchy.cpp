@@ -0,0 +1,470 @@
+/// \file LaneContractionHierarchy.cpp
+/// \brief Contraction hierarchy over the lane graph (Lane::toLanes), for fast lane level routing on large maps
+/// \date Oct 14, 2026
+
+#include "op_planner/LaneContractionHierarchy.h"
+#include "op_planner/PlanningHelpers.h"
+#include <queue>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <algorithm>
+
+namespace PlannerHNS
+{
+
+#define WITNESS_SEARCH_MAX_SETTLED 64
+
+typedef std::pair<double, int> QueueItem;
+typedef std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem> > MinQueue;
+
+LaneContractionHierarchy::LaneContractionHierarchy()
+{
+  m_bLaneChange = false;
+}
+
+LaneContractionHierarchy::~LaneContractionHierarchy()
+{
+}
+
+void LaneContractionHierarchy::Clear()
+{
+  m_bLaneChange = false;
+  m_LaneIds.clear();
+  m_Rank.clear();
+  m_Edges.clear();
+  m_UpEdges.clear();
+  m_DownEdges.clear();
+  m_LaneIndex.clear();
+  m_EdgeIndex.clear();
+  m_OutEdges.clear();
+  m_InEdges.clear();
+}
+
+bool LaneContractionHierarchy::IsBuilt() const
+{
+  return m_LaneIds.size() > 0;
+}
+
+bool LaneContractionHierarchy::IsLaneChangeEnabled() const
+{
+  return m_bLaneChange;
+}
+
+unsigned int LaneContractionHierarchy::GetNumberOfLanes() const
+{
+  return m_LaneIds.size();
+}
+
+unsigned int LaneContractionHierarchy::GetNumberOfShortcuts() const
+{
+  unsigned int n = 0;
+  for(unsigned int i = 0; i < m_Edges.size(); i++)
+  {
+    if(m_Edges.at(i).middle >= 0)
+      n++;
+  }
+  return n;
+}
+
+long long LaneContractionHierarchy::GetEdgeKey(const int& from, const int& to)
+{
+  return ((long long)from << 32) | (unsigned int)to;
+}
+
+void LaneContractionHierarchy::GetLaneIds(const RoadNetwork& map, std::vector<int>& laneIds)
+{
+  //first lane wins when ids are duplicated
+  std::unordered_map<int, int> found;
+  laneIds.clear();
+  for(unsigned int rs = 0; rs < map.roadSegments.size(); rs++)
+  {
+    for(unsigned int i = 0; i < map.roadSegments.at(rs).Lanes.size(); i++)
+    {
+      int id = map.roadSegments.at(rs).Lanes.at(i).id;
+      if(found.find(id) != found.end()) continue;
+      found[id] = laneIds.size();
+      laneIds.push_back(id);
+    }
+  }
+}
+
+bool LaneContractionHierarchy::IsBuiltFor(const RoadNetwork& map) const
+{
+  if(!IsBuilt()) return false;
+
+  std::vector<int> lane_ids;
+  GetLaneIds(map, lane_ids);
+  return lane_ids == m_LaneIds;
+}
+
+void LaneContractionHierarchy::AddEdge(const int& from, const int& to, const double& weight, const int& middle)
+{
+  if(from == to) return;
+
+  //keep only the lowest weight edge between two lanes
+  std::unordered_map<int, int>::iterator it = m_OutEdges.at(from).find(to);
+  if(it != m_OutEdges.at(from).end())
+  {
+    Edge& e = m_Edges.at(it->second);
+    if(weight < e.weight)
+    {
+      e.weight = weight;
+      e.middle = middle;
+    }
+    return;
+  }
+
+  Edge e;
+  e.from = from;
+  e.to = to;
+  e.weight = weight;
+  e.middle = middle;
+  m_OutEdges.at(from)[to] = m_Edges.size();
+  m_InEdges.at(to)[from] = m_Edges.size();
+  m_Edges.push_back(e);
+}
+
+void LaneContractionHierarchy::WitnessSearch(const int& source, const int& ignore, const double& maxCost, const std::vector<bool>& contracted,
+    std::unordered_map<int, double>& dist) const
+{
+  dist.clear();
+  MinQueue queue;
+  dist[source] = 0;
+  queue.push(std::make_pair(0.0, source));
+  int nSettled = 0;
+
+  while(queue.size() > 0 && nSettled < WITNESS_SEARCH_MAX_SETTLED)
+  {
+    QueueItem item = queue.top();
+    queue.pop();
+    if(item.first > dist[item.second]) continue;
+    if(item.first > maxCost) break;
+    nSettled++;
+
+    const std::unordered_map<int, int>& out = m_OutEdges.at(item.second);
+    for(std::unordered_map<int, int>::const_iterator it = out.begin(); it != out.end(); it++)
+    {
+      if(it->first == ignore || contracted.at(it->first)) continue;
+
+      double d = item.first + m_Edges.at(it->second).weight;
+      std::unordered_map<int, double>::iterator it_d = dist.find(it->first);
+      if(it_d == dist.end() || d < it_d->second)
+      {
+        dist[it->first] = d;
+        queue.push(std::make_pair(d, it->first));
+      }
+    }
+  }
+}
+
+int LaneContractionHierarchy::ContractLane(const int& v, const std::vector<bool>& contracted, const bool& bAddShortcuts)
+{
+  //copy, AddEdge changes the adjacency of the neighbors
+  std::vector<std::pair<int, double> > ins, outs;
+  for(std::unordered_map<int, int>::const_iterator it = m_InEdges.at(v).begin(); it != m_InEdges.at(v).end(); it++)
+  {
+    if(!contracted.at(it->first))
+      ins.push_back(std::make_pair(it->first, m_Edges.at(it->second).weight));
+  }
+  for(std::unordered_map<int, int>::const_iterator it = m_OutEdges.at(v).begin(); it != m_OutEdges.at(v).end(); it++)
+  {
+    if(!contracted.at(it->first))
+      outs.push_back(std::make_pair(it->first, m_Edges.at(it->second).weight));
+  }
+
+  //hash map iteration order is not fixed, sort so the shortcuts are the same on every build
+  std::sort(ins.begin(), ins.end());
+  std::sort(outs.begin(), outs.end());
+
+  double max_out = 0;
+  for(unsigned int j = 0; j < outs.size(); j++)
+    max_out = std::max(max_out, outs.at(j).second);
+
+  int nShortcuts = 0;
+  std::unordered_map<int, double> dist;
+  for(unsigned int i = 0; i < ins.size(); i++)
+  {
+    int u = ins.at(i).first;
+    WitnessSearch(u, v, ins.at(i).second + max_out, contracted, dist);
+    for(unsigned int j = 0; j < outs.size(); j++)
+    {
+      int x = outs.at(j).first;
+      if(x == u) continue;
+
+      double via_v = ins.at(i).second + outs.at(j).second;
+      std::unordered_map<int, double>::iterator it_d = dist.find(x);
+      if(it_d != dist.end() && it_d->second <= via_v) continue;
+
+      nShortcuts++;
+      if(bAddShortcuts)
+        AddEdge(u, x, via_v, v);
+    }
+  }
+
+  return nShortcuts - (int)ins.size() - (int)outs.size();
+}
+
+void LaneContractionHierarchy::Build(const RoadNetwork& map, const bool& bEnableLaneChange)
+{
+  Clear();
+  m_bLaneChange = bEnableLaneChange;
+  GetLaneIds(map, m_LaneIds);
+  int n = m_LaneIds.size();
+  for(int i = 0; i < n; i++)
+    m_LaneIndex[m_LaneIds.at(i)] = i;
+
+  m_OutEdges.resize(n);
+  m_InEdges.resize(n);
+  for(unsigned int rs = 0; rs < map.roadSegments.size(); rs++)
+  {
+    for(unsigned int i = 0; i < map.roadSegments.at(rs).Lanes.size(); i++)
+    {
+      const Lane& l = map.roadSegments.at(rs).Lanes.at(i);
+      int from = m_LaneIndex[l.id];
+      double length = 0;
+      for(unsigned int p = 1; p < l.points.size(); p++)
+        length += hypot(l.points.at(p).pos.y - l.points.at(p-1).pos.y, l.points.at(p).pos.x - l.points.at(p-1).pos.x);
+
+      for(unsigned int j = 0; j < l.toLanes.size(); j++)
+      {
+        std::unordered_map<int, int>::iterator it = m_LaneIndex.find(l.toLanes.at(j)->id);
+        if(it != m_LaneIndex.end())
+          AddEdge(from, it->second, length, -1);
+      }
+
+      if(!bEnableLaneChange) continue;
+
+      Lane* pSides[2] = {l.pLeftLane, l.pRightLane};
+      for(int s = 0; s < 2; s++)
+      {
+        if(!pSides[s]) continue;
+        std::unordered_map<int, int>::iterator it = m_LaneIndex.find(pSides[s]->id);
+        if(it != m_LaneIndex.end())
+          AddEdge(from, it->second, LANE_CHANGE_MIN_DISTANCE, -1);
+      }
+    }
+  }
+
+  //lazy update, the lane on top is contracted only if its recomputed priority is still the lowest
+  std::vector<bool> contracted(n, false);
+  std::vector<int> contracted_neighbors(n, 0);
+  MinQueue queue;
+  for(int v = 0; v < n; v++)
+    queue.push(std::make_pair((double)ContractLane(v, contracted, false), v));
+
+  m_Rank.assign(n, 0);
+  int rank = 0;
+  while(queue.size() > 0)
+  {
+    QueueItem item = queue.top();
+    queue.pop();
+    int v = item.second;
+    if(contracted.at(v)) continue;
+
+    double priority = ContractLane(v, contracted, false) + contracted_neighbors.at(v);
+    if(queue.size() > 0 && priority > queue.top().first)
+    {
+      queue.push(std::make_pair(priority, v));
+      continue;
+    }
+
+    ContractLane(v, contracted, true);
+    contracted.at(v) = true;
+    m_Rank.at(v) = rank++;
+
+    for(std::unordered_map<int, int>::const_iterator it = m_InEdges.at(v).begin(); it != m_InEdges.at(v).end(); it++)
+      contracted_neighbors.at(it->first)++;
+    for(std::unordered_map<int, int>::const_iterator it = m_OutEdges.at(v).begin(); it != m_OutEdges.at(v).end(); it++)
+      contracted_neighbors.at(it->first)++;
+  }
+
+  m_OutEdges.clear();
+  m_InEdges.clear();
+  BuildSearchGraph();
+}
+
+void LaneContractionHierarchy::BuildSearchGraph()
+{
+  int n = m_LaneIds.size();
+  m_UpEdges.assign(n, std::vector<int>());
+  m_DownEdges.assign(n, std::vector<int>());
+  m_EdgeIndex.clear();
+  m_LaneIndex.clear();
+  for(int i = 0; i < n; i++)
+    m_LaneIndex[m_LaneIds.at(i)] = i;
+
+  for(unsigned int i = 0; i < m_Edges.size(); i++)
+  {
+    const Edge& e = m_Edges.at(i);
+    m_EdgeIndex[GetEdgeKey(e.from, e.to)] = i;
+    if(m_Rank.at(e.to) > m_Rank.at(e.from))
+      m_UpEdges.at(e.from).push_back(i);
+    else
+      m_DownEdges.at(e.to).push_back(i);
+  }
+}
+
+void LaneContractionHierarchy::UnpackEdge(const int& iEdge, std::vector<int>& lanes) const
+{
+  const Edge& e = m_Edges.at(iEdge);
+  if(e.middle < 0)
+  {
+    lanes.push_back(e.to);
+    return;
+  }
+
+  UnpackEdge(m_EdgeIndex.at(GetEdgeKey(e.from, e.middle)), lanes);
+  UnpackEdge(m_EdgeIndex.at(GetEdgeKey(e.middle, e.to)), lanes);
+}
+
+bool LaneContractionHierarchy::GetLaneRoute(const int& startLaneId, const int& goalLaneId, std::vector<int>& laneIds, double& cost) const
+{
+  laneIds.clear();
+  cost = 0;
+  std::unordered_map<int, int>::const_iterator it_start = m_LaneIndex.find(startLaneId);
+  std::unordered_map<int, int>::const_iterator it_goal = m_LaneIndex.find(goalLaneId);
+  if(it_start == m_LaneIndex.end() || it_goal == m_LaneIndex.end()) return false;
+
+  if(startLaneId == goalLaneId)
+  {
+    laneIds.push_back(startLaneId);
+    return true;
+  }
+
+  //index 0 forward search from the start on up edges, 1 backward search from the goal on down edges
+  std::unordered_map<int, double> dist[2];
+  std::unordered_map<int, int> parent_edge[2];
+  MinQueue queue[2];
+  dist[0][it_start->second] = 0;
+  dist[1][it_goal->second] = 0;
+  queue[0].push(std::make_pair(0.0, it_start->second));
+  queue[1].push(std::make_pair(0.0, it_goal->second));
+
+  double best = std::numeric_limits<double>::max();
+  int meet = -1;
+  while(queue[0].size() > 0 || queue[1].size() > 0)
+  {
+    double min_f = queue[0].size() > 0 ? queue[0].top().first : std::numeric_limits<double>::max();
+    double min_b = queue[1].size() > 0 ? queue[1].top().first : std::numeric_limits<double>::max();
+    if(std::min(min_f, min_b) >= best) break;
+
+    int s = min_f <= min_b ? 0 : 1;
+    QueueItem item = queue[s].top();
+    queue[s].pop();
+    int u = item.second;
+    if(item.first > dist[s][u]) continue;
+
+    std::unordered_map<int, double>::const_iterator it_other = dist[1-s].find(u);
+    if(it_other != dist[1-s].end() && item.first + it_other->second < best)
+    {
+      best = item.first + it_other->second;
+      meet = u;
+    }
+
+    const std::vector<int>& edges = s == 0 ? m_UpEdges.at(u) : m_DownEdges.at(u);
+    for(unsigned int i = 0; i < edges.size(); i++)
+    {
+      const Edge& e = m_Edges.at(edges.at(i));
+      int v = s == 0 ? e.to : e.from;
+      double d = item.first + e.weight;
+      std::unordered_map<int, double>::iterator it_d = dist[s].find(v);
+      if(it_d == dist[s].end() || d < it_d->second)
+      {
+        dist[s][v] = d;
+        parent_edge[s][v] = edges.at(i);
+        queue[s].push(std::make_pair(d, v));
+      }
+    }
+  }
+
+  if(meet < 0) return false;
+
+  std::vector<int> up_edges;
+  for(int v = meet; v != it_start->second; v = m_Edges.at(up_edges.back()).from)
+    up_edges.push_back(parent_edge[0].at(v));
+  std::reverse(up_edges.begin(), up_edges.end());
+  for(int v = meet; v != it_goal->second; v = m_Edges.at(up_edges.back()).to)
+    up_edges.push_back(parent_edge[1].at(v));
+
+  std::vector<int> lanes;
+  lanes.push_back(it_start->second);
+  for(unsigned int i = 0; i < up_edges.size(); i++)
+    UnpackEdge(up_edges.at(i), lanes);
+
+  for(unsigned int i = 0; i < lanes.size(); i++)
+    laneIds.push_back(m_LaneIds.at(lanes.at(i)));
+
+  cost = best;
+  return true;
+}
+
+bool LaneContractionHierarchy::SaveToFile(const std::string& fileName) const
+{
+  std::ofstream f(fileName.c_str());
+  if(!f.is_open()) return false;
+
+  f << std::setprecision(17);
+  f << "LaneContractionHierarchy 1" << std::endl;
+  f << "lane_change " << (m_bLaneChange ? 1 : 0) << std::endl;
+  f << "lanes " << m_LaneIds.size() << std::endl;
+  for(unsigned int i = 0; i < m_LaneIds.size(); i++)
+    f << m_LaneIds.at(i) << " " << m_Rank.at(i) << std::endl;
+
+  f << "edges " << m_Edges.size() << std::endl;
+  for(unsigned int i = 0; i < m_Edges.size(); i++)
+    f << m_Edges.at(i).from << " " << m_Edges.at(i).to << " " << m_Edges.at(i).weight << " " << m_Edges.at(i).middle << std::endl;
+
+  return f.good();
+}
+
+bool LaneContractionHierarchy::LoadFromFile(const std::string& fileName, const RoadNetwork& map)
+{
+  Clear();
+  std::ifstream f(fileName.c_str());
+  if(!f.is_open()) return false;
+
+  std::string name, tag;
+  int version = 0, lane_change = 0;
+  unsigned int n_lanes = 0, n_edges = 0;
+  f >> name >> version;
+  f >> tag >> lane_change;
+  f >> tag >> n_lanes;
+  if(!f.good() || name != "LaneContractionHierarchy" || version != 1) return false;
+
+  m_LaneIds.resize(n_lanes);
+  m_Rank.resize(n_lanes);
+  for(unsigned int i = 0; i < n_lanes; i++)
+    f >> m_LaneIds.at(i) >> m_Rank.at(i);
+
+  f >> tag >> n_edges;
+  if(!f.good())
+  {
+    Clear();
+    return false;
+  }
+
+  m_Edges.resize(n_edges);
+  for(unsigned int i = 0; i < n_edges; i++)
+  {
+    Edge& e = m_Edges.at(i);
+    f >> e.from >> e.to >> e.weight >> e.middle;
+    if(!f.good() || e.from < 0 || e.to < 0 || e.from >= (int)n_lanes || e.to >= (int)n_lanes || e.middle >= (int)n_lanes)
+    {
+      Clear();
+      return false;
+    }
+  }
+
+  m_bLaneChange = lane_change != 0;
+  if(!IsBuiltFor(map))
+  {
+    Clear();
+    return false;
+  }
+
+  BuildSearchGraph();
+  return true;
+}
+
+} /* namespace PlannerHNS */
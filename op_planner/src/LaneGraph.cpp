@@ -0,0 +1,182 @@
+/// \file LaneGraph.cpp
+/// \brief Lane level graph of a RoadNetwork, for coarse routing before the waypoint search
+/// \date Oct 14, 2026
+
+#include "op_planner/LaneGraph.h"
+#include "op_planner/PlanningHelpers.h"
+#include <queue>
+#include <limits>
+#include <algorithm>
+
+namespace PlannerHNS
+{
+
+typedef std::pair<double, int> QueueItem;
+typedef std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem> > MinQueue;
+
+LaneGraph::LaneGraph()
+{
+  m_pMap = nullptr;
+  m_MapVersion = 0;
+  m_bLaneChange = false;
+}
+
+LaneGraph::~LaneGraph()
+{
+}
+
+void LaneGraph::Clear()
+{
+  m_pMap = nullptr;
+  m_MapVersion = 0;
+  m_bLaneChange = false;
+  m_LaneIds.clear();
+  m_LaneLengths.clear();
+  m_FirstEdge.clear();
+  m_EdgeTo.clear();
+  m_EdgeWeight.clear();
+  m_LaneIndex.clear();
+}
+
+bool LaneGraph::IsBuilt() const
+{
+  return m_LaneIds.size() > 0;
+}
+
+bool LaneGraph::IsBuiltFor(const RoadNetwork& map) const
+{
+  return IsBuilt() && m_pMap == &map && map.version > 0 && m_MapVersion == map.version;
+}
+
+bool LaneGraph::IsLaneChangeEnabled() const
+{
+  return m_bLaneChange;
+}
+
+unsigned int LaneGraph::GetNumberOfLanes() const
+{
+  return m_LaneIds.size();
+}
+
+unsigned int LaneGraph::GetNumberOfEdges() const
+{
+  return m_EdgeTo.size();
+}
+
+double LaneGraph::GetLaneLength(const int& laneId) const
+{
+  std::unordered_map<int, int>::const_iterator it = m_LaneIndex.find(laneId);
+  if(it == m_LaneIndex.end()) return -1;
+  return m_LaneLengths.at(it->second);
+}
+
+void LaneGraph::Build(const RoadNetwork& map, const bool& bEnableLaneChange)
+{
+  Clear();
+  m_pMap = &map;
+  m_MapVersion = map.version;
+  m_bLaneChange = bEnableLaneChange;
+
+  //first lane wins when ids are duplicated
+  std::vector<const Lane*> lanes;
+  for(unsigned int rs = 0; rs < map.roadSegments.size(); rs++)
+  {
+    for(unsigned int i = 0; i < map.roadSegments.at(rs).Lanes.size(); i++)
+    {
+      const Lane& l = map.roadSegments.at(rs).Lanes.at(i);
+      if(m_LaneIndex.find(l.id) != m_LaneIndex.end()) continue;
+      m_LaneIndex[l.id] = lanes.size();
+      m_LaneIds.push_back(l.id);
+      lanes.push_back(&l);
+    }
+  }
+
+  int n = lanes.size();
+  m_LaneLengths.resize(n);
+  m_FirstEdge.resize(n + 1);
+  std::vector<std::pair<int, double> > edges;
+  for(int i = 0; i < n; i++)
+  {
+    const Lane* pL = lanes.at(i);
+    double length = 0;
+    for(unsigned int p = 1; p < pL->points.size(); p++)
+      length += hypot(pL->points.at(p).pos.y - pL->points.at(p-1).pos.y, pL->points.at(p).pos.x - pL->points.at(p-1).pos.x);
+    m_LaneLengths.at(i) = length;
+
+    edges.clear();
+    for(unsigned int j = 0; j < pL->toLanes.size(); j++)
+    {
+      std::unordered_map<int, int>::iterator it = pL->toLanes.at(j) ? m_LaneIndex.find(pL->toLanes.at(j)->id) : m_LaneIndex.end();
+      if(it != m_LaneIndex.end())
+        edges.push_back(std::make_pair(it->second, length));
+    }
+
+    if(bEnableLaneChange)
+    {
+      const Lane* pSides[2] = {pL->pLeftLane, pL->pRightLane};
+      for(int s = 0; s < 2; s++)
+      {
+        std::unordered_map<int, int>::iterator it = pSides[s] ? m_LaneIndex.find(pSides[s]->id) : m_LaneIndex.end();
+        if(it != m_LaneIndex.end())
+          edges.push_back(std::make_pair(it->second, (double)LANE_CHANGE_MIN_DISTANCE));
+      }
+    }
+
+    //keep only the lowest weight edge between two lanes
+    std::sort(edges.begin(), edges.end());
+    m_FirstEdge.at(i) = m_EdgeTo.size();
+    for(unsigned int j = 0; j < edges.size(); j++)
+    {
+      if(edges.at(j).first == i || (j > 0 && edges.at(j).first == edges.at(j-1).first)) continue;
+      m_EdgeTo.push_back(edges.at(j).first);
+      m_EdgeWeight.push_back(edges.at(j).second);
+    }
+  }
+  m_FirstEdge.at(n) = m_EdgeTo.size();
+}
+
+bool LaneGraph::GetLaneRoute(const int& startLaneId, const int& goalLaneId, std::vector<int>& laneIds, double& cost) const
+{
+  laneIds.clear();
+  cost = 0;
+  std::unordered_map<int, int>::const_iterator it_start = m_LaneIndex.find(startLaneId);
+  std::unordered_map<int, int>::const_iterator it_goal = m_LaneIndex.find(goalLaneId);
+  if(it_start == m_LaneIndex.end() || it_goal == m_LaneIndex.end()) return false;
+
+  int start = it_start->second, goal = it_goal->second;
+  std::vector<double> dist(m_LaneIds.size(), std::numeric_limits<double>::max());
+  std::vector<int> parent(m_LaneIds.size(), -1);
+  MinQueue queue;
+  dist.at(start) = 0;
+  queue.push(std::make_pair(0.0, start));
+  while(queue.size() > 0)
+  {
+    QueueItem item = queue.top();
+    queue.pop();
+    int u = item.second;
+    if(item.first > dist.at(u)) continue;
+    if(u == goal) break;
+
+    for(int e = m_FirstEdge.at(u); e < m_FirstEdge.at(u + 1); e++)
+    {
+      int v = m_EdgeTo.at(e);
+      double d = item.first + m_EdgeWeight.at(e);
+      if(d < dist.at(v))
+      {
+        dist.at(v) = d;
+        parent.at(v) = u;
+        queue.push(std::make_pair(d, v));
+      }
+    }
+  }
+
+  if(dist.at(goal) == std::numeric_limits<double>::max()) return false;
+
+  for(int v = goal; v >= 0; v = parent.at(v))
+    laneIds.push_back(m_LaneIds.at(v));
+  std::reverse(laneIds.begin(), laneIds.end());
+  cost = dist.at(goal);
+  return true;
+}
+
+} /* namespace PlannerHNS */
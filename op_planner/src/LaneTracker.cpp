@@ -0,0 +1,140 @@
+/// \file LaneTracker.cpp
+/// \brief Current lane of the car between planning cycles, searched on the previous lane and its neighbors before the map
+/// \date Oct 14, 2026
+
+#include "op_planner/LaneTracker.h"
+#include "op_planner/MappingHelpers.h"
+#include "op_planner/PlanningHelpers.h"
+#include <float.h>
+
+namespace PlannerHNS
+{
+
+LaneTracker::LaneTracker() : m_LaneCursor(20)
+{
+  m_DefaultLaneWidth = 3.5;
+  m_nHits = 0;
+  m_nFallbacks = 0;
+  m_pMap = 0;
+  m_MapVersion = 0;
+  m_pLane = 0;
+}
+
+LaneTracker::~LaneTracker()
+{
+}
+
+void LaneTracker::Reset()
+{
+  m_pMap = 0;
+  m_MapVersion = 0;
+  m_pSnapshot.reset();
+  m_pLane = 0;
+  m_LaneCursor.Reset();
+}
+
+bool LaneTracker::IsOnLane(const Lane* pL, const WayPoint& pos, const double& search_distance, double& perp_distance)
+{
+  if(!pL || pL->points.size() < 2) return false;
+
+  const std::vector<WayPoint>& points = pL->points;
+  RelativeInfo info;
+  if(pL == m_pLane)
+    m_LaneCursor.GetRelativeInfo(points, pos, info);
+  else
+    PlanningHelpers::GetRelativeInfo(points, pos, info);
+
+  const double half_width = (pL->width > 0 ? pL->width : m_DefaultLaneWidth) / 2.0;
+  perp_distance = fabs(info.perp_distance);
+  if(perp_distance > half_width || perp_distance > search_distance || fabs(info.angle_diff) >= 45)
+    return false;
+
+  //before the first point or after the last one, the car is on the lane before or after this one
+  const int n = points.size();
+  const GPSPoint& p0 = points.at(0).pos;
+  const GPSPoint& p1 = points.at(1).pos;
+  if(info.iFront <= 1 && (pos.pos.x - p0.x)*(p1.x - p0.x) + (pos.pos.y - p0.y)*(p1.y - p0.y) < 0)
+    return false;
+
+  const GPSPoint& pe = points.at(n-1).pos;
+  const GPSPoint& pe_prev = points.at(n-2).pos;
+  if(info.iFront >= n-1 && (pos.pos.x - pe.x)*(pe.x - pe_prev.x) + (pos.pos.y - pe.y)*(pe.y - pe_prev.y) > 0)
+    return false;
+
+  return true;
+}
+
+const Lane* LaneTracker::GetCurrentLane(const WayPoint& pos, const RoadNetwork& map, const double& search_distance)
+{
+  //a map reassigned in place keeps its address, its lanes are not the ones m_pLane points to anymore
+  if(m_pMap != &map || m_MapVersion != map.version)
+  {
+    m_LaneCursor.Reset();
+    m_pLane = 0;
+    m_pMap = &map;
+    m_MapVersion = map.version;
+  }
+
+  if(m_pLane)
+  {
+    //the previous lane wins the ties, then the lanes it leads to, then its neighbors
+    const Lane* pBest = 0;
+    double min_d = DBL_MAX, d = 0;
+    if(IsOnLane(m_pLane, pos, search_distance, d))
+    {
+      pBest = m_pLane;
+      min_d = d;
+    }
+
+    for(unsigned int i = 0; i < m_pLane->toLanes.size(); i++)
+    {
+      if(IsOnLane(m_pLane->toLanes.at(i), pos, search_distance, d) && d < min_d)
+      {
+        pBest = m_pLane->toLanes.at(i);
+        min_d = d;
+      }
+    }
+
+    const Lane* neighbors[2] = {m_pLane->pLeftLane, m_pLane->pRightLane};
+    for(int i = 0; i < 2; i++)
+    {
+      if(IsOnLane(neighbors[i], pos, search_distance, d) && d < min_d)
+      {
+        pBest = neighbors[i];
+        min_d = d;
+      }
+    }
+
+    if(pBest)
+    {
+      m_nHits++;
+      if(pBest != m_pLane)
+      {
+        m_pLane = pBest;
+        m_LaneCursor.Reset();
+      }
+      return m_pLane;
+    }
+  }
+
+  m_nFallbacks++;
+  const Lane* pL = MappingHelpers::GetClosestLaneFromMap(pos, map, search_distance);
+  if(pL != m_pLane)
+    m_LaneCursor.Reset();
+  m_pLane = pL;
+  return m_pLane;
+}
+
+const Lane* LaneTracker::GetCurrentLane(const WayPoint& pos, const RoadNetworkSnapshotPtr& pMap, const double& search_distance)
+{
+  if(!pMap)
+  {
+    Reset();
+    return 0;
+  }
+
+  m_pSnapshot = pMap;
+  return GetCurrentLane(pos, *pMap, search_distance);
+}
+
+} /* namespace PlannerHNS */
@@ -22,6 +22,8 @@ LocalPlannerH::LocalPlannerH()
   m_iSafeTrajectory = 0;
   m_iCurrentTotalPathId = 0;
   pLane = 0;
+  m_GlobalPathFingerprint = 0;
+  m_bGlobalPathFingerprint = false;
   m_CurrentVelocity =  m_CurrentVelocityD =0;
   m_CurrentSteering = m_CurrentSteeringD =0;
   m_CurrentShift     =  m_CurrentShiftD = SHIFT_POS_NN;
@@ -40,6 +42,12 @@ LocalPlannerH::LocalPlannerH()
   m_SimulationSteeringDelayFactor = 0.1;
   UtilityH::GetTickCount(m_SteerDelayTimer);
   m_PredictionTime = 0;
+  m_CostCalculationTime = 0;
+  m_BehaviorGenTime = 0;
+  m_RollOutsGenerationTime = 0;
+
+  for(int i = 0; i < STAGE_COUNT; i++)
+    m_StageLatency.AddStage(GetPlanningStageName((PLANNING_STAGE)i));
 
   InitBehaviorStates();
 }
@@ -155,6 +163,8 @@ void LocalPlannerH::ReInitializePlanner(const WayPoint& start_pose)
   m_TotalPath.clear();
   m_OriginalLocalPath.clear();
   m_TotalOriginalPath.clear();
+  m_bGlobalPathFingerprint = false;
+  m_LaneTracker.Reset();
   m_Path.clear();
   m_RollOuts.clear();
   m_pCurrentBehaviorState->m_Behavior = PlannerHNS::FORWARD_STATE;
@@ -252,10 +262,7 @@ void LocalPlannerH::ReInitializePlanner(const WayPoint& start_pose)
 
  void LocalPlannerH::TransformPoint(const PlannerHNS::WayPoint& refPose, PlannerHNS::GPSPoint& p)
  {
-   PlannerHNS::Mat3 rotationMat(refPose.pos.a);
-   PlannerHNS::Mat3 translationMat(refPose.pos.x, refPose.pos.y);
-  p = rotationMat*p;
-  p = translationMat*p;
+   PlannerHNS::RigidTransform2D(refPose.pos).Transform(p);
  }
 
  bool LocalPlannerH::GetNextTrafficLight(const int& prevTrafficLightId, const std::vector<PlannerHNS::TrafficLight>& trafficLights, PlannerHNS::TrafficLight& trafficL)
@@ -378,13 +385,13 @@ void LocalPlannerH::ReInitializePlanner(const WayPoint& start_pose)
 
  void LocalPlannerH::UpdateCurrentLane(PlannerHNS::RoadNetwork& map, const double& search_distance)
  {
-   PlannerHNS::Lane* pMapLane = 0;
+   const PlannerHNS::Lane* pMapLane = 0;
   PlannerHNS::Lane* pPathLane = 0;
   pPathLane = MappingHelpers::GetLaneFromPath(state, m_Path);
   if(!pPathLane)
   {
     cout << "Performance Alert: Can't Find Lane Information in Global Path, Searching the Map :( " << endl;
-    pMapLane  = MappingHelpers::GetClosestLaneFromMap(state, map, search_distance);
+    pMapLane  = m_LaneTracker.GetCurrentLane(state, map, search_distance);
 
   }
 
@@ -408,17 +415,12 @@ void LocalPlannerH::ReInitializePlanner(const WayPoint& start_pose)
    if(m_TotalPath.size()==0) return false;
 
    PlannerHNS::RelativeInfo info;
-   PlanningHelpers::GetRelativeInfo(m_TotalPath.at(iGlobalPathIndex), state, info);
+   const std::vector<WayPoint>& path = m_TotalPath.at(iGlobalPathIndex);
+   m_TotalPathCursor.GetRelativeInfo(path, state, info);
 
-   double d = 0;
-   for(unsigned int i = info.iFront; i < m_TotalPath.at(iGlobalPathIndex).size()-1; i++)
-   {
-     d+= hypot(m_TotalPath.at(iGlobalPathIndex).at(i+1).pos.y - m_TotalPath.at(iGlobalPathIndex).at(i).pos.y, m_TotalPath.at(iGlobalPathIndex).at(i+1).pos.x - m_TotalPath.at(iGlobalPathIndex).at(i).pos.x);
-     if(d > min_distance)
-       return false;
-   }
+   double d = m_TotalPathCursor.GetDistanceBetweenIndices(path, info.iFront, path.size()-1);
 
-   return true;
+   return d <= min_distance;
  }
 
  bool LocalPlannerH::SelectSafeTrajectoryAndSpeedProfile(const PlannerHNS::VehicleState& vehicleState)
@@ -429,7 +431,7 @@ void LocalPlannerH::ReInitializePlanner(const WayPoint& start_pose)
 
   if(m_TotalPath.size()>0)
   {
-    int currIndex = PlannerHNS::PlanningHelpers::GetClosestNextPointIndexFast(m_Path, state);
+    int currIndex = m_PathCursor.GetClosestNextPointIndex(m_Path, state);
     int index_limit = 0;//m_Path.size() - 20;
     if(index_limit<=0)
       index_limit =  m_Path.size()/2.0;
@@ -476,6 +478,7 @@ void LocalPlannerH::ReInitializePlanner(const WayPoint& start_pose)
           && preCalcPrams->iPrevSafeTrajectory < (int)m_RollOuts.at(preCalcPrams->iPrevSafeLane).size())
       {
         m_Path = m_RollOuts.at(preCalcPrams->iPrevSafeLane).at(preCalcPrams->iPrevSafeTrajectory);
+        m_PathCursor.Reset();
         m_OriginalLocalPath = m_TotalPath.at(m_iCurrentTotalPathId);
         bNewTrajectory = true;
       }
@@ -622,8 +625,8 @@ void LocalPlannerH::ReInitializePlanner(const WayPoint& start_pose)
   if(m_TotalOriginalPath.size() ==0 ) return 0;
 
   RelativeInfo info, total_info;
-  PlanningHelpers::GetRelativeInfo(m_TotalOriginalPath.at(m_iCurrentTotalPathId), state, total_info);
-  PlanningHelpers::GetRelativeInfo(m_Path, state, info);
+  m_TotalOriginalPathCursor.GetRelativeInfo(m_TotalOriginalPath.at(m_iCurrentTotalPathId), state, total_info);
+  m_PathCursor.GetRelativeInfo(m_Path, state, info);
   double average_braking_distance = -pow(CurrStatus.speed, 2)/(m_CarInfo.max_deceleration) + m_params.additionalBrakingDistance;
   double max_velocity  = PlannerHNS::PlanningHelpers::GetVelocityAhead(m_TotalOriginalPath.at(m_iCurrentTotalPathId), total_info, m_PrevBrakingWayPoint, average_braking_distance);
 
@@ -716,13 +719,32 @@ void LocalPlannerH::ReInitializePlanner(const WayPoint& start_pose)
   return max_velocity;
  }
 
+ void LocalPlannerH::SetNewGlobalPath(const std::vector<std::vector<WayPoint> >& globalPath, const unsigned long long& fingerprint)
+ {
+   if(!m_pCurrentBehaviorState) return;
+
+   if(m_bGlobalPathFingerprint && fingerprint == m_GlobalPathFingerprint && globalPath.size() == m_TotalOriginalPath.size())
+     return;
+
+   m_GlobalPathFingerprint = fingerprint;
+   m_bGlobalPathFingerprint = true;
+   m_TotalOriginalPath = globalPath;
+   m_pCurrentBehaviorState->GetCalcParams()->bNewGlobalPath = true;
+ }
+
  void LocalPlannerH::ExtractHorizonAndCalculateRecommendedSpeed()
  {
+   if(m_pCurrentBehaviorState->GetCalcParams()->bNewGlobalPath || m_TotalOriginalPathGeometry.size() != m_TotalOriginalPath.size())
+   {
+     m_TotalOriginalPathGeometry.clear();
+     m_TotalOriginalPathGeometry.resize(m_TotalOriginalPath.size());
+   }
+
    if(m_pCurrentBehaviorState->GetCalcParams()->bNewGlobalPath && m_TotalOriginalPath.size() > 0)
     {
        m_PrevBrakingWayPoint = 0;
-       PlanningHelpers::FixPathDensity(m_TotalOriginalPath.at(m_iCurrentTotalPathId), m_pCurrentBehaviorState->m_pParams->pathDensity);
-       PlanningHelpers::SmoothPath(m_TotalOriginalPath.at(m_iCurrentTotalPathId), 0.49, 0.25, 0.05);
+       PlanningHelpers::FixPathDensity(m_TotalOriginalPath.at(m_iCurrentTotalPathId), m_pCurrentBehaviorState->m_pParams->pathDensity, m_TotalOriginalPathGeometry.at(m_iCurrentTotalPathId));
+       PlanningHelpers::SmoothPath(m_TotalOriginalPath.at(m_iCurrentTotalPathId), m_TotalOriginalPathGeometry.at(m_iCurrentTotalPathId), 0.49, 0.25, 0.05);
        
       PlanningHelpers::GenerateRecommendedSpeed(m_TotalOriginalPath.at(m_iCurrentTotalPathId), m_CarInfo.max_speed_forward, m_pCurrentBehaviorState->m_pParams->speedProfileFactor);
       m_TotalOriginalPath.at(m_iCurrentTotalPathId).at(m_TotalOriginalPath.at(m_iCurrentTotalPathId).size()-1).v = 0;
@@ -734,13 +756,12 @@ void LocalPlannerH::ReInitializePlanner(const WayPoint& start_pose)
      for(unsigned int i = 0; i < m_TotalOriginalPath.size(); i++)
     {
       vector<WayPoint> centerTrajectorySmoothed;
-      PlanningHelpers::ExtractPartFromPointToDistanceFast(m_TotalOriginalPath.at(i), state,
+      PathGeometry centerGeometry;
+      m_TotalOriginalPathGeometry.at(i).Update(m_TotalOriginalPath.at(i));
+      PlanningHelpers::ExtractPartFromPointToDistanceFast(m_TotalOriginalPath.at(i), m_TotalOriginalPathGeometry.at(i), state,
           m_pCurrentBehaviorState->m_pParams->horizonDistance ,
           m_pCurrentBehaviorState->m_pParams->pathDensity ,
-          centerTrajectorySmoothed,
-          m_pCurrentBehaviorState->m_pParams->smoothingDataWeight,
-          m_pCurrentBehaviorState->m_pParams->smoothingSmoothWeight,
-          m_pCurrentBehaviorState->m_pParams->smoothingToleranceError);
+          centerTrajectorySmoothed, centerGeometry);
 
       m_TotalPath.push_back(centerTrajectorySmoothed);
     }
@@ -764,8 +785,10 @@ void LocalPlannerH::ReInitializePlanner(const WayPoint& start_pose)
 
   UpdateCurrentLane(map, 3.0);
 
-
-  ExtractHorizonAndCalculateRecommendedSpeed();
+  {
+    OP_STAGE_TIMER(&m_StageLatency, STAGE_TOTAL_PATH);
+    ExtractHorizonAndCalculateRecommendedSpeed();
+  }
 
 
   m_PredictedTrajectoryObstacles = obj_list;
@@ -776,6 +799,7 @@ void LocalPlannerH::ReInitializePlanner(const WayPoint& start_pose)
       m_pCurrentBehaviorState->GetCalcParams()->iCurrSafeTrajectory, m_pCurrentBehaviorState->GetCalcParams()->iCurrSafeLane, *m_pCurrentBehaviorState->m_pParams,
       m_CarInfo,vehicleState, m_PredictedTrajectoryObstacles);
   m_CostCalculationTime = UtilityH::GetTimeDiffNow(t);
+  OP_STAGE_RECORD(&m_StageLatency, STAGE_TRAJECTORY_COSTS, m_CostCalculationTime);
 
 
   UtilityH::GetTickCount(t);
@@ -783,13 +807,18 @@ void LocalPlannerH::ReInitializePlanner(const WayPoint& start_pose)
 
   beh = GenerateBehaviorState(vehicleState);
   m_BehaviorGenTime = UtilityH::GetTimeDiffNow(t);
+  OP_STAGE_RECORD(&m_StageLatency, STAGE_BEHAVIOR_STATE, m_BehaviorGenTime);
 
   UtilityH::GetTickCount(t);
   beh.bNewPlan = SelectSafeTrajectoryAndSpeedProfile(vehicleState);
 
   m_RollOutsGenerationTime = UtilityH::GetTimeDiffNow(t);
+  OP_STAGE_RECORD(&m_StageLatency, STAGE_ROLL_OUTS, m_RollOutsGenerationTime);
 
-  beh.maxVelocity = UpdateVelocityDirectlyToTrajectory(beh, vehicleState, dt);
+  {
+    OP_STAGE_TIMER(&m_StageLatency, STAGE_VELOCITY_PROFILE);
+    beh.maxVelocity = UpdateVelocityDirectlyToTrajectory(beh, vehicleState, dt);
+  }
 
   return beh;
  }
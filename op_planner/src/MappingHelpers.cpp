@@ -9,10 +9,18 @@
 #include "op_planner/MappingHelpers.h"
 #include "op_planner/MatrixOperations.h"
 #include "op_planner/PlanningHelpers.h"
+#include "op_planner/RoadNetworkSnapshot.h"
+#include "op_planner/KmlMapReader.h"
+#include "op_utility/TaskScheduler.h"
+#include <algorithm>
 #include <float.h>
+#include <map>
 
 #include "math.h"
 #include <fstream>
+#include <atomic>
+#include <unordered_set>
+#include <future>
 
 using namespace UtilityHNS;
 using namespace std;
@@ -47,8 +55,38 @@ GPSPoint MappingHelpers::GetTransformationOrigin(const int& bToyotaCityMap)
   //return GPSPoint(18221.1, 93546.1, -36.19, 0);
 }
 
+//lane and waypoint at an id index location, nullptr if the map changed since the index was built
+static Lane* GetIndexedLane(RoadNetwork& map, const MapIdIndex::Location& loc)
+{
+  if(loc.iSegment >= (int)map.roadSegments.size() || loc.iLane >= (int)map.roadSegments.at(loc.iSegment).Lanes.size())
+    return nullptr;
+
+  return &map.roadSegments.at(loc.iSegment).Lanes.at(loc.iLane);
+}
+
+static WayPoint* GetIndexedWaypoint(RoadNetwork& map, const MapIdIndex::Location& loc, const int& id)
+{
+  Lane* pL = GetIndexedLane(map, loc);
+  if(!pL || loc.iPoint < 0 || loc.iPoint >= (int)pL->points.size() || pL->points.at(loc.iPoint).id != id)
+    return nullptr;
+
+  return &pL->points.at(loc.iPoint);
+}
+
 Lane* MappingHelpers::GetLaneById(const int& id,RoadNetwork& map)
 {
+  if(map.idIndex.IsValid(map.roadSegments))
+  {
+    std::unordered_map<int, std::vector<MapIdIndex::Location> >::const_iterator it = map.idIndex.lanes.find(id);
+    if(it != map.idIndex.lanes.end())
+    {
+      Lane* pL = GetIndexedLane(map, it->second.at(0));
+      if(pL && pL->id == id)
+        return pL;
+    }
+  }
+
+  //not indexed, or the map changed after the index was built
   for(unsigned int rs = 0; rs < map.roadSegments.size(); rs++)
   {
     for(unsigned int i =0; i < map.roadSegments.at(rs).Lanes.size(); i++)
@@ -339,16 +377,29 @@ void MappingHelpers::ConstructRoadNetworkFromROSMessage(const std::vector<Utilit
   //Link Lanes and lane's waypoints by pointers
   //For each lane, the previous code set the fromId as the id of the last waypoint of the previos lane.
   //here we fix that by finding from each fromID the corresponding point and replace the fromId by the LaneID associated with that point.
+  //same result as GetLaneIdByWaypointId, first lane in order, without scanning all the lanes for each id
+  std::unordered_map<int, int> waypoint_lane_ids;
+  for(unsigned int l= 0; l < roadLanes.size(); l++)
+  {
+    for(unsigned int p = 0; p < roadLanes.at(l).points.size(); p++)
+    {
+      if(waypoint_lane_ids.find(roadLanes.at(l).points.at(p).id) == waypoint_lane_ids.end())
+        waypoint_lane_ids[roadLanes.at(l).points.at(p).id] = roadLanes.at(l).points.at(p).laneId;
+    }
+  }
+
   for(unsigned int l= 0; l < roadLanes.size(); l++)
   {
     for(unsigned int fp = 0; fp< roadLanes.at(l).fromIds.size(); fp++)
     {
-      roadLanes.at(l).fromIds.at(fp) = GetLaneIdByWaypointId(roadLanes.at(l).fromIds.at(fp), roadLanes);
+      std::unordered_map<int, int>::const_iterator it = waypoint_lane_ids.find(roadLanes.at(l).fromIds.at(fp));
+      roadLanes.at(l).fromIds.at(fp) = it != waypoint_lane_ids.end() ? it->second : 0;
     }
 
     for(unsigned int tp = 0; tp< roadLanes.at(l).toIds.size(); tp++)
     {
-      roadLanes.at(l).toIds.at(tp) = GetLaneIdByWaypointId(roadLanes.at(l).toIds.at(tp), roadLanes);
+      std::unordered_map<int, int>::const_iterator it = waypoint_lane_ids.find(roadLanes.at(l).toIds.at(tp));
+      roadLanes.at(l).toIds.at(tp) = it != waypoint_lane_ids.end() ? it->second : 0;
     }
 
     double sum_a = 0;
@@ -366,40 +417,7 @@ void MappingHelpers::ConstructRoadNetworkFromROSMessage(const std::vector<Utilit
   map.roadSegments.push_back(roadSegment1);
 
   //Link Lanes and lane's waypoints by pointers
-  for(unsigned int rs = 0; rs < map.roadSegments.size(); rs++)
-  {
-    //Link Lanes
-    for(unsigned int i =0; i < map.roadSegments.at(rs).Lanes.size(); i++)
-    {
-      Lane* pL = &map.roadSegments.at(rs).Lanes.at(i);
-      for(unsigned int j = 0 ; j < pL->fromIds.size(); j++)
-      {
-        for(unsigned int l= 0; l < map.roadSegments.at(rs).Lanes.size(); l++)
-        {
-          if(map.roadSegments.at(rs).Lanes.at(l).id == pL->fromIds.at(j))
-          {
-            pL->fromLanes.push_back(&map.roadSegments.at(rs).Lanes.at(l));
-          }
-        }
-      }
-
-      for(unsigned int j = 0 ; j < pL->toIds.size(); j++)
-      {
-        for(unsigned int l= 0; l < map.roadSegments.at(rs).Lanes.size(); l++)
-        {
-          if(map.roadSegments.at(rs).Lanes.at(l).id == pL->toIds.at(j))
-          {
-            pL->toLanes.push_back(&map.roadSegments.at(rs).Lanes.at(l));
-          }
-        }
-      }
-
-      for(unsigned int j = 0 ; j < pL->points.size(); j++)
-      {
-        pL->points.at(j).pLane  = pL;
-      }
-    }
-  }
+  LinkLanesPointers(map);
 
   for(unsigned int rs = 0; rs < map.roadSegments.size(); rs++)
   {
@@ -467,6 +485,9 @@ void MappingHelpers::ConstructRoadNetworkFromROSMessage(const std::vector<Utilit
     }
   }
 
+  map.spatialIndex.Build(map.roadSegments);
+  UpdateMapVersion(map);
+
   cout << "Map loaded from data with " << roadLanes.size()  << " lanes" << endl;
 }
 
@@ -481,6 +502,17 @@ void MappingHelpers::AssignActionCostToLane(Lane* pL, ACTION_TYPE action, double
 
 WayPoint* MappingHelpers::FindWaypoint(const int& id, RoadNetwork& map)
 {
+  if(map.idIndex.IsValid(map.roadSegments))
+  {
+    std::unordered_map<int, std::vector<MapIdIndex::Location> >::const_iterator it = map.idIndex.waypoints.find(id);
+    if(it != map.idIndex.waypoints.end())
+    {
+      WayPoint* pWP = GetIndexedWaypoint(map, it->second.at(0), id);
+      if(pWP)
+        return pWP;
+    }
+  }
+
   for(unsigned int rs = 0; rs < map.roadSegments.size(); rs++)
   {
     for(unsigned int i =0; i < map.roadSegments.at(rs).Lanes.size(); i++)
@@ -498,6 +530,21 @@ WayPoint* MappingHelpers::FindWaypoint(const int& id, RoadNetwork& map)
 
 WayPoint* MappingHelpers::FindWaypointV2(const int& id, const int& l_id, RoadNetwork& map)
 {
+  if(map.idIndex.IsValid(map.roadSegments))
+  {
+    std::unordered_map<int, std::vector<MapIdIndex::Location> >::const_iterator it = map.idIndex.waypoints.find(id);
+    if(it != map.idIndex.waypoints.end())
+    {
+      for(unsigned int i = 0; i < it->second.size(); i++)
+      {
+        WayPoint* pWP = GetIndexedWaypoint(map, it->second.at(i), id);
+        if(!pWP) break;
+        if(map.roadSegments.at(it->second.at(i).iSegment).Lanes.at(it->second.at(i).iLane).id != l_id)
+          return pWP;
+      }
+    }
+  }
+
   for(unsigned int rs = 0; rs < map.roadSegments.size(); rs++)
   {
     for(unsigned int i =0; i < map.roadSegments.at(rs).Lanes.size(); i++)
@@ -517,7 +564,7 @@ WayPoint* MappingHelpers::FindWaypointV2(const int& id, const int& l_id, RoadNet
   return nullptr;
 }
 
-void MappingHelpers::ConstructRoadNetworkFromDataFiles(const std::string vectoMapPath, RoadNetwork& map, const bool& bZeroOrigin)
+void MappingHelpers::ConstructRoadNetworkFromDataFiles(const std::string vectoMapPath, RoadNetwork& map, const bool& bZeroOrigin, const bool& bUseSnapshot)
 {
   /**
    * Exporting the center lines
@@ -537,6 +584,24 @@ void MappingHelpers::ConstructRoadNetworkFromDataFiles(const std::string vectoMa
   string crosswalk_info = vectoMapPath + "crosswalk.csv";
   string conn_info = vectoMapPath + "dataconnection.csv";
   string intersection_info = vectoMapPath + "intersection.csv";
+  string snapshot_file = vectoMapPath + "op_planner_map.snapshot";
+
+  //the snapshot is used only while every data file has the size and modification time it was built from
+  std::vector<std::string> data_files = {laneLinesDetails, center_lines_info, lane_info, node_info, area_info, line_info,
+      signal_info, stop_line_info, vector_info, curb_info, roadedge_info, wayarea_info, crosswalk_info, conn_info, intersection_info};
+  unsigned long long data_signature = RoadNetworkSnapshot::GetFilesSignature(data_files);
+  if(bUseSnapshot)
+  {
+    struct timespec load_timer;
+    UtilityH::GetTickCount(load_timer);
+    if(RoadNetworkSnapshot::LoadFromFile(snapshot_file, data_signature, map))
+    {
+      GetMapMaxIds(map);
+      cout << " >> Map loaded from snapshot (" << snapshot_file << ") in " << UtilityH::GetTimeDiffNow(load_timer) << " s" << endl;
+      return;
+    }
+    cout << " >> No valid map snapshot (" << snapshot_file << "), building the map from the data files ... " << endl;
+  }
 
   cout << " >> Loading vector map data files ... " << endl;
   AisanCenterLinesFileReader  center_lanes(center_lines_info);
@@ -614,6 +679,14 @@ void MappingHelpers::ConstructRoadNetworkFromDataFiles(const std::string vectoMa
 
   WayPoint origin = GetFirstWaypoint(map);
   cout << origin.pos.ToString() ;
+
+  if(bUseSnapshot && map.roadSegments.size() > 0)
+  {
+    if(RoadNetworkSnapshot::SaveToFile(snapshot_file, map, data_signature))
+      cout << " >> Map snapshot saved to (" << snapshot_file << ")" << endl;
+    else
+      cout << " >> Can't save map snapshot to (" << snapshot_file << ")" << endl;
+  }
 }
 
 bool MappingHelpers::GetWayPoint(const int& id, const int& laneID,const double& refVel, const int& did,
@@ -738,6 +811,43 @@ void MappingHelpers::LoadKML(const std::string& kmlFile, RoadNetwork& map)
   map.curbs.clear();
   map.curbs = curbs;
 
+  map.stopLines = stopLines;
+  map.trafficLights = trafficLights;
+
+  LinkKMLMap(map, laneLinksList);
+}
+
+void MappingHelpers::LoadKMLStreaming(const std::string& kmlFile, RoadNetwork& map)
+{
+  std::cout << " >> Reading KML Map file ... " << std::endl;
+
+  KmlMapReader reader;
+  if(!reader.ReadFile(kmlFile, m_USING_VER_ZERO == 1))
+  {
+    cout << "Can't Open KML Map File: (" << kmlFile << ")" << endl;
+    return;
+  }
+
+  map.roadSegments.clear();
+  map.roadSegments.swap(reader.roadSegments);
+  map.signs.clear();
+  map.signs.swap(reader.signs);
+  map.crossings.clear();
+  map.crossings.swap(reader.crossings);
+  map.markings.clear();
+  map.markings.swap(reader.markings);
+  map.boundaries.clear();
+  map.boundaries.swap(reader.boundaries);
+  map.curbs.clear();
+  map.curbs.swap(reader.curbs);
+  map.stopLines.swap(reader.stopLines);
+  map.trafficLights.swap(reader.trafficLights);
+
+  LinkKMLMap(map, reader.lanes);
+}
+
+void MappingHelpers::LinkKMLMap(RoadNetwork& map, std::vector<Lane>& laneLinksList)
+{
   //Fill the relations
   for(unsigned int i= 0; i<map.roadSegments.size(); i++ )
   {
@@ -750,40 +860,7 @@ void MappingHelpers::LoadKML(const std::string& kmlFile, RoadNetwork& map)
 
   cout << " >> Link lanes and waypoints with pointers ... " << endl;
   //Link Lanes and lane's waypoints by pointers
-  for(unsigned int rs = 0; rs < map.roadSegments.size(); rs++)
-  {
-    //Link Lanes
-    for(unsigned int i =0; i < map.roadSegments.at(rs).Lanes.size(); i++)
-    {
-      Lane* pL = &map.roadSegments.at(rs).Lanes.at(i);
-      for(unsigned int j = 0 ; j < pL->fromIds.size(); j++)
-      {
-        for(unsigned int l= 0; l < map.roadSegments.at(rs).Lanes.size(); l++)
-        {
-          if(map.roadSegments.at(rs).Lanes.at(l).id == pL->fromIds.at(j))
-          {
-            pL->fromLanes.push_back(&map.roadSegments.at(rs).Lanes.at(l));
-          }
-        }
-      }
-
-      for(unsigned int j = 0 ; j < pL->toIds.size(); j++)
-      {
-        for(unsigned int l= 0; l < map.roadSegments.at(rs).Lanes.size(); l++)
-        {
-          if(map.roadSegments.at(rs).Lanes.at(l).id == pL->toIds.at(j))
-          {
-            pL->toLanes.push_back(&map.roadSegments.at(rs).Lanes.at(l));
-          }
-        }
-      }
-
-      for(unsigned int j = 0 ; j < pL->points.size(); j++)
-      {
-        pL->points.at(j).pLane  = pL;
-      }
-    }
-  }
+  LinkLanesPointers(map);
 
   //Link waypoints
   cout << " >> Link missing branches and waypoints... " << endl;
@@ -836,9 +913,6 @@ void MappingHelpers::LoadKML(const std::string& kmlFile, RoadNetwork& map)
     }
   }
 
-  map.stopLines = stopLines;
-  map.trafficLights = trafficLights;
-
   //Link waypoints && StopLines
   cout << " >> Link Stop lines and Traffic lights ... " << endl;
   for(unsigned int rs = 0; rs < map.roadSegments.size(); rs++)
@@ -870,6 +944,10 @@ void MappingHelpers::LoadKML(const std::string& kmlFile, RoadNetwork& map)
   cout << " >> Find Max IDs ... " << endl;
   GetMapMaxIds(map);
 
+  cout << " >> Build map spatial index ... " << endl;
+  map.spatialIndex.Build(map.roadSegments);
+  UpdateMapVersion(map);
+
   cout << "Map loaded from kml file with (" << laneLinksList.size()  << ") lanes, First Point ( " << GetFirstWaypoint(map).pos.ToString() << ")"<< endl;
 
 }
@@ -909,13 +987,15 @@ TiXmlElement* MappingHelpers::GetDataFolder(const string& folderName, TiXmlEleme
   return nullptr;
 }
 
-WayPoint* MappingHelpers::GetClosestWaypointFromMap(const WayPoint& pos, RoadNetwork& map, const bool bDirectionBased)
+//the waypoints get the constness of the map, like the lanes of ClosestLaneFromMap
+template <class MAP>
+static auto ClosestWaypointFromMap(const WayPoint& pos, MAP& map, const bool bDirectionBased) -> decltype(&map.roadSegments.at(0).Lanes.at(0).points.at(0))
 {
   double distance_to_nearest_lane = 1;
-  Lane* pLane = 0;
+  decltype(&map.roadSegments.at(0).Lanes.at(0)) pLane = 0;
   while(distance_to_nearest_lane < 100 && pLane == 0)
   {
-    pLane = GetClosestLaneFromMap(pos, map, distance_to_nearest_lane, bDirectionBased);
+    pLane = MappingHelpers::GetClosestLaneFromMap(pos, map, distance_to_nearest_lane, bDirectionBased);
     distance_to_nearest_lane += 1;
   }
 
@@ -926,11 +1006,22 @@ WayPoint* MappingHelpers::GetClosestWaypointFromMap(const WayPoint& pos, RoadNet
   return &pLane->points.at(closest_index);
 }
 
-vector<WayPoint*> MappingHelpers::GetClosestWaypointsListFromMap(const WayPoint& pos, RoadNetwork& map, const double& distance, const bool bDirectionBased)
+WayPoint* MappingHelpers::GetClosestWaypointFromMap(const WayPoint& pos, RoadNetwork& map, const bool bDirectionBased)
 {
-  vector<Lane*> pLanes = GetClosestLanesListFromMap(pos, map, distance, bDirectionBased);
+  return ClosestWaypointFromMap(pos, map, bDirectionBased);
+}
 
-  vector<WayPoint*> waypoints_list;
+const WayPoint* MappingHelpers::GetClosestWaypointFromMap(const WayPoint& pos, const RoadNetwork& map, const bool bDirectionBased)
+{
+  return ClosestWaypointFromMap(pos, map, bDirectionBased);
+}
+
+template <class MAP>
+static auto ClosestWaypointsListFromMap(const WayPoint& pos, MAP& map, const double& distance, const bool bDirectionBased) -> std::vector<decltype(&map.roadSegments.at(0).Lanes.at(0).points.at(0))>
+{
+  auto pLanes = MappingHelpers::GetClosestLanesListFromMap(pos, map, distance, bDirectionBased);
+
+  std::vector<decltype(&map.roadSegments.at(0).Lanes.at(0).points.at(0))> waypoints_list;
 
   if(pLanes.size() == 0) return waypoints_list;
 
@@ -946,6 +1037,16 @@ vector<WayPoint*> MappingHelpers::GetClosestWaypointsListFromMap(const WayPoint&
   return waypoints_list;
 }
 
+vector<WayPoint*> MappingHelpers::GetClosestWaypointsListFromMap(const WayPoint& pos, RoadNetwork& map, const double& distance, const bool bDirectionBased)
+{
+  return ClosestWaypointsListFromMap(pos, map, distance, bDirectionBased);
+}
+
+vector<const WayPoint*> MappingHelpers::GetClosestWaypointsListFromMap(const WayPoint& pos, const RoadNetwork& map, const double& distance, const bool bDirectionBased)
+{
+  return ClosestWaypointsListFromMap(pos, map, distance, bDirectionBased);
+}
+
 WayPoint* MappingHelpers::GetClosestBackWaypointFromMap(const WayPoint& pos, RoadNetwork& map)
 {
   double distance_to_nearest_lane = 1;
@@ -973,6 +1074,27 @@ WayPoint* MappingHelpers::GetClosestBackWaypointFromMap(const WayPoint& pos, Roa
 std::vector<Lane*> MappingHelpers::GetClosestLanesFast(const WayPoint& center, RoadNetwork& map, const double& distance)
 {
   vector<Lane*> lanesList;
+
+  if(map.spatialIndex.IsBuilt())
+  {
+    //a lane without any point inside the distance can't have its closest next point inside it either
+    vector<NearLaneInfo> near_lanes;
+    GetNearLanesFromMap(center, map, distance + 1e-6, near_lanes);
+    for(unsigned int i = 0; i < near_lanes.size(); i++)
+    {
+      Lane* pL = near_lanes.at(i).pLane;
+      int index = PlanningHelpers::GetClosestNextPointIndexFast(pL->points, center);
+
+      if(index < 0 || index >= pL->points.size()) continue;
+
+      double d = hypot(pL->points.at(index).pos.y - center.pos.y, pL->points.at(index).pos.x - center.pos.x);
+      if(d <= distance)
+        lanesList.push_back(pL);
+    }
+
+    return lanesList;
+  }
+
   for(unsigned int j=0; j< map.roadSegments.size(); j ++)
   {
     for(unsigned int k=0; k< map.roadSegments.at(j).Lanes.size(); k ++)
@@ -991,155 +1113,190 @@ std::vector<Lane*> MappingHelpers::GetClosestLanesFast(const WayPoint& center, R
   return lanesList;
 }
 
-Lane* MappingHelpers::GetClosestLaneFromMap(const WayPoint& pos, RoadNetwork& map, const double& distance, const bool bDirectionBased)
+//one search for the const and the non const maps, the lanes get the constness of the map
+template <class MAP, class INFO>
+static void NearLanesFromMap(const WayPoint& pos, MAP& map, const double& distance, std::vector<INFO>& lanes_list)
 {
-  vector<pair<double, Lane*> > laneLinksList;
+  lanes_list.clear();
   double d = 0;
-  double min_d = DBL_MAX;
+
+  if(map.spatialIndex.IsBuilt())
+  {
+    std::vector<const MapSpatialIndex::Entry*> candidates;
+    map.spatialIndex.GetCandidates(pos.pos, distance, candidates);
+
+    //ordered by (segment, lane) to keep the same lanes order as the linear scan
+    std::map<std::pair<int, int>, INFO> near_lanes;
+    for(unsigned int i = 0; i < candidates.size(); i++)
+    {
+      const MapSpatialIndex::Entry* pE = candidates.at(i);
+      d = distance2points((*pE), pos.pos);
+      if(d >= distance) continue;
+
+      std::pair<int, int> key = make_pair(pE->iSegment, pE->iLane);
+      typename std::map<std::pair<int, int>, INFO>::iterator it = near_lanes.find(key);
+      if(it == near_lanes.end())
+      {
+        INFO info;
+        info.pLane = &map.roadSegments.at(pE->iSegment).Lanes.at(pE->iLane);
+        info.min_distance = d;
+        info.min_index = pE->iPoint;
+        near_lanes[key] = info;
+      }
+      else if(d < it->second.min_distance || (d == it->second.min_distance && pE->iPoint < it->second.min_index))
+      {
+        it->second.min_distance = d;
+        it->second.min_index = pE->iPoint;
+      }
+    }
+
+    for(typename std::map<std::pair<int, int>, INFO>::iterator it = near_lanes.begin(); it != near_lanes.end(); it++)
+      lanes_list.push_back(it->second);
+
+    return;
+  }
+
   for(unsigned int j=0; j< map.roadSegments.size(); j ++)
   {
     for(unsigned int k=0; k< map.roadSegments.at(j).Lanes.size(); k ++)
     {
-      //Lane* pLane = &pEdge->lanes.at(k);
-       d = 0;
-      min_d = DBL_MAX;
-      for(unsigned int pindex=0; pindex< map.roadSegments.at(j).Lanes.at(k).points.size(); pindex ++)
+      INFO info;
+      info.pLane = &map.roadSegments.at(j).Lanes.at(k);
+      info.min_distance = DBL_MAX;
+      for(unsigned int pindex=0; pindex< info.pLane->points.size(); pindex ++)
       {
-
-        d = distance2points(map.roadSegments.at(j).Lanes.at(k).points.at(pindex).pos, pos.pos);
-        if(d < min_d)
-          min_d = d;
+        d = distance2points(info.pLane->points.at(pindex).pos, pos.pos);
+        if(d < info.min_distance)
+        {
+          info.min_distance = d;
+          info.min_index = pindex;
+        }
       }
 
-      if(min_d < distance)
-        laneLinksList.push_back(make_pair(min_d, &map.roadSegments.at(j).Lanes.at(k)));
+      if(info.min_distance < distance)
+        lanes_list.push_back(info);
     }
   }
+}
+
+template <class MAP, class INFO>
+static decltype(INFO().pLane) ClosestLaneFromMap(const WayPoint& pos, MAP& map, const double& distance, const bool bDirectionBased)
+{
+  vector<INFO> laneLinksList;
+  NearLanesFromMap(pos, map, distance, laneLinksList);
 
   if(laneLinksList.size() == 0) return nullptr;
 
-  min_d = DBL_MAX;
-  Lane* closest_lane = 0;
+  double min_d = DBL_MAX;
+  decltype(INFO().pLane) closest_lane = 0;
   for(unsigned int i = 0; i < laneLinksList.size(); i++)
   {
     RelativeInfo info;
-    PlanningHelpers::GetRelativeInfo(laneLinksList.at(i).second->points, pos, info);
+    PlanningHelpers::GetRelativeInfo(laneLinksList.at(i).pLane->points, pos, info);
 
-    if(info.perp_distance == 0 && laneLinksList.at(i).first != 0)
+    if(info.perp_distance == 0 && laneLinksList.at(i).min_distance != 0)
       continue;
 
     if(bDirectionBased && fabs(info.perp_distance) < min_d && fabs(info.angle_diff) < 45)
     {
       min_d = fabs(info.perp_distance);
-      closest_lane = laneLinksList.at(i).second;
+      closest_lane = laneLinksList.at(i).pLane;
     }
     else if(!bDirectionBased && fabs(info.perp_distance) < min_d)
     {
       min_d = fabs(info.perp_distance);
-      closest_lane = laneLinksList.at(i).second;
+      closest_lane = laneLinksList.at(i).pLane;
     }
   }
 
   return closest_lane;
 }
 
-vector<Lane*> MappingHelpers::GetClosestLanesListFromMap(const WayPoint& pos, RoadNetwork& map, const double& distance, const bool bDirectionBased)
+void MappingHelpers::GetNearLanesFromMap(const WayPoint& pos, RoadNetwork& map, const double& distance, std::vector<NearLaneInfo>& lanes_list)
 {
-  vector<pair<double, Lane*> > laneLinksList;
-  double d = 0;
-  double min_d = DBL_MAX;
-  for(unsigned int j=0; j< map.roadSegments.size(); j ++)
-  {
-    for(unsigned int k=0; k< map.roadSegments.at(j).Lanes.size(); k ++)
-    {
-      //Lane* pLane = &pEdge->lanes.at(k);
-       d = 0;
-      min_d = DBL_MAX;
-      for(unsigned int pindex=0; pindex< map.roadSegments.at(j).Lanes.at(k).points.size(); pindex ++)
-      {
+  NearLanesFromMap(pos, map, distance, lanes_list);
+}
 
-        d = distance2points(map.roadSegments.at(j).Lanes.at(k).points.at(pindex).pos, pos.pos);
-        if(d < min_d)
-          min_d = d;
-      }
+void MappingHelpers::GetNearLanesFromMap(const WayPoint& pos, const RoadNetwork& map, const double& distance, std::vector<ConstNearLaneInfo>& lanes_list)
+{
+  NearLanesFromMap(pos, map, distance, lanes_list);
+}
 
-      if(min_d < distance)
-        laneLinksList.push_back(make_pair(min_d, &map.roadSegments.at(j).Lanes.at(k)));
-    }
-  }
+Lane* MappingHelpers::GetClosestLaneFromMap(const WayPoint& pos, RoadNetwork& map, const double& distance, const bool bDirectionBased)
+{
+  return ClosestLaneFromMap<RoadNetwork, NearLaneInfo>(pos, map, distance, bDirectionBased);
+}
+
+const Lane* MappingHelpers::GetClosestLaneFromMap(const WayPoint& pos, const RoadNetwork& map, const double& distance, const bool bDirectionBased)
+{
+  return ClosestLaneFromMap<const RoadNetwork, ConstNearLaneInfo>(pos, map, distance, bDirectionBased);
+}
 
-  vector<Lane*> closest_lanes;
+template <class MAP, class INFO>
+static std::vector<decltype(INFO().pLane)> ClosestLanesListFromMap(const WayPoint& pos, MAP& map, const double& distance, const bool bDirectionBased)
+{
+  vector<INFO> laneLinksList;
+  NearLanesFromMap(pos, map, distance, laneLinksList);
+
+  vector<decltype(INFO().pLane)> closest_lanes;
   if(laneLinksList.size() == 0) return closest_lanes;
 
 
   for(unsigned int i = 0; i < laneLinksList.size(); i++)
   {
     RelativeInfo info;
-    PlanningHelpers::GetRelativeInfo(laneLinksList.at(i).second->points, pos, info);
+    PlanningHelpers::GetRelativeInfo(laneLinksList.at(i).pLane->points, pos, info);
 
-    if(info.perp_distance == 0 && laneLinksList.at(i).first != 0)
+    if(info.perp_distance == 0 && laneLinksList.at(i).min_distance != 0)
       continue;
 
     if(bDirectionBased && fabs(info.perp_distance) < distance && fabs(info.angle_diff) < 30)
     {
-      closest_lanes.push_back(laneLinksList.at(i).second);
+      closest_lanes.push_back(laneLinksList.at(i).pLane);
     }
     else if(!bDirectionBased && fabs(info.perp_distance) < distance)
     {
-      closest_lanes.push_back(laneLinksList.at(i).second);
+      closest_lanes.push_back(laneLinksList.at(i).pLane);
     }
   }
 
   return closest_lanes;
 }
 
-Lane* MappingHelpers::GetClosestLaneFromMapDirectionBased(const WayPoint& pos, RoadNetwork& map, const double& distance)
+vector<Lane*> MappingHelpers::GetClosestLanesListFromMap(const WayPoint& pos, RoadNetwork& map, const double& distance, const bool bDirectionBased)
 {
-  vector<pair<double, WayPoint*> > laneLinksList;
-  double d = 0;
-  double min_d = DBL_MAX;
-  int min_i = 0;
-  for(unsigned int j=0; j< map.roadSegments.size(); j ++)
-  {
-    for(unsigned int k=0; k< map.roadSegments.at(j).Lanes.size(); k ++)
-    {
-      //Lane* pLane = &pEdge->lanes.at(k);
-      d = 0;
-      min_d = DBL_MAX;
-      for(unsigned int pindex=0; pindex< map.roadSegments.at(j).Lanes.at(k).points.size(); pindex ++)
-      {
+  return ClosestLanesListFromMap<RoadNetwork, NearLaneInfo>(pos, map, distance, bDirectionBased);
+}
 
-        d = distance2points(map.roadSegments.at(j).Lanes.at(k).points.at(pindex).pos, pos.pos);
-        if(d < min_d)
-        {
-          min_d = d;
-          min_i = pindex;
-        }
-      }
+vector<const Lane*> MappingHelpers::GetClosestLanesListFromMap(const WayPoint& pos, const RoadNetwork& map, const double& distance, const bool bDirectionBased)
+{
+  return ClosestLanesListFromMap<const RoadNetwork, ConstNearLaneInfo>(pos, map, distance, bDirectionBased);
+}
 
-      if(min_d < distance)
-        laneLinksList.push_back(make_pair(min_d, &map.roadSegments.at(j).Lanes.at(k).points.at(min_i)));
-    }
-  }
+Lane* MappingHelpers::GetClosestLaneFromMapDirectionBased(const WayPoint& pos, RoadNetwork& map, const double& distance)
+{
+  vector<NearLaneInfo> laneLinksList;
+  GetNearLanesFromMap(pos, map, distance, laneLinksList);
 
   if(laneLinksList.size() == 0) return nullptr;
 
-  min_d = DBL_MAX;
+  double min_d = DBL_MAX;
   Lane* closest_lane = 0;
   double a_diff = 0;
   for(unsigned int i = 0; i < laneLinksList.size(); i++)
   {
+    WayPoint* pWP = &laneLinksList.at(i).pLane->points.at(laneLinksList.at(i).min_index);
     RelativeInfo info;
-    PlanningHelpers::GetRelativeInfo(laneLinksList.at(i).second->pLane->points, pos, info);
-    if(info.perp_distance == 0 && laneLinksList.at(i).first != 0)
+    PlanningHelpers::GetRelativeInfo(pWP->pLane->points, pos, info);
+    if(info.perp_distance == 0 && laneLinksList.at(i).min_distance != 0)
       continue;
 
-    a_diff = UtilityH::AngleBetweenTwoAnglesPositive(laneLinksList.at(i).second->pos.a, pos.pos.a);
+    a_diff = UtilityH::AngleBetweenTwoAnglesPositive(pWP->pos.a, pos.pos.a);
 
     if(fabs(info.perp_distance)<min_d && a_diff <= M_PI_4)
     {
       min_d = fabs(info.perp_distance);
-      closest_lane = laneLinksList.at(i).second->pLane;
+      closest_lane = pWP->pLane;
     }
   }
 
@@ -1152,6 +1309,43 @@ Lane* MappingHelpers::GetClosestLaneFromMapDirectionBased(const WayPoint& pos, R
   vector<Lane*> lanesList;
   double d = 0;
   double a_diff = 0;
+
+  if(map.spatialIndex.IsBuilt())
+  {
+    std::vector<const MapSpatialIndex::Entry*> candidates;
+    map.spatialIndex.GetCandidates(pos.pos, distance, candidates);
+
+    std::map<std::pair<int, int>, bool> near_lanes;
+    for(unsigned int i = 0; i < candidates.size(); i++)
+    {
+      const MapSpatialIndex::Entry* pE = candidates.at(i);
+      Lane* pL = &map.roadSegments.at(pE->iSegment).Lanes.at(pE->iLane);
+      d = distance2points((*pE), pos.pos);
+      a_diff = UtilityH::AngleBetweenTwoAnglesPositive(pL->points.at(pE->iPoint).pos.a, pos.pos.a);
+      if(d <= distance && a_diff <= M_PI_4)
+        near_lanes[make_pair(pE->iSegment, pE->iLane)] = true;
+    }
+
+    for(std::map<std::pair<int, int>, bool>::iterator it = near_lanes.begin(); it != near_lanes.end(); it++)
+    {
+      Lane* pL = &map.roadSegments.at(it->first.first).Lanes.at(it->first.second);
+      bool bLaneExist = false;
+      for(unsigned int il = 0; il < lanesList.size(); il++)
+      {
+        if(lanesList.at(il)->id == pL->id)
+        {
+          bLaneExist = true;
+          break;
+        }
+      }
+
+      if(!bLaneExist)
+        lanesList.push_back(pL);
+    }
+
+    return lanesList;
+  }
+
   for(unsigned int j=0; j< map.roadSegments.size(); j ++)
   {
     for(unsigned int k=0; k< map.roadSegments.at(j).Lanes.size(); k ++)
@@ -2126,6 +2320,13 @@ void MappingHelpers::LinkMissingBranchingWayPointsV2(RoadNetwork& map)
 
 void MappingHelpers::LinkTrafficLightsAndStopLines(RoadNetwork& map)
 {
+  //first stop line of each link id, a waypoint is linked to one stop line only
+  std::unordered_map<int, int> stop_line_links;
+  for(unsigned int isl = 0; isl < map.stopLines.size(); isl++)
+  {
+    if(stop_line_links.find(map.stopLines.at(isl).linkID) == stop_line_links.end())
+      stop_line_links[map.stopLines.at(isl).linkID] = isl;
+  }
 
   for(unsigned int rs = 0; rs < map.roadSegments.size(); rs++)
   {
@@ -2133,48 +2334,43 @@ void MappingHelpers::LinkTrafficLightsAndStopLines(RoadNetwork& map)
     {
       for(unsigned int p= 0; p < map.roadSegments.at(rs).Lanes.at(i).points.size(); p++)
       {
-        for(unsigned int isl = 0; isl < map.stopLines.size(); isl++)
-        {
-          WayPoint* pWP = &map.roadSegments.at(rs).Lanes.at(i).points.at(p);
+        WayPoint* pWP = &map.roadSegments.at(rs).Lanes.at(i).points.at(p);
+        std::unordered_map<int, int>::const_iterator it = stop_line_links.find(pWP->id);
+        if(it == stop_line_links.end()) continue;
 
-          if(map.stopLines.at(isl).linkID == pWP->id)
-          {
-            map.stopLines.at(isl).laneId = pWP->laneId;
-            map.stopLines.at(isl).pLane = pWP->pLane;
-            map.roadSegments.at(rs).Lanes.at(i).stopLines.push_back(map.stopLines.at(isl));
+        int isl = it->second;
+        map.stopLines.at(isl).laneId = pWP->laneId;
+        map.stopLines.at(isl).pLane = pWP->pLane;
+        map.roadSegments.at(rs).Lanes.at(i).stopLines.push_back(map.stopLines.at(isl));
 
-            pWP->stopLineID = map.stopLines.at(isl).id;
+        pWP->stopLineID = map.stopLines.at(isl).id;
 
-            for(unsigned int itl = 0; itl < map.trafficLights.size(); itl++)
-            {
-              if(map.trafficLights.at(itl).id == map.stopLines.at(isl).trafficLightID)
-              {
-                map.trafficLights.at(itl).laneIds.push_back(pWP->laneId);
-                map.trafficLights.at(itl).pLanes.push_back(pWP->pLane);
-              }
-            }
-            break;
+        for(unsigned int itl = 0; itl < map.trafficLights.size(); itl++)
+        {
+          if(map.trafficLights.at(itl).id == map.stopLines.at(isl).trafficLightID)
+          {
+            map.trafficLights.at(itl).laneIds.push_back(pWP->laneId);
+            map.trafficLights.at(itl).pLanes.push_back(pWP->pLane);
           }
         }
       }
     }
   }
 
+  //each lane gets the traffic lights linked to one of its waypoints, in traffic light order
   for(unsigned int rs = 0; rs < map.roadSegments.size(); rs++)
   {
     for(unsigned int i =0; i < map.roadSegments.at(rs).Lanes.size(); i++)
     {
+      Lane* pL = &map.roadSegments.at(rs).Lanes.at(i);
+      std::unordered_set<int> point_ids;
+      for(unsigned int p= 0; p < pL->points.size(); p++)
+        point_ids.insert(pL->points.at(p).id);
+
       for(unsigned int itl = 0; itl < map.trafficLights.size(); itl++)
       {
-        for(unsigned int p= 0; p < map.roadSegments.at(rs).Lanes.at(i).points.size(); p++)
-        {
-          WayPoint* pWP = &map.roadSegments.at(rs).Lanes.at(i).points.at(p);
-          if(map.trafficLights.at(itl).linkID == pWP->id)
-          {
-            map.roadSegments.at(rs).Lanes.at(i).trafficlights.push_back(map.trafficLights.at(itl));
-            break;
-          }
-        }
+        if(point_ids.find(map.trafficLights.at(itl).linkID) != point_ids.end())
+          pL->trafficlights.push_back(map.trafficLights.at(itl));
       }
     }
   }
@@ -2225,6 +2421,32 @@ void MappingHelpers::LinkTrafficLightsAndStopLinesConData(const std::vector<Util
   }
 }
 
+//value of the grid cell under the waypoint, false when the waypoint and its neighbor cells are out of the grid
+static bool GetWayPointCellValue(OccupancyToGridMap& map_info, const std::vector<int>& data, Mat3& rotationMat, Mat3& translationMat,
+    const WayPoint& wp, int& cell_value)
+{
+  GPSPoint relative_point = wp.pos;
+  relative_point = translationMat * relative_point;
+  relative_point = rotationMat *relative_point;
+  return map_info.GetCellIndexFromPoint(relative_point, data, cell_value);
+}
+
+static void BlockWayPointForwardAction(WayPoint* pWP)
+{
+  bool bFound = false;
+  for(unsigned int i_action=0; i_action < pWP->actionCost.size(); i_action++)
+  {
+    if(pWP->actionCost.at(i_action).first == FORWARD_ACTION)
+    {
+      pWP->actionCost.at(i_action).second = 100;
+      bFound = true;
+    }
+  }
+
+  if(!bFound)
+    pWP->actionCost.push_back(make_pair(FORWARD_ACTION, 100));
+}
+
 void MappingHelpers::UpdateMapWithOccupancyGrid(OccupancyToGridMap& map_info, const std::vector<int>& data, RoadNetwork& map, std::vector<WayPoint*>& updated_list)
 {
   PlannerHNS::Mat3 rotationMat(- map_info.center.pos.a);
@@ -2239,34 +2461,92 @@ void MappingHelpers::UpdateMapWithOccupancyGrid(OccupancyToGridMap& map_info, co
       {
         WayPoint* pWP = &map.roadSegments.at(rs).Lanes.at(i).points.at(p);
 
-        GPSPoint relative_point = pWP->pos;
-        relative_point = translationMat * relative_point;
-        relative_point = rotationMat *relative_point;
-
         int cell_value = 0;
-        if(map_info.GetCellIndexFromPoint(relative_point, data, cell_value) == true)
+        if(GetWayPointCellValue(map_info, data, rotationMat, translationMat, *pWP, cell_value) == true)
         {
           if(cell_value == 0)
           {
-            bool bFound = false;
-            for(unsigned int i_action=0; i_action < pWP->actionCost.size(); i_action++)
-            {
-              if(pWP->actionCost.at(i_action).first == FORWARD_ACTION)
-              {
-                pWP->actionCost.at(i_action).second = 100;
-                bFound = true;
-              }
-            }
-
-            if(!bFound)
-              pWP->actionCost.push_back(make_pair(FORWARD_ACTION, 100));
-
+            BlockWayPointForwardAction(pWP);
             updated_list.push_back(pWP);
           }
         }
       }
     }
   }
+
+  if(updated_list.size() > 0)
+    UpdateMapVersion(map);
+}
+
+void MappingHelpers::UpdateMapWithOccupancyGrid(OccupancyToGridMap& map_info, const std::vector<int>& data, RoadNetwork& map,
+    std::vector<WayPoint*>& updated_list, OccupancyGridHistory& history)
+{
+  OccupancyToGridMap& old_info = history.grid_info;
+  bool bSameGrid = history.pMap == &map && history.mapVersion == map.version && history.data.size() == data.size()
+      && old_info.width == map_info.width && old_info.length == map_info.length && old_info.res == map_info.res
+      && old_info.center.pos.x == map_info.center.pos.x && old_info.center.pos.y == map_info.center.pos.y
+      && old_info.center.pos.a == map_info.center.pos.a;
+
+  if(!bSameGrid || !map.spatialIndex.IsBuilt() || map_info.res <= 0)
+  {
+    UpdateMapWithOccupancyGrid(map_info, data, map, updated_list);
+  }
+  else
+  {
+    updated_list.clear();
+    PlannerHNS::Mat3 rotationMat(- map_info.center.pos.a);
+    PlannerHNS::Mat3 translationMat(-map_info.center.pos.x, -map_info.center.pos.y);
+    PlannerHNS::Mat3 invRotationMat(map_info.center.pos.a);
+    PlannerHNS::Mat3 invTranslationMat(map_info.center.pos.x, map_info.center.pos.y);
+
+    //a waypoint reads its own cell or, out of the grid, one of the 8 around it, so a changed cell affects the waypoints in the 3x3 cells around it
+    double search_radius = 1.5 * map_info.res * M_SQRT2 + 0.01;
+    std::unordered_set<const MapSpatialIndex::Entry*> checked_entries;
+    std::vector<const MapSpatialIndex::Entry*> candidates;
+    for(unsigned int index = 0; index < data.size(); index++)
+    {
+      if(data.at(index) == history.data.at(index)) continue;
+
+      int row = index / map_info.width;
+      int col = index % map_info.width;
+      GPSPoint cell_center((col + 0.5) * map_info.res, (row + 0.5) * map_info.res, 0, 0);
+      cell_center = invRotationMat * cell_center;
+      cell_center = invTranslationMat * cell_center;
+
+      map.spatialIndex.GetCandidates(cell_center, search_radius, candidates);
+      for(unsigned int ic = 0; ic < candidates.size(); ic++)
+      {
+        const MapSpatialIndex::Entry* pE = candidates.at(ic);
+        if(!checked_entries.insert(pE).second) continue;
+
+        WayPoint* pWP = &map.roadSegments.at(pE->iSegment).Lanes.at(pE->iLane).points.at(pE->iPoint);
+        int cell_value = 0, old_cell_value = 0;
+        if(!GetWayPointCellValue(map_info, data, rotationMat, translationMat, *pWP, cell_value) || cell_value != 0)
+          continue;
+
+        //blocked by the previous grid too, its cost is already patched
+        if(GetWayPointCellValue(old_info, history.data, rotationMat, translationMat, *pWP, old_cell_value) && old_cell_value == 0)
+          continue;
+
+        BlockWayPointForwardAction(pWP);
+        updated_list.push_back(pWP);
+      }
+    }
+
+    if(updated_list.size() > 0)
+      UpdateMapVersion(map);
+  }
+
+  history.grid_info = map_info;
+  history.data = data;
+  history.pMap = &map;
+  history.mapVersion = map.version;
+}
+
+void MappingHelpers::UpdateMapVersion(RoadNetwork& map)
+{
+  static std::atomic<unsigned long> last_map_version(0);
+  map.version = ++last_map_version;
 }
 
 void MappingHelpers::ConstructRoadNetworkFromROSMessageV2(const std::vector<UtilityHNS::AisanLanesFileReader::AisanLane>& lanes_data,
@@ -2292,6 +2572,39 @@ void MappingHelpers::ConstructRoadNetworkFromROSMessageV2(const std::vector<Util
     const bool& bFindLaneChangeLanes, const bool& bFindCurbsAndWayArea)
 {
   vector<Lane> roadLanes;
+  struct timespec total_timer, stage_timer;
+  UtilityH::GetTickCount(total_timer);
+
+  //Signals, stop lines and wayarea only read the vector map data, they are extracted while the lanes are built
+  cout << " >> Extract Signal, Stop lines and wayarea data in the background ... " << endl;
+  RoadNetwork signals_map, stop_lines_map, way_area_map;
+  std::future<double> signals_task = std::async(std::launch::async, [&]()
+  {
+    struct timespec t;
+    UtilityH::GetTickCount(t);
+    ExtractSignalDataV2(signal_data, vector_data, pPointsData, origin, signals_map);
+    return UtilityH::GetTimeDiffNow(t);
+  });
+
+  std::future<double> stop_lines_task = std::async(std::launch::async, [&]()
+  {
+    struct timespec t;
+    UtilityH::GetTickCount(t);
+    ExtractStopLinesDataV2(stop_line_data, pLinedata, pPointsData, origin, stop_lines_map);
+    return UtilityH::GetTimeDiffNow(t);
+  });
+
+  std::future<double> way_area_task;
+  if(bFindCurbsAndWayArea)
+  {
+    way_area_task = std::async(std::launch::async, [&]()
+    {
+      struct timespec t;
+      UtilityH::GetTickCount(t);
+      ExtractWayArea(area_data, wayarea_data, line_data, points_data, origin, way_area_map);
+      return UtilityH::GetTimeDiffNow(t);
+    });
+  }
 
   for(unsigned int i=0; i< pLaneData->m_data_list.size(); i++)
   {
@@ -2300,9 +2613,12 @@ void MappingHelpers::ConstructRoadNetworkFromROSMessageV2(const std::vector<Util
   }
 
   cout << " >> Extracting Lanes ... " << endl;
+  UtilityH::GetTickCount(stage_timer);
   CreateLanes(pLaneData, pPointsData, pNodesData, roadLanes);
+  cout << " >> Extracting Lanes took " << UtilityH::GetTimeDiffNow(stage_timer) << " s" << endl;
 
   cout << " >> Fix Waypoints errors ... " << endl;
+  UtilityH::GetTickCount(stage_timer);
   FixTwoPointsLanes(roadLanes);
   FixRedundantPointsLanes(roadLanes);
 
@@ -2311,6 +2627,7 @@ void MappingHelpers::ConstructRoadNetworkFromROSMessageV2(const std::vector<Util
   cout << " >> Create Missing lane connections ... " << endl;
   FixUnconnectedLanes(roadLanes);
   ////FixTwoPointsLanes(roadLanes);
+  cout << " >> Fix and connect lanes took " << UtilityH::GetTimeDiffNow(stage_timer) << " s" << endl;
 
   //map has one road segment
   RoadSegment roadSegment1;
@@ -2330,6 +2647,7 @@ void MappingHelpers::ConstructRoadNetworkFromROSMessageV2(const std::vector<Util
 
   //Link Lanes and lane's waypoints by pointers
   cout << " >> Link lanes and waypoints with pointers ... " << endl;
+  UtilityH::GetTickCount(stage_timer);
   LinkLanesPointers(map);
 
   for(unsigned int rs = 0; rs < map.roadSegments.size(); rs++)
@@ -2356,42 +2674,100 @@ void MappingHelpers::ConstructRoadNetworkFromROSMessageV2(const std::vector<Util
       }
     }
   }
+  cout << " >> Link lanes took " << UtilityH::GetTimeDiffNow(stage_timer) << " s" << endl;
+
+  //waypoints positions don't change after this point, the index speeds up the closest lane search of the curbs
+  cout << " >> Build map spatial index ... " << endl;
+  map.spatialIndex.Build(map.roadSegments);
 
   if(bFindLaneChangeLanes)
   {
     cout << " >> Extract Lane Change Information... " << endl;
+    UtilityH::GetTickCount(stage_timer);
     FindAdjacentLanesV2(map);
+    cout << " >> Extract Lane Change Information took " << UtilityH::GetTimeDiffNow(stage_timer) << " s" << endl;
   }
 
-  //Extract Signals and StopLines
-  cout << " >> Extract Signal data ... " << endl;
-  ExtractSignalDataV2(signal_data, vector_data, pPointsData, origin, map);
-
-  //Stop Lines
-  cout << " >> Extract Stop lines data ... " << endl;
-  ExtractStopLinesDataV2(stop_line_data, pLinedata, pPointsData, origin, map);
-
   if(bFindCurbsAndWayArea)
   {
     //Curbs
     cout << " >> Extract curbs data ... " << endl;
+    UtilityH::GetTickCount(stage_timer);
     ExtractCurbDataV2(curb_data, pLinedata, pPointsData, origin, map);
-
-    //Wayarea
-    cout << " >> Extract wayarea data ... " << endl;
-    ExtractWayArea(area_data, wayarea_data, line_data, points_data, origin, map);
+    cout << " >> Extract curbs data took " << UtilityH::GetTimeDiffNow(stage_timer) << " s" << endl;
   }
 
   //Link waypoints
   cout << " >> Link missing branches and waypoints... " << endl;
   LinkMissingBranchingWayPointsV2(map);
 
+  //Extract Signals and StopLines
+  UtilityH::GetTickCount(stage_timer);
+  double signals_time = signals_task.get();
+  double stop_lines_time = stop_lines_task.get();
+  map.trafficLights.insert(map.trafficLights.end(), signals_map.trafficLights.begin(), signals_map.trafficLights.end());
+  map.stopLines.insert(map.stopLines.end(), stop_lines_map.stopLines.begin(), stop_lines_map.stopLines.end());
+  cout << " >> Extract Signal data took " << signals_time << " s" << endl;
+  cout << " >> Extract Stop lines data took " << stop_lines_time << " s" << endl;
+
+  //Wayarea
+  if(bFindCurbsAndWayArea)
+  {
+    double way_area_time = way_area_task.get();
+    map.boundaries.insert(map.boundaries.end(), way_area_map.boundaries.begin(), way_area_map.boundaries.end());
+    cout << " >> Extract wayarea data took " << way_area_time << " s" << endl;
+  }
+  cout << " >> Waiting for the background extraction took " << UtilityH::GetTimeDiffNow(stage_timer) << " s" << endl;
+
   //Link StopLines and Traffic Lights
   cout << " >> Link StopLines and Traffic Lights ... " << endl;
   LinkTrafficLightsAndStopLinesV2(map);
 //  //LinkTrafficLightsAndStopLinesConData(conn_data, id_replace_list, map);
 
-  cout << " >> Map loaded from data with " << roadLanes.size()  << " lanes" << endl;
+  UpdateMapVersion(map);
+
+  cout << " >> Map loaded from data with " << roadLanes.size()  << " lanes in " << UtilityH::GetTimeDiffNow(total_timer) << " s" << endl;
+}
+
+void MappingHelpers::ConstructRoadNetworkFromROSMessages(const vector_map_msgs::LaneArray& lanes,
+    const vector_map_msgs::PointArray& points,
+    const vector_map_msgs::DTLaneArray& dt_lanes,
+    const vector_map_msgs::CrossRoadArray& intersections,
+    const vector_map_msgs::AreaArray& areas,
+    const vector_map_msgs::LineArray& lines,
+    const vector_map_msgs::StopLineArray& stop_lines,
+    const vector_map_msgs::SignalArray& signals,
+    const vector_map_msgs::VectorArray& vectors,
+    const vector_map_msgs::CurbArray& curbs,
+    const vector_map_msgs::RoadEdgeArray& road_edges,
+    const vector_map_msgs::WayAreaArray& way_areas,
+    const vector_map_msgs::CrossWalkArray& cross_walks,
+    const vector_map_msgs::NodeArray& nodes,
+    const GPSPoint& origin, RoadNetwork& map,
+    const bool& bFindLaneChangeLanes, const bool& bFindCurbsAndWayArea)
+{
+  //the readers own the only copy of the records, the lists passed to the builder are theirs
+  AisanLanesFileReader lanes_reader(lanes);
+  AisanPointsFileReader points_reader(points);
+  AisanCenterLinesFileReader dt_reader(dt_lanes);
+  AisanIntersectionFileReader intersections_reader(intersections);
+  AisanAreasFileReader areas_reader(areas);
+  AisanLinesFileReader lines_reader(lines);
+  AisanStopLineFileReader stop_lines_reader(stop_lines);
+  AisanSignalFileReader signals_reader(signals);
+  AisanVectorFileReader vectors_reader(vectors);
+  AisanCurbFileReader curbs_reader(curbs);
+  AisanRoadEdgeFileReader road_edges_reader(road_edges);
+  AisanWayareaFileReader way_areas_reader(way_areas);
+  AisanCrossWalkFileReader cross_walks_reader(cross_walks);
+  AisanNodesFileReader nodes_reader(nodes);
+  std::vector<AisanDataConnFileReader::DataConn> conn_data;
+
+  ConstructRoadNetworkFromROSMessageV2(lanes_reader.m_data_list, points_reader.m_data_list, dt_reader.m_data_list,
+      intersections_reader.m_data_list, areas_reader.m_data_list, lines_reader.m_data_list, stop_lines_reader.m_data_list,
+      signals_reader.m_data_list, vectors_reader.m_data_list, curbs_reader.m_data_list, road_edges_reader.m_data_list,
+      way_areas_reader.m_data_list, cross_walks_reader.m_data_list, nodes_reader.m_data_list, conn_data,
+      &lanes_reader, &points_reader, &nodes_reader, &lines_reader, origin, map, false, bFindLaneChangeLanes, bFindCurbsAndWayArea);
 }
 
 bool MappingHelpers::GetPointFromDataList(UtilityHNS::AisanPointsFileReader* pPointsData,const int& pid, WayPoint& out_wp)
@@ -3140,35 +3516,35 @@ void MappingHelpers::FixUnconnectedLanes(std::vector<Lane>& lanes)
   lanes = sp_lanes;
 }
 
+//append every lane of segment rs with the id, in lane order
+static void GetSegmentLanesById(RoadNetwork& map, const unsigned int& rs, const int& id, std::vector<Lane*>& lanes)
+{
+  std::unordered_map<int, std::vector<MapIdIndex::Location> >::const_iterator it = map.idIndex.lanes.find(id);
+  if(it == map.idIndex.lanes.end()) return;
+
+  for(unsigned int i = 0; i < it->second.size(); i++)
+  {
+    if(it->second.at(i).iSegment == (int)rs)
+      lanes.push_back(&map.roadSegments.at(rs).Lanes.at(it->second.at(i).iLane));
+  }
+}
+
 void MappingHelpers::LinkLanesPointers(PlannerHNS::RoadNetwork& map)
 {
+  //lanes are only looked up here, built for the current lanes the index is exact
+  map.idIndex.Build(map.roadSegments);
+
   for(unsigned int rs = 0; rs < map.roadSegments.size(); rs++)
   {
-    //Link Lanes
+    //Link Lanes, only lanes of the same road segment are linked
     for(unsigned int i =0; i < map.roadSegments.at(rs).Lanes.size(); i++)
     {
       Lane* pL = &map.roadSegments.at(rs).Lanes.at(i);
       for(unsigned int j = 0 ; j < pL->fromIds.size(); j++)
-      {
-        for(unsigned int l= 0; l < map.roadSegments.at(rs).Lanes.size(); l++)
-        {
-          if(map.roadSegments.at(rs).Lanes.at(l).id == pL->fromIds.at(j))
-          {
-            pL->fromLanes.push_back(&map.roadSegments.at(rs).Lanes.at(l));
-          }
-        }
-      }
+        GetSegmentLanesById(map, rs, pL->fromIds.at(j), pL->fromLanes);
 
       for(unsigned int j = 0 ; j < pL->toIds.size(); j++)
-      {
-        for(unsigned int l= 0; l < map.roadSegments.at(rs).Lanes.size(); l++)
-        {
-          if(map.roadSegments.at(rs).Lanes.at(l).id == pL->toIds.at(j))
-          {
-            pL->toLanes.push_back(&map.roadSegments.at(rs).Lanes.at(l));
-          }
-        }
-      }
+        GetSegmentLanesById(map, rs, pL->toIds.at(j), pL->toLanes);
 
       for(unsigned int j = 0 ; j < pL->points.size(); j++)
       {
@@ -3181,38 +3557,40 @@ void MappingHelpers::LinkLanesPointers(PlannerHNS::RoadNetwork& map)
 void MappingHelpers::ExtractCurbDataV2(const std::vector<UtilityHNS::AisanCurbFileReader::AisanCurb>& curb_data,
         UtilityHNS::AisanLinesFileReader* pLinedata,
         UtilityHNS::AisanPointsFileReader* pPointsData,
-        const GPSPoint& origin, RoadNetwork& map)
+        const GPSPoint& origin, RoadNetwork& map, const int& nThreads)
 {
-  for(unsigned int ic=0; ic < curb_data.size(); ic++)
+  //the closest lane search only reads the map, each curb is built in its own slot
+  std::vector<Curb> curbs(curb_data.size());
+  UtilityHNS::TaskScheduler& scheduler = UtilityHNS::TaskScheduler::GetShared();
+  scheduler.ParallelFor(curb_data.size(), [&](const int& ic)
   {
-    Curb c;
+    Curb& c = curbs.at(ic);
     c.id = curb_data.at(ic).ID;
 
-    for(unsigned int il=0; il < pLinedata->m_data_list.size() ; il++)
+    AisanLinesFileReader::AisanLine* pLine = pLinedata->GetDataRowById(curb_data.at(ic).LID);
+    if(pLine != nullptr)
     {
-      if(curb_data.at(ic).LID == pLinedata->m_data_list.at(il).LID)
-      {
-        int s_id = pLinedata->m_data_list.at(il).BPID;
-        if(s_id == 0)
-          s_id = pLinedata->m_data_list.at(il).FPID;
+      int s_id = pLine->BPID;
+      if(s_id == 0)
+        s_id = pLine->FPID;
 
-        AisanPointsFileReader::AisanPoints* pP = pPointsData->GetDataRowById(s_id);
-        if(pP != nullptr)
+      AisanPointsFileReader::AisanPoints* pP = pPointsData->GetDataRowById(s_id);
+      if(pP != nullptr)
+      {
+        c.points.push_back(GPSPoint(pP->Ly + origin.x, pP->Bx + origin.y, pP->H + origin.z, 0));
+        WayPoint wp;
+        wp.pos = c.points.at(0);
+        Lane* pLane = GetClosestLaneFromMap(wp, map, 5);
+        if(pLane != nullptr)
         {
-          c.points.push_back(GPSPoint(pP->Ly + origin.x, pP->Bx + origin.y, pP->H + origin.z, 0));
-          WayPoint wp;
-          wp.pos = c.points.at(0);
-          Lane* pLane = GetClosestLaneFromMap(wp, map, 5);
-          if(pLane != nullptr)
-          {
-            c.laneId = pLane->id;
-            c.pLane = pLane;
-          }
+          c.laneId = pLane->id;
+          c.pLane = pLane;
         }
       }
     }
-    map.curbs.push_back(c);
-  }
+  }, nThreads);
+
+  map.curbs.insert(map.curbs.end(), curbs.begin(), curbs.end());
 }
 
 void MappingHelpers::ExtractSignalDataV2(const std::vector<UtilityHNS::AisanSignalFileReader::AisanSignal>& signal_data,
@@ -3335,70 +3713,243 @@ void MappingHelpers::LinkTrafficLightsAndStopLinesV2(RoadNetwork& map)
   }
 }
 
-void MappingHelpers::FindAdjacentLanesV2(RoadNetwork& map)
+//waypoint of a lane that is beside a point of another lane, found by the parallel pass of FindAdjacentLanesV2
+class AdjacentPointMatch
 {
-  bool bTestDebug = false;
-  for(unsigned int rs = 0; rs < map.roadSegments.size(); rs++)
+public:
+  int iLane2;
+  int iPoint;
+  int iFront;
+  bool bRight;
+};
+
+#define ADJACENT_LANES_MAX_PERP_DISTANCE 3.5
+#define ADJACENT_LANES_MAX_ANGLE_DIFF 0.06
+#define ADJACENT_LANES_HEADING_BUCKETS 64
+#define ADJACENT_LANES_GRID_MAX_CELLS 1048576
+
+//lanes of a road segment that have a point in each cell and heading bucket, in CSR layout.
+//A waypoint is matched against a lane only when the lane has a point within m_Radius with a heading close to its own:
+//the perpendicular point of a match is at most ADJACENT_LANES_MAX_PERP_DISTANCE away from the waypoint, on the segment
+//of the closest point the lane search picks, and has the heading of one of its two points.
+class AdjacentLanesGrid
+{
+public:
+  double m_Radius;
+
+  AdjacentLanesGrid(const std::vector<Lane>& lanes) : m_Radius(0), m_MinX(0), m_MinY(0), m_CellSize(1), m_nCellsX(0), m_nCellsY(0)
   {
-    for(unsigned int i =0; i < map.roadSegments.at(rs).Lanes.size(); i++)
+    double max_x = -DBL_MAX, max_y = -DBL_MAX, max_segment = 0;
+    m_MinX = DBL_MAX;
+    m_MinY = DBL_MAX;
+    for(unsigned int i = 0; i < lanes.size(); i++)
     {
-      Lane* pL = &map.roadSegments.at(rs).Lanes.at(i);
-      for(unsigned int i2 =0; i2 < map.roadSegments.at(rs).Lanes.size(); i2++)
+      const std::vector<WayPoint>& points = lanes.at(i).points;
+      for(unsigned int p = 0; p < points.size(); p++)
       {
-        Lane* pL2 = &map.roadSegments.at(rs).Lanes.at(i2);
+        m_MinX = std::min(m_MinX, points.at(p).pos.x);
+        m_MinY = std::min(m_MinY, points.at(p).pos.y);
+        max_x = std::max(max_x, points.at(p).pos.x);
+        max_y = std::max(max_y, points.at(p).pos.y);
+        if(p > 0)
+          max_segment = std::max(max_segment, hypot(points.at(p).pos.y - points.at(p-1).pos.y, points.at(p).pos.x - points.at(p-1).pos.x));
+      }
+    }
 
-        if(pL->id == pL2->id) continue;
+    if(max_x < m_MinX) return;
 
+    //the perpendicular point is within one segment of a point of the lane, and one more meter for the curved lanes
+    m_Radius = ADJACENT_LANES_MAX_PERP_DISTANCE + max_segment + 1.0;
+    m_CellSize = m_Radius;
+    while(true)
+    {
+      m_nCellsX = (int)((max_x - m_MinX) / m_CellSize) + 1;
+      m_nCellsY = (int)((max_y - m_MinY) / m_CellSize) + 1;
+      if((double)m_nCellsX * (double)m_nCellsY <= ADJACENT_LANES_GRID_MAX_CELLS) break;
+      m_CellSize *= 2.0;
+    }
 
-        if(pL->id == 1683)
-          bTestDebug = true;
+    std::vector<std::pair<int, int> > keys;
+    for(unsigned int i = 0; i < lanes.size(); i++)
+    {
+      const std::vector<WayPoint>& points = lanes.at(i).points;
+      for(unsigned int p = 0; p < points.size(); p++)
+        keys.push_back(std::make_pair(GetCell(points.at(p).pos.x, points.at(p).pos.y) * ADJACENT_LANES_HEADING_BUCKETS + GetHeadingBucket(points.at(p).pos.a), i));
+    }
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+    m_CellStart.assign(m_nCellsX * m_nCellsY * ADJACENT_LANES_HEADING_BUCKETS + 1, 0);
+    m_CellLanes.resize(keys.size());
+    for(unsigned int k = 0; k < keys.size(); k++)
+    {
+      m_CellStart.at(keys.at(k).first + 1)++;
+      m_CellLanes.at(k) = keys.at(k).second;
+    }
+    for(unsigned int c = 1; c < m_CellStart.size(); c++)
+      m_CellStart.at(c) += m_CellStart.at(c-1);
+  }
+
+  //sorted indices of the lanes that can have a perpendicular point for wp, lanes is cleared first
+  void GetCandidateLanes(const WayPoint& wp, std::vector<int>& lanes) const
+  {
+    lanes.clear();
+    if(m_nCellsX == 0) return;
 
+    int x0 = std::max(0, (int)floor((wp.pos.x - m_Radius - m_MinX) / m_CellSize));
+    int x1 = std::min(m_nCellsX - 1, (int)floor((wp.pos.x + m_Radius - m_MinX) / m_CellSize));
+    int y0 = std::max(0, (int)floor((wp.pos.y - m_Radius - m_MinY) / m_CellSize));
+    int y1 = std::min(m_nCellsY - 1, (int)floor((wp.pos.y + m_Radius - m_MinY) / m_CellSize));
+
+    //buckets that overlap [a - max diff, a + max diff], the bucket of a and its two neighbors as a bucket is wider than the max diff
+    int b = GetHeadingBucket(wp.pos.a);
+    int buckets[3] = {(b + ADJACENT_LANES_HEADING_BUCKETS - 1) % ADJACENT_LANES_HEADING_BUCKETS, b, (b + 1) % ADJACENT_LANES_HEADING_BUCKETS};
+
+    for(int y = y0; y <= y1; y++)
+    {
+      for(int x = x0; x <= x1; x++)
+      {
+        int cell = (y * m_nCellsX + x) * ADJACENT_LANES_HEADING_BUCKETS;
+        for(int ib = 0; ib < 3; ib++)
+        {
+          for(int k = m_CellStart.at(cell + buckets[ib]); k < m_CellStart.at(cell + buckets[ib] + 1); k++)
+            lanes.push_back(m_CellLanes.at(k));
+        }
+      }
+    }
+
+    std::sort(lanes.begin(), lanes.end());
+    lanes.erase(std::unique(lanes.begin(), lanes.end()), lanes.end());
+  }
+
+private:
+  double m_MinX;
+  double m_MinY;
+  double m_CellSize;
+  int m_nCellsX;
+  int m_nCellsY;
+  std::vector<int> m_CellStart;
+  std::vector<int> m_CellLanes;
+
+  int GetCell(const double& x, const double& y) const
+  {
+    int ix = std::min(m_nCellsX - 1, std::max(0, (int)((x - m_MinX) / m_CellSize)));
+    int iy = std::min(m_nCellsY - 1, std::max(0, (int)((y - m_MinY) / m_CellSize)));
+    return iy * m_nCellsX + ix;
+  }
+
+  static int GetHeadingBucket(const double& a)
+  {
+    double a_fixed = fmod(a, 2.0 * M_PI);
+    if(a_fixed < 0) a_fixed += 2.0 * M_PI;
+    int b = (int)(a_fixed / (2.0 * M_PI) * ADJACENT_LANES_HEADING_BUCKETS);
+    return std::min(ADJACENT_LANES_HEADING_BUCKETS - 1, std::max(0, b));
+  }
+};
+
+void MappingHelpers::FindAdjacentLanesV2(RoadNetwork& map, const int& nThreads, const bool& bExhaustive)
+{
+  UtilityHNS::TaskScheduler& scheduler = UtilityHNS::TaskScheduler::GetShared();
+  for(unsigned int rs = 0; rs < map.roadSegments.size(); rs++)
+  {
+    std::vector<Lane>& lanes = map.roadSegments.at(rs).Lanes;
+    AdjacentLanesGrid grid(bExhaustive ? std::vector<Lane>() : lanes);
+
+    //the point to lane search only reads the lanes, each lane fills its own list of matches
+    std::vector<std::vector<AdjacentPointMatch> > lanes_matches(lanes.size());
+    scheduler.ParallelFor(lanes.size(), [&](const int& i)
+    {
+      const Lane* pL = &lanes.at(i);
+
+      //(other lane, point) pairs to check, in the order of the exhaustive search so the matches come in the same order
+      std::vector<std::pair<int, int> > pairs;
+      if(bExhaustive)
+      {
+        for(unsigned int i2 =0; i2 < lanes.size(); i2++)
+          for(unsigned int p=0; p < pL->points.size(); p++)
+            pairs.push_back(std::make_pair(i2, p));
+      }
+      else
+      {
+        std::vector<int> candidates;
         for(unsigned int p=0; p < pL->points.size(); p++)
         {
-          WayPoint* pWP = &pL->points.at(p);
-          RelativeInfo info;
-          PlanningHelpers::GetRelativeInfoLimited(pL2->points, *pWP, info);
+          grid.GetCandidateLanes(pL->points.at(p), candidates);
+          for(unsigned int c = 0; c < candidates.size(); c++)
+            pairs.push_back(std::make_pair(candidates.at(c), p));
+        }
+        std::sort(pairs.begin(), pairs.end());
+      }
+
+      for(unsigned int ip = 0; ip < pairs.size(); ip++)
+      {
+        int i2 = pairs.at(ip).first;
+        int p = pairs.at(ip).second;
+        const Lane* pL2 = &lanes.at(i2);
 
-          if(!info.bAfter && !info.bBefore && fabs(info.perp_distance) > 1.2 && fabs(info.perp_distance) < 3.5 && UtilityH::AngleBetweenTwoAnglesPositive(info.perp_point.pos.a, pWP->pos.a) < 0.06)
+        if(pL->id == pL2->id) continue;
+
+        const WayPoint* pWP = &pL->points.at(p);
+        RelativeInfo info;
+        PlanningHelpers::GetRelativeInfoLimited(pL2->points, *pWP, info);
+
+        if(!info.bAfter && !info.bBefore && fabs(info.perp_distance) > 1.2 && fabs(info.perp_distance) < ADJACENT_LANES_MAX_PERP_DISTANCE && UtilityH::AngleBetweenTwoAnglesPositive(info.perp_point.pos.a, pWP->pos.a) < ADJACENT_LANES_MAX_ANGLE_DIFF)
+        {
+          AdjacentPointMatch match;
+          match.iLane2 = i2;
+          match.iPoint = p;
+          match.iFront = info.iFront;
+          match.bRight = info.perp_distance < 0;
+          lanes_matches.at(i).push_back(match);
+        }
+      }
+    }, nThreads);
+
+    //links are applied in the sequential lane order, the first link found for a waypoint side is kept
+    for(unsigned int i =0; i < lanes.size(); i++)
+    {
+      Lane* pL = &lanes.at(i);
+      for(unsigned int m = 0; m < lanes_matches.at(i).size(); m++)
+      {
+        const AdjacentPointMatch& match = lanes_matches.at(i).at(m);
+        Lane* pL2 = &lanes.at(match.iLane2);
+        WayPoint* pWP = &pL->points.at(match.iPoint);
+        WayPoint* pWP2 = &pL2->points.at(match.iFront);
+        if(match.bRight)
+        {
+          if(pWP->pRight == 0)
           {
-            WayPoint* pWP2 = &pL2->points.at(info.iFront);
-            if(info.perp_distance < 0)
-            {
-              if(pWP->pRight == 0)
-              {
-                pWP->pRight = pWP2;
-                pWP->RightPointId = pWP2->id;
-                pWP->RightLnId = pL2->id;
-                pL->pRightLane = pL2;
+            pWP->pRight = pWP2;
+            pWP->RightPointId = pWP2->id;
+            pWP->RightLnId = pL2->id;
+            pL->pRightLane = pL2;
 
-              }
+          }
 
-              if(pWP2->pLeft == 0)
-              {
-                pWP2->pLeft = pWP;
-                pWP2->LeftPointId = pWP->id;
-                pWP2->LeftLnId = pL->id;
-                pL2->pLeftLane = pL;
-              }
-            }
-            else
-            {
-              if(pWP->pLeft == 0)
-              {
-                pWP->pLeft = pWP2;
-                pWP->LeftPointId = pWP2->id;
-                pWP->LeftLnId = pL2->id;
-                pL->pLeftLane = pL2;
-              }
+          if(pWP2->pLeft == 0)
+          {
+            pWP2->pLeft = pWP;
+            pWP2->LeftPointId = pWP->id;
+            pWP2->LeftLnId = pL->id;
+            pL2->pLeftLane = pL;
+          }
+        }
+        else
+        {
+          if(pWP->pLeft == 0)
+          {
+            pWP->pLeft = pWP2;
+            pWP->LeftPointId = pWP2->id;
+            pWP->LeftLnId = pL2->id;
+            pL->pLeftLane = pL2;
+          }
 
-              if(pWP2->pRight == 0)
-              {
-                pWP2->pRight = pWP->pLeft;
-                pWP2->RightPointId = pWP->id;
-                pWP2->RightLnId = pL->id;
-                pL2->pRightLane = pL;
-              }
-            }
+          if(pWP2->pRight == 0)
+          {
+            pWP2->pRight = pWP->pLeft;
+            pWP2->RightPointId = pWP->id;
+            pWP2->RightLnId = pL->id;
+            pL2->pRightLane = pL;
           }
         }
       }
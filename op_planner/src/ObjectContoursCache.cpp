@@ -0,0 +1,81 @@
+/// \file ObjectContoursCache.cpp
+/// \brief Contours of the detected objects kept between planning cycles, recomputed only when an object moves or changes shape
+/// \date Oct 14, 2026
+
+#include "op_planner/ObjectContoursCache.h"
+#include "op_planner/PolygonGeometry.h"
+
+namespace PlannerHNS
+{
+
+ObjectContoursCache::ObjectContoursCache()
+{
+  m_nHits = 0;
+  m_nComputations = 0;
+}
+
+void ObjectContoursCache::Clear()
+{
+  m_Entries.clear();
+}
+
+const std::vector<GPSPoint>& ObjectContoursCache::GetContour(const DetectedObject& obj)
+{
+  const GPSPoint& center = obj.center.pos;
+  std::unordered_map<int, Entry>::iterator it = m_Entries.find(obj.id);
+  if(it == m_Entries.end())
+  {
+    it = m_Entries.insert(std::make_pair(obj.id, Entry())).first;
+  }
+  else if(it->second.center.x == center.x && it->second.center.y == center.y && it->second.center.z == center.z
+      && it->second.center.a == center.a && it->second.w == obj.w && it->second.l == obj.l && it->second.h == obj.h)
+  {
+    it->second.bUsed = true;
+    m_nHits++;
+    return it->second.contour;
+  }
+
+  Entry& entry = it->second;
+  entry.center = center;
+  entry.w = obj.w;
+  entry.l = obj.l;
+  entry.h = obj.h;
+  entry.bUsed = true;
+  PolygonGeometry::GetOrientedRectangle(center, obj.w, obj.l, center.z + obj.h/2.0, entry.contour);
+  m_nComputations++;
+  return entry.contour;
+}
+
+void ObjectContoursCache::RemoveUnused()
+{
+  std::unordered_map<int, Entry>::iterator it = m_Entries.begin();
+  while(it != m_Entries.end())
+  {
+    if(!it->second.bUsed)
+    {
+      it = m_Entries.erase(it);
+    }
+    else
+    {
+      it->second.bUsed = false;
+      it++;
+    }
+  }
+}
+
+unsigned int ObjectContoursCache::GetNumberOfObjects() const
+{
+  return m_Entries.size();
+}
+
+unsigned long ObjectContoursCache::GetNumberOfHits() const
+{
+  return m_nHits;
+}
+
+unsigned long ObjectContoursCache::GetNumberOfComputations() const
+{
+  return m_nComputations;
+}
+
+} /* namespace PlannerHNS */
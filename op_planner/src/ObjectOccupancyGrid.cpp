@@ -0,0 +1,168 @@
+/// \file ObjectOccupancyGrid.cpp
+/// \brief Uniform grid of the predicted trajectory points of one object, for the roll out collision checks
+/// \date Oct 14, 2026
+
+#include "op_planner/ObjectOccupancyGrid.h"
+#include <algorithm>
+#include <cmath>
+
+namespace PlannerHNS
+{
+
+#define OCCUPANCY_GRID_MAX_CELLS 65536
+
+ObjectOccupancyGrid::ObjectOccupancyGrid()
+{
+  m_CellSize = 1.0;
+  m_MinX = 0;
+  m_MinY = 0;
+  m_nCellsX = 0;
+  m_nCellsY = 0;
+}
+
+ObjectOccupancyGrid::~ObjectOccupancyGrid()
+{
+}
+
+void ObjectOccupancyGrid::Clear()
+{
+  m_nCellsX = 0;
+  m_nCellsY = 0;
+  m_CellStart.clear();
+  m_X.clear();
+  m_Y.clear();
+  m_A.clear();
+  m_T.clear();
+  m_Order.clear();
+}
+
+unsigned int ObjectOccupancyGrid::GetNumberOfPoints() const
+{
+  return m_X.size();
+}
+
+double ObjectOccupancyGrid::GetHeading(const int& iPredicted) const
+{
+  return m_A.at(iPredicted);
+}
+
+double ObjectOccupancyGrid::GetTime(const int& iPredicted) const
+{
+  return m_T.at(iPredicted);
+}
+
+void ObjectOccupancyGrid::Build(const DetectedObject& obj, const double& cellSize)
+{
+  Clear();
+  m_CellSize = std::max(0.1, cellSize);
+
+  double max_x = 0, max_y = 0;
+  std::vector<const WayPoint*> points;
+  for(unsigned int k = 0; k < obj.predTrajectories.size(); k++)
+  {
+    for(unsigned int j = 0; j < obj.predTrajectories.at(k).size(); j++)
+    {
+      const WayPoint& p = obj.predTrajectories.at(k).at(j);
+      if(points.size() == 0)
+      {
+        m_MinX = max_x = p.pos.x;
+        m_MinY = max_y = p.pos.y;
+      }
+      m_MinX = std::min(m_MinX, p.pos.x);
+      m_MinY = std::min(m_MinY, p.pos.y);
+      max_x = std::max(max_x, p.pos.x);
+      max_y = std::max(max_y, p.pos.y);
+      points.push_back(&p);
+    }
+  }
+  if(points.size() == 0) return;
+
+  //very long predictions get larger cells
+  while(((max_x - m_MinX) / m_CellSize + 1) * ((max_y - m_MinY) / m_CellSize + 1) > OCCUPANCY_GRID_MAX_CELLS)
+    m_CellSize *= 2.0;
+  m_nCellsX = floor((max_x - m_MinX) / m_CellSize) + 1;
+  m_nCellsY = floor((max_y - m_MinY) / m_CellSize) + 1;
+
+  m_SortBuffer.resize(points.size());
+  for(unsigned int i = 0; i < points.size(); i++)
+  {
+    int ix = std::min(m_nCellsX - 1, (int)floor((points.at(i)->pos.x - m_MinX) / m_CellSize));
+    int iy = std::min(m_nCellsY - 1, (int)floor((points.at(i)->pos.y - m_MinY) / m_CellSize));
+    m_SortBuffer.at(i) = std::make_pair(iy * m_nCellsX + ix, (int)i);
+  }
+  std::sort(m_SortBuffer.begin(), m_SortBuffer.end());
+
+  int n = m_SortBuffer.size();
+  m_X.resize(n);
+  m_Y.resize(n);
+  m_A.resize(n);
+  m_T.resize(n);
+  m_Order.resize(n);
+  m_CellStart.assign(m_nCellsX * m_nCellsY + 1, 0);
+  for(int i = 0; i < n; i++)
+  {
+    const WayPoint* p = points.at(m_SortBuffer.at(i).second);
+    m_X.at(i) = p->pos.x;
+    m_Y.at(i) = p->pos.y;
+    m_A.at(i) = p->pos.a;
+    m_T.at(i) = p->timeCost;
+    m_Order.at(i) = m_SortBuffer.at(i).second;
+    m_CellStart.at(m_SortBuffer.at(i).first + 1)++;
+  }
+  for(unsigned int c = 1; c < m_CellStart.size(); c++)
+    m_CellStart.at(c) += m_CellStart.at(c-1);
+}
+
+int ObjectOccupancyGrid::FindFirstCollision(const std::vector<WayPoint>& path, const double& distance, int& iPredicted, double& collisionDistance) const
+{
+  iPredicted = -1;
+  collisionDistance = 0;
+  if(m_X.size() == 0) return -1;
+
+  double distance_sqr = distance*distance;
+  double margin = distance*1.000001;
+  double max_x = m_MinX + m_nCellsX * m_CellSize;
+  double max_y = m_MinY + m_nCellsY * m_CellSize;
+  int r = std::max(1, (int)ceil(distance / m_CellSize));
+  for(unsigned int i = 0; i < path.size(); i++)
+  {
+    const GPSPoint& p = path.at(i).pos;
+    if(p.x < m_MinX - margin || p.x > max_x + margin || p.y < m_MinY - margin || p.y > max_y + margin) continue;
+
+    int cx = floor((p.x - m_MinX) / m_CellSize);
+    int cy = floor((p.y - m_MinY) / m_CellSize);
+    int min_order = -1;
+    for(int iy = std::max(0, cy - r); iy <= std::min(m_nCellsY - 1, cy + r); iy++)
+    {
+      for(int ix = std::max(0, cx - r); ix <= std::min(m_nCellsX - 1, cx + r); ix++)
+      {
+        int cell = iy * m_nCellsX + ix;
+        for(int ip = m_CellStart[cell]; ip < m_CellStart[cell+1]; ip++)
+        {
+          if(min_order >= 0 && m_Order[ip] >= min_order) break;
+
+          //same distance test as the scan of TrajectoryDynamicCosts::CalculateIntersectionVelocities
+          double dx = p.x - m_X[ip];
+          double dy = p.y - m_Y[ip];
+          if(dx*dx + dy*dy > distance_sqr*1.000001) continue;
+
+          double d = hypot(dx, dy);
+          if(d <= distance)
+          {
+            min_order = m_Order[ip];
+            iPredicted = ip;
+            collisionDistance = d;
+            break;
+          }
+        }
+      }
+    }
+
+    if(min_order >= 0)
+      return i;
+  }
+
+  return -1;
+}
+
+} /* namespace PlannerHNS */
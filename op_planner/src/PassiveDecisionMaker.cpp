@@ -78,6 +78,24 @@ PassiveDecisionMaker::~PassiveDecisionMaker()
   return false;
  }
 
+ bool PassiveDecisionMaker::CheckForStopLineInTable(PlannerHNS::WayPoint& currPose, const std::vector<WayPoint>& path, const CAR_BASIC_INFO& carInfo)
+ {
+   double minStoppingDistance = -pow(currPose.v, 2)/(carInfo.max_deceleration);
+   double critical_long_front_distance =  carInfo.wheel_base/2.0 + carInfo.length/2.0;
+
+  int stopLineID = -1;
+  int stopSignID = -1;
+  int trafficLightID = -1;
+  double distanceToClosestStopLine = m_StopLines.GetDistanceToNextStopLine(path, currPose, 0, 0, stopLineID, stopSignID, trafficLightID) - critical_long_front_distance;
+
+  if(distanceToClosestStopLine > -2 && distanceToClosestStopLine < minStoppingDistance)
+  {
+    return true;
+  }
+
+  return false;
+ }
+
  PlannerHNS::BehaviorState PassiveDecisionMaker::MoveStep(const double& dt, PlannerHNS::WayPoint& currPose, const std::vector<WayPoint>& path, const CAR_BASIC_INFO& carInfo)
  {
    PlannerHNS::BehaviorState beh;
@@ -150,4 +168,90 @@ PassiveDecisionMaker::~PassiveDecisionMaker()
 
   }
 
+ void PassiveDecisionMaker::MoveSteps(const double& dt, std::vector<WayPoint>& poses, const std::vector<WayPoint>& path, const CAR_BASIC_INFO& carInfo,
+     std::vector<BehaviorState>& behs)
+ {
+   behs.clear();
+   behs.resize(poses.size());
+   if(path.size() == 0) return;
+
+   m_StopLines.Build(path);
+   for(unsigned int i = 0; i < poses.size(); i++)
+   {
+     PlannerHNS::WayPoint& currPose = poses.at(i);
+     PlannerHNS::BehaviorState& beh = behs.at(i);
+
+     RelativeInfo info;
+     m_PathCursor.GetRelativeInfo(path, currPose, info);
+
+     if(CheckForStopLineInTable(currPose, path, carInfo))
+       beh.state = PlannerHNS::STOPPING_STATE;
+     else
+       beh.state = PlannerHNS::FORWARD_STATE;
+
+     double average_braking_distance = -pow(currPose.v, 2)/(carInfo.max_deceleration) + 1.0;
+
+     if(average_braking_distance  < 10)
+       average_braking_distance = 10;
+
+     beh.indicator = PlanningHelpers::GetIndicatorsFromPath(path, currPose, average_braking_distance);
+
+     currPose.v = beh.maxVelocity = GetVelocity(currPose, path, carInfo, info);
+
+     double steer = GetSteerAngle(currPose, path, info);
+
+     currPose.pos.x += currPose.v * dt * cos(currPose.pos.a);
+     currPose.pos.y += currPose.v * dt * sin(currPose.pos.a);
+     currPose.pos.a += currPose.v * dt * tan(steer)  / carInfo.wheel_base;
+   }
+ }
+
+ void PassiveDecisionMaker::MoveStepsSimple(const double& dt, std::vector<WayPoint>& poses, const std::vector<WayPoint>& path, const CAR_BASIC_INFO& carInfo,
+     std::vector<ParticleInfo>& behs)
+ {
+   behs.clear();
+   behs.resize(poses.size());
+   if(path.size() == 0) return;
+
+   m_StopLines.Build(path);
+
+   //searched from the first path point, so it only changes with the braking distance
+   PlannerHNS::LIGHT_INDICATOR indicator = PlannerHNS::INDICATOR_NONE;
+   double indicator_distance = 0;
+   bool bIndicator = false;
+   for(unsigned int i = 0; i < poses.size(); i++)
+   {
+     PlannerHNS::WayPoint& currPose = poses.at(i);
+     PlannerHNS::ParticleInfo& beh = behs.at(i);
+
+     RelativeInfo info;
+     m_PathCursor.GetRelativeInfo(path, currPose, info);
+
+     if(CheckForStopLineInTable(currPose, path, carInfo))
+       beh.state = PlannerHNS::STOPPING_STATE;
+     else
+       beh.state = PlannerHNS::FORWARD_STATE;
+
+     double average_braking_distance = -pow(currPose.v, 2)/(carInfo.max_deceleration) + 15.0;
+     if(!bIndicator || average_braking_distance != indicator_distance)
+     {
+       indicator = PlanningHelpers::GetIndicatorsFromPath(path, path.at(0), average_braking_distance);
+       indicator_distance = average_braking_distance;
+       bIndicator = true;
+     }
+     beh.indicator = indicator;
+
+     if(info.iFront < path.size())
+       beh.vel = path.at(info.iFront).v;
+     else
+       beh.vel = 0;
+
+     double steer = GetSteerAngle(currPose, path, info);
+
+     currPose.pos.x += currPose.v * dt * cos(currPose.pos.a);
+     currPose.pos.y += currPose.v * dt * sin(currPose.pos.a);
+     currPose.pos.a += currPose.v * dt * tan(steer)  / carInfo.wheel_base;
+   }
+ }
+
 } /* namespace PlannerHNS */
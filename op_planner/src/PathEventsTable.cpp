@@ -0,0 +1,101 @@
+/// \file PathEventsTable.cpp
+/// \brief Stop lines of a global path with their arc length positions, built once per path and read with a cursor every cycle
+/// \date Oct 14, 2026
+
+#include "op_planner/PathEventsTable.h"
+#include "op_planner/PlanningHelpers.h"
+#include <limits>
+
+namespace PlannerHNS
+{
+
+PathEventsTable::PathEventsTable()
+{
+  m_pData = nullptr;
+  m_Size = 0;
+  m_iNextEvent = 0;
+  m_LastCarDistance = -std::numeric_limits<double>::max();
+}
+
+PathEventsTable::~PathEventsTable()
+{
+}
+
+void PathEventsTable::Clear()
+{
+  m_Events.clear();
+  m_pData = nullptr;
+  m_Size = 0;
+  m_iNextEvent = 0;
+  m_LastCarDistance = -std::numeric_limits<double>::max();
+  m_Cursor.Reset();
+}
+
+bool PathEventsTable::IsBuiltFor(const std::vector<WayPoint>& path) const
+{
+  return m_pData != nullptr && m_pData == path.data() && m_Size == path.size();
+}
+
+void PathEventsTable::Build(const std::vector<WayPoint>& path)
+{
+  Clear();
+  m_pData = path.data();
+  m_Size = path.size();
+  m_Cursor.Sync(path);
+
+  for(unsigned int i = 0; i < path.size(); i++)
+  {
+    if(path.at(i).stopLineID <= 0 || !path.at(i).pLane) continue;
+
+    const std::vector<StopLine>& stopLines = path.at(i).pLane->stopLines;
+    for(unsigned int j = 0; j < stopLines.size(); j++)
+    {
+      if(stopLines.at(j).id != path.at(i).stopLineID || stopLines.at(j).points.size() == 0) continue;
+
+      RelativeInfo stop_info;
+      WayPoint stopLineWP;
+      stopLineWP.pos = stopLines.at(j).points.at(0);
+      PlanningHelpers::GetRelativeInfo(path, stopLineWP, stop_info);
+
+      PathEvent e;
+      e.waypointIndex = i;
+      e.distance = m_Cursor.m_CumulativeDistance.at(stop_info.iBack) + stop_info.from_back_distance;
+      e.stopLineID = path.at(i).stopLineID;
+      e.stopSignID = stopLines.at(j).stopSignID;
+      e.trafficLightID = stopLines.at(j).trafficLightID;
+      m_Events.push_back(e);
+    }
+  }
+}
+
+double PathEventsTable::GetDistanceToNextStopLine(const std::vector<WayPoint>& path, const WayPoint& p, const double& giveUpDistance,
+    const double& maxDistance, int& stopLineID, int& stopSignID, int& trafficLightID)
+{
+  trafficLightID = stopSignID = stopLineID = -1;
+  if(m_Events.size() == 0 || path.size() == 0) return -1;
+
+  RelativeInfo info;
+  m_Cursor.GetRelativeInfo(path, p, info);
+  double car_distance = m_Cursor.m_CumulativeDistance.at(info.iBack) + info.from_back_distance;
+  if(car_distance < m_LastCarDistance)
+    m_iNextEvent = 0;
+  m_LastCarDistance = car_distance;
+
+  //events behind the car or closer than giveUpDistance stay behind while the car moves forward
+  while(m_iNextEvent < m_Events.size() && (m_Events.at(m_iNextEvent).waypointIndex < info.iBack
+      || m_Events.at(m_iNextEvent).distance - car_distance <= giveUpDistance))
+    m_iNextEvent++;
+
+  if(m_iNextEvent >= m_Events.size()) return -1;
+
+  const PathEvent& e = m_Events.at(m_iNextEvent);
+  double d = e.distance - car_distance;
+  if(maxDistance > 0 && d > maxDistance) return -1;
+
+  stopLineID = e.stopLineID;
+  stopSignID = e.stopSignID;
+  trafficLightID = e.trafficLightID;
+  return d;
+}
+
+} /* namespace PlannerHNS */
@@ -0,0 +1,200 @@
+/// \file PathGeometry.cpp
+/// \brief Side car geometry columns (arc length, heading, curvature) of a WayPoint path, computed once per path update
+/// \date Oct 14, 2026
+
+#include "op_planner/PathGeometry.h"
+#include "op_planner/PlanningHelpers.h"
+#include "op_utility/FastAngle.h"
+#include <algorithm>
+
+namespace PlannerHNS
+{
+
+PathGeometry::PathGeometry()
+{
+  m_DirtyStart = -1;
+  m_DirtyEnd = -1;
+}
+
+PathGeometry::~PathGeometry()
+{
+}
+
+void PathGeometry::Clear()
+{
+  s.clear();
+  heading.clear();
+  kappa.clear();
+  m_DirtyStart = -1;
+  m_DirtyEnd = -1;
+}
+
+void PathGeometry::Invalidate()
+{
+  //empty columns never match the path size, so the next Update recomputes everything
+  Clear();
+}
+
+void PathGeometry::Invalidate(const int& start, const int& end)
+{
+  if(start < 0 || end < start) return;
+
+  if(m_DirtyStart < 0)
+  {
+    m_DirtyStart = start;
+    m_DirtyEnd = end;
+  }
+  else
+  {
+    m_DirtyStart = std::min(m_DirtyStart, start);
+    m_DirtyEnd = std::max(m_DirtyEnd, end);
+  }
+}
+
+bool PathGeometry::IsValid(const std::vector<WayPoint>& path) const
+{
+  return m_DirtyStart < 0 && s.size() == path.size();
+}
+
+void PathGeometry::Update(const std::vector<WayPoint>& path)
+{
+  int n = path.size();
+  if(n == 0)
+  {
+    Clear();
+    return;
+  }
+
+  bool bFull = (int)s.size() != n;
+  if(!bFull && m_DirtyStart < 0) return;
+
+  int start = 0, end = n-1;
+  if(bFull)
+  {
+    s.resize(n);
+    heading.resize(n);
+    kappa.resize(n);
+  }
+  else
+  {
+    start = std::min(m_DirtyStart, n-1);
+    end = std::min(m_DirtyEnd, n-1);
+  }
+
+  //moving point i changes the heading of i-1 and i, and the curvature of i-1, i and i+1
+  UpdateHeading(path, start-1, end);
+  UpdateCurvature(path, start-1, end+1);
+
+  if(bFull)
+  {
+    s.at(0) = 0;
+    for(int j = 1; j < n; j++)
+      s.at(j) = s.at(j-1) + hypot(path.at(j).pos.y - path.at(j-1).pos.y, path.at(j).pos.x - path.at(j-1).pos.x);
+  }
+  else
+  {
+    //only the segments touching the range change length, the rest of s is shifted
+    int iLast = std::min(n-1, end+1);
+    double old_last = s.at(iLast);
+    s.at(0) = 0;
+    for(int j = std::max(1, start); j <= iLast; j++)
+      s.at(j) = s.at(j-1) + hypot(path.at(j).pos.y - path.at(j-1).pos.y, path.at(j).pos.x - path.at(j-1).pos.x);
+
+    double delta = s.at(iLast) - old_last;
+    if(delta != 0)
+    {
+      for(int j = iLast+1; j < n; j++)
+        s.at(j) += delta;
+    }
+  }
+
+  m_DirtyStart = -1;
+  m_DirtyEnd = -1;
+}
+
+void PathGeometry::UpdateHeading(const std::vector<WayPoint>& path, const int& start, const int& end)
+{
+  int n = path.size();
+  if(n < 2)
+  {
+    heading.assign(n, 0);
+    return;
+  }
+
+  int iStart = std::max(0, start);
+  int iEnd = std::min(n-2, end);
+  for(int j = iStart; j <= iEnd; j++)
+    heading.at(j) = UtilityHNS::PlannerAngle::Atan2(path.at(j+1).pos.y - path.at(j).pos.y, path.at(j+1).pos.x - path.at(j).pos.x);
+
+  if(end >= n-2)
+    heading.at(n-1) = heading.at(n-2);
+}
+
+void PathGeometry::UpdateCurvature(const std::vector<WayPoint>& path, const int& start, const int& end)
+{
+  int n = path.size();
+  if(n < 3)
+  {
+    kappa.assign(n, 0);
+    return;
+  }
+
+  GPSPoint center;
+  int iStart = std::max(1, start);
+  int iEnd = std::min(n-2, end);
+  for(int j = iStart; j <= iEnd; j++)
+  {
+    double r = PlanningHelpers::CalcCircle(path.at(j-1).pos, path.at(j).pos, path.at(j+1).pos, center);
+    if(std::isnan(r))
+      kappa.at(j) = 0;
+    else
+      kappa.at(j) = 1.0/r;
+  }
+
+  if(start <= 1)
+    kappa.at(0) = kappa.at(1);
+  if(end >= n-2)
+    kappa.at(n-1) = kappa.at(n-2);
+}
+
+int PathGeometry::GetIndexAtDistance(const double& distance) const
+{
+  if(s.size() == 0) return 0;
+
+  std::vector<double>::const_iterator it = std::lower_bound(s.begin(), s.end(), distance);
+  if(it == s.end())
+    return s.size()-1;
+
+  return it - s.begin();
+}
+
+double PathGeometry::GetTotalLength() const
+{
+  if(s.size() == 0) return 0;
+
+  return s.back();
+}
+
+void PathGeometry::GetChangedRange(const std::vector<GPSPoint>& before, const std::vector<WayPoint>& after, int& start, int& end)
+{
+  start = -1;
+  end = -1;
+  if(before.size() != after.size())
+  {
+    start = 0;
+    end = (int)std::max(before.size(), after.size()) - 1;
+    return;
+  }
+
+  for(unsigned int i = 0; i < after.size(); i++)
+  {
+    if(before.at(i).x != after.at(i).pos.x || before.at(i).y != after.at(i).pos.y)
+    {
+      if(start < 0)
+        start = i;
+      end = i;
+    }
+  }
+}
+
+} /* namespace PlannerHNS */
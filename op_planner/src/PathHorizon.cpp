@@ -0,0 +1,260 @@
+/// \file PathHorizon.cpp
+/// \brief Views on a part of a path, and the resampled horizon of a global path extended as the car advances
+/// \date Oct 14, 2026
+
+#include "op_planner/PathHorizon.h"
+#include "op_planner/PlanningHelpers.h"
+#include "op_utility/FastAngle.h"
+
+namespace PlannerHNS
+{
+
+//resampled points behind the car kept before they are dropped at once
+static const unsigned int DROP_POINTS_COUNT = 64;
+
+void PathView::CopyTo(std::vector<WayPoint>& path) const
+{
+  if(m_Size == 0)
+  {
+    path.clear();
+    return;
+  }
+
+  path.assign(m_pPath->begin() + m_Offset, m_pPath->begin() + m_Offset + m_Size);
+  const double first_cost = path.at(0).cost;
+  for(unsigned int i = 0; i < path.size(); i++)
+    path.at(i).cost -= first_cost;
+}
+
+PathHorizon::PathHorizon()
+{
+  m_nRestarts = 0;
+  m_nAddedPoints = 0;
+  m_pData = 0;
+  m_Size = 0;
+  m_Density = 0;
+  m_iResampleStart = -1;
+  m_bFinished = false;
+  m_si = 0;
+  m_ei = 0;
+  m_d = 0;
+  m_Remaining = 0;
+}
+
+PathHorizon::~PathHorizon()
+{
+}
+
+void PathHorizon::Reset()
+{
+  m_pData = 0;
+  m_Size = 0;
+  m_iResampleStart = -1;
+  m_Resampled.clear();
+}
+
+bool PathHorizon::IsResampledFor(const std::vector<WayPoint>& originalPath, const double& pathDensity) const
+{
+  return m_iResampleStart >= 0 && m_pData == originalPath.data() && m_Size == originalPath.size() && m_Density == pathDensity
+      && m_First.x == originalPath.front().pos.x && m_First.y == originalPath.front().pos.y
+      && m_Last.x == originalPath.back().pos.x && m_Last.y == originalPath.back().pos.y;
+}
+
+double PathHorizon::Restart(const std::vector<WayPoint>& originalPath, const WayPoint& pos, const double& pathDensity)
+{
+  m_nRestarts++;
+  m_pData = originalPath.data();
+  m_Size = originalPath.size();
+  m_First = originalPath.front().pos;
+  m_Last = originalPath.back().pos;
+  m_Density = pathDensity;
+
+  //same start as ExtractPartFromPointToDistanceDirectionFast, 10 meters behind the closest point
+  int close_index = PlanningHelpers::GetClosestNextPointIndexDirectionFast(originalPath, pos);
+  if(close_index + 1 >= (int)originalPath.size())
+    close_index = originalPath.size() - 2;
+
+  double d = 0;
+  int start_index = 0;
+  for(int i = close_index; i >= 0; i--)
+  {
+    start_index = i;
+    d += hypot(originalPath.at(i).pos.y - originalPath.at(i+1).pos.y, originalPath.at(i).pos.x - originalPath.at(i+1).pos.x);
+    if(d > 10)
+      break;
+  }
+
+  m_iResampleStart = start_index;
+  m_Resampled.clear();
+  m_Resampled.push_back(originalPath.at(start_index));
+  m_Resampled.back().cost = 0;
+  m_nAddedPoints++;
+
+  m_si = start_index;
+  m_ei = start_index + 1;
+  m_d = 0;
+  m_Remaining = 0;
+  m_StartPos = originalPath.at(start_index).pos;
+  m_bFinished = m_ei >= originalPath.size();
+  return d;
+}
+
+const GPSPoint& PathHorizon::GetPos(const std::vector<WayPoint>& originalPath, const unsigned int& i) const
+{
+  if(i == m_si)
+    return m_StartPos;
+  return originalPath.at(i).pos;
+}
+
+bool PathHorizon::ResampleNextPoint(const std::vector<WayPoint>& originalPath)
+{
+  if(m_bFinished) return false;
+
+  //one step of the FixPathDensity loop
+  if(m_Density == 0)
+  {
+    m_Resampled.push_back(originalPath.at(m_ei));
+  }
+  else
+  {
+    const double margin = m_Density*0.01;
+    const GPSPoint& pe = GetPos(originalPath, m_ei);
+    const GPSPoint& pe_prev = GetPos(originalPath, m_ei-1);
+    const GPSPoint& ps = GetPos(originalPath, m_si);
+    m_d += hypot(pe.x - pe_prev.x, pe.y - pe_prev.y) + m_Remaining;
+    const double a = atan2(pe.y - ps.y, pe.x - ps.x);
+
+    if(m_d < m_Density - margin)
+    {
+      m_Remaining = 0;
+    }
+    else if(m_d > m_Density + margin)
+    {
+      WayPoint pm = originalPath.at(m_si);
+      pm.pos = ps;
+      const int nPoints = m_d / m_Density;
+      for(int k = 0; k < nPoints; k++)
+      {
+        pm.pos.x = pm.pos.x + m_Density * cos(a);
+        pm.pos.y = pm.pos.y + m_Density * sin(a);
+        m_Resampled.push_back(pm);
+      }
+      m_Remaining = m_d - nPoints*m_Density;
+      m_si++;
+      m_StartPos = pm.pos;
+      m_d = 0;
+    }
+    else
+    {
+      m_d = 0;
+      m_Remaining = 0;
+      m_Resampled.push_back(originalPath.at(m_ei));
+      m_si = m_ei;
+      m_StartPos = originalPath.at(m_si).pos;
+    }
+  }
+
+  m_ei++;
+  m_bFinished = m_ei >= originalPath.size();
+  return true;
+}
+
+void PathHorizon::UpdateAngleAndCost(const unsigned int& first_new)
+{
+  //CalcAngleAndCost of the new points, and of the two before them that see a new next point
+  const int n = m_Resampled.size();
+  if(n < 2 || first_new >= (unsigned int)n) return;
+
+  m_nAddedPoints += n - first_new;
+  const int j_angle = first_new >= 2 ? first_new - 2 : 0;
+  for(int j = j_angle; j < n-1; j++)
+  {
+    m_Resampled[j].pos.a = UtilityHNS::PlannerAngle::FixNegativeAngle(UtilityHNS::PlannerAngle::Atan2(
+        m_Resampled[j+1].pos.y - m_Resampled[j].pos.y, m_Resampled[j+1].pos.x - m_Resampled[j].pos.x));
+  }
+  m_Resampled[n-1].pos.a = m_Resampled[n-2].pos.a;
+
+  for(int j = first_new > 0 ? first_new : 1; j < n; j++)
+    m_Resampled[j].cost = m_Resampled[j-1].cost + distance2points(m_Resampled[j-1].pos, m_Resampled[j].pos);
+
+  for(int j = j_angle; j < n-1; j++)
+  {
+    if(m_Resampled.at(j).pos.x == m_Resampled.at(j+1).pos.x && m_Resampled.at(j).pos.y == m_Resampled.at(j+1).pos.y)
+      m_Resampled.at(j).pos.a = m_Resampled.at(j+1).pos.a;
+  }
+}
+
+bool PathHorizon::Extract(const std::vector<WayPoint>& originalPath, const WayPoint& pos, const double& minDistance,
+    const double& pathDensity, PathView& view)
+{
+  view = PathView();
+  if(originalPath.size() < 2) return false;
+
+  int close_index = -1;
+  if(IsResampledFor(originalPath, pathDensity) && m_Resampled.size() > 1)
+  {
+    close_index = PlanningHelpers::GetClosestNextPointIndexDirectionFast(m_Resampled, pos);
+    //the car left the resampled part, behind it or beyond its end
+    const bool bAtPathStart = m_iResampleStart == 0 && m_Resampled.front().cost == 0;
+    if((close_index == 0 && !bAtPathStart) || (close_index + 1 >= (int)m_Resampled.size() && !m_bFinished))
+      close_index = -1;
+  }
+
+  if(close_index < 0)
+  {
+    const double behind = Restart(originalPath, pos, pathDensity);
+    while(!m_bFinished && m_Resampled.back().cost <= behind + minDistance)
+    {
+      const unsigned int first_new = m_Resampled.size();
+      if(ResampleNextPoint(originalPath))
+        UpdateAngleAndCost(first_new);
+    }
+    close_index = PlanningHelpers::GetClosestNextPointIndexDirectionFast(m_Resampled, pos);
+  }
+
+  //extended up to the first point beyond minDistance from the closest point
+  while(!m_bFinished && m_Resampled.back().cost - m_Resampled.at(close_index).cost <= minDistance)
+  {
+    const unsigned int first_new = m_Resampled.size();
+    if(ResampleNextPoint(originalPath))
+      UpdateAngleAndCost(first_new);
+  }
+
+  if(m_Resampled.size() < 2)
+  {
+    view = PathView(m_Resampled, 0, m_Resampled.size());
+    return true;
+  }
+
+  if(close_index + 1 >= (int)m_Resampled.size())
+    close_index = m_Resampled.size() - 2;
+
+  int start_index = 0;
+  for(int i = close_index; i >= 0; i--)
+  {
+    start_index = i;
+    if(m_Resampled.at(close_index+1).cost - m_Resampled.at(i).cost > 10)
+      break;
+  }
+
+  int end_index = close_index;
+  for(int i = close_index+1; i < (int)m_Resampled.size(); i++)
+  {
+    end_index = i;
+    if(m_Resampled.at(i).cost - m_Resampled.at(close_index).cost > minDistance)
+      break;
+  }
+
+  //moving the points is amortized over DROP_POINTS_COUNT cycles, the vector keeps its memory
+  if(start_index >= (int)DROP_POINTS_COUNT)
+  {
+    m_Resampled.erase(m_Resampled.begin(), m_Resampled.begin() + start_index);
+    end_index -= start_index;
+    start_index = 0;
+  }
+
+  view = PathView(m_Resampled, start_index, end_index - start_index + 1);
+  return true;
+}
+
+} /* namespace PlannerHNS */
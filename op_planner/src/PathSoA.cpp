@@ -0,0 +1,75 @@
+/// \file PathSoA.cpp
+/// \brief Compact structure of arrays copy of a WayPoint path (x, y, yaw, v, s, time), for the roll out and cost evaluation loops
+/// \date Oct 14, 2026
+
+#include "op_planner/PathSoA.h"
+#include <math.h>
+
+namespace PlannerHNS
+{
+
+PathSoA::PathSoA()
+{
+}
+
+PathSoA::PathSoA(const std::vector<WayPoint>& path)
+{
+  Assign(path);
+}
+
+PathSoA::~PathSoA()
+{
+}
+
+void PathSoA::Clear()
+{
+  x.clear();
+  y.clear();
+  yaw.clear();
+  v.clear();
+  s.clear();
+  t.clear();
+}
+
+void PathSoA::Reserve(const unsigned int& n)
+{
+  x.reserve(n);
+  y.reserve(n);
+  yaw.reserve(n);
+  v.reserve(n);
+  s.reserve(n);
+  t.reserve(n);
+}
+
+void PathSoA::PushBack(const WayPoint& wp)
+{
+  if(x.size() == 0)
+    s.push_back(0);
+  else
+    s.push_back(s.back() + hypot(wp.pos.y - y.back(), wp.pos.x - x.back()));
+
+  x.push_back(wp.pos.x);
+  y.push_back(wp.pos.y);
+  yaw.push_back(wp.pos.a);
+  v.push_back(wp.v);
+  t.push_back(wp.timeCost);
+}
+
+void PathSoA::Assign(const std::vector<WayPoint>& path)
+{
+  Clear();
+  Reserve(path.size());
+  for(unsigned int i = 0; i < path.size(); i++)
+    PushBack(path.at(i));
+}
+
+WayPoint PathSoA::GetWayPoint(const unsigned int& i) const
+{
+  WayPoint wp(x.at(i), y.at(i), 0, yaw.at(i));
+  wp.v = v.at(i);
+  wp.cost = s.at(i);
+  wp.timeCost = t.at(i);
+  return wp;
+}
+
+} /* namespace PlannerHNS */
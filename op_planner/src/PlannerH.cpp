@@ -15,6 +15,8 @@ namespace PlannerHNS
 {
 PlannerH::PlannerH()
 {
+  m_SearchType = DP_SEARCH_TREE;
+  m_bLaneGraphRouting = false;
   //m_Params = params;
 }
 
@@ -62,6 +64,49 @@ void PlannerH::GenerateRunoffTrajectory(const std::vector<std::vector<WayPoint>
   }
 }
 
+void PlannerH::GenerateRunoffTrajectory(const std::vector<std::vector<WayPoint> >& referencePaths,const WayPoint& carPos, const bool& bEnableLaneChange, const double& speed, const double& microPlanDistance,
+    const double& maxSpeed,const double& minSpeed, const double&  carTipMargin, const double& rollInMargin,
+    const double& rollInSpeedFactor, const double& pathDensity, const double& rollOutDensity,
+    const int& rollOutNumber, const double& SmoothDataWeight, const double& SmoothWeight,
+    const double& SmoothTolerance, const double& speedProfileFactor, const bool& bHeadingSmooth,
+    const int& iCurrGlobalPath, const int& iCurrLocalTraj,
+    std::vector<std::vector<std::vector<WayPoint> > >& rollOutsPaths,
+    std::vector<RollOutsCache>& caches,
+    std::vector<WayPoint>& sampledPoints_debug)
+{
+  if(referencePaths.size()==0) return;
+  if(microPlanDistance <=0 ) return;
+  rollOutsPaths.resize(referencePaths.size());
+
+  //a different number of reference paths is a new global path
+  if(caches.size() != referencePaths.size())
+  {
+    caches.clear();
+    caches.resize(referencePaths.size());
+  }
+
+  sampledPoints_debug.clear(); //for visualization only
+
+  for(unsigned int i = 0; i < referencePaths.size(); i++)
+  {
+    int s_index = 0, e_index = 0;
+    vector<double> e_distances;
+    if(referencePaths.at(i).size()>0)
+    {
+      PlanningHelpers::CalculateRollInTrajectories(carPos, speed, referencePaths.at(i), s_index, e_index, e_distances,
+          rollOutsPaths.at(i), microPlanDistance, maxSpeed, carTipMargin, rollInMargin,
+          rollInSpeedFactor, pathDensity, rollOutDensity,rollOutNumber,
+          SmoothDataWeight, SmoothWeight, SmoothTolerance, bHeadingSmooth, caches.at(i), sampledPoints_debug);
+    }
+    else
+    {
+      caches.at(i).Reset();
+      rollOutsPaths.at(i).clear();
+      rollOutsPaths.at(i).resize(rollOutNumber+1);
+    }
+  }
+}
+
 double PlannerH::PlanUsingDPRandom(const WayPoint& start,
     const double& maxPlanningDistance,
     RoadNetwork& map,
@@ -100,7 +145,8 @@ double PlannerH::PlanUsingDPRandom(const WayPoint& start,
 
   vector<WayPoint*> local_cell_to_delete;
   WayPoint* pLaneCell = 0;
-  pLaneCell =  PlanningHelpers::BuildPlanningSearchTreeStraight(pStart, maxPlanningDistance, local_cell_to_delete);
+  m_SearchArena.Reset();
+  pLaneCell =  PlanningHelpers::BuildPlanningSearchTreeStraight(pStart, maxPlanningDistance, local_cell_to_delete, &m_SearchArena);
 
   if(!pLaneCell)
   {
@@ -123,14 +169,9 @@ double PlannerH::PlanUsingDPRandom(const WayPoint& start,
   if(path.size()<2)
   {
     cout << endl << "Err: PlannerH -> Invalid Path, Car Should Stop." << endl;
-    if(pLaneCell)
-      DeleteWaypoints(local_cell_to_delete);
     return 0 ;
   }
 
-  if(pLaneCell)
-    DeleteWaypoints(local_cell_to_delete);
-
   double totalPlanningDistance = path.at(path.size()-1).cost;
   return totalPlanningDistance;
 }
@@ -140,13 +181,13 @@ double PlannerH::PlanUsingDP(const WayPoint& start,
     const double& maxPlanningDistance,
     const bool bEnableLaneChange,
     const std::vector<int>& globalPath,
-    RoadNetwork& map,
+    const RoadNetwork& map,
     std::vector<std::vector<WayPoint> >& paths,
     vector<WayPoint*>* all_cell_to_delete,
     double fallback_min_goal_distance_th)
 {
-  PlannerHNS::WayPoint* pStart = PlannerHNS::MappingHelpers::GetClosestWaypointFromMap(start, map);
-  PlannerHNS::WayPoint* pGoal = PlannerHNS::MappingHelpers::GetClosestWaypointFromMap(goalPos, map);
+  const PlannerHNS::WayPoint* pStart = PlannerHNS::MappingHelpers::GetClosestWaypointFromMap(start, map);
+  const PlannerHNS::WayPoint* pGoal = PlannerHNS::MappingHelpers::GetClosestWaypointFromMap(goalPos, map);
   bool bEnableGoalBranching = false;
 
   if(!pStart ||  !pGoal)
@@ -205,11 +246,189 @@ double PlannerH::PlanUsingDP(const WayPoint& start,
     }
   }
 
+  double totalPlanningDistance = 0;
+  bool bUseCache = !all_cell_to_delete && m_RouteCache.GetCapacity() > 0 && map.version > 0;
+  RouteCacheKey cache_key;
+  if(bUseCache)
+  {
+    cache_key.pMap = &map;
+    cache_key.mapVersion = map.version;
+    cache_key.startLaneId = pStart->laneId;
+    cache_key.startWaypointId = pStart->id;
+    cache_key.goalLaneId = pGoal->laneId;
+    cache_key.goalWaypointId = pGoal->id;
+    cache_key.maxPlanningDistance = maxPlanningDistance;
+    cache_key.bEnableLaneChange = bEnableLaneChange;
+    cache_key.searchType = m_SearchType;
+    cache_key.fallbackGoalDistance = fallback_min_goal_distance_th;
+    cache_key.globalPath = globalPath;
+  }
+
+  if(bUseCache && m_RouteCache.Find(cache_key, paths, totalPlanningDistance))
+  {
+    cout << endl <<"Info: PlannerH -> Plan From Cache, MultiPaths No(" << paths.size() << ")" << endl;
+  }
+  else
+  {
+    //lane level route from the hierarchy or the lane graph first, the waypoint search is then limited to its lanes
+    bool bFound = false;
+    if(globalPath.size() == 0 && m_LaneHierarchy.IsLaneChangeEnabled() == bEnableLaneChange && m_LaneHierarchy.IsBuiltFor(map))
+    {
+      vector<int> route_lanes;
+      double route_cost = 0;
+      if(m_LaneHierarchy.GetLaneRoute(pStart->pLane->id, pGoal->pLane->id, route_lanes, route_cost))
+        bFound = SearchGlobalRoute(pStart, pGoal, maxPlanningDistance, bEnableLaneChange, route_lanes, paths, totalPlanningDistance, all_cell_to_delete, fallback_min_goal_distance_th, false);
+
+      if(!bFound)
+        cout << endl << "Info: PlannerH -> Lane hierarchy route failed, searching the whole map." << endl;
+    }
+    else if(globalPath.size() == 0 && m_bLaneGraphRouting)
+    {
+      if(m_LaneGraph.IsLaneChangeEnabled() != bEnableLaneChange || !m_LaneGraph.IsBuiltFor(map))
+        m_LaneGraph.Build(map, bEnableLaneChange);
+
+      vector<int> route_lanes;
+      double route_cost = 0;
+      if(m_LaneGraph.GetLaneRoute(pStart->pLane->id, pGoal->pLane->id, route_lanes, route_cost))
+        bFound = SearchGlobalRoute(pStart, pGoal, maxPlanningDistance, bEnableLaneChange, route_lanes, paths, totalPlanningDistance, all_cell_to_delete, fallback_min_goal_distance_th, false);
+
+      if(!bFound)
+        cout << endl << "Info: PlannerH -> Lane graph route failed, searching the whole map." << endl;
+    }
+
+    if(!bFound && !SearchGlobalRoute(pStart, pGoal, maxPlanningDistance, bEnableLaneChange, globalPath, paths, totalPlanningDistance, all_cell_to_delete, fallback_min_goal_distance_th))
+      return 0;
+
+    if(bUseCache && totalPlanningDistance > 0)
+      m_RouteCache.Insert(cache_key, paths, totalPlanningDistance);
+  }
+
+  //attach start path to beginning of all paths, but goal path to only the path connected to the goal path.
+  for(unsigned int i=0; i< paths.size(); i++ )
+  {
+    paths.at(i).insert(paths.at(i).begin(), start_path.begin(), start_path.end());
+    if(paths.at(i).size() > 0)
+    {
+      //if(hypot(paths.at(i).at(paths.at(i).size()-1).pos.y-goal_info.perp_point.pos.y, paths.at(i).at(paths.at(i).size()-1).pos.x-goal_info.perp_point.pos.x) < 1.5)
+      {
+
+        if(paths.at(i).size() > 0 && goal_path.size() > 0)
+        {
+          goal_path.insert(goal_path.begin(), paths.at(i).end()-5, paths.at(i).end());
+          PlanningHelpers::SmoothPath(goal_path, 0.25, 0.25);
+          PlanningHelpers::FixPathDensity(goal_path, 0.75);
+          PlanningHelpers::SmoothPath(goal_path, 0.25, 0.35);
+          paths.at(i).erase(paths.at(i).end()-5, paths.at(i).end());
+          paths.at(i).insert(paths.at(i).end(), goal_path.begin(), goal_path.end());
+        }
+      }
+    }
+  }
+
+  return totalPlanningDistance;
+}
+
+int PlannerH::PlanUsingDPMultiGoal(const WayPoint& start,
+    const std::vector<WayPoint>& goals,
+    const double& maxPlanningDistance,
+    const bool bEnableLaneChange,
+    const std::vector<int>& globalPath,
+    const RoadNetwork& map,
+    std::vector<std::vector<std::vector<WayPoint> > >& paths,
+    std::vector<double>& costs)
+{
+  paths.assign(goals.size(), vector<vector<WayPoint> >());
+  costs.assign(goals.size(), 0);
+
+  const PlannerHNS::WayPoint* pStart = PlannerHNS::MappingHelpers::GetClosestWaypointFromMap(start, map);
+  if(!pStart || !pStart->pLane)
+  {
+    GPSPoint sp = start.pos;
+    cout << endl << "Error: PlannerH -> Can't Find Global Waypoint Node in the Map for Start (" << sp.ToString() << ")" << endl;
+    return 0;
+  }
+
+  RelativeInfo start_info;
+  if(!PlanningHelpers::GetRelativeInfo(pStart->pLane->points, start, start_info) || fabs(start_info.perp_distance) > START_POINT_MAX_DISTANCE)
+  {
+    cout << endl << "Error: PlannerH -> Start Distance to Lane is: " << start_info.perp_distance
+        << ", LaneID: " << pStart->pLane->id << " -> Check origin and vector map. " << endl;
+    return 0;
+  }
+
+  //the search looks for the map waypoints of the goals, like PlanUsingDP
+  vector<WayPoint> search_goals;
+  vector<int> goal_indices;
+  for(unsigned int ig = 0; ig < goals.size(); ig++)
+  {
+    const PlannerHNS::WayPoint* pGoal = PlannerHNS::MappingHelpers::GetClosestWaypointFromMap(goals.at(ig), map);
+    RelativeInfo goal_info;
+    if(!pGoal || !pGoal->pLane || !PlanningHelpers::GetRelativeInfo(pGoal->pLane->points, goals.at(ig), goal_info)
+        || fabs(goal_info.perp_distance) > GOAL_POINT_MAX_DISTANCE)
+    {
+      GPSPoint gp = goals.at(ig).pos;
+      cout << endl << "Error: PlannerH -> Can't Find Global Waypoint Node in the Map for Goal (" << gp.ToString() << ")" << endl;
+      continue;
+    }
+
+    search_goals.push_back(*pGoal);
+    goal_indices.push_back(ig);
+  }
+
+  vector<WayPoint*> local_cell_to_delete, goal_cells;
+  m_SearchArena.Reset();
+  PlanningHelpers::BuildPlanningSearchTreeMultiGoal(pStart, search_goals, globalPath, maxPlanningDistance,
+      bEnableLaneChange, local_cell_to_delete, goal_cells, &m_SearchArena);
+
+  int nRoutes = 0;
+  for(unsigned int i = 0; i < goal_cells.size(); i++)
+  {
+    if(!goal_cells.at(i)) continue;
+
+    vector<WayPoint> path;
+    vector<vector<WayPoint> > tempCurrentForwardPathss;
+    PlanningHelpers::TraversePathTreeBackwards(goal_cells.at(i), pStart, globalPath, path, tempCurrentForwardPathss);
+    if(path.size() < 2) continue;
+
+    int ig = goal_indices.at(i);
+    PlanningHelpers::ExtractPlanAlernatives(path, paths.at(ig));
+    costs.at(ig) = path.at(path.size()-1).cost;
+    nRoutes++;
+  }
+
+  cout << endl <<"Info: PlannerH -> Multi Goal Plan, Routes (" << nRoutes << ") of Goals (" << goals.size() << "), Search Nodes (" << local_cell_to_delete.size() << ")" << endl;
+  return nRoutes;
+}
+
+bool PlannerH::SearchGlobalRoute(const WayPoint* pStart, const WayPoint* pGoal,
+    const double& maxPlanningDistance,
+    const bool bEnableLaneChange,
+    const std::vector<int>& globalPath,
+    std::vector<std::vector<WayPoint> >& paths,
+    double& totalPlanningDistance,
+    vector<WayPoint*>* all_cell_to_delete,
+    double fallback_min_goal_distance_th, const bool& bUseBackupPlan)
+{
   vector<WayPoint*> local_cell_to_delete;
   WayPoint* pLaneCell = 0;
   char bPlan = 'A';
 
-  if(all_cell_to_delete)
+  //the caller deletes the nodes it asked for, otherwise they come from the search arena
+  m_SearchArena.Reset();
+  if(m_SearchType == ASTAR_SEARCH_TREE)
+  {
+    if(all_cell_to_delete)
+      pLaneCell =  PlanningHelpers::BuildPlanningSearchTreeAStar(pStart,
+                                        *pGoal, globalPath, maxPlanningDistance,
+                                        bEnableLaneChange, *all_cell_to_delete,
+                                        fallback_min_goal_distance_th);
+    else
+      pLaneCell =  PlanningHelpers::BuildPlanningSearchTreeAStar(pStart,
+                                        *pGoal, globalPath, maxPlanningDistance,
+                                        bEnableLaneChange, local_cell_to_delete,
+                                        fallback_min_goal_distance_th, &m_SearchArena);
+  }
+  else if(all_cell_to_delete)
     pLaneCell =  PlanningHelpers::BuildPlanningSearchTreeV2(pStart,
                                       *pGoal, globalPath, maxPlanningDistance,
                                       bEnableLaneChange, *all_cell_to_delete,
@@ -218,7 +437,10 @@ double PlannerH::PlanUsingDP(const WayPoint& start,
     pLaneCell =  PlanningHelpers::BuildPlanningSearchTreeV2(pStart,
                                       *pGoal, globalPath, maxPlanningDistance,
                                       bEnableLaneChange, local_cell_to_delete,
-                                      fallback_min_goal_distance_th);
+                                      fallback_min_goal_distance_th, &m_SearchArena);
+
+  if(!pLaneCell && !bUseBackupPlan)
+    return false;
 
   if(!pLaneCell)
   {
@@ -228,20 +450,20 @@ double PlannerH::PlanUsingDP(const WayPoint& start,
     if(all_cell_to_delete)
       pLaneCell =  PlanningHelpers::BuildPlanningSearchTreeStraight(pStart, BACKUP_STRAIGHT_PLAN_DISTANCE, *all_cell_to_delete);
     else
-      pLaneCell =  PlanningHelpers::BuildPlanningSearchTreeStraight(pStart, BACKUP_STRAIGHT_PLAN_DISTANCE, local_cell_to_delete);
+      pLaneCell =  PlanningHelpers::BuildPlanningSearchTreeStraight(pStart, BACKUP_STRAIGHT_PLAN_DISTANCE, local_cell_to_delete, &m_SearchArena);
 
     if(!pLaneCell)
     {
       bPlan = 'Z';
       cout << endl << "PlannerH -> Plan (B) Failed, Sorry we Don't have plan (C) This is the END." << endl;
-      return 0;
+      return false;
     }
   }
 
   vector<WayPoint> path;
   vector<vector<WayPoint> > tempCurrentForwardPathss;
   PlanningHelpers::TraversePathTreeBackwards(pLaneCell, pStart, globalPath, path, tempCurrentForwardPathss);
-  if(path.size()==0) return 0;
+  if(path.size()==0) return false;
 
   paths.clear();
 
@@ -254,44 +476,18 @@ double PlannerH::PlanUsingDP(const WayPoint& start,
     paths.push_back(path);
   }
 
-  //attach start path to beginning of all paths, but goal path to only the path connected to the goal path.
-  for(unsigned int i=0; i< paths.size(); i++ )
-  {
-    paths.at(i).insert(paths.at(i).begin(), start_path.begin(), start_path.end());
-    if(paths.at(i).size() > 0)
-    {
-      //if(hypot(paths.at(i).at(paths.at(i).size()-1).pos.y-goal_info.perp_point.pos.y, paths.at(i).at(paths.at(i).size()-1).pos.x-goal_info.perp_point.pos.x) < 1.5)
-      {
-
-        if(paths.at(i).size() > 0 && goal_path.size() > 0)
-        {
-          goal_path.insert(goal_path.begin(), paths.at(i).end()-5, paths.at(i).end());
-          PlanningHelpers::SmoothPath(goal_path, 0.25, 0.25);
-          PlanningHelpers::FixPathDensity(goal_path, 0.75);
-          PlanningHelpers::SmoothPath(goal_path, 0.25, 0.35);
-          paths.at(i).erase(paths.at(i).end()-5, paths.at(i).end());
-          paths.at(i).insert(paths.at(i).end(), goal_path.begin(), goal_path.end());
-        }
-      }
-    }
-  }
-
   cout << endl <<"Info: PlannerH -> Plan (" << bPlan << ") Path With Size (" << (int)path.size() << "), MultiPaths No(" << paths.size() << ") Extraction Time : " << endl;
 
 
   if(path.size()<2)
   {
     cout << endl << "Err: PlannerH -> Invalid Path, Car Should Stop." << endl;
-    if(pLaneCell && !all_cell_to_delete)
-      DeleteWaypoints(local_cell_to_delete);
-    return 0 ;
+    totalPlanningDistance = 0;
+    return true;
   }
 
-  if(pLaneCell && !all_cell_to_delete)
-    DeleteWaypoints(local_cell_to_delete);
-
-  double totalPlanningDistance = path.at(path.size()-1).cost;
-  return totalPlanningDistance;
+  totalPlanningDistance = path.at(path.size()-1).cost;
+  return true;
 }
 
 double PlannerH::PredictPlanUsingDP(PlannerHNS::Lane* l, const WayPoint& start, const double& maxPlanningDistance, std::vector<std::vector<WayPoint> >& paths)
@@ -321,7 +517,8 @@ double PlannerH::PredictPlanUsingDP(PlannerHNS::Lane* l, const WayPoint& start,
   }
 
   vector<WayPoint*> pLaneCells;
-  int nPaths =  PlanningHelpers::PredictiveDP(pStartWP, maxPlanningDistance, all_cell_to_delete, pLaneCells);
+  m_SearchArena.Reset();
+  int nPaths =  PlanningHelpers::PredictiveDP(pStartWP, maxPlanningDistance, all_cell_to_delete, pLaneCells, &m_SearchArena);
 
   if(nPaths==0)
   {
@@ -344,12 +541,10 @@ double PlannerH::PredictPlanUsingDP(PlannerHNS::Lane* l, const WayPoint& start,
     paths.push_back(path);
   }
 
-  DeleteWaypoints(all_cell_to_delete);
-
   return totalPlanDistance;
 }
 
-double PlannerH::PredictTrajectoriesUsingDP(const WayPoint& startPose, std::vector<WayPoint*> closestWPs, const double& maxPlanningDistance, std::vector<std::vector<WayPoint> >& paths, const bool& bFindBranches , const bool bDirectionBased, const bool pathDensity)
+double PlannerH::PredictTrajectoriesUsingDP(const WayPoint& startPose, const std::vector<const WayPoint*>& closestWPs, const double& maxPlanningDistance, std::vector<std::vector<WayPoint> >& paths, const bool& bFindBranches , const bool bDirectionBased, const bool pathDensity)
 {
   vector<vector<WayPoint> > tempCurrentForwardPathss;
   vector<WayPoint*> all_cell_to_delete;
@@ -358,10 +553,11 @@ double PlannerH::PredictTrajectoriesUsingDP(const WayPoint& startPose, std::vect
   vector<WayPoint*> pLaneCells;
   vector<int> unique_lanes;
   std::vector<WayPoint> path;
+  m_SearchArena.Reset();
   for(unsigned int j = 0 ; j < closestWPs.size(); j++)
   {
     pLaneCells.clear();
-    int nPaths =  PlanningHelpers::PredictiveIgnorIdsDP(closestWPs.at(j), maxPlanningDistance, all_cell_to_delete, pLaneCells, unique_lanes);
+    int nPaths =  PlanningHelpers::PredictiveIgnorIdsDP(closestWPs.at(j), maxPlanningDistance, all_cell_to_delete, pLaneCells, unique_lanes, &m_SearchArena);
     for(unsigned int i = 0; i< pLaneCells.size(); i++)
     {
       path.clear();
@@ -431,8 +627,6 @@ double PlannerH::PredictTrajectoriesUsingDP(const WayPoint& startPose, std::vect
     paths.push_back(r_branch);
   }
 
-  DeleteWaypoints(all_cell_to_delete);
-
   return paths.size();
 }
 
@@ -449,7 +643,8 @@ double PlannerH::PredictPlanUsingDP(const WayPoint& startPose, WayPoint* closest
   vector<int> globalPath;
 
   vector<WayPoint*> pLaneCells;
-  int nPaths =  PlanningHelpers::PredictiveDP(closestWP, maxPlanningDistance, all_cell_to_delete, pLaneCells);
+  m_SearchArena.Reset();
+  int nPaths =  PlanningHelpers::PredictiveDP(closestWP, maxPlanningDistance, all_cell_to_delete, pLaneCells, &m_SearchArena);
 
   if(nPaths==0)
   {
@@ -490,8 +685,6 @@ double PlannerH::PredictPlanUsingDP(const WayPoint& startPose, WayPoint* closest
     }
   }
 
-  DeleteWaypoints(all_cell_to_delete);
-
   return totalPlanDistance;
 }
 
@@ -0,0 +1,338 @@
+/// \file PlanningBenchmark.cpp
+/// \brief Replay of a recorded scenario through the planning modules with per stage latency percentiles, no ROS node needed
+/// \date Oct 14, 2026
+
+#include "op_planner/PlanningBenchmark.h"
+#include "op_planner/DecisionMaker.h"
+#include "op_planner/TrajectoryDynamicCosts.h"
+#include "op_planner/BehaviorPrediction.h" // includes PlannerH.h, which has no include guard
+#include "op_planner/MappingHelpers.h"
+#include "op_planner/PlanningHelpers.h"
+#include "op_planner/PolygonGeometry.h"
+#include "op_planner/RoadNetworkSnapshot.h"
+#include "op_utility/DataRW.h"
+#include "op_utility/UtilityH.h"
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+
+namespace PlannerHNS
+{
+
+static const char* BENCHMARK_STAGE_NAMES[BENCH_STAGES_COUNT] = {"GlobalPlan", "Prediction", "RollOuts", "TrajectoryCosts", "Decision", "Cycle"};
+
+static bool FileExists(const std::string& fileName)
+{
+  std::ifstream f(fileName.c_str());
+  return f.good();
+}
+
+static void SetObjectContour(DetectedObject& obj)
+{
+  PolygonGeometry::GetOrientedRectangle(obj.center.pos, obj.w, obj.l, obj.center.pos.z, obj.contour);
+}
+
+bool PlanningScenario::LoadFromFolder(const std::string& folder)
+{
+  map = RoadNetwork();
+  egoTrajectory.clear();
+  objectFrames.clear();
+
+  if(FileExists(folder + "map.snapshot"))
+  {
+    if(!RoadNetworkSnapshot::LoadFromFile(folder + "map.snapshot", 0, map))
+      return false;
+  }
+  else if(FileExists(folder + "map.kml"))
+    MappingHelpers::LoadKML(folder + "map.kml", map);
+  else
+    MappingHelpers::ConstructRoadNetworkFromDataFiles(folder, map, false, false);
+
+  if(map.roadSegments.size() == 0 || !FileExists(folder + "ego.csv"))
+    return false;
+
+  UtilityHNS::LocalizationPathReader ego_reader(folder + "ego.csv", ',');
+  std::vector<UtilityHNS::LocalizationPathReader::LocalizationWayPoint> ego_list;
+  ego_reader.ReadAllData(ego_list);
+  for(unsigned int i = 0; i < ego_list.size(); i++)
+  {
+    WayPoint wp(ego_list.at(i).x, ego_list.at(i).y, ego_list.at(i).z, ego_list.at(i).a);
+    wp.v = ego_list.at(i).v;
+    egoTrajectory.push_back(wp);
+  }
+  objectFrames.resize(egoTrajectory.size());
+
+  if(FileExists(folder + "objects.csv"))
+  {
+    UtilityHNS::ObjectsLogReader objects_reader(folder + "objects.csv");
+    std::vector<UtilityHNS::ObjectsLogReader::ObjectRecord> objects_list;
+    objects_reader.ReadAllData(objects_list);
+    for(unsigned int i = 0; i < objects_list.size(); i++)
+    {
+      const UtilityHNS::ObjectsLogReader::ObjectRecord& r = objects_list.at(i);
+      if(r.frame < 0 || r.frame >= (int)objectFrames.size())
+        continue;
+
+      DetectedObject obj;
+      obj.id = r.id;
+      obj.t = CAR;
+      obj.center = WayPoint(r.x, r.y, r.z, r.a);
+      obj.center.v = r.v;
+      obj.w = r.w;
+      obj.l = r.l;
+      obj.h = r.h;
+      obj.bDirection = true;
+      obj.bVelocity = true;
+      SetObjectContour(obj);
+      objectFrames.at(r.frame).push_back(obj);
+    }
+  }
+
+  return egoTrajectory.size() > 1;
+}
+
+bool PlanningScenario::SaveToFolder(const std::string& folder) const
+{
+  if(!RoadNetworkSnapshot::SaveToFile(folder + "map.snapshot", map, 0))
+    return false;
+
+  std::ofstream ego_file((folder + "ego.csv").c_str());
+  if(!ego_file.is_open())
+    return false;
+  ego_file << std::setprecision(12) << "x,y,z,a,v\r\n";
+  for(unsigned int i = 0; i < egoTrajectory.size(); i++)
+  {
+    const WayPoint& wp = egoTrajectory.at(i);
+    ego_file << wp.pos.x << "," << wp.pos.y << "," << wp.pos.z << "," << wp.pos.a << "," << wp.v << "\r\n";
+  }
+  ego_file.close();
+
+  std::ofstream objects_file((folder + "objects.csv").c_str());
+  if(!objects_file.is_open())
+    return false;
+  objects_file << std::setprecision(12) << "frame,id,x,y,z,a,v,w,l,h\r\n";
+  for(unsigned int i = 0; i < objectFrames.size(); i++)
+  {
+    for(unsigned int j = 0; j < objectFrames.at(i).size(); j++)
+    {
+      const DetectedObject& obj = objectFrames.at(i).at(j);
+      objects_file << i << "," << obj.id << "," << obj.center.pos.x << "," << obj.center.pos.y << "," << obj.center.pos.z << ","
+          << obj.center.pos.a << "," << obj.center.v << "," << obj.w << "," << obj.l << "," << obj.h << "\r\n";
+    }
+  }
+  objects_file.close();
+
+  return true;
+}
+
+void PlanningScenario::CreateSynthetic(const int& nLanes, const double& length, const int& nObjects, const double& speed,
+    const double& dt, PlanningScenario& scenario)
+{
+  scenario.map = RoadNetwork();
+  scenario.egoTrajectory.clear();
+  scenario.objectFrames.clear();
+
+  RoadSegment segment;
+  segment.id = 1;
+  int point_id = 1;
+  for(int r = 0; r < nLanes; r++)
+  {
+    Lane l;
+    l.id = r + 1;
+    for(int p = 0; p <= length; p++)
+    {
+      WayPoint wp(p, r * 3.5, 0, 0);
+      wp.id = point_id++;
+      wp.laneId = l.id;
+      wp.v = speed;
+      l.points.push_back(wp);
+    }
+    PlanningHelpers::FixAngleOnly(l.points);
+    segment.Lanes.push_back(l);
+  }
+  scenario.map.roadSegments.push_back(segment);
+
+  MappingHelpers::LinkLanesPointers(scenario.map);
+  MappingHelpers::LinkMissingBranchingWayPointsV2(scenario.map);
+  MappingHelpers::FindAdjacentLanesV2(scenario.map, 1);
+  scenario.map.spatialIndex.Build(scenario.map.roadSegments);
+  MappingHelpers::UpdateMapVersion(scenario.map);
+
+  // the ego stops 20 meters before the end of its lane, slightly off the center line like a localized pose,
+  // the objects start ahead of it on the other lanes
+  int nFrames = (length - 40) / (speed * dt);
+  for(int i = 0; i < nFrames; i++)
+  {
+    WayPoint pose(5 + i * speed * dt, 0.2, 0, 0);
+    pose.v = speed;
+    scenario.egoTrajectory.push_back(pose);
+
+    std::vector<DetectedObject> objects;
+    for(int k = 0; k < nObjects; k++)
+    {
+      DetectedObject obj;
+      obj.id = k + 1;
+      obj.t = CAR;
+      obj.w = 1.8;
+      obj.l = 4.2;
+      obj.h = 1.5;
+      double obj_speed = speed * (0.5 + 0.25 * (k % 3));
+      double x = fmod(15 + k * 12 + i * obj_speed * dt, length);
+      obj.center = WayPoint(x, (nLanes > 1 ? (1 + k % (nLanes - 1)) : 0) * 3.5, 0, 0);
+      obj.center.v = obj_speed;
+      obj.bDirection = true;
+      obj.bVelocity = true;
+      SetObjectContour(obj);
+      objects.push_back(obj);
+    }
+    scenario.objectFrames.push_back(objects);
+  }
+}
+
+PlanningBenchmark::PlanningBenchmark()
+{
+  m_nRepeats = 1;
+  m_nThreads = 1;
+  m_FrameTime = 0.1;
+
+  m_Params.maxSpeed = 10;
+  m_Params.minSpeed = 0.2;
+  m_Params.rollOutNumber = 6;
+  m_Params.microPlanDistance = 50;
+  m_Params.horizonDistance = 120;
+  m_Params.pathDensity = 0.5;
+  m_Params.horizontalSafetyDistancel = 0.5;
+  m_Params.verticalSafetyDistance = 0.5;
+  m_Params.enableFollowing = true;
+  m_Params.enableSwerving = true;
+
+  m_CarInfo.max_speed_forward = m_Params.maxSpeed;
+  m_CarInfo.max_acceleration = 3;
+  m_CarInfo.max_deceleration = -3;
+
+  for(int i = 0; i < BENCH_STAGES_COUNT; i++)
+    m_Latency.AddStage(BENCHMARK_STAGE_NAMES[i]);
+}
+
+PlanningBenchmark::~PlanningBenchmark()
+{
+}
+
+bool PlanningBenchmark::Run(PlanningScenario& scenario)
+{
+  m_Latency.Reset();
+  if(scenario.egoTrajectory.size() < 2)
+    return false;
+
+  std::vector<TrafficLight> traffic_lights;
+  std::vector<int> global_path_ids;
+  std::vector<DetectedObject> predicted_objects;
+  std::vector<std::vector<WayPoint> > reference_paths;
+  std::vector<PathHorizon> reference_horizons;
+  PathView reference_view;
+  std::vector<std::vector<std::vector<WayPoint> > > roll_outs;
+  std::vector<WayPoint> sampled_points;
+  struct timespec t;
+
+  for(int r = 0; r < m_nRepeats; r++)
+  {
+    PlannerH planner;
+    planner.m_RouteCache.SetCapacity(0);
+    std::vector<std::vector<WayPoint> > global_paths;
+
+    UtilityHNS::UtilityH::GetTickCount(t);
+    double distance = planner.PlanUsingDP(scenario.egoTrajectory.front(), scenario.egoTrajectory.back(), m_Params.planningDistance,
+        m_Params.enableLaneChange, global_path_ids, scenario.map, global_paths);
+    m_Latency.Record(BENCH_GLOBAL_PLAN, UtilityHNS::UtilityH::GetTimeDiffNow(t));
+
+    if(distance <= 0 || global_paths.size() == 0)
+      return false;
+
+    for(unsigned int i = 0; i < global_paths.size(); i++)
+      PlanningHelpers::CalcAngleAndCost(global_paths.at(i));
+
+    BehaviorPrediction prediction;
+    prediction.m_nThreads = m_nThreads;
+    prediction.m_RandomSeed = 7;
+    TrajectoryDynamicCosts costs;
+    costs.SetNumberOfThreads(m_nThreads);
+    DecisionMaker decision_maker;
+    decision_maker.Init(m_CtrlParams, m_Params, m_CarInfo);
+    decision_maker.SetNewGlobalPath(global_paths);
+    reference_paths.resize(global_paths.size());
+    reference_horizons.assign(global_paths.size(), PathHorizon());
+
+    for(unsigned int f = 0; f < scenario.egoTrajectory.size(); f++)
+    {
+      const WayPoint& pose = scenario.egoTrajectory.at(f);
+      VehicleState vehicle_state;
+      vehicle_state.speed = pose.v;
+      struct timespec cycle_t;
+      UtilityHNS::UtilityH::GetTickCount(cycle_t);
+
+      UtilityHNS::UtilityH::GetTickCount(t);
+      prediction.DoOneStep(scenario.objectFrames.at(f), pose, m_Params.minSpeed, m_CarInfo.max_deceleration, scenario.map);
+      m_Latency.Record(BENCH_PREDICTION, UtilityHNS::UtilityH::GetTimeDiffNow(t));
+
+      predicted_objects.clear();
+      for(unsigned int i = 0; i < prediction.m_ParticleInfo_II.size(); i++)
+        predicted_objects.push_back(prediction.m_ParticleInfo_II.at(i)->obj);
+
+      UtilityHNS::UtilityH::GetTickCount(t);
+      for(unsigned int i = 0; i < global_paths.size(); i++)
+      {
+        reference_horizons.at(i).Extract(global_paths.at(i), pose, m_Params.horizonDistance, m_Params.pathDensity, reference_view);
+        reference_view.CopyTo(reference_paths.at(i));
+      }
+      planner.GenerateRunoffTrajectory(reference_paths, pose, m_Params.enableLaneChange, pose.v, m_Params.microPlanDistance,
+          m_Params.maxSpeed, m_Params.minSpeed, m_Params.carTipMargin, m_Params.rollInMargin, m_Params.rollInSpeedFactor,
+          m_Params.pathDensity, m_Params.rollOutDensity, m_Params.rollOutNumber, m_Params.smoothingDataWeight,
+          m_Params.smoothingSmoothWeight, m_Params.smoothingToleranceError, m_Params.speedProfileFactor,
+          m_Params.enableHeadingSmoothing, -1, -1, roll_outs, sampled_points);
+      m_Latency.Record(BENCH_ROLL_OUTS, UtilityHNS::UtilityH::GetTimeDiffNow(t));
+
+      if(roll_outs.size() == 0)
+        continue;
+
+      UtilityHNS::UtilityH::GetTickCount(t);
+      TrajectoryCost tc = costs.DoOneStep(roll_outs, reference_paths, pose, m_Params.rollOutNumber/2, 0, m_Params, m_CarInfo,
+          vehicle_state, predicted_objects);
+      m_Latency.Record(BENCH_TRAJECTORY_COSTS, UtilityHNS::UtilityH::GetTimeDiffNow(t));
+
+      decision_maker.m_RollOuts = roll_outs.at(0);
+      UtilityHNS::UtilityH::GetTickCount(t);
+      decision_maker.DoOneStep(m_FrameTime, pose, vehicle_state, 1, traffic_lights, tc, false);
+      m_Latency.Record(BENCH_DECISION, UtilityHNS::UtilityH::GetTimeDiffNow(t));
+
+      m_Latency.Record(BENCH_CYCLE, UtilityHNS::UtilityH::GetTimeDiffNow(cycle_t));
+    }
+  }
+
+  return true;
+}
+
+const UtilityHNS::StageLatencyRecorder& PlanningBenchmark::GetLatency() const
+{
+  return m_Latency;
+}
+
+std::string PlanningBenchmark::GetReport() const
+{
+  std::ostringstream str;
+  str << std::fixed << std::setprecision(3);
+  for(unsigned int i = 0; i < m_Latency.GetNumberOfStages(); i++)
+  {
+    const UtilityHNS::LatencyHistogram& h = m_Latency.GetHistogram(i);
+    double throughput = h.GetMean() > 0 ? 1.0 / h.GetMean() : 0;
+    str << std::left << std::setw(16) << m_Latency.GetStageName(i) << std::right
+        << " calls: " << std::setw(7) << h.GetCount()
+        << ", calls/s: " << std::setw(11) << throughput
+        << ", p50: " << std::setw(9) << h.GetPercentile(0.5) * 1000.0
+        << ", p90: " << std::setw(9) << h.GetPercentile(0.9) * 1000.0
+        << ", p99: " << std::setw(9) << h.GetPercentile(0.99) * 1000.0
+        << ", max: " << std::setw(9) << h.GetMax() * 1000.0 << " ms\n";
+  }
+  return str.str();
+}
+
+} /* namespace PlannerHNS */
@@ -7,8 +7,14 @@
 
 #include "op_planner/PlanningHelpers.h"
 #include "op_planner/MatrixOperations.h"
+#include "op_planner/PolygonGeometry.h"
+#include "op_utility/FastAngle.h"
 #include <string>
 #include <float.h>
+#include <algorithm>
+#include <queue>
+#include <unordered_map>
+#include <unordered_set>
 
 using namespace UtilityHNS;
 using namespace std;
@@ -17,6 +23,11 @@ namespace PlannerHNS
 {
 
 std::vector<std::pair<GPSPoint, GPSPoint> > PlanningHelpers::m_TestingClosestPoint;
+SMOOTHING_METHOD PlanningHelpers::m_SmoothingMethod = SMOOTHING_GRADIENT_DESCENT;
+VELOCITY_PROFILE_METHOD PlanningHelpers::m_VelocityProfileMethod = VELOCITY_PROFILE_SMOOTHING;
+double PlanningHelpers::m_ProfileMaxAcceleration = 1.5;
+double PlanningHelpers::m_ProfileMaxDeceleration = 1.5;
+double PlanningHelpers::m_ProfileMaxLateralAcceleration = 2.0;
 
 PlanningHelpers::PlanningHelpers()
 {
@@ -30,54 +41,43 @@ bool PlanningHelpers::GetRelativeInfoRange(const std::vector<std::vector<WayPoin
 {
   if(trajectories.size() == 0) return false;
 
-  vector<RelativeInfo> infos;
+  //the candidates are compared while they are found, the first one is kept unless a later one costs less
+  int nCandidates = 0;
+  double minCost = DBL_MAX;
+  RelativeInfo info_item;
   for(unsigned int i=0; i < trajectories.size(); i++)
   {
-    RelativeInfo info_item;
+    info_item = RelativeInfo();
     GetRelativeInfo(trajectories.at(i), p, info_item);
     double angle_diff = UtilityH::AngleBetweenTwoAnglesPositive(info_item.perp_point.pos.a, p.pos.a)*RAD2DEG;
-    if(angle_diff < 75)
-    {
-      info_item.iGlobalPath = i;
-      infos.push_back(info_item);
-    }
-  }
+    if(angle_diff >= 75)
+      continue;
 
-  if(infos.size() == 0)
-    return false;
-  else if(infos.size() == 1)
-  {
-    info = infos.at(0);
-    return true;
-  }
+    info_item.iGlobalPath = i;
+    nCandidates++;
+    if(nCandidates == 1)
+      info = info_item;
 
-  double minCost = DBL_MAX;
-  int min_index = 0;
-
-  for(unsigned int i=0 ; i< infos.size(); i++)
-  {
     if(searchDistance > 0)
     {
-      double laneChangeCost = trajectories.at(infos.at(i).iGlobalPath).at(infos.at(i).iFront).laneChangeCost;
-      if(fabs(infos.at(i).perp_distance) < searchDistance && laneChangeCost < minCost)
+      double laneChangeCost = trajectories.at(i).at(info_item.iFront).laneChangeCost;
+      if(fabs(info_item.perp_distance) < searchDistance && laneChangeCost < minCost)
       {
-        min_index = i;
+        info = info_item;
         minCost = laneChangeCost;
       }
     }
     else
     {
-      if(fabs(infos.at(i).perp_distance) < minCost)
+      if(fabs(info_item.perp_distance) < minCost)
       {
-        min_index = i;
-        minCost = infos.at(i).perp_distance;
+        info = info_item;
+        minCost = info_item.perp_distance;
       }
     }
   }
 
-  info = infos.at(min_index);
-
-  return true;
+  return nCandidates > 0;
 }
 
 
@@ -85,6 +85,17 @@ bool PlanningHelpers::GetRelativeInfo(const std::vector<WayPoint>& trajectory, c
 {
   if(trajectory.size() < 2) return false;
 
+  int iFront = 1;
+  if(trajectory.size() > 2)
+    iFront = GetClosestNextPointIndexFast(trajectory, p, prevIndex);
+
+  GetRelativeInfoFromIndex(trajectory, p, iFront, info);
+
+  return true;
+}
+
+void PlanningHelpers::GetRelativeInfoFromIndex(const std::vector<WayPoint>& trajectory, const WayPoint& p, const int& iFront, RelativeInfo& info)
+{
   WayPoint p0, p1;
   if(trajectory.size()==2)
   {
@@ -97,11 +108,7 @@ bool PlanningHelpers::GetRelativeInfo(const std::vector<WayPoint>& trajectory, c
   }
   else
   {
-    info.iFront = GetClosestNextPointIndexFast(trajectory, p, prevIndex);
-//    WayPoint p2 = p;
-//    int old_index = GetClosestNextPointIndex(trajectory, p2, prevIndex);
-//    if(old_index != info.iFront)
-//      cout << " Alert Alert !!!! fast: " << info.iFront << ", slow: " << old_index  << endl;
+    info.iFront = iFront;
 
     if(info.iFront > 0)
       info.iBack = info.iFront -1;
@@ -154,9 +161,7 @@ bool PlanningHelpers::GetRelativeInfo(const std::vector<WayPoint>& trajectory, c
 
   info.from_back_distance = hypot(info.perp_point.pos.y - prevWP.pos.y, info.perp_point.pos.x - prevWP.pos.x);
 
-  info.angle_diff = UtilityH::AngleBetweenTwoAnglesPositive(p1.pos.a, p.pos.a)*RAD2DEG;
-
-  return true;
+  info.angle_diff = PlannerAngle::AngleBetweenTwoAnglesPositive(p1.pos.a, p.pos.a)*RAD2DEG;
 }
 
 bool PlanningHelpers::GetRelativeInfoLimited(const std::vector<WayPoint>& trajectory, const WayPoint& p, RelativeInfo& info, const int& prevIndex )
@@ -227,7 +232,7 @@ bool PlanningHelpers::GetRelativeInfoLimited(const std::vector<WayPoint>& trajec
 
     info.from_back_distance = hypot(info.perp_point.pos.y - prevWP.pos.y, info.perp_point.pos.x - prevWP.pos.x);
 
-    info.angle_diff = UtilityH::AngleBetweenTwoAnglesPositive(p1.pos.a, p.pos.a)*RAD2DEG;
+    info.angle_diff = PlannerAngle::AngleBetweenTwoAnglesPositive(p1.pos.a, p.pos.a)*RAD2DEG;
 
     info.bAfter = false;
     info.bBefore = false;
@@ -239,9 +244,9 @@ bool PlanningHelpers::GetRelativeInfoLimited(const std::vector<WayPoint>& trajec
     else if(info.iFront == _trajectory.size()-1)
     {
       int s = _trajectory.size();
-      double angle_befor_last = UtilityH::FixNegativeAngle(atan2(_trajectory.at(s-2).pos.y - _trajectory.at(s-1).pos.y, _trajectory.at(s-2).pos.x - _trajectory.at(s-1).pos.x));
-      double angle_from_perp = UtilityH::FixNegativeAngle(atan2(info.perp_point.pos.y - _trajectory.at(s-1).pos.y, info.perp_point.pos.x - _trajectory.at(s-1).pos.x));
-      double diff_last_perp = UtilityH::AngleBetweenTwoAnglesPositive(angle_befor_last, angle_from_perp);
+      double angle_befor_last = PlannerAngle::FixNegativeAngle(PlannerAngle::Atan2(_trajectory.at(s-2).pos.y - _trajectory.at(s-1).pos.y, _trajectory.at(s-2).pos.x - _trajectory.at(s-1).pos.x));
+      double angle_from_perp = PlannerAngle::FixNegativeAngle(PlannerAngle::Atan2(info.perp_point.pos.y - _trajectory.at(s-1).pos.y, info.perp_point.pos.x - _trajectory.at(s-1).pos.x));
+      double diff_last_perp = PlannerAngle::AngleBetweenTwoAnglesPositive(angle_befor_last, angle_from_perp);
       info.after_angle = diff_last_perp;
       if(diff_last_perp > M_PI_2)
       {
@@ -302,7 +307,7 @@ bool PlanningHelpers::GetRelativeInfoLimited(const std::vector<WayPoint>& trajec
 
     info.from_back_distance = hypot(info.perp_point.pos.y - prevWP.pos.y, info.perp_point.pos.x - prevWP.pos.x);
 
-    info.angle_diff = UtilityH::AngleBetweenTwoAnglesPositive(p1.pos.a, p.pos.a)*RAD2DEG;
+    info.angle_diff = PlannerAngle::AngleBetweenTwoAnglesPositive(p1.pos.a, p.pos.a)*RAD2DEG;
 
     info.bAfter = false;
     info.bBefore = false;
@@ -314,9 +319,9 @@ bool PlanningHelpers::GetRelativeInfoLimited(const std::vector<WayPoint>& trajec
     else if(info.iFront == trajectory.size()-1)
     {
       int s = trajectory.size();
-      double angle_befor_last = UtilityH::FixNegativeAngle(atan2(trajectory.at(s-2).pos.y - trajectory.at(s-1).pos.y, trajectory.at(s-2).pos.x - trajectory.at(s-1).pos.x));
-      double angle_from_perp = UtilityH::FixNegativeAngle(atan2(info.perp_point.pos.y - trajectory.at(s-1).pos.y, info.perp_point.pos.x - trajectory.at(s-1).pos.x));
-      double diff_last_perp = UtilityH::AngleBetweenTwoAnglesPositive(angle_befor_last, angle_from_perp);
+      double angle_befor_last = PlannerAngle::FixNegativeAngle(PlannerAngle::Atan2(trajectory.at(s-2).pos.y - trajectory.at(s-1).pos.y, trajectory.at(s-2).pos.x - trajectory.at(s-1).pos.x));
+      double angle_from_perp = PlannerAngle::FixNegativeAngle(PlannerAngle::Atan2(info.perp_point.pos.y - trajectory.at(s-1).pos.y, info.perp_point.pos.x - trajectory.at(s-1).pos.x));
+      double diff_last_perp = PlannerAngle::AngleBetweenTwoAnglesPositive(angle_befor_last, angle_from_perp);
       info.after_angle = diff_last_perp;
       if(diff_last_perp > M_PI_2)
       {
@@ -445,6 +450,30 @@ double PlanningHelpers::GetExactDistanceOnTrajectory(const std::vector<WayPoint>
   }
 }
 
+double PlanningHelpers::GetAccurateDistanceOnTrajectory(std::vector<WayPoint>& path, const int& start_index, const WayPoint& p)
+{
+  PathGeometry geometry;
+  geometry.Update(path);
+  return GetAccurateDistanceOnTrajectory(path, geometry, start_index, p);
+}
+
+double PlanningHelpers::GetAccurateDistanceOnTrajectory(const std::vector<WayPoint>& path, const PathGeometry& geometry, const int& start_index, const WayPoint& p)
+{
+  if(path.size() < 2 || start_index < 0 || start_index >= (int)path.size()) return 0;
+
+  if(!geometry.IsValid(path))
+  {
+    PathGeometry updated_geometry;
+    updated_geometry.Update(path);
+    return GetAccurateDistanceOnTrajectory(path, updated_geometry, start_index, p);
+  }
+
+  RelativeInfo info;
+  GetRelativeInfo(path, p, info);
+
+  return geometry.s.at(info.iBack) + info.from_back_distance - geometry.s.at(start_index);
+}
+
 int PlanningHelpers::GetClosestNextPointIndex_obsolete(const vector<WayPoint>& trajectory, const WayPoint& p,const int& prevIndex )
 {
   if(trajectory.size() == 0 || prevIndex < 0) return 0;
@@ -994,6 +1023,72 @@ bool PlanningHelpers::CompareTrajectories(const std::vector<WayPoint>& path1, co
   return true;
 }
 
+static void HashFingerprintValue(unsigned long long& hash, const void* value, const unsigned int& size)
+{
+  const unsigned char* bytes = (const unsigned char*)value;
+  for(unsigned int i = 0; i < size; i++)
+  {
+    hash ^= bytes[i];
+    hash *= 1099511628211ULL;
+  }
+}
+
+static void HashPathFingerprint(unsigned long long& hash, const std::vector<WayPoint>& path, const unsigned int& sampleStep)
+{
+  unsigned long long n = path.size();
+  HashFingerprintValue(hash, &n, sizeof(n));
+  if(path.size() == 0) return;
+
+  //lane changes along the path, consecutive points mostly share their lane
+  //the lane pointer too, the same ids on a reloaded map are different lanes for the consumers
+  int prevLaneId = path.at(0).laneId;
+  const Lane* pPrevLane = path.at(0).pLane;
+  HashFingerprintValue(hash, &prevLaneId, sizeof(prevLaneId));
+  HashFingerprintValue(hash, &pPrevLane, sizeof(pPrevLane));
+  for(unsigned int i = 0; i < path.size(); i++)
+  {
+    const WayPoint& p = path.at(i);
+    if(p.laneId != prevLaneId || p.pLane != pPrevLane)
+    {
+      HashFingerprintValue(hash, &i, sizeof(i));
+      HashFingerprintValue(hash, &p.laneId, sizeof(p.laneId));
+      HashFingerprintValue(hash, &p.pLane, sizeof(p.pLane));
+      prevLaneId = p.laneId;
+      pPrevLane = p.pLane;
+    }
+    if(p.stopLineID > 0)
+    {
+      HashFingerprintValue(hash, &i, sizeof(i));
+      HashFingerprintValue(hash, &p.stopLineID, sizeof(p.stopLineID));
+    }
+
+    if(i % sampleStep == 0 || i+1 == path.size())
+    {
+      HashFingerprintValue(hash, &p.pos.x, sizeof(p.pos.x));
+      HashFingerprintValue(hash, &p.pos.y, sizeof(p.pos.y));
+      HashFingerprintValue(hash, &p.pos.a, sizeof(p.pos.a));
+      HashFingerprintValue(hash, &p.v, sizeof(p.v));
+    }
+  }
+}
+
+unsigned long long PlanningHelpers::GetPathFingerprint(const std::vector<WayPoint>& path, const unsigned int& sampleStep)
+{
+  unsigned long long hash = 14695981039346656037ULL;
+  HashPathFingerprint(hash, path, sampleStep > 0 ? sampleStep : 1);
+  return hash;
+}
+
+unsigned long long PlanningHelpers::GetPathFingerprint(const std::vector<std::vector<WayPoint> >& paths, const unsigned int& sampleStep)
+{
+  unsigned long long hash = 14695981039346656037ULL;
+  unsigned long long n = paths.size();
+  HashFingerprintValue(hash, &n, sizeof(n));
+  for(unsigned int i = 0; i < paths.size(); i++)
+    HashPathFingerprint(hash, paths.at(i), sampleStep > 0 ? sampleStep : 1);
+  return hash;
+}
+
 double PlanningHelpers::GetDistanceToClosestStopLineAndCheck(const std::vector<WayPoint>& path, const WayPoint& p, const double& giveUpDistance, int& stopLineID, int& stopSignID, int& trafficLightID, const int& prevIndex)
 {
   trafficLightID = stopSignID = stopLineID = -1;
@@ -1140,6 +1235,12 @@ void PlanningHelpers::CreateManualBranch(std::vector<WayPoint>& path, const int&
 }
 
 void PlanningHelpers::FixPathDensity(vector<WayPoint>& path, const double& distanceDensity)
+{
+  vector<WayPoint> fixedPath;
+  FixPathDensity(path, distanceDensity, fixedPath);
+}
+
+void PlanningHelpers::FixPathDensity(vector<WayPoint>& path, const double& distanceDensity, vector<WayPoint>& fixedPath)
 {
   if(path.size() == 0 || distanceDensity==0) return;
 
@@ -1147,7 +1248,7 @@ void PlanningHelpers::FixPathDensity(vector<WayPoint>& path, const double& dista
   double margin = distanceDensity*0.01;
   double remaining = 0;
   int nPoints = 0;
-  vector<WayPoint> fixedPath;
+  fixedPath.clear();
   fixedPath.push_back(path.at(0));
   for(unsigned int si = 0, ei=1; ei < path.size(); )
   {
@@ -1185,12 +1286,114 @@ void PlanningHelpers::FixPathDensity(vector<WayPoint>& path, const double& dista
     }
   }
 
-  path = fixedPath;
+  path.assign(fixedPath.begin(), fixedPath.end());
+}
+
+void PlanningHelpers::FixPathDensity(vector<WayPoint>& path, const double& distanceDensity, PlanningContext& context)
+{
+  FixPathDensity(path, distanceDensity, context.pathBuffer);
+}
+
+void PlanningHelpers::FixPathDensity(vector<WayPoint>& path, const double& distanceDensity, PathGeometry& geometry)
+{
+  vector<GPSPoint> prev_points(path.size());
+  for(unsigned int i = 0; i < path.size(); i++)
+    prev_points.at(i) = path.at(i).pos;
+
+  FixPathDensity(path, distanceDensity);
+
+  int start = -1, end = -1;
+  PathGeometry::GetChangedRange(prev_points, path, start, end);
+  if(prev_points.size() != path.size())
+    geometry.Invalidate();
+  else
+    geometry.Invalidate(start, end);
+}
+
+void PlanningHelpers::SmoothPath(vector<WayPoint>& path, PathGeometry& geometry, double weight_data,
+    double weight_smooth, double tolerance)
+{
+  vector<GPSPoint> prev_points(path.size());
+  for(unsigned int i = 0; i < path.size(); i++)
+    prev_points.at(i) = path.at(i).pos;
+
+  SmoothPath(path, weight_data, weight_smooth, tolerance);
+
+  int start = -1, end = -1;
+  PathGeometry::GetChangedRange(prev_points, path, start, end);
+  geometry.Invalidate(start, end);
+}
+
+void PlanningHelpers::SetSmoothingMethod(const SMOOTHING_METHOD& method)
+{
+  m_SmoothingMethod = method;
+}
+
+SMOOTHING_METHOD PlanningHelpers::GetSmoothingMethod()
+{
+  return m_SmoothingMethod;
+}
+
+void PlanningHelpers::SetVelocityProfileMethod(const VELOCITY_PROFILE_METHOD& method, const double& max_acceleration,
+    const double& max_deceleration, const double& max_lateral_acceleration)
+{
+  m_VelocityProfileMethod = method;
+  m_ProfileMaxAcceleration = fabs(max_acceleration);
+  m_ProfileMaxDeceleration = fabs(max_deceleration);
+  m_ProfileMaxLateralAcceleration = fabs(max_lateral_acceleration);
+}
+
+VELOCITY_PROFILE_METHOD PlanningHelpers::GetVelocityProfileMethod()
+{
+  return m_VelocityProfileMethod;
+}
+
+void PlanningHelpers::SmoothValuesDirect(vector<double>& values, const double& weight_data, const double& weight_smooth, vector<double>& buffer)
+{
+  //interior rows: -ws*y[i-1] + (wd + 2ws)*y[i] - ws*y[i+1] = wd*in[i], the end values move to the right hand side.
+  //one gradient descent step applies the data term before the smooth term, so their fixed point has the data weight scaled by (1 - 2ws)
+  int n = values.size();
+  double wd = weight_data*(1.0 - 2.0*weight_smooth);
+  if(wd < 0)
+    wd = 0;
+  if(n <= 2 || weight_smooth <= 0)
+    return;
+
+  int m = n - 2;
+  double a = -weight_smooth;
+  double b = wd + 2.0*weight_smooth;
+  buffer.resize(m);
+
+  //forward sweep (Thomas algorithm), buffer keeps the modified upper diagonal and values[1..m] the modified right hand side
+  double rhs = wd*values[1] + weight_smooth*values[0];
+  if(m == 1)
+    rhs += weight_smooth*values[n-1];
+  buffer[0] = a/b;
+  values[1] = rhs/b;
+  for(int k = 1; k < m; k++)
+  {
+    rhs = wd*values[k+1];
+    if(k == m-1)
+      rhs += weight_smooth*values[n-1];
+    double denom = b - a*buffer[k-1];
+    buffer[k] = a/denom;
+    values[k+1] = (rhs - a*values[k])/denom;
+  }
+
+  for(int k = m-2; k >= 0; k--)
+    values[k+1] -= buffer[k]*values[k+2];
 }
 
 void PlanningHelpers::SmoothPath(vector<WayPoint>& path, double weight_data,
     double weight_smooth, double tolerance)
 {
+  PlanningContext context(m_SmoothingMethod);
+  SmoothPath(path, weight_data, weight_smooth, tolerance, context);
+}
+
+void PlanningHelpers::SmoothPath(vector<WayPoint>& path, const double& weight_data, const double& weight_smooth, const double& tolerance,
+    PlanningContext& context)
+{
 
   if (path.size() <= 2 )
   {
@@ -1198,8 +1401,30 @@ void PlanningHelpers::SmoothPath(vector<WayPoint>& path, double weight_data,
     return;
   }
 
+  if(context.smoothingMethod == SMOOTHING_DIRECT)
+  {
+    vector<double>& x = context.x;
+    vector<double>& y = context.y;
+    x.resize(path.size());
+    y.resize(path.size());
+    for(unsigned int i = 0; i < path.size(); i++)
+    {
+      x[i] = path[i].pos.x;
+      y[i] = path[i].pos.y;
+    }
+    SmoothValuesDirect(x, weight_data, weight_smooth, context.solverBuffer);
+    SmoothValuesDirect(y, weight_data, weight_smooth, context.solverBuffer);
+    for(unsigned int i = 0; i < path.size(); i++)
+    {
+      path[i].pos.x = x[i];
+      path[i].pos.y = y[i];
+    }
+    return;
+  }
+
   const vector<WayPoint>& path_in = path;
-  vector<WayPoint> smoothPath_out =  path_in;
+  vector<WayPoint>& smoothPath_out = context.pathBuffer;
+  smoothPath_out.assign(path_in.begin(), path_in.end());
 
   double change = tolerance;
   double xtemp, ytemp;
@@ -1237,7 +1462,8 @@ void PlanningHelpers::SmoothPath(vector<WayPoint>& path, double weight_data,
     nIterations++;
   }
 
-  path = smoothPath_out;
+  //both vectors keep their memory for the next call
+  path.swap(smoothPath_out);
 }
 
 void PlanningHelpers::PredictConstantTimeCostForTrajectory(std::vector<PlannerHNS::WayPoint>& path, const PlannerHNS::WayPoint& currPose, const double& minVelocity, const double& minDist)
@@ -1270,10 +1496,10 @@ void PlanningHelpers::FixAngleOnly(std::vector<WayPoint>& path)
 {
   if(path.size() <= 2) return;
 
-  path[0].pos.a = UtilityH::FixNegativeAngle(atan2(path[1].pos.y - path[0].pos.y, path[1].pos.x - path[0].pos.x ));
+  path[0].pos.a = PlannerAngle::FixNegativeAngle(PlannerAngle::Atan2(path[1].pos.y - path[0].pos.y, path[1].pos.x - path[0].pos.x ));
 
   for(int j = 1; j < path.size()-1; j++)
-    path[j].pos.a     = UtilityH::FixNegativeAngle(atan2(path[j+1].pos.y - path[j].pos.y, path[j+1].pos.x - path[j].pos.x ));
+    path[j].pos.a     = PlannerAngle::FixNegativeAngle(PlannerAngle::Atan2(path[j+1].pos.y - path[j].pos.y, path[j+1].pos.x - path[j].pos.x ));
 
   int j = (int)path.size()-1;
 
@@ -1291,19 +1517,19 @@ double PlanningHelpers::CalcAngleAndCost(vector<WayPoint>& path, const double& l
   if(path.size() < 2) return 0;
   if(path.size() == 2)
   {
-    path[0].pos.a = UtilityH::FixNegativeAngle(atan2(path[1].pos.y - path[0].pos.y, path[1].pos.x - path[0].pos.x ));
+    path[0].pos.a = PlannerAngle::FixNegativeAngle(PlannerAngle::Atan2(path[1].pos.y - path[0].pos.y, path[1].pos.x - path[0].pos.x ));
     path[0].cost = lastCost;
     path[1].pos.a = path[0].pos.a;
     path[1].cost = path[0].cost +  distance2points(path[0].pos, path[1].pos);
     return path[1].cost;
   }
 
-  path[0].pos.a = UtilityH::FixNegativeAngle(atan2(path[1].pos.y - path[0].pos.y, path[1].pos.x - path[0].pos.x ));
+  path[0].pos.a = PlannerAngle::FixNegativeAngle(PlannerAngle::Atan2(path[1].pos.y - path[0].pos.y, path[1].pos.x - path[0].pos.x ));
   path[0].cost = lastCost;
 
   for(int j = 1; j < path.size()-1; j++)
   {
-    path[j].pos.a     = UtilityH::FixNegativeAngle(atan2(path[j+1].pos.y - path[j].pos.y, path[j+1].pos.x - path[j].pos.x ));
+    path[j].pos.a     = PlannerAngle::FixNegativeAngle(PlannerAngle::Atan2(path[j+1].pos.y - path[j].pos.y, path[j+1].pos.x - path[j].pos.x ));
     path[j].cost   = path[j-1].cost +  distance2points(path[j-1].pos, path[j].pos);
   }
 
@@ -1321,11 +1547,63 @@ double PlanningHelpers::CalcAngleAndCost(vector<WayPoint>& path, const double& l
   return path[j].cost;
 }
 
+double PlanningHelpers::CalcAngleAndCost(vector<WayPoint>& path, PathGeometry& geometry, const double& lastCost)
+{
+  if(path.size() < 2) return 0;
+
+  geometry.Update(path);
+
+  for(unsigned int j = 0; j < path.size(); j++)
+  {
+    path[j].pos.a = PlannerAngle::FixNegativeAngle(geometry.heading[j]);
+    path[j].cost = lastCost + geometry.s[j];
+  }
+
+  for(unsigned int j = 0; j < path.size()-1; j++)
+  {
+    if(path.at(j).pos.x == path.at(j+1).pos.x && path.at(j).pos.y == path.at(j+1).pos.y)
+      path.at(j).pos.a = path.at(j+1).pos.a;
+  }
+
+  return path[path.size()-1].cost;
+}
+
+double PlanningHelpers::CalcAngleAndCostAndCurvatureAnd2D(vector<WayPoint>& path, PathGeometry& geometry, const double& lastCost)
+{
+  if(path.size() < 2) return -1;
+
+  geometry.Update(path);
+
+  path[0].pos.a   = geometry.heading[0];
+  path[0].cost   = lastCost;
+
+  for(unsigned int j = 1; j < path.size()-1; j++)
+  {
+    double k = 1.0/geometry.kappa[j];
+    if(k > 150.0 || std::isnan(k))
+      k = 150.0;
+
+    if(k<1.0)
+      path[j].cost = 0;
+    else
+      path[j].cost = 1.0-1.0/k;
+
+    path[j].pos.a   = geometry.heading[j];
+  }
+  unsigned int j = path.size()-1;
+
+  path[0].cost    = path[1].cost;
+  path[j].pos.a   = geometry.heading[j];
+  path[j].cost   = path[j-1].cost ;
+
+  return path[j].cost;
+}
+
 double PlanningHelpers::CalcAngleAndCostAndCurvatureAnd2D(vector<WayPoint>& path, const double& lastCost)
 {
   if(path.size() < 2) return -1;
 
-  path[0].pos.a   = atan2(path[1].pos.y - path[0].pos.y, path[1].pos.x - path[0].pos.x );
+  path[0].pos.a   = PlannerAngle::Atan2(path[1].pos.y - path[0].pos.y, path[1].pos.x - path[0].pos.x );
   path[0].cost   = lastCost;
 
   double k = 0;
@@ -1342,7 +1620,7 @@ double PlanningHelpers::CalcAngleAndCostAndCurvatureAnd2D(vector<WayPoint>& path
     else
       path[j].cost = 1.0-1.0/k;
 
-    path[j].pos.a   = atan2(path[j+1].pos.y - path[j].pos.y, path[j+1].pos.x - path[j].pos.x );
+    path[j].pos.a   = PlannerAngle::Atan2(path[j+1].pos.y - path[j].pos.y, path[j+1].pos.x - path[j].pos.x );
   }
   unsigned int j = path.size()-1;
 
@@ -1422,10 +1700,35 @@ void PlanningHelpers::ExtractPartFromPointToDistance(const vector<WayPoint>& ori
 
 void PlanningHelpers::ExtractPartFromPointToDistanceDirectionFast(const vector<WayPoint>& originalPath, const WayPoint& pos, const double& minDistance,
     const double& pathDensity, vector<WayPoint>& extractedPath)
+{
+  vector<WayPoint> buffer;
+  ExtractPartFromPointToDistanceDirectionFast(originalPath, pos, minDistance, pathDensity, extractedPath, buffer);
+}
+
+void PlanningHelpers::ExtractPartFromPointToDistanceDirectionFast(const vector<WayPoint>& originalPath, const WayPoint& pos, const double& minDistance,
+    const double& pathDensity, vector<WayPoint>& extractedPath, vector<WayPoint>& buffer)
 {
   if(originalPath.size() < 2 ) return;
 
-  extractedPath.clear();
+  PathView view;
+  ExtractPartFromPointToDistanceDirectionFast(originalPath, pos, minDistance, view);
+  extractedPath.assign(originalPath.begin() + view.GetOffset(), originalPath.begin() + view.GetOffset() + view.size());
+
+  if(extractedPath.size() < 2)
+  {
+    cout << endl << "### Planner Z . Extracted Rollout Path is too Small, Size = " << extractedPath.size() << endl;
+    return;
+  }
+
+  FixPathDensity(extractedPath, pathDensity, buffer);
+  CalcAngleAndCost(extractedPath);
+}
+
+void PlanningHelpers::ExtractPartFromPointToDistanceDirectionFast(const vector<WayPoint>& originalPath, const WayPoint& pos, const double& minDistance,
+    PathView& extractedView)
+{
+  extractedView = PathView();
+  if(originalPath.size() < 2 ) return;
 
   int close_index = GetClosestNextPointIndexDirectionFast(originalPath, pos);
   double d = 0;
@@ -1433,34 +1736,27 @@ void PlanningHelpers::ExtractPartFromPointToDistanceDirectionFast(const vector<W
   if(close_index + 1 >= originalPath.size())
     close_index = originalPath.size() - 2;
 
+  //10 meters behind the closest point and minDistance ahead of it, in one range
+  int start_index = 0;
   for(int i=close_index; i >=  0; i--)
   {
-    extractedPath.insert(extractedPath.begin(),  originalPath.at(i));
-    if(i < originalPath.size())
-      d += hypot(originalPath.at(i).pos.y - originalPath.at(i+1).pos.y, originalPath.at(i).pos.x - originalPath.at(i+1).pos.x);
+    start_index = i;
+    d += hypot(originalPath.at(i).pos.y - originalPath.at(i+1).pos.y, originalPath.at(i).pos.x - originalPath.at(i+1).pos.x);
     if(d > 10)
       break;
   }
 
-  //extractedPath.push_back(info.perp_point);
   d = 0;
+  int end_index = close_index;
   for(int i=close_index+1; i < (int)originalPath.size(); i++)
   {
-    extractedPath.push_back(originalPath.at(i));
-    if(i > 0)
-      d += hypot(originalPath.at(i).pos.y - originalPath.at(i-1).pos.y, originalPath.at(i).pos.x - originalPath.at(i-1).pos.x);
+    end_index = i;
+    d += hypot(originalPath.at(i).pos.y - originalPath.at(i-1).pos.y, originalPath.at(i).pos.x - originalPath.at(i-1).pos.x);
     if(d > minDistance)
       break;
   }
 
-  if(extractedPath.size() < 2)
-  {
-    cout << endl << "### Planner Z . Extracted Rollout Path is too Small, Size = " << extractedPath.size() << endl;
-    return;
-  }
-
-  FixPathDensity(extractedPath, pathDensity);
-  CalcAngleAndCost(extractedPath);
+  extractedView = PathView(originalPath, start_index, end_index - start_index + 1);
 }
 
 void PlanningHelpers::ExtractPartFromPointToDistanceFast(const vector<WayPoint>& originalPath, const WayPoint& pos, const double& minDistance,
@@ -1503,6 +1799,47 @@ void PlanningHelpers::ExtractPartFromPointToDistanceFast(const vector<WayPoint>&
   CalcAngleAndCost(extractedPath);
 }
 
+void PlanningHelpers::ExtractPartFromPointToDistanceFast(const vector<WayPoint>& originalPath, const PathGeometry& originalGeometry, const WayPoint& pos, const double& minDistance,
+    const double& pathDensity, vector<WayPoint>& extractedPath, PathGeometry& extractedGeometry)
+{
+  extractedPath.clear();
+  extractedGeometry.Invalidate();
+  if(originalPath.size() < 2 || !originalGeometry.IsValid(originalPath))
+  {
+    ExtractPartFromPointToDistanceFast(originalPath, pos, minDistance, pathDensity, extractedPath, 0, 0, 0);
+    return;
+  }
+
+  RelativeInfo info;
+  GetRelativeInfo(originalPath, pos, info);
+  int iBack = info.iBack;
+  if(iBack > 0)
+    iBack--;
+
+  //same range as the distance accumulation loops of the version above, found with a binary search on the arc length
+  const vector<double>& s = originalGeometry.s;
+  int iStart = originalGeometry.GetIndexAtDistance(s.at(iBack+1) - 10.0) - 1;
+  if(iStart > iBack)
+    iStart = iBack;
+  if(iStart < 0)
+    iStart = 0;
+
+  int iEnd = std::upper_bound(s.begin() + iBack + 1, s.end(), s.at(iBack) + minDistance) - s.begin();
+  if(iEnd >= (int)originalPath.size())
+    iEnd = originalPath.size() - 1;
+
+  extractedPath.assign(originalPath.begin() + iStart, originalPath.begin() + iEnd + 1);
+
+  if(extractedPath.size() < 2)
+  {
+    cout << endl << "### Planner Z . Extracted Rollout Path is too Small, Size = " << extractedPath.size() << endl;
+    return;
+  }
+
+  FixPathDensity(extractedPath, pathDensity, extractedGeometry);
+  CalcAngleAndCost(extractedPath, extractedGeometry);
+}
+
 void PlanningHelpers::CalculateRollInTrajectories(const WayPoint& carPos, const double& speed, const vector<WayPoint>& originalCenter, int& start_index,
     int& end_index, vector<double>& end_laterals ,
     vector<vector<WayPoint> >& rollInPaths, const double& max_roll_distance,
@@ -1512,6 +1849,39 @@ void PlanningHelpers::CalculateRollInTrajectories(const WayPoint& carPos, const
     const double& SmoothTolerance, const bool& bHeadingSmooth,
     std::vector<WayPoint>& sampledPoints)
 {
+  PlanningContext context(m_SmoothingMethod);
+  CalculateRollInTrajectories(carPos, speed, originalCenter, start_index, end_index, end_laterals, rollInPaths, max_roll_distance,
+      maxSpeed, carTipMargin, rollInMargin, rollInSpeedFactor, pathDensity, rollOutDensity, rollOutNumber,
+      SmoothDataWeight, SmoothWeight, SmoothTolerance, bHeadingSmooth, context, sampledPoints);
+}
+
+void PlanningHelpers::CalculateRollInTrajectories(const WayPoint& carPos, const double& speed, const vector<WayPoint>& originalCenter, int& start_index,
+    int& end_index, vector<double>& end_laterals ,
+    vector<vector<WayPoint> >& rollInPaths, const double& max_roll_distance,
+    const double& maxSpeed, const double&  carTipMargin, const double& rollInMargin,
+    const double& rollInSpeedFactor, const double& pathDensity, const double& rollOutDensity,
+    const int& rollOutNumber, const double& SmoothDataWeight, const double& SmoothWeight,
+    const double& SmoothTolerance, const bool& bHeadingSmooth, RollOutsTemplate& rollOutsTemplate,
+    std::vector<WayPoint>& sampledPoints)
+{
+  PlanningContext context(m_SmoothingMethod);
+  std::swap(context.rollOutsTemplate, rollOutsTemplate);
+  CalculateRollInTrajectories(carPos, speed, originalCenter, start_index, end_index, end_laterals, rollInPaths, max_roll_distance,
+      maxSpeed, carTipMargin, rollInMargin, rollInSpeedFactor, pathDensity, rollOutDensity, rollOutNumber,
+      SmoothDataWeight, SmoothWeight, SmoothTolerance, bHeadingSmooth, context, sampledPoints);
+  std::swap(context.rollOutsTemplate, rollOutsTemplate);
+}
+
+void PlanningHelpers::CalculateRollInTrajectories(const WayPoint& carPos, const double& speed, const vector<WayPoint>& originalCenter, int& start_index,
+    int& end_index, vector<double>& end_laterals ,
+    vector<vector<WayPoint> >& rollInPaths, const double& max_roll_distance,
+    const double& maxSpeed, const double&  carTipMargin, const double& rollInMargin,
+    const double& rollInSpeedFactor, const double& pathDensity, const double& rollOutDensity,
+    const int& rollOutNumber, const double& SmoothDataWeight, const double& SmoothWeight,
+    const double& SmoothTolerance, const bool& bHeadingSmooth, PlanningContext& context,
+    std::vector<WayPoint>& sampledPoints)
+{
+  RollOutsTemplate& rollOutsTemplate = context.rollOutsTemplate;
   WayPoint p;
   double dummyd = 0;
 
@@ -1583,16 +1953,14 @@ void PlanningHelpers::CalculateRollInTrajectories(const WayPoint& carPos, const
     }
 
   int centralTrajectoryIndex = rollOutNumber/2;
-  vector<double> end_distance_list;
-  for(int i=0; i< rollOutNumber+1; i++)
-    {
-      double end_roll_in_distance = rollOutDensity*(i - centralTrajectoryIndex);
-      end_distance_list.push_back(end_roll_in_distance);
-    }
+  rollOutsTemplate.SetParams(rollOutNumber, rollOutDensity);
+  rollOutsTemplate.SetCenter(originalCenter);
+  const vector<double>& normal_x = rollOutsTemplate.normalX;
+  const vector<double>& normal_y = rollOutsTemplate.normalY;
 
   start_index = close_index;
   end_index = far_index;
-  end_laterals = end_distance_list;
+  end_laterals = rollOutsTemplate.endLaterals;
 
   //calculate the actual calculation starting index
   d_limit = 0;
@@ -1623,22 +1991,22 @@ void PlanningHelpers::CalculateRollInTrajectories(const WayPoint& carPos, const
   int nSteps = end_index - smoothing_start_index;
 
 
-  vector<double> inc_list;
-  rollInPaths.clear();
-  vector<double> inc_list_inc;
+  vector<double>& inc_list = context.rollInSteps;
+  vector<double>& inc_list_inc = context.rollInOffsets;
+  inc_list.resize(rollOutNumber+1);
+  inc_list_inc.assign(rollOutNumber+1, 0);
+  rollInPaths.resize(rollOutNumber+1);
   for(int i=0; i< rollOutNumber+1; i++)
   {
     double diff = end_laterals.at(i)-initial_roll_in_distance;
-    inc_list.push_back(diff/(double)nSteps);
-    rollInPaths.push_back(vector<WayPoint>());
-    inc_list_inc.push_back(0);
+    inc_list.at(i) = diff/(double)nSteps;
+    rollInPaths.at(i).clear();
   }
 
-
-
-  vector<vector<WayPoint> > execluded_from_smoothing;
+  vector<vector<WayPoint> >& execluded_from_smoothing = context.excludedPaths;
+  execluded_from_smoothing.resize(rollOutNumber+1);
   for(unsigned int i=0; i< rollOutNumber+1 ; i++)
-    execluded_from_smoothing.push_back(vector<WayPoint>());
+    execluded_from_smoothing.at(i).clear();
 
 
 
@@ -1649,8 +2017,8 @@ void PlanningHelpers::CalculateRollInTrajectories(const WayPoint& carPos, const
     double original_speed = p.v;
     for(unsigned int i=0; i< rollOutNumber+1 ; i++)
     {
-      p.pos.x = originalCenter.at(j).pos.x -  initial_roll_in_distance*cos(p.pos.a + M_PI_2);
-      p.pos.y = originalCenter.at(j).pos.y -  initial_roll_in_distance*sin(p.pos.a + M_PI_2);
+      p.pos.x = originalCenter.at(j).pos.x -  initial_roll_in_distance*normal_x[j];
+      p.pos.y = originalCenter.at(j).pos.y -  initial_roll_in_distance*normal_y[j];
       if(i!=centralTrajectoryIndex)
         p.v = original_speed * LANE_CHANGE_SPEED_FACTOR;
       else
@@ -1673,8 +2041,8 @@ void PlanningHelpers::CalculateRollInTrajectories(const WayPoint& carPos, const
       {
         inc_list_inc[i] += inc_list[i];
         double d = inc_list_inc[i];
-        p.pos.x = originalCenter.at(j).pos.x -  initial_roll_in_distance*cos(p.pos.a + M_PI_2) - d*cos(p.pos.a+ M_PI_2);
-        p.pos.y = originalCenter.at(j).pos.y -  initial_roll_in_distance*sin(p.pos.a + M_PI_2) - d*sin(p.pos.a+ M_PI_2);
+        p.pos.x = originalCenter.at(j).pos.x -  initial_roll_in_distance*normal_x[j] - d*normal_x[j];
+        p.pos.y = originalCenter.at(j).pos.y -  initial_roll_in_distance*normal_y[j] - d*normal_y[j];
         if(i!=centralTrajectoryIndex)
           p.v = original_speed * LANE_CHANGE_SPEED_FACTOR;
         else
@@ -1694,8 +2062,8 @@ void PlanningHelpers::CalculateRollInTrajectories(const WayPoint& carPos, const
     for(unsigned int i=0; i< rollOutNumber+1 ; i++)
     {
       double d = end_laterals.at(i);
-      p.pos.x  = originalCenter.at(j).pos.x - d*cos(p.pos.a + M_PI_2);
-      p.pos.y  = originalCenter.at(j).pos.y - d*sin(p.pos.a + M_PI_2);
+      p.pos.x  = originalCenter.at(j).pos.x - d*normal_x[j];
+      p.pos.y  = originalCenter.at(j).pos.y - d*normal_y[j];
       if(i!=centralTrajectoryIndex)
         p.v = original_speed * LANE_CHANGE_SPEED_FACTOR;
       else
@@ -1737,8 +2105,8 @@ void PlanningHelpers::CalculateRollInTrajectories(const WayPoint& carPos, const
       for(unsigned int i=0; i< rollInPaths.size() ; i++)
       {
         double d = end_laterals.at(i);
-        p.pos.x  = originalCenter.at(j).pos.x - d*cos(p.pos.a + M_PI_2);
-        p.pos.y  = originalCenter.at(j).pos.y - d*sin(p.pos.a + M_PI_2);
+        p.pos.x  = originalCenter.at(j).pos.x - d*normal_x[j];
+        p.pos.y  = originalCenter.at(j).pos.y - d*normal_y[j];
 
         if(i!=centralTrajectoryIndex)
           p.v = original_speed * LANE_CHANGE_SPEED_FACTOR;
@@ -1753,13 +2121,179 @@ void PlanningHelpers::CalculateRollInTrajectories(const WayPoint& carPos, const
 
   for(unsigned int i=0; i< rollOutNumber+1 ; i++)
   {
-    SmoothPath(rollInPaths.at(i), SmoothDataWeight, SmoothWeight, SmoothTolerance);
+    SmoothPath(rollInPaths.at(i), SmoothDataWeight, SmoothWeight, SmoothTolerance, context);
   }
 
 //  for(unsigned int i=0; i< rollInPaths.size(); i++)
 //    CalcAngleAndCost(rollInPaths.at(i));
 }
 
+void PlanningHelpers::GetRollOutsIndices(const WayPoint& carPos, const double& speed, const vector<WayPoint>& originalCenter,
+    const double& max_roll_distance, const double&  carTipMargin, const double& rollInMargin, const double& rollInSpeedFactor,
+    int& close_index, int& far_index, int& last_index, double& lateral)
+{
+  //same index calculation as CalculateRollInTrajectories
+  RelativeInfo info;
+  GetRelativeInfo(originalCenter, carPos, info);
+  close_index = info.iBack;
+  lateral = info.perp_distance;
+
+  double remaining_distance = 0;
+  for(unsigned int i=close_index; i< originalCenter.size()-1; i++)
+  {
+    if(i>0)
+      remaining_distance += distance2points(originalCenter[i].pos, originalCenter[i+1].pos);
+  }
+
+  double start_distance = rollInSpeedFactor*speed+rollInMargin;
+  if(start_distance > remaining_distance)
+    start_distance = remaining_distance;
+
+  double d_limit = 0;
+  far_index = close_index;
+  for(unsigned int i=close_index; i< originalCenter.size(); i++)
+  {
+    if(i>0)
+      d_limit += distance2points(originalCenter[i].pos, originalCenter[i-1].pos);
+
+    if(d_limit >= start_distance)
+    {
+      far_index = i;
+      break;
+    }
+  }
+
+  d_limit = 0;
+  unsigned int smoothing_end_index = far_index;
+  for(unsigned int i=far_index; i< originalCenter.size(); i++)
+  {
+    if(i > 0)
+      d_limit += distance2points(originalCenter[i].pos, originalCenter[i-1].pos);
+    if(d_limit > carTipMargin)
+      break;
+
+    smoothing_end_index++;
+  }
+
+  d_limit = 0;
+  last_index = (int)smoothing_end_index - 1;
+  for(unsigned int j = smoothing_end_index; j < originalCenter.size(); j++)
+  {
+    if(j > 0)
+      d_limit += distance2points(originalCenter.at(j).pos, originalCenter.at(j-1).pos);
+
+    if(d_limit > max_roll_distance)
+      break;
+
+    last_index = j;
+  }
+}
+
+bool PlanningHelpers::CalculateRollInTrajectories(const WayPoint& carPos, const double& speed, const vector<WayPoint>& originalCenter, int& start_index,
+    int& end_index, vector<double>& end_laterals ,
+    vector<vector<WayPoint> >& rollInPaths, const double& max_roll_distance,
+    const double& maxSpeed, const double&  carTipMargin, const double& rollInMargin,
+    const double& rollInSpeedFactor, const double& pathDensity, const double& rollOutDensity,
+    const int& rollOutNumber, const double& SmoothDataWeight, const double& SmoothWeight,
+    const double& SmoothTolerance, const bool& bHeadingSmooth, RollOutsCache& cache,
+    std::vector<WayPoint>& sampledPoints)
+{
+  int close_index = 0, far_index = 0, last_index = 0;
+  double lateral = 0;
+  GetRollOutsIndices(carPos, speed, originalCenter, max_roll_distance, carTipMargin, rollInMargin, rollInSpeedFactor,
+      close_index, far_index, last_index, lateral);
+
+  double max_shift = carTipMargin*ROLL_OUTS_MAX_SHIFT_RATIO;
+  bool bShift = cache.bValid && cache.IsSameCenter(originalCenter)
+      && cache.rollOutNumber == rollOutNumber && cache.rollOutDensity == rollOutDensity
+      && close_index >= cache.iStart && close_index <= cache.iEnd && last_index >= cache.iEnd
+      && fabs(lateral - cache.anchorLateral) <= ROLL_OUTS_MAX_LATERAL_SHIFT
+      && distance2points(originalCenter.at(close_index).pos, originalCenter.at(cache.iAnchorStart).pos) <= max_shift
+      && distance2points(originalCenter.at(far_index).pos, originalCenter.at(cache.iAnchorFar).pos) <= max_shift;
+
+  if(!bShift)
+  {
+    CalculateRollInTrajectories(carPos, speed, originalCenter, start_index, end_index, end_laterals, rollInPaths, max_roll_distance,
+        maxSpeed, carTipMargin, rollInMargin, rollInSpeedFactor, pathDensity, rollOutDensity, rollOutNumber,
+        SmoothDataWeight, SmoothWeight, SmoothTolerance, bHeadingSmooth, cache.offsets, sampledPoints);
+
+    cache.rollOuts = rollInPaths;
+    cache.iStart = start_index;
+    cache.iEnd = last_index;
+    cache.iAnchorStart = start_index;
+    cache.iAnchorFar = end_index;
+    cache.anchorLateral = lateral;
+    cache.rollOutNumber = rollOutNumber;
+    cache.rollOutDensity = rollOutDensity;
+    cache.centerSize = originalCenter.size();
+    cache.centerFront = originalCenter.front().pos;
+    cache.centerBack = originalCenter.back().pos;
+    cache.nGenerations++;
+
+    //the indices of the roll out points must follow the center line one to one, otherwise the roll outs can't be shifted
+    cache.bValid = rollInPaths.size() > 0;
+    for(unsigned int i=0; i< rollInPaths.size(); i++)
+    {
+      if((int)rollInPaths.at(i).size() != last_index - start_index + 1)
+        cache.bValid = false;
+    }
+
+    return false;
+  }
+
+  int centralTrajectoryIndex = rollOutNumber/2;
+  cache.offsets.SetParams(rollOutNumber, rollOutDensity);
+  cache.offsets.SetCenter(originalCenter);
+  end_laterals = cache.offsets.endLaterals;
+
+  start_index = close_index;
+  end_index = far_index;
+
+  int nTrim = close_index - cache.iStart;
+  int nNew = last_index - cache.iEnd;
+  WayPoint p;
+  for(unsigned int i=0; i< cache.rollOuts.size(); i++)
+  {
+    vector<WayPoint>& path = cache.rollOuts.at(i);
+    path.erase(path.begin(), path.begin() + nTrim);
+
+    if(nNew == 0) continue;
+
+    double d = end_laterals.at(i);
+    for(int j = cache.iEnd + 1; j <= last_index; j++)
+    {
+      p = originalCenter.at(j);
+      double original_speed = p.v;
+      p.pos.x  = originalCenter.at(j).pos.x - d*cache.offsets.normalX.at(j);
+      p.pos.y  = originalCenter.at(j).pos.y - d*cache.offsets.normalY.at(j);
+      if((int)i!=centralTrajectoryIndex)
+        p.v = original_speed * LANE_CHANGE_SPEED_FACTOR;
+      else
+        p.v = original_speed ;
+      path.push_back(p);
+      sampledPoints.push_back(p);
+    }
+
+    //smooth the new points with the end of the kept part, the first point of the window stays fixed
+    int tail_start = (int)path.size() - nNew - ROLL_OUTS_TAIL_OVERLAP;
+    if(tail_start < 0)
+      tail_start = 0;
+    cache.tail.assign(path.begin() + tail_start, path.end());
+    SmoothPath(cache.tail, SmoothDataWeight, SmoothWeight, SmoothTolerance);
+    std::copy(cache.tail.begin(), cache.tail.end(), path.begin() + tail_start);
+  }
+
+  cache.iStart = close_index;
+  cache.iEnd = last_index;
+  cache.nShifts++;
+
+  rollInPaths.resize(cache.rollOuts.size());
+  for(unsigned int i=0; i< cache.rollOuts.size(); i++)
+    rollInPaths.at(i).assign(cache.rollOuts.at(i).begin(), cache.rollOuts.at(i).end());
+
+  return true;
+}
+
 bool PlanningHelpers::FindInList(const std::vector<int>& list,const int& x)
 {
   for(unsigned int i = 0 ; i < list.size(); i++)
@@ -1824,11 +2358,32 @@ std::vector<int> PlanningHelpers::GetUniqueLeftRightIds(const std::vector<WayPoi
 }
 
 void PlanningHelpers::SmoothSpeedProfiles(vector<WayPoint>& path_in, double weight_data, double weight_smooth, double tolerance  )
+{
+  PlanningContext context(m_SmoothingMethod);
+  SmoothSpeedProfiles(path_in, weight_data, weight_smooth, tolerance, context);
+}
+
+void PlanningHelpers::SmoothSpeedProfiles(vector<WayPoint>& path_in, const double& weight_data, const double& weight_smooth, const double& tolerance,
+    PlanningContext& context)
 {
 
   if (path_in.size() <= 1)
     return;
-  vector<WayPoint> newpath = path_in;
+
+  if(context.smoothingMethod == SMOOTHING_DIRECT)
+  {
+    vector<double>& values = context.x;
+    values.resize(path_in.size());
+    for(unsigned int i = 0; i < path_in.size(); i++)
+      values[i] = path_in[i].v;
+    SmoothValuesDirect(values, weight_data, weight_smooth, context.solverBuffer);
+    for(unsigned int i = 0; i < path_in.size(); i++)
+      path_in[i].v = values[i];
+    return;
+  }
+
+  vector<WayPoint>& newpath = context.pathBuffer;
+  newpath.assign(path_in.begin(), path_in.end());
 
   double change = tolerance;
   double xtemp;
@@ -1849,13 +2404,25 @@ void PlanningHelpers::SmoothSpeedProfiles(vector<WayPoint>& path_in, double weig
     nIterations++;
   }
 
-  path_in = newpath;
+  path_in.swap(newpath);
 }
 
 void PlanningHelpers::SmoothCurvatureProfiles(vector<WayPoint>& path_in, double weight_data, double weight_smooth, double tolerance)
 {
   if (path_in.size() <= 1)
       return;
+
+  if(m_SmoothingMethod == SMOOTHING_DIRECT)
+  {
+    vector<double> values(path_in.size()), buffer;
+    for(unsigned int i = 0; i < path_in.size(); i++)
+      values[i] = path_in[i].cost;
+    SmoothValuesDirect(values, weight_data, weight_smooth, buffer);
+    for(unsigned int i = 0; i < path_in.size(); i++)
+      path_in[i].cost = values[i];
+    return;
+  }
+
   vector<WayPoint> newpath = path_in;
 
   double change = tolerance;
@@ -1885,6 +2452,18 @@ void PlanningHelpers::SmoothWayPointsDirections(vector<WayPoint>& path_in, doubl
   if (path_in.size() <= 1)
     return;
 
+  if(m_SmoothingMethod == SMOOTHING_DIRECT)
+  {
+    vector<double> values(path_in.size()), buffer;
+    for(unsigned int i = 0; i < path_in.size(); i++)
+      values[i] = path_in[i].pos.a;
+    SmoothValuesDirect(values, weight_data, weight_smooth, buffer);
+    for(unsigned int i = 0; i < path_in.size(); i++)
+      path_in[i].pos.a = values[i];
+    return;
+  }
+
+
   vector<WayPoint> newpath = path_in;
 
   double change = tolerance;
@@ -1911,12 +2490,27 @@ void PlanningHelpers::SmoothWayPointsDirections(vector<WayPoint>& path_in, doubl
 void PlanningHelpers::SmoothGlobalPathSpeed(vector<WayPoint>& path)
 {
   CalcAngleAndCostAndCurvatureAnd2D(path);
+  if(m_VelocityProfileMethod == VELOCITY_PROFILE_SWEEP)
+  {
+    //the speeds already on the path are the caps, only the acceleration limits are added
+    GenerateVelocityProfile(path, DBL_MAX, m_ProfileMaxAcceleration, m_ProfileMaxDeceleration, 0);
+    return;
+  }
+
   SmoothSpeedProfiles(path, 0.45,0.25, 0.01);
 }
 
 void PlanningHelpers::GenerateRecommendedSpeed(vector<WayPoint>& path, const double& max_speed, const double& speedProfileFactor)
 {
   CalcAngleAndCostAndCurvatureAnd2D(path);
+  if(m_VelocityProfileMethod == VELOCITY_PROFILE_SWEEP)
+  {
+    //speedProfileFactor scales the curve speeds as in the curvature ratio profile
+    double lateral_acceleration = m_ProfileMaxLateralAcceleration*speedProfileFactor*speedProfileFactor;
+    GenerateVelocityProfile(path, max_speed, m_ProfileMaxAcceleration, m_ProfileMaxDeceleration, lateral_acceleration);
+    return;
+  }
+
   SmoothCurvatureProfiles(path, 0.4, 0.3, 0.01);
   double v = 0;
 
@@ -1946,21 +2540,82 @@ void PlanningHelpers::GenerateRecommendedSpeed(vector<WayPoint>& path, const dou
   SmoothSpeedProfiles(path, 0.4,0.3, 0.01);
 }
 
-WayPoint* PlanningHelpers::BuildPlanningSearchTreeV2(WayPoint* pStart,
+void PlanningHelpers::GenerateVelocityProfile(vector<WayPoint>& path, const double& max_speed, const double& max_acceleration,
+    const double& max_deceleration, const double& max_lateral_acceleration, const double& start_speed, const double& end_speed)
+{
+  if(path.size() == 0) return;
+
+  PathGeometry geometry;
+  geometry.Update(path);
+
+  for(unsigned int i = 0; i < path.size(); i++)
+  {
+    double v = max_speed;
+    if(path.at(i).v >= 0 && path.at(i).v < v)
+      v = path.at(i).v;
+
+    if(max_lateral_acceleration > 0 && geometry.kappa.size() == path.size() && geometry.kappa.at(i) > 0)
+    {
+      double v_curve = sqrt(max_lateral_acceleration/geometry.kappa.at(i));
+      if(v_curve < v)
+        v = v_curve;
+    }
+    path.at(i).v = v;
+  }
+
+  if(start_speed >= 0 && start_speed < path.at(0).v)
+    path.at(0).v = start_speed;
+
+  if(max_acceleration > 0)
+  {
+    for(unsigned int i = 1; i < path.size(); i++)
+    {
+      double ds = geometry.s.at(i) - geometry.s.at(i-1);
+      double v_reach = sqrt(path.at(i-1).v*path.at(i-1).v + 2.0*max_acceleration*ds);
+      if(v_reach < path.at(i).v)
+        path.at(i).v = v_reach;
+    }
+  }
+
+  unsigned int last = path.size()-1;
+  if(end_speed >= 0 && end_speed < path.at(last).v)
+    path.at(last).v = end_speed;
+
+  if(max_deceleration > 0)
+  {
+    for(int i = (int)last - 1; i >= 0; i--)
+    {
+      double ds = geometry.s.at(i+1) - geometry.s.at(i);
+      double v_stop = sqrt(path.at(i+1).v*path.at(i+1).v + 2.0*max_deceleration*ds);
+      if(v_stop < path.at(i).v)
+        path.at(i).v = v_stop;
+    }
+  }
+}
+
+//search tree node from the arena if there is one, otherwise the caller deletes it
+static WayPoint* CreateSearchNode(const WayPoint& wp, WayPointArena* pArena)
+{
+  if(pArena)
+    return pArena->Create(wp);
+
+  return new WayPoint(wp);
+}
+
+WayPoint* PlanningHelpers::BuildPlanningSearchTreeV2(const WayPoint* pStart,
     const WayPoint& goalPos,
     const vector<int>& globalPath,
     const double& DistanceLimit,
     const bool& bEnableLaneChange,
     vector<WayPoint*>& all_cells_to_delete,
-    double fallback_min_goal_distance_th)
+    double fallback_min_goal_distance_th, WayPointArena* pArena)
 {
   if(!pStart) return nullptr;
 
   vector<pair<WayPoint*, WayPoint*> >nextLeafToTrace;
 
   WayPoint* pZero = 0;
-  WayPoint* wp    = new WayPoint();
-  *wp = *pStart;
+  WayPoint* wp    = CreateSearchNode(*pStart, pArena);
   nextLeafToTrace.push_back(make_pair(pZero, wp));
   all_cells_to_delete.push_back(wp);
 
@@ -2013,8 +2668,7 @@ WayPoint* PlanningHelpers::BuildPlanningSearchTreeV2(WayPoint* pStart,
 
       if(pH->pLeft && !CheckLaneExits(all_cells_to_delete, pH->pLeft->pLane) && !CheckNodeExits(all_cells_to_delete, pH->pLeft) && bEnableLaneChange && before_change_distance > LANE_CHANGE_MIN_DISTANCE)
       {
-        wp = new WayPoint();
-        *wp = *pH->pLeft;
+        wp = CreateSearchNode(*pH->pLeft, pArena);
         double d = hypot(wp->pos.y - pH->pos.y, wp->pos.x - pH->pos.x);
         distance += d;
         before_change_distance = -LANE_CHANGE_MIN_DISTANCE*3;
@@ -2035,8 +2689,7 @@ WayPoint* PlanningHelpers::BuildPlanningSearchTreeV2(WayPoint* pStart,
 
       if(pH->pRight && !CheckLaneExits(all_cells_to_delete, pH->pRight->pLane) && !CheckNodeExits(all_cells_to_delete, pH->pRight) && bEnableLaneChange && before_change_distance > LANE_CHANGE_MIN_DISTANCE)
       {
-        wp = new WayPoint();
-        *wp = *pH->pRight;
+        wp = CreateSearchNode(*pH->pRight, pArena);
         double d = hypot(wp->pos.y - pH->pos.y, wp->pos.x - pH->pos.x);
         distance += d;
         before_change_distance = -LANE_CHANGE_MIN_DISTANCE*3;
@@ -2058,8 +2711,7 @@ WayPoint* PlanningHelpers::BuildPlanningSearchTreeV2(WayPoint* pStart,
       {
         if(CheckLaneIdExits(globalPath, pH->pLane) && pH->pFronts.at(i) && !CheckNodeExits(all_cells_to_delete, pH->pFronts.at(i)))
         {
-          wp = new WayPoint();
-          *wp = *pH->pFronts.at(i);
+          wp = CreateSearchNode(*pH->pFronts.at(i), pArena);
 
           double d = hypot(wp->pos.y - pH->pos.y, wp->pos.x - pH->pos.x);
           distance += d;
@@ -2132,17 +2784,269 @@ WayPoint* PlanningHelpers::BuildPlanningSearchTreeV2(WayPoint* pStart,
   return pGoalCell;
 }
 
-WayPoint* PlanningHelpers::BuildPlanningSearchTreeStraight(WayPoint* pStart,
+//open list entry of the A* search, the tree node is created when the entry is popped
+class AStarEntry
+{
+public:
+  double f;
+  double g;
+  double before_change_distance;
+  unsigned long order;
+  const WayPoint* pMapNode;
+  WayPoint* pParent;
+  ACTION_TYPE action;
+};
+
+//min f first, insertion order breaks ties so the search is deterministic
+class AStarEntryCompare
+{
+public:
+  bool operator()(const AStarEntry& e1, const AStarEntry& e2) const
+  {
+    if(e1.f != e2.f)
+      return e1.f > e2.f;
+    return e1.order > e2.order;
+  }
+};
+
+static long long GetSearchNodeKey(const WayPoint* p)
+{
+  return ((long long)p->laneId << 32) ^ (unsigned int)p->id;
+}
+
+typedef std::priority_queue<AStarEntry, std::vector<AStarEntry>, AStarEntryCompare> AStarOpenList;
+
+//open list entries of the side lanes and the next waypoints of the expanded node pH, with the distance to pHeuristicGoal
+//added to f for A*, Dijkstra without it
+static void PushSearchNeighbors(const AStarEntry& curr, WayPoint* pH, const WayPoint* pHeuristicGoal,
+    const vector<int>& globalPath, const bool& bEnableLaneChange,
+    const std::unordered_map<long long, WayPoint*>& closed_nodes, const std::unordered_set<const Lane*>& closed_lanes,
+    unsigned long& order, AStarOpenList& open_list)
+{
+  //neighbors come from the map node, the tree node left/right pointers are used for the lane change parent
+  const WayPoint* pMapNode = curr.pMapNode;
+  WayPoint* pSides[2] = {pMapNode->pLeft, pMapNode->pRight};
+  ACTION_TYPE side_actions[2] = {LEFT_TURN_ACTION, RIGHT_TURN_ACTION};
+  for(int is = 0; is < 2; is++)
+  {
+    WayPoint* pSide = pSides[is];
+    if(!pSide || !bEnableLaneChange || curr.before_change_distance <= LANE_CHANGE_MIN_DISTANCE) continue;
+    if(closed_lanes.find(pSide->pLane) != closed_lanes.end() || closed_nodes.find(GetSearchNodeKey(pSide)) != closed_nodes.end()) continue;
+
+    double d = hypot(pSide->pos.y - pH->pos.y, pSide->pos.x - pH->pos.x);
+    for(unsigned int a = 0; a < pSide->actionCost.size(); a++)
+      d += pSide->actionCost.at(a).second;
+
+    AStarEntry next;
+    next.g = curr.g + d;
+    next.f = pHeuristicGoal ? next.g + distance2points(pSide->pos, pHeuristicGoal->pos) : next.g;
+    next.before_change_distance = -LANE_CHANGE_MIN_DISTANCE*3;
+    next.order = order++;
+    next.pMapNode = pSide;
+    next.pParent = pH;
+    next.action = side_actions[is];
+    open_list.push(next);
+  }
+
+  if(!PlanningHelpers::CheckLaneIdExits(globalPath, pH->pLane)) return;
+
+  for(unsigned int i = 0; i < pMapNode->pFronts.size(); i++)
+  {
+    WayPoint* pFront = pMapNode->pFronts.at(i);
+    if(!pFront || closed_nodes.find(GetSearchNodeKey(pFront)) != closed_nodes.end()) continue;
+
+    double d = hypot(pFront->pos.y - pH->pos.y, pFront->pos.x - pH->pos.x);
+    AStarEntry next;
+    next.before_change_distance = curr.before_change_distance + d;
+    for(unsigned int a = 0; a < pFront->actionCost.size(); a++)
+      d += pFront->actionCost.at(a).second;
+
+    next.g = curr.g + d;
+    next.f = pHeuristicGoal ? next.g + distance2points(pFront->pos, pHeuristicGoal->pos) : next.g;
+    next.order = order++;
+    next.pMapNode = pFront;
+    next.pParent = pH;
+    next.action = FORWARD_ACTION;
+    open_list.push(next);
+  }
+}
+
+//tree node of the popped entry, linked to its parent by the action that reached it
+static WayPoint* CreateSearchTreeNode(const AStarEntry& curr, WayPointArena* pArena)
+{
+  WayPoint* pH = CreateSearchNode(*curr.pMapNode, pArena);
+  pH->cost = curr.g;
+  if(curr.action == LEFT_TURN_ACTION)
+  {
+    pH->pRight = curr.pParent;
+    pH->pLeft = 0;
+  }
+  else if(curr.action == RIGHT_TURN_ACTION)
+  {
+    pH->pLeft = curr.pParent;
+    pH->pRight = 0;
+  }
+  else if(curr.pParent)
+  {
+    pH->pBacks.push_back(curr.pParent);
+  }
+  return pH;
+}
+
+WayPoint* PlanningHelpers::BuildPlanningSearchTreeAStar(const WayPoint* pStart,
+    const WayPoint& goalPos,
+    const vector<int>& globalPath,
+    const double& DistanceLimit,
+    const bool& bEnableLaneChange,
+    vector<WayPoint*>& all_cells_to_delete,
+    double fallback_min_goal_distance_th, WayPointArena* pArena)
+{
+  if(!pStart) return nullptr;
+
+  AStarOpenList open_list;
+  std::unordered_map<long long, WayPoint*> closed_nodes;
+  std::unordered_set<const Lane*> closed_lanes;
+  unsigned long order = 0;
+
+  AStarEntry e;
+  e.g = pStart->cost;
+  e.f = e.g + distance2points(pStart->pos, goalPos.pos);
+  e.before_change_distance = 0;
+  e.order = order++;
+  e.pMapNode = pStart;
+  e.pParent = nullptr;
+  e.action = FORWARD_ACTION;
+  open_list.push(e);
+
+  WayPoint* pGoalCell = nullptr;
+  WayPoint* pMinGoalDistanceNode = nullptr;
+  double min_goal_distance_to_waypoint = std::numeric_limits<double>::max();
+
+  while(open_list.size() > 0)
+  {
+    AStarEntry curr = open_list.top();
+    open_list.pop();
+
+    long long key = GetSearchNodeKey(curr.pMapNode);
+    if(closed_nodes.find(key) != closed_nodes.end())
+      continue;
+
+    WayPoint* pH = CreateSearchTreeNode(curr, pArena);
+    all_cells_to_delete.push_back(pH);
+    closed_nodes[key] = pH;
+    closed_lanes.insert(pH->pLane);
+
+    double distance_to_goal = distance2points(pH->pos, goalPos.pos);
+    double angle_to_goal = UtilityH::AngleBetweenTwoAnglesPositive(UtilityH::FixNegativeAngle(pH->pos.a), UtilityH::FixNegativeAngle(goalPos.pos.a));
+    if(distance_to_goal <= 0.1 && angle_to_goal < M_PI_4)
+    {
+      pGoalCell = pH;
+      break;
+    }
+
+    if(distance_to_goal < min_goal_distance_to_waypoint)
+    {
+      min_goal_distance_to_waypoint = distance_to_goal;
+      pMinGoalDistanceNode = pH;
+    }
+
+    if(curr.g - pStart->cost > DistanceLimit && globalPath.size()==0)
+    {
+      cout << "Goal Not Found, LaneID: " << pH->laneId <<", Distance : " << curr.g - pStart->cost << endl;
+      pGoalCell = pH;
+      break;
+    }
+
+    PushSearchNeighbors(curr, pH, &goalPos, globalPath, bEnableLaneChange, closed_nodes, closed_lanes, order, open_list);
+  }
+
+  if(!pGoalCell && pMinGoalDistanceNode && min_goal_distance_to_waypoint < fallback_min_goal_distance_th)
+  {
+    cout << endl << "PlanningHelpers::BuildPlanningSearchTreeAStar goal not reached, closest node at: "
+        << min_goal_distance_to_waypoint << endl;
+    pGoalCell = pMinGoalDistanceNode;
+  }
+
+  return pGoalCell;
+}
+
+int PlanningHelpers::BuildPlanningSearchTreeMultiGoal(const WayPoint* pStart,
+    const vector<WayPoint>& goals,
+    const vector<int>& globalPath,
+    const double& DistanceLimit,
+    const bool& bEnableLaneChange,
+    vector<WayPoint*>& all_cells_to_delete,
+    vector<WayPoint*>& goalCells,
+    WayPointArena* pArena)
+{
+  goalCells.assign(goals.size(), nullptr);
+  if(!pStart || goals.size() == 0) return 0;
+
+  AStarOpenList open_list;
+  std::unordered_map<long long, WayPoint*> closed_nodes;
+  std::unordered_set<const Lane*> closed_lanes;
+  unsigned long order = 0;
+
+  AStarEntry e;
+  e.g = pStart->cost;
+  e.f = e.g;
+  e.before_change_distance = 0;
+  e.order = order++;
+  e.pMapNode = pStart;
+  e.pParent = nullptr;
+  e.action = FORWARD_ACTION;
+  open_list.push(e);
+
+  vector<double> goal_angles(goals.size());
+  for(unsigned int ig = 0; ig < goals.size(); ig++)
+    goal_angles.at(ig) = UtilityH::FixNegativeAngle(goals.at(ig).pos.a);
+
+  int nReached = 0;
+  while(open_list.size() > 0 && nReached < (int)goals.size())
+  {
+    AStarEntry curr = open_list.top();
+    open_list.pop();
+
+    long long key = GetSearchNodeKey(curr.pMapNode);
+    if(closed_nodes.find(key) != closed_nodes.end())
+      continue;
+
+    if(curr.g - pStart->cost > DistanceLimit)
+      break;
+
+    WayPoint* pH = CreateSearchTreeNode(curr, pArena);
+    all_cells_to_delete.push_back(pH);
+    closed_nodes[key] = pH;
+    closed_lanes.insert(pH->pLane);
+
+    //same goal test as the A* search, the first node popped is the one with the lowest cost
+    double node_angle = UtilityH::FixNegativeAngle(pH->pos.a);
+    for(unsigned int ig = 0; ig < goals.size(); ig++)
+    {
+      if(goalCells.at(ig)) continue;
+      if(distance2points(pH->pos, goals.at(ig).pos) <= 0.1 && UtilityH::AngleBetweenTwoAnglesPositive(node_angle, goal_angles.at(ig)) < M_PI_4)
+      {
+        goalCells.at(ig) = pH;
+        nReached++;
+      }
+    }
+
+    PushSearchNeighbors(curr, pH, nullptr, globalPath, bEnableLaneChange, closed_nodes, closed_lanes, order, open_list);
+  }
+
+  return nReached;
+}
+
+WayPoint* PlanningHelpers::BuildPlanningSearchTreeStraight(const WayPoint* pStart,
     const double& DistanceLimit,
-    vector<WayPoint*>& all_cells_to_delete)
+    vector<WayPoint*>& all_cells_to_delete, WayPointArena* pArena)
 {
   if(!pStart) return nullptr;
 
   vector<pair<WayPoint*, WayPoint*> >nextLeafToTrace;
 
   WayPoint* pZero = 0;
-  WayPoint* wp    = new WayPoint();
-  *wp = *pStart;
+  WayPoint* wp    = CreateSearchNode(*pStart, pArena);
   wp->cost = 0;
   nextLeafToTrace.push_back(make_pair(pZero, wp));
   all_cells_to_delete.push_back(wp);
@@ -2176,10 +3080,8 @@ WayPoint* PlanningHelpers::BuildPlanningSearchTreeStraight(WayPoint* pStart,
     {
       if(pH->pFronts.at(i) && !CheckNodeExits(all_cells_to_delete, pH->pFronts.at(i)))
       {
-        wp = new WayPoint();
-        *wp = *pH->pFronts.at(i);
-
-        double d = hypot(wp->pos.y - pH->pos.y, wp->pos.x - pH->pos.x);
+        const WayPoint* pFront = pH->pFronts.at(i);
+        double d = hypot(pFront->pos.y - pH->pos.y, pFront->pos.x - pH->pos.x);
         distance += d;
 
 //        for(unsigned int a = 0; a < wp->actionCost.size(); a++)
@@ -2188,15 +3090,15 @@ WayPoint* PlanningHelpers::BuildPlanningSearchTreeStraight(WayPoint* pStart,
 //            d += wp->actionCost.at(a).second;
 //        }
 
-        wp->cost = pH->cost + d;
-        wp->pBacks.push_back(pH);
-        if(wp->cost < DistanceLimit)
+        //only nodes inside the limit are created, arena nodes can't be deleted one by one
+        if(pH->cost + d < DistanceLimit)
         {
+          wp = CreateSearchNode(*pFront, pArena);
+          wp->cost = pH->cost + d;
+          wp->pBacks.push_back(pH);
           nextLeafToTrace.push_back(make_pair(pH, wp));
           all_cells_to_delete.push_back(wp);
         }
-        else
-          delete wp;
       }
     }
 
@@ -2248,16 +3150,15 @@ WayPoint* PlanningHelpers::BuildPlanningSearchTreeStraight(WayPoint* pStart,
   return pGoalCell;
 }
 
-int PlanningHelpers::PredictiveIgnorIdsDP(WayPoint* pStart, const double& DistanceLimit,
-    vector<WayPoint*>& all_cells_to_delete,vector<WayPoint*>& end_waypoints, std::vector<int>& lanes_ids)
+int PlanningHelpers::PredictiveIgnorIdsDP(const WayPoint* pStart, const double& DistanceLimit,
+    vector<WayPoint*>& all_cells_to_delete,vector<WayPoint*>& end_waypoints, std::vector<int>& lanes_ids, WayPointArena* pArena)
 {
   if(!pStart) return 0;
 
     vector<pair<WayPoint*, WayPoint*> >nextLeafToTrace;
 
     WayPoint* pZero = 0;
-    WayPoint* wp    = new WayPoint();
-    *wp = *pStart;
+    WayPoint* wp    = CreateSearchNode(*pStart, pArena);
     wp->cost = 0;
     wp->pLeft = 0;
     wp->pRight = 0;
@@ -2284,8 +3185,7 @@ int PlanningHelpers::PredictiveIgnorIdsDP(WayPoint* pStart, const double& Distan
         {
           if(pH->cost < DistanceLimit)
           {
-            wp = new WayPoint();
-            *wp = *pH->pFronts.at(i);
+            wp = CreateSearchNode(*pH->pFronts.at(i), pArena);
 
             double d = distance2points(wp->pos, pH->pos);
             distance += d;
@@ -2323,16 +3223,15 @@ int PlanningHelpers::PredictiveIgnorIdsDP(WayPoint* pStart, const double& Distan
     return end_waypoints.size();
 }
 
-int PlanningHelpers::PredictiveDP(WayPoint* pStart, const double& DistanceLimit,
-    vector<WayPoint*>& all_cells_to_delete,vector<WayPoint*>& end_waypoints)
+int PlanningHelpers::PredictiveDP(const WayPoint* pStart, const double& DistanceLimit,
+    vector<WayPoint*>& all_cells_to_delete,vector<WayPoint*>& end_waypoints, WayPointArena* pArena)
 {
   if(!pStart) return 0;
 
   vector<pair<WayPoint*, WayPoint*> >nextLeafToTrace;
 
   WayPoint* pZero = 0;
-  WayPoint* wp    = new WayPoint();
-  *wp = *pStart;
+  WayPoint* wp    = CreateSearchNode(*pStart, pArena);
   wp->pLeft = 0;
   wp->pRight = 0;
   nextLeafToTrace.push_back(make_pair(pZero, wp));
@@ -2358,8 +3257,7 @@ int PlanningHelpers::PredictiveDP(WayPoint* pStart, const double& DistanceLimit,
       {
         if(pH->cost < DistanceLimit)
         {
-          wp = new WayPoint();
-          *wp = *pH->pFronts.at(i);
+          wp = CreateSearchNode(*pH->pFronts.at(i), pArena);
 
           double d = distance2points(wp->pos, pH->pos);
           distance += d;
@@ -2566,8 +3464,9 @@ void PlanningHelpers::ExtractPlanAlernatives(const std::vector<WayPoint>& single
       RelativeInfo start_info;
       PlanningHelpers::GetRelativeInfo(start_point.pLane->points, start_point, start_info);
       vector<WayPoint*> local_cell_to_delete;
+      WayPointArena local_arena;
       PlannerHNS::WayPoint* pStart = &start_point.pLane->points.at(start_info.iFront);
-      WayPoint* pLaneCell =  PlanningHelpers::BuildPlanningSearchTreeStraight(pStart, BACKUP_STRAIGHT_PLAN_DISTANCE, local_cell_to_delete);
+      WayPoint* pLaneCell =  PlanningHelpers::BuildPlanningSearchTreeStraight(pStart, BACKUP_STRAIGHT_PLAN_DISTANCE, local_cell_to_delete, &local_arena);
       if(pLaneCell)
       {
         vector<WayPoint> straight_path;
@@ -2601,7 +3500,7 @@ void PlanningHelpers::ExtractPlanAlernatives(const std::vector<WayPoint>& single
   allPaths.push_back(path);
 }
 
-void PlanningHelpers::TraversePathTreeBackwards(WayPoint* pHead, WayPoint* pStartWP,const vector<int>& globalPathIds,
+void PlanningHelpers::TraversePathTreeBackwards(WayPoint* pHead, const WayPoint* pStartWP,const vector<int>& globalPathIds,
     vector<WayPoint>& localPath, std::vector<std::vector<WayPoint> >& localPaths)
 {
   if(pHead != nullptr && pHead->id != pStartWP->id)
@@ -2678,7 +3577,8 @@ ACTION_TYPE PlanningHelpers::GetBranchingDirection(WayPoint& currWP, WayPoint& n
 
 void PlanningHelpers::CalcContourPointsForDetectedObjects(const WayPoint& currPose, vector<DetectedObject>& obj_list, const double& filterDistance)
 {
-  vector<DetectedObject> res_list;
+  // the kept objects are moved to the front, no copy of their trajectories
+  unsigned int n = 0;
   for(unsigned int i = 0; i < obj_list.size(); i++)
   {
     GPSPoint center = obj_list.at(i).center.pos;
@@ -2686,40 +3586,45 @@ void PlanningHelpers::CalcContourPointsForDetectedObjects(const WayPoint& currPo
 
     if(distance < filterDistance)
     {
-      DetectedObject obj = obj_list.at(i);
+      if(i != n)
+        std::swap(obj_list.at(n), obj_list.at(i));
+      DetectedObject& obj = obj_list.at(n);
 
-      Mat3 rotationMat(center.a);
-      Mat3 translationMat(center.x, center.y);
-      double w2 = obj.w/2.0;
-      double h2 = obj.l/2.0;
-      double z = center.z + obj.h/2.0;
+      PolygonGeometry::GetOrientedRectangle(center, obj.w, obj.l, center.z + obj.h/2.0, obj.contour);
 
-      GPSPoint left_bottom(-w2, -h2, z,0);
-      GPSPoint right_bottom(w2,-h2, z,0);
-      GPSPoint right_top(w2,h2, z,0);
-      GPSPoint left_top(-w2,h2, z,0);
+      n++;
+    }
+  }
 
-      left_bottom   = rotationMat * left_bottom;
-      right_bottom   = rotationMat * right_bottom;
-      right_top     = rotationMat * right_top;
-      left_top     = rotationMat * left_top;
+  obj_list.resize(n);
+}
 
-      left_bottom   = translationMat * left_bottom;
-      right_bottom   = translationMat * right_bottom;
-      right_top     = translationMat * right_top;
-      left_top     = translationMat * left_top;
+void PlanningHelpers::CalcContourPointsForDetectedObjects(const WayPoint& currPose, vector<DetectedObject>& obj_list, const double& filterDistance,
+    ObjectContoursCache& cache, const ContourCorridor* pCorridor)
+{
+  unsigned int n = 0;
+  for(unsigned int i = 0; i < obj_list.size(); i++)
+  {
+    double distance = distance2points(obj_list.at(i).center.pos, currPose.pos);
 
-      obj.contour.clear();
-      obj.contour.push_back(left_bottom);
-      obj.contour.push_back(right_bottom);
-      obj.contour.push_back(right_top);
-      obj.contour.push_back(left_top);
+    if(distance < filterDistance)
+    {
+      if(i != n)
+        std::swap(obj_list.at(n), obj_list.at(i));
+      DetectedObject& obj = obj_list.at(n);
 
-      res_list.push_back(obj);
+      // the corners are within half the diagonal of the center
+      if(pCorridor && !pCorridor->IsNear(obj.center.pos, hypot(obj.w, obj.l)/2.0))
+        obj.contour.clear();
+      else
+        obj.contour = cache.GetContour(obj);
+
+      n++;
     }
   }
 
-  obj_list = res_list;
+  obj_list.resize(n);
+  cache.RemoveUnused();
 }
 
 double PlanningHelpers::GetVelocityAhead(const std::vector<WayPoint>& path, const RelativeInfo& info, int& prev_index, const double& reasonable_brake_distance)
@@ -2766,6 +3671,21 @@ void PlanningHelpers::WritePathToFile(const string& fileName, const vector<WayPo
    dataFile.WriteLogData("", fileName, str_header.str(), dataList);
 }
 
+int PlanningHelpers::AddPathLog(UtilityHNS::AsyncLogger& logger, const std::string& title)
+{
+  return logger.AddLog(title, "laneID,wpID,x,y,a,cost,Speed,");
+}
+
+void PlanningHelpers::LogPath(UtilityHNS::AsyncLogger& logger, const int& log, const std::vector<WayPoint>& path)
+{
+  for(unsigned int i=0; i<path.size(); i++)
+  {
+    double values[] = {(double)path.at(i).laneId, (double)path.at(i).id, path.at(i).pos.x, path.at(i).pos.y,
+        path.at(i).pos.a, path.at(i).cost, path.at(i).v};
+    logger.Log(log, values, 7);
+  }
+}
+
 LIGHT_INDICATOR PlanningHelpers::GetIndicatorsFromPath(const std::vector<WayPoint>& path, const WayPoint& pose,  const double& seachDistance)
 {
   if(path.size() < 2)
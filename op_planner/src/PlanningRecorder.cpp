@@ -0,0 +1,703 @@
+/// \file PlanningRecorder.cpp
+/// \brief Binary recording of the converted planner inputs and their replay through the planning modules, no ROS node needed
+/// \date Oct 14, 2026
+
+#include "op_planner/PlanningRecorder.h"
+#include "op_planner/DecisionMaker.h"
+#include "op_planner/TrajectoryDynamicCosts.h"
+#include "op_planner/BehaviorPrediction.h" // includes PlannerH.h, which has no include guard
+#include "op_planner/PlanningHelpers.h"
+#include "op_planner/RoadNetworkSnapshot.h"
+#include "op_utility/UtilityH.h"
+#include <type_traits>
+#include <sstream>
+#include <cstring>
+#include <thread>
+#include <chrono>
+
+using namespace std;
+
+namespace PlannerHNS
+{
+
+const unsigned int PlanningRecorder::FORMAT_VERSION;
+
+static const char RECORDING_MAGIC[8] = {'O', 'P', 'R', 'E', 'C', 'O', 'R', 'D'};
+static const unsigned int RECORDING_BYTE_ORDER = 0x01020304;
+static const char* REPLAY_STAGE_NAMES[REPLAY_STAGES_COUNT] = {"Prediction", "RollOuts", "TrajectoryCosts", "Decision", "Cycle"};
+
+//appends the fields of the planner inputs to a record payload
+class RecordPayloadWriter
+{
+public:
+  std::string& m_Data;
+
+  RecordPayloadWriter(std::string& data) : m_Data(data)
+  {
+  }
+
+  template<typename T> void Write(const T& value)
+  {
+    static_assert(std::is_trivially_copyable<T>::value, "only plain values are written as is");
+    m_Data.append((const char*)&value, sizeof(T));
+  }
+
+  template<typename T> void WriteVector(const std::vector<T>& values)
+  {
+    static_assert(std::is_trivially_copyable<T>::value, "only plain values are written as is");
+    Write<unsigned int>(values.size());
+    if(values.size() > 0)
+      m_Data.append((const char*)values.data(), values.size()*sizeof(T));
+  }
+
+  void WriteString(const std::string& str)
+  {
+    Write<unsigned int>(str.size());
+    m_Data.append(str);
+  }
+
+  void WriteWayPoint(const WayPoint& wp)
+  {
+    Write(wp.pos);
+    Write(wp.rot);
+    Write<double>(wp.v);
+    Write<double>(wp.cost);
+    Write<double>(wp.timeCost);
+    Write<double>(wp.totalReward);
+    Write<double>(wp.collisionCost);
+    Write<double>(wp.laneChangeCost);
+    Write<int>(wp.laneId);
+    Write<int>(wp.id);
+    Write<int>(wp.LeftPointId);
+    Write<int>(wp.RightPointId);
+    Write<int>(wp.LeftLnId);
+    Write<int>(wp.RightLnId);
+    Write<int>(wp.stopLineID);
+    Write<int>(wp.bDir);
+    Write<int>(wp.state);
+    Write<int>(wp.beh_state);
+    Write<int>(wp.iOriginalIndex);
+    Write<int>(wp.originalMapID);
+    Write<int>(wp.gid);
+    WriteVector(wp.toIds);
+    WriteVector(wp.fromIds);
+  }
+
+  void WritePath(const std::vector<WayPoint>& path)
+  {
+    Write<unsigned int>(path.size());
+    for(unsigned int i = 0; i < path.size(); i++)
+      WriteWayPoint(path.at(i));
+  }
+
+  void WritePaths(const std::vector<std::vector<WayPoint> >& paths)
+  {
+    Write<unsigned int>(paths.size());
+    for(unsigned int i = 0; i < paths.size(); i++)
+      WritePath(paths.at(i));
+  }
+
+  void WriteObject(const DetectedObject& obj)
+  {
+    Write<int>(obj.id);
+    WriteString(obj.label);
+    Write<int>(obj.t);
+    WriteWayPoint(obj.center);
+    WriteWayPoint(obj.predicted_center);
+    WriteWayPoint(obj.noisy_center);
+    Write<int>(obj.predicted_behavior);
+    WritePath(obj.centers_list);
+    WriteVector(obj.contour);
+    WritePaths(obj.predTrajectories);
+    Write<double>(obj.w);
+    Write<double>(obj.l);
+    Write<double>(obj.h);
+    Write<double>(obj.distance_to_center);
+    Write<double>(obj.actual_speed);
+    Write<double>(obj.actual_yaw);
+    Write<bool>(obj.bDirection);
+    Write<bool>(obj.bVelocity);
+    Write<int>(obj.acceleration);
+    Write<int>(obj.acceleration_desc);
+    Write<double>(obj.acceleration_raw);
+    Write<int>(obj.indicator_state);
+    Write<int>(obj.originalID);
+    Write<int>(obj.behavior_state);
+  }
+};
+
+//reads a record payload back, every read is bounds checked and a failed read leaves m_bOk false
+class RecordPayloadReader
+{
+public:
+  const std::string& m_Data;
+  size_t m_Pos;
+  bool m_bOk;
+
+  RecordPayloadReader(const std::string& data) : m_Data(data)
+  {
+    m_Pos = 0;
+    m_bOk = true;
+  }
+
+  bool Has(const size_t& nBytes)
+  {
+    if(!m_bOk || m_Data.size() - m_Pos < nBytes)
+      m_bOk = false;
+    return m_bOk;
+  }
+
+  template<typename T> void Read(T& value)
+  {
+    static_assert(std::is_trivially_copyable<T>::value, "only plain values are read as is");
+    if(!Has(sizeof(T))) return;
+    memcpy((void*)&value, m_Data.data() + m_Pos, sizeof(T));
+    m_Pos += sizeof(T);
+  }
+
+  template<typename E> void ReadEnum(E& value)
+  {
+    int v = 0;
+    Read<int>(v);
+    value = (E)v;
+  }
+
+  unsigned int ReadSize()
+  {
+    unsigned int n = 0;
+    Read<unsigned int>(n);
+    //a size larger than the rest of the payload is a damaged record
+    if(m_bOk && n > m_Data.size() - m_Pos)
+      m_bOk = false;
+    return m_bOk ? n : 0;
+  }
+
+  template<typename T> void ReadVector(std::vector<T>& values)
+  {
+    static_assert(std::is_trivially_copyable<T>::value, "only plain values are read as is");
+    unsigned int n = ReadSize();
+    if(!Has((size_t)n*sizeof(T)))
+    {
+      values.clear();
+      return;
+    }
+    values.resize(n);
+    if(n > 0)
+      memcpy((void*)values.data(), m_Data.data() + m_Pos, n*sizeof(T));
+    m_Pos += n*sizeof(T);
+  }
+
+  void ReadString(std::string& str)
+  {
+    unsigned int n = ReadSize();
+    if(!Has(n))
+    {
+      str.clear();
+      return;
+    }
+    str.assign(m_Data.data() + m_Pos, n);
+    m_Pos += n;
+  }
+
+  void ReadWayPoint(WayPoint& wp)
+  {
+    Read(wp.pos);
+    Read(wp.rot);
+    Read<double>(wp.v);
+    Read<double>(wp.cost);
+    Read<double>(wp.timeCost);
+    Read<double>(wp.totalReward);
+    Read<double>(wp.collisionCost);
+    Read<double>(wp.laneChangeCost);
+    Read<int>(wp.laneId);
+    Read<int>(wp.id);
+    Read<int>(wp.LeftPointId);
+    Read<int>(wp.RightPointId);
+    Read<int>(wp.LeftLnId);
+    Read<int>(wp.RightLnId);
+    Read<int>(wp.stopLineID);
+    ReadEnum(wp.bDir);
+    ReadEnum(wp.state);
+    ReadEnum(wp.beh_state);
+    Read<int>(wp.iOriginalIndex);
+    Read<int>(wp.originalMapID);
+    Read<int>(wp.gid);
+    ReadVector(wp.toIds);
+    ReadVector(wp.fromIds);
+  }
+
+  void ReadPath(std::vector<WayPoint>& path)
+  {
+    unsigned int n = ReadSize();
+    path.resize(n);
+    for(unsigned int i = 0; i < n && m_bOk; i++)
+      ReadWayPoint(path.at(i));
+  }
+
+  void ReadPaths(std::vector<std::vector<WayPoint> >& paths)
+  {
+    unsigned int n = ReadSize();
+    paths.resize(n);
+    for(unsigned int i = 0; i < n && m_bOk; i++)
+      ReadPath(paths.at(i));
+  }
+
+  void ReadObject(DetectedObject& obj)
+  {
+    Read<int>(obj.id);
+    ReadString(obj.label);
+    ReadEnum(obj.t);
+    ReadWayPoint(obj.center);
+    ReadWayPoint(obj.predicted_center);
+    ReadWayPoint(obj.noisy_center);
+    ReadEnum(obj.predicted_behavior);
+    ReadPath(obj.centers_list);
+    ReadVector(obj.contour);
+    ReadPaths(obj.predTrajectories);
+    Read<double>(obj.w);
+    Read<double>(obj.l);
+    Read<double>(obj.h);
+    Read<double>(obj.distance_to_center);
+    Read<double>(obj.actual_speed);
+    Read<double>(obj.actual_yaw);
+    Read<bool>(obj.bDirection);
+    Read<bool>(obj.bVelocity);
+    Read<int>(obj.acceleration);
+    Read<int>(obj.acceleration_desc);
+    Read<double>(obj.acceleration_raw);
+    ReadEnum(obj.indicator_state);
+    Read<int>(obj.originalID);
+    ReadEnum(obj.behavior_state);
+  }
+};
+
+static double GetStampSeconds(const timespec& t)
+{
+  return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+PlanningRecorder::PlanningRecorder()
+{
+  m_bSaveMaps = true;
+  m_bMapRecorded = false;
+  m_LastMapVersion = 0;
+  m_nMaps = 0;
+  m_nRecords = 0;
+}
+
+PlanningRecorder::~PlanningRecorder()
+{
+  Close();
+}
+
+bool PlanningRecorder::Open(const std::string& fileName, const bool& bSaveMaps)
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  if(m_File.is_open())
+    m_File.close();
+
+  m_File.clear();
+  m_File.open(fileName.c_str(), std::ios::binary | std::ios::trunc);
+  if(!m_File.is_open())
+    return false;
+
+  m_FileName = fileName;
+  m_bSaveMaps = bSaveMaps;
+  m_bMapRecorded = false;
+  m_LastMapVersion = 0;
+  m_nMaps = 0;
+  m_nRecords = 0;
+
+  unsigned int format_version = FORMAT_VERSION;
+  m_File.write(RECORDING_MAGIC, sizeof(RECORDING_MAGIC));
+  m_File.write((const char*)&format_version, sizeof(format_version));
+  m_File.write((const char*)&RECORDING_BYTE_ORDER, sizeof(RECORDING_BYTE_ORDER));
+  return m_File.good();
+}
+
+void PlanningRecorder::Close()
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  if(m_File.is_open())
+    m_File.close();
+}
+
+bool PlanningRecorder::IsOpen() const
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  return m_File.is_open() && m_File.good();
+}
+
+unsigned long PlanningRecorder::GetNumberOfRecords() const
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  return m_nRecords;
+}
+
+std::string PlanningRecorder::GetMapFileName(const std::string& fileName, const int& mapIndex)
+{
+  std::ostringstream str;
+  str << fileName << ".map" << mapIndex << ".snapshot";
+  return str.str();
+}
+
+void PlanningRecorder::WriteRecord(const PLANNING_RECORD_TYPE& type, const timespec& stamp)
+{
+  unsigned int header[2] = {(unsigned int)type, (unsigned int)m_Buffer.size()};
+  long long t[2] = {(long long)stamp.tv_sec, (long long)stamp.tv_nsec};
+  m_File.write((const char*)header, sizeof(header));
+  m_File.write((const char*)t, sizeof(t));
+  m_File.write(m_Buffer.data(), m_Buffer.size());
+  //flushed per record, a node killed during the recording leaves a readable file
+  m_File.flush();
+  m_nRecords++;
+}
+
+void PlanningRecorder::RecordMap(const timespec& stamp, const RoadNetwork& map)
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  if(!m_File.is_open() || !m_File.good()) return;
+  if(m_bMapRecorded && map.version == m_LastMapVersion) return;
+
+  int map_index = -1;
+  if(m_bSaveMaps && RoadNetworkSnapshot::SaveToFile(GetMapFileName(m_FileName, m_nMaps), map, 0))
+    map_index = m_nMaps++;
+
+  m_Buffer.clear();
+  RecordPayloadWriter writer(m_Buffer);
+  writer.Write<unsigned long long>(map.version);
+  writer.Write<int>(map_index);
+  WriteRecord(RECORD_MAP, stamp);
+
+  m_bMapRecorded = true;
+  m_LastMapVersion = map.version;
+}
+
+void PlanningRecorder::RecordEgoState(const timespec& stamp, const WayPoint& pose, const VehicleState& vehicleState)
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  if(!m_File.is_open() || !m_File.good()) return;
+
+  m_Buffer.clear();
+  RecordPayloadWriter writer(m_Buffer);
+  writer.WriteWayPoint(pose);
+  writer.Write<long long>(vehicleState.tStamp.tv_sec);
+  writer.Write<long long>(vehicleState.tStamp.tv_nsec);
+  writer.Write<double>(vehicleState.speed);
+  writer.Write<double>(vehicleState.steer);
+  writer.Write<int>(vehicleState.shift);
+  WriteRecord(RECORD_EGO_STATE, stamp);
+}
+
+void PlanningRecorder::RecordDetectedObjects(const timespec& stamp, const std::vector<DetectedObject>& objects)
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  if(!m_File.is_open() || !m_File.good()) return;
+
+  m_Buffer.clear();
+  RecordPayloadWriter writer(m_Buffer);
+  writer.Write<unsigned int>(objects.size());
+  for(unsigned int i = 0; i < objects.size(); i++)
+    writer.WriteObject(objects.at(i));
+  WriteRecord(RECORD_DETECTED_OBJECTS, stamp);
+}
+
+void PlanningRecorder::RecordGlobalPaths(const timespec& stamp, const std::vector<std::vector<WayPoint> >& paths)
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  if(!m_File.is_open() || !m_File.good()) return;
+
+  m_Buffer.clear();
+  RecordPayloadWriter writer(m_Buffer);
+  writer.WritePaths(paths);
+  WriteRecord(RECORD_GLOBAL_PATHS, stamp);
+}
+
+PlanningRecordReader::PlanningRecordReader()
+{
+}
+
+PlanningRecordReader::~PlanningRecordReader()
+{
+}
+
+bool PlanningRecordReader::Open(const std::string& fileName)
+{
+  Close();
+  m_File.open(fileName.c_str(), std::ios::binary);
+  if(!m_File.is_open())
+    return false;
+
+  char magic[sizeof(RECORDING_MAGIC)];
+  unsigned int format_version = 0, byte_order = 0;
+  m_File.read(magic, sizeof(magic));
+  m_File.read((char*)&format_version, sizeof(format_version));
+  m_File.read((char*)&byte_order, sizeof(byte_order));
+  if(!m_File.good() || memcmp(magic, RECORDING_MAGIC, sizeof(magic)) != 0
+      || format_version != PlanningRecorder::FORMAT_VERSION || byte_order != RECORDING_BYTE_ORDER)
+  {
+    Close();
+    return false;
+  }
+
+  return true;
+}
+
+void PlanningRecordReader::Close()
+{
+  if(m_File.is_open())
+    m_File.close();
+  m_File.clear();
+}
+
+bool PlanningRecordReader::ReadNext(PlanningRecord& record)
+{
+  if(!m_File.is_open()) return false;
+
+  unsigned int header[2] = {0, 0};
+  long long t[2] = {0, 0};
+  m_File.read((char*)header, sizeof(header));
+  m_File.read((char*)t, sizeof(t));
+  if(m_File.gcount() != sizeof(t) || !m_File.good())
+    return false;
+
+  m_Buffer.resize(header[1]);
+  m_File.read(&m_Buffer[0], header[1]);
+  if((unsigned int)m_File.gcount() != header[1])
+    return false;
+
+  record = PlanningRecord();
+  record.type = (PLANNING_RECORD_TYPE)header[0];
+  record.stamp.tv_sec = t[0];
+  record.stamp.tv_nsec = t[1];
+
+  RecordPayloadReader reader(m_Buffer);
+  if(record.type == RECORD_MAP)
+  {
+    unsigned long long version = 0;
+    reader.Read(version);
+    reader.Read<int>(record.mapIndex);
+    record.mapVersion = version;
+  }
+  else if(record.type == RECORD_EGO_STATE)
+  {
+    long long state_t[2] = {0, 0};
+    reader.ReadWayPoint(record.pose);
+    reader.Read(state_t[0]);
+    reader.Read(state_t[1]);
+    record.vehicleState.tStamp.tv_sec = state_t[0];
+    record.vehicleState.tStamp.tv_nsec = state_t[1];
+    reader.Read<double>(record.vehicleState.speed);
+    reader.Read<double>(record.vehicleState.steer);
+    reader.ReadEnum(record.vehicleState.shift);
+  }
+  else if(record.type == RECORD_DETECTED_OBJECTS)
+  {
+    unsigned int n = reader.ReadSize();
+    record.objects.resize(n);
+    for(unsigned int i = 0; i < n && reader.m_bOk; i++)
+      reader.ReadObject(record.objects.at(i));
+  }
+  else if(record.type == RECORD_GLOBAL_PATHS)
+  {
+    reader.ReadPaths(record.globalPaths);
+  }
+  else
+  {
+    return false;
+  }
+
+  return reader.m_bOk && reader.m_Pos == m_Buffer.size();
+}
+
+bool PlanningRecordReader::ReadAll(const std::string& fileName, std::vector<PlanningRecord>& records)
+{
+  records.clear();
+  PlanningRecordReader reader;
+  if(!reader.Open(fileName))
+    return false;
+
+  PlanningRecord record;
+  while(reader.ReadNext(record))
+    records.push_back(record);
+
+  return true;
+}
+
+PlanningReplay::PlanningReplay()
+{
+  m_SpeedFactor = 0;
+  m_nThreads = 1;
+
+  m_Params.maxSpeed = 10;
+  m_Params.minSpeed = 0.2;
+  m_Params.rollOutNumber = 6;
+  m_Params.microPlanDistance = 50;
+  m_Params.horizonDistance = 120;
+  m_Params.pathDensity = 0.5;
+  m_Params.horizontalSafetyDistancel = 0.5;
+  m_Params.verticalSafetyDistance = 0.5;
+  m_Params.enableFollowing = true;
+  m_Params.enableSwerving = true;
+
+  m_CarInfo.max_speed_forward = m_Params.maxSpeed;
+  m_CarInfo.max_acceleration = 3;
+  m_CarInfo.max_deceleration = -3;
+
+  for(int i = 0; i < REPLAY_STAGES_COUNT; i++)
+    m_Latency.AddStage(REPLAY_STAGE_NAMES[i]);
+}
+
+PlanningReplay::~PlanningReplay()
+{
+}
+
+bool PlanningReplay::Load(const std::string& fileName)
+{
+  m_Records.clear();
+  m_Maps.clear();
+  if(!PlanningRecordReader::ReadAll(fileName, m_Records))
+    return false;
+
+  for(unsigned int i = 0; i < m_Records.size(); i++)
+  {
+    if(m_Records.at(i).type != RECORD_MAP) continue;
+
+    std::shared_ptr<RoadNetwork> pMap = std::make_shared<RoadNetwork>();
+    if(m_Records.at(i).mapIndex < 0
+        || !RoadNetworkSnapshot::LoadFromFile(PlanningRecorder::GetMapFileName(fileName, m_Records.at(i).mapIndex), 0, *pMap))
+      return false;
+    m_Maps.push_back(pMap);
+  }
+
+  return m_Maps.size() > 0;
+}
+
+int PlanningReplay::Run()
+{
+  m_Latency.Reset();
+  m_Behaviors.clear();
+  m_SelectedRollOuts.clear();
+
+  PlannerH planner;
+  BehaviorPrediction prediction;
+  prediction.m_nThreads = m_nThreads;
+  prediction.m_RandomSeed = 7;
+  TrajectoryDynamicCosts costs;
+  costs.SetNumberOfThreads(m_nThreads);
+  DecisionMaker decision_maker;
+  decision_maker.Init(m_CtrlParams, m_Params, m_CarInfo);
+
+  std::shared_ptr<RoadNetwork> pMap;
+  std::vector<DetectedObject> objects;
+  std::vector<std::vector<WayPoint> > global_paths;
+  std::vector<TrafficLight> traffic_lights;
+  std::vector<DetectedObject> predicted_objects;
+  std::vector<std::vector<WayPoint> > reference_paths;
+  std::vector<PathHorizon> reference_horizons;
+  PathView reference_view;
+  std::vector<std::vector<std::vector<WayPoint> > > roll_outs;
+  std::vector<WayPoint> sampled_points;
+  int iMap = 0;
+  int nCycles = 0;
+  double prev_ego_stamp = -1;
+  struct timespec t;
+
+  std::chrono::steady_clock::time_point replay_start = std::chrono::steady_clock::now();
+  double first_stamp = m_Records.size() > 0 ? GetStampSeconds(m_Records.front().stamp) : 0;
+
+  for(unsigned int ir = 0; ir < m_Records.size(); ir++)
+  {
+    const PlanningRecord& record = m_Records.at(ir);
+    if(m_SpeedFactor > 0)
+    {
+      double delay = (GetStampSeconds(record.stamp) - first_stamp) / m_SpeedFactor;
+      std::this_thread::sleep_until(replay_start + std::chrono::duration<double>(delay));
+    }
+
+    if(record.type == RECORD_MAP)
+    {
+      pMap = m_Maps.at(iMap++);
+      decision_maker.m_pSharedMap = pMap;
+    }
+    else if(record.type == RECORD_DETECTED_OBJECTS)
+    {
+      objects = record.objects;
+    }
+    else if(record.type == RECORD_GLOBAL_PATHS)
+    {
+      global_paths = record.globalPaths;
+      for(unsigned int i = 0; i < global_paths.size(); i++)
+        PlanningHelpers::CalcAngleAndCost(global_paths.at(i));
+      decision_maker.SetNewGlobalPath(global_paths);
+      reference_paths.resize(global_paths.size());
+      reference_horizons.assign(global_paths.size(), PathHorizon());
+    }
+    else if(record.type == RECORD_EGO_STATE)
+    {
+      double stamp = GetStampSeconds(record.stamp);
+      double dt = prev_ego_stamp < 0 ? 0.1 : stamp - prev_ego_stamp;
+      prev_ego_stamp = stamp;
+      if(!pMap || global_paths.size() == 0)
+        continue;
+
+      const WayPoint& pose = record.pose;
+      struct timespec cycle_t;
+      UtilityHNS::UtilityH::GetTickCount(cycle_t);
+
+      UtilityHNS::UtilityH::GetTickCount(t);
+      prediction.DoOneStep(objects, pose, m_Params.minSpeed, m_CarInfo.max_deceleration, *pMap);
+      m_Latency.Record(REPLAY_PREDICTION, UtilityHNS::UtilityH::GetTimeDiffNow(t));
+
+      predicted_objects.clear();
+      for(unsigned int i = 0; i < prediction.m_ParticleInfo_II.size(); i++)
+        predicted_objects.push_back(prediction.m_ParticleInfo_II.at(i)->obj);
+
+      UtilityHNS::UtilityH::GetTickCount(t);
+      for(unsigned int i = 0; i < global_paths.size(); i++)
+      {
+        reference_horizons.at(i).Extract(global_paths.at(i), pose, m_Params.horizonDistance, m_Params.pathDensity, reference_view);
+        reference_view.CopyTo(reference_paths.at(i));
+      }
+      planner.GenerateRunoffTrajectory(reference_paths, pose, m_Params.enableLaneChange, pose.v, m_Params.microPlanDistance,
+          m_Params.maxSpeed, m_Params.minSpeed, m_Params.carTipMargin, m_Params.rollInMargin, m_Params.rollInSpeedFactor,
+          m_Params.pathDensity, m_Params.rollOutDensity, m_Params.rollOutNumber, m_Params.smoothingDataWeight,
+          m_Params.smoothingSmoothWeight, m_Params.smoothingToleranceError, m_Params.speedProfileFactor,
+          m_Params.enableHeadingSmoothing, -1, -1, roll_outs, sampled_points);
+      m_Latency.Record(REPLAY_ROLL_OUTS, UtilityHNS::UtilityH::GetTimeDiffNow(t));
+
+      if(roll_outs.size() == 0)
+        continue;
+
+      UtilityHNS::UtilityH::GetTickCount(t);
+      TrajectoryCost tc = costs.DoOneStep(roll_outs, reference_paths, pose, m_Params.rollOutNumber/2, 0, m_Params, m_CarInfo,
+          record.vehicleState, predicted_objects);
+      m_Latency.Record(REPLAY_TRAJECTORY_COSTS, UtilityHNS::UtilityH::GetTimeDiffNow(t));
+
+      //the recording has no goal or traffic light inputs, like PlanningBenchmark a single goal and no lights are used
+      decision_maker.m_RollOuts = roll_outs.at(0);
+      UtilityHNS::UtilityH::GetTickCount(t);
+      BehaviorState beh = decision_maker.DoOneStep(dt, pose, record.vehicleState, 1, traffic_lights, tc, false);
+      m_Latency.Record(REPLAY_DECISION, UtilityHNS::UtilityH::GetTimeDiffNow(t));
+
+      m_Latency.Record(REPLAY_CYCLE, UtilityHNS::UtilityH::GetTimeDiffNow(cycle_t));
+      m_Behaviors.push_back(beh);
+      m_SelectedRollOuts.push_back(tc.index);
+      nCycles++;
+    }
+  }
+
+  return nCycles;
+}
+
+const std::vector<PlanningRecord>& PlanningReplay::GetRecords() const
+{
+  return m_Records;
+}
+
+const UtilityHNS::StageLatencyRecorder& PlanningReplay::GetLatency() const
+{
+  return m_Latency;
+}
+
+} /* namespace PlannerHNS */
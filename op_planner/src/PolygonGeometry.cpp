@@ -0,0 +1,399 @@
+/// \file PolygonGeometry.cpp
+/// \brief Vectorized point in polygon, polygon overlap and polygon expansion for contours and safety borders
+/// \date Oct 14, 2026
+
+#include "op_planner/PolygonGeometry.h"
+#include "op_planner/MatrixOperations.h"
+#include <float.h>
+#include <cmath>
+#include <algorithm>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+namespace PlannerHNS
+{
+
+//The constant part of the crossing test of one edge
+class PolygonEdge
+{
+public:
+  double y_min;
+  double y_max;
+  double x_max;
+  double x1;
+  double y1;
+  double dx;
+  double dy;
+  bool bVertical;
+};
+
+static void GetPolygonEdges(const std::vector<GPSPoint>& polygon, std::vector<PolygonEdge>& edges)
+{
+  edges.clear();
+  int N = polygon.size();
+  for(int i = 1; i <= N; i++)
+  {
+    const GPSPoint& p1 = polygon.at(i-1);
+    const GPSPoint& p2 = polygon.at(i % N);
+    if(p1.y == p2.y) continue; // never crossed
+
+    PolygonEdge e;
+    e.y_min = std::min(p1.y, p2.y);
+    e.y_max = std::max(p1.y, p2.y);
+    e.x_max = std::max(p1.x, p2.x);
+    e.x1 = p1.x;
+    e.y1 = p1.y;
+    e.dx = p2.x - p1.x;
+    e.dy = p2.y - p1.y;
+    e.bVertical = p1.x == p2.x;
+    edges.push_back(e);
+  }
+}
+
+int PolygonGeometry::PointInsidePolygon(const std::vector<GPSPoint>& polygon, const GPSPoint& p)
+{
+  int counter = 0;
+  int N = polygon.size();
+  if(N <= 0) return -1;
+
+  GPSPoint p1 = polygon.at(0);
+  for(int i = 1; i <= N; i++)
+  {
+    const GPSPoint& p2 = polygon.at(i % N);
+    if(p.y > std::min(p1.y, p2.y) && p.y <= std::max(p1.y, p2.y) && p.x <= std::max(p1.x, p2.x) && p1.y != p2.y)
+    {
+      double xinters = (p.y-p1.y)*(p2.x-p1.x)/(p2.y-p1.y)+p1.x;
+      if(p1.x == p2.x || p.x <= xinters)
+        counter++;
+    }
+    p1 = p2;
+  }
+
+  return counter % 2;
+}
+
+//The points go through the edges a vector at a time, the crossing parity is kept as a mask.
+//The intersection is computed with the same operations as the scalar test, so both give the same result.
+void PolygonGeometry::PointsInsidePolygon(const std::vector<GPSPoint>& polygon, const double* xs, const double* ys, const int& n, int* inside)
+{
+  if(polygon.size() == 0)
+  {
+    for(int i = 0; i < n; i++)
+      inside[i] = -1;
+    return;
+  }
+
+  std::vector<PolygonEdge> edges;
+  GetPolygonEdges(polygon, edges);
+  int nEdges = edges.size();
+  int i = 0;
+
+#if defined(__AVX2__)
+  for(; i + 4 <= n; i += 4)
+  {
+    __m256d px = _mm256_loadu_pd(xs + i);
+    __m256d py = _mm256_loadu_pd(ys + i);
+    __m256d parity = _mm256_setzero_pd();
+    for(int ie = 0; ie < nEdges; ie++)
+    {
+      const PolygonEdge& e = edges[ie];
+      __m256d c = _mm256_and_pd(_mm256_cmp_pd(py, _mm256_set1_pd(e.y_min), _CMP_GT_OQ), _mm256_cmp_pd(py, _mm256_set1_pd(e.y_max), _CMP_LE_OQ));
+      c = _mm256_and_pd(c, _mm256_cmp_pd(px, _mm256_set1_pd(e.x_max), _CMP_LE_OQ));
+      if(!e.bVertical)
+      {
+        __m256d xinters = _mm256_add_pd(_mm256_div_pd(_mm256_mul_pd(_mm256_sub_pd(py, _mm256_set1_pd(e.y1)), _mm256_set1_pd(e.dx)), _mm256_set1_pd(e.dy)), _mm256_set1_pd(e.x1));
+        c = _mm256_and_pd(c, _mm256_cmp_pd(px, xinters, _CMP_LE_OQ));
+      }
+      parity = _mm256_xor_pd(parity, c);
+    }
+    int mask = _mm256_movemask_pd(parity);
+    for(int k = 0; k < 4; k++)
+      inside[i+k] = (mask >> k) & 1;
+  }
+#elif defined(__SSE2__)
+  for(; i + 2 <= n; i += 2)
+  {
+    __m128d px = _mm_loadu_pd(xs + i);
+    __m128d py = _mm_loadu_pd(ys + i);
+    __m128d parity = _mm_setzero_pd();
+    for(int ie = 0; ie < nEdges; ie++)
+    {
+      const PolygonEdge& e = edges[ie];
+      __m128d c = _mm_and_pd(_mm_cmpgt_pd(py, _mm_set1_pd(e.y_min)), _mm_cmple_pd(py, _mm_set1_pd(e.y_max)));
+      c = _mm_and_pd(c, _mm_cmple_pd(px, _mm_set1_pd(e.x_max)));
+      if(!e.bVertical)
+      {
+        __m128d xinters = _mm_add_pd(_mm_div_pd(_mm_mul_pd(_mm_sub_pd(py, _mm_set1_pd(e.y1)), _mm_set1_pd(e.dx)), _mm_set1_pd(e.dy)), _mm_set1_pd(e.x1));
+        c = _mm_and_pd(c, _mm_cmple_pd(px, xinters));
+      }
+      parity = _mm_xor_pd(parity, c);
+    }
+    int mask = _mm_movemask_pd(parity);
+    inside[i] = mask & 1;
+    inside[i+1] = (mask >> 1) & 1;
+  }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+  for(; i + 2 <= n; i += 2)
+  {
+    float64x2_t px = vld1q_f64(xs + i);
+    float64x2_t py = vld1q_f64(ys + i);
+    uint64x2_t parity = vdupq_n_u64(0);
+    for(int ie = 0; ie < nEdges; ie++)
+    {
+      const PolygonEdge& e = edges[ie];
+      uint64x2_t c = vandq_u64(vcgtq_f64(py, vdupq_n_f64(e.y_min)), vcleq_f64(py, vdupq_n_f64(e.y_max)));
+      c = vandq_u64(c, vcleq_f64(px, vdupq_n_f64(e.x_max)));
+      if(!e.bVertical)
+      {
+        float64x2_t xinters = vaddq_f64(vdivq_f64(vmulq_f64(vsubq_f64(py, vdupq_n_f64(e.y1)), vdupq_n_f64(e.dx)), vdupq_n_f64(e.dy)), vdupq_n_f64(e.x1));
+        c = vandq_u64(c, vcleq_f64(px, xinters));
+      }
+      parity = veorq_u64(parity, c);
+    }
+    inside[i] = vgetq_lane_u64(parity, 0) != 0;
+    inside[i+1] = vgetq_lane_u64(parity, 1) != 0;
+  }
+#endif
+
+  //scalar tail, all the points for the scalar build
+  for(; i < n; i++)
+  {
+    int counter = 0;
+    for(int ie = 0; ie < nEdges; ie++)
+    {
+      const PolygonEdge& e = edges[ie];
+      if(ys[i] > e.y_min && ys[i] <= e.y_max && xs[i] <= e.x_max)
+      {
+        if(e.bVertical || xs[i] <= (ys[i]-e.y1)*e.dx/e.dy+e.x1)
+          counter++;
+      }
+    }
+    inside[i] = counter % 2;
+  }
+}
+
+void PolygonGeometry::PointsInsidePolygon(const std::vector<GPSPoint>& polygon, const std::vector<GPSPoint>& points, std::vector<int>& inside)
+{
+  std::vector<double> xs(points.size()), ys(points.size());
+  for(unsigned int i = 0; i < points.size(); i++)
+  {
+    xs[i] = points[i].x;
+    ys[i] = points[i].y;
+  }
+
+  inside.resize(points.size());
+  PointsInsidePolygon(polygon, xs.data(), ys.data(), points.size(), inside.data());
+}
+
+void PolygonGeometry::PointsInsidePolygon(const std::vector<GPSPoint>& polygon, const std::vector<WayPoint>& points, std::vector<int>& inside)
+{
+  std::vector<double> xs(points.size()), ys(points.size());
+  for(unsigned int i = 0; i < points.size(); i++)
+  {
+    xs[i] = points[i].pos.x;
+    ys[i] = points[i].pos.y;
+  }
+
+  inside.resize(points.size());
+  PointsInsidePolygon(polygon, xs.data(), ys.data(), points.size(), inside.data());
+}
+
+void PolygonGeometry::GetProjectionRange(const double* xs, const double* ys, const int& n, const double& ax, const double& ay, double& min_p, double& max_p)
+{
+  min_p = DBL_MAX;
+  max_p = -DBL_MAX;
+  int i = 0;
+
+#if defined(__AVX2__)
+  if(n >= 4)
+  {
+    __m256d v_ax = _mm256_set1_pd(ax);
+    __m256d v_ay = _mm256_set1_pd(ay);
+    __m256d v_min = _mm256_set1_pd(DBL_MAX);
+    __m256d v_max = _mm256_set1_pd(-DBL_MAX);
+    for(; i + 4 <= n; i += 4)
+    {
+      __m256d d = _mm256_add_pd(_mm256_mul_pd(_mm256_loadu_pd(xs + i), v_ax), _mm256_mul_pd(_mm256_loadu_pd(ys + i), v_ay));
+      v_min = _mm256_min_pd(v_min, d);
+      v_max = _mm256_max_pd(v_max, d);
+    }
+    double lanes_min[4], lanes_max[4];
+    _mm256_storeu_pd(lanes_min, v_min);
+    _mm256_storeu_pd(lanes_max, v_max);
+    for(int l = 0; l < 4; l++)
+    {
+      min_p = std::min(min_p, lanes_min[l]);
+      max_p = std::max(max_p, lanes_max[l]);
+    }
+  }
+#elif defined(__SSE2__)
+  if(n >= 2)
+  {
+    __m128d v_ax = _mm_set1_pd(ax);
+    __m128d v_ay = _mm_set1_pd(ay);
+    __m128d v_min = _mm_set1_pd(DBL_MAX);
+    __m128d v_max = _mm_set1_pd(-DBL_MAX);
+    for(; i + 2 <= n; i += 2)
+    {
+      __m128d d = _mm_add_pd(_mm_mul_pd(_mm_loadu_pd(xs + i), v_ax), _mm_mul_pd(_mm_loadu_pd(ys + i), v_ay));
+      v_min = _mm_min_pd(v_min, d);
+      v_max = _mm_max_pd(v_max, d);
+    }
+    double lanes_min[2], lanes_max[2];
+    _mm_storeu_pd(lanes_min, v_min);
+    _mm_storeu_pd(lanes_max, v_max);
+    min_p = std::min(lanes_min[0], lanes_min[1]);
+    max_p = std::max(lanes_max[0], lanes_max[1]);
+  }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+  if(n >= 2)
+  {
+    float64x2_t v_ax = vdupq_n_f64(ax);
+    float64x2_t v_ay = vdupq_n_f64(ay);
+    float64x2_t v_min = vdupq_n_f64(DBL_MAX);
+    float64x2_t v_max = vdupq_n_f64(-DBL_MAX);
+    for(; i + 2 <= n; i += 2)
+    {
+      float64x2_t d = vaddq_f64(vmulq_f64(vld1q_f64(xs + i), v_ax), vmulq_f64(vld1q_f64(ys + i), v_ay));
+      v_min = vminq_f64(v_min, d);
+      v_max = vmaxq_f64(v_max, d);
+    }
+    min_p = vminvq_f64(v_min);
+    max_p = vmaxvq_f64(v_max);
+  }
+#endif
+
+  for(; i < n; i++)
+  {
+    double d = xs[i]*ax + ys[i]*ay;
+    min_p = std::min(min_p, d);
+    max_p = std::max(max_p, d);
+  }
+}
+
+bool PolygonGeometry::PolygonsOverlap(const std::vector<GPSPoint>& polygon_a, const std::vector<GPSPoint>& polygon_b)
+{
+  if(polygon_a.size() == 0 || polygon_b.size() == 0) return false;
+
+  std::vector<double> xs_a(polygon_a.size()), ys_a(polygon_a.size()), xs_b(polygon_b.size()), ys_b(polygon_b.size());
+  for(unsigned int i = 0; i < polygon_a.size(); i++)
+  {
+    xs_a[i] = polygon_a[i].x;
+    ys_a[i] = polygon_a[i].y;
+  }
+  for(unsigned int i = 0; i < polygon_b.size(); i++)
+  {
+    xs_b[i] = polygon_b[i].x;
+    ys_b[i] = polygon_b[i].y;
+  }
+
+  //the edge normals of both polygons are the candidate separating axes
+  for(int ip = 0; ip < 2; ip++)
+  {
+    const std::vector<double>& xs = (ip == 0) ? xs_a : xs_b;
+    const std::vector<double>& ys = (ip == 0) ? ys_a : ys_b;
+    int N = xs.size();
+    for(int i = 0; i < N; i++)
+    {
+      int j = (i+1) % N;
+      double ax = -(ys[j] - ys[i]);
+      double ay = xs[j] - xs[i];
+      if(ax == 0 && ay == 0) continue;
+
+      double min_a, max_a, min_b, max_b;
+      GetProjectionRange(xs_a.data(), ys_a.data(), xs_a.size(), ax, ay, min_a, max_a);
+      GetProjectionRange(xs_b.data(), ys_b.data(), xs_b.size(), ax, ay, min_b, max_b);
+      if(max_a < min_b || max_b < min_a)
+        return false;
+    }
+  }
+
+  //points and degenerate segments have no axis of their own
+  if(polygon_a.size() < 3 || polygon_b.size() < 3)
+  {
+    double min_a, max_a, min_b, max_b;
+    GetProjectionRange(xs_a.data(), ys_a.data(), xs_a.size(), 1, 0, min_a, max_a);
+    GetProjectionRange(xs_b.data(), ys_b.data(), xs_b.size(), 1, 0, min_b, max_b);
+    if(max_a < min_b || max_b < min_a) return false;
+    GetProjectionRange(xs_a.data(), ys_a.data(), xs_a.size(), 0, 1, min_a, max_a);
+    GetProjectionRange(xs_b.data(), ys_b.data(), xs_b.size(), 0, 1, min_b, max_b);
+    if(max_a < min_b || max_b < min_a) return false;
+  }
+
+  return true;
+}
+
+void PolygonGeometry::ExpandPolygon(const std::vector<GPSPoint>& polygon, const double& distance, std::vector<GPSPoint>& expanded)
+{
+  int N = polygon.size();
+  expanded = polygon;
+  if(N < 3) return;
+
+  double area = 0;
+  for(int i = 0; i < N; i++)
+  {
+    const GPSPoint& p1 = polygon.at(i);
+    const GPSPoint& p2 = polygon.at((i+1) % N);
+    area += p1.x*p2.y - p2.x*p1.y;
+  }
+  if(area == 0) return;
+
+  //outward normal is on the right of the edges of a counter clockwise polygon
+  double side = (area > 0) ? 1.0 : -1.0;
+  for(int i = 0; i < N; i++)
+  {
+    const GPSPoint& prev = polygon.at((i+N-1) % N);
+    const GPSPoint& p = polygon.at(i);
+    const GPSPoint& next = polygon.at((i+1) % N);
+
+    double l1 = hypot(p.y - prev.y, p.x - prev.x);
+    double l2 = hypot(next.y - p.y, next.x - p.x);
+    if(l1 == 0 || l2 == 0) continue;
+
+    double n1x = side*(p.y - prev.y)/l1, n1y = -side*(p.x - prev.x)/l1;
+    double n2x = side*(next.y - p.y)/l2, n2y = -side*(next.x - p.x)/l2;
+    double cos_a = n1x*n2x + n1y*n2y;
+    if(cos_a <= -1 + 1e-9)
+    {
+      expanded.at(i).x += n1x*distance;
+      expanded.at(i).y += n1y*distance;
+    }
+    else
+    {
+      expanded.at(i).x += (n1x + n2x)*distance/(1.0 + cos_a);
+      expanded.at(i).y += (n1y + n2y)*distance/(1.0 + cos_a);
+    }
+  }
+}
+
+void PolygonGeometry::GetOrientedRectangle(const GPSPoint& center, const double& width, const double& length, const double& z, std::vector<GPSPoint>& rectangle)
+{
+  double w2 = width/2.0;
+  double h2 = length/2.0;
+
+  GPSPoint corners[4] = {GPSPoint(-w2, -h2, z, 0), GPSPoint(w2, -h2, z, 0), GPSPoint(w2, h2, z, 0), GPSPoint(-w2, h2, z, 0)};
+
+  rectangle.resize(4);
+  RigidTransform2D(center).Transform(corners, rectangle.data(), 4);
+}
+
+const char* PolygonGeometry::GetKernelName()
+{
+#if defined(__AVX2__)
+  return "avx2";
+#elif defined(__SSE2__)
+  return "sse2";
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+  return "neon";
+#else
+  return "scalar";
+#endif
+}
+
+} /* namespace PlannerHNS */
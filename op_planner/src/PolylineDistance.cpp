@@ -0,0 +1,224 @@
+/// \file PolylineDistance.cpp
+/// \brief Vectorized closest vertex search of a point against a polyline stored as contiguous x, y arrays
+/// \date Oct 14, 2026
+
+#include "op_planner/PolylineDistance.h"
+#include <float.h>
+#include <algorithm>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+namespace PlannerHNS
+{
+
+int PolylineDistance::GetClosestVertexScalar(const double* xs, const double* ys, const int& n, const double& px, const double& py, double& min_d_sqr)
+{
+  int min_index = -1;
+  min_d_sqr = DBL_MAX;
+  for(int i = 0; i < n; i++)
+  {
+    double dx = xs[i] - px;
+    double dy = ys[i] - py;
+    double d = dx*dx + dy*dy;
+    if(d < min_d_sqr)
+    {
+      min_index = i;
+      min_d_sqr = d;
+    }
+  }
+
+  return min_index;
+}
+
+//Two passes, the first one finds the minimum squared distance with independent min accumulators (no index bookkeeping
+//in the dependency chain), the second one returns the first vertex with exactly that distance.
+//The distance of a vertex is computed with the same operations in both passes, so the result is the same as the scalar scan.
+int PolylineDistance::GetClosestVertex(const double* xs, const double* ys, const int& n, const double& px, const double& py, double& min_d_sqr)
+{
+  min_d_sqr = DBL_MAX;
+  if(n <= 0) return -1;
+
+  int nVector = 0;
+  double min_d = DBL_MAX;
+
+#if defined(__AVX2__)
+  nVector = n - n % 4;
+  __m256d v_px = _mm256_set1_pd(px);
+  __m256d v_py = _mm256_set1_pd(py);
+  if(nVector > 0)
+  {
+    __m256d v_min[4];
+    for(int k = 0; k < 4; k++)
+      v_min[k] = _mm256_set1_pd(DBL_MAX);
+
+    int i = 0;
+    for(; i + 16 <= nVector; i += 16)
+    {
+      for(int k = 0; k < 4; k++)
+      {
+        __m256d dx = _mm256_sub_pd(_mm256_loadu_pd(xs + i + k*4), v_px);
+        __m256d dy = _mm256_sub_pd(_mm256_loadu_pd(ys + i + k*4), v_py);
+        v_min[k] = _mm256_min_pd(v_min[k], _mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy)));
+      }
+    }
+    for(; i < nVector; i += 4)
+    {
+      __m256d dx = _mm256_sub_pd(_mm256_loadu_pd(xs + i), v_px);
+      __m256d dy = _mm256_sub_pd(_mm256_loadu_pd(ys + i), v_py);
+      v_min[0] = _mm256_min_pd(v_min[0], _mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy)));
+    }
+
+    double lanes[4];
+    _mm256_storeu_pd(lanes, _mm256_min_pd(_mm256_min_pd(v_min[0], v_min[1]), _mm256_min_pd(v_min[2], v_min[3])));
+    for(int l = 0; l < 4; l++)
+      min_d = std::min(min_d, lanes[l]);
+  }
+#elif defined(__SSE2__)
+  nVector = n - n % 2;
+  __m128d v_px = _mm_set1_pd(px);
+  __m128d v_py = _mm_set1_pd(py);
+  if(nVector > 0)
+  {
+    __m128d v_min[4];
+    for(int k = 0; k < 4; k++)
+      v_min[k] = _mm_set1_pd(DBL_MAX);
+
+    int i = 0;
+    for(; i + 8 <= nVector; i += 8)
+    {
+      for(int k = 0; k < 4; k++)
+      {
+        __m128d dx = _mm_sub_pd(_mm_loadu_pd(xs + i + k*2), v_px);
+        __m128d dy = _mm_sub_pd(_mm_loadu_pd(ys + i + k*2), v_py);
+        v_min[k] = _mm_min_pd(v_min[k], _mm_add_pd(_mm_mul_pd(dx, dx), _mm_mul_pd(dy, dy)));
+      }
+    }
+    for(; i < nVector; i += 2)
+    {
+      __m128d dx = _mm_sub_pd(_mm_loadu_pd(xs + i), v_px);
+      __m128d dy = _mm_sub_pd(_mm_loadu_pd(ys + i), v_py);
+      v_min[0] = _mm_min_pd(v_min[0], _mm_add_pd(_mm_mul_pd(dx, dx), _mm_mul_pd(dy, dy)));
+    }
+
+    double lanes[2];
+    _mm_storeu_pd(lanes, _mm_min_pd(_mm_min_pd(v_min[0], v_min[1]), _mm_min_pd(v_min[2], v_min[3])));
+    min_d = std::min(lanes[0], lanes[1]);
+  }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+  nVector = n - n % 2;
+  float64x2_t v_px = vdupq_n_f64(px);
+  float64x2_t v_py = vdupq_n_f64(py);
+  if(nVector > 0)
+  {
+    float64x2_t v_min[4];
+    for(int k = 0; k < 4; k++)
+      v_min[k] = vdupq_n_f64(DBL_MAX);
+
+    int i = 0;
+    for(; i + 8 <= nVector; i += 8)
+    {
+      for(int k = 0; k < 4; k++)
+      {
+        float64x2_t dx = vsubq_f64(vld1q_f64(xs + i + k*2), v_px);
+        float64x2_t dy = vsubq_f64(vld1q_f64(ys + i + k*2), v_py);
+        v_min[k] = vminq_f64(v_min[k], vaddq_f64(vmulq_f64(dx, dx), vmulq_f64(dy, dy)));
+      }
+    }
+    for(; i < nVector; i += 2)
+    {
+      float64x2_t dx = vsubq_f64(vld1q_f64(xs + i), v_px);
+      float64x2_t dy = vsubq_f64(vld1q_f64(ys + i), v_py);
+      v_min[0] = vminq_f64(v_min[0], vaddq_f64(vmulq_f64(dx, dx), vmulq_f64(dy, dy)));
+    }
+
+    min_d = vminvq_f64(vminq_f64(vminq_f64(v_min[0], v_min[1]), vminq_f64(v_min[2], v_min[3])));
+  }
+#endif
+
+  //scalar tail, the whole polyline for the scalar build
+  for(int i = nVector; i < n; i++)
+  {
+    double dx = xs[i] - px;
+    double dy = ys[i] - py;
+    min_d = std::min(min_d, dx*dx + dy*dy);
+  }
+
+  //all distances are DBL_MAX or NaN, same as the scalar scan finding nothing
+  if(!(min_d < DBL_MAX)) return -1;
+
+  min_d_sqr = min_d;
+
+#if defined(__AVX2__)
+  __m256d v_target = _mm256_set1_pd(min_d);
+  for(int i = 0; i < nVector; i += 4)
+  {
+    __m256d dx = _mm256_sub_pd(_mm256_loadu_pd(xs + i), v_px);
+    __m256d dy = _mm256_sub_pd(_mm256_loadu_pd(ys + i), v_py);
+    int mask = _mm256_movemask_pd(_mm256_cmp_pd(_mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy)), v_target, _CMP_EQ_OQ));
+    if(mask != 0)
+      return i + __builtin_ctz(mask);
+  }
+#elif defined(__SSE2__)
+  __m128d v_target = _mm_set1_pd(min_d);
+  for(int i = 0; i < nVector; i += 2)
+  {
+    __m128d dx = _mm_sub_pd(_mm_loadu_pd(xs + i), v_px);
+    __m128d dy = _mm_sub_pd(_mm_loadu_pd(ys + i), v_py);
+    int mask = _mm_movemask_pd(_mm_cmpeq_pd(_mm_add_pd(_mm_mul_pd(dx, dx), _mm_mul_pd(dy, dy)), v_target));
+    if(mask != 0)
+      return i + __builtin_ctz(mask);
+  }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+  float64x2_t v_target = vdupq_n_f64(min_d);
+  for(int i = 0; i < nVector; i += 2)
+  {
+    float64x2_t dx = vsubq_f64(vld1q_f64(xs + i), v_px);
+    float64x2_t dy = vsubq_f64(vld1q_f64(ys + i), v_py);
+    uint64x2_t mask = vceqq_f64(vaddq_f64(vmulq_f64(dx, dx), vmulq_f64(dy, dy)), v_target);
+    if(vgetq_lane_u64(mask, 0) != 0)
+      return i;
+    if(vgetq_lane_u64(mask, 1) != 0)
+      return i + 1;
+  }
+#endif
+
+  for(int i = nVector; i < n; i++)
+  {
+    double dx = xs[i] - px;
+    double dy = ys[i] - py;
+    if(dx*dx + dy*dy == min_d)
+      return i;
+  }
+
+  return -1;
+}
+
+void PolylineDistance::GetClosestVertices(const PathSoA& polyline, const std::vector<WayPoint>& points, std::vector<int>& indices, std::vector<double>& min_d_sqr)
+{
+  indices.resize(points.size());
+  min_d_sqr.resize(points.size());
+  int n = polyline.size();
+  for(unsigned int i = 0; i < points.size(); i++)
+    indices.at(i) = GetClosestVertex(polyline.x.data(), polyline.y.data(), n, points.at(i).pos.x, points.at(i).pos.y, min_d_sqr.at(i));
+}
+
+const char* PolylineDistance::GetKernelName()
+{
+#if defined(__AVX2__)
+  return "avx2";
+#elif defined(__SSE2__)
+  return "sse2";
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+  return "neon";
+#else
+  return "scalar";
+#endif
+}
+
+} /* namespace PlannerHNS */
@@ -0,0 +1,128 @@
+/// \file RoadNetwork.cpp
+/// \brief Implementation of the non trivial parts of OpenPlanner's map data types (spatial and id indexes)
+/// \date Oct 14, 2026
+
+#include "op_planner/RoadNetwork.h"
+#include "op_planner/PolygonGeometry.h"
+#include <algorithm>
+#include <math.h>
+
+namespace PlannerHNS
+{
+
+int PolygonShape::PointInsidePolygon(const PolygonShape& polygon,const GPSPoint& p)
+{
+  return PolygonGeometry::PointInsidePolygon(polygon.points, p);
+}
+
+long long MapSpatialIndex::GetCellKey(const long long& ix, const long long& iy) const
+{
+  //unsigned, the cells left of or below the origin have negative indices
+  return (long long)(((unsigned long long)(unsigned int)ix << 32) | (unsigned int)iy);
+}
+
+long long MapSpatialIndex::GetCellKey(const double& x, const double& y) const
+{
+  return GetCellKey((long long)floor(x / cell_size), (long long)floor(y / cell_size));
+}
+
+void MapSpatialIndex::Build(const std::vector<RoadSegment>& segments, const double& cellSize)
+{
+  Clear();
+  if(cellSize > 0)
+    cell_size = cellSize;
+
+  std::vector<std::pair<long long, Entry> > keyed_entries;
+  for(unsigned int rs = 0; rs < segments.size(); rs++)
+  {
+    for(unsigned int i = 0; i < segments.at(rs).Lanes.size(); i++)
+    {
+      const std::vector<WayPoint>& points = segments.at(rs).Lanes.at(i).points;
+      for(unsigned int p = 0; p < points.size(); p++)
+      {
+        Entry e;
+        e.x = points.at(p).pos.x;
+        e.y = points.at(p).pos.y;
+        e.iSegment = rs;
+        e.iLane = i;
+        e.iPoint = p;
+        keyed_entries.push_back(std::make_pair(GetCellKey(e.x, e.y), e));
+      }
+    }
+  }
+
+  //keep map order inside each cell, callers rely on it to reproduce the linear scan results
+  std::stable_sort(keyed_entries.begin(), keyed_entries.end(),
+      [](const std::pair<long long, Entry>& a, const std::pair<long long, Entry>& b){ return a.first < b.first; });
+
+  entries.reserve(keyed_entries.size());
+  for(unsigned int i = 0; i < keyed_entries.size(); i++)
+  {
+    if(i == 0 || keyed_entries.at(i).first != keyed_entries.at(i-1).first)
+      cells[keyed_entries.at(i).first] = std::make_pair((int)i, (int)i);
+
+    cells[keyed_entries.at(i).first].second = i + 1;
+    entries.push_back(keyed_entries.at(i).second);
+  }
+}
+
+void MapSpatialIndex::GetCandidates(const GPSPoint& p, const double& radius, std::vector<const Entry*>& candidates) const
+{
+  candidates.clear();
+  if(!IsBuilt()) return;
+
+  long long min_ix = (long long)floor((p.x - radius) / cell_size);
+  long long max_ix = (long long)floor((p.x + radius) / cell_size);
+  long long min_iy = (long long)floor((p.y - radius) / cell_size);
+  long long max_iy = (long long)floor((p.y + radius) / cell_size);
+
+  for(long long ix = min_ix; ix <= max_ix; ix++)
+  {
+    for(long long iy = min_iy; iy <= max_iy; iy++)
+    {
+      std::unordered_map<long long, std::pair<int, int> >::const_iterator it = cells.find(GetCellKey(ix, iy));
+      if(it == cells.end()) continue;
+
+      for(int i = it->second.first; i < it->second.second; i++)
+        candidates.push_back(&entries.at(i));
+    }
+  }
+}
+
+void MapIdIndex::Build(const std::vector<RoadSegment>& segments)
+{
+  Clear();
+  nSegments = segments.size();
+  for(unsigned int rs = 0; rs < segments.size(); rs++)
+  {
+    nLanes += segments.at(rs).Lanes.size();
+    for(unsigned int i = 0; i < segments.at(rs).Lanes.size(); i++)
+    {
+      const Lane& l = segments.at(rs).Lanes.at(i);
+      Location loc;
+      loc.iSegment = rs;
+      loc.iLane = i;
+      loc.iPoint = -1;
+      lanes[l.id].push_back(loc);
+
+      for(unsigned int p = 0; p < l.points.size(); p++)
+      {
+        loc.iPoint = p;
+        waypoints[l.points.at(p).id].push_back(loc);
+      }
+    }
+  }
+}
+
+bool MapIdIndex::IsValid(const std::vector<RoadSegment>& segments) const
+{
+  if(nLanes == 0 || nSegments != segments.size()) return false;
+
+  unsigned int n = 0;
+  for(unsigned int rs = 0; rs < segments.size(); rs++)
+    n += segments.at(rs).Lanes.size();
+
+  return n == nLanes;
+}
+
+} /* namespace PlannerHNS */
@@ -0,0 +1,760 @@
+/// \file RoadNetworkSnapshot.cpp
+/// \brief Versioned binary snapshot of a fully linked RoadNetwork, pointers are stored as indices and resolved at load time
+/// \date Oct 14, 2026
+
+#include "op_planner/RoadNetworkSnapshot.h"
+#include "op_planner/MappingHelpers.h"
+#include <unordered_map>
+#include <type_traits>
+#include <fstream>
+#include <cstring>
+#include <cstdio>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace std;
+
+namespace PlannerHNS
+{
+
+const unsigned int RoadNetworkSnapshot::FORMAT_VERSION;
+
+static const char SNAPSHOT_MAGIC[8] = {'O', 'P', 'M', 'A', 'P', 'S', 'N', 'P'};
+static const unsigned int SNAPSHOT_BYTE_ORDER = 0x01020304;
+static const unsigned int SNAPSHOT_HEADER_SIZE = sizeof(SNAPSHOT_MAGIC) + 2*sizeof(unsigned int) + 2*sizeof(unsigned long long);
+
+//appends the records to a memory buffer, the links are written as indices of the pointed object in map order
+class SnapshotWriter
+{
+public:
+  std::string m_Data;
+  std::unordered_map<const RoadSegment*, int> m_SegmentIndex;
+  std::unordered_map<const Lane*, int> m_LaneIndex;
+  std::unordered_map<const WayPoint*, int> m_PointIndex;
+
+  template<typename T> void Write(const T& value)
+  {
+    static_assert(std::is_trivially_copyable<T>::value, "only plain values are written as is");
+    m_Data.append((const char*)&value, sizeof(T));
+  }
+
+  template<typename T> void WriteVector(const std::vector<T>& values)
+  {
+    static_assert(std::is_trivially_copyable<T>::value, "only plain values are written as is");
+    Write<unsigned int>(values.size());
+    if(values.size() > 0)
+      m_Data.append((const char*)values.data(), values.size()*sizeof(T));
+  }
+
+  void WriteString(const std::string& str)
+  {
+    Write<unsigned int>(str.size());
+    m_Data.append(str);
+  }
+
+  void WriteTime(const timespec& t)
+  {
+    Write<long long>(t.tv_sec);
+    Write<long long>(t.tv_nsec);
+  }
+
+  template<typename T> void WriteRef(const std::unordered_map<const T*, int>& index, const T* pObj)
+  {
+    int ref = -1;
+    typename std::unordered_map<const T*, int>::const_iterator it = index.find(pObj);
+    if(pObj != nullptr && it != index.end())
+      ref = it->second;
+    Write<int>(ref);
+  }
+
+  template<typename T> void WriteRefs(const std::unordered_map<const T*, int>& index, const std::vector<T*>& objs)
+  {
+    Write<unsigned int>(objs.size());
+    for(unsigned int i = 0; i < objs.size(); i++)
+      WriteRef(index, (const T*)objs.at(i));
+  }
+
+  void BuildIndex(const RoadNetwork& map)
+  {
+    int iLane = 0, iPoint = 0;
+    for(unsigned int rs = 0; rs < map.roadSegments.size(); rs++)
+    {
+      const RoadSegment* pSeg = &map.roadSegments.at(rs);
+      m_SegmentIndex[pSeg] = rs;
+      for(unsigned int i = 0; i < pSeg->Lanes.size(); i++)
+      {
+        const Lane* pL = &pSeg->Lanes.at(i);
+        m_LaneIndex[pL] = iLane++;
+        for(unsigned int p = 0; p < pL->points.size(); p++)
+          m_PointIndex[&pL->points.at(p)] = iPoint++;
+      }
+    }
+  }
+
+  void WriteBoundary(const Boundary& b)
+  {
+    Write<int>(b.id);
+    Write<int>(b.roadId);
+    WriteVector(b.points);
+    WriteRef(m_SegmentIndex, (const RoadSegment*)b.pSegment);
+  }
+
+  void WriteCrossing(const Crossing& c)
+  {
+    Write<int>(c.id);
+    Write<int>(c.roadId);
+    WriteVector(c.points);
+    WriteRef(m_SegmentIndex, (const RoadSegment*)c.pSegment);
+  }
+
+  void WriteTrafficLight(const TrafficLight& tl)
+  {
+    Write<int>(tl.id);
+    Write(tl.pos);
+    Write<int>(tl.lightState);
+    Write<double>(tl.stoppingDistance);
+    WriteVector(tl.laneIds);
+    WriteRefs(m_LaneIndex, tl.pLanes);
+    Write<int>(tl.linkID);
+  }
+
+  void WriteStopLine(const StopLine& sl)
+  {
+    Write<int>(sl.id);
+    Write<int>(sl.laneId);
+    Write<int>(sl.roadId);
+    Write<int>(sl.trafficLightID);
+    Write<int>(sl.stopSignID);
+    WriteVector(sl.points);
+    WriteRef(m_LaneIndex, (const Lane*)sl.pLane);
+    Write<int>(sl.linkID);
+  }
+
+  void WriteWaitingLine(const WaitingLine& wl)
+  {
+    Write<int>(wl.id);
+    Write<int>(wl.laneId);
+    Write<int>(wl.roadId);
+    WriteVector(wl.points);
+    WriteRef(m_LaneIndex, (const Lane*)wl.pLane);
+  }
+
+  void WriteCurb(const Curb& c)
+  {
+    Write<int>(c.id);
+    Write<int>(c.laneId);
+    Write<int>(c.roadId);
+    WriteVector(c.points);
+    WriteRef(m_LaneIndex, (const Lane*)c.pLane);
+  }
+
+  void WriteMarking(const Marking& m)
+  {
+    Write<int>(m.id);
+    Write<int>(m.laneId);
+    Write<int>(m.roadId);
+    Write<int>(m.mark_type);
+    Write(m.center);
+    WriteVector(m.points);
+    WriteRef(m_LaneIndex, (const Lane*)m.pLane);
+  }
+
+  void WriteTrafficSign(const TrafficSign& ts)
+  {
+    Write<int>(ts.id);
+    Write<int>(ts.laneId);
+    Write<int>(ts.roadId);
+    Write(ts.pos);
+    Write<int>(ts.signType);
+    Write<double>(ts.value);
+    Write<double>(ts.fromValue);
+    Write<double>(ts.toValue);
+    WriteString(ts.strValue);
+    WriteTime(ts.timeValue);
+    WriteTime(ts.fromTimeValue);
+    WriteTime(ts.toTimeValue);
+    WriteRef(m_LaneIndex, (const Lane*)ts.pLane);
+  }
+
+  void WriteWayPoint(const WayPoint& wp)
+  {
+    Write(wp.pos);
+    Write(wp.rot);
+    Write<double>(wp.v);
+    Write<double>(wp.cost);
+    Write<double>(wp.timeCost);
+    Write<double>(wp.totalReward);
+    Write<double>(wp.collisionCost);
+    Write<double>(wp.laneChangeCost);
+    Write<int>(wp.laneId);
+    Write<int>(wp.id);
+    Write<int>(wp.LeftPointId);
+    Write<int>(wp.RightPointId);
+    Write<int>(wp.LeftLnId);
+    Write<int>(wp.RightLnId);
+    Write<int>(wp.stopLineID);
+    Write<int>(wp.bDir);
+    Write<int>(wp.state);
+    Write<int>(wp.beh_state);
+    Write<int>(wp.iOriginalIndex);
+    Write<int>(wp.originalMapID);
+    Write<int>(wp.gid);
+    WriteRef(m_LaneIndex, (const Lane*)wp.pLane);
+    WriteRef(m_PointIndex, (const WayPoint*)wp.pLeft);
+    WriteRef(m_PointIndex, (const WayPoint*)wp.pRight);
+    WriteVector(wp.toIds);
+    WriteVector(wp.fromIds);
+    WriteRefs(m_PointIndex, wp.pFronts);
+    WriteRefs(m_PointIndex, wp.pBacks);
+    Write<unsigned int>(wp.actionCost.size());
+    for(unsigned int i = 0; i < wp.actionCost.size(); i++)
+    {
+      Write<int>(wp.actionCost.at(i).first);
+      Write<double>(wp.actionCost.at(i).second);
+    }
+  }
+
+  void WriteLane(const Lane& l)
+  {
+    Write<int>(l.id);
+    Write<int>(l.roadId);
+    Write<int>(l.areaId);
+    Write<int>(l.fromAreaId);
+    Write<int>(l.toAreaId);
+    WriteVector(l.fromIds);
+    WriteVector(l.toIds);
+    Write<int>(l.num);
+    Write<double>(l.speed);
+    Write<double>(l.length);
+    Write<double>(l.dir);
+    Write<int>(l.type);
+    Write<double>(l.width);
+    for(unsigned int p = 0; p < l.points.size(); p++)
+      WriteWayPoint(l.points.at(p));
+
+    Write<unsigned int>(l.trafficlights.size());
+    for(unsigned int i = 0; i < l.trafficlights.size(); i++)
+      WriteTrafficLight(l.trafficlights.at(i));
+
+    Write<unsigned int>(l.stopLines.size());
+    for(unsigned int i = 0; i < l.stopLines.size(); i++)
+      WriteStopLine(l.stopLines.at(i));
+
+    WriteWaitingLine(l.waitingLine);
+    WriteRefs(m_LaneIndex, l.fromLanes);
+    WriteRefs(m_LaneIndex, l.toLanes);
+    WriteRef(m_LaneIndex, (const Lane*)l.pLeftLane);
+    WriteRef(m_LaneIndex, (const Lane*)l.pRightLane);
+    WriteRef(m_SegmentIndex, (const RoadSegment*)l.pRoad);
+  }
+
+  void WriteSegment(const RoadSegment& seg)
+  {
+    Write<int>(seg.id);
+    Write<int>(seg.roadType);
+    WriteBoundary(seg.boundary);
+    WriteCrossing(seg.start_crossing);
+    WriteCrossing(seg.finish_crossing);
+    Write<double>(seg.avgWidth);
+    WriteVector(seg.fromIds);
+    WriteVector(seg.toIds);
+    WriteRefs(m_SegmentIndex, seg.fromLanes);
+    WriteRefs(m_SegmentIndex, seg.toLanes);
+    for(unsigned int i = 0; i < seg.Lanes.size(); i++)
+      WriteLane(seg.Lanes.at(i));
+  }
+
+  template<typename T> void WriteItems(const std::vector<T>& items, void (SnapshotWriter::*writeItem)(const T&))
+  {
+    Write<unsigned int>(items.size());
+    for(unsigned int i = 0; i < items.size(); i++)
+      (this->*writeItem)(items.at(i));
+  }
+
+  void WritePayload(const RoadNetwork& map)
+  {
+    BuildIndex(map);
+
+    //shape first, so the loader can size all the containers before reading any link
+    Write<unsigned int>(map.roadSegments.size());
+    for(unsigned int rs = 0; rs < map.roadSegments.size(); rs++)
+    {
+      const RoadSegment& seg = map.roadSegments.at(rs);
+      Write<unsigned int>(seg.Lanes.size());
+      for(unsigned int i = 0; i < seg.Lanes.size(); i++)
+        Write<unsigned int>(seg.Lanes.at(i).points.size());
+    }
+
+    for(unsigned int rs = 0; rs < map.roadSegments.size(); rs++)
+      WriteSegment(map.roadSegments.at(rs));
+
+    WriteItems(map.trafficLights, &SnapshotWriter::WriteTrafficLight);
+    WriteItems(map.stopLines, &SnapshotWriter::WriteStopLine);
+    WriteItems(map.curbs, &SnapshotWriter::WriteCurb);
+    WriteItems(map.boundaries, &SnapshotWriter::WriteBoundary);
+    WriteItems(map.crossings, &SnapshotWriter::WriteCrossing);
+    WriteItems(map.markings, &SnapshotWriter::WriteMarking);
+    WriteItems(map.signs, &SnapshotWriter::WriteTrafficSign);
+  }
+};
+
+//reads the records back from the mapped file, any out of range count, link or read marks the whole snapshot as damaged
+class SnapshotReader
+{
+public:
+  const char* m_pData;
+  const char* m_pEnd;
+  bool m_bError;
+  std::vector<RoadSegment*> m_Segments;
+  std::vector<Lane*> m_Lanes;
+  std::vector<WayPoint*> m_Points;
+
+  SnapshotReader(const char* pData, const unsigned long long& size)
+  {
+    m_pData = pData;
+    m_pEnd = pData + size;
+    m_bError = false;
+  }
+
+  unsigned long long GetRemainingSize() const
+  {
+    return m_pEnd - m_pData;
+  }
+
+  template<typename T> void Read(T& value)
+  {
+    if(m_bError || GetRemainingSize() < sizeof(T))
+    {
+      m_bError = true;
+      value = T();
+      return;
+    }
+    memcpy(&value, m_pData, sizeof(T));
+    m_pData += sizeof(T);
+  }
+
+  int ReadInt()
+  {
+    int value;
+    Read(value);
+    return value;
+  }
+
+  double ReadDouble()
+  {
+    double value;
+    Read(value);
+    return value;
+  }
+
+  //every item takes at least one byte, a larger count is a damaged file
+  unsigned int ReadCount()
+  {
+    unsigned int n;
+    Read(n);
+    if(n > GetRemainingSize())
+    {
+      m_bError = true;
+      return 0;
+    }
+    return n;
+  }
+
+  template<typename T> void ReadVector(std::vector<T>& values)
+  {
+    unsigned int n = ReadCount();
+    values.clear();
+    if(m_bError || n == 0) return;
+    if(GetRemainingSize() / sizeof(T) < n)
+    {
+      m_bError = true;
+      return;
+    }
+    values.resize(n);
+    memcpy(values.data(), m_pData, n*sizeof(T));
+    m_pData += n*sizeof(T);
+  }
+
+  void ReadString(std::string& str)
+  {
+    unsigned int n = ReadCount();
+    if(m_bError) return;
+    str.assign(m_pData, n);
+    m_pData += n;
+  }
+
+  void ReadTime(timespec& t)
+  {
+    long long sec, nsec;
+    Read(sec);
+    Read(nsec);
+    t.tv_sec = sec;
+    t.tv_nsec = nsec;
+  }
+
+  template<typename T> T* ReadRef(const std::vector<T*>& objs)
+  {
+    int ref = ReadInt();
+    if(ref < 0) return nullptr;
+    if(ref >= (int)objs.size())
+    {
+      m_bError = true;
+      return nullptr;
+    }
+    return objs.at(ref);
+  }
+
+  template<typename T> void ReadRefs(const std::vector<T*>& objs, std::vector<T*>& refs)
+  {
+    unsigned int n = ReadCount();
+    refs.clear();
+    refs.reserve(n);
+    for(unsigned int i = 0; i < n && !m_bError; i++)
+      refs.push_back(ReadRef(objs));
+  }
+
+  void ReadBoundary(Boundary& b)
+  {
+    b.id = ReadInt();
+    b.roadId = ReadInt();
+    ReadVector(b.points);
+    b.pSegment = ReadRef(m_Segments);
+  }
+
+  void ReadCrossing(Crossing& c)
+  {
+    c.id = ReadInt();
+    c.roadId = ReadInt();
+    ReadVector(c.points);
+    c.pSegment = ReadRef(m_Segments);
+  }
+
+  void ReadTrafficLight(TrafficLight& tl)
+  {
+    tl.id = ReadInt();
+    Read(tl.pos);
+    tl.lightState = (TrafficLightState)ReadInt();
+    tl.stoppingDistance = ReadDouble();
+    ReadVector(tl.laneIds);
+    ReadRefs(m_Lanes, tl.pLanes);
+    tl.linkID = ReadInt();
+  }
+
+  void ReadStopLine(StopLine& sl)
+  {
+    sl.id = ReadInt();
+    sl.laneId = ReadInt();
+    sl.roadId = ReadInt();
+    sl.trafficLightID = ReadInt();
+    sl.stopSignID = ReadInt();
+    ReadVector(sl.points);
+    sl.pLane = ReadRef(m_Lanes);
+    sl.linkID = ReadInt();
+  }
+
+  void ReadWaitingLine(WaitingLine& wl)
+  {
+    wl.id = ReadInt();
+    wl.laneId = ReadInt();
+    wl.roadId = ReadInt();
+    ReadVector(wl.points);
+    wl.pLane = ReadRef(m_Lanes);
+  }
+
+  void ReadCurb(Curb& c)
+  {
+    c.id = ReadInt();
+    c.laneId = ReadInt();
+    c.roadId = ReadInt();
+    ReadVector(c.points);
+    c.pLane = ReadRef(m_Lanes);
+  }
+
+  void ReadMarking(Marking& m)
+  {
+    m.id = ReadInt();
+    m.laneId = ReadInt();
+    m.roadId = ReadInt();
+    m.mark_type = (MARKING_TYPE)ReadInt();
+    Read(m.center);
+    ReadVector(m.points);
+    m.pLane = ReadRef(m_Lanes);
+  }
+
+  void ReadTrafficSign(TrafficSign& ts)
+  {
+    ts.id = ReadInt();
+    ts.laneId = ReadInt();
+    ts.roadId = ReadInt();
+    Read(ts.pos);
+    ts.signType = (TrafficSignTypes)ReadInt();
+    ts.value = ReadDouble();
+    ts.fromValue = ReadDouble();
+    ts.toValue = ReadDouble();
+    ReadString(ts.strValue);
+    ReadTime(ts.timeValue);
+    ReadTime(ts.fromTimeValue);
+    ReadTime(ts.toTimeValue);
+    ts.pLane = ReadRef(m_Lanes);
+  }
+
+  void ReadWayPoint(WayPoint& wp)
+  {
+    Read(wp.pos);
+    Read(wp.rot);
+    wp.v = ReadDouble();
+    wp.cost = ReadDouble();
+    wp.timeCost = ReadDouble();
+    wp.totalReward = ReadDouble();
+    wp.collisionCost = ReadDouble();
+    wp.laneChangeCost = ReadDouble();
+    wp.laneId = ReadInt();
+    wp.id = ReadInt();
+    wp.LeftPointId = ReadInt();
+    wp.RightPointId = ReadInt();
+    wp.LeftLnId = ReadInt();
+    wp.RightLnId = ReadInt();
+    wp.stopLineID = ReadInt();
+    wp.bDir = (DIRECTION_TYPE)ReadInt();
+    wp.state = (STATE_TYPE)ReadInt();
+    wp.beh_state = (BEH_STATE_TYPE)ReadInt();
+    wp.iOriginalIndex = ReadInt();
+    wp.originalMapID = ReadInt();
+    wp.gid = ReadInt();
+    wp.pLane = ReadRef(m_Lanes);
+    wp.pLeft = ReadRef(m_Points);
+    wp.pRight = ReadRef(m_Points);
+    ReadVector(wp.toIds);
+    ReadVector(wp.fromIds);
+    ReadRefs(m_Points, wp.pFronts);
+    ReadRefs(m_Points, wp.pBacks);
+    unsigned int nActions = ReadCount();
+    wp.actionCost.clear();
+    for(unsigned int i = 0; i < nActions && !m_bError; i++)
+    {
+      ACTION_TYPE action = (ACTION_TYPE)ReadInt();
+      double cost = ReadDouble();
+      wp.actionCost.push_back(make_pair(action, cost));
+    }
+  }
+
+  void ReadLane(Lane& l)
+  {
+    l.id = ReadInt();
+    l.roadId = ReadInt();
+    l.areaId = ReadInt();
+    l.fromAreaId = ReadInt();
+    l.toAreaId = ReadInt();
+    ReadVector(l.fromIds);
+    ReadVector(l.toIds);
+    l.num = ReadInt();
+    l.speed = ReadDouble();
+    l.length = ReadDouble();
+    l.dir = ReadDouble();
+    l.type = (LaneType)ReadInt();
+    l.width = ReadDouble();
+    for(unsigned int p = 0; p < l.points.size() && !m_bError; p++)
+      ReadWayPoint(l.points.at(p));
+
+    ReadItems(l.trafficlights, &SnapshotReader::ReadTrafficLight);
+    ReadItems(l.stopLines, &SnapshotReader::ReadStopLine);
+    ReadWaitingLine(l.waitingLine);
+    ReadRefs(m_Lanes, l.fromLanes);
+    ReadRefs(m_Lanes, l.toLanes);
+    l.pLeftLane = ReadRef(m_Lanes);
+    l.pRightLane = ReadRef(m_Lanes);
+    l.pRoad = ReadRef(m_Segments);
+  }
+
+  void ReadSegment(RoadSegment& seg)
+  {
+    seg.id = ReadInt();
+    seg.roadType = (SEGMENT_TYPE)ReadInt();
+    ReadBoundary(seg.boundary);
+    ReadCrossing(seg.start_crossing);
+    ReadCrossing(seg.finish_crossing);
+    seg.avgWidth = ReadDouble();
+    ReadVector(seg.fromIds);
+    ReadVector(seg.toIds);
+    ReadRefs(m_Segments, seg.fromLanes);
+    ReadRefs(m_Segments, seg.toLanes);
+    for(unsigned int i = 0; i < seg.Lanes.size() && !m_bError; i++)
+      ReadLane(seg.Lanes.at(i));
+  }
+
+  template<typename T> void ReadItems(std::vector<T>& items, void (SnapshotReader::*readItem)(T&))
+  {
+    unsigned int n = ReadCount();
+    items.clear();
+    items.resize(n);
+    for(unsigned int i = 0; i < n && !m_bError; i++)
+      (this->*readItem)(items.at(i));
+  }
+
+  bool ReadShape(RoadNetwork& map)
+  {
+    unsigned int nSegments = ReadCount();
+    map.roadSegments.resize(nSegments);
+    for(unsigned int rs = 0; rs < nSegments && !m_bError; rs++)
+    {
+      RoadSegment& seg = map.roadSegments.at(rs);
+      unsigned int nLanes = ReadCount();
+      seg.Lanes.resize(nLanes);
+      for(unsigned int i = 0; i < nLanes && !m_bError; i++)
+        seg.Lanes.at(i).points.resize(ReadCount());
+    }
+
+    if(m_bError) return false;
+
+    //the containers are not resized after this point, so the tables keep valid addresses
+    for(unsigned int rs = 0; rs < map.roadSegments.size(); rs++)
+    {
+      RoadSegment* pSeg = &map.roadSegments.at(rs);
+      m_Segments.push_back(pSeg);
+      for(unsigned int i = 0; i < pSeg->Lanes.size(); i++)
+      {
+        Lane* pL = &pSeg->Lanes.at(i);
+        m_Lanes.push_back(pL);
+        for(unsigned int p = 0; p < pL->points.size(); p++)
+          m_Points.push_back(&pL->points.at(p));
+      }
+    }
+
+    return true;
+  }
+
+  bool ReadPayload(RoadNetwork& map)
+  {
+    if(!ReadShape(map)) return false;
+
+    for(unsigned int rs = 0; rs < map.roadSegments.size() && !m_bError; rs++)
+      ReadSegment(map.roadSegments.at(rs));
+
+    ReadItems(map.trafficLights, &SnapshotReader::ReadTrafficLight);
+    ReadItems(map.stopLines, &SnapshotReader::ReadStopLine);
+    ReadItems(map.curbs, &SnapshotReader::ReadCurb);
+    ReadItems(map.boundaries, &SnapshotReader::ReadBoundary);
+    ReadItems(map.crossings, &SnapshotReader::ReadCrossing);
+    ReadItems(map.markings, &SnapshotReader::ReadMarking);
+    ReadItems(map.signs, &SnapshotReader::ReadTrafficSign);
+
+    return !m_bError && GetRemainingSize() == 0;
+  }
+};
+
+bool RoadNetworkSnapshot::SaveToFile(const std::string& fileName, const RoadNetwork& map, const unsigned long long& sourceSignature)
+{
+  SnapshotWriter payload;
+  payload.WritePayload(map);
+
+  SnapshotWriter header;
+  header.m_Data.append(SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+  header.Write<unsigned int>(FORMAT_VERSION);
+  header.Write<unsigned int>(SNAPSHOT_BYTE_ORDER);
+  header.Write<unsigned long long>(sourceSignature);
+  header.Write<unsigned long long>(payload.m_Data.size());
+
+  //readers never see a half written snapshot
+  std::string tempFileName = fileName + ".tmp";
+  ofstream f(tempFileName.c_str(), ios::binary | ios::trunc);
+  if(!f.is_open()) return false;
+
+  f.write(header.m_Data.data(), header.m_Data.size());
+  f.write(payload.m_Data.data(), payload.m_Data.size());
+  f.close();
+  if(!f.good())
+  {
+    remove(tempFileName.c_str());
+    return false;
+  }
+
+  if(rename(tempFileName.c_str(), fileName.c_str()) != 0)
+  {
+    remove(tempFileName.c_str());
+    return false;
+  }
+
+  return true;
+}
+
+bool RoadNetworkSnapshot::LoadFromFile(const std::string& fileName, const unsigned long long& sourceSignature, RoadNetwork& map)
+{
+  int fd = open(fileName.c_str(), O_RDONLY);
+  if(fd < 0) return false;
+
+  struct stat file_stat;
+  if(fstat(fd, &file_stat) != 0 || file_stat.st_size < (off_t)SNAPSHOT_HEADER_SIZE)
+  {
+    close(fd);
+    return false;
+  }
+
+  unsigned long long size = file_stat.st_size;
+  void* pFileData = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if(pFileData == MAP_FAILED) return false;
+  madvise(pFileData, size, MADV_SEQUENTIAL);
+
+  SnapshotReader reader((const char*)pFileData, size);
+  char magic[sizeof(SNAPSHOT_MAGIC)];
+  for(unsigned int i = 0; i < sizeof(magic); i++)
+    reader.Read(magic[i]);
+  unsigned int version = 0, byte_order = 0;
+  unsigned long long signature = 0, payload_size = 0;
+  reader.Read(version);
+  reader.Read(byte_order);
+  reader.Read(signature);
+  reader.Read(payload_size);
+
+  bool bLoaded = false;
+  RoadNetwork loaded_map;
+  if(memcmp(magic, SNAPSHOT_MAGIC, sizeof(magic)) == 0 && version == FORMAT_VERSION && byte_order == SNAPSHOT_BYTE_ORDER
+      && signature == sourceSignature && payload_size == reader.GetRemainingSize())
+  {
+    bLoaded = reader.ReadPayload(loaded_map);
+  }
+
+  munmap(pFileData, size);
+  if(!bLoaded) return false;
+
+  //moving the vectors keeps the addresses of their elements, the links stay valid
+  map = std::move(loaded_map);
+  map.spatialIndex.Build(map.roadSegments);
+  map.idIndex.Build(map.roadSegments);
+  MappingHelpers::UpdateMapVersion(map);
+  return true;
+}
+
+unsigned long long RoadNetworkSnapshot::GetFilesSignature(const std::vector<std::string>& fileNames)
+{
+  //64 bit FNV-1a
+  unsigned long long hash = 14695981039346656037ULL;
+  std::string data;
+  for(unsigned int i = 0; i < fileNames.size(); i++)
+  {
+    data.append(fileNames.at(i));
+    data.push_back(0);
+
+    long long values[3] = {-1, -1, -1};
+    struct stat file_stat;
+    if(stat(fileNames.at(i).c_str(), &file_stat) == 0)
+    {
+      values[0] = file_stat.st_size;
+      values[1] = file_stat.st_mtim.tv_sec;
+      values[2] = file_stat.st_mtim.tv_nsec;
+    }
+    data.append((const char*)values, sizeof(values));
+  }
+
+  for(unsigned int i = 0; i < data.size(); i++)
+  {
+    hash ^= (unsigned char)data.at(i);
+    hash *= 1099511628211ULL;
+  }
+
+  return hash;
+}
+
+} /* namespace PlannerHNS */
@@ -0,0 +1,633 @@
+/// \file RoadNetworkTiles.cpp
+/// \brief Tiled storage of a RoadNetwork, only the tiles around the ego pose are kept in memory and linked into the active map
+/// \date Oct 14, 2026
+
+#include "op_planner/RoadNetworkTiles.h"
+#include "op_planner/RoadNetworkSnapshot.h"
+#include "op_planner/MappingHelpers.h"
+#include <unordered_map>
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include <cmath>
+
+using namespace std;
+
+namespace PlannerHNS
+{
+
+const unsigned int RoadNetworkTiles::FORMAT_VERSION;
+
+static const char* TILES_CATALOG_MAGIC = "OPMAPTILES";
+
+//tile of one point, (0, 0) for objects without points
+static void GetPointTile(const double& tileSize, const GPSPoint& p, int& ix, int& iy)
+{
+  ix = (int)floor(p.x / tileSize);
+  iy = (int)floor(p.y / tileSize);
+}
+
+static void GetPointsTile(const double& tileSize, const std::vector<GPSPoint>& points, int& ix, int& iy)
+{
+  ix = 0;
+  iy = 0;
+  if(points.size() > 0)
+    GetPointTile(tileSize, points.at(points.size()/2), ix, iy);
+}
+
+static Lane* GetLaneById(RoadNetwork& map, const int& laneId)
+{
+  std::unordered_map<int, std::vector<MapIdIndex::Location> >::const_iterator it = map.idIndex.lanes.find(laneId);
+  if(it == map.idIndex.lanes.end() || it->second.size() == 0) return nullptr;
+
+  const MapIdIndex::Location& loc = it->second.at(0);
+  return &map.roadSegments.at(loc.iSegment).Lanes.at(loc.iLane);
+}
+
+static WayPoint* GetLaneWayPointById(RoadNetwork& map, const int& laneId, const int& pointId)
+{
+  std::unordered_map<int, std::vector<MapIdIndex::Location> >::const_iterator it = map.idIndex.waypoints.find(pointId);
+  if(it == map.idIndex.waypoints.end()) return nullptr;
+
+  for(unsigned int i = 0; i < it->second.size(); i++)
+  {
+    const MapIdIndex::Location& loc = it->second.at(i);
+    Lane* pL = &map.roadSegments.at(loc.iSegment).Lanes.at(loc.iLane);
+    if(pL->id == laneId)
+      return &pL->points.at(loc.iPoint);
+  }
+
+  return nullptr;
+}
+
+static void GetLanesByIds(RoadNetwork& map, const std::vector<int>& laneIds, std::vector<Lane*>& lanes)
+{
+  lanes.clear();
+  for(unsigned int i = 0; i < laneIds.size(); i++)
+  {
+    Lane* pL = GetLaneById(map, laneIds.at(i));
+    if(pL != nullptr)
+      lanes.push_back(pL);
+  }
+}
+
+RoadNetworkTiles::RoadNetworkTiles()
+{
+  m_TileSize = 0;
+  m_LoadRadius = 250;
+  m_ActiveMapVersion = 0;
+}
+
+RoadNetworkTiles::~RoadNetworkTiles()
+{
+  Close();
+}
+
+long long RoadNetworkTiles::GetTileKey(const int& ix, const int& iy)
+{
+  return ((long long)ix << 32) ^ ((long long)iy & 0xffffffffLL);
+}
+
+std::string RoadNetworkTiles::GetCatalogFileName(const std::string& folder)
+{
+  return folder + "op_planner_map_tiles.catalog";
+}
+
+bool RoadNetworkTiles::WriteTiles(const RoadNetwork& map, const double& tileSize, const std::string& folder)
+{
+  if(tileSize <= 0) return false;
+
+  std::map<long long, RoadNetwork> tiles;
+  std::map<long long, std::pair<int, int> > tiles_xy;
+  std::unordered_map<long long, std::unordered_map<int, int> > tiles_segments; // tile key -> segment id -> segment index in the tile
+  std::vector<std::pair<int, long long> > lane_tiles;
+
+  for(unsigned int rs = 0; rs < map.roadSegments.size(); rs++)
+  {
+    const RoadSegment& seg = map.roadSegments.at(rs);
+    for(unsigned int i = 0; i < seg.Lanes.size(); i++)
+    {
+      const Lane& l = seg.Lanes.at(i);
+      if(l.points.size() == 0) continue;
+
+      int ix, iy;
+      GetPointTile(tileSize, l.points.at(l.points.size()/2).pos, ix, iy);
+      long long key = GetTileKey(ix, iy);
+      tiles_xy[key] = std::make_pair(ix, iy);
+      RoadNetwork& tile = tiles[key];
+      std::unordered_map<int, int>& segments = tiles_segments[key];
+      std::unordered_map<int, int>::iterator it = segments.find(seg.id);
+      if(it == segments.end())
+      {
+        RoadSegment tile_seg;
+        tile_seg.id = seg.id;
+        tile_seg.roadType = seg.roadType;
+        tile_seg.boundary = seg.boundary;
+        tile_seg.start_crossing = seg.start_crossing;
+        tile_seg.finish_crossing = seg.finish_crossing;
+        tile_seg.avgWidth = seg.avgWidth;
+        tile_seg.fromIds = seg.fromIds;
+        tile_seg.toIds = seg.toIds;
+        tile.roadSegments.push_back(tile_seg);
+        it = segments.insert(std::make_pair(seg.id, (int)tile.roadSegments.size() - 1)).first;
+      }
+
+      tile.roadSegments.at(it->second).Lanes.push_back(l);
+      lane_tiles.push_back(std::make_pair(l.id, key));
+    }
+  }
+
+  //map objects go to the tile of their middle point, pointers out of the tile are written as null by the snapshot
+  int ix, iy;
+  for(unsigned int i = 0; i < map.trafficLights.size(); i++)
+  {
+    GetPointTile(tileSize, map.trafficLights.at(i).pos, ix, iy);
+    tiles_xy[GetTileKey(ix, iy)] = std::make_pair(ix, iy);
+    tiles[GetTileKey(ix, iy)].trafficLights.push_back(map.trafficLights.at(i));
+  }
+  for(unsigned int i = 0; i < map.stopLines.size(); i++)
+  {
+    GetPointsTile(tileSize, map.stopLines.at(i).points, ix, iy);
+    tiles_xy[GetTileKey(ix, iy)] = std::make_pair(ix, iy);
+    tiles[GetTileKey(ix, iy)].stopLines.push_back(map.stopLines.at(i));
+  }
+  for(unsigned int i = 0; i < map.curbs.size(); i++)
+  {
+    GetPointsTile(tileSize, map.curbs.at(i).points, ix, iy);
+    tiles_xy[GetTileKey(ix, iy)] = std::make_pair(ix, iy);
+    tiles[GetTileKey(ix, iy)].curbs.push_back(map.curbs.at(i));
+  }
+  for(unsigned int i = 0; i < map.boundaries.size(); i++)
+  {
+    GetPointsTile(tileSize, map.boundaries.at(i).points, ix, iy);
+    tiles_xy[GetTileKey(ix, iy)] = std::make_pair(ix, iy);
+    tiles[GetTileKey(ix, iy)].boundaries.push_back(map.boundaries.at(i));
+  }
+  for(unsigned int i = 0; i < map.crossings.size(); i++)
+  {
+    GetPointsTile(tileSize, map.crossings.at(i).points, ix, iy);
+    tiles_xy[GetTileKey(ix, iy)] = std::make_pair(ix, iy);
+    tiles[GetTileKey(ix, iy)].crossings.push_back(map.crossings.at(i));
+  }
+  for(unsigned int i = 0; i < map.markings.size(); i++)
+  {
+    GetPointTile(tileSize, map.markings.at(i).center, ix, iy);
+    tiles_xy[GetTileKey(ix, iy)] = std::make_pair(ix, iy);
+    tiles[GetTileKey(ix, iy)].markings.push_back(map.markings.at(i));
+  }
+  for(unsigned int i = 0; i < map.signs.size(); i++)
+  {
+    GetPointTile(tileSize, map.signs.at(i).pos, ix, iy);
+    tiles_xy[GetTileKey(ix, iy)] = std::make_pair(ix, iy);
+    tiles[GetTileKey(ix, iy)].signs.push_back(map.signs.at(i));
+  }
+
+  std::string catalog_name = GetCatalogFileName(folder);
+  std::ofstream catalog((catalog_name + ".tmp").c_str());
+  if(!catalog.is_open())
+  {
+    std::cout << "Can't write map tiles catalog, " << catalog_name << std::endl;
+    return false;
+  }
+
+  catalog.precision(16);
+  catalog << TILES_CATALOG_MAGIC << " " << FORMAT_VERSION << std::endl;
+  catalog << tileSize << " " << tiles.size() << " " << lane_tiles.size() << std::endl;
+
+  for(std::map<long long, RoadNetwork>::const_iterator it = tiles.begin(); it != tiles.end(); it++)
+  {
+    const std::pair<int, int>& xy = tiles_xy.at(it->first);
+    std::ostringstream file_name;
+    file_name << "tile_" << xy.first << "_" << xy.second << ".snapshot";
+    if(!RoadNetworkSnapshot::SaveToFile(folder + file_name.str(), it->second, (unsigned long long)it->first))
+      return false;
+
+    catalog << xy.first << " " << xy.second << " " << file_name.str() << std::endl;
+  }
+
+  for(unsigned int i = 0; i < lane_tiles.size(); i++)
+  {
+    const std::pair<int, int>& xy = tiles_xy.at(lane_tiles.at(i).second);
+    catalog << lane_tiles.at(i).first << " " << xy.first << " " << xy.second << std::endl;
+  }
+
+  catalog.close();
+  if(catalog.fail() || rename((catalog_name + ".tmp").c_str(), catalog_name.c_str()) != 0)
+  {
+    std::cout << "Can't write map tiles catalog, " << catalog_name << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
+void RoadNetworkTiles::RelinkFromIds(RoadNetwork& map)
+{
+  for(unsigned int rs = 0; rs < map.roadSegments.size(); rs++)
+  {
+    RoadSegment& seg = map.roadSegments.at(rs);
+    seg.fromLanes.clear();
+    seg.toLanes.clear();
+    seg.boundary.pSegment = &seg;
+    seg.start_crossing.pSegment = &seg;
+    seg.finish_crossing.pSegment = &seg;
+    for(unsigned int i = 0; i < seg.Lanes.size(); i++)
+    {
+      Lane* pL = &seg.Lanes.at(i);
+      pL->fromLanes.clear();
+      pL->toLanes.clear();
+      pL->pLeftLane = nullptr;
+      pL->pRightLane = nullptr;
+      pL->pRoad = nullptr;
+      for(unsigned int p = 0; p < pL->points.size(); p++)
+      {
+        WayPoint* pWP = &pL->points.at(p);
+        pWP->pLane = nullptr;
+        pWP->pLeft = nullptr;
+        pWP->pRight = nullptr;
+        pWP->pFronts.clear();
+        pWP->pBacks.clear();
+      }
+    }
+  }
+
+  //lanes and waypoints of the same road segment, the id index is built here too
+  MappingHelpers::LinkLanesPointers(map);
+  MappingHelpers::LinkMissingBranchingWayPointsV2(map);
+
+  for(unsigned int rs = 0; rs < map.roadSegments.size(); rs++)
+  {
+    for(unsigned int i = 0; i < map.roadSegments.at(rs).Lanes.size(); i++)
+    {
+      Lane* pL = &map.roadSegments.at(rs).Lanes.at(i);
+      for(unsigned int p = 0; p < pL->points.size(); p++)
+      {
+        WayPoint* pWP = &pL->points.at(p);
+        if(pWP->LeftLnId > 0)
+        {
+          pWP->pLeft = GetLaneWayPointById(map, pWP->LeftLnId, pWP->LeftPointId);
+          if(pWP->pLeft != nullptr)
+            pL->pLeftLane = pWP->pLeft->pLane;
+        }
+
+        if(pWP->RightLnId > 0)
+        {
+          pWP->pRight = GetLaneWayPointById(map, pWP->RightLnId, pWP->RightPointId);
+          if(pWP->pRight != nullptr)
+            pL->pRightLane = pWP->pRight->pLane;
+        }
+      }
+
+      for(unsigned int j = 0; j < pL->stopLines.size(); j++)
+        pL->stopLines.at(j).pLane = GetLaneById(map, pL->stopLines.at(j).laneId);
+
+      for(unsigned int j = 0; j < pL->trafficlights.size(); j++)
+        GetLanesByIds(map, pL->trafficlights.at(j).laneIds, pL->trafficlights.at(j).pLanes);
+
+      pL->waitingLine.pLane = GetLaneById(map, pL->waitingLine.laneId);
+    }
+  }
+
+  for(unsigned int i = 0; i < map.trafficLights.size(); i++)
+    GetLanesByIds(map, map.trafficLights.at(i).laneIds, map.trafficLights.at(i).pLanes);
+
+  for(unsigned int i = 0; i < map.stopLines.size(); i++)
+    map.stopLines.at(i).pLane = GetLaneById(map, map.stopLines.at(i).laneId);
+
+  for(unsigned int i = 0; i < map.curbs.size(); i++)
+    map.curbs.at(i).pLane = GetLaneById(map, map.curbs.at(i).laneId);
+
+  for(unsigned int i = 0; i < map.markings.size(); i++)
+    map.markings.at(i).pLane = GetLaneById(map, map.markings.at(i).laneId);
+
+  for(unsigned int i = 0; i < map.signs.size(); i++)
+    map.signs.at(i).pLane = GetLaneById(map, map.signs.at(i).laneId);
+
+  std::unordered_map<int, RoadSegment*> segments;
+  for(unsigned int rs = 0; rs < map.roadSegments.size(); rs++)
+    segments[map.roadSegments.at(rs).id] = &map.roadSegments.at(rs);
+
+  for(unsigned int i = 0; i < map.boundaries.size(); i++)
+  {
+    std::unordered_map<int, RoadSegment*>::const_iterator it = segments.find(map.boundaries.at(i).roadId);
+    map.boundaries.at(i).pSegment = it != segments.end() ? it->second : nullptr;
+  }
+
+  for(unsigned int i = 0; i < map.crossings.size(); i++)
+  {
+    std::unordered_map<int, RoadSegment*>::const_iterator it = segments.find(map.crossings.at(i).roadId);
+    map.crossings.at(i).pSegment = it != segments.end() ? it->second : nullptr;
+  }
+
+  map.spatialIndex.Build(map.roadSegments);
+  MappingHelpers::UpdateMapVersion(map);
+}
+
+bool RoadNetworkTiles::Open(const std::string& folder)
+{
+  Close();
+
+  std::ifstream catalog(GetCatalogFileName(folder).c_str());
+  if(!catalog.is_open())
+  {
+    std::cout << "Can't open map tiles catalog, " << GetCatalogFileName(folder) << std::endl;
+    return false;
+  }
+
+  std::string magic;
+  unsigned int version = 0, nTiles = 0, nLanes = 0;
+  double tileSize = 0;
+  catalog >> magic >> version >> tileSize >> nTiles >> nLanes;
+  if(catalog.fail() || magic != TILES_CATALOG_MAGIC || version != FORMAT_VERSION || tileSize <= 0)
+  {
+    std::cout << "Wrong map tiles catalog format, " << GetCatalogFileName(folder) << std::endl;
+    return false;
+  }
+
+  for(unsigned int i = 0; i < nTiles; i++)
+  {
+    int ix, iy;
+    std::string file_name;
+    catalog >> ix >> iy >> file_name;
+    if(catalog.fail()) break;
+
+    Tile& tile = m_Tiles[GetTileKey(ix, iy)];
+    tile.ix = ix;
+    tile.iy = iy;
+    tile.fileName = folder + file_name;
+  }
+
+  for(unsigned int i = 0; i < nLanes && !catalog.fail(); i++)
+  {
+    int laneId, ix, iy;
+    catalog >> laneId >> ix >> iy;
+    if(!catalog.fail())
+      m_LaneTiles[laneId] = GetTileKey(ix, iy);
+  }
+
+  if(catalog.fail() || m_Tiles.size() != nTiles)
+  {
+    std::cout << "Damaged map tiles catalog, " << GetCatalogFileName(folder) << std::endl;
+    Close();
+    return false;
+  }
+
+  m_Folder = folder;
+  m_TileSize = tileSize;
+  return true;
+}
+
+void RoadNetworkTiles::Close()
+{
+  for(std::map<long long, Tile>::iterator it = m_Tiles.begin(); it != m_Tiles.end(); it++)
+  {
+    if(it->second.loading.valid())
+      it->second.loading.wait();
+  }
+
+  m_Tiles.clear();
+  m_LaneTiles.clear();
+  m_ActiveTiles.clear();
+  m_LinkedTiles.clear();
+  m_PrefetchTiles.clear();
+  m_Folder.clear();
+  m_TileSize = 0;
+  m_ActiveMapVersion = 0;
+}
+
+bool RoadNetworkTiles::IsOpen() const
+{
+  return m_TileSize > 0;
+}
+
+void RoadNetworkTiles::SetLoadRadius(const double& radius)
+{
+  m_LoadRadius = radius;
+}
+
+double RoadNetworkTiles::GetLoadRadius() const
+{
+  return m_LoadRadius;
+}
+
+double RoadNetworkTiles::GetTileSize() const
+{
+  return m_TileSize;
+}
+
+double RoadNetworkTiles::GetDistanceToTile(const GPSPoint& p, const Tile& tile) const
+{
+  double min_x = tile.ix * m_TileSize;
+  double min_y = tile.iy * m_TileSize;
+  double dx = std::max(0.0, std::max(min_x - p.x, p.x - (min_x + m_TileSize)));
+  double dy = std::max(0.0, std::max(min_y - p.y, p.y - (min_y + m_TileSize)));
+  return hypot(dx, dy);
+}
+
+void RoadNetworkTiles::GetTilesInRadius(const GPSPoint& p, const double& radius, std::set<long long>& keys) const
+{
+  int min_ix = (int)floor((p.x - radius) / m_TileSize);
+  int max_ix = (int)floor((p.x + radius) / m_TileSize);
+  int min_iy = (int)floor((p.y - radius) / m_TileSize);
+  int max_iy = (int)floor((p.y + radius) / m_TileSize);
+
+  for(int ix = min_ix; ix <= max_ix; ix++)
+  {
+    for(int iy = min_iy; iy <= max_iy; iy++)
+    {
+      std::map<long long, Tile>::const_iterator it = m_Tiles.find(GetTileKey(ix, iy));
+      if(it != m_Tiles.end() && GetDistanceToTile(p, it->second) <= radius)
+        keys.insert(it->first);
+    }
+  }
+}
+
+bool RoadNetworkTiles::LoadTile(Tile& tile)
+{
+  if(tile.loading.valid())
+    tile.bLoaded = tile.loading.get();
+  else if(!tile.bLoaded)
+    tile.bLoaded = RoadNetworkSnapshot::LoadFromFile(tile.fileName, (unsigned long long)GetTileKey(tile.ix, tile.iy), tile.map);
+
+  if(!tile.bLoaded)
+    std::cout << "Can't load map tile, " << tile.fileName << std::endl;
+
+  return tile.bLoaded;
+}
+
+void RoadNetworkTiles::EvictTiles(const GPSPoint& p)
+{
+  double evict_radius = m_LoadRadius + m_TileSize;
+  for(std::map<long long, Tile>::iterator it = m_Tiles.begin(); it != m_Tiles.end(); it++)
+  {
+    Tile& tile = it->second;
+
+    //finished background loads are collected here, running ones are left alone
+    if(tile.loading.valid())
+    {
+      if(tile.loading.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+        continue;
+      tile.bLoaded = tile.loading.get();
+    }
+
+    if(m_ActiveTiles.find(it->first) != m_ActiveTiles.end() || m_PrefetchTiles.find(it->first) != m_PrefetchTiles.end())
+      continue;
+
+    if(tile.bLoaded && GetDistanceToTile(p, tile) > evict_radius)
+    {
+      tile.map = RoadNetwork();
+      tile.bLoaded = false;
+    }
+  }
+}
+
+void RoadNetworkTiles::BuildActiveMap(RoadNetwork& map)
+{
+  RoadNetwork active;
+  std::unordered_map<int, int> segments;
+  for(std::set<long long>::const_iterator it = m_ActiveTiles.begin(); it != m_ActiveTiles.end(); it++)
+  {
+    const Tile& tile = m_Tiles.at(*it);
+    if(!tile.bLoaded) continue;
+
+    for(unsigned int rs = 0; rs < tile.map.roadSegments.size(); rs++)
+    {
+      const RoadSegment& seg = tile.map.roadSegments.at(rs);
+      std::unordered_map<int, int>::const_iterator seg_it = segments.find(seg.id);
+      if(seg_it == segments.end())
+      {
+        segments[seg.id] = active.roadSegments.size();
+        active.roadSegments.push_back(seg);
+      }
+      else
+      {
+        std::vector<Lane>& lanes = active.roadSegments.at(seg_it->second).Lanes;
+        lanes.insert(lanes.end(), seg.Lanes.begin(), seg.Lanes.end());
+      }
+    }
+
+    active.trafficLights.insert(active.trafficLights.end(), tile.map.trafficLights.begin(), tile.map.trafficLights.end());
+    active.stopLines.insert(active.stopLines.end(), tile.map.stopLines.begin(), tile.map.stopLines.end());
+    active.curbs.insert(active.curbs.end(), tile.map.curbs.begin(), tile.map.curbs.end());
+    active.boundaries.insert(active.boundaries.end(), tile.map.boundaries.begin(), tile.map.boundaries.end());
+    active.crossings.insert(active.crossings.end(), tile.map.crossings.begin(), tile.map.crossings.end());
+    active.markings.insert(active.markings.end(), tile.map.markings.begin(), tile.map.markings.end());
+    active.signs.insert(active.signs.end(), tile.map.signs.begin(), tile.map.signs.end());
+  }
+
+  //the copied links point into the tiles, all of them are resolved again for the active lanes
+  RelinkFromIds(active);
+  map = std::move(active);
+  m_ActiveMapVersion = map.version;
+}
+
+bool RoadNetworkTiles::UpdateActiveTiles(const WayPoint& pose, RoadNetwork& map)
+{
+  if(!IsOpen()) return false;
+
+  std::set<long long> active;
+  GetTilesInRadius(pose.pos, m_LoadRadius, active);
+
+  double evict_radius = m_LoadRadius + m_TileSize;
+  for(std::set<long long>::iterator it = m_LinkedTiles.begin(); it != m_LinkedTiles.end();)
+  {
+    if(GetDistanceToTile(pose.pos, m_Tiles.at(*it)) > evict_radius)
+    {
+      it = m_LinkedTiles.erase(it);
+    }
+    else
+    {
+      active.insert(*it);
+      it++;
+    }
+  }
+
+  for(std::set<long long>::const_iterator it = active.begin(); it != active.end(); it++)
+    LoadTile(m_Tiles.at(*it));
+
+  bool bChanged = active != m_ActiveTiles || map.version != m_ActiveMapVersion;
+  m_ActiveTiles = active;
+  EvictTiles(pose.pos);
+
+  if(!bChanged) return false;
+
+  BuildActiveMap(map);
+  return true;
+}
+
+void RoadNetworkTiles::PrefetchAlongPath(const std::vector<WayPoint>& path)
+{
+  if(!IsOpen()) return;
+
+  m_PrefetchTiles.clear();
+  for(unsigned int i = 0; i < path.size(); i++)
+    GetTilesInRadius(path.at(i).pos, m_LoadRadius, m_PrefetchTiles);
+
+  for(std::set<long long>::const_iterator it = m_PrefetchTiles.begin(); it != m_PrefetchTiles.end(); it++)
+  {
+    Tile* pTile = &m_Tiles.at(*it);
+    if(pTile->bLoaded || pTile->loading.valid()) continue;
+
+    unsigned long long signature = (unsigned long long)*it;
+    pTile->loading = std::async(std::launch::async, [pTile, signature]()
+    {
+      return RoadNetworkSnapshot::LoadFromFile(pTile->fileName, signature, pTile->map);
+    });
+  }
+}
+
+void RoadNetworkTiles::WaitForPrefetch()
+{
+  for(std::map<long long, Tile>::iterator it = m_Tiles.begin(); it != m_Tiles.end(); it++)
+  {
+    if(it->second.loading.valid())
+      it->second.bLoaded = it->second.loading.get();
+  }
+}
+
+bool RoadNetworkTiles::ActivateLaneTile(const int& laneId, RoadNetwork& map)
+{
+  std::unordered_map<int, long long>::const_iterator it = m_LaneTiles.find(laneId);
+  if(it == m_LaneTiles.end()) return false;
+
+  if(!LoadTile(m_Tiles.at(it->second))) return false;
+
+  m_LinkedTiles.insert(it->second);
+  if(m_ActiveTiles.find(it->second) != m_ActiveTiles.end() && map.version == m_ActiveMapVersion)
+    return true;
+
+  m_ActiveTiles.insert(it->second);
+  BuildActiveMap(map);
+  return true;
+}
+
+bool RoadNetworkTiles::IsLaneActive(const int& laneId) const
+{
+  std::unordered_map<int, long long>::const_iterator it = m_LaneTiles.find(laneId);
+  if(it == m_LaneTiles.end()) return false;
+
+  return m_ActiveTiles.find(it->second) != m_ActiveTiles.end() && m_Tiles.at(it->second).bLoaded;
+}
+
+unsigned int RoadNetworkTiles::GetNumberOfTiles() const
+{
+  return m_Tiles.size();
+}
+
+unsigned int RoadNetworkTiles::GetNumberOfLoadedTiles() const
+{
+  unsigned int n = 0;
+  for(std::map<long long, Tile>::const_iterator it = m_Tiles.begin(); it != m_Tiles.end(); it++)
+  {
+    if(it->second.bLoaded)
+      n++;
+  }
+  return n;
+}
+
+unsigned int RoadNetworkTiles::GetNumberOfActiveTiles() const
+{
+  return m_ActiveTiles.size();
+}
+
+} /* namespace PlannerHNS */
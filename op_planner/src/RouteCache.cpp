@@ -0,0 +1,92 @@
+/// \file RouteCache.cpp
+/// \brief Least recently used cache of global plans, keyed on the start and goal map waypoints and the map version
+/// \date Oct 14, 2026
+
+#include "op_planner/RouteCache.h"
+
+namespace PlannerHNS
+{
+
+RouteCache::RouteCache(const unsigned int& capacity)
+{
+  m_Capacity = capacity;
+  m_nHits = 0;
+  m_nMisses = 0;
+}
+
+RouteCache::~RouteCache()
+{
+}
+
+void RouteCache::SetCapacity(const unsigned int& capacity)
+{
+  m_Capacity = capacity;
+  while(m_Entries.size() > m_Capacity)
+    m_Entries.pop_back();
+}
+
+unsigned int RouteCache::GetCapacity() const
+{
+  return m_Capacity;
+}
+
+unsigned int RouteCache::GetSize() const
+{
+  return m_Entries.size();
+}
+
+void RouteCache::Clear()
+{
+  m_Entries.clear();
+}
+
+bool RouteCache::Find(const RouteCacheKey& key, std::vector<std::vector<WayPoint> >& paths, double& totalDistance)
+{
+  std::list<Entry>::iterator it = m_Entries.begin();
+  while(it != m_Entries.end())
+  {
+    if(it->key.pMap == key.pMap && it->key.mapVersion != key.mapVersion)
+    {
+      it = m_Entries.erase(it);
+      continue;
+    }
+
+    if(it->key == key)
+    {
+      m_Entries.splice(m_Entries.begin(), m_Entries, it);
+      paths = m_Entries.front().paths;
+      totalDistance = m_Entries.front().totalDistance;
+      m_nHits++;
+      return true;
+    }
+    it++;
+  }
+
+  m_nMisses++;
+  return false;
+}
+
+void RouteCache::Insert(const RouteCacheKey& key, const std::vector<std::vector<WayPoint> >& paths, const double& totalDistance)
+{
+  if(m_Capacity == 0) return;
+
+  for(std::list<Entry>::iterator it = m_Entries.begin(); it != m_Entries.end(); it++)
+  {
+    if(it->key == key)
+    {
+      m_Entries.erase(it);
+      break;
+    }
+  }
+
+  Entry e;
+  e.key = key;
+  e.paths = paths;
+  e.totalDistance = totalDistance;
+  m_Entries.push_front(e);
+
+  while(m_Entries.size() > m_Capacity)
+    m_Entries.pop_back();
+}
+
+} /* namespace PlannerHNS */
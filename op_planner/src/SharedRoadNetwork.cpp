@@ -0,0 +1,66 @@
+/// \file SharedRoadNetwork.cpp
+/// \brief One read only RoadNetwork per process shared by the planners, replaced as a whole when a new map arrives
+/// \date Oct 14, 2026
+
+#include "op_planner/SharedRoadNetwork.h"
+#include "op_planner/MappingHelpers.h"
+
+namespace PlannerHNS
+{
+
+SharedRoadNetwork::SharedRoadNetwork() : m_Version(0)
+{
+}
+
+SharedRoadNetwork::~SharedRoadNetwork()
+{
+}
+
+SharedRoadNetwork& SharedRoadNetwork::GetProcessMap()
+{
+  static SharedRoadNetwork process_map;
+  return process_map;
+}
+
+unsigned long SharedRoadNetwork::Publish(RoadNetwork& map)
+{
+  //moving keeps the lanes and waypoints at their addresses, so the map links stay valid
+  std::shared_ptr<RoadNetwork> pNewMap = std::make_shared<RoadNetwork>(std::move(map));
+  map = RoadNetwork();
+  MappingHelpers::UpdateMapVersion(*pNewMap);
+  unsigned long version = pNewMap->version;
+
+  std::atomic_store(&m_pMap, RoadNetworkSnapshotPtr(pNewMap));
+  m_Version.store(version);
+  return version;
+}
+
+RoadNetworkSnapshotPtr SharedRoadNetwork::GetSnapshot() const
+{
+  return std::atomic_load(&m_pMap);
+}
+
+bool SharedRoadNetwork::Update(RoadNetworkSnapshotPtr& pMap) const
+{
+  unsigned long current_version = pMap ? pMap->version : 0;
+  if(current_version == m_Version.load()) return false;
+
+  RoadNetworkSnapshotPtr pNewMap = std::atomic_load(&m_pMap);
+  if(pNewMap == pMap) return false;
+
+  pMap = pNewMap;
+  return true;
+}
+
+unsigned long SharedRoadNetwork::GetVersion() const
+{
+  return m_Version.load();
+}
+
+void SharedRoadNetwork::Clear()
+{
+  std::atomic_store(&m_pMap, RoadNetworkSnapshotPtr());
+  m_Version.store(0);
+}
+
+} /* namespace PlannerHNS */
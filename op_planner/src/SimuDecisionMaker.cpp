@@ -49,6 +49,8 @@ void SimuDecisionMaker::ReInitializePlanner(const WayPoint& start_pose)
   m_pCurrentBehaviorState = m_pFollowState;
   m_TotalPath.clear();
   m_TotalOriginalPath.clear();
+  m_bGlobalPathFingerprint = false;
+  m_LaneTracker.Reset();
   m_Path.clear();
   m_RollOuts.clear();
   m_pCurrentBehaviorState->m_Behavior = PlannerHNS::FORWARD_STATE;
@@ -135,25 +137,46 @@ void SimuDecisionMaker::FirstLocalizeMe(const WayPoint& initCarPos)
   std::vector<PlannerHNS::WayPoint> sampledPoints_debug;
   std::vector<std::vector<std::vector<PlannerHNS::WayPoint> > > _roll_outs;
   PlannerHNS::PlannerH _planner;
-  _planner.GenerateRunoffTrajectory(m_TotalPath, state,
-            m_params.enableLaneChange,
-            state.v,
-            m_params.microPlanDistance,
-            m_params.maxSpeed,
-            m_params.minSpeed,
-            m_params.carTipMargin,
-            m_params.rollInMargin,
-            m_params.rollInSpeedFactor,
-            m_params.pathDensity,
-            m_params.rollOutDensity,
-            m_params.rollOutNumber,
-            m_params.smoothingDataWeight,
-            m_params.smoothingSmoothWeight,
-            m_params.smoothingToleranceError,
-            m_params.speedProfileFactor,
-            m_params.enableHeadingSmoothing,
-            -1 , -1,
-            _roll_outs, sampledPoints_debug);
+  if(m_params.enableIncrementalRollOuts)
+    _planner.GenerateRunoffTrajectory(m_TotalPath, state,
+              m_params.enableLaneChange,
+              state.v,
+              m_params.microPlanDistance,
+              m_params.maxSpeed,
+              m_params.minSpeed,
+              m_params.carTipMargin,
+              m_params.rollInMargin,
+              m_params.rollInSpeedFactor,
+              m_params.pathDensity,
+              m_params.rollOutDensity,
+              m_params.rollOutNumber,
+              m_params.smoothingDataWeight,
+              m_params.smoothingSmoothWeight,
+              m_params.smoothingToleranceError,
+              m_params.speedProfileFactor,
+              m_params.enableHeadingSmoothing,
+              -1 , -1,
+              _roll_outs, m_RollOutsCaches, sampledPoints_debug);
+  else
+    _planner.GenerateRunoffTrajectory(m_TotalPath, state,
+              m_params.enableLaneChange,
+              state.v,
+              m_params.microPlanDistance,
+              m_params.maxSpeed,
+              m_params.minSpeed,
+              m_params.carTipMargin,
+              m_params.rollInMargin,
+              m_params.rollInSpeedFactor,
+              m_params.pathDensity,
+              m_params.rollOutDensity,
+              m_params.rollOutNumber,
+              m_params.smoothingDataWeight,
+              m_params.smoothingSmoothWeight,
+              m_params.smoothingToleranceError,
+              m_params.speedProfileFactor,
+              m_params.enableHeadingSmoothing,
+              -1 , -1,
+              _roll_outs, sampledPoints_debug);
 
   if(_roll_outs.size()>0)
     m_RollOuts.clear();
@@ -219,29 +242,36 @@ void SimuDecisionMaker::FirstLocalizeMe(const WayPoint& initCarPos)
 {
    PlannerHNS::BehaviorState beh;
    state.v = vehicleState.speed;
-   m_TotalPath.clear();
-  for(unsigned int i = 0; i < m_TotalOriginalPath.size(); i++)
   {
-    t_centerTrajectorySmoothed.clear();
-    PlannerHNS::PlanningHelpers::ExtractPartFromPointToDistanceDirectionFast(m_TotalOriginalPath.at(i), state, m_params.horizonDistance ,  m_params.pathDensity , t_centerTrajectorySmoothed);
-    m_TotalPath.push_back(t_centerTrajectorySmoothed);
+    OP_STAGE_TIMER(&m_StageLatency, STAGE_TOTAL_PATH);
+    ExtractTotalPath();
   }
 
   if(m_TotalPath.size()==0) return beh;
 
   UpdateCurrentLane(m_MaxLaneSearchDistance);
 
-  PlannerHNS::TrajectoryCost tc = m_TrajectoryCostsCalculator.DoOneStepStatic(m_RollOuts, m_TotalPath.at(m_iCurrentTotalPathId), state,  m_params, m_CarInfo, vehicleState, objects);
+  PlannerHNS::TrajectoryCost tc;
+  {
+    OP_STAGE_TIMER(&m_StageLatency, STAGE_TRAJECTORY_COSTS);
+    tc = m_TrajectoryCostsCalculator.DoOneStepStatic(m_RollOuts, m_TotalPath.at(m_iCurrentTotalPathId), state,  m_params, m_CarInfo, vehicleState, objects);
+  }
 
   //std::cout << "Detected Objects Distance: " << tc.closest_obj_distance << ", N RollOuts: " << m_RollOuts.size() << std::endl;
 
-  CalculateImportantParameterForDecisionMaking(vehicleState, goalID, bEmergencyStop, trafficLight, tc);
+  {
+    OP_STAGE_TIMER(&m_StageLatency, STAGE_BEHAVIOR_STATE);
+    CalculateImportantParameterForDecisionMaking(vehicleState, goalID, bEmergencyStop, trafficLight, tc);
 
-  beh = GenerateBehaviorState(vehicleState);
+    beh = GenerateBehaviorState(vehicleState);
 
-  beh.bNewPlan = SelectSafeTrajectory();
+    beh.bNewPlan = SelectSafeTrajectory();
+  }
 
-  beh.maxVelocity = UpdateVelocityDirectlyToTrajectory(beh, vehicleState, dt);
+  {
+    OP_STAGE_TIMER(&m_StageLatency, STAGE_VELOCITY_PROFILE);
+    beh.maxVelocity = UpdateVelocityDirectlyToTrajectory(beh, vehicleState, dt);
+  }
 
   //std::cout << "Eval_i: " << tc.index << ", Curr_i: " <<  m_pCurrentBehaviorState->GetCalcParams()->iCurrSafeTrajectory << ", Prev_i: " << m_pCurrentBehaviorState->GetCalcParams()->iPrevSafeTrajectory << std::endl;
 
@@ -6,6 +6,8 @@
 #include "op_planner/TrajectoryCosts.h"
 #include "op_planner/MatrixOperations.h"
 #include "float.h"
+#include "op_planner/PolygonGeometry.h"
+#include <algorithm>
 
 namespace PlannerHNS
 {
@@ -19,6 +21,8 @@ TrajectoryCosts::TrajectoryCosts()
   m_WeightLat = 1.0;
   m_WeightLaneChange = 1.0;
   m_LateralSkipDistance = 10;
+  m_bUseContourCorridor = true;
+  m_nCulledContourPoints = 0;
 }
 
 TrajectoryCosts::~TrajectoryCosts()
@@ -70,7 +74,14 @@ TrajectoryCost TrajectoryCosts::DoOneStep(const vector<vector<vector<WayPoint> >
     }
   }
 
-  CalculateLateralAndLongitudinalCosts(m_TrajectoryCosts, rollOuts, totalPaths, currState, m_AllContourPoints, params, carInfo, vehicleState);
+  m_ContourCorridor.Clear();
+  for(unsigned int il = 0; il < rollOuts.size(); il++)
+  {
+    if(rollOuts.at(il).size() > 0 && rollOuts.at(il).at(0).size() > 0)
+      AddToContourCorridor(totalPaths.at(il), currState, params, carInfo);
+  }
+
+  CalculateLateralAndLongitudinalCosts(m_TrajectoryCosts, rollOuts, totalPaths, currState, FilterContourPoints(params), params, carInfo, vehicleState);
 
   NormalizeCosts(m_TrajectoryCosts);
 
@@ -135,8 +146,7 @@ void TrajectoryCosts::CalculateLateralAndLongitudinalCosts(vector<TrajectoryCost
   double critical_long_back_distance =  carInfo.length/2.0 + params.verticalSafetyDistance - carInfo.wheel_base/2.0;
   int iCostIndex = 0;
 
-  PlannerHNS::Mat3 invRotationMat(currState.pos.a-M_PI_2);
-  PlannerHNS::Mat3 invTranslationMat(currState.pos.x, currState.pos.y);
+  PlannerHNS::RigidTransform2D carToMap(currState.pos.a-M_PI_2, currState.pos.x, currState.pos.y);
 
   double corner_slide_distance = critical_lateral_distance/2.0;
   double ratio_to_angle = corner_slide_distance/carInfo.max_steer_angle;
@@ -151,24 +161,6 @@ void TrajectoryCosts::CalculateLateralAndLongitudinalCosts(vector<TrajectoryCost
   GPSPoint top_right(critical_lateral_distance - slide_distance, critical_long_front_distance,  currState.pos.z, 0);
   GPSPoint top_left(-critical_lateral_distance - slide_distance , critical_long_front_distance, currState.pos.z, 0);
 
-  bottom_left = invRotationMat*bottom_left;
-  bottom_left = invTranslationMat*bottom_left;
-
-  top_right = invRotationMat*top_right;
-  top_right = invTranslationMat*top_right;
-
-  bottom_right = invRotationMat*bottom_right;
-  bottom_right = invTranslationMat*bottom_right;
-
-  top_left = invRotationMat*top_left;
-  top_left = invTranslationMat*top_left;
-
-  top_right_car = invRotationMat*top_right_car;
-  top_right_car = invTranslationMat*top_right_car;
-
-  top_left_car = invRotationMat*top_left_car;
-  top_left_car = invTranslationMat*top_left_car;
-
   m_SafetyBorder.points.clear();
   m_SafetyBorder.points.push_back(bottom_left) ;
   m_SafetyBorder.points.push_back(bottom_right) ;
@@ -176,6 +168,9 @@ void TrajectoryCosts::CalculateLateralAndLongitudinalCosts(vector<TrajectoryCost
   m_SafetyBorder.points.push_back(top_right) ;
   m_SafetyBorder.points.push_back(top_left) ;
   m_SafetyBorder.points.push_back(top_left_car) ;
+  carToMap.Transform(m_SafetyBorder.points);
+
+  PolygonGeometry::PointsInsidePolygon(m_SafetyBorder.points, contourPoints, m_ContourInsideSafetyBorder);
 
   for(unsigned int il=0; il < rollOuts.size(); il++)
   {
@@ -225,7 +220,7 @@ void TrajectoryCosts::CalculateLateralAndLongitudinalCosts(vector<TrajectoryCost
 
           longitudinalDist = longitudinalDist - critical_long_front_distance;
 
-          if(m_SafetyBorder.PointInsidePolygon(m_SafetyBorder, contourPoints.at(icon).pos) == true)
+          if(m_ContourInsideSafetyBorder.at(icon) == 1)
             trajectoryCosts.at(iCostIndex).bBlocked = true;
 
           if(lateralDist <= critical_lateral_distance
@@ -254,6 +249,29 @@ void TrajectoryCosts::CalculateLateralAndLongitudinalCosts(vector<TrajectoryCost
   }
 }
 
+void TrajectoryCosts::AddToContourCorridor(const vector<WayPoint>& totalPath, const WayPoint& currState, const PlanningParams& params, const CAR_BASIC_INFO& carInfo)
+{
+  if(!m_bUseContourCorridor) return;
+
+  //a contour point changes the costs of a roll out only within m_LateralSkipDistance of it
+  double max_distance_from_center = 0;
+  for(unsigned int ic = 0; ic < m_TrajectoryCosts.size(); ic++)
+    max_distance_from_center = std::max(max_distance_from_center, fabs(m_TrajectoryCosts.at(ic).distance_from_center));
+
+  RelativeInfo car_info;
+  PlanningHelpers::GetRelativeInfo(totalPath, currState, car_info);
+  m_ContourCorridor.AddPath(totalPath, car_info, carInfo.length, params.minFollowingDistance, m_LateralSkipDistance + max_distance_from_center);
+}
+
+const vector<WayPoint>& TrajectoryCosts::FilterContourPoints(const PlanningParams& params)
+{
+  m_nCulledContourPoints = 0;
+  if(!m_bUseContourCorridor) return m_AllContourPoints;
+
+  m_nCulledContourPoints = m_ContourCorridor.Filter(m_AllContourPoints, params.minSpeed, m_CorridorContourPoints);
+  return m_CorridorContourPoints;
+}
+
 void TrajectoryCosts::NormalizeCosts(vector<TrajectoryCost>& trajectoryCosts)
 {
   //Normalize costs
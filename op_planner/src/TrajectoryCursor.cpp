@@ -0,0 +1,235 @@
+/// \file TrajectoryCursor.cpp
+/// \brief Warm started closest point search on a trajectory, caches the last match and the cumulative arc length
+/// \date Oct 14, 2026
+
+#include "op_planner/TrajectoryCursor.h"
+#include "op_planner/PlanningHelpers.h"
+#include "op_planner/PolylineDistance.h"
+#include "op_utility/FastAngle.h"
+#include <float.h>
+
+using namespace UtilityHNS;
+
+namespace PlannerHNS
+{
+
+TrajectoryCursor::TrajectoryCursor(const int& searchWindow)
+{
+  m_SearchWindow = searchWindow;
+  m_nWindowHits = 0;
+  m_nFullScans = 0;
+  Reset();
+}
+
+TrajectoryCursor::~TrajectoryCursor()
+{
+}
+
+void TrajectoryCursor::Reset()
+{
+  m_LastIndex = -1;
+  m_pData = nullptr;
+  m_Size = 0;
+  m_CumulativeDistance.clear();
+  m_X.clear();
+  m_Y.clear();
+}
+
+bool TrajectoryCursor::Sync(const std::vector<WayPoint>& trajectory)
+{
+  unsigned int size = trajectory.size();
+  if(size > 0 && m_pData == trajectory.data() && m_Size == size
+      && m_First.x == trajectory.at(0).pos.x && m_First.y == trajectory.at(0).pos.y
+      && m_Middle.x == trajectory.at(size/2).pos.x && m_Middle.y == trajectory.at(size/2).pos.y
+      && m_Last.x == trajectory.at(size-1).pos.x && m_Last.y == trajectory.at(size-1).pos.y)
+    return false;
+
+  Reset();
+  m_pData = trajectory.data();
+  m_Size = size;
+  if(size == 0) return true;
+
+  m_First = trajectory.at(0).pos;
+  m_Middle = trajectory.at(size/2).pos;
+  m_Last = trajectory.at(size-1).pos;
+
+  m_CumulativeDistance.resize(size);
+  m_X.resize(size);
+  m_Y.resize(size);
+  m_CumulativeDistance.at(0) = 0;
+  m_X.at(0) = trajectory.at(0).pos.x;
+  m_Y.at(0) = trajectory.at(0).pos.y;
+  for(unsigned int i = 1; i < size; i++)
+  {
+    m_CumulativeDistance.at(i) = m_CumulativeDistance.at(i-1) + hypot(trajectory.at(i).pos.y - trajectory.at(i-1).pos.y, trajectory.at(i).pos.x - trajectory.at(i-1).pos.x);
+    m_X.at(i) = trajectory.at(i).pos.x;
+    m_Y.at(i) = trajectory.at(i).pos.y;
+  }
+
+  return true;
+}
+
+int TrajectoryCursor::FullScan(const std::vector<WayPoint>& trajectory, const WayPoint& p, const bool& bDirection, double& minD)
+{
+  m_nFullScans++;
+  if(!bDirection)
+    return PolylineDistance::GetClosestVertex(m_X.data(), m_Y.data(), m_Size, p.pos.x, p.pos.y, minD);
+
+  int min_index = -1;
+  minD = DBL_MAX;
+  for(unsigned int i = 0; i < trajectory.size(); i++)
+  {
+    if(PlannerAngle::AngleBetweenTwoAnglesPositive(trajectory[i].pos.a, p.pos.a)*RAD2DEG >= 45)
+      continue;
+
+    double d = distance2pointsSqr(trajectory[i].pos, p.pos);
+    if(d < minD)
+    {
+      min_index = i;
+      minD = d;
+    }
+  }
+
+  return min_index;
+}
+
+int TrajectoryCursor::CorrectToNextPoint(const std::vector<WayPoint>& trajectory, const WayPoint& p, const int& min_index, const int& max_index)
+{
+  if(min_index >= max_index) return min_index;
+
+  GPSPoint curr, next;
+  curr = trajectory[min_index].pos;
+  next = trajectory[min_index+1].pos;
+  GPSPoint v_1(p.pos.x - curr.x   ,p.pos.y - curr.y,0,0);
+  double norm1 = pointNorm(v_1);
+  GPSPoint v_2(next.x - curr.x,next.y - curr.y,0,0);
+  double norm2 = pointNorm(v_2);
+  double dot_pro = v_1.x*v_2.x + v_1.y*v_2.y;
+  double a = UtilityH::FixNegativeAngle(acos(dot_pro/(norm1*norm2)));
+  if(a <= M_PI_2)
+    return min_index + 1;
+
+  return min_index;
+}
+
+int TrajectoryCursor::GetClosestNextPointIndex(const std::vector<WayPoint>& trajectory, const WayPoint& p)
+{
+  int size = (int)trajectory.size();
+  if(size < 2) return 0;
+
+  Sync(trajectory);
+
+  int min_index = -1;
+  double minD = DBL_MAX;
+  if(m_LastIndex >= 0 && m_LastIndex < size)
+  {
+    int iStart = std::max(0, m_LastIndex - m_SearchWindow);
+    int iEnd = std::min(size - 1, m_LastIndex + m_SearchWindow);
+    min_index = PolylineDistance::GetClosestVertex(m_X.data() + iStart, m_Y.data() + iStart, iEnd - iStart + 1, p.pos.x, p.pos.y, minD);
+    //no vertex when the distances are not numbers, the window start sends it to the full scan
+    min_index = iStart + std::max(0, min_index);
+
+    //the minimum is on the window border, the real one could be outside
+    if((min_index == iStart && iStart > 0) || (min_index == iEnd && iEnd < size - 1))
+      min_index = -1;
+    else
+      m_nWindowHits++;
+  }
+
+  if(min_index < 0)
+    min_index = FullScan(trajectory, p, false, minD);
+
+  m_LastIndex = min_index;
+
+  return CorrectToNextPoint(trajectory, p, min_index, size - 1);
+}
+
+int TrajectoryCursor::GetClosestNextPointIndexDirection(const std::vector<WayPoint>& trajectory, const WayPoint& p)
+{
+  int size = (int)trajectory.size();
+  if(size < 2) return 0;
+
+  Sync(trajectory);
+
+  int min_index = -1;
+  double minD = DBL_MAX;
+  if(m_LastIndex >= 0 && m_LastIndex < size)
+  {
+    int iStart = std::max(0, m_LastIndex - m_SearchWindow);
+    int iEnd = std::min(size - 1, m_LastIndex + m_SearchWindow);
+    for(int i = iStart; i <= iEnd; i++)
+    {
+      double d = distance2pointsSqr(trajectory[i].pos, p.pos);
+      double angle_diff = PlannerAngle::AngleBetweenTwoAnglesPositive(trajectory[i].pos.a, p.pos.a)*RAD2DEG;
+      if(d < minD && angle_diff < 45)
+      {
+        min_index = i;
+        minD = d;
+      }
+    }
+
+    if((min_index == iStart && iStart > 0) || (min_index == iEnd && iEnd < size - 1))
+      min_index = -1;
+    else if(min_index >= 0)
+      m_nWindowHits++;
+  }
+
+  if(min_index < 0)
+    min_index = FullScan(trajectory, p, true, minD);
+
+  if(min_index < 0)
+  {
+    m_LastIndex = -1;
+    min_index = 0;
+  }
+  else
+  {
+    m_LastIndex = min_index;
+  }
+
+  return CorrectToNextPoint(trajectory, p, min_index, size - 2);
+}
+
+bool TrajectoryCursor::GetRelativeInfo(const std::vector<WayPoint>& trajectory, const WayPoint& p, RelativeInfo& info)
+{
+  if(trajectory.size() < 2) return false;
+
+  int iFront = 1;
+  if(trajectory.size() > 2)
+    iFront = GetClosestNextPointIndex(trajectory, p);
+
+  PlanningHelpers::GetRelativeInfoFromIndex(trajectory, p, iFront, info);
+  return true;
+}
+
+double TrajectoryCursor::GetDistanceBetweenIndices(const std::vector<WayPoint>& trajectory, const int& from_index, const int& to_index)
+{
+  Sync(trajectory);
+  if(from_index < 0 || to_index < 0 || from_index >= (int)m_Size || to_index >= (int)m_Size) return 0;
+
+  return m_CumulativeDistance.at(to_index) - m_CumulativeDistance.at(from_index);
+}
+
+double TrajectoryCursor::GetExactDistanceOnTrajectory(const std::vector<WayPoint>& trajectory, const RelativeInfo& p1, const RelativeInfo& p2)
+{
+  if(trajectory.size() == 0) return 0;
+
+  if(p2.iFront == p1.iFront && p2.iBack == p1.iBack)
+  {
+    return p2.to_front_distance - p1.to_front_distance;
+  }
+  else if(p2.iBack >= p1.iFront)
+  {
+    return p1.to_front_distance + p2.from_back_distance + GetDistanceBetweenIndices(trajectory, p1.iFront, p2.iBack);
+  }
+  else if(p2.iFront <= p1.iBack)
+  {
+    return -(p1.from_back_distance + p2.to_front_distance + GetDistanceBetweenIndices(trajectory, p2.iFront, p1.iBack));
+  }
+  else
+  {
+    return 0;
+  }
+}
+
+} /* namespace PlannerHNS */
@@ -7,6 +7,8 @@
 #include "op_planner/TrajectoryDynamicCosts.h"
 #include "op_planner/MatrixOperations.h"
 #include "float.h"
+#include "op_planner/PolygonGeometry.h"
+#include <algorithm>
 
 namespace PlannerHNS
 {
@@ -27,16 +29,57 @@ TrajectoryDynamicCosts::TrajectoryDynamicCosts()
   m_PrevIndex = -1;
   m_WeightPriority = 0.9;
   m_WeightTransition = 0.9;
+  m_bNearestObjectsFirst = false;
+  m_nSkippedObjectChecks = 0;
+  m_bUseContourCorridor = true;
+  m_bUseOccupancyGrid = true;
+  m_nCulledContourPoints = 0;
+  m_nThreads = 1;
 }
 
 TrajectoryDynamicCosts::~TrajectoryDynamicCosts()
 {
 }
 
+void TrajectoryDynamicCosts::SetNumberOfThreads(const int& nThreads)
+{
+  m_nThreads = std::max(1, nThreads);
+}
+
+void TrajectoryDynamicCosts::SetNearestObjectsFirst(const bool& bNearestFirst)
+{
+  m_bNearestObjectsFirst = bNearestFirst;
+}
+
+void TrajectoryDynamicCosts::RunRollOutTasks(const int& nTasks, const std::function<void(const int&)>& task)
+{
+  if(m_nThreads > 1)
+  {
+    UtilityHNS::TaskScheduler::GetShared().ParallelFor(nTasks, task, m_nThreads);
+  }
+  else
+  {
+    for(int i = 0; i < nTasks; i++)
+      task(i);
+  }
+}
+
 TrajectoryCost TrajectoryDynamicCosts::DoOneStepDynamic(const vector<vector<WayPoint> >& rollOuts,
     const vector<WayPoint>& totalPaths, const WayPoint& currState,
     const PlanningParams& params, const CAR_BASIC_INFO& carInfo, const VehicleState& vehicleState,
     const std::vector<PlannerHNS::DetectedObject>& obj_list, const int& iCurrentIndex)
+{
+  m_RollOutsSoA.resize(rollOuts.size());
+  for(unsigned int i = 0; i < rollOuts.size(); i++)
+    m_RollOutsSoA.at(i).Assign(rollOuts.at(i));
+
+  return DoOneStepDynamic(rollOuts, m_RollOutsSoA, totalPaths, currState, params, carInfo, vehicleState, obj_list, iCurrentIndex);
+}
+
+TrajectoryCost TrajectoryDynamicCosts::DoOneStepDynamic(const vector<vector<WayPoint> >& rollOuts, const vector<PathSoA>& rollOutsSoA,
+    const vector<WayPoint>& totalPaths, const WayPoint& currState,
+    const PlanningParams& params, const CAR_BASIC_INFO& carInfo, const VehicleState& vehicleState,
+    const std::vector<PlannerHNS::DetectedObject>& obj_list, const int& iCurrentIndex)
 {
   TrajectoryCost bestTrajectory;
   bestTrajectory.bBlocked = true;
@@ -60,7 +103,7 @@ TrajectoryCost TrajectoryDynamicCosts::DoOneStepDynamic(const vector<vector<WayP
 
   CalculateTransitionCosts(m_TrajectoryCosts, currIndex, params);
 
-  CalculateLateralAndLongitudinalCostsDynamic(obj_list, rollOuts, totalPaths,  currState, params, carInfo, vehicleState, critical_lateral_distance, critical_long_front_distance, critical_long_back_distance);
+  CalculateLateralAndLongitudinalCostsDynamic(obj_list, rollOuts, rollOutsSoA, totalPaths,  currState, params, carInfo, vehicleState, critical_lateral_distance, critical_long_front_distance, critical_long_back_distance);
 
   NormalizeCosts(m_TrajectoryCosts);
 
@@ -169,7 +212,11 @@ TrajectoryCost TrajectoryDynamicCosts::DoOneStepStatic(const vector<vector<WayPo
     }
   }
 
-  CalculateLateralAndLongitudinalCostsStatic(m_TrajectoryCosts, rollOuts, totalPaths, currState, m_AllContourPoints, params, carInfo, vehicleState);
+  m_ContourCorridor.Clear();
+  if(rollOuts.size() > 0 && rollOuts.at(0).size() > 0)
+    AddToContourCorridor(totalPaths, currState, params, carInfo);
+
+  CalculateLateralAndLongitudinalCostsStatic(m_TrajectoryCosts, rollOuts, totalPaths, currState, FilterContourPoints(params), params, carInfo, vehicleState);
 
   NormalizeCosts(m_TrajectoryCosts);
 
@@ -258,7 +305,14 @@ TrajectoryCost TrajectoryDynamicCosts::DoOneStep(const vector<vector<vector<WayP
     }
   }
 
-  CalculateLateralAndLongitudinalCosts(m_TrajectoryCosts, rollOuts, totalPaths, currState, m_AllContourPoints, params, carInfo, vehicleState);
+  m_ContourCorridor.Clear();
+  for(unsigned int il = 0; il < rollOuts.size(); il++)
+  {
+    if(rollOuts.at(il).size() > 0 && rollOuts.at(il).at(0).size() > 0)
+      AddToContourCorridor(totalPaths.at(il), currState, params, carInfo);
+  }
+
+  CalculateLateralAndLongitudinalCosts(m_TrajectoryCosts, rollOuts, totalPaths, currState, FilterContourPoints(params), params, carInfo, vehicleState);
 
   NormalizeCosts(m_TrajectoryCosts);
 
@@ -322,8 +376,7 @@ void TrajectoryDynamicCosts::CalculateLateralAndLongitudinalCostsStatic(vector<T
   double critical_long_front_distance =  carInfo.wheel_base/2.0 + carInfo.length/2.0 + params.verticalSafetyDistance;
   double critical_long_back_distance =  carInfo.length/2.0 + params.verticalSafetyDistance - carInfo.wheel_base/2.0;
 
-  PlannerHNS::Mat3 invRotationMat(currState.pos.a-M_PI_2);
-  PlannerHNS::Mat3 invTranslationMat(currState.pos.x, currState.pos.y);
+  PlannerHNS::RigidTransform2D carToMap(currState.pos.a-M_PI_2, currState.pos.x, currState.pos.y);
 
   double corner_slide_distance = critical_lateral_distance/2.0;
   double ratio_to_angle = corner_slide_distance/carInfo.max_steer_angle;
@@ -338,24 +391,6 @@ void TrajectoryDynamicCosts::CalculateLateralAndLongitudinalCostsStatic(vector<T
   GPSPoint top_right(critical_lateral_distance - slide_distance, critical_long_front_distance,  currState.pos.z, 0);
   GPSPoint top_left(-critical_lateral_distance - slide_distance , critical_long_front_distance, currState.pos.z, 0);
 
-  bottom_left = invRotationMat*bottom_left;
-  bottom_left = invTranslationMat*bottom_left;
-
-  top_right = invRotationMat*top_right;
-  top_right = invTranslationMat*top_right;
-
-  bottom_right = invRotationMat*bottom_right;
-  bottom_right = invTranslationMat*bottom_right;
-
-  top_left = invRotationMat*top_left;
-  top_left = invTranslationMat*top_left;
-
-  top_right_car = invRotationMat*top_right_car;
-  top_right_car = invTranslationMat*top_right_car;
-
-  top_left_car = invRotationMat*top_left_car;
-  top_left_car = invTranslationMat*top_left_car;
-
   m_SafetyBorder.points.clear();
   m_SafetyBorder.points.push_back(bottom_left) ;
   m_SafetyBorder.points.push_back(bottom_right) ;
@@ -363,79 +398,26 @@ void TrajectoryDynamicCosts::CalculateLateralAndLongitudinalCostsStatic(vector<T
   m_SafetyBorder.points.push_back(top_right) ;
   m_SafetyBorder.points.push_back(top_left) ;
   m_SafetyBorder.points.push_back(top_left_car) ;
+  carToMap.Transform(m_SafetyBorder.points);
 
-  int iCostIndex = 0;
   if(rollOuts.size() > 0 && rollOuts.at(0).size()>0)
   {
+    TrajectoryCursor path_cursor;
     RelativeInfo car_info;
-    PlanningHelpers::GetRelativeInfo(totalPaths, currState, car_info);
+    path_cursor.GetRelativeInfo(totalPaths, currState, car_info);
 
+    //the contour points relative info does not depend on the roll out, calculate it once
+    vector<RelativeInfo> contour_info;
+    vector<double> contour_long_dist;
+    CalculateContourRelativeInfo(path_cursor, totalPaths, car_info, contourPoints, contour_info, contour_long_dist);
+    PolygonGeometry::PointsInsidePolygon(m_SafetyBorder.points, contourPoints, m_ContourInsideSafetyBorder);
 
-    for(unsigned int it=0; it< rollOuts.size(); it++)
+    //each roll out only writes its own cost, the contour info is shared read only
+    RunRollOutTasks(rollOuts.size(), [&](const int& it)
     {
-      int skip_id = -1;
-      for(unsigned int icon = 0; icon < contourPoints.size(); icon++)
-      {
-        if(skip_id == contourPoints.at(icon).id)
-          continue;
-
-        RelativeInfo obj_info;
-        PlanningHelpers::GetRelativeInfo(totalPaths, contourPoints.at(icon), obj_info);
-        double longitudinalDist = PlanningHelpers::GetExactDistanceOnTrajectory(totalPaths, car_info, obj_info);
-        if(obj_info.iFront == 0 && longitudinalDist > 0)
-          longitudinalDist = -longitudinalDist;
-
-        double direct_distance = hypot(obj_info.perp_point.pos.y-contourPoints.at(icon).pos.y, obj_info.perp_point.pos.x-contourPoints.at(icon).pos.x);
-        if(contourPoints.at(icon).v < params.minSpeed && direct_distance > (m_LateralSkipDistance+contourPoints.at(icon).cost))
-        {
-          skip_id = contourPoints.at(icon).id;
-          continue;
-        }
-
-        double close_in_percentage = 1;
-//          close_in_percentage = ((longitudinalDist- critical_long_front_distance)/params.rollInMargin)*4.0;
-//
-//          if(close_in_percentage <= 0 || close_in_percentage > 1) close_in_percentage = 1;
-
-        double distance_from_center = trajectoryCosts.at(iCostIndex).distance_from_center;
-
-        if(close_in_percentage < 1)
-          distance_from_center = distance_from_center - distance_from_center * (1.0-close_in_percentage);
-
-        double lateralDist = fabs(obj_info.perp_distance - distance_from_center);
-
-        if(longitudinalDist < -carInfo.length || longitudinalDist > params.minFollowingDistance || lateralDist > m_LateralSkipDistance)
-        {
-          continue;
-        }
-
-        longitudinalDist = longitudinalDist - critical_long_front_distance;
-
-        if(m_SafetyBorder.PointInsidePolygon(m_SafetyBorder, contourPoints.at(icon).pos) == true)
-          trajectoryCosts.at(iCostIndex).bBlocked = true;
-
-        if(lateralDist <= critical_lateral_distance
-            && longitudinalDist >= -carInfo.length/1.5
-            && longitudinalDist < params.minFollowingDistance)
-          trajectoryCosts.at(iCostIndex).bBlocked = true;
-
-
-        if(lateralDist != 0)
-          trajectoryCosts.at(iCostIndex).lateral_cost += 1.0/lateralDist;
-
-        if(longitudinalDist != 0)
-          trajectoryCosts.at(iCostIndex).longitudinal_cost += 1.0/fabs(longitudinalDist);
-
-
-        if(longitudinalDist >= -critical_long_front_distance && longitudinalDist < trajectoryCosts.at(iCostIndex).closest_obj_distance)
-        {
-          trajectoryCosts.at(iCostIndex).closest_obj_distance = longitudinalDist;
-          trajectoryCosts.at(iCostIndex).closest_obj_velocity = contourPoints.at(icon).v;
-        }
-      }
-
-      iCostIndex++;
-    }
+      CalculateRollOutContourCosts(trajectoryCosts.at(it), contourPoints, contour_info, contour_long_dist, m_ContourInsideSafetyBorder, params, carInfo,
+          critical_lateral_distance, critical_long_front_distance);
+    });
   }
 }
 
@@ -447,10 +429,8 @@ void TrajectoryDynamicCosts::CalculateLateralAndLongitudinalCosts(vector<Traject
   double critical_lateral_distance =  carInfo.width/2.0 + params.horizontalSafetyDistancel;
   double critical_long_front_distance =  carInfo.wheel_base/2.0 + carInfo.length/2.0 + params.verticalSafetyDistance;
   double critical_long_back_distance =  carInfo.length/2.0 + params.verticalSafetyDistance - carInfo.wheel_base/2.0;
-  int iCostIndex = 0;
 
-  PlannerHNS::Mat3 invRotationMat(currState.pos.a-M_PI_2);
-  PlannerHNS::Mat3 invTranslationMat(currState.pos.x, currState.pos.y);
+  PlannerHNS::RigidTransform2D carToMap(currState.pos.a-M_PI_2, currState.pos.x, currState.pos.y);
 
   double corner_slide_distance = critical_lateral_distance/2.0;
   double ratio_to_angle = corner_slide_distance/carInfo.max_steer_angle;
@@ -465,24 +445,6 @@ void TrajectoryDynamicCosts::CalculateLateralAndLongitudinalCosts(vector<Traject
   GPSPoint top_right(critical_lateral_distance - slide_distance, critical_long_front_distance,  currState.pos.z, 0);
   GPSPoint top_left(-critical_lateral_distance - slide_distance , critical_long_front_distance, currState.pos.z, 0);
 
-  bottom_left = invRotationMat*bottom_left;
-  bottom_left = invTranslationMat*bottom_left;
-
-  top_right = invRotationMat*top_right;
-  top_right = invTranslationMat*top_right;
-
-  bottom_right = invRotationMat*bottom_right;
-  bottom_right = invTranslationMat*bottom_right;
-
-  top_left = invRotationMat*top_left;
-  top_left = invTranslationMat*top_left;
-
-  top_right_car = invRotationMat*top_right_car;
-  top_right_car = invTranslationMat*top_right_car;
-
-  top_left_car = invRotationMat*top_left_car;
-  top_left_car = invTranslationMat*top_left_car;
-
   m_SafetyBorder.points.clear();
   m_SafetyBorder.points.push_back(bottom_left) ;
   m_SafetyBorder.points.push_back(bottom_right) ;
@@ -490,84 +452,129 @@ void TrajectoryDynamicCosts::CalculateLateralAndLongitudinalCosts(vector<Traject
   m_SafetyBorder.points.push_back(top_right) ;
   m_SafetyBorder.points.push_back(top_left) ;
   m_SafetyBorder.points.push_back(top_left_car) ;
+  carToMap.Transform(m_SafetyBorder.points);
 
+  //the costs are stored lane after lane, task i is the roll out of cost i
+  vector<int> valid_lanes;
+  vector<int> task_lane;
   for(unsigned int il=0; il < rollOuts.size(); il++)
   {
     if(rollOuts.at(il).size() > 0 && rollOuts.at(il).at(0).size()>0)
     {
-      RelativeInfo car_info;
-      PlanningHelpers::GetRelativeInfo(totalPaths.at(il), currState, car_info);
+      valid_lanes.push_back(il);
+      for(unsigned int it=0; it< rollOuts.at(il).size(); it++)
+        task_lane.push_back(il);
+    }
+  }
 
+  PolygonGeometry::PointsInsidePolygon(m_SafetyBorder.points, contourPoints, m_ContourInsideSafetyBorder);
 
-      for(unsigned int it=0; it< rollOuts.at(il).size(); it++)
-      {
-        int skip_id = -1;
-        for(unsigned int icon = 0; icon < contourPoints.size(); icon++)
-        {
-          if(skip_id == contourPoints.at(icon).id)
-            continue;
+  vector<vector<RelativeInfo> > lanes_contour_info(rollOuts.size());
+  vector<vector<double> > lanes_contour_long_dist(rollOuts.size());
+  RunRollOutTasks(valid_lanes.size(), [&](const int& i)
+  {
+    int il = valid_lanes.at(i);
+    TrajectoryCursor path_cursor;
+    RelativeInfo car_info;
+    path_cursor.GetRelativeInfo(totalPaths.at(il), currState, car_info);
+    CalculateContourRelativeInfo(path_cursor, totalPaths.at(il), car_info, contourPoints, lanes_contour_info.at(il), lanes_contour_long_dist.at(il));
+  });
 
-          RelativeInfo obj_info;
-          PlanningHelpers::GetRelativeInfo(totalPaths.at(il), contourPoints.at(icon), obj_info);
-          double longitudinalDist = PlanningHelpers::GetExactDistanceOnTrajectory(totalPaths.at(il), car_info, obj_info);
-          if(obj_info.iFront == 0 && longitudinalDist > 0)
-            longitudinalDist = -longitudinalDist;
+  RunRollOutTasks(task_lane.size(), [&](const int& i)
+  {
+    int il = task_lane.at(i);
+    CalculateRollOutContourCosts(trajectoryCosts.at(i), contourPoints, lanes_contour_info.at(il), lanes_contour_long_dist.at(il), m_ContourInsideSafetyBorder,
+        params, carInfo, critical_lateral_distance, critical_long_front_distance);
+  });
+}
 
-          double direct_distance = hypot(obj_info.perp_point.pos.y-contourPoints.at(icon).pos.y, obj_info.perp_point.pos.x-contourPoints.at(icon).pos.x);
-          if(contourPoints.at(icon).v < params.minSpeed && direct_distance > (m_LateralSkipDistance+contourPoints.at(icon).cost))
-          {
-            skip_id = contourPoints.at(icon).id;
-            continue;
-          }
+void TrajectoryDynamicCosts::CalculateRollOutContourCosts(TrajectoryCost& trajectoryCost, const vector<WayPoint>& contourPoints,
+    const vector<RelativeInfo>& contour_info, const vector<double>& contour_long_dist, const vector<int>& contour_inside, const PlanningParams& params,
+    const CAR_BASIC_INFO& carInfo, const double& critical_lateral_distance, const double& critical_long_front_distance)
+{
+  int skip_id = -1;
+  for(unsigned int icon = 0; icon < contourPoints.size(); icon++)
+  {
+    if(skip_id == contourPoints.at(icon).id)
+      continue;
 
-          double close_in_percentage = 1;
-//          close_in_percentage = ((longitudinalDist- critical_long_front_distance)/params.rollInMargin)*4.0;
-//
-//          if(close_in_percentage <= 0 || close_in_percentage > 1) close_in_percentage = 1;
+    const RelativeInfo& obj_info = contour_info.at(icon);
+    double longitudinalDist = contour_long_dist.at(icon);
 
-          double distance_from_center = trajectoryCosts.at(iCostIndex).distance_from_center;
+    double direct_distance = hypot(obj_info.perp_point.pos.y-contourPoints.at(icon).pos.y, obj_info.perp_point.pos.x-contourPoints.at(icon).pos.x);
+    if(contourPoints.at(icon).v < params.minSpeed && direct_distance > (m_LateralSkipDistance+contourPoints.at(icon).cost))
+    {
+      skip_id = contourPoints.at(icon).id;
+      continue;
+    }
 
-          if(close_in_percentage < 1)
-            distance_from_center = distance_from_center - distance_from_center * (1.0-close_in_percentage);
+    double close_in_percentage = 1;
+//      close_in_percentage = ((longitudinalDist- critical_long_front_distance)/params.rollInMargin)*4.0;
+//
+//      if(close_in_percentage <= 0 || close_in_percentage > 1) close_in_percentage = 1;
 
-          double lateralDist = fabs(obj_info.perp_distance - distance_from_center);
+    double distance_from_center = trajectoryCost.distance_from_center;
 
-          if(longitudinalDist < -carInfo.length || longitudinalDist > params.minFollowingDistance || lateralDist > m_LateralSkipDistance)
-          {
-            continue;
-          }
+    if(close_in_percentage < 1)
+      distance_from_center = distance_from_center - distance_from_center * (1.0-close_in_percentage);
 
-          longitudinalDist = longitudinalDist - critical_long_front_distance;
+    double lateralDist = fabs(obj_info.perp_distance - distance_from_center);
 
-          if(m_SafetyBorder.PointInsidePolygon(m_SafetyBorder, contourPoints.at(icon).pos) == true)
-            trajectoryCosts.at(iCostIndex).bBlocked = true;
+    if(longitudinalDist < -carInfo.length || longitudinalDist > params.minFollowingDistance || lateralDist > m_LateralSkipDistance)
+    {
+      continue;
+    }
 
-          if(lateralDist <= critical_lateral_distance
-              && longitudinalDist >= -carInfo.length/1.5
-              && longitudinalDist < params.minFollowingDistance)
-            trajectoryCosts.at(iCostIndex).bBlocked = true;
+    longitudinalDist = longitudinalDist - critical_long_front_distance;
 
+    if(contour_inside.at(icon) == 1)
+      trajectoryCost.bBlocked = true;
 
-          if(lateralDist != 0)
-            trajectoryCosts.at(iCostIndex).lateral_cost += 1.0/lateralDist;
+    if(lateralDist <= critical_lateral_distance
+        && longitudinalDist >= -carInfo.length/1.5
+        && longitudinalDist < params.minFollowingDistance)
+      trajectoryCost.bBlocked = true;
 
-          if(longitudinalDist != 0)
-            trajectoryCosts.at(iCostIndex).longitudinal_cost += 1.0/fabs(longitudinalDist);
 
+    if(lateralDist != 0)
+      trajectoryCost.lateral_cost += 1.0/lateralDist;
 
-          if(longitudinalDist >= -critical_long_front_distance && longitudinalDist < trajectoryCosts.at(iCostIndex).closest_obj_distance)
-          {
-            trajectoryCosts.at(iCostIndex).closest_obj_distance = longitudinalDist;
-            trajectoryCosts.at(iCostIndex).closest_obj_velocity = contourPoints.at(icon).v;
-          }
-        }
+    if(longitudinalDist != 0)
+      trajectoryCost.longitudinal_cost += 1.0/fabs(longitudinalDist);
 
-        iCostIndex++;
-      }
+
+    if(longitudinalDist >= -critical_long_front_distance && longitudinalDist < trajectoryCost.closest_obj_distance)
+    {
+      trajectoryCost.closest_obj_distance = longitudinalDist;
+      trajectoryCost.closest_obj_velocity = contourPoints.at(icon).v;
     }
   }
 }
 
+void TrajectoryDynamicCosts::AddToContourCorridor(const vector<WayPoint>& totalPath, const WayPoint& currState, const PlanningParams& params, const CAR_BASIC_INFO& carInfo)
+{
+  if(!m_bUseContourCorridor) return;
+
+  //a contour point changes the costs of a roll out only within m_LateralSkipDistance of it
+  double max_distance_from_center = 0;
+  for(unsigned int ic = 0; ic < m_TrajectoryCosts.size(); ic++)
+    max_distance_from_center = std::max(max_distance_from_center, fabs(m_TrajectoryCosts.at(ic).distance_from_center));
+
+  RelativeInfo car_info;
+  TrajectoryCursor path_cursor;
+  path_cursor.GetRelativeInfo(totalPath, currState, car_info);
+  m_ContourCorridor.AddPath(totalPath, car_info, carInfo.length, params.minFollowingDistance, m_LateralSkipDistance + max_distance_from_center);
+}
+
+const vector<WayPoint>& TrajectoryDynamicCosts::FilterContourPoints(const PlanningParams& params)
+{
+  m_nCulledContourPoints = 0;
+  if(!m_bUseContourCorridor) return m_AllContourPoints;
+
+  m_nCulledContourPoints = m_ContourCorridor.Filter(m_AllContourPoints, params.minSpeed, m_CorridorContourPoints);
+  return m_CorridorContourPoints;
+}
+
 void TrajectoryDynamicCosts::NormalizeCosts(vector<TrajectoryCost>& trajectoryCosts)
 {
   //Normalize costs
@@ -727,6 +734,94 @@ void TrajectoryDynamicCosts::CalculateIntersectionVelocities(const std::vector<P
   }
 }
 
+void TrajectoryDynamicCosts::CalculateIntersectionVelocities(const std::vector<PlannerHNS::WayPoint>& path, const PathSoA& path_soa, const PlannerHNS::DetectedObject& obj, const WayPoint& currPose, const CAR_BASIC_INFO& carInfo, const double& c_lateral_d, WayPoint& collisionPoint, TrajectoryCost& trajectoryCosts)
+{
+  trajectoryCosts.bBlocked = false;
+  int closest_path_i = path_soa.size();
+  double closest_collision_distance = 0;
+  double closest_collision_t = 0;
+  double c_lateral_d_sqr = c_lateral_d*c_lateral_d;
+  const double* px = path_soa.x.data();
+  const double* py = path_soa.y.data();
+  for(unsigned int k = 0; k < obj.predTrajectories.size(); k++)
+  {
+    for(unsigned int j = 0; j < obj.predTrajectories.at(k).size(); j++)
+    {
+      const WayPoint& obj_p = obj.predTrajectories.at(k).at(j);
+      //only points before the closest collision so far can replace it
+      for(int i = 0; i < closest_path_i; i++)
+      {
+        double dx = px[i] - obj_p.pos.x;
+        double dy = py[i] - obj_p.pos.y;
+        if(dx*dx + dy*dy > c_lateral_d_sqr*1.000001)
+          continue;
+
+        double collision_distance = hypot(dx, dy);
+        if(collision_distance <= c_lateral_d)
+        {
+          closest_path_i = i;
+          closest_collision_distance = collision_distance;
+          closest_collision_t = fabs(path_soa.t[i] - obj_p.timeCost);
+          double a = UtilityHNS::UtilityH::AngleBetweenTwoAnglesPositive(path_soa.yaw[i], obj_p.pos.a)/M_PI;
+          if(a < 0.25 && (currPose.v - obj.center.v) > 0)
+            trajectoryCosts.closest_obj_velocity = (currPose.v - obj.center.v);
+          else
+            trajectoryCosts.closest_obj_velocity = currPose.v;
+
+          trajectoryCosts.bBlocked = true;
+          break;
+        }
+      }
+    }
+  }
+
+  if(trajectoryCosts.bBlocked)
+  {
+    collisionPoint = path.at(closest_path_i);
+    collisionPoint.collisionCost = closest_collision_t;
+    collisionPoint.cost = closest_collision_distance;
+  }
+}
+
+void TrajectoryDynamicCosts::CalculateIntersectionVelocities(const std::vector<PlannerHNS::WayPoint>& path, const ObjectOccupancyGrid& grid, const PlannerHNS::DetectedObject& obj, const WayPoint& currPose, const double& c_lateral_d, WayPoint& collisionPoint, TrajectoryCost& trajectoryCosts)
+{
+  trajectoryCosts.bBlocked = false;
+  int iPredicted = -1;
+  double collision_distance = 0;
+  int i = grid.FindFirstCollision(path, c_lateral_d, iPredicted, collision_distance);
+  if(i < 0) return;
+
+  double a = UtilityHNS::UtilityH::AngleBetweenTwoAnglesPositive(path.at(i).pos.a, grid.GetHeading(iPredicted))/M_PI;
+  if(a < 0.25 && (currPose.v - obj.center.v) > 0)
+    trajectoryCosts.closest_obj_velocity = (currPose.v - obj.center.v);
+  else
+    trajectoryCosts.closest_obj_velocity = currPose.v;
+
+  trajectoryCosts.bBlocked = true;
+  collisionPoint = path.at(i);
+  collisionPoint.collisionCost = fabs(path.at(i).timeCost - grid.GetTime(iPredicted));
+  collisionPoint.cost = collision_distance;
+}
+
+void TrajectoryDynamicCosts::CalculateContourRelativeInfo(TrajectoryCursor& path_cursor, const vector<WayPoint>& totalPaths,
+    const RelativeInfo& car_info, const vector<WayPoint>& contourPoints, vector<RelativeInfo>& contour_info, vector<double>& contour_long_dist)
+{
+  contour_info.resize(contourPoints.size());
+  contour_long_dist.resize(contourPoints.size());
+
+  //a separate cursor, contour points are close to each other but far from the car
+  TrajectoryCursor obj_cursor;
+  for(unsigned int icon = 0; icon < contourPoints.size(); icon++)
+  {
+    obj_cursor.GetRelativeInfo(totalPaths, contourPoints.at(icon), contour_info.at(icon));
+    double longitudinalDist = path_cursor.GetExactDistanceOnTrajectory(totalPaths, car_info, contour_info.at(icon));
+    if(contour_info.at(icon).iFront == 0 && longitudinalDist > 0)
+      longitudinalDist = -longitudinalDist;
+
+    contour_long_dist.at(icon) = longitudinalDist;
+  }
+}
+
 int TrajectoryDynamicCosts::GetCurrentRollOutIndex(const std::vector<WayPoint>& path, const WayPoint& currState, const PlanningParams& params)
 {
   RelativeInfo obj_info;
@@ -764,8 +859,7 @@ void TrajectoryDynamicCosts::InitializeCosts(const vector<vector<WayPoint> >& ro
 
 void TrajectoryDynamicCosts::InitializeSafetyPolygon(const WayPoint& currState, const CAR_BASIC_INFO& carInfo, const VehicleState& vehicleState, const double& c_lateral_d, const double& c_long_front_d, const double& c_long_back_d)
 {
-  PlannerHNS::Mat3 invRotationMat(currState.pos.a-M_PI_2);
-  PlannerHNS::Mat3 invTranslationMat(currState.pos.x, currState.pos.y);
+  PlannerHNS::RigidTransform2D carToMap(currState.pos.a-M_PI_2, currState.pos.x, currState.pos.y);
 
   double corner_slide_distance = c_lateral_d/2.0;
   double ratio_to_angle = corner_slide_distance/carInfo.max_steer_angle;
@@ -780,24 +874,6 @@ void TrajectoryDynamicCosts::InitializeSafetyPolygon(const WayPoint& currState,
   GPSPoint top_right(c_lateral_d - slide_distance, c_long_front_d,  currState.pos.z, 0);
   GPSPoint top_left(-c_lateral_d - slide_distance , c_long_front_d, currState.pos.z, 0);
 
-  bottom_left = invRotationMat*bottom_left;
-  bottom_left = invTranslationMat*bottom_left;
-
-  top_right = invRotationMat*top_right;
-  top_right = invTranslationMat*top_right;
-
-  bottom_right = invRotationMat*bottom_right;
-  bottom_right = invTranslationMat*bottom_right;
-
-  top_left = invRotationMat*top_left;
-  top_left = invTranslationMat*top_left;
-
-  top_right_car = invRotationMat*top_right_car;
-  top_right_car = invTranslationMat*top_right_car;
-
-  top_left_car = invRotationMat*top_left_car;
-  top_left_car = invTranslationMat*top_left_car;
-
   m_SafetyBorder.points.clear();
   m_SafetyBorder.points.push_back(bottom_left) ;
   m_SafetyBorder.points.push_back(bottom_right) ;
@@ -805,16 +881,19 @@ void TrajectoryDynamicCosts::InitializeSafetyPolygon(const WayPoint& currState,
   m_SafetyBorder.points.push_back(top_right) ;
   m_SafetyBorder.points.push_back(top_left) ;
   m_SafetyBorder.points.push_back(top_left_car) ;
+  carToMap.Transform(m_SafetyBorder.points);
 }
 
-void TrajectoryDynamicCosts::CalculateLateralAndLongitudinalCostsDynamic(const std::vector<PlannerHNS::DetectedObject>& obj_list, const vector<vector<WayPoint> >& rollOuts, const vector<WayPoint>& totalPaths,
+void TrajectoryDynamicCosts::CalculateLateralAndLongitudinalCostsDynamic(const std::vector<PlannerHNS::DetectedObject>& obj_list, const vector<vector<WayPoint> >& rollOuts, const vector<PathSoA>& rollOutsSoA, const vector<WayPoint>& totalPaths,
     const WayPoint& currState, const PlanningParams& params, const CAR_BASIC_INFO& carInfo,
     const VehicleState& vehicleState, const double& c_lateral_d, const double& c_long_front_d, const double& c_long_back_d )
 {
 
+  TrajectoryCursor path_cursor, obj_cursor;
   RelativeInfo car_info;
-  PlanningHelpers::GetRelativeInfo(totalPaths, currState, car_info);
+  path_cursor.GetRelativeInfo(totalPaths, currState, car_info);
   m_CollisionPoints.clear();
+  m_DynamicObjects.clear();
 
   for(unsigned int i=0; i < obj_list.size(); i++)
   {
@@ -825,19 +904,35 @@ void TrajectoryDynamicCosts::CalculateLateralAndLongitudinalCostsDynamic(const s
         continue;
     }
 
-    if(obj_list.at(i).bVelocity && obj_list.at(i).predTrajectories.size() > 0) // dynamic
+    if(obj_list.at(i).bVelocity && obj_list.at(i).predTrajectories.size() > 0 && m_bNearestObjectsFirst)
+    {
+      m_DynamicObjects.push_back(i);
+    }
+    else if(obj_list.at(i).bVelocity && obj_list.at(i).predTrajectories.size() > 0) // dynamic
     {
 
+      if(m_bUseOccupancyGrid)
+      {
+        if(m_ObjectGrids.size() < 1)
+          m_ObjectGrids.resize(1);
+        m_ObjectGrids.at(0).Build(obj_list.at(i), c_lateral_d);
+      }
+
       for(unsigned int ir=0; ir < rollOuts.size(); ir++)
       {
         WayPoint collisionPoint;
         TrajectoryCost trajectoryCosts;
-        CalculateIntersectionVelocities(rollOuts.at(ir), obj_list.at(i), currState, carInfo, c_lateral_d, collisionPoint,trajectoryCosts);
+        if(m_bUseOccupancyGrid)
+          CalculateIntersectionVelocities(rollOuts.at(ir), m_ObjectGrids.at(0), obj_list.at(i), currState, c_lateral_d, collisionPoint, trajectoryCosts);
+        else if(ir < rollOutsSoA.size() && rollOutsSoA.at(ir).size() == rollOuts.at(ir).size())
+          CalculateIntersectionVelocities(rollOuts.at(ir), rollOutsSoA.at(ir), obj_list.at(i), currState, carInfo, c_lateral_d, collisionPoint,trajectoryCosts);
+        else
+          CalculateIntersectionVelocities(rollOuts.at(ir), obj_list.at(i), currState, carInfo, c_lateral_d, collisionPoint,trajectoryCosts);
         if(trajectoryCosts.bBlocked)
         {
           RelativeInfo col_info;
-          PlanningHelpers::GetRelativeInfo(totalPaths, collisionPoint, col_info);
-          double longitudinalDist = PlanningHelpers::GetExactDistanceOnTrajectory(totalPaths, car_info, col_info);
+          obj_cursor.GetRelativeInfo(totalPaths, collisionPoint, col_info);
+          double longitudinalDist = path_cursor.GetExactDistanceOnTrajectory(totalPaths, car_info, col_info);
 
           if(col_info.iFront == 0 && longitudinalDist > 0)
             longitudinalDist = -longitudinalDist;
@@ -861,19 +956,23 @@ void TrajectoryDynamicCosts::CalculateLateralAndLongitudinalCostsDynamic(const s
     {
       RelativeInfo obj_info;
       WayPoint corner_p;
+      PolygonGeometry::PointsInsidePolygon(m_SafetyBorder.points, obj_list.at(i).contour, m_ContourInsideSafetyBorder);
       for(unsigned int icon = 0; icon < obj_list.at(i).contour.size(); icon++)
       {
-        if(m_SafetyBorder.PointInsidePolygon(m_SafetyBorder, obj_list.at(i).contour.at(icon)) == true)
+        if(m_ContourInsideSafetyBorder.at(icon) == 1)
         {
           for(unsigned int it=0; it< rollOuts.size(); it++)
             m_TrajectoryCosts.at(it).bBlocked = true;
 
+          if(m_bNearestObjectsFirst)
+            CalculateDynamicCostsNearestFirst(obj_list, rollOuts, rollOutsSoA, totalPaths, path_cursor, car_info, currState, params, carInfo, c_lateral_d, c_long_front_d);
+
           return;
         }
 
         corner_p.pos = obj_list.at(i).contour.at(icon);
-        PlanningHelpers::GetRelativeInfo(totalPaths, corner_p, obj_info);
-        double longitudinalDist = PlanningHelpers::GetExactDistanceOnTrajectory(totalPaths, car_info, obj_info);
+        obj_cursor.GetRelativeInfo(totalPaths, corner_p, obj_info);
+        double longitudinalDist = path_cursor.GetExactDistanceOnTrajectory(totalPaths, car_info, obj_info);
         if(obj_info.iFront == 0 && longitudinalDist > 0)
           longitudinalDist = -longitudinalDist;
 
@@ -912,6 +1011,118 @@ void TrajectoryDynamicCosts::CalculateLateralAndLongitudinalCostsDynamic(const s
 
     }
   }
+
+  if(m_bNearestObjectsFirst)
+    CalculateDynamicCostsNearestFirst(obj_list, rollOuts, rollOutsSoA, totalPaths, path_cursor, car_info, currState, params, carInfo, c_lateral_d, c_long_front_d);
+}
+
+void TrajectoryDynamicCosts::CalculateDynamicCostsNearestFirst(const std::vector<PlannerHNS::DetectedObject>& obj_list, const vector<vector<WayPoint> >& rollOuts, const vector<PathSoA>& rollOutsSoA,
+    const vector<WayPoint>& totalPaths, TrajectoryCursor& path_cursor, const RelativeInfo& car_info, const WayPoint& currState, const PlanningParams& params,
+    const CAR_BASIC_INFO& carInfo, const double& c_lateral_d, const double& c_long_front_d)
+{
+  //a collision point is within c_lateral_d of a predicted point, the projections of two close points on a curved path
+  //can be farther apart than the points, so the bound keeps twice that margin
+  m_DynamicObjectsOrder.clear();
+  TrajectoryCursor obj_cursor;
+  for(unsigned int io = 0; io < m_DynamicObjects.size(); io++)
+  {
+    const DetectedObject& obj = obj_list.at(m_DynamicObjects.at(io));
+    double min_distance = DBL_MAX;
+    for(unsigned int k = 0; k < obj.predTrajectories.size(); k++)
+    {
+      for(unsigned int j = 0; j < obj.predTrajectories.at(k).size(); j++)
+      {
+        RelativeInfo pred_info;
+        obj_cursor.GetRelativeInfo(totalPaths, obj.predTrajectories.at(k).at(j), pred_info);
+        double longitudinalDist = path_cursor.GetExactDistanceOnTrajectory(totalPaths, car_info, pred_info);
+        if(pred_info.iFront == 0 && longitudinalDist > 0)
+          longitudinalDist = -longitudinalDist;
+        if(longitudinalDist < min_distance)
+          min_distance = longitudinalDist;
+      }
+    }
+
+    double lower_bound = min_distance - 2.0*c_lateral_d;
+    if(lower_bound > params.minFollowingDistance)
+    {
+      m_nSkippedObjectChecks += rollOuts.size();
+      continue;
+    }
+
+    m_DynamicObjectsOrder.push_back(std::make_pair(lower_bound, m_DynamicObjects.at(io)));
+  }
+
+  std::sort(m_DynamicObjectsOrder.begin(), m_DynamicObjectsOrder.end());
+
+  //the grids are built once here and only read by the roll out tasks
+  if(m_bUseOccupancyGrid)
+  {
+    if(m_ObjectGrids.size() < m_DynamicObjectsOrder.size())
+      m_ObjectGrids.resize(m_DynamicObjectsOrder.size());
+    for(unsigned int io = 0; io < m_DynamicObjectsOrder.size(); io++)
+      m_ObjectGrids.at(io).Build(obj_list.at(m_DynamicObjectsOrder.at(io).second), c_lateral_d);
+  }
+
+  m_RollOutCollisionPoints.resize(rollOuts.size());
+  m_RollOutSkippedChecks.assign(rollOuts.size(), 0);
+
+  //each roll out goes through the objects on its own and only writes its own cost
+  RunRollOutTasks(rollOuts.size(), [&](const int& ir)
+  {
+    TrajectoryCursor roll_out_cursor = path_cursor;
+    TrajectoryCursor col_cursor;
+    TrajectoryCost& tc = m_TrajectoryCosts.at(ir);
+    m_RollOutCollisionPoints.at(ir).clear();
+
+    for(unsigned int io = 0; io < m_DynamicObjectsOrder.size(); io++)
+    {
+      //sorted, none of the next objects can be closer
+      if(tc.bBlocked && m_DynamicObjectsOrder.at(io).first >= tc.closest_obj_distance)
+      {
+        m_RollOutSkippedChecks.at(ir) += m_DynamicObjectsOrder.size() - io;
+        break;
+      }
+
+      const DetectedObject& obj = obj_list.at(m_DynamicObjectsOrder.at(io).second);
+      WayPoint collisionPoint;
+      TrajectoryCost trajectoryCosts;
+      if(m_bUseOccupancyGrid)
+        CalculateIntersectionVelocities(rollOuts.at(ir), m_ObjectGrids.at(io), obj, currState, c_lateral_d, collisionPoint, trajectoryCosts);
+      else if(ir < (int)rollOutsSoA.size() && rollOutsSoA.at(ir).size() == rollOuts.at(ir).size())
+        CalculateIntersectionVelocities(rollOuts.at(ir), rollOutsSoA.at(ir), obj, currState, carInfo, c_lateral_d, collisionPoint, trajectoryCosts);
+      else
+        CalculateIntersectionVelocities(rollOuts.at(ir), obj, currState, carInfo, c_lateral_d, collisionPoint, trajectoryCosts);
+
+      if(!trajectoryCosts.bBlocked)
+        continue;
+
+      RelativeInfo col_info;
+      col_cursor.GetRelativeInfo(totalPaths, collisionPoint, col_info);
+      double longitudinalDist = roll_out_cursor.GetExactDistanceOnTrajectory(totalPaths, car_info, col_info);
+
+      if(col_info.iFront == 0 && longitudinalDist > 0)
+        longitudinalDist = -longitudinalDist;
+
+      if(longitudinalDist < -carInfo.length || longitudinalDist > params.minFollowingDistance || fabs(longitudinalDist) < carInfo.width/2.0)
+        continue;
+
+      bool bCloser = longitudinalDist >= -c_long_front_d && longitudinalDist < tc.closest_obj_distance;
+      if(bCloser)
+        tc.closest_obj_distance = longitudinalDist;
+
+      if(bCloser || !tc.bBlocked)
+        tc.closest_obj_velocity = trajectoryCosts.closest_obj_velocity;
+
+      tc.bBlocked = true;
+      m_RollOutCollisionPoints.at(ir).push_back(collisionPoint);
+    }
+  });
+
+  for(unsigned int ir = 0; ir < rollOuts.size(); ir++)
+  {
+    m_CollisionPoints.insert(m_CollisionPoints.end(), m_RollOutCollisionPoints.at(ir).begin(), m_RollOutCollisionPoints.at(ir).end());
+    m_nSkippedObjectChecks += m_RollOutSkippedChecks.at(ir);
+  }
 }
 
 }
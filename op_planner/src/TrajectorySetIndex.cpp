@@ -0,0 +1,299 @@
+/// \file TrajectorySetIndex.cpp
+/// \brief Bounding volume hierarchy over the segments of a set of trajectories, for closest point queries in logarithmic time
+/// \date Oct 14, 2026
+
+#include "op_planner/TrajectorySetIndex.h"
+#include "op_planner/PlanningHelpers.h"
+#include "op_planner/PolylineDistance.h"
+#include <float.h>
+
+using namespace UtilityHNS;
+
+namespace PlannerHNS
+{
+
+// deep enough for any tree the halving builds, 2^64 points would not fit in memory
+#define MAX_TREE_DEPTH 64
+
+TrajectorySetIndex::TrajectorySetIndex(const int& leafSize)
+{
+  m_LeafSize = leafSize;
+}
+
+TrajectorySetIndex::~TrajectorySetIndex()
+{
+}
+
+void TrajectorySetIndex::Clear()
+{
+  m_Nodes.clear();
+  m_Roots.clear();
+  m_Offsets.clear();
+  m_X.clear();
+  m_Y.clear();
+}
+
+void TrajectorySetIndex::Build(const std::vector<std::vector<WayPoint> >& trajectories)
+{
+  Clear();
+
+  unsigned int nPoints = 0;
+  for(unsigned int i = 0; i < trajectories.size(); i++)
+    nPoints += trajectories.at(i).size();
+
+  m_X.reserve(nPoints);
+  m_Y.reserve(nPoints);
+  m_Roots.resize(trajectories.size(), -1);
+  m_Offsets.resize(trajectories.size(), 0);
+
+  for(unsigned int i = 0; i < trajectories.size(); i++)
+  {
+    const std::vector<WayPoint>& t = trajectories.at(i);
+    m_Offsets.at(i) = m_X.size();
+    if(t.size() == 0) continue;
+
+    for(unsigned int j = 0; j < t.size(); j++)
+    {
+      m_X.push_back(t.at(j).pos.x);
+      m_Y.push_back(t.at(j).pos.y);
+    }
+
+    m_Roots.at(i) = BuildNode(m_Offsets.at(i), 0, t.size() - 1);
+  }
+}
+
+int TrajectorySetIndex::BuildNode(const int& offset, const int& iFirst, const int& iLast)
+{
+  int iNode = m_Nodes.size();
+  m_Nodes.push_back(Node());
+  Node node;
+  node.iFirst = iFirst;
+  node.iLast = iLast;
+  node.left = -1;
+  node.right = -1;
+
+  //the children share their border point, so every segment is inside one leaf
+  if(iLast - iFirst > std::max(1, m_LeafSize))
+  {
+    int iMiddle = (iFirst + iLast) / 2;
+    node.left = BuildNode(offset, iFirst, iMiddle);
+    node.right = BuildNode(offset, iMiddle, iLast);
+    const Node& l = m_Nodes.at(node.left);
+    const Node& r = m_Nodes.at(node.right);
+    node.min_x = std::min(l.min_x, r.min_x);
+    node.min_y = std::min(l.min_y, r.min_y);
+    node.max_x = std::max(l.max_x, r.max_x);
+    node.max_y = std::max(l.max_y, r.max_y);
+  }
+  else
+  {
+    node.min_x = node.max_x = m_X.at(offset + iFirst);
+    node.min_y = node.max_y = m_Y.at(offset + iFirst);
+    for(int j = offset + iFirst + 1; j <= offset + iLast; j++)
+    {
+      node.min_x = std::min(node.min_x, m_X.at(j));
+      node.min_y = std::min(node.min_y, m_Y.at(j));
+      node.max_x = std::max(node.max_x, m_X.at(j));
+      node.max_y = std::max(node.max_y, m_Y.at(j));
+    }
+  }
+
+  m_Nodes.at(iNode) = node;
+  return iNode;
+}
+
+double TrajectorySetIndex::GetBoxDistanceSqr(const Node& node, const GPSPoint& p) const
+{
+  double dx = std::max(0.0, std::max(node.min_x - p.x, p.x - node.max_x));
+  double dy = std::max(0.0, std::max(node.min_y - p.y, p.y - node.max_y));
+  return dx*dx + dy*dy;
+}
+
+double TrajectorySetIndex::GetSegmentDistanceSqr(const int& i, const GPSPoint& p) const
+{
+  double x0 = m_X[i], y0 = m_Y[i];
+  double vx = m_X[i+1] - x0, vy = m_Y[i+1] - y0;
+  double wx = p.x - x0, wy = p.y - y0;
+  double len_sqr = vx*vx + vy*vy;
+  double t = 0;
+  if(len_sqr > 0)
+    t = std::max(0.0, std::min(1.0, (wx*vx + wy*vy) / len_sqr));
+
+  double dx = wx - t*vx, dy = wy - t*vy;
+  return dx*dx + dy*dy;
+}
+
+int TrajectorySetIndex::GetClosestVertex(const int& iTrajectory, const GPSPoint& p, double& min_d_sqr) const
+{
+  min_d_sqr = DBL_MAX;
+  if(iTrajectory < 0 || iTrajectory >= (int)m_Roots.size() || m_Roots.at(iTrajectory) < 0) return -1;
+
+  const int offset = m_Offsets.at(iTrajectory);
+  int min_index = -1;
+  int stack[MAX_TREE_DEPTH];
+  int nStack = 0;
+  stack[nStack++] = m_Roots.at(iTrajectory);
+  while(nStack > 0)
+  {
+    const Node& node = m_Nodes[stack[--nStack]];
+    //strictly farther only, an equal point with a lower index can still be in the box
+    if(GetBoxDistanceSqr(node, p) > min_d_sqr) continue;
+
+    if(node.left < 0)
+    {
+      double d = 0;
+      int j = node.iFirst + PolylineDistance::GetClosestVertex(m_X.data() + offset + node.iFirst, m_Y.data() + offset + node.iFirst,
+          node.iLast - node.iFirst + 1, p.x, p.y, d);
+      if(d < min_d_sqr || (d == min_d_sqr && j < min_index))
+      {
+        min_d_sqr = d;
+        min_index = j;
+      }
+      continue;
+    }
+
+    //the nearer child is popped first
+    const int iLeft = node.left, iRight = node.right;
+    if(GetBoxDistanceSqr(m_Nodes[iLeft], p) <= GetBoxDistanceSqr(m_Nodes[iRight], p))
+    {
+      stack[nStack++] = iRight;
+      stack[nStack++] = iLeft;
+    }
+    else
+    {
+      stack[nStack++] = iLeft;
+      stack[nStack++] = iRight;
+    }
+  }
+
+  return min_index;
+}
+
+bool TrajectorySetIndex::GetClosestSegment(const GPSPoint& p, int& iTrajectory, int& iSegment, double& distance) const
+{
+  iTrajectory = -1;
+  iSegment = -1;
+  double min_d_sqr = DBL_MAX;
+  int stack[MAX_TREE_DEPTH];
+  for(unsigned int i = 0; i < m_Roots.size(); i++)
+  {
+    if(m_Roots.at(i) < 0 || m_Nodes.at(m_Roots.at(i)).iLast < 1) continue;
+
+    const int offset = m_Offsets.at(i);
+    int nStack = 0;
+    stack[nStack++] = m_Roots.at(i);
+    while(nStack > 0)
+    {
+      const Node& node = m_Nodes[stack[--nStack]];
+      if(GetBoxDistanceSqr(node, p) >= min_d_sqr) continue;
+
+      if(node.left < 0)
+      {
+        for(int j = node.iFirst; j < node.iLast; j++)
+        {
+          double d = GetSegmentDistanceSqr(offset + j, p);
+          if(d < min_d_sqr)
+          {
+            min_d_sqr = d;
+            iTrajectory = i;
+            iSegment = j;
+          }
+        }
+        continue;
+      }
+
+      const int iLeft = node.left, iRight = node.right;
+      if(GetBoxDistanceSqr(m_Nodes[iLeft], p) <= GetBoxDistanceSqr(m_Nodes[iRight], p))
+      {
+        stack[nStack++] = iRight;
+        stack[nStack++] = iLeft;
+      }
+      else
+      {
+        stack[nStack++] = iLeft;
+        stack[nStack++] = iRight;
+      }
+    }
+  }
+
+  if(iTrajectory < 0) return false;
+
+  distance = sqrt(min_d_sqr);
+  return true;
+}
+
+bool TrajectorySetIndex::GetRelativeInfo(const std::vector<std::vector<WayPoint> >& trajectories, const int& iTrajectory,
+    const WayPoint& p, RelativeInfo& info) const
+{
+  const std::vector<WayPoint>& trajectory = trajectories.at(iTrajectory);
+  if(trajectory.size() < 2) return false;
+
+  int iFront = 1;
+  if(trajectory.size() > 2)
+  {
+    double min_d_sqr = 0;
+    int min_index = GetClosestVertex(iTrajectory, p.pos, min_d_sqr);
+    iFront = min_index;
+    //the point after the closest one when p is ahead of it, as TrajectoryCursor::CorrectToNextPoint
+    if(min_index < (int)trajectory.size() - 1)
+    {
+      const GPSPoint& curr = trajectory[min_index].pos;
+      const GPSPoint& next = trajectory[min_index+1].pos;
+      GPSPoint v_1(p.pos.x - curr.x, p.pos.y - curr.y, 0, 0);
+      GPSPoint v_2(next.x - curr.x, next.y - curr.y, 0, 0);
+      double dot_pro = v_1.x*v_2.x + v_1.y*v_2.y;
+      double a = UtilityH::FixNegativeAngle(acos(dot_pro/(pointNorm(v_1)*pointNorm(v_2))));
+      if(a <= M_PI_2)
+        iFront = min_index + 1;
+    }
+  }
+
+  PlanningHelpers::GetRelativeInfoFromIndex(trajectory, p, iFront, info);
+  return true;
+}
+
+bool TrajectorySetIndex::GetRelativeInfoRange(const std::vector<std::vector<WayPoint> >& trajectories, const WayPoint& p,
+    const double& searchDistance, RelativeInfo& info) const
+{
+  if(trajectories.size() == 0) return false;
+
+  //same selection as PlanningHelpers::GetRelativeInfoRange
+  int nCandidates = 0;
+  double minCost = DBL_MAX;
+  RelativeInfo info_item;
+  for(unsigned int i=0; i < trajectories.size(); i++)
+  {
+    info_item = RelativeInfo();
+    GetRelativeInfo(trajectories, i, p, info_item);
+    double angle_diff = UtilityH::AngleBetweenTwoAnglesPositive(info_item.perp_point.pos.a, p.pos.a)*RAD2DEG;
+    if(angle_diff >= 75)
+      continue;
+
+    info_item.iGlobalPath = i;
+    nCandidates++;
+    if(nCandidates == 1)
+      info = info_item;
+
+    if(searchDistance > 0)
+    {
+      double laneChangeCost = trajectories.at(i).at(info_item.iFront).laneChangeCost;
+      if(fabs(info_item.perp_distance) < searchDistance && laneChangeCost < minCost)
+      {
+        info = info_item;
+        minCost = laneChangeCost;
+      }
+    }
+    else
+    {
+      if(fabs(info_item.perp_distance) < minCost)
+      {
+        info = info_item;
+        minCost = info_item.perp_distance;
+      }
+    }
+  }
+
+  return nCandidates > 0;
+}
+
+} /* namespace PlannerHNS */
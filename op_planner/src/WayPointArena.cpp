@@ -0,0 +1,80 @@
+/// \file WayPointArena.cpp
+/// \brief Block allocated WayPoint nodes for the planning search trees, released all at once with Reset
+/// \date Oct 14, 2026
+
+#include "op_planner/WayPointArena.h"
+
+namespace PlannerHNS
+{
+
+WayPointArena::WayPointArena(const unsigned int& blockSize)
+{
+  m_BlockSize = blockSize > 0 ? blockSize : 1;
+  m_nNodes = 0;
+  m_nPeakNodes = 0;
+}
+
+WayPointArena::~WayPointArena()
+{
+}
+
+WayPoint* WayPointArena::Create(const WayPoint& wp)
+{
+  unsigned int iBlock = m_nNodes / m_BlockSize;
+  unsigned int iNode = m_nNodes % m_BlockSize;
+
+  if(iBlock == m_Blocks.size())
+  {
+    m_Blocks.push_back(std::vector<WayPoint>());
+    m_Blocks.back().reserve(m_BlockSize);
+  }
+
+  //blocks are reserved once and never grow past their capacity, so the node addresses stay valid
+  std::vector<WayPoint>& block = m_Blocks.at(iBlock);
+  WayPoint* pNode = nullptr;
+  if(iNode < block.size())
+  {
+    pNode = &block.at(iNode);
+    *pNode = wp;
+  }
+  else
+  {
+    block.push_back(wp);
+    pNode = &block.back();
+  }
+
+  m_nNodes++;
+  if(m_nNodes > m_nPeakNodes)
+    m_nPeakNodes = m_nNodes;
+
+  return pNode;
+}
+
+void WayPointArena::Reset()
+{
+  m_nNodes = 0;
+}
+
+void WayPointArena::Clear()
+{
+  m_Blocks.clear();
+  m_nNodes = 0;
+  m_nPeakNodes = 0;
+}
+
+unsigned int WayPointArena::GetNodeCount() const
+{
+  return m_nNodes;
+}
+
+unsigned int WayPointArena::GetPeakNodeCount() const
+{
+  return m_nPeakNodes;
+}
+
+size_t WayPointArena::GetPeakBytes() const
+{
+  return m_Blocks.size() * m_BlockSize * sizeof(WayPoint);
+}
+
+} /* namespace PlannerHNS */
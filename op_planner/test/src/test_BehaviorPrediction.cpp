@@ -0,0 +1,469 @@
+/*
+ * Copyright 2020 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "op_planner/BehaviorPrediction.h"
+#include "op_planner/MappingHelpers.h"
+#include "op_planner/PlanningHelpers.h"
+#include "op_planner/PassiveDecisionMaker.h"
+
+using namespace PlannerHNS;
+
+#include <ros/ros.h>
+#include <gtest/gtest.h>
+#include <vector>
+#include <iostream>
+#include <algorithm>
+
+class TestSuite:
+  public ::testing::Test
+{
+public:
+  TestSuite() {}
+};
+
+// Four rows of chained lanes 3.5 meters apart along x, each lane is 25 meters long
+void CreateRowsMap(RoadNetwork& map)
+{
+  RoadSegment segment;
+  segment.id = 1;
+  int point_id = 1;
+  for(int r = 0; r < 4; r++)
+  {
+    for(int i = 0; i < 12; i++)
+    {
+      Lane l;
+      l.id = r * 100 + i + 1;
+      for(int p = 0; p < 25; p++)
+      {
+        WayPoint wp(i * 25 + p, r * 3.5, 0, 0);
+        wp.id = point_id++;
+        wp.laneId = l.id;
+        l.points.push_back(wp);
+      }
+      PlanningHelpers::FixAngleOnly(l.points);
+      if(i < 11) l.toIds.push_back(l.id + 1);
+      if(i > 0) l.fromIds.push_back(l.id - 1);
+      segment.Lanes.push_back(l);
+    }
+  }
+  map.roadSegments.push_back(segment);
+
+  MappingHelpers::LinkLanesPointers(map);
+  MappingHelpers::LinkMissingBranchingWayPointsV2(map);
+  MappingHelpers::FindAdjacentLanesV2(map, 1);
+  map.spatialIndex.Build(map.roadSegments);
+}
+
+void CreateObjects(const int& step, std::vector<DetectedObject>& objects)
+{
+  objects.clear();
+  for(int i = 0; i < 16; i++)
+  {
+    DetectedObject obj;
+    obj.id = i + 1;
+    obj.t = CAR;
+    obj.w = 1.8;
+    obj.l = 4.2;
+    obj.center = WayPoint(10 + i * 15 + step * 0.4, (i % 4) * 3.5 + 0.1, 0, 0);
+    obj.center.v = 3 + (i % 3);
+    obj.bDirection = true;
+    obj.bVelocity = true;
+    objects.push_back(obj);
+  }
+}
+
+void InitPrediction(const int& nThreads, BehaviorPrediction& prediction, const bool& bResampling = false)
+{
+  prediction.m_bSystematicResampling = bResampling;
+  prediction.m_nThreads = nThreads;
+  prediction.m_RandomSeed = 7;
+  prediction.m_bParticleFilter = true;
+  prediction.m_bStepByStep = true;
+  prediction.m_PredictionDistance = 40;
+  prediction.m_MaxLaneDetectionDistance = 1.0;
+}
+
+TEST(TestSuite, ParallelObjectsMatchSequentialObjects)
+{
+  RoadNetwork map;
+  CreateRowsMap(map);
+
+  BehaviorPrediction sequential, parallel;
+  InitPrediction(1, sequential);
+  InitPrediction(4, parallel);
+
+  std::vector<DetectedObject> objects;
+  for(int step = 0; step < 4; step++)
+  {
+    CreateObjects(step, objects);
+    sequential.DoOneStep(objects, WayPoint(), 0.5, 0, map);
+    parallel.DoOneStep(objects, WayPoint(), 0.5, 0, map);
+
+    ASSERT_EQ(objects.size(), sequential.m_ParticleInfo_II.size());
+    ASSERT_EQ(sequential.m_ParticleInfo_II.size(), parallel.m_ParticleInfo_II.size());
+    unsigned int nParticles = 0;
+    for(unsigned int i = 0; i < sequential.m_ParticleInfo_II.size(); i++)
+    {
+      const ObjParticles* pS = sequential.m_ParticleInfo_II.at(i);
+      const ObjParticles* pP = parallel.m_ParticleInfo_II.at(i);
+      ASSERT_EQ(pS->obj.id, pP->obj.id);
+      ASSERT_GT(pS->obj.predTrajectories.size(), 0);
+      ASSERT_EQ(pS->obj.predTrajectories.size(), pP->obj.predTrajectories.size());
+      for(unsigned int t = 0; t < pS->obj.predTrajectories.size(); t++)
+      {
+        ASSERT_EQ(pS->obj.predTrajectories.at(t).size(), pP->obj.predTrajectories.at(t).size());
+        for(unsigned int k = 0; k < pS->obj.predTrajectories.at(t).size(); k++)
+        {
+          ASSERT_EQ(pS->obj.predTrajectories.at(t).at(k).pos.x, pP->obj.predTrajectories.at(t).at(k).pos.x);
+          ASSERT_EQ(pS->obj.predTrajectories.at(t).at(k).pos.y, pP->obj.predTrajectories.at(t).at(k).pos.y);
+          ASSERT_EQ(pS->obj.predTrajectories.at(t).at(k).timeCost, pP->obj.predTrajectories.at(t).at(k).timeCost);
+        }
+        ASSERT_EQ(pS->obj.predTrajectories.at(t).at(0).collisionCost, pP->obj.predTrajectories.at(t).at(0).collisionCost);
+      }
+
+      ASSERT_EQ(pS->m_Particles.size(), pP->m_Particles.size());
+      nParticles += pS->m_Particles.size();
+      for(unsigned int k = 0; k < pS->m_Particles.size(); k++)
+        ASSERT_EQ(pS->m_Particles.x.at(k), pP->m_Particles.x.at(k));
+      ASSERT_EQ(pS->i_best_track, pP->i_best_track);
+      ASSERT_EQ(pS->bCanDecide, pP->bCanDecide);
+      ASSERT_EQ(pS->all_w, pP->all_w);
+      ASSERT_EQ(pS->p_stop, pP->p_stop);
+    }
+    ASSERT_GT(nParticles, 0);
+    ASSERT_EQ(sequential.m_bCanDecide, parallel.m_bCanDecide);
+  }
+}
+
+TEST(TestSuite, FixedSeedRepeatsParticles)
+{
+  RoadNetwork map;
+  CreateRowsMap(map);
+
+  BehaviorPrediction first, second;
+  InitPrediction(2, first);
+  InitPrediction(3, second);
+
+  std::vector<DetectedObject> objects;
+  CreateObjects(0, objects);
+  first.DoOneStep(objects, WayPoint(), 0.5, 0, map);
+  second.DoOneStep(objects, WayPoint(), 0.5, 0, map);
+
+  for(unsigned int i = 0; i < first.m_ParticleInfo_II.size(); i++)
+  {
+    const ObjParticles* pF = first.m_ParticleInfo_II.at(i);
+    const ObjParticles* pS = second.m_ParticleInfo_II.at(i);
+    ASSERT_EQ(pF->m_Particles.size(), pS->m_Particles.size());
+    for(unsigned int k = 0; k < pF->m_Particles.size(); k++)
+    {
+      ASSERT_EQ(pF->m_Particles.x.at(k), pS->m_Particles.x.at(k));
+      ASSERT_EQ(pF->m_Particles.w.at(k), pS->m_Particles.w.at(k));
+    }
+  }
+
+  //different objects draw different noise
+  ASSERT_NE(first.m_ParticleInfo_II.at(0)->m_Particles.y.at(0) - objects.at(0).center.pos.y,
+      first.m_ParticleInfo_II.at(4)->m_Particles.y.at(0) - objects.at(4).center.pos.y);
+}
+
+TEST(TestSuite, ParticleBufferSwapRemove)
+{
+  TrajectoryTracker track;
+  ParticleBuffer parts;
+  for(int i = 0; i < 5; i++)
+  {
+    Particle p;
+    p.pose.pos.x = i;
+    p.w = i;
+    parts.Add(p, &track);
+  }
+
+  parts.Remove(1);
+  ASSERT_EQ(parts.size(), 4);
+  ASSERT_EQ(parts.x.at(1), 4);
+  ASSERT_EQ(parts.w.at(1), 4);
+  ASSERT_EQ(parts.pTraj.at(1), &track);
+
+  parts.Remove(3);
+  ASSERT_EQ(parts.size(), 3);
+  ASSERT_EQ(parts.x.at(0), 0);
+  ASSERT_EQ(parts.x.at(1), 4);
+  ASSERT_EQ(parts.x.at(2), 2);
+  ASSERT_EQ(parts.Get(2).pose.pos.x, 2);
+}
+
+TEST(TestSuite, SystematicSamples)
+{
+  TrajectoryTracker track;
+  ParticleBuffer parts;
+  double weights[] = {0, 0, 1, 3};
+  for(int i = 0; i < 4; i++)
+  {
+    Particle p;
+    p.pose.pos.x = i;
+    p.w = weights[i];
+    parts.Add(p, &track);
+  }
+
+  std::vector<unsigned int> indices;
+  parts.GetSystematicSamples(0.5, indices);
+  ASSERT_EQ(indices.size(), 4);
+  ASSERT_EQ(indices.at(0), 2);
+  ASSERT_EQ(indices.at(1), 3);
+  ASSERT_EQ(indices.at(2), 3);
+  ASSERT_EQ(indices.at(3), 3);
+
+  parts.Select(indices);
+  ASSERT_EQ(parts.size(), 4);
+  ASSERT_EQ(parts.x.at(0), 2);
+  ASSERT_EQ(parts.x.at(3), 3);
+
+  ParticleBuffer empty;
+  empty.GetSystematicSamples(0.5, indices);
+  ASSERT_EQ(indices.size(), 0);
+}
+
+TEST(TestSuite, AliveCountsMatchParticles)
+{
+  RoadNetwork map;
+  CreateRowsMap(map);
+
+  BehaviorPrediction pruning, resampling;
+  InitPrediction(1, pruning);
+  InitPrediction(2, resampling, true);
+
+  std::vector<DetectedObject> objects;
+  for(int step = 0; step < 4; step++)
+  {
+    CreateObjects(step, objects);
+    pruning.DoOneStep(objects, WayPoint(), 0.5, 0, map);
+    resampling.DoOneStep(objects, WayPoint(), 0.5, 0, map);
+
+    BehaviorPrediction* predictions[] = {&pruning, &resampling};
+    for(int k = 0; k < 2; k++)
+    {
+      for(unsigned int i = 0; i < predictions[k]->m_ParticleInfo_II.size(); i++)
+      {
+        ObjParticles* pParts = predictions[k]->m_ParticleInfo_II.at(i);
+        int nAlive = 0;
+        for(unsigned int t = 0; t < pParts->m_TrajectoryTracker.size(); t++)
+        {
+          TrajectoryTracker* pTrack = pParts->m_TrajectoryTracker.at(t);
+          ASSERT_LE(pTrack->nAliveForward, BEH_PARTICLES_NUM);
+          ASSERT_LE(pTrack->nAliveStop, BEH_PARTICLES_NUM);
+          nAlive += pTrack->nAliveForward + pTrack->nAliveStop + pTrack->nAliveYield + pTrack->nAliveLeft + pTrack->nAliveRight;
+        }
+        ASSERT_EQ(nAlive, pParts->m_Particles.size());
+        for(unsigned int p = 0; p < pParts->m_Particles.size(); p++)
+        {
+          ASSERT_NE(std::find(pParts->m_TrajectoryTracker.begin(), pParts->m_TrajectoryTracker.end(), pParts->m_Particles.pTraj.at(p)),
+              pParts->m_TrajectoryTracker.end());
+        }
+      }
+    }
+  }
+
+  //resampling keeps the population of the last step
+  unsigned int nParticles = 0;
+  for(unsigned int i = 0; i < resampling.m_ParticleInfo_II.size(); i++)
+    nParticles += resampling.m_ParticleInfo_II.at(i)->m_Particles.size();
+  ASSERT_GT(nParticles, 0);
+}
+
+TEST(TestSuite, TrajectoryCache)
+{
+  RoadNetwork map;
+  CreateRowsMap(map);
+
+  BehaviorPrediction prediction;
+  InitPrediction(1, prediction);
+  prediction.m_bParticleFilter = false;
+
+  std::vector<DetectedObject> objects;
+  for(int step = 0; step < 4; step++)
+  {
+    CreateObjects(step, objects);
+    prediction.DoOneStep(objects, WayPoint(), 0.5, 0, map);
+    for(unsigned int i = 0; i < prediction.m_ParticleInfo_II.size(); i++)
+    {
+      ASSERT_EQ(prediction.m_ParticleInfo_II.at(i)->bTrajectoriesFromCache, step > 0);
+      ASSERT_GT(prediction.m_ParticleInfo_II.at(i)->obj.predTrajectories.size(), 0);
+    }
+  }
+
+  ASSERT_EQ(prediction.m_nTrajectoryCacheMisses, objects.size());
+  ASSERT_EQ(prediction.m_nTrajectoryCacheHits, objects.size()*3);
+  ASSERT_DOUBLE_EQ(prediction.GetTrajectoryCacheHitRate(), 0.75);
+
+  //first object changes lanes, second one consumed its trajectories, the rest stay
+  CreateObjects(4, objects);
+  objects.at(0).center.pos.y += 3.5;
+  objects.at(1).center.pos.x += 15;
+  prediction.ResetTrajectoryCacheCounters();
+  prediction.DoOneStep(objects, WayPoint(), 0.5, 0, map);
+  ASSERT_FALSE(prediction.m_ParticleInfo_II.at(0)->bTrajectoriesFromCache);
+  ASSERT_FALSE(prediction.m_ParticleInfo_II.at(1)->bTrajectoriesFromCache);
+  ASSERT_TRUE(prediction.m_ParticleInfo_II.at(2)->bTrajectoriesFromCache);
+  ASSERT_EQ(prediction.m_nTrajectoryCacheMisses, 2);
+
+  //a new map version drops every cached trajectory
+  MappingHelpers::UpdateMapVersion(map);
+  prediction.DoOneStep(objects, WayPoint(), 0.5, 0, map);
+  for(unsigned int i = 0; i < prediction.m_ParticleInfo_II.size(); i++)
+    ASSERT_FALSE(prediction.m_ParticleInfo_II.at(i)->bTrajectoriesFromCache);
+}
+
+class FilteringPrediction : public BehaviorPrediction
+{
+public:
+  using BehaviorPrediction::FilterObservations;
+};
+
+TEST(TestSuite, ObservationsMatchedById)
+{
+  RoadNetwork map;
+  CreateRowsMap(map);
+
+  //moving objects are added or updated, slow ones keep their entry, missing ones are dropped in order
+  FilteringPrediction filter;
+  std::vector<DetectedObject> objects, filtered;
+  CreateObjects(0, objects);
+  filter.FilterObservations(objects, map, filtered);
+  ASSERT_EQ(filtered.size(), objects.size());
+
+  CreateObjects(1, objects);
+  objects.at(3).center.v = 0;
+  objects.erase(objects.begin() + 5);
+  std::reverse(objects.begin(), objects.end());
+  DetectedObject new_obj = objects.at(0);
+  new_obj.id = 100;
+  objects.push_back(new_obj);
+  filter.FilterObservations(objects, map, filtered);
+  ASSERT_EQ(filtered.size(), 16);
+  for(unsigned int i = 0; i < 15; i++)
+  {
+    int id = i < 5 ? i + 1 : i + 2;
+    ASSERT_EQ(filtered.at(i).id, id);
+    ASSERT_EQ(filtered.at(i).center.pos.x, id == 4 ? 10 + 3 * 15 : 10 + (id - 1) * 15 + 0.4);
+  }
+  ASSERT_EQ(filtered.back().id, 100);
+
+  //tracked objects follow their ids whatever the order of the detections
+  BehaviorPrediction prediction;
+  InitPrediction(1, prediction);
+  CreateObjects(0, objects);
+  prediction.DoOneStep(objects, WayPoint(), 0.5, 0, map);
+  std::vector<ObjParticles*> tracked = prediction.m_ParticleInfo_II;
+
+  CreateObjects(1, objects);
+  objects.erase(objects.begin() + 2);
+  std::reverse(objects.begin(), objects.end());
+  prediction.DoOneStep(objects, WayPoint(), 0.5, 0, map);
+  ASSERT_EQ(prediction.m_ParticleInfo_II.size(), objects.size());
+  for(unsigned int i = 0; i < objects.size(); i++)
+  {
+    ASSERT_EQ(prediction.m_ParticleInfo_II.at(i)->obj.id, objects.at(i).id);
+    ASSERT_EQ(prediction.m_ParticleInfo_II.at(i), tracked.at(objects.at(i).id - 1));
+  }
+}
+
+TEST(TestSuite, BatchedMovesMatchSingleMoves)
+{
+  // curved path with a stop line every 40 meters
+  Lane lane;
+  std::vector<WayPoint> path;
+  for(int i = 0; i < 200; i++)
+  {
+    WayPoint wp(i, 10.0 * sin(i / 40.0), 0, 0);
+    wp.pLane = &lane;
+    wp.v = 5 + (i % 13);
+    path.push_back(wp);
+  }
+  PlanningHelpers::CalcAngleAndCost(path);
+  for(int i = 30; i < 200; i += 40)
+  {
+    StopLine sl;
+    sl.id = lane.stopLines.size() + 1;
+    sl.points.push_back(GPSPoint(path.at(i).pos.x, path.at(i).pos.y + 2.0, 0, 0));
+    sl.points.push_back(GPSPoint(path.at(i).pos.x, path.at(i).pos.y - 2.0, 0, 0));
+    lane.stopLines.push_back(sl);
+    path.at(i - 2).stopLineID = sl.id;
+  }
+
+  CAR_BASIC_INFO carInfo;
+  carInfo.length = 4.5;
+  carInfo.wheel_base = carInfo.length*0.75;
+  carInfo.max_deceleration = -3;
+  carInfo.max_speed_forward = 20;
+  carInfo.min_speed_forward = 0;
+
+  std::vector<WayPoint> poses;
+  for(int i = 0; i < 300; i++)
+  {
+    double x = (i * 0.61);
+    WayPoint p(x, 10.0 * sin(x / 40.0) + ((i % 7) - 3) * 0.3, 0, path.at(std::min(199, (int)x)).pos.a + ((i % 5) - 2) * 0.05);
+    p.v = 2 + (i % 11);
+    poses.push_back(p);
+  }
+
+  for(int simple = 0; simple < 2; simple++)
+  {
+    PassiveDecisionMaker single, batched;
+    std::vector<WayPoint> batch_poses = poses;
+    std::vector<ParticleInfo> batch_info;
+    std::vector<BehaviorState> batch_behaviors;
+    if(simple)
+      batched.MoveStepsSimple(0.1, batch_poses, path, carInfo, batch_info);
+    else
+      batched.MoveSteps(0.1, batch_poses, path, carInfo, batch_behaviors);
+
+    int n_stopping = 0;
+    for(unsigned int i = 0; i < poses.size(); i++)
+    {
+      WayPoint pose = poses.at(i);
+      if(simple)
+      {
+        ParticleInfo info = single.MoveStepSimple(0.1, pose, path, carInfo);
+        ASSERT_EQ(info.state, batch_info.at(i).state) << "pose " << i;
+        ASSERT_EQ(info.indicator, batch_info.at(i).indicator);
+        ASSERT_EQ(info.vel, batch_info.at(i).vel);
+        n_stopping += info.state == STOPPING_STATE;
+      }
+      else
+      {
+        BehaviorState beh = single.MoveStep(0.1, pose, path, carInfo);
+        ASSERT_EQ(beh.state, batch_behaviors.at(i).state) << "pose " << i;
+        ASSERT_EQ(beh.indicator, batch_behaviors.at(i).indicator);
+        ASSERT_EQ(beh.maxVelocity, batch_behaviors.at(i).maxVelocity);
+        n_stopping += beh.state == STOPPING_STATE;
+      }
+      ASSERT_EQ(pose.pos.x, batch_poses.at(i).pos.x);
+      ASSERT_EQ(pose.pos.y, batch_poses.at(i).pos.y);
+      ASSERT_EQ(pose.pos.a, batch_poses.at(i).pos.a);
+      ASSERT_EQ(pose.v, batch_poses.at(i).v);
+    }
+    EXPECT_GT(n_stopping, 0);
+    EXPECT_LT(n_stopping, poses.size());
+  }
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  ros::init(argc, argv, "TestNode");
+  return RUN_ALL_TESTS();
+}
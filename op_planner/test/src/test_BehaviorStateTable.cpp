@@ -0,0 +1,136 @@
+/*
+ * Copyright 2020 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "op_planner/DecisionMaker.h"
+#include "op_planner/BehaviorStateTable.h"
+
+using namespace PlannerHNS;
+
+#include <ros/ros.h>
+#include <gtest/gtest.h>
+#include <vector>
+#include <cstdlib>
+
+class TestSuite:
+  public ::testing::Test
+{
+public:
+  TestSuite() {}
+};
+
+void RandomConditions(PreCalculatedConditions& pre)
+{
+  // goal, stop sign and traffic light changes are rare so every state is reached
+  pre.currentGoalID = (rand() % 40 == 0) ? -1 : 1;
+  pre.prevGoalID = (rand() % 8 == 0) ? 2 : pre.currentGoalID;
+  pre.currentStopSignID = rand() % 3;
+  pre.prevStopSignID = (rand() % 4 == 0) ? rand() % 3 : pre.currentStopSignID;
+  pre.currentTrafficLightID = rand() % 3;
+  pre.prevTrafficLightID = (rand() % 4 == 0) ? rand() % 3 : pre.currentTrafficLightID;
+  pre.bTrafficIsRed = rand() % 2;
+  pre.currentVelocity = (rand() % 3) * 0.05;
+  pre.bFullyBlock = rand() % 2;
+  pre.distanceToNext = rand() % 30;
+  pre.iCurrSafeTrajectory = rand() % 3;
+  pre.iPrevSafeTrajectory = rand() % 3;
+  pre.bRePlan = false;
+}
+
+TEST(TestSuite, TableMatchesStateClasses)
+{
+  PlanningParams params;
+  params.enableFollowing = true;
+  params.enableSwerving = true;
+  params.enableStopSignBehavior = true;
+  params.enableTrafficLightBehavior = true;
+  params.stopSignStopTime = 0;
+  ControllerParams ctrl_params;
+  CAR_BASIC_INFO car_info;
+
+  DecisionMaker classes, table;
+  classes.Init(ctrl_params, params, car_info);
+  table.Init(ctrl_params, params, car_info);
+  table.m_bUseStateTable = true;
+
+  srand(7);
+  std::vector<int> visited(BEHAVIOR_STATES_NUMBER, 0);
+  for(int i = 0; i < 5000; i++)
+  {
+    PreCalculatedConditions* pA = classes.m_pCurrentBehaviorState->GetCalcParams();
+    PreCalculatedConditions* pB = table.m_pCurrentBehaviorState->GetCalcParams();
+    RandomConditions(*pA);
+    *pB = *pA;
+
+    classes.m_pCurrentBehaviorState = classes.m_pCurrentBehaviorState->GetNextState();
+    if(!classes.m_pCurrentBehaviorState)
+      classes.m_pCurrentBehaviorState = classes.m_pInitState;
+
+    STATE_TYPE next = table.m_StateTable.GetNextState(table.m_pCurrentBehaviorState->m_Behavior, *table.m_pCurrentBehaviorState->m_pParams, *pB);
+    table.m_pCurrentBehaviorState = table.m_pStatesByType[next];
+    ASSERT_NE(nullptr, table.m_pCurrentBehaviorState);
+
+    ASSERT_EQ(classes.m_pCurrentBehaviorState->m_Behavior, table.m_pCurrentBehaviorState->m_Behavior) << "step " << i;
+    ASSERT_EQ(pA->prevGoalID, pB->prevGoalID);
+    ASSERT_EQ(pA->prevStopSignID, pB->prevStopSignID);
+    ASSERT_EQ(pA->prevTrafficLightID, pB->prevTrafficLightID);
+    ASSERT_EQ(pA->iPrevSafeTrajectory, pB->iPrevSafeTrajectory);
+    ASSERT_EQ(pA->bRePlan, pB->bRePlan);
+    visited.at(next)++;
+  }
+
+  ASSERT_GT(visited.at(FORWARD_STATE), 0);
+  ASSERT_GT(visited.at(FOLLOW_STATE), 0);
+  ASSERT_GT(visited.at(STOP_SIGN_WAIT_STATE), 0);
+  ASSERT_GT(visited.at(TRAFFIC_LIGHT_WAIT_STATE), 0);
+  ASSERT_GT(visited.at(OBSTACLE_AVOIDANCE_STATE), 0);
+  ASSERT_GT(visited.at(FINISH_STATE), 0);
+}
+
+TEST(TestSuite, TransitionMasks)
+{
+  ASSERT_TRUE(BehaviorStateTable::IsTransitionAllowed(FORWARD_STATE, FOLLOW_STATE));
+  ASSERT_TRUE(BehaviorStateTable::IsTransitionAllowed(STOP_SIGN_STOP_STATE, STOP_SIGN_WAIT_STATE));
+  ASSERT_FALSE(BehaviorStateTable::IsTransitionAllowed(STOP_SIGN_STOP_STATE, GOAL_STATE));
+  ASSERT_FALSE(BehaviorStateTable::IsTransitionAllowed(FINISH_STATE, FORWARD_STATE));
+
+  // a decision that is not in the table goes back to the initial state
+  PlanningParams params;
+  PreCalculatedConditions pre;
+  pre.currentGoalID = 2;
+  pre.prevGoalID = 1;
+  BehaviorStateTable table;
+  ASSERT_EQ(INITIAL_STATE, table.GetNextState(STOP_SIGN_STOP_STATE, params, pre));
+  ASSERT_EQ(FORWARD_STATE, table.GetNextState(INITIAL_STATE, params, pre));
+  ASSERT_EQ(GOAL_STATE, table.GetNextState(FORWARD_STATE, params, pre));
+}
+
+TEST(TestSuite, DecisionMakingTimeHoldsState)
+{
+  PlanningParams params;
+  PreCalculatedConditions pre;
+  BehaviorStateTable table;
+  table.SetDecisionMakingTime(STOP_SIGN_WAIT_STATE, 100.0);
+  ASSERT_EQ(STOP_SIGN_WAIT_STATE, table.GetNextState(STOP_SIGN_WAIT_STATE, params, pre));
+  table.SetDecisionMakingTime(STOP_SIGN_WAIT_STATE, 0);
+  ASSERT_EQ(FORWARD_STATE, table.GetNextState(STOP_SIGN_WAIT_STATE, params, pre));
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  ros::init(argc, argv, "TestNode");
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,286 @@
+/*
+ * Copyright 2020 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "op_planner/PlanningHelpers.h"
+#include "op_planner/PlannerH.h"
+
+using namespace PlannerHNS;
+
+#include <ros/ros.h>
+#include <gtest/gtest.h>
+#include <vector>
+#include <iostream>
+
+class TestSuite:
+  public ::testing::Test
+{
+public:
+  TestSuite() {}
+};
+
+// Main chain along x with a side chain forking every 40 points, 1 meter spacing
+void CreateForkedGraph(std::vector<WayPoint>& nodes, const int& n_main)
+{
+  int n_forks = n_main / 40;
+  int fork_length = 30;
+  nodes.clear();
+  nodes.resize(n_main + n_forks * fork_length);
+  for(int i = 0; i < n_main; i++)
+  {
+    nodes.at(i) = WayPoint(i, 0, 0, 0);
+    nodes.at(i).id = i + 1;
+    nodes.at(i).laneId = 1;
+  }
+
+  for(int f = 0; f < n_forks; f++)
+  {
+    int iFork = f * 40 + 20;
+    for(int k = 0; k < fork_length; k++)
+    {
+      int i = n_main + f * fork_length + k;
+      nodes.at(i) = WayPoint(iFork + k + 1, k + 1, 0, M_PI_4);
+      nodes.at(i).id = i + 1;
+      nodes.at(i).laneId = 100 + f;
+    }
+  }
+
+  for(int i = 0; i + 1 < n_main; i++)
+  {
+    nodes.at(i).pFronts.push_back(&nodes.at(i + 1));
+    nodes.at(i + 1).pBacks.push_back(&nodes.at(i));
+  }
+
+  for(int f = 0; f < n_forks; f++)
+  {
+    int iFork = f * 40 + 20;
+    int iFirst = n_main + f * fork_length;
+    nodes.at(iFork).pFronts.push_back(&nodes.at(iFirst));
+    nodes.at(iFirst).pBacks.push_back(&nodes.at(iFork));
+    for(int k = 0; k + 1 < fork_length; k++)
+    {
+      nodes.at(iFirst + k).pFronts.push_back(&nodes.at(iFirst + k + 1));
+      nodes.at(iFirst + k + 1).pBacks.push_back(&nodes.at(iFirst + k));
+    }
+  }
+}
+
+// Two parallel lanes 3 meters apart, linked to each other at every point
+void CreateTwoLaneGraph(std::vector<WayPoint>& nodes, std::vector<Lane>& lanes, const int& n_points)
+{
+  lanes.clear();
+  lanes.resize(2);
+  lanes.at(0).id = 1;
+  lanes.at(1).id = 2;
+  nodes.clear();
+  nodes.resize(n_points * 2);
+  for(int l = 0; l < 2; l++)
+  {
+    for(int i = 0; i < n_points; i++)
+    {
+      WayPoint& wp = nodes.at(l * n_points + i);
+      wp = WayPoint(i, l * 3.0, 0, 0);
+      wp.id = l * n_points + i + 1;
+      wp.laneId = l + 1;
+      wp.pLane = &lanes.at(l);
+    }
+  }
+
+  for(int l = 0; l < 2; l++)
+  {
+    for(int i = 0; i < n_points; i++)
+    {
+      WayPoint& wp = nodes.at(l * n_points + i);
+      if(i + 1 < n_points)
+      {
+        wp.pFronts.push_back(&nodes.at(l * n_points + i + 1));
+        nodes.at(l * n_points + i + 1).pBacks.push_back(&wp);
+      }
+      if(l == 0)
+        wp.pLeft = &nodes.at(n_points + i);
+      else
+        wp.pRight = &nodes.at(i);
+    }
+  }
+}
+
+void GetPathIds(WayPoint* pGoal, WayPoint* pStart, std::vector<int>& ids)
+{
+  std::vector<WayPoint> path;
+  std::vector<std::vector<WayPoint> > temp_paths;
+  std::vector<int> global_path;
+  PlanningHelpers::TraversePathTreeBackwards(pGoal, pStart, global_path, path, temp_paths);
+  ids.clear();
+  for(unsigned int i = 0; i < path.size(); i++)
+    ids.push_back(path.at(i).id);
+}
+
+TEST(TestSuite, AStarMatchesDPOnForkedGraph)
+{
+  std::vector<WayPoint> graph;
+  CreateForkedGraph(graph, 800);
+  std::vector<int> global_path;
+  PlannerH planner;
+
+  // goals at the end of a few side chains and on the main chain
+  std::vector<int> goal_indices = {800 + 3 * 30 + 29, 800 + 12 * 30 + 29, 799, 500};
+  for(unsigned int g = 0; g < goal_indices.size(); g++)
+  {
+    WayPoint goal = graph.at(goal_indices.at(g));
+    std::vector<WayPoint*> dp_cells, astar_cells;
+
+    WayPoint* pDPGoal = PlanningHelpers::BuildPlanningSearchTreeV2(&graph.at(0), goal, global_path, 2000, false, dp_cells);
+    WayPoint* pAStarGoal = PlanningHelpers::BuildPlanningSearchTreeAStar(&graph.at(0), goal, global_path, 2000, false, astar_cells);
+    ASSERT_TRUE(pDPGoal != nullptr);
+    ASSERT_TRUE(pAStarGoal != nullptr);
+    ASSERT_EQ(pDPGoal->id, pAStarGoal->id);
+    ASSERT_NEAR(pDPGoal->cost, pAStarGoal->cost, 1e-9);
+    ASSERT_LE(astar_cells.size(), dp_cells.size());
+
+    std::vector<int> dp_ids, astar_ids;
+    GetPathIds(pDPGoal, &graph.at(0), dp_ids);
+    GetPathIds(pAStarGoal, &graph.at(0), astar_ids);
+    ASSERT_EQ(dp_ids, astar_ids);
+
+    std::cout << "Goal: " << goal.id << ", DP nodes: " << dp_cells.size() << ", A* nodes: " << astar_cells.size() << std::endl;
+    planner.DeleteWaypoints(dp_cells);
+    planner.DeleteWaypoints(astar_cells);
+  }
+}
+
+TEST(TestSuite, AStarLaneChangeReachesGoal)
+{
+  std::vector<WayPoint> graph;
+  std::vector<Lane> lanes;
+  CreateTwoLaneGraph(graph, lanes, 200);
+  std::vector<int> global_path;
+  WayPoint goal = graph.at(200 + 150);
+  std::vector<WayPoint*> astar_cells, dp_cells;
+  PlannerH planner;
+
+  WayPoint* pNoChange = PlanningHelpers::BuildPlanningSearchTreeAStar(&graph.at(0), goal, global_path, 400, false, astar_cells);
+  ASSERT_TRUE(pNoChange == nullptr);
+  planner.DeleteWaypoints(astar_cells);
+
+  WayPoint* pDPGoal = PlanningHelpers::BuildPlanningSearchTreeV2(&graph.at(0), goal, global_path, 400, true, dp_cells);
+  WayPoint* pAStarGoal = PlanningHelpers::BuildPlanningSearchTreeAStar(&graph.at(0), goal, global_path, 400, true, astar_cells);
+  ASSERT_TRUE(pDPGoal != nullptr);
+  ASSERT_TRUE(pAStarGoal != nullptr);
+  ASSERT_EQ(goal.id, pAStarGoal->id);
+  ASSERT_LE(pAStarGoal->cost, pDPGoal->cost + 1e-9);
+
+  planner.DeleteWaypoints(dp_cells);
+  planner.DeleteWaypoints(astar_cells);
+}
+
+TEST(TestSuite, AStarStopsAtDistanceLimit)
+{
+  std::vector<WayPoint> graph;
+  CreateForkedGraph(graph, 400);
+  std::vector<int> global_path;
+  WayPoint goal = graph.at(399);
+  std::vector<WayPoint*> astar_cells;
+  PlannerH planner;
+
+  // without a global path the node over the limit is returned, like the DP search
+  WayPoint* pLimit = PlanningHelpers::BuildPlanningSearchTreeAStar(&graph.at(0), goal, global_path, 100, false, astar_cells);
+  ASSERT_TRUE(pLimit != nullptr);
+  ASSERT_GT(pLimit->cost, 100);
+  ASSERT_LT(pLimit->cost, 102);
+  planner.DeleteWaypoints(astar_cells);
+
+  // goal off the graph, on the global path the closest node is used within the fall back threshold
+  std::vector<Lane> lanes;
+  CreateTwoLaneGraph(graph, lanes, 200);
+  goal = graph.at(199);
+  goal.pos.y = -1.5;
+  global_path.push_back(1);
+  ASSERT_TRUE(PlanningHelpers::BuildPlanningSearchTreeAStar(&graph.at(0), goal, global_path, 100, false, astar_cells) == nullptr);
+  planner.DeleteWaypoints(astar_cells);
+  WayPoint* pClose = PlanningHelpers::BuildPlanningSearchTreeAStar(&graph.at(0), goal, global_path, 100, false, astar_cells, 3.0);
+  ASSERT_TRUE(pClose != nullptr);
+  ASSERT_EQ(200, pClose->id);
+  planner.DeleteWaypoints(astar_cells);
+}
+
+TEST(TestSuite, MultiGoalMatchesSingleGoalSearches)
+{
+  std::vector<WayPoint> graph;
+  CreateForkedGraph(graph, 800);
+  std::vector<int> global_path;
+  PlannerH planner;
+
+  std::vector<int> goal_indices = {800 + 3 * 30 + 29, 800 + 12 * 30 + 29, 799, 500, 10};
+  std::vector<WayPoint> goals;
+  for(unsigned int g = 0; g < goal_indices.size(); g++)
+    goals.push_back(graph.at(goal_indices.at(g)));
+
+  std::vector<WayPoint*> multi_cells, goal_cells;
+  int n_reached = PlanningHelpers::BuildPlanningSearchTreeMultiGoal(&graph.at(0), goals, global_path, 2000, false, multi_cells, goal_cells);
+  ASSERT_EQ((int)goals.size(), n_reached);
+  ASSERT_EQ(goals.size(), goal_cells.size());
+
+  unsigned int n_single_cells = 0;
+  for(unsigned int g = 0; g < goals.size(); g++)
+  {
+    std::vector<WayPoint*> astar_cells;
+    WayPoint* pAStarGoal = PlanningHelpers::BuildPlanningSearchTreeAStar(&graph.at(0), goals.at(g), global_path, 2000, false, astar_cells);
+    ASSERT_TRUE(pAStarGoal != nullptr);
+    ASSERT_TRUE(goal_cells.at(g) != nullptr);
+    ASSERT_EQ(pAStarGoal->id, goal_cells.at(g)->id);
+    ASSERT_NEAR(pAStarGoal->cost, goal_cells.at(g)->cost, 1e-9);
+
+    std::vector<int> astar_ids, multi_ids;
+    GetPathIds(pAStarGoal, &graph.at(0), astar_ids);
+    GetPathIds(goal_cells.at(g), &graph.at(0), multi_ids);
+    ASSERT_EQ(astar_ids, multi_ids);
+    n_single_cells += astar_cells.size();
+    planner.DeleteWaypoints(astar_cells);
+  }
+
+  std::cout << "Goals: " << goals.size() << ", multi goal nodes: " << multi_cells.size() << ", single goal nodes: " << n_single_cells << std::endl;
+  planner.DeleteWaypoints(multi_cells);
+}
+
+TEST(TestSuite, MultiGoalStopsAtDistanceLimit)
+{
+  std::vector<WayPoint> graph;
+  std::vector<Lane> lanes;
+  CreateTwoLaneGraph(graph, lanes, 200);
+  std::vector<int> global_path;
+  PlannerH planner;
+
+  // a goal behind the limit and one on the other lane are not reached without lane change
+  std::vector<WayPoint> goals = {graph.at(50), graph.at(150), graph.at(200 + 60)};
+  std::vector<WayPoint*> cells, goal_cells;
+  ASSERT_EQ(1, PlanningHelpers::BuildPlanningSearchTreeMultiGoal(&graph.at(0), goals, global_path, 100, false, cells, goal_cells));
+  ASSERT_TRUE(goal_cells.at(0) != nullptr);
+  ASSERT_EQ(goals.at(0).id, goal_cells.at(0)->id);
+  ASSERT_TRUE(goal_cells.at(1) == nullptr);
+  ASSERT_TRUE(goal_cells.at(2) == nullptr);
+  planner.DeleteWaypoints(cells);
+
+  ASSERT_EQ(2, PlanningHelpers::BuildPlanningSearchTreeMultiGoal(&graph.at(0), goals, global_path, 100, true, cells, goal_cells));
+  ASSERT_TRUE(goal_cells.at(2) != nullptr);
+  ASSERT_EQ(goals.at(2).id, goal_cells.at(2)->id);
+  planner.DeleteWaypoints(cells);
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  ros::init(argc, argv, "TestNode");
+  return RUN_ALL_TESTS();
+}
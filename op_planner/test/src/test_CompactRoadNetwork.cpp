@@ -0,0 +1,297 @@
+/*
+ * Copyright 2020 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "op_planner/CompactRoadNetwork.h"
+#include "op_planner/MappingHelpers.h"
+
+using namespace PlannerHNS;
+
+#include <ros/ros.h>
+#include <gtest/gtest.h>
+#include <vector>
+#include <iostream>
+
+class TestSuite:
+  public ::testing::Test
+{
+public:
+  TestSuite() {}
+};
+
+// Two rows of chained lanes 3 meters apart, linked like a loaded vector map, with a few map items pointing to the lanes
+void CreateLinkedMap(RoadNetwork& map)
+{
+  RoadSegment segment;
+  segment.id = 1;
+  int point_id = 1;
+  for(int i = 0; i < 8; i++)
+  {
+    Lane l;
+    l.id = i + 1;
+    l.speed = 10 + i;
+    for(int p = 0; p < 20; p++)
+    {
+      WayPoint wp((i % 4) * 20 + p, (i / 4) * 3.0, 0.5, 0);
+      wp.id = point_id++;
+      wp.laneId = l.id;
+      wp.v = l.speed;
+      if(p == 0 && i == 2)
+        wp.actionCost.push_back(std::make_pair(LEFT_TURN_ACTION, 5.0));
+      l.points.push_back(wp);
+    }
+    if(i % 4 < 3) l.toIds.push_back(i + 2);
+    if(i % 4 > 0) l.fromIds.push_back(i);
+    segment.Lanes.push_back(l);
+  }
+  map.roadSegments.push_back(segment);
+
+  MappingHelpers::LinkLanesPointers(map);
+  MappingHelpers::LinkMissingBranchingWayPointsV2(map);
+  MappingHelpers::FindAdjacentLanesV2(map, 1);
+
+  std::vector<Lane>& lanes = map.roadSegments.at(0).Lanes;
+  TrafficLight tl;
+  tl.id = 3;
+  tl.pos = GPSPoint(30, 1, 0, 0.5);
+  tl.laneIds.push_back(lanes.at(1).id);
+  tl.pLanes.push_back(&lanes.at(1));
+  map.trafficLights.push_back(tl);
+  lanes.at(1).trafficlights.push_back(tl);
+
+  StopLine sl;
+  sl.id = 4;
+  sl.laneId = lanes.at(1).id;
+  sl.pLane = &lanes.at(1);
+  sl.trafficLightID = tl.id;
+  sl.points.push_back(GPSPoint(38, -1, 0, 0));
+  sl.points.push_back(GPSPoint(38, 1, 0, 0));
+  map.stopLines.push_back(sl);
+  lanes.at(1).stopLines.push_back(sl);
+  lanes.at(1).points.at(18).stopLineID = sl.id;
+
+  Curb c;
+  c.id = 5;
+  c.pLane = &lanes.at(5);
+  c.points.push_back(GPSPoint(25, 5, 0, 0));
+  map.curbs.push_back(c);
+
+  Boundary b;
+  b.id = 6;
+  b.pSegment = &map.roadSegments.at(0);
+  b.points.push_back(GPSPoint(0, 0, 0, 0));
+  b.points.push_back(GPSPoint(80, 0, 0, 0));
+  b.points.push_back(GPSPoint(80, 5, 0, 0));
+  map.boundaries.push_back(b);
+
+  TrafficSign ts;
+  ts.id = 7;
+  ts.signType = MAX_SPEED_SIGN;
+  ts.value = 40;
+  ts.strValue = "max 40";
+  ts.pLane = &lanes.at(6);
+  map.signs.push_back(ts);
+}
+
+int GetPointIndex(const RoadNetwork& map, const WayPoint* pWP)
+{
+  if(pWP == nullptr) return -1;
+  int index = 0;
+  for(unsigned int i = 0; i < map.roadSegments.at(0).Lanes.size(); i++)
+  {
+    const std::vector<WayPoint>& points = map.roadSegments.at(0).Lanes.at(i).points;
+    if(points.size() > 0 && pWP >= &points.front() && pWP <= &points.back())
+      return index + (pWP - &points.front());
+    index += points.size();
+  }
+  return -2; // not in this map
+}
+
+int GetLaneIndex(const RoadNetwork& map, const Lane* pL)
+{
+  if(pL == nullptr) return -1;
+  const std::vector<Lane>& lanes = map.roadSegments.at(0).Lanes;
+  if(pL >= &lanes.front() && pL <= &lanes.back())
+    return pL - &lanes.front();
+  return -2;
+}
+
+TEST(TestSuite, ExpandKeepsDataAndLinks)
+{
+  RoadNetwork map, expanded_map;
+  CreateLinkedMap(map);
+  map.roadSegments.at(0).Lanes.at(3).points.at(2).pos.lat = 35.5;
+  map.roadSegments.at(0).Lanes.at(3).points.at(2).laneChangeCost = 7;
+  map.roadSegments.at(0).Lanes.at(4).points.at(1).iOriginalIndex = 9;
+
+  CompactRoadNetwork compact;
+  compact.Build(map);
+  ASSERT_EQ(160, compact.GetNumberOfPoints());
+  ASSERT_EQ(8, compact.GetNumberOfLanes());
+  compact.Expand(expanded_map);
+  ASSERT_NE(0UL, expanded_map.version);
+  ASSERT_TRUE(expanded_map.spatialIndex.IsBuilt());
+
+  const std::vector<Lane>& lanes = map.roadSegments.at(0).Lanes;
+  const std::vector<Lane>& expanded_lanes = expanded_map.roadSegments.at(0).Lanes;
+  ASSERT_EQ(lanes.size(), expanded_lanes.size());
+  int n_fronts = 0, n_sides = 0;
+  for(unsigned int i = 0; i < lanes.size(); i++)
+  {
+    const Lane& l = lanes.at(i);
+    const Lane& el = expanded_lanes.at(i);
+    ASSERT_EQ(l.id, el.id);
+    ASSERT_EQ(l.toIds, el.toIds);
+    ASSERT_DOUBLE_EQ(l.speed, el.speed);
+    ASSERT_EQ(l.pRoad == nullptr, el.pRoad == nullptr);
+    ASSERT_EQ(l.toLanes.size(), el.toLanes.size());
+    for(unsigned int j = 0; j < l.toLanes.size(); j++)
+      ASSERT_EQ(GetLaneIndex(map, l.toLanes.at(j)), GetLaneIndex(expanded_map, el.toLanes.at(j)));
+    ASSERT_EQ(GetLaneIndex(map, l.pLeftLane), GetLaneIndex(expanded_map, el.pLeftLane));
+    ASSERT_EQ(GetLaneIndex(map, l.pRightLane), GetLaneIndex(expanded_map, el.pRightLane));
+
+    ASSERT_EQ(l.points.size(), el.points.size());
+    for(unsigned int p = 0; p < l.points.size(); p++)
+    {
+      const WayPoint& wp = l.points.at(p);
+      const WayPoint& ewp = el.points.at(p);
+      ASSERT_EQ(wp.id, ewp.id);
+      ASSERT_EQ(wp.laneId, ewp.laneId);
+      ASSERT_EQ(wp.pos.x, ewp.pos.x);
+      ASSERT_EQ(wp.pos.y, ewp.pos.y);
+      ASSERT_EQ(wp.pos.z, ewp.pos.z);
+      ASSERT_EQ(wp.pos.a, ewp.pos.a);
+      ASSERT_EQ(wp.pos.lat, ewp.pos.lat);
+      ASSERT_EQ(wp.pos.dir, ewp.pos.dir);
+      ASSERT_EQ(wp.v, ewp.v);
+      ASSERT_EQ(wp.laneChangeCost, ewp.laneChangeCost);
+      ASSERT_EQ(wp.iOriginalIndex, ewp.iOriginalIndex);
+      ASSERT_EQ(wp.stopLineID, ewp.stopLineID);
+      ASSERT_EQ(wp.LeftLnId, ewp.LeftLnId);
+      ASSERT_EQ(wp.RightPointId, ewp.RightPointId);
+      ASSERT_EQ(wp.toIds, ewp.toIds);
+      ASSERT_EQ(wp.fromIds, ewp.fromIds);
+      ASSERT_EQ(wp.actionCost, ewp.actionCost);
+      ASSERT_EQ(&el, ewp.pLane);
+      ASSERT_EQ(GetPointIndex(map, wp.pLeft), GetPointIndex(expanded_map, ewp.pLeft));
+      ASSERT_EQ(GetPointIndex(map, wp.pRight), GetPointIndex(expanded_map, ewp.pRight));
+      ASSERT_EQ(wp.pFronts.size(), ewp.pFronts.size());
+      for(unsigned int j = 0; j < wp.pFronts.size(); j++)
+        ASSERT_EQ(GetPointIndex(map, wp.pFronts.at(j)), GetPointIndex(expanded_map, ewp.pFronts.at(j)));
+      ASSERT_EQ(wp.pBacks.size(), ewp.pBacks.size());
+      for(unsigned int j = 0; j < wp.pBacks.size(); j++)
+        ASSERT_EQ(GetPointIndex(map, wp.pBacks.at(j)), GetPointIndex(expanded_map, ewp.pBacks.at(j)));
+      n_fronts += wp.pFronts.size();
+      if(wp.pLeft != nullptr) n_sides++;
+    }
+  }
+  ASSERT_GT(n_fronts, 0);
+  ASSERT_GT(n_sides, 0);
+
+  ASSERT_EQ(&expanded_lanes.at(1), expanded_map.trafficLights.at(0).pLanes.at(0));
+  ASSERT_EQ(&expanded_lanes.at(1), expanded_lanes.at(1).stopLines.at(0).pLane);
+  ASSERT_EQ(&expanded_lanes.at(1), expanded_map.stopLines.at(0).pLane);
+  ASSERT_EQ(&expanded_lanes.at(5), expanded_map.curbs.at(0).pLane);
+  ASSERT_EQ(&expanded_map.roadSegments.at(0), expanded_map.boundaries.at(0).pSegment);
+  ASSERT_EQ("max 40", expanded_map.signs.at(0).strValue);
+  ASSERT_EQ(&expanded_lanes.at(6), expanded_map.signs.at(0).pLane);
+}
+
+TEST(TestSuite, OverlayCreatesNodesOnDemand)
+{
+  RoadNetwork map;
+  CreateLinkedMap(map);
+  CompactRoadNetwork compact;
+  compact.Build(map);
+
+  const WayPoint& map_wp = map.roadSegments.at(0).Lanes.at(0).points.at(19);
+  int iPoint = compact.FindPointIndex(map_wp.id);
+  ASSERT_EQ(19, iPoint);
+  ASSERT_EQ(0, compact.GetLaneIndexOfPoint(iPoint));
+  ASSERT_EQ(-1, compact.FindPointIndex(100000));
+
+  CompactSearchOverlay overlay(compact);
+  WayPoint* pNode = overlay.GetWayPoint(iPoint);
+  ASSERT_NE(nullptr, pNode);
+  ASSERT_EQ(1, overlay.GetNumberOfNodes());
+  ASSERT_EQ(pNode, overlay.GetWayPoint(iPoint));
+  ASSERT_EQ(map_wp.id, pNode->id);
+  ASSERT_EQ(map_wp.pLane->id, pNode->pLane->id);
+  ASSERT_EQ(0, pNode->pFronts.size());
+
+  overlay.LinkNeighbors(pNode);
+  ASSERT_EQ(map_wp.pFronts.size(), pNode->pFronts.size());
+  for(unsigned int j = 0; j < map_wp.pFronts.size(); j++)
+    ASSERT_EQ(map_wp.pFronts.at(j)->id, pNode->pFronts.at(j)->id);
+  ASSERT_EQ(map_wp.pLeft != nullptr, pNode->pLeft != nullptr);
+  if(map_wp.pLeft != nullptr)
+  {
+    ASSERT_EQ(map_wp.pLeft->id, pNode->pLeft->id);
+  }
+  ASSERT_GT(overlay.GetNumberOfNodes(), 1);
+  ASSERT_EQ(-1, overlay.GetPointIndex(&map_wp));
+
+  // the search fields of the nodes are not written back to the map
+  pNode->cost = 42;
+  WayPoint wp;
+  compact.GetWayPoint(iPoint, wp);
+  ASSERT_EQ(0, wp.cost);
+
+  overlay.Reset();
+  ASSERT_EQ(0, overlay.GetNumberOfNodes());
+  ASSERT_EQ(0, overlay.GetWayPoint(iPoint)->cost);
+  ASSERT_EQ(nullptr, overlay.GetWayPoint(-1));
+}
+
+TEST(TestSuite, CompactMapIsSmaller)
+{
+  RoadNetwork map;
+  RoadSegment segment;
+  segment.id = 1;
+  int point_id = 1;
+  for(int i = 0; i < 100; i++)
+  {
+    Lane l;
+    l.id = i + 1;
+    for(int p = 0; p < 500; p++)
+    {
+      WayPoint wp(p, i * 3.0, 0, 0);
+      wp.id = point_id++;
+      wp.laneId = l.id;
+      if(p > 0) wp.fromIds.push_back(wp.id - 1);
+      if(p < 499) wp.toIds.push_back(wp.id + 1);
+      l.points.push_back(wp);
+    }
+    segment.Lanes.push_back(l);
+  }
+  map.roadSegments.push_back(segment);
+  MappingHelpers::LinkLanesPointers(map);
+  MappingHelpers::LinkMissingBranchingWayPointsV2(map);
+  MappingHelpers::FindAdjacentLanesV2(map, 1);
+
+  CompactRoadNetwork compact;
+  compact.Build(map);
+  size_t map_bytes = CompactRoadNetwork::GetMemoryBytes(map);
+  size_t compact_bytes = compact.GetMemoryBytes();
+  std::cout << "50000 waypoints, RoadNetwork: " << map_bytes / 1024 << " KB, compact: " << compact_bytes / 1024 << " KB" << std::endl;
+  ASSERT_LT(compact_bytes * 3, map_bytes);
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  ros::init(argc, argv, "TestNode");
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,214 @@
+/*
+ * Copyright 2020 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "op_planner/PlanningHelpers.h"
+#include "op_planner/ContourCorridor.h"
+#include "op_planner/TrajectoryCosts.h"
+#include "op_planner/TrajectoryDynamicCosts.h"
+
+using namespace PlannerHNS;
+
+#include <ros/ros.h>
+#include <gtest/gtest.h>
+#include <vector>
+
+class TestSuite:
+  public ::testing::Test
+{
+public:
+  TestSuite() {}
+};
+
+PlanningParams CreateParams()
+{
+  PlanningParams params;
+  params.rollOutNumber = 6;
+  params.rollOutDensity = 0.5;
+  params.horizonDistance = 120;
+  params.minFollowingDistance = 35;
+  params.horizontalSafetyDistancel = 0.5;
+  params.verticalSafetyDistance = 0.5;
+  params.minSpeed = 0.2;
+  return params;
+}
+
+void CreateLane(const double& y_offset, const PlanningParams& params, std::vector<WayPoint>& center, std::vector<std::vector<WayPoint> >& rollOuts)
+{
+  center.clear();
+  for(int i = 0; i < 240; i++)
+    center.push_back(WayPoint(i * 0.5, y_offset + 6.0 * sin(i / 90.0), 0, 0));
+  PlanningHelpers::CalcAngleAndCost(center);
+
+  rollOuts.clear();
+  int central = params.rollOutNumber/2;
+  for(int it = 0; it <= params.rollOutNumber; it++)
+  {
+    double d = (it - central) * params.rollOutDensity;
+    std::vector<WayPoint> path;
+    for(unsigned int i = 0; i < center.size(); i++)
+      path.push_back(WayPoint(center.at(i).pos.x - d * sin(center.at(i).pos.a), center.at(i).pos.y + d * cos(center.at(i).pos.a), 0, center.at(i).pos.a));
+    rollOuts.push_back(path);
+  }
+}
+
+// Objects spread far around the lanes, every third one is static
+std::vector<DetectedObject> CreateObjects(const int& n_objects)
+{
+  std::vector<DetectedObject> objects;
+  for(int i = 0; i < n_objects; i++)
+  {
+    DetectedObject obj;
+    obj.id = i;
+    double x = -20 + fmod(i * 17.3, 160);
+    double y = 6.0 * sin(x / 45.0) + 30.0 * sin(i * 0.7);
+    obj.center = WayPoint(x, y, 0, 0);
+    obj.center.v = (i % 3 == 0) ? 0 : 2.0;
+    obj.w = 1.8;
+    obj.l = 4.0;
+    for(int k = 0; k < 16; k++)
+    {
+      double a = k * 2.0 * M_PI / 16.0;
+      obj.contour.push_back(GPSPoint(x + 2.0 * cos(a), y + 0.9 * sin(a), 0, 0));
+    }
+    objects.push_back(obj);
+  }
+  return objects;
+}
+
+void ExpectSameCosts(const std::vector<TrajectoryCost>& c1, const std::vector<TrajectoryCost>& c2)
+{
+  ASSERT_EQ(c1.size(), c2.size());
+  for(unsigned int i = 0; i < c1.size(); i++)
+  {
+    ASSERT_EQ(c1.at(i).cost, c2.at(i).cost);
+    ASSERT_EQ(c1.at(i).lateral_cost, c2.at(i).lateral_cost);
+    ASSERT_EQ(c1.at(i).longitudinal_cost, c2.at(i).longitudinal_cost);
+    ASSERT_EQ(c1.at(i).closest_obj_distance, c2.at(i).closest_obj_distance);
+    ASSERT_EQ(c1.at(i).closest_obj_velocity, c2.at(i).closest_obj_velocity);
+    ASSERT_EQ(c1.at(i).bBlocked, c2.at(i).bBlocked);
+  }
+}
+
+TEST(TestSuite, FilterKeepsSlowObjectsWhole)
+{
+  std::vector<WayPoint> path;
+  for(int i = 0; i < 100; i++)
+    path.push_back(WayPoint(i, 0, 0, 0));
+  PlanningHelpers::CalcAngleAndCost(path);
+
+  RelativeInfo car_info;
+  PlanningHelpers::GetRelativeInfo(path, WayPoint(20, 0, 0, 0), car_info);
+
+  ContourCorridor corridor;
+  corridor.AddPath(path, car_info, 5, 30, 3);
+  EXPECT_GT(corridor.GetNumberOfBoxes(), 0);
+  EXPECT_TRUE(corridor.IsInside(GPSPoint(30, 2, 0, 0)));
+  EXPECT_FALSE(corridor.IsInside(GPSPoint(30, 20, 0, 0)));
+  EXPECT_FALSE(corridor.IsInside(GPSPoint(80, 0, 0, 0)));
+  EXPECT_FALSE(corridor.IsInside(GPSPoint(5, 0, 0, 0)));
+
+  std::vector<WayPoint> contour;
+  WayPoint p;
+  // slow object, one point inside
+  p.id = 0; p.v = 0;
+  p.pos = GPSPoint(30, 20, 0, 0); contour.push_back(p);
+  p.pos = GPSPoint(30, 1, 0, 0); contour.push_back(p);
+  // moving object, one point inside
+  p.id = 1; p.v = 5;
+  p.pos = GPSPoint(40, 20, 0, 0); contour.push_back(p);
+  p.pos = GPSPoint(40, 1, 0, 0); contour.push_back(p);
+  // slow object, all outside
+  p.id = 2; p.v = 0;
+  p.pos = GPSPoint(30, -20, 0, 0); contour.push_back(p);
+  p.pos = GPSPoint(31, -20, 0, 0); contour.push_back(p);
+
+  std::vector<WayPoint> filtered;
+  EXPECT_EQ(corridor.Filter(contour, 0.2, filtered), 3);
+  ASSERT_EQ(filtered.size(), 3);
+  EXPECT_EQ(filtered.at(0).pos.y, 20);
+  EXPECT_EQ(filtered.at(1).pos.y, 1);
+  EXPECT_EQ(filtered.at(2).id, 1);
+  EXPECT_EQ(filtered.at(2).pos.y, 1);
+}
+
+TEST(TestSuite, TrajectoryCostsSameWithCorridor)
+{
+  PlanningParams params = CreateParams();
+  CAR_BASIC_INFO car_info;
+  VehicleState vehicle_state;
+  std::vector<std::vector<std::vector<WayPoint> > > rollOuts(3);
+  std::vector<std::vector<WayPoint> > totalPaths(3);
+  for(unsigned int il = 0; il < 3; il++)
+    CreateLane(il * 3.5, params, totalPaths.at(il), rollOuts.at(il));
+  std::vector<DetectedObject> objects = CreateObjects(40);
+
+  TrajectoryCosts full, culled;
+  full.m_bUseContourCorridor = false;
+  unsigned int n_culled = 0;
+  for(unsigned int i = 0; i < 240; i += 11)
+  {
+    TrajectoryCost best = full.DoOneStep(rollOuts, totalPaths, totalPaths.at(0).at(i), params.rollOutNumber/2, 0, params, car_info, vehicle_state, objects);
+    TrajectoryCost culled_best = culled.DoOneStep(rollOuts, totalPaths, totalPaths.at(0).at(i), params.rollOutNumber/2, 0, params, car_info, vehicle_state, objects);
+    ASSERT_EQ(best.index, culled_best.index);
+    ASSERT_EQ(best.lane_index, culled_best.lane_index);
+    ExpectSameCosts(full.m_TrajectoryCosts, culled.m_TrajectoryCosts);
+    EXPECT_EQ(full.m_nCulledContourPoints, 0);
+    n_culled += culled.m_nCulledContourPoints;
+  }
+  EXPECT_GT(n_culled, 0);
+}
+
+TEST(TestSuite, TrajectoryDynamicCostsSameWithCorridor)
+{
+  PlanningParams params = CreateParams();
+  CAR_BASIC_INFO car_info;
+  VehicleState vehicle_state;
+  std::vector<std::vector<std::vector<WayPoint> > > rollOuts(3);
+  std::vector<std::vector<WayPoint> > totalPaths(3);
+  for(unsigned int il = 0; il < 3; il++)
+    CreateLane(il * 3.5, params, totalPaths.at(il), rollOuts.at(il));
+  std::vector<DetectedObject> objects = CreateObjects(40);
+
+  TrajectoryDynamicCosts full, culled, full_static, culled_static;
+  full.m_bUseContourCorridor = false;
+  full_static.m_bUseContourCorridor = false;
+  unsigned int n_culled = 0, n_culled_static = 0;
+  for(unsigned int i = 0; i < 240; i += 11)
+  {
+    TrajectoryCost best = full.DoOneStep(rollOuts, totalPaths, totalPaths.at(0).at(i), params.rollOutNumber/2, 0, params, car_info, vehicle_state, objects);
+    TrajectoryCost culled_best = culled.DoOneStep(rollOuts, totalPaths, totalPaths.at(0).at(i), params.rollOutNumber/2, 0, params, car_info, vehicle_state, objects);
+    ASSERT_EQ(best.index, culled_best.index);
+    ASSERT_EQ(best.lane_index, culled_best.lane_index);
+    ExpectSameCosts(full.m_TrajectoryCosts, culled.m_TrajectoryCosts);
+    n_culled += culled.m_nCulledContourPoints;
+
+    best = full_static.DoOneStepStatic(rollOuts.at(1), totalPaths.at(1), totalPaths.at(1).at(i), params, car_info, vehicle_state, objects);
+    culled_best = culled_static.DoOneStepStatic(rollOuts.at(1), totalPaths.at(1), totalPaths.at(1).at(i), params, car_info, vehicle_state, objects);
+    ASSERT_EQ(best.index, culled_best.index);
+    ExpectSameCosts(full_static.m_TrajectoryCosts, culled_static.m_TrajectoryCosts);
+    n_culled_static += culled_static.m_nCulledContourPoints;
+  }
+  EXPECT_GT(n_culled, 0);
+  EXPECT_GT(n_culled_static, 0);
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  ros::init(argc, argv, "TestNode");
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,227 @@
+/*
+ * Copyright 2020 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "op_planner/DecisionMaker.h"
+#include "op_planner/PlanningHelpers.h"
+
+using namespace PlannerHNS;
+
+#include <ros/ros.h>
+#include <gtest/gtest.h>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+// every heap allocation of the test binary is counted while g_bCountAllocations is set. The replacements are kept
+// out of line, inlined into their callers the malloc() and free() inside them are reported by -Wmismatched-new-delete
+static std::atomic<bool> g_bCountAllocations(false);
+static std::atomic<long> g_nAllocations(0);
+
+__attribute__((noinline)) void* operator new(std::size_t size)
+{
+  if(g_bCountAllocations)
+    g_nAllocations++;
+
+  void* p = std::malloc(size == 0 ? 1 : size);
+  if(!p)
+    throw std::bad_alloc();
+  return p;
+}
+
+__attribute__((noinline)) void operator delete(void* p) noexcept
+{
+  std::free(p);
+}
+
+__attribute__((noinline)) void operator delete(void* p, std::size_t) noexcept
+{
+  std::free(p);
+}
+
+class TestSuite:
+  public ::testing::Test
+{
+public:
+  TestSuite() {}
+};
+
+// exposes the extracted total path of the last cycle
+class DecisionMakerCycle : public DecisionMaker
+{
+public:
+  const std::vector<std::vector<WayPoint> >& GetTotalPath() const { return m_TotalPath; }
+  const std::vector<std::vector<WayPoint> >& GetTotalOriginalPath() const { return m_TotalOriginalPath; }
+};
+
+void CreateStraightPath(Lane* pLane, const double& length, std::vector<WayPoint>& path)
+{
+  path.clear();
+  for(int i = 0; i <= length; i++)
+  {
+    WayPoint wp(i, 0, 0, 0);
+    wp.v = 5;
+    wp.laneId = 1;
+    wp.pLane = pLane;
+    path.push_back(wp);
+  }
+  PlanningHelpers::CalcAngleAndCost(path);
+}
+
+TEST(TestSuite, SteadyStateCycleWithoutAllocations)
+{
+  Lane lane;
+  lane.id = 1;
+  std::vector<WayPoint> global_path;
+  CreateStraightPath(&lane, 600, global_path);
+
+  PlanningParams params;
+  ControllerParams ctrl_params;
+  CAR_BASIC_INFO car_info;
+  car_info.max_deceleration = -3;
+  car_info.max_acceleration = 3;
+
+  DecisionMakerCycle decision_maker;
+  decision_maker.Init(ctrl_params, params, car_info);
+  decision_maker.SetNewGlobalPath(std::vector<std::vector<WayPoint> >(1, global_path));
+
+  decision_maker.m_RollOuts.clear();
+  for(int i = 0; i <= params.rollOutNumber; i++)
+  {
+    std::vector<WayPoint> roll_out;
+    CreateStraightPath(&lane, 300, roll_out);
+    decision_maker.m_RollOuts.push_back(roll_out);
+  }
+
+  TrajectoryCost tc;
+  tc.index = params.rollOutNumber/2;
+  tc.lane_index = 0;
+  tc.closest_obj_distance = 1000;
+  tc.closest_obj_velocity = 0;
+  tc.bBlocked = false;
+
+  VehicleState vehicle_state;
+  vehicle_state.speed = 3;
+  std::vector<TrafficLight> traffic_lights;
+
+  WayPoint pose(50, 0, 0, 0);
+  pose.v = vehicle_state.speed;
+
+  //warm up, the buffers reach their steady size
+  for(int i = 0; i < 20; i++)
+  {
+    pose.pos.x += 0.1;
+    decision_maker.DoOneStep(0.1, pose, vehicle_state, 1, traffic_lights, tc, false);
+  }
+
+  long nAllocations = 0;
+  for(int i = 0; i < 100; i++)
+  {
+    pose.pos.x += 0.1;
+    g_nAllocations = 0;
+    g_bCountAllocations = true;
+    BehaviorState beh = decision_maker.DoOneStep(0.1, pose, vehicle_state, 1, traffic_lights, tc, false);
+    g_bCountAllocations = false;
+    nAllocations += g_nAllocations;
+    ASSERT_FALSE(beh.bNewPlan);
+  }
+
+  ASSERT_EQ(nAllocations, 0);
+  ASSERT_EQ(decision_maker.GetTotalPath().size(), 1);
+  ASSERT_GT(decision_maker.GetTotalPath().at(0).size(), 2);
+  ASSERT_GT(decision_maker.m_Path.size(), 0);
+}
+
+TEST(TestSuite, ExtractPartWithBufferMatchesPlainExtraction)
+{
+  Lane lane;
+  std::vector<WayPoint> path;
+  CreateStraightPath(&lane, 200, path);
+  path.at(50).pos.y = 0.3;
+
+  std::vector<WayPoint> plain, reused, buffer;
+  WayPoint pose(60.2, 0.1, 0, 0);
+  PlanningHelpers::ExtractPartFromPointToDistanceDirectionFast(path, pose, 80, 0.5, plain);
+  for(int k = 0; k < 2; k++)
+    PlanningHelpers::ExtractPartFromPointToDistanceDirectionFast(path, pose, 80, 0.5, reused, buffer);
+
+  ASSERT_EQ(plain.size(), reused.size());
+  for(unsigned int i = 0; i < plain.size(); i++)
+  {
+    ASSERT_EQ(plain.at(i).pos.x, reused.at(i).pos.x);
+    ASSERT_EQ(plain.at(i).pos.y, reused.at(i).pos.y);
+    ASSERT_EQ(plain.at(i).cost, reused.at(i).cost);
+  }
+  ASSERT_LT(plain.at(0).pos.x, pose.pos.x - 9);
+  ASSERT_GT(plain.back().pos.x, pose.pos.x + 79);
+}
+
+TEST(TestSuite, UnchangedGlobalPathIsNotReplanned)
+{
+  Lane lane;
+  std::vector<std::vector<WayPoint> > global_paths(1);
+  CreateStraightPath(&lane, 300, global_paths.at(0));
+  const unsigned long long fingerprint = PlanningHelpers::GetPathFingerprint(global_paths);
+
+  std::vector<std::vector<WayPoint> > same_paths = global_paths;
+  ASSERT_EQ(PlanningHelpers::GetPathFingerprint(same_paths), fingerprint);
+  same_paths.at(0).at(150).laneId = 2;
+  ASSERT_NE(PlanningHelpers::GetPathFingerprint(same_paths), fingerprint);
+  same_paths = global_paths;
+  same_paths.at(0).at(160).pos.y = 0.5;
+  ASSERT_NE(PlanningHelpers::GetPathFingerprint(same_paths), fingerprint);
+  same_paths = global_paths;
+  same_paths.at(0).pop_back();
+  ASSERT_NE(PlanningHelpers::GetPathFingerprint(same_paths), fingerprint);
+
+  PlanningParams params;
+  ControllerParams ctrl_params;
+  CAR_BASIC_INFO car_info;
+  DecisionMakerCycle decision_maker;
+  decision_maker.Init(ctrl_params, params, car_info);
+  PreCalculatedConditions* pValues = decision_maker.m_pCurrentBehaviorState->GetCalcParams();
+
+  decision_maker.SetNewGlobalPath(global_paths, fingerprint);
+  ASSERT_TRUE(pValues->bNewGlobalPath);
+
+  //re-sent unchanged
+  pValues->bNewGlobalPath = false;
+  decision_maker.SetNewGlobalPath(global_paths, fingerprint);
+  ASSERT_FALSE(pValues->bNewGlobalPath);
+
+  //a speed between the sampled points doesn't change the fingerprint, the path without fingerprint is always taken
+  global_paths.at(0).at(9).v = 2;
+  ASSERT_EQ(PlanningHelpers::GetPathFingerprint(global_paths), fingerprint);
+  decision_maker.SetNewGlobalPath(global_paths);
+  ASSERT_TRUE(pValues->bNewGlobalPath);
+  ASSERT_EQ(decision_maker.GetTotalOriginalPath().at(0).at(9).v, 2);
+
+  pValues->bNewGlobalPath = false;
+  decision_maker.SetNewGlobalPath(global_paths);
+  ASSERT_TRUE(pValues->bNewGlobalPath);
+
+  //then the first path with a fingerprint is taken too
+  pValues->bNewGlobalPath = false;
+  decision_maker.SetNewGlobalPath(global_paths, fingerprint);
+  ASSERT_TRUE(pValues->bNewGlobalPath);
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  ros::init(argc, argv, "TestNode");
+  return RUN_ALL_TESTS();
+}
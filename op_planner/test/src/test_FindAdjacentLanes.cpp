@@ -0,0 +1,205 @@
+/*
+ * Copyright 2020 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "op_planner/MappingHelpers.h"
+#include "op_planner/PlanningHelpers.h"
+
+using namespace PlannerHNS;
+
+#include <ros/ros.h>
+#include <gtest/gtest.h>
+#include <vector>
+#include <iostream>
+
+class TestSuite:
+  public ::testing::Test
+{
+public:
+  TestSuite() {}
+};
+
+// Parallel lanes along x, 3 meters apart, each row split in lanes of different lengths so the points don't line up
+void CreateParallelLanesMap(const int& n_rows, const int& row_length, RoadNetwork& map)
+{
+  RoadSegment segment;
+  segment.id = 1;
+  int point_id = 1;
+  int lane_id = 1;
+  for(int r = 0; r < n_rows; r++)
+  {
+    int lane_length = 20 + r * 7;
+    for(int start = 0; start < row_length; start += lane_length)
+    {
+      Lane l;
+      l.id = lane_id++;
+      for(double x = start + r * 0.3; x < start + lane_length && x < row_length; x += 1.0)
+      {
+        WayPoint wp(x, r * 3.0 + 0.05 * sin(x / 10.0), 0, 0);
+        wp.id = point_id++;
+        wp.laneId = l.id;
+        l.points.push_back(wp);
+      }
+      if(l.points.size() > 1)
+        segment.Lanes.push_back(l);
+    }
+  }
+  map.roadSegments.push_back(segment);
+
+  for(unsigned int i = 0; i < map.roadSegments.at(0).Lanes.size(); i++)
+    PlanningHelpers::FixAngleOnly(map.roadSegments.at(0).Lanes.at(i).points);
+}
+
+// Concentric arcs 3 meters apart with different point spacings, the outer one driven the other way, and a lane crossing them
+void CreateCurvedLanesMap(RoadNetwork& map)
+{
+  RoadSegment segment;
+  segment.id = 1;
+  int point_id = 1;
+  for(int r = 0; r < 4; r++)
+  {
+    Lane l;
+    l.id = r + 1;
+    double radius = 30.0 + r * 3.0;
+    double step = (0.7 + r * 0.4) / radius;
+    for(double t = 0; t < M_PI; t += step)
+    {
+      double angle = r == 3 ? M_PI - t : t;
+      WayPoint wp(radius * cos(angle), radius * sin(angle), 0, 0);
+      wp.id = point_id++;
+      wp.laneId = l.id;
+      l.points.push_back(wp);
+    }
+    segment.Lanes.push_back(l);
+  }
+
+  Lane crossing;
+  crossing.id = 5;
+  for(double y = 0; y < 50; y += 1.0)
+  {
+    WayPoint wp(1.5, y, 0, 0);
+    wp.id = point_id++;
+    wp.laneId = crossing.id;
+    crossing.points.push_back(wp);
+  }
+  segment.Lanes.push_back(crossing);
+  map.roadSegments.push_back(segment);
+
+  for(unsigned int i = 0; i < map.roadSegments.at(0).Lanes.size(); i++)
+    PlanningHelpers::FixAngleOnly(map.roadSegments.at(0).Lanes.at(i).points);
+}
+
+int GetPointId(const WayPoint* pWP)
+{
+  if(pWP == nullptr) return -1;
+  return pWP->id;
+}
+
+int GetLaneId(const Lane* pL)
+{
+  if(pL == nullptr) return -1;
+  return pL->id;
+}
+
+// number of left links, the two maps have the same links
+int ExpectSameLinks(const RoadNetwork& map_1, const RoadNetwork& map_2)
+{
+  const std::vector<Lane>& lanes_1 = map_1.roadSegments.at(0).Lanes;
+  const std::vector<Lane>& lanes_2 = map_2.roadSegments.at(0).Lanes;
+  EXPECT_EQ(lanes_1.size(), lanes_2.size());
+  if(lanes_1.size() != lanes_2.size()) return 0;
+
+  int n_links = 0;
+  for(unsigned int i = 0; i < lanes_1.size(); i++)
+  {
+    EXPECT_EQ(GetLaneId(lanes_1.at(i).pLeftLane), GetLaneId(lanes_2.at(i).pLeftLane));
+    EXPECT_EQ(GetLaneId(lanes_1.at(i).pRightLane), GetLaneId(lanes_2.at(i).pRightLane));
+    for(unsigned int p = 0; p < lanes_1.at(i).points.size(); p++)
+    {
+      const WayPoint& wp_1 = lanes_1.at(i).points.at(p);
+      const WayPoint& wp_2 = lanes_2.at(i).points.at(p);
+      EXPECT_EQ(GetPointId(wp_1.pLeft), GetPointId(wp_2.pLeft));
+      EXPECT_EQ(GetPointId(wp_1.pRight), GetPointId(wp_2.pRight));
+      EXPECT_EQ(wp_1.LeftPointId, wp_2.LeftPointId);
+      EXPECT_EQ(wp_1.RightPointId, wp_2.RightPointId);
+      EXPECT_EQ(wp_1.LeftLnId, wp_2.LeftLnId);
+      EXPECT_EQ(wp_1.RightLnId, wp_2.RightLnId);
+      if(wp_1.pLeft != nullptr) n_links++;
+    }
+  }
+
+  return n_links;
+}
+
+TEST(TestSuite, ParallelLinksMatchSequentialLinks)
+{
+  RoadNetwork sequential_map, parallel_map;
+  CreateParallelLanesMap(4, 200, sequential_map);
+  CreateParallelLanesMap(4, 200, parallel_map);
+
+  MappingHelpers::FindAdjacentLanesV2(sequential_map, 1);
+  MappingHelpers::FindAdjacentLanesV2(parallel_map, 4);
+
+  ASSERT_GT(ExpectSameLinks(sequential_map, parallel_map), 0);
+}
+
+TEST(TestSuite, GridLinksMatchExhaustiveLinks)
+{
+  RoadNetwork exhaustive_map, grid_map;
+  CreateParallelLanesMap(6, 300, exhaustive_map);
+  CreateParallelLanesMap(6, 300, grid_map);
+  MappingHelpers::FindAdjacentLanesV2(exhaustive_map, 2, true);
+  MappingHelpers::FindAdjacentLanesV2(grid_map, 2);
+  ASSERT_GT(ExpectSameLinks(exhaustive_map, grid_map), 0);
+
+  RoadNetwork exhaustive_curved_map, grid_curved_map;
+  CreateCurvedLanesMap(exhaustive_curved_map);
+  CreateCurvedLanesMap(grid_curved_map);
+  MappingHelpers::FindAdjacentLanesV2(exhaustive_curved_map, 2, true);
+  MappingHelpers::FindAdjacentLanesV2(grid_curved_map, 2);
+  ASSERT_GT(ExpectSameLinks(exhaustive_curved_map, grid_curved_map), 0);
+
+  // the lane driven the other way is never adjacent
+  const Lane& outer = grid_curved_map.roadSegments.at(0).Lanes.at(3);
+  ASSERT_EQ(nullptr, outer.pLeftLane);
+  ASSERT_EQ(nullptr, outer.pRightLane);
+}
+
+TEST(TestSuite, LeftAndRightLanes)
+{
+  RoadNetwork map;
+  CreateParallelLanesMap(2, 20, map);
+  ASSERT_EQ(2, map.roadSegments.at(0).Lanes.size());
+
+  MappingHelpers::FindAdjacentLanesV2(map, 2);
+  const Lane& right_lane = map.roadSegments.at(0).Lanes.at(0);
+  const Lane& left_lane = map.roadSegments.at(0).Lanes.at(1);
+  ASSERT_EQ(left_lane.id, GetLaneId(right_lane.pLeftLane));
+  ASSERT_EQ(right_lane.id, GetLaneId(left_lane.pRightLane));
+  ASSERT_EQ(nullptr, right_lane.pRightLane);
+  ASSERT_EQ(nullptr, left_lane.pLeftLane);
+
+  const WayPoint& wp = right_lane.points.at(10);
+  ASSERT_NE(nullptr, wp.pLeft);
+  ASSERT_EQ(left_lane.id, wp.LeftLnId);
+  ASSERT_LT(fabs(wp.pLeft->pos.x - wp.pos.x), 1.0);
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  ros::init(argc, argv, "TestNode");
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,391 @@
+/*
+ * Copyright 2020 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "op_planner/KmlMapReader.h"
+#include "op_planner/MappingHelpers.h"
+
+using namespace PlannerHNS;
+
+#include <ros/ros.h>
+#include <gtest/gtest.h>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+#include <stdexcept>
+
+class TestSuite:
+  public ::testing::Test
+{
+public:
+  TestSuite() {}
+};
+
+// nLanes chained lanes of nPoints waypoints along x, lane i is y = 4*i. One stop line on the first lane, one traffic light.
+// bDocument puts the data folders in a Document, as the other layout GetHeadElement accepts
+void WriteKmlMap(const std::string& fileName, const int& nLanes, const int& nPoints, const bool& bDocument)
+{
+  std::ofstream f(fileName.c_str());
+  f << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n";
+  f << "<kml xmlns=\"http://www.opengis.net/kml/2.2\">\n";
+  f << "<Folder><name>OpenPlanner</name>\n";
+  if(bDocument)
+    f << "<Document><name>Map</name>\n";
+  else
+    f << "<Folder><name>Map</name>\n";
+
+  f << "<!-- lanes, then the road segment -->\n";
+  f << "<Folder><name>Lanes</name><visibility/>\n";
+  for(int l = 0; l < nLanes; l++)
+  {
+    int id = l + 1;
+    f << "<Folder>\n  <description>LID_" << id << "_RSID_1_NUM_0_From_" << (l > 0 ? "_" + std::to_string(id - 1) : "")
+        << "_To_" << (l < nLanes - 1 ? "_" + std::to_string(id + 1) : "") << "_Vel_10</description>\n";
+    f << "  <Placemark><name attr=\"a > b\">Lane</name><LineString><coordinates>\n";
+    for(int p = 0; p < nPoints; p++)
+      f << "    " << p * 0.5 << "," << l * 4.0 << "," << 0.25 << "\n";
+    f << "  </coordinates></LineString></Placemark>\n  <Folder><description>";
+    for(int p = 0; p < nPoints; p++)
+    {
+      int wp_id = l * nPoints + p + 1;
+      f << "WPID_" << wp_id << "_AC_" << (p % 3 == 0 ? "L" : "F") << "_" << p << "_From_"
+          << (p > 0 ? "_" + std::to_string(wp_id - 1) : "") << "_To_" << (p < nPoints - 1 ? "_" + std::to_string(wp_id + 1) : "")
+          << "_Lid_0_Rid_0_Vel_" << 5.5 << "_Dir_" << 0.125 << ",";
+    }
+    f << "</description></Folder>\n</Folder>\n";
+  }
+  f << "</Folder>\n";
+
+  f << "<Folder><name>RoadSegments</name><Placemark><description>RSID_1</description></Placemark></Folder>\n";
+  f << "<Folder><name>StopLines</name><Placemark><name>SLID_3_LnID_1_TSID_0_TLID_7</name><LineString><coordinates>"
+      << "10,-2,0 10,2,0</coordinates></LineString></Placemark></Folder>\n";
+  f << "<Folder><name>TrafficLights</name><Placemark><name>TLID_7_LnID_1_2</name><Point><coordinates>"
+      << "11,3,4</coordinates></Point></Placemark></Folder>\n";
+  f << "<Folder><name>TrafficSigns</name><Placemark><name>TSID_5_LnID_1_RdID_1_Type_2</name><LineString><coordinates>"
+      << "12,3,0</coordinates></LineString></Placemark></Folder>\n";
+  f << "<Folder><name>Markings</name><Placemark><name>MID_9_LnID_1_RdID_1</name><LineString><coordinates>"
+      << "5,5,0 4,4,0 6,6,0</coordinates></LineString></Placemark></Folder>\n";
+  // only the first folder of a name is read
+  f << "<Folder><name>StopLines</name><Placemark><name>SLID_4_LnID_1_TSID_0_TLID_0</name><LineString><coordinates>"
+      << "1,1,0 2,2,0</coordinates></LineString></Placemark></Folder>\n";
+
+  f << (bDocument ? "</Document>\n" : "</Folder>\n");
+  f << "</Folder>\n</kml>\n";
+}
+
+TEST(TestSuite, PrefixParsingMatchesMappingHelpers)
+{
+  const char* strs[] = {"LID_12_RSID_3_NUM_0_From_1_2_To_4_Vel_10", "WPID_7_AC_L_2.5_From_To_8_Lid_0_Rid_3_Vel_5.5_Dir_-0.25",
+      "TLID_7_LnID_1_2_3", "RSID_1", "LnID", "__5__", "Vel_1e2_Dir_"};
+  const char* prefixes[][2] = {{"LID", "RSID"}, {"From", "To"}, {"To", "Vel"}, {"Vel", ""}, {"LnID", ""}, {"RSID", "NUM"},
+      {"Dir", ""}, {"AC", "From"}, {"Missing", "To"}, {"Vel", "Dir"}};
+
+  for(unsigned int i = 0; i < sizeof(strs)/sizeof(strs[0]); i++)
+  {
+    std::string str = strs[i];
+    for(unsigned int j = 0; j < sizeof(prefixes)/sizeof(prefixes[0]); j++)
+    {
+      // the prefix is not found and its position ends past the string, both throw
+      bool bExpectedThrow = false;
+      try
+      {
+        MappingHelpers::GetIDsFromPrefix(str, prefixes[j][0], prefixes[j][1]);
+      }
+      catch(const std::out_of_range&)
+      {
+        bExpectedThrow = true;
+      }
+
+      std::vector<int> ids;
+      std::vector<double> nums;
+      if(bExpectedThrow)
+      {
+        EXPECT_THROW(KmlMapReader::GetIDsFromPrefix(str.c_str(), str.size(), prefixes[j][0], prefixes[j][1], ids), std::out_of_range);
+        EXPECT_THROW(KmlMapReader::GetDoubleFromPrefix(str.c_str(), str.size(), prefixes[j][0], prefixes[j][1], nums), std::out_of_range);
+        continue;
+      }
+
+      KmlMapReader::GetIDsFromPrefix(str.c_str(), str.size(), prefixes[j][0], prefixes[j][1], ids);
+      KmlMapReader::GetDoubleFromPrefix(str.c_str(), str.size(), prefixes[j][0], prefixes[j][1], nums);
+      EXPECT_EQ(MappingHelpers::GetIDsFromPrefix(str, prefixes[j][0], prefixes[j][1]), ids) << str << " " << prefixes[j][0];
+      EXPECT_EQ(MappingHelpers::GetDoubleFromPrefix(str, prefixes[j][0], prefixes[j][1]), nums) << str << " " << prefixes[j][0];
+
+      std::pair<ACTION_TYPE, double> action = KmlMapReader::GetActionPairFromPrefix(str.c_str(), str.size(), prefixes[j][0], prefixes[j][1]);
+      std::pair<ACTION_TYPE, double> expected = MappingHelpers::GetActionPairFromPrefix(str, prefixes[j][0], prefixes[j][1]);
+      EXPECT_EQ(expected.first, action.first);
+      EXPECT_EQ(expected.second, action.second);
+    }
+  }
+
+  std::vector<GPSPoint> points;
+  KmlMapReader::GetPointsData("1.5,2,3 4,5 6,7,8,9 ,1", points);
+  ASSERT_EQ(4, points.size());
+  EXPECT_EQ(1.5, points.at(0).x);
+  EXPECT_EQ(3, points.at(0).z);
+  EXPECT_EQ(5, points.at(1).lon);
+  EXPECT_EQ(0, points.at(1).alt);
+  EXPECT_EQ(8, points.at(2).z);
+  EXPECT_EQ(0, points.at(3).x);
+  EXPECT_EQ(1, points.at(3).y);
+}
+
+TEST(TestSuite, StreamingReaderReadsMapData)
+{
+  // more than one read buffer, so records cross the buffer ends
+  std::string file_name = "/tmp/test_kml_map_reader.kml";
+  int nLanes = 60, nPoints = 400;
+  for(int document = 0; document < 2; document++)
+  {
+    WriteKmlMap(file_name, nLanes, nPoints, document == 1);
+    std::ifstream size_check(file_name.c_str(), std::ios::binary | std::ios::ate);
+    ASSERT_GT((long)size_check.tellg(), (long)KML_READ_BUFFER_SIZE);
+
+    KmlMapReader reader;
+    ASSERT_TRUE(reader.ReadFile(file_name));
+    ASSERT_EQ(nLanes, reader.lanes.size());
+    ASSERT_EQ(1, reader.roadSegments.size());
+    ASSERT_EQ(1, reader.stopLines.size());
+    ASSERT_EQ(1, reader.trafficLights.size());
+    ASSERT_EQ(1, reader.signs.size());
+    ASSERT_EQ(1, reader.markings.size());
+
+    for(int l = 0; l < nLanes; l++)
+    {
+      const Lane& lane = reader.lanes.at(l);
+      ASSERT_EQ(l + 1, lane.id);
+      EXPECT_EQ(1, lane.roadId);
+      EXPECT_EQ(10, lane.speed);
+      EXPECT_EQ(l > 0 ? 1 : 0, lane.fromIds.size());
+      EXPECT_EQ(l < nLanes - 1 ? 1 : 0, lane.toIds.size());
+      ASSERT_EQ(nPoints, lane.points.size());
+      for(int p = 0; p < nPoints; p++)
+      {
+        const WayPoint& wp = lane.points.at(p);
+        ASSERT_EQ(l * nPoints + p + 1, wp.id);
+        ASSERT_EQ(l + 1, wp.laneId);
+        ASSERT_DOUBLE_EQ(p * 0.5, wp.pos.x);
+        ASSERT_DOUBLE_EQ(l * 4.0, wp.pos.y);
+        ASSERT_DOUBLE_EQ(0.25, wp.pos.z);
+        ASSERT_DOUBLE_EQ(5.5, wp.v);
+        ASSERT_DOUBLE_EQ(0.125, wp.pos.a);
+        ASSERT_EQ(1, wp.actionCost.size());
+        ASSERT_EQ(p % 3 == 0 ? LEFT_TURN_ACTION : FORWARD_ACTION, wp.actionCost.at(0).first);
+        ASSERT_DOUBLE_EQ(p, wp.actionCost.at(0).second);
+        ASSERT_EQ(p > 0 ? 1 : 0, wp.fromIds.size());
+        ASSERT_EQ(p < nPoints - 1 ? 1 : 0, wp.toIds.size());
+      }
+    }
+
+    EXPECT_EQ(3, reader.stopLines.at(0).id);
+    EXPECT_EQ(7, reader.stopLines.at(0).trafficLightID);
+    ASSERT_EQ(2, reader.stopLines.at(0).points.size());
+    EXPECT_EQ(7, reader.trafficLights.at(0).id);
+    EXPECT_EQ(2, reader.trafficLights.at(0).laneIds.size());
+    EXPECT_EQ(4, reader.trafficLights.at(0).pos.z);
+    EXPECT_EQ(MAX_SPEED_SIGN, reader.signs.at(0).signType);
+    EXPECT_EQ(5, reader.markings.at(0).center.x);
+    EXPECT_EQ(2, reader.markings.at(0).points.size());
+  }
+
+  std::remove(file_name.c_str());
+}
+
+TEST(TestSuite, StreamingLoadLinksMap)
+{
+  std::string file_name = "/tmp/test_kml_map_streaming.kml";
+  WriteKmlMap(file_name, 3, 50, false);
+
+  RoadNetwork map;
+  MappingHelpers::LoadKMLStreaming(file_name, map);
+  std::remove(file_name.c_str());
+
+  ASSERT_EQ(1, map.roadSegments.size());
+  ASSERT_EQ(3, map.roadSegments.at(0).Lanes.size());
+  EXPECT_GT(map.version, 0);
+
+  Lane& first = map.roadSegments.at(0).Lanes.at(0);
+  ASSERT_EQ(1, first.toLanes.size());
+  EXPECT_EQ(2, first.toLanes.at(0)->id);
+  ASSERT_EQ(1, first.stopLines.size());
+  EXPECT_EQ(&first, map.stopLines.at(0).pLane);
+  ASSERT_EQ(1, first.trafficlights.size());
+
+  int n_stop_points = 0;
+  for(unsigned int i = 0; i < first.points.size(); i++)
+  {
+    if(first.points.at(i).stopLineID == 3)
+    {
+      n_stop_points++;
+      EXPECT_NEAR(10, first.points.at(i).pos.x, 0.5);
+    }
+  }
+  EXPECT_EQ(1, n_stop_points);
+
+  // the last point of a lane continues on the first point of the next lane
+  WayPoint& last = first.points.back();
+  ASSERT_EQ(1, last.pFronts.size());
+  EXPECT_EQ(&map.roadSegments.at(0).Lanes.at(1).points.at(0), last.pFronts.at(0));
+
+  RoadNetwork missing;
+  MappingHelpers::LoadKMLStreaming("/tmp/no_such_map.kml", missing);
+  EXPECT_EQ(0, missing.roadSegments.size());
+}
+
+std::vector<int> LaneIds(const std::vector<Lane*>& lanes)
+{
+  std::vector<int> ids;
+  for(unsigned int i = 0; i < lanes.size(); i++)
+    ids.push_back(lanes.at(i) ? lanes.at(i)->id : -1);
+  return ids;
+}
+
+std::vector<int> WaypointIds(const std::vector<WayPoint*>& waypoints)
+{
+  std::vector<int> ids;
+  for(unsigned int i = 0; i < waypoints.size(); i++)
+    ids.push_back(waypoints.at(i) ? waypoints.at(i)->id : -1);
+  return ids;
+}
+
+void ExpectSamePoints(const std::vector<GPSPoint>& expected, const std::vector<GPSPoint>& points)
+{
+  ASSERT_EQ(expected.size(), points.size());
+  for(unsigned int i = 0; i < expected.size(); i++)
+  {
+    EXPECT_DOUBLE_EQ(expected.at(i).x, points.at(i).x);
+    EXPECT_DOUBLE_EQ(expected.at(i).y, points.at(i).y);
+    EXPECT_DOUBLE_EQ(expected.at(i).z, points.at(i).z);
+  }
+}
+
+// lanes, waypoints, their links by id, stop lines and traffic lights of two maps loaded from the same file
+void ExpectSameMap(const RoadNetwork& expected, const RoadNetwork& map)
+{
+  ASSERT_EQ(expected.roadSegments.size(), map.roadSegments.size());
+  for(unsigned int i = 0; i < expected.roadSegments.size(); i++)
+  {
+    const RoadSegment& expected_segment = expected.roadSegments.at(i);
+    const RoadSegment& segment = map.roadSegments.at(i);
+    EXPECT_EQ(expected_segment.id, segment.id);
+    ASSERT_EQ(expected_segment.Lanes.size(), segment.Lanes.size());
+    for(unsigned int j = 0; j < expected_segment.Lanes.size(); j++)
+    {
+      const Lane& expected_lane = expected_segment.Lanes.at(j);
+      const Lane& lane = segment.Lanes.at(j);
+      ASSERT_EQ(expected_lane.id, lane.id);
+      EXPECT_EQ(expected_lane.roadId, lane.roadId);
+      EXPECT_EQ(expected_lane.num, lane.num);
+      EXPECT_DOUBLE_EQ(expected_lane.speed, lane.speed);
+      EXPECT_EQ(expected_lane.fromIds, lane.fromIds);
+      EXPECT_EQ(expected_lane.toIds, lane.toIds);
+      EXPECT_EQ(LaneIds(expected_lane.fromLanes), LaneIds(lane.fromLanes));
+      EXPECT_EQ(LaneIds(expected_lane.toLanes), LaneIds(lane.toLanes));
+      EXPECT_EQ(expected_lane.stopLines.size(), lane.stopLines.size());
+      EXPECT_EQ(expected_lane.trafficlights.size(), lane.trafficlights.size());
+
+      ASSERT_EQ(expected_lane.points.size(), lane.points.size());
+      for(unsigned int k = 0; k < expected_lane.points.size(); k++)
+      {
+        const WayPoint& expected_wp = expected_lane.points.at(k);
+        const WayPoint& wp = lane.points.at(k);
+        ASSERT_EQ(expected_wp.id, wp.id);
+        EXPECT_EQ(expected_wp.laneId, wp.laneId);
+        EXPECT_DOUBLE_EQ(expected_wp.pos.x, wp.pos.x);
+        EXPECT_DOUBLE_EQ(expected_wp.pos.y, wp.pos.y);
+        EXPECT_DOUBLE_EQ(expected_wp.pos.z, wp.pos.z);
+        EXPECT_DOUBLE_EQ(expected_wp.pos.a, wp.pos.a);
+        EXPECT_DOUBLE_EQ(expected_wp.v, wp.v);
+        EXPECT_EQ(expected_wp.actionCost, wp.actionCost);
+        EXPECT_EQ(expected_wp.fromIds, wp.fromIds);
+        EXPECT_EQ(expected_wp.toIds, wp.toIds);
+        EXPECT_EQ(expected_wp.stopLineID, wp.stopLineID);
+        ASSERT_TRUE(wp.pLane != nullptr);
+        EXPECT_EQ(expected_wp.pLane->id, wp.pLane->id);
+        EXPECT_EQ(WaypointIds(expected_wp.pFronts), WaypointIds(wp.pFronts));
+        EXPECT_EQ(WaypointIds(expected_wp.pBacks), WaypointIds(wp.pBacks));
+      }
+    }
+  }
+
+  ASSERT_EQ(expected.stopLines.size(), map.stopLines.size());
+  for(unsigned int i = 0; i < expected.stopLines.size(); i++)
+  {
+    EXPECT_EQ(expected.stopLines.at(i).id, map.stopLines.at(i).id);
+    EXPECT_EQ(expected.stopLines.at(i).laneId, map.stopLines.at(i).laneId);
+    EXPECT_EQ(expected.stopLines.at(i).trafficLightID, map.stopLines.at(i).trafficLightID);
+    EXPECT_EQ(expected.stopLines.at(i).stopSignID, map.stopLines.at(i).stopSignID);
+    ExpectSamePoints(expected.stopLines.at(i).points, map.stopLines.at(i).points);
+    ASSERT_EQ(expected.stopLines.at(i).pLane == nullptr, map.stopLines.at(i).pLane == nullptr);
+    if(expected.stopLines.at(i).pLane)
+    {
+      EXPECT_EQ(expected.stopLines.at(i).pLane->id, map.stopLines.at(i).pLane->id);
+    }
+  }
+
+  ASSERT_EQ(expected.trafficLights.size(), map.trafficLights.size());
+  for(unsigned int i = 0; i < expected.trafficLights.size(); i++)
+  {
+    EXPECT_EQ(expected.trafficLights.at(i).id, map.trafficLights.at(i).id);
+    EXPECT_DOUBLE_EQ(expected.trafficLights.at(i).pos.x, map.trafficLights.at(i).pos.x);
+    EXPECT_DOUBLE_EQ(expected.trafficLights.at(i).pos.y, map.trafficLights.at(i).pos.y);
+    EXPECT_DOUBLE_EQ(expected.trafficLights.at(i).pos.z, map.trafficLights.at(i).pos.z);
+    EXPECT_EQ(expected.trafficLights.at(i).laneIds, map.trafficLights.at(i).laneIds);
+    EXPECT_EQ(LaneIds(expected.trafficLights.at(i).pLanes), LaneIds(map.trafficLights.at(i).pLanes));
+  }
+
+  ASSERT_EQ(expected.signs.size(), map.signs.size());
+  for(unsigned int i = 0; i < expected.signs.size(); i++)
+  {
+    EXPECT_EQ(expected.signs.at(i).id, map.signs.at(i).id);
+    EXPECT_EQ(expected.signs.at(i).signType, map.signs.at(i).signType);
+  }
+
+  ASSERT_EQ(expected.markings.size(), map.markings.size());
+  for(unsigned int i = 0; i < expected.markings.size(); i++)
+  {
+    EXPECT_EQ(expected.markings.at(i).id, map.markings.at(i).id);
+    ExpectSamePoints(expected.markings.at(i).points, map.markings.at(i).points);
+  }
+}
+
+TEST(TestSuite, StreamingLoadSameAsTinyXmlLoad)
+{
+  std::string file_name = "/tmp/test_kml_map_compare.kml";
+  for(int document = 0; document < 2; document++)
+  {
+    WriteKmlMap(file_name, 4, 60, document == 1);
+
+    RoadNetwork dom_map, streaming_map;
+    MappingHelpers::LoadKML(file_name, dom_map);
+    MappingHelpers::LoadKMLStreaming(file_name, streaming_map);
+    ASSERT_EQ(1, dom_map.roadSegments.size());
+    ASSERT_EQ(4, dom_map.roadSegments.at(0).Lanes.size());
+    ASSERT_EQ(1, dom_map.stopLines.size());
+    ASSERT_EQ(1, dom_map.trafficLights.size());
+
+    ExpectSameMap(dom_map, streaming_map);
+  }
+
+  std::remove(file_name.c_str());
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  ros::init(argc, argv, "TestNode");
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,325 @@
+/*
+ * Copyright 2020 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "op_planner/LaneContractionHierarchy.h"
+#include "op_planner/LaneGraph.h"
+#include "op_planner/PlannerH.h"
+#include "op_planner/PlanningHelpers.h"
+
+using namespace PlannerHNS;
+
+#include <ros/ros.h>
+#include <gtest/gtest.h>
+#include <vector>
+#include <queue>
+#include <map>
+#include <iostream>
+
+class TestSuite:
+  public ::testing::Test
+{
+public:
+  TestSuite() {}
+};
+
+// Grid of intersections with uneven spacing, every pair of neighbor intersections is linked by two one way lanes.
+// Lanes, waypoints and the toLanes / pFronts links are filled like the map loaders do.
+void CreateLaneGridMap(const int& n_rows, const int& n_cols, RoadNetwork& map)
+{
+  std::vector<double> xs(1, 0), ys(1, 0);
+  srand(3);
+  for(int c = 1; c < n_cols; c++)
+    xs.push_back(xs.back() + 20 + rand() % 30);
+  for(int r = 1; r < n_rows; r++)
+    ys.push_back(ys.back() + 20 + rand() % 30);
+
+  RoadSegment segment;
+  segment.id = 1;
+  map.roadSegments.push_back(segment);
+  std::vector<Lane>& lanes = map.roadSegments.at(0).Lanes;
+  std::vector<std::pair<int, int> > ends; // start and end intersection of each lane
+  int point_id = 1;
+  for(int r = 0; r < n_rows; r++)
+  {
+    for(int c = 0; c < n_cols; c++)
+    {
+      int dr[2] = {0, 1}, dc[2] = {1, 0};
+      for(int k = 0; k < 2; k++)
+      {
+        int r2 = r + dr[k], c2 = c + dc[k];
+        if(r2 >= n_rows || c2 >= n_cols) continue;
+
+        for(int dir = 0; dir < 2; dir++)
+        {
+          int i1 = r * n_cols + c, i2 = r2 * n_cols + c2;
+          if(dir == 1) std::swap(i1, i2);
+          GPSPoint p1(xs.at(i1 % n_cols), ys.at(i1 / n_cols), 0, 0), p2(xs.at(i2 % n_cols), ys.at(i2 / n_cols), 0, 0);
+
+          Lane l;
+          l.id = lanes.size() + 1;
+          double length = hypot(p2.y - p1.y, p2.x - p1.x);
+          for(double s = 0; s <= length + 0.001; s += 1.0)
+          {
+            double t = std::min(1.0, s / length);
+            WayPoint wp(p1.x + t * (p2.x - p1.x), p1.y + t * (p2.y - p1.y), 0, atan2(p2.y - p1.y, p2.x - p1.x));
+            wp.id = point_id++;
+            wp.laneId = l.id;
+            l.points.push_back(wp);
+          }
+          if(l.points.back().pos.x != p2.x || l.points.back().pos.y != p2.y)
+          {
+            WayPoint wp(p2.x, p2.y, 0, l.points.back().pos.a);
+            wp.id = point_id++;
+            wp.laneId = l.id;
+            l.points.push_back(wp);
+          }
+          lanes.push_back(l);
+          ends.push_back(std::make_pair(i1, i2));
+        }
+      }
+    }
+  }
+
+  for(unsigned int i = 0; i < lanes.size(); i++)
+  {
+    Lane* pL = &lanes.at(i);
+    for(unsigned int p = 0; p < pL->points.size(); p++)
+    {
+      pL->points.at(p).pLane = pL;
+      if(p + 1 < pL->points.size())
+      {
+        pL->points.at(p).pFronts.push_back(&pL->points.at(p + 1));
+        pL->points.at(p + 1).pBacks.push_back(&pL->points.at(p));
+      }
+    }
+
+    for(unsigned int j = 0; j < lanes.size(); j++)
+    {
+      // no u turns
+      if(ends.at(j).first != ends.at(i).second || ends.at(j).second == ends.at(i).first) continue;
+      pL->toLanes.push_back(&lanes.at(j));
+      lanes.at(j).fromLanes.push_back(pL);
+      pL->points.back().pFronts.push_back(&lanes.at(j).points.at(0));
+      lanes.at(j).points.at(0).pBacks.push_back(&pL->points.back());
+    }
+  }
+}
+
+double GetLaneLength(const Lane& l)
+{
+  double length = 0;
+  for(unsigned int p = 1; p < l.points.size(); p++)
+    length += hypot(l.points.at(p).pos.y - l.points.at(p-1).pos.y, l.points.at(p).pos.x - l.points.at(p-1).pos.x);
+  return length;
+}
+
+// Plain Dijkstra over the lane graph, same edge weights as the hierarchy
+double GetDijkstraCost(RoadNetwork& map, const int& start_id, const int& goal_id)
+{
+  std::vector<Lane>& lanes = map.roadSegments.at(0).Lanes;
+  std::map<int, double> dist;
+  std::priority_queue<std::pair<double, int>, std::vector<std::pair<double, int> >, std::greater<std::pair<double, int> > > queue;
+  dist[start_id] = 0;
+  queue.push(std::make_pair(0.0, start_id));
+  while(queue.size() > 0)
+  {
+    std::pair<double, int> item = queue.top();
+    queue.pop();
+    if(item.second == goal_id) return item.first;
+    if(item.first > dist[item.second]) continue;
+
+    Lane& l = lanes.at(item.second - 1);
+    double d = item.first + GetLaneLength(l);
+    for(unsigned int j = 0; j < l.toLanes.size(); j++)
+    {
+      int id = l.toLanes.at(j)->id;
+      if(dist.find(id) == dist.end() || d < dist[id])
+      {
+        dist[id] = d;
+        queue.push(std::make_pair(d, id));
+      }
+    }
+  }
+  return -1;
+}
+
+TEST(TestSuite, HierarchyRoutesMatchDijkstra)
+{
+  RoadNetwork map;
+  CreateLaneGridMap(12, 12, map);
+  std::vector<Lane>& lanes = map.roadSegments.at(0).Lanes;
+
+  struct timespec t;
+  UtilityHNS::UtilityH::GetTickCount(t);
+  LaneContractionHierarchy hierarchy;
+  hierarchy.Build(map);
+  double build_time = UtilityHNS::UtilityH::GetTimeDiffNow(t);
+  ASSERT_TRUE(hierarchy.IsBuiltFor(map));
+  ASSERT_EQ(lanes.size(), hierarchy.GetNumberOfLanes());
+  std::cout << "Lanes: " << lanes.size() << ", shortcuts: " << hierarchy.GetNumberOfShortcuts() << ", build: " << build_time * 1000.0 << " ms" << std::endl;
+
+  srand(11);
+  for(int q = 0; q < 300; q++)
+  {
+    int start_id = 1 + rand() % lanes.size();
+    int goal_id = 1 + rand() % lanes.size();
+    std::vector<int> route;
+    double cost = 0;
+    ASSERT_TRUE(hierarchy.GetLaneRoute(start_id, goal_id, route, cost));
+    ASSERT_NEAR(GetDijkstraCost(map, start_id, goal_id), cost, 1e-6);
+
+    // the route is connected and its length is the cost
+    ASSERT_EQ(start_id, route.front());
+    ASSERT_EQ(goal_id, route.back());
+    double route_length = 0;
+    for(unsigned int i = 0; i + 1 < route.size(); i++)
+    {
+      Lane& l = lanes.at(route.at(i) - 1);
+      bool bLinked = false;
+      for(unsigned int j = 0; j < l.toLanes.size(); j++)
+        bLinked |= l.toLanes.at(j)->id == route.at(i + 1);
+      ASSERT_TRUE(bLinked);
+      route_length += GetLaneLength(l);
+    }
+    ASSERT_NEAR(route_length, cost, 1e-6);
+  }
+
+  std::vector<int> route;
+  double cost = 0;
+  ASSERT_FALSE(hierarchy.GetLaneRoute(1, 100000, route, cost));
+}
+
+TEST(TestSuite, HierarchySaveAndLoad)
+{
+  RoadNetwork map;
+  CreateLaneGridMap(6, 8, map);
+  LaneContractionHierarchy hierarchy, loaded;
+  hierarchy.Build(map);
+  std::string file_name = "/tmp/test_lane_contraction_hierarchy.txt";
+  ASSERT_TRUE(hierarchy.SaveToFile(file_name));
+  ASSERT_TRUE(loaded.LoadFromFile(file_name, map));
+  ASSERT_EQ(hierarchy.GetNumberOfShortcuts(), loaded.GetNumberOfShortcuts());
+
+  int n_lanes = map.roadSegments.at(0).Lanes.size();
+  for(int start_id = 1; start_id <= n_lanes; start_id += 7)
+  {
+    for(int goal_id = 1; goal_id <= n_lanes; goal_id += 5)
+    {
+      std::vector<int> route, loaded_route;
+      double cost = 0, loaded_cost = 0;
+      ASSERT_TRUE(hierarchy.GetLaneRoute(start_id, goal_id, route, cost));
+      ASSERT_TRUE(loaded.GetLaneRoute(start_id, goal_id, loaded_route, loaded_cost));
+      ASSERT_EQ(route, loaded_route);
+      ASSERT_DOUBLE_EQ(cost, loaded_cost);
+    }
+  }
+
+  // a different map is refused
+  RoadNetwork other_map;
+  CreateLaneGridMap(6, 9, other_map);
+  ASSERT_FALSE(loaded.LoadFromFile(file_name, other_map));
+  ASSERT_FALSE(loaded.IsBuilt());
+  ASSERT_FALSE(loaded.LoadFromFile("/tmp/not_existing_hierarchy_file.txt", map));
+}
+
+TEST(TestSuite, PlannerUsesHierarchyRoute)
+{
+  RoadNetwork map;
+  CreateLaneGridMap(5, 5, map);
+  std::vector<int> global_path;
+  std::vector<std::vector<WayPoint> > paths, hierarchy_paths;
+  const Lane& start_lane = map.roadSegments.at(0).Lanes.at(0);
+  const Lane& goal_lane = map.roadSegments.at(0).Lanes.back();
+  WayPoint start = start_lane.points.at(3);
+  WayPoint goal = goal_lane.points.at(goal_lane.points.size() / 2);
+
+  PlannerH planner;
+  double distance = planner.PlanUsingDP(start, goal, 100000, false, global_path, map, paths);
+  planner.m_LaneHierarchy.Build(map);
+  double hierarchy_distance = planner.PlanUsingDP(start, goal, 100000, false, global_path, map, hierarchy_paths);
+
+  ASSERT_GT(distance, 0);
+  ASSERT_NEAR(distance, hierarchy_distance, 1e-6);
+  ASSERT_GT(hierarchy_paths.size(), 0);
+  ASSERT_EQ(goal.id, hierarchy_paths.at(0).back().id);
+}
+
+TEST(TestSuite, LaneGraphRoutesMatchHierarchy)
+{
+  RoadNetwork map;
+  CreateLaneGridMap(8, 8, map);
+  map.version = 1;
+  LaneContractionHierarchy hierarchy;
+  hierarchy.Build(map);
+  LaneGraph graph;
+  graph.Build(map);
+  ASSERT_TRUE(graph.IsBuiltFor(map));
+  ASSERT_EQ(map.roadSegments.at(0).Lanes.size(), graph.GetNumberOfLanes());
+
+  const std::vector<Lane>& lanes = map.roadSegments.at(0).Lanes;
+  srand(11);
+  for(int q = 0; q < 100; q++)
+  {
+    int start_id = lanes.at(rand() % lanes.size()).id;
+    int goal_id = lanes.at(rand() % lanes.size()).id;
+    std::vector<int> route, hierarchy_route;
+    double cost = 0, hierarchy_cost = 0;
+    bool bFound = graph.GetLaneRoute(start_id, goal_id, route, cost);
+    ASSERT_EQ(hierarchy.GetLaneRoute(start_id, goal_id, hierarchy_route, hierarchy_cost), bFound);
+    if(!bFound) continue;
+
+    ASSERT_NEAR(hierarchy_cost, cost, 1e-6);
+    ASSERT_EQ(start_id, route.front());
+    ASSERT_EQ(goal_id, route.back());
+    double route_length = 0;
+    for(unsigned int i = 0; i + 1 < route.size(); i++)
+      route_length += graph.GetLaneLength(route.at(i));
+    ASSERT_NEAR(cost, route_length, 1e-6);
+  }
+
+  map.version = 2;
+  ASSERT_FALSE(graph.IsBuiltFor(map));
+}
+
+TEST(TestSuite, PlannerUsesLaneGraphRoute)
+{
+  RoadNetwork map;
+  CreateLaneGridMap(5, 5, map);
+  std::vector<int> global_path;
+  std::vector<std::vector<WayPoint> > paths, graph_paths;
+  const Lane& start_lane = map.roadSegments.at(0).Lanes.at(0);
+  const Lane& goal_lane = map.roadSegments.at(0).Lanes.back();
+  WayPoint start = start_lane.points.at(3);
+  WayPoint goal = goal_lane.points.at(goal_lane.points.size() / 2);
+
+  PlannerH planner;
+  double distance = planner.PlanUsingDP(start, goal, 100000, false, global_path, map, paths);
+  planner.m_bLaneGraphRouting = true;
+  double graph_distance = planner.PlanUsingDP(start, goal, 100000, false, global_path, map, graph_paths);
+
+  ASSERT_TRUE(planner.m_LaneGraph.IsBuilt());
+  ASSERT_GT(distance, 0);
+  ASSERT_NEAR(distance, graph_distance, 1e-6);
+  ASSERT_GT(graph_paths.size(), 0);
+  ASSERT_EQ(goal.id, graph_paths.at(0).back().id);
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  ros::init(argc, argv, "TestNode");
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,227 @@
+/*
+ * Copyright 2020 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "op_planner/LaneTracker.h"
+#include "op_planner/MappingHelpers.h"
+#include "op_planner/PlanningHelpers.h"
+
+using namespace PlannerHNS;
+
+#include <ros/ros.h>
+#include <gtest/gtest.h>
+#include <cmath>
+#include <vector>
+
+class TestSuite:
+  public ::testing::Test
+{
+public:
+  TestSuite() {}
+};
+
+// n_rows parallel rows 3.5 meters apart along x, each made of n_parts lanes of 50 meters one after the other,
+// crossed by vertical lanes every 50 meters
+void CreateRowsMap(const int& n_rows, const int& n_parts, RoadNetwork& map)
+{
+  RoadSegment segment;
+  segment.id = 1;
+  int point_id = 1;
+  for(int r = 0; r < n_rows; r++)
+  {
+    for(int k = 0; k < n_parts; k++)
+    {
+      Lane l;
+      l.id = r * n_parts + k + 1;
+      l.width = 3.5;
+      for(double s = k * 50.0; s <= (k + 1) * 50.0; s += 1.0)
+      {
+        WayPoint wp(s, r * 3.5, 0, 0);
+        wp.id = point_id++;
+        wp.laneId = l.id;
+        l.points.push_back(wp);
+      }
+      segment.Lanes.push_back(l);
+    }
+  }
+
+  for(int k = 0; k < n_parts; k++)
+  {
+    Lane l;
+    l.id = n_rows * n_parts + k + 1;
+    l.width = 3.5;
+    for(double s = -10; s <= n_rows * 3.5 + 10; s += 1.0)
+    {
+      WayPoint wp(k * 50.0 + 25.0, s, 0, M_PI_2);
+      wp.id = point_id++;
+      wp.laneId = l.id;
+      l.points.push_back(wp);
+    }
+    segment.Lanes.push_back(l);
+  }
+
+  map.roadSegments.push_back(segment);
+  std::vector<Lane>& lanes = map.roadSegments.at(0).Lanes;
+  for(unsigned int i = 0; i < lanes.size(); i++)
+  {
+    for(unsigned int j = 0; j < lanes.at(i).points.size(); j++)
+      lanes.at(i).points.at(j).pLane = &lanes.at(i);
+  }
+
+  for(int r = 0; r < n_rows; r++)
+  {
+    for(int k = 0; k < n_parts; k++)
+    {
+      Lane& l = lanes.at(r * n_parts + k);
+      if(k + 1 < n_parts)
+        l.toLanes.push_back(&lanes.at(r * n_parts + k + 1));
+      if(r + 1 < n_rows)
+        l.pLeftLane = &lanes.at((r + 1) * n_parts + k);
+      if(r > 0)
+        l.pRightLane = &lanes.at((r - 1) * n_parts + k);
+    }
+  }
+  map.spatialIndex.Build(map.roadSegments);
+}
+
+// lane id of the row lane under a point of the car on the rows map
+int ExpectedLaneId(const WayPoint& pos, const int& n_parts)
+{
+  int r = floor((pos.pos.y + 1.75) / 3.5);
+  int k = std::min((int)floor(pos.pos.x / 50.0), n_parts - 1);
+  return r * n_parts + k + 1;
+}
+
+TEST(TestSuite, FollowsTheLanesWithOneMapSearch)
+{
+  RoadNetwork map;
+  CreateRowsMap(3, 3, map);
+
+  LaneTracker tracker;
+  int nSteps = 0;
+  for(double x = 0.35; x < 149; x += 0.7)
+  {
+    //lane change from the first row to the second one between x = 60 and x = 80
+    double y = 0.3;
+    double a = 0;
+    if(x > 80)
+      y += 3.5;
+    else if(x > 60)
+    {
+      y += 3.5 * (x - 60) / 20.0;
+      a = atan2(3.5, 20.0);
+    }
+
+    WayPoint pos(x, y, 0, a);
+    const Lane* pL = tracker.GetCurrentLane(pos, map, 3.0);
+    nSteps++;
+    ASSERT_TRUE(pL != 0);
+    ASSERT_EQ(ExpectedLaneId(pos, 3), pL->id);
+
+    //the map search finds the same row, it can't tell apart the lanes one after the other on a row
+    Lane* pMapLane = MappingHelpers::GetClosestLaneFromMap(pos, map, 3.0);
+    ASSERT_TRUE(pMapLane != 0);
+    ASSERT_EQ(pMapLane->points.at(0).pos.y, pL->points.at(0).pos.y);
+    const RoadNetwork& const_map = map;
+    ASSERT_TRUE(MappingHelpers::GetClosestLaneFromMap(pos, const_map, 3.0) == pMapLane);
+  }
+
+  ASSERT_EQ(tracker.m_nFallbacks, 1);
+  ASSERT_EQ(tracker.m_nHits, nSteps - 1);
+}
+
+TEST(TestSuite, SearchesTheMapWhenTheCarJumps)
+{
+  RoadNetwork map;
+  CreateRowsMap(3, 3, map);
+
+  LaneTracker tracker;
+  ASSERT_EQ(tracker.GetCurrentLane(WayPoint(10, 0.2, 0, 0), map, 3.0)->id, 1);
+  ASSERT_EQ(tracker.GetCurrentLane(WayPoint(11, 0.2, 0, 0), map, 3.0)->id, 1);
+  ASSERT_EQ(tracker.m_nFallbacks, 1);
+
+  //two rows and two lanes away
+  ASSERT_EQ(tracker.GetCurrentLane(WayPoint(120, 7.1, 0, 0), map, 3.0)->id, 9);
+  ASSERT_EQ(tracker.m_nFallbacks, 2);
+
+  //on a crossing lane, the rows are in the wrong direction
+  ASSERT_EQ(tracker.GetCurrentLane(WayPoint(125.2, 7.5, 0, M_PI_2), map, 3.0)->id, 12);
+  ASSERT_EQ(tracker.m_nFallbacks, 3);
+
+  //off the map
+  ASSERT_TRUE(tracker.GetCurrentLane(WayPoint(300, 300, 0, 0), map, 3.0) == 0);
+  ASSERT_TRUE(tracker.GetLastLane() == 0);
+  ASSERT_EQ(tracker.m_nFallbacks, 4);
+
+  //another map starts from the map search
+  RoadNetwork other_map;
+  CreateRowsMap(3, 3, other_map);
+  tracker.GetCurrentLane(WayPoint(10, 0.2, 0, 0), map, 3.0);
+  ASSERT_EQ(tracker.m_nFallbacks, 5);
+  const Lane* pL = tracker.GetCurrentLane(WayPoint(10.5, 0.2, 0, 0), other_map, 3.0);
+  ASSERT_EQ(tracker.m_nFallbacks, 6);
+  ASSERT_EQ(pL, &other_map.roadSegments.at(0).Lanes.at(0));
+}
+
+TEST(TestSuite, StartsAgainWhenTheMapIsReloadedInPlace)
+{
+  RoadNetwork map;
+  CreateRowsMap(3, 3, map);
+  MappingHelpers::UpdateMapVersion(map);
+
+  LaneTracker tracker;
+  ASSERT_EQ(tracker.GetCurrentLane(WayPoint(10, 0.2, 0, 0), map, 3.0)->id, 1);
+  ASSERT_EQ(tracker.m_nFallbacks, 1);
+
+  //same address, the lanes are freed and allocated again, as when a node assigns the received map
+  map = RoadNetwork();
+  CreateRowsMap(3, 3, map);
+  MappingHelpers::UpdateMapVersion(map);
+  const Lane* pL = tracker.GetCurrentLane(WayPoint(10.5, 0.2, 0, 0), map, 3.0);
+  ASSERT_EQ(tracker.m_nFallbacks, 2);
+  ASSERT_EQ(pL, &map.roadSegments.at(0).Lanes.at(0));
+
+  ASSERT_EQ(tracker.GetCurrentLane(WayPoint(11, 0.2, 0, 0), map, 3.0), pL);
+  ASSERT_EQ(tracker.m_nFallbacks, 2);
+}
+
+TEST(TestSuite, KeepsTheSnapshotOfThePreviousLane)
+{
+  std::shared_ptr<RoadNetwork> pMap(new RoadNetwork());
+  CreateRowsMap(2, 2, *pMap);
+  RoadNetworkSnapshotPtr pSnapshot = pMap;
+  std::weak_ptr<const RoadNetwork> pWeak = pSnapshot;
+
+  LaneTracker tracker;
+  ASSERT_EQ(tracker.GetCurrentLane(WayPoint(10, 0.2, 0, 0), pSnapshot, 3.0)->id, 1);
+  pMap.reset();
+  pSnapshot.reset();
+  ASSERT_FALSE(pWeak.expired());
+
+  std::shared_ptr<RoadNetwork> pNewMap(new RoadNetwork());
+  CreateRowsMap(2, 2, *pNewMap);
+  RoadNetworkSnapshotPtr pNewSnapshot = pNewMap;
+  const Lane* pL = tracker.GetCurrentLane(WayPoint(10.5, 0.2, 0, 0), pNewSnapshot, 3.0);
+  ASSERT_EQ(pL, &pNewMap->roadSegments.at(0).Lanes.at(0));
+  ASSERT_EQ(tracker.m_nFallbacks, 2);
+  ASSERT_TRUE(pWeak.expired());
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  ros::init(argc, argv, "TestNode");
+  return RUN_ALL_TESTS();
+}
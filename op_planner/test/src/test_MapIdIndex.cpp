@@ -0,0 +1,184 @@
+/*
+ * Copyright 2020 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "op_planner/MappingHelpers.h"
+
+using namespace PlannerHNS;
+
+#include <ros/ros.h>
+#include <gtest/gtest.h>
+#include <vector>
+#include <cstdlib>
+
+class TestSuite:
+  public ::testing::Test
+{
+public:
+  TestSuite() {}
+};
+
+// Chain of lanes, each one linked to the next two by id, neighbor lanes share the left/right waypoint ids
+void CreateChainMap(const int& n_lanes, const int& n_points, RoadNetwork& map)
+{
+  RoadSegment segment;
+  segment.id = 1;
+  int point_id = 1;
+  for(int i = 0; i < n_lanes; i++)
+  {
+    Lane l;
+    l.id = i + 1;
+    for(int p = 0; p < n_points; p++)
+    {
+      WayPoint wp(i * n_points + p, (i % 2) * 3.0, 0, 0);
+      wp.id = point_id++;
+      wp.laneId = l.id;
+      l.points.push_back(wp);
+    }
+    if(i + 1 < n_lanes) l.toIds.push_back(i + 2);
+    if(i + 2 < n_lanes) l.toIds.push_back(i + 3);
+    if(i > 0) l.fromIds.push_back(i);
+    segment.Lanes.push_back(l);
+  }
+  map.roadSegments.push_back(segment);
+}
+
+TEST(TestSuite, IndexedLookupsMatchLinearScan)
+{
+  RoadNetwork map;
+  CreateChainMap(50, 40, map);
+  RoadNetwork plain_map = map;
+  map.idIndex.Build(map.roadSegments);
+  ASSERT_TRUE(map.idIndex.IsValid(map.roadSegments));
+  ASSERT_FALSE(plain_map.idIndex.IsValid(plain_map.roadSegments));
+
+  for(int id = -1; id < 53; id++)
+  {
+    Lane* pL = MappingHelpers::GetLaneById(id, map);
+    Lane* pPlainL = MappingHelpers::GetLaneById(id, plain_map);
+    ASSERT_EQ(pL == nullptr, pPlainL == nullptr);
+    if(pL)
+    {
+      ASSERT_EQ(pL - &map.roadSegments.at(0).Lanes.at(0), pPlainL - &plain_map.roadSegments.at(0).Lanes.at(0));
+    }
+  }
+
+  const WayPoint* pFirst = &map.roadSegments.at(0).Lanes.at(0).points.at(0);
+  for(int id = -1; id < 50 * 40 + 3; id += 7)
+  {
+    WayPoint* pWP = MappingHelpers::FindWaypoint(id, map);
+    WayPoint* pPlainWP = MappingHelpers::FindWaypoint(id, plain_map);
+    ASSERT_EQ(pWP == nullptr, pPlainWP == nullptr);
+    if(pWP)
+    {
+      ASSERT_EQ(id, pWP->id);
+    }
+
+    // waypoint of another lane only
+    ASSERT_TRUE(MappingHelpers::FindWaypointV2(id, pWP ? pWP->laneId : 0, map) == nullptr);
+    ASSERT_EQ(pWP, MappingHelpers::FindWaypointV2(id, -1, map));
+  }
+  ASSERT_EQ(pFirst, MappingHelpers::FindWaypoint(1, map));
+
+  // a changed lane list makes the index invalid, lookups still find the lanes
+  map.roadSegments.at(0).Lanes.pop_back();
+  ASSERT_FALSE(map.idIndex.IsValid(map.roadSegments));
+  ASSERT_EQ(&map.roadSegments.at(0).Lanes.at(10), MappingHelpers::GetLaneById(11, map));
+  ASSERT_TRUE(MappingHelpers::GetLaneById(50, map) == nullptr);
+}
+
+TEST(TestSuite, LinkLanesPointersUsesIds)
+{
+  RoadNetwork map;
+  CreateChainMap(30, 10, map);
+  MappingHelpers::LinkLanesPointers(map);
+  ASSERT_TRUE(map.idIndex.IsValid(map.roadSegments));
+
+  std::vector<Lane>& lanes = map.roadSegments.at(0).Lanes;
+  for(unsigned int i = 0; i < lanes.size(); i++)
+  {
+    ASSERT_EQ(lanes.at(i).toIds.size(), lanes.at(i).toLanes.size());
+    for(unsigned int j = 0; j < lanes.at(i).toLanes.size(); j++)
+      ASSERT_EQ(lanes.at(i).toIds.at(j), lanes.at(i).toLanes.at(j)->id);
+
+    ASSERT_EQ(lanes.at(i).fromIds.size(), lanes.at(i).fromLanes.size());
+    for(unsigned int j = 0; j < lanes.at(i).fromLanes.size(); j++)
+      ASSERT_EQ(lanes.at(i).fromIds.at(j), lanes.at(i).fromLanes.at(j)->id);
+
+    ASSERT_EQ(&lanes.at(i), lanes.at(i).points.at(0).pLane);
+  }
+}
+
+TEST(TestSuite, IdLookupSameAsLinearScan)
+{
+  RoadNetwork map;
+  CreateChainMap(400, 100, map);
+  RoadNetwork plain_map = map;
+  map.idIndex.Build(map.roadSegments);
+
+  for(int id = 1; id <= 400 * 100; id += 37)
+  {
+    ASSERT_EQ(MappingHelpers::FindWaypoint(id, plain_map)->laneId, MappingHelpers::FindWaypoint(id, map)->laneId);
+    ASSERT_EQ(MappingHelpers::GetLaneById(1 + id % 400, plain_map)->id, MappingHelpers::GetLaneById(1 + id % 400, map)->id);
+  }
+
+  // same lookups on a real Aisan vector map folder (with the trailing /), if one is given
+  const char* vector_map_path = std::getenv("OP_TEST_VECTOR_MAP_PATH");
+  if(vector_map_path)
+  {
+    RoadNetwork vector_map;
+    MappingHelpers::ConstructRoadNetworkFromDataFiles(vector_map_path, vector_map);
+    ASSERT_GT(vector_map.roadSegments.size(), 0);
+    vector_map.idIndex.Build(vector_map.roadSegments);
+
+    std::vector<int> lane_ids, waypoint_ids;
+    int n = 0;
+    for(unsigned int i = 0; i < vector_map.roadSegments.size(); i++)
+    {
+      for(unsigned int j = 0; j < vector_map.roadSegments.at(i).Lanes.size(); j++)
+      {
+        const Lane& l = vector_map.roadSegments.at(i).Lanes.at(j);
+        lane_ids.push_back(l.id);
+        for(unsigned int k = 0; k < l.points.size(); k++)
+        {
+          if(n++ % 37 == 0)
+            waypoint_ids.push_back(l.points.at(k).id);
+        }
+      }
+    }
+    ASSERT_GT(lane_ids.size(), 0);
+
+    std::vector<Lane*> indexed_lanes;
+    std::vector<WayPoint*> indexed_waypoints;
+    for(unsigned int i = 0; i < lane_ids.size(); i++)
+      indexed_lanes.push_back(MappingHelpers::GetLaneById(lane_ids.at(i), vector_map));
+    for(unsigned int i = 0; i < waypoint_ids.size(); i++)
+      indexed_waypoints.push_back(MappingHelpers::FindWaypoint(waypoint_ids.at(i), vector_map));
+
+    vector_map.idIndex.Clear();
+    ASSERT_FALSE(vector_map.idIndex.IsValid(vector_map.roadSegments));
+    for(unsigned int i = 0; i < lane_ids.size(); i++)
+      ASSERT_EQ(MappingHelpers::GetLaneById(lane_ids.at(i), vector_map), indexed_lanes.at(i));
+    for(unsigned int i = 0; i < waypoint_ids.size(); i++)
+      ASSERT_EQ(MappingHelpers::FindWaypoint(waypoint_ids.at(i), vector_map), indexed_waypoints.at(i));
+  }
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  ros::init(argc, argv, "TestNode");
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,170 @@
+/*
+ * Copyright 2020 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "op_planner/MappingHelpers.h"
+#include "op_planner/PlanningHelpers.h"
+
+using namespace PlannerHNS;
+
+#include <ros/ros.h>
+#include <gtest/gtest.h>
+#include <set>
+#include <vector>
+
+class TestSuite:
+  public ::testing::Test
+{
+public:
+  TestSuite() {}
+};
+
+// Grid of straight one way lanes, horizontal rows and vertical columns, 1 meter point density
+void CreateGridMap(const int& n_rows, const int& n_cols, const double& length, RoadNetwork& map)
+{
+  RoadSegment segment;
+  segment.id = 1;
+  int lane_id = 1;
+  int point_id = 1;
+  for(int r = 0; r < n_rows + n_cols; r++)
+  {
+    Lane l;
+    l.id = lane_id++;
+    bool bRow = r < n_rows;
+    double offset = bRow ? r * 3.5 : (r - n_rows) * 7.0;
+    for(double s = 0; s < length; s += 1.0)
+    {
+      WayPoint wp(bRow ? s : offset, bRow ? offset : s, 0, bRow ? 0 : M_PI_2);
+      wp.id = point_id++;
+      wp.laneId = l.id;
+      l.points.push_back(wp);
+    }
+    segment.Lanes.push_back(l);
+  }
+
+  map.roadSegments.push_back(segment);
+  for(unsigned int i = 0; i < map.roadSegments.at(0).Lanes.size(); i++)
+  {
+    Lane* pL = &map.roadSegments.at(0).Lanes.at(i);
+    for(unsigned int j = 0; j < pL->points.size(); j++)
+      pL->points.at(j).pLane = pL;
+  }
+}
+
+std::vector<WayPoint> CreateQueryPoints(const int& n, const double& max_x, const double& max_y)
+{
+  std::vector<WayPoint> queries;
+  srand(7);
+  for(int i = 0; i < n; i++)
+  {
+    double x = max_x * (double)rand() / RAND_MAX;
+    double y = max_y * (double)rand() / RAND_MAX;
+    double a = (i % 2 == 0) ? 0.1 : M_PI_2 - 0.1;
+    queries.push_back(WayPoint(x, y, 0, a));
+  }
+  return queries;
+}
+
+std::vector<int> LaneIds(const std::vector<Lane*>& lanes)
+{
+  std::vector<int> ids;
+  for(unsigned int i = 0; i < lanes.size(); i++)
+    ids.push_back(lanes.at(i)->id);
+  return ids;
+}
+
+TEST(TestSuite, SpatialIndexMatchesLinearScan)
+{
+  RoadNetwork map;
+  CreateGridMap(20, 20, 150, map);
+  std::vector<WayPoint> queries = CreateQueryPoints(200, 150, 150);
+
+  map.spatialIndex.Build(map.roadSegments);
+  ASSERT_TRUE(map.spatialIndex.IsBuilt());
+
+  std::vector<int> closest_indexed, closest_dir_indexed, closest_wp_indexed;
+  std::vector<std::vector<int> > lists_indexed, multiple_indexed, fast_indexed;
+  for(unsigned int i = 0; i < queries.size(); i++)
+  {
+    Lane* pL = MappingHelpers::GetClosestLaneFromMap(queries.at(i), map, 3.0);
+    closest_indexed.push_back(pL ? pL->id : -1);
+    pL = MappingHelpers::GetClosestLaneFromMapDirectionBased(queries.at(i), map, 3.0);
+    closest_dir_indexed.push_back(pL ? pL->id : -1);
+    WayPoint* pW = MappingHelpers::GetClosestWaypointFromMap(queries.at(i), map, false);
+    closest_wp_indexed.push_back(pW ? pW->id : -1);
+    lists_indexed.push_back(LaneIds(MappingHelpers::GetClosestLanesListFromMap(queries.at(i), map, 4.0, false)));
+    multiple_indexed.push_back(LaneIds(MappingHelpers::GetClosestMultipleLanesFromMap(queries.at(i), map, 4.0)));
+    fast_indexed.push_back(LaneIds(MappingHelpers::GetClosestLanesFast(queries.at(i), map, 4.0)));
+  }
+
+  map.spatialIndex.Clear();
+  ASSERT_FALSE(map.spatialIndex.IsBuilt());
+
+  for(unsigned int i = 0; i < queries.size(); i++)
+  {
+    Lane* pL = MappingHelpers::GetClosestLaneFromMap(queries.at(i), map, 3.0);
+    ASSERT_EQ(closest_indexed.at(i), pL ? pL->id : -1);
+    pL = MappingHelpers::GetClosestLaneFromMapDirectionBased(queries.at(i), map, 3.0);
+    ASSERT_EQ(closest_dir_indexed.at(i), pL ? pL->id : -1);
+    WayPoint* pW = MappingHelpers::GetClosestWaypointFromMap(queries.at(i), map, false);
+    ASSERT_EQ(closest_wp_indexed.at(i), pW ? pW->id : -1);
+    ASSERT_EQ(lists_indexed.at(i), LaneIds(MappingHelpers::GetClosestLanesListFromMap(queries.at(i), map, 4.0, false)));
+    ASSERT_EQ(multiple_indexed.at(i), LaneIds(MappingHelpers::GetClosestMultipleLanesFromMap(queries.at(i), map, 4.0)));
+    ASSERT_EQ(fast_indexed.at(i), LaneIds(MappingHelpers::GetClosestLanesFast(queries.at(i), map, 4.0)));
+  }
+}
+
+TEST(TestSuite, CellKeysAroundTheOrigin)
+{
+  MapSpatialIndex index;
+  std::set<long long> keys;
+  for(long long ix = -2; ix <= 2; ix++)
+    for(long long iy = -2; iy <= 2; iy++)
+      keys.insert(index.GetCellKey(ix, iy));
+  ASSERT_EQ(keys.size(), 25);
+  ASSERT_EQ(index.GetCellKey(-0.5, -0.5), index.GetCellKey((long long)-1, (long long)-1));
+  ASSERT_NE(index.GetCellKey(-0.5, 0.5), index.GetCellKey(0.5, -0.5));
+}
+
+TEST(TestSuite, SpatialIndexSameCountAsLinearScan)
+{
+  RoadNetwork map;
+  CreateGridMap(100, 100, 700, map);
+  std::vector<WayPoint> queries = CreateQueryPoints(50, 700, 700);
+
+  int n_found_linear = 0;
+  for(unsigned int i = 0; i < queries.size(); i++)
+  {
+    if(MappingHelpers::GetClosestWaypointFromMap(queries.at(i), map) != nullptr)
+      n_found_linear++;
+  }
+
+  map.spatialIndex.Build(map.roadSegments);
+  int n_found_indexed = 0;
+  for(unsigned int i = 0; i < queries.size(); i++)
+  {
+    if(MappingHelpers::GetClosestWaypointFromMap(queries.at(i), map) != nullptr)
+      n_found_indexed++;
+  }
+
+  ASSERT_EQ(n_found_linear, n_found_indexed);
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  ros::init(argc, argv, "TestNode");
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,111 @@
+/*
+ * Copyright 2020 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "op_planner/MatrixOperations.h"
+
+using namespace PlannerHNS;
+
+#include <ros/ros.h>
+#include <gtest/gtest.h>
+#include <vector>
+
+class TestSuite:
+  public ::testing::Test
+{
+public:
+  TestSuite() {}
+};
+
+std::vector<GPSPoint> CreateTestPoints()
+{
+  std::vector<GPSPoint> points;
+  for(int i = 0; i < 50; i++)
+    points.push_back(GPSPoint(i*1.37 - 20.0, 15.0 - i*0.61, i*0.1, i*0.05));
+  return points;
+}
+
+TEST(TestSuite, RigidTransformMatchesMat3)
+{
+  std::vector<GPSPoint> points = CreateTestPoints();
+  double angles[] = {0, 0.3, -1.2, M_PI_2, 2.9, -M_PI};
+
+  for(unsigned int ia = 0; ia < sizeof(angles)/sizeof(double); ia++)
+  {
+    Mat3 rotationMat(angles[ia]);
+    Mat3 translationMat(12.5, -3.25);
+    RigidTransform2D transform(angles[ia], 12.5, -3.25);
+
+    std::vector<GPSPoint> batch_points = points;
+    transform.Transform(batch_points);
+
+    std::vector<double> x, y, out_x(points.size()), out_y(points.size());
+    for(unsigned int i = 0; i < points.size(); i++)
+    {
+      x.push_back(points.at(i).x);
+      y.push_back(points.at(i).y);
+    }
+    transform.Transform(x.data(), y.data(), out_x.data(), out_y.data(), points.size());
+
+    for(unsigned int i = 0; i < points.size(); i++)
+    {
+      GPSPoint p = translationMat*(rotationMat*points.at(i));
+      GPSPoint p_rigid = transform*points.at(i);
+      EXPECT_EQ(p_rigid.x, p.x);
+      EXPECT_EQ(p_rigid.y, p.y);
+      EXPECT_EQ(p_rigid.z, p.z);
+      EXPECT_EQ(p_rigid.a, p.a);
+      EXPECT_EQ(batch_points.at(i).x, p.x);
+      EXPECT_EQ(batch_points.at(i).y, p.y);
+      EXPECT_EQ(out_x.at(i), p.x);
+      EXPECT_EQ(out_y.at(i), p.y);
+    }
+  }
+}
+
+TEST(TestSuite, RigidTransformInverse)
+{
+  std::vector<GPSPoint> points = CreateTestPoints();
+  RigidTransform2D transform(GPSPoint(7.5, -2.0, 0, 0.8));
+  RigidTransform2D inv = transform.Inverse();
+
+  std::vector<WayPoint> waypoints;
+  for(unsigned int i = 0; i < points.size(); i++)
+  {
+    WayPoint wp;
+    wp.pos = points.at(i);
+    waypoints.push_back(wp);
+  }
+
+  transform.Transform(waypoints);
+  inv.Transform(waypoints);
+  for(unsigned int i = 0; i < points.size(); i++)
+  {
+    EXPECT_NEAR(waypoints.at(i).pos.x, points.at(i).x, 1e-9);
+    EXPECT_NEAR(waypoints.at(i).pos.y, points.at(i).y, 1e-9);
+    EXPECT_EQ(waypoints.at(i).pos.a, points.at(i).a);
+  }
+
+  GPSPoint origin = transform*GPSPoint(0, 0, 0, 0);
+  EXPECT_DOUBLE_EQ(origin.x, 7.5);
+  EXPECT_DOUBLE_EQ(origin.y, -2.0);
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  ros::init(argc, argv, "TestNode");
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,116 @@
+/*
+ * Copyright 2020 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "op_planner/PlanningHelpers.h"
+#include "op_planner/PathEventsTable.h"
+
+using namespace PlannerHNS;
+
+#include <ros/ros.h>
+#include <gtest/gtest.h>
+#include <vector>
+#include <iostream>
+
+class TestSuite:
+  public ::testing::Test
+{
+public:
+  TestSuite() {}
+};
+
+// Curved path with 1 meter point density and a stop line across it every 70 meters, every other one with a traffic light
+void CreatePathWithStopLines(Lane& lane, std::vector<WayPoint>& path)
+{
+  path.clear();
+  lane.stopLines.clear();
+  for(int i = 0; i < 1000; i++)
+  {
+    WayPoint wp(i, 20.0 * sin(i / 60.0), 0, 0);
+    wp.pLane = &lane;
+    path.push_back(wp);
+  }
+  PlanningHelpers::CalcAngleAndCost(path);
+
+  for(int i = 50; i < 1000; i += 70)
+  {
+    StopLine sl;
+    sl.id = lane.stopLines.size() + 1;
+    sl.trafficLightID = sl.id % 2 == 0 ? 100 + sl.id : -1;
+    sl.stopSignID = sl.id % 2 == 1 ? 200 + sl.id : -1;
+    sl.points.push_back(GPSPoint(path.at(i).pos.x + 0.5, path.at(i).pos.y + 2.0, 0, 0));
+    sl.points.push_back(GPSPoint(path.at(i).pos.x + 0.5, path.at(i).pos.y - 2.0, 0, 0));
+    lane.stopLines.push_back(sl);
+    path.at(i - 3).stopLineID = sl.id;
+  }
+}
+
+TEST(TestSuite, TableMatchesPathWalk)
+{
+  Lane lane;
+  std::vector<WayPoint> path;
+  CreatePathWithStopLines(lane, path);
+  PathEventsTable table;
+  table.Build(path);
+  ASSERT_TRUE(table.IsBuiltFor(path));
+  ASSERT_EQ(lane.stopLines.size(), table.m_Events.size());
+
+  double give_up_distance = -4.0;
+  for(double x = 0; x < 1005; x += 0.37)
+  {
+    WayPoint car(x, 20.0 * sin(x / 60.0) + 0.8, 0, 0);
+    int line_id = 0, sign_id = 0, light_id = 0, table_line_id = 0, table_sign_id = 0, table_light_id = 0;
+    double d = PlanningHelpers::GetDistanceToClosestStopLineAndCheck(path, car, give_up_distance, line_id, sign_id, light_id);
+    double table_d = table.GetDistanceToNextStopLine(path, car, give_up_distance, 0, table_line_id, table_sign_id, table_light_id);
+    ASSERT_EQ(line_id, table_line_id) << "x: " << x;
+    ASSERT_EQ(sign_id, table_sign_id);
+    ASSERT_EQ(light_id, table_light_id);
+    // the path walk adds to_front_distance, measured along the heading of the front point, the table only arc length
+    ASSERT_NEAR(d, table_d, 0.01) << "x: " << x;
+  }
+}
+
+TEST(TestSuite, MaxDistanceAndMovingBack)
+{
+  Lane lane;
+  std::vector<WayPoint> path;
+  CreatePathWithStopLines(lane, path);
+  PathEventsTable table;
+  table.Build(path);
+
+  int line_id = 0, sign_id = 0, light_id = 0;
+  WayPoint car(60, 20.0 * sin(1.0), 0, 0);
+  ASSERT_LT(table.GetDistanceToNextStopLine(path, car, -4.0, 30, line_id, sign_id, light_id), 0);
+  ASSERT_EQ(-1, line_id);
+  ASSERT_GT(table.GetDistanceToNextStopLine(path, car, -4.0, 100, line_id, sign_id, light_id), 0);
+  ASSERT_EQ(2, line_id);
+  ASSERT_EQ(102, light_id);
+
+  // back before the first stop line, the cursor starts over
+  car = WayPoint(10, 20.0 * sin(10 / 60.0), 0, 0);
+  ASSERT_GT(table.GetDistanceToNextStopLine(path, car, -4.0, 0, line_id, sign_id, light_id), 0);
+  ASSERT_EQ(1, line_id);
+  ASSERT_EQ(201, sign_id);
+
+  std::vector<WayPoint> other_path = path;
+  ASSERT_FALSE(table.IsBuiltFor(other_path));
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  ros::init(argc, argv, "TestNode");
+  return RUN_ALL_TESTS();
+}
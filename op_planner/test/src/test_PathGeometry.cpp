@@ -0,0 +1,170 @@
+/*
+ * Copyright 2020 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "op_planner/PlanningHelpers.h"
+#include "op_planner/PathGeometry.h"
+
+using namespace PlannerHNS;
+
+#include <ros/ros.h>
+#include <gtest/gtest.h>
+#include <vector>
+#include <iostream>
+
+class TestSuite:
+  public ::testing::Test
+{
+public:
+  TestSuite() {}
+};
+
+// Uneven point density and a few sharp corners
+std::vector<WayPoint> CreateRoughPath(const int& n_points)
+{
+  std::vector<WayPoint> path;
+  double x = 0, y = 0;
+  for(int i = 0; i < n_points; i++)
+  {
+    double step = 0.5 + 0.4 * sin(i * 0.7);
+    double a = 0.6 * sin(i / 25.0) + ((i % 40 == 0) ? 0.5 : 0);
+    x += step * cos(a);
+    y += step * sin(a);
+    path.push_back(WayPoint(x, y, 0, 0));
+  }
+  return path;
+}
+
+void ExpectSameGeometry(const PathGeometry& g1, const PathGeometry& g2)
+{
+  ASSERT_EQ(g1.s.size(), g2.s.size());
+  for(unsigned int i = 0; i < g1.s.size(); i++)
+  {
+    ASSERT_NEAR(g1.s.at(i), g2.s.at(i), 1e-9);
+    ASSERT_NEAR(g1.heading.at(i), g2.heading.at(i), 1e-12);
+    ASSERT_NEAR(g1.kappa.at(i), g2.kappa.at(i), 1e-9);
+  }
+}
+
+TEST(TestSuite, CalcAngleAndCostMatchesPlainVersion)
+{
+  std::vector<WayPoint> path = CreateRoughPath(300);
+  std::vector<WayPoint> plain_path = path;
+  PathGeometry geometry;
+
+  double last_cost = PlanningHelpers::CalcAngleAndCost(path, geometry, 3.0);
+  double plain_last_cost = PlanningHelpers::CalcAngleAndCost(plain_path, 3.0);
+  ASSERT_NEAR(plain_last_cost, last_cost, 1e-9);
+  for(unsigned int i = 0; i < path.size(); i++)
+  {
+    ASSERT_DOUBLE_EQ(plain_path.at(i).pos.a, path.at(i).pos.a);
+    ASSERT_NEAR(plain_path.at(i).cost, path.at(i).cost, 1e-9);
+  }
+
+  path = CreateRoughPath(300);
+  plain_path = path;
+  PlanningHelpers::CalcAngleAndCostAndCurvatureAnd2D(path, geometry);
+  PlanningHelpers::CalcAngleAndCostAndCurvatureAnd2D(plain_path);
+  for(unsigned int i = 0; i < path.size(); i++)
+  {
+    ASSERT_DOUBLE_EQ(plain_path.at(i).pos.a, path.at(i).pos.a);
+    ASSERT_NEAR(plain_path.at(i).cost, path.at(i).cost, 1e-9);
+  }
+}
+
+TEST(TestSuite, IncrementalUpdateMatchesFullUpdate)
+{
+  std::vector<WayPoint> path = CreateRoughPath(400);
+  PathGeometry geometry;
+  geometry.Update(path);
+  ASSERT_TRUE(geometry.IsValid(path));
+
+  // move a single range by hand
+  for(unsigned int i = 100; i <= 120; i++)
+    path.at(i).pos.y += 0.3;
+  geometry.Invalidate(100, 120);
+  ASSERT_FALSE(geometry.IsValid(path));
+  geometry.Update(path);
+
+  PathGeometry full_geometry;
+  full_geometry.Update(path);
+  ExpectSameGeometry(full_geometry, geometry);
+
+  // smoothing marks the points it moved
+  PlanningHelpers::SmoothPath(path, geometry, 0.45, 0.3, 0.05);
+  geometry.Update(path);
+  full_geometry.Invalidate();
+  full_geometry.Update(path);
+  ExpectSameGeometry(full_geometry, geometry);
+
+  // density fix changes the point count, everything is recomputed
+  PlanningHelpers::FixPathDensity(path, 0.75, geometry);
+  ASSERT_FALSE(geometry.IsValid(path));
+  geometry.Update(path);
+  full_geometry.Invalidate();
+  full_geometry.Update(path);
+  ExpectSameGeometry(full_geometry, geometry);
+}
+
+TEST(TestSuite, ExtractPartMatchesPlainVersion)
+{
+  // density that does not divide the extraction distances, to stay away from ties on the break conditions
+  std::vector<WayPoint> path = CreateRoughPath(2000);
+  PlanningHelpers::FixPathDensity(path, 0.53);
+  PlanningHelpers::CalcAngleAndCost(path);
+  PathGeometry geometry;
+  geometry.Update(path);
+
+  for(unsigned int i = 5; i < path.size(); i += 97)
+  {
+    WayPoint pos = path.at(i);
+    pos.pos.x += 0.4;
+
+    std::vector<WayPoint> plain_extracted, extracted;
+    PathGeometry extracted_geometry;
+    PlanningHelpers::ExtractPartFromPointToDistanceFast(path, pos, 50, 0.5, plain_extracted, 0.45, 0.3, 0.05);
+    PlanningHelpers::ExtractPartFromPointToDistanceFast(path, geometry, pos, 50, 0.5, extracted, extracted_geometry);
+
+    ASSERT_EQ(plain_extracted.size(), extracted.size());
+    ASSERT_TRUE(extracted_geometry.IsValid(extracted));
+    for(unsigned int j = 0; j < extracted.size(); j++)
+    {
+      ASSERT_DOUBLE_EQ(plain_extracted.at(j).pos.x, extracted.at(j).pos.x);
+      ASSERT_DOUBLE_EQ(plain_extracted.at(j).pos.y, extracted.at(j).pos.y);
+      ASSERT_NEAR(plain_extracted.at(j).cost, extracted.at(j).cost, 1e-9);
+    }
+  }
+}
+
+TEST(TestSuite, AccurateDistanceOnStraightPath)
+{
+  std::vector<WayPoint> path;
+  for(int i = 0; i < 50; i++)
+    path.push_back(WayPoint(i, 0, 0, 0));
+
+  PathGeometry geometry;
+  geometry.Update(path);
+  WayPoint p(20.5, 1.0, 0, 0);
+  ASSERT_NEAR(10.5, PlanningHelpers::GetAccurateDistanceOnTrajectory(path, geometry, 10, p), 1e-9);
+  ASSERT_NEAR(-9.5, PlanningHelpers::GetAccurateDistanceOnTrajectory(path, geometry, 30, p), 1e-9);
+  ASSERT_NEAR(10.5, PlanningHelpers::GetAccurateDistanceOnTrajectory(path, 10, p), 1e-9);
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  ros::init(argc, argv, "TestNode");
+  return RUN_ALL_TESTS();
+}
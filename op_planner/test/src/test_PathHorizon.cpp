@@ -0,0 +1,184 @@
+/*
+ * Copyright 2020 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "op_planner/PlanningHelpers.h"
+#include "op_planner/PathHorizon.h"
+
+using namespace PlannerHNS;
+
+#include <ros/ros.h>
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <vector>
+
+class TestSuite:
+  public ::testing::Test
+{
+public:
+  TestSuite() {}
+};
+
+// A long curve with an uneven point density, points from 0.2 to 2 meters apart
+std::vector<WayPoint> CreateCurvedPath(const int& n_points)
+{
+  std::vector<WayPoint> path;
+  double x = 0, y = 0, a = 0;
+  for(int i = 0; i < n_points; i++)
+  {
+    WayPoint wp(x, y, 0, 0);
+    wp.v = 5;
+    wp.laneId = 1 + i/100;
+    path.push_back(wp);
+    const double step = 0.2 + (i*7 % 10) * 0.2;
+    a += 0.01 * sin(i * 0.05);
+    x += step * cos(a);
+    y += step * sin(a);
+  }
+  PlanningHelpers::CalcAngleAndCost(path);
+  return path;
+}
+
+TEST(TestSuite, ViewIsTheCopiedRange)
+{
+  std::vector<WayPoint> path = CreateCurvedPath(400);
+  WayPoint pos = path.at(150);
+
+  PathView view;
+  PlanningHelpers::ExtractPartFromPointToDistanceDirectionFast(path, pos, 60, view);
+  ASSERT_EQ(view.GetPath(), &path);
+  ASSERT_GT(view.size(), 2);
+  ASSERT_LT(view.GetOffset(), 150);
+  ASSERT_GT(view.GetOffset() + view.size(), 150);
+
+  //the copying version resamples exactly these points
+  std::vector<WayPoint> part(path.begin() + view.GetOffset(), path.begin() + view.GetOffset() + view.size());
+  PlanningHelpers::FixPathDensity(part, 0.5);
+  PlanningHelpers::CalcAngleAndCost(part);
+  std::vector<WayPoint> extracted;
+  PlanningHelpers::ExtractPartFromPointToDistanceDirectionFast(path, pos, 60, 0.5, extracted);
+  ASSERT_EQ(part.size(), extracted.size());
+  for(unsigned int i = 0; i < part.size(); i++)
+  {
+    ASSERT_EQ(part.at(i).pos.x, extracted.at(i).pos.x);
+    ASSERT_EQ(part.at(i).pos.y, extracted.at(i).pos.y);
+  }
+}
+
+TEST(TestSuite, ResampledOnceLikeFixPathDensity)
+{
+  std::vector<WayPoint> path = CreateCurvedPath(300);
+
+  PathHorizon horizon;
+  PathView view;
+  ASSERT_TRUE(horizon.Extract(path, path.at(0), 10000, 0.5, view));
+  ASSERT_EQ(horizon.GetResampleStart(), 0);
+
+  std::vector<WayPoint> reference = path;
+  PlanningHelpers::FixPathDensity(reference, 0.5);
+  PlanningHelpers::CalcAngleAndCost(reference);
+
+  const std::vector<WayPoint>& resampled = horizon.GetResampledPoints();
+  ASSERT_EQ(reference.size(), resampled.size());
+  ASSERT_EQ(reference.size(), view.size());
+  for(unsigned int i = 0; i < reference.size(); i++)
+  {
+    ASSERT_EQ(reference.at(i).pos.x, resampled.at(i).pos.x);
+    ASSERT_EQ(reference.at(i).pos.y, resampled.at(i).pos.y);
+    ASSERT_NEAR(reference.at(i).pos.a, resampled.at(i).pos.a, 1e-9);
+    ASSERT_NEAR(reference.at(i).cost, resampled.at(i).cost, 1e-9);
+  }
+}
+
+TEST(TestSuite, ExtendedAsTheCarAdvances)
+{
+  std::vector<WayPoint> path = CreateCurvedPath(2000);
+  std::vector<WayPoint> reference = path;
+  PlanningHelpers::FixPathDensity(reference, 0.5);
+  PlanningHelpers::CalcAngleAndCost(reference);
+
+  PathHorizon horizon;
+  PathView view;
+  std::vector<WayPoint> copied;
+  for(unsigned int r = 0; r + 50 < reference.size(); r += 3)
+  {
+    WayPoint pos = reference.at(r);
+    pos.pos.x += 0.1;
+    ASSERT_TRUE(horizon.Extract(path, pos, 80, 0.5, view));
+    ASSERT_GT(view.size(), 2);
+
+    //same points as the resampled whole path, 10 meters behind and 80 meters ahead
+    unsigned int k = 0;
+    while(k < reference.size() && reference.at(k).pos.x != view.front().pos.x)
+      k++;
+    ASSERT_LT(k + view.size(), reference.size() + 1);
+    for(unsigned int i = 0; i < view.size(); i++)
+    {
+      ASSERT_EQ(reference.at(k+i).pos.x, view.at(i).pos.x);
+      ASSERT_EQ(reference.at(k+i).pos.y, view.at(i).pos.y);
+      ASSERT_NEAR(reference.at(k+i).cost, view.at(i).cost, 1e-6);
+    }
+    ASSERT_LE(view.front().cost, std::max(0.0, reference.at(r).cost - 10 + 1.0));
+    if(view.back().cost < reference.back().cost)
+    {
+      ASSERT_GT(view.back().cost, reference.at(r).cost + 80 - 0.5);
+    }
+
+    view.CopyTo(copied);
+    ASSERT_EQ(copied.size(), view.size());
+    ASSERT_EQ(copied.front().cost, 0);
+  }
+
+  //resampled from the start once, each point once
+  ASSERT_EQ(horizon.m_nRestarts, 1);
+  ASSERT_LE(horizon.m_nAddedPoints, reference.size());
+  ASSERT_LT(horizon.GetResampledPoints().size(), reference.size() / 4);
+}
+
+TEST(TestSuite, RestartsWhenThePathOrTheCarJumps)
+{
+  std::vector<WayPoint> path = CreateCurvedPath(1000);
+  PathHorizon horizon;
+  PathView view;
+  horizon.Extract(path, path.at(100), 50, 0.5, view);
+  horizon.Extract(path, path.at(105), 50, 0.5, view);
+  ASSERT_EQ(horizon.m_nRestarts, 1);
+
+  //far beyond the resampled part
+  horizon.Extract(path, path.at(800), 50, 0.5, view);
+  ASSERT_EQ(horizon.m_nRestarts, 2);
+  ASSERT_GT(horizon.GetResampleStart(), 700);
+
+  //another density
+  horizon.Extract(path, path.at(801), 50, 1.0, view);
+  ASSERT_EQ(horizon.m_nRestarts, 3);
+
+  //another path
+  std::vector<WayPoint> other = CreateCurvedPath(900);
+  horizon.Extract(other, other.at(801), 50, 1.0, view);
+  ASSERT_EQ(horizon.m_nRestarts, 4);
+  ASSERT_EQ(view.GetPath(), &horizon.GetResampledPoints());
+
+  std::vector<WayPoint> too_short(1, path.at(0));
+  ASSERT_FALSE(horizon.Extract(too_short, path.at(0), 50, 0.5, view));
+  ASSERT_TRUE(view.empty());
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  ros::init(argc, argv, "TestNode");
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,113 @@
+/*
+ * Copyright 2020 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "op_planner/PlanningHelpers.h"
+
+using namespace PlannerHNS;
+
+#include <ros/ros.h>
+#include <gtest/gtest.h>
+#include <vector>
+#include <iostream>
+
+class TestSuite:
+  public ::testing::Test
+{
+public:
+  TestSuite() {}
+};
+
+// Zigzag path with noisy speed, curvature and direction profiles
+void CreateNoisyPath(std::vector<WayPoint>& path)
+{
+  path.clear();
+  for(int i = 0; i < 200; i++)
+  {
+    WayPoint wp(i * 0.5, ((i % 3) - 1) * 0.2 + 3.0 * sin(i / 40.0), 0, 0.1 * ((i * 7) % 5));
+    wp.v = 5.0 + ((i * 13) % 7) * 0.3;
+    wp.cost = ((i * 11) % 4) * 0.05;
+    path.push_back(wp);
+  }
+}
+
+TEST(TestSuite, DirectSmootherMatchesGradientDescent)
+{
+  std::vector<WayPoint> path;
+  CreateNoisyPath(path);
+  std::vector<WayPoint> gd_path = path, direct_path = path;
+
+  PlanningHelpers::SetSmoothingMethod(SMOOTHING_GRADIENT_DESCENT);
+  PlanningHelpers::SmoothPath(gd_path, 0.45, 0.3, 1e-10);
+  PlanningHelpers::SmoothSpeedProfiles(gd_path, 0.45, 0.3, 1e-10);
+  PlanningHelpers::SmoothCurvatureProfiles(gd_path, 0.45, 0.3, 1e-10);
+  PlanningHelpers::SmoothWayPointsDirections(gd_path, 0.45, 0.3, 1e-10);
+
+  PlanningHelpers::SetSmoothingMethod(SMOOTHING_DIRECT);
+  ASSERT_EQ(SMOOTHING_DIRECT, PlanningHelpers::GetSmoothingMethod());
+  PlanningHelpers::SmoothPath(direct_path, 0.45, 0.3, 1e-10);
+  PlanningHelpers::SmoothSpeedProfiles(direct_path, 0.45, 0.3, 1e-10);
+  PlanningHelpers::SmoothCurvatureProfiles(direct_path, 0.45, 0.3, 1e-10);
+  PlanningHelpers::SmoothWayPointsDirections(direct_path, 0.45, 0.3, 1e-10);
+  PlanningHelpers::SetSmoothingMethod(SMOOTHING_GRADIENT_DESCENT);
+
+  ASSERT_EQ(gd_path.size(), direct_path.size());
+  double max_change = 0;
+  for(unsigned int i = 0; i < path.size(); i++)
+  {
+    ASSERT_NEAR(gd_path.at(i).pos.x, direct_path.at(i).pos.x, 1e-6);
+    ASSERT_NEAR(gd_path.at(i).pos.y, direct_path.at(i).pos.y, 1e-6);
+    ASSERT_NEAR(gd_path.at(i).v, direct_path.at(i).v, 1e-6);
+    ASSERT_NEAR(gd_path.at(i).cost, direct_path.at(i).cost, 1e-6);
+    ASSERT_NEAR(gd_path.at(i).pos.a, direct_path.at(i).pos.a, 1e-6);
+    max_change = std::max(max_change, fabs(direct_path.at(i).pos.y - path.at(i).pos.y));
+  }
+
+  // the end points are fixed and the path is actually smoothed
+  ASSERT_DOUBLE_EQ(path.front().pos.y, direct_path.front().pos.y);
+  ASSERT_DOUBLE_EQ(path.back().v, direct_path.back().v);
+  ASSERT_GT(max_change, 0.05);
+}
+
+TEST(TestSuite, DirectSmootherShortAndFlatInputs)
+{
+  std::vector<double> values, buffer;
+  values.push_back(1.0);
+  values.push_back(3.0);
+  PlanningHelpers::SmoothValuesDirect(values, 0.5, 0.3, buffer);
+  ASSERT_DOUBLE_EQ(3.0, values.at(1));
+
+  // pure smoothing turns the interior into a straight line
+  values.clear();
+  for(int i = 0; i < 6; i++)
+    values.push_back(i % 2);
+  values.back() = 5.0;
+  PlanningHelpers::SmoothValuesDirect(values, 0.0, 0.4, buffer);
+  for(int i = 0; i < 6; i++)
+    ASSERT_NEAR(i, values.at(i), 1e-9);
+
+  // no smoothing weight keeps the input
+  values.assign(5, 2.0);
+  values.at(2) = 7.0;
+  PlanningHelpers::SmoothValuesDirect(values, 0.5, 0.0, buffer);
+  ASSERT_DOUBLE_EQ(7.0, values.at(2));
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  ros::init(argc, argv, "TestNode");
+  return RUN_ALL_TESTS();
+}
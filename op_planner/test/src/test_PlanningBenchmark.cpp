@@ -0,0 +1,102 @@
+/*
+ * Copyright 2020 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "op_planner/PlanningBenchmark.h"
+
+using namespace PlannerHNS;
+
+#include <ros/ros.h>
+#include <gtest/gtest.h>
+#include <iostream>
+#include <sys/stat.h>
+
+class TestSuite:
+  public ::testing::Test
+{
+public:
+  TestSuite() {}
+};
+
+TEST(TestSuite, SavedScenarioLoadsTheSameFrames)
+{
+  PlanningScenario scenario;
+  PlanningScenario::CreateSynthetic(3, 200, 5, 8, 0.1, scenario);
+  std::string folder = "/tmp/op_planner_test_scenario/";
+  mkdir(folder.c_str(), 0755);
+  ASSERT_TRUE(scenario.SaveToFolder(folder));
+
+  PlanningScenario loaded;
+  ASSERT_TRUE(loaded.LoadFromFolder(folder));
+  ASSERT_EQ(scenario.map.roadSegments.at(0).Lanes.size(), loaded.map.roadSegments.at(0).Lanes.size());
+  ASSERT_EQ(scenario.egoTrajectory.size(), loaded.egoTrajectory.size());
+  ASSERT_EQ(scenario.objectFrames.size(), loaded.objectFrames.size());
+  for(unsigned int i = 0; i < scenario.egoTrajectory.size(); i++)
+  {
+    ASSERT_NEAR(scenario.egoTrajectory.at(i).pos.x, loaded.egoTrajectory.at(i).pos.x, 1e-9);
+    ASSERT_NEAR(scenario.egoTrajectory.at(i).v, loaded.egoTrajectory.at(i).v, 1e-9);
+    ASSERT_EQ(scenario.objectFrames.at(i).size(), loaded.objectFrames.at(i).size());
+    for(unsigned int j = 0; j < scenario.objectFrames.at(i).size(); j++)
+    {
+      const DetectedObject& obj = scenario.objectFrames.at(i).at(j);
+      const DetectedObject& loaded_obj = loaded.objectFrames.at(i).at(j);
+      ASSERT_EQ(obj.id, loaded_obj.id);
+      ASSERT_NEAR(obj.center.pos.x, loaded_obj.center.pos.x, 1e-9);
+      ASSERT_NEAR(obj.center.pos.y, loaded_obj.center.pos.y, 1e-9);
+      ASSERT_NEAR(obj.center.v, loaded_obj.center.v, 1e-9);
+      ASSERT_EQ(obj.contour.size(), loaded_obj.contour.size());
+    }
+  }
+}
+
+TEST(TestSuite, ReplayRecordsEveryStage)
+{
+  PlanningScenario scenario;
+  PlanningScenario::CreateSynthetic(3, 200, 5, 8, 0.1, scenario);
+
+  PlanningBenchmark benchmark;
+  benchmark.m_nRepeats = 2;
+  ASSERT_TRUE(benchmark.Run(scenario));
+
+  const UtilityHNS::StageLatencyRecorder& latency = benchmark.GetLatency();
+  ASSERT_EQ(BENCH_STAGES_COUNT, latency.GetNumberOfStages());
+  ASSERT_EQ(2, latency.GetHistogram(BENCH_GLOBAL_PLAN).GetCount());
+  unsigned long nFrames = 2 * scenario.egoTrajectory.size();
+  ASSERT_EQ(nFrames, latency.GetHistogram(BENCH_PREDICTION).GetCount());
+  ASSERT_EQ(nFrames, latency.GetHistogram(BENCH_CYCLE).GetCount());
+  ASSERT_EQ(nFrames, latency.GetHistogram(BENCH_DECISION).GetCount());
+  ASSERT_GT(latency.GetHistogram(BENCH_CYCLE).GetPercentile(0.99), 0);
+
+  std::cout << benchmark.GetReport();
+}
+
+TEST(TestSuite, NoGlobalPlanFails)
+{
+  PlanningScenario scenario;
+  PlanningScenario::CreateSynthetic(2, 100, 0, 5, 0.1, scenario);
+  scenario.egoTrajectory.back().pos.x = 5000;
+  scenario.egoTrajectory.back().pos.y = 5000;
+
+  PlanningBenchmark benchmark;
+  ASSERT_FALSE(benchmark.Run(scenario));
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  ros::init(argc, argv, "TestNode");
+  return RUN_ALL_TESTS();
+}
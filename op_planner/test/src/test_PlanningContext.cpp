@@ -0,0 +1,172 @@
+/*
+ * Copyright 2020 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "op_planner/PlanningHelpers.h"
+
+using namespace PlannerHNS;
+
+#include <ros/ros.h>
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+class TestSuite:
+  public ::testing::Test
+{
+public:
+  TestSuite() {}
+};
+
+// Curved center line of 100 meters with 0.25 meter density
+void CreateCenter(const double& y_offset, std::vector<WayPoint>& center)
+{
+  center.clear();
+  for(int i = 0; i < 400; i++)
+  {
+    WayPoint wp(i * 0.25, y_offset + 4.0 * sin(i / 120.0), 0, 0);
+    wp.v = 5 + (i % 7) * 0.2;
+    center.push_back(wp);
+  }
+  PlanningHelpers::CalcAngleAndCost(center);
+}
+
+void GenerateRollOuts(const std::vector<WayPoint>& center, const double& s, const PlanningParams& params, PlanningContext* pContext,
+    std::vector<std::vector<WayPoint> >& rollOuts)
+{
+  int s_index = 0, e_index = 0;
+  std::vector<double> e_distances;
+  std::vector<WayPoint> sampled;
+  WayPoint carPos = center.at(s*4);
+  carPos.pos.y += 0.3;
+  if(pContext)
+    PlanningHelpers::CalculateRollInTrajectories(carPos, 2.0, center, s_index, e_index, e_distances, rollOuts, params.microPlanDistance,
+        params.maxSpeed, params.carTipMargin, params.rollInMargin, params.rollInSpeedFactor, params.pathDensity, params.rollOutDensity,
+        params.rollOutNumber, params.smoothingDataWeight, params.smoothingSmoothWeight, params.smoothingToleranceError, false, *pContext, sampled);
+  else
+    PlanningHelpers::CalculateRollInTrajectories(carPos, 2.0, center, s_index, e_index, e_distances, rollOuts, params.microPlanDistance,
+        params.maxSpeed, params.carTipMargin, params.rollInMargin, params.rollInSpeedFactor, params.pathDensity, params.rollOutDensity,
+        params.rollOutNumber, params.smoothingDataWeight, params.smoothingSmoothWeight, params.smoothingToleranceError, false, sampled);
+}
+
+void ExpectSamePaths(const std::vector<std::vector<WayPoint> >& paths, const std::vector<std::vector<WayPoint> >& other_paths)
+{
+  ASSERT_EQ(paths.size(), other_paths.size());
+  for(unsigned int i = 0; i < paths.size(); i++)
+  {
+    ASSERT_EQ(paths.at(i).size(), other_paths.at(i).size());
+    for(unsigned int j = 0; j < paths.at(i).size(); j++)
+    {
+      ASSERT_EQ(paths.at(i).at(j).pos.x, other_paths.at(i).at(j).pos.x);
+      ASSERT_EQ(paths.at(i).at(j).pos.y, other_paths.at(i).at(j).pos.y);
+      ASSERT_EQ(paths.at(i).at(j).v, other_paths.at(i).at(j).v);
+    }
+  }
+}
+
+TEST(TestSuite, ContextMatchesStaticSettings)
+{
+  PlanningParams params;
+  std::vector<WayPoint> center;
+  CreateCenter(0, center);
+
+  SMOOTHING_METHOD methods[] = {SMOOTHING_GRADIENT_DESCENT, SMOOTHING_DIRECT};
+  for(int im = 0; im < 2; im++)
+  {
+    PlanningHelpers::SetSmoothingMethod(methods[im]);
+    PlanningContext context(methods[im]);
+
+    std::vector<std::vector<WayPoint> > rollOuts, contextRollOuts;
+    GenerateRollOuts(center, 10.0, params, 0, rollOuts);
+    GenerateRollOuts(center, 10.0, params, &context, contextRollOuts);
+    ExpectSamePaths(rollOuts, contextRollOuts);
+
+    std::vector<std::vector<WayPoint> > paths(1, center), contextPaths(1, center);
+    PlanningHelpers::SmoothSpeedProfiles(paths.at(0), 0.4, 0.3, 0.01);
+    PlanningHelpers::SmoothSpeedProfiles(contextPaths.at(0), 0.4, 0.3, 0.01, context);
+    PlanningHelpers::FixPathDensity(paths.at(0), 0.5);
+    PlanningHelpers::FixPathDensity(contextPaths.at(0), 0.5, context);
+    PlanningHelpers::SmoothPath(paths.at(0), 0.45, 0.3, 0.01);
+    PlanningHelpers::SmoothPath(contextPaths.at(0), 0.45, 0.3, 0.01, context);
+    ExpectSamePaths(paths, contextPaths);
+  }
+  PlanningHelpers::SetSmoothingMethod(SMOOTHING_GRADIENT_DESCENT);
+}
+
+TEST(TestSuite, ReusedContextKeepsItsMemory)
+{
+  PlanningParams params;
+  std::vector<WayPoint> center;
+  CreateCenter(0, center);
+
+  PlanningContext context(SMOOTHING_DIRECT);
+  std::vector<std::vector<WayPoint> > rollOuts;
+  GenerateRollOuts(center, 10.0, params, &context, rollOuts);
+
+  std::vector<const WayPoint*> buffers;
+  for(unsigned int i = 0; i < rollOuts.size(); i++)
+    buffers.push_back(rollOuts.at(i).data());
+  const double* pX = context.x.data();
+  const double* pSteps = context.rollInSteps.data();
+
+  GenerateRollOuts(center, 10.0, params, &context, rollOuts);
+  for(unsigned int i = 0; i < rollOuts.size(); i++)
+    EXPECT_EQ(buffers.at(i), rollOuts.at(i).data());
+  EXPECT_EQ(pX, context.x.data());
+  EXPECT_EQ(pSteps, context.rollInSteps.data());
+  EXPECT_EQ(1u, context.rollOutsTemplate.nBuilds);
+  EXPECT_EQ(1u, context.rollOutsTemplate.nCenterBuilds);
+}
+
+TEST(TestSuite, ThreadsWithOwnContexts)
+{
+  PlanningParams params;
+  std::vector<WayPoint> center;
+  CreateCenter(0, center);
+
+  //the global setting is not read by the context functions
+  PlanningHelpers::SetSmoothingMethod(SMOOTHING_GRADIENT_DESCENT);
+  std::vector<std::vector<std::vector<WayPoint> > > expected(4);
+  for(unsigned int t = 0; t < expected.size(); t++)
+  {
+    PlanningContext context(t % 2 == 0 ? SMOOTHING_DIRECT : SMOOTHING_GRADIENT_DESCENT);
+    GenerateRollOuts(center, 10.0 + t*5.0, params, &context, expected.at(t));
+  }
+
+  std::vector<std::vector<std::vector<WayPoint> > > results(expected.size());
+  std::vector<std::thread> threads;
+  for(unsigned int t = 0; t < expected.size(); t++)
+  {
+    threads.push_back(std::thread([&center, &params, &results, t]()
+    {
+      PlanningContext context(t % 2 == 0 ? SMOOTHING_DIRECT : SMOOTHING_GRADIENT_DESCENT);
+      for(int i = 0; i < 20; i++)
+        GenerateRollOuts(center, 10.0 + t*5.0, params, &context, results.at(t));
+    }));
+  }
+
+  for(unsigned int t = 0; t < threads.size(); t++)
+  {
+    threads.at(t).join();
+    ExpectSamePaths(expected.at(t), results.at(t));
+  }
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  ros::init(argc, argv, "TestNode");
+  return RUN_ALL_TESTS();
+}
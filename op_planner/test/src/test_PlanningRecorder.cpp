@@ -0,0 +1,174 @@
+/*
+ * Copyright 2020 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "op_planner/PlanningRecorder.h"
+#include "op_planner/PlanningBenchmark.h"
+#include "op_planner/PlannerH.h"
+#include "op_planner/PlanningHelpers.h"
+
+using namespace PlannerHNS;
+
+#include <ros/ros.h>
+#include <gtest/gtest.h>
+#include <cstring>
+#include <fstream>
+
+class TestSuite:
+  public ::testing::Test
+{
+public:
+  TestSuite() {}
+};
+
+static timespec FrameStamp(const int& iFrame)
+{
+  timespec t;
+  t.tv_sec = 100 + iFrame / 10;
+  t.tv_nsec = (iFrame % 10) * 100000000;
+  return t;
+}
+
+// the inputs a live node would convert: the map, the global path and for every frame the objects and the ego state
+static bool RecordScenario(const std::string& fileName, PlanningScenario& scenario, unsigned long& nRecords)
+{
+  PlanningScenario::CreateSynthetic(3, 200, 5, 8, 0.1, scenario);
+
+  PlannerH planner;
+  std::vector<int> global_path_ids;
+  std::vector<std::vector<WayPoint> > global_paths;
+  PlanningParams params;
+  planner.PlanUsingDP(scenario.egoTrajectory.front(), scenario.egoTrajectory.back(), params.planningDistance,
+      false, global_path_ids, scenario.map, global_paths);
+  if(global_paths.size() == 0) return false;
+
+  PlanningRecorder recorder;
+  if(!recorder.Open(fileName)) return false;
+  recorder.RecordMap(FrameStamp(0), scenario.map);
+  recorder.RecordMap(FrameStamp(0), scenario.map); // same version, not recorded again
+  recorder.RecordGlobalPaths(FrameStamp(0), global_paths);
+  for(unsigned int i = 0; i < scenario.egoTrajectory.size(); i++)
+  {
+    VehicleState state;
+    state.speed = scenario.egoTrajectory.at(i).v;
+    state.steer = 0.01 * i;
+    recorder.RecordDetectedObjects(FrameStamp(i), scenario.objectFrames.at(i));
+    recorder.RecordEgoState(FrameStamp(i), scenario.egoTrajectory.at(i), state);
+  }
+
+  nRecords = recorder.GetNumberOfRecords();
+  recorder.Close();
+  return true;
+}
+
+TEST(TestSuite, RecordsReadBackBitForBit)
+{
+  std::string fileName = "/tmp/op_planner_test_recording.oprec";
+  PlanningScenario scenario;
+  unsigned long nRecords = 0;
+  ASSERT_TRUE(RecordScenario(fileName, scenario, nRecords));
+  ASSERT_EQ(2 + 2 * scenario.egoTrajectory.size(), nRecords);
+
+  std::vector<PlanningRecord> records;
+  ASSERT_TRUE(PlanningRecordReader::ReadAll(fileName, records));
+  ASSERT_EQ(nRecords, records.size());
+  ASSERT_EQ(RECORD_MAP, records.at(0).type);
+  ASSERT_EQ(scenario.map.version, records.at(0).mapVersion);
+  ASSERT_EQ(0, records.at(0).mapIndex);
+  ASSERT_EQ(RECORD_GLOBAL_PATHS, records.at(1).type);
+  ASSERT_GT(records.at(1).globalPaths.at(0).size(), 0u);
+
+  for(unsigned int i = 0; i < scenario.egoTrajectory.size(); i++)
+  {
+    const PlanningRecord& objects = records.at(2 + 2 * i);
+    const PlanningRecord& ego = records.at(3 + 2 * i);
+    ASSERT_EQ(RECORD_DETECTED_OBJECTS, objects.type);
+    ASSERT_EQ(RECORD_EGO_STATE, ego.type);
+    ASSERT_EQ(FrameStamp(i).tv_sec, ego.stamp.tv_sec);
+    ASSERT_EQ(FrameStamp(i).tv_nsec, ego.stamp.tv_nsec);
+
+    const WayPoint& pose = scenario.egoTrajectory.at(i);
+    ASSERT_EQ(0, memcmp(&pose.pos, &ego.pose.pos, sizeof(GPSPoint)));
+    ASSERT_EQ(0, memcmp(&pose.v, &ego.pose.v, sizeof(double)));
+    double steer = 0.01 * i;
+    ASSERT_EQ(0, memcmp(&steer, &ego.vehicleState.steer, sizeof(double)));
+
+    ASSERT_EQ(scenario.objectFrames.at(i).size(), objects.objects.size());
+    for(unsigned int j = 0; j < objects.objects.size(); j++)
+    {
+      const DetectedObject& obj = scenario.objectFrames.at(i).at(j);
+      const DetectedObject& read_obj = objects.objects.at(j);
+      ASSERT_EQ(obj.id, read_obj.id);
+      ASSERT_EQ(obj.t, read_obj.t);
+      ASSERT_EQ(0, memcmp(&obj.center.pos, &read_obj.center.pos, sizeof(GPSPoint)));
+      ASSERT_EQ(obj.contour.size(), read_obj.contour.size());
+      ASSERT_EQ(0, memcmp(obj.contour.data(), read_obj.contour.data(), obj.contour.size() * sizeof(GPSPoint)));
+    }
+  }
+
+  // a recording cut in the middle of a record keeps the complete ones
+  std::ifstream in(fileName.c_str(), std::ios::binary);
+  std::string data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+  std::string cutName = "/tmp/op_planner_test_recording_cut.oprec";
+  std::ofstream out(cutName.c_str(), std::ios::binary);
+  out.write(data.data(), data.size() - 10);
+  out.close();
+  ASSERT_TRUE(PlanningRecordReader::ReadAll(cutName, records));
+  ASSERT_EQ(nRecords - 1, records.size());
+
+  std::ofstream other(cutName.c_str(), std::ios::binary);
+  other << "not a recording";
+  other.close();
+  ASSERT_FALSE(PlanningRecordReader::ReadAll(cutName, records));
+}
+
+TEST(TestSuite, ReplayIsTheSameAtAnySpeed)
+{
+  std::string fileName = "/tmp/op_planner_test_replay.oprec";
+  PlanningScenario scenario;
+  unsigned long nRecords = 0;
+  ASSERT_TRUE(RecordScenario(fileName, scenario, nRecords));
+
+  PlanningReplay fast;
+  ASSERT_TRUE(fast.Load(fileName));
+  int nCycles = fast.Run();
+  ASSERT_EQ((int)scenario.egoTrajectory.size(), nCycles);
+  ASSERT_EQ(nCycles, (int)fast.GetLatency().GetHistogram(REPLAY_CYCLE).GetCount());
+
+  // the recording is 20 seconds long, replayed in about half a second
+  PlanningReplay timed;
+  timed.m_SpeedFactor = 40;
+  timed.m_nThreads = 2;
+  ASSERT_TRUE(timed.Load(fileName));
+  ASSERT_EQ(nCycles, timed.Run());
+
+  ASSERT_EQ(fast.m_Behaviors.size(), timed.m_Behaviors.size());
+  for(unsigned int i = 0; i < fast.m_Behaviors.size(); i++)
+  {
+    ASSERT_EQ(fast.m_Behaviors.at(i).state, timed.m_Behaviors.at(i).state);
+    ASSERT_EQ(0, memcmp(&fast.m_Behaviors.at(i).maxVelocity, &timed.m_Behaviors.at(i).maxVelocity, sizeof(double)));
+    ASSERT_EQ(fast.m_SelectedRollOuts.at(i), timed.m_SelectedRollOuts.at(i));
+  }
+
+  PlanningReplay missing;
+  ASSERT_FALSE(missing.Load("/tmp/op_planner_test_no_recording.oprec"));
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  ros::init(argc, argv, "TestNode");
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,279 @@
+/*
+ * Copyright 2020 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "op_planner/PlanningHelpers.h"
+#include "op_planner/PolygonGeometry.h"
+
+using namespace PlannerHNS;
+
+#include <ros/ros.h>
+#include <gtest/gtest.h>
+#include <vector>
+
+class TestSuite:
+  public ::testing::Test
+{
+public:
+  TestSuite() {}
+};
+
+// Star shaped (not convex) polygon with some horizontal and vertical edges
+std::vector<GPSPoint> CreatePolygon(const int& n_points, const double& cx, const double& cy)
+{
+  std::vector<GPSPoint> polygon;
+  for(int i = 0; i < n_points; i++)
+  {
+    double a = i * 2.0 * M_PI / n_points;
+    double r = (i % 2 == 0) ? 5.0 : 2.5;
+    polygon.push_back(GPSPoint(cx + round(r * cos(a) * 4.0) / 4.0, cy + round(r * sin(a) * 4.0) / 4.0, 0, 0));
+  }
+  return polygon;
+}
+
+// Grid of points on a 0.25 step, many of them on the polygon vertices and edges
+std::vector<GPSPoint> CreatePoints(const double& cx, const double& cy)
+{
+  std::vector<GPSPoint> points;
+  for(double x = -7; x <= 7; x += 0.25)
+    for(double y = -7; y <= 7; y += 0.25)
+      points.push_back(GPSPoint(cx + x, cy + y, 0, 0));
+  return points;
+}
+
+int PointInsidePolygonReference(const std::vector<GPSPoint>& polygon, const GPSPoint& p)
+{
+  PolygonShape shape;
+  shape.points = polygon;
+  return shape.PointInsidePolygon(shape, p);
+}
+
+TEST(TestSuite, BatchedPointInsideMatchesScalar)
+{
+  for(int n = 0; n < 20; n++)
+  {
+    std::vector<GPSPoint> polygon = CreatePolygon(n, 1.5, -2.0);
+    std::vector<GPSPoint> points = CreatePoints(1.5, -2.0);
+    for(int n_points = 0; n_points < 7; n_points++)
+    {
+      std::vector<GPSPoint> few(points.begin() + 100, points.begin() + 100 + n_points);
+      std::vector<int> inside;
+      PolygonGeometry::PointsInsidePolygon(polygon, few, inside);
+      ASSERT_EQ(few.size(), inside.size());
+      for(unsigned int i = 0; i < few.size(); i++)
+        ASSERT_EQ(PolygonGeometry::PointInsidePolygon(polygon, few.at(i)), inside.at(i));
+    }
+
+    std::vector<int> inside;
+    PolygonGeometry::PointsInsidePolygon(polygon, points, inside);
+    int n_inside = 0;
+    for(unsigned int i = 0; i < points.size(); i++)
+    {
+      int expected = PolygonGeometry::PointInsidePolygon(polygon, points.at(i));
+      ASSERT_EQ(expected, inside.at(i));
+      ASSERT_EQ(PointInsidePolygonReference(polygon, points.at(i)), expected);
+      if(expected == 1)
+        n_inside++;
+    }
+    if(n >= 3)
+    {
+      ASSERT_GT(n_inside, 0);
+    }
+  }
+
+  std::vector<GPSPoint> empty;
+  EXPECT_EQ(-1, PolygonGeometry::PointInsidePolygon(empty, GPSPoint()));
+}
+
+TEST(TestSuite, PolygonsOverlap)
+{
+  std::vector<GPSPoint> a, b;
+  PolygonGeometry::GetOrientedRectangle(GPSPoint(0, 0, 0, 0), 2, 4, 0, a);
+
+  PolygonGeometry::GetOrientedRectangle(GPSPoint(1.5, 0, 0, M_PI_4), 2, 4, 0, b);
+  EXPECT_TRUE(PolygonGeometry::PolygonsOverlap(a, b));
+  EXPECT_TRUE(PolygonGeometry::PolygonsOverlap(b, a));
+
+  PolygonGeometry::GetOrientedRectangle(GPSPoint(4, 0, 0, M_PI_4), 2, 4, 0, b);
+  EXPECT_FALSE(PolygonGeometry::PolygonsOverlap(a, b));
+
+  // the boxes of a and b overlap but the rotated rectangle is separated along its own axis
+  PolygonGeometry::GetOrientedRectangle(GPSPoint(2.6, 3.6, 0, M_PI_4), 0.5, 4, 0, b);
+  EXPECT_FALSE(PolygonGeometry::PolygonsOverlap(a, b));
+
+  // touching edges
+  PolygonGeometry::GetOrientedRectangle(GPSPoint(2, 0, 0, 0), 2, 4, 0, b);
+  EXPECT_TRUE(PolygonGeometry::PolygonsOverlap(a, b));
+
+  // inside
+  PolygonGeometry::GetOrientedRectangle(GPSPoint(0.1, 0.2, 0, 0.3), 0.2, 0.4, 0, b);
+  EXPECT_TRUE(PolygonGeometry::PolygonsOverlap(a, b));
+
+  // points
+  std::vector<GPSPoint> p(1, GPSPoint(0.5, 0.5, 0, 0));
+  EXPECT_TRUE(PolygonGeometry::PolygonsOverlap(a, p));
+  p.at(0) = GPSPoint(3, 3, 0, 0);
+  EXPECT_FALSE(PolygonGeometry::PolygonsOverlap(p, a));
+  EXPECT_FALSE(PolygonGeometry::PolygonsOverlap(a, std::vector<GPSPoint>()));
+}
+
+TEST(TestSuite, ExpandPolygon)
+{
+  std::vector<GPSPoint> rectangle, expanded, expected;
+  PolygonGeometry::GetOrientedRectangle(GPSPoint(3, -1, 0, 0.4), 2, 4, 0, rectangle);
+  PolygonGeometry::GetOrientedRectangle(GPSPoint(3, -1, 0, 0.4), 3, 5, 0, expected);
+
+  PolygonGeometry::ExpandPolygon(rectangle, 0.5, expanded);
+  ASSERT_EQ(expected.size(), expanded.size());
+  for(unsigned int i = 0; i < expected.size(); i++)
+  {
+    EXPECT_NEAR(expected.at(i).x, expanded.at(i).x, 1e-9);
+    EXPECT_NEAR(expected.at(i).y, expanded.at(i).y, 1e-9);
+  }
+
+  // same result for the clockwise polygon
+  std::vector<GPSPoint> reversed(rectangle.rbegin(), rectangle.rend());
+  PolygonGeometry::ExpandPolygon(reversed, 0.5, expanded);
+  for(unsigned int i = 0; i < expected.size(); i++)
+  {
+    EXPECT_NEAR(expected.at(expected.size()-1-i).x, expanded.at(i).x, 1e-9);
+    EXPECT_NEAR(expected.at(expected.size()-1-i).y, expanded.at(i).y, 1e-9);
+  }
+
+  PolygonGeometry::ExpandPolygon(expected, -0.5, expanded);
+  for(unsigned int i = 0; i < rectangle.size(); i++)
+  {
+    EXPECT_NEAR(rectangle.at(i).x, expanded.at(i).x, 1e-9);
+    EXPECT_NEAR(rectangle.at(i).y, expanded.at(i).y, 1e-9);
+  }
+}
+
+TEST(TestSuite, ContourPointsOfDetectedObjects)
+{
+  std::vector<DetectedObject> objects(2);
+  objects.at(0).center = WayPoint(5, 3, 1, 0.7);
+  objects.at(0).w = 2;
+  objects.at(0).l = 4.5;
+  objects.at(0).h = 1.6;
+  objects.at(1).center = WayPoint(500, 3, 1, 0.7);
+  PlanningHelpers::CalcContourPointsForDetectedObjects(WayPoint(0, 0, 0, 0), objects, 100);
+  ASSERT_EQ(1, objects.size());
+  ASSERT_EQ(4, objects.at(0).contour.size());
+
+  PolygonShape box;
+  box.points = objects.at(0).contour;
+  EXPECT_EQ(1, box.PointInsidePolygon(box, GPSPoint(5, 3, 0, 0)));
+  EXPECT_EQ(0, box.PointInsidePolygon(box, GPSPoint(8, 3, 0, 0)));
+  EXPECT_NEAR(1.8, objects.at(0).contour.at(0).z, 1e-9);
+  EXPECT_NEAR(2.0, hypot(objects.at(0).contour.at(1).y - objects.at(0).contour.at(0).y, objects.at(0).contour.at(1).x - objects.at(0).contour.at(0).x), 1e-9);
+  EXPECT_NEAR(4.5, hypot(objects.at(0).contour.at(2).y - objects.at(0).contour.at(1).y, objects.at(0).contour.at(2).x - objects.at(0).contour.at(1).x), 1e-9);
+}
+
+TEST(TestSuite, CachedContoursMatchComputedContours)
+{
+  std::vector<DetectedObject> objects(4);
+  for(unsigned int i = 0; i < objects.size(); i++)
+  {
+    objects.at(i).id = i + 1;
+    objects.at(i).center = WayPoint(10 + i * 10, (i == 2) ? 30 : 1, 1, 0.3 * i);
+    objects.at(i).w = 2;
+    objects.at(i).l = 4;
+    objects.at(i).h = 1.5;
+  }
+  objects.at(3).center.pos.x = 500;
+
+  std::vector<WayPoint> path;
+  for(int i = 0; i < 100; i++)
+    path.push_back(WayPoint(i, 0, 0, 0));
+  PlanningHelpers::CalcAngleAndCost(path);
+  RelativeInfo car_info;
+  PlanningHelpers::GetRelativeInfo(path, WayPoint(0, 0, 0, 0), car_info);
+  ContourCorridor corridor;
+  corridor.AddPath(path, car_info, 5, 60, 3);
+
+  ObjectContoursCache cache, near_cache;
+  for(int cycle = 0; cycle < 3; cycle++)
+  {
+    if(cycle == 2)
+      objects.at(1).center.pos.x += 0.5;
+
+    std::vector<DetectedObject> expected = objects;
+    PlanningHelpers::CalcContourPointsForDetectedObjects(WayPoint(0, 0, 0, 0), expected, 100);
+    std::vector<DetectedObject> cached = objects;
+    PlanningHelpers::CalcContourPointsForDetectedObjects(WayPoint(0, 0, 0, 0), cached, 100, cache);
+    std::vector<DetectedObject> near = objects;
+    PlanningHelpers::CalcContourPointsForDetectedObjects(WayPoint(0, 0, 0, 0), near, 100, near_cache, &corridor);
+
+    ASSERT_EQ(3, expected.size());
+    ASSERT_EQ(expected.size(), cached.size());
+    ASSERT_EQ(expected.size(), near.size());
+    for(unsigned int i = 0; i < expected.size(); i++)
+    {
+      EXPECT_EQ(expected.at(i).id, cached.at(i).id);
+      EXPECT_EQ(expected.at(i).id, near.at(i).id);
+      ASSERT_EQ(expected.at(i).contour.size(), cached.at(i).contour.size());
+      ASSERT_EQ((expected.at(i).id == 3) ? 0 : 4, near.at(i).contour.size());
+      for(unsigned int j = 0; j < expected.at(i).contour.size(); j++)
+      {
+        EXPECT_EQ(expected.at(i).contour.at(j).x, cached.at(i).contour.at(j).x);
+        EXPECT_EQ(expected.at(i).contour.at(j).y, cached.at(i).contour.at(j).y);
+        EXPECT_EQ(expected.at(i).contour.at(j).z, cached.at(i).contour.at(j).z);
+        if(near.at(i).contour.size() > 0)
+        {
+          EXPECT_EQ(expected.at(i).contour.at(j).x, near.at(i).contour.at(j).x);
+        }
+      }
+    }
+  }
+
+  // computed once, object 2 again when it moved. Object 3 is out of the corridor
+  EXPECT_EQ(4, cache.GetNumberOfComputations());
+  EXPECT_EQ(5, cache.GetNumberOfHits());
+  EXPECT_EQ(3, cache.GetNumberOfObjects());
+  EXPECT_EQ(3, near_cache.GetNumberOfComputations());
+  EXPECT_EQ(3, near_cache.GetNumberOfHits());
+  EXPECT_EQ(2, near_cache.GetNumberOfObjects());
+}
+
+TEST(TestSuite, BatchSameAsReference)
+{
+  std::vector<GPSPoint> polygon = CreatePolygon(16, 0, 0);
+  std::vector<GPSPoint> points;
+  for(int k = 0; k < 40; k++)
+  {
+    std::vector<GPSPoint> grid = CreatePoints(k * 0.01, 0);
+    points.insert(points.end(), grid.begin(), grid.end());
+  }
+
+  std::vector<double> xs(points.size()), ys(points.size());
+  for(unsigned int i = 0; i < points.size(); i++)
+  {
+    xs.at(i) = points.at(i).x;
+    ys.at(i) = points.at(i).y;
+  }
+
+  std::vector<int> inside(points.size());
+  PolygonGeometry::PointsInsidePolygon(polygon, xs.data(), ys.data(), xs.size(), inside.data());
+  for(unsigned int i = 0; i < points.size(); i++)
+    ASSERT_EQ(PointInsidePolygonReference(polygon, points.at(i)), inside.at(i));
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  ros::init(argc, argv, "TestNode");
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,107 @@
+/*
+ * Copyright 2020 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "op_planner/PlanningHelpers.h"
+#include "op_planner/PolylineDistance.h"
+
+using namespace PlannerHNS;
+
+#include <ros/ros.h>
+#include <gtest/gtest.h>
+#include <vector>
+
+class TestSuite:
+  public ::testing::Test
+{
+public:
+  TestSuite() {}
+};
+
+// Smooth path with 0.5 meter density, like the planner roll outs
+PathSoA CreatePolyline(const int& n_points)
+{
+  std::vector<WayPoint> path;
+  for(int i = 0; i < n_points; i++)
+    path.push_back(WayPoint(i * 0.5, 15.0 * sin(i / 80.0), 0, 0));
+
+  return PathSoA(path);
+}
+
+// Contour points of a few obstacles around the path
+std::vector<WayPoint> CreateContourPoints(const int& n_points, const double& length)
+{
+  std::vector<WayPoint> points;
+  for(int i = 0; i < n_points; i++)
+  {
+    double x = fmod(i * 7.31, length);
+    double y = 15.0 * sin(x / 40.0) + 3.0 * sin(i * 0.37);
+    points.push_back(WayPoint(x, y, 0, 0));
+  }
+  return points;
+}
+
+TEST(TestSuite, KernelMatchesScalar)
+{
+  for(int n = 0; n < 40; n++)
+  {
+    PathSoA polyline = CreatePolyline(n);
+    std::vector<WayPoint> points = CreateContourPoints(50, n * 0.5 + 1);
+    for(unsigned int i = 0; i < points.size(); i++)
+    {
+      double d = 0, d_scalar = 0;
+      int index = PolylineDistance::GetClosestVertex(polyline.x.data(), polyline.y.data(), n, points.at(i).pos.x, points.at(i).pos.y, d);
+      int index_scalar = PolylineDistance::GetClosestVertexScalar(polyline.x.data(), polyline.y.data(), n, points.at(i).pos.x, points.at(i).pos.y, d_scalar);
+      ASSERT_EQ(index_scalar, index);
+      if(index >= 0)
+      {
+        ASSERT_DOUBLE_EQ(d_scalar, d);
+      }
+    }
+  }
+
+  // equal distances in different lanes, the lowest index wins like the scalar scan
+  std::vector<double> xs = {5, 4, 3, 1, 9, 1, 8, 1, 1, 7};
+  std::vector<double> ys(xs.size(), 0);
+  double d = 0;
+  ASSERT_EQ(3, PolylineDistance::GetClosestVertex(xs.data(), ys.data(), xs.size(), 0, 0, d));
+  ASSERT_EQ(3, PolylineDistance::GetClosestVertexScalar(xs.data(), ys.data(), xs.size(), 0, 0, d));
+}
+
+TEST(TestSuite, BatchSameAsScalar)
+{
+  PathSoA polyline = CreatePolyline(2000);
+  std::vector<WayPoint> points = CreateContourPoints(20000, 1000);
+
+  std::vector<int> indices;
+  std::vector<double> distances;
+  PolylineDistance::GetClosestVertices(polyline, points, indices, distances);
+  ASSERT_EQ(indices.size(), points.size());
+  ASSERT_EQ(distances.size(), points.size());
+
+  double d = 0;
+  for(unsigned int i = 0; i < points.size(); i++)
+  {
+    ASSERT_EQ(indices.at(i), PolylineDistance::GetClosestVertexScalar(polyline.x.data(), polyline.y.data(), polyline.size(), points.at(i).pos.x, points.at(i).pos.y, d));
+    ASSERT_DOUBLE_EQ(distances.at(i), d);
+  }
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  ros::init(argc, argv, "TestNode");
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,261 @@
+/*
+ * Copyright 2020 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "op_planner/RoadNetworkSnapshot.h"
+#include "op_planner/MappingHelpers.h"
+
+using namespace PlannerHNS;
+
+#include <ros/ros.h>
+#include <gtest/gtest.h>
+#include <vector>
+#include <iostream>
+#include <fstream>
+#include <cstdio>
+
+class TestSuite:
+  public ::testing::Test
+{
+public:
+  TestSuite() {}
+};
+
+// Two rows of chained lanes 3 meters apart, linked like a loaded vector map, with a few map items pointing to the lanes
+void CreateLinkedMap(RoadNetwork& map)
+{
+  RoadSegment segment;
+  segment.id = 1;
+  int point_id = 1;
+  for(int i = 0; i < 8; i++)
+  {
+    Lane l;
+    l.id = i + 1;
+    l.speed = 10 + i;
+    for(int p = 0; p < 20; p++)
+    {
+      WayPoint wp((i % 4) * 20 + p, (i / 4) * 3.0, 0.5, 0);
+      wp.id = point_id++;
+      wp.laneId = l.id;
+      wp.v = l.speed;
+      if(p == 0 && i == 2)
+        wp.actionCost.push_back(std::make_pair(LEFT_TURN_ACTION, 5.0));
+      l.points.push_back(wp);
+    }
+    if(i % 4 < 3) l.toIds.push_back(i + 2);
+    if(i % 4 > 0) l.fromIds.push_back(i);
+    segment.Lanes.push_back(l);
+  }
+  map.roadSegments.push_back(segment);
+
+  MappingHelpers::LinkLanesPointers(map);
+  MappingHelpers::LinkMissingBranchingWayPointsV2(map);
+  MappingHelpers::FindAdjacentLanesV2(map, 1);
+
+  std::vector<Lane>& lanes = map.roadSegments.at(0).Lanes;
+  TrafficLight tl;
+  tl.id = 3;
+  tl.pos = GPSPoint(30, 1, 0, 0.5);
+  tl.laneIds.push_back(lanes.at(1).id);
+  tl.pLanes.push_back(&lanes.at(1));
+  map.trafficLights.push_back(tl);
+  lanes.at(1).trafficlights.push_back(tl);
+
+  StopLine sl;
+  sl.id = 4;
+  sl.laneId = lanes.at(1).id;
+  sl.pLane = &lanes.at(1);
+  sl.trafficLightID = tl.id;
+  sl.points.push_back(GPSPoint(38, -1, 0, 0));
+  sl.points.push_back(GPSPoint(38, 1, 0, 0));
+  map.stopLines.push_back(sl);
+  lanes.at(1).stopLines.push_back(sl);
+  lanes.at(1).points.at(18).stopLineID = sl.id;
+
+  Curb c;
+  c.id = 5;
+  c.pLane = &lanes.at(5);
+  c.points.push_back(GPSPoint(25, 5, 0, 0));
+  map.curbs.push_back(c);
+
+  Boundary b;
+  b.id = 6;
+  b.pSegment = &map.roadSegments.at(0);
+  b.points.push_back(GPSPoint(0, 0, 0, 0));
+  b.points.push_back(GPSPoint(80, 0, 0, 0));
+  b.points.push_back(GPSPoint(80, 5, 0, 0));
+  map.boundaries.push_back(b);
+
+  TrafficSign ts;
+  ts.id = 7;
+  ts.signType = MAX_SPEED_SIGN;
+  ts.value = 40;
+  ts.strValue = "max 40";
+  ts.pLane = &lanes.at(6);
+  map.signs.push_back(ts);
+}
+
+int GetPointIndex(const RoadNetwork& map, const WayPoint* pWP)
+{
+  if(pWP == nullptr) return -1;
+  int index = 0;
+  for(unsigned int i = 0; i < map.roadSegments.at(0).Lanes.size(); i++)
+  {
+    const std::vector<WayPoint>& points = map.roadSegments.at(0).Lanes.at(i).points;
+    if(points.size() > 0 && pWP >= &points.front() && pWP <= &points.back())
+      return index + (pWP - &points.front());
+    index += points.size();
+  }
+  return -2; // not in this map
+}
+
+int GetLaneIndex(const RoadNetwork& map, const Lane* pL)
+{
+  if(pL == nullptr) return -1;
+  const std::vector<Lane>& lanes = map.roadSegments.at(0).Lanes;
+  if(pL >= &lanes.front() && pL <= &lanes.back())
+    return pL - &lanes.front();
+  return -2;
+}
+
+TEST(TestSuite, SnapshotKeepsDataAndLinks)
+{
+  RoadNetwork map, loaded_map;
+  CreateLinkedMap(map);
+  std::string file_name = "/tmp/test_op_planner_map.snapshot";
+
+  ASSERT_TRUE(RoadNetworkSnapshot::SaveToFile(file_name, map, 1234));
+  ASSERT_TRUE(RoadNetworkSnapshot::LoadFromFile(file_name, 1234, loaded_map));
+  ASSERT_NE(0UL, loaded_map.version);
+  ASSERT_TRUE(loaded_map.spatialIndex.IsBuilt());
+
+  const std::vector<Lane>& lanes = map.roadSegments.at(0).Lanes;
+  const std::vector<Lane>& loaded_lanes = loaded_map.roadSegments.at(0).Lanes;
+  ASSERT_EQ(lanes.size(), loaded_lanes.size());
+  int n_fronts = 0, n_sides = 0;
+  for(unsigned int i = 0; i < lanes.size(); i++)
+  {
+    const Lane& l = lanes.at(i);
+    const Lane& ll = loaded_lanes.at(i);
+    ASSERT_EQ(l.id, ll.id);
+    ASSERT_EQ(l.toIds, ll.toIds);
+    ASSERT_DOUBLE_EQ(l.speed, ll.speed);
+    ASSERT_EQ(l.pRoad == nullptr, ll.pRoad == nullptr);
+    ASSERT_EQ(l.toLanes.size(), ll.toLanes.size());
+    for(unsigned int j = 0; j < l.toLanes.size(); j++)
+      ASSERT_EQ(GetLaneIndex(map, l.toLanes.at(j)), GetLaneIndex(loaded_map, ll.toLanes.at(j)));
+    ASSERT_EQ(GetLaneIndex(map, l.pLeftLane), GetLaneIndex(loaded_map, ll.pLeftLane));
+    ASSERT_EQ(GetLaneIndex(map, l.pRightLane), GetLaneIndex(loaded_map, ll.pRightLane));
+
+    ASSERT_EQ(l.points.size(), ll.points.size());
+    for(unsigned int p = 0; p < l.points.size(); p++)
+    {
+      const WayPoint& wp = l.points.at(p);
+      const WayPoint& lwp = ll.points.at(p);
+      ASSERT_EQ(wp.id, lwp.id);
+      ASSERT_DOUBLE_EQ(wp.pos.x, lwp.pos.x);
+      ASSERT_DOUBLE_EQ(wp.pos.y, lwp.pos.y);
+      ASSERT_DOUBLE_EQ(wp.pos.z, lwp.pos.z);
+      ASSERT_DOUBLE_EQ(wp.pos.a, lwp.pos.a);
+      ASSERT_DOUBLE_EQ(wp.v, lwp.v);
+      ASSERT_EQ(wp.stopLineID, lwp.stopLineID);
+      ASSERT_EQ(wp.actionCost.size(), lwp.actionCost.size());
+      ASSERT_EQ(&ll, lwp.pLane);
+      ASSERT_EQ(GetPointIndex(map, wp.pLeft), GetPointIndex(loaded_map, lwp.pLeft));
+      ASSERT_EQ(GetPointIndex(map, wp.pRight), GetPointIndex(loaded_map, lwp.pRight));
+      ASSERT_EQ(wp.pFronts.size(), lwp.pFronts.size());
+      for(unsigned int j = 0; j < wp.pFronts.size(); j++)
+        ASSERT_EQ(GetPointIndex(map, wp.pFronts.at(j)), GetPointIndex(loaded_map, lwp.pFronts.at(j)));
+      ASSERT_EQ(wp.pBacks.size(), lwp.pBacks.size());
+      for(unsigned int j = 0; j < wp.pBacks.size(); j++)
+        ASSERT_EQ(GetPointIndex(map, wp.pBacks.at(j)), GetPointIndex(loaded_map, lwp.pBacks.at(j)));
+      n_fronts += wp.pFronts.size();
+      if(wp.pLeft != nullptr) n_sides++;
+    }
+  }
+  ASSERT_GT(n_fronts, 0);
+  ASSERT_GT(n_sides, 0);
+  ASSERT_EQ(LEFT_TURN_ACTION, loaded_lanes.at(2).points.at(0).actionCost.at(0).first);
+
+  ASSERT_EQ(1, loaded_map.trafficLights.size());
+  ASSERT_EQ(&loaded_lanes.at(1), loaded_map.trafficLights.at(0).pLanes.at(0));
+  ASSERT_EQ(1, loaded_lanes.at(1).trafficlights.size());
+  ASSERT_EQ(1, loaded_map.stopLines.size());
+  ASSERT_EQ(&loaded_lanes.at(1), loaded_map.stopLines.at(0).pLane);
+  ASSERT_EQ(2, loaded_map.stopLines.at(0).points.size());
+  ASSERT_EQ(&loaded_lanes.at(5), loaded_map.curbs.at(0).pLane);
+  ASSERT_EQ(&loaded_map.roadSegments.at(0), loaded_map.boundaries.at(0).pSegment);
+  ASSERT_EQ(3, loaded_map.boundaries.at(0).points.size());
+  ASSERT_EQ("max 40", loaded_map.signs.at(0).strValue);
+  ASSERT_EQ(&loaded_lanes.at(6), loaded_map.signs.at(0).pLane);
+
+  remove(file_name.c_str());
+}
+
+TEST(TestSuite, StaleOrDamagedSnapshotIsNotLoaded)
+{
+  RoadNetwork map;
+  CreateLinkedMap(map);
+  std::string file_name = "/tmp/test_op_planner_map_stale.snapshot";
+  ASSERT_TRUE(RoadNetworkSnapshot::SaveToFile(file_name, map, 1234));
+
+  RoadNetwork loaded_map;
+  ASSERT_FALSE(RoadNetworkSnapshot::LoadFromFile(file_name, 4321, loaded_map));
+  ASSERT_EQ(0, loaded_map.roadSegments.size());
+  ASSERT_FALSE(RoadNetworkSnapshot::LoadFromFile("/tmp/test_op_planner_no_such.snapshot", 1234, loaded_map));
+
+  // cut the file in the middle of the waypoints
+  std::ifstream in(file_name.c_str(), std::ios::binary);
+  std::string data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+  in.close();
+  std::ofstream out(file_name.c_str(), std::ios::binary | std::ios::trunc);
+  out.write(data.data(), data.size()/2);
+  out.close();
+  ASSERT_FALSE(RoadNetworkSnapshot::LoadFromFile(file_name, 1234, loaded_map));
+  ASSERT_EQ(0, loaded_map.roadSegments.size());
+
+  remove(file_name.c_str());
+}
+
+TEST(TestSuite, FilesSignatureFollowsTheFiles)
+{
+  std::string file_name = "/tmp/test_op_planner_map_signature.csv";
+  std::vector<std::string> files;
+  files.push_back(file_name);
+
+  remove(file_name.c_str());
+  unsigned long long missing_signature = RoadNetworkSnapshot::GetFilesSignature(files);
+
+  std::ofstream out(file_name.c_str());
+  out << "PID,B,L,H" << std::endl;
+  out.close();
+  unsigned long long signature = RoadNetworkSnapshot::GetFilesSignature(files);
+  ASSERT_NE(missing_signature, signature);
+  ASSERT_EQ(signature, RoadNetworkSnapshot::GetFilesSignature(files));
+
+  out.open(file_name.c_str(), std::ios::app);
+  out << "1,0,0,0" << std::endl;
+  out.close();
+  ASSERT_NE(signature, RoadNetworkSnapshot::GetFilesSignature(files));
+
+  remove(file_name.c_str());
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  ros::init(argc, argv, "TestNode");
+  return RUN_ALL_TESTS();
+}
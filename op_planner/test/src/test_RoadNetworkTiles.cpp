@@ -0,0 +1,257 @@
+/*
+ * Copyright 2020 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "op_planner/RoadNetworkTiles.h"
+#include "op_planner/MappingHelpers.h"
+
+using namespace PlannerHNS;
+
+#include <ros/ros.h>
+#include <gtest/gtest.h>
+#include <vector>
+#include <iostream>
+#include <sstream>
+#include <cstdio>
+#include <sys/stat.h>
+#include <unistd.h>
+
+class TestSuite:
+  public ::testing::Test
+{
+public:
+  TestSuite() {}
+};
+
+static const std::string TILES_FOLDER = "/tmp/test_op_planner_tiles/";
+
+// Two rows of 50 chained lanes 3 meters apart along x (1 km), each lane is 20 meters long
+void CreateCorridorMap(RoadNetwork& map)
+{
+  RoadSegment segment;
+  segment.id = 1;
+  int point_id = 1;
+  for(int r = 0; r < 2; r++)
+  {
+    for(int i = 0; i < 50; i++)
+    {
+      Lane l;
+      l.id = r * 100 + i + 1;
+      for(int p = 0; p < 20; p++)
+      {
+        WayPoint wp(i * 20 + p, r * 3.0, 0, 0);
+        wp.id = point_id++;
+        wp.laneId = l.id;
+        l.points.push_back(wp);
+      }
+      if(i < 49) l.toIds.push_back(l.id + 1);
+      if(i > 0) l.fromIds.push_back(l.id - 1);
+      segment.Lanes.push_back(l);
+    }
+  }
+  map.roadSegments.push_back(segment);
+
+  MappingHelpers::LinkLanesPointers(map);
+  MappingHelpers::LinkMissingBranchingWayPointsV2(map);
+  MappingHelpers::FindAdjacentLanesV2(map, 1);
+
+  TrafficLight tl;
+  tl.id = 1;
+  tl.pos = GPSPoint(150, 1, 0, 0);
+  tl.laneIds.push_back(8);
+  tl.pLanes.push_back(&map.roadSegments.at(0).Lanes.at(7));
+  map.trafficLights.push_back(tl);
+}
+
+void WriteCorridorTiles()
+{
+  mkdir(TILES_FOLDER.c_str(), 0755);
+  RoadNetwork map;
+  CreateCorridorMap(map);
+  ASSERT_TRUE(RoadNetworkTiles::WriteTiles(map, 100, TILES_FOLDER));
+}
+
+void RemoveCorridorTiles()
+{
+  for(int ix = 0; ix < 10; ix++)
+  {
+    std::ostringstream file_name;
+    file_name << TILES_FOLDER << "tile_" << ix << "_0.snapshot";
+    remove(file_name.str().c_str());
+  }
+  remove((TILES_FOLDER + "op_planner_map_tiles.catalog").c_str());
+  rmdir(TILES_FOLDER.c_str());
+}
+
+const Lane* GetMapLane(const RoadNetwork& map, const int& laneId)
+{
+  for(unsigned int rs = 0; rs < map.roadSegments.size(); rs++)
+  {
+    for(unsigned int i = 0; i < map.roadSegments.at(rs).Lanes.size(); i++)
+    {
+      if(map.roadSegments.at(rs).Lanes.at(i).id == laneId)
+        return &map.roadSegments.at(rs).Lanes.at(i);
+    }
+  }
+  return nullptr;
+}
+
+TEST(TestSuite, ActiveTilesAroundPose)
+{
+  WriteCorridorTiles();
+  RoadNetworkTiles tiles;
+  ASSERT_TRUE(tiles.Open(TILES_FOLDER));
+  ASSERT_EQ(10, tiles.GetNumberOfTiles());
+  tiles.SetLoadRadius(60);
+
+  RoadNetwork map;
+  ASSERT_TRUE(tiles.UpdateActiveTiles(WayPoint(150, 1, 0, 0), map));
+  ASSERT_EQ(3, tiles.GetNumberOfActiveTiles());
+  ASSERT_EQ(1, map.roadSegments.size());
+  ASSERT_EQ(30, map.roadSegments.at(0).Lanes.size());
+  ASSERT_TRUE(map.spatialIndex.IsBuilt());
+
+  //links inside the active tiles are resolved, the ones leaving them stay null
+  for(unsigned int i = 0; i < map.roadSegments.at(0).Lanes.size(); i++)
+  {
+    const Lane& l = map.roadSegments.at(0).Lanes.at(i);
+    ASSERT_EQ(1, l.toIds.size());
+    if(tiles.IsLaneActive(l.toIds.at(0)))
+    {
+      ASSERT_EQ(1, l.toLanes.size());
+      ASSERT_EQ(l.toIds.at(0), l.toLanes.at(0)->id);
+      ASSERT_EQ(&l.toLanes.at(0)->points.at(0), l.points.back().pFronts.at(0));
+    }
+    else
+    {
+      ASSERT_EQ(0, l.toLanes.size());
+      ASSERT_EQ(0, l.points.back().pFronts.size());
+    }
+
+    for(unsigned int p = 0; p < l.points.size(); p++)
+    {
+      ASSERT_EQ(&l, l.points.at(p).pLane);
+      if(l.points.at(p).pLeft != nullptr)
+      {
+        ASSERT_EQ(l.points.at(p).LeftLnId, l.points.at(p).pLeft->pLane->id);
+      }
+      if(l.points.at(p).pRight != nullptr)
+      {
+        ASSERT_EQ(l.points.at(p).RightLnId, l.points.at(p).pRight->pLane->id);
+      }
+    }
+  }
+
+  const Lane* pLane = GetMapLane(map, 8);
+  ASSERT_NE(nullptr, pLane);
+  ASSERT_EQ(108, pLane->pLeftLane->id);
+  ASSERT_EQ(1, map.trafficLights.size());
+  ASSERT_EQ(1, map.trafficLights.at(0).pLanes.size());
+  ASSERT_EQ(pLane, map.trafficLights.at(0).pLanes.at(0));
+  ASSERT_EQ(nullptr, GetMapLane(map, 16));
+
+  //same tiles, the map is left alone
+  unsigned long version = map.version;
+  ASSERT_FALSE(tiles.UpdateActiveTiles(WayPoint(155, 1, 0, 0), map));
+  ASSERT_EQ(version, map.version);
+
+  //far away, the old tiles are evicted
+  ASSERT_TRUE(tiles.UpdateActiveTiles(WayPoint(550, 1, 0, 0), map));
+  ASSERT_NE(version, map.version);
+  ASSERT_EQ(3, tiles.GetNumberOfLoadedTiles());
+  ASSERT_EQ(nullptr, GetMapLane(map, 8));
+  ASSERT_NE(nullptr, GetMapLane(map, 28));
+  ASSERT_EQ(0, map.trafficLights.size());
+
+  tiles.Close();
+  RemoveCorridorTiles();
+}
+
+TEST(TestSuite, FollowLinkOutOfActiveTiles)
+{
+  WriteCorridorTiles();
+  RoadNetworkTiles tiles;
+  ASSERT_TRUE(tiles.Open(TILES_FOLDER));
+  tiles.SetLoadRadius(60);
+
+  RoadNetwork map;
+  tiles.UpdateActiveTiles(WayPoint(150, 1, 0, 0), map);
+  ASSERT_EQ(0, GetMapLane(map, 15)->toLanes.size());
+  ASSERT_FALSE(tiles.IsLaneActive(16));
+
+  ASSERT_TRUE(tiles.ActivateLaneTile(16, map));
+  ASSERT_TRUE(tiles.IsLaneActive(16));
+  ASSERT_EQ(4, tiles.GetNumberOfActiveTiles());
+  ASSERT_EQ(1, GetMapLane(map, 15)->toLanes.size());
+  ASSERT_EQ(16, GetMapLane(map, 15)->toLanes.at(0)->id);
+  ASSERT_FALSE(tiles.ActivateLaneTile(1000, map));
+
+  //the linked tile stays while it is close enough
+  ASSERT_FALSE(tiles.UpdateActiveTiles(WayPoint(150, 1, 0, 0), map));
+  ASSERT_TRUE(tiles.IsLaneActive(16));
+
+  tiles.Close();
+  RemoveCorridorTiles();
+}
+
+TEST(TestSuite, PrefetchAlongPath)
+{
+  WriteCorridorTiles();
+  RoadNetworkTiles tiles;
+  ASSERT_TRUE(tiles.Open(TILES_FOLDER));
+  tiles.SetLoadRadius(60);
+
+  RoadNetwork map;
+  tiles.UpdateActiveTiles(WayPoint(50, 1, 0, 0), map);
+
+  std::vector<WayPoint> path;
+  for(int x = 50; x < 1000; x += 5)
+    path.push_back(WayPoint(x, 1, 0, 0));
+  tiles.PrefetchAlongPath(path);
+
+  ASSERT_TRUE(tiles.UpdateActiveTiles(WayPoint(850, 1, 0, 0), map));
+  ASSERT_EQ(3, tiles.GetNumberOfActiveTiles());
+  ASSERT_NE(nullptr, GetMapLane(map, 43));
+  ASSERT_EQ(nullptr, GetMapLane(map, 3));
+  ASSERT_EQ(44, GetMapLane(map, 43)->toLanes.at(0)->id);
+
+  //prefetched tiles are kept until the next prefetch, then only the active ones and the one inside the evict radius stay
+  tiles.WaitForPrefetch();
+  ASSERT_EQ(10, tiles.GetNumberOfLoadedTiles());
+  tiles.PrefetchAlongPath(std::vector<WayPoint>());
+  tiles.UpdateActiveTiles(WayPoint(850, 1, 0, 0), map);
+  ASSERT_EQ(4, tiles.GetNumberOfLoadedTiles());
+
+  tiles.Close();
+  RemoveCorridorTiles();
+}
+
+TEST(TestSuite, MissingCatalog)
+{
+  RoadNetworkTiles tiles;
+  ASSERT_FALSE(tiles.Open("/tmp/test_op_planner_no_tiles/"));
+  ASSERT_FALSE(tiles.IsOpen());
+
+  RoadNetwork map;
+  ASSERT_FALSE(tiles.UpdateActiveTiles(WayPoint(0, 0, 0, 0), map));
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  ros::init(argc, argv, "TestNode");
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,180 @@
+/*
+ * Copyright 2020 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "op_planner/PlanningHelpers.h"
+#include "op_planner/RollOutsCache.h"
+
+using namespace PlannerHNS;
+
+#include <ros/ros.h>
+#include <gtest/gtest.h>
+#include <vector>
+#include <iostream>
+
+class TestSuite:
+  public ::testing::Test
+{
+public:
+  TestSuite() {}
+};
+
+// Curved center line of 100 meters with 0.25 meter density
+void CreateCenter(const double& y_offset, std::vector<WayPoint>& center)
+{
+  center.clear();
+  for(int i = 0; i < 400; i++)
+  {
+    WayPoint wp(i * 0.25, y_offset + 4.0 * sin(i / 120.0), 0, 0);
+    wp.v = 5;
+    center.push_back(wp);
+  }
+  PlanningHelpers::CalcAngleAndCost(center);
+}
+
+WayPoint GetCarPose(const std::vector<WayPoint>& center, const double& s)
+{
+  RelativeInfo info;
+  WayPoint p = center.at(0);
+  p.pos.x = s;
+  PlanningHelpers::GetRelativeInfo(center, p, info);
+  return info.perp_point;
+}
+
+bool GenerateRollOuts(const std::vector<WayPoint>& center, const WayPoint& carPos, const PlanningParams& params,
+    RollOutsCache* pCache, std::vector<std::vector<WayPoint> >& rollOuts)
+{
+  int s_index = 0, e_index = 0;
+  std::vector<double> e_distances;
+  std::vector<WayPoint> sampled;
+  if(pCache)
+    return PlanningHelpers::CalculateRollInTrajectories(carPos, 2.0, center, s_index, e_index, e_distances, rollOuts, params.microPlanDistance,
+        params.maxSpeed, params.carTipMargin, params.rollInMargin, params.rollInSpeedFactor, params.pathDensity, params.rollOutDensity,
+        params.rollOutNumber, params.smoothingDataWeight, params.smoothingSmoothWeight, params.smoothingToleranceError, false, *pCache, sampled);
+
+  PlanningHelpers::CalculateRollInTrajectories(carPos, 2.0, center, s_index, e_index, e_distances, rollOuts, params.microPlanDistance,
+      params.maxSpeed, params.carTipMargin, params.rollInMargin, params.rollInSpeedFactor, params.pathDensity, params.rollOutDensity,
+      params.rollOutNumber, params.smoothingDataWeight, params.smoothingSmoothWeight, params.smoothingToleranceError, false, sampled);
+  return false;
+}
+
+TEST(TestSuite, ShiftMatchesFullGeneration)
+{
+  PlanningParams params;
+  std::vector<WayPoint> center;
+  CreateCenter(0, center);
+
+  RollOutsCache cache;
+  std::vector<std::vector<WayPoint> > rollOuts, fullRollOuts;
+  ASSERT_FALSE(GenerateRollOuts(center, GetCarPose(center, 10.0), params, &cache, rollOuts));
+  ASSERT_TRUE(cache.bValid);
+
+  // a few centimeters per cycle stays on the cached roll outs
+  for(int i = 1; i <= 10; i++)
+  {
+    WayPoint carPos = GetCarPose(center, 10.0 + i*0.1);
+    ASSERT_TRUE(GenerateRollOuts(center, carPos, params, &cache, rollOuts));
+    GenerateRollOuts(center, carPos, params, 0, fullRollOuts);
+
+    ASSERT_EQ(fullRollOuts.size(), rollOuts.size());
+    for(unsigned int j = 0; j < rollOuts.size(); j++)
+    {
+      ASSERT_EQ(fullRollOuts.at(j).size(), rollOuts.at(j).size());
+      for(unsigned int k = 0; k < rollOuts.at(j).size(); k++)
+        ASSERT_LT(distance2points(fullRollOuts.at(j).at(k).pos, rollOuts.at(j).at(k).pos), 0.15);
+    }
+  }
+  ASSERT_EQ(10u, cache.nShifts);
+  ASSERT_EQ(1u, cache.nGenerations);
+
+  // moving past the shift limit generates again
+  ASSERT_FALSE(GenerateRollOuts(center, GetCarPose(center, 10.0 + params.carTipMargin), params, &cache, rollOuts));
+  ASSERT_EQ(2u, cache.nGenerations);
+}
+
+TEST(TestSuite, NewCenterLineGeneratesAgain)
+{
+  PlanningParams params;
+  std::vector<WayPoint> center;
+  CreateCenter(0, center);
+
+  RollOutsCache cache;
+  std::vector<std::vector<WayPoint> > rollOuts;
+  ASSERT_FALSE(GenerateRollOuts(center, GetCarPose(center, 10.0), params, &cache, rollOuts));
+  ASSERT_TRUE(GenerateRollOuts(center, GetCarPose(center, 10.05), params, &cache, rollOuts));
+
+  CreateCenter(0.01, center);
+  ASSERT_FALSE(GenerateRollOuts(center, GetCarPose(center, 10.1), params, &cache, rollOuts));
+
+  // lateral jump of the car
+  WayPoint carPos = GetCarPose(center, 10.15);
+  carPos.pos.y += 0.5;
+  ASSERT_FALSE(GenerateRollOuts(center, carPos, params, &cache, rollOuts));
+  ASSERT_EQ(3u, cache.nGenerations);
+}
+
+TEST(TestSuite, TemplateRebuildsOnlyOnChange)
+{
+  PlanningParams params;
+  std::vector<WayPoint> center;
+  CreateCenter(0, center);
+
+  RollOutsTemplate rollOutsTemplate;
+  int s_index = 0, e_index = 0;
+  std::vector<double> e_distances;
+  std::vector<WayPoint> sampled;
+  std::vector<std::vector<WayPoint> > rollOuts, fullRollOuts;
+  for(int i = 0; i < 5; i++)
+  {
+    WayPoint carPos = GetCarPose(center, 10.0 + i);
+    PlanningHelpers::CalculateRollInTrajectories(carPos, 2.0, center, s_index, e_index, e_distances, rollOuts, params.microPlanDistance,
+        params.maxSpeed, params.carTipMargin, params.rollInMargin, params.rollInSpeedFactor, params.pathDensity, params.rollOutDensity,
+        params.rollOutNumber, params.smoothingDataWeight, params.smoothingSmoothWeight, params.smoothingToleranceError, false,
+        rollOutsTemplate, sampled);
+    GenerateRollOuts(center, carPos, params, 0, fullRollOuts);
+
+    ASSERT_EQ(fullRollOuts.size(), rollOuts.size());
+    for(unsigned int j = 0; j < rollOuts.size(); j++)
+    {
+      ASSERT_EQ(fullRollOuts.at(j).size(), rollOuts.at(j).size());
+      for(unsigned int k = 0; k < rollOuts.at(j).size(); k++)
+      {
+        ASSERT_EQ(fullRollOuts.at(j).at(k).pos.x, rollOuts.at(j).at(k).pos.x);
+        ASSERT_EQ(fullRollOuts.at(j).at(k).pos.y, rollOuts.at(j).at(k).pos.y);
+      }
+    }
+  }
+  ASSERT_EQ(1u, rollOutsTemplate.nBuilds);
+  ASSERT_EQ(1u, rollOutsTemplate.nCenterBuilds);
+  ASSERT_EQ(params.rollOutNumber+1, (int)e_distances.size());
+
+  rollOutsTemplate.SetParams(params.rollOutNumber, params.rollOutDensity*2.0);
+  ASSERT_EQ(2u, rollOutsTemplate.nBuilds);
+  ASSERT_DOUBLE_EQ(rollOutsTemplate.endLaterals.back(), params.rollOutDensity*2.0*(params.rollOutNumber - params.rollOutNumber/2));
+
+  rollOutsTemplate.SetCenter(center);
+  ASSERT_EQ(1u, rollOutsTemplate.nCenterBuilds);
+  center.at(200).pos.a += 0.01;
+  rollOutsTemplate.SetCenter(center);
+  ASSERT_EQ(2u, rollOutsTemplate.nCenterBuilds);
+  ASSERT_EQ(cos(center.at(200).pos.a + M_PI_2), rollOutsTemplate.normalX.at(200));
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  ros::init(argc, argv, "TestNode");
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,156 @@
+/*
+ * Copyright 2020 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "op_planner/PlannerH.h"
+#include "op_planner/MappingHelpers.h"
+#include "op_planner/RouteCache.h"
+
+using namespace PlannerHNS;
+
+#include <ros/ros.h>
+#include <gtest/gtest.h>
+#include <vector>
+
+class TestSuite:
+  public ::testing::Test
+{
+public:
+  TestSuite() {}
+};
+
+// One straight lane along x, 1 meter point density, every point linked to the next one
+void CreateStraightLaneMap(const int& n_points, RoadNetwork& map)
+{
+  RoadSegment segment;
+  segment.id = 1;
+  Lane l;
+  l.id = 1;
+  for(int i = 0; i < n_points; i++)
+  {
+    WayPoint wp(i, 0, 0, 0);
+    wp.id = i + 1;
+    wp.laneId = l.id;
+    l.points.push_back(wp);
+  }
+  segment.Lanes.push_back(l);
+  map.roadSegments.push_back(segment);
+
+  Lane* pL = &map.roadSegments.at(0).Lanes.at(0);
+  for(unsigned int i = 0; i < pL->points.size(); i++)
+  {
+    pL->points.at(i).pLane = pL;
+    if(i + 1 < pL->points.size())
+    {
+      pL->points.at(i).pFronts.push_back(&pL->points.at(i + 1));
+      pL->points.at(i + 1).pBacks.push_back(&pL->points.at(i));
+    }
+  }
+}
+
+RouteCacheKey CreateKey(const RoadNetwork* pMap, const unsigned long& version, const int& goal_id)
+{
+  RouteCacheKey key;
+  key.pMap = pMap;
+  key.mapVersion = version;
+  key.startLaneId = 1;
+  key.startWaypointId = 1;
+  key.goalLaneId = 1;
+  key.goalWaypointId = goal_id;
+  return key;
+}
+
+TEST(TestSuite, CacheDropsLeastRecentlyUsed)
+{
+  RoadNetwork map;
+  RouteCache cache(2);
+  std::vector<std::vector<WayPoint> > paths(1, std::vector<WayPoint>(3)), found_paths;
+  double distance = 0;
+
+  cache.Insert(CreateKey(&map, 1, 10), paths, 10);
+  cache.Insert(CreateKey(&map, 1, 20), paths, 20);
+  ASSERT_TRUE(cache.Find(CreateKey(&map, 1, 10), found_paths, distance));
+  ASSERT_EQ(10, distance);
+  ASSERT_EQ(paths.at(0).size(), found_paths.at(0).size());
+
+  // 20 is the least recently used now
+  cache.Insert(CreateKey(&map, 1, 30), paths, 30);
+  ASSERT_EQ(2, cache.GetSize());
+  ASSERT_FALSE(cache.Find(CreateKey(&map, 1, 20), found_paths, distance));
+  ASSERT_TRUE(cache.Find(CreateKey(&map, 1, 30), found_paths, distance));
+  ASSERT_EQ(30, distance);
+
+  // a new version of the same map drops every older entry
+  RoadNetwork other_map;
+  cache.Insert(CreateKey(&other_map, 1, 30), paths, 31);
+  ASSERT_FALSE(cache.Find(CreateKey(&map, 2, 30), found_paths, distance));
+  ASSERT_EQ(1, cache.GetSize());
+  ASSERT_TRUE(cache.Find(CreateKey(&other_map, 1, 30), found_paths, distance));
+  ASSERT_EQ(31, distance);
+
+  cache.SetCapacity(0);
+  ASSERT_EQ(0, cache.GetSize());
+  cache.Insert(CreateKey(&map, 2, 30), paths, 30);
+  ASSERT_EQ(0, cache.GetSize());
+}
+
+TEST(TestSuite, PlannerUsesCacheUntilMapChanges)
+{
+  RoadNetwork map;
+  CreateStraightLaneMap(300, map);
+  WayPoint start(10, 0.2, 0, 0), goal(250, -0.2, 0, 0);
+  std::vector<int> global_path;
+  std::vector<std::vector<WayPoint> > paths, cached_paths;
+  PlannerH planner;
+
+  // maps that were never versioned are not cached
+  double distance = planner.PlanUsingDP(start, goal, 1000, false, global_path, map, paths);
+  ASSERT_GT(distance, 0);
+  ASSERT_EQ(0, planner.m_RouteCache.GetSize());
+
+  MappingHelpers::UpdateMapVersion(map);
+  distance = planner.PlanUsingDP(start, goal, 1000, false, global_path, map, paths);
+  double cached_distance = planner.PlanUsingDP(start, goal, 1000, false, global_path, map, cached_paths);
+  ASSERT_EQ(1, planner.m_RouteCache.m_nHits);
+  ASSERT_EQ(distance, cached_distance);
+  ASSERT_EQ(paths.size(), cached_paths.size());
+  for(unsigned int i = 0; i < paths.size(); i++)
+  {
+    ASSERT_EQ(paths.at(i).size(), cached_paths.at(i).size());
+    for(unsigned int j = 0; j < paths.at(i).size(); j++)
+      ASSERT_EQ(paths.at(i).at(j).id, cached_paths.at(i).at(j).id);
+  }
+
+  // blocked cells raise the waypoint costs, the plan is searched again
+  WayPoint grid_center(100, -5, 0, 0);
+  OccupancyToGridMap grid_info(20, 10, 1.0, grid_center);
+  std::vector<int> grid_data(200, 0);
+  std::vector<WayPoint*> updated_list;
+  unsigned long version = map.version;
+  MappingHelpers::UpdateMapWithOccupancyGrid(grid_info, grid_data, map, updated_list);
+  ASSERT_GT(updated_list.size(), 0);
+  ASSERT_NE(version, map.version);
+
+  cached_distance = planner.PlanUsingDP(start, goal, 1000, false, global_path, map, cached_paths);
+  ASSERT_EQ(1, planner.m_RouteCache.m_nHits);
+  ASSERT_GT(cached_distance, distance);
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  ros::init(argc, argv, "TestNode");
+  return RUN_ALL_TESTS();
+}
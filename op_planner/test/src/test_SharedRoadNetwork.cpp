@@ -0,0 +1,211 @@
+/*
+ * Copyright 2020 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "op_planner/BehaviorPrediction.h"
+#include "op_planner/MappingHelpers.h"
+#include "op_planner/SharedRoadNetwork.h"
+
+using namespace PlannerHNS;
+
+#include <ros/ros.h>
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+class TestSuite:
+  public ::testing::Test
+{
+public:
+  TestSuite() {}
+};
+
+// One straight lane along x, 1 meter point density, every point linked to the next one
+void CreateStraightLaneMap(const int& n_points, RoadNetwork& map)
+{
+  RoadSegment segment;
+  segment.id = 1;
+  Lane l;
+  l.id = 1;
+  for(int i = 0; i < n_points; i++)
+  {
+    WayPoint wp(i, 0, 0, 0);
+    wp.id = i + 1;
+    wp.laneId = l.id;
+    l.points.push_back(wp);
+  }
+  segment.Lanes.push_back(l);
+  map.roadSegments.push_back(segment);
+
+  Lane* pL = &map.roadSegments.at(0).Lanes.at(0);
+  for(unsigned int i = 0; i < pL->points.size(); i++)
+  {
+    pL->points.at(i).pLane = pL;
+    if(i + 1 < pL->points.size())
+      pL->points.at(i).pFronts.push_back(&pL->points.at(i + 1));
+  }
+
+  map.spatialIndex.Build(map.roadSegments);
+  map.idIndex.Build(map.roadSegments);
+  MappingHelpers::UpdateMapVersion(map);
+}
+
+TEST(TestSuite, PublishKeepsMapLinks)
+{
+  SharedRoadNetwork shared;
+  EXPECT_FALSE(shared.GetSnapshot());
+  EXPECT_EQ(shared.GetVersion(), 0u);
+
+  RoadNetwork map;
+  CreateStraightLaneMap(20, map);
+  unsigned long old_version = map.version;
+  unsigned long version = shared.Publish(map);
+
+  EXPECT_GT(version, old_version);
+  EXPECT_EQ(shared.GetVersion(), version);
+  EXPECT_EQ(map.roadSegments.size(), 0u);
+
+  RoadNetworkSnapshotPtr pMap = shared.GetSnapshot();
+  ASSERT_TRUE(pMap != nullptr);
+  EXPECT_EQ(pMap->version, version);
+  const Lane& l = pMap->roadSegments.at(0).Lanes.at(0);
+  ASSERT_EQ(l.points.size(), 20u);
+  for(unsigned int i = 0; i < l.points.size(); i++)
+  {
+    EXPECT_EQ(l.points.at(i).pLane, &l);
+    if(i + 1 < l.points.size())
+    {
+      ASSERT_EQ(l.points.at(i).pFronts.size(), 1u);
+      EXPECT_EQ(l.points.at(i).pFronts.at(0), &l.points.at(i + 1));
+    }
+  }
+
+  WayPoint pos(5.2, 0.3, 0, 0);
+  const Lane* pLane = MappingHelpers::GetClosestLaneFromMap(pos, *pMap, 5.0);
+  EXPECT_EQ(pLane, &l);
+}
+
+TEST(TestSuite, PlannersSearchTheSnapshot)
+{
+  SharedRoadNetwork shared;
+  RoadNetwork map;
+  CreateStraightLaneMap(60, map);
+  shared.Publish(map);
+  RoadNetworkSnapshotPtr pMap = shared.GetSnapshot();
+  ASSERT_TRUE(pMap != nullptr);
+  const Lane& l = pMap->roadSegments.at(0).Lanes.at(0);
+
+  PlannerH planner;
+  std::vector<std::vector<WayPoint> > paths;
+  double distance = planner.PlanUsingDP(WayPoint(2, 0, 0, 0), WayPoint(50, 0, 0, 0), 100, false, std::vector<int>(), *pMap, paths);
+  EXPECT_GT(distance, 0);
+  ASSERT_GT(paths.size(), 0u);
+  EXPECT_GT(paths.at(0).size(), 1u);
+
+  DetectedObject obj;
+  obj.id = 1;
+  obj.t = CAR;
+  obj.center = WayPoint(10.2, 0.1, 0, 0);
+  obj.center.v = 3;
+  obj.bDirection = true;
+  obj.bVelocity = true;
+
+  BehaviorPrediction prediction;
+  prediction.m_bParticleFilter = false;
+  prediction.m_PredictionDistance = 20;
+  prediction.DoOneStep(std::vector<DetectedObject>(1, obj), WayPoint(), 0.5, 0, *pMap);
+  ASSERT_EQ(prediction.m_ParticleInfo_II.size(), 1u);
+  const DetectedObject& predicted = prediction.m_ParticleInfo_II.at(0)->obj;
+  ASSERT_EQ(predicted.pClosestWaypoints.size(), 1u);
+  EXPECT_EQ(predicted.pClosestWaypoints.at(0)->pLane, &l);
+  EXPECT_GT(predicted.predTrajectories.size(), 0u);
+}
+
+TEST(TestSuite, UpdateSwapsOnlyOnNewMap)
+{
+  SharedRoadNetwork shared;
+  RoadNetworkSnapshotPtr pMap;
+  EXPECT_FALSE(shared.Update(pMap));
+
+  RoadNetwork map;
+  CreateStraightLaneMap(10, map);
+  shared.Publish(map);
+  EXPECT_TRUE(shared.Update(pMap));
+  EXPECT_EQ(pMap, shared.GetSnapshot());
+  EXPECT_FALSE(shared.Update(pMap));
+
+  RoadNetworkSnapshotPtr pOldMap = pMap;
+  CreateStraightLaneMap(30, map);
+  shared.Publish(map);
+  EXPECT_TRUE(shared.Update(pMap));
+  EXPECT_NE(pMap, pOldMap);
+  EXPECT_EQ(pMap->roadSegments.at(0).Lanes.at(0).points.size(), 30u);
+
+  //the snapshot of a reader stays valid after it is replaced
+  EXPECT_EQ(pOldMap->roadSegments.at(0).Lanes.at(0).points.size(), 10u);
+  EXPECT_EQ(pOldMap.use_count(), 1);
+
+  shared.Clear();
+  EXPECT_TRUE(shared.Update(pMap));
+  EXPECT_FALSE(pMap);
+}
+
+TEST(TestSuite, ReadersSeeCompleteMaps)
+{
+  SharedRoadNetwork shared;
+  RoadNetwork map;
+  CreateStraightLaneMap(1, map);
+  shared.Publish(map);
+
+  const int n_maps = 50;
+  std::vector<std::thread> readers;
+  std::vector<int> n_bad(4, 0);
+  for(unsigned int r = 0; r < n_bad.size(); r++)
+  {
+    readers.push_back(std::thread([&shared, &n_bad, r]()
+    {
+      RoadNetworkSnapshotPtr pMap;
+      while(!pMap || pMap->roadSegments.at(0).Lanes.at(0).points.size() < n_maps)
+      {
+        shared.Update(pMap);
+        const Lane& l = pMap->roadSegments.at(0).Lanes.at(0);
+        for(unsigned int i = 0; i < l.points.size(); i++)
+        {
+          if(l.points.at(i).pLane != &l || (i + 1 < l.points.size() && l.points.at(i).pFronts.at(0) != &l.points.at(i + 1)))
+            n_bad.at(r)++;
+        }
+      }
+    }));
+  }
+
+  for(int i = 2; i <= n_maps; i++)
+  {
+    CreateStraightLaneMap(i, map);
+    shared.Publish(map);
+  }
+
+  for(unsigned int r = 0; r < readers.size(); r++)
+  {
+    readers.at(r).join();
+    EXPECT_EQ(n_bad.at(r), 0);
+  }
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  ros::init(argc, argv, "TestNode");
+  return RUN_ALL_TESTS();
+}
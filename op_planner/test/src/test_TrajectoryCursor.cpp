@@ -0,0 +1,143 @@
+/*
+ * Copyright 2020 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "op_planner/PlanningHelpers.h"
+#include "op_planner/TrajectoryCursor.h"
+
+using namespace PlannerHNS;
+
+#include <ros/ros.h>
+#include <gtest/gtest.h>
+#include <vector>
+
+class TestSuite:
+  public ::testing::Test
+{
+public:
+  TestSuite() {}
+};
+
+// Smooth S shaped path, 1 meter point density
+std::vector<WayPoint> CreateCurvedPath(const int& n_points)
+{
+  std::vector<WayPoint> path;
+  for(int i = 0; i < n_points; i++)
+    path.push_back(WayPoint(i, 20.0 * sin(i / 60.0), 0, 0));
+
+  PlanningHelpers::CalcAngleAndCost(path);
+  return path;
+}
+
+// Car moving along the path with a small lateral offset
+std::vector<WayPoint> CreateCarPoses(const std::vector<WayPoint>& path, const double& step)
+{
+  std::vector<WayPoint> poses;
+  for(double s = 0; s < path.size() - 1; s += step)
+  {
+    const WayPoint& wp = path.at((int)s);
+    double offset = 0.8 * sin(s / 10.0);
+    WayPoint p(wp.pos.x - offset * sin(wp.pos.a), wp.pos.y + offset * cos(wp.pos.a), 0, wp.pos.a);
+    poses.push_back(p);
+  }
+  return poses;
+}
+
+TEST(TestSuite, CursorMatchesPlanningHelpers)
+{
+  std::vector<WayPoint> path = CreateCurvedPath(1000);
+  std::vector<WayPoint> poses = CreateCarPoses(path, 0.37);
+  TrajectoryCursor cursor;
+
+  RelativeInfo start_info, start_cursor_info;
+  PlanningHelpers::GetRelativeInfo(path, poses.at(0), start_info);
+  cursor.GetRelativeInfo(path, poses.at(0), start_cursor_info);
+
+  for(unsigned int i = 0; i < poses.size(); i++)
+  {
+    RelativeInfo info, cursor_info;
+    PlanningHelpers::GetRelativeInfo(path, poses.at(i), info);
+    cursor.GetRelativeInfo(path, poses.at(i), cursor_info);
+
+    ASSERT_EQ(info.iFront, cursor_info.iFront);
+    ASSERT_EQ(info.iBack, cursor_info.iBack);
+    ASSERT_NEAR(info.perp_distance, cursor_info.perp_distance, 1e-9);
+    ASSERT_NEAR(info.to_front_distance, cursor_info.to_front_distance, 1e-9);
+
+    ASSERT_EQ(PlanningHelpers::GetClosestNextPointIndexFast(path, poses.at(i)), cursor.GetClosestNextPointIndex(path, poses.at(i)));
+    ASSERT_EQ(PlanningHelpers::GetClosestNextPointIndexDirectionFast(path, poses.at(i)), cursor.GetClosestNextPointIndexDirection(path, poses.at(i)));
+
+    ASSERT_NEAR(PlanningHelpers::GetExactDistanceOnTrajectory(path, start_info, info),
+        cursor.GetExactDistanceOnTrajectory(path, start_cursor_info, cursor_info), 1e-6);
+    ASSERT_NEAR(PlanningHelpers::GetExactDistanceOnTrajectory(path, info, start_info),
+        cursor.GetExactDistanceOnTrajectory(path, cursor_info, start_cursor_info), 1e-6);
+  }
+
+  ASSERT_GT(cursor.m_nWindowHits, cursor.m_nFullScans);
+}
+
+TEST(TestSuite, CursorFallsBackOnJumpAndNewPath)
+{
+  std::vector<WayPoint> path = CreateCurvedPath(500);
+  TrajectoryCursor cursor;
+
+  cursor.GetClosestNextPointIndex(path, path.at(10));
+  unsigned long n_full = cursor.m_nFullScans;
+
+  // jump far ahead, the window minimum is on its border
+  int index = cursor.GetClosestNextPointIndex(path, path.at(400));
+  ASSERT_EQ(PlanningHelpers::GetClosestNextPointIndexFast(path, path.at(400)), index);
+  ASSERT_EQ(n_full + 1, cursor.m_nFullScans);
+
+  // same size, different content, the cache must be rebuilt
+  std::vector<WayPoint> shifted = path;
+  for(unsigned int i = 0; i < shifted.size(); i++)
+    shifted.at(i).pos.y += 50;
+  ASSERT_TRUE(cursor.Sync(shifted));
+  ASSERT_FALSE(cursor.Sync(shifted));
+  ASSERT_EQ(PlanningHelpers::GetClosestNextPointIndexFast(shifted, shifted.at(200)), cursor.GetClosestNextPointIndex(shifted, shifted.at(200)));
+}
+
+TEST(TestSuite, LongPathSameAsPlanningHelpers)
+{
+  std::vector<WayPoint> path = CreateCurvedPath(5000);
+  std::vector<WayPoint> poses = CreateCarPoses(path, 0.1);
+  RelativeInfo start_info, info;
+  PlanningHelpers::GetRelativeInfo(path, poses.at(0), start_info);
+
+  double sum_helpers = 0;
+  for(unsigned int i = 0; i < poses.size(); i++)
+  {
+    PlanningHelpers::GetRelativeInfo(path, poses.at(i), info);
+    sum_helpers += PlanningHelpers::GetExactDistanceOnTrajectory(path, start_info, info);
+  }
+
+  TrajectoryCursor cursor;
+  double sum_cursor = 0;
+  for(unsigned int i = 0; i < poses.size(); i++)
+  {
+    cursor.GetRelativeInfo(path, poses.at(i), info);
+    sum_cursor += cursor.GetExactDistanceOnTrajectory(path, start_info, info);
+  }
+
+  ASSERT_NEAR(sum_helpers, sum_cursor, 1e-9 * fabs(sum_helpers));
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  ros::init(argc, argv, "TestNode");
+  return RUN_ALL_TESTS();
+}
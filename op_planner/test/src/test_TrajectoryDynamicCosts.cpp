@@ -0,0 +1,280 @@
+/*
+ * Copyright 2020 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "op_planner/PlanningHelpers.h"
+#include "op_planner/TrajectoryDynamicCosts.h"
+
+using namespace PlannerHNS;
+
+#include <ros/ros.h>
+#include <gtest/gtest.h>
+#include <vector>
+#include <iostream>
+
+class TestSuite:
+  public ::testing::Test
+{
+public:
+  TestSuite() {}
+};
+
+PlanningParams CreateParams()
+{
+  PlanningParams params;
+  params.rollOutNumber = 6;
+  params.rollOutDensity = 0.5;
+  params.horizonDistance = 120;
+  params.minFollowingDistance = 35;
+  params.horizontalSafetyDistancel = 0.5;
+  params.verticalSafetyDistance = 0.5;
+  params.minSpeed = 0.2;
+  return params;
+}
+
+// Curved center line with 0.5 meter density, and rollOutNumber+1 parallel roll outs
+void CreateLane(const double& y_offset, const PlanningParams& params, std::vector<WayPoint>& center, std::vector<std::vector<WayPoint> >& rollOuts)
+{
+  center.clear();
+  for(int i = 0; i < 240; i++)
+    center.push_back(WayPoint(i * 0.5, y_offset + 6.0 * sin(i / 90.0), 0, 0));
+  PlanningHelpers::CalcAngleAndCost(center);
+
+  rollOuts.clear();
+  int central = params.rollOutNumber/2;
+  for(int it = 0; it <= params.rollOutNumber; it++)
+  {
+    double d = params.rollOutDensity * (it - central);
+    std::vector<WayPoint> path;
+    for(unsigned int i = 0; i < center.size(); i++)
+      path.push_back(WayPoint(center.at(i).pos.x - d * sin(center.at(i).pos.a), center.at(i).pos.y + d * cos(center.at(i).pos.a), 0, center.at(i).pos.a));
+    rollOuts.push_back(path);
+  }
+}
+
+std::vector<DetectedObject> CreateObjects(const int& n_objects)
+{
+  std::vector<DetectedObject> objects;
+  for(int i = 0; i < n_objects; i++)
+  {
+    DetectedObject obj;
+    obj.id = i;
+    double x = 6 + fmod(i * 13.7, 100);
+    double y = 6.0 * sin(x / 45.0) + 2.5 * sin(i * 1.3);
+    obj.center = WayPoint(x, y, 0, 0);
+    obj.center.v = (i % 3 == 0) ? 0 : 2.0;
+    obj.w = 1.8;
+    obj.l = 4.0;
+    for(int k = 0; k < 16; k++)
+    {
+      double a = k * 2.0 * M_PI / 16.0;
+      obj.contour.push_back(GPSPoint(x + 2.0 * cos(a), y + 0.9 * sin(a), 0, 0));
+    }
+    objects.push_back(obj);
+  }
+  return objects;
+}
+
+void ExpectSameCosts(const std::vector<TrajectoryCost>& c1, const std::vector<TrajectoryCost>& c2)
+{
+  ASSERT_EQ(c1.size(), c2.size());
+  for(unsigned int i = 0; i < c1.size(); i++)
+  {
+    // bit identical, not only close
+    ASSERT_EQ(c1.at(i).cost, c2.at(i).cost);
+    ASSERT_EQ(c1.at(i).lateral_cost, c2.at(i).lateral_cost);
+    ASSERT_EQ(c1.at(i).longitudinal_cost, c2.at(i).longitudinal_cost);
+    ASSERT_EQ(c1.at(i).closest_obj_distance, c2.at(i).closest_obj_distance);
+    ASSERT_EQ(c1.at(i).closest_obj_velocity, c2.at(i).closest_obj_velocity);
+    ASSERT_EQ(c1.at(i).bBlocked, c2.at(i).bBlocked);
+  }
+}
+
+TEST(TestSuite, ParallelStaticMatchesSequential)
+{
+  PlanningParams params = CreateParams();
+  CAR_BASIC_INFO car_info;
+  VehicleState vehicle_state;
+  std::vector<WayPoint> center;
+  std::vector<std::vector<WayPoint> > rollOuts;
+  CreateLane(0, params, center, rollOuts);
+  std::vector<DetectedObject> objects = CreateObjects(30);
+
+  TrajectoryDynamicCosts sequential, parallel;
+  parallel.SetNumberOfThreads(4);
+  for(unsigned int i = 0; i < 60; i += 7)
+  {
+    TrajectoryCost best = sequential.DoOneStepStatic(rollOuts, center, center.at(i), params, car_info, vehicle_state, objects);
+    TrajectoryCost parallel_best = parallel.DoOneStepStatic(rollOuts, center, center.at(i), params, car_info, vehicle_state, objects);
+    ASSERT_EQ(best.index, parallel_best.index);
+    ASSERT_EQ(best.cost, parallel_best.cost);
+    ExpectSameCosts(sequential.m_TrajectoryCosts, parallel.m_TrajectoryCosts);
+  }
+}
+
+TEST(TestSuite, ParallelLanesMatchesSequential)
+{
+  PlanningParams params = CreateParams();
+  CAR_BASIC_INFO car_info;
+  VehicleState vehicle_state;
+  std::vector<std::vector<std::vector<WayPoint> > > rollOuts(3);
+  std::vector<std::vector<WayPoint> > totalPaths(3);
+  for(unsigned int il = 0; il < 3; il++)
+    CreateLane(il * 3.5, params, totalPaths.at(il), rollOuts.at(il));
+  std::vector<DetectedObject> objects = CreateObjects(30);
+
+  TrajectoryDynamicCosts sequential, parallel;
+  parallel.SetNumberOfThreads(4);
+
+  struct timespec t;
+  double sequential_time = 0, parallel_time = 0;
+  for(unsigned int i = 0; i < 60; i += 7)
+  {
+    UtilityHNS::UtilityH::GetTickCount(t);
+    TrajectoryCost best = sequential.DoOneStep(rollOuts, totalPaths, totalPaths.at(0).at(i), params.rollOutNumber/2, 0, params, car_info, vehicle_state, objects);
+    sequential_time += UtilityHNS::UtilityH::GetTimeDiffNow(t);
+
+    UtilityHNS::UtilityH::GetTickCount(t);
+    TrajectoryCost parallel_best = parallel.DoOneStep(rollOuts, totalPaths, totalPaths.at(0).at(i), params.rollOutNumber/2, 0, params, car_info, vehicle_state, objects);
+    parallel_time += UtilityHNS::UtilityH::GetTimeDiffNow(t);
+
+    ASSERT_EQ(best.index, parallel_best.index);
+    ASSERT_EQ(best.lane_index, parallel_best.lane_index);
+    ExpectSameCosts(sequential.m_TrajectoryCosts, parallel.m_TrajectoryCosts);
+  }
+
+  std::cout << "Sequential: " << sequential_time * 1000.0 << " ms, parallel: " << parallel_time * 1000.0 << " ms" << std::endl;
+}
+
+// Moving objects going across the lane, each with two predicted trajectories
+void AddPredictedTrajectories(std::vector<DetectedObject>& objects)
+{
+  for(unsigned int i = 0; i < objects.size(); i++)
+  {
+    DetectedObject& obj = objects.at(i);
+    if(obj.center.v == 0)
+      continue;
+    obj.bVelocity = true;
+    for(int k = 0; k < 2; k++)
+    {
+      std::vector<WayPoint> pred;
+      double a = (k == 0) ? M_PI_2 : M_PI_4;
+      for(int j = 0; j < 20; j++)
+      {
+        WayPoint wp(obj.center.pos.x + j * 0.5 * cos(a), obj.center.pos.y - 5 + j * 0.5 * sin(a), 0, a);
+        wp.v = obj.center.v;
+        wp.timeCost = j * 0.5 / obj.center.v;
+        pred.push_back(wp);
+      }
+      obj.predTrajectories.push_back(pred);
+    }
+  }
+}
+
+TEST(TestSuite, NearestObjectsFirstMatchesFullEvaluation)
+{
+  PlanningParams params = CreateParams();
+  CAR_BASIC_INFO car_info;
+  VehicleState vehicle_state;
+  vehicle_state.speed = 3.0;
+  std::vector<WayPoint> center;
+  std::vector<std::vector<WayPoint> > rollOuts;
+  CreateLane(0, params, center, rollOuts);
+  std::vector<DetectedObject> objects = CreateObjects(30);
+  AddPredictedTrajectories(objects);
+
+  TrajectoryDynamicCosts full, nearest_first, nearest_first_parallel;
+  nearest_first.SetNearestObjectsFirst(true);
+  nearest_first_parallel.SetNearestObjectsFirst(true);
+  nearest_first_parallel.SetNumberOfThreads(4);
+  int n_blocked = 0;
+  for(unsigned int i = 0; i < 200; i += 9)
+  {
+    TrajectoryCost best = full.DoOneStepDynamic(rollOuts, center, center.at(i), params, car_info, vehicle_state, objects);
+    TrajectoryCost nearest_best = nearest_first.DoOneStepDynamic(rollOuts, center, center.at(i), params, car_info, vehicle_state, objects);
+    TrajectoryCost parallel_best = nearest_first_parallel.DoOneStepDynamic(rollOuts, center, center.at(i), params, car_info, vehicle_state, objects);
+    ASSERT_EQ(best.index, nearest_best.index);
+    ASSERT_EQ(best.index, parallel_best.index);
+    ASSERT_EQ(full.m_TrajectoryCosts.size(), nearest_first.m_TrajectoryCosts.size());
+    for(unsigned int it = 0; it < full.m_TrajectoryCosts.size(); it++)
+    {
+      ASSERT_EQ(full.m_TrajectoryCosts.at(it).bBlocked, nearest_first.m_TrajectoryCosts.at(it).bBlocked);
+      ASSERT_EQ(full.m_TrajectoryCosts.at(it).closest_obj_distance, nearest_first.m_TrajectoryCosts.at(it).closest_obj_distance);
+      ASSERT_EQ(full.m_TrajectoryCosts.at(it).cost, nearest_first.m_TrajectoryCosts.at(it).cost);
+      if(full.m_TrajectoryCosts.at(it).bBlocked)
+        n_blocked++;
+    }
+    ExpectSameCosts(nearest_first.m_TrajectoryCosts, nearest_first_parallel.m_TrajectoryCosts);
+  }
+
+  EXPECT_GT(n_blocked, 0);
+  EXPECT_GT(nearest_first.m_nSkippedObjectChecks, 0);
+  EXPECT_EQ(nearest_first.m_nSkippedObjectChecks, nearest_first_parallel.m_nSkippedObjectChecks);
+}
+
+TEST(TestSuite, OccupancyGridMatchesFullScan)
+{
+  PlanningParams params = CreateParams();
+  CAR_BASIC_INFO car_info;
+  VehicleState vehicle_state;
+  vehicle_state.speed = 3.0;
+  std::vector<WayPoint> center;
+  std::vector<std::vector<WayPoint> > rollOuts;
+  CreateLane(0, params, center, rollOuts);
+  std::vector<DetectedObject> objects = CreateObjects(60);
+  AddPredictedTrajectories(objects);
+
+  for(int mode = 0; mode < 2; mode++)
+  {
+    TrajectoryDynamicCosts scan, grid;
+    scan.m_bUseOccupancyGrid = false;
+    scan.SetNearestObjectsFirst(mode == 1);
+    grid.SetNearestObjectsFirst(mode == 1);
+    int n_collisions = 0;
+    struct timespec t;
+    double scan_time = 0, grid_time = 0;
+    for(unsigned int i = 0; i < 200; i += 9)
+    {
+      UtilityHNS::UtilityH::GetTickCount(t);
+      TrajectoryCost best = scan.DoOneStepDynamic(rollOuts, center, center.at(i), params, car_info, vehicle_state, objects);
+      scan_time += UtilityHNS::UtilityH::GetTimeDiffNow(t);
+      UtilityHNS::UtilityH::GetTickCount(t);
+      TrajectoryCost grid_best = grid.DoOneStepDynamic(rollOuts, center, center.at(i), params, car_info, vehicle_state, objects);
+      grid_time += UtilityHNS::UtilityH::GetTimeDiffNow(t);
+
+      ASSERT_EQ(best.index, grid_best.index);
+      ExpectSameCosts(scan.m_TrajectoryCosts, grid.m_TrajectoryCosts);
+      ASSERT_EQ(scan.m_CollisionPoints.size(), grid.m_CollisionPoints.size());
+      for(unsigned int ic = 0; ic < scan.m_CollisionPoints.size(); ic++)
+      {
+        ASSERT_EQ(scan.m_CollisionPoints.at(ic).pos.x, grid.m_CollisionPoints.at(ic).pos.x);
+        ASSERT_EQ(scan.m_CollisionPoints.at(ic).pos.y, grid.m_CollisionPoints.at(ic).pos.y);
+        ASSERT_EQ(scan.m_CollisionPoints.at(ic).cost, grid.m_CollisionPoints.at(ic).cost);
+        ASSERT_EQ(scan.m_CollisionPoints.at(ic).collisionCost, grid.m_CollisionPoints.at(ic).collisionCost);
+      }
+      n_collisions += scan.m_CollisionPoints.size();
+    }
+
+    EXPECT_GT(n_collisions, 0);
+    std::cout << "Mode: " << mode << ", scan: " << scan_time * 1000.0 << " ms, grid: " << grid_time * 1000.0 << " ms" << std::endl;
+  }
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  ros::init(argc, argv, "TestNode");
+  return RUN_ALL_TESTS();
+}
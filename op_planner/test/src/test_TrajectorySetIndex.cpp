@@ -0,0 +1,177 @@
+/*
+ * Copyright 2020 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "op_planner/PlanningHelpers.h"
+#include "op_planner/PolylineDistance.h"
+#include "op_planner/TrajectorySetIndex.h"
+
+using namespace PlannerHNS;
+
+#include <ros/ros.h>
+#include <gtest/gtest.h>
+#include <float.h>
+#include <cstdlib>
+#include <vector>
+
+class TestSuite:
+  public ::testing::Test
+{
+public:
+  TestSuite() {}
+};
+
+// n_rollouts smooth S shaped paths 1 meter apart, 1 meter point density, the headings follow the path
+std::vector<std::vector<WayPoint> > CreateRollOuts(const int& n_rollouts, const int& n_points)
+{
+  std::vector<std::vector<WayPoint> > rollOuts(n_rollouts);
+  for(int r = 0; r < n_rollouts; r++)
+  {
+    for(int i = 0; i < n_points; i++)
+    {
+      double y = 20.0 * sin(i / 60.0) + r - n_rollouts / 2;
+      double a = atan2(20.0 / 60.0 * cos(i / 60.0), 1.0);
+      WayPoint wp(i, y, 0, a);
+      wp.laneChangeCost = abs(r - n_rollouts / 2);
+      rollOuts.at(r).push_back(wp);
+    }
+  }
+  return rollOuts;
+}
+
+double SegmentDistanceSqr(const GPSPoint& a, const GPSPoint& b, const GPSPoint& p)
+{
+  double vx = b.x - a.x, vy = b.y - a.y;
+  double len_sqr = vx*vx + vy*vy;
+  double t = len_sqr > 0 ? ((p.x - a.x)*vx + (p.y - a.y)*vy) / len_sqr : 0;
+  t = std::max(0.0, std::min(1.0, t));
+  double dx = p.x - a.x - t*vx, dy = p.y - a.y - t*vy;
+  return dx*dx + dy*dy;
+}
+
+TEST(TestSuite, ClosestVertexSameAsFullScan)
+{
+  srand(7);
+  std::vector<std::vector<WayPoint> > trajectories(4);
+  for(unsigned int i = 0; i < trajectories.size(); i++)
+  {
+    //random walks, with repeated points so the ties are tested
+    int n = 1 + i * 97;
+    double x = 0, y = 0;
+    for(int j = 0; j < n; j++)
+    {
+      if(rand() % 5 != 0)
+      {
+        x += (rand() % 21 - 10) / 4.0;
+        y += (rand() % 21 - 10) / 4.0;
+      }
+      trajectories.at(i).push_back(WayPoint(x, y, 0, 0));
+    }
+  }
+
+  for(int leafSize = 1; leafSize <= 16; leafSize *= 4)
+  {
+    TrajectorySetIndex index(leafSize);
+    index.Build(trajectories);
+    ASSERT_EQ(index.GetTrajectoriesNumber(), trajectories.size());
+    for(int k = 0; k < 500; k++)
+    {
+      GPSPoint p((rand() % 801 - 400) / 8.0, (rand() % 801 - 400) / 8.0, 0, 0);
+      for(unsigned int i = 0; i < trajectories.size(); i++)
+      {
+        std::vector<double> xs, ys;
+        for(unsigned int j = 0; j < trajectories.at(i).size(); j++)
+        {
+          xs.push_back(trajectories.at(i).at(j).pos.x);
+          ys.push_back(trajectories.at(i).at(j).pos.y);
+        }
+
+        double d_index = 0, d_scan = 0;
+        int i_index = index.GetClosestVertex(i, p, d_index);
+        int i_scan = PolylineDistance::GetClosestVertexScalar(xs.data(), ys.data(), xs.size(), p.x, p.y, d_scan);
+        ASSERT_EQ(i_index, i_scan);
+        ASSERT_EQ(d_index, d_scan);
+      }
+    }
+  }
+}
+
+TEST(TestSuite, ClosestSegmentSameAsFullScan)
+{
+  std::vector<std::vector<WayPoint> > trajectories = CreateRollOuts(7, 300);
+  trajectories.push_back(std::vector<WayPoint>());
+  trajectories.push_back(std::vector<WayPoint>(1, WayPoint(150, 0, 0, 0)));
+
+  TrajectorySetIndex index;
+  index.Build(trajectories);
+  srand(11);
+  for(int k = 0; k < 1000; k++)
+  {
+    GPSPoint p((rand() % 3401 - 200) / 10.0, (rand() % 801 - 400) / 10.0, 0, 0);
+    double min_d_sqr = DBL_MAX;
+    for(unsigned int i = 0; i < trajectories.size(); i++)
+      for(int j = 0; j + 1 < (int)trajectories.at(i).size(); j++)
+        min_d_sqr = std::min(min_d_sqr, SegmentDistanceSqr(trajectories.at(i).at(j).pos, trajectories.at(i).at(j+1).pos, p));
+
+    int iTrajectory = -1, iSegment = -1;
+    double d = 0;
+    ASSERT_TRUE(index.GetClosestSegment(p, iTrajectory, iSegment, d));
+    ASSERT_NEAR(d, sqrt(min_d_sqr), 1e-9);
+    const std::vector<WayPoint>& t = trajectories.at(iTrajectory);
+    ASSERT_NEAR(SegmentDistanceSqr(t.at(iSegment).pos, t.at(iSegment+1).pos, p), min_d_sqr, 1e-9);
+  }
+
+  TrajectorySetIndex empty_index;
+  empty_index.Build(std::vector<std::vector<WayPoint> >(2));
+  int iTrajectory = 0, iSegment = 0;
+  double d = 0;
+  ASSERT_FALSE(empty_index.GetClosestSegment(GPSPoint(), iTrajectory, iSegment, d));
+}
+
+TEST(TestSuite, RelativeInfoRangeSameAsPlanningHelpers)
+{
+  std::vector<std::vector<WayPoint> > rollOuts = CreateRollOuts(7, 400);
+  TrajectorySetIndex index;
+  index.Build(rollOuts);
+
+  for(double x = 1.3; x < 398; x += 0.9)
+  {
+    double y = 20.0 * sin(x / 60.0) + 1.2 * sin(x / 17.0);
+    WayPoint p(x, y, 0, atan2(20.0 / 60.0 * cos(x / 60.0), 1.0));
+    double searchDistances[2] = {0, 3.6};
+    for(int k = 0; k < 2; k++)
+    {
+      RelativeInfo info, expected;
+      ASSERT_TRUE(index.GetRelativeInfoRange(rollOuts, p, searchDistances[k], info));
+      ASSERT_TRUE(PlanningHelpers::GetRelativeInfoRange(rollOuts, p, searchDistances[k], expected));
+      ASSERT_EQ(info.iGlobalPath, expected.iGlobalPath);
+      ASSERT_EQ(info.iFront, expected.iFront);
+      ASSERT_EQ(info.iBack, expected.iBack);
+      ASSERT_NEAR(info.perp_distance, expected.perp_distance, 1e-9);
+      ASSERT_NEAR(info.to_front_distance, expected.to_front_distance, 1e-9);
+    }
+  }
+
+  //against the opposite direction there is no candidate
+  RelativeInfo info;
+  ASSERT_FALSE(index.GetRelativeInfoRange(rollOuts, WayPoint(50, 0, 0, M_PI), 0, info));
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  ros::init(argc, argv, "TestNode");
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,166 @@
+/*
+ * Copyright 2020 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "op_planner/MappingHelpers.h"
+
+using namespace PlannerHNS;
+
+#include <ros/ros.h>
+#include <gtest/gtest.h>
+#include <vector>
+#include <set>
+#include <iostream>
+
+class TestSuite:
+  public ::testing::Test
+{
+public:
+  TestSuite() {}
+};
+
+// Parallel lanes with 0.5 meter point spacing, spatial index built as after loading
+void CreateLanesMap(const int& n_lanes, const int& n_points, RoadNetwork& map)
+{
+  RoadSegment segment;
+  segment.id = 1;
+  int point_id = 1;
+  for(int i = 0; i < n_lanes; i++)
+  {
+    Lane l;
+    l.id = i + 1;
+    for(int p = 0; p < n_points; p++)
+    {
+      WayPoint wp(p * 0.5, i * 3.0 + 0.3 * sin(p * 0.05), 0, 0);
+      wp.id = point_id++;
+      wp.laneId = l.id;
+      l.points.push_back(wp);
+    }
+    segment.Lanes.push_back(l);
+  }
+  map.roadSegments.push_back(segment);
+  map.spatialIndex.Build(map.roadSegments);
+  MappingHelpers::UpdateMapVersion(map);
+}
+
+// Free grid (100) with a moving blocked (0) box
+void FillGrid(const int& width, const int& length, const int& box_col, const int& box_row, const int& box_size, std::vector<int>& data)
+{
+  data.assign(width * length, 100);
+  for(int r = box_row; r < box_row + box_size && r < length; r++)
+  {
+    for(int c = box_col; c < box_col + box_size && c < width; c++)
+      data.at(r * width + c) = 0;
+  }
+}
+
+bool IsBlocked(const WayPoint& wp)
+{
+  for(unsigned int i = 0; i < wp.actionCost.size(); i++)
+  {
+    if(wp.actionCost.at(i).first == FORWARD_ACTION && wp.actionCost.at(i).second == 100)
+      return true;
+  }
+  return false;
+}
+
+TEST(TestSuite, IncrementalUpdateMatchesFullUpdate)
+{
+  RoadNetwork full_map, incremental_map;
+  CreateLanesMap(5, 120, full_map);
+  CreateLanesMap(5, 120, incremental_map);
+
+  // rotated grid over the middle of the lanes
+  WayPoint grid_center(10, -2, 0, 0.3);
+  OccupancyToGridMap grid_info(60, 40, 0.5, grid_center);
+  OccupancyGridHistory history;
+  std::vector<int> data;
+  std::vector<WayPoint*> full_updated, incremental_updated;
+
+  for(int step = 0; step < 12; step++)
+  {
+    FillGrid(60, 40, step * 4, 5 + step, 6, data);
+
+    std::set<int> blocked_before;
+    const std::vector<Lane>& lanes = incremental_map.roadSegments.at(0).Lanes;
+    for(unsigned int i = 0; i < lanes.size(); i++)
+    {
+      for(unsigned int p = 0; p < lanes.at(i).points.size(); p++)
+      {
+        if(IsBlocked(lanes.at(i).points.at(p)))
+          blocked_before.insert(lanes.at(i).points.at(p).id);
+      }
+    }
+
+    MappingHelpers::UpdateMapWithOccupancyGrid(grid_info, data, full_map, full_updated);
+    MappingHelpers::UpdateMapWithOccupancyGrid(grid_info, data, incremental_map, incremental_updated, history);
+
+    // same costs on every waypoint
+    for(unsigned int i = 0; i < lanes.size(); i++)
+    {
+      for(unsigned int p = 0; p < lanes.at(i).points.size(); p++)
+        ASSERT_EQ(IsBlocked(full_map.roadSegments.at(0).Lanes.at(i).points.at(p)), IsBlocked(lanes.at(i).points.at(p)));
+    }
+
+    // the incremental list has the waypoints of the full list that were not blocked yet
+    std::set<int> expected, reported;
+    for(unsigned int i = 0; i < full_updated.size(); i++)
+    {
+      if(step == 0 || blocked_before.find(full_updated.at(i)->id) == blocked_before.end())
+        expected.insert(full_updated.at(i)->id);
+    }
+    for(unsigned int i = 0; i < incremental_updated.size(); i++)
+      reported.insert(incremental_updated.at(i)->id);
+    ASSERT_EQ(expected, reported);
+    ASSERT_EQ(reported.size(), incremental_updated.size());
+  }
+}
+
+TEST(TestSuite, GridChangesFallBackToFullUpdate)
+{
+  RoadNetwork map;
+  CreateLanesMap(3, 60, map);
+  WayPoint grid_center(0, -2, 0, 0);
+  OccupancyToGridMap grid_info(20, 20, 0.5, grid_center);
+  OccupancyGridHistory history;
+  std::vector<int> data;
+  std::vector<WayPoint*> updated_list;
+
+  FillGrid(20, 20, 0, 0, 20, data);
+  MappingHelpers::UpdateMapWithOccupancyGrid(grid_info, data, map, updated_list, history);
+  unsigned int n_blocked = updated_list.size();
+  ASSERT_GT(n_blocked, 0);
+
+  // same grid, nothing new to report
+  MappingHelpers::UpdateMapWithOccupancyGrid(grid_info, data, map, updated_list, history);
+  ASSERT_EQ(0, updated_list.size());
+
+  // moved grid, full update reports every blocked waypoint again
+  grid_info.center.pos.x += 1.0;
+  MappingHelpers::UpdateMapWithOccupancyGrid(grid_info, data, map, updated_list, history);
+  ASSERT_GT(updated_list.size(), 0);
+
+  // map changed by someone else
+  MappingHelpers::UpdateMapVersion(map);
+  MappingHelpers::UpdateMapWithOccupancyGrid(grid_info, data, map, updated_list, history);
+  ASSERT_GT(updated_list.size(), 0);
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  ros::init(argc, argv, "TestNode");
+  return RUN_ALL_TESTS();
+}
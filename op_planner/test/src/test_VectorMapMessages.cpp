@@ -0,0 +1,148 @@
+/*
+ * Copyright 2020 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "op_planner/MappingHelpers.h"
+
+using namespace PlannerHNS;
+
+#include <ros/ros.h>
+#include <gtest/gtest.h>
+#include <vector>
+
+class TestSuite:
+  public ::testing::Test
+{
+public:
+  TestSuite() {}
+};
+
+// two parallel roads of n_points points, each lane record joins two consecutive points
+static void CreateMessages(const int& n_points, vector_map_msgs::PointArray& points, vector_map_msgs::NodeArray& nodes,
+    vector_map_msgs::LaneArray& lanes, vector_map_msgs::DTLaneArray& dt_lanes)
+{
+  for(int road = 0; road < 2; road++)
+  {
+    int first = road * n_points + 1;
+    for(int i = 0; i < n_points; i++)
+    {
+      vector_map_msgs::Point p = vector_map_msgs::Point();
+      p.pid = first + i;
+      p.bx = road * 3.5;
+      p.ly = i * 2.0;
+      points.data.push_back(p);
+
+      vector_map_msgs::Node n = vector_map_msgs::Node();
+      n.nid = first + i;
+      n.pid = first + i;
+      nodes.data.push_back(n);
+
+      vector_map_msgs::DTLane dt = vector_map_msgs::DTLane();
+      dt.did = first + i;
+      dt.pid = first + i;
+      dt.dist = i * 2.0;
+      dt_lanes.data.push_back(dt);
+    }
+
+    for(int i = 0; i < n_points - 1; i++)
+    {
+      vector_map_msgs::Lane l = vector_map_msgs::Lane();
+      l.lnid = first + i;
+      l.did = first + i;
+      l.bnid = first + i;
+      l.fnid = first + i + 1;
+      l.blid = i > 0 ? first + i - 1 : 0;
+      l.flid = i < n_points - 2 ? first + i + 1 : 0;
+      l.refvel = 20;
+      lanes.data.push_back(l);
+    }
+  }
+}
+
+TEST(TestSuite, MessagesBuildTheSameMapAsTheRecordLists)
+{
+  vector_map_msgs::PointArray points;
+  vector_map_msgs::NodeArray nodes;
+  vector_map_msgs::LaneArray lanes;
+  vector_map_msgs::DTLaneArray dt_lanes;
+  CreateMessages(30, points, nodes, lanes, dt_lanes);
+
+  RoadNetwork direct_map;
+  MappingHelpers::ConstructRoadNetworkFromROSMessages(lanes, points, dt_lanes, vector_map_msgs::CrossRoadArray(),
+      vector_map_msgs::AreaArray(), vector_map_msgs::LineArray(), vector_map_msgs::StopLineArray(),
+      vector_map_msgs::SignalArray(), vector_map_msgs::VectorArray(), vector_map_msgs::CurbArray(),
+      vector_map_msgs::RoadEdgeArray(), vector_map_msgs::WayAreaArray(), vector_map_msgs::CrossWalkArray(), nodes,
+      GPSPoint(), direct_map, true);
+
+  // reference, record lists copied out of the readers
+  UtilityHNS::AisanLanesFileReader lanes_reader(lanes);
+  UtilityHNS::AisanPointsFileReader points_reader(points);
+  UtilityHNS::AisanCenterLinesFileReader dt_reader(dt_lanes);
+  UtilityHNS::AisanNodesFileReader nodes_reader(nodes);
+  UtilityHNS::AisanLinesFileReader lines_reader((vector_map_msgs::LineArray()));
+  std::vector<UtilityHNS::AisanLanesFileReader::AisanLane> lanes_data = lanes_reader.m_data_list;
+  std::vector<UtilityHNS::AisanPointsFileReader::AisanPoints> points_data = points_reader.m_data_list;
+  std::vector<UtilityHNS::AisanCenterLinesFileReader::AisanCenterLine> dt_data = dt_reader.m_data_list;
+  std::vector<UtilityHNS::AisanNodesFileReader::AisanNode> nodes_data = nodes_reader.m_data_list;
+  RoadNetwork reference_map;
+  MappingHelpers::ConstructRoadNetworkFromROSMessageV2(lanes_data, points_data, dt_data,
+      std::vector<UtilityHNS::AisanIntersectionFileReader::AisanIntersection>(),
+      std::vector<UtilityHNS::AisanAreasFileReader::AisanArea>(),
+      std::vector<UtilityHNS::AisanLinesFileReader::AisanLine>(),
+      std::vector<UtilityHNS::AisanStopLineFileReader::AisanStopLine>(),
+      std::vector<UtilityHNS::AisanSignalFileReader::AisanSignal>(),
+      std::vector<UtilityHNS::AisanVectorFileReader::AisanVector>(),
+      std::vector<UtilityHNS::AisanCurbFileReader::AisanCurb>(),
+      std::vector<UtilityHNS::AisanRoadEdgeFileReader::AisanRoadEdge>(),
+      std::vector<UtilityHNS::AisanWayareaFileReader::AisanWayarea>(),
+      std::vector<UtilityHNS::AisanCrossWalkFileReader::AisanCrossWalk>(),
+      nodes_data, std::vector<UtilityHNS::AisanDataConnFileReader::DataConn>(),
+      &lanes_reader, &points_reader, &nodes_reader, &lines_reader, GPSPoint(), reference_map, false, true);
+
+  // the records are sized once from the message
+  ASSERT_EQ(points.data.size(), points_reader.m_data_list.capacity());
+  ASSERT_EQ(lanes.data.size(), lanes_reader.m_data_list.capacity());
+
+  ASSERT_EQ(1u, direct_map.roadSegments.size());
+  const std::vector<Lane>& direct_lanes = direct_map.roadSegments.at(0).Lanes;
+  const std::vector<Lane>& reference_lanes = reference_map.roadSegments.at(0).Lanes;
+  ASSERT_EQ(2u, direct_lanes.size());
+  ASSERT_EQ(reference_lanes.size(), direct_lanes.size());
+  for(unsigned int i = 0; i < direct_lanes.size(); i++)
+  {
+    ASSERT_EQ(reference_lanes.at(i).id, direct_lanes.at(i).id);
+    ASSERT_EQ(30u, direct_lanes.at(i).points.size());
+    ASSERT_EQ(reference_lanes.at(i).points.size(), direct_lanes.at(i).points.size());
+    for(unsigned int j = 0; j < direct_lanes.at(i).points.size(); j++)
+    {
+      const WayPoint& wp = direct_lanes.at(i).points.at(j);
+      const WayPoint& reference_wp = reference_lanes.at(i).points.at(j);
+      ASSERT_EQ(reference_wp.id, wp.id);
+      ASSERT_EQ(reference_wp.pos.x, wp.pos.x);
+      ASSERT_EQ(reference_wp.pos.y, wp.pos.y);
+      ASSERT_EQ(reference_wp.pos.a, wp.pos.a);
+      ASSERT_EQ(reference_wp.v, wp.v);
+      ASSERT_EQ(reference_wp.LeftPointId, wp.LeftPointId);
+      ASSERT_EQ(reference_wp.RightPointId, wp.RightPointId);
+    }
+  }
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  ros::init(argc, argv, "TestNode");
+  return RUN_ALL_TESTS();
+}
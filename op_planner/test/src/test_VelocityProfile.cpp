@@ -0,0 +1,137 @@
+/*
+ * Copyright 2020 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "op_planner/PlanningHelpers.h"
+
+using namespace PlannerHNS;
+
+#include <ros/ros.h>
+#include <gtest/gtest.h>
+#include <vector>
+
+class TestSuite:
+  public ::testing::Test
+{
+public:
+  TestSuite() {}
+};
+
+// Straight path along x with 1 meter point density and no speed limit on the points
+void CreateStraightPath(const int& n_points, std::vector<WayPoint>& path)
+{
+  path.clear();
+  for(int i = 0; i < n_points; i++)
+  {
+    WayPoint wp(i, 0, 0, 0);
+    wp.v = -1;
+    path.push_back(wp);
+  }
+}
+
+// Speeds change at most as allowed by the acceleration limits between consecutive points
+void ExpectAccelerationLimits(const std::vector<WayPoint>& path, const double& max_acceleration, const double& max_deceleration)
+{
+  for(unsigned int i = 1; i < path.size(); i++)
+  {
+    double ds = hypot(path.at(i).pos.y - path.at(i-1).pos.y, path.at(i).pos.x - path.at(i-1).pos.x);
+    double dv2 = path.at(i).v*path.at(i).v - path.at(i-1).v*path.at(i-1).v;
+    EXPECT_LE(dv2, 2.0*max_acceleration*ds + 1e-9) << "point " << i;
+    EXPECT_GE(dv2, -2.0*max_deceleration*ds - 1e-9) << "point " << i;
+  }
+}
+
+TEST(TestSuite, StraightPathAcceleratesAndStops)
+{
+  std::vector<WayPoint> path;
+  CreateStraightPath(200, path);
+  PlanningHelpers::GenerateVelocityProfile(path, 10.0, 1.0, 2.0, 2.0, 0, 0);
+
+  EXPECT_EQ(path.front().v, 0);
+  EXPECT_EQ(path.back().v, 0);
+  EXPECT_DOUBLE_EQ(path.at(100).v, 10.0);
+  EXPECT_NEAR(path.at(18).v, 6.0, 1e-9); // sqrt(2*1*18)
+  EXPECT_NEAR(path.at(199 - 9).v, 6.0, 1e-9); // sqrt(2*2*9)
+  ExpectAccelerationLimits(path, 1.0, 2.0);
+}
+
+TEST(TestSuite, StopPointAndCurveCaps)
+{
+  std::vector<WayPoint> path;
+  CreateStraightPath(100, path);
+  path.at(50).v = 0; // stop line
+  path.at(80).v = 3.0; // map speed limit
+  PlanningHelpers::GenerateVelocityProfile(path, 10.0, 1.0, 1.5, 0);
+
+  EXPECT_DOUBLE_EQ(path.front().v, 10.0);
+  EXPECT_NEAR(path.back().v, sqrt(9.0 + 2.0*19.0), 1e-9); // accelerating after the speed limit
+  EXPECT_EQ(path.at(50).v, 0);
+  EXPECT_DOUBLE_EQ(path.at(80).v, 3.0);
+  EXPECT_NEAR(path.at(47).v, 3.0, 1e-9); // sqrt(2*1.5*3)
+  ExpectAccelerationLimits(path, 1.0, 1.5);
+
+  //half circle of radius 20, the curve speed is sqrt(a_lat*R)
+  std::vector<WayPoint> curve;
+  for(int i = 0; i <= 60; i++)
+  {
+    double a = M_PI*i/60.0;
+    WayPoint wp(20.0*sin(a), 20.0*(1.0 - cos(a)), 0, 0);
+    wp.v = -1;
+    curve.push_back(wp);
+  }
+  PlanningHelpers::GenerateVelocityProfile(curve, 15.0, 1.0, 1.5, 2.0);
+  for(unsigned int i = 0; i < curve.size(); i++)
+    EXPECT_NEAR(curve.at(i).v, sqrt(40.0), 1e-6);
+}
+
+TEST(TestSuite, RecommendedSpeedSweepMethod)
+{
+  std::vector<WayPoint> path;
+  for(int i = 0; i < 150; i++)
+  {
+    WayPoint wp(i * 0.5, 3.0 * sin(i / 15.0), 0, 0);
+    wp.v = 8.0;
+    path.push_back(wp);
+  }
+
+  ASSERT_EQ(VELOCITY_PROFILE_SMOOTHING, PlanningHelpers::GetVelocityProfileMethod());
+  PlanningHelpers::SetVelocityProfileMethod(VELOCITY_PROFILE_SWEEP, 1.0, -2.0, 1.5);
+  ASSERT_EQ(VELOCITY_PROFILE_SWEEP, PlanningHelpers::GetVelocityProfileMethod());
+
+  std::vector<WayPoint> sweep_path = path;
+  PlanningHelpers::GenerateRecommendedSpeed(sweep_path, 6.0, 1.0);
+  std::vector<WayPoint> sweep_path_2 = path;
+  PlanningHelpers::GenerateRecommendedSpeed(sweep_path_2, 6.0, 1.0);
+
+  double min_v = DBL_MAX;
+  for(unsigned int i = 0; i < sweep_path.size(); i++)
+  {
+    EXPECT_LE(sweep_path.at(i).v, 6.0);
+    EXPECT_GT(sweep_path.at(i).v, 0);
+    EXPECT_EQ(sweep_path.at(i).v, sweep_path_2.at(i).v);
+    min_v = std::min(min_v, sweep_path.at(i).v);
+  }
+  EXPECT_LT(min_v, 6.0); // slower in the curves
+  ExpectAccelerationLimits(sweep_path, 1.0, 2.0);
+
+  PlanningHelpers::SetVelocityProfileMethod(VELOCITY_PROFILE_SMOOTHING);
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  ros::init(argc, argv, "TestNode");
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,162 @@
+/*
+ * Copyright 2020 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "op_planner/PlanningHelpers.h"
+#include "op_planner/PlannerH.h"
+#include "op_planner/WayPointArena.h"
+
+using namespace PlannerHNS;
+
+#include <ros/ros.h>
+#include <gtest/gtest.h>
+#include <vector>
+
+class TestSuite:
+  public ::testing::Test
+{
+public:
+  TestSuite() {}
+};
+
+// Main chain along x with a side chain forking every 40 points, 1 meter spacing
+void CreateForkedGraph(std::vector<WayPoint>& nodes, const int& n_main)
+{
+  int n_forks = n_main / 40;
+  int fork_length = 30;
+  nodes.clear();
+  nodes.resize(n_main + n_forks * fork_length);
+  for(int i = 0; i < n_main; i++)
+  {
+    nodes.at(i) = WayPoint(i, 0, 0, 0);
+    nodes.at(i).id = i + 1;
+    nodes.at(i).laneId = 1;
+  }
+
+  for(int f = 0; f < n_forks; f++)
+  {
+    int iFork = f * 40 + 20;
+    for(int k = 0; k < fork_length; k++)
+    {
+      int i = n_main + f * fork_length + k;
+      nodes.at(i) = WayPoint(iFork + k + 1, k + 1, 0, 0);
+      nodes.at(i).id = i + 1;
+      nodes.at(i).laneId = 100 + f;
+    }
+  }
+
+  for(int i = 0; i + 1 < n_main; i++)
+  {
+    nodes.at(i).pFronts.push_back(&nodes.at(i + 1));
+    nodes.at(i + 1).pBacks.push_back(&nodes.at(i));
+  }
+
+  for(int f = 0; f < n_forks; f++)
+  {
+    int iFork = f * 40 + 20;
+    int iFirst = n_main + f * fork_length;
+    nodes.at(iFork).pFronts.push_back(&nodes.at(iFirst));
+    nodes.at(iFirst).pBacks.push_back(&nodes.at(iFork));
+    for(int k = 0; k + 1 < fork_length; k++)
+    {
+      nodes.at(iFirst + k).pFronts.push_back(&nodes.at(iFirst + k + 1));
+      nodes.at(iFirst + k + 1).pBacks.push_back(&nodes.at(iFirst + k));
+    }
+  }
+}
+
+TEST(TestSuite, ArenaKeepsAddressesAndReusesStorage)
+{
+  WayPointArena arena(4);
+  std::vector<WayPoint*> nodes;
+  for(int i = 0; i < 10; i++)
+  {
+    WayPoint wp(i, 0, 0, 0);
+    wp.id = i;
+    nodes.push_back(arena.Create(wp));
+  }
+
+  for(int i = 0; i < 10; i++)
+  {
+    ASSERT_EQ(i, nodes.at(i)->id);
+    ASSERT_EQ(i, nodes.at(i)->pos.x);
+  }
+  ASSERT_EQ(10, arena.GetNodeCount());
+  size_t bytes = arena.GetPeakBytes();
+  ASSERT_EQ(3 * 4 * sizeof(WayPoint), bytes);
+
+  arena.Reset();
+  ASSERT_EQ(0, arena.GetNodeCount());
+  WayPoint wp(5, 5, 0, 0);
+  ASSERT_EQ(nodes.at(0), arena.Create(wp));
+  ASSERT_EQ(5, nodes.at(0)->pos.y);
+  ASSERT_EQ(10, arena.GetPeakNodeCount());
+  ASSERT_EQ(bytes, arena.GetPeakBytes());
+
+  arena.Clear();
+  ASSERT_EQ(0, arena.GetPeakBytes());
+  ASSERT_EQ(0, arena.GetPeakNodeCount());
+}
+
+TEST(TestSuite, ArenaSearchMatchesHeapSearch)
+{
+  std::vector<WayPoint> graph;
+  CreateForkedGraph(graph, 400);
+  std::vector<int> global_path;
+
+  std::vector<WayPoint*> heap_cells, arena_cells, heap_ends, arena_ends;
+  WayPointArena arena;
+  int n_heap = PlanningHelpers::PredictiveDP(&graph.at(0), 150, heap_cells, heap_ends);
+  int n_arena = PlanningHelpers::PredictiveDP(&graph.at(0), 150, arena_cells, arena_ends, &arena);
+  ASSERT_GT(n_heap, 1);
+  ASSERT_EQ(n_heap, n_arena);
+  ASSERT_EQ(heap_cells.size(), arena_cells.size());
+  ASSERT_EQ(arena_cells.size(), arena.GetNodeCount());
+
+  for(unsigned int i = 0; i < heap_ends.size(); i++)
+  {
+    std::vector<WayPoint> heap_path, arena_path;
+    std::vector<std::vector<WayPoint> > temp_paths;
+    PlanningHelpers::TraversePathTreeBackwards(heap_ends.at(i), &graph.at(0), global_path, heap_path, temp_paths);
+    PlanningHelpers::TraversePathTreeBackwards(arena_ends.at(i), &graph.at(0), global_path, arena_path, temp_paths);
+    ASSERT_EQ(heap_path.size(), arena_path.size());
+    for(unsigned int j = 0; j < heap_path.size(); j++)
+    {
+      ASSERT_EQ(heap_path.at(j).id, arena_path.at(j).id);
+      ASSERT_EQ(heap_path.at(j).cost, arena_path.at(j).cost);
+    }
+  }
+
+  PlannerH planner;
+  planner.DeleteWaypoints(heap_cells);
+
+  // straight search, nodes over the limit are never created
+  arena.Reset();
+  arena_cells.clear();
+  WayPoint* pHeapGoal = PlanningHelpers::BuildPlanningSearchTreeStraight(&graph.at(0), 100, heap_cells);
+  WayPoint* pArenaGoal = PlanningHelpers::BuildPlanningSearchTreeStraight(&graph.at(0), 100, arena_cells, &arena);
+  ASSERT_TRUE(pHeapGoal != nullptr && pArenaGoal != nullptr);
+  ASSERT_EQ(pHeapGoal->id, pArenaGoal->id);
+  ASSERT_EQ(pHeapGoal->cost, pArenaGoal->cost);
+  ASSERT_EQ(heap_cells.size(), arena.GetNodeCount());
+  planner.DeleteWaypoints(heap_cells);
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  ros::init(argc, argv, "TestNode");
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,402 @@
+/// \file planning_benchmark.cpp
+/// \brief Command line replay of a recorded scenario through the planning modules, prints the latency of each stage
+/// \date Oct 14, 2026
+
+#include "op_planner/PlanningBenchmark.h"
+#include "op_planner/MappingHelpers.h"
+#include "op_planner/PolylineDistance.h"
+#include "op_planner/PolygonGeometry.h"
+#include "op_utility/UtilityH.h"
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+
+using namespace PlannerHNS;
+
+// Closest vertex of a 2000 points path (0.5 meter density, like the roll outs) for 20000 contour points, with the
+// compiled kernel, the scalar scan and the batch call. Returns 1 if the kernel and the scalar scan disagree.
+static int RunPolylineBenchmark(const int& nRepeats)
+{
+  std::vector<WayPoint> path;
+  for(int i = 0; i < 2000; i++)
+    path.push_back(WayPoint(i * 0.5, 15.0 * sin(i / 80.0), 0, 0));
+  PathSoA polyline(path);
+
+  std::vector<WayPoint> points;
+  for(int i = 0; i < 20000; i++)
+  {
+    double x = fmod(i * 7.31, 1000.0);
+    points.push_back(WayPoint(x, 15.0 * sin(x / 40.0) + 3.0 * sin(i * 0.37), 0, 0));
+  }
+
+  timespec t;
+  double d = 0;
+  long sum_scalar = 0, sum_kernel = 0, sum_batch = 0;
+  UtilityHNS::UtilityH::GetTickCount(t);
+  for(int r = 0; r < nRepeats; r++)
+    for(unsigned int i = 0; i < points.size(); i++)
+      sum_scalar += PolylineDistance::GetClosestVertexScalar(polyline.x.data(), polyline.y.data(), polyline.size(), points.at(i).pos.x, points.at(i).pos.y, d);
+  double scalar_time = UtilityHNS::UtilityH::GetTimeDiffNow(t);
+
+  UtilityHNS::UtilityH::GetTickCount(t);
+  for(int r = 0; r < nRepeats; r++)
+    for(unsigned int i = 0; i < points.size(); i++)
+      sum_kernel += PolylineDistance::GetClosestVertex(polyline.x.data(), polyline.y.data(), polyline.size(), points.at(i).pos.x, points.at(i).pos.y, d);
+  double kernel_time = UtilityHNS::UtilityH::GetTimeDiffNow(t);
+
+  std::vector<int> indices;
+  std::vector<double> distances;
+  UtilityHNS::UtilityH::GetTickCount(t);
+  for(int r = 0; r < nRepeats; r++)
+  {
+    PolylineDistance::GetClosestVertices(polyline, points, indices, distances);
+    for(unsigned int i = 0; i < indices.size(); i++)
+      sum_batch += indices.at(i);
+  }
+  double batch_time = UtilityHNS::UtilityH::GetTimeDiffNow(t);
+
+  std::cout << "Kernel: " << PolylineDistance::GetKernelName() << ", polyline points: " << polyline.size() << ", queries: "
+      << points.size() << ", repeats: " << nRepeats << std::endl;
+  std::cout << "GetClosestVertexScalar: " << scalar_time * 1000.0 << " ms" << std::endl;
+  std::cout << "GetClosestVertex:       " << kernel_time * 1000.0 << " ms" << std::endl;
+  std::cout << "GetClosestVertices:     " << batch_time * 1000.0 << " ms" << std::endl;
+
+  if(sum_kernel != sum_scalar || sum_batch != sum_scalar)
+  {
+    std::cout << "The kernel and the scalar scan found different vertices" << std::endl;
+    return 1;
+  }
+  return 0;
+}
+
+// Point inside polygon of a 16 points star polygon for 40 grids of 3249 points (0.25 meter step, many points on the
+// vertices and edges), with PolygonShape::PointInsidePolygon and the batch kernel. Returns 1 if they disagree.
+static int RunPolygonBenchmark(const int& nRepeats)
+{
+  PolygonShape shape;
+  for(int i = 0; i < 16; i++)
+  {
+    double a = i * 2.0 * M_PI / 16;
+    double r = (i % 2 == 0) ? 5.0 : 2.5;
+    shape.points.push_back(GPSPoint(round(r * cos(a) * 4.0) / 4.0, round(r * sin(a) * 4.0) / 4.0, 0, 0));
+  }
+
+  std::vector<GPSPoint> points;
+  for(int k = 0; k < 40; k++)
+    for(double x = -7; x <= 7; x += 0.25)
+      for(double y = -7; y <= 7; y += 0.25)
+        points.push_back(GPSPoint(k * 0.01 + x, y, 0, 0));
+
+  std::vector<double> xs(points.size()), ys(points.size());
+  for(unsigned int i = 0; i < points.size(); i++)
+  {
+    xs.at(i) = points.at(i).x;
+    ys.at(i) = points.at(i).y;
+  }
+
+  timespec t;
+  long sum_reference = 0, sum_kernel = 0;
+  UtilityHNS::UtilityH::GetTickCount(t);
+  for(int r = 0; r < nRepeats; r++)
+    for(unsigned int i = 0; i < points.size(); i++)
+      sum_reference += shape.PointInsidePolygon(shape, points.at(i));
+  double reference_time = UtilityHNS::UtilityH::GetTimeDiffNow(t);
+
+  std::vector<int> inside(points.size());
+  UtilityHNS::UtilityH::GetTickCount(t);
+  for(int r = 0; r < nRepeats; r++)
+  {
+    PolygonGeometry::PointsInsidePolygon(shape.points, xs.data(), ys.data(), xs.size(), inside.data());
+    for(unsigned int i = 0; i < inside.size(); i++)
+      sum_kernel += inside.at(i);
+  }
+  double kernel_time = UtilityHNS::UtilityH::GetTimeDiffNow(t);
+
+  std::cout << "Kernel: " << PolygonGeometry::GetKernelName() << ", polygon points: " << shape.points.size() << ", queries: "
+      << points.size() << ", repeats: " << nRepeats << std::endl;
+  std::cout << "PolygonShape::PointInsidePolygon:    " << reference_time * 1000.0 << " ms" << std::endl;
+  std::cout << "PolygonGeometry::PointsInsidePolygon: " << kernel_time * 1000.0 << " ms" << std::endl;
+
+  if(sum_kernel != sum_reference)
+  {
+    std::cout << "The kernel and the reference test found different inside points" << std::endl;
+    return 1;
+  }
+  return 0;
+}
+
+// Grid of straight one way lanes, rows 3.5 meters apart and columns 7 meters apart, 1 meter point density
+static void CreateGridMap(const int& n_rows, const int& n_cols, const double& length, RoadNetwork& map)
+{
+  RoadSegment segment;
+  segment.id = 1;
+  int point_id = 1;
+  for(int r = 0; r < n_rows + n_cols; r++)
+  {
+    Lane l;
+    l.id = r + 1;
+    bool bRow = r < n_rows;
+    double offset = bRow ? r * 3.5 : (r - n_rows) * 7.0;
+    for(double s = 0; s < length; s += 1.0)
+    {
+      WayPoint wp(bRow ? s : offset, bRow ? offset : s, 0, bRow ? 0 : M_PI_2);
+      wp.id = point_id++;
+      wp.laneId = l.id;
+      l.points.push_back(wp);
+    }
+    segment.Lanes.push_back(l);
+  }
+
+  map.roadSegments.push_back(segment);
+  for(unsigned int i = 0; i < map.roadSegments.at(0).Lanes.size(); i++)
+  {
+    Lane* pL = &map.roadSegments.at(0).Lanes.at(i);
+    for(unsigned int j = 0; j < pL->points.size(); j++)
+      pL->points.at(j).pLane = pL;
+  }
+}
+
+// Closest waypoint and near lanes queries on a 200 lanes grid (140000 waypoints), with the linear scan and with
+// map.spatialIndex. Returns 1 if the two searches disagree.
+static int RunSpatialIndexBenchmark(const int& nQueries)
+{
+  RoadNetwork map;
+  CreateGridMap(100, 100, 700, map);
+
+  std::vector<WayPoint> queries;
+  srand(7);
+  for(int i = 0; i < nQueries; i++)
+  {
+    double x = 700.0 * (double)rand() / RAND_MAX;
+    double y = 700.0 * (double)rand() / RAND_MAX;
+    queries.push_back(WayPoint(x, y, 0, (i % 2 == 0) ? 0.1 : M_PI_2 - 0.1));
+  }
+
+  timespec t;
+  std::vector<const WayPoint*> linear_wps, indexed_wps;
+  std::vector<std::vector<Lane*> > linear_lanes, indexed_lanes;
+  UtilityHNS::UtilityH::GetTickCount(t);
+  for(unsigned int i = 0; i < queries.size(); i++)
+  {
+    linear_wps.push_back(MappingHelpers::GetClosestWaypointFromMap(queries.at(i), map));
+    linear_lanes.push_back(MappingHelpers::GetClosestLanesListFromMap(queries.at(i), map, 4.0, false));
+  }
+  double linear_time = UtilityHNS::UtilityH::GetTimeDiffNow(t);
+
+  UtilityHNS::UtilityH::GetTickCount(t);
+  map.spatialIndex.Build(map.roadSegments);
+  double build_time = UtilityHNS::UtilityH::GetTimeDiffNow(t);
+
+  UtilityHNS::UtilityH::GetTickCount(t);
+  for(unsigned int i = 0; i < queries.size(); i++)
+  {
+    indexed_wps.push_back(MappingHelpers::GetClosestWaypointFromMap(queries.at(i), map));
+    indexed_lanes.push_back(MappingHelpers::GetClosestLanesListFromMap(queries.at(i), map, 4.0, false));
+  }
+  double indexed_time = UtilityHNS::UtilityH::GetTimeDiffNow(t);
+
+  int nWaypoints = 0;
+  for(unsigned int i = 0; i < map.roadSegments.at(0).Lanes.size(); i++)
+    nWaypoints += map.roadSegments.at(0).Lanes.at(i).points.size();
+
+  std::cout << "Lanes: " << map.roadSegments.at(0).Lanes.size() << ", waypoints: " << nWaypoints << ", queries: " << queries.size() << std::endl;
+  std::cout << "Linear scan:   " << linear_time * 1000.0 << " ms" << std::endl;
+  std::cout << "Spatial index: " << indexed_time * 1000.0 << " ms, build " << build_time * 1000.0 << " ms" << std::endl;
+
+  if(linear_wps != indexed_wps || linear_lanes != indexed_lanes)
+  {
+    std::cout << "The spatial index and the linear scan found different waypoints or lanes" << std::endl;
+    return 1;
+  }
+  return 0;
+}
+
+// GetLaneById for every lane and FindWaypoint for every 37th waypoint of map, with map.idIndex and with the linear
+// scan. Returns false if the two lookups disagree.
+static bool TimeIdLookups(RoadNetwork& map)
+{
+  std::vector<int> lane_ids, waypoint_ids;
+  int n = 0;
+  for(unsigned int i = 0; i < map.roadSegments.size(); i++)
+  {
+    for(unsigned int j = 0; j < map.roadSegments.at(i).Lanes.size(); j++)
+    {
+      const Lane& l = map.roadSegments.at(i).Lanes.at(j);
+      lane_ids.push_back(l.id);
+      for(unsigned int k = 0; k < l.points.size(); k++)
+      {
+        if(n++ % 37 == 0)
+          waypoint_ids.push_back(l.points.at(k).id);
+      }
+    }
+  }
+
+  timespec t;
+  UtilityHNS::UtilityH::GetTickCount(t);
+  map.idIndex.Build(map.roadSegments);
+  double build_time = UtilityHNS::UtilityH::GetTimeDiffNow(t);
+
+  std::vector<Lane*> indexed_lanes, linear_lanes;
+  std::vector<WayPoint*> indexed_waypoints, linear_waypoints;
+  UtilityHNS::UtilityH::GetTickCount(t);
+  for(unsigned int i = 0; i < lane_ids.size(); i++)
+    indexed_lanes.push_back(MappingHelpers::GetLaneById(lane_ids.at(i), map));
+  for(unsigned int i = 0; i < waypoint_ids.size(); i++)
+    indexed_waypoints.push_back(MappingHelpers::FindWaypoint(waypoint_ids.at(i), map));
+  double indexed_time = UtilityHNS::UtilityH::GetTimeDiffNow(t);
+
+  map.idIndex.Clear();
+  UtilityHNS::UtilityH::GetTickCount(t);
+  for(unsigned int i = 0; i < lane_ids.size(); i++)
+    linear_lanes.push_back(MappingHelpers::GetLaneById(lane_ids.at(i), map));
+  for(unsigned int i = 0; i < waypoint_ids.size(); i++)
+    linear_waypoints.push_back(MappingHelpers::FindWaypoint(waypoint_ids.at(i), map));
+  double linear_time = UtilityHNS::UtilityH::GetTimeDiffNow(t);
+
+  std::cout << "Lanes: " << lane_ids.size() << ", waypoints: " << n << ", lookups: " << lane_ids.size() + waypoint_ids.size() << std::endl;
+  std::cout << "Linear scan: " << linear_time * 1000.0 << " ms" << std::endl;
+  std::cout << "Id index:    " << indexed_time * 1000.0 << " ms, build " << build_time * 1000.0 << " ms" << std::endl;
+
+  return indexed_lanes == linear_lanes && indexed_waypoints == linear_waypoints;
+}
+
+// Id lookups on a chain of 400 lanes of 100 waypoints, then the vector map build time and the same lookups on the
+// Aisan vector map folder (with the trailing /) when one is given. Returns 1 if the index and the linear scan disagree.
+static int RunIdIndexBenchmark(const char* vector_map_path)
+{
+  RoadNetwork map;
+  RoadSegment segment;
+  segment.id = 1;
+  int point_id = 1;
+  for(int i = 0; i < 400; i++)
+  {
+    Lane l;
+    l.id = i + 1;
+    for(int p = 0; p < 100; p++)
+    {
+      WayPoint wp(i * 100 + p, (i % 2) * 3.0, 0, 0);
+      wp.id = point_id++;
+      wp.laneId = l.id;
+      l.points.push_back(wp);
+    }
+    segment.Lanes.push_back(l);
+  }
+  map.roadSegments.push_back(segment);
+
+  std::cout << "Synthetic chain map" << std::endl;
+  bool bSame = TimeIdLookups(map);
+
+  if(vector_map_path)
+  {
+    timespec t;
+    RoadNetwork vector_map;
+    UtilityHNS::UtilityH::GetTickCount(t);
+    MappingHelpers::ConstructRoadNetworkFromDataFiles(vector_map_path, vector_map);
+    double map_time = UtilityHNS::UtilityH::GetTimeDiffNow(t);
+
+    std::cout << "Vector map " << vector_map_path << ", build " << map_time << " s" << std::endl;
+    bSame = TimeIdLookups(vector_map) && bSame;
+  }
+
+  if(!bSame)
+  {
+    std::cout << "The id index and the linear scan found different lanes or waypoints" << std::endl;
+    return 1;
+  }
+  return 0;
+}
+
+// planning_benchmark <scenario folder/> [repeats] [threads]
+// planning_benchmark --synthetic <output folder/>, writes a synthetic scenario that can be replayed with the first form
+// planning_benchmark --kml <map.kml>, time of loading the map with the TinyXML reader and with the streaming reader
+// planning_benchmark --polyline [repeats], time of the closest vertex kernel against the scalar scan
+// planning_benchmark --polygon [repeats], time of the point inside polygon kernel against PolygonShape
+// planning_benchmark --spatial-index [queries], time of the map searches with and without the spatial index
+// planning_benchmark --id-index [vector map folder/], time of the id lookups with and without the id index
+int main(int argc, char **argv)
+{
+  if(argc < 2)
+  {
+    std::cout << "Usage: " << argv[0] << " <scenario folder/> [repeats] [threads]" << std::endl;
+    std::cout << "       " << argv[0] << " --synthetic <output folder/>" << std::endl;
+    std::cout << "       " << argv[0] << " --kml <map.kml>" << std::endl;
+    std::cout << "       " << argv[0] << " --polyline [repeats]" << std::endl;
+    std::cout << "       " << argv[0] << " --polygon [repeats]" << std::endl;
+    std::cout << "       " << argv[0] << " --spatial-index [queries]" << std::endl;
+    std::cout << "       " << argv[0] << " --id-index [vector map folder/]" << std::endl;
+    return 1;
+  }
+
+  if(strcmp(argv[1], "--synthetic") == 0)
+  {
+    if(argc < 3)
+      return 1;
+
+    PlanningScenario scenario;
+    PlanningScenario::CreateSynthetic(3, 600, 12, 8, 0.1, scenario);
+    if(!scenario.SaveToFolder(argv[2]))
+    {
+      std::cout << "Can't write the scenario to " << argv[2] << std::endl;
+      return 1;
+    }
+    return 0;
+  }
+
+  if(strcmp(argv[1], "--kml") == 0)
+  {
+    if(argc < 3)
+      return 1;
+
+    timespec t;
+    RoadNetwork dom_map, streaming_map;
+    UtilityHNS::UtilityH::GetTickCount(t);
+    MappingHelpers::LoadKML(argv[2], dom_map);
+    double dom_time = UtilityHNS::UtilityH::GetTimeDiffNow(t);
+    UtilityHNS::UtilityH::GetTickCount(t);
+    MappingHelpers::LoadKMLStreaming(argv[2], streaming_map);
+    double streaming_time = UtilityHNS::UtilityH::GetTimeDiffNow(t);
+
+    int nDomLanes = dom_map.roadSegments.size() > 0 ? dom_map.roadSegments.at(0).Lanes.size() : 0;
+    int nStreamingLanes = streaming_map.roadSegments.size() > 0 ? streaming_map.roadSegments.at(0).Lanes.size() : 0;
+    std::cout << "TinyXML:   " << dom_time << " s, " << nDomLanes << " lanes" << std::endl;
+    std::cout << "Streaming: " << streaming_time << " s, " << nStreamingLanes << " lanes" << std::endl;
+    return 0;
+  }
+
+  if(strcmp(argv[1], "--polyline") == 0)
+    return RunPolylineBenchmark(argc > 2 ? atoi(argv[2]) : 10);
+
+  if(strcmp(argv[1], "--polygon") == 0)
+    return RunPolygonBenchmark(argc > 2 ? atoi(argv[2]) : 10);
+
+  if(strcmp(argv[1], "--spatial-index") == 0)
+    return RunSpatialIndexBenchmark(argc > 2 ? atoi(argv[2]) : 200);
+
+  if(strcmp(argv[1], "--id-index") == 0)
+    return RunIdIndexBenchmark(argc > 2 ? argv[2] : nullptr);
+
+  PlanningScenario scenario;
+  if(!scenario.LoadFromFolder(argv[1]))
+  {
+    std::cout << "Can't load the scenario from " << argv[1] << std::endl;
+    return 1;
+  }
+
+  PlanningBenchmark benchmark;
+  if(argc > 2)
+    benchmark.m_nRepeats = atoi(argv[2]);
+  if(argc > 3)
+    benchmark.m_nThreads = atoi(argv[3]);
+
+  std::cout << "Scenario: " << scenario.egoTrajectory.size() << " frames, " << benchmark.m_nRepeats << " repeats, "
+      << benchmark.m_nThreads << " threads" << std::endl;
+  if(!benchmark.Run(scenario))
+  {
+    std::cout << "No global plan from the first to the last ego pose" << std::endl;
+    return 1;
+  }
+
+  std::cout << benchmark.GetReport();
+  return 0;
+}
@@ -0,0 +1,59 @@
+/// \file IncrementalMarkers.h
+/// \brief Markers kept between cycles, so that only the markers that changed are published
+/// \date Oct 14, 2026
+
+#ifndef OP_INCREMENTALMARKERS_H_
+#define OP_INCREMENTALMARKERS_H_
+
+#include <map>
+#include <string>
+#include <vector>
+#include <visualization_msgs/MarkerArray.h>
+
+namespace PlannerHNS
+{
+
+/**
+ * @brief Keeps the markers of one published topic by namespace and id. Each cycle the markers are committed
+ * between StartCycle and EndCycle, EndCycle gives the new and changed markers with ADD and a DELETE for each kept
+ * marker that wasn't committed, nothing when nothing changed. The header stamp isn't compared.
+ * Reset when a new subscriber has to receive all the markers.
+ */
+class IncrementalMarkers
+{
+public:
+  IncrementalMarkers();
+
+  void StartCycle();
+
+  /**
+   * @brief marker is copied into the kept marker of its namespace and id only when it differs from it
+   */
+  void Commit(const visualization_msgs::Marker& marker);
+
+  /**
+   * @param updates resized to the updates of the cycle, its markers are reused
+   */
+  void EndCycle(visualization_msgs::MarkerArray& updates);
+
+  void Reset();
+
+  unsigned int GetMarkersCount() const;
+
+  static bool IsSameMarker(const visualization_msgs::Marker& m1, const visualization_msgs::Marker& m2);
+
+private:
+  struct KeptMarker
+  {
+    visualization_msgs::Marker marker;
+    bool bCommitted;
+  };
+
+  typedef std::map<std::pair<std::string, int>, KeptMarker> MarkersMap;
+  MarkersMap m_Markers;
+  std::vector<const visualization_msgs::Marker*> m_Changed;
+};
+
+} /* namespace PlannerHNS */
+
+#endif /* OP_INCREMENTALMARKERS_H_ */
@@ -0,0 +1,39 @@
+/// \file MapMarkersCache.h
+/// \brief Road network markers built once per map version, as a few LINE_LIST markers
+/// \date Oct 14, 2026
+
+#ifndef OP_MAPMARKERSCACHE_H_
+#define OP_MAPMARKERSCACHE_H_
+
+#include "op_planner/RoadNetwork.h"
+#include <visualization_msgs/MarkerArray.h>
+
+namespace PlannerHNS
+{
+
+/**
+ * @brief Markers of ROSHelpers::ConvertFromRoadNetworkToAutowareVisualizeMapLineLists for the last map given to
+ * Update. They are built again only for another map or another map version, a map with version 0 is built every
+ * time. Publish them on a latched topic when Update returns true.
+ */
+class MapMarkersCache
+{
+public:
+  MapMarkersCache();
+
+  /**
+   * @return true when the markers were built again
+   */
+  bool Update(const PlannerHNS::RoadNetwork& map);
+
+  const visualization_msgs::MarkerArray& GetMarkers() const;
+
+private:
+  const PlannerHNS::RoadNetwork* m_pMap;
+  unsigned long m_MapVersion;
+  visualization_msgs::MarkerArray m_Markers;
+};
+
+} /* namespace PlannerHNS */
+
+#endif /* OP_MAPMARKERSCACHE_H_ */
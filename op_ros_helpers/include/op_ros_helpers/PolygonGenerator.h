@@ -7,6 +7,9 @@
 #define OP_POLYGONGENERATOR_H_
 
 #include "op_planner/RoadNetwork.h"
+#include "op_utility/TaskScheduler.h"
+#include "autoware_msgs/CloudClusterArray.h"
+#include <memory>
 #include <sensor_msgs/PointCloud2.h>
 #include <visualization_msgs/Marker.h>
 #include <pcl_conversions/pcl_conversions.h>
@@ -74,6 +77,12 @@ public:
   }
 };
 
+/**
+ * QUARTER_VIEWS_POLYGON: the farthest point from the centroid in each of the nQuarters angle sectors
+ * CONVEX_HULL_POLYGON: the convex hull of the cluster, monotone chain in O(n log n)
+ */
+enum POLYGON_METHOD {QUARTER_VIEWS_POLYGON, CONVEX_HULL_POLYGON};
+
 class PolygonGenerator
 {
 
@@ -82,11 +91,52 @@ public:
   GPSPoint m_Centroid;
   std::vector<QuarterView> m_Quarters;
   std::vector<GPSPoint> m_Polygon;
+  POLYGON_METHOD m_Method;
 
-  PolygonGenerator(int nQuarters);
+  PolygonGenerator(int nQuarters, const POLYGON_METHOD& method = QUARTER_VIEWS_POLYGON);
   virtual ~PolygonGenerator();
   std::vector<QuarterView> CreateQuarterViews(const int& nResolution);
   std::vector<GPSPoint> EstimateClusterPolygon(const pcl::PointCloud<pcl::PointXYZ>& cluster, const GPSPoint& original_centroid, GPSPoint& new_centroid, const double& polygon_resolution = 1.0);
+
+  /**
+   * @brief Same polygon written to polygon, which keeps its capacity between calls
+   */
+  void EstimateClusterPolygon(const pcl::PointCloud<pcl::PointXYZ>& cluster, const GPSPoint& original_centroid, GPSPoint& new_centroid,
+      std::vector<GPSPoint>& polygon, const double& polygon_resolution = 1.0);
+
+  /**
+   * @brief Counter clockwise convex hull in x, y without collinear points, the first point isn't repeated. points are sorted.
+   */
+  static void ConvexHull(std::vector<GPSPoint>& points, std::vector<GPSPoint>& hull);
+
+  /**
+   * @brief Insert mid points until no edge of the closed polygon is longer than polygon_resolution
+   */
+  static void FixPolygonResolution(const std::vector<GPSPoint>& polygon, const double& polygon_resolution, std::vector<GPSPoint>& fixed_polygon);
+
+private:
+  std::vector<GPSPoint> m_Points;
+  std::vector<GPSPoint> m_Hull;
+};
+
+/**
+ * @brief Polygons of all the clusters of a message on at most nThreads threads of the shared task scheduler (the caller included), each thread has its
+ * own PolygonGenerator and point cloud, so nothing is allocated once the buffers have grown.
+ */
+class ClusterPolygonsGenerator
+{
+public:
+  ClusterPolygonsGenerator(const int& nQuarters, const POLYGON_METHOD& method = QUARTER_VIEWS_POLYGON, const int& nThreads = 1);
+
+  /**
+   * @brief polygon, new centroid and number of cloud points of each cluster, around its centroid_point
+   */
+  void EstimateClustersPolygons(const autoware_msgs::CloudClusterArray& clusters, const double& polygon_resolution,
+      std::vector<std::vector<GPSPoint> >& polygons, std::vector<GPSPoint>& new_centroids, std::vector<int>& nCloudPoints);
+
+private:
+  std::vector<PolygonGenerator> m_Generators;
+  std::vector<pcl::PointCloud<pcl::PointXYZ> > m_Clouds;
 };
 
 } /* namespace PlannerXNS */
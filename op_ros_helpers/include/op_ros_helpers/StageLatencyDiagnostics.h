@@ -0,0 +1,34 @@
+/// \file StageLatencyDiagnostics.h
+/// \brief Report the stage latencies of a planner cycle to the autoware health checker
+/// \date Oct 14, 2026
+
+#ifndef OP_STAGELATENCYDIAGNOSTICS_H_
+#define OP_STAGELATENCYDIAGNOSTICS_H_
+
+#include "op_utility/StageTimer.h"
+#include <autoware_health_checker/health_checker/health_checker.h>
+
+namespace PlannerHNS
+{
+
+/**
+ * @brief Check the p99 latency (ms) of every stage of recorder against the warn, error and fatal thresholds.
+ * The key of a stage is "value_<prefix>_<stage name>_latency_high" and the description holds p50, p99 and max.
+ * Stages without samples are skipped.
+ */
+class StageLatencyDiagnostics
+{
+public:
+  StageLatencyDiagnostics(const std::string& prefix, const double& warn_ms, const double& error_ms, const double& fatal_ms);
+
+  void Check(autoware_health_checker::HealthChecker& checker, const UtilityHNS::StageLatencyRecorder& recorder) const;
+
+  std::string m_Prefix;
+  double m_WarnLatency;
+  double m_ErrorLatency;
+  double m_FatalLatency;
+};
+
+} /* namespace PlannerHNS */
+
+#endif /* OP_STAGELATENCYDIAGNOSTICS_H_ */
@@ -10,6 +10,9 @@
 #include "op_planner/RoadNetwork.h"
 #include "op_planner/PlannerCommonDef.h"
 #include "op_planner/LocalPlannerH.h"
+#include "op_planner/PlanningRecorder.h"
+#include "op_ros_helpers/IncrementalMarkers.h"
+#include "op_ros_helpers/PolygonGenerator.h"
 
 #include "vector_map_msgs/PointArray.h"
 #include "vector_map_msgs/LaneArray.h"
@@ -167,6 +170,14 @@ public:
   }
 };
 
+/**
+ * @brief Waypoint fields converted by the buffered lane conversions of ROSHelpers, a field that isn't requested
+ * keeps the value it has in the output buffer.
+ * LANE_FIELD_IDS: gid, lane, stop line, left and right ids. LANE_FIELD_COST: cost, time cost and direction.
+ */
+enum LANE_CONVERSION_FIELDS {LANE_FIELD_POSITION = 0x01, LANE_FIELD_HEADING = 0x02, LANE_FIELD_VELOCITY = 0x04,
+  LANE_FIELD_IDS = 0x08, LANE_FIELD_COST = 0x10, LANE_FIELD_ALL = 0x1f};
+
 class ROSHelpers
 {
 public:
@@ -180,6 +191,16 @@ public:
       std::vector<PlannerHNS::DetectedObject>& impObstacles, const double max_obj_size, const double& min_obj_size, const double& detection_radius,
       const int& n_poly_quarters,const double& poly_resolution, int& nOriginalPoints, int& nContourPoints);
 
+  /**
+   * @brief Same obstacles with the polygons of all the clusters estimated together by polyGen (in parallel when it
+   * has threads), polygons_buffer keeps the polygons between calls.
+   */
+  static void ConvertFromAutowareCloudClusterObstaclesToPlannerH(const PlannerHNS::WayPoint& currState, const double& car_width,
+      const double& car_length, const autoware_msgs::CloudClusterArray& clusters,
+      std::vector<PlannerHNS::DetectedObject>& impObstacles, const double max_obj_size, const double& min_obj_size, const double& detection_radius,
+      ClusterPolygonsGenerator& polyGen, const double& poly_resolution, int& nOriginalPoints, int& nContourPoints,
+      std::vector<std::vector<PlannerHNS::GPSPoint> >& polygons_buffer);
+
   static visualization_msgs::Marker CreateGenMarker(const double& x, const double& y, const double& z,const double& a,
       const double& r, const double& g, const double& b, const double& scale, const int& id, const std::string& ns, const int& type);
 
@@ -207,6 +228,13 @@ public:
       visualization_msgs::MarkerArray& polygons,
       visualization_msgs::MarkerArray& tracked_traj);
 
+  /**
+   * @brief Incremental versions: updates holds only the markers that changed since the last call with the same markers,
+   * and a DELETE for each removed marker. The tracked objects markers use the object id.
+   */
+  static void ConvertTrackedObjectsMarkers(const std::vector<PlannerHNS::DetectedObject>& trackedObstacles,
+      IncrementalMarkers& markers, visualization_msgs::MarkerArray& updates);
+
   static void CreateCircleMarker(const PlannerHNS::WayPoint& _center, const double& radius, const int& start_id, visualization_msgs::Marker& circle_points);
 
   static void InitPredMarkers(const int& nMarkers, visualization_msgs::MarkerArray& paths);
@@ -221,6 +249,12 @@ public:
 
   static void TrajectoriesToColoredMarkers(const std::vector<std::vector<PlannerHNS::WayPoint> >& paths,const std::vector<PlannerHNS::TrajectoryCost>& traj_costs, const int& iClosest, visualization_msgs::MarkerArray& markerArray);
 
+  static void TrajectoriesToMarkers(const std::vector<std::vector<std::vector<PlannerHNS::WayPoint> > >& paths, IncrementalMarkers& markers,
+      visualization_msgs::MarkerArray& updates);
+
+  static void TrajectoriesToColoredMarkers(const std::vector<std::vector<PlannerHNS::WayPoint> >& paths, const std::vector<PlannerHNS::TrajectoryCost>& traj_costs,
+      const int& iClosest, IncrementalMarkers& markers, visualization_msgs::MarkerArray& updates);
+
   static void InitCollisionPointsMarkers(const int& nMarkers, visualization_msgs::MarkerArray& col_points);
 
   static void ConvertCollisionPointsMarkers(const std::vector<PlannerHNS::WayPoint>& col_pointss, visualization_msgs::MarkerArray& collision_markers, visualization_msgs::MarkerArray& collision_markers_d);
@@ -243,6 +277,15 @@ public:
 
   static void ConvertFromRoadNetworkToAutowareVisualizeMapFormat(const PlannerHNS::RoadNetwork& map,  visualization_msgs::MarkerArray& markerArray);
 
+  static void ConvertFromRoadNetworkToAutowareVisualizeMapFormat(const PlannerHNS::RoadNetwork& map, IncrementalMarkers& markers,
+      visualization_msgs::MarkerArray& updates);
+
+  /**
+   * @brief The whole map in four markers of the namespace road_network_line_lists: the lane center lines (id 0),
+   * stop lines (1) and curbs (2) as LINE_LIST and the traffic lights (3) as SPHERE_LIST. See MapMarkersCache.
+   */
+  static void ConvertFromRoadNetworkToAutowareVisualizeMapLineLists(const PlannerHNS::RoadNetwork& map, visualization_msgs::MarkerArray& markerArray);
+
   static void ConvertFromAutowareBoundingBoxObstaclesToPlannerH(const jsk_recognition_msgs::BoundingBoxArray& detectedObstacles,
       std::vector<PlannerHNS::DetectedObject>& impObstacles);
 
@@ -255,6 +298,16 @@ public:
 
   static void ConvertFromAutowareLaneToLocalLane(const autoware_msgs::Lane& trajectory, std::vector<PlannerHNS::WayPoint>& path);
 
+  /**
+   * @brief Buffered conversions, the output is resized, not cleared, so its elements and capacity are reused between
+   * messages and only the LANE_CONVERSION_FIELDS in fields are written.
+   */
+  static void ConvertFromLocalLaneToAutowareLane(const std::vector<PlannerHNS::WayPoint>& path, const unsigned int& iStart,
+      const unsigned int& fields, autoware_msgs::Lane& trajectory);
+
+  static void ConvertFromAutowareLaneToLocalLane(const autoware_msgs::Lane& trajectory, const unsigned int& fields,
+      std::vector<PlannerHNS::WayPoint>& path);
+
   static void createGlobalLaneArrayMarker(std_msgs::ColorRGBA color, const autoware_msgs::LaneArray &lane_waypoints_array, visualization_msgs::MarkerArray& markerArray);
 
   static void createGlobalLaneArrayVelocityMarker(const autoware_msgs::LaneArray &lane_waypoints_array , visualization_msgs::MarkerArray& markerArray);
@@ -265,6 +318,19 @@ public:
 
   static void ConvertFromAutowareDetectedObjectToOpenPlannerDetectedObject(const autoware_msgs::DetectedObject& det_obj, PlannerHNS::DetectedObject& obj);
 
+  /**
+   * @brief Buffered conversion, the contour and the predicted trajectories of obj are reused and trajectoryFields
+   * are the LANE_CONVERSION_FIELDS of the trajectories, 0 skips them.
+   */
+  static void ConvertFromAutowareDetectedObjectToOpenPlannerDetectedObject(const autoware_msgs::DetectedObject& det_obj,
+      const unsigned int& trajectoryFields, PlannerHNS::DetectedObject& obj);
+
+  /**
+   * @brief Buffered conversion of a whole message, objs is resized and its objects reused.
+   */
+  static void ConvertFromAutowareDetectedObjectsToOpenPlannerDetectedObjects(const autoware_msgs::DetectedObjectArray& det_objs,
+      const unsigned int& trajectoryFields, std::vector<PlannerHNS::DetectedObject>& objs);
+
   static void ConvertFromOpenPlannerDetectedObjectToAutowareDetectedObject(const PlannerHNS::DetectedObject& det_obj, const bool& bSimulationMode, autoware_msgs::DetectedObject& obj);
 
   static PlannerHNS::SHIFT_POS ConvertShiftFromAutowareToPlannerH(const PlannerHNS::AUTOWARE_SHIFT_POS& shift);
@@ -279,6 +345,26 @@ public:
 
   static void UpdateRoadMap(const AutowareRoadNetwork& src_map, PlannerHNS::RoadNetwork& out_map);
 
+  /**
+   * @brief Recorder of the converted planner inputs, nullptr (the default) records nothing. The recorder is not owned.
+   * When set, UpdateRoadMap, ConvertFromAutowareDetectedObjectsToOpenPlannerDetectedObjects and
+   * ConvertFromAutowareLaneArrayToGlobalPaths record their output, RecordEgoState records the state of each planning cycle.
+   */
+  static void SetInputsRecorder(PlannerHNS::PlanningRecorder* pRecorder);
+  static PlannerHNS::PlanningRecorder* GetInputsRecorder();
+
+  static void RecordEgoState(const ros::Time& stamp, const PlannerHNS::WayPoint& currPose, const PlannerHNS::VehicleState& vehicleState);
+
+  static void ConvertFromAutowareLaneArrayToGlobalPaths(const autoware_msgs::LaneArray& lanes,
+      std::vector<std::vector<PlannerHNS::WayPoint> >& paths);
+
+  /**
+   * @brief Same conversion, fingerprint is PlanningHelpers::GetPathFingerprint of paths, to pass with them to
+   * DecisionMaker::SetNewGlobalPath so a re-sent lane array doesn't trigger a new plan
+   */
+  static void ConvertFromAutowareLaneArrayToGlobalPaths(const autoware_msgs::LaneArray& lanes,
+      std::vector<std::vector<PlannerHNS::WayPoint> >& paths, unsigned long long& fingerprint);
+
   static void GetIndicatorArrows(const PlannerHNS::WayPoint& center, const double& width,const double& length, const PlannerHNS::LIGHT_INDICATOR& indicator, const int& id,visualization_msgs::MarkerArray& markerArray);
 
   static void TTC_PathRviz(const std::vector<PlannerHNS::WayPoint>& path, visualization_msgs::MarkerArray& markerArray);
@@ -0,0 +1,127 @@
+/// \file IncrementalMarkers.cpp
+/// \brief Markers kept between cycles, so that only the markers that changed are published
+/// \date Oct 14, 2026
+
+#include "op_ros_helpers/IncrementalMarkers.h"
+
+namespace PlannerHNS
+{
+
+static bool IsSamePoint(const geometry_msgs::Point& p1, const geometry_msgs::Point& p2)
+{
+  return p1.x == p2.x && p1.y == p2.y && p1.z == p2.z;
+}
+
+static bool IsSameColor(const std_msgs::ColorRGBA& c1, const std_msgs::ColorRGBA& c2)
+{
+  return c1.r == c2.r && c1.g == c2.g && c1.b == c2.b && c1.a == c2.a;
+}
+
+IncrementalMarkers::IncrementalMarkers()
+{
+}
+
+void IncrementalMarkers::StartCycle()
+{
+  m_Changed.clear();
+  for(MarkersMap::iterator it = m_Markers.begin(); it != m_Markers.end(); it++)
+    it->second.bCommitted = false;
+}
+
+void IncrementalMarkers::Commit(const visualization_msgs::Marker& marker)
+{
+  std::pair<MarkersMap::iterator, bool> res = m_Markers.insert(std::make_pair(std::make_pair(marker.ns, marker.id), KeptMarker()));
+  KeptMarker& kept = res.first->second;
+  if(kept.bCommitted && !res.second)
+    return; // same id twice in one cycle, the first one is kept
+
+  kept.bCommitted = true;
+  if(res.second || !IsSameMarker(kept.marker, marker))
+  {
+    kept.marker = marker;
+    kept.marker.action = visualization_msgs::Marker::ADD;
+    m_Changed.push_back(&kept.marker);
+  }
+}
+
+void IncrementalMarkers::EndCycle(visualization_msgs::MarkerArray& updates)
+{
+  unsigned int nDeleted = 0;
+  for(MarkersMap::iterator it = m_Markers.begin(); it != m_Markers.end(); it++)
+  {
+    if(!it->second.bCommitted)
+      nDeleted++;
+  }
+
+  updates.markers.resize(m_Changed.size() + nDeleted);
+  for(unsigned int i = 0; i < m_Changed.size(); i++)
+    updates.markers[i] = *m_Changed[i];
+
+  unsigned int iDelete = m_Changed.size();
+  for(MarkersMap::iterator it = m_Markers.begin(); it != m_Markers.end();)
+  {
+    if(it->second.bCommitted)
+    {
+      it++;
+      continue;
+    }
+
+    visualization_msgs::Marker& mkr = updates.markers[iDelete++];
+    mkr.header = it->second.marker.header;
+    mkr.ns = it->second.marker.ns;
+    mkr.id = it->second.marker.id;
+    mkr.action = visualization_msgs::Marker::DELETE;
+    mkr.points.clear();
+    mkr.colors.clear();
+    mkr.text.clear();
+    m_Markers.erase(it++);
+  }
+
+  m_Changed.clear();
+}
+
+void IncrementalMarkers::Reset()
+{
+  m_Markers.clear();
+  m_Changed.clear();
+}
+
+unsigned int IncrementalMarkers::GetMarkersCount() const
+{
+  return m_Markers.size();
+}
+
+bool IncrementalMarkers::IsSameMarker(const visualization_msgs::Marker& m1, const visualization_msgs::Marker& m2)
+{
+  if(m1.type != m2.type || m1.header.frame_id != m2.header.frame_id || m1.frame_locked != m2.frame_locked
+      || m1.lifetime != m2.lifetime || m1.text != m2.text || m1.mesh_resource != m2.mesh_resource
+      || m1.mesh_use_embedded_materials != m2.mesh_use_embedded_materials)
+    return false;
+
+  if(!IsSamePoint(m1.pose.position, m2.pose.position) || m1.pose.orientation.x != m2.pose.orientation.x
+      || m1.pose.orientation.y != m2.pose.orientation.y || m1.pose.orientation.z != m2.pose.orientation.z
+      || m1.pose.orientation.w != m2.pose.orientation.w)
+    return false;
+
+  if(m1.scale.x != m2.scale.x || m1.scale.y != m2.scale.y || m1.scale.z != m2.scale.z || !IsSameColor(m1.color, m2.color))
+    return false;
+
+  if(m1.points.size() != m2.points.size() || m1.colors.size() != m2.colors.size())
+    return false;
+
+  for(unsigned int i = 0; i < m1.points.size(); i++)
+  {
+    if(!IsSamePoint(m1.points[i], m2.points[i]))
+      return false;
+  }
+
+  for(unsigned int i = 0; i < m1.colors.size(); i++)
+  {
+    if(!IsSameColor(m1.colors[i], m2.colors[i]))
+      return false;
+  }
+
+  return true;
+}
+
+} /* namespace PlannerHNS */
@@ -0,0 +1,31 @@
+/// \file MapMarkersCache.cpp
+/// \brief Road network markers built once per map version, as a few LINE_LIST markers
+/// \date Oct 14, 2026
+
+#include "op_ros_helpers/MapMarkersCache.h"
+#include "op_ros_helpers/op_ROSHelpers.h"
+
+namespace PlannerHNS
+{
+
+MapMarkersCache::MapMarkersCache() : m_pMap(0), m_MapVersion(0)
+{
+}
+
+bool MapMarkersCache::Update(const PlannerHNS::RoadNetwork& map)
+{
+  if(m_pMap == &map && map.version > 0 && map.version == m_MapVersion)
+    return false;
+
+  ROSHelpers::ConvertFromRoadNetworkToAutowareVisualizeMapLineLists(map, m_Markers);
+  m_pMap = &map;
+  m_MapVersion = map.version;
+  return true;
+}
+
+const visualization_msgs::MarkerArray& MapMarkersCache::GetMarkers() const
+{
+  return m_Markers;
+}
+
+} /* namespace PlannerHNS */
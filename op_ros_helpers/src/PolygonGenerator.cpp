@@ -5,13 +5,15 @@
 
 #include "op_ros_helpers/PolygonGenerator.h"
 #include "op_planner/PlanningHelpers.h"
+#include <algorithm>
 
 namespace PlannerHNS
 {
 
-PolygonGenerator::PolygonGenerator(int nQuarters)
+PolygonGenerator::PolygonGenerator(int nQuarters, const POLYGON_METHOD& method)
 {
   m_Quarters = CreateQuarterViews(nQuarters);
+  m_Method = method;
 }
 
 PolygonGenerator::~PolygonGenerator()
@@ -20,75 +22,180 @@ PolygonGenerator::~PolygonGenerator()
 
 std::vector<GPSPoint> PolygonGenerator::EstimateClusterPolygon(const pcl::PointCloud<pcl::PointXYZ>& cluster, const GPSPoint& original_centroid, GPSPoint& new_centroid, const double& polygon_resolution)
 {
-  for(unsigned int i=0; i < m_Quarters.size(); i++)
-      m_Quarters.at(i).ResetQuarterView();
+  EstimateClusterPolygon(cluster, original_centroid, new_centroid, m_Polygon, polygon_resolution);
+  return m_Polygon;
+}
 
-  WayPoint p;
+void PolygonGenerator::EstimateClusterPolygon(const pcl::PointCloud<pcl::PointXYZ>& cluster, const GPSPoint& original_centroid, GPSPoint& new_centroid,
+    std::vector<GPSPoint>& polygon, const double& polygon_resolution)
+{
+  m_Points.resize(cluster.points.size());
   for(unsigned int i=0; i< cluster.points.size(); i++)
   {
-    p.pos.x = cluster.points.at(i).x;
-    p.pos.y = cluster.points.at(i).y;
-    p.pos.z = original_centroid.z;
+    m_Points[i].x = cluster.points[i].x;
+    m_Points[i].y = cluster.points[i].y;
+    m_Points[i].z = original_centroid.z;
+    m_Points[i].a = 0;
+  }
+
+  if(m_Method == CONVEX_HULL_POLYGON)
+  {
+    ConvexHull(m_Points, m_Hull);
+  }
+  else
+  {
+    for(unsigned int i=0; i < m_Quarters.size(); i++)
+        m_Quarters.at(i).ResetQuarterView();
 
-    GPSPoint v(p.pos.x - original_centroid.x , p.pos.y - original_centroid.y, 0, 0);
-    p.cost = pointNorm(v);
-    p.pos.a = UtilityHNS::UtilityH::FixNegativeAngle(atan2(v.y, v.x))*(180. / M_PI);
+    WayPoint p;
+    for(unsigned int i=0; i< m_Points.size(); i++)
+    {
+      p.pos = m_Points[i];
+      GPSPoint v(p.pos.x - original_centroid.x , p.pos.y - original_centroid.y, 0, 0);
+      p.cost = pointNorm(v);
+      p.pos.a = UtilityHNS::UtilityH::FixNegativeAngle(atan2(v.y, v.x))*(180. / M_PI);
 
+      for(unsigned int j = 0 ; j < m_Quarters.size(); j++)
+      {
+        if(m_Quarters.at(j).UpdateQuarterView(p))
+          break;
+      }
+    }
+
+    m_Hull.clear();
+    WayPoint wp;
     for(unsigned int j = 0 ; j < m_Quarters.size(); j++)
     {
-      if(m_Quarters.at(j).UpdateQuarterView(p))
-        break;
+      if(m_Quarters.at(j).GetMaxPoint(wp))
+        m_Hull.push_back(wp.pos);
     }
   }
 
-  m_Polygon.clear();
-  WayPoint wp;
-  for(unsigned int j = 0 ; j < m_Quarters.size(); j++)
+  FixPolygonResolution(m_Hull, polygon_resolution, polygon);
+
+  new_centroid = original_centroid;
+  if(polygon.size() > 0)
   {
-    if(m_Quarters.at(j).GetMaxPoint(wp))
-      m_Polygon.push_back(wp.pos);
+    GPSPoint sum_p;
+    for(unsigned int i = 0 ; i< polygon.size(); i++)
+    {
+      sum_p.x += polygon[i].x;
+      sum_p.y += polygon[i].y;
+    }
+    new_centroid.x = sum_p.x / (double)polygon.size();
+    new_centroid.y = sum_p.y / (double)polygon.size();
   }
+}
+
+static bool IsLowerPoint(const GPSPoint& p1, const GPSPoint& p2)
+{
+  return p1.x < p2.x || (p1.x == p2.x && p1.y < p2.y);
+}
 
-//  //Fix Resolution:
-  bool bChange = true;
-  while (bChange && m_Polygon.size()>1)
+static double HullCross(const GPSPoint& o, const GPSPoint& a, const GPSPoint& b)
+{
+  return (a.x - o.x) * (b.y - o.y) - (a.y - o.y) * (b.x - o.x);
+}
+
+void PolygonGenerator::ConvexHull(std::vector<GPSPoint>& points, std::vector<GPSPoint>& hull)
+{
+  if(points.size() < 3)
   {
-    bChange = false;
-    GPSPoint p1 =  m_Polygon.at(m_Polygon.size()-1);
-    for(unsigned int i=0; i< m_Polygon.size(); i++)
-    {
-      GPSPoint p2 = m_Polygon.at(i);
-      double d = hypot(p2.y- p1.y, p2.x - p1.x);
-      if(d > polygon_resolution)
-      {
-        GPSPoint center_p = p1;
-        center_p.x = (p2.x + p1.x)/2.0;
-        center_p.y = (p2.y + p1.y)/2.0;
-        m_Polygon.insert(m_Polygon.begin()+i, center_p);
-        bChange = true;
-        break;
-      }
+    hull = points;
+    return;
+  }
 
-      p1 = p2;
-    }
+  std::sort(points.begin(), points.end(), IsLowerPoint);
+  hull.resize(points.size() * 2);
+  unsigned int k = 0;
+
+  //lower hull, then upper hull
+  for(unsigned int i = 0; i < points.size(); i++)
+  {
+    while(k >= 2 && HullCross(hull[k-2], hull[k-1], points[i]) <= 0)
+      k--;
+    hull[k++] = points[i];
   }
-  GPSPoint sum_p;
-  for(unsigned int i = 0 ; i< m_Polygon.size(); i++)
+
+  unsigned int lower_size = k + 1;
+  for(int i = (int)points.size() - 2; i >= 0; i--)
   {
-    sum_p.x += m_Polygon.at(i).x;
-    sum_p.y += m_Polygon.at(i).y;
+    while(k >= lower_size && HullCross(hull[k-2], hull[k-1], points[i]) <= 0)
+      k--;
+    hull[k++] = points[i];
   }
 
-  new_centroid = original_centroid;
+  hull.resize(k - 1);
+}
 
-  if(m_Polygon.size() > 0)
+static void AddMidPoints(const GPSPoint& p1, const GPSPoint& p2, const double& polygon_resolution, std::vector<GPSPoint>& polygon)
+{
+  if(hypot(p2.y- p1.y, p2.x - p1.x) <= polygon_resolution)
+    return;
+
+  GPSPoint center_p = p1;
+  center_p.x = (p2.x + p1.x)/2.0;
+  center_p.y = (p2.y + p1.y)/2.0;
+  AddMidPoints(p1, center_p, polygon_resolution, polygon);
+  polygon.push_back(center_p);
+  AddMidPoints(center_p, p2, polygon_resolution, polygon);
+}
+
+void PolygonGenerator::FixPolygonResolution(const std::vector<GPSPoint>& polygon, const double& polygon_resolution, std::vector<GPSPoint>& fixed_polygon)
+{
+  if(polygon.size() < 2 || !(polygon_resolution > 0))
   {
-    new_centroid.x = sum_p.x / (double)m_Polygon.size();
-    new_centroid.y = sum_p.y / (double)m_Polygon.size();
+    fixed_polygon = polygon;
+    return;
   }
 
-  return m_Polygon;
+  //the points of inserting the mid point of the first long edge until there is none
+  fixed_polygon.clear();
+  for(unsigned int i = 0; i < polygon.size(); i++)
+  {
+    AddMidPoints(i == 0 ? polygon.back() : polygon[i-1], polygon[i], polygon_resolution, fixed_polygon);
+    fixed_polygon.push_back(polygon[i]);
+  }
+}
+
+ClusterPolygonsGenerator::ClusterPolygonsGenerator(const int& nQuarters, const POLYGON_METHOD& method, const int& nThreads)
+{
+  int n = std::max(1, nThreads);
+  m_Generators.resize(n, PolygonGenerator(nQuarters, method));
+  m_Clouds.resize(n);
+}
 
+void ClusterPolygonsGenerator::EstimateClustersPolygons(const autoware_msgs::CloudClusterArray& clusters, const double& polygon_resolution,
+    std::vector<std::vector<GPSPoint> >& polygons, std::vector<GPSPoint>& new_centroids, std::vector<int>& nCloudPoints)
+{
+  int nClusters = clusters.clusters.size();
+  polygons.resize(nClusters);
+  new_centroids.resize(nClusters);
+  nCloudPoints.resize(nClusters);
+
+  //task it uses generator it for the clusters it, it + nTasks, ...
+  int nTasks = m_Generators.size();
+  std::function<void(const int&)> task = [&](const int& it)
+  {
+    for(int i = it; i < nClusters; i += nTasks)
+    {
+      const autoware_msgs::CloudCluster& cluster = clusters.clusters.at(i);
+      GPSPoint centroid(cluster.centroid_point.point.x, cluster.centroid_point.point.y, cluster.centroid_point.point.z, 0);
+      pcl::fromROSMsg(cluster.cloud, m_Clouds.at(it));
+      m_Generators.at(it).EstimateClusterPolygon(m_Clouds.at(it), centroid, new_centroids.at(i), polygons.at(i), polygon_resolution);
+      nCloudPoints.at(i) = m_Clouds.at(it).points.size();
+    }
+  };
+
+  if(nTasks > 1 && nClusters > 1)
+  {
+    UtilityHNS::TaskScheduler::GetShared().ParallelFor(nTasks, task, nTasks);
+  }
+  else
+  {
+    for(int i = 0; i < nTasks; i++)
+      task(i);
+  }
 }
 
 std::vector<QuarterView> PolygonGenerator::CreateQuarterViews(const int& nResolution)
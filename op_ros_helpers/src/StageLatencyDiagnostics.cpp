@@ -0,0 +1,39 @@
+/// \file StageLatencyDiagnostics.cpp
+/// \brief Report the stage latencies of a planner cycle to the autoware health checker
+/// \date Oct 14, 2026
+
+#include "op_ros_helpers/StageLatencyDiagnostics.h"
+#include <sstream>
+
+namespace PlannerHNS
+{
+
+StageLatencyDiagnostics::StageLatencyDiagnostics(const std::string& prefix, const double& warn_ms, const double& error_ms, const double& fatal_ms)
+{
+  m_Prefix = prefix;
+  m_WarnLatency = warn_ms;
+  m_ErrorLatency = error_ms;
+  m_FatalLatency = fatal_ms;
+}
+
+void StageLatencyDiagnostics::Check(autoware_health_checker::HealthChecker& checker, const UtilityHNS::StageLatencyRecorder& recorder) const
+{
+  for(unsigned int i = 0; i < recorder.GetNumberOfStages(); i++)
+  {
+    const UtilityHNS::LatencyHistogram& hist = recorder.GetHistogram(i);
+    if(hist.GetCount() == 0) continue;
+
+    double p50 = hist.GetPercentile(0.5)*1000.0;
+    double p99 = hist.GetPercentile(0.99)*1000.0;
+    double max = hist.GetMax()*1000.0;
+
+    std::ostringstream desc;
+    desc << m_Prefix << " " << recorder.GetStageName(i) << " latency (ms) p50: " << p50 << ", p99: " << p99 << ", max: " << max
+        << ", samples: " << hist.GetCount();
+
+    checker.CHECK_MAX_VALUE("value_" + m_Prefix + "_" + recorder.GetStageName(i) + "_latency_high", p99,
+        m_WarnLatency, m_ErrorLatency, m_FatalLatency, desc.str());
+  }
+}
+
+} /* namespace PlannerHNS */
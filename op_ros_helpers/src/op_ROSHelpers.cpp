@@ -11,12 +11,76 @@
 #include <math.h>
 #include "op_ros_helpers/PolygonGenerator.h"
 #include "op_planner/MappingHelpers.h"
+#include "op_planner/PlanningHelpers.h"
 #include "op_planner/MatrixOperations.h"
+#include "op_utility/FastAngle.h"
+#include <atomic>
 
 
 namespace PlannerHNS
 {
 
+static void SetTrajectoryCostColor(const unsigned int& i, const unsigned int& nPaths, const std::vector<PlannerHNS::TrajectoryCost>& traj_costs,
+    const int& iClosest, std_msgs::ColorRGBA& color)
+{
+  color.b = 0;
+
+  if(traj_costs.size() == nPaths)
+  {
+    float norm_cost = traj_costs.at(i).cost * nPaths;
+    if(norm_cost <= 1.0)
+    {
+      color.r = norm_cost;
+      color.g = 1.0;
+    }
+    else if(norm_cost > 1.0)
+    {
+      color.r = 1.0;
+      color.g = 2.0 - norm_cost;
+    }
+  }
+  else
+  {
+    color.r = 1.0;
+    color.g = 0.0;
+  }
+
+  if(traj_costs.at(i).bBlocked)
+  {
+    color.r = 1.0;
+    color.g = 0.0;
+    color.b = 0.0;
+  }
+
+  if(i == iClosest)
+  {
+    color.r = 1.0;
+    color.g = 0.0;
+    color.b = 1.0;
+  }
+}
+
+static void SetMarkerPoints(const std::vector<PlannerHNS::WayPoint>& path, visualization_msgs::Marker& mkr)
+{
+  mkr.points.resize(path.size());
+  for(unsigned int j = 0; j < path.size(); j++)
+  {
+    mkr.points[j].x = path[j].pos.x;
+    mkr.points[j].y = path[j].pos.y;
+    mkr.points[j].z = path[j].pos.z;
+  }
+}
+
+static std::atomic<PlannerHNS::PlanningRecorder*> g_pInputsRecorder(nullptr);
+
+static timespec ToTimeSpec(const ros::Time& t)
+{
+  timespec ts;
+  ts.tv_sec = t.sec;
+  ts.tv_nsec = t.nsec;
+  return ts;
+}
+
 ROSHelpers::ROSHelpers() {
 
 }
@@ -285,6 +349,52 @@ int ROSHelpers::ConvertTrackedObjectsMarkers(const PlannerHNS::WayPoint& currSta
   return i_next_id +1;
 }
 
+void ROSHelpers::ConvertTrackedObjectsMarkers(const std::vector<PlannerHNS::DetectedObject>& trackedObstacles,
+    IncrementalMarkers& markers, visualization_msgs::MarkerArray& updates)
+{
+  markers.StartCycle();
+  visualization_msgs::Marker poly_mkr = CreateGenMarker(0,0,0,0, 1,0.25,0.25,0.1,0,"detected_polygons", visualization_msgs::Marker::LINE_STRIP);
+  visualization_msgs::Marker traj_mkr = CreateGenMarker(0,0,0,0,1,1,0,0.1,0,"tracked_trajectories", visualization_msgs::Marker::LINE_STRIP);
+
+  for(unsigned int i =0; i < trackedObstacles.size(); i++)
+  {
+    const PlannerHNS::DetectedObject& obj = trackedObstacles.at(i);
+    int speed = (obj.center.v*3.6);
+
+    markers.Commit(CreateGenMarker(obj.center.pos.x,obj.center.pos.y,obj.center.pos.z,obj.center.pos.a,1,0,0,0.5,obj.id,"CenterMarker", visualization_msgs::Marker::SPHERE));
+
+    if(obj.bDirection)
+    {
+      visualization_msgs::Marker dir_mkr = CreateGenMarker(obj.center.pos.x,obj.center.pos.y,obj.center.pos.z+0.5,obj.center.pos.a,0,1,0,0.3,obj.id,"Directions", visualization_msgs::Marker::ARROW);
+      dir_mkr.scale.x = 0.4;
+      markers.Commit(dir_mkr);
+    }
+
+    visualization_msgs::Marker text_mkr = CreateGenMarker(obj.center.pos.x+0.5,obj.center.pos.y+0.5,obj.center.pos.z+1,obj.center.pos.a,1,1,1,1.2,obj.id,"InfoText", visualization_msgs::Marker::TEXT_VIEW_FACING);
+    std::ostringstream str_out;
+    str_out << obj.id << " (" << speed << ")";
+    text_mkr.text = str_out.str();
+    markers.Commit(text_mkr);
+
+    poly_mkr.id = obj.id;
+    poly_mkr.points.resize(obj.contour.size() > 0 ? obj.contour.size() + 1 : 0);
+    for(unsigned int p = 0; p < poly_mkr.points.size(); p++)
+    {
+      const PlannerHNS::GPSPoint& c = obj.contour.at(p % obj.contour.size());
+      poly_mkr.points[p].x = c.x;
+      poly_mkr.points[p].y = c.y;
+      poly_mkr.points[p].z = c.z;
+    }
+    markers.Commit(poly_mkr);
+
+    traj_mkr.id = obj.id;
+    SetMarkerPoints(obj.centers_list, traj_mkr);
+    markers.Commit(traj_mkr);
+  }
+
+  markers.EndCycle(updates);
+}
+
 void ROSHelpers::CreateCircleMarker(const PlannerHNS::WayPoint& _center, const double& radius, const int& start_id, visualization_msgs::Marker& circle_points)
 {
   circle_points = CreateGenMarker(0,0,0,0,1,1,1,0.2,start_id,"Detection_Circles", visualization_msgs::Marker::LINE_STRIP);
@@ -506,6 +616,100 @@ void ROSHelpers::ConvertFromRoadNetworkToAutowareVisualizeMapFormat(const Planne
   }
 }
 
+void ROSHelpers::ConvertFromRoadNetworkToAutowareVisualizeMapFormat(const PlannerHNS::RoadNetwork& map, IncrementalMarkers& markers,
+    visualization_msgs::MarkerArray& updates)
+{
+  visualization_msgs::Marker lane_waypoint_marker;
+  lane_waypoint_marker.header.frame_id = "map";
+  lane_waypoint_marker.header.stamp = ros::Time();
+  lane_waypoint_marker.ns = "road_network_vector_map";
+  lane_waypoint_marker.type = visualization_msgs::Marker::LINE_STRIP;
+  lane_waypoint_marker.action = visualization_msgs::Marker::ADD;
+  lane_waypoint_marker.scale.x = 0.25;
+  lane_waypoint_marker.color.r = 1;
+  lane_waypoint_marker.color.g = 1;
+  lane_waypoint_marker.color.b = 1;
+  lane_waypoint_marker.color.a = 0.5;
+  lane_waypoint_marker.frame_locked = false;
+
+  markers.StartCycle();
+  for(unsigned int i = 0; i< map.roadSegments.size(); i++)
+  {
+    for(unsigned int j = 0; j < map.roadSegments.at(i).Lanes.size(); j++)
+    {
+      lane_waypoint_marker.id = map.roadSegments.at(i).Lanes.at(j).id;
+      SetMarkerPoints(map.roadSegments.at(i).Lanes.at(j).points, lane_waypoint_marker);
+      markers.Commit(lane_waypoint_marker);
+    }
+  }
+  markers.EndCycle(updates);
+}
+
+static void AddLineListSegments(const std::vector<PlannerHNS::GPSPoint>& points, visualization_msgs::Marker& mkr)
+{
+  geometry_msgs::Point p;
+  for(unsigned int i = 1; i < points.size(); i++)
+  {
+    p.x = points[i-1].x; p.y = points[i-1].y; p.z = points[i-1].z;
+    mkr.points.push_back(p);
+    p.x = points[i].x; p.y = points[i].y; p.z = points[i].z;
+    mkr.points.push_back(p);
+  }
+}
+
+void ROSHelpers::ConvertFromRoadNetworkToAutowareVisualizeMapLineLists(const PlannerHNS::RoadNetwork& map, visualization_msgs::MarkerArray& markerArray)
+{
+  markerArray.markers.clear();
+
+  visualization_msgs::Marker lanes_marker = CreateGenMarker(0,0,0,0,1,1,1,0.25,0,"road_network_line_lists", visualization_msgs::Marker::LINE_LIST);
+  lanes_marker.color.a = 0.5;
+  unsigned int nSegments = 0;
+  for(unsigned int i = 0; i< map.roadSegments.size(); i++)
+  {
+    for(unsigned int j = 0; j < map.roadSegments.at(i).Lanes.size(); j++)
+    {
+      if(map.roadSegments.at(i).Lanes.at(j).points.size() > 1)
+        nSegments += map.roadSegments.at(i).Lanes.at(j).points.size() - 1;
+    }
+  }
+
+  lanes_marker.points.reserve(nSegments * 2);
+  geometry_msgs::Point p;
+  for(unsigned int i = 0; i< map.roadSegments.size(); i++)
+  {
+    for(unsigned int j = 0; j < map.roadSegments.at(i).Lanes.size(); j++)
+    {
+      const std::vector<PlannerHNS::WayPoint>& points = map.roadSegments.at(i).Lanes.at(j).points;
+      for(unsigned int k = 1; k < points.size(); k++)
+      {
+        p.x = points[k-1].pos.x; p.y = points[k-1].pos.y; p.z = points[k-1].pos.z;
+        lanes_marker.points.push_back(p);
+        p.x = points[k].pos.x; p.y = points[k].pos.y; p.z = points[k].pos.z;
+        lanes_marker.points.push_back(p);
+      }
+    }
+  }
+  markerArray.markers.push_back(lanes_marker);
+
+  visualization_msgs::Marker stop_lines_marker = CreateGenMarker(0,0,0,0,1,0,0,0.3,1,"road_network_line_lists", visualization_msgs::Marker::LINE_LIST);
+  for(unsigned int i = 0; i < map.stopLines.size(); i++)
+    AddLineListSegments(map.stopLines.at(i).points, stop_lines_marker);
+  markerArray.markers.push_back(stop_lines_marker);
+
+  visualization_msgs::Marker curbs_marker = CreateGenMarker(0,0,0,0,1,1,0,0.15,2,"road_network_line_lists", visualization_msgs::Marker::LINE_LIST);
+  for(unsigned int i = 0; i < map.curbs.size(); i++)
+    AddLineListSegments(map.curbs.at(i).points, curbs_marker);
+  markerArray.markers.push_back(curbs_marker);
+
+  visualization_msgs::Marker lights_marker = CreateGenMarker(0,0,0,0,0,0,1,1,3,"road_network_line_lists", visualization_msgs::Marker::SPHERE_LIST);
+  for(unsigned int i = 0; i < map.trafficLights.size(); i++)
+  {
+    p.x = map.trafficLights.at(i).pos.x; p.y = map.trafficLights.at(i).pos.y; p.z = map.trafficLights.at(i).pos.z;
+    lights_marker.points.push_back(p);
+  }
+  markerArray.markers.push_back(lights_marker);
+}
+
 void ROSHelpers::InitPredParticlesMarkers(const int& nMarkers, visualization_msgs::MarkerArray& paths)
 {
   paths.markers.clear();
@@ -688,45 +892,70 @@ void ROSHelpers::TrajectoriesToColoredMarkers(const std::vector<std::vector<Plan
       lane_waypoint_marker.points.push_back(point);
     }
 
-    lane_waypoint_marker.color.b = 0;
+    SetTrajectoryCostColor(i, paths.size(), traj_costs, iClosest, lane_waypoint_marker.color);
 
-    if(traj_costs.size() == paths.size())
-    {
-      float norm_cost = traj_costs.at(i).cost * paths.size();
-      if(norm_cost <= 1.0)
-      {
-        lane_waypoint_marker.color.r = norm_cost;
-        lane_waypoint_marker.color.g = 1.0;
-      }
-      else if(norm_cost > 1.0)
-      {
-        lane_waypoint_marker.color.r = 1.0;
-        lane_waypoint_marker.color.g = 2.0 - norm_cost;
-      }
-    }
-    else
-    {
-      lane_waypoint_marker.color.r = 1.0;
-      lane_waypoint_marker.color.g = 0.0;
-    }
+    markerArray.markers.push_back(lane_waypoint_marker);
+    count++;
+  }
+}
 
-    if(traj_costs.at(i).bBlocked)
-    {
-      lane_waypoint_marker.color.r = 1.0;
-      lane_waypoint_marker.color.g = 0.0;
-      lane_waypoint_marker.color.b = 0.0;
-    }
+void ROSHelpers::TrajectoriesToMarkers(const std::vector<std::vector<std::vector<PlannerHNS::WayPoint> > >& paths, IncrementalMarkers& markers,
+    visualization_msgs::MarkerArray& updates)
+{
+  visualization_msgs::Marker lane_waypoint_marker;
+  lane_waypoint_marker.header.frame_id = "map";
+  lane_waypoint_marker.header.stamp = ros::Time();
+  lane_waypoint_marker.ns = "global_lane_array_marker";
+  lane_waypoint_marker.type = visualization_msgs::Marker::LINE_STRIP;
+  lane_waypoint_marker.action = visualization_msgs::Marker::ADD;
+  lane_waypoint_marker.scale.x = 0.1;
+  lane_waypoint_marker.scale.y = 0.1;
+  lane_waypoint_marker.frame_locked = false;
+  lane_waypoint_marker.color.a = 0.9;
+  lane_waypoint_marker.color.r = 0.0;
+  lane_waypoint_marker.color.g = 1.0;
+  lane_waypoint_marker.color.b = 0.0;
 
-    if(i == iClosest)
+  markers.StartCycle();
+  int count = 0;
+  for (unsigned int il = 0; il < paths.size(); il++)
+  {
+    for (unsigned int i = 0; i < paths.at(il).size(); i++)
     {
-      lane_waypoint_marker.color.r = 1.0;
-      lane_waypoint_marker.color.g = 0.0;
-      lane_waypoint_marker.color.b = 1.0;
+      lane_waypoint_marker.id = count++;
+      SetMarkerPoints(paths.at(il).at(i), lane_waypoint_marker);
+      markers.Commit(lane_waypoint_marker);
     }
+  }
+  markers.EndCycle(updates);
+}
 
-    markerArray.markers.push_back(lane_waypoint_marker);
-    count++;
+void ROSHelpers::TrajectoriesToColoredMarkers(const std::vector<std::vector<PlannerHNS::WayPoint> >& paths, const std::vector<PlannerHNS::TrajectoryCost>& traj_costs,
+    const int& iClosest, IncrementalMarkers& markers, visualization_msgs::MarkerArray& updates)
+{
+  visualization_msgs::Marker lane_waypoint_marker;
+  lane_waypoint_marker.header.frame_id = "map";
+  lane_waypoint_marker.header.stamp = ros::Time();
+  lane_waypoint_marker.ns = "local_lane_array_marker_colored";
+  lane_waypoint_marker.type = visualization_msgs::Marker::LINE_STRIP;
+  lane_waypoint_marker.action = visualization_msgs::Marker::ADD;
+  lane_waypoint_marker.scale.x = 0.1;
+  lane_waypoint_marker.scale.y = 0.1;
+  lane_waypoint_marker.color.a = 0.9;
+  lane_waypoint_marker.color.r = 1.0;
+  lane_waypoint_marker.color.g = 1.0;
+  lane_waypoint_marker.color.b = 1.0;
+  lane_waypoint_marker.frame_locked = false;
+
+  markers.StartCycle();
+  for (unsigned int i = 0; i < paths.size(); i++)
+  {
+    lane_waypoint_marker.id = i;
+    SetMarkerPoints(paths.at(i), lane_waypoint_marker);
+    SetTrajectoryCostColor(i, paths.size(), traj_costs, iClosest, lane_waypoint_marker.color);
+    markers.Commit(lane_waypoint_marker);
   }
+  markers.EndCycle(updates);
 }
 
 void ROSHelpers::ConvertFromPlannerHToAutowareVisualizePathFormat(const std::vector<PlannerHNS::WayPoint>& curr_path,
@@ -1218,6 +1447,65 @@ void ROSHelpers::ConvertFromAutowareCloudClusterObstaclesToPlannerH(const Planne
   nContourPoints =  nPoints;
 }
 
+void ROSHelpers::ConvertFromAutowareCloudClusterObstaclesToPlannerH(const PlannerHNS::WayPoint& currState, const double& car_width,
+    const double& car_length, const autoware_msgs::CloudClusterArray& clusters, vector<PlannerHNS::DetectedObject>& obstacles_list,
+    const double max_obj_size, const double& min_obj_size, const double& detection_radius,
+    ClusterPolygonsGenerator& polyGen, const double& poly_resolution, int& nOriginalPoints, int& nContourPoints,
+    std::vector<std::vector<PlannerHNS::GPSPoint> >& polygons_buffer)
+{
+  PlannerHNS::Mat3 rotationMat(-currState.pos.a);
+  PlannerHNS::Mat3 translationMat(-currState.pos.x, -currState.pos.y);
+
+  std::vector<PlannerHNS::GPSPoint> avg_centers;
+  std::vector<int> nCloudPoints;
+  polyGen.EstimateClustersPolygons(clusters, poly_resolution, polygons_buffer, avg_centers, nCloudPoints);
+
+  int nPoints = 0;
+  int nOrPoints = 0;
+  double object_size = 0;
+  PlannerHNS::GPSPoint relative_point;
+  PlannerHNS::DetectedObject obj;
+
+  for(unsigned int i =0; i < clusters.clusters.size(); i++)
+  {
+    obj.center.pos.x = clusters.clusters.at(i).centroid_point.point.x;
+    obj.center.pos.y = clusters.clusters.at(i).centroid_point.point.y;
+    obj.center.pos.z = clusters.clusters.at(i).centroid_point.point.z;
+    obj.center.pos.a = 0;
+    obj.w = clusters.clusters.at(i).dimensions.x;
+    obj.l = clusters.clusters.at(i).dimensions.y;
+    obj.h = clusters.clusters.at(i).dimensions.z;
+
+    obj.distance_to_center = hypot(obj.center.pos.y-currState.pos.y, obj.center.pos.x-currState.pos.x);
+    object_size = hypot(obj.w, obj.l);
+
+    if(obj.distance_to_center > detection_radius || object_size < min_obj_size || object_size > max_obj_size)
+      continue;
+
+    relative_point = translationMat*obj.center.pos;
+    relative_point = rotationMat*relative_point;
+
+    double distance_x = fabs(relative_point.x - car_length/3.0);
+    double distance_y = fabs(relative_point.y);
+
+    if(distance_x  <= car_length*0.5 && distance_y <= car_width*0.5) // don't detect yourself
+      continue;
+
+    obj.id = clusters.clusters.at(i).id;
+    obj.label = clusters.clusters.at(i).label;
+    obj.center.v = 0;
+    obj.actual_yaw = clusters.clusters.at(i).estimated_angle;
+    obj.contour = polygons_buffer.at(i);
+
+    nOrPoints += nCloudPoints.at(i);
+    nPoints += obj.contour.size();
+    obstacles_list.push_back(obj);
+  }
+
+  nOriginalPoints = nOrPoints;
+  nContourPoints =  nPoints;
+}
+
 PlannerHNS::SHIFT_POS ROSHelpers::ConvertShiftFromAutowareToPlannerH(const PlannerHNS::AUTOWARE_SHIFT_POS& shift)
 {
   if(shift == PlannerHNS::AW_SHIFT_POS_DD)
@@ -1303,34 +1591,66 @@ PlannerHNS::AutowareBehaviorState ROSHelpers::ConvertBehaviorStateFromPlannerHTo
 void ROSHelpers::ConvertFromLocalLaneToAutowareLane(const std::vector<PlannerHNS::WayPoint>& path, autoware_msgs::Lane& trajectory , const unsigned int& iStart)
 {
   trajectory.waypoints.clear();
+  ConvertFromLocalLaneToAutowareLane(path, iStart, LANE_FIELD_ALL, trajectory);
+}
 
-  for(unsigned int i = iStart; i < path.size(); i++)
+void ROSHelpers::ConvertFromLocalLaneToAutowareLane(const std::vector<PlannerHNS::WayPoint>& path, const unsigned int& iStart,
+    const unsigned int& fields, autoware_msgs::Lane& trajectory)
+{
+  if(iStart >= path.size())
   {
-    autoware_msgs::Waypoint wp;
-    wp.pose.pose.position.x = path.at(i).pos.x;
-    wp.pose.pose.position.y = path.at(i).pos.y;
-    wp.pose.pose.position.z = path.at(i).pos.z;
-    wp.pose.pose.orientation = tf::createQuaternionMsgFromYaw(UtilityHNS::UtilityH::SplitPositiveAngle(path.at(i).pos.a));
+    trajectory.waypoints.clear();
+    return;
+  }
 
-    wp.twist.twist.linear.x = path.at(i).v;
-    wp.lane_id = path.at(i).laneId;
-    wp.stop_line_id = path.at(i).stopLineID;
-    wp.left_lane_id = path.at(i).LeftPointId;
-    wp.right_lane_id = path.at(i).RightPointId;
-    wp.time_cost = path.at(i).timeCost;
+  trajectory.waypoints.resize(path.size() - iStart);
+
+  for(unsigned int i = iStart; i < path.size(); i++)
+  {
+    const PlannerHNS::WayPoint& p = path[i];
+    autoware_msgs::Waypoint& wp = trajectory.waypoints[i - iStart];
+    if(fields & LANE_FIELD_POSITION)
+    {
+      wp.pose.pose.position.x = p.pos.x;
+      wp.pose.pose.position.y = p.pos.y;
+      wp.pose.pose.position.z = p.pos.z;
+    }
 
-    wp.gid = path.at(i).gid;
+    if(fields & LANE_FIELD_HEADING)
+    {
+      // yaw only quaternion, as tf::createQuaternionMsgFromYaw makes it
+      double s = 0, c = 1;
+      UtilityHNS::PlannerAngle::SinCos(UtilityHNS::UtilityH::SplitPositiveAngle(p.pos.a) * 0.5, s, c);
+      wp.pose.pose.orientation.x = 0;
+      wp.pose.pose.orientation.y = 0;
+      wp.pose.pose.orientation.z = s;
+      wp.pose.pose.orientation.w = c;
+    }
 
-    //wp.cost = path.at(i).cost;
-    wp.cost = 0;
+    if(fields & LANE_FIELD_VELOCITY)
+      wp.twist.twist.linear.x = p.v;
 
-    if(path.at(i).actionCost.size()>0)
+    if(fields & LANE_FIELD_IDS)
     {
-      wp.direction = path.at(i).actionCost.at(0).first;
-      wp.cost += path.at(i).actionCost.at(0).second;
+      wp.lane_id = p.laneId;
+      wp.stop_line_id = p.stopLineID;
+      wp.left_lane_id = p.LeftPointId;
+      wp.right_lane_id = p.RightPointId;
+      wp.gid = p.gid;
     }
 
-    trajectory.waypoints.push_back(wp);
+    if(fields & LANE_FIELD_COST)
+    {
+      wp.time_cost = p.timeCost;
+      //wp.cost = p.cost;
+      wp.cost = 0;
+      wp.direction = 0;
+      if(p.actionCost.size()>0)
+      {
+        wp.direction = p.actionCost.at(0).first;
+        wp.cost += p.actionCost.at(0).second;
+      }
+    }
   }
 }
 
@@ -1353,42 +1673,63 @@ void ROSHelpers::ConvertFromLocalLaneToAutowareLane(const std::vector<PlannerHNS
 void ROSHelpers::ConvertFromAutowareLaneToLocalLane(const autoware_msgs::Lane& trajectory, std::vector<PlannerHNS::WayPoint>& path)
 {
   path.clear();
+  ConvertFromAutowareLaneToLocalLane(trajectory, LANE_FIELD_ALL, path);
+}
+
+void ROSHelpers::ConvertFromAutowareLaneToLocalLane(const autoware_msgs::Lane& trajectory, const unsigned int& fields,
+    std::vector<PlannerHNS::WayPoint>& path)
+{
+  path.resize(trajectory.waypoints.size());
 
   for(unsigned int i=0; i < trajectory.waypoints.size(); i++)
   {
-    PlannerHNS::WayPoint wp;
-    wp.pos.x = trajectory.waypoints.at(i).pose.pose.position.x;
-    wp.pos.y = trajectory.waypoints.at(i).pose.pose.position.y;
-    wp.pos.z = trajectory.waypoints.at(i).pose.pose.position.z;
-    wp.pos.a = tf::getYaw(trajectory.waypoints.at(i).pose.pose.orientation);
+    const autoware_msgs::Waypoint& p = trajectory.waypoints[i];
+    PlannerHNS::WayPoint& wp = path[i];
+    if(fields & LANE_FIELD_POSITION)
+    {
+      wp.pos.x = p.pose.pose.position.x;
+      wp.pos.y = p.pose.pose.position.y;
+      wp.pos.z = p.pose.pose.position.z;
+    }
 
-    wp.v = trajectory.waypoints.at(i).twist.twist.linear.x;
+    if(fields & LANE_FIELD_HEADING)
+      wp.pos.a = tf::getYaw(p.pose.pose.orientation);
 
-    wp.gid = trajectory.waypoints.at(i).gid;
-    wp.laneId = trajectory.waypoints.at(i).lane_id;
-    wp.stopLineID = trajectory.waypoints.at(i).stop_line_id;
-    wp.LeftPointId = trajectory.waypoints.at(i).left_lane_id;
-    wp.RightPointId = trajectory.waypoints.at(i).right_lane_id;
-    wp.timeCost = trajectory.waypoints.at(i).time_cost;
+    if(fields & LANE_FIELD_VELOCITY)
+      wp.v = p.twist.twist.linear.x;
 
-    if(trajectory.waypoints.at(i).direction == 0)
-      wp.bDir = PlannerHNS::FORWARD_DIR;
-    else if(trajectory.waypoints.at(i).direction == 1)
-      wp.bDir = PlannerHNS::FORWARD_LEFT_DIR;
-    else if(trajectory.waypoints.at(i).direction == 2)
-      wp.bDir = PlannerHNS::FORWARD_RIGHT_DIR;
-    else if(trajectory.waypoints.at(i).direction == 3)
-      wp.bDir = PlannerHNS::BACKWARD_DIR;
-    else if(trajectory.waypoints.at(i).direction == 4)
-      wp.bDir = PlannerHNS::BACKWARD_LEFT_DIR;
-    else if(trajectory.waypoints.at(i).direction == 5)
-      wp.bDir = PlannerHNS::BACKWARD_RIGHT_DIR;
-    else if(trajectory.waypoints.at(i).direction == 6)
-      wp.bDir = PlannerHNS::STANDSTILL_DIR;
+    if(fields & LANE_FIELD_IDS)
+    {
+      wp.gid = p.gid;
+      wp.laneId = p.lane_id;
+      wp.stopLineID = p.stop_line_id;
+      wp.LeftPointId = p.left_lane_id;
+      wp.RightPointId = p.right_lane_id;
+    }
 
-    wp.cost = trajectory.waypoints.at(i).cost;
+    if(fields & LANE_FIELD_COST)
+    {
+      wp.timeCost = p.time_cost;
+
+      if(p.direction == 0)
+        wp.bDir = PlannerHNS::FORWARD_DIR;
+      else if(p.direction == 1)
+        wp.bDir = PlannerHNS::FORWARD_LEFT_DIR;
+      else if(p.direction == 2)
+        wp.bDir = PlannerHNS::FORWARD_RIGHT_DIR;
+      else if(p.direction == 3)
+        wp.bDir = PlannerHNS::BACKWARD_DIR;
+      else if(p.direction == 4)
+        wp.bDir = PlannerHNS::BACKWARD_LEFT_DIR;
+      else if(p.direction == 5)
+        wp.bDir = PlannerHNS::BACKWARD_RIGHT_DIR;
+      else if(p.direction == 6)
+        wp.bDir = PlannerHNS::STANDSTILL_DIR;
+      else
+        wp.bDir = PlannerHNS::FORWARD_DIR;
 
-    path.push_back(wp);
+      wp.cost = p.cost;
+    }
   }
 }
 
@@ -1564,6 +1905,13 @@ void ROSHelpers::GetTrafficLightForVisualization(std::vector<PlannerHNS::Traffic
 }
 
 void ROSHelpers::ConvertFromAutowareDetectedObjectToOpenPlannerDetectedObject(const autoware_msgs::DetectedObject& det_obj, PlannerHNS::DetectedObject& obj)
+{
+  obj.predTrajectories.clear();
+  ConvertFromAutowareDetectedObjectToOpenPlannerDetectedObject(det_obj, LANE_FIELD_ALL, obj);
+}
+
+void ROSHelpers::ConvertFromAutowareDetectedObjectToOpenPlannerDetectedObject(const autoware_msgs::DetectedObject& det_obj,
+    const unsigned int& trajectoryFields, PlannerHNS::DetectedObject& obj)
 {
   obj.id = det_obj.id;
   obj.label = det_obj.label;
@@ -1591,31 +1939,43 @@ void ROSHelpers::ConvertFromAutowareDetectedObjectToOpenPlannerDetectedObject(co
   else if(det_obj.indicator_state == 3)
     obj.indicator_state = PlannerHNS::INDICATOR_NONE;
 
-  PlannerHNS::GPSPoint p;
-  obj.contour.clear();
-
+  obj.contour.resize(det_obj.convex_hull.polygon.points.size());
   for(unsigned int j=0; j < det_obj.convex_hull.polygon.points.size(); j++)
   {
-
-    p.x = det_obj.convex_hull.polygon.points.at(j).x;
-    p.y = det_obj.convex_hull.polygon.points.at(j).y;
-    p.z = det_obj.convex_hull.polygon.points.at(j).z;
-    obj.contour.push_back(p);
+    const geometry_msgs::Point32& p = det_obj.convex_hull.polygon.points[j];
+    obj.contour[j].x = p.x;
+    obj.contour[j].y = p.y;
+    obj.contour[j].z = p.z;
   }
 
-  obj.predTrajectories.clear();
+  if(trajectoryFields == 0)
+  {
+    obj.predTrajectories.clear();
+    return;
+  }
 
+  obj.predTrajectories.resize(det_obj.candidate_trajectories.lanes.size());
   for(unsigned int j = 0 ; j < det_obj.candidate_trajectories.lanes.size(); j++)
   {
-    std::vector<PlannerHNS::WayPoint> _traj;
-    PlannerHNS::ROSHelpers::ConvertFromAutowareLaneToLocalLane(det_obj.candidate_trajectories.lanes.at(j), _traj);
+    std::vector<PlannerHNS::WayPoint>& _traj = obj.predTrajectories[j];
+    ConvertFromAutowareLaneToLocalLane(det_obj.candidate_trajectories.lanes[j], trajectoryFields, _traj);
     for(unsigned int k=0; k < _traj.size(); k++)
-      _traj.at(k).collisionCost = det_obj.candidate_trajectories.lanes.at(j).cost;
-
-    obj.predTrajectories.push_back(_traj);
+      _traj[k].collisionCost = det_obj.candidate_trajectories.lanes[j].cost;
   }
 }
 
+void ROSHelpers::ConvertFromAutowareDetectedObjectsToOpenPlannerDetectedObjects(const autoware_msgs::DetectedObjectArray& det_objs,
+    const unsigned int& trajectoryFields, std::vector<PlannerHNS::DetectedObject>& objs)
+{
+  objs.resize(det_objs.objects.size());
+  for(unsigned int i = 0; i < det_objs.objects.size(); i++)
+    ConvertFromAutowareDetectedObjectToOpenPlannerDetectedObject(det_objs.objects[i], trajectoryFields, objs[i]);
+
+  PlannerHNS::PlanningRecorder* pRecorder = g_pInputsRecorder;
+  if(pRecorder != nullptr)
+    pRecorder->RecordDetectedObjects(ToTimeSpec(det_objs.header.stamp), objs);
+}
+
 void ROSHelpers::ConvertFromOpenPlannerDetectedObjectToAutowareDetectedObject(const PlannerHNS::DetectedObject& det_obj, const bool& bSimulationMode, autoware_msgs::DetectedObject& obj)
 {
   if(bSimulationMode)
@@ -1669,6 +2029,7 @@ void ROSHelpers::ConvertFromOpenPlannerDetectedObjectToAutowareDetectedObject(co
 void ROSHelpers::UpdateRoadMap(const AutowareRoadNetwork& src_map, PlannerHNS::RoadNetwork& out_map)
 {
   std::vector<UtilityHNS::AisanLanesFileReader::AisanLane> lanes;
+  lanes.reserve(src_map.lanes.data.size());
   for(unsigned int i=0; i < src_map.lanes.data.size();i++)
   {
     UtilityHNS::AisanLanesFileReader::AisanLane l;
@@ -1703,6 +2064,7 @@ void ROSHelpers::UpdateRoadMap(const AutowareRoadNetwork& src_map, PlannerHNS::R
   }
 
   std::vector<UtilityHNS::AisanPointsFileReader::AisanPoints> points;
+  points.reserve(src_map.points.data.size());
 
   for(unsigned int i=0; i < src_map.points.data.size();i++)
   {
@@ -1734,6 +2096,7 @@ void ROSHelpers::UpdateRoadMap(const AutowareRoadNetwork& src_map, PlannerHNS::R
 
 
   std::vector<UtilityHNS::AisanCenterLinesFileReader::AisanCenterLine> dts;
+  dts.reserve(src_map.dtlanes.data.size());
   for(unsigned int i=0; i < src_map.dtlanes.data.size();i++)
   {
     UtilityHNS::AisanCenterLinesFileReader::AisanCenterLine dt;
@@ -1767,6 +2130,46 @@ void ROSHelpers::UpdateRoadMap(const AutowareRoadNetwork& src_map, PlannerHNS::R
 
   PlannerHNS::GPSPoint origin;//(m_OriginPos.position.x, m_OriginPos.position.y, m_OriginPos.position.z, 0);
   PlannerHNS::MappingHelpers::ConstructRoadNetworkFromROSMessage(lanes, points, dts, inters, areas, line_data, stop_line_data, signal_data, vector_data, curb_data, roadedge_data,way_area, crossing, nodes_data,  conn_data, origin, out_map);
+
+  PlannerHNS::PlanningRecorder* pRecorder = g_pInputsRecorder;
+  if(pRecorder != nullptr)
+    pRecorder->RecordMap(ToTimeSpec(ros::Time::now()), out_map);
+}
+
+void ROSHelpers::SetInputsRecorder(PlannerHNS::PlanningRecorder* pRecorder)
+{
+  g_pInputsRecorder = pRecorder;
+}
+
+PlannerHNS::PlanningRecorder* ROSHelpers::GetInputsRecorder()
+{
+  return g_pInputsRecorder;
+}
+
+void ROSHelpers::RecordEgoState(const ros::Time& stamp, const PlannerHNS::WayPoint& currPose, const PlannerHNS::VehicleState& vehicleState)
+{
+  PlannerHNS::PlanningRecorder* pRecorder = g_pInputsRecorder;
+  if(pRecorder != nullptr)
+    pRecorder->RecordEgoState(ToTimeSpec(stamp), currPose, vehicleState);
+}
+
+void ROSHelpers::ConvertFromAutowareLaneArrayToGlobalPaths(const autoware_msgs::LaneArray& lanes,
+    std::vector<std::vector<PlannerHNS::WayPoint> >& paths)
+{
+  paths.resize(lanes.lanes.size());
+  for(unsigned int i = 0; i < lanes.lanes.size(); i++)
+    ConvertFromAutowareLaneToLocalLane(lanes.lanes.at(i), paths.at(i));
+
+  PlannerHNS::PlanningRecorder* pRecorder = g_pInputsRecorder;
+  if(pRecorder != nullptr)
+    pRecorder->RecordGlobalPaths(ToTimeSpec(ros::Time::now()), paths);
+}
+
+void ROSHelpers::ConvertFromAutowareLaneArrayToGlobalPaths(const autoware_msgs::LaneArray& lanes,
+    std::vector<std::vector<PlannerHNS::WayPoint> >& paths, unsigned long long& fingerprint)
+{
+  ConvertFromAutowareLaneArrayToGlobalPaths(lanes, paths);
+  fingerprint = PlannerHNS::PlanningHelpers::GetPathFingerprint(paths);
 }
 
 void ROSHelpers::GetIndicatorArrows(const PlannerHNS::WayPoint& center, const double& width,const double& length, const PlannerHNS::LIGHT_INDICATOR& indicator, const int& id, visualization_msgs::MarkerArray& markerArray)
@@ -0,0 +1,86 @@
+/// \file ControlLogWriter.h
+/// \brief Control logs kept as binary records in a ring buffer and written to csv files by a background thread
+/// \date Oct 14, 2026
+
+#ifndef CONTROLLOGWRITER_H_
+#define CONTROLLOGWRITER_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <time.h>
+#include <vector>
+
+namespace SimulationNS
+{
+
+/**
+ * @brief Push copies a fixed size record into a preallocated single producer ring and returns, the records are
+ * formatted and written by the thread of Start, so the control loop never formats strings or touches files.
+ * A record is dropped when the ring is full.
+ */
+class ControlLogWriter
+{
+public:
+  static const int MAX_VALUES = 10;
+  typedef std::string (*FormatFunction)(const time_t& t, const double* values);
+
+  explicit ControlLogWriter(const unsigned int& capacity = 4096);
+  virtual ~ControlLogWriter();
+
+  /**
+   * @brief New csv log logFolder + logTitle + time + .csv as DataRW::WriteLogData names it, the file is created
+   * with its first record. Call before Start.
+   * @return log index for Push
+   */
+  int AddLog(const std::string& logFolder, const std::string& logTitle, const std::string& header, FormatFunction format);
+
+  void Start();
+
+  /**
+   * @brief Writes the remaining records, then stops the thread
+   */
+  void Stop();
+
+  bool Push(const int& log, const time_t& t, const double* values, const int& nValues);
+
+  unsigned long GetDroppedCount() const { return m_nDropped.load(std::memory_order_relaxed); }
+
+private:
+  struct LogRecord
+  {
+    int log;
+    time_t t;
+    double values[MAX_VALUES];
+  };
+
+  struct LogFile
+  {
+    std::string fileName;
+    std::string header;
+    FormatFunction format;
+    std::ofstream* pFile;
+  };
+
+  std::vector<LogRecord> m_Records;
+  unsigned int m_Mask;
+  std::atomic<unsigned long> m_Head; // next record to push, only the producer writes it
+  std::atomic<unsigned long> m_Tail; // next record to write, only the thread writes it
+  std::atomic<unsigned long> m_nDropped;
+  std::vector<LogFile> m_Logs;
+
+  std::thread m_Thread;
+  std::mutex m_Mutex;
+  std::condition_variable m_StopCondition;
+  bool m_bStop;
+
+  void WriterLoop();
+  void WriteRecords();
+};
+
+} /* namespace SimulationNS */
+
+#endif /* CONTROLLOGWRITER_H_ */
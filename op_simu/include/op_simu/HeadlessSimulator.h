@@ -0,0 +1,110 @@
+/// \file HeadlessSimulator.h
+/// \brief Time stepped simulation of the car following a path with SimulatedTrajectoryFollower, without display or wall clock
+/// \date Oct 14, 2026
+
+#ifndef HEADLESSSIMULATOR_H_
+#define HEADLESSSIMULATOR_H_
+
+#include "op_planner/RoadNetwork.h"
+#include "op_planner/PlannerCommonDef.h"
+#include <string>
+#include <vector>
+
+namespace SimulationNS
+{
+
+/**
+ * @brief The car starts at startPose and follows path at up to maxVelocity, until it is within goalDistance of
+ * the last point or duration simulated seconds have passed.
+ */
+class SimulationScenario
+{
+public:
+  std::string name;
+  std::vector<PlannerHNS::WayPoint> path;
+  PlannerHNS::WayPoint startPose;
+  double maxVelocity;
+  double duration;
+  double goalDistance;
+
+  SimulationScenario()
+  {
+    maxVelocity = 3.0;
+    duration = 120.0;
+    goalDistance = 1.0;
+  }
+
+  /**
+   * @brief Path from a file in the LocalizationPathReader format (x, y, z, a, v), the car starts at its first
+   * point and the fastest point gives maxVelocity. false when there are less than two points.
+   */
+  bool LoadFromFile(const std::string& fileName);
+
+  /**
+   * @brief Straight line, circle and S curve of about length meters with points every resolution meters
+   */
+  static void CreateSynthetic(const double& length, const double& resolution, std::vector<SimulationScenario>& scenarios);
+};
+
+class SimulationMetrics
+{
+public:
+  std::string name;
+  bool bReachedGoal;
+  int nSteps;
+  double simulatedTime;
+  double wallTime;
+  double distance; // driven, meters
+  double maxLateralError;
+  double meanLateralError;
+  double maxVelocity;
+  double goalDistance; // at the end of the run
+
+  SimulationMetrics()
+  {
+    bReachedGoal = false;
+    nSteps = 0;
+    simulatedTime = 0;
+    wallTime = 0;
+    distance = 0;
+    maxLateralError = 0;
+    meanLateralError = 0;
+    maxVelocity = 0;
+    goalDistance = 0;
+  }
+};
+
+/**
+ * @brief Runs scenarios as fast as possible: each step of m_dt simulated seconds gives the desired speed and
+ * steering of SimulatedTrajectoryFollower to a kinematic bicycle model with the acceleration and steering limits
+ * of m_CarInfo. Nothing depends on the wall clock, so a scenario gives the same metrics on every run and
+ * scenarios run independently in m_nThreads threads.
+ */
+class HeadlessSimulator
+{
+public:
+  PlannerHNS::ControllerParams m_CtrlParams;
+  PlannerHNS::CAR_BASIC_INFO m_CarInfo;
+  double m_dt;
+  int m_nThreads;
+
+  HeadlessSimulator();
+  virtual ~HeadlessSimulator();
+
+  SimulationMetrics RunScenario(const SimulationScenario& scenario) const;
+
+  /**
+   * @brief Metrics of each scenario, in the order of scenarios
+   */
+  std::vector<SimulationMetrics> RunScenarios(const std::vector<SimulationScenario>& scenarios) const;
+
+  /**
+   * @brief One line per scenario: result, steps, simulated and wall time, real time factor, driven distance,
+   * max and mean lateral error, max velocity and the distance left to the goal
+   */
+  static std::string GetReport(const std::vector<SimulationMetrics>& metrics);
+};
+
+} /* namespace SimulationNS */
+
+#endif /* HEADLESSSIMULATOR_H_ */
@@ -0,0 +1,70 @@
+/// \file KFTrackStates.h
+/// \brief Constant velocity Kalman filter states of all the tracks of SimpleTracker, stored contiguously
+/// \date Oct 14, 2026
+
+#ifndef KFTRACKSTATES_H_
+#define KFTRACKSTATES_H_
+
+#include <Eigen/Core>
+#include <vector>
+
+namespace SimulationNS
+{
+
+/**
+ * The filters of KFTrackV (state x, y, vx, vy, measurement x, y) with the same noise, one column per track:
+ * the states in a 4 x n matrix and the covariances in a 16 x n matrix, so all the tracks are corrected and
+ * predicted by one loop over fixed size blocks instead of one cv::KalmanFilter and its cv::Mat temporaries each.
+ */
+class KFTrackStates
+{
+public:
+  typedef Eigen::Matrix<double, 4, 1> State;
+  typedef Eigen::Matrix<double, 4, 4> Covariance;
+
+  KFTrackStates();
+
+  int size() const { return m_States.cols(); }
+  void clear();
+
+  /**
+   * @brief Keep the states of the given indices in this order, the slots of negative indices are initialized
+   * with InitializeState.
+   */
+  void Reorder(const std::vector<int>& indices);
+
+  /**
+   * @brief Reset the state i to the position x, y without velocity and predict it by dt, as KFTrackV does.
+   */
+  void InitializeState(int i, double x, double y, double dt);
+
+  /**
+   * @brief Correct each state with the measured position of its track.
+   * @param measurements x, y of each track
+   */
+  void Correct(const std::vector<double>& measurements);
+
+  /**
+   * @brief Predict all the states by dt.
+   */
+  void Predict(double dt);
+
+  Eigen::Map<const State> GetState(int i) const { return Eigen::Map<const State>(m_States.col(i).data()); }
+  Eigen::Map<const Covariance> GetCovariance(int i) const { return Eigen::Map<const Covariance>(m_Covariances.col(i).data()); }
+
+public:
+  double m_MeasureCov;
+  double m_ProcessCov;
+  double m_InitialCov;
+
+private:
+  Eigen::Matrix<double, 4, Eigen::Dynamic> m_States;
+  Eigen::Matrix<double, 16, Eigen::Dynamic> m_Covariances;
+
+  static Covariance TransitionMatrix(double dt);
+  void PredictState(int i, const Covariance& F, const Covariance& Q);
+};
+
+}
+
+#endif /* KFTRACKSTATES_H_ */
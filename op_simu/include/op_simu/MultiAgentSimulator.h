@@ -0,0 +1,127 @@
+/// \file MultiAgentSimulator.h
+/// \brief Simulated cars each driven by a SimuDecisionMaker, stepped together in parallel on one read only map
+/// \date Oct 14, 2026
+
+#ifndef MULTIAGENTSIMULATOR_H_
+#define MULTIAGENTSIMULATOR_H_
+
+#include "op_planner/RoadNetwork.h"
+#include "op_planner/PlannerCommonDef.h"
+#include "op_planner/SharedRoadNetwork.h"
+#include "op_planner/SimuDecisionMaker.h"
+#include "op_simu/SimulatedTrajectoryFollower.h"
+#include <memory>
+#include <vector>
+
+namespace SimulationNS
+{
+
+/**
+ * @brief State of one car at the end of a tick, what the other cars see of it during the next tick
+ */
+class SimulatedAgentState
+{
+public:
+  int id;
+  PlannerHNS::WayPoint pose;
+  PlannerHNS::VehicleState vehicleState;
+  PlannerHNS::STATE_TYPE behavior;
+  bool bReachedGoal;
+  int nSteps;
+  double distance; // driven, meters
+
+  SimulatedAgentState()
+  {
+    id = 0;
+    behavior = PlannerHNS::INITIAL_STATE;
+    bReachedGoal = false;
+    nSteps = 0;
+    distance = 0;
+  }
+};
+
+/**
+ * @brief Each tick steps every car once: its SimuDecisionMaker plans with the other cars of the previous tick as
+ * detected objects, SimulatedTrajectoryFollower gives the desired speed and steering, LocalizeStep moves the car.
+ * A tick reads the world state of the previous tick and each car only writes its own entry of the next one,
+ * the two buffers are swapped after the tick. The cars run in parallel on up to m_nThreads threads of the shared
+ * task scheduler, their timers run on the simulated time, so the states are the same for any number of threads.
+ * The map is shared read only by all the cars, the lanes of their global paths point into it.
+ */
+class MultiAgentSimulator
+{
+public:
+  PlannerHNS::ControllerParams m_CtrlParams;
+  PlannerHNS::PlanningParams m_PlanningParams;
+  PlannerHNS::CAR_BASIC_INFO m_CarInfo;
+  double m_dt;
+  int m_nThreads; // cars stepped in parallel, 1 steps them one after the other
+  double m_ObjectsDistance; // the other cars closer than this are the detected objects of a car
+  double m_GoalDistance; // a car stops when its planner finished or it is this close to the end of its global path
+
+  MultiAgentSimulator();
+  virtual ~MultiAgentSimulator();
+
+  /**
+   * @brief Map of the cars added after the call, kept alive while they run
+   */
+  void SetRoadNetwork(const PlannerHNS::RoadNetworkSnapshotPtr& pMap);
+
+  /**
+   * @brief New car at startPose following globalPaths, with the parameters of the simulator at the time of the call
+   * @return id of the car, its index in the world state
+   */
+  int AddAgent(const PlannerHNS::WayPoint& startPose, const std::vector<std::vector<PlannerHNS::WayPoint> >& globalPaths);
+
+  /**
+   * @brief Advance all the cars by m_dt
+   */
+  void Step();
+
+  /**
+   * @brief nSteps ticks, or less if all the cars reached their goal, returns the ticks done
+   */
+  int Run(const int& nSteps);
+
+  const std::vector<SimulatedAgentState>& GetWorldState() const;
+  double GetSimulatedTime() const { return m_SimulatedTime; }
+  int GetAgentsCount() const { return m_Agents.size(); }
+
+  /**
+   * @brief 64 bit FNV-1a hash of the poses and speeds of all the cars, equal for equal runs
+   */
+  unsigned long long GetStateChecksum() const;
+
+  /**
+   * @brief nLanes parallel straight lanes of length meters, 3.5 meters apart, points every resolution meters,
+   * speed is the speed limit of the lanes in m/s
+   */
+  static void CreateParallelLanes(const int& nLanes, const double& length, const double& resolution, const double& speed,
+      PlannerHNS::RoadNetwork& map);
+
+private:
+  class Agent
+  {
+  public:
+    PlannerHNS::SimuDecisionMaker planner;
+    SimulatedTrajectoryFollower follower;
+    PlannerHNS::WayPoint goal;
+    std::vector<PlannerHNS::DetectedObject> objects;
+  };
+
+  PlannerHNS::RoadNetworkSnapshotPtr m_pMap;
+  std::vector<std::unique_ptr<Agent> > m_Agents;
+  std::vector<SimulatedAgentState> m_WorldState[2];
+  int m_iFront; // buffer of the last finished tick
+  double m_SimulatedTime;
+
+  void StepAgent(const int& i);
+  void GetObjects(const int& i, std::vector<PlannerHNS::DetectedObject>& objects) const;
+
+  MultiAgentSimulator(const MultiAgentSimulator&);
+  MultiAgentSimulator& operator=(const MultiAgentSimulator&);
+};
+
+} /* namespace SimulationNS */
+
+#endif /* MULTIAGENTSIMULATOR_H_ */
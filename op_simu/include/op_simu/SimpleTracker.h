@@ -9,6 +9,7 @@
 
 #include "op_planner/RoadNetwork.h"
 #include "op_planner/PlanningHelpers.h"
+#include "op_simu/KFTrackStates.h"
 #include "opencv2/video/tracking.hpp"
 #include <vector>
 #include "op_utility/UtilityH.h"
@@ -21,7 +22,11 @@ namespace SimulationNS
 #define DEBUG_TRACKER 0
 #define NEVER_GORGET_TIME -1000
 
-enum TRACKING_TYPE {ASSOCIATE_ONLY = 0, SIMPLE_TRACKER = 1, CONTOUR_TRACKER = 2};
+/**
+ * ASSOCIATE_ONLY and SIMPLE_TRACKER match the detections to the tracks greedily, the _OPTIMAL ones with the
+ * assignment of minimum total cost over the pairs gated by distance, size and angle, see MatchOptimalCost.
+ */
+enum TRACKING_TYPE {ASSOCIATE_ONLY = 0, SIMPLE_TRACKER = 1, CONTOUR_TRACKER = 2, ASSOCIATE_ONLY_OPTIMAL = 3, SIMPLE_TRACKER_OPTIMAL = 4};
 
 struct Kalman1dState
 {
@@ -79,6 +84,7 @@ public:
   int region_id;
   double forget_time;
   int m_iLife;
+  int state_index; // column of the track in SimpleTracker::m_TrackStates when m_bBatchKalman, -1 until it is added
   PlannerHNS::DetectedObject obj; // Used for associate only , don't remove
   //kalmanFilter1D errorSmoother;
 
@@ -94,6 +100,7 @@ public:
 //    errorSmoother.result.p = 1;
 //    errorSmoother.result.x = 0;
     region_id = -1;
+    state_index = -1;
     forget_time = NEVER_GORGET_TIME; // this is very bad , dangerous
     m_iLife = 0;
     prev_x = x;
@@ -162,11 +169,27 @@ public:
 
     prediction = m_filter.correct(measurement);
 
-    predObj.center.pos.x = prediction.at<float>(0);
-    predObj.center.pos.y = prediction.at<float>(1);
+    double x = prediction.at<float>(0);
+    double y = prediction.at<float>(1);
     double vx  = prediction.at<float>(2);
     double vy  = prediction.at<float>(3);
 
+    // statePost shares the data of prediction
+    m_filter.predict();
+    m_filter.statePre.copyTo(m_filter.statePost);
+    m_filter.errorCovPre.copyTo(m_filter.errorCovPost);
+
+    UpdateTrackingState(_dt, x, y, vx, vy, predObj);
+  }
+
+  /**
+   * @brief The part of UpdateTracking after the filter, from the corrected state x, y, vx, vy.
+   */
+  void UpdateTrackingState(double _dt, double x, double y, double vx, double vy, PlannerHNS::DetectedObject& predObj)
+  {
+    predObj.center.pos.x = x;
+    predObj.center.pos.y = y;
+
     double currA = 0;
     double currV = 0;
 
@@ -231,11 +254,6 @@ public:
       predObj.center.pos.a = predObj.centers_list.at(predObj.centers_list.size()-1).pos.a;
     }
 
-
-    m_filter.predict();
-    m_filter.statePre.copyTo(m_filter.statePost);
-    m_filter.errorCovPre.copyTo(m_filter.errorCovPost);
-
     prev_a = currA;
     prev_y = predObj.center.pos.y;
     prev_x = predObj.center.pos.x;
@@ -477,6 +495,14 @@ public:
   void InitSimpleTracker();
   void InitializeInterestRegions(std::vector<InterestCircle*>& regions);
 
+  /**
+   * @brief Minimum cost assignment of a square cost matrix by the Hungarian method, O(n^3).
+   * @param cost cost[i][j] of assigning row i to column j
+   * @param assignment column of each row
+   * @return total cost
+   */
+  static double SolveAssignment(const std::vector<std::vector<double> >& cost, std::vector<int>& assignment);
+
 public:
   double m_dt;
   double m_MAX_ASSOCIATION_DISTANCE;
@@ -488,19 +514,27 @@ public:
   double m_CirclesResolution;
   double m_MAX_ASSOCIATION_SIZE_DIFF;
   double m_MAX_ASSOCIATION_ANGLE_DIFF;
+  /**
+   * SIMPLE_TRACKER and SIMPLE_TRACKER_OPTIMAL filter the tracks of m_TrackSimply together in m_TrackStates
+   * instead of with the cv::KalmanFilter of each track.
+   */
+  bool m_bBatchKalman;
+  KFTrackStates m_TrackStates;
 
 private:
   std::vector<KFTrackV> newObjects;
   void AssociateAndTrack();
-  void AssociateSimply();
+  void AssociateSimply(bool bOptimal = false);
   void AssociateToRegions(KFTrackV& detectedObject);
   void CleanOldTracks();
-  void AssociateOnly();
+  void AssociateOnly(bool bOptimal = false);
   void MergeObjectAndTrack(KFTrackV& track, PlannerHNS::DetectedObject& obj);
   int InsidePolygon(const std::vector<PlannerHNS::GPSPoint>& polygon,const PlannerHNS::GPSPoint& p);
 
   void MatchClosest();
   void MatchClosestCost();
+  void MatchOptimalCost();
+  void UpdateTracksBatch();
 
 };
 
@@ -10,6 +10,7 @@
 #include "op_planner/RoadNetwork.h"
 #include "op_utility/UtilityH.h"
 #include "op_planner/PlannerCommonDef.h"
+#include "op_simu/ControlLogWriter.h"
 
 
 #define MAX_ACCELERATION_2G 5 // meter /sec/sec
@@ -47,6 +48,7 @@ public:
   int           m_iCalculatedIndex;
   bool          m_bEndPath;
   double           m_WayPointsDensity;
+  double           m_HighSpeedSteerGainRatio; // steering gains at max_speed_forward relative to Steering_Gain, set before Init
 
 
 private:
@@ -65,16 +67,20 @@ private:
   UtilityHNS::PIDController   m_pidVelocity;
   UtilityHNS::LowpassFilter   m_lowpassVelocity;
 
+  std::vector<PlannerHNS::PID_CONST> m_SteerGainSchedule; // steering gains every m_GainScheduleResolution m/s, built in Init
+  double            m_GainScheduleResolution;
+
   bool            m_bEnableLog;
   std::vector<std::string>    m_LogData;
-  std::vector<std::string>    m_LogSteerPIDData;
-  std::vector<std::string>    m_LogVelocityPIDData;
+  ControlLogWriter*      m_pLogWriter;
+  int              m_iSteerPIDLog;
+  int              m_iVelocityPIDLog;
+  int              m_iSteerCalibrationLog;
+  int              m_iVelocityCalibrationLog;
 
   //Steering and Velocity Calibration Global Variables
   bool            m_bCalibrationMode;
   int              m_iNextTest;
-  std::vector<std::string>    m_SteerCalibrationData;
-  std::vector<std::string>    m_VelocityCalibrationData;
   PlannerHNS::VehicleState   m_prevCurrState_steer;
   PlannerHNS::VehicleState   m_prevDesiredState_steer;
   PlannerHNS::VehicleState   m_prevCurrState_vel;
@@ -97,6 +103,9 @@ private:
   double GetPID_LinearChange(double minVal, double maxVal, double speedMax, double currSpeed);
 
   void AdjustPID(const double& v, const double& maxV,  PlannerHNS::PID_CONST& steerPID);
+  void InitGainSchedule();
+  void InitLogs();
+  void LogPID(const int& log, const UtilityHNS::PIDController& pid);
 
   int CalculateVelocityDesired(const double& dt, const double& currVel,const PlannerHNS::STATE_TYPE& CurrBehavior,
       double& desiredVel);
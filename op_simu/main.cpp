@@ -5,11 +5,103 @@
  *      Author: hatem
  */
 
+#include "op_simu/HeadlessSimulator.h"
+#include "op_simu/MultiAgentSimulator.h"
+#include "op_utility/UtilityH.h"
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
 
-int main(int argc, char** argv)
+// nAgents cars on 4 parallel lanes, 20 meters apart on each lane, all stepped together
+int RunAgents(const int& nAgents, const int& nThreads, const double& dt, const double& duration)
 {
+  const int nLanes = 4;
+  const int nPerLane = (nAgents + nLanes - 1) / nLanes;
+  std::shared_ptr<PlannerHNS::RoadNetwork> pMap(new PlannerHNS::RoadNetwork());
+  SimulationNS::MultiAgentSimulator::CreateParallelLanes(nLanes, nPerLane * 20.0 + 200.0, 0.5, 8.0, *pMap);
+
+  SimulationNS::MultiAgentSimulator simulator;
+  if(nThreads > 0)
+    simulator.m_nThreads = nThreads;
+  simulator.m_dt = dt;
+  simulator.m_PlanningParams.maxSpeed = 8.0;
+  simulator.m_PlanningParams.microPlanDistance = 50.0;
+  simulator.m_PlanningParams.horizonDistance = 100.0;
+  simulator.m_PlanningParams.pathDensity = 0.5;
+  simulator.m_PlanningParams.rollOutNumber = 0;
+  simulator.m_CarInfo.max_speed_forward = 8.0;
+  simulator.SetRoadNetwork(pMap);
+  for(int i = 0; i < nAgents; i++)
+  {
+    const std::vector<PlannerHNS::WayPoint>& lane_points = pMap->roadSegments.at(0).Lanes.at(i % nLanes).points;
+    std::vector<std::vector<PlannerHNS::WayPoint> > paths(1, lane_points);
+    simulator.AddAgent(lane_points.at((nPerLane - 1 - i / nLanes) * 40), paths);
+  }
+
+  struct timespec t;
+  UtilityHNS::UtilityH::GetTickCount(t);
+  const int nSteps = simulator.Run(duration / dt);
+  const double time = UtilityHNS::UtilityH::GetTimeDiffNow(t);
 
+  int nReached = 0;
+  for(unsigned int i = 0; i < simulator.GetWorldState().size(); i++)
+    nReached += simulator.GetWorldState().at(i).bReachedGoal;
+  std::cout << "Agents: " << nAgents << ", Threads: " << simulator.m_nThreads << ", Ticks: " << nSteps
+      << ", Reached goal: " << nReached << ", Time: " << time << " s, Checksum: " << std::hex
+      << simulator.GetStateChecksum() << std::dec << std::endl;
+  return 0;
 }
 
+// Simu [-threads n] [-dt seconds] [-duration seconds] [-agents n] [path.csv ...]
+// runs each path file as a scenario, or the synthetic scenarios when there is none, and prints their metrics,
+// with -agents runs n cars together instead and prints the checksum of their final states
+int main(int argc, char** argv)
+{
+  SimulationNS::HeadlessSimulator simulator;
+  double duration = 120.0;
+  int nAgents = 0;
+  std::vector<std::string> files;
+  for(int i = 1; i < argc; i++)
+  {
+    if(strcmp(argv[i], "-threads") == 0 && i + 1 < argc)
+      simulator.m_nThreads = atoi(argv[++i]);
+    else if(strcmp(argv[i], "-dt") == 0 && i + 1 < argc)
+      simulator.m_dt = atof(argv[++i]);
+    else if(strcmp(argv[i], "-duration") == 0 && i + 1 < argc)
+      duration = atof(argv[++i]);
+    else if(strcmp(argv[i], "-agents") == 0 && i + 1 < argc)
+      nAgents = atoi(argv[++i]);
+    else
+      files.push_back(argv[i]);
+  }
+
+  if(nAgents > 0)
+    return RunAgents(nAgents, simulator.m_nThreads, simulator.m_dt, duration);
+
+  std::vector<SimulationNS::SimulationScenario> scenarios;
+  for(unsigned int i = 0; i < files.size(); i++)
+  {
+    SimulationNS::SimulationScenario scenario;
+    if(!scenario.LoadFromFile(files.at(i)))
+    {
+      std::cout << "Can't load the path " << files.at(i) << std::endl;
+      return 1;
+    }
+    scenarios.push_back(scenario);
+  }
+  if(scenarios.size() == 0)
+    SimulationNS::SimulationScenario::CreateSynthetic(200.0, 0.5, scenarios);
+
+  for(unsigned int i = 0; i < scenarios.size(); i++)
+    scenarios.at(i).duration = duration;
 
+  std::vector<SimulationNS::SimulationMetrics> metrics = simulator.RunScenarios(scenarios);
+  std::cout << SimulationNS::HeadlessSimulator::GetReport(metrics);
+
+  for(unsigned int i = 0; i < metrics.size(); i++)
+  {
+    if(!metrics.at(i).bReachedGoal)
+      return 2;
+  }
+  return 0;
+}
@@ -0,0 +1,119 @@
+/// \file ControlLogWriter.cpp
+/// \brief Control logs kept as binary records in a ring buffer and written to csv files by a background thread
+/// \date Oct 14, 2026
+
+#include "op_simu/ControlLogWriter.h"
+#include "op_utility/UtilityH.h"
+#include <algorithm>
+#include <chrono>
+
+namespace SimulationNS
+{
+
+const int ControlLogWriter::MAX_VALUES;
+
+ControlLogWriter::ControlLogWriter(const unsigned int& capacity) : m_Head(0), m_Tail(0), m_nDropped(0), m_bStop(false)
+{
+  unsigned int size = 1;
+  while(size < capacity)
+    size *= 2;
+  m_Records.resize(size);
+  m_Mask = size - 1;
+}
+
+ControlLogWriter::~ControlLogWriter()
+{
+  Stop();
+  for(unsigned int i = 0; i < m_Logs.size(); i++)
+    delete m_Logs.at(i).pFile;
+}
+
+int ControlLogWriter::AddLog(const std::string& logFolder, const std::string& logTitle, const std::string& header, FormatFunction format)
+{
+  LogFile log;
+  log.fileName = logFolder + logTitle + UtilityHNS::UtilityH::GetFilePrefixHourMinuteSeconds() + ".csv";
+  log.header = header;
+  log.format = format;
+  log.pFile = 0;
+  m_Logs.push_back(log);
+  return m_Logs.size() - 1;
+}
+
+void ControlLogWriter::Start()
+{
+  if(m_Thread.joinable())
+    return;
+  m_bStop = false;
+  m_Thread = std::thread(&ControlLogWriter::WriterLoop, this);
+}
+
+void ControlLogWriter::Stop()
+{
+  if(!m_Thread.joinable())
+    return;
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_bStop = true;
+  }
+  m_StopCondition.notify_one();
+  m_Thread.join();
+}
+
+bool ControlLogWriter::Push(const int& log, const time_t& t, const double* values, const int& nValues)
+{
+  unsigned long head = m_Head.load(std::memory_order_relaxed);
+  if(head - m_Tail.load(std::memory_order_acquire) >= m_Records.size())
+  {
+    m_nDropped.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+
+  LogRecord& record = m_Records.at(head & m_Mask);
+  record.log = log;
+  record.t = t;
+  std::copy(values, values + std::min(nValues, (int)MAX_VALUES), record.values);
+  m_Head.store(head + 1, std::memory_order_release);
+  return true;
+}
+
+void ControlLogWriter::WriterLoop()
+{
+  // the producer does not notify, the records are written every 100 ms
+  std::unique_lock<std::mutex> lock(m_Mutex);
+  while(!m_bStop)
+  {
+    m_StopCondition.wait_for(lock, std::chrono::milliseconds(100));
+    lock.unlock();
+    WriteRecords();
+    lock.lock();
+  }
+  lock.unlock();
+  WriteRecords();
+
+  for(unsigned int i = 0; i < m_Logs.size(); i++)
+  {
+    if(m_Logs.at(i).pFile)
+      m_Logs.at(i).pFile->flush();
+  }
+}
+
+void ControlLogWriter::WriteRecords()
+{
+  unsigned long tail = m_Tail.load(std::memory_order_relaxed);
+  unsigned long head = m_Head.load(std::memory_order_acquire);
+  for(; tail < head; tail++)
+  {
+    const LogRecord& record = m_Records.at(tail & m_Mask);
+    LogFile& log = m_Logs.at(record.log);
+    if(!log.pFile)
+    {
+      log.pFile = new std::ofstream(log.fileName.c_str());
+      if(log.header.size() > 0)
+        *log.pFile << log.header << "\r\n";
+    }
+    *log.pFile << log.format(record.t, record.values) << "\r\n";
+  }
+  m_Tail.store(tail, std::memory_order_release);
+}
+
+} /* namespace SimulationNS */
@@ -0,0 +1,187 @@
+/// \file HeadlessSimulator.cpp
+/// \brief Time stepped simulation of the car following a path with SimulatedTrajectoryFollower, without display or wall clock
+/// \date Oct 14, 2026
+
+#include "op_simu/HeadlessSimulator.h"
+#include "op_simu/SimulatedTrajectoryFollower.h"
+#include "op_planner/PlanningHelpers.h"
+#include "op_utility/DataRW.h"
+#include "op_utility/UtilityH.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+#include <thread>
+
+using namespace PlannerHNS;
+using namespace UtilityHNS;
+
+namespace SimulationNS
+{
+
+bool SimulationScenario::LoadFromFile(const std::string& fileName)
+{
+  std::vector<LocalizationPathReader::LocalizationWayPoint> points;
+  LocalizationPathReader reader(fileName, ',');
+  reader.ReadAllData(points);
+  if(points.size() < 2)
+    return false;
+
+  name = fileName;
+  path.clear();
+  maxVelocity = 0;
+  for(unsigned int i = 0; i < points.size(); i++)
+  {
+    WayPoint wp(points.at(i).x, points.at(i).y, points.at(i).z, points.at(i).a);
+    wp.v = points.at(i).v;
+    path.push_back(wp);
+    maxVelocity = std::max(maxVelocity, points.at(i).v);
+  }
+  PlanningHelpers::CalcAngleAndCost(path);
+  startPose = path.at(0);
+  return true;
+}
+
+void SimulationScenario::CreateSynthetic(const double& length, const double& resolution, std::vector<SimulationScenario>& scenarios)
+{
+  int nPoints = std::max(2, (int)(length / resolution) + 1);
+  double radius = length / (2.0 * M_PI);
+
+  SimulationScenario straight, circle, s_curve;
+  straight.name = "straight";
+  circle.name = "circle";
+  s_curve.name = "s_curve";
+  for(int i = 0; i < nPoints; i++)
+  {
+    double s = i * resolution;
+    straight.path.push_back(WayPoint(s, 0, 0, 0));
+    // stops short of closing the circle, so the goal is not the start
+    double a = 0.95 * s / radius;
+    circle.path.push_back(WayPoint(radius * sin(a), radius - radius * cos(a), 0, 0));
+    s_curve.path.push_back(WayPoint(s, 5.0 * sin(2.0 * M_PI * s / length), 0, 0));
+  }
+
+  SimulationScenario* pScenarios[] = {&straight, &circle, &s_curve};
+  for(unsigned int i = 0; i < 3; i++)
+  {
+    PlanningHelpers::CalcAngleAndCost(pScenarios[i]->path);
+    pScenarios[i]->startPose = pScenarios[i]->path.at(0);
+    scenarios.push_back(*pScenarios[i]);
+  }
+}
+
+HeadlessSimulator::HeadlessSimulator()
+{
+  m_dt = 0.01;
+  m_nThreads = std::max(1u, std::thread::hardware_concurrency());
+  m_CtrlParams.Steering_Gain = PID_CONST(1.5, 0.0, 0.0);
+  m_CtrlParams.Velocity_Gain = PID_CONST(0.1, 0.005, 0.1);
+}
+
+HeadlessSimulator::~HeadlessSimulator()
+{
+}
+
+SimulationMetrics HeadlessSimulator::RunScenario(const SimulationScenario& scenario) const
+{
+  SimulationMetrics metrics;
+  metrics.name = scenario.name;
+  if(scenario.path.size() < 2)
+    return metrics;
+
+  timespec wall_timer;
+  UtilityH::GetTickCount(wall_timer);
+
+  SimulatedTrajectoryFollower follower;
+  follower.Init(m_CtrlParams, m_CarInfo);
+
+  BehaviorState behavior;
+  behavior.state = FORWARD_STATE;
+  behavior.maxVelocity = std::min(scenario.maxVelocity, m_CarInfo.max_speed_forward);
+
+  WayPoint pose = scenario.startPose;
+  VehicleState state;
+  const WayPoint& goal = scenario.path.at(scenario.path.size() - 1);
+  double sum_lateral_error = 0;
+  int nSteps = std::ceil(scenario.duration / m_dt);
+
+  for(int i = 0; i < nSteps; i++)
+  {
+    metrics.goalDistance = hypot(goal.pos.y - pose.pos.y, goal.pos.x - pose.pos.x);
+    if(metrics.goalDistance <= scenario.goalDistance)
+    {
+      metrics.bReachedGoal = true;
+      break;
+    }
+
+    VehicleState desired = follower.DoOneStep(m_dt, behavior, scenario.path, pose, state, i == 0);
+
+    // the speed follows the desired one within the acceleration limits, the steering within its range
+    double dv = std::min(std::max(desired.speed - state.speed, m_CarInfo.max_deceleration * m_dt), m_CarInfo.max_acceleration * m_dt);
+    state.speed += dv;
+    state.steer = std::min(std::max(desired.steer, -m_CarInfo.max_steer_angle), m_CarInfo.max_steer_angle);
+    state.shift = desired.shift;
+
+    pose.pos.x += state.speed * m_dt * cos(pose.pos.a);
+    pose.pos.y += state.speed * m_dt * sin(pose.pos.a);
+    pose.pos.a = UtilityH::FixNegativeAngle(pose.pos.a + state.speed * m_dt * tan(state.steer) / m_CarInfo.wheel_base);
+    pose.v = state.speed;
+
+    metrics.nSteps++;
+    metrics.distance += state.speed * m_dt;
+    metrics.maxVelocity = std::max(metrics.maxVelocity, state.speed);
+    metrics.maxLateralError = std::max(metrics.maxLateralError, fabs(follower.m_LateralError));
+    sum_lateral_error += fabs(follower.m_LateralError);
+  }
+
+  metrics.simulatedTime = metrics.nSteps * m_dt;
+  if(metrics.nSteps > 0)
+    metrics.meanLateralError = sum_lateral_error / metrics.nSteps;
+  metrics.wallTime = UtilityH::GetTimeDiffNow(wall_timer);
+  return metrics;
+}
+
+std::vector<SimulationMetrics> HeadlessSimulator::RunScenarios(const std::vector<SimulationScenario>& scenarios) const
+{
+  std::vector<SimulationMetrics> metrics(scenarios.size());
+  std::atomic<unsigned int> next_scenario(0);
+  auto worker = [&]()
+  {
+    for(unsigned int i = next_scenario++; i < scenarios.size(); i = next_scenario++)
+      metrics.at(i) = RunScenario(scenarios.at(i));
+  };
+
+  int nThreads = std::min<int>(std::max(1, m_nThreads), scenarios.size());
+  std::vector<std::thread> threads;
+  for(int i = 1; i < nThreads; i++)
+    threads.push_back(std::thread(worker));
+  worker();
+  for(unsigned int i = 0; i < threads.size(); i++)
+    threads.at(i).join();
+
+  return metrics;
+}
+
+std::string HeadlessSimulator::GetReport(const std::vector<SimulationMetrics>& metrics)
+{
+  std::ostringstream str;
+  str << std::fixed << std::setprecision(3);
+  for(unsigned int i = 0; i < metrics.size(); i++)
+  {
+    const SimulationMetrics& m = metrics.at(i);
+    double real_time_factor = m.wallTime > 0 ? m.simulatedTime / m.wallTime : 0;
+    str << m.name << ": " << (m.bReachedGoal ? "goal" : "timeout")
+        << ", steps " << m.nSteps
+        << ", sim " << m.simulatedTime << " s"
+        << ", wall " << m.wallTime * 1000.0 << " ms"
+        << ", x" << std::setprecision(0) << real_time_factor << std::setprecision(3)
+        << ", distance " << m.distance << " m"
+        << ", lateral max " << m.maxLateralError << " m, mean " << m.meanLateralError << " m"
+        << ", max v " << m.maxVelocity << " m/s"
+        << ", to goal " << m.goalDistance << " m" << std::endl;
+  }
+  return str.str();
+}
+
+} /* namespace SimulationNS */
@@ -0,0 +1,87 @@
+/// \file KFTrackStates.cpp
+/// \brief Constant velocity Kalman filter states of all the tracks of SimpleTracker, stored contiguously
+/// \date Oct 14, 2026
+
+#include "op_simu/KFTrackStates.h"
+#include <Eigen/LU>
+
+namespace SimulationNS
+{
+
+KFTrackStates::KFTrackStates()
+{
+  // same noise as the cv::KalmanFilter of KFTrackV
+  m_MeasureCov = 0.0001;
+  m_ProcessCov = 0.0001;
+  m_InitialCov = 0.075;
+}
+
+void KFTrackStates::clear()
+{
+  m_States.resize(4, 0);
+  m_Covariances.resize(16, 0);
+}
+
+void KFTrackStates::Reorder(const std::vector<int>& indices)
+{
+  Eigen::Matrix<double, 4, Eigen::Dynamic> states(4, indices.size());
+  Eigen::Matrix<double, 16, Eigen::Dynamic> covariances(16, indices.size());
+  for(unsigned int i = 0; i < indices.size(); i++)
+  {
+    if(indices.at(i) < 0)
+      continue;
+    states.col(i) = m_States.col(indices.at(i));
+    covariances.col(i) = m_Covariances.col(indices.at(i));
+  }
+  m_States.swap(states);
+  m_Covariances.swap(covariances);
+}
+
+void KFTrackStates::InitializeState(int i, double x, double y, double dt)
+{
+  m_States.col(i) << x, y, 0, 0;
+  Eigen::Map<Covariance>(m_Covariances.col(i).data()) = Covariance::Identity() * m_InitialCov;
+  PredictState(i, TransitionMatrix(dt), Covariance::Identity() * m_ProcessCov);
+}
+
+void KFTrackStates::Correct(const std::vector<double>& measurements)
+{
+  const Eigen::Matrix2d R = Eigen::Matrix2d::Identity() * m_MeasureCov;
+  for(int i = 0; i < size(); i++)
+  {
+    Eigen::Map<State> state(m_States.col(i).data());
+    Eigen::Map<Covariance> P(m_Covariances.col(i).data());
+    Eigen::Vector2d z(measurements.at(2*i), measurements.at(2*i+1));
+
+    // the measurement matrix selects the position, the gain K = P H' (H P H' + R)^-1
+    Eigen::Matrix<double, 4, 2> K = P.leftCols<2>() * (P.topLeftCorner<2, 2>() + R).inverse();
+    state += K * (z - state.head<2>());
+    P -= K * P.topRows<2>();
+  }
+}
+
+void KFTrackStates::Predict(double dt)
+{
+  const Covariance F = TransitionMatrix(dt);
+  const Covariance Q = Covariance::Identity() * m_ProcessCov;
+  for(int i = 0; i < size(); i++)
+    PredictState(i, F, Q);
+}
+
+KFTrackStates::Covariance KFTrackStates::TransitionMatrix(double dt)
+{
+  Covariance F = Covariance::Identity();
+  F(0, 2) = dt;
+  F(1, 3) = dt;
+  return F;
+}
+
+void KFTrackStates::PredictState(int i, const Covariance& F, const Covariance& Q)
+{
+  Eigen::Map<State> state(m_States.col(i).data());
+  Eigen::Map<Covariance> P(m_Covariances.col(i).data());
+  state = F * state;
+  P = F * P * F.transpose() + Q;
+}
+
+}
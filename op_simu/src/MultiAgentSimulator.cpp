@@ -0,0 +1,227 @@
+/// \file MultiAgentSimulator.cpp
+/// \brief Simulated cars each driven by a SimuDecisionMaker, stepped together in parallel on one read only map
+/// \date Oct 14, 2026
+
+#include "op_simu/MultiAgentSimulator.h"
+#include "op_planner/PlanningHelpers.h"
+#include "op_utility/TaskScheduler.h"
+#include "op_utility/UtilityH.h"
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+using namespace PlannerHNS;
+using namespace UtilityHNS;
+
+namespace SimulationNS
+{
+
+MultiAgentSimulator::MultiAgentSimulator()
+{
+  m_dt = 0.05;
+  m_nThreads = std::max(1u, std::thread::hardware_concurrency());
+  m_ObjectsDistance = 50.0;
+  m_GoalDistance = 2.0;
+  m_CtrlParams.Steering_Gain = PID_CONST(1.5, 0.0, 0.0);
+  m_CtrlParams.Velocity_Gain = PID_CONST(0.1, 0.005, 0.1);
+  m_iFront = 0;
+  m_SimulatedTime = 0;
+}
+
+MultiAgentSimulator::~MultiAgentSimulator()
+{
+}
+
+void MultiAgentSimulator::SetRoadNetwork(const RoadNetworkSnapshotPtr& pMap)
+{
+  m_pMap = pMap;
+}
+
+int MultiAgentSimulator::AddAgent(const WayPoint& startPose, const std::vector<std::vector<WayPoint> >& globalPaths)
+{
+  //the state timers of the planner start at the current simulated time
+  SimulatedClockScope clock(m_SimulatedTime);
+
+  std::unique_ptr<Agent> pAgent(new Agent());
+  pAgent->planner.m_pSharedMap = m_pMap;
+  pAgent->planner.Init(m_CtrlParams, m_PlanningParams, m_CarInfo);
+  pAgent->planner.ReInitializePlanner(startPose);
+  pAgent->planner.SetNewGlobalPath(globalPaths);
+  pAgent->follower.Init(m_CtrlParams, m_CarInfo);
+  if(globalPaths.size() > 0 && globalPaths.at(0).size() > 0)
+    pAgent->goal = globalPaths.at(0).back();
+  else
+    pAgent->goal = startPose;
+
+  SimulatedAgentState agent_state;
+  agent_state.id = m_Agents.size();
+  agent_state.pose = pAgent->planner.state;
+  agent_state.vehicleState.shift = SHIFT_POS_DD;
+  m_Agents.push_back(std::move(pAgent));
+
+  //both buffers, a car added between two ticks is seen by the others from the next one
+  m_WorldState[0].push_back(agent_state);
+  m_WorldState[1].push_back(agent_state);
+  return agent_state.id;
+}
+
+void MultiAgentSimulator::GetObjects(const int& i, std::vector<DetectedObject>& objects) const
+{
+  //the other cars as boxes of the car size, in the order of their ids
+  const std::vector<SimulatedAgentState>& world = m_WorldState[m_iFront];
+  const WayPoint& pose = world.at(i).pose;
+  const double half_l = m_CarInfo.length / 2.0;
+  const double half_w = m_CarInfo.width / 2.0;
+  objects.clear();
+  for(unsigned int j = 0; j < world.size(); j++)
+  {
+    if((int)j == i) continue;
+    const WayPoint& other = world.at(j).pose;
+    if(hypot(other.pos.y - pose.pos.y, other.pos.x - pose.pos.x) > m_ObjectsDistance) continue;
+
+    DetectedObject obj;
+    obj.id = world.at(j).id;
+    obj.t = CAR;
+    obj.label = "simulated_car";
+    obj.center = other;
+    obj.center.v = world.at(j).vehicleState.speed;
+    obj.actual_speed = obj.center.v;
+    obj.actual_yaw = other.pos.a;
+    obj.bDirection = true;
+    obj.bVelocity = true;
+    obj.l = m_CarInfo.length;
+    obj.w = m_CarInfo.width;
+    const double c = cos(other.pos.a), s = sin(other.pos.a);
+    const double corners[4][2] = {{half_l, half_w}, {half_l, -half_w}, {-half_l, -half_w}, {-half_l, half_w}};
+    for(int k = 0; k < 4; k++)
+    {
+      obj.contour.push_back(GPSPoint(other.pos.x + corners[k][0]*c - corners[k][1]*s,
+          other.pos.y + corners[k][0]*s + corners[k][1]*c, other.pos.z, 0));
+    }
+    objects.push_back(obj);
+  }
+}
+
+void MultiAgentSimulator::StepAgent(const int& i)
+{
+  const SimulatedAgentState& prev = m_WorldState[m_iFront].at(i);
+  SimulatedAgentState& next = m_WorldState[1 - m_iFront].at(i);
+  next = prev;
+  if(prev.bReachedGoal)
+    return;
+
+  Agent& agent = *m_Agents.at(i);
+  SimulatedClockScope clock(m_SimulatedTime);
+  GetObjects(i, agent.objects);
+
+  std::vector<TrafficLight> traffic_lights;
+  BehaviorState beh = agent.planner.DoOneStep(m_dt, prev.vehicleState, 1, traffic_lights, agent.objects, false);
+  VehicleState desired = agent.follower.DoOneStep(m_dt, beh, agent.planner.m_Path, agent.planner.state, prev.vehicleState, beh.bNewPlan);
+  next.vehicleState = agent.planner.LocalizeStep(m_dt, desired);
+
+  next.pose = agent.planner.state;
+  next.pose.v = next.vehicleState.speed;
+  next.behavior = beh.state;
+  next.nSteps++;
+  next.distance += hypot(next.pose.pos.y - prev.pose.pos.y, next.pose.pos.x - prev.pose.pos.x);
+  next.bReachedGoal = beh.state == FINISH_STATE
+      || hypot(agent.goal.pos.y - next.pose.pos.y, agent.goal.pos.x - next.pose.pos.x) <= m_GoalDistance;
+}
+
+void MultiAgentSimulator::Step()
+{
+  const int nAgents = m_Agents.size();
+  if(m_nThreads > 1 && nAgents > 1)
+    TaskScheduler::GetShared().ParallelFor(nAgents, [this](const int& i) { StepAgent(i); }, m_nThreads);
+  else
+  {
+    for(int i = 0; i < nAgents; i++)
+      StepAgent(i);
+  }
+
+  m_iFront = 1 - m_iFront;
+  m_SimulatedTime += m_dt;
+}
+
+int MultiAgentSimulator::Run(const int& nSteps)
+{
+  for(int i = 0; i < nSteps; i++)
+  {
+    const std::vector<SimulatedAgentState>& world = GetWorldState();
+    bool bAllReached = true;
+    for(unsigned int j = 0; j < world.size() && bAllReached; j++)
+      bAllReached = world.at(j).bReachedGoal;
+    if(bAllReached)
+      return i;
+
+    Step();
+  }
+  return nSteps;
+}
+
+const std::vector<SimulatedAgentState>& MultiAgentSimulator::GetWorldState() const
+{
+  return m_WorldState[m_iFront];
+}
+
+unsigned long long MultiAgentSimulator::GetStateChecksum() const
+{
+  //64 bit FNV-1a
+  unsigned long long hash = 14695981039346656037ULL;
+  const std::vector<SimulatedAgentState>& world = GetWorldState();
+  for(unsigned int i = 0; i < world.size(); i++)
+  {
+    const double values[4] = {world.at(i).pose.pos.x, world.at(i).pose.pos.y, world.at(i).pose.pos.a, world.at(i).vehicleState.speed};
+    const unsigned char* bytes = (const unsigned char*)values;
+    for(unsigned int k = 0; k < sizeof(values); k++)
+    {
+      hash ^= bytes[k];
+      hash *= 1099511628211ULL;
+    }
+  }
+  return hash;
+}
+
+void MultiAgentSimulator::CreateParallelLanes(const int& nLanes, const double& length, const double& resolution, const double& speed,
+    RoadNetwork& map)
+{
+  map.roadSegments.clear();
+  map.roadSegments.push_back(RoadSegment());
+  RoadSegment& segment = map.roadSegments.back();
+  segment.id = 1;
+
+  const int nPoints = std::max(2, (int)(length / resolution) + 1);
+  segment.Lanes.resize(nLanes);
+  for(int l = 0; l < nLanes; l++)
+  {
+    Lane& lane = segment.Lanes.at(l);
+    lane.id = l + 1;
+    lane.roadId = segment.id;
+    lane.num = l;
+    lane.width = 3.5;
+    lane.speed = speed;
+    lane.length = (nPoints - 1) * resolution;
+    for(int i = 0; i < nPoints; i++)
+    {
+      WayPoint wp(i * resolution, l * 3.5, 0, 0);
+      wp.id = l * nPoints + i + 1;
+      wp.laneId = lane.id;
+      wp.v = speed;
+      lane.points.push_back(wp);
+    }
+    PlanningHelpers::CalcAngleAndCost(lane.points);
+  }
+
+  //the pointers once the vectors have their final size
+  for(int l = 0; l < nLanes; l++)
+  {
+    Lane& lane = segment.Lanes.at(l);
+    lane.pRoad = &segment;
+    lane.pLeftLane = l + 1 < nLanes ? &segment.Lanes.at(l+1) : 0;
+    lane.pRightLane = l > 0 ? &segment.Lanes.at(l-1) : 0;
+    for(unsigned int i = 0; i < lane.points.size(); i++)
+      lane.points.at(i).pLane = &lane;
+  }
+}
+
+} /* namespace SimulationNS */
@@ -5,11 +5,14 @@
 
 #include "op_simu/SimpleTracker.h"
 #include "op_planner/MatrixOperations.h"
+#include "op_planner/PolygonGeometry.h"
 #include "op_utility/UtilityH.h"
 
 #include <iostream>
 #include <vector>
 #include <cstdio>
+#include <limits>
+#include <unordered_map>
 
 #include <opencv2/core/core.hpp>
 #include <opencv2/highgui/highgui.hpp>
@@ -33,6 +36,7 @@ SimpleTracker::SimpleTracker()
   m_nMinTrustAppearances = 5;
   m_Horizon = 100.0;
   m_CirclesResolution = 5.0;
+  m_bBatchKalman = false;
   UtilityHNS::UtilityH::GetTickCount(m_TrackTimer);
 }
 
@@ -111,13 +115,13 @@ void SimpleTracker::DoOneStep(const WayPoint& currPose, const std::vector<Detect
 
   m_DetectedObjects = obj_list;
 
-  if(type == ASSOCIATE_ONLY)
+  if(type == ASSOCIATE_ONLY || type == ASSOCIATE_ONLY_OPTIMAL)
   {
-    AssociateOnly();
+    AssociateOnly(type == ASSOCIATE_ONLY_OPTIMAL);
   }
-  else if (type == SIMPLE_TRACKER)
+  else if (type == SIMPLE_TRACKER || type == SIMPLE_TRACKER_OPTIMAL)
   {
-    AssociateSimply();
+    AssociateSimply(type == SIMPLE_TRACKER_OPTIMAL);
   }
   else
   {
@@ -394,9 +398,250 @@ void SimpleTracker::MatchClosestCost()
   m_TrackSimply = newObjects;
 }
 
-void SimpleTracker::AssociateOnly()
+void SimpleTracker::MatchOptimalCost()
 {
-  MatchClosestCost();
+  // a detection or a track left out costs more than any gated pair, so the most pairs are matched first
+  const double UNASSIGNED_COST = 1000.0;
+  const double NOT_GATED_COST = 1e9;
+
+  newObjects.clear();
+  m_CostsLists.clear();
+
+  const int nObjects = m_DetectedObjects.size();
+  const int nTracks = m_TrackSimply.size();
+
+  // gating grid of the tracks, with cells of the association distance the tracks close enough to a detection
+  // are in the 3 x 3 cells around it
+  const double cell_size = std::max(m_MAX_ASSOCIATION_DISTANCE, 0.01);
+  std::unordered_map<long long, std::vector<int> > grid;
+  for(int i = 0; i < nTracks; i++)
+  {
+    long long ix = floor(m_TrackSimply.at(i).obj.center.pos.x / cell_size);
+    long long iy = floor(m_TrackSimply.at(i).obj.center.pos.y / cell_size);
+    grid[(ix << 32) ^ (iy & 0xffffffff)].push_back(i);
+  }
+
+  // the pairs within the gates of MatchClosestCost, the differences are normalized by the gates instead of the
+  // ranges of all the pairs so that the cost of a pair does not depend on the others
+  for(int jj = 0; jj < nObjects; jj++)
+  {
+    const DetectedObject& obj = m_DetectedObjects.at(jj);
+    double object_size = sqrt(obj.w*obj.w + obj.l*obj.l + obj.h*obj.h);
+    long long ix = floor(obj.center.pos.x / cell_size);
+    long long iy = floor(obj.center.pos.y / cell_size);
+
+    for(long long cx = ix - 1; cx <= ix + 1; cx++)
+    {
+      for(long long cy = iy - 1; cy <= iy + 1; cy++)
+      {
+        std::unordered_map<long long, std::vector<int> >::const_iterator cell = grid.find((cx << 32) ^ (cy & 0xffffffff));
+        if(cell == grid.end())
+          continue;
+
+        for(unsigned int k = 0; k < cell->second.size(); k++)
+        {
+          int i = cell->second.at(k);
+          const DetectedObject& track_obj = m_TrackSimply.at(i).obj;
+          double d = hypot(obj.center.pos.y - track_obj.center.pos.y, obj.center.pos.x - track_obj.center.pos.x);
+          if(d > m_MAX_ASSOCIATION_DISTANCE)
+            continue;
+
+          double old_size = sqrt(track_obj.w*track_obj.w + track_obj.l*track_obj.l + track_obj.h*track_obj.h);
+          double obj_diff = fabs(object_size - old_size);
+          if(obj_diff >= m_MAX_ASSOCIATION_SIZE_DIFF)
+            continue;
+
+          double a_diff = M_PI;
+          if(track_obj.bDirection && d > 0.2)
+          {
+            double a = UtilityHNS::UtilityH::FixNegativeAngle(atan2(obj.center.pos.y - track_obj.center.pos.y, obj.center.pos.x - track_obj.center.pos.x));
+            a_diff = UtilityHNS::UtilityH::AngleBetweenTwoAnglesPositive(a, track_obj.center.pos.a);
+          }
+          // as in MatchClosestCost, a direction of more than 90 degrees off is not taken into account
+          if(a_diff >= M_PI_2)
+            a_diff = 0;
+          if(a_diff >= m_MAX_ASSOCIATION_ANGLE_DIFF)
+            continue;
+
+          CostRecordSet pair(jj, i, d, obj_diff, fabs(track_obj.w - obj.w), fabs(track_obj.l - obj.l), fabs(track_obj.h - obj.h), a_diff);
+          pair.cost = (d / m_MAX_ASSOCIATION_DISTANCE + (pair.width_diff + pair.length_diff + pair.height_diff) / m_MAX_ASSOCIATION_SIZE_DIFF + a_diff / m_MAX_ASSOCIATION_ANGLE_DIFF) / 5.0;
+          m_CostsLists.push_back(pair);
+        }
+      }
+    }
+  }
+
+  // the pairs split the detections and the tracks into independent groups, detections then tracks
+  std::vector<int> group(nObjects + nTracks);
+  for(unsigned int i = 0; i < group.size(); i++)
+    group.at(i) = i;
+  for(unsigned int ic = 0; ic < m_CostsLists.size(); ic++)
+  {
+    int a = m_CostsLists.at(ic).i_obj;
+    int b = nObjects + m_CostsLists.at(ic).i_track;
+    while(group.at(a) != a) a = group.at(a) = group.at(group.at(a));
+    while(group.at(b) != b) b = group.at(b) = group.at(group.at(b));
+    group.at(std::max(a, b)) = std::min(a, b);
+  }
+
+  std::vector<std::vector<int> > group_members(nObjects + nTracks);
+  std::vector<int> index_in_group(nObjects + nTracks);
+  for(int i = 0; i < nObjects + nTracks; i++)
+  {
+    int root = i;
+    while(group.at(root) != root) root = group.at(root);
+    index_in_group.at(i) = group_members.at(root).size();
+    group_members.at(root).push_back(i);
+  }
+
+  std::vector<std::vector<const CostRecordSet*> > group_pairs(nObjects + nTracks);
+  for(unsigned int ic = 0; ic < m_CostsLists.size(); ic++)
+  {
+    int root = m_CostsLists.at(ic).i_obj;
+    while(group.at(root) != root) root = group.at(root);
+    group_pairs.at(root).push_back(&m_CostsLists.at(ic));
+  }
+
+  // optimal assignment of each group, with a dummy track for each detection and a dummy detection for each track
+  std::vector<int> matched_track(nObjects, -1);
+  std::vector<std::vector<double> > cost;
+  std::vector<int> assignment;
+  for(int root = 0; root < nObjects + nTracks; root++)
+  {
+    if(group_pairs.at(root).empty())
+      continue;
+
+    const std::vector<int>& members = group_members.at(root);
+    int nGroupObjects = 0;
+    while(nGroupObjects < (int)members.size() && members.at(nGroupObjects) < nObjects)
+      nGroupObjects++;
+    int nGroupTracks = members.size() - nGroupObjects;
+    int n = members.size();
+
+    cost.assign(n, std::vector<double>(n, 0));
+    for(int r = 0; r < n; r++)
+    {
+      for(int c = 0; c < n; c++)
+      {
+        if(r < nGroupObjects && c < nGroupTracks)
+          cost.at(r).at(c) = NOT_GATED_COST;
+        else if(r < nGroupObjects || c < nGroupTracks)
+          cost.at(r).at(c) = UNASSIGNED_COST;
+      }
+    }
+    for(unsigned int ip = 0; ip < group_pairs.at(root).size(); ip++)
+    {
+      const CostRecordSet* pair = group_pairs.at(root).at(ip);
+      cost.at(index_in_group.at(pair->i_obj)).at(index_in_group.at(nObjects + pair->i_track) - nGroupObjects) = pair->cost;
+    }
+
+    SolveAssignment(cost, assignment);
+    for(int r = 0; r < nGroupObjects; r++)
+    {
+      int c = assignment.at(r);
+      if(c < nGroupTracks && cost.at(r).at(c) < NOT_GATED_COST)
+        matched_track.at(members.at(r)) = members.at(nGroupObjects + c) - nObjects;
+    }
+  }
+
+  for(int jj = 0; jj < nObjects; jj++)
+  {
+    int i = matched_track.at(jj);
+    if(i >= 0)
+    {
+      m_DetectedObjects.at(jj).id = m_TrackSimply.at(i).obj.id;
+      MergeObjectAndTrack(m_TrackSimply.at(i), m_DetectedObjects.at(jj));
+      newObjects.push_back(m_TrackSimply.at(i));
+    }
+    else
+    {
+      iTracksNumber = iTracksNumber + 1;
+      m_DetectedObjects.at(jj).id = iTracksNumber;
+      KFTrackV track(m_DetectedObjects.at(jj).center.pos.x, m_DetectedObjects.at(jj).center.pos.y,m_DetectedObjects.at(jj).actual_yaw, m_DetectedObjects.at(jj).id, m_dt, m_nMinTrustAppearances);
+      track.obj = m_DetectedObjects.at(jj);
+      newObjects.push_back(track);
+    }
+  }
+
+  m_DetectedObjects.clear();
+  m_TrackSimply = newObjects;
+}
+
+double SimpleTracker::SolveAssignment(const std::vector<std::vector<double> >& cost, std::vector<int>& assignment)
+{
+  // shortest augmenting paths with row and column potentials u and v, rows and columns from 1, column 0 is the
+  // start of each path
+  const double INF = std::numeric_limits<double>::max();
+  int n = cost.size();
+  std::vector<double> u(n + 1, 0), v(n + 1, 0), min_v(n + 1);
+  std::vector<int> row_of_col(n + 1, 0), way(n + 1, 0);
+  std::vector<bool> used(n + 1);
+
+  for(int i = 1; i <= n; i++)
+  {
+    row_of_col.at(0) = i;
+    int j0 = 0;
+    min_v.assign(n + 1, INF);
+    used.assign(n + 1, false);
+    do
+    {
+      used.at(j0) = true;
+      int i0 = row_of_col.at(j0);
+      int j1 = 0;
+      double delta = INF;
+      for(int j = 1; j <= n; j++)
+      {
+        if(used.at(j))
+          continue;
+        double reduced = cost.at(i0 - 1).at(j - 1) - u.at(i0) - v.at(j);
+        if(reduced < min_v.at(j))
+        {
+          min_v.at(j) = reduced;
+          way.at(j) = j0;
+        }
+        if(min_v.at(j) < delta)
+        {
+          delta = min_v.at(j);
+          j1 = j;
+        }
+      }
+      for(int j = 0; j <= n; j++)
+      {
+        if(used.at(j))
+        {
+          u.at(row_of_col.at(j)) += delta;
+          v.at(j) -= delta;
+        }
+        else
+          min_v.at(j) -= delta;
+      }
+      j0 = j1;
+    } while(row_of_col.at(j0) != 0);
+
+    do
+    {
+      int j1 = way.at(j0);
+      row_of_col.at(j0) = row_of_col.at(j1);
+      j0 = j1;
+    } while(j0 != 0);
+  }
+
+  assignment.assign(n, -1);
+  double total_cost = 0;
+  for(int j = 1; j <= n; j++)
+  {
+    assignment.at(row_of_col.at(j) - 1) = j - 1;
+    total_cost += cost.at(row_of_col.at(j) - 1).at(j - 1);
+  }
+  return total_cost;
+}
+
+void SimpleTracker::AssociateOnly(bool bOptimal)
+{
+  if(bOptimal)
+    MatchOptimalCost();
+  else
+    MatchClosestCost();
 
   for(unsigned int i =0; i< m_TrackSimply.size(); i++)
     m_TrackSimply.at(i).UpdateAssociateOnly(m_dt, m_TrackSimply.at(i).obj, m_TrackSimply.at(i).obj);
@@ -406,21 +651,59 @@ void SimpleTracker::AssociateOnly()
     m_DetectedObjects.push_back(m_TrackSimply.at(i).obj);
 }
 
-void SimpleTracker::AssociateSimply()
+void SimpleTracker::AssociateSimply(bool bOptimal)
 {
   for(unsigned int i = 0; i < m_TrackSimply.size(); i++)
     m_TrackSimply.at(i).m_bUpdated = false;
 
-  MatchClosestCost();
+  if(bOptimal)
+    MatchOptimalCost();
+  else
+    MatchClosestCost();
 
-  for(unsigned int i =0; i< m_TrackSimply.size(); i++)
-    m_TrackSimply.at(i).UpdateTracking(m_dt, m_TrackSimply.at(i).obj, m_TrackSimply.at(i).obj);
+  if(m_bBatchKalman)
+  {
+    UpdateTracksBatch();
+  }
+  else
+  {
+    for(unsigned int i =0; i< m_TrackSimply.size(); i++)
+      m_TrackSimply.at(i).UpdateTracking(m_dt, m_TrackSimply.at(i).obj, m_TrackSimply.at(i).obj);
+  }
 
   m_DetectedObjects.clear();
   for(unsigned int i = 0; i< m_TrackSimply.size(); i++)
     m_DetectedObjects.push_back(m_TrackSimply.at(i).obj);
 }
 
+void SimpleTracker::UpdateTracksBatch()
+{
+  // the association keeps, drops and adds tracks, the states follow the order of m_TrackSimply
+  std::vector<int> indices(m_TrackSimply.size());
+  for(unsigned int i = 0; i < m_TrackSimply.size(); i++)
+    indices.at(i) = m_TrackSimply.at(i).state_index;
+  m_TrackStates.Reorder(indices);
+
+  std::vector<double> measurements(2*m_TrackSimply.size());
+  for(unsigned int i = 0; i < m_TrackSimply.size(); i++)
+  {
+    const DetectedObject& obj = m_TrackSimply.at(i).obj;
+    if(m_TrackSimply.at(i).state_index < 0)
+      m_TrackStates.InitializeState(i, obj.center.pos.x, obj.center.pos.y, m_dt);
+    m_TrackSimply.at(i).state_index = i;
+    measurements.at(2*i) = obj.center.pos.x;
+    measurements.at(2*i+1) = obj.center.pos.y;
+  }
+
+  m_TrackStates.Correct(measurements);
+  for(unsigned int i = 0; i < m_TrackSimply.size(); i++)
+  {
+    KFTrackStates::State state = m_TrackStates.GetState(i);
+    m_TrackSimply.at(i).UpdateTrackingState(m_dt, state(0), state(1), state(2), state(3), m_TrackSimply.at(i).obj);
+  }
+  m_TrackStates.Predict(m_dt);
+}
+
 void SimpleTracker::AssociateToRegions(KFTrackV& detectedObject)
 {
   for(unsigned int i = 0; i < m_InterestRegions.size(); i++)
@@ -578,39 +861,6 @@ void SimpleTracker::MergeObjectAndTrack(KFTrackV& track, PlannerHNS::DetectedObj
 
 int SimpleTracker::InsidePolygon(const std::vector<GPSPoint>& polygon,const GPSPoint& p)
 {
-  int counter = 0;
-  int i;
-  double xinters;
-  GPSPoint p1,p2;
-  int N = polygon.size();
-  if(N <=0 ) return -1;
-
-  p1 = polygon.at(0);
-  for (i=1;i<=N;i++)
-  {
-    p2 = polygon.at(i % N);
-
-    if (p.y > MIN(p1.y,p2.y))
-    {
-      if (p.y <= MAX(p1.y,p2.y))
-      {
-        if (p.x <= MAX(p1.x,p2.x))
-        {
-          if (p1.y != p2.y)
-          {
-            xinters = (p.y-p1.y)*(p2.x-p1.x)/(p2.y-p1.y)+p1.x;
-            if (p1.x == p2.x || p.x <= xinters)
-              counter++;
-          }
-        }
-      }
-    }
-    p1 = p2;
-  }
-
-  if (counter % 2 == 0)
-    return 0;
-  else
-    return 1;
+  return PolygonGeometry::PointInsidePolygon(polygon, p);
 }
 }
@@ -5,9 +5,12 @@
 
 #include "op_simu/TrajectoryFollower.h"
 #include "op_planner/PlanningHelpers.h"
+#include "op_utility/DataRW.h"
+#include <algorithm>
 #include <cmath>
 #include <stdlib.h>
 #include <iostream>
+#include <sstream>
 
 using namespace PlannerHNS;
 using namespace UtilityHNS;
@@ -17,6 +20,22 @@ using namespace std;
 namespace SimulationNS
 {
 
+// steering gains every 0.1 m/s
+#define GAIN_SCHEDULE_RESOLUTION 0.1
+
+static std::string CalibrationToString(const time_t& t, const double* values)
+{
+  std::ostringstream dataLine;
+  dataLine << t << ","
+      << (bool)values[0] << ","
+      << (int)values[1] << ","
+      << (int)values[2] << ","
+      << (int)values[3] << ","
+      << values[4] << ","
+      << (int)values[5] << ",";
+  return dataLine.str();
+}
+
 TrajectoryFollower::TrajectoryFollower()
 {
   m_iNextTest = 0;
@@ -32,6 +51,10 @@ TrajectoryFollower::TrajectoryFollower()
   m_StartFollowDistance = 0;
   m_FollowAcc = 0.5;
   m_iCalculatedIndex = 0;
+  m_HighSpeedSteerGainRatio = 1.0;
+  m_GainScheduleResolution = GAIN_SCHEDULE_RESOLUTION;
+  m_pLogWriter = 0;
+  m_iSteerPIDLog = m_iVelocityPIDLog = m_iSteerCalibrationLog = m_iVelocityCalibrationLog = -1;
   UtilityH::GetTickCount(m_SteerDelayTimer);
   UtilityH::GetTickCount(m_VelocityDelayTimer);
 }
@@ -55,6 +78,10 @@ void TrajectoryFollower::Init(const ControllerParams& params, const CAR_BASIC_IN
   m_pidSteer.Init(params.Steering_Gain.kP, params.Steering_Gain.kI, params.Steering_Gain.kD); // for 3 m/s
   m_pidSteer.Setlimit(m_VehicleInfo.max_steer_angle, -m_VehicleInfo.max_steer_angle);
   m_pidVelocity.Init(params.Velocity_Gain.kP, params.Velocity_Gain.kI, params.Velocity_Gain.kD);
+
+  InitGainSchedule();
+  if(m_bEnableLog)
+    InitLogs();
 }
 
 TrajectoryFollower::~TrajectoryFollower()
@@ -64,18 +91,72 @@ TrajectoryFollower::~TrajectoryFollower()
     DataRW::WriteLogData(UtilityH::GetHomeDirectory()+DataRW::LoggingMainfolderName+DataRW::ControlLogFolderName, "ControlLog",
         "time,X,Y,heading, Target, error,LateralError,SteerBeforLowPass,Steer,iIndex, pathSize",
         m_LogData);
+  }
 
-    DataRW::WriteLogData(UtilityH::GetHomeDirectory()+DataRW::LoggingMainfolderName+DataRW::ControlLogFolderName, "SteeringCalibrationLog",
-        "time, reset, start A, end A, desired A, dt, vel", m_SteerCalibrationData);
-
-    DataRW::WriteLogData(UtilityH::GetHomeDirectory()+DataRW::LoggingMainfolderName+DataRW::ControlLogFolderName, "VelocityCalibrationLog",
-        "time, reset, start V, end V, desired V, dt, steering", m_VelocityCalibrationData);
+  delete m_pLogWriter;
+}
 
-    DataRW::WriteLogData(UtilityH::GetHomeDirectory()+DataRW::LoggingMainfolderName+DataRW::ControlLogFolderName, "SteeringPIDLog",m_pidSteer.ToStringHeader(), m_LogSteerPIDData );
-    DataRW::WriteLogData(UtilityH::GetHomeDirectory()+DataRW::LoggingMainfolderName+DataRW::ControlLogFolderName, "VelocityPIDLog",m_pidVelocity.ToStringHeader(), m_LogVelocityPIDData );
+void TrajectoryFollower::InitGainSchedule()
+{
+  // from Steering_Gain at 0 to Steering_Gain * m_HighSpeedSteerGainRatio at max_speed_forward and above
+  double maxV = std::max(m_VehicleInfo.max_speed_forward, m_GainScheduleResolution);
+  int nSpeeds = std::ceil(maxV / m_GainScheduleResolution) + 1;
+  m_SteerGainSchedule.resize(nSpeeds);
+  for(int i = 0; i < nSpeeds; i++)
+  {
+    double v = i * m_GainScheduleResolution;
+    PID_CONST& gains = m_SteerGainSchedule.at(i);
+    gains.kP = GetPID_LinearChange(m_Params.Steering_Gain.kP, m_Params.Steering_Gain.kP * m_HighSpeedSteerGainRatio, maxV, v);
+    gains.kI = GetPID_LinearChange(m_Params.Steering_Gain.kI, m_Params.Steering_Gain.kI * m_HighSpeedSteerGainRatio, maxV, v);
+    gains.kD = GetPID_LinearChange(m_Params.Steering_Gain.kD, m_Params.Steering_Gain.kD * m_HighSpeedSteerGainRatio, maxV, v);
   }
 }
 
+double TrajectoryFollower::GetPID_LinearChange(double minVal, double maxVal, double speedMax, double currSpeed)
+{
+  if(currSpeed >= speedMax)
+    return maxVal;
+  if(currSpeed <= 0)
+    return minVal;
+  return minVal + (maxVal - minVal) * currSpeed / speedMax;
+}
+
+void TrajectoryFollower::AdjustPID(const double& v, const double& maxV, PlannerHNS::PID_CONST& steerPID)
+{
+  if(m_SteerGainSchedule.size() == 0)
+    return;
+
+  double speed = std::min(std::max(v, 0.0), maxV);
+  unsigned int i = std::min<unsigned int>(speed / m_GainScheduleResolution + 0.5, m_SteerGainSchedule.size() - 1);
+  steerPID = m_SteerGainSchedule.at(i);
+  m_pidSteer.Init(steerPID.kP, steerPID.kI, steerPID.kD);
+}
+
+void TrajectoryFollower::InitLogs()
+{
+  if(m_pLogWriter)
+    return;
+
+  std::string logFolder = UtilityH::GetHomeDirectory()+DataRW::LoggingMainfolderName+DataRW::ControlLogFolderName;
+  m_pLogWriter = new ControlLogWriter();
+  m_iSteerCalibrationLog = m_pLogWriter->AddLog(logFolder, "SteeringCalibrationLog",
+      "time, reset, start A, end A, desired A, dt, vel", CalibrationToString);
+  m_iVelocityCalibrationLog = m_pLogWriter->AddLog(logFolder, "VelocityCalibrationLog",
+      "time, reset, start V, end V, desired V, dt, steering", CalibrationToString);
+  m_iSteerPIDLog = m_pLogWriter->AddLog(logFolder, "SteeringPIDLog", m_pidSteer.ToStringHeader(), PIDController::LogValuesToString);
+  m_iVelocityPIDLog = m_pLogWriter->AddLog(logFolder, "VelocityPIDLog", m_pidVelocity.ToStringHeader(), PIDController::LogValuesToString);
+  m_pLogWriter->Start();
+}
+
+void TrajectoryFollower::LogPID(const int& log, const UtilityHNS::PIDController& pid)
+{
+  timespec t_stamp;
+  UtilityH::GetTickCount(t_stamp);
+  double values[PIDController::LOG_VALUES_COUNT];
+  pid.GetLogValues(values);
+  m_pLogWriter->Push(log, UtilityH::GetLongTime(t_stamp), values, PIDController::LOG_VALUES_COUNT);
+}
+
 void TrajectoryFollower::PrepareNextWaypoint(const PlannerHNS::WayPoint& CurPos, const double& currVelocity, const double& currSteering)
 {
   WayPoint pred_point = CurPos;
@@ -145,7 +226,8 @@ int TrajectoryFollower::SteerControllerUpdate(const PlannerHNS::VehicleState& Cu
 {
   if(m_Path.size()==0) return -1;
   int ret = -1;
-  //AdjustPID(CurrStatus.velocity, 18.0, m_Params.Gain);
+  PID_CONST steerGains;
+  AdjustPID(CurrStatus.speed, m_VehicleInfo.max_speed_forward, steerGains);
   if(CurrBehavior.state == FORWARD_STATE || CurrBehavior.state == TRAFFIC_LIGHT_STOP_STATE || CurrBehavior.state == STOP_SIGN_STOP_STATE || CurrBehavior.state  == FOLLOW_STATE)
     ret = SteerControllerPart(m_CurrPos, m_DesPos, m_LateralError, desiredSteerAngle);
 
@@ -173,7 +255,7 @@ int TrajectoryFollower::SteerControllerPart(const PlannerHNS::WayPoint& state, c
   //cout << m_pidSteer.ToString() << endl;
 
   if(m_bEnableLog)
-    m_LogSteerPIDData.push_back(m_pidSteer.ToString());
+    LogPID(m_iSteerPIDLog, m_pidSteer);
 
   //TODO use lateral error instead of angle error
   //double future_lateral_error = PlanningHelpers::GetPerpDistanceToTrajectorySimple(m_Path, m_ForwardSimulation,0);
@@ -288,7 +370,7 @@ int TrajectoryFollower::VeclocityControllerUpdate(const double& dt, const Planne
 
   desiredShift = PlannerHNS::SHIFT_POS_DD;
   if(m_bEnableLog)
-    m_LogVelocityPIDData.push_back(m_pidVelocity.ToString());
+    LogPID(m_iVelocityPIDLog, m_pidVelocity);
   return 1;
 }
 
@@ -381,16 +463,9 @@ void TrajectoryFollower::LogCalibrationData(const PlannerHNS::VehicleState& curr
     currVelocity = currState.speed*3.6;
     UtilityH::GetTickCount(m_SteerDelayTimer);
 
-    std::ostringstream dataLine;
-    dataLine << UtilityH::GetLongTime(m_SteerDelayTimer) << ","
-        << bAngleReset << ","
-        << startAngle << ","
-        << finishAngle << ","
-        << originalTargetAngle << ","
-        << t_FromStartToFinish_a << ","
-        << currVelocity << ",";
-
-    m_SteerCalibrationData.push_back(dataLine.str());
+    double values[] = {(double)bAngleReset, (double)startAngle, (double)finishAngle, (double)originalTargetAngle,
+        t_FromStartToFinish_a, (double)currVelocity};
+    m_pLogWriter->Push(m_iSteerCalibrationLog, UtilityH::GetLongTime(m_SteerDelayTimer), values, 6);
 
     if(bAngleReset)
     {
@@ -409,16 +484,9 @@ void TrajectoryFollower::LogCalibrationData(const PlannerHNS::VehicleState& curr
     currSteering = currState.steer*RAD2DEG;
     UtilityH::GetTickCount(m_VelocityDelayTimer);
 
-    std::ostringstream dataLine;
-    dataLine << UtilityH::GetLongTime(m_VelocityDelayTimer) << ","
-        << bVelocityReset << ","
-        << startV << ","
-        << finishV << ","
-        << originalTargetV << ","
-        << t_FromStartToFinish_v << ","
-        << currSteering << ",";
-
-    m_VelocityCalibrationData.push_back(dataLine.str());
+    double values[] = {(double)bVelocityReset, (double)startV, (double)finishV, (double)originalTargetV,
+        t_FromStartToFinish_v, (double)currSteering};
+    m_pLogWriter->Push(m_iVelocityCalibrationLog, UtilityH::GetLongTime(m_VelocityDelayTimer), values, 6);
 
     if(bVelocityReset)
     {
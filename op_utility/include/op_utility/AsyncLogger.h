@@ -0,0 +1,127 @@
+/// \file AsyncLogger.h
+/// \brief Logs pushed as fixed size binary records into a lock free queue, written to a binary file by a background thread
+/// \date Oct 14, 2026
+
+#ifndef ASYNCLOGGER_H_
+#define ASYNCLOGGER_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace UtilityHNS
+{
+
+/**
+ * @brief Layout of a log once converted to text by AsyncLogger::ConvertToText
+ * LOG_CSV: title.csv with the header and the values of one record per line, as DataRW::WriteLogData writes
+ * LOG_CSV_TIME: the same with the time of the record (UtilityH::GetLongTime) as the first column
+ * LOG_KML: title.kml with the lon, lat, alt of each record as one line string, as DataRW::WriteKMLFile writes
+ */
+enum LOG_LAYOUT {LOG_CSV = 0, LOG_CSV_TIME = 1, LOG_KML = 2};
+
+/**
+ * @brief Log is lock free and never formats: it takes the time, copies the values into a slot of a bounded
+ * multi producer queue and returns, a record is dropped when the queue is full. The thread of the logger writes
+ * the records to the binary file every flushPeriod seconds and when it is destroyed.
+ *
+ * Binary file: the 8 bytes "OPLOG001", then records of a one byte type:
+ * 'D' definition: uint32 log, uint8 layout, uint32 size and characters of the title, then of the header,
+ * 'R' record: uint32 log, uint32 nValues, int64 time, nValues doubles.
+ * The definition of a log is written before its first record.
+ */
+class AsyncLogger
+{
+public:
+  static const int MAX_VALUES = 16;
+
+  /**
+   * @param capacity records in the queue, rounded up to a power of 2
+   * @param flushPeriod seconds between two writes of the queued records
+   */
+  AsyncLogger(const std::string& fileName, const unsigned int& capacity = 8192, const double& flushPeriod = 0.1);
+  virtual ~AsyncLogger();
+
+  bool IsOpen() const;
+
+  /**
+   * @brief New log, may be called from any thread at any time
+   * @return log index for Log
+   */
+  int AddLog(const std::string& title, const std::string& header, const LOG_LAYOUT& layout = LOG_CSV);
+
+  /**
+   * @brief Queue a record of values, at most MAX_VALUES are kept. false when it is dropped.
+   */
+  bool Log(const int& log, const double* values, const int& nValues);
+
+  /**
+   * @brief Write the queued records now and flush the file, from any thread
+   */
+  void Flush();
+
+  unsigned long GetDroppedCount() const;
+
+  /**
+   * @brief Text files of each log of the binary file logFile in outputFolder (ends with /), in their LOG_LAYOUT.
+   * Integral values are written without decimals.
+   * @return false when the file can't be read or isn't a log file
+   */
+  static bool ConvertToText(const std::string& logFile, const std::string& outputFolder);
+
+private:
+  const double m_FlushPeriod;
+  struct LogRecord
+  {
+    int32_t log;
+    int32_t nValues;
+    int64_t time;
+    double values[MAX_VALUES];
+  };
+
+  struct Slot
+  {
+    std::atomic<uint64_t> sequence;
+    LogRecord record;
+  };
+
+  struct LogDefinition
+  {
+    std::string title;
+    std::string header;
+    LOG_LAYOUT layout;
+  };
+
+  std::vector<Slot> m_Slots;
+  uint64_t m_Mask;
+  std::atomic<uint64_t> m_EnqueuePos;
+  uint64_t m_DequeuePos; // only the writer reads the queue
+  std::atomic<unsigned long> m_nDropped;
+
+  std::mutex m_DefinitionsMutex;
+  std::vector<LogDefinition> m_Definitions;
+  unsigned int m_nWrittenDefinitions;
+
+  std::ofstream m_File;
+  std::mutex m_WriteMutex; // the thread and Flush
+  std::thread m_Thread;
+  std::mutex m_Mutex;
+  std::condition_variable m_Condition;
+  bool m_bStop;
+
+  void WriterLoop();
+  void WriteRecords();
+  void WriteDefinitions(const unsigned int& nLogs);
+
+  AsyncLogger(const AsyncLogger&);
+  AsyncLogger& operator=(const AsyncLogger&);
+};
+
+} /* namespace UtilityHNS */
+
+#endif /* ASYNCLOGGER_H_ */
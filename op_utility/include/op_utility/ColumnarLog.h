@@ -0,0 +1,204 @@
+/// \file ColumnarLog.h
+/// \brief Recorded logs as fixed width typed columns in chunks, read by column and by key range without parsing
+/// \date Oct 14, 2026
+
+#ifndef COLUMNARLOG_H_
+#define COLUMNARLOG_H_
+
+#include <cstdint>
+#include <fstream>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "DataRW.h"
+
+namespace UtilityHNS
+{
+
+/**
+ * @brief Type of a column, COL_STRING has the width given in its definition and is padded with '\0'
+ */
+enum COLUMN_TYPE {COL_DOUBLE = 0, COL_FLOAT = 1, COL_INT32 = 2, COL_INT64 = 3, COL_STRING = 4};
+
+struct ColumnDefinition
+{
+  std::string name;
+  COLUMN_TYPE type;
+  unsigned int width; // bytes of a COL_STRING value, the width of the other types is the size of the type
+
+  ColumnDefinition(const std::string& _name = "", const COLUMN_TYPE& _type = COL_DOUBLE, const unsigned int& _width = 0)
+    : name(_name), type(_type), width(_width){}
+};
+
+/**
+ * @brief The rows are added one by one and written by chunks of chunkRows rows. In a chunk the values of each
+ * column are stored one after the other, so a reader seeks to the columns it needs and skips the others.
+ * The key of a row is the value of keyColumn (a time, a frame), or its row number when there is no key column.
+ * The chunk index keeps the range of keys of each chunk, a reader only reads the chunks of the keys it asks for.
+ *
+ * File: the 8 bytes "OPCOL001", uint32 nColumns, int32 keyColumn, uint32 chunkRows, for each column
+ * uint8 type, uint32 width, uint32 size and characters of the name. Then the chunks, then the chunk index:
+ * for each chunk uint64 offset, uint32 nRows, double min key, double max key,
+ * then uint64 offset of the index, uint32 nChunks and the 8 bytes "OPCOLIDX". Values are little endian.
+ */
+class ColumnarLogWriter
+{
+public:
+  /**
+   * @param keyColumn column holding the key of the rows, -1 for the row numbers. A string key column is ignored
+   */
+  ColumnarLogWriter(const std::string& fileName, const std::vector<ColumnDefinition>& columns,
+      const int& keyColumn = -1, const unsigned int& chunkRows = 65536);
+  virtual ~ColumnarLogWriter();
+
+  bool IsOpen() const;
+
+  /**
+   * @brief Values of the row being added, the columns not set are 0 or empty
+   */
+  void SetValue(const int& column, const double& value);
+  void SetString(const int& column, const std::string& value);
+
+  /**
+   * @brief Add the row set by SetValue and SetString
+   */
+  void EndRow();
+
+  /**
+   * @brief Write the last chunk and the chunk index, called by the destructor. false when the file can't be written
+   */
+  bool Close();
+
+  unsigned long long GetRowsCount() const { return m_nRows; }
+
+private:
+  struct ChunkInfo
+  {
+    uint64_t offset;
+    uint32_t nRows;
+    double minKey;
+    double maxKey;
+  };
+
+  std::ofstream m_File;
+  std::vector<ColumnDefinition> m_Columns;
+  int m_KeyColumn;
+  unsigned int m_ChunkRows;
+  std::vector<double> m_RowValues;
+  std::vector<std::string> m_RowStrings;
+  std::vector<std::vector<char> > m_ChunkColumns;
+  unsigned int m_nChunkRows;
+  double m_ChunkMinKey;
+  double m_ChunkMaxKey;
+  std::vector<ChunkInfo> m_Index;
+  unsigned long long m_nRows;
+
+  void WriteChunk();
+
+  ColumnarLogWriter(const ColumnarLogWriter&);
+  ColumnarLogWriter& operator=(const ColumnarLogWriter&);
+};
+
+class ColumnarLogReader
+{
+public:
+  ColumnarLogReader(const std::string& fileName);
+  virtual ~ColumnarLogReader(){}
+
+  /**
+   * @brief false when the file can't be read or isn't a columnar log
+   */
+  bool IsOpen() const;
+
+  const std::vector<ColumnDefinition>& GetColumns() const { return m_Columns; }
+
+  /**
+   * @return index of the column named name, -1 if there is none
+   */
+  int GetColumnIndex(const std::string& name) const;
+
+  unsigned long long GetRowsCount() const;
+  unsigned int GetChunksCount() const { return m_Index.size(); }
+
+  /**
+   * @brief Values of the numeric columns for the rows whose key is in [minKey, maxKey], one vector per column.
+   * Only the chunks with keys in the range and only these columns are read. COL_INT64 beyond 2^53 lose precision.
+   * @return rows read, -1 when a column is not numeric or the file can't be read
+   */
+  int ReadColumns(const std::vector<int>& columns, std::vector<std::vector<double> >& values,
+      const double& minKey = -std::numeric_limits<double>::max(),
+      const double& maxKey = std::numeric_limits<double>::max());
+
+  /**
+   * @brief Values of a COL_STRING column for the rows whose key is in [minKey, maxKey]
+   * @return rows read, -1 when the column is not a string or the file can't be read
+   */
+  int ReadStringColumn(const int& column, std::vector<std::string>& values,
+      const double& minKey = -std::numeric_limits<double>::max(),
+      const double& maxKey = std::numeric_limits<double>::max());
+
+private:
+  struct ChunkInfo
+  {
+    uint64_t offset;
+    uint32_t nRows;
+    double minKey;
+    double maxKey;
+    uint64_t firstRow;
+  };
+
+  std::ifstream m_File;
+  bool m_bOpen;
+  std::vector<ColumnDefinition> m_Columns;
+  std::vector<uint64_t> m_ColumnOffsets; // bytes of the columns before each one in a row
+  int m_KeyColumn;
+  std::vector<ChunkInfo> m_Index;
+  std::vector<char> m_Buffer;
+
+  bool ReadChunkColumn(const ChunkInfo& chunk, const int& column);
+  bool ReadChunkKeys(const ChunkInfo& chunk, std::vector<double>& keys);
+};
+
+/**
+ * @brief Columnar logs of the recorded logs of GPSDataReader, LocalizationPathReader, SimulationFileReader and
+ * ObjectsLogReader, and converters from their csv files. The key of a localization path is t, the row of the
+ * waypoint in the csv file (the frame of ObjectsLogReader), the key of an objects log is frame, a gps log and
+ * a simulation file have the row numbers.
+ */
+class ColumnarLog
+{
+public:
+  static bool WriteGPSData(const std::string& fileName, const std::vector<GPSDataReader::GPSBasicData>& data_list);
+  static int ReadGPSData(const std::string& fileName, std::vector<GPSDataReader::GPSBasicData>& data_list,
+      const double& minRow = -std::numeric_limits<double>::max(),
+      const double& maxRow = std::numeric_limits<double>::max());
+
+  static bool WriteLocalizationPath(const std::string& fileName,
+      const std::vector<LocalizationPathReader::LocalizationWayPoint>& data_list);
+  static int ReadLocalizationPath(const std::string& fileName,
+      std::vector<LocalizationPathReader::LocalizationWayPoint>& data_list,
+      const double& minTime = -std::numeric_limits<double>::max(),
+      const double& maxTime = std::numeric_limits<double>::max());
+
+  static bool WriteSimulationData(const std::string& fileName, const SimulationFileReader::SimulationData& data);
+  static int ReadSimulationData(const std::string& fileName, SimulationFileReader::SimulationData& data);
+
+  static bool WriteObjectsLog(const std::string& fileName, const std::vector<ObjectsLogReader::ObjectRecord>& data_list);
+  static int ReadObjectsLog(const std::string& fileName, std::vector<ObjectsLogReader::ObjectRecord>& data_list,
+      const double& minFrame = -std::numeric_limits<double>::max(),
+      const double& maxFrame = std::numeric_limits<double>::max());
+
+  /**
+   * @brief Convert a csv log read by the matching reader into a columnar log
+   * @return rows written, -1 when the columnar log can't be written
+   */
+  static int ConvertGPSData(const std::string& csvFile, const std::string& fileName);
+  static int ConvertLocalizationPath(const std::string& csvFile, const char& separator, const std::string& fileName);
+  static int ConvertSimulationData(const std::string& csvFile, const std::string& fileName);
+  static int ConvertObjectsLog(const std::string& csvFile, const std::string& fileName);
+};
+
+} /* namespace UtilityHNS */
+
+#endif /* COLUMNARLOG_H_ */
@@ -14,6 +14,7 @@
 #include <vector>
 #include <iostream>
 #include <limits>
+#include <unordered_map>
 
 #include "vector_map_msgs/PointArray.h"
 #include "vector_map_msgs/LaneArray.h"
@@ -58,10 +59,82 @@ public:
   static void CreateLoggingFolder();
 };
 
+/**
+ * @brief O(1) id lookup for the rows of a reader, built once after loading.
+ * Ids that cover at least half of their range get a direct array indexed by (id - min id), sparse ids a hash map.
+ * For duplicated ids the last row wins. Rows are referenced by pointer, so the list must not change after Build.
+ */
+template <class T>
+class DataRowIndex
+{
+public:
+  DataRowIndex() : m_MinId(0){}
+
+  void Clear()
+  {
+    m_MinId = 0;
+    m_Dense.clear();
+    m_Sparse.clear();
+  }
+
+  void Build(std::vector<T>& data_list, int T::* pId)
+  {
+    Clear();
+    if(data_list.size() == 0) return;
+
+    long long min_id = std::numeric_limits<long long>::max();
+    long long max_id = std::numeric_limits<long long>::min();
+    for(unsigned int i=0; i < data_list.size(); i++)
+    {
+      long long id = data_list.at(i).*pId;
+      if(id < min_id) min_id = id;
+      if(id > max_id) max_id = id;
+    }
+
+    if(max_id - min_id < 2 * (long long)data_list.size() + 64)
+    {
+      m_MinId = min_id;
+      m_Dense.resize(max_id - min_id + 1, nullptr);
+      for(unsigned int i=0; i < data_list.size(); i++)
+        m_Dense.at(data_list.at(i).*pId - m_MinId) = &data_list.at(i);
+    }
+    else
+    {
+      m_Sparse.reserve(data_list.size());
+      for(unsigned int i=0; i < data_list.size(); i++)
+        m_Sparse[data_list.at(i).*pId] = &data_list.at(i);
+    }
+  }
+
+  T* GetDataRowById(const int& id) const
+  {
+    if(m_Dense.size() > 0)
+    {
+      long long index = (long long)id - m_MinId;
+      if(index >= 0 && index < (long long)m_Dense.size())
+        return m_Dense[index];
+      return nullptr;
+    }
+
+    typename std::unordered_map<int, T*>::const_iterator it = m_Sparse.find(id);
+    if(it != m_Sparse.end())
+      return it->second;
+    return nullptr;
+  }
+
+  bool IsDense() const { return m_Dense.size() > 0; }
+
+private:
+  long long m_MinId;
+  std::vector<T*> m_Dense;
+  std::unordered_map<int, T*> m_Sparse;
+};
+
 class SimpleReaderBase
 {
 private:
-  std::ifstream* m_pFile;
+  std::vector<char> m_Buffer; // file content with a '\0' after it, line ends and separators are overwritten with '\0' as lines are read
+  unsigned int m_iNextLine;
   std::vector<std::string> m_RawHeaders;
   std::vector<std::string> m_DataTitlesHeader;
   std::vector<std::vector<std::vector<std::string> > > m_AllData;
@@ -74,6 +147,7 @@ private:
 
   void ReadHeaders();
   void ParseDataTitles(const std::string& header);
+  bool GetNextLine(char*& pLine, unsigned int& length);
 
 public:
   /**
@@ -90,9 +164,17 @@ public:
   ~SimpleReaderBase();
 
 protected:
+  std::vector<const char*> m_Fields; // fields of the last line read by ReadLineFields, valid until the reader is destroyed
+
   int ReadAllData();
   bool ReadSingleLine(std::vector<std::vector<std::string> >& line);
 
+  /**
+   * @brief Split the next line into m_Fields without copying, each field is '\0' terminated in the file buffer
+   * so it can be converted with strtol / strtod directly. false at the end of the file.
+   */
+  bool ReadLineFields();
+
 };
 
 class GPSDataReader : public SimpleReaderBase
@@ -164,6 +246,34 @@ public:
   int ReadAllData(std::vector<LocalizationWayPoint>& data_list);
 };
 
+/**
+ * @brief Log of the detected objects, one row per object and frame: frame, id, x, y, z, a, v, w, l, h.
+ * frame is the row index of the matching ego pose in the localization log.
+ */
+class ObjectsLogReader : public SimpleReaderBase
+{
+public:
+  struct ObjectRecord
+  {
+    int frame;
+    int id;
+    double x;
+    double y;
+    double z;
+    double a;
+    double v;
+    double w;
+    double l;
+    double h;
+  };
+
+  ObjectsLogReader(const std::string& fileName) : SimpleReaderBase(fileName, 1){}
+  ~ObjectsLogReader(){}
+
+  bool ReadNextLine(ObjectRecord& data);
+  int ReadAllData(std::vector<ObjectRecord>& data_list);
+};
+
 class AisanPointsFileReader : public SimpleReaderBase
 {
 public:
@@ -181,10 +291,7 @@ public:
     int MCODE3;
   };
 
-  AisanPointsFileReader(const std::string& fileName) : SimpleReaderBase(fileName, 1)
-  {
-    m_min_id = std::numeric_limits<int>::max();
-  }
+  AisanPointsFileReader(const std::string& fileName) : SimpleReaderBase(fileName, 1){}
 
   AisanPointsFileReader(const vector_map_msgs::PointArray& _points);
   ~AisanPointsFileReader(){}
@@ -196,8 +303,7 @@ public:
   std::vector<AisanPoints> m_data_list;
 
 private:
-  int m_min_id;
-  std::vector<AisanPoints*> m_data_map;
+  DataRowIndex<AisanPoints> m_data_index;
 };
 
 class AisanNodesFileReader : public SimpleReaderBase
@@ -210,10 +316,7 @@ public:
     int PID;
   };
 
-  AisanNodesFileReader(const std::string& fileName) : SimpleReaderBase(fileName, 1)
-  {
-    m_min_id = std::numeric_limits<int>::max();
-  }
+  AisanNodesFileReader(const std::string& fileName) : SimpleReaderBase(fileName, 1){}
 
   AisanNodesFileReader(const vector_map_msgs::NodeArray& _nodes);
   ~AisanNodesFileReader(){}
@@ -225,8 +328,7 @@ public:
   std::vector<AisanNode> m_data_list;
 
 private:
-  int m_min_id;
-  std::vector<AisanNode*> m_data_map;
+  DataRowIndex<AisanNode> m_data_index;
 };
 
 class AisanLinesFileReader : public SimpleReaderBase
@@ -242,10 +344,7 @@ public:
     int FLID;
   };
 
-  AisanLinesFileReader(const std::string& fileName) : SimpleReaderBase(fileName, 1)
-  {
-    m_min_id = std::numeric_limits<int>::max();
-  }
+  AisanLinesFileReader(const std::string& fileName) : SimpleReaderBase(fileName, 1){}
   AisanLinesFileReader(const vector_map_msgs::LineArray & _lines);
   ~AisanLinesFileReader(){}
 
@@ -256,8 +355,7 @@ public:
   std::vector<AisanLine> m_data_list;
 
 private:
-  int m_min_id;
-  std::vector<AisanLine*> m_data_map;
+  DataRowIndex<AisanLine> m_data_index;
 };
 
 class AisanCenterLinesFileReader : public SimpleReaderBase
@@ -278,10 +376,7 @@ public:
     double   RW;
   };
 
-  AisanCenterLinesFileReader(const std::string& fileName) : SimpleReaderBase(fileName, 1)
-  {
-    m_min_id = std::numeric_limits<int>::max();
-  }
+  AisanCenterLinesFileReader(const std::string& fileName) : SimpleReaderBase(fileName, 1){}
   AisanCenterLinesFileReader(const vector_map_msgs::DTLaneArray& _dtLanes);
   ~AisanCenterLinesFileReader(){}
 
@@ -292,8 +387,7 @@ public:
   std::vector<AisanCenterLine> m_data_list;
 
 private:
-  int m_min_id;
-  std::vector<AisanCenterLine*> m_data_map;
+  DataRowIndex<AisanCenterLine> m_data_index;
 };
 
 class AisanAreasFileReader : public SimpleReaderBase
@@ -307,10 +401,7 @@ public:
     int   ELID;
   };
 
-  AisanAreasFileReader(const std::string& fileName) : SimpleReaderBase(fileName, 1)
-  {
-    m_min_id = std::numeric_limits<int>::max();
-  }
+  AisanAreasFileReader(const std::string& fileName) : SimpleReaderBase(fileName, 1){}
   AisanAreasFileReader(const vector_map_msgs::AreaArray& _areas);
   ~AisanAreasFileReader(){}
 
@@ -321,8 +412,7 @@ public:
   std::vector<AisanArea> m_data_list;
 
 private:
-  int m_min_id;
-  std::vector<AisanArea*> m_data_map;
+  DataRowIndex<AisanArea> m_data_index;
 };
 
 class AisanIntersectionFileReader : public SimpleReaderBase
@@ -336,10 +426,7 @@ public:
     int   LinkID;
   };
 
-  AisanIntersectionFileReader(const std::string& fileName) : SimpleReaderBase(fileName, 1)
-  {
-    m_min_id = std::numeric_limits<int>::max();
-  }
+  AisanIntersectionFileReader(const std::string& fileName) : SimpleReaderBase(fileName, 1){}
   AisanIntersectionFileReader(const vector_map_msgs::CrossRoadArray& _inters);
   ~AisanIntersectionFileReader(){}
 
@@ -350,8 +437,7 @@ public:
   std::vector<AisanIntersection> m_data_list;
 
 private:
-  int m_min_id;
-  std::vector<AisanIntersection*> m_data_map;
+  DataRowIndex<AisanIntersection> m_data_index;
 };
 
 class AisanLanesFileReader : public SimpleReaderBase
@@ -390,10 +476,7 @@ public:
     int originalMapID;
   };
 
-  AisanLanesFileReader(const std::string& fileName) : SimpleReaderBase(fileName, 1)
-  {
-    m_min_id = std::numeric_limits<int>::max();
-  }
+  AisanLanesFileReader(const std::string& fileName) : SimpleReaderBase(fileName, 1){}
   AisanLanesFileReader(const vector_map_msgs::LaneArray& _lanes);
   ~AisanLanesFileReader(){}
 
@@ -404,8 +487,7 @@ public:
   std::vector<AisanLane> m_data_list;
 
 private:
-  int m_min_id;
-  std::vector<AisanLane*> m_data_map;
+  DataRowIndex<AisanLane> m_data_index;
 };
 
 class AisanStopLineFileReader : public SimpleReaderBase
@@ -421,10 +503,7 @@ public:
     int   LinkID;
   };
 
-  AisanStopLineFileReader(const std::string& fileName) : SimpleReaderBase(fileName, 1)
-  {
-    m_min_id = std::numeric_limits<int>::max();
-  }
+  AisanStopLineFileReader(const std::string& fileName) : SimpleReaderBase(fileName, 1){}
   AisanStopLineFileReader(const vector_map_msgs::StopLineArray& _stopLines);
   ~AisanStopLineFileReader(){}
 
@@ -435,8 +514,7 @@ public:
   std::vector<AisanStopLine> m_data_list;
 
 private:
-  int m_min_id;
-  std::vector<AisanStopLine*> m_data_map;
+  DataRowIndex<AisanStopLine> m_data_index;
 };
 
 class AisanRoadSignFileReader : public SimpleReaderBase
@@ -452,10 +530,7 @@ public:
     int   LinkID;
   };
 
-  AisanRoadSignFileReader(const std::string& fileName) : SimpleReaderBase(fileName, 1)
-  {
-    m_min_id = std::numeric_limits<int>::max();
-  }
+  AisanRoadSignFileReader(const std::string& fileName) : SimpleReaderBase(fileName, 1){}
   AisanRoadSignFileReader(const vector_map_msgs::RoadSignArray& _signs);
   ~AisanRoadSignFileReader(){}
 
@@ -466,8 +541,7 @@ public:
   std::vector<AisanRoadSign> m_data_list;
 
 private:
-  int m_min_id;
-  std::vector<AisanRoadSign*> m_data_map;
+  DataRowIndex<AisanRoadSign> m_data_index;
 };
 
 class AisanSignalFileReader : public SimpleReaderBase
@@ -483,10 +557,7 @@ public:
     int   LinkID;
   };
 
-  AisanSignalFileReader(const std::string& fileName) : SimpleReaderBase(fileName, 1)
-  {
-    m_min_id = std::numeric_limits<int>::max();
-  }
+  AisanSignalFileReader(const std::string& fileName) : SimpleReaderBase(fileName, 1){}
   AisanSignalFileReader(const vector_map_msgs::SignalArray& _signals);
   ~AisanSignalFileReader(){}
 
@@ -497,8 +568,7 @@ public:
   std::vector<AisanSignal> m_data_list;
 
 private:
-  int m_min_id;
-  std::vector<AisanSignal*> m_data_map;
+  DataRowIndex<AisanSignal> m_data_index;
 };
 
 class AisanVectorFileReader : public SimpleReaderBase
@@ -513,10 +583,7 @@ public:
     double   Vang;
   };
 
-  AisanVectorFileReader(const std::string& fileName) : SimpleReaderBase(fileName, 1)
-  {
-    m_min_id = std::numeric_limits<int>::max();
-  }
+  AisanVectorFileReader(const std::string& fileName) : SimpleReaderBase(fileName, 1){}
   AisanVectorFileReader(const vector_map_msgs::VectorArray& _vectors);
   ~AisanVectorFileReader(){}
 
@@ -527,8 +594,7 @@ public:
   std::vector<AisanVector> m_data_list;
 
 private:
-  int m_min_id;
-  std::vector<AisanVector*> m_data_map;
+  DataRowIndex<AisanVector> m_data_index;
 };
 
 class AisanCurbFileReader : public SimpleReaderBase
@@ -545,10 +611,7 @@ public:
     int   LinkID;
   };
 
-  AisanCurbFileReader(const std::string& fileName) : SimpleReaderBase(fileName, 1)
-  {
-    m_min_id = std::numeric_limits<int>::max();
-  }
+  AisanCurbFileReader(const std::string& fileName) : SimpleReaderBase(fileName, 1){}
   AisanCurbFileReader(const vector_map_msgs::CurbArray& _curbs);
   ~AisanCurbFileReader(){}
 
@@ -559,8 +622,7 @@ public:
   std::vector<AisanCurb> m_data_list;
 
 private:
-  int m_min_id;
-  std::vector<AisanCurb*> m_data_map;
+  DataRowIndex<AisanCurb> m_data_index;
 };
 
 class AisanRoadEdgeFileReader : public SimpleReaderBase
@@ -574,10 +636,7 @@ public:
     int   LinkID;
   };
 
-  AisanRoadEdgeFileReader(const std::string& fileName) : SimpleReaderBase(fileName, 1)
-  {
-    m_min_id = std::numeric_limits<int>::max();
-  }
+  AisanRoadEdgeFileReader(const std::string& fileName) : SimpleReaderBase(fileName, 1){}
   AisanRoadEdgeFileReader(const vector_map_msgs::RoadEdgeArray& _roadEdges);
   ~AisanRoadEdgeFileReader(){}
 
@@ -588,8 +647,7 @@ public:
   std::vector<AisanRoadEdge> m_data_list;
 
 private:
-  int m_min_id;
-  std::vector<AisanRoadEdge*> m_data_map;
+  DataRowIndex<AisanRoadEdge> m_data_index;
 };
 
 class AisanCrossWalkFileReader : public SimpleReaderBase
@@ -605,10 +663,7 @@ public:
     int   LinkID;
   };
 
-  AisanCrossWalkFileReader(const std::string& fileName) : SimpleReaderBase(fileName, 1)
-  {
-    m_min_id = std::numeric_limits<int>::max();
-  }
+  AisanCrossWalkFileReader(const std::string& fileName) : SimpleReaderBase(fileName, 1){}
   AisanCrossWalkFileReader(const vector_map_msgs::CrossWalkArray& _crossWalks);
   ~AisanCrossWalkFileReader(){}
 
@@ -619,8 +674,7 @@ public:
   std::vector<AisanCrossWalk> m_data_list;
 
 private:
-  int m_min_id;
-  std::vector<AisanCrossWalk*> m_data_map;
+  DataRowIndex<AisanCrossWalk> m_data_index;
 };
 
 class AisanWayareaFileReader : public SimpleReaderBase
@@ -634,10 +688,7 @@ public:
     int   LinkID;
   };
 
-  AisanWayareaFileReader(const std::string& fileName) : SimpleReaderBase(fileName, 1)
-  {
-    m_min_id = std::numeric_limits<int>::max();
-  }
+  AisanWayareaFileReader(const std::string& fileName) : SimpleReaderBase(fileName, 1){}
   AisanWayareaFileReader(const vector_map_msgs::WayAreaArray& _wayArea);
   ~AisanWayareaFileReader(){}
 
@@ -648,8 +699,7 @@ public:
   std::vector<AisanWayarea> m_data_list;
 
 private:
-  int m_min_id;
-  std::vector<AisanWayarea*> m_data_map;
+  DataRowIndex<AisanWayarea> m_data_index;
 };
 
 class AisanDataConnFileReader : public SimpleReaderBase
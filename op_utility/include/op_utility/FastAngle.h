@@ -0,0 +1,144 @@
+/// \file FastAngle.h
+/// \brief Branchless angle wrapping and polynomial atan2, sin and cos, with a compile time policy for the planners
+/// \date Oct 14, 2026
+
+#ifndef FASTANGLE_H_
+#define FASTANGLE_H_
+
+#include "UtilityH.h"
+#include <math.h>
+
+// build with -DOP_FAST_ANGLE=1 to switch PlannerAngle (used by the planners hot paths) from the libm functions to FastAngle
+#ifndef OP_FAST_ANGLE
+#define OP_FAST_ANGLE 0
+#endif
+
+namespace UtilityHNS
+{
+
+/**
+ * @brief Same interface as FastAngle on top of UtilityH and libm, the results are the ones of the original helpers
+ */
+class ExactAngle
+{
+public:
+  static inline double FixNegativeAngle(const double& a) { return UtilityH::FixNegativeAngle(a); }
+  static inline double SplitPositiveAngle(const double& a) { return UtilityH::SplitPositiveAngle(a); }
+  static inline double AngleBetweenTwoAnglesPositive(const double& a1, const double& a2) { return UtilityH::AngleBetweenTwoAnglesPositive(a1, a2); }
+  static inline double Atan2(const double& y, const double& x) { return atan2(y, x); }
+  static inline void SinCos(const double& a, double& s, double& c) { s = sin(a); c = cos(a); }
+};
+
+/**
+ * @brief Wrapping without fmod nor branches on the data, atan2 from a degree 13 odd polynomial after reducing the argument
+ * to [-tan(pi/8), tan(pi/8)], sin and cos from the Cephes polynomials after Cody Waite reduction to [-pi/4, pi/4].
+ * Error bounds (pinned by the op_utility tests):
+ *  - Atan2, absolute error below 1e-11 rad for finite inputs, Atan2(0, 0) is 0.
+ *  - SinCos, absolute error below 1e-14 for |a| <= 1e4 rad.
+ *  - FixNegativeAngle, SplitPositiveAngle and AngleBetweenTwoAnglesPositive, below 1e-15 * (1 + |a|) rad.
+ * AngleBetweenTwoAnglesPositive is in [0, pi] for any a1 and a2 (the UtilityH one expects both in [0, 2pi)).
+ */
+class FastAngle
+{
+public:
+  static constexpr double TWO_PI = 6.28318530717958647692;
+  static constexpr double INV_TWO_PI = 0.15915494309189533577;
+  static constexpr double TAN_PI_8 = 0.41421356237309504880;
+
+  /**
+   * @brief a in [0, 2pi)
+   */
+  static inline double FixNegativeAngle(const double& a)
+  {
+    double r = a - TWO_PI * floor(a * INV_TWO_PI);
+    r += (r < 0) ? TWO_PI : 0.0;
+    r -= (r >= TWO_PI) ? TWO_PI : 0.0;
+    return r;
+  }
+
+  /**
+   * @brief a in [-pi, pi)
+   */
+  static inline double SplitPositiveAngle(const double& a)
+  {
+    double r = a - TWO_PI * floor(a * INV_TWO_PI + 0.5);
+    r += (r < -M_PI) ? TWO_PI : 0.0;
+    r -= (r >= M_PI) ? TWO_PI : 0.0;
+    return r;
+  }
+
+  static inline double AngleBetweenTwoAnglesPositive(const double& a1, const double& a2)
+  {
+    return fabs(SplitPositiveAngle(a1 - a2));
+  }
+
+  static inline double Atan2(const double& y, const double& x)
+  {
+    double ax = fabs(x);
+    double ay = fabs(y);
+    double mx = (ax > ay) ? ax : ay;
+    double mn = (ax > ay) ? ay : ax;
+    double t = (mx > 0) ? mn / mx : 0.0;
+
+    //atan(t) = pi/4 + atan((t-1)/(t+1))
+    bool bReduced = t > TAN_PI_8;
+    double u = bReduced ? (t - 1.0) / (t + 1.0) : t;
+    double z = u * u;
+    double p = 0.047247566756474686;
+    p = p * z - 0.08465252999469648;
+    p = p * z + 0.1104226285240689;
+    p = p * z - 0.1428174953695099;
+    p = p * z + 0.19999890492041927;
+    p = p * z - 0.3333333219911652;
+    p = p * z + 0.9999999999809904;
+    double r = u * p + (bReduced ? M_PI_4 : 0.0);
+
+    r = (ay > ax) ? M_PI_2 - r : r;
+    r = (x < 0) ? M_PI - r : r;
+    return copysign(r, y);
+  }
+
+  static inline void SinCos(const double& a, double& s, double& c)
+  {
+    static constexpr double TWO_OVER_PI = 0.63661977236758134308;
+    //first 33 bits of pi/2, j * PI_2_HI is exact for |j| < 2^20
+    static constexpr double PI_2_HI = 1.57079632673412561417e+00;
+    static constexpr double PI_2_LO = 6.07710050650619224932e-11;
+
+    double j = floor(a * TWO_OVER_PI + 0.5);
+    double x = (a - j * PI_2_HI) - j * PI_2_LO;
+    double z = x * x;
+
+    double ps = 1.58962301576546568060E-10;
+    ps = ps * z - 2.50507477628578072866E-8;
+    ps = ps * z + 2.75573136213857245213E-6;
+    ps = ps * z - 1.98412698295895385996E-4;
+    ps = ps * z + 8.33333333332211858878E-3;
+    ps = ps * z - 1.66666666666666307295E-1;
+    double sx = x + x * z * ps;
+
+    double pc = -1.13585365213876817300E-11;
+    pc = pc * z + 2.08757008419747316778E-9;
+    pc = pc * z - 2.75573141792967388112E-7;
+    pc = pc * z + 2.48015872888517045348E-5;
+    pc = pc * z - 1.38888888888730564116E-3;
+    pc = pc * z + 4.16666666666665929218E-2;
+    double cx = 1.0 - 0.5 * z + z * z * pc;
+
+    int q = ((long long)j) & 3;
+    double qs = (q & 1) ? cx : sx;
+    double qc = (q & 1) ? sx : cx;
+    s = (q & 2) ? -qs : qs;
+    c = ((q + 1) & 2) ? -qc : qc;
+  }
+};
+
+#if OP_FAST_ANGLE
+typedef FastAngle PlannerAngle;
+#else
+typedef ExactAngle PlannerAngle;
+#endif
+
+} /* namespace UtilityHNS */
+
+#endif /* FASTANGLE_H_ */
@@ -0,0 +1,113 @@
+/// \file StageTimer.h
+/// \brief Scoped timers and latency histograms for the stages of a planning cycle
+/// \date Oct 14, 2026
+
+#ifndef STAGETIMER_H_
+#define STAGETIMER_H_
+
+#include <string>
+#include <vector>
+#include <time.h>
+
+// build with -DOP_STAGE_TIMERS=0 to compile the OP_STAGE_TIMER and OP_STAGE_RECORD macros out
+#ifndef OP_STAGE_TIMERS
+#define OP_STAGE_TIMERS 1
+#endif
+
+namespace UtilityHNS
+{
+
+/**
+ * @brief Fixed log scale histogram of durations in seconds, from 1 us up to about 100 s with 15% wide bins.
+ * Adding a sample is O(1) and never allocates, percentiles are the upper edge of their bin (never above the max).
+ */
+class LatencyHistogram
+{
+public:
+  static const int N_BINS = 136;
+  static constexpr double MIN_DURATION = 1e-6;
+  static constexpr double BIN_GROWTH = 1.15;
+
+  LatencyHistogram();
+  void Add(const double& seconds);
+  void Reset();
+
+  unsigned long GetCount() const;
+  double GetMax() const;
+  double GetMean() const;
+
+  /**
+   * @brief p in [0, 1], 0 when there is no sample
+   */
+  double GetPercentile(const double& p) const;
+
+private:
+  unsigned long m_Bins[N_BINS]; // bin 0 holds durations under MIN_DURATION, bin i up to MIN_DURATION*BIN_GROWTH^i
+  unsigned long m_Count;
+  double m_Max;
+  double m_Sum;
+
+  static int GetBin(const double& seconds);
+  static double GetBinUpperEdge(const int& bin);
+};
+
+/**
+ * @brief One latency histogram per named stage, the stages are added once and recorded by index.
+ * Not synchronized, record from the planning thread and read between cycles.
+ */
+class StageLatencyRecorder
+{
+public:
+  /**
+   * @brief Index of the stage called name, added at the end if it is new
+   */
+  int AddStage(const std::string& name);
+  void Record(const int& stage, const double& seconds);
+  void Reset();
+
+  unsigned int GetNumberOfStages() const;
+  const std::string& GetStageName(const int& stage) const;
+  const LatencyHistogram& GetHistogram(const int& stage) const;
+
+  /**
+   * @brief One line per stage, name: p50, p99 and max in milliseconds and the number of samples
+   */
+  std::string ToString() const;
+
+private:
+  std::vector<std::string> m_Names;
+  std::vector<LatencyHistogram> m_Histograms;
+};
+
+/**
+ * @brief Records the time from its construction to its destruction in stage of pRecorder, nothing when pRecorder is null
+ */
+class ScopedStageTimer
+{
+public:
+  ScopedStageTimer(StageLatencyRecorder* pRecorder, const int& stage);
+  ~ScopedStageTimer();
+
+private:
+  StageLatencyRecorder* m_pRecorder;
+  int m_Stage;
+  struct timespec m_Start;
+
+  ScopedStageTimer(const ScopedStageTimer&);
+  ScopedStageTimer& operator=(const ScopedStageTimer&);
+};
+
+} /* namespace UtilityHNS */
+
+#define OP_STAGE_TIMER_NAME_(line) op_stage_timer_##line
+#define OP_STAGE_TIMER_NAME(line) OP_STAGE_TIMER_NAME_(line)
+
+#if OP_STAGE_TIMERS
+#define OP_STAGE_TIMER(pRecorder, stage) UtilityHNS::ScopedStageTimer OP_STAGE_TIMER_NAME(__LINE__)(pRecorder, stage)
+#define OP_STAGE_RECORD(pRecorder, stage, seconds) (pRecorder)->Record(stage, seconds)
+#else
+#define OP_STAGE_TIMER(pRecorder, stage)
+#define OP_STAGE_RECORD(pRecorder, stage, seconds)
+#endif
+
+#endif /* STAGETIMER_H_ */
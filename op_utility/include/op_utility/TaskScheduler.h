@@ -0,0 +1,163 @@
+/// \file TaskScheduler.h
+/// \brief Work stealing task scheduler, one process wide instance shared by the OpenPlanner libraries
+/// \date Oct 14, 2026
+
+#ifndef TASKSCHEDULER_H_
+#define TASKSCHEDULER_H_
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <exception>
+
+namespace UtilityHNS
+{
+
+class TaskSchedulerParams
+{
+public:
+  int nThreads; // total number of threads including the submitting thread, 0 uses the hardware concurrency
+  std::vector<int> cpuAffinity; // worker i is pinned to cpuAffinity[i % size], empty leaves the workers unpinned
+  int niceValue; // applied to each worker, 0 keeps the priority of the creating thread
+  int realTimePriority; // > 0 runs the workers with SCHED_FIFO at this priority instead of niceValue
+
+  TaskSchedulerParams()
+  {
+    nThreads = 0;
+    niceValue = 0;
+    realTimePriority = 0;
+  }
+};
+
+class TaskSchedulerStats
+{
+public:
+  int nThreads;
+  unsigned long nSubmitted;
+  unsigned long nExecuted;
+  unsigned long nStolen; // tasks taken from the queue of another thread
+  unsigned int queueDepth; // tasks waiting in all the queues
+  unsigned int maxQueueDepth; // since the last ResetStats
+  std::vector<unsigned int> workerQueueDepths; // one per worker, the last one is the queue of the non worker threads
+  int nSettingsFailures; // affinity or priority settings the system refused
+
+  TaskSchedulerStats()
+  {
+    nThreads = 0;
+    nSubmitted = 0;
+    nExecuted = 0;
+    nStolen = 0;
+    queueDepth = 0;
+    maxQueueDepth = 0;
+    nSettingsFailures = 0;
+  }
+};
+
+/**
+ * @brief Pending tasks of one Submit / Wait batch, keeps the first exception thrown by them
+ */
+class TaskGroup
+{
+public:
+  TaskGroup();
+
+private:
+  friend class TaskScheduler;
+  std::atomic<int> m_nPending;
+  std::mutex m_Mutex;
+  std::condition_variable m_DoneCondition;
+  std::exception_ptr m_Exception;
+
+  TaskGroup(const TaskGroup&);
+  TaskGroup& operator=(const TaskGroup&);
+};
+
+/**
+ * @brief Each worker has its own queue, it runs its newest task first and steals the oldest task of another queue when its own is empty.
+ * Tasks submitted from a worker go to its queue, tasks from other threads go to a shared queue the workers also steal from.
+ * A thread waiting on a group runs queued tasks until the group is done, so tasks can submit and wait on nested groups.
+ * Affinity and priority settings are best effort, the ones the system refuses are counted in the statistics.
+ */
+class TaskScheduler
+{
+public:
+  TaskScheduler(const TaskSchedulerParams& params = TaskSchedulerParams());
+  virtual ~TaskScheduler();
+
+  /**
+   * @brief Scheduler shared by the libraries of the process, created on first use
+   */
+  static TaskScheduler& GetShared();
+
+  /**
+   * @brief Parameters of the shared scheduler, false if it is already created
+   */
+  static bool ConfigureShared(const TaskSchedulerParams& params);
+
+  int GetNumberOfThreads() const;
+
+  void Submit(TaskGroup& group, const std::function<void()>& task);
+
+  /**
+   * @brief Returns when all the tasks of group are done, re-throws the first exception thrown by one of them
+   */
+  void Wait(TaskGroup& group);
+
+  /**
+   * @brief Runs task(i) for i in [0, n) on at most maxParallel threads (0 for all), the caller included, returns when all are done.
+   * The order of execution is not defined, tasks must only write to their own slot of the output.
+   * The first exception thrown by a task is re-thrown to the caller after the loop finishes.
+   */
+  void ParallelFor(const int& n, const std::function<void(const int&)>& task, const int& maxParallel = 0);
+
+  TaskSchedulerStats GetStats() const;
+  void ResetStats();
+
+private:
+  class Task
+  {
+  public:
+    std::function<void()> run;
+    TaskGroup* pGroup;
+  };
+
+  class TaskQueue
+  {
+  public:
+    std::mutex mutex;
+    std::deque<Task> tasks;
+  };
+
+  std::vector<std::unique_ptr<TaskQueue> > m_Queues; // one per worker, the last one for the other threads
+  std::vector<std::thread> m_Workers;
+  TaskSchedulerParams m_Params;
+  std::mutex m_SleepMutex;
+  std::condition_variable m_WakeCondition;
+  std::atomic<int> m_nQueued;
+  bool m_bStop;
+
+  std::atomic<unsigned long> m_nSubmitted;
+  std::atomic<unsigned long> m_nExecuted;
+  std::atomic<unsigned long> m_nStolen;
+  std::atomic<unsigned int> m_MaxQueueDepth;
+  std::atomic<int> m_nSettingsFailures;
+  std::atomic<int> m_nStartedWorkers;
+
+  void WorkerLoop(const int& iWorker);
+  void ApplyThreadSettings(const int& iWorker);
+  int GetCurrentQueue() const;
+  bool PopTask(const int& iQueue, Task& task);
+  void RunTask(Task& task);
+
+  TaskScheduler(const TaskScheduler&);
+  TaskScheduler& operator=(const TaskScheduler&);
+};
+
+} /* namespace UtilityHNS */
+
+#endif /* TASKSCHEDULER_H_ */
@@ -10,6 +10,7 @@
 #include <assert.h>
 #include <string>
 #include <math.h>
+#include <time.h>
 
 
 namespace UtilityHNS
@@ -49,6 +50,26 @@ public:
   static time_t GetLongTime(const struct timespec& srcT);
 };
 
+/**
+ * @brief While it exists, GetTickCount of the creating thread returns simTime instead of the system clock,
+ * so the timers of the planners run on a simulated time. Scopes nest, the previous clock is restored by the destructor.
+ * The scope must be destroyed on the thread that created it.
+ */
+class SimulatedClockScope
+{
+public:
+  SimulatedClockScope(const struct timespec& simTime);
+  SimulatedClockScope(const double& simSeconds);
+  virtual ~SimulatedClockScope();
+
+private:
+  struct timespec m_Time;
+  const struct timespec* m_pPreviousTime;
+
+  SimulatedClockScope(const SimulatedClockScope&);
+  SimulatedClockScope& operator=(const SimulatedClockScope&);
+};
+
 class PIDController
 {
 public:
@@ -63,6 +84,13 @@ public:
   std::string ToString();
   std::string ToStringHeader();
 
+  /**
+   * @brief Values of a ToString line without its time, for a log record formatted later by LogValuesToString
+   */
+  static const int LOG_VALUES_COUNT = 10;
+  void GetLogValues(double* values) const;
+  static std::string LogValuesToString(const time_t& t, const double* values);
+
 
 private:
   double kp;
@@ -0,0 +1,300 @@
+/// \file AsyncLogger.cpp
+/// \brief Logs pushed as fixed size binary records into a lock free queue, written to a binary file by a background thread
+/// \date Oct 14, 2026
+
+#include "op_utility/AsyncLogger.h"
+#include "op_utility/DataRW.h"
+#include "op_utility/UtilityH.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <sstream>
+
+namespace UtilityHNS
+{
+
+const int AsyncLogger::MAX_VALUES;
+
+static const char LOG_FILE_MAGIC[8] = {'O', 'P', 'L', 'O', 'G', '0', '0', '1'};
+
+template <class T>
+static void WriteBinary(std::ofstream& f, const T& value)
+{
+  f.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+static void WriteBinaryString(std::ofstream& f, const std::string& str)
+{
+  WriteBinary(f, (uint32_t)str.size());
+  f.write(str.data(), str.size());
+}
+
+template <class T>
+static bool ReadBinary(std::ifstream& f, T& value)
+{
+  return (bool)f.read(reinterpret_cast<char*>(&value), sizeof(T));
+}
+
+static bool ReadBinaryString(std::ifstream& f, std::string& str)
+{
+  uint32_t size = 0;
+  if(!ReadBinary(f, size))
+    return false;
+  str.resize(size);
+  return size == 0 || (bool)f.read(&str[0], size);
+}
+
+static void WriteTextValue(std::ostringstream& str, const double& value)
+{
+  if(value == std::floor(value) && std::fabs(value) < 9007199254740992.0)
+    str << (long long)value;
+  else
+    str << value;
+}
+
+AsyncLogger::AsyncLogger(const std::string& fileName, const unsigned int& capacity, const double& flushPeriod)
+  : m_FlushPeriod(flushPeriod), m_EnqueuePos(0), m_DequeuePos(0), m_nDropped(0), m_nWrittenDefinitions(0),
+    m_bStop(false)
+{
+  uint64_t size = 2;
+  while(size < capacity)
+    size *= 2;
+  m_Slots = std::vector<Slot>(size);
+  for(uint64_t i = 0; i < size; i++)
+    m_Slots.at(i).sequence.store(i, std::memory_order_relaxed);
+  m_Mask = size - 1;
+
+  m_File.open(fileName.c_str(), std::ios::binary | std::ios::trunc);
+  if(m_File.is_open())
+  {
+    m_File.write(LOG_FILE_MAGIC, sizeof(LOG_FILE_MAGIC));
+    m_Thread = std::thread(&AsyncLogger::WriterLoop, this);
+  }
+}
+
+AsyncLogger::~AsyncLogger()
+{
+  if(m_Thread.joinable())
+  {
+    {
+      std::lock_guard<std::mutex> lock(m_Mutex);
+      m_bStop = true;
+    }
+    m_Condition.notify_one();
+    m_Thread.join();
+  }
+}
+
+bool AsyncLogger::IsOpen() const
+{
+  return m_File.is_open();
+}
+
+int AsyncLogger::AddLog(const std::string& title, const std::string& header, const LOG_LAYOUT& layout)
+{
+  LogDefinition definition;
+  definition.title = title;
+  definition.header = header;
+  definition.layout = layout;
+  std::lock_guard<std::mutex> lock(m_DefinitionsMutex);
+  m_Definitions.push_back(definition);
+  return m_Definitions.size() - 1;
+}
+
+bool AsyncLogger::Log(const int& log, const double* values, const int& nValues)
+{
+  timespec t;
+  UtilityH::GetTickCount(t);
+
+  // bounded multi producer queue, a slot is free for position pos when its sequence is pos
+  uint64_t pos = m_EnqueuePos.load(std::memory_order_relaxed);
+  Slot* pSlot = 0;
+  while(true)
+  {
+    pSlot = &m_Slots[pos & m_Mask];
+    int64_t diff = (int64_t)pSlot->sequence.load(std::memory_order_acquire) - (int64_t)pos;
+    if(diff == 0)
+    {
+      if(m_EnqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+        break;
+    }
+    else if(diff < 0)
+    {
+      m_nDropped.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    else
+    {
+      pos = m_EnqueuePos.load(std::memory_order_relaxed);
+    }
+  }
+
+  LogRecord& record = pSlot->record;
+  record.log = log;
+  record.nValues = std::max(0, std::min(nValues, (int)MAX_VALUES));
+  record.time = UtilityH::GetLongTime(t);
+  std::copy(values, values + record.nValues, record.values);
+  pSlot->sequence.store(pos + 1, std::memory_order_release);
+  return true;
+}
+
+void AsyncLogger::Flush()
+{
+  if(!m_File.is_open())
+    return;
+  std::lock_guard<std::mutex> lock(m_WriteMutex);
+  WriteRecords();
+  m_File.flush();
+}
+
+unsigned long AsyncLogger::GetDroppedCount() const
+{
+  return m_nDropped.load(std::memory_order_relaxed);
+}
+
+void AsyncLogger::WriterLoop()
+{
+  std::unique_lock<std::mutex> lock(m_Mutex);
+  while(!m_bStop)
+  {
+    m_Condition.wait_for(lock, std::chrono::duration<double>(m_FlushPeriod));
+    lock.unlock();
+    Flush();
+    lock.lock();
+  }
+  lock.unlock();
+  Flush();
+}
+
+void AsyncLogger::WriteRecords()
+{
+  while(true)
+  {
+    Slot& slot = m_Slots[m_DequeuePos & m_Mask];
+    if(slot.sequence.load(std::memory_order_acquire) != m_DequeuePos + 1)
+      break;
+
+    const LogRecord& record = slot.record;
+    if(record.log >= 0 && (unsigned int)record.log >= m_nWrittenDefinitions)
+      WriteDefinitions(record.log + 1);
+    if(record.log >= 0 && (unsigned int)record.log < m_nWrittenDefinitions)
+    {
+      m_File.put('R');
+      WriteBinary(m_File, (uint32_t)record.log);
+      WriteBinary(m_File, (uint32_t)record.nValues);
+      WriteBinary(m_File, (int64_t)record.time);
+      m_File.write(reinterpret_cast<const char*>(record.values), record.nValues * sizeof(double));
+    }
+
+    // free for the producers of the next round
+    slot.sequence.store(m_DequeuePos + m_Mask + 1, std::memory_order_release);
+    m_DequeuePos++;
+  }
+}
+
+void AsyncLogger::WriteDefinitions(const unsigned int& nLogs)
+{
+  std::lock_guard<std::mutex> lock(m_DefinitionsMutex);
+  unsigned int n = std::min<unsigned int>(nLogs, m_Definitions.size());
+  for(; m_nWrittenDefinitions < n; m_nWrittenDefinitions++)
+  {
+    const LogDefinition& definition = m_Definitions.at(m_nWrittenDefinitions);
+    m_File.put('D');
+    WriteBinary(m_File, (uint32_t)m_nWrittenDefinitions);
+    WriteBinary(m_File, (uint8_t)definition.layout);
+    WriteBinaryString(m_File, definition.title);
+    WriteBinaryString(m_File, definition.header);
+  }
+}
+
+bool AsyncLogger::ConvertToText(const std::string& logFile, const std::string& outputFolder)
+{
+  std::ifstream f(logFile.c_str(), std::ios::binary);
+  char magic[sizeof(LOG_FILE_MAGIC)];
+  if(!f.read(magic, sizeof(magic)) || memcmp(magic, LOG_FILE_MAGIC, sizeof(magic)) != 0)
+    return false;
+
+  std::map<uint32_t, LogDefinition> definitions;
+  std::map<uint32_t, std::vector<std::string> > lines;
+  std::vector<double> values;
+  char type = 0;
+  while(f.get(type))
+  {
+    uint32_t log = 0;
+    if(!ReadBinary(f, log))
+      return false;
+
+    if(type == 'D')
+    {
+      uint8_t layout = 0;
+      LogDefinition definition;
+      if(!ReadBinary(f, layout) || !ReadBinaryString(f, definition.title) || !ReadBinaryString(f, definition.header))
+        return false;
+      definition.layout = (LOG_LAYOUT)layout;
+      definitions[log] = definition;
+    }
+    else if(type == 'R')
+    {
+      uint32_t nValues = 0;
+      int64_t time = 0;
+      if(!ReadBinary(f, nValues) || !ReadBinary(f, time) || nValues > (uint32_t)MAX_VALUES)
+        return false;
+      values.resize(nValues);
+      if(nValues > 0 && !f.read(reinterpret_cast<char*>(values.data()), nValues * sizeof(double)))
+        return false;
+      if(definitions.find(log) == definitions.end())
+        return false;
+
+      std::ostringstream str;
+      if(definitions[log].layout == LOG_KML)
+      {
+        str.precision(18);
+        for(unsigned int i = 0; i < nValues; i++)
+        {
+          if(i > 0)
+            str << ",";
+          str << values.at(i);
+        }
+      }
+      else
+      {
+        if(definitions[log].layout == LOG_CSV_TIME)
+          str << time << ",";
+        for(unsigned int i = 0; i < nValues; i++)
+        {
+          WriteTextValue(str, values.at(i));
+          str << ",";
+        }
+      }
+      lines[log].push_back(str.str());
+    }
+    else
+    {
+      return false;
+    }
+  }
+
+  for(std::map<uint32_t, LogDefinition>::const_iterator it = definitions.begin(); it != definitions.end(); it++)
+  {
+    const std::vector<std::string>& log_lines = lines[it->first];
+    if(it->second.layout == LOG_KML)
+    {
+      DataRW::WriteKMLFile(outputFolder + it->second.title + ".kml", log_lines);
+      continue;
+    }
+
+    std::ofstream csv((outputFolder + it->second.title + ".csv").c_str());
+    if(!csv.is_open())
+      return false;
+    if(it->second.header.size() > 0)
+      csv << it->second.header << "\r\n";
+    for(unsigned int i = 0; i < log_lines.size(); i++)
+      csv << log_lines.at(i) << "\r\n";
+  }
+
+  return true;
+}
+
+} /* namespace UtilityHNS */
@@ -0,0 +1,638 @@
+/// \file ColumnarLog.cpp
+/// \brief Recorded logs as fixed width typed columns in chunks, read by column and by key range without parsing
+/// \date Oct 14, 2026
+
+#include "op_utility/ColumnarLog.h"
+#include <algorithm>
+#include <cstring>
+
+namespace UtilityHNS
+{
+
+static const char COLUMNAR_FILE_MAGIC[8] = {'O', 'P', 'C', 'O', 'L', '0', '0', '1'};
+static const char COLUMNAR_INDEX_MAGIC[8] = {'O', 'P', 'C', 'O', 'L', 'I', 'D', 'X'};
+// uint64 offset of the index, uint32 nChunks, magic
+static const int COLUMNAR_TRAILER_SIZE = sizeof(uint64_t) + sizeof(uint32_t) + sizeof(COLUMNAR_INDEX_MAGIC);
+static const unsigned int SIMULATION_NAME_WIDTH = 64;
+
+template <class T>
+static void WriteBinary(std::ofstream& f, const T& value)
+{
+  f.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <class T>
+static bool ReadBinary(std::ifstream& f, T& value)
+{
+  return (bool)f.read(reinterpret_cast<char*>(&value), sizeof(T));
+}
+
+template <class T>
+static void AppendBinary(std::vector<char>& buffer, const T& value)
+{
+  const char* p = reinterpret_cast<const char*>(&value);
+  buffer.insert(buffer.end(), p, p + sizeof(T));
+}
+
+template <class T>
+static T ReadBinaryAt(const char* p)
+{
+  T value;
+  memcpy(&value, p, sizeof(T));
+  return value;
+}
+
+static unsigned int ColumnWidth(const ColumnDefinition& column)
+{
+  switch(column.type)
+  {
+  case COL_DOUBLE:
+    return sizeof(double);
+  case COL_FLOAT:
+    return sizeof(float);
+  case COL_INT32:
+    return sizeof(int32_t);
+  case COL_INT64:
+    return sizeof(int64_t);
+  default:
+    return column.width;
+  }
+}
+
+static double ColumnValue(const ColumnDefinition& column, const char* p)
+{
+  switch(column.type)
+  {
+  case COL_DOUBLE:
+    return ReadBinaryAt<double>(p);
+  case COL_FLOAT:
+    return ReadBinaryAt<float>(p);
+  case COL_INT32:
+    return ReadBinaryAt<int32_t>(p);
+  case COL_INT64:
+    return (double)ReadBinaryAt<int64_t>(p);
+  default:
+    return 0;
+  }
+}
+
+ColumnarLogWriter::ColumnarLogWriter(const std::string& fileName, const std::vector<ColumnDefinition>& columns,
+    const int& keyColumn, const unsigned int& chunkRows)
+  : m_Columns(columns), m_KeyColumn(keyColumn), m_ChunkRows(std::max(chunkRows, 1u)), m_nChunkRows(0),
+    m_ChunkMinKey(0), m_ChunkMaxKey(0), m_nRows(0)
+{
+  if(m_KeyColumn < 0 || m_KeyColumn >= (int)m_Columns.size() || m_Columns.at(m_KeyColumn).type == COL_STRING)
+    m_KeyColumn = -1;
+
+  m_RowValues.resize(m_Columns.size(), 0);
+  m_RowStrings.resize(m_Columns.size());
+  m_ChunkColumns.resize(m_Columns.size());
+
+  m_File.open(fileName.c_str(), std::ios::binary | std::ios::trunc);
+  if(!m_File.is_open())
+    return;
+
+  m_File.write(COLUMNAR_FILE_MAGIC, sizeof(COLUMNAR_FILE_MAGIC));
+  WriteBinary(m_File, (uint32_t)m_Columns.size());
+  WriteBinary(m_File, (int32_t)m_KeyColumn);
+  WriteBinary(m_File, (uint32_t)m_ChunkRows);
+  for(unsigned int i = 0; i < m_Columns.size(); i++)
+  {
+    WriteBinary(m_File, (uint8_t)m_Columns.at(i).type);
+    WriteBinary(m_File, (uint32_t)ColumnWidth(m_Columns.at(i)));
+    WriteBinary(m_File, (uint32_t)m_Columns.at(i).name.size());
+    m_File.write(m_Columns.at(i).name.data(), m_Columns.at(i).name.size());
+  }
+}
+
+ColumnarLogWriter::~ColumnarLogWriter()
+{
+  Close();
+}
+
+bool ColumnarLogWriter::IsOpen() const
+{
+  return m_File.is_open();
+}
+
+void ColumnarLogWriter::SetValue(const int& column, const double& value)
+{
+  if(column >= 0 && column < (int)m_RowValues.size())
+    m_RowValues.at(column) = value;
+}
+
+void ColumnarLogWriter::SetString(const int& column, const std::string& value)
+{
+  if(column >= 0 && column < (int)m_RowStrings.size())
+    m_RowStrings.at(column) = value;
+}
+
+void ColumnarLogWriter::EndRow()
+{
+  if(!m_File.is_open())
+    return;
+
+  for(unsigned int i = 0; i < m_Columns.size(); i++)
+  {
+    std::vector<char>& buffer = m_ChunkColumns.at(i);
+    switch(m_Columns.at(i).type)
+    {
+    case COL_DOUBLE:
+      AppendBinary(buffer, m_RowValues.at(i));
+      break;
+    case COL_FLOAT:
+      AppendBinary(buffer, (float)m_RowValues.at(i));
+      break;
+    case COL_INT32:
+      AppendBinary(buffer, (int32_t)m_RowValues.at(i));
+      break;
+    case COL_INT64:
+      AppendBinary(buffer, (int64_t)m_RowValues.at(i));
+      break;
+    default:
+    {
+      // truncated or padded to the width
+      const std::string& str = m_RowStrings.at(i);
+      unsigned int n = std::min((unsigned int)str.size(), m_Columns.at(i).width);
+      buffer.insert(buffer.end(), str.begin(), str.begin() + n);
+      buffer.insert(buffer.end(), m_Columns.at(i).width - n, '\0');
+      break;
+    }
+    }
+  }
+
+  double key = (m_KeyColumn >= 0) ? ColumnValue(m_Columns.at(m_KeyColumn),
+      m_ChunkColumns.at(m_KeyColumn).data() + m_nChunkRows * ColumnWidth(m_Columns.at(m_KeyColumn))) : m_nRows;
+  if(m_nChunkRows == 0 || key < m_ChunkMinKey)
+    m_ChunkMinKey = key;
+  if(m_nChunkRows == 0 || key > m_ChunkMaxKey)
+    m_ChunkMaxKey = key;
+
+  std::fill(m_RowValues.begin(), m_RowValues.end(), 0);
+  std::fill(m_RowStrings.begin(), m_RowStrings.end(), std::string());
+  m_nChunkRows++;
+  m_nRows++;
+  if(m_nChunkRows == m_ChunkRows)
+    WriteChunk();
+}
+
+void ColumnarLogWriter::WriteChunk()
+{
+  if(m_nChunkRows == 0)
+    return;
+
+  ChunkInfo chunk;
+  chunk.offset = m_File.tellp();
+  chunk.nRows = m_nChunkRows;
+  chunk.minKey = m_ChunkMinKey;
+  chunk.maxKey = m_ChunkMaxKey;
+  m_Index.push_back(chunk);
+
+  for(unsigned int i = 0; i < m_ChunkColumns.size(); i++)
+  {
+    m_File.write(m_ChunkColumns.at(i).data(), m_ChunkColumns.at(i).size());
+    m_ChunkColumns.at(i).clear();
+  }
+  m_nChunkRows = 0;
+}
+
+bool ColumnarLogWriter::Close()
+{
+  if(!m_File.is_open())
+    return false;
+
+  WriteChunk();
+  uint64_t indexOffset = m_File.tellp();
+  for(unsigned int i = 0; i < m_Index.size(); i++)
+  {
+    WriteBinary(m_File, m_Index.at(i).offset);
+    WriteBinary(m_File, m_Index.at(i).nRows);
+    WriteBinary(m_File, m_Index.at(i).minKey);
+    WriteBinary(m_File, m_Index.at(i).maxKey);
+  }
+  WriteBinary(m_File, indexOffset);
+  WriteBinary(m_File, (uint32_t)m_Index.size());
+  m_File.write(COLUMNAR_INDEX_MAGIC, sizeof(COLUMNAR_INDEX_MAGIC));
+  bool bWritten = (bool)m_File;
+  m_File.close();
+  return bWritten;
+}
+
+ColumnarLogReader::ColumnarLogReader(const std::string& fileName) : m_bOpen(false), m_KeyColumn(-1)
+{
+  m_File.open(fileName.c_str(), std::ios::binary);
+  char magic[sizeof(COLUMNAR_FILE_MAGIC)];
+  if(!m_File.read(magic, sizeof(magic)) || memcmp(magic, COLUMNAR_FILE_MAGIC, sizeof(magic)) != 0)
+    return;
+
+  uint32_t nColumns = 0, chunkRows = 0;
+  int32_t keyColumn = -1;
+  if(!ReadBinary(m_File, nColumns) || !ReadBinary(m_File, keyColumn) || !ReadBinary(m_File, chunkRows))
+    return;
+
+  uint64_t rowWidth = 0;
+  for(uint32_t i = 0; i < nColumns; i++)
+  {
+    uint8_t type = 0;
+    uint32_t width = 0, nameSize = 0;
+    if(!ReadBinary(m_File, type) || !ReadBinary(m_File, width) || !ReadBinary(m_File, nameSize) || type > COL_STRING)
+      return;
+    std::string name(nameSize, '\0');
+    if(nameSize > 0 && !m_File.read(&name[0], nameSize))
+      return;
+    m_Columns.push_back(ColumnDefinition(name, (COLUMN_TYPE)type, width));
+    m_ColumnOffsets.push_back(rowWidth);
+    rowWidth += width;
+  }
+  m_KeyColumn = (keyColumn >= 0 && keyColumn < (int)nColumns) ? keyColumn : -1;
+
+  uint64_t indexOffset = 0;
+  uint32_t nChunks = 0;
+  char indexMagic[sizeof(COLUMNAR_INDEX_MAGIC)];
+  if(!m_File.seekg(-COLUMNAR_TRAILER_SIZE, std::ios::end) || !ReadBinary(m_File, indexOffset) ||
+      !ReadBinary(m_File, nChunks) || !m_File.read(indexMagic, sizeof(indexMagic)) ||
+      memcmp(indexMagic, COLUMNAR_INDEX_MAGIC, sizeof(indexMagic)) != 0)
+    return;
+
+  if(!m_File.seekg(indexOffset))
+    return;
+  uint64_t firstRow = 0;
+  for(uint32_t i = 0; i < nChunks; i++)
+  {
+    ChunkInfo chunk;
+    if(!ReadBinary(m_File, chunk.offset) || !ReadBinary(m_File, chunk.nRows) || !ReadBinary(m_File, chunk.minKey) ||
+        !ReadBinary(m_File, chunk.maxKey))
+      return;
+    chunk.firstRow = firstRow;
+    firstRow += chunk.nRows;
+    m_Index.push_back(chunk);
+  }
+  m_bOpen = true;
+}
+
+bool ColumnarLogReader::IsOpen() const
+{
+  return m_bOpen;
+}
+
+int ColumnarLogReader::GetColumnIndex(const std::string& name) const
+{
+  for(unsigned int i = 0; i < m_Columns.size(); i++)
+  {
+    if(m_Columns.at(i).name == name)
+      return i;
+  }
+  return -1;
+}
+
+unsigned long long ColumnarLogReader::GetRowsCount() const
+{
+  if(m_Index.size() == 0)
+    return 0;
+  return m_Index.back().firstRow + m_Index.back().nRows;
+}
+
+// values of the column in the chunk into m_Buffer
+bool ColumnarLogReader::ReadChunkColumn(const ChunkInfo& chunk, const int& column)
+{
+  m_File.clear();
+  m_Buffer.resize((size_t)chunk.nRows * m_Columns.at(column).width);
+  return m_File.seekg(chunk.offset + m_ColumnOffsets.at(column) * chunk.nRows) &&
+      (m_Buffer.size() == 0 || m_File.read(m_Buffer.data(), m_Buffer.size()));
+}
+
+bool ColumnarLogReader::ReadChunkKeys(const ChunkInfo& chunk, std::vector<double>& keys)
+{
+  keys.resize(chunk.nRows);
+  if(m_KeyColumn < 0)
+  {
+    for(uint32_t i = 0; i < chunk.nRows; i++)
+      keys.at(i) = chunk.firstRow + i;
+    return true;
+  }
+
+  if(!ReadChunkColumn(chunk, m_KeyColumn))
+    return false;
+  const ColumnDefinition& key = m_Columns.at(m_KeyColumn);
+  for(uint32_t i = 0; i < chunk.nRows; i++)
+    keys.at(i) = ColumnValue(key, m_Buffer.data() + i * key.width);
+  return true;
+}
+
+int ColumnarLogReader::ReadColumns(const std::vector<int>& columns, std::vector<std::vector<double> >& values,
+    const double& minKey, const double& maxKey)
+{
+  values.assign(columns.size(), std::vector<double>());
+  if(!m_bOpen)
+    return -1;
+  for(unsigned int j = 0; j < columns.size(); j++)
+  {
+    if(columns.at(j) < 0 || columns.at(j) >= (int)m_Columns.size() || m_Columns.at(columns.at(j)).type == COL_STRING)
+      return -1;
+  }
+
+  std::vector<double> keys;
+  int count = 0;
+  for(unsigned int c = 0; c < m_Index.size(); c++)
+  {
+    const ChunkInfo& chunk = m_Index.at(c);
+    if(chunk.maxKey < minKey || chunk.minKey > maxKey)
+      continue;
+    if(!ReadChunkKeys(chunk, keys))
+      return -1;
+    for(unsigned int j = 0; j < columns.size(); j++)
+    {
+      if(!ReadChunkColumn(chunk, columns.at(j)))
+        return -1;
+      const ColumnDefinition& column = m_Columns.at(columns.at(j));
+      for(uint32_t i = 0; i < chunk.nRows; i++)
+      {
+        if(keys.at(i) >= minKey && keys.at(i) <= maxKey)
+          values.at(j).push_back(ColumnValue(column, m_Buffer.data() + i * column.width));
+      }
+    }
+    for(uint32_t i = 0; i < chunk.nRows; i++)
+    {
+      if(keys.at(i) >= minKey && keys.at(i) <= maxKey)
+        count++;
+    }
+  }
+  return count;
+}
+
+int ColumnarLogReader::ReadStringColumn(const int& column, std::vector<std::string>& values, const double& minKey,
+    const double& maxKey)
+{
+  values.clear();
+  if(!m_bOpen || column < 0 || column >= (int)m_Columns.size() || m_Columns.at(column).type != COL_STRING)
+    return -1;
+
+  std::vector<double> keys;
+  const unsigned int width = m_Columns.at(column).width;
+  for(unsigned int c = 0; c < m_Index.size(); c++)
+  {
+    const ChunkInfo& chunk = m_Index.at(c);
+    if(chunk.maxKey < minKey || chunk.minKey > maxKey)
+      continue;
+    if(!ReadChunkKeys(chunk, keys) || !ReadChunkColumn(chunk, column))
+      return -1;
+    for(uint32_t i = 0; i < chunk.nRows; i++)
+    {
+      if(keys.at(i) < minKey || keys.at(i) > maxKey)
+        continue;
+      const char* p = m_Buffer.data() + i * width;
+      values.push_back(std::string(p, std::find(p, p + width, '\0')));
+    }
+  }
+  return values.size();
+}
+
+// reads the named columns of the typed logs, all of them must be there
+static int ReadNamedColumns(ColumnarLogReader& reader, const char* const* names, const unsigned int& nNames,
+    std::vector<std::vector<double> >& values, const double& minKey, const double& maxKey)
+{
+  std::vector<int> columns;
+  for(unsigned int i = 0; i < nNames; i++)
+  {
+    columns.push_back(reader.GetColumnIndex(names[i]));
+    if(columns.back() < 0)
+      return -1;
+  }
+  return reader.ReadColumns(columns, values, minKey, maxKey);
+}
+
+static const char* const GPS_COLUMNS[] = {"lat", "lon", "alt", "dir", "distance"};
+static const char* const LOCALIZATION_COLUMNS[] = {"t", "x", "y", "z", "a", "v"};
+static const char* const SIMULATION_COLUMNS[] = {"x", "y", "z", "a", "c", "v"};
+static const char* const OBJECTS_COLUMNS[] = {"frame", "id", "x", "y", "z", "a", "v", "w", "l", "h"};
+
+static std::vector<ColumnDefinition> DoubleColumns(const char* const* names, const unsigned int& nNames)
+{
+  std::vector<ColumnDefinition> columns;
+  for(unsigned int i = 0; i < nNames; i++)
+    columns.push_back(ColumnDefinition(names[i], COL_DOUBLE));
+  return columns;
+}
+
+bool ColumnarLog::WriteGPSData(const std::string& fileName, const std::vector<GPSDataReader::GPSBasicData>& data_list)
+{
+  ColumnarLogWriter writer(fileName, DoubleColumns(GPS_COLUMNS, 5));
+  for(unsigned int i = 0; i < data_list.size(); i++)
+  {
+    const GPSDataReader::GPSBasicData& d = data_list.at(i);
+    writer.SetValue(0, d.lat);
+    writer.SetValue(1, d.lon);
+    writer.SetValue(2, d.alt);
+    writer.SetValue(3, d.dir);
+    writer.SetValue(4, d.distance);
+    writer.EndRow();
+  }
+  return writer.Close();
+}
+
+int ColumnarLog::ReadGPSData(const std::string& fileName, std::vector<GPSDataReader::GPSBasicData>& data_list,
+    const double& minRow, const double& maxRow)
+{
+  data_list.clear();
+  ColumnarLogReader reader(fileName);
+  std::vector<std::vector<double> > v;
+  int count = ReadNamedColumns(reader, GPS_COLUMNS, 5, v, minRow, maxRow);
+  for(int i = 0; i < count; i++)
+  {
+    GPSDataReader::GPSBasicData d;
+    d.lat = v[0][i];
+    d.lon = v[1][i];
+    d.alt = v[2][i];
+    d.dir = v[3][i];
+    d.distance = v[4][i];
+    data_list.push_back(d);
+  }
+  return count;
+}
+
+bool ColumnarLog::WriteLocalizationPath(const std::string& fileName,
+    const std::vector<LocalizationPathReader::LocalizationWayPoint>& data_list)
+{
+  ColumnarLogWriter writer(fileName, DoubleColumns(LOCALIZATION_COLUMNS, 6), 0);
+  for(unsigned int i = 0; i < data_list.size(); i++)
+  {
+    const LocalizationPathReader::LocalizationWayPoint& d = data_list.at(i);
+    writer.SetValue(0, d.t);
+    writer.SetValue(1, d.x);
+    writer.SetValue(2, d.y);
+    writer.SetValue(3, d.z);
+    writer.SetValue(4, d.a);
+    writer.SetValue(5, d.v);
+    writer.EndRow();
+  }
+  return writer.Close();
+}
+
+int ColumnarLog::ReadLocalizationPath(const std::string& fileName,
+    std::vector<LocalizationPathReader::LocalizationWayPoint>& data_list, const double& minTime,
+    const double& maxTime)
+{
+  data_list.clear();
+  ColumnarLogReader reader(fileName);
+  std::vector<std::vector<double> > v;
+  int count = ReadNamedColumns(reader, LOCALIZATION_COLUMNS, 6, v, minTime, maxTime);
+  for(int i = 0; i < count; i++)
+  {
+    LocalizationPathReader::LocalizationWayPoint d;
+    d.t = v[0][i];
+    d.x = v[1][i];
+    d.y = v[2][i];
+    d.z = v[3][i];
+    d.a = v[4][i];
+    d.v = v[5][i];
+    data_list.push_back(d);
+  }
+  return count;
+}
+
+// start point, goal point then the cars, as the rows of the csv file
+bool ColumnarLog::WriteSimulationData(const std::string& fileName, const SimulationFileReader::SimulationData& data)
+{
+  std::vector<ColumnDefinition> columns = DoubleColumns(SIMULATION_COLUMNS, 6);
+  columns.push_back(ColumnDefinition("name", COL_STRING, SIMULATION_NAME_WIDTH));
+  ColumnarLogWriter writer(fileName, columns);
+  std::vector<SimulationFileReader::SimulationPoint> points;
+  points.push_back(data.startPoint);
+  points.push_back(data.goalPoint);
+  points.insert(points.end(), data.simuCars.begin(), data.simuCars.end());
+  for(unsigned int i = 0; i < points.size(); i++)
+  {
+    const SimulationFileReader::SimulationPoint& p = points.at(i);
+    writer.SetValue(0, p.x);
+    writer.SetValue(1, p.y);
+    writer.SetValue(2, p.z);
+    writer.SetValue(3, p.a);
+    writer.SetValue(4, p.c);
+    writer.SetValue(5, p.v);
+    writer.SetString(6, p.name);
+    writer.EndRow();
+  }
+  return writer.Close();
+}
+
+int ColumnarLog::ReadSimulationData(const std::string& fileName, SimulationFileReader::SimulationData& data)
+{
+  data.simuCars.clear();
+  ColumnarLogReader reader(fileName);
+  std::vector<std::vector<double> > v;
+  std::vector<std::string> names;
+  int count = ReadNamedColumns(reader, SIMULATION_COLUMNS, 6, v, -std::numeric_limits<double>::max(),
+      std::numeric_limits<double>::max());
+  if(count < 0 || reader.ReadStringColumn(reader.GetColumnIndex("name"), names) != count)
+    return -1;
+  for(int i = 0; i < count; i++)
+  {
+    SimulationFileReader::SimulationPoint p;
+    p.x = v[0][i];
+    p.y = v[1][i];
+    p.z = v[2][i];
+    p.a = v[3][i];
+    p.c = v[4][i];
+    p.v = v[5][i];
+    p.name = names.at(i);
+    if(i == 0)
+      data.startPoint = p;
+    else if(i == 1)
+      data.goalPoint = p;
+    else
+      data.simuCars.push_back(p);
+  }
+  return count;
+}
+
+bool ColumnarLog::WriteObjectsLog(const std::string& fileName,
+    const std::vector<ObjectsLogReader::ObjectRecord>& data_list)
+{
+  std::vector<ColumnDefinition> columns = DoubleColumns(OBJECTS_COLUMNS, 10);
+  columns.at(0).type = COL_INT32;
+  columns.at(1).type = COL_INT32;
+  ColumnarLogWriter writer(fileName, columns, 0);
+  for(unsigned int i = 0; i < data_list.size(); i++)
+  {
+    const ObjectsLogReader::ObjectRecord& d = data_list.at(i);
+    writer.SetValue(0, d.frame);
+    writer.SetValue(1, d.id);
+    writer.SetValue(2, d.x);
+    writer.SetValue(3, d.y);
+    writer.SetValue(4, d.z);
+    writer.SetValue(5, d.a);
+    writer.SetValue(6, d.v);
+    writer.SetValue(7, d.w);
+    writer.SetValue(8, d.l);
+    writer.SetValue(9, d.h);
+    writer.EndRow();
+  }
+  return writer.Close();
+}
+
+int ColumnarLog::ReadObjectsLog(const std::string& fileName, std::vector<ObjectsLogReader::ObjectRecord>& data_list,
+    const double& minFrame, const double& maxFrame)
+{
+  data_list.clear();
+  ColumnarLogReader reader(fileName);
+  std::vector<std::vector<double> > v;
+  int count = ReadNamedColumns(reader, OBJECTS_COLUMNS, 10, v, minFrame, maxFrame);
+  for(int i = 0; i < count; i++)
+  {
+    ObjectsLogReader::ObjectRecord d;
+    d.frame = v[0][i];
+    d.id = v[1][i];
+    d.x = v[2][i];
+    d.y = v[3][i];
+    d.z = v[4][i];
+    d.a = v[5][i];
+    d.v = v[6][i];
+    d.w = v[7][i];
+    d.l = v[8][i];
+    d.h = v[9][i];
+    data_list.push_back(d);
+  }
+  return count;
+}
+
+int ColumnarLog::ConvertGPSData(const std::string& csvFile, const std::string& fileName)
+{
+  GPSDataReader reader(csvFile);
+  std::vector<GPSDataReader::GPSBasicData> data_list;
+  reader.ReadAllData(data_list);
+  // the csv reader leaves dir as it is
+  for(unsigned int i = 0; i < data_list.size(); i++)
+    data_list.at(i).dir = 0;
+  return WriteGPSData(fileName, data_list) ? data_list.size() : -1;
+}
+
+int ColumnarLog::ConvertLocalizationPath(const std::string& csvFile, const char& separator,
+    const std::string& fileName)
+{
+  LocalizationPathReader reader(csvFile, separator);
+  std::vector<LocalizationPathReader::LocalizationWayPoint> data_list;
+  reader.ReadAllData(data_list);
+  for(unsigned int i = 0; i < data_list.size(); i++)
+    data_list.at(i).t = i;
+  return WriteLocalizationPath(fileName, data_list) ? data_list.size() : -1;
+}
+
+int ColumnarLog::ConvertSimulationData(const std::string& csvFile, const std::string& fileName)
+{
+  SimulationFileReader reader(csvFile);
+  SimulationFileReader::SimulationData data;
+  int count = reader.ReadAllData(data);
+  if(count < 2)
+    return -1;
+  return WriteSimulationData(fileName, data) ? count : -1;
+}
+
+int ColumnarLog::ConvertObjectsLog(const std::string& csvFile, const std::string& fileName)
+{
+  ObjectsLogReader reader(csvFile);
+  std::vector<ObjectsLogReader::ObjectRecord> data_list;
+  reader.ReadAllData(data_list);
+  return WriteObjectsLog(fileName, data_list) ? data_list.size() : -1;
+}
+
+} /* namespace UtilityHNS */
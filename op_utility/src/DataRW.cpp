@@ -6,6 +6,7 @@
 
 #include "op_utility/DataRW.h"
 #include <stdlib.h>
+#include <string.h>
 #include <tinyxml.h>
 #include <sys/stat.h>
 #include "op_utility/UtilityH.h"
@@ -215,70 +216,113 @@ SimpleReaderBase::SimpleReaderBase(const string& fileName, const int& nHeaders,c
       const int& iDataTitles, const int& nVariablesForOneObject ,
       const int& nLineHeaders, const string& headerRepeatKey)
 {
+  m_iNextLine = 0;
+  m_nHeders = nHeaders;
+  m_iDataTitles = iDataTitles;
+  m_nVarPerObj = nVariablesForOneObject;
+  m_HeaderRepeatKey = headerRepeatKey;
+  m_nLineHeaders = nLineHeaders;
+  m_Separator = separator;
+
   if(fileName.compare("d") != 0)
   {
-    m_pFile = new ifstream(fileName.c_str(), ios::in);
-    if(!m_pFile->is_open())
+    //the whole file is read at once, lines and fields are then split in place
+    ifstream file(fileName.c_str(), ios::in | ios::binary);
+    if(!file.is_open())
     {
       printf("\n Can't Open Map File !, %s", fileName.c_str());
       return;
     }
 
-  m_nHeders = nHeaders;
-  m_iDataTitles = iDataTitles;
-  m_nVarPerObj = nVariablesForOneObject;
-  m_HeaderRepeatKey = headerRepeatKey;
-  m_nLineHeaders = nLineHeaders;
-  m_Separator = separator;
-  m_pFile->precision(16);
+    file.seekg(0, ios::end);
+    streamoff size = file.tellg();
+    file.seekg(0, ios::beg);
+    if(size > 0)
+    {
+      m_Buffer.resize(size + 1);
+      file.read(m_Buffer.data(), size);
+      m_Buffer.resize(file.gcount() + 1);
+      m_Buffer.back() = 0;
+    }
 
-  ReadHeaders();
+    ReadHeaders();
   }
 }
 
 SimpleReaderBase::~SimpleReaderBase()
 {
-  if(m_pFile->is_open())
-    m_pFile->close();
 }
 
-bool SimpleReaderBase::ReadSingleLine(vector<vector<string> >& line)
+bool SimpleReaderBase::GetNextLine(char*& pLine, unsigned int& length)
 {
-  if(!m_pFile->is_open() || m_pFile->eof()) return false;
+  if(m_Buffer.size() == 0 || m_iNextLine >= m_Buffer.size() - 1) return false;
 
-  string strLine, innerToken;
+  pLine = &m_Buffer.at(m_iNextLine);
+  unsigned int remaining = m_Buffer.size() - 1 - m_iNextLine;
+  char* pEnd = (char*)memchr(pLine, '\n', remaining);
+  if(pEnd == nullptr)
+    pEnd = pLine + remaining;
+
+  *pEnd = 0;
+  length = pEnd - pLine;
+  m_iNextLine += length + 1;
+  return true;
+}
+
+bool SimpleReaderBase::ReadLineFields()
+{
+  char* pLine = nullptr;
+  unsigned int length = 0;
+  m_Fields.clear();
+  if(!GetNextLine(pLine, length)) return false;
+
+  //same fields as getline with the separator, an empty last field is dropped
+  const char* pField = pLine;
+  for(unsigned int i = 0; i < length; i++)
+  {
+    if(pLine[i] == m_Separator)
+    {
+      pLine[i] = 0;
+      m_Fields.push_back(pField);
+      pField = pLine + i + 1;
+    }
+  }
+
+  if(pField < pLine + length)
+    m_Fields.push_back(pField);
+
+  return true;
+}
+
+bool SimpleReaderBase::ReadSingleLine(vector<vector<string> >& line)
+{
   line.clear();
-  getline(*m_pFile, strLine);
-  istringstream str_stream(strLine);
+  if(!ReadLineFields()) return false;
 
   vector<string> header;
   vector<string> obj_part;
 
   if(m_nVarPerObj == 0)
   {
-    while(getline(str_stream, innerToken, m_Separator))
-    {
-      obj_part.push_back(innerToken);
-    }
-
+    obj_part.insert(obj_part.end(), m_Fields.begin(), m_Fields.end());
     line.push_back(obj_part);
     return true;
   }
   else
   {
-    int iCounter = 0;
-    while(iCounter < m_nLineHeaders && getline(str_stream, innerToken, m_Separator))
+    unsigned int iField = 0;
+    while((int)header.size() < m_nLineHeaders && iField < m_Fields.size())
     {
-      header.push_back(innerToken);
-      iCounter++;
+      header.push_back(m_Fields.at(iField));
+      iField++;
     }
     obj_part.insert(obj_part.begin(), header.begin(), header.end());
 
-    iCounter = 1;
+    int iCounter = 1;
 
-    while(getline(str_stream, innerToken, m_Separator))
+    for(; iField < m_Fields.size(); iField++)
     {
-      obj_part.push_back(innerToken);
+      obj_part.push_back(m_Fields.at(iField));
       if(iCounter == m_nVarPerObj)
       {
         line.push_back(obj_part);
@@ -297,13 +341,10 @@ bool SimpleReaderBase::ReadSingleLine(vector<vector<string> >& line)
 
 int SimpleReaderBase::ReadAllData()
 {
-  if(!m_pFile->is_open()) return 0;
-
   m_AllData.clear();
   vector<vector<string> > singleLine;
-  while(!m_pFile->eof())
+  while(ReadSingleLine(singleLine))
   {
-    ReadSingleLine(singleLine);
     m_AllData.push_back(singleLine);
   }
 
@@ -312,14 +353,13 @@ int SimpleReaderBase::ReadAllData()
 
 void SimpleReaderBase::ReadHeaders()
 {
-  if(!m_pFile->is_open()) return;
-
-  string strLine;
+  char* pLine = nullptr;
+  unsigned int length = 0;
   int iCounter = 0;
   m_RawHeaders.clear();
-  while(!m_pFile->eof() && iCounter < m_nHeders)
+  while(iCounter < m_nHeders && GetNextLine(pLine, length))
   {
-    getline(*m_pFile, strLine);
+    string strLine(pLine, length);
     m_RawHeaders.push_back(strLine);
     if(iCounter == m_iDataTitles)
       ParseDataTitles(strLine);
@@ -454,37 +494,62 @@ int LocalizationPathReader::ReadAllData(vector<LocalizationWayPoint>& data_list)
   return count;
 }
 
+bool ObjectsLogReader::ReadNextLine(ObjectRecord& data)
+{
+  if(ReadLineFields())
+  {
+    if(m_Fields.size() < 10) return false;
+
+    data.frame = strtol(m_Fields.at(0), NULL, 10);
+    data.id = strtol(m_Fields.at(1), NULL, 10);
+    data.x = strtod(m_Fields.at(2), NULL);
+    data.y = strtod(m_Fields.at(3), NULL);
+    data.z = strtod(m_Fields.at(4), NULL);
+    data.a = strtod(m_Fields.at(5), NULL);
+    data.v = strtod(m_Fields.at(6), NULL);
+    data.w = strtod(m_Fields.at(7), NULL);
+    data.l = strtod(m_Fields.at(8), NULL);
+    data.h = strtod(m_Fields.at(9), NULL);
+
+    return true;
+  }
+  else
+    return false;
+}
+
+int ObjectsLogReader::ReadAllData(vector<ObjectRecord>& data_list)
+{
+  data_list.clear();
+  ObjectRecord data;
+  int count = 0;
+  while(ReadNextLine(data))
+  {
+    data_list.push_back(data);
+    count++;
+  }
+  return count;
+}
+
 //Nodes
 
 AisanNodesFileReader::AisanNodesFileReader(const vector_map_msgs::NodeArray& _nodes) : SimpleReaderBase("d", 1)
 {
   if(_nodes.data.size()==0) return;
 
-  m_min_id = std::numeric_limits<int>::max();
-
   //TODO Fix PID and NID problem
 
   m_data_list.clear();
+  m_data_list.reserve(_nodes.data.size());
   AisanNode data;
-  int max_id = std::numeric_limits<int>::min();
 
   for(unsigned int i=0; i < _nodes.data.size(); i++)
   {
     ParseNextLine(_nodes.data.at(i), data);
 
     m_data_list.push_back(data);
-    if(data.NID < m_min_id)
-      m_min_id = data.NID;
-
-    if(data.NID > max_id)
-      max_id = data.NID;
   }
 
-  m_data_map.resize(max_id-m_min_id+2);
-  for(unsigned int i=0; i < m_data_list.size(); i++)
-  {
-    m_data_map.at(m_data_list.at(i).NID-m_min_id) = &m_data_list.at(i);
-  }
+  m_data_index.Build(m_data_list, &AisanNode::NID);
 }
 
 void AisanNodesFileReader::ParseNextLine(const vector_map_msgs::Node& _rec, AisanNode& data)
@@ -495,37 +560,17 @@ void AisanNodesFileReader::ParseNextLine(const vector_map_msgs::Node& _rec, Aisa
 
 AisanNodesFileReader::AisanNode* AisanNodesFileReader::GetDataRowById(int _nid)
 {
-  if(m_data_map.size()==0) return nullptr;
-
-  int index = _nid-m_min_id;
-  if(index >= 0 && index < m_data_map.size())
-  {
-    return m_data_map.at(index);
-  }
-  else
-  {
-    for(unsigned int i=0; i < m_data_list.size(); i++)
-    {
-      if(m_data_list.at(i).NID == _nid)
-      {
-        return &m_data_list.at(i);
-      }
-    }
-  }
-
-  return nullptr;
+  return m_data_index.GetDataRowById(_nid);
 }
 
 bool AisanNodesFileReader::ReadNextLine(AisanNode& data)
 {
-  vector<vector<string> > lineData;
-  if(ReadSingleLine(lineData))
+  if(ReadLineFields())
   {
-    if(lineData.size()==0) return false;
-    if(lineData.at(0).size() < 2) return false;
+    if(m_Fields.size() < 2) return false;
 
-    data.NID = strtol(lineData.at(0).at(0).c_str(), NULL, 10);
-    data.PID = strtol(lineData.at(0).at(1).c_str(), NULL, 10);
+    data.NID = strtol(m_Fields.at(0), NULL, 10);
+    data.PID = strtol(m_Fields.at(1), NULL, 10);
 
     return true;
 
@@ -538,23 +583,12 @@ int AisanNodesFileReader::ReadAllData(vector<AisanNode>& data_list)
 {
   m_data_list.clear();
   AisanNode data;
-  //double logTime = 0;
-  int max_id = std::numeric_limits<int>::min();
   while(ReadNextLine(data))
   {
     m_data_list.push_back(data);
-    if(data.NID < m_min_id)
-      m_min_id = data.NID;
-
-    if(data.NID > max_id)
-      max_id = data.NID;
   }
 
-  m_data_map.resize(max_id - m_min_id + 2);
-  for(unsigned int i=0; i < m_data_list.size(); i++)
-  {
-    m_data_map.at(m_data_list.at(i).NID-m_min_id) = &m_data_list.at(i);
-  }
+  m_data_index.Build(m_data_list, &AisanNode::NID);
 
   data_list = m_data_list;
   return m_data_list.size();
@@ -566,29 +600,18 @@ AisanPointsFileReader::AisanPointsFileReader(const vector_map_msgs::PointArray&
 {
   if(_points.data.size()==0) return;
 
-  m_min_id = std::numeric_limits<int>::max();
-
   m_data_list.clear();
+  m_data_list.reserve(_points.data.size());
   AisanPoints data;
-  int max_id = std::numeric_limits<int>::min();
 
   for(unsigned int i=0; i < _points.data.size(); i++)
   {
     ParseNextLine(_points.data.at(i), data);
 
     m_data_list.push_back(data);
-    if(data.PID < m_min_id)
-      m_min_id = data.PID;
-
-    if(data.PID > max_id)
-      max_id = data.PID;
   }
 
-  m_data_map.resize(max_id-m_min_id+2);
-  for(unsigned int i=0; i < m_data_list.size(); i++)
-  {
-    m_data_map.at(m_data_list.at(i).PID-m_min_id) = &m_data_list.at(i);
-  }
+  m_data_index.Build(m_data_list, &AisanPoints::PID);
 }
 
 void AisanPointsFileReader::ParseNextLine(const vector_map_msgs::Point& _rec, AisanPoints& data)
@@ -607,46 +630,26 @@ void AisanPointsFileReader::ParseNextLine(const vector_map_msgs::Point& _rec, Ai
 
 AisanPointsFileReader::AisanPoints* AisanPointsFileReader::GetDataRowById(int _pid)
 {
-  if(m_data_map.size()==0) return nullptr;
-
-  int index = _pid-m_min_id;
-  if(index >= 0 && index < m_data_map.size())
-  {
-    return m_data_map.at(index);
-  }
-  else
-  {
-    for(unsigned int i=0; i < m_data_list.size(); i++)
-    {
-      if(m_data_list.at(i).PID == _pid)
-      {
-        return &m_data_list.at(i);
-      }
-    }
-  }
-
-  return nullptr;
+  return m_data_index.GetDataRowById(_pid);
 }
 
 bool AisanPointsFileReader::ReadNextLine(AisanPoints& data)
 {
-  vector<vector<string> > lineData;
-  if(ReadSingleLine(lineData))
+  if(ReadLineFields())
   {
-    if(lineData.size()==0) return false;
-    if(lineData.at(0).size() < 10) return false;
+    if(m_Fields.size() < 10) return false;
 
-    data.PID = strtol(lineData.at(0).at(0).c_str(), NULL, 10);
-    data.B = strtod(lineData.at(0)[1].c_str(), NULL);
-    data.L = strtod(lineData.at(0)[2].c_str(), NULL);
-    data.H = strtod(lineData.at(0)[3].c_str(), NULL);
+    data.PID = strtol(m_Fields.at(0), NULL, 10);
+    data.B = strtod(m_Fields.at(1), NULL);
+    data.L = strtod(m_Fields.at(2), NULL);
+    data.H = strtod(m_Fields.at(3), NULL);
 
-    data.Bx = strtod(lineData.at(0)[4].c_str(), NULL);
-    data.Ly = strtod(lineData.at(0)[5].c_str(), NULL);
-    data.Ref = strtol(lineData.at(0).at(6).c_str(), NULL, 10);
-    data.MCODE1 = strtol(lineData.at(0).at(7).c_str(), NULL, 10);
-    data.MCODE2 = strtol(lineData.at(0).at(8).c_str(), NULL, 10);
-    data.MCODE3 = strtol(lineData.at(0).at(9).c_str(), NULL, 10);
+    data.Bx = strtod(m_Fields.at(4), NULL);
+    data.Ly = strtod(m_Fields.at(5), NULL);
+    data.Ref = strtol(m_Fields.at(6), NULL, 10);
+    data.MCODE1 = strtol(m_Fields.at(7), NULL, 10);
+    data.MCODE2 = strtol(m_Fields.at(8), NULL, 10);
+    data.MCODE3 = strtol(m_Fields.at(9), NULL, 10);
 
     return true;
 
@@ -659,23 +662,12 @@ int AisanPointsFileReader::ReadAllData(vector<AisanPoints>& data_list)
 {
   m_data_list.clear();
   AisanPoints data;
-  //double logTime = 0;
-  int max_id = std::numeric_limits<int>::min();
   while(ReadNextLine(data))
   {
     m_data_list.push_back(data);
-    if(data.PID < m_min_id)
-      m_min_id = data.PID;
-
-    if(data.PID > max_id)
-      max_id = data.PID;
   }
 
-  m_data_map.resize(max_id-m_min_id+2);
-  for(unsigned int i=0; i < m_data_list.size(); i++)
-  {
-    m_data_map.at(m_data_list.at(i).PID-m_min_id) = &m_data_list.at(i);
-  }
+  m_data_index.Build(m_data_list, &AisanPoints::PID);
 
   data_list = m_data_list;
   return m_data_list.size();
@@ -687,29 +679,18 @@ AisanLinesFileReader::AisanLinesFileReader(const vector_map_msgs::LineArray& _no
 {
   if(_nodes.data.size()==0) return;
 
-  m_min_id = std::numeric_limits<int>::max();
-
   m_data_list.clear();
+  m_data_list.reserve(_nodes.data.size());
   AisanLine data;
-  int max_id = std::numeric_limits<int>::min();
 
   for(unsigned int i=0; i < _nodes.data.size(); i++)
   {
     ParseNextLine(_nodes.data.at(i), data);
 
     m_data_list.push_back(data);
-    if(data.LID < m_min_id)
-      m_min_id = data.LID;
-
-    if(data.LID > max_id)
-      max_id = data.LID;
   }
 
-  m_data_map.resize(max_id-m_min_id+2);
-  for(unsigned int i=0; i < m_data_list.size(); i++)
-  {
-    m_data_map.at(m_data_list.at(i).LID-m_min_id) = &m_data_list.at(i);
-  }
+  m_data_index.Build(m_data_list, &AisanLine::LID);
 }
 
 void AisanLinesFileReader::ParseNextLine(const vector_map_msgs::Line& _rec, AisanLine& data)
@@ -723,40 +704,20 @@ void AisanLinesFileReader::ParseNextLine(const vector_map_msgs::Line& _rec, Aisa
 
 AisanLinesFileReader::AisanLine* AisanLinesFileReader::GetDataRowById(int _lid)
 {
-  if(m_data_map.size()==0) return nullptr;
-
-  int index = _lid-m_min_id;
-  if(index >= 0 && index < m_data_map.size())
-  {
-    return m_data_map.at(index);
-  }
-  else
-  {
-    for(unsigned int i=0; i < m_data_list.size(); i++)
-    {
-      if(m_data_list.at(i).LID == _lid)
-      {
-        return &m_data_list.at(i);
-      }
-    }
-  }
-
-  return nullptr;
+  return m_data_index.GetDataRowById(_lid);
 }
 
 bool AisanLinesFileReader::ReadNextLine(AisanLine& data)
 {
-  vector<vector<string> > lineData;
-  if(ReadSingleLine(lineData))
+  if(ReadLineFields())
   {
-    if(lineData.size()==0) return false;
-    if(lineData.at(0).size() < 5) return false;
+    if(m_Fields.size() < 5) return false;
 
-    data.LID = strtol(lineData.at(0).at(0).c_str(), NULL, 10);
-    data.BPID = strtol(lineData.at(0).at(1).c_str(), NULL, 10);
-    data.FPID = strtol(lineData.at(0).at(2).c_str(), NULL, 10);
-    data.BLID = strtol(lineData.at(0).at(3).c_str(), NULL, 10);
-    data.FLID = strtol(lineData.at(0).at(4).c_str(), NULL, 10);
+    data.LID = strtol(m_Fields.at(0), NULL, 10);
+    data.BPID = strtol(m_Fields.at(1), NULL, 10);
+    data.FPID = strtol(m_Fields.at(2), NULL, 10);
+    data.BLID = strtol(m_Fields.at(3), NULL, 10);
+    data.FLID = strtol(m_Fields.at(4), NULL, 10);
 
     return true;
   }
@@ -766,26 +727,14 @@ bool AisanLinesFileReader::ReadNextLine(AisanLine& data)
 
 int AisanLinesFileReader::ReadAllData(vector<AisanLine>& data_list)
 {
-  data_list.clear();
+  m_data_list.clear();
   AisanLine data;
-  //double logTime = 0;
-
-  int max_id = std::numeric_limits<int>::min();
   while(ReadNextLine(data))
   {
     m_data_list.push_back(data);
-    if(data.LID < m_min_id)
-      m_min_id = data.LID;
-
-    if(data.LID > max_id)
-      max_id = data.LID;
   }
 
-  m_data_map.resize(max_id - m_min_id + 2);
-  for(unsigned int i=0; i < m_data_list.size(); i++)
-  {
-    m_data_map.at(m_data_list.at(i).LID-m_min_id) = &m_data_list.at(i);
-  }
+  m_data_index.Build(m_data_list, &AisanLine::LID);
 
   data_list = m_data_list;
   return m_data_list.size();
@@ -797,29 +746,18 @@ AisanCenterLinesFileReader::AisanCenterLinesFileReader(const vector_map_msgs::DT
 {
   if(_Lines.data.size()==0) return;
 
-  m_min_id = std::numeric_limits<int>::max();
-
   m_data_list.clear();
+  m_data_list.reserve(_Lines.data.size());
   AisanCenterLine data;
-  int max_id = std::numeric_limits<int>::min();
 
   for(unsigned int i=0; i < _Lines.data.size(); i++)
   {
     ParseNextLine(_Lines.data.at(i), data);
 
     m_data_list.push_back(data);
-    if(data.DID < m_min_id)
-      m_min_id = data.DID;
-
-    if(data.DID > max_id)
-      max_id = data.DID;
   }
 
-  m_data_map.resize(max_id-m_min_id+2);
-  for(unsigned int i=0; i < m_data_list.size(); i++)
-  {
-    m_data_map.at(m_data_list.at(i).DID-m_min_id) = &m_data_list.at(i);
-  }
+  m_data_index.Build(m_data_list, &AisanCenterLine::DID);
 }
 
 void AisanCenterLinesFileReader::ParseNextLine(const vector_map_msgs::DTLane& _rec, AisanCenterLine& data)
@@ -838,46 +776,26 @@ void AisanCenterLinesFileReader::ParseNextLine(const vector_map_msgs::DTLane& _r
 
 AisanCenterLinesFileReader::AisanCenterLine* AisanCenterLinesFileReader::GetDataRowById(int _did)
 {
-  if(m_data_map.size()==0) return nullptr;
-
-  int index = _did-m_min_id;
-  if(index >= 0 && index < m_data_map.size())
-  {
-    return m_data_map.at(index);
-  }
-  else
-  {
-    for(unsigned int i=0; i < m_data_list.size(); i++)
-    {
-      if(m_data_list.at(i).DID == _did)
-      {
-        return &m_data_list.at(i);
-      }
-    }
-  }
-
-  return nullptr;
+  return m_data_index.GetDataRowById(_did);
 }
 
 bool AisanCenterLinesFileReader::ReadNextLine(AisanCenterLine& data)
 {
-  vector<vector<string> > lineData;
-  if(ReadSingleLine(lineData))
+  if(ReadLineFields())
   {
-    if(lineData.size()==0) return false;
-    if(lineData.at(0).size() < 10) return false;
+    if(m_Fields.size() < 10) return false;
 
-    data.DID   = strtol(lineData.at(0).at(0).c_str(), NULL, 10);
-    data.Dist   = strtol(lineData.at(0).at(1).c_str(), NULL, 10);
-    data.PID   = strtol(lineData.at(0).at(2).c_str(), NULL, 10);
+    data.DID   = strtol(m_Fields.at(0), NULL, 10);
+    data.Dist   = strtol(m_Fields.at(1), NULL, 10);
+    data.PID   = strtol(m_Fields.at(2), NULL, 10);
 
-    data.Dir   = strtod(lineData.at(0)[3].c_str(), NULL);
-    data.Apara   = strtod(lineData.at(0)[4].c_str(), NULL);
-    data.r     = strtod(lineData.at(0)[5].c_str(), NULL);
-    data.slope   = strtod(lineData.at(0)[6].c_str(), NULL);
-    data.cant   = strtod(lineData.at(0)[7].c_str(), NULL);
-    data.LW   = strtod(lineData.at(0)[8].c_str(), NULL);
-    data.RW   = strtod(lineData.at(0)[9].c_str(), NULL);
+    data.Dir   = strtod(m_Fields.at(3), NULL);
+    data.Apara   = strtod(m_Fields.at(4), NULL);
+    data.r     = strtod(m_Fields.at(5), NULL);
+    data.slope   = strtod(m_Fields.at(6), NULL);
+    data.cant   = strtod(m_Fields.at(7), NULL);
+    data.LW   = strtod(m_Fields.at(8), NULL);
+    data.RW   = strtod(m_Fields.at(9), NULL);
 
     return true;
   }
@@ -887,16 +805,17 @@ bool AisanCenterLinesFileReader::ReadNextLine(AisanCenterLine& data)
 
 int AisanCenterLinesFileReader::ReadAllData(vector<AisanCenterLine>& data_list)
 {
-  data_list.clear();
+  m_data_list.clear();
   AisanCenterLine data;
-  //double logTime = 0;
-  int count = 0;
   while(ReadNextLine(data))
   {
-    data_list.push_back(data);
-    count++;
+    m_data_list.push_back(data);
   }
-  return count;
+
+  m_data_index.Build(m_data_list, &AisanCenterLine::DID);
+
+  data_list = m_data_list;
+  return m_data_list.size();
 }
 
 //Lane
@@ -905,29 +824,18 @@ AisanLanesFileReader::AisanLanesFileReader(const vector_map_msgs::LaneArray& _la
 {
   if(_lanes.data.size()==0) return;
 
-  m_min_id = std::numeric_limits<int>::max();
-
   m_data_list.clear();
+  m_data_list.reserve(_lanes.data.size());
   AisanLane data;
-  int max_id = std::numeric_limits<int>::min();
 
   for(unsigned int i=0; i < _lanes.data.size(); i++)
   {
     ParseNextLine(_lanes.data.at(i), data);
 
     m_data_list.push_back(data);
-    if(data.LnID < m_min_id)
-      m_min_id = data.LnID;
-
-    if(data.LnID > max_id)
-      max_id = data.LnID;
   }
 
-  m_data_map.resize(max_id-m_min_id+2);
-  for(unsigned int i=0; i < m_data_list.size(); i++)
-  {
-    m_data_map.at(m_data_list.at(i).LnID-m_min_id) = &m_data_list.at(i);
-  }
+  m_data_index.Build(m_data_list, &AisanLane::LnID);
 }
 
 void AisanLanesFileReader::ParseNextLine(const vector_map_msgs::Lane& _rec, AisanLane& data)
@@ -965,67 +873,47 @@ void AisanLanesFileReader::ParseNextLine(const vector_map_msgs::Lane& _rec, Aisa
 
 AisanLanesFileReader::AisanLane* AisanLanesFileReader::GetDataRowById(int _lnid)
 {
-  if(m_data_map.size()==0) return nullptr;
-
-  int index = _lnid-m_min_id;
-  if(index >= 0 && index < m_data_map.size())
-  {
-    return m_data_map.at(index);
-  }
-  else
-  {
-    for(unsigned int i=0; i < m_data_list.size(); i++)
-    {
-      if(m_data_list.at(i).LnID == _lnid)
-      {
-        return &m_data_list.at(i);
-      }
-    }
-  }
-
-  return nullptr;
+  return m_data_index.GetDataRowById(_lnid);
 }
 
 bool AisanLanesFileReader::ReadNextLine(AisanLane& data)
 {
-  vector<vector<string> > lineData;
-  if(ReadSingleLine(lineData))
+  if(ReadLineFields())
   {
-    if(lineData.size() == 0) return false;
-    if(lineData.at(0).size() < 17) return false;
-
-    data.LnID    = strtol(lineData.at(0).at(0).c_str(), NULL, 10);
-    data.DID    = strtol(lineData.at(0).at(1).c_str(), NULL, 10);
-    data.BLID    = strtol(lineData.at(0).at(2).c_str(), NULL, 10);
-    data.FLID    = strtol(lineData.at(0).at(3).c_str(), NULL, 10);
-    data.BNID     = strtol(lineData.at(0).at(4).c_str(), NULL, 10);
-    data.FNID    = strtol(lineData.at(0).at(5).c_str(), NULL, 10);
-    data.JCT    = strtol(lineData.at(0).at(6).c_str(), NULL, 10);
-    data.BLID2     = strtol(lineData.at(0).at(7).c_str(), NULL, 10);
-    data.BLID3    = strtol(lineData.at(0).at(8).c_str(), NULL, 10);
-    data.BLID4    = strtol(lineData.at(0).at(9).c_str(), NULL, 10);
-    data.FLID2     = strtol(lineData.at(0).at(10).c_str(), NULL, 10);
-    data.FLID3    = strtol(lineData.at(0).at(11).c_str(), NULL, 10);
-    data.FLID4    = strtol(lineData.at(0).at(12).c_str(), NULL, 10);
-    data.ClossID   = strtol(lineData.at(0).at(13).c_str(), NULL, 10);
-    data.Span     = strtod(lineData.at(0).at(14).c_str(), NULL);
-    data.LCnt     = strtol(lineData.at(0).at(15).c_str(), NULL, 10);
-    data.Lno      = strtol(lineData.at(0).at(16).c_str(), NULL, 10);
-
-
-    if(lineData.at(0).size() < 23) return true;
-
-    data.LaneType  = strtol(lineData.at(0).at(17).c_str(), NULL, 10);
-    data.LimitVel  = strtol(lineData.at(0).at(18).c_str(), NULL, 10);
-    data.RefVel     = strtol(lineData.at(0).at(19).c_str(), NULL, 10);
-    data.RoadSecID  = strtol(lineData.at(0).at(20).c_str(), NULL, 10);
-    data.LaneChgFG   = strtol(lineData.at(0).at(21).c_str(), NULL, 10);
-    data.LinkWAID  = strtol(lineData.at(0).at(22).c_str(), NULL, 10);
-
-
-    if(lineData.at(0).size() > 23)
+    if(m_Fields.size() < 17) return false;
+
+    data.LnID    = strtol(m_Fields.at(0), NULL, 10);
+    data.DID    = strtol(m_Fields.at(1), NULL, 10);
+    data.BLID    = strtol(m_Fields.at(2), NULL, 10);
+    data.FLID    = strtol(m_Fields.at(3), NULL, 10);
+    data.BNID     = strtol(m_Fields.at(4), NULL, 10);
+    data.FNID    = strtol(m_Fields.at(5), NULL, 10);
+    data.JCT    = strtol(m_Fields.at(6), NULL, 10);
+    data.BLID2     = strtol(m_Fields.at(7), NULL, 10);
+    data.BLID3    = strtol(m_Fields.at(8), NULL, 10);
+    data.BLID4    = strtol(m_Fields.at(9), NULL, 10);
+    data.FLID2     = strtol(m_Fields.at(10), NULL, 10);
+    data.FLID3    = strtol(m_Fields.at(11), NULL, 10);
+    data.FLID4    = strtol(m_Fields.at(12), NULL, 10);
+    data.ClossID   = strtol(m_Fields.at(13), NULL, 10);
+    data.Span     = strtod(m_Fields.at(14), NULL);
+    data.LCnt     = strtol(m_Fields.at(15), NULL, 10);
+    data.Lno      = strtol(m_Fields.at(16), NULL, 10);
+
+
+    if(m_Fields.size() < 23) return true;
+
+    data.LaneType  = strtol(m_Fields.at(17), NULL, 10);
+    data.LimitVel  = strtol(m_Fields.at(18), NULL, 10);
+    data.RefVel     = strtol(m_Fields.at(19), NULL, 10);
+    data.RoadSecID  = strtol(m_Fields.at(20), NULL, 10);
+    data.LaneChgFG   = strtol(m_Fields.at(21), NULL, 10);
+    data.LinkWAID  = strtol(m_Fields.at(22), NULL, 10);
+
+
+    if(m_Fields.size() > 23)
     {
-      string str_dir = lineData.at(0).at(23);
+      string str_dir = m_Fields.at(23);
       if(str_dir.size() > 0)
         data.LaneDir   = str_dir.at(0);
       else
@@ -1034,8 +922,8 @@ bool AisanLanesFileReader::ReadNextLine(AisanLane& data)
 
 //    data.LeftLaneId  = 0;
 //    data.RightLaneId = 0;
-//    data.LeftLaneId   = strtol(lineData.at(0).at(24).c_str(), NULL, 10);
-//    data.RightLaneId   = strtol(lineData.at(0).at(25).c_str(), NULL, 10);
+//    data.LeftLaneId   = strtol(m_Fields.at(24), NULL, 10);
+//    data.RightLaneId   = strtol(m_Fields.at(25), NULL, 10);
 
 
     return true;
@@ -1046,29 +934,16 @@ bool AisanLanesFileReader::ReadNextLine(AisanLane& data)
 
 int AisanLanesFileReader::ReadAllData(vector<AisanLane>& data_list)
 {
-  data_list.clear();
+  m_data_list.clear();
   AisanLane data;
-  //double logTime = 0;
-  int max_id = std::numeric_limits<int>::min();
-
   while(ReadNextLine(data))
   {
     m_data_list.push_back(data);
-    if(data.LnID < m_min_id)
-      m_min_id = data.LnID;
-
-    if(data.LnID > max_id)
-      max_id = data.LnID;
   }
 
-  m_data_map.resize(max_id-m_min_id+2);
-  for(unsigned int i=0; i < m_data_list.size(); i++)
-  {
-    m_data_map.at(m_data_list.at(i).LnID-m_min_id) = &m_data_list.at(i);
-  }
+  m_data_index.Build(m_data_list, &AisanLane::LnID);
 
   data_list = m_data_list;
-
   return m_data_list.size();
 }
 
@@ -1078,29 +953,18 @@ AisanAreasFileReader::AisanAreasFileReader(const vector_map_msgs::AreaArray& _ar
 {
   if(_areas.data.size()==0) return;
 
-  m_min_id = std::numeric_limits<int>::max();
-
   m_data_list.clear();
+  m_data_list.reserve(_areas.data.size());
   AisanArea data;
-  int max_id = std::numeric_limits<int>::min();
 
   for(unsigned int i=0; i < _areas.data.size(); i++)
   {
     ParseNextLine(_areas.data.at(i), data);
 
     m_data_list.push_back(data);
-    if(data.AID < m_min_id)
-      m_min_id = data.AID;
-
-    if(data.AID > max_id)
-      max_id = data.AID;
   }
 
-  m_data_map.resize(max_id-m_min_id+2);
-  for(unsigned int i=0; i < m_data_list.size(); i++)
-  {
-    m_data_map.at(m_data_list.at(i).AID-m_min_id) = &m_data_list.at(i);
-  }
+  m_data_index.Build(m_data_list, &AisanArea::AID);
 }
 
 void AisanAreasFileReader::ParseNextLine(const vector_map_msgs::Area& _rec, AisanArea& data)
@@ -1112,38 +976,18 @@ void AisanAreasFileReader::ParseNextLine(const vector_map_msgs::Area& _rec, Aisa
 
 AisanAreasFileReader::AisanArea* AisanAreasFileReader::GetDataRowById(int _aid)
 {
-  if(m_data_map.size()==0) return nullptr;
-
-  int index = _aid-m_min_id;
-  if(index >= 0 && index < m_data_map.size())
-  {
-    return m_data_map.at(index);
-  }
-  else
-  {
-    for(unsigned int i=0; i < m_data_list.size(); i++)
-    {
-      if(m_data_list.at(i).AID == _aid)
-      {
-        return &m_data_list.at(i);
-      }
-    }
-  }
-
-  return nullptr;
+  return m_data_index.GetDataRowById(_aid);
 }
 
 bool AisanAreasFileReader::ReadNextLine(AisanArea& data)
 {
-  vector<vector<string> > lineData;
-  if(ReadSingleLine(lineData))
+  if(ReadLineFields())
   {
-    if(lineData.size()==0) return false;
-    if(lineData.at(0).size() < 3) return false;
+    if(m_Fields.size() < 3) return false;
 
-    data.AID = strtol(lineData.at(0).at(0).c_str(), NULL, 10);
-    data.SLID = strtol(lineData.at(0).at(1).c_str(), NULL, 10);
-    data.ELID = strtol(lineData.at(0).at(2).c_str(), NULL, 10);
+    data.AID = strtol(m_Fields.at(0), NULL, 10);
+    data.SLID = strtol(m_Fields.at(1), NULL, 10);
+    data.ELID = strtol(m_Fields.at(2), NULL, 10);
 
     return true;
 
@@ -1154,16 +998,17 @@ bool AisanAreasFileReader::ReadNextLine(AisanArea& data)
 
 int AisanAreasFileReader::ReadAllData(vector<AisanArea>& data_list)
 {
-  data_list.clear();
+  m_data_list.clear();
   AisanArea data;
-  //double logTime = 0;
-  int count = 0;
   while(ReadNextLine(data))
   {
-    data_list.push_back(data);
-    count++;
+    m_data_list.push_back(data);
   }
-  return count;
+
+  m_data_index.Build(m_data_list, &AisanArea::AID);
+
+  data_list = m_data_list;
+  return m_data_list.size();
 }
 
 //Intersection
@@ -1172,29 +1017,18 @@ AisanIntersectionFileReader::AisanIntersectionFileReader(const vector_map_msgs::
 {
   if(_inters.data.size()==0) return;
 
-  m_min_id = std::numeric_limits<int>::max();
-
   m_data_list.clear();
+  m_data_list.reserve(_inters.data.size());
   AisanIntersection data;
-  int max_id = std::numeric_limits<int>::min();
 
   for(unsigned int i=0; i < _inters.data.size(); i++)
   {
     ParseNextLine(_inters.data.at(i), data);
 
     m_data_list.push_back(data);
-    if(data.ID < m_min_id)
-      m_min_id = data.ID;
-
-    if(data.ID > max_id)
-      max_id = data.ID;
   }
 
-  m_data_map.resize(max_id-m_min_id+2);
-  for(unsigned int i=0; i < m_data_list.size(); i++)
-  {
-    m_data_map.at(m_data_list.at(i).ID-m_min_id) = &m_data_list.at(i);
-  }
+  m_data_index.Build(m_data_list, &AisanIntersection::ID);
 }
 
 void AisanIntersectionFileReader::ParseNextLine(const vector_map_msgs::CrossRoad& _rec, AisanIntersection& data)
@@ -1206,38 +1040,18 @@ void AisanIntersectionFileReader::ParseNextLine(const vector_map_msgs::CrossRoad
 
 AisanIntersectionFileReader::AisanIntersection* AisanIntersectionFileReader::GetDataRowById(int _id)
 {
-  if(m_data_map.size()==0) return nullptr;
-
-  int index = _id-m_min_id;
-  if(index >= 0 && index < m_data_map.size())
-  {
-    return m_data_map.at(index);
-  }
-  else
-  {
-    for(unsigned int i=0; i < m_data_list.size(); i++)
-    {
-      if(m_data_list.at(i).ID == _id)
-      {
-        return &m_data_list.at(i);
-      }
-    }
-  }
-
-  return nullptr;
+  return m_data_index.GetDataRowById(_id);
 }
 
 bool AisanIntersectionFileReader::ReadNextLine(AisanIntersection& data)
 {
-  vector<vector<string> > lineData;
-  if(ReadSingleLine(lineData))
+  if(ReadLineFields())
   {
-    if(lineData.size()==0) return false;
-    if(lineData.at(0).size() < 3) return false;
+    if(m_Fields.size() < 3) return false;
 
-    data.ID = strtol(lineData.at(0).at(0).c_str(), NULL, 10);
-    data.AID = strtol(lineData.at(0).at(1).c_str(), NULL, 10);
-    data.LinkID = strtol(lineData.at(0).at(2).c_str(), NULL, 10);
+    data.ID = strtol(m_Fields.at(0), NULL, 10);
+    data.AID = strtol(m_Fields.at(1), NULL, 10);
+    data.LinkID = strtol(m_Fields.at(2), NULL, 10);
 
     return true;
 
@@ -1248,16 +1062,17 @@ bool AisanIntersectionFileReader::ReadNextLine(AisanIntersection& data)
 
 int AisanIntersectionFileReader::ReadAllData(vector<AisanIntersection>& data_list)
 {
-  data_list.clear();
+  m_data_list.clear();
   AisanIntersection data;
-  //double logTime = 0;
-  int count = 0;
   while(ReadNextLine(data))
   {
-    data_list.push_back(data);
-    count++;
+    m_data_list.push_back(data);
   }
-  return count;
+
+  m_data_index.Build(m_data_list, &AisanIntersection::ID);
+
+  data_list = m_data_list;
+  return m_data_list.size();
 }
 
 //StopLine
@@ -1266,29 +1081,18 @@ AisanStopLineFileReader::AisanStopLineFileReader(const vector_map_msgs::StopLine
 {
   if(_stopLines.data.size()==0) return;
 
-  m_min_id = std::numeric_limits<int>::max();
-
   m_data_list.clear();
+  m_data_list.reserve(_stopLines.data.size());
   AisanStopLine data;
-  int max_id = std::numeric_limits<int>::min();
 
   for(unsigned int i=0; i < _stopLines.data.size(); i++)
   {
     ParseNextLine(_stopLines.data.at(i), data);
 
     m_data_list.push_back(data);
-    if(data.ID < m_min_id)
-      m_min_id = data.ID;
-
-    if(data.ID > max_id)
-      max_id = data.ID;
   }
 
-  m_data_map.resize(max_id-m_min_id+2);
-  for(unsigned int i=0; i < m_data_list.size(); i++)
-  {
-    m_data_map.at(m_data_list.at(i).ID-m_min_id) = &m_data_list.at(i);
-  }
+  m_data_index.Build(m_data_list, &AisanStopLine::ID);
 }
 
 void AisanStopLineFileReader::ParseNextLine(const vector_map_msgs::StopLine& _rec, AisanStopLine& data)
@@ -1302,40 +1106,20 @@ void AisanStopLineFileReader::ParseNextLine(const vector_map_msgs::StopLine& _re
 
 AisanStopLineFileReader::AisanStopLine* AisanStopLineFileReader::GetDataRowById(int _id)
 {
-  if(m_data_map.size()==0) return nullptr;
-
-  int index = _id-m_min_id;
-  if(index >= 0 && index < m_data_map.size())
-  {
-    return m_data_map.at(index);
-  }
-  else
-  {
-    for(unsigned int i=0; i < m_data_list.size(); i++)
-    {
-      if(m_data_list.at(i).ID == _id)
-      {
-        return &m_data_list.at(i);
-      }
-    }
-  }
-
-  return nullptr;
+  return m_data_index.GetDataRowById(_id);
 }
 
 bool AisanStopLineFileReader::ReadNextLine(AisanStopLine& data)
 {
-  vector<vector<string> > lineData;
-  if(ReadSingleLine(lineData))
+  if(ReadLineFields())
   {
-    if(lineData.size()==0) return false;
-    if(lineData.at(0).size() < 5) return false;
+    if(m_Fields.size() < 5) return false;
 
-    data.ID   = strtol(lineData.at(0).at(0).c_str(), NULL, 10);
-    data.LID   = strtol(lineData.at(0).at(1).c_str(), NULL, 10);
-    data.TLID   = strtol(lineData.at(0).at(2).c_str(), NULL, 10);
-    data.SignID = strtol(lineData.at(0).at(3).c_str(), NULL, 10);
-    data.LinkID = strtol(lineData.at(0).at(4).c_str(), NULL, 10);
+    data.ID   = strtol(m_Fields.at(0), NULL, 10);
+    data.LID   = strtol(m_Fields.at(1), NULL, 10);
+    data.TLID   = strtol(m_Fields.at(2), NULL, 10);
+    data.SignID = strtol(m_Fields.at(3), NULL, 10);
+    data.LinkID = strtol(m_Fields.at(4), NULL, 10);
 
     return true;
 
@@ -1346,16 +1130,17 @@ bool AisanStopLineFileReader::ReadNextLine(AisanStopLine& data)
 
 int AisanStopLineFileReader::ReadAllData(vector<AisanStopLine>& data_list)
 {
-  data_list.clear();
+  m_data_list.clear();
   AisanStopLine data;
-  //double logTime = 0;
-  int count = 0;
   while(ReadNextLine(data))
   {
-    data_list.push_back(data);
-    count++;
+    m_data_list.push_back(data);
   }
-  return count;
+
+  m_data_index.Build(m_data_list, &AisanStopLine::ID);
+
+  data_list = m_data_list;
+  return m_data_list.size();
 }
 
 //RoadSign
@@ -1364,29 +1149,18 @@ AisanRoadSignFileReader::AisanRoadSignFileReader(const vector_map_msgs::RoadSign
 {
   if(_signs.data.size()==0) return;
 
-  m_min_id = std::numeric_limits<int>::max();
-
   m_data_list.clear();
+  m_data_list.reserve(_signs.data.size());
   AisanRoadSign data;
-  int max_id = std::numeric_limits<int>::min();
 
   for(unsigned int i=0; i < _signs.data.size(); i++)
   {
     ParseNextLine(_signs.data.at(i), data);
 
     m_data_list.push_back(data);
-    if(data.ID < m_min_id)
-      m_min_id = data.ID;
-
-    if(data.ID > max_id)
-      max_id = data.ID;
   }
 
-  m_data_map.resize(max_id-m_min_id+2);
-  for(unsigned int i=0; i < m_data_list.size(); i++)
-  {
-    m_data_map.at(m_data_list.at(i).ID-m_min_id) = &m_data_list.at(i);
-  }
+  m_data_index.Build(m_data_list, &AisanRoadSign::ID);
 }
 
 void AisanRoadSignFileReader::ParseNextLine(const vector_map_msgs::RoadSign& _rec, AisanRoadSign& data)
@@ -1400,40 +1174,20 @@ void AisanRoadSignFileReader::ParseNextLine(const vector_map_msgs::RoadSign& _re
 
 AisanRoadSignFileReader::AisanRoadSign* AisanRoadSignFileReader::GetDataRowById(int _id)
 {
-  if(m_data_map.size()==0) return nullptr;
-
-  int index = _id-m_min_id;
-  if(index >= 0 && index < m_data_map.size())
-  {
-    return m_data_map.at(index);
-  }
-  else
-  {
-    for(unsigned int i=0; i < m_data_list.size(); i++)
-    {
-      if(m_data_list.at(i).ID == _id)
-      {
-        return &m_data_list.at(i);
-      }
-    }
-  }
-
-  return nullptr;
+  return m_data_index.GetDataRowById(_id);
 }
 
 bool AisanRoadSignFileReader::ReadNextLine(AisanRoadSign& data)
 {
-  vector<vector<string> > lineData;
-  if(ReadSingleLine(lineData))
+  if(ReadLineFields())
   {
-    if(lineData.size()==0) return false;
-    if(lineData.at(0).size() < 5) return false;
+    if(m_Fields.size() < 5) return false;
 
-    data.ID   = strtol(lineData.at(0).at(0).c_str(), NULL, 10);
-    data.VID   = strtol(lineData.at(0).at(1).c_str(), NULL, 10);
-    data.PLID   = strtol(lineData.at(0).at(2).c_str(), NULL, 10);
-    data.Type   = strtol(lineData.at(0).at(3).c_str(), NULL, 10);
-    data.LinkID = strtol(lineData.at(0).at(4).c_str(), NULL, 10);
+    data.ID   = strtol(m_Fields.at(0), NULL, 10);
+    data.VID   = strtol(m_Fields.at(1), NULL, 10);
+    data.PLID   = strtol(m_Fields.at(2), NULL, 10);
+    data.Type   = strtol(m_Fields.at(3), NULL, 10);
+    data.LinkID = strtol(m_Fields.at(4), NULL, 10);
 
     return true;
 
@@ -1444,16 +1198,17 @@ bool AisanRoadSignFileReader::ReadNextLine(AisanRoadSign& data)
 
 int AisanRoadSignFileReader::ReadAllData(vector<AisanRoadSign>& data_list)
 {
-  data_list.clear();
+  m_data_list.clear();
   AisanRoadSign data;
-  //double logTime = 0;
-  int count = 0;
   while(ReadNextLine(data))
   {
-    data_list.push_back(data);
-    count++;
+    m_data_list.push_back(data);
   }
-  return count;
+
+  m_data_index.Build(m_data_list, &AisanRoadSign::ID);
+
+  data_list = m_data_list;
+  return m_data_list.size();
 }
 
 //Signal
@@ -1462,29 +1217,18 @@ AisanSignalFileReader::AisanSignalFileReader(const vector_map_msgs::SignalArray&
 {
   if(_signal.data.size()==0) return;
 
-  m_min_id = std::numeric_limits<int>::max();
-
   m_data_list.clear();
+  m_data_list.reserve(_signal.data.size());
   AisanSignal data;
-  int max_id = std::numeric_limits<int>::min();
 
   for(unsigned int i=0; i < _signal.data.size(); i++)
   {
     ParseNextLine(_signal.data.at(i), data);
 
     m_data_list.push_back(data);
-    if(data.ID < m_min_id)
-      m_min_id = data.ID;
-
-    if(data.ID > max_id)
-      max_id = data.ID;
   }
 
-  m_data_map.resize(max_id-m_min_id+2);
-  for(unsigned int i=0; i < m_data_list.size(); i++)
-  {
-    m_data_map.at(m_data_list.at(i).ID-m_min_id) = &m_data_list.at(i);
-  }
+  m_data_index.Build(m_data_list, &AisanSignal::ID);
 }
 
 void AisanSignalFileReader::ParseNextLine(const vector_map_msgs::Signal& _rec, AisanSignal& data)
@@ -1498,40 +1242,20 @@ void AisanSignalFileReader::ParseNextLine(const vector_map_msgs::Signal& _rec, A
 
 AisanSignalFileReader::AisanSignal* AisanSignalFileReader::GetDataRowById(int _id)
 {
-  if(m_data_map.size()==0) return nullptr;
-
-  int index = _id-m_min_id;
-  if(index >= 0 && index < m_data_map.size())
-  {
-    return m_data_map.at(index);
-  }
-  else
-  {
-    for(unsigned int i=0; i < m_data_list.size(); i++)
-    {
-      if(m_data_list.at(i).ID == _id)
-      {
-        return &m_data_list.at(i);
-      }
-    }
-  }
-
-  return nullptr;
+  return m_data_index.GetDataRowById(_id);
 }
 
 bool AisanSignalFileReader::ReadNextLine(AisanSignal& data)
 {
-  vector<vector<string> > lineData;
-  if(ReadSingleLine(lineData))
+  if(ReadLineFields())
   {
-    if(lineData.size()==0) return false;
-    if(lineData.at(0).size() < 5) return false;
+    if(m_Fields.size() < 5) return false;
 
-    data.ID   = strtol(lineData.at(0).at(0).c_str(), NULL, 10);
-    data.VID   = strtol(lineData.at(0).at(1).c_str(), NULL, 10);
-    data.PLID   = strtol(lineData.at(0).at(2).c_str(), NULL, 10);
-    data.Type   = strtol(lineData.at(0).at(3).c_str(), NULL, 10);
-    data.LinkID = strtol(lineData.at(0).at(4).c_str(), NULL, 10);
+    data.ID   = strtol(m_Fields.at(0), NULL, 10);
+    data.VID   = strtol(m_Fields.at(1), NULL, 10);
+    data.PLID   = strtol(m_Fields.at(2), NULL, 10);
+    data.Type   = strtol(m_Fields.at(3), NULL, 10);
+    data.LinkID = strtol(m_Fields.at(4), NULL, 10);
 
     return true;
 
@@ -1542,17 +1266,17 @@ bool AisanSignalFileReader::ReadNextLine(AisanSignal& data)
 
 int AisanSignalFileReader::ReadAllData(vector<AisanSignal>& data_list)
 {
-  data_list.clear();
+  m_data_list.clear();
   AisanSignal data;
-  //double logTime = 0;
-  int count = 0;
   while(ReadNextLine(data))
   {
-    data_list.push_back(data);
-    count++;
+    m_data_list.push_back(data);
   }
 
-  return count;
+  m_data_index.Build(m_data_list, &AisanSignal::ID);
+
+  data_list = m_data_list;
+  return m_data_list.size();
 }
 
 //Vector
@@ -1561,29 +1285,18 @@ AisanVectorFileReader::AisanVectorFileReader(const vector_map_msgs::VectorArray&
 {
   if(_vectors.data.size()==0) return;
 
-  m_min_id = std::numeric_limits<int>::max();
-
   m_data_list.clear();
+  m_data_list.reserve(_vectors.data.size());
   AisanVector data;
-  int max_id = std::numeric_limits<int>::min();
 
   for(unsigned int i=0; i < _vectors.data.size(); i++)
   {
     ParseNextLine(_vectors.data.at(i), data);
 
     m_data_list.push_back(data);
-    if(data.VID < m_min_id)
-      m_min_id = data.VID;
-
-    if(data.VID > max_id)
-      max_id = data.VID;
   }
 
-  m_data_map.resize(max_id-m_min_id+2);
-  for(unsigned int i=0; i < m_data_list.size(); i++)
-  {
-    m_data_map.at(m_data_list.at(i).VID-m_min_id) = &m_data_list.at(i);
-  }
+  m_data_index.Build(m_data_list, &AisanVector::VID);
 }
 
 void AisanVectorFileReader::ParseNextLine(const vector_map_msgs::Vector& _rec, AisanVector& data)
@@ -1596,39 +1309,19 @@ void AisanVectorFileReader::ParseNextLine(const vector_map_msgs::Vector& _rec, A
 
 AisanVectorFileReader::AisanVector* AisanVectorFileReader::GetDataRowById(int _id)
 {
-  if(m_data_map.size()==0) return nullptr;
-
-  int index = _id-m_min_id;
-  if(index >= 0 && index < m_data_map.size())
-  {
-    return m_data_map.at(index);
-  }
-  else
-  {
-    for(unsigned int i=0; i < m_data_list.size(); i++)
-    {
-      if(m_data_list.at(i).VID == _id)
-      {
-        return &m_data_list.at(i);
-      }
-    }
-  }
-
-  return nullptr;
+  return m_data_index.GetDataRowById(_id);
 }
 
 bool AisanVectorFileReader::ReadNextLine(AisanVector& data)
 {
-  vector<vector<string> > lineData;
-  if(ReadSingleLine(lineData))
+  if(ReadLineFields())
   {
-    if(lineData.size()==0) return false;
-    if(lineData.at(0).size() < 4) return false;
+    if(m_Fields.size() < 4) return false;
 
-    data.VID   = strtol(lineData.at(0).at(0).c_str(), NULL, 10);
-    data.PID   = strtol(lineData.at(0).at(1).c_str(), NULL, 10);
-    data.Hang   = strtod(lineData.at(0).at(2).c_str(), NULL);
-    data.Vang   = strtod(lineData.at(0).at(3).c_str(), NULL);
+    data.VID   = strtol(m_Fields.at(0), NULL, 10);
+    data.PID   = strtol(m_Fields.at(1), NULL, 10);
+    data.Hang   = strtod(m_Fields.at(2), NULL);
+    data.Vang   = strtod(m_Fields.at(3), NULL);
 
     return true;
 
@@ -1639,16 +1332,17 @@ bool AisanVectorFileReader::ReadNextLine(AisanVector& data)
 
 int AisanVectorFileReader::ReadAllData(vector<AisanVector>& data_list)
 {
-  data_list.clear();
+  m_data_list.clear();
   AisanVector data;
-  //double logTime = 0;
-  int count = 0;
   while(ReadNextLine(data))
   {
-    data_list.push_back(data);
-    count++;
+    m_data_list.push_back(data);
   }
-  return count;
+
+  m_data_index.Build(m_data_list, &AisanVector::VID);
+
+  data_list = m_data_list;
+  return m_data_list.size();
 }
 
 //Curb
@@ -1657,29 +1351,18 @@ AisanCurbFileReader::AisanCurbFileReader(const vector_map_msgs::CurbArray& _curb
 {
   if(_curbs.data.size()==0) return;
 
-  m_min_id = std::numeric_limits<int>::max();
-
   m_data_list.clear();
+  m_data_list.reserve(_curbs.data.size());
   AisanCurb data;
-  int max_id = std::numeric_limits<int>::min();
 
   for(unsigned int i=0; i < _curbs.data.size(); i++)
   {
     ParseNextLine(_curbs.data.at(i), data);
 
     m_data_list.push_back(data);
-    if(data.ID < m_min_id)
-      m_min_id = data.ID;
-
-    if(data.ID > max_id)
-      max_id = data.ID;
   }
 
-  m_data_map.resize(max_id-m_min_id+2);
-  for(unsigned int i=0; i < m_data_list.size(); i++)
-  {
-    m_data_map.at(m_data_list.at(i).ID-m_min_id) = &m_data_list.at(i);
-  }
+  m_data_index.Build(m_data_list, &AisanCurb::ID);
 }
 
 void AisanCurbFileReader::ParseNextLine(const vector_map_msgs::Curb& _rec, AisanCurb& data)
@@ -1694,41 +1377,21 @@ void AisanCurbFileReader::ParseNextLine(const vector_map_msgs::Curb& _rec, Aisan
 
 AisanCurbFileReader::AisanCurb* AisanCurbFileReader::GetDataRowById(int _id)
 {
-  if(m_data_map.size()==0) return nullptr;
-
-  int index = _id-m_min_id;
-  if(index >= 0 && index < m_data_map.size())
-  {
-    return m_data_map.at(index);
-  }
-  else
-  {
-    for(unsigned int i=0; i < m_data_list.size(); i++)
-    {
-      if(m_data_list.at(i).ID == _id)
-      {
-        return &m_data_list.at(i);
-      }
-    }
-  }
-
-  return nullptr;
+  return m_data_index.GetDataRowById(_id);
 }
 
 bool AisanCurbFileReader::ReadNextLine(AisanCurb& data)
 {
-  vector<vector<string> > lineData;
-  if(ReadSingleLine(lineData))
+  if(ReadLineFields())
   {
-    if(lineData.size()==0) return false;
-    if(lineData.at(0).size() < 6) return false;
+    if(m_Fields.size() < 6) return false;
 
-    data.ID   = strtol(lineData.at(0).at(0).c_str(), NULL, 10);
-    data.LID   = strtol(lineData.at(0).at(1).c_str(), NULL, 10);
-    data.Height = strtod(lineData.at(0).at(2).c_str(), NULL);
-    data.Width   = strtod(lineData.at(0).at(3).c_str(), NULL);
-    data.dir   = strtol(lineData.at(0).at(4).c_str(), NULL, 10);
-    data.LinkID = strtol(lineData.at(0).at(5).c_str(), NULL, 10);
+    data.ID   = strtol(m_Fields.at(0), NULL, 10);
+    data.LID   = strtol(m_Fields.at(1), NULL, 10);
+    data.Height = strtod(m_Fields.at(2), NULL);
+    data.Width   = strtod(m_Fields.at(3), NULL);
+    data.dir   = strtol(m_Fields.at(4), NULL, 10);
+    data.LinkID = strtol(m_Fields.at(5), NULL, 10);
 
     return true;
 
@@ -1739,16 +1402,17 @@ bool AisanCurbFileReader::ReadNextLine(AisanCurb& data)
 
 int AisanCurbFileReader::ReadAllData(vector<AisanCurb>& data_list)
 {
-  data_list.clear();
+  m_data_list.clear();
   AisanCurb data;
-  //double logTime = 0;
-  int count = 0;
   while(ReadNextLine(data))
   {
-    data_list.push_back(data);
-    count++;
+    m_data_list.push_back(data);
   }
-  return count;
+
+  m_data_index.Build(m_data_list, &AisanCurb::ID);
+
+  data_list = m_data_list;
+  return m_data_list.size();
 }
 
 // RoadEdge
@@ -1757,29 +1421,18 @@ AisanRoadEdgeFileReader::AisanRoadEdgeFileReader(const vector_map_msgs::RoadEdge
 {
   if(_edges.data.size()==0) return;
 
-  m_min_id = std::numeric_limits<int>::max();
-
   m_data_list.clear();
+  m_data_list.reserve(_edges.data.size());
   AisanRoadEdge data;
-  int max_id = std::numeric_limits<int>::min();
 
   for(unsigned int i=0; i < _edges.data.size(); i++)
   {
     ParseNextLine(_edges.data.at(i), data);
 
     m_data_list.push_back(data);
-    if(data.ID < m_min_id)
-      m_min_id = data.ID;
-
-    if(data.ID > max_id)
-      max_id = data.ID;
   }
 
-  m_data_map.resize(max_id-m_min_id+2);
-  for(unsigned int i=0; i < m_data_list.size(); i++)
-  {
-    m_data_map.at(m_data_list.at(i).ID-m_min_id) = &m_data_list.at(i);
-  }
+  m_data_index.Build(m_data_list, &AisanRoadEdge::ID);
 }
 
 void AisanRoadEdgeFileReader::ParseNextLine(const vector_map_msgs::RoadEdge& _rec, AisanRoadEdge& data)
@@ -1791,38 +1444,18 @@ void AisanRoadEdgeFileReader::ParseNextLine(const vector_map_msgs::RoadEdge& _re
 
 AisanRoadEdgeFileReader::AisanRoadEdge* AisanRoadEdgeFileReader::GetDataRowById(int _id)
 {
-  if(m_data_map.size()==0) return nullptr;
-
-  int index = _id-m_min_id;
-  if(index >= 0 && index < m_data_map.size())
-  {
-    return m_data_map.at(index);
-  }
-  else
-  {
-    for(unsigned int i=0; i < m_data_list.size(); i++)
-    {
-      if(m_data_list.at(i).ID == _id)
-      {
-        return &m_data_list.at(i);
-      }
-    }
-  }
-
-  return nullptr;
+  return m_data_index.GetDataRowById(_id);
 }
 
 bool AisanRoadEdgeFileReader::ReadNextLine(AisanRoadEdge& data)
 {
-  vector<vector<string> > lineData;
-  if(ReadSingleLine(lineData))
+  if(ReadLineFields())
   {
-    if(lineData.size()==0) return false;
-    if(lineData.at(0).size() < 3) return false;
+    if(m_Fields.size() < 3) return false;
 
-    data.ID   = strtol(lineData.at(0).at(0).c_str(), NULL, 10);
-    data.LID   = strtol(lineData.at(0).at(1).c_str(), NULL, 10);
-    data.LinkID = strtol(lineData.at(0).at(2).c_str(), NULL, 10);
+    data.ID   = strtol(m_Fields.at(0), NULL, 10);
+    data.LID   = strtol(m_Fields.at(1), NULL, 10);
+    data.LinkID = strtol(m_Fields.at(2), NULL, 10);
 
     return true;
 
@@ -1833,16 +1466,17 @@ bool AisanRoadEdgeFileReader::ReadNextLine(AisanRoadEdge& data)
 
 int AisanRoadEdgeFileReader::ReadAllData(vector<AisanRoadEdge>& data_list)
 {
-  data_list.clear();
+  m_data_list.clear();
   AisanRoadEdge data;
-  //double logTime = 0;
-  int count = 0;
   while(ReadNextLine(data))
   {
-    data_list.push_back(data);
-    count++;
+    m_data_list.push_back(data);
   }
-  return count;
+
+  m_data_index.Build(m_data_list, &AisanRoadEdge::ID);
+
+  data_list = m_data_list;
+  return m_data_list.size();
 }
 
 //CrossWalk
@@ -1851,29 +1485,18 @@ AisanCrossWalkFileReader::AisanCrossWalkFileReader(const vector_map_msgs::CrossW
 {
   if(_crossWalks.data.size()==0) return;
 
-  m_min_id = std::numeric_limits<int>::max();
-
   m_data_list.clear();
+  m_data_list.reserve(_crossWalks.data.size());
   AisanCrossWalk data;
-  int max_id = std::numeric_limits<int>::min();
 
   for(unsigned int i=0; i < _crossWalks.data.size(); i++)
   {
     ParseNextLine(_crossWalks.data.at(i), data);
 
     m_data_list.push_back(data);
-    if(data.ID < m_min_id)
-      m_min_id = data.ID;
-
-    if(data.ID > max_id)
-      max_id = data.ID;
   }
 
-  m_data_map.resize(max_id-m_min_id+2);
-  for(unsigned int i=0; i < m_data_list.size(); i++)
-  {
-    m_data_map.at(m_data_list.at(i).ID-m_min_id) = &m_data_list.at(i);
-  }
+  m_data_index.Build(m_data_list, &AisanCrossWalk::ID);
 }
 
 void AisanCrossWalkFileReader::ParseNextLine(const vector_map_msgs::CrossWalk& _rec, AisanCrossWalk& data)
@@ -1887,40 +1510,20 @@ void AisanCrossWalkFileReader::ParseNextLine(const vector_map_msgs::CrossWalk& _
 
 AisanCrossWalkFileReader::AisanCrossWalk* AisanCrossWalkFileReader::GetDataRowById(int _id)
 {
-  if(m_data_map.size()==0) return nullptr;
-
-  int index = _id-m_min_id;
-  if(index >= 0 && index < m_data_map.size())
-  {
-    return m_data_map.at(index);
-  }
-  else
-  {
-    for(unsigned int i=0; i < m_data_list.size(); i++)
-    {
-      if(m_data_list.at(i).ID == _id)
-      {
-        return &m_data_list.at(i);
-      }
-    }
-  }
-
-  return nullptr;
+  return m_data_index.GetDataRowById(_id);
 }
 
 bool AisanCrossWalkFileReader::ReadNextLine(AisanCrossWalk& data)
 {
-  vector<vector<string> > lineData;
-  if(ReadSingleLine(lineData))
+  if(ReadLineFields())
   {
-    if(lineData.size()==0) return false;
-    if(lineData.at(0).size() < 5) return false;
+    if(m_Fields.size() < 5) return false;
 
-    data.ID   = strtol(lineData.at(0).at(0).c_str(), NULL, 10);
-    data.AID   = strtol(lineData.at(0).at(1).c_str(), NULL, 10);
-    data.Type   = strtol(lineData.at(0).at(2).c_str(), NULL, 10);
-    data.BdID   = strtol(lineData.at(0).at(3).c_str(), NULL, 10);
-    data.LinkID = strtol(lineData.at(0).at(4).c_str(), NULL, 10);
+    data.ID   = strtol(m_Fields.at(0), NULL, 10);
+    data.AID   = strtol(m_Fields.at(1), NULL, 10);
+    data.Type   = strtol(m_Fields.at(2), NULL, 10);
+    data.BdID   = strtol(m_Fields.at(3), NULL, 10);
+    data.LinkID = strtol(m_Fields.at(4), NULL, 10);
 
     return true;
 
@@ -1931,16 +1534,17 @@ bool AisanCrossWalkFileReader::ReadNextLine(AisanCrossWalk& data)
 
 int AisanCrossWalkFileReader::ReadAllData(vector<AisanCrossWalk>& data_list)
 {
-  data_list.clear();
+  m_data_list.clear();
   AisanCrossWalk data;
-  //double logTime = 0;
-  int count = 0;
   while(ReadNextLine(data))
   {
-    data_list.push_back(data);
-    count++;
+    m_data_list.push_back(data);
   }
-  return count;
+
+  m_data_index.Build(m_data_list, &AisanCrossWalk::ID);
+
+  data_list = m_data_list;
+  return m_data_list.size();
 }
 
 //WayArea
@@ -1949,29 +1553,18 @@ AisanWayareaFileReader::AisanWayareaFileReader(const vector_map_msgs::WayAreaArr
 {
   if(_wayAreas.data.size()==0) return;
 
-  m_min_id = std::numeric_limits<int>::max();
-
   m_data_list.clear();
+  m_data_list.reserve(_wayAreas.data.size());
   AisanWayarea data;
-  int max_id = std::numeric_limits<int>::min();
 
   for(unsigned int i=0; i < _wayAreas.data.size(); i++)
   {
     ParseNextLine(_wayAreas.data.at(i), data);
 
     m_data_list.push_back(data);
-    if(data.ID < m_min_id)
-      m_min_id = data.ID;
-
-    if(data.ID > max_id)
-      max_id = data.ID;
   }
 
-  m_data_map.resize(max_id-m_min_id+2);
-  for(unsigned int i=0; i < m_data_list.size(); i++)
-  {
-    m_data_map.at(m_data_list.at(i).ID-m_min_id) = &m_data_list.at(i);
-  }
+  m_data_index.Build(m_data_list, &AisanWayarea::ID);
 }
 
 void AisanWayareaFileReader::ParseNextLine(const vector_map_msgs::WayArea& _rec, AisanWayarea& data)
@@ -1983,38 +1576,18 @@ void AisanWayareaFileReader::ParseNextLine(const vector_map_msgs::WayArea& _rec,
 
 AisanWayareaFileReader::AisanWayarea* AisanWayareaFileReader::GetDataRowById(int _id)
 {
-  if(m_data_map.size()==0) return nullptr;
-
-  int index = _id-m_min_id;
-  if(index >= 0 && index < m_data_map.size())
-  {
-    return m_data_map.at(index);
-  }
-  else
-  {
-    for(unsigned int i=0; i < m_data_list.size(); i++)
-    {
-      if(m_data_list.at(i).ID == _id)
-      {
-        return &m_data_list.at(i);
-      }
-    }
-  }
-
-  return nullptr;
+  return m_data_index.GetDataRowById(_id);
 }
 
 bool AisanWayareaFileReader::ReadNextLine(AisanWayarea& data)
 {
-  vector<vector<string> > lineData;
-  if(ReadSingleLine(lineData))
+  if(ReadLineFields())
   {
-    if(lineData.size()==0) return false;
-    if(lineData.at(0).size() < 3) return false;
+    if(m_Fields.size() < 3) return false;
 
-    data.ID   = strtol(lineData.at(0).at(0).c_str(), NULL, 10);
-    data.AID   = strtol(lineData.at(0).at(1).c_str(), NULL, 10);
-    data.LinkID = strtol(lineData.at(0).at(2).c_str(), NULL, 10);
+    data.ID   = strtol(m_Fields.at(0), NULL, 10);
+    data.AID   = strtol(m_Fields.at(1), NULL, 10);
+    data.LinkID = strtol(m_Fields.at(2), NULL, 10);
 
     return true;
 
@@ -2025,31 +1598,30 @@ bool AisanWayareaFileReader::ReadNextLine(AisanWayarea& data)
 
 int AisanWayareaFileReader::ReadAllData(vector<AisanWayarea>& data_list)
 {
-  data_list.clear();
+  m_data_list.clear();
   AisanWayarea data;
-  //double logTime = 0;
-  int count = 0;
   while(ReadNextLine(data))
   {
-    data_list.push_back(data);
-    count++;
+    m_data_list.push_back(data);
   }
-  return count;
+
+  m_data_index.Build(m_data_list, &AisanWayarea::ID);
+
+  data_list = m_data_list;
+  return m_data_list.size();
 }
 
 //Data Conn
 bool AisanDataConnFileReader::ReadNextLine(DataConn& data)
 {
-  vector<vector<string> > lineData;
-  if(ReadSingleLine(lineData))
+  if(ReadLineFields())
   {
-    if(lineData.size()==0) return false;
-    if(lineData.at(0).size() < 4) return false;
+    if(m_Fields.size() < 4) return false;
 
-    data.LID   = strtol(lineData.at(0).at(0).c_str(), NULL, 10);
-    data.SLID   = strtol(lineData.at(0).at(1).c_str(), NULL, 10);
-    data.SID   = strtol(lineData.at(0).at(2).c_str(), NULL, 10);
-    data.SSID   = strtol(lineData.at(0).at(3).c_str(), NULL, 10);
+    data.LID   = strtol(m_Fields.at(0), NULL, 10);
+    data.SLID   = strtol(m_Fields.at(1), NULL, 10);
+    data.SID   = strtol(m_Fields.at(2), NULL, 10);
+    data.SSID   = strtol(m_Fields.at(3), NULL, 10);
 
     return true;
 
@@ -0,0 +1,166 @@
+/// \file StageTimer.cpp
+/// \brief Scoped timers and latency histograms for the stages of a planning cycle
+/// \date Oct 14, 2026
+
+#include "op_utility/StageTimer.h"
+#include "op_utility/UtilityH.h"
+#include <math.h>
+#include <sstream>
+#include <iomanip>
+
+namespace UtilityHNS
+{
+
+const int LatencyHistogram::N_BINS;
+constexpr double LatencyHistogram::MIN_DURATION;
+constexpr double LatencyHistogram::BIN_GROWTH;
+
+LatencyHistogram::LatencyHistogram()
+{
+  Reset();
+}
+
+void LatencyHistogram::Reset()
+{
+  for(int i = 0; i < N_BINS; i++)
+    m_Bins[i] = 0;
+  m_Count = 0;
+  m_Max = 0;
+  m_Sum = 0;
+}
+
+int LatencyHistogram::GetBin(const double& seconds)
+{
+  if(!(seconds >= MIN_DURATION))
+    return 0;
+
+  int bin = 1 + (int)(log(seconds/MIN_DURATION)/log(BIN_GROWTH));
+  if(bin >= N_BINS)
+    bin = N_BINS - 1;
+  return bin;
+}
+
+double LatencyHistogram::GetBinUpperEdge(const int& bin)
+{
+  return MIN_DURATION*pow(BIN_GROWTH, bin);
+}
+
+void LatencyHistogram::Add(const double& seconds)
+{
+  m_Bins[GetBin(seconds)]++;
+  m_Count++;
+  m_Sum += seconds;
+  if(seconds > m_Max)
+    m_Max = seconds;
+}
+
+unsigned long LatencyHistogram::GetCount() const
+{
+  return m_Count;
+}
+
+double LatencyHistogram::GetMax() const
+{
+  return m_Max;
+}
+
+double LatencyHistogram::GetMean() const
+{
+  if(m_Count == 0)
+    return 0;
+  return m_Sum/(double)m_Count;
+}
+
+double LatencyHistogram::GetPercentile(const double& p) const
+{
+  if(m_Count == 0)
+    return 0;
+
+  //rank of the sample we look for, counted from 1
+  double rank = ceil(p*(double)m_Count);
+  if(rank < 1)
+    rank = 1;
+
+  unsigned long accum = 0;
+  for(int i = 0; i < N_BINS; i++)
+  {
+    accum += m_Bins[i];
+    if((double)accum >= rank)
+    {
+      double edge = GetBinUpperEdge(i);
+      return edge < m_Max ? edge : m_Max;
+    }
+  }
+
+  return m_Max;
+}
+
+int StageLatencyRecorder::AddStage(const std::string& name)
+{
+  for(unsigned int i = 0; i < m_Names.size(); i++)
+  {
+    if(m_Names.at(i) == name)
+      return i;
+  }
+
+  m_Names.push_back(name);
+  m_Histograms.push_back(LatencyHistogram());
+  return m_Names.size() - 1;
+}
+
+void StageLatencyRecorder::Record(const int& stage, const double& seconds)
+{
+  if(stage < 0 || stage >= (int)m_Histograms.size())
+    return;
+
+  m_Histograms[stage].Add(seconds);
+}
+
+void StageLatencyRecorder::Reset()
+{
+  for(unsigned int i = 0; i < m_Histograms.size(); i++)
+    m_Histograms.at(i).Reset();
+}
+
+unsigned int StageLatencyRecorder::GetNumberOfStages() const
+{
+  return m_Names.size();
+}
+
+const std::string& StageLatencyRecorder::GetStageName(const int& stage) const
+{
+  return m_Names.at(stage);
+}
+
+const LatencyHistogram& StageLatencyRecorder::GetHistogram(const int& stage) const
+{
+  return m_Histograms.at(stage);
+}
+
+std::string StageLatencyRecorder::ToString() const
+{
+  std::ostringstream str;
+  str << std::fixed << std::setprecision(3);
+  for(unsigned int i = 0; i < m_Names.size(); i++)
+  {
+    const LatencyHistogram& h = m_Histograms.at(i);
+    str << m_Names.at(i) << ": p50 " << h.GetPercentile(0.5)*1000.0 << " ms, p99 " << h.GetPercentile(0.99)*1000.0
+        << " ms, max " << h.GetMax()*1000.0 << " ms (" << h.GetCount() << ")" << std::endl;
+  }
+  return str.str();
+}
+
+ScopedStageTimer::ScopedStageTimer(StageLatencyRecorder* pRecorder, const int& stage)
+{
+  m_pRecorder = pRecorder;
+  m_Stage = stage;
+  UtilityH::GetTickCount(m_Start);
+}
+
+ScopedStageTimer::~ScopedStageTimer()
+{
+  if(m_pRecorder)
+    m_pRecorder->Record(m_Stage, UtilityH::GetTimeDiffNow(m_Start));
+}
+
+} /* namespace UtilityHNS */
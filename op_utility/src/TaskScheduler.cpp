@@ -0,0 +1,345 @@
+/// \file TaskScheduler.cpp
+/// \brief Work stealing task scheduler, one process wide instance shared by the OpenPlanner libraries
+/// \date Oct 14, 2026
+
+#include "op_utility/TaskScheduler.h"
+#include <algorithm>
+#include <chrono>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace UtilityHNS
+{
+
+//set on the scheduler workers, the tasks they submit go to their own queue
+static thread_local const TaskScheduler* g_pWorkerScheduler = nullptr;
+static thread_local int g_iWorkerQueue = -1;
+
+static std::mutex g_SharedMutex;
+static std::unique_ptr<TaskScheduler> g_pSharedScheduler;
+static TaskSchedulerParams g_SharedParams;
+
+TaskGroup::TaskGroup()
+{
+  m_nPending = 0;
+}
+
+TaskScheduler::TaskScheduler(const TaskSchedulerParams& params)
+{
+  m_Params = params;
+  m_nQueued = 0;
+  m_bStop = false;
+  m_nSubmitted = 0;
+  m_nExecuted = 0;
+  m_nStolen = 0;
+  m_MaxQueueDepth = 0;
+  m_nSettingsFailures = 0;
+  m_nStartedWorkers = 0;
+
+  int n = params.nThreads;
+  if(n <= 0)
+    n = std::max(1, (int)std::thread::hardware_concurrency());
+
+  for(int i = 0; i < n; i++)
+    m_Queues.push_back(std::unique_ptr<TaskQueue>(new TaskQueue()));
+
+  for(int i = 0; i < n - 1; i++)
+    m_Workers.push_back(std::thread(&TaskScheduler::WorkerLoop, this, i));
+
+  //the settings are applied by each worker, wait for them so the statistics report the refused ones
+  while(m_nStartedWorkers < (int)m_Workers.size())
+    std::this_thread::yield();
+}
+
+TaskScheduler::~TaskScheduler()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_SleepMutex);
+    m_bStop = true;
+  }
+  m_WakeCondition.notify_all();
+
+  for(unsigned int i = 0; i < m_Workers.size(); i++)
+    m_Workers.at(i).join();
+}
+
+TaskScheduler& TaskScheduler::GetShared()
+{
+  std::lock_guard<std::mutex> lock(g_SharedMutex);
+  if(!g_pSharedScheduler)
+    g_pSharedScheduler.reset(new TaskScheduler(g_SharedParams));
+
+  return *g_pSharedScheduler;
+}
+
+bool TaskScheduler::ConfigureShared(const TaskSchedulerParams& params)
+{
+  std::lock_guard<std::mutex> lock(g_SharedMutex);
+  if(g_pSharedScheduler)
+    return false;
+
+  g_SharedParams = params;
+  return true;
+}
+
+int TaskScheduler::GetNumberOfThreads() const
+{
+  return m_Workers.size() + 1;
+}
+
+int TaskScheduler::GetCurrentQueue() const
+{
+  if(g_pWorkerScheduler == this)
+    return g_iWorkerQueue;
+
+  return m_Queues.size() - 1;
+}
+
+void TaskScheduler::ApplyThreadSettings(const int& iWorker)
+{
+#ifdef __linux__
+  if(m_Params.cpuAffinity.size() > 0)
+  {
+    int cpu = m_Params.cpuAffinity.at(iWorker % m_Params.cpuAffinity.size());
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    if(cpu >= 0 && cpu < CPU_SETSIZE)
+      CPU_SET(cpu, &cpu_set);
+
+    if(cpu < 0 || cpu >= CPU_SETSIZE || pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set) != 0)
+      m_nSettingsFailures++;
+  }
+
+  if(m_Params.realTimePriority > 0)
+  {
+    sched_param sched;
+    sched.sched_priority = m_Params.realTimePriority;
+    if(pthread_setschedparam(pthread_self(), SCHED_FIFO, &sched) != 0)
+      m_nSettingsFailures++;
+  }
+  else if(m_Params.niceValue != 0)
+  {
+    //on linux the nice value of a thread id only applies to that thread
+    if(setpriority(PRIO_PROCESS, syscall(SYS_gettid), m_Params.niceValue) != 0)
+      m_nSettingsFailures++;
+  }
+#else
+  if(m_Params.cpuAffinity.size() > 0 || m_Params.realTimePriority > 0 || m_Params.niceValue != 0)
+    m_nSettingsFailures++;
+#endif
+}
+
+bool TaskScheduler::PopTask(const int& iQueue, Task& task)
+{
+  //own queue newest first, it is the one most likely in the cache
+  {
+    TaskQueue& q = *m_Queues.at(iQueue);
+    std::lock_guard<std::mutex> lock(q.mutex);
+    if(q.tasks.size() > 0)
+    {
+      task = q.tasks.back();
+      q.tasks.pop_back();
+      m_nQueued--;
+      return true;
+    }
+  }
+
+  //then the oldest task of the other queues, the largest pieces of work are usually submitted first
+  int nQueues = m_Queues.size();
+  for(int k = 1; k < nQueues; k++)
+  {
+    TaskQueue& q = *m_Queues.at((iQueue + k) % nQueues);
+    std::lock_guard<std::mutex> lock(q.mutex);
+    if(q.tasks.size() > 0)
+    {
+      task = q.tasks.front();
+      q.tasks.pop_front();
+      m_nQueued--;
+      m_nStolen++;
+      return true;
+    }
+  }
+
+  return false;
+}
+
+void TaskScheduler::RunTask(Task& task)
+{
+  TaskGroup& group = *task.pGroup;
+  std::exception_ptr exception;
+  try
+  {
+    task.run();
+  }
+  catch(...)
+  {
+    exception = std::current_exception();
+  }
+
+  m_nExecuted++;
+
+  //under the group lock, Wait takes it before returning so the group outlives this notification
+  std::lock_guard<std::mutex> lock(group.m_Mutex);
+  if(exception && !group.m_Exception)
+    group.m_Exception = exception;
+
+  if(--group.m_nPending == 0)
+    group.m_DoneCondition.notify_all();
+}
+
+void TaskScheduler::WorkerLoop(const int& iWorker)
+{
+  g_pWorkerScheduler = this;
+  g_iWorkerQueue = iWorker;
+  ApplyThreadSettings(iWorker);
+  m_nStartedWorkers++;
+
+  while(true)
+  {
+    Task task;
+    if(PopTask(iWorker, task))
+    {
+      RunTask(task);
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock(m_SleepMutex);
+    m_WakeCondition.wait(lock, [&]{ return m_bStop || m_nQueued > 0; });
+    if(m_bStop) return;
+  }
+}
+
+void TaskScheduler::Submit(TaskGroup& group, const std::function<void()>& task)
+{
+  group.m_nPending++;
+
+  Task t;
+  t.run = task;
+  t.pGroup = &group;
+  {
+    TaskQueue& q = *m_Queues.at(GetCurrentQueue());
+    std::lock_guard<std::mutex> lock(q.mutex);
+    q.tasks.push_back(t);
+  }
+
+  unsigned int depth = std::max(0, ++m_nQueued);
+  unsigned int max_depth = m_MaxQueueDepth;
+  while(depth > max_depth && !m_MaxQueueDepth.compare_exchange_weak(max_depth, depth));
+  m_nSubmitted++;
+
+  {
+    std::lock_guard<std::mutex> lock(m_SleepMutex);
+  }
+  m_WakeCondition.notify_one();
+}
+
+void TaskScheduler::Wait(TaskGroup& group)
+{
+  int iQueue = GetCurrentQueue();
+  while(group.m_nPending > 0)
+  {
+    Task task;
+    if(PopTask(iQueue, task))
+    {
+      RunTask(task);
+      continue;
+    }
+
+    //the remaining tasks are running on other threads, check again for tasks they submit
+    std::unique_lock<std::mutex> lock(group.m_Mutex);
+    group.m_DoneCondition.wait_for(lock, std::chrono::milliseconds(1), [&]{ return group.m_nPending == 0; });
+  }
+
+  std::exception_ptr exception;
+  {
+    std::lock_guard<std::mutex> lock(group.m_Mutex);
+    exception = group.m_Exception;
+    group.m_Exception = nullptr;
+  }
+
+  if(exception)
+    std::rethrow_exception(exception);
+}
+
+void TaskScheduler::ParallelFor(const int& n, const std::function<void(const int&)>& task, const int& maxParallel)
+{
+  if(n <= 0) return;
+
+  int nRunners = GetNumberOfThreads();
+  if(maxParallel > 0)
+    nRunners = std::min(nRunners, maxParallel);
+  nRunners = std::min(nRunners, n);
+
+  if(nRunners <= 1)
+  {
+    for(int i = 0; i < n; i++)
+      task(i);
+    return;
+  }
+
+  //each runner takes the next index until all are taken, so uneven tasks still balance
+  TaskGroup group;
+  std::atomic<int> next_task(0);
+  std::function<void()> runner = [&]()
+  {
+    while(true)
+    {
+      int i = next_task.fetch_add(1);
+      if(i >= n) break;
+
+      try
+      {
+        task(i);
+      }
+      catch(...)
+      {
+        std::lock_guard<std::mutex> lock(group.m_Mutex);
+        if(!group.m_Exception)
+          group.m_Exception = std::current_exception();
+      }
+    }
+  };
+
+  for(int i = 1; i < nRunners; i++)
+    Submit(group, runner);
+
+  runner();
+  Wait(group);
+}
+
+TaskSchedulerStats TaskScheduler::GetStats() const
+{
+  TaskSchedulerStats stats;
+  stats.nThreads = GetNumberOfThreads();
+  stats.nSubmitted = m_nSubmitted;
+  stats.nExecuted = m_nExecuted;
+  stats.nStolen = m_nStolen;
+  stats.maxQueueDepth = m_MaxQueueDepth;
+  stats.nSettingsFailures = m_nSettingsFailures;
+
+  for(unsigned int i = 0; i < m_Queues.size(); i++)
+  {
+    TaskQueue& q = *m_Queues.at(i);
+    std::lock_guard<std::mutex> lock(q.mutex);
+    stats.workerQueueDepths.push_back(q.tasks.size());
+    stats.queueDepth += q.tasks.size();
+  }
+
+  return stats;
+}
+
+void TaskScheduler::ResetStats()
+{
+  m_nSubmitted = 0;
+  m_nExecuted = 0;
+  m_nStolen = 0;
+  m_MaxQueueDepth = 0;
+}
+
+} /* namespace UtilityHNS */
@@ -133,11 +133,40 @@ double UtilityH::GetCircularAngle(const double& prevContAngle, const double& pre
   return c_ang;
 }
 
+//time of the innermost SimulatedClockScope of this thread, 0 for the system clock
+static thread_local const struct timespec* g_pSimulatedTime = 0;
+
 void UtilityH::GetTickCount(struct timespec& t)
 {
+  if(g_pSimulatedTime)
+  {
+    t = *g_pSimulatedTime;
+    return;
+  }
+
   while(clock_gettime(0, & t) == -1);
 }
 
+SimulatedClockScope::SimulatedClockScope(const struct timespec& simTime)
+{
+  m_Time = simTime;
+  m_pPreviousTime = g_pSimulatedTime;
+  g_pSimulatedTime = &m_Time;
+}
+
+SimulatedClockScope::SimulatedClockScope(const double& simSeconds)
+{
+  m_Time.tv_sec = (time_t)floor(simSeconds);
+  m_Time.tv_nsec = (long)((simSeconds - m_Time.tv_sec) * 1000000000.0);
+  m_pPreviousTime = g_pSimulatedTime;
+  g_pSimulatedTime = &m_Time;
+}
+
+SimulatedClockScope::~SimulatedClockScope()
+{
+  g_pSimulatedTime = m_pPreviousTime;
+}
+
 double UtilityH::GetTimeDiff(const struct timespec& old_t,const struct timespec& curr_t)
 {
   return (curr_t.tv_sec - old_t.tv_sec) + ((double)(curr_t.tv_nsec - old_t.tv_nsec)/ 1000000000.0);
@@ -223,6 +252,8 @@ time_t UtilityH::GetLongTime(const struct timespec& srcT)
   return dstT;
 }
 
+const int PIDController::LOG_VALUES_COUNT;
+
 PIDController::PIDController()
 {
   kp = kp_v = 0;
@@ -319,14 +350,34 @@ std::string PIDController::ToStringHeader()
 
 std::string PIDController::ToString()
 {
-  std::ostringstream str_out;
   timespec t_stamp;
   UtilityH::GetTickCount(t_stamp);
-  str_out << UtilityH::GetLongTime(t_stamp) << "," <<kp << "," << ki << "," << kd << "," << kp_v << "," << ki_v << "," << kd_v
-        << "," << pid_v << "," << "," << pid_lim << "," << "," << prevErr << "," << accumErr << "," ;
+  double values[LOG_VALUES_COUNT];
+  GetLogValues(values);
+  return LogValuesToString(UtilityH::GetLongTime(t_stamp), values);
+}
 
-  return str_out.str();
+void PIDController::GetLogValues(double* values) const
+{
+  values[0] = kp;
+  values[1] = ki;
+  values[2] = kd;
+  values[3] = kp_v;
+  values[4] = ki_v;
+  values[5] = kd_v;
+  values[6] = pid_v;
+  values[7] = pid_lim;
+  values[8] = prevErr;
+  values[9] = accumErr;
+}
 
+std::string PIDController::LogValuesToString(const time_t& t, const double* values)
+{
+  std::ostringstream str_out;
+  str_out << t << "," << values[0] << "," << values[1] << "," << values[2] << "," << values[3] << "," << values[4] << "," << values[5]
+        << "," << values[6] << "," << "," << values[7] << "," << "," << values[8] << "," << values[9] << "," ;
+
+  return str_out.str();
 }
 
 void PIDController::ResetD()
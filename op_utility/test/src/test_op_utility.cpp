@@ -1,7 +1,24 @@
 #include <ros/ros.h>
 #include <gtest/gtest.h>
+#include <stdexcept>
+#include <vector>
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+#include <atomic>
+#include <chrono>
 
 #include "op_utility/UtilityH.h"
+#include "op_utility/TaskScheduler.h"
+#include "op_utility/DataRW.h"
+#include "op_utility/StageTimer.h"
+#include "op_utility/FastAngle.h"
+#include "op_utility/AsyncLogger.h"
+#include "op_utility/ColumnarLog.h"
 
 class TestSuite : public ::testing::Test
 {
@@ -121,6 +138,528 @@ TEST(TestSuite, UtilityH_tsCompare) {
   ASSERT_EQ(1, UtilityHNS::UtilityH::tsCompare(timespec{1, 0}, timespec{0, 999999989}, 10));
 }
 
+TEST(TestSuite, TaskScheduler_parallelFor) {
+  UtilityHNS::TaskSchedulerParams params;
+  params.nThreads = 4;
+  UtilityHNS::TaskScheduler scheduler(params);
+  ASSERT_EQ(4, scheduler.GetNumberOfThreads());
+
+  for (int n = 0; n < 50; n++) {
+    std::vector<int> out(n, 0);
+    scheduler.ParallelFor(n, [&](const int & i) { out.at(i) += i + 1; });
+    for (int i = 0; i < n; i++) {
+      ASSERT_EQ(i + 1, out.at(i));
+    }
+  }
+
+  // nested loops are queued on the worker running the outer task, the idle workers steal them
+  std::vector<int> out(64, 0);
+  scheduler.ParallelFor(8, [&](const int & i) {
+    scheduler.ParallelFor(8, [&](const int & j) { out.at(i * 8 + j) = 1; });
+  });
+  for (int i = 0; i < 64; i++) {
+    ASSERT_EQ(1, out.at(i));
+  }
+
+  std::vector<int> done(8, 0);
+  ASSERT_THROW(scheduler.ParallelFor(8, [&](const int & i) {
+    done.at(i) = 1;
+    if (i == 3) {throw std::runtime_error("task failed");}
+  }), std::runtime_error);
+  for (int i = 0; i < 8; i++) {
+    ASSERT_EQ(1, done.at(i));
+  }
+
+  // at most 2 threads run the loop
+  std::atomic<int> running(0);
+  std::atomic<int> max_running(0);
+  scheduler.ParallelFor(32, [&](const int &) {
+    int r = ++running;
+    int m = max_running;
+    while (r > m && !max_running.compare_exchange_weak(m, r)) {}
+    std::this_thread::sleep_for(std::chrono::microseconds(200));
+    running--;
+  }, 2);
+  ASSERT_LE(max_running.load(), 2);
+}
+
+TEST(TestSuite, TaskScheduler_submitAndStats) {
+  UtilityHNS::TaskSchedulerParams params;
+  params.nThreads = 3;
+  params.cpuAffinity.push_back(0);
+  UtilityHNS::TaskScheduler scheduler(params);
+  UtilityHNS::TaskSchedulerStats stats = scheduler.GetStats();
+  ASSERT_EQ(3, stats.nThreads);
+  ASSERT_EQ(3u, stats.workerQueueDepths.size());
+  ASSERT_EQ(0u, stats.queueDepth);
+  ASSERT_EQ(0, stats.nSettingsFailures);
+
+  std::vector<int> out(20, 0);
+  UtilityHNS::TaskGroup group;
+  for (int i = 0; i < 20; i++) {
+    scheduler.Submit(group, [&out, i]() { out.at(i) = i; });
+  }
+  scheduler.Wait(group);
+  for (int i = 0; i < 20; i++) {
+    ASSERT_EQ(i, out.at(i));
+  }
+
+  // tasks from a non worker thread go to the shared queue, the ones the workers run are counted as stolen
+  stats = scheduler.GetStats();
+  ASSERT_EQ(20u, stats.nSubmitted);
+  ASSERT_EQ(20u, stats.nExecuted);
+  ASSERT_LE(stats.nStolen, 20u);
+  ASSERT_EQ(0u, stats.queueDepth);
+  ASSERT_GE(stats.maxQueueDepth, 1u);
+
+  scheduler.ResetStats();
+  stats = scheduler.GetStats();
+  ASSERT_EQ(0u, stats.nSubmitted);
+  ASSERT_EQ(0u, stats.nStolen);
+
+  // an invalid cpu is reported, the scheduler still runs the tasks
+  params.cpuAffinity.clear();
+  params.cpuAffinity.push_back(-1);
+  UtilityHNS::TaskScheduler refused(params);
+  ASSERT_EQ(2, refused.GetStats().nSettingsFailures);
+  std::vector<int> ran(4, 0);
+  refused.ParallelFor(4, [&](const int & i) { ran.at(i) = 1; });
+  for (int i = 0; i < 4; i++) {
+    ASSERT_EQ(1, ran.at(i));
+  }
+
+  ASSERT_EQ(&UtilityHNS::TaskScheduler::GetShared(), &UtilityHNS::TaskScheduler::GetShared());
+  ASSERT_FALSE(UtilityHNS::TaskScheduler::ConfigureShared(params));
+}
+
+// Same parsing as the string based reader before the in place fields, used as reference and benchmark baseline
+void ReadPointsWithStrings(
+  const std::string & fileName,
+  std::vector<UtilityHNS::AisanPointsFileReader::AisanPoints> & points)
+{
+  points.clear();
+  std::ifstream file(fileName.c_str());
+  std::string strLine, token;
+  getline(file, strLine);
+  while (!file.eof()) {
+    getline(file, strLine);
+    std::istringstream str_stream(strLine);
+    std::vector<std::vector<std::string>> line(1);
+    while (getline(str_stream, token, ',')) {
+      line.at(0).push_back(token);
+    }
+    if (line.at(0).size() < 10) {break;}
+
+    UtilityHNS::AisanPointsFileReader::AisanPoints p;
+    p.PID = strtol(line.at(0).at(0).c_str(), NULL, 10);
+    p.B = strtod(line.at(0).at(1).c_str(), NULL);
+    p.L = strtod(line.at(0).at(2).c_str(), NULL);
+    p.H = strtod(line.at(0).at(3).c_str(), NULL);
+    p.Bx = strtod(line.at(0).at(4).c_str(), NULL);
+    p.Ly = strtod(line.at(0).at(5).c_str(), NULL);
+    p.Ref = strtol(line.at(0).at(6).c_str(), NULL, 10);
+    p.MCODE1 = strtol(line.at(0).at(7).c_str(), NULL, 10);
+    p.MCODE2 = strtol(line.at(0).at(8).c_str(), NULL, 10);
+    p.MCODE3 = strtol(line.at(0).at(9).c_str(), NULL, 10);
+    points.push_back(p);
+  }
+}
+
+void WritePointsFile(const std::string & fileName, const int & nPoints)
+{
+  std::ofstream file(fileName.c_str());
+  file.precision(16);
+  file << "PID,B,L,H,Bx,Ly,ReF,MCODE1,MCODE2,MCODE3" << std::endl;
+  for (int i = 0; i < nPoints; i++) {
+    file << i + 1 << "," << 35.0 + i * 1e-7 << "," << 139.0 - i * 1e-7 << "," << 40.25 + (i % 7) * 0.125 <<
+      "," << -12345.678 + i * 0.01 << "," << 6789.0123 - i * 0.02 << ",7," << i % 3 << ",0,0" << std::endl;
+  }
+}
+
+TEST(TestSuite, DataRW_inPlaceFields) {
+  std::string fileName = "/tmp/test_op_utility_points.csv";
+  std::ofstream file(fileName.c_str());
+  file << "PID,B,L,H,Bx,Ly,ReF,MCODE1,MCODE2,MCODE3" << std::endl;
+  file << "1,35.5,139.25,10.5,-100.75,200.5,7,1,2,3" << std::endl;
+  file << "2,,139.0,11,-101,201,7,0,0,0," << std::endl;
+  file << "3,35.0,139.0,12,-102,202,7,0,0,4\r" << std::endl;
+  file << "4,1,2,3,4,5,6,7,8" << std::endl;
+  file << "5,1,2,3,4,5,6,7,8,9";
+  file.close();
+
+  UtilityHNS::AisanPointsFileReader reader(fileName);
+  std::vector<UtilityHNS::AisanPointsFileReader::AisanPoints> points;
+  ASSERT_EQ(3, reader.ReadAllData(points));
+  ASSERT_EQ(1, points.at(0).PID);
+  ASSERT_EQ(35.5, points.at(0).B);
+  ASSERT_EQ(-100.75, points.at(0).Bx);
+  ASSERT_EQ(3, points.at(0).MCODE3);
+  ASSERT_EQ(0.0, points.at(1).B);
+  ASSERT_EQ(201.0, points.at(1).Ly);
+  ASSERT_EQ(4, points.at(2).MCODE3);
+  ASSERT_NE(nullptr, reader.GetDataRowById(3));
+  ASSERT_EQ(12.0, reader.GetDataRowById(3)->H);
+
+  // last line without a line end
+  std::ofstream short_file(fileName.c_str());
+  short_file << "PID,B,L,H,Bx,Ly,ReF,MCODE1,MCODE2,MCODE3" << std::endl;
+  short_file << "9,1,2,3,4,5,6,7,8,9";
+  short_file.close();
+  UtilityHNS::AisanPointsFileReader short_reader(fileName);
+  ASSERT_EQ(1, short_reader.ReadAllData(points));
+  ASSERT_EQ(9, points.at(0).MCODE3);
+
+  UtilityHNS::AisanPointsFileReader missing_reader("/tmp/test_op_utility_no_such_file.csv");
+  ASSERT_EQ(0, missing_reader.ReadAllData(points));
+  remove(fileName.c_str());
+}
+
+TEST(TestSuite, DataRW_pointsBenchmark) {
+  std::string fileName = "/tmp/test_op_utility_points_benchmark.csv";
+  WritePointsFile(fileName, 200000);
+
+  struct timespec t;
+  std::vector<UtilityHNS::AisanPointsFileReader::AisanPoints> string_points, points;
+  UtilityHNS::UtilityH::GetTickCount(t);
+  ReadPointsWithStrings(fileName, string_points);
+  double strings_time = UtilityHNS::UtilityH::GetTimeDiffNow(t);
+
+  UtilityHNS::UtilityH::GetTickCount(t);
+  UtilityHNS::AisanPointsFileReader reader(fileName);
+  reader.ReadAllData(points);
+  double fields_time = UtilityHNS::UtilityH::GetTimeDiffNow(t);
+
+  std::cout << "200000 points, string fields: " << strings_time << " s, in place fields: " << fields_time <<
+    " s" << std::endl;
+
+  ASSERT_EQ(string_points.size(), points.size());
+  for (unsigned int i = 0; i < points.size(); i++) {
+    ASSERT_EQ(string_points.at(i).PID, points.at(i).PID);
+    ASSERT_EQ(string_points.at(i).B, points.at(i).B);
+    ASSERT_EQ(string_points.at(i).L, points.at(i).L);
+    ASSERT_EQ(string_points.at(i).H, points.at(i).H);
+    ASSERT_EQ(string_points.at(i).Bx, points.at(i).Bx);
+    ASSERT_EQ(string_points.at(i).Ly, points.at(i).Ly);
+    ASSERT_EQ(string_points.at(i).MCODE1, points.at(i).MCODE1);
+  }
+  remove(fileName.c_str());
+}
+
+TEST(TestSuite, DataRW_dataRowIndex) {
+  struct Row
+  {
+    int ID;
+    int value;
+  };
+
+  std::vector<Row> dense_rows;
+  for (int i = 0; i < 100; i++) {
+    dense_rows.push_back({10 + i * 2, i});
+  }
+  UtilityHNS::DataRowIndex<Row> dense_index;
+  dense_index.Build(dense_rows, &Row::ID);
+  ASSERT_TRUE(dense_index.IsDense());
+  ASSERT_EQ(&dense_rows.at(5), dense_index.GetDataRowById(20));
+  ASSERT_EQ(nullptr, dense_index.GetDataRowById(21));
+  ASSERT_EQ(nullptr, dense_index.GetDataRowById(9));
+  ASSERT_EQ(nullptr, dense_index.GetDataRowById(std::numeric_limits<int>::max()));
+
+  std::vector<Row> sparse_rows = {{-2000000000, 0}, {7, 1}, {2000000000, 2}, {7, 3}};
+  UtilityHNS::DataRowIndex<Row> sparse_index;
+  sparse_index.Build(sparse_rows, &Row::ID);
+  ASSERT_FALSE(sparse_index.IsDense());
+  ASSERT_EQ(&sparse_rows.at(0), sparse_index.GetDataRowById(-2000000000));
+  ASSERT_EQ(&sparse_rows.at(2), sparse_index.GetDataRowById(2000000000));
+  ASSERT_EQ(&sparse_rows.at(3), sparse_index.GetDataRowById(7));
+  ASSERT_EQ(nullptr, sparse_index.GetDataRowById(8));
+
+  std::vector<Row> no_rows;
+  UtilityHNS::DataRowIndex<Row> empty_index;
+  empty_index.Build(no_rows, &Row::ID);
+  ASSERT_EQ(nullptr, empty_index.GetDataRowById(0));
+
+  // readers that used to fill only the caller's list are indexed as well
+  std::string fileName = "/tmp/test_op_utility_vector.csv";
+  std::ofstream file(fileName.c_str());
+  file << "VID,PID,Hang,Vang" << std::endl;
+  file << "3,11,90.0,0.0" << std::endl;
+  file << "1000000,12,180.0,0.0" << std::endl;
+  file.close();
+  UtilityHNS::AisanVectorFileReader vectors(fileName);
+  std::vector<UtilityHNS::AisanVectorFileReader::AisanVector> vector_data;
+  ASSERT_EQ(2, vectors.ReadAllData(vector_data));
+  ASSERT_NE(nullptr, vectors.GetDataRowById(1000000));
+  ASSERT_EQ(12, vectors.GetDataRowById(1000000)->PID);
+  ASSERT_EQ(11, vectors.GetDataRowById(3)->PID);
+  ASSERT_EQ(nullptr, vectors.GetDataRowById(4));
+  remove(fileName.c_str());
+}
+
+TEST(TestSuite, StageTimer_latencyHistogram) {
+  UtilityHNS::LatencyHistogram hist;
+  ASSERT_EQ(0u, hist.GetCount());
+  ASSERT_DOUBLE_EQ(0, hist.GetPercentile(0.5));
+
+  // 98 samples of 1 ms and 2 of 50 ms
+  for(int i = 0; i < 98; i++)
+    hist.Add(0.001);
+  hist.Add(0.05);
+  hist.Add(0.05);
+
+  ASSERT_EQ(100u, hist.GetCount());
+  ASSERT_DOUBLE_EQ(0.05, hist.GetMax());
+  ASSERT_NEAR(0.00198, hist.GetMean(), 1e-9);
+  ASSERT_GE(hist.GetPercentile(0.5), 0.001);
+  ASSERT_LE(hist.GetPercentile(0.5), 0.001*UtilityHNS::LatencyHistogram::BIN_GROWTH);
+  ASSERT_GE(hist.GetPercentile(0.99), 0.05/UtilityHNS::LatencyHistogram::BIN_GROWTH);
+  ASSERT_LE(hist.GetPercentile(0.99), 0.05);
+  ASSERT_DOUBLE_EQ(0.05, hist.GetPercentile(1.0));
+
+  hist.Reset();
+  ASSERT_EQ(0u, hist.GetCount());
+  ASSERT_DOUBLE_EQ(0, hist.GetMax());
+}
+
+TEST(TestSuite, StageTimer_stageRecorder) {
+  UtilityHNS::StageLatencyRecorder recorder;
+  int a = recorder.AddStage("a");
+  int b = recorder.AddStage("b");
+  ASSERT_EQ(a, recorder.AddStage("a"));
+  ASSERT_EQ(2u, recorder.GetNumberOfStages());
+  ASSERT_EQ("b", recorder.GetStageName(b));
+
+  {
+    UtilityHNS::ScopedStageTimer timer(&recorder, b);
+    struct timespec sleep_time = {0, 2000000};
+    nanosleep(&sleep_time, nullptr);
+  }
+  recorder.Record(a, 0.003);
+
+  ASSERT_EQ(1u, recorder.GetHistogram(a).GetCount());
+  ASSERT_EQ(1u, recorder.GetHistogram(b).GetCount());
+  ASSERT_GE(recorder.GetHistogram(b).GetMax(), 0.002);
+  ASSERT_NE(std::string::npos, recorder.ToString().find("b"));
+
+  UtilityHNS::ScopedStageTimer no_recorder(nullptr, a);
+  recorder.Reset();
+  ASSERT_EQ(0u, recorder.GetHistogram(a).GetCount());
+}
+
+TEST(TestSuite, FastAngle_atan2Error) {
+  double max_error = 0;
+  for(int i = 0; i < 20000; i++)
+  {
+    double a = -M_PI + i * 2.0 * M_PI / 20000;
+    for(double r = 1e-3; r < 1e4; r *= 7.3)
+    {
+      double y = r * sin(a), x = r * cos(a);
+      max_error = std::max(max_error, fabs(UtilityHNS::FastAngle::Atan2(y, x) - atan2(y, x)));
+    }
+  }
+  ASSERT_LT(max_error, 1e-11);
+
+  ASSERT_EQ(0.0, UtilityHNS::FastAngle::Atan2(0, 0));
+  ASSERT_EQ(0.0, UtilityHNS::FastAngle::Atan2(0, 1));
+  ASSERT_NEAR(M_PI, UtilityHNS::FastAngle::Atan2(0, -1), 1e-15);
+  ASSERT_NEAR(-M_PI, UtilityHNS::FastAngle::Atan2(-0.0, -1), 1e-15);
+  ASSERT_NEAR(M_PI_2, UtilityHNS::FastAngle::Atan2(3, 0), 1e-15);
+  ASSERT_NEAR(-M_PI_2, UtilityHNS::FastAngle::Atan2(-3, 0), 1e-15);
+  ASSERT_NEAR(-3 * M_PI_4, UtilityHNS::FastAngle::Atan2(-2, -2), 1e-15);
+}
+
+TEST(TestSuite, FastAngle_sinCosError) {
+  double max_error = 0;
+  for(int i = -200000; i <= 200000; i++)
+  {
+    double a = i * 0.05 + 0.001 * (i % 7);
+    double s = 0, c = 0;
+    UtilityHNS::FastAngle::SinCos(a, s, c);
+    max_error = std::max(max_error, std::max(fabs(s - sin(a)), fabs(c - cos(a))));
+  }
+  ASSERT_LT(max_error, 1e-14);
+
+  double s = 1, c = 0;
+  UtilityHNS::FastAngle::SinCos(0, s, c);
+  ASSERT_EQ(0.0, s);
+  ASSERT_EQ(1.0, c);
+}
+
+TEST(TestSuite, FastAngle_wrap) {
+  double max_error = 0;
+  for(int i = -100000; i <= 100000; i++)
+  {
+    double a = i * 0.0123;
+    double fixed = UtilityHNS::FastAngle::FixNegativeAngle(a);
+    double split = UtilityHNS::FastAngle::SplitPositiveAngle(a);
+    ASSERT_GE(fixed, 0);
+    ASSERT_LT(fixed, 2 * M_PI);
+    ASSERT_GE(split, -M_PI);
+    ASSERT_LT(split, M_PI);
+
+    // the same angle as the UtilityH one, it can land on the other side of the wrap point
+    double e1 = fabs(UtilityHNS::FastAngle::SplitPositiveAngle(fixed - UtilityHNS::UtilityH::FixNegativeAngle(a)));
+    double e2 = fabs(UtilityHNS::FastAngle::SplitPositiveAngle(split - UtilityHNS::UtilityH::SplitPositiveAngle(a)));
+    max_error = std::max(max_error, std::max(e1, e2) / (1 + fabs(a)));
+
+    double a2 = fmod(i * 0.731, 2 * M_PI);
+    double b2 = fmod(i * 0.377 + 1.0, 2 * M_PI);
+    if(a2 < 0) a2 += 2 * M_PI;
+    if(b2 < 0) b2 += 2 * M_PI;
+    ASSERT_NEAR(UtilityHNS::UtilityH::AngleBetweenTwoAnglesPositive(a2, b2), UtilityHNS::FastAngle::AngleBetweenTwoAnglesPositive(a2, b2), 1e-14);
+  }
+  ASSERT_LT(max_error, 1e-15);
+
+  ASSERT_EQ(0.0, UtilityHNS::FastAngle::FixNegativeAngle(0));
+  ASSERT_EQ(M_PI, UtilityHNS::FastAngle::FixNegativeAngle(-M_PI));
+  ASSERT_EQ(-M_PI, UtilityHNS::FastAngle::SplitPositiveAngle(M_PI));
+  ASSERT_NEAR(M_PI, UtilityHNS::FastAngle::AngleBetweenTwoAnglesPositive(0.5, 0.5 + 3 * M_PI), 1e-14);
+}
+
+TEST(TestSuite, FastAngle_policy) {
+  // the default build keeps the libm results
+  double s = 0, c = 0;
+  UtilityHNS::PlannerAngle::SinCos(0.7, s, c);
+#if OP_FAST_ANGLE
+  ASSERT_NEAR(sin(0.7), s, 1e-14);
+#else
+  ASSERT_EQ(sin(0.7), s);
+  ASSERT_EQ(cos(0.7), c);
+  ASSERT_EQ(atan2(0.3, -0.2), UtilityHNS::PlannerAngle::Atan2(0.3, -0.2));
+  ASSERT_EQ(UtilityHNS::UtilityH::FixNegativeAngle(-7.5), UtilityHNS::PlannerAngle::FixNegativeAngle(-7.5));
+#endif
+}
+
+TEST(TestSuite, AsyncLogger_convertToText) {
+  std::string logFile = "/tmp/test_op_utility_async.oplog";
+  {
+    UtilityHNS::AsyncLogger logger(logFile, 4096, 0.01);
+    ASSERT_TRUE(logger.IsOpen());
+    int csv_log = logger.AddLog("test_op_utility_async_csv", "i,x,");
+    int time_log = logger.AddLog("test_op_utility_async_time", "t,i,", UtilityHNS::LOG_CSV_TIME);
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+      threads.push_back(std::thread([&logger, csv_log, t]() {
+        for (int i = 0; i < 250; i++) {
+          double values[2] = {(double)(t * 1000 + i), 0.5};
+          logger.Log(csv_log, values, 2);
+        }
+      }));
+    }
+    for (unsigned int t = 0; t < threads.size(); t++) {
+      threads.at(t).join();
+    }
+    double value = 7;
+    ASSERT_TRUE(logger.Log(time_log, &value, 1));
+    ASSERT_EQ(0u, logger.GetDroppedCount());
+  }
+
+  ASSERT_TRUE(UtilityHNS::AsyncLogger::ConvertToText(logFile, "/tmp/"));
+  std::ifstream csv("/tmp/test_op_utility_async_csv.csv");
+  std::string line;
+  std::getline(csv, line);
+  ASSERT_EQ("i,x,\r", line);
+  int nLines = 0;
+  while (std::getline(csv, line)) {
+    ASSERT_EQ(",0.5,\r", line.substr(line.find(',')));
+    nLines++;
+  }
+  ASSERT_EQ(1000, nLines);
+
+  std::ifstream time_csv("/tmp/test_op_utility_async_time.csv");
+  std::getline(time_csv, line);
+  std::getline(time_csv, line);
+  ASSERT_EQ(",7,\r", line.substr(line.find(',')));
+
+  ASSERT_FALSE(UtilityHNS::AsyncLogger::ConvertToText("/tmp/test_op_utility_no_such_file.oplog", "/tmp/"));
+  remove(logFile.c_str());
+  remove("/tmp/test_op_utility_async_csv.csv");
+  remove("/tmp/test_op_utility_async_time.csv");
+}
+
+TEST(TestSuite, ColumnarLog_objectsAndPath) {
+  std::string csvFile = "/tmp/test_op_utility_objects.csv";
+  std::string logFile = "/tmp/test_op_utility_objects.opcol";
+  std::ofstream file(csvFile.c_str());
+  file << "frame,id,x,y,z,a,v,w,l,h" << std::endl;
+  for (int i = 0; i < 1000; i++) {
+    file << i / 4 << "," << i % 4 << "," << i * 0.5 << "," << -i * 0.25 << ",0.125," << (i % 7) * 0.5 <<
+      ",3.5,1.5,4.25,1.75" << std::endl;
+  }
+  file.close();
+
+  UtilityHNS::ObjectsLogReader csv_reader(csvFile);
+  std::vector<UtilityHNS::ObjectsLogReader::ObjectRecord> csv_objects, objects;
+  ASSERT_EQ(1000, csv_reader.ReadAllData(csv_objects));
+  ASSERT_EQ(1000, UtilityHNS::ColumnarLog::ConvertObjectsLog(csvFile, logFile));
+  ASSERT_EQ(1000, UtilityHNS::ColumnarLog::ReadObjectsLog(logFile, objects));
+  for (unsigned int i = 0; i < objects.size(); i++) {
+    ASSERT_EQ(csv_objects.at(i).frame, objects.at(i).frame);
+    ASSERT_EQ(csv_objects.at(i).id, objects.at(i).id);
+    ASSERT_EQ(csv_objects.at(i).x, objects.at(i).x);
+    ASSERT_EQ(csv_objects.at(i).y, objects.at(i).y);
+    ASSERT_EQ(csv_objects.at(i).a, objects.at(i).a);
+    ASSERT_EQ(csv_objects.at(i).h, objects.at(i).h);
+  }
+
+  // frames 100 to 109
+  ASSERT_EQ(40, UtilityHNS::ColumnarLog::ReadObjectsLog(logFile, objects, 100, 109));
+  ASSERT_EQ(100, objects.front().frame);
+  ASSERT_EQ(109, objects.back().frame);
+
+  // only the chunks of the keys are read, only the asked columns are returned
+  std::vector<UtilityHNS::ColumnDefinition> columns;
+  columns.push_back(UtilityHNS::ColumnDefinition("t", UtilityHNS::COL_DOUBLE));
+  columns.push_back(UtilityHNS::ColumnDefinition("x", UtilityHNS::COL_FLOAT));
+  columns.push_back(UtilityHNS::ColumnDefinition("name", UtilityHNS::COL_STRING, 4));
+  {
+    UtilityHNS::ColumnarLogWriter writer(logFile, columns, 0, 100);
+    ASSERT_TRUE(writer.IsOpen());
+    for (int i = 0; i < 1050; i++) {
+      writer.SetValue(0, i * 0.1);
+      writer.SetValue(1, i * 2.0);
+      writer.SetString(2, (i % 2 == 0) ? "even_row" : "odd");
+      writer.EndRow();
+    }
+  }
+  UtilityHNS::ColumnarLogReader reader(logFile);
+  ASSERT_TRUE(reader.IsOpen());
+  ASSERT_EQ(1050u, reader.GetRowsCount());
+  ASSERT_EQ(11u, reader.GetChunksCount());
+  ASSERT_EQ(1, reader.GetColumnIndex("x"));
+  ASSERT_EQ(-1, reader.GetColumnIndex("y"));
+  std::vector<std::vector<double> > values;
+  ASSERT_EQ(11, reader.ReadColumns(std::vector<int>(1, 1), values, 49.95, 51.05));
+  ASSERT_EQ(1u, values.size());
+  ASSERT_EQ(1000.0, values.at(0).front());
+  ASSERT_EQ(1020.0, values.at(0).back());
+  ASSERT_EQ(-1, reader.ReadColumns(std::vector<int>(1, 2), values));
+  std::vector<std::string> names;
+  ASSERT_EQ(1050, reader.ReadStringColumn(2, names));
+  ASSERT_EQ("even", names.at(0));
+  ASSERT_EQ("odd", names.at(1));
+
+  // the key of a converted localization path is its row
+  std::ofstream path_file(csvFile.c_str());
+  path_file << "x,y,z,a,v" << std::endl;
+  for (int i = 0; i < 10; i++) {
+    path_file << i << ",0.5,0,0.25,2" << std::endl;
+  }
+  path_file.close();
+  std::vector<UtilityHNS::LocalizationPathReader::LocalizationWayPoint> path;
+  ASSERT_EQ(10, UtilityHNS::ColumnarLog::ConvertLocalizationPath(csvFile, ',', logFile));
+  ASSERT_EQ(3, UtilityHNS::ColumnarLog::ReadLocalizationPath(logFile, path, 4, 6));
+  ASSERT_EQ(4.0, path.front().t);
+  ASSERT_EQ(4.0, path.front().x);
+  ASSERT_EQ(0.25, path.front().a);
+
+  UtilityHNS::ColumnarLogReader missing_reader("/tmp/test_op_utility_no_such_file.opcol");
+  ASSERT_FALSE(missing_reader.IsOpen());
+  ASSERT_EQ(-1, UtilityHNS::ColumnarLog::ReadObjectsLog(csvFile, objects));
+  remove(csvFile.c_str());
+  remove(logFile.c_str());
+}
+
 int main(int argc, char ** argv)
 {
   testing::InitGoogleTest(&argc, argv);
@@ -18,6 +18,7 @@
  *
  */
 
+#include <memory>
 #include <string>
 #include <boost/interprocess/managed_shared_memory.hpp>
 #include <boost/interprocess/sync/interprocess_mutex.hpp>
@@ -42,12 +43,17 @@ public:
   bool is_error_detected(void);
 
 protected:
-  std::string name_, shm_name_, mut_name_;
+  std::string name_, shm_name_;
   VitalMonitorMode mode_;
   bool is_opened_;
   const unsigned int polling_interval_msec_;
+  // the segment stays mapped, it is opened again from time to time in case ros_observer created a new one
+  std::unique_ptr<boost::interprocess::managed_shared_memory> shm_;
+  ShmVitalCounter* p_cnt_;
+  int64_t opened_nsec_;
 
   bool attempt_to_open(void);
+  ShmVitalCounter* get_vital_counter(void);
   void init_vital_counter(void);
   void update_vital_counter(void);
 };
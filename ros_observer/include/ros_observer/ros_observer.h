@@ -18,11 +18,16 @@
  *
  */
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <iostream>
 #include <string>
 #include <functional>
 #include <utility>
 #include <boost/interprocess/managed_shared_memory.hpp>
+#include <boost/interprocess/sync/interprocess_condition.hpp>
 #include <boost/interprocess/sync/interprocess_mutex.hpp>
 #include <boost/interprocess/sync/scoped_lock.hpp>
 #include <boost/thread.hpp>
@@ -31,6 +36,14 @@ static constexpr const char* SHM_NAME = "SharedMemoryForVitalMonitor";
 static constexpr int SHM_SIZE = 65536;
 static constexpr unsigned int SHM_TH_COUNTER = 3;
 static constexpr unsigned int SHM_COUNTER_MAX = 10000;
+static constexpr const char* SHM_NOTIFIER_NAME = "SHM_VitalNotifier";
+static constexpr int SHM_SEQLOCK_RETRY = 100;
+
+inline int64_t get_steady_nsec(void)
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+}
 
 enum class ModuleStatus
 {
@@ -38,16 +51,97 @@ enum class ModuleStatus
   ErrorDetected
 };
 
+// The counters are shared without lock, so that a process dying while it
+// updates one does not block the others. The fields are lock-free atomics,
+// hence address-free and valid in shared memory.
 struct ShmVitalCounter
 {
-  ModuleStatus modstatus;
+  // activated and thresh are written by the clearing side only, sequence is
+  // odd while they are written
+  std::atomic<uint32_t> sequence;
+  std::atomic<bool> activated;
+  std::atomic<unsigned int> thresh;
+
+  // cleared by one side, incremented by the other one
+  std::atomic<unsigned int> value;
+  // steady clock of the last clear, common to the processes of the host
+  std::atomic<int64_t> cleared_nsec;
+  std::atomic<ModuleStatus> modstatus;
+
+  ShmVitalCounter() :
+  sequence(0), activated(false), thresh(0), value(0), cleared_nsec(0), modstatus(ModuleStatus::Normal) {}
+};
 
+struct ShmVitalConfig
+{
   bool activated;
   unsigned int thresh;
-  unsigned int value;
 
-  ShmVitalCounter() :
-  modstatus(ModuleStatus::Normal), activated(false), thresh(0), value(0) {}
+  ShmVitalConfig() : activated(false), thresh(0) {}
+};
+
+inline void write_vital_config(ShmVitalCounter* p_cnt, const ShmVitalConfig& config)
+{
+  // a sequence left odd by a dead writer is completed
+  const uint32_t sequence = (p_cnt->sequence.load(std::memory_order_relaxed) + 1) & ~1u;
+  p_cnt->sequence.store(sequence + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  p_cnt->thresh.store(config.thresh, std::memory_order_relaxed);
+  p_cnt->activated.store(config.activated, std::memory_order_relaxed);
+  p_cnt->sequence.store(sequence + 2, std::memory_order_release);
+}
+
+// false when no consistent config could be read, config is then unchanged
+inline bool read_vital_config(const ShmVitalCounter& cnt, ShmVitalConfig* config)
+{
+  for (int i = 0; i < SHM_SEQLOCK_RETRY; i++)
+  {
+    const uint32_t sequence = cnt.sequence.load(std::memory_order_acquire);
+    if (sequence & 1u)
+    {
+      continue;
+    }
+    ShmVitalConfig read;
+    read.activated = cnt.activated.load(std::memory_order_relaxed);
+    read.thresh = cnt.thresh.load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (cnt.sequence.load(std::memory_order_relaxed) == sequence)
+    {
+      *config = read;
+      return true;
+    }
+  }
+  return false;
+}
+
+inline void clear_vital_counter(ShmVitalCounter* p_cnt)
+{
+  p_cnt->cleared_nsec.store(get_steady_nsec(), std::memory_order_relaxed);
+  p_cnt->value.store(0, std::memory_order_release);
+}
+
+// value + step up to SHM_COUNTER_MAX, unless the clearing side clears it meanwhile
+inline unsigned int increment_vital_counter(ShmVitalCounter* p_cnt, const unsigned int step)
+{
+  unsigned int value = p_cnt->value.load(std::memory_order_relaxed);
+  unsigned int next;
+  do
+  {
+    next = std::min(value + step, SHM_COUNTER_MAX);
+  } while (!p_cnt->value.compare_exchange_weak(value, next, std::memory_order_acq_rel));
+  return next;
+}
+
+// Created by ros_observer in the notified mode only. The counters are then
+// evaluated at their deadlines, and a module waking it up when it is activated
+// or recovers from a timeout is taken into account right away.
+struct ShmVitalNotifier
+{
+  boost::interprocess::interprocess_mutex mutex;
+  boost::interprocess::interprocess_condition condition;
+  bool notified;
+
+  ShmVitalNotifier() : notified(false) {}
 };
 
 #endif  // ROS_OBSERVER_ROS_OBSERVER_H
@@ -27,9 +27,24 @@ using boost::interprocess::open_only;
 using boost::interprocess::interprocess_mutex;
 using boost::interprocess::interprocess_exception;
 
+// wakes up ros_observer when it runs in the notified mode
+static void notify_observer(managed_shared_memory* shm)
+{
+  ShmVitalNotifier* p_notifier = shm->find<ShmVitalNotifier>(SHM_NOTIFIER_NAME).first;
+  if (p_notifier == nullptr)
+  {
+    return;
+  }
+  scoped_lock<interprocess_mutex> scpdlock(p_notifier->mutex);
+  p_notifier->notified = true;
+  p_notifier->condition.notify_one();
+}
+
+static constexpr int64_t SHM_REOPEN_INTERVAL_NSEC = 1000000000;
+
 ShmVitalMonitor::ShmVitalMonitor(std::string mod_name, const double loop_rate, VitalMonitorMode mode) :
-  is_opened_(false), name_(mod_name), shm_name_("SHM_" + mod_name), mut_name_("MUT_" + mod_name),
-  mode_(mode), polling_interval_msec_(1000.0/loop_rate) {}
+  is_opened_(false), name_(mod_name), shm_name_("SHM_" + mod_name),
+  mode_(mode), polling_interval_msec_(1000.0/loop_rate), p_cnt_(nullptr), opened_nsec_(0) {}
 
 void ShmVitalMonitor::run(void)
 {
@@ -48,65 +63,80 @@ void ShmVitalMonitor::init_vital_counter(void)
 {
   if (mode_ == VitalMonitorMode::CNT_CLEAR)
   {
-    try
-    {
-      managed_shared_memory shm(open_only, SHM_NAME);
-      ShmVitalCounter* p_cnt = shm.find<ShmVitalCounter>(shm_name_.c_str()).first;
-      interprocess_mutex* p_mut = shm.find<interprocess_mutex>(mut_name_.c_str()).first;
-      scoped_lock<interprocess_mutex> scpdlock(*p_mut);
-
-      p_cnt->activated = true;
-      p_cnt->thresh = (polling_interval_msec_)*(SHM_TH_COUNTER);
-      p_cnt->value = 0;
-    }
-    catch(interprocess_exception &ex)
+    ShmVitalCounter* p_cnt = get_vital_counter();
+    if (p_cnt == nullptr)
     {
       std::cout << "[INFO][Failed to connect shared memory]" << std::endl;
+      return;
     }
+
+    ShmVitalConfig config;
+    config.activated = true;
+    config.thresh = (polling_interval_msec_)*(SHM_TH_COUNTER);
+    clear_vital_counter(p_cnt);
+    write_vital_config(p_cnt, config);
+    notify_observer(shm_.get());
   }
 }
 
 void ShmVitalMonitor::update_vital_counter(void)
 {
-  try
+  const int64_t opened_nsec = opened_nsec_;
+  ShmVitalCounter* p_cnt = get_vital_counter();
+  if (p_cnt == nullptr)
   {
-    managed_shared_memory shm(open_only, SHM_NAME);
-    ShmVitalCounter* p_cnt = shm.find<ShmVitalCounter>(shm_name_.c_str()).first;
-    interprocess_mutex* p_mut = shm.find<interprocess_mutex>(mut_name_.c_str()).first;
-    scoped_lock<interprocess_mutex> scpdlock(*p_mut);
+    std::cout << "[INFO][Failed to connect shared memory]" << std::endl;
+    return;
+  }
 
-    if (mode_ == VitalMonitorMode::CNT_CLEAR)
+  ShmVitalConfig config;
+  read_vital_config(*p_cnt, &config);
+  if (mode_ == VitalMonitorMode::CNT_CLEAR)
+  {
+    if (opened_nsec_ != opened_nsec && !config.activated)
     {
-      p_cnt->value = 0;
+      // segment created again by a restarted ros_observer
+      init_vital_counter();
+      return;
     }
-    else if (mode_ == VitalMonitorMode::CNT_MON)
+    const bool is_recovered = (p_cnt->value.load(std::memory_order_relaxed) > config.thresh);
+    clear_vital_counter(p_cnt);
+    // a clear in time only moves the deadline later, no wake up is needed
+    if (is_recovered)
     {
-      p_cnt->value = (p_cnt->activated) ? std::min((p_cnt->value + polling_interval_msec_), SHM_COUNTER_MAX) : 0;
-      p_cnt->modstatus = (p_cnt->value > p_cnt->thresh) ? ModuleStatus::ErrorDetected : ModuleStatus::Normal;
+      notify_observer(shm_.get());
     }
   }
-  catch(interprocess_exception &ex)
+  else if (mode_ == VitalMonitorMode::CNT_MON)
   {
-    std::cout << "[INFO][Failed to connect shared memory]" << std::endl;
+    const unsigned int value = (config.activated) ? increment_vital_counter(p_cnt, polling_interval_msec_) : 0;
+    p_cnt->modstatus.store((value > config.thresh) ? ModuleStatus::ErrorDetected : ModuleStatus::Normal);
   }
 }
 
 bool ShmVitalMonitor::attempt_to_open(void)
 {
-  bool is_opened = false;
-
+  opened_nsec_ = get_steady_nsec();
+  p_cnt_ = nullptr;
   try
   {
-    managed_shared_memory shm(open_only, SHM_NAME);
-    ShmVitalCounter* p_cnt = shm.find<ShmVitalCounter>(shm_name_.c_str()).first;
-    interprocess_mutex* p_mut = shm.find<interprocess_mutex>(mut_name_.c_str()).first;
-    is_opened = true;
+    shm_.reset(new managed_shared_memory(open_only, SHM_NAME));
+    p_cnt_ = shm_->find<ShmVitalCounter>(shm_name_.c_str()).first;
   }
   catch(interprocess_exception &ex)
   {
-    is_opened = false;
+    shm_.reset();
   }
-  return is_opened;
+  return (p_cnt_ != nullptr);
+}
+
+ShmVitalCounter* ShmVitalMonitor::get_vital_counter(void)
+{
+  if (p_cnt_ == nullptr || (get_steady_nsec() - opened_nsec_) > SHM_REOPEN_INTERVAL_NSEC)
+  {
+    attempt_to_open();
+  }
+  return p_cnt_;
 }
 
 bool ShmVitalMonitor::is_error_detected(void)
@@ -119,19 +149,8 @@ bool ShmVitalMonitor::is_error_detected(void)
   }
   else
   {
-    try
-    {
-      managed_shared_memory shm(open_only, SHM_NAME);
-      ShmVitalCounter* p_cnt = shm.find<ShmVitalCounter>(shm_name_.c_str()).first;
-      interprocess_mutex* p_mut = shm.find<interprocess_mutex>(mut_name_.c_str()).first;
-
-      scoped_lock<interprocess_mutex> scpdlock(*p_mut);
-      is_error_detected = (p_cnt->modstatus == ModuleStatus::ErrorDetected) ? true : false;
-    }
-    catch(interprocess_exception &ex)
-    {
-      is_error_detected = true;
-    }
+    ShmVitalCounter* p_cnt = get_vital_counter();
+    is_error_detected = (p_cnt == nullptr || p_cnt->modstatus.load() == ModuleStatus::ErrorDetected);
   }
   return is_error_detected;
 }
@@ -20,6 +20,7 @@
 #include <iostream>
 #include <string>
 #include <algorithm>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
 #include <ros_observer/ros_observer.h>
 
 using boost::interprocess::managed_shared_memory;
@@ -35,6 +36,8 @@ static constexpr double ROS_OBSERVE_MONITOR_RATE = 100;
 static constexpr unsigned int POLLING_INTERVAL_MSEC = (1000.0 / ROS_OBSERVE_MONITOR_RATE);
 static constexpr unsigned int POLLING_INTERVAL_USEC = (POLLING_INTERVAL_MSEC * 1000);
 static constexpr unsigned int SHM_TH_COUNTER_RO = 10;
+// the counter of ros_observer is cleared twice within its threshold
+static constexpr int64_t RO_CLEAR_INTERVAL_NSEC = (POLLING_INTERVAL_MSEC) * (SHM_TH_COUNTER_RO) * 1000000 / 2;
 
 static bool terminate_req_rcvd = false;
 
@@ -68,10 +71,71 @@ static void sig_handler_init(void)
   }
 }
 
+struct MonitoredModule
+{
+  const char* shm_name;
+  const char* error_node;
+  ShmVitalCounter* p_cnt;
+  // last consistent config, kept when the module died while writing it
+  ShmVitalConfig config;
+};
+
+// In the polling mode a counter grows by POLLING_INTERVAL_MSEC each cycle,
+// in the notified mode it is the time since the module cleared it
+static unsigned int update_counter_value(MonitoredModule* module, const bool notified_mode, const int64_t now_nsec)
+{
+  read_vital_config(*module->p_cnt, &module->config);
+  if (!module->config.activated)
+  {
+    module->p_cnt->value.store(0);
+    return 0;
+  }
+  if (!notified_mode)
+  {
+    return increment_vital_counter(module->p_cnt, POLLING_INTERVAL_MSEC);
+  }
+  const int64_t cleared_nsec = module->p_cnt->cleared_nsec.load(std::memory_order_acquire);
+  const int64_t elapsed_msec = std::max<int64_t>((now_nsec - cleared_nsec) / 1000000, 0);
+  const unsigned int value = static_cast<unsigned int>(std::min<int64_t>(elapsed_msec, SHM_COUNTER_MAX));
+  module->p_cnt->value.store(value);
+  return value;
+}
+
+// steady clock when the counter exceeds its threshold, unless the module clears it before
+static int64_t counter_deadline_nsec(const MonitoredModule& module)
+{
+  return module.p_cnt->cleared_nsec.load(std::memory_order_acquire) +
+         (static_cast<int64_t>(module.config.thresh) + 1) * 1000000;
+}
+
+// Sleeps until wakeup_nsec or until a module notifies a change
+static void wait_for_notification(ShmVitalNotifier* p_notifier, const int64_t wakeup_nsec)
+{
+  scoped_lock<interprocess_mutex> scpdlock(p_notifier->mutex);
+  if (!p_notifier->notified)
+  {
+    const int64_t timeout_usec = std::max<int64_t>((wakeup_nsec - get_steady_nsec()) / 1000, 0);
+    const boost::posix_time::ptime abs_time =
+        boost::posix_time::microsec_clock::universal_time() + boost::posix_time::microseconds(timeout_usec);
+    p_notifier->condition.timed_wait(scpdlock, abs_time);
+  }
+  p_notifier->notified = false;
+}
+
 int main(int argc, char* argv[])
 {
   sig_handler_init();
 
+  // --notified evaluates the counters at their deadlines instead of every POLLING_INTERVAL_MSEC
+  bool notified_mode = false;
+  for (int i = 1; i < argc; i++)
+  {
+    if (std::string(argv[i]) == "--notified")
+    {
+      notified_mode = true;
+    }
+  }
+
   struct tm localtime;
   auto now = std::chrono::system_clock::now();
   auto now_c = std::chrono::system_clock::to_time_t(now);
@@ -82,110 +146,88 @@ int main(int argc, char* argv[])
   managed_shared_memory shm(create_only, SHM_NAME, SHM_SIZE);
 
   ShmVitalCounter* p_cnt_RO = shm.construct<ShmVitalCounter>("SHM_RosObserver")();
-  ShmVitalCounter* p_cnt_HA = shm.construct<ShmVitalCounter>("SHM_HealthAggregator")();
-  ShmVitalCounter* p_cnt_EH = shm.construct<ShmVitalCounter>("SHM_EmergencyHandler")();
-  ShmVitalCounter* p_cnt_TG = shm.construct<ShmVitalCounter>("SHM_TwistGate")();
-  ShmVitalCounter* p_cnt_YMC = shm.construct<ShmVitalCounter>("SHM_YMC_VehicleDriver")();
-  ShmVitalCounter* p_cnt_AS = shm.construct<ShmVitalCounter>("SHM_AS_VehicleDriver")();
+  MonitoredModule modules[] = {
+    { "SHM_HealthAggregator", "Health Aggregator", nullptr, ShmVitalConfig() },
+    { "SHM_EmergencyHandler", "Emergency Handler", nullptr, ShmVitalConfig() },
+    { "SHM_TwistGate", "Twist Gate", nullptr, ShmVitalConfig() },
+    { "SHM_YMC_VehicleDriver", "YMC Vehicle Driver", nullptr, ShmVitalConfig() },
+    { "SHM_AS_VehicleDriver", "AS Vehicle Driver", nullptr, ShmVitalConfig() },
+  };
+  for (MonitoredModule& module : modules)
+  {
+    module.p_cnt = shm.construct<ShmVitalCounter>(module.shm_name)();
+  }
+  ShmVitalCounter* p_cnt_HA = modules[0].p_cnt;
   bool* p_stopReq_DR = shm.construct<bool>("SHM_DRStopRequest")();
 
-  interprocess_mutex* p_mut_RO = shm.construct<interprocess_mutex>("MUT_RosObserver")();
-  interprocess_mutex* p_mut_HA = shm.construct<interprocess_mutex>("MUT_HealthAggregator")();
-  interprocess_mutex* p_mut_EH = shm.construct<interprocess_mutex>("MUT_EmergencyHandler")();
-  interprocess_mutex* p_mut_TG = shm.construct<interprocess_mutex>("MUT_TwistGate")();
-  interprocess_mutex* p_mut_YMC = shm.construct<interprocess_mutex>("MUT_YMC_VehicleDriver")();
-  interprocess_mutex* p_mut_AS = shm.construct<interprocess_mutex>("MUT_AS_VehicleDriver")();
   interprocess_mutex* p_mut_DR = shm.construct<interprocess_mutex>("MUT_DRStopRequest")();
+  ShmVitalNotifier* p_notifier = (notified_mode) ? shm.construct<ShmVitalNotifier>(SHM_NOTIFIER_NAME)() : nullptr;
 
-  {
-    scoped_lock<interprocess_mutex> scpdlock_RO(*p_mut_RO);
-    p_cnt_RO->activated = true;
-    p_cnt_RO->thresh = (POLLING_INTERVAL_MSEC) * (SHM_TH_COUNTER_RO);
-    p_cnt_RO->value = 0;
-  }
+  ShmVitalConfig config_RO;
+  config_RO.activated = true;
+  config_RO.thresh = (POLLING_INTERVAL_MSEC) * (SHM_TH_COUNTER_RO);
+  clear_vital_counter(p_cnt_RO);
+  write_vital_config(p_cnt_RO, config_RO);
 
   while (!terminate_req_rcvd)
   {
-    {
-      scoped_lock<interprocess_mutex> scpdlock_RO(*p_mut_RO);
-      scoped_lock<interprocess_mutex> scpdlock_HA(*p_mut_HA);
-      scoped_lock<interprocess_mutex> scpdlock_EH(*p_mut_EH);
-      scoped_lock<interprocess_mutex> scpdlock_TG(*p_mut_TG);
-      scoped_lock<interprocess_mutex> scpdlock_YMC(*p_mut_YMC);
-      scoped_lock<interprocess_mutex> scpdlock_AS(*p_mut_AS);
-      scoped_lock<interprocess_mutex> scpdlock_DR(*p_mut_DR);
-
-      p_cnt_RO->value = 0;
-      p_cnt_HA->value =
-          (p_cnt_HA->activated) ? std::min((p_cnt_HA->value + (POLLING_INTERVAL_MSEC)), SHM_COUNTER_MAX) : 0;
-      p_cnt_EH->value =
-          (p_cnt_EH->activated) ? std::min((p_cnt_EH->value + (POLLING_INTERVAL_MSEC)), SHM_COUNTER_MAX) : 0;
-      p_cnt_TG->value =
-          (p_cnt_TG->activated) ? std::min((p_cnt_TG->value + (POLLING_INTERVAL_MSEC)), SHM_COUNTER_MAX) : 0;
-      p_cnt_YMC->value =
-          (p_cnt_YMC->activated) ? std::min((p_cnt_YMC->value + (POLLING_INTERVAL_MSEC)), SHM_COUNTER_MAX) : 0;
-      p_cnt_AS->value =
-          (p_cnt_AS->activated) ? std::min((p_cnt_AS->value + (POLLING_INTERVAL_MSEC)), SHM_COUNTER_MAX) : 0;
-
-      static bool ros_error_detected_prev = false;
-      bool ros_error_detected = false;
-      std::string error_node;
-
-      if (p_cnt_HA->value > p_cnt_HA->thresh)
-      {
-        ros_error_detected = true;
-        error_node = "Health Aggregator";
-      }
+    const int64_t now_nsec = get_steady_nsec();
+    int64_t wakeup_nsec = now_nsec + RO_CLEAR_INTERVAL_NSEC;
+    clear_vital_counter(p_cnt_RO);
 
-      if (p_cnt_EH->value > p_cnt_EH->thresh)
-      {
-        ros_error_detected = true;
-        error_node = "Emergency Handler";
-      }
+    static bool ros_error_detected_prev = false;
+    bool ros_error_detected = false;
+    std::string error_node;
 
-      if (p_cnt_TG->value > p_cnt_TG->thresh)
+    for (MonitoredModule& module : modules)
+    {
+      const unsigned int value = update_counter_value(&module, notified_mode, now_nsec);
+      if (value > module.config.thresh)
       {
         ros_error_detected = true;
-        error_node = "Twist Gate";
+        error_node = module.error_node;
       }
-
-      if (p_cnt_YMC->value > p_cnt_YMC->thresh)
+      else if (module.config.activated)
       {
-        ros_error_detected = true;
-        error_node = "YMC Vehicle Driver";
+        // a counter already over its threshold stays so until the module notifies its recovery
+        wakeup_nsec = std::min(wakeup_nsec, counter_deadline_nsec(module));
       }
+    }
 
-      if (p_cnt_AS->value > p_cnt_AS->thresh)
+    if (ros_error_detected)
+    {
+      p_cnt_HA->modstatus.store(ModuleStatus::ErrorDetected);
+      if (!ros_error_detected_prev)
       {
-        ros_error_detected = true;
-        error_node = "AS Vehicle Driver";
+        scoped_lock<interprocess_mutex> scpdlock_DR(*p_mut_DR);
+        (*p_stopReq_DR) = true;
       }
 
-      if (ros_error_detected)
-      {
-        p_cnt_HA->modstatus = ModuleStatus::ErrorDetected;
-        if (!ros_error_detected_prev)
-        {
-          (*p_stopReq_DR) = true;
-        }
-
-        auto now = std::chrono::system_clock::now();
-        auto now_c = std::chrono::system_clock::to_time_t(now);
-        localtime_r(&now_c, &localtime);
-        std::cerr << "[START][TIME][LOCAL: " << std::put_time(&localtime, "%c") << "][" << error_node.c_str() << "]"
-                  << std::endl;
-      }
-      else
+      auto now = std::chrono::system_clock::now();
+      auto now_c = std::chrono::system_clock::to_time_t(now);
+      localtime_r(&now_c, &localtime);
+      std::cerr << "[START][TIME][LOCAL: " << std::put_time(&localtime, "%c") << "][" << error_node.c_str() << "]"
+                << std::endl;
+    }
+    else
+    {
+      p_cnt_HA->modstatus.store(ModuleStatus::Normal);
+      if (ros_error_detected_prev)
       {
-        p_cnt_HA->modstatus = ModuleStatus::Normal;
-        if (ros_error_detected_prev)
-        {
-          (*p_stopReq_DR) = false;
-        }
+        scoped_lock<interprocess_mutex> scpdlock_DR(*p_mut_DR);
+        (*p_stopReq_DR) = false;
       }
-      ros_error_detected_prev = ros_error_detected;
     }
-    usleep(POLLING_INTERVAL_USEC);
+    ros_error_detected_prev = ros_error_detected;
+
+    if (notified_mode)
+    {
+      wait_for_notification(p_notifier, wakeup_nsec);
+    }
+    else
+    {
+      usleep(POLLING_INTERVAL_USEC);
+    }
   }
 
   shared_memory_object::remove(SHM_NAME);
@@ -70,7 +70,6 @@ public:
   void nameTestVM(void)
   {
     ASSERT_EQ(myVMObj_->shm_name_, "SHM_NameTest");
-    ASSERT_EQ(myVMObj_->mut_name_, "MUT_NameTest");
   }
 
   void openTestVM(void)
@@ -79,7 +78,6 @@ public:
 
     managed_shared_memory shm_new(create_only, SHM_NAME, SHM_SIZE);
     ShmVitalCounter*  p_cnt_new = shm_new.construct<ShmVitalCounter>(myVMObj_->shm_name_.c_str())();
-    interprocess_mutex* p_mut_new = shm_new.construct<interprocess_mutex>(myVMObj_->mut_name_.c_str())();
 
     ASSERT_TRUE(myVMObj_->attempt_to_open());
 
@@ -90,7 +88,6 @@ public:
   {
     managed_shared_memory shm_new(create_only, SHM_NAME, SHM_SIZE);
     ShmVitalCounter*  p_cnt_new = shm_new.construct<ShmVitalCounter>(myVMObj_->shm_name_.c_str())();
-    interprocess_mutex* p_mut_new = shm_new.construct<interprocess_mutex>(myVMObj_->mut_name_.c_str())();
 
     myVMObj_->run();
     ASSERT_TRUE(p_cnt_new->activated);
@@ -102,7 +99,6 @@ public:
   {
     managed_shared_memory shm_new(create_only, SHM_NAME, SHM_SIZE);
     ShmVitalCounter*  p_cnt_new = shm_new.construct<ShmVitalCounter>(myVMObj_->shm_name_.c_str())();
-    interprocess_mutex* p_mut_new = shm_new.construct<interprocess_mutex>(myVMObj_->mut_name_.c_str())();
 
     myVMObj_->mode_ = VitalMonitorMode::CNT_CLEAR;
     p_cnt_new->activated = true;
@@ -127,13 +123,60 @@ public:
     shared_memory_object::remove(SHM_NAME);
   }
 
+  void notifyTestVM(void)
+  {
+    managed_shared_memory shm_new(create_only, SHM_NAME, SHM_SIZE);
+    ShmVitalCounter*  p_cnt_new = shm_new.construct<ShmVitalCounter>(myVMObj_->shm_name_.c_str())();
+    ShmVitalNotifier* p_notifier_new = shm_new.construct<ShmVitalNotifier>(SHM_NOTIFIER_NAME)();
+
+    myVMObj_->run();
+    ASSERT_TRUE(p_notifier_new->notified);
+    ASSERT_GT(p_cnt_new->cleared_nsec, 0);
+
+    p_notifier_new->notified = false;
+    myVMObj_->update_vital_counter();
+    ASSERT_FALSE(p_notifier_new->notified);
+
+    p_cnt_new->value = p_cnt_new->thresh + 1;
+    myVMObj_->update_vital_counter();
+    ASSERT_EQ(p_cnt_new->value, 0);
+    ASSERT_TRUE(p_notifier_new->notified);
+
+    shared_memory_object::remove(SHM_NAME);
+  }
+
+  void seqlockTestVM(void)
+  {
+    ShmVitalCounter cnt;
+    ShmVitalConfig config;
+    config.activated = true;
+    config.thresh = 30;
+    write_vital_config(&cnt, config);
+
+    ShmVitalConfig read;
+    ASSERT_TRUE(read_vital_config(cnt, &read));
+    ASSERT_TRUE(read.activated);
+    ASSERT_EQ(read.thresh, 30);
+
+    // writer died while writing the config
+    cnt.sequence.fetch_add(1);
+    cnt.thresh = 60;
+    ASSERT_FALSE(read_vital_config(cnt, &read));
+    ASSERT_EQ(read.thresh, 30);
+
+    config.thresh = 90;
+    write_vital_config(&cnt, config);
+    ASSERT_EQ(cnt.sequence.load() % 2, 0);
+    ASSERT_TRUE(read_vital_config(cnt, &read));
+    ASSERT_EQ(read.thresh, 90);
+  }
+
   void errorDetectionTestVM(void)
   {
     ASSERT_FALSE(myVMObj_->is_opened_);
 
     managed_shared_memory shm_new(create_only, SHM_NAME, SHM_SIZE);
     ShmVitalCounter*  p_cnt_new = shm_new.construct<ShmVitalCounter>(myVMObj_->shm_name_.c_str())();
-    interprocess_mutex* p_mut_new = shm_new.construct<interprocess_mutex>(myVMObj_->mut_name_.c_str())();
 
     myVMObj_->run();
     p_cnt_new->modstatus = ModuleStatus::Normal;
@@ -223,6 +266,18 @@ TEST_F(ShmTestSuite, UpdateTestVM)
   updateTestVM();
 }
 
+TEST_F(ShmTestSuite, NotifyTestVM)
+{
+  setupVM("NotifyTest", 100.0);
+  notifyTestVM();
+}
+
+TEST_F(ShmTestSuite, SeqlockTestVM)
+{
+  setupVM("SeqlockTest", 100.0);
+  seqlockTestVM();
+}
+
 TEST_F(ShmTestSuite, ErrorDetectionTestVM)
 {
   setupVM("ErrorDetectionTest", 100.0);
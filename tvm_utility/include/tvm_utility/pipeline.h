@@ -20,9 +20,29 @@
 #include <tvm_vendor/tvm/runtime/module.h>
 #include <tvm_vendor/tvm/runtime/packed_func.h>
 #include <tvm_vendor/tvm/runtime/registry.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
 #include <fstream>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <tuple>
 #include <utility>
 #include <vector>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
 
 #ifndef TVM_UTILITY_PIPELINE_H
 #define TVM_UTILITY_PIPELINE_H
@@ -47,6 +67,17 @@ public:
     handle_ = std::make_shared<TVMArrayHandle>(x);
   }
 
+  /**
+   * @brief View of an array of the TVM runtime, such as a graph output. The
+   * container keeps the array alive.
+   */
+  explicit TVMArrayContainer(tvm::runtime::NDArray array)
+  {
+    TVMArrayHandle x = const_cast<TVMArrayHandle>(array.operator->());
+    handle_ = std::shared_ptr<TVMArrayHandle>(
+        new TVMArrayHandle(x), [array](TVMArrayHandle *ptr) { delete ptr; });
+  }
+
   TVMArrayHandle getArray() const { return *handle_.get(); }
 
 private:
@@ -120,6 +151,160 @@ template <class OutputType>
 class PostProcessor
     : public PipelineStage<TVMArrayContainerVector, OutputType> {};
 
+/**
+ * @brief The stages of a pipeline, as reported to a StageTimer.
+ */
+enum class Stage
+{
+  PreProcessing,
+  Inference,
+  PostProcessing
+};
+
+/**
+ * @brief Called by a pipeline with the time the schedule of a stage took for
+ * one input. The stages of an AsyncPipeline call it from their own threads.
+ */
+using StageTimer = std::function<void(Stage, std::chrono::nanoseconds)>;
+
+/**
+ * @class PipelineStatistics
+ * @brief Rolling statistics of the last window_size inputs of each stage of a
+ * pipeline, recorded by the StageTimer of timer().
+ */
+class PipelineStatistics
+{
+public:
+  typedef struct
+  {
+    // number of inputs in the window
+    size_t count;
+
+    // schedule time of the stage, in milliseconds
+    double mean_ms;
+    double p99_ms;
+
+    // standard deviation of the schedule time, in milliseconds
+    double jitter_ms;
+
+    // inputs processed by the stage per second of wall clock in the window,
+    // the throughput of the whole pipeline for its slowest stage
+    double fps;
+  }
+  Summary;
+
+  explicit PipelineStatistics(size_t window_size = 1000)
+      : window_size_(std::max<size_t>(window_size, 1)) {}
+
+  PipelineStatistics(const PipelineStatistics &) = delete;
+  PipelineStatistics &operator=(const PipelineStatistics &) = delete;
+
+  /**
+   * @brief Timer recording in this object, which has to outlive the pipeline.
+   */
+  StageTimer timer()
+  {
+    return [this](Stage stage, std::chrono::nanoseconds duration)
+    {
+      record(stage, duration);
+    };
+  }
+
+  void record(Stage stage, std::chrono::nanoseconds duration)
+  {
+    const auto end = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto &samples = samples_[static_cast<size_t>(stage)];
+    samples.push_back(std::make_pair(duration, end));
+    if (samples.size() > window_size_)
+    {
+      samples.pop_front();
+    }
+  }
+
+  Summary summary(Stage stage) const
+  {
+    std::vector<double> durations_ms;
+    std::chrono::steady_clock::duration elapsed{};
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      const auto &samples = samples_[static_cast<size_t>(stage)];
+      for (const auto &sample : samples)
+      {
+        durations_ms.push_back(
+            std::chrono::duration<double, std::milli>(sample.first).count());
+      }
+      if (!samples.empty())
+      {
+        elapsed = samples.back().second - samples.front().second;
+      }
+    }
+
+    Summary summary{durations_ms.size(), 0.0, 0.0, 0.0, 0.0};
+    if (durations_ms.empty())
+    {
+      return summary;
+    }
+    double sum = 0.0;
+    for (const double duration : durations_ms)
+    {
+      sum += duration;
+    }
+    summary.mean_ms = sum / durations_ms.size();
+    double square_sum = 0.0;
+    for (const double duration : durations_ms)
+    {
+      square_sum += (duration - summary.mean_ms) * (duration - summary.mean_ms);
+    }
+    summary.jitter_ms = std::sqrt(square_sum / durations_ms.size());
+    const size_t p99_index = (durations_ms.size() * 99 + 99) / 100 - 1;
+    std::nth_element(durations_ms.begin(), durations_ms.begin() + p99_index,
+                     durations_ms.end());
+    summary.p99_ms = durations_ms[p99_index];
+    const double elapsed_s = std::chrono::duration<double>(elapsed).count();
+    if (elapsed_s > 0.0)
+    {
+      // the first input ends the window start
+      summary.fps = (durations_ms.size() - 1) / elapsed_s;
+    }
+    return summary;
+  }
+
+  void reset()
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto &samples : samples_)
+    {
+      samples.clear();
+    }
+  }
+
+private:
+  using Sample = std::pair<std::chrono::nanoseconds,
+                           std::chrono::steady_clock::time_point>;
+  const size_t window_size_;
+  mutable std::mutex mutex_;
+  std::deque<Sample> samples_[3];
+};
+
+/**
+ * @brief Call the schedule of stage with input, timed by timer when it is set.
+ */
+template <class StageType, class InputType>
+auto scheduleTimed(StageType &stage, const InputType &input, Stage id,
+                   const StageTimer &timer) -> decltype(stage.schedule(input))
+{
+  if (!timer)
+  {
+    return stage.schedule(input);
+  }
+  const auto start = std::chrono::steady_clock::now();
+  auto output = stage.schedule(input);
+  timer(id, std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start));
+  return output;
+}
+
 /**
  * @class Pipeline
  * @brief Inference Pipeline. Consists of 3 stages: preprocessor, inference
@@ -141,11 +326,12 @@ public:
    * @param pre_processor a PreProcessor object
    * @param post_processor a PostProcessor object
    * @param inference_engine a InferenceEngine object
+   * @param stage_timer called with the time of each stage, when set
    */
   Pipeline(PreProcessorType pre_processor, InferenceEngineType inference_engine,
-           PostProcessorType post_processor)
+           PostProcessorType post_processor, StageTimer stage_timer = nullptr)
       : pre_processor_(pre_processor), post_processor_(post_processor),
-        inference_engine_(inference_engine) {}
+        inference_engine_(inference_engine), stage_timer_(stage_timer) {}
 
   /**
    * @brief run the pipeline. Return asynchronously in a callback.
@@ -155,15 +341,378 @@ public:
    */
   OutputType schedule(const InputType &input)
   {
-    auto input_tensor = pre_processor_.schedule(input);
-    auto output_tensor = inference_engine_.schedule(input_tensor);
-    return post_processor_.schedule(output_tensor);
+    auto input_tensor = scheduleTimed(pre_processor_, input,
+                                      Stage::PreProcessing, stage_timer_);
+    auto output_tensor = scheduleTimed(inference_engine_, input_tensor,
+                                       Stage::Inference, stage_timer_);
+    return scheduleTimed(post_processor_, output_tensor, Stage::PostProcessing,
+                         stage_timer_);
   };
 
 private:
   PreProcessorType pre_processor_{};
   InferenceEngineType inference_engine_{};
   PostProcessorType post_processor_{};
+  StageTimer stage_timer_{};
+};
+
+/**
+ * @brief What an AsyncPipeline does with an input scheduled while its input
+ * queue is full.
+ */
+enum class OverflowPolicy
+{
+  // schedule blocks until the pre processor takes the oldest input
+  Block,
+  // the oldest queued input is dropped and its future throws
+  // std::runtime_error, for sensor streams where only the latest data matters
+  DropOldest
+};
+
+/**
+ * @class BoundedQueue
+ * @brief Queue of at most capacity elements shared by two threads.
+ */
+template <class T> class BoundedQueue
+{
+public:
+  explicit BoundedQueue(size_t capacity) : capacity_(std::max<size_t>(capacity, 1)) {}
+
+  /**
+   * @brief Push value, as policy when the queue is full.
+   *
+   * @param dropped receives the elements dropped to make room
+   * @return false when the queue is closed, value is then dropped
+   */
+  bool push(T value, OverflowPolicy policy, std::vector<T> *dropped)
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (policy == OverflowPolicy::Block)
+    {
+      not_full_.wait(lock, [this]() { return closed_ || queue_.size() < capacity_; });
+    }
+    if (closed_)
+    {
+      return false;
+    }
+    while (queue_.size() >= capacity_)
+    {
+      dropped->push_back(std::move(queue_.front()));
+      queue_.pop_front();
+    }
+    queue_.push_back(std::move(value));
+    not_empty_.notify_one();
+    return true;
+  }
+
+  /**
+   * @brief Wait for the oldest element.
+   *
+   * @return false once the queue is closed and empty
+   */
+  bool pop(T *value)
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    not_empty_.wait(lock, [this]() { return closed_ || !queue_.empty(); });
+    if (queue_.empty())
+    {
+      return false;
+    }
+    *value = std::move(queue_.front());
+    queue_.pop_front();
+    not_full_.notify_one();
+    return true;
+  }
+
+  /**
+   * @brief Refuse new elements, the queued ones can still be popped.
+   */
+  void close()
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    closed_ = true;
+    not_empty_.notify_all();
+    not_full_.notify_all();
+  }
+
+private:
+  const size_t capacity_;
+  std::deque<T> queue_;
+  bool closed_{false};
+  std::mutex mutex_;
+  std::condition_variable not_empty_;
+  std::condition_variable not_full_;
+};
+
+/**
+ * @class TVMArrayContainerPool
+ * @brief Arrays allocated once and reused after release, by shape, data type
+ * and device. A pre processor filling a new array for each input takes it from
+ * a pool instead of allocating it. The pool also copies the tensors passed from
+ * a pipeline stage to the next one: a stage usually returns the same arrays for
+ * each input, so the next stage gets a copy while the stage processes the
+ * following input.
+ */
+class TVMArrayContainerPool
+{
+public:
+  TVMArrayContainer acquire(const std::vector<int64_t> &shape,
+                            DLDataTypeCode dtype_code, uint32_t dtype_bits,
+                            uint32_t dtype_lanes, DLDeviceType device_type,
+                            uint32_t device_id)
+  {
+    const Layout layout{shape, dtype_code, dtype_bits, dtype_lanes, device_type, device_id};
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto &arrays = free_[layout];
+      if (!arrays.empty())
+      {
+        TVMArrayContainer array = arrays.back();
+        arrays.pop_back();
+        return array;
+      }
+    }
+    return TVMArrayContainer(shape, dtype_code, dtype_bits, dtype_lanes,
+                             device_type, device_id);
+  }
+
+  /**
+   * @brief Give back an array of acquire or copy, once nothing uses it.
+   */
+  void release(const TVMArrayContainer &array)
+  {
+    const DLTensor *tensor = array.getArray();
+    const Layout layout{std::vector<int64_t>(tensor->shape, tensor->shape + tensor->ndim),
+                        tensor->dtype.code, tensor->dtype.bits, tensor->dtype.lanes,
+                        tensor->ctx.device_type, tensor->ctx.device_id};
+    std::lock_guard<std::mutex> lock(mutex_);
+    free_[layout].push_back(array);
+  }
+
+  void release(TVMArrayContainerVector &&arrays)
+  {
+    for (const auto &array : arrays)
+    {
+      release(array);
+    }
+    arrays.clear();
+  }
+
+  TVMArrayContainerVector copy(const TVMArrayContainerVector &tensors)
+  {
+    TVMArrayContainerVector copies;
+    for (const auto &tensor : tensors)
+    {
+      const DLTensor *array = tensor.getArray();
+      if (array == nullptr)
+      {
+        throw std::runtime_error("pipeline stage output is null");
+      }
+      copies.push_back(acquire(
+          std::vector<int64_t>(array->shape, array->shape + array->ndim),
+          static_cast<DLDataTypeCode>(array->dtype.code), array->dtype.bits,
+          array->dtype.lanes, array->ctx.device_type, array->ctx.device_id));
+      if (TVMArrayCopyFromTo(tensor.getArray(), copies.back().getArray(),
+                             nullptr) != 0)
+      {
+        throw std::runtime_error(TVMGetLastError());
+      }
+    }
+    return copies;
+  }
+
+private:
+  // shape, dtype code, bits and lanes, device type and id
+  using Layout = std::tuple<std::vector<int64_t>, int, int, int, int, int>;
+  std::mutex mutex_;
+  std::map<Layout, std::vector<TVMArrayContainer>> free_;
+};
+
+/**
+ * @class AsyncPipeline
+ * @brief Inference Pipeline running each stage on its own thread, so that the
+ * pre processing of an input overlaps the inference of the previous one and
+ * the post processing of the one before. The stages are connected by bounded
+ * queues, a full queue blocks the stage feeding it. The tensors are copied
+ * from a stage to the next one, the stages keep their own arrays.
+ */
+template <class PreProcessorType, class InferenceEngineType,
+          class PostProcessorType>
+class AsyncPipeline
+{
+  using InputType =
+      decltype(std::declval<PreProcessorType>().input_type_indicator_);
+  using OutputType =
+      decltype(std::declval<PostProcessorType>().output_type_indicator_);
+
+public:
+  /**
+   * @brief Construct a new AsyncPipeline object and start its threads
+   *
+   * @param pre_processor a PreProcessor object
+   * @param inference_engine a InferenceEngine object
+   * @param post_processor a PostProcessor object
+   * @param queue_size capacity of the queue in front of each stage
+   * @param policy what schedule does when the input queue is full
+   * @param stage_timer called with the time of each stage, when set
+   */
+  AsyncPipeline(PreProcessorType pre_processor,
+                InferenceEngineType inference_engine,
+                PostProcessorType post_processor, size_t queue_size = 1,
+                OverflowPolicy policy = OverflowPolicy::Block,
+                StageTimer stage_timer = nullptr)
+      : pre_processor_(pre_processor), inference_engine_(inference_engine),
+        post_processor_(post_processor), policy_(policy),
+        stage_timer_(stage_timer),
+        input_queue_(queue_size), pre_processor_queue_(queue_size),
+        inference_engine_queue_(queue_size),
+        pre_processor_thread_(&AsyncPipeline::runPreProcessor, this),
+        inference_engine_thread_(&AsyncPipeline::runInferenceEngine, this),
+        post_processor_thread_(&AsyncPipeline::runPostProcessor, this) {}
+
+  AsyncPipeline(const AsyncPipeline &) = delete;
+  AsyncPipeline &operator=(const AsyncPipeline &) = delete;
+
+  /**
+   * @brief Wait for the scheduled inputs to be processed and stop the threads.
+   */
+  ~AsyncPipeline()
+  {
+    input_queue_.close();
+    pre_processor_thread_.join();
+    inference_engine_thread_.join();
+    post_processor_thread_.join();
+  }
+
+  /**
+   * @brief push the data into the pipeline.
+   *
+   * @param input The data to push into the pipeline
+   * @return The future pipeline output. It throws the std::runtime_error of a
+   * stage, or when the input is dropped.
+   */
+  std::future<OutputType> schedule(const InputType &input)
+  {
+    InputJob job;
+    job.input = input;
+    std::future<OutputType> output = job.promise.get_future();
+    std::vector<InputJob> dropped;
+    input_queue_.push(std::move(job), policy_, &dropped);
+    for (auto &dropped_job : dropped)
+    {
+      dropped_job.promise.set_exception(std::make_exception_ptr(
+          std::runtime_error("input dropped by the pipeline")));
+    }
+    return output;
+  }
+
+private:
+  struct InputJob
+  {
+    InputType input;
+    std::promise<OutputType> promise;
+  };
+  struct TensorJob
+  {
+    TVMArrayContainerVector tensors;
+    std::promise<OutputType> promise;
+  };
+
+  PreProcessorType pre_processor_;
+  InferenceEngineType inference_engine_;
+  PostProcessorType post_processor_;
+  const OverflowPolicy policy_;
+  const StageTimer stage_timer_;
+  TVMArrayContainerPool pre_processor_pool_;
+  TVMArrayContainerPool inference_engine_pool_;
+  BoundedQueue<InputJob> input_queue_;
+  BoundedQueue<TensorJob> pre_processor_queue_;
+  BoundedQueue<TensorJob> inference_engine_queue_;
+  // started last, once the members they use are constructed
+  std::thread pre_processor_thread_;
+  std::thread inference_engine_thread_;
+  std::thread post_processor_thread_;
+
+  void runPreProcessor()
+  {
+    InputJob job;
+    while (input_queue_.pop(&job))
+    {
+      TensorJob next;
+      next.promise = std::move(job.promise);
+      try
+      {
+        next.tensors = pre_processor_pool_.copy(scheduleTimed(
+            pre_processor_, job.input, Stage::PreProcessing, stage_timer_));
+      }
+      catch (...)
+      {
+        next.promise.set_exception(std::current_exception());
+        continue;
+      }
+      pre_processor_queue_.push(std::move(next), OverflowPolicy::Block, nullptr);
+    }
+    pre_processor_queue_.close();
+  }
+
+  void runInferenceEngine()
+  {
+    TensorJob job;
+    while (pre_processor_queue_.pop(&job))
+    {
+      TensorJob next;
+      next.promise = std::move(job.promise);
+      bool is_failed = false;
+      try
+      {
+        next.tensors = inference_engine_pool_.copy(scheduleTimed(
+            inference_engine_, job.tensors, Stage::Inference, stage_timer_));
+      }
+      catch (...)
+      {
+        next.promise.set_exception(std::current_exception());
+        is_failed = true;
+      }
+      pre_processor_pool_.release(std::move(job.tensors));
+      if (!is_failed)
+      {
+        inference_engine_queue_.push(std::move(next), OverflowPolicy::Block, nullptr);
+      }
+    }
+    inference_engine_queue_.close();
+  }
+
+  void runPostProcessor()
+  {
+    TensorJob job;
+    while (inference_engine_queue_.pop(&job))
+    {
+      try
+      {
+        job.promise.set_value(scheduleTimed(
+            post_processor_, job.tensors, Stage::PostProcessing, stage_timer_));
+      }
+      catch (...)
+      {
+        job.promise.set_exception(std::current_exception());
+      }
+      inference_engine_pool_.release(std::move(job.tensors));
+    }
+  }
+};
+
+/**
+ * @brief Cores of the worker threads of the TVM runtime, the affinity modes of
+ * runtime.config_threadpool.
+ */
+enum class TVMCorePreference
+{
+  // all the cores, the ones of highest frequency first
+  Default = 0,
+  // the cores of highest frequency of a big.LITTLE CPU
+  Big = 1,
+  // the cores of lowest frequency
+  Little = -1
 };
 
 // each node should be specificed with a string name and a shape
@@ -189,14 +738,115 @@ typedef struct
 
   // network outputs
   std::vector<NetworkNode> network_outputs;
+
+  // thread pool of the TVM runtime, configured in each thread running the
+  // inferences. 0 threads keeps the default of TVM, one per core, or one per
+  // CPU of the affinity mask when it is set
+  int tvm_num_threads = 0;
+  // CPUs the workers of the thread pool run on, bit i for CPU i, 0 for all
+  // of them
+  uint64_t tvm_cpu_affinity_mask = 0;
+  TVMCorePreference tvm_core_preference = TVMCorePreference::Default;
 }
 InferenceEngineTVMConfig;
 
-class InferenceEngineTVM : public InferenceEngine
+/**
+ * @brief Keep TVM from binding its workers to cores, so they keep the
+ * affinity mask they are created with. Done once for the process, before the
+ * first runtime of a model with an affinity mask is created, and a value of
+ * TVM_BIND_THREADS set by the user is kept.
+ */
+inline void disableThreadBindingTVM()
+{
+  static std::once_flag once;
+  std::call_once(once, []() { setenv("TVM_BIND_THREADS", "0", 0); });
+}
+
+/**
+ * @brief Configure the TVM thread pool of the calling thread, which is the
+ * one of the inferences it runs, as config. The workers of the pool are
+ * created on the CPUs of the affinity mask, the calling thread gets its own
+ * mask back afterwards, so a ROS callback thread running the inferences is
+ * not left pinned for its other callbacks.
+ */
+inline void configureThreadPoolTVM(const InferenceEngineTVMConfig &config)
+{
+  int num_threads = config.tvm_num_threads;
+  if (num_threads == 0 && config.tvm_cpu_affinity_mask == 0 &&
+      config.tvm_core_preference == TVMCorePreference::Default)
+  {
+    return;
+  }
+  const tvm::runtime::PackedFunc *config_threadpool =
+      tvm::runtime::Registry::Get("runtime.config_threadpool");
+  if (config_threadpool == nullptr)
+  {
+    throw std::runtime_error("the TVM runtime has no runtime.config_threadpool");
+  }
+
+  if (config.tvm_cpu_affinity_mask == 0)
+  {
+    (*config_threadpool)(static_cast<int>(config.tvm_core_preference), num_threads);
+    return;
+  }
+
+#ifdef __linux__
+  cpu_set_t cpuset;
+  CPU_ZERO(&cpuset);
+  int num_cpus = 0;
+  for (int cpu = 0; cpu < 64 && cpu < CPU_SETSIZE; ++cpu)
+  {
+    if ((config.tvm_cpu_affinity_mask >> cpu) & 1u)
+    {
+      CPU_SET(cpu, &cpuset);
+      ++num_cpus;
+    }
+  }
+  if (num_threads == 0)
+  {
+    num_threads = num_cpus;
+  }
+
+  // the workers inherit the mask of the thread creating them
+  cpu_set_t caller_cpuset;
+  if (pthread_getaffinity_np(pthread_self(), sizeof(caller_cpuset), &caller_cpuset) != 0 ||
+      pthread_setaffinity_np(pthread_self(), sizeof(cpuset), &cpuset) != 0)
+  {
+    throw std::runtime_error("cannot set the cpu affinity of the inference workers");
+  }
+  try
+  {
+    (*config_threadpool)(static_cast<int>(config.tvm_core_preference), num_threads);
+  }
+  catch (...)
+  {
+    pthread_setaffinity_np(pthread_self(), sizeof(caller_cpuset), &caller_cpuset);
+    throw;
+  }
+  pthread_setaffinity_np(pthread_self(), sizeof(caller_cpuset), &caller_cpuset);
+#else
+  throw std::runtime_error("cpu affinity of the inference workers not supported");
+#endif
+}
+
+/**
+ * @class CompiledModelTVM
+ * @brief Compiled module and parameters of a network, loaded once and shared
+ * by the InferenceEngineTVM objects running it, such as one per pipeline. Each
+ * engine has its own graph runtime. The runtime of the first engine loads the
+ * parameters, the next ones share them when the runtime supports
+ * share_params, so the weights are in memory once.
+ */
+class CompiledModelTVM
 {
 public:
-  explicit InferenceEngineTVM(InferenceEngineTVMConfig config) : config_(config)
+  explicit CompiledModelTVM(InferenceEngineTVMConfig config) : config_(config)
   {
+    if (config.tvm_cpu_affinity_mask != 0)
+    {
+      disableThreadBindingTVM();
+    }
+
     // load compiled functions
     std::ifstream module(config.network_module_path);
     if (!module.good())
@@ -207,8 +857,7 @@ public:
           "found");
     }
     module.close();
-    tvm::runtime::Module mod =
-        tvm::runtime::Module::LoadFromFile(config.network_module_path);
+    module_ = tvm::runtime::Module::LoadFromFile(config.network_module_path);
 
     // load json graph
     std::ifstream json_in(config.network_graph_path, std::ios::in);
@@ -219,8 +868,8 @@ public:
           " specified in inference_engine_tvm_config.h not "
           "found");
     }
-    std::string json_data((std::istreambuf_iterator<char>(json_in)),
-                          std::istreambuf_iterator<char>());
+    json_data_ = std::string((std::istreambuf_iterator<char>(json_in)),
+                             std::istreambuf_iterator<char>());
     json_in.close();
 
     // load parameters from binary file
@@ -232,44 +881,137 @@ public:
           " specified in inference_engine_tvm_config.h not "
           "found");
     }
-    std::string params_data((std::istreambuf_iterator<char>(params_in)),
-                            std::istreambuf_iterator<char>());
+    params_data_ = std::string((std::istreambuf_iterator<char>(params_in)),
+                               std::istreambuf_iterator<char>());
     params_in.close();
+  }
+
+  const InferenceEngineTVMConfig &getConfig() const { return config_; }
 
-    // parameters need to be in TVMByteArray format
+  /**
+   * @brief Create a graph runtime of the network with the parameters of the
+   * model. Thread safe.
+   */
+  tvm::runtime::Module createRuntime() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (params_released_)
+    {
+      throw std::runtime_error("the parameters of the model are released");
+    }
+    tvm::runtime::Module runtime_mod = createGraphRuntime();
+    auto share_params = runtime_mod.GetFunction("share_params");
+    if (params_owner_ != nullptr && share_params != nullptr)
+    {
+      share_params(*params_owner_, getParams());
+    }
+    else
+    {
+      runtime_mod.GetFunction("load_params")(getParams());
+      if (share_params != nullptr)
+      {
+        params_owner_.reset(new tvm::runtime::Module(runtime_mod));
+      }
+    }
+    return runtime_mod;
+  }
+
+  /**
+   * @brief Free the parameter file kept for the engines to come, once no
+   * engine is created from the model anymore. The weights stay in the
+   * runtimes of the engines. Thread safe.
+   */
+  void releaseParams() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::string().swap(params_data_);
+    params_released_ = true;
+  }
+
+private:
+  const InferenceEngineTVMConfig config_;
+  tvm::runtime::Module module_;
+  std::string json_data_;
+  // read by load_params and share_params, which both parse the whole file
+  mutable std::string params_data_;
+  mutable bool params_released_ = false;
+  // runtime of the first engine, whose parameters the next engines share
+  mutable std::unique_ptr<tvm::runtime::Module> params_owner_;
+  mutable std::mutex mutex_;
+
+  tvm::runtime::Module createGraphRuntime() const
+  {
+    return (*tvm::runtime::Registry::Get("tvm.graph_runtime.create"))(
+        json_data_, module_, static_cast<int>(config_.tvm_device_type),
+        config_.tvm_device_id);
+  }
+
+  // parameters need to be in TVMByteArray format
+  TVMByteArray getParams() const
+  {
     TVMByteArray params_arr;
-    params_arr.data = params_data.c_str();
-    params_arr.size = params_data.length();
+    params_arr.data = params_data_.c_str();
+    params_arr.size = params_data_.length();
+    return params_arr;
+  }
+};
 
-    // create tvm runtime module
-    tvm::runtime::Module runtime_mod =
-        (*tvm::runtime::Registry::Get("tvm.graph_runtime.create"))(
-            json_data, mod, static_cast<int>(config.tvm_device_type), config.tvm_device_id);
+class InferenceEngineTVM : public InferenceEngine
+{
+public:
+  explicit InferenceEngineTVM(InferenceEngineTVMConfig config)
+      : InferenceEngineTVM(std::make_shared<const CompiledModelTVM>(config))
+  {
+    // the model is the engine's own, no other runtime is created from it
+    model_->releaseParams();
+  }
 
-    // load parameters
-    auto load_params = runtime_mod.GetFunction("load_params");
-    load_params(params_arr);
+  /**
+   * @brief Construct an engine running model with its own graph runtime.
+   * Copies of the engine share the runtime, each thread running inferences
+   * at the same time needs its own engine.
+   */
+  explicit InferenceEngineTVM(std::shared_ptr<const CompiledModelTVM> model)
+      : config_(model->getConfig()), model_(model)
+  {
+    tvm::runtime::Module runtime_mod = model->createRuntime();
 
     // get set_input function
     set_input = runtime_mod.GetFunction("set_input");
 
+    // binds the input arrays to the graph without copy, when the runtime
+    // supports it
+    set_input_zero_copy = runtime_mod.GetFunction("set_input_zero_copy");
+
+    // the graph inputs an input array must match to be bound without copy
+    if (set_input_zero_copy != nullptr)
+    {
+      auto get_input = runtime_mod.GetFunction("get_input");
+      for (const auto &network_input : config_.network_inputs)
+      {
+        tvm::runtime::NDArray graph_input = get_input(network_input.first);
+        graph_input_.push_back(graph_input);
+      }
+    }
+
     // get the function which executes the network
     execute = runtime_mod.GetFunction("run");
 
-    // get the function to get output data
-    get_output = runtime_mod.GetFunction("get_output");
-
-    for (auto &output_config : config.network_outputs)
+    // the output arrays of the graph keep their storage between runs, they
+    // are returned in place instead of being copied after each run
+    auto get_output = runtime_mod.GetFunction("get_output");
+    for (int index = 0; index < config_.network_outputs.size(); ++index)
     {
-      output_.push_back(
-          TVMArrayContainer(output_config.second, config.tvm_dtype_code,
-                            config.tvm_dtype_bits, config.tvm_dtype_lanes,
-                            config.tvm_device_type, config.tvm_device_id));
+      tvm::runtime::NDArray output = get_output(index);
+      output_.push_back(TVMArrayContainer(output));
     }
   }
 
   TVMArrayContainerVector schedule(const TVMArrayContainerVector &input)
   {
+    // the thread pool of TVM belongs to the thread running the inference
+    configureThreadPool();
+
     // set input(s)
     for (int index = 0; index < input.size(); ++index)
     {
@@ -277,31 +1019,346 @@ public:
       {
         throw std::runtime_error("input variable is null");
       }
-      set_input(config_.network_inputs[index].first.c_str(),
-                input[index].getArray());
+      if (set_input_zero_copy != nullptr &&
+          canBindWithoutCopy(input[index].getArray(), graph_input_[index].operator->()))
+      {
+        set_input_zero_copy(config_.network_inputs[index].first.c_str(),
+                            input[index].getArray());
+      }
+      else
+      {
+        set_input(config_.network_inputs[index].first.c_str(),
+                  input[index].getArray());
+      }
     }
 
     // execute the inference
     execute();
 
-    // get output(s)
-    for (int index = 0; index < output_.size(); ++index)
+    // the outputs are overwritten by the next inference
+    return output_;
+  }
+
+private:
+  // alignment of the arrays allocated by TVM, set_input_zero_copy rejects the
+  // other ones
+  static constexpr uintptr_t kAllocAlignment = 64;
+
+  InferenceEngineTVMConfig config_;
+  std::shared_ptr<const CompiledModelTVM> model_;
+  TVMArrayContainerVector output_;
+  std::vector<tvm::runtime::NDArray> graph_input_;
+  // threads whose TVM thread pool is configured, shared by the copies of the
+  // engine so that the spinner threads of a node are configured once each
+  struct ConfiguredThreads
+  {
+    std::mutex mutex;
+    std::set<std::thread::id> ids;
+  };
+  std::shared_ptr<ConfiguredThreads> configured_threads_ =
+      std::make_shared<ConfiguredThreads>();
+  tvm::runtime::PackedFunc set_input;
+  tvm::runtime::PackedFunc set_input_zero_copy;
+  tvm::runtime::PackedFunc execute;
+
+  /**
+   * @brief Whether set_input_zero_copy accepts input for graph_input: same
+   * device, data type and shape, compact and aligned as the arrays of TVM.
+   * TVM aborts on the other arrays, such as the ones of a pre-processor on
+   * the CPU for a network on the GPU, which are copied by set_input instead.
+   */
+  void configureThreadPool()
+  {
+    const std::thread::id thread = std::this_thread::get_id();
+    std::lock_guard<std::mutex> lock(configured_threads_->mutex);
+    if (configured_threads_->ids.count(thread) == 0)
+    {
+      configureThreadPoolTVM(config_);
+      configured_threads_->ids.insert(thread);
+    }
+  }
+
+  static bool canBindWithoutCopy(const DLTensor *input, const DLTensor *graph_input)
+  {
+    if (input->ctx.device_type != graph_input->ctx.device_type ||
+        input->ctx.device_id != graph_input->ctx.device_id ||
+        input->dtype.code != graph_input->dtype.code ||
+        input->dtype.bits != graph_input->dtype.bits ||
+        input->dtype.lanes != graph_input->dtype.lanes ||
+        input->ndim != graph_input->ndim)
+    {
+      return false;
+    }
+    for (int i = 0; i < input->ndim; ++i)
     {
-      if (output_[index].getArray() == nullptr)
+      if (input->shape[i] != graph_input->shape[i])
       {
-        throw std::runtime_error("output variable is null");
+        return false;
       }
-      get_output(index, output_[index].getArray());
     }
+    if (input->strides != nullptr)
+    {
+      int64_t expected_stride = 1;
+      for (int i = input->ndim - 1; i >= 0; --i)
+      {
+        if (input->shape[i] != 1 && input->strides[i] != expected_stride)
+        {
+          return false;
+        }
+        expected_stride *= input->shape[i];
+      }
+    }
+    const uintptr_t data =
+        reinterpret_cast<uintptr_t>(input->data) + input->byte_offset;
+    return data % kAllocAlignment == 0;
+  }
+};
+
+/**
+ * @class InferenceEngineTVMBatch
+ * @brief Inference engine of a module compiled for a batch, shared by several
+ * pipelines such as one per camera. The first dimension of each network input
+ * and output is the batch size. Each call to schedule is one request whose
+ * tensors have a batch dimension of 1: the requests are gathered until the
+ * batch is full or the first one waited max_delay, then they are copied into
+ * the batched input, inferred at once, and the batched output is split back
+ * into the output of each request.
+ *
+ * The copies of an engine share the same module and batch, and each copy has
+ * its own output arrays, so each pipeline should have its own copy.
+ */
+class InferenceEngineTVMBatch : public InferenceEngine
+{
+public:
+  InferenceEngineTVMBatch(InferenceEngineTVMConfig config,
+                          std::chrono::microseconds max_delay)
+      : batch_(std::make_shared<Batch>(config, max_delay)),
+        output_(batch_->allocateOutputs()) {}
+
+  InferenceEngineTVMBatch(const InferenceEngineTVMBatch &other)
+      : batch_(other.batch_), output_(batch_->allocateOutputs()) {}
+
+  InferenceEngineTVMBatch &operator=(const InferenceEngineTVMBatch &other)
+  {
+    if (batch_ != other.batch_)
+    {
+      batch_ = other.batch_;
+      output_ = batch_->allocateOutputs();
+    }
+    return *this;
+  }
+
+  TVMArrayContainerVector schedule(const TVMArrayContainerVector &input)
+  {
+    batch_->schedule(input, output_);
     return output_;
   }
 
 private:
-  InferenceEngineTVMConfig config_;
+  class Batch
+  {
+  public:
+    Batch(InferenceEngineTVMConfig config, std::chrono::microseconds max_delay)
+        : config_(config), max_delay_(max_delay), engine_(config),
+          batch_size_(config.network_inputs.at(0).second.at(0))
+    {
+      for (auto &input_config : config.network_inputs)
+      {
+        if (input_config.second.empty() || input_config.second[0] != batch_size_)
+        {
+          throw std::runtime_error("network input " + input_config.first +
+                                   " has not the batch size as first dimension");
+        }
+        input_.push_back(
+            TVMArrayContainer(input_config.second, config.tvm_dtype_code,
+                              config.tvm_dtype_bits, config.tvm_dtype_lanes,
+                              config.tvm_device_type, config.tvm_device_id));
+      }
+      for (auto &output_config : config.network_outputs)
+      {
+        if (output_config.second.empty() || output_config.second[0] != batch_size_)
+        {
+          throw std::runtime_error("network output " + output_config.first +
+                                   " has not the batch size as first dimension");
+        }
+      }
+      thread_ = std::thread(&Batch::run, this);
+    }
+
+    ~Batch()
+    {
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        is_shutdown_ = true;
+      }
+      request_cv_.notify_all();
+      thread_.join();
+    }
+
+    // arrays of one request for the network outputs
+    TVMArrayContainerVector allocateOutputs() const
+    {
+      TVMArrayContainerVector output;
+      for (auto &output_config : config_.network_outputs)
+      {
+        std::vector<int64_t> shape = output_config.second;
+        shape[0] = 1;
+        output.push_back(
+            TVMArrayContainer(shape, config_.tvm_dtype_code,
+                              config_.tvm_dtype_bits, config_.tvm_dtype_lanes,
+                              config_.tvm_device_type, config_.tvm_device_id));
+      }
+      return output;
+    }
+
+    void schedule(const TVMArrayContainerVector &input,
+                  const TVMArrayContainerVector &output)
+    {
+      if (input.size() != config_.network_inputs.size())
+      {
+        throw std::runtime_error("unexpected number of input variables");
+      }
+      Request request{&input, &output, false, nullptr};
+      std::unique_lock<std::mutex> lock(mutex_);
+      if (pending_.empty())
+      {
+        first_request_time_ = std::chrono::steady_clock::now();
+      }
+      pending_.push_back(&request);
+      request_cv_.notify_one();
+      done_cv_.wait(lock, [&request]() { return request.is_done; });
+      if (request.error)
+      {
+        std::rethrow_exception(request.error);
+      }
+    }
+
+  private:
+    struct Request
+    {
+      const TVMArrayContainerVector *input;
+      const TVMArrayContainerVector *output;
+      bool is_done;
+      std::exception_ptr error;
+    };
+
+    const InferenceEngineTVMConfig config_;
+    const std::chrono::microseconds max_delay_;
+    InferenceEngineTVM engine_;
+    const int64_t batch_size_;
+    TVMArrayContainerVector input_;
+    std::mutex mutex_;
+    std::condition_variable request_cv_;
+    std::condition_variable done_cv_;
+    std::vector<Request *> pending_;
+    std::chrono::steady_clock::time_point first_request_time_;
+    bool is_shutdown_{false};
+    std::thread thread_;
+
+    // view of the index-th element of the batch in array
+    static DLTensor slice(const DLTensor *array, int64_t index,
+                          std::vector<int64_t> *shape)
+    {
+      if (array == nullptr)
+      {
+        throw std::runtime_error("batched variable is null");
+      }
+      shape->assign(array->shape, array->shape + array->ndim);
+      (*shape)[0] = 1;
+      int64_t element_bytes = (array->dtype.bits * array->dtype.lanes + 7) / 8;
+      for (size_t dim = 1; dim < shape->size(); ++dim)
+      {
+        element_bytes *= (*shape)[dim];
+      }
+      DLTensor view = *array;
+      view.shape = shape->data();
+      view.strides = nullptr;
+      view.byte_offset += index * element_bytes;
+      return view;
+    }
+
+    static void copy(const DLTensor *from, DLTensor *to)
+    {
+      if (from == nullptr || to == nullptr)
+      {
+        throw std::runtime_error("input variable is null");
+      }
+      if (TVMArrayCopyFromTo(const_cast<DLTensor *>(from), to, nullptr) != 0)
+      {
+        throw std::runtime_error(TVMGetLastError());
+      }
+    }
+
+    void infer(const std::vector<Request *> &requests)
+    {
+      std::vector<int64_t> shape;
+      for (size_t index = 0; index < requests.size(); ++index)
+      {
+        const TVMArrayContainerVector &input = *requests[index]->input;
+        for (size_t i = 0; i < input.size(); ++i)
+        {
+          DLTensor view = slice(input_[i].getArray(), index, &shape);
+          copy(input[i].getArray(), &view);
+        }
+      }
+      // elements beyond the requests keep older data, their output is ignored
+      const TVMArrayContainerVector batched_output = engine_.schedule(input_);
+      for (size_t index = 0; index < requests.size(); ++index)
+      {
+        const TVMArrayContainerVector &output = *requests[index]->output;
+        for (size_t i = 0; i < output.size(); ++i)
+        {
+          DLTensor view = slice(batched_output[i].getArray(), index, &shape);
+          copy(&view, output[i].getArray());
+        }
+      }
+    }
+
+    void run()
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      while (true)
+      {
+        request_cv_.wait(lock, [this]() { return is_shutdown_ || !pending_.empty(); });
+        if (is_shutdown_)
+        {
+          return;
+        }
+        request_cv_.wait_until(lock, first_request_time_ + max_delay_, [this]() {
+          return is_shutdown_ ||
+                 static_cast<int64_t>(pending_.size()) >= batch_size_;
+        });
+
+        const size_t count = std::min<size_t>(pending_.size(), batch_size_);
+        std::vector<Request *> requests(pending_.begin(), pending_.begin() + count);
+        pending_.erase(pending_.begin(), pending_.begin() + count);
+        // the remaining requests start the next batch
+        first_request_time_ = std::chrono::steady_clock::now();
+        lock.unlock();
+
+        std::exception_ptr error;
+        try
+        {
+          infer(requests);
+        }
+        catch (...)
+        {
+          error = std::current_exception();
+        }
+
+        lock.lock();
+        for (auto request : requests)
+        {
+          request->error = error;
+          request->is_done = true;
+        }
+        done_cv_.notify_all();
+      }
+    }
+  };
+
+  std::shared_ptr<Batch> batch_;
   TVMArrayContainerVector output_;
-  tvm::runtime::PackedFunc set_input;
-  tvm::runtime::PackedFunc execute;
-  tvm::runtime::PackedFunc get_output;
 };
 
 }  // namespace pipeline
@@ -0,0 +1,323 @@
+/*
+ * Copyright 2020 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#ifndef TVM_UTILITY_POST_PROCESSING_H
+#define TVM_UTILITY_POST_PROCESSING_H
+
+namespace tvm_utility
+{
+namespace post_processing
+{
+
+/**
+ * @brief exp of x with a relative error below 2e-7: x = n * ln(2) + r with r
+ * in [-ln(2) / 2, ln(2) / 2], exp(r) from a polynomial and 2^n from the
+ * exponent bits.
+ */
+inline float fastExp(float x)
+{
+  x = std::min(std::max(x, -87.0f), 88.0f);
+  const float t = x * 1.44269504f + 0.5f;
+  int32_t n = static_cast<int32_t>(t);
+  n -= (t < static_cast<float>(n));
+  const float fn = static_cast<float>(n);
+  const float r = x - fn * 0.693359375f + fn * 2.12194440e-4f;
+  float y = 1.9875691500e-4f;
+  y = y * r + 1.3981999507e-3f;
+  y = y * r + 8.3334519073e-3f;
+  y = y * r + 4.1665795894e-2f;
+  y = y * r + 1.6666665459e-1f;
+  y = y * r + 5.0000001201e-1f;
+  y = y * r * r + r + 1.0f;
+  const uint32_t bits = static_cast<uint32_t>(n + 127) << 23;
+  float scale;
+  std::memcpy(&scale, &bits, sizeof(scale));
+  return y * scale;
+}
+
+inline float fastSigmoid(float x) { return 1.0f / (1.0f + fastExp(-x)); }
+
+#ifdef __SSE2__
+// fastExp of 4 values, the compiler does not vectorize the scalar one as its
+// comparisons may trap
+inline __m128 fastExp(__m128 x)
+{
+  x = _mm_min_ps(_mm_max_ps(x, _mm_set1_ps(-87.0f)), _mm_set1_ps(88.0f));
+  const __m128 t = _mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(1.44269504f)), _mm_set1_ps(0.5f));
+  __m128i n = _mm_cvttps_epi32(t);
+  // the mask is -1 where the truncation is above t
+  n = _mm_add_epi32(n, _mm_castps_si128(_mm_cmplt_ps(t, _mm_cvtepi32_ps(n))));
+  const __m128 fn = _mm_cvtepi32_ps(n);
+  const __m128 r = _mm_add_ps(_mm_sub_ps(x, _mm_mul_ps(fn, _mm_set1_ps(0.693359375f))),
+                              _mm_mul_ps(fn, _mm_set1_ps(2.12194440e-4f)));
+  __m128 y = _mm_set1_ps(1.9875691500e-4f);
+  y = _mm_add_ps(_mm_mul_ps(y, r), _mm_set1_ps(1.3981999507e-3f));
+  y = _mm_add_ps(_mm_mul_ps(y, r), _mm_set1_ps(8.3334519073e-3f));
+  y = _mm_add_ps(_mm_mul_ps(y, r), _mm_set1_ps(4.1665795894e-2f));
+  y = _mm_add_ps(_mm_mul_ps(y, r), _mm_set1_ps(1.6666665459e-1f));
+  y = _mm_add_ps(_mm_mul_ps(y, r), _mm_set1_ps(5.0000001201e-1f));
+  y = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_mul_ps(y, r), r), r), _mm_set1_ps(1.0f));
+  const __m128 scale = _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(n, _mm_set1_epi32(127)), 23));
+  return _mm_mul_ps(y, scale);
+}
+#endif
+
+/**
+ * @brief Apply fastSigmoid to size values in place.
+ */
+inline void sigmoid(float *values, size_t size)
+{
+  size_t i = 0;
+#ifdef __SSE2__
+  const __m128 one = _mm_set1_ps(1.0f);
+  for (; i + 4 <= size; i += 4)
+  {
+    const __m128 x = _mm_loadu_ps(values + i);
+    const __m128 e = fastExp(_mm_sub_ps(_mm_setzero_ps(), x));
+    _mm_storeu_ps(values + i, _mm_div_ps(one, _mm_add_ps(one, e)));
+  }
+#endif
+  for (; i < size; ++i)
+  {
+    values[i] = fastSigmoid(values[i]);
+  }
+}
+
+/**
+ * @brief Index and probability of the most likely class of size logits, from
+ * their softmax.
+ */
+inline std::pair<size_t, float> softmaxMax(const float *logits, size_t size)
+{
+  const size_t max_index = std::max_element(logits, logits + size) - logits;
+  const float max_logit = logits[max_index];
+  float sum = 0.0f;
+  size_t i = 0;
+#ifdef __SSE2__
+  const __m128 max_logits = _mm_set1_ps(max_logit);
+  __m128 sums = _mm_setzero_ps();
+  for (; i + 4 <= size; i += 4)
+  {
+    sums = _mm_add_ps(sums, fastExp(_mm_sub_ps(_mm_loadu_ps(logits + i), max_logits)));
+  }
+  float lanes[4];
+  _mm_storeu_ps(lanes, sums);
+  sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#endif
+  for (; i < size; ++i)
+  {
+    sum += fastExp(logits[i] - max_logit);
+  }
+  // the most likely class contributes exp(0)
+  return std::make_pair(max_index, 1.0f / sum);
+}
+
+/**
+ * @brief A detected box. The center and the size are relative to the network
+ * input, between 0 and 1.
+ */
+typedef struct
+{
+  float x;
+  float y;
+  float width;
+  float height;
+  float score;
+  size_t class_index;
+}
+Detection;
+
+/**
+ * @brief Intersection over union of the boxes a and b.
+ */
+inline float intersectionOverUnion(const Detection &a, const Detection &b)
+{
+  const float width = std::min(a.x + a.width / 2, b.x + b.width / 2) -
+                      std::max(a.x - a.width / 2, b.x - b.width / 2);
+  const float height = std::min(a.y + a.height / 2, b.y + b.height / 2) -
+                       std::max(a.y - a.height / 2, b.y - b.height / 2);
+  if (width <= 0 || height <= 0)
+  {
+    return 0.0f;
+  }
+  const float intersection = width * height;
+  return intersection / (a.width * a.height + b.width * b.height - intersection);
+}
+
+/**
+ * @brief Non maximum suppression: the detections sorted by decreasing score,
+ * without the ones overlapping a better one by more than iou_threshold.
+ *
+ * @param per_class only detections of the same class suppress each other
+ */
+inline std::vector<Detection> nonMaximumSuppression(
+    std::vector<Detection> detections, float iou_threshold,
+    bool per_class = true)
+{
+  std::stable_sort(detections.begin(), detections.end(),
+                   [](const Detection &a, const Detection &b) { return a.score > b.score; });
+  std::vector<Detection> kept;
+  for (const auto &detection : detections)
+  {
+    bool is_suppressed = false;
+    for (const auto &better : kept)
+    {
+      if ((!per_class || better.class_index == detection.class_index) &&
+          intersectionOverUnion(better, detection) > iou_threshold)
+      {
+        is_suppressed = true;
+        break;
+      }
+    }
+    if (!is_suppressed)
+    {
+      kept.push_back(detection);
+    }
+  }
+  return kept;
+}
+
+/**
+ * @brief Output of a YOLO detector head, set from the network output of an
+ * InferenceEngineTVMConfig.
+ */
+typedef struct
+{
+  // shape of the network output: batch, rows, columns and, for each anchor,
+  // x, y, width, height, objectness and the class logits
+  std::vector<int64_t> output_shape;
+
+  // width and height of each anchor, in grid cells
+  std::vector<std::pair<float, float>> anchors;
+
+  // a box is detected when its score is above this threshold
+  float score_threshold;
+
+  // at most this number of boxes of highest objectness are decoded,
+  // 0 for all of them
+  size_t top_k;
+}
+YoloDecoderConfig;
+
+/**
+ * @class YoloDecoder
+ * @brief Decode the detections of a YOLO head, in the order of the grid cells
+ * and anchors. A box score is its objectness times the probability of its
+ * class, so the boxes whose objectness is not above the threshold are skipped
+ * before their classes are decoded. The buffers are kept between calls.
+ */
+class YoloDecoder
+{
+public:
+  YoloDecoder() = default;
+
+  explicit YoloDecoder(YoloDecoderConfig config) : config_(config)
+  {
+    if (config.output_shape.size() != 4 || config.anchors.empty() ||
+        config.output_shape[3] % config.anchors.size() != 0 ||
+        config.output_shape[3] / config.anchors.size() <= BOX_FIELDS)
+    {
+      throw std::runtime_error("output shape does not match the anchors");
+    }
+    rows_ = config.output_shape[1];
+    columns_ = config.output_shape[2];
+    anchor_size_ = config.output_shape[3] / config.anchors.size();
+    objectness_.resize(rows_ * columns_ * config.anchors.size());
+  }
+
+  /**
+   * @brief Detections of the data of the network output, row-major float.
+   */
+  const std::vector<Detection> &decode(const float *data)
+  {
+    const size_t anchor_count = config_.anchors.size();
+    for (size_t box = 0; box < objectness_.size(); ++box)
+    {
+      objectness_[box] = data[box * anchor_size_ + OBJECTNESS];
+    }
+    sigmoid(objectness_.data(), objectness_.size());
+
+    candidates_.clear();
+    for (size_t box = 0; box < objectness_.size(); ++box)
+    {
+      if (objectness_[box] > config_.score_threshold)
+      {
+        candidates_.push_back(box);
+      }
+    }
+    if (config_.top_k > 0 && candidates_.size() > config_.top_k)
+    {
+      std::nth_element(candidates_.begin(), candidates_.begin() + config_.top_k,
+                       candidates_.end(), [this](size_t a, size_t b) {
+                         return objectness_[a] > objectness_[b];
+                       });
+      candidates_.resize(config_.top_k);
+      std::sort(candidates_.begin(), candidates_.end());
+    }
+
+    detections_.clear();
+    for (const size_t box : candidates_)
+    {
+      const float *values = data + box * anchor_size_;
+      const auto best_class = softmaxMax(values + BOX_FIELDS, anchor_size_ - BOX_FIELDS);
+      const float score = objectness_[box] * best_class.second;
+      if (score <= config_.score_threshold)
+      {
+        continue;
+      }
+      const size_t cell = box / anchor_count;
+      const auto &anchor = config_.anchors[box % anchor_count];
+      Detection detection;
+      detection.x = (fastSigmoid(values[0]) + cell % columns_) / columns_;
+      detection.y = (fastSigmoid(values[1]) + cell / columns_) / rows_;
+      detection.width = anchor.first * fastExp(values[2]) / columns_;
+      detection.height = anchor.second * fastExp(values[3]) / rows_;
+      detection.score = score;
+      detection.class_index = best_class.first;
+      detections_.push_back(detection);
+    }
+    return detections_;
+  }
+
+private:
+  static constexpr size_t OBJECTNESS = 4;
+  static constexpr size_t BOX_FIELDS = 5;
+  YoloDecoderConfig config_{};
+  size_t rows_{0};
+  size_t columns_{0};
+  size_t anchor_size_{0};
+  std::vector<float> objectness_;
+  std::vector<size_t> candidates_;
+  std::vector<Detection> detections_;
+};
+
+}  // namespace post_processing
+}  // namespace tvm_utility
+
+#endif  // TVM_UTILITY_POST_PROCESSING_H
@@ -0,0 +1,169 @@
+/*
+ * Copyright 2020 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Runs the yolo_v2_tiny pipeline on the test image and prints the time of
+// each stage:
+//   yolo_v2_tiny_benchmark [--iterations N] [--warmup N] [--async]
+//                          [--threads N] [--affinity MASK] [--cores big|little]
+// from the directory of the model files. --async runs an AsyncPipeline, the
+// inputs are scheduled as fast as the pipeline takes them. --threads,
+// --affinity (a hexadecimal CPU mask) and --cores configure the TVM thread
+// pool of the inferences.
+
+#include <tvm_utility/pipeline.h>
+
+#include "inference_engine_tvm_config.hpp"
+#include "yolo_v2_tiny.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <future>
+#include <string>
+#include <vector>
+
+namespace model_config = model_zoo::perception::camera_obstacle_detection::
+    yolo_v2_tiny::tensorflow_fp32_coco;
+using tvm_utility::pipeline::AsyncPipeline;
+using tvm_utility::pipeline::InferenceEngineTVM;
+using tvm_utility::pipeline::OverflowPolicy;
+using tvm_utility::pipeline::Pipeline;
+using tvm_utility::pipeline::PipelineStatistics;
+using tvm_utility::pipeline::Stage;
+using tvm_utility::pipeline::TVMCorePreference;
+
+namespace
+{
+void printSummary(const char *name, const PipelineStatistics::Summary &summary)
+{
+  std::printf("%-16s %8zu %10.3f %10.3f %10.3f %10.1f\n", name, summary.count,
+              summary.mean_ms, summary.p99_ms, summary.jitter_ms, summary.fps);
+}
+
+template <class PipelineType>
+double run(PipelineType &pipeline, size_t iterations)
+{
+  sensor_msgs::PointCloud2 msg{};
+  const auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < iterations; ++i)
+  {
+    pipeline.schedule(msg);
+  }
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+template <class... Types>
+double run(AsyncPipeline<Types...> &pipeline, size_t iterations)
+{
+  sensor_msgs::PointCloud2 msg{};
+  std::vector<std::future<std::vector<float>>> outputs;
+  const auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < iterations; ++i)
+  {
+    outputs.push_back(pipeline.schedule(msg));
+  }
+  for (auto &output : outputs)
+  {
+    output.get();
+  }
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+template <class PipelineType>
+void benchmark(PipelineType &pipeline, PipelineStatistics &statistics,
+               size_t iterations, size_t warmup)
+{
+  run(pipeline, warmup);
+  statistics.reset();
+  const double elapsed_s = run(pipeline, iterations);
+
+  std::printf("%-16s %8s %10s %10s %10s %10s\n", "stage", "count", "mean ms",
+              "p99 ms", "jitter ms", "fps");
+  printSummary("pre-processing", statistics.summary(Stage::PreProcessing));
+  printSummary("inference", statistics.summary(Stage::Inference));
+  printSummary("post-processing", statistics.summary(Stage::PostProcessing));
+  std::printf("%-16s %8zu %10.3f %10s %10s %10.1f\n", "pipeline", iterations,
+              iterations > 0 ? elapsed_s * 1e3 / iterations : 0.0, "", "",
+              elapsed_s > 0 ? iterations / elapsed_s : 0.0);
+}
+}  // namespace
+
+int main(int argc, char **argv)
+{
+  size_t iterations = 100;
+  size_t warmup = 10;
+  bool is_async = false;
+  tvm_utility::pipeline::InferenceEngineTVMConfig config = model_config::config;
+  for (int i = 1; i < argc; ++i)
+  {
+    const std::string arg = argv[i];
+    if (arg == "--iterations" && i + 1 < argc)
+    {
+      iterations = std::strtoul(argv[++i], nullptr, 10);
+    }
+    else if (arg == "--warmup" && i + 1 < argc)
+    {
+      warmup = std::strtoul(argv[++i], nullptr, 10);
+    }
+    else if (arg == "--async")
+    {
+      is_async = true;
+    }
+    else if (arg == "--threads" && i + 1 < argc)
+    {
+      config.tvm_num_threads = std::atoi(argv[++i]);
+    }
+    else if (arg == "--affinity" && i + 1 < argc)
+    {
+      config.tvm_cpu_affinity_mask = std::strtoull(argv[++i], nullptr, 16);
+    }
+    else if (arg == "--cores" && i + 1 < argc && (std::string(argv[i + 1]) == "big" ||
+                                                  std::string(argv[i + 1]) == "little"))
+    {
+      config.tvm_core_preference = std::string(argv[++i]) == "big" ? TVMCorePreference::Big
+                                                                   : TVMCorePreference::Little;
+    }
+    else
+    {
+      std::fprintf(stderr,
+                   "usage: %s [--iterations N] [--warmup N] [--async] [--threads N] "
+                   "[--affinity MASK] [--cores big|little]\n",
+                   argv[0]);
+      return 1;
+    }
+  }
+
+  PipelineStatistics statistics(iterations);
+  if (is_async)
+  {
+    AsyncPipeline<PreProcessorYoloV2Tiny, InferenceEngineTVM, PostProcessorYoloV2Tiny>
+        pipeline(PreProcessorYoloV2Tiny{model_config::config},
+                 InferenceEngineTVM{config},
+                 PostProcessorYoloV2Tiny{model_config::config}, 1,
+                 OverflowPolicy::Block, statistics.timer());  // NOLINT
+    benchmark(pipeline, statistics, iterations, warmup);
+  }
+  else
+  {
+    Pipeline<PreProcessorYoloV2Tiny, InferenceEngineTVM, PostProcessorYoloV2Tiny>
+        pipeline(PreProcessorYoloV2Tiny{model_config::config},
+                 InferenceEngineTVM{config},
+                 PostProcessorYoloV2Tiny{model_config::config},
+                 statistics.timer());  // NOLINT
+    benchmark(pipeline, statistics, iterations, warmup);
+  }
+  return 0;
+}
@@ -0,0 +1,208 @@
+/*
+ * Copyright 2020 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TVM_UTILITY_TEST_YOLO_V2_TINY_YOLO_V2_TINY_HPP
+#define TVM_UTILITY_TEST_YOLO_V2_TINY_YOLO_V2_TINY_HPP
+
+#include "pcl_ros/point_cloud.h"
+#include <opencv2/core/core.hpp>
+#include <opencv2/highgui/highgui.hpp>
+#include <opencv2/imgproc/imgproc.hpp>
+#include <opencv2/opencv.hpp>
+#include <tvm_utility/pipeline.h>
+#include <tvm_utility/post_processing.h>
+
+#include <algorithm>
+#include <cassert>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Name of file containing the human readable names of the classes. One class
+// on each line.
+#define LABEL_FILENAME "labels.txt"
+// Name of file containing the anchor values for the network. Each line is one
+// anchor. each anchor has 2 comma separated floating point values.
+#define ANCHOR_FILENAME "anchors.csv"
+// filename of the image on which to run the inference
+#define IMAGE_FILENAME "test_image_0.jpg"
+
+class PreProcessorYoloV2Tiny
+    : public tvm_utility::pipeline::PreProcessor<sensor_msgs::PointCloud2>
+{
+public:
+  explicit PreProcessorYoloV2Tiny(tvm_utility::pipeline::InferenceEngineTVMConfig config)
+      : network_input_width(config.network_inputs[0].second[1]),
+        network_input_height(config.network_inputs[0].second[2]),
+        network_input_depth(config.network_inputs[0].second[3]),
+        network_datatype_bytes(config.tvm_dtype_bits / 8)
+  {
+    // allocate input variable
+    std::vector<int64_t> shape_x
+    {
+      1,
+      network_input_width,
+      network_input_height,
+      network_input_depth
+    };
+    tvm_utility::pipeline::TVMArrayContainer x
+    {
+      shape_x,
+      config.tvm_dtype_code,
+      config.tvm_dtype_bits,
+      config.tvm_dtype_lanes,
+      config.tvm_device_type,
+      config.tvm_device_id
+    };
+
+    output = x;
+  }
+
+  tvm_utility::pipeline::TVMArrayContainerVector
+  schedule(const sensor_msgs::PointCloud2 &input)
+  {
+    // read input image
+    auto image = cv::imread(IMAGE_FILENAME, CV_LOAD_IMAGE_COLOR);
+    if (!image.data)
+    {
+      throw std::runtime_error("File " IMAGE_FILENAME " not found");
+    }
+
+    // Compute the ratio for resizing and size for padding
+    double scale_x =
+        static_cast<double>(image.size().width) / network_input_width;
+    double scale_y =
+        static_cast<double>(image.size().height) / network_input_height;
+    double scale = std::max(scale_x, scale_y);
+
+    // perform padding
+    if (scale != 1)
+    {
+      cv::resize(image, image, cv::Size(), 1.0f / scale, 1.0f / scale);
+    }
+
+    size_t w_pad = network_input_width - image.size().width;
+    size_t h_pad = network_input_height - image.size().height;
+
+    if (w_pad || h_pad)
+    {
+      cv::copyMakeBorder(image, image, h_pad / 2, (h_pad - h_pad / 2),
+                         w_pad / 2, (w_pad - w_pad / 2), cv::BORDER_CONSTANT,
+                         cv::Scalar(0, 0, 0));
+    }
+
+    // convert pixel values from int8 to float32. convert pixel value range from
+    // 0 - 255 to 0 - 1.
+    cv::Mat3f image_3f{};
+    image.convertTo(image_3f, CV_32FC3, 1 / 255.0f);
+
+    // cv library use BGR as a default color format, the network expects the
+    // data in RGB format
+    cv::cvtColor(image_3f, image_3f, CV_BGR2RGB);
+
+    TVMArrayCopyFromBytes(output.getArray(), image_3f.data,
+                          network_input_width * network_input_height *
+                              network_input_depth * network_datatype_bytes);
+
+    return {output};
+  }
+
+private:
+  int64_t network_input_width;
+  int64_t network_input_height;
+  int64_t network_input_depth;
+  int64_t network_datatype_bytes;
+  tvm_utility::pipeline::TVMArrayContainer output;
+};
+
+class PostProcessorYoloV2Tiny
+    : public tvm_utility::pipeline::PostProcessor<std::vector<float>>
+{
+public:
+  PostProcessorYoloV2Tiny(
+      tvm_utility::pipeline::InferenceEngineTVMConfig config)
+  {
+    // parse human readable names for the classes
+    std::ifstream label_file{LABEL_FILENAME};
+    if (!label_file.good())
+    {
+      throw std::runtime_error("unable to open label file:" LABEL_FILENAME);
+    }
+    std::string line{};
+    while (std::getline(label_file, line))
+    {
+      labels.push_back(line);
+    }
+
+    // Get anchor values for this network from the anchor file
+    std::ifstream anchor_file{ANCHOR_FILENAME};
+    if (!anchor_file.good())
+    {
+      throw std::runtime_error("unable to open anchor file:" ANCHOR_FILENAME);
+    }
+    std::string first{};
+    std::string second{};
+    std::vector<std::pair<float, float>> anchors{};
+    while (std::getline(anchor_file, line))
+    {
+      std::stringstream line_stream(line);
+      std::getline(line_stream, first, ',');
+      std::getline(line_stream, second, ',');
+      anchors.push_back(
+          std::make_pair(std::atof(first.c_str()), std::atof(second.c_str())));
+    }
+
+    // decode all the detections with a score above 0.3
+    tvm_utility::post_processing::YoloDecoderConfig decoder_config
+    {
+      config.network_outputs[0].second,
+      anchors,
+      0.3f,
+      0
+    };
+    decoder = tvm_utility::post_processing::YoloDecoder{decoder_config};
+  }
+
+  std::vector<float>
+  schedule(const tvm_utility::pipeline::TVMArrayContainerVector &input)
+  {
+    // assert data is stored row-majored in input and the dtype is float
+    assert(input[0].getArray()->strides == nullptr);
+    assert(input[0].getArray()->dtype.bits == sizeof(float) * 8);
+
+    // get a pointer to the output data
+    float *data_ptr =
+      reinterpret_cast<float *>(reinterpret_cast<uint8_t *>(input[0].getArray()->data) +
+                                input[0].getArray()->byte_offset);
+
+    // vector used to check if the result is accurate,
+    // this is also the output of this (schedule) function
+    std::vector<float> scores_above_threshold{};
+    for (const auto &detection : decoder.decode(data_ptr))
+    {
+      scores_above_threshold.push_back(detection.score);
+    }
+    return scores_above_threshold;
+  }
+
+private:
+  std::vector<std::string> labels{};
+  tvm_utility::post_processing::YoloDecoder decoder{};
+};
+
+#endif  // TVM_UTILITY_TEST_YOLO_V2_TINY_YOLO_V2_TINY_HPP
@@ -18,8 +18,11 @@
 #define VECTOR_MAP_VECTOR_MAP_H
 
 #include <ros/ros.h>
+#include <ros/callback_queue.h>
+#include <ros/spinner.h>
 #include <geometry_msgs/Point.h>
 #include <geometry_msgs/Quaternion.h>
+#include <std_msgs/UInt8MultiArray.h>
 #include <visualization_msgs/Marker.h>
 
 #include <vector_map_msgs/PointArray.h>
@@ -55,8 +58,18 @@
 #include <vector_map_msgs/FenceArray.h>
 #include <vector_map_msgs/RailCrossingArray.h>
 
+#include <boost/bind.hpp>
+
+#include <algorithm>
+#include <array>
+#include <climits>
+#include <cstdint>
 #include <fstream>
+#include <functional>
+#include <future>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -226,8 +239,334 @@ public:
   }
 };
 
-template <class T, class U>
-using Updater = std::function<void(std::map<Key<T>, T>&, const U&)>;
+// Storage policies of Handle. Both are filled by an updater in one pass (clear, insert for every item of the message,
+// build) and keep the first item inserted for a repeated key. Items are visited in increasing id order.
+
+// std::map of the items, every lookup walks the tree
+template <class T>
+class TreeStorage
+{
+private:
+  std::map<Key<T>, T> map_;
+
+public:
+  void clear(size_t /*capacity*/ = 0)
+  {
+    map_ = std::map<Key<T>, T>();
+  }
+
+  void insert(const Key<T>& key, const T& item)
+  {
+    map_.insert(std::make_pair(key, item));
+  }
+
+  void build()
+  {
+  }
+
+  const T* find(const Key<T>& key) const
+  {
+    auto it = map_.find(key);
+    if (it == map_.end())
+      return nullptr;
+    return &it->second;
+  }
+
+  template <class F>
+  void forEach(F f) const
+  {
+    for (const auto& pair : map_)
+      f(pair.second);
+  }
+
+  bool empty() const
+  {
+    return map_.empty();
+  }
+
+  size_t size() const
+  {
+    return map_.size();
+  }
+};
+
+// Contiguous items sorted by id. When the ids are compact (at most twice as many slots as items) a dense array
+// indexed by id gives the position of each item, otherwise lookups are a binary search over the ids.
+// The items are either owned or those of a mapped snapshot (attach), used in place
+template <class T>
+class FlatStorage
+{
+private:
+  std::vector<int> ids_;
+  std::vector<T> items_;
+  std::vector<int> index_;  // position in items_ of id min_id_ + i, -1 when there is no such id
+  int min_id_ = 0;
+  std::shared_ptr<const void> mapping_;  // held while the views point into it
+  const int* ids_view_ = nullptr;
+  const T* items_view_ = nullptr;
+  size_t size_ = 0;
+
+  void buildDenseIndex()
+  {
+    index_.clear();
+    if (size_ > 0 && static_cast<int64_t>(ids_view_[size_ - 1]) - ids_view_[0] < 2 * static_cast<int64_t>(size_))
+    {
+      min_id_ = ids_view_[0];
+      index_.assign(ids_view_[size_ - 1] - min_id_ + 1, -1);
+      for (size_t i = 0; i < size_; ++i)
+        index_[ids_view_[i] - min_id_] = static_cast<int>(i);
+    }
+  }
+
+public:
+  void clear(size_t capacity = 0)
+  {
+    ids_.clear();
+    items_.clear();
+    index_.clear();
+    ids_.reserve(capacity);
+    items_.reserve(capacity);
+    mapping_.reset();
+    ids_view_ = nullptr;
+    items_view_ = nullptr;
+    size_ = 0;
+  }
+
+  void insert(const Key<T>& key, const T& item)
+  {
+    ids_.push_back(key.getId());
+    items_.push_back(item);
+  }
+
+  void build()
+  {
+    // message arrays are nearly always in id order already, sort only when needed
+    if (!std::is_sorted(ids_.begin(), ids_.end()))
+    {
+      std::vector<size_t> order(ids_.size());
+      for (size_t i = 0; i < order.size(); ++i)
+        order[i] = i;
+      std::stable_sort(order.begin(), order.end(), [this](size_t a, size_t b) { return ids_[a] < ids_[b]; });
+
+      std::vector<int> ids;
+      std::vector<T> items;
+      ids.reserve(ids_.size());
+      items.reserve(items_.size());
+      for (size_t i : order)
+      {
+        ids.push_back(ids_[i]);
+        items.push_back(std::move(items_[i]));
+      }
+      ids_.swap(ids);
+      items_.swap(items);
+    }
+
+    // the sort is stable, so the first of equal ids is the one inserted first
+    size_t n = 0;
+    for (size_t i = 0; i < ids_.size(); ++i)
+    {
+      if (n > 0 && ids_[i] == ids_[n - 1])
+        continue;
+      if (n != i)
+      {
+        ids_[n] = ids_[i];
+        items_[n] = std::move(items_[i]);
+      }
+      ++n;
+    }
+    ids_.resize(n);
+    items_.resize(n);
+
+    ids_view_ = ids_.data();
+    items_view_ = items_.data();
+    size_ = n;
+    buildDenseIndex();
+  }
+
+  // The items of previous whose id is not in removed (sorted), merged with the items of added in one pass, both
+  // built. An id in both is taken from added. moved gets the new position of every item of previous, then of every
+  // item of added, -1 for the items left out. The items of previous are moved from unless it is attached
+  void merge(FlatStorage& previous, const FlatStorage& added, const std::vector<int>& removed, std::vector<int>& moved)
+  {
+    clear(previous.size_ + added.size_);
+    moved.assign(previous.size_ + added.size_, -1);
+    size_t i = 0;
+    size_t j = 0;
+    size_t r = 0;
+    while (i < previous.size_ || j < added.size_)
+    {
+      if (j == added.size_ || (i < previous.size_ && previous.ids_view_[i] < added.ids_view_[j]))
+      {
+        int id = previous.ids_view_[i];
+        while (r < removed.size() && removed[r] < id)
+          ++r;
+        if (r == removed.size() || removed[r] != id)
+        {
+          moved[i] = static_cast<int>(ids_.size());
+          ids_.push_back(id);
+          if (previous.mapping_)
+            items_.push_back(previous.items_view_[i]);
+          else
+            items_.push_back(std::move(previous.items_[i]));
+        }
+        ++i;
+        continue;
+      }
+
+      if (i < previous.size_ && previous.ids_view_[i] == added.ids_view_[j])
+        ++i;
+      moved[previous.size_ + j] = static_cast<int>(ids_.size());
+      ids_.push_back(added.ids_view_[j]);
+      items_.push_back(added.items_view_[j]);
+      ++j;
+    }
+
+    ids_view_ = ids_.data();
+    items_view_ = items_.data();
+    size_ = ids_.size();
+    buildDenseIndex();
+  }
+
+  // ids sorted and unique, the items stay valid as long as mapping is held
+  void attach(const std::shared_ptr<const void>& mapping, const int* ids, const T* items, size_t size)
+  {
+    clear();
+    mapping_ = mapping;
+    ids_view_ = ids;
+    items_view_ = items;
+    size_ = size;
+    buildDenseIndex();
+  }
+
+  const T* find(const Key<T>& key) const
+  {
+    int id = key.getId();
+    if (!index_.empty())
+    {
+      int64_t slot = static_cast<int64_t>(id) - min_id_;
+      if (slot < 0 || slot >= static_cast<int64_t>(index_.size()) || index_[slot] < 0)
+        return nullptr;
+      return &items_view_[index_[slot]];
+    }
+
+    const int* end = ids_view_ + size_;
+    const int* it = std::lower_bound(ids_view_, end, id);
+    if (it == end || *it != id)
+      return nullptr;
+    return &items_view_[it - ids_view_];
+  }
+
+  template <class F>
+  void forEach(F f) const
+  {
+    for (size_t i = 0; i < size_; ++i)
+      f(items_view_[i]);
+  }
+
+  // position of the items in id order
+  const T* at(size_t position) const
+  {
+    return &items_view_[position];
+  }
+
+  const int* ids() const
+  {
+    return ids_view_;
+  }
+
+  bool empty() const
+  {
+    return size_ == 0;
+  }
+
+  size_t size() const
+  {
+    return size_;
+  }
+};
+
+// Snapshot of a loaded VectorMap (VectorMap::saveSnapshot, vector_map_loader snapshot_file): every category in id
+// order with its secondary indexes, and the spatial grids when they are enabled, in the byte order of the writer.
+// VectorMap::loadSnapshot maps the file, a path under /dev/shm shares it between the nodes of a host. The categories
+// whose message layout is their serialization (the simple messages of ROS) are used in place, the others are
+// deserialized from the mapping. Secondary index entries are (key, position in id order)
+constexpr uint32_t SNAPSHOT_VERSION = 1;
+
+struct SnapshotIndexEntry
+{
+  int32_t key;
+  uint32_t position;
+};
+
+// Tiled transport of the categories (vector_map_loader publish_tiles). Every category is split in square tiles of the
+// map plane, x Point.bx and y Point.ly, and each tile is latched on its own topic as a chunk: a header and the
+// serialized category array of the tile, LZ4 compressed when that is smaller. An item is in the tile of its first
+// point, reached through its line, area, vector, pole or node, items without a point are in the tile_none topic of
+// their category. The index topic lists every published tile, so a subscriber knows which tiles it waits for
+constexpr int32_t NO_TILE = INT32_MIN;
+const std::string TILE_INDEX_TOPIC = "/vector_map_info/tiles";
+
+struct TileId
+{
+  int32_t x;
+  int32_t y;
+};
+
+struct TileIndexEntry
+{
+  category_t category;
+  TileId tile;
+  uint32_t size;  // items in the tile
+};
+
+struct TileIndex
+{
+  double tile_size = 0;
+  std::vector<TileIndexEntry> entries;
+};
+
+// topic name of a single category ("point", "dtlane", ...), empty for anything else
+std::string getCategoryName(category_t category);
+TileId getTileId(double x, double y, double tile_size);
+
+// /vector_map_info/<category>/tile_<x>_<y>, a negative number is written n<absolute value>, tile_none for NO_TILE
+std::string getTileTopic(category_t category, const TileId& tile);
+
+void encodeTileIndex(const TileIndex& index, std_msgs::UInt8MultiArray& msg);
+bool decodeTileIndex(const std_msgs::UInt8MultiArray& msg, TileIndex& index);
+
+// data is the serialized array message of the tile
+void encodeTileChunk(category_t category, const TileId& tile, const std::vector<uint8_t>& data, bool compress,
+                     std_msgs::UInt8MultiArray& msg);
+bool decodeTileChunk(const std_msgs::UInt8MultiArray& msg, category_t& category, TileId& tile,
+                     std::vector<uint8_t>& data);
+
+template <class U>
+std::vector<uint8_t> serializeArray(const U& array)
+{
+  std::vector<uint8_t> data(ros::serialization::serializationLength(array));
+  ros::serialization::OStream stream(data.data(), data.size());
+  ros::serialization::serialize(stream, array);
+  return data;
+}
+
+template <class U>
+bool deserializeArray(std::vector<uint8_t>& data, U& array)
+{
+  try
+  {
+    ros::serialization::IStream stream(data.data(), data.size());
+    ros::serialization::deserialize(stream, array);
+  }
+  catch (const ros::serialization::StreamOverrunException&)
+  {
+    return false;
+  }
+  return true;
+}
+
+template <class T, class U, class S = FlatStorage<T>>
+using Updater = std::function<void(S&, const U&)>;
 
 template <class T>
 using Callback = std::function<void(const T&)>;
@@ -235,20 +574,80 @@ using Callback = std::function<void(const T&)>;
 template <class T>
 using Filter = std::function<bool(const T&)>;
 
-template <class T, class U>
+// foreign key field of an item, the join column of a secondary index
+template <class T>
+using IndexKey = std::function<int(const T&)>;
+
+template <class T, class U, class S = FlatStorage<T>>
 class Handle
 {
 private:
   ros::Subscriber sub_;
-  Updater<T, U> update_;
+  Updater<T, U, S> update_;
   std::vector<Callback<U>> cbs_;
-  std::map<Key<T>, T> map_;
+  S storage_;
+  std::vector<IndexKey<T>> index_keys_;
+  std::vector<std::vector<std::pair<int, const T*>>> indexes_;  // (foreign key, item) sorted by foreign key, then by id
+  std::vector<ros::Subscriber> tile_subs_;
+  std::map<std::string, std::vector<int>> tile_ids_;  // ids of the items of every tile received, by topic
+  std::function<void()> notify_;  // after an update that leaves the storage not empty
+  std::mutex* update_mutex_ = nullptr;  // held by the updates and their callbacks when set
+
+  void buildIndex(size_t index)
+  {
+    auto& entries = indexes_[index];
+    entries.clear();
+    entries.reserve(storage_.size());
+    storage_.forEach([&](const T& item) { entries.emplace_back(index_keys_[index](item), &item); });
+    std::stable_sort(entries.begin(), entries.end(),
+                     [](const std::pair<int, const T*>& a, const std::pair<int, const T*>& b) {
+                       return a.first < b.first;
+                     });
+  }
+
+  // the entries of previous moved to their position in the storage merged from it and added, see FlatStorage::merge,
+  // and the entries of added merged in
+  void mergeIndex(size_t index, const S& previous, const S& added, const std::vector<int>& moved)
+  {
+    auto& entries = indexes_[index];
+    size_t n = 0;
+    for (size_t i = 0; i < entries.size(); ++i)
+    {
+      int position = moved[entries[i].second - previous.at(0)];
+      if (position >= 0)
+        entries[n++] = std::make_pair(entries[i].first, storage_.at(position));
+    }
+    entries.resize(n);
+    for (size_t i = 0; i < added.size(); ++i)
+      entries.emplace_back(index_keys_[index](*added.at(i)), storage_.at(moved[previous.size() + i]));
+
+    // the positions are in id order, so (key, item) is the order buildIndex leaves
+    auto less = [](const std::pair<int, const T*>& a, const std::pair<int, const T*>& b) {
+      return a.first < b.first || (a.first == b.first && a.second < b.second);
+    };
+    std::sort(entries.begin() + n, entries.end(), less);
+    std::inplace_merge(entries.begin(), entries.begin() + n, entries.end(), less);
+  }
 
   void subscribe(const U& msg)
   {
-    update_(map_, msg);
-    for (const auto& cb : cbs_)
-      cb(msg);
+    {
+      std::unique_lock<std::mutex> lock;
+      if (update_mutex_ != nullptr)
+        lock = std::unique_lock<std::mutex>(*update_mutex_);
+      update_(storage_, msg);
+      for (size_t i = 0; i < indexes_.size(); ++i)
+        buildIndex(i);
+      for (const auto& cb : cbs_)
+        cb(msg);
+    }
+    if (notify_ && !storage_.empty())
+      notify_();
+  }
+
+  void subscribeTile(const std::string& topic, const std_msgs::UInt8MultiArray::ConstPtr& msg)
+  {
+    receiveTile(topic, *msg);
   }
 
 public:
@@ -256,16 +655,78 @@ public:
   {
   }
 
-  void registerSubscriber(ros::NodeHandle& nh, const std::string& topic_name)
+  // same as a tile chunk received by the tile subscriber of topic, the updater must be registered
+  void receiveTile(const std::string& topic, const std_msgs::UInt8MultiArray& msg)
+  {
+    category_t category;
+    TileId tile;
+    std::vector<uint8_t> data;
+    U array;
+    if (!decodeTileChunk(msg, category, tile, data) || !deserializeArray(data, array))
+    {
+      ROS_ERROR_STREAM("invalid vector map tile on " << topic);
+      return;
+    }
+
+    // only the items of this tile are merged into the storage, a tile received again (the loader restarted)
+    // replaces its previous items
+    S added;
+    update_(added, array);
+    {
+      std::unique_lock<std::mutex> lock;
+      if (update_mutex_ != nullptr)
+        lock = std::unique_lock<std::mutex>(*update_mutex_);
+      std::vector<int>& ids = tile_ids_[topic];
+      S previous;
+      std::swap(previous, storage_);
+      std::vector<int> moved;
+      storage_.merge(previous, added, ids, moved);
+      for (size_t i = 0; i < indexes_.size(); ++i)
+        mergeIndex(i, previous, added, moved);
+      ids.assign(added.ids(), added.ids() + added.size());
+      for (const auto& cb : cbs_)
+        cb(array);
+    }
+    if (notify_ && !storage_.empty())
+      notify_();
+  }
+
+  void registerSubscriber(ros::NodeHandle& nh, const std::string& topic_name,
+                          const std::function<void()>& notify = std::function<void()>())
+  {
+    notify_ = notify;
+    sub_ = nh.subscribe(topic_name, 1, &Handle<T, U, S>::subscribe, this);
+  }
+
+  // Handles whose callbacks read one another share a mutex, so their updates may run on different threads
+  void setUpdateMutex(std::mutex* mutex)
   {
-    sub_ = nh.subscribe(topic_name, 1, &Handle<T, U>::subscribe, this);
+    update_mutex_ = mutex;
   }
 
-  void registerUpdater(const Updater<T, U>& update)
+  // the items of every tile topic are merged into the storage as the tile arrives, the callbacks get the tile
+  void registerTileSubscriber(ros::NodeHandle& nh, const std::string& topic)
+  {
+    tile_subs_.push_back(nh.subscribe<std_msgs::UInt8MultiArray>(
+        topic, 1, boost::bind(&Handle<T, U, S>::subscribeTile, this, topic, _1)));
+  }
+
+  bool hasTile(const std::string& topic) const
+  {
+    return tile_ids_.count(topic) > 0;
+  }
+
+  void registerUpdater(const Updater<T, U, S>& update)
   {
     update_ = update;
   }
 
+  // same as a message received by the subscriber, the updater must be registered
+  void receive(const U& msg)
+  {
+    subscribe(msg);
+  }
+
   void registerCallback(const Callback<U>& cb)
   {
     cbs_.push_back(cb);
@@ -273,26 +734,117 @@ public:
 
   T findByKey(const Key<T>& key) const
   {
-    auto it = map_.find(key);
-    if (it == map_.end())
+    const T* item = storage_.find(key);
+    if (item == nullptr)
       return T();
-    return it->second;
+    return *item;
+  }
+
+  const T* findPtrByKey(const Key<T>& key) const
+  {
+    return storage_.find(key);
+  }
+
+  void forEach(const Filter<T>& filter, const Callback<T>& fn) const
+  {
+    storage_.forEach([&](const T& item) {
+      if (filter(item))
+        fn(item);
+    });
+  }
+
+  // Secondary index on key, rebuilt with the storage on every message before the callbacks run.
+  // Returns the index number
+  size_t addIndex(const IndexKey<T>& key)
+  {
+    index_keys_.push_back(key);
+    indexes_.emplace_back();
+    buildIndex(indexes_.size() - 1);
+    return indexes_.size() - 1;
+  }
+
+  // Items whose key of index is value, in id order, binary search instead of a full scan
+  void forEachByIndex(size_t index, int value, const Callback<T>& fn) const
+  {
+    const auto& entries = indexes_.at(index);
+    auto it = std::lower_bound(entries.begin(), entries.end(), value,
+                               [](const std::pair<int, const T*>& entry, int v) { return entry.first < v; });
+    for (; it != entries.end() && it->first == value; ++it)
+      fn(*it->second);
   }
 
   std::vector<T> findByFilter(const Filter<T>& filter) const
   {
     std::vector<T> vector;
-    for (const auto& pair : map_)
-    {
-      if (filter(pair.second))
-        vector.push_back(pair.second);
-    }
+    storage_.forEach([&](const T& item) {
+      if (filter(item))
+        vector.push_back(item);
+    });
     return vector;
   }
 
   bool empty() const
   {
-    return map_.empty();
+    return storage_.empty();
+  }
+
+  const S& getStorage() const
+  {
+    return storage_;
+  }
+
+  size_t getIndexCount() const
+  {
+    return indexes_.size();
+  }
+
+  const std::vector<std::pair<int, const T*>>& getIndex(size_t index) const
+  {
+    return indexes_.at(index);
+  }
+
+  // Storage replaced by fill (a snapshot load), then the indexes, callbacks and notification as for a message.
+  // indexes are the (entries, count) of the secondary indexes in the snapshot, an index without a valid count is
+  // rebuilt. The callbacks get the loaded items as a message
+  void load(const std::function<void(S&)>& fill,
+            const std::vector<std::pair<const SnapshotIndexEntry*, size_t>>& indexes)
+  {
+    {
+      std::unique_lock<std::mutex> lock;
+      if (update_mutex_ != nullptr)
+        lock = std::unique_lock<std::mutex>(*update_mutex_);
+      fill(storage_);
+      for (size_t i = 0; i < indexes_.size(); ++i)
+      {
+        if (i >= indexes.size() || indexes[i].second != storage_.size())
+        {
+          buildIndex(i);
+          continue;
+        }
+        auto& entries = indexes_[i];
+        entries.clear();
+        entries.reserve(storage_.size());
+        for (size_t j = 0; j < indexes[i].second; ++j)
+        {
+          const SnapshotIndexEntry& entry = indexes[i].first[j];
+          if (entry.position >= storage_.size())
+            break;
+          entries.emplace_back(entry.key, storage_.at(entry.position));
+        }
+        if (entries.size() != storage_.size())
+          buildIndex(i);
+      }
+      if (!cbs_.empty())
+      {
+        U msg;
+        msg.data.reserve(storage_.size());
+        storage_.forEach([&msg](const T& item) { msg.data.push_back(item); });
+        for (const auto& cb : cbs_)
+          cb(msg);
+      }
+    }
+    if (notify_ && !storage_.empty())
+      notify_();
   }
 };
 
@@ -313,9 +865,44 @@ std::vector<T> parse(const std::string& csv_file)
   return objs;
 }
 
+// Uniform grid over x (Point.bx) and y (Point.ly), every cell lists the ids of the boxes that overlap it
+class GridIndex
+{
+private:
+  double cell_size_;
+  std::vector<std::pair<int64_t, int>> cells_;  // (cell key, id) sorted by cell key, then by id
+  double min_x_;
+  double min_y_;
+  double max_x_;
+  double max_y_;
+
+  int getCell(double v) const;
+  static int64_t getCellKey(int ix, int iy);
+
+public:
+  explicit GridIndex(double cell_size = 10.0);
+
+  void clear(double cell_size);
+  void insert(int id, double min_x, double min_y, double max_x, double max_y);
+  void build();
+
+  // ids of the boxes sharing a cell with the query box (a superset of the overlapping ones), sorted and unique
+  void findInBox(double min_x, double min_y, double max_x, double max_y, std::vector<int>& ids) const;
+  bool empty() const;
+
+  // distance from (x, y) to the farthest corner of the bounding box of everything inserted
+  double getMaxDistance(double x, double y) const;
+  double getCellSize() const;
+
+  friend class VectorMap;  // snapshot of the cells
+};
+
 class VectorMap
 {
 private:
+  // declared before the handles, their subscribers are removed from it when they are destroyed
+  ros::CallbackQueue async_queue_;
+
   Handle<Point, PointArray> point_;
   Handle<Vector, VectorArray> vector_;
   Handle<Line, LineArray> line_;
@@ -349,7 +936,55 @@ private:
   Handle<Fence, FenceArray> fence_;
   Handle<RailCrossing, RailCrossingArray> rail_crossing_;
 
-  void registerSubscriber(ros::NodeHandle& nh, category_t category);
+  // index numbers of the joins, every object data category has its linkid index first
+  static const size_t LINK_INDEX = 0;
+  size_t node_pid_index_;
+  size_t lane_bnid_index_;
+  size_t lane_fnid_index_;
+
+  // spatial index, disabled while spatial_cell_size_ is 0
+  double spatial_cell_size_;
+  GridIndex point_grid_;
+  GridIndex lane_grid_;
+  bool loading_snapshot_;  // the grids are set by loadSnapshot, not by the callbacks
+
+  // tiled subscription, the tiles of tile_category_ overlapping one of the regions
+  // copy of the NodeHandle of the first subscribeTiles for the tile topics, a member NodeHandle would need ros::init
+  // before any VectorMap is constructed
+  std::unique_ptr<ros::NodeHandle> tile_nh_;
+  ros::Subscriber tile_index_sub_;
+  TileIndex tile_index_;
+  bool has_tile_index_;
+  category_t tile_category_;
+  std::vector<std::array<double, 4>> tile_regions_;  // (min x, min y, max x, max y)
+  std::vector<std::pair<category_t, std::string>> tile_topics_;  // tiles subscribed
+
+  // asynchronous subscription, see subscribeAsync
+  struct AsyncSubscription
+  {
+    category_t category;
+    std::promise<void> ready;
+    std::function<void()> ready_cb;
+  };
+  std::mutex spatial_mutex_;  // point, node and lane updates, they rebuild the grids
+  std::mutex async_mutex_;
+  category_t async_received_;
+  std::vector<AsyncSubscription> async_subscriptions_;
+  // declared after the handles, the spinner threads are stopped before the handles are destroyed
+  std::unique_ptr<ros::AsyncSpinner> async_spinner_;
+
+  void registerSubscriber(ros::NodeHandle& nh, category_t category, bool async = false);
+  std::function<void()> getAsyncNotifier(bool async, category_t category);
+  void onAsyncUpdate(category_t category);
+  void subscribeTileIndex(const std_msgs::UInt8MultiArray& msg);
+  void registerTileSubscribers();
+  void registerTileSubscriber(category_t category, const std::string& topic);
+  bool hasTile(category_t category, const std::string& topic) const;
+  bool isInTileRegions(const TileId& tile) const;
+  void buildPointGrid();
+  void buildLaneGrid();
+  bool findLaneSegment(const Lane& lane, const Point*& start_point, const Point*& end_point) const;
+  double computeLaneDistance(const Lane& lane, const Point& point) const;
 
 public:
   VectorMap();
@@ -358,6 +993,26 @@ public:
   void subscribe(ros::NodeHandle& nh, category_t category, const ros::Duration& timeout);
   void subscribe(ros::NodeHandle& nh, category_t category, const size_t max_retries);
 
+  // Returns at once, the categories are received on a callback queue of their own served by nthreads threads (0 for
+  // one per core), so their updates run in parallel. When every category has been received ready_cb runs on one of
+  // these threads and the future becomes ready: future.wait_for(timeout) replaces subscribe with a timeout.
+  // The updates received later also run on these threads, the map is read safely once the future is ready
+  std::shared_future<void> subscribeAsync(ros::NodeHandle& nh, category_t category,
+                                          const std::function<void()>& ready_cb = std::function<void()>(),
+                                          int nthreads = 0);
+
+  // Tiled subscription to a vector_map_loader publishing tiles: only the tiles of category overlapping the box (and
+  // the tile_none items) are received. Waits like subscribe until the tile index and all the tiles it lists for the
+  // box are received. Every tile is merged into its category as it arrives, also the tiles of the regions added
+  // later, and the callbacks get the items of that tile. The finders see every tile received so far. The topics are
+  // subscribed with the NodeHandle of the first call. Not to be mixed with subscribe on the same categories
+  void subscribeTiles(ros::NodeHandle& nh, category_t category, double min_x, double min_y, double max_x,
+                      double max_y);
+  void subscribeTiles(ros::NodeHandle& nh, category_t category, double min_x, double min_y, double max_x,
+                      double max_y, const ros::Duration& timeout);
+  void addTileRegion(double min_x, double min_y, double max_x, double max_y);
+  bool hasSubscribedTiles() const;
+
   Point findByKey(const Key<Point>& key) const;
   Vector findByKey(const Key<Vector>& key) const;
   Line findByKey(const Key<Line>& key) const;
@@ -424,8 +1079,162 @@ public:
   std::vector<Fence> findByFilter(const Filter<Fence>& filter) const;
   std::vector<RailCrossing> findByFilter(const Filter<RailCrossing>& filter) const;
 
+  // Same lookups without copies. The pointer and the items passed to fn belong to the map, they are valid until
+  // the next message of their category is received, nullptr when the key is not in the map
+  const Point* findPtrByKey(const Key<Point>& key) const;
+  const Vector* findPtrByKey(const Key<Vector>& key) const;
+  const Line* findPtrByKey(const Key<Line>& key) const;
+  const Area* findPtrByKey(const Key<Area>& key) const;
+  const Pole* findPtrByKey(const Key<Pole>& key) const;
+  const Box* findPtrByKey(const Key<Box>& key) const;
+  const DTLane* findPtrByKey(const Key<DTLane>& key) const;
+  const Node* findPtrByKey(const Key<Node>& key) const;
+  const Lane* findPtrByKey(const Key<Lane>& key) const;
+  const WayArea* findPtrByKey(const Key<WayArea>& key) const;
+  const RoadEdge* findPtrByKey(const Key<RoadEdge>& key) const;
+  const Gutter* findPtrByKey(const Key<Gutter>& key) const;
+  const Curb* findPtrByKey(const Key<Curb>& key) const;
+  const WhiteLine* findPtrByKey(const Key<WhiteLine>& key) const;
+  const StopLine* findPtrByKey(const Key<StopLine>& key) const;
+  const ZebraZone* findPtrByKey(const Key<ZebraZone>& key) const;
+  const CrossWalk* findPtrByKey(const Key<CrossWalk>& key) const;
+  const RoadMark* findPtrByKey(const Key<RoadMark>& key) const;
+  const RoadPole* findPtrByKey(const Key<RoadPole>& key) const;
+  const RoadSign* findPtrByKey(const Key<RoadSign>& key) const;
+  const Signal* findPtrByKey(const Key<Signal>& key) const;
+  const StreetLight* findPtrByKey(const Key<StreetLight>& key) const;
+  const UtilityPole* findPtrByKey(const Key<UtilityPole>& key) const;
+  const GuardRail* findPtrByKey(const Key<GuardRail>& key) const;
+  const SideWalk* findPtrByKey(const Key<SideWalk>& key) const;
+  const DriveOnPortion* findPtrByKey(const Key<DriveOnPortion>& key) const;
+  const CrossRoad* findPtrByKey(const Key<CrossRoad>& key) const;
+  const SideStrip* findPtrByKey(const Key<SideStrip>& key) const;
+  const CurveMirror* findPtrByKey(const Key<CurveMirror>& key) const;
+  const Wall* findPtrByKey(const Key<Wall>& key) const;
+  const Fence* findPtrByKey(const Key<Fence>& key) const;
+  const RailCrossing* findPtrByKey(const Key<RailCrossing>& key) const;
+
+  void forEach(const Filter<Point>& filter, const Callback<Point>& fn) const;
+  void forEach(const Filter<Vector>& filter, const Callback<Vector>& fn) const;
+  void forEach(const Filter<Line>& filter, const Callback<Line>& fn) const;
+  void forEach(const Filter<Area>& filter, const Callback<Area>& fn) const;
+  void forEach(const Filter<Pole>& filter, const Callback<Pole>& fn) const;
+  void forEach(const Filter<Box>& filter, const Callback<Box>& fn) const;
+  void forEach(const Filter<DTLane>& filter, const Callback<DTLane>& fn) const;
+  void forEach(const Filter<Node>& filter, const Callback<Node>& fn) const;
+  void forEach(const Filter<Lane>& filter, const Callback<Lane>& fn) const;
+  void forEach(const Filter<WayArea>& filter, const Callback<WayArea>& fn) const;
+  void forEach(const Filter<RoadEdge>& filter, const Callback<RoadEdge>& fn) const;
+  void forEach(const Filter<Gutter>& filter, const Callback<Gutter>& fn) const;
+  void forEach(const Filter<Curb>& filter, const Callback<Curb>& fn) const;
+  void forEach(const Filter<WhiteLine>& filter, const Callback<WhiteLine>& fn) const;
+  void forEach(const Filter<StopLine>& filter, const Callback<StopLine>& fn) const;
+  void forEach(const Filter<ZebraZone>& filter, const Callback<ZebraZone>& fn) const;
+  void forEach(const Filter<CrossWalk>& filter, const Callback<CrossWalk>& fn) const;
+  void forEach(const Filter<RoadMark>& filter, const Callback<RoadMark>& fn) const;
+  void forEach(const Filter<RoadPole>& filter, const Callback<RoadPole>& fn) const;
+  void forEach(const Filter<RoadSign>& filter, const Callback<RoadSign>& fn) const;
+  void forEach(const Filter<Signal>& filter, const Callback<Signal>& fn) const;
+  void forEach(const Filter<StreetLight>& filter, const Callback<StreetLight>& fn) const;
+  void forEach(const Filter<UtilityPole>& filter, const Callback<UtilityPole>& fn) const;
+  void forEach(const Filter<GuardRail>& filter, const Callback<GuardRail>& fn) const;
+  void forEach(const Filter<SideWalk>& filter, const Callback<SideWalk>& fn) const;
+  void forEach(const Filter<DriveOnPortion>& filter, const Callback<DriveOnPortion>& fn) const;
+  void forEach(const Filter<CrossRoad>& filter, const Callback<CrossRoad>& fn) const;
+  void forEach(const Filter<SideStrip>& filter, const Callback<SideStrip>& fn) const;
+  void forEach(const Filter<CurveMirror>& filter, const Callback<CurveMirror>& fn) const;
+  void forEach(const Filter<Wall>& filter, const Callback<Wall>& fn) const;
+  void forEach(const Filter<Fence>& filter, const Callback<Fence>& fn) const;
+  void forEach(const Filter<RailCrossing>& filter, const Callback<RailCrossing>& fn) const;
+
+  // Joins over the secondary indexes kept by VectorMap (node pid, lane bnid and fnid, linkid of the object data),
+  // O(log N) instead of a findByFilter scan. Items passed to fn have the lifetime of findPtrByKey results
+  std::vector<Node> findNodesAt(const Point& point) const;
+  std::vector<Lane> findLanesStartingAt(const Node& node) const;
+  std::vector<Lane> findLanesEndingAt(const Node& node) const;
+  void forEachLinkedTo(const Lane& lane, const Callback<RoadEdge>& fn) const;
+  void forEachLinkedTo(const Lane& lane, const Callback<Gutter>& fn) const;
+  void forEachLinkedTo(const Lane& lane, const Callback<Curb>& fn) const;
+  void forEachLinkedTo(const Lane& lane, const Callback<WhiteLine>& fn) const;
+  void forEachLinkedTo(const Lane& lane, const Callback<StopLine>& fn) const;
+  void forEachLinkedTo(const Lane& lane, const Callback<ZebraZone>& fn) const;
+  void forEachLinkedTo(const Lane& lane, const Callback<CrossWalk>& fn) const;
+  void forEachLinkedTo(const Lane& lane, const Callback<RoadMark>& fn) const;
+  void forEachLinkedTo(const Lane& lane, const Callback<RoadPole>& fn) const;
+  void forEachLinkedTo(const Lane& lane, const Callback<RoadSign>& fn) const;
+  void forEachLinkedTo(const Lane& lane, const Callback<Signal>& fn) const;
+  void forEachLinkedTo(const Lane& lane, const Callback<StreetLight>& fn) const;
+  void forEachLinkedTo(const Lane& lane, const Callback<UtilityPole>& fn) const;
+  void forEachLinkedTo(const Lane& lane, const Callback<GuardRail>& fn) const;
+  void forEachLinkedTo(const Lane& lane, const Callback<SideWalk>& fn) const;
+  void forEachLinkedTo(const Lane& lane, const Callback<DriveOnPortion>& fn) const;
+  void forEachLinkedTo(const Lane& lane, const Callback<CrossRoad>& fn) const;
+  void forEachLinkedTo(const Lane& lane, const Callback<SideStrip>& fn) const;
+  void forEachLinkedTo(const Lane& lane, const Callback<CurveMirror>& fn) const;
+  void forEachLinkedTo(const Lane& lane, const Callback<Wall>& fn) const;
+  void forEachLinkedTo(const Lane& lane, const Callback<Fence>& fn) const;
+  void forEachLinkedTo(const Lane& lane, const Callback<RailCrossing>& fn) const;
+
+  // Grid over the points and over the lane segments (start to end point, from the node and point categories),
+  // rebuilt on every point, node and lane message. Without it the spatial queries below scan the whole category
+  void enableSpatialIndex(double cell_size = 10.0);
+  bool hasSpatialIndex() const;
+
+  // Distances are 2D (bx, ly), lanes are measured to their segment. Results are sorted by id,
+  // the nearest queries return an empty object when the category is empty
+  std::vector<Point> findPointsWithinRadius(const Point& center, double radius) const;
+  Point findNearestPoint(const Point& base_point) const;
+  std::vector<Lane> findLanesWithinRadius(const Point& center, double radius) const;
+  Lane findNearestLane(const Point& base_point) const;
+
   bool hasSubscribed(category_t category) const;
 
+  // Snapshot of the received categories, their secondary indexes and the spatial grids (see SNAPSHOT_VERSION).
+  // Written to a temporary file renamed to file_name, nodes mapping the previous snapshot keep it.
+  // False on write errors
+  bool saveSnapshot(const std::string& file_name, category_t category = Category::ALL) const;
+
+  // The categories of the snapshot file_name are set as if their messages were received, the callbacks run and
+  // hasSubscribed is true for them; the other categories are left as they are. The grids of the snapshot are used when
+  // the spatial index is enabled with their cell size, otherwise they are rebuilt. False if the file can't be mapped or
+  // is not a snapshot of this version and byte order. Later messages replace the loaded categories as usual
+  bool loadSnapshot(const std::string& file_name, category_t category = Category::ALL);
+
+  // The category of msg is set as if msg was received on its topic: the indexes are built, the callbacks run and
+  // hasSubscribed is true for it. Needs no ROS master, for tools and benchmarks filling a map without a loader
+  void receive(const PointArray& msg);
+  void receive(const VectorArray& msg);
+  void receive(const LineArray& msg);
+  void receive(const AreaArray& msg);
+  void receive(const PoleArray& msg);
+  void receive(const BoxArray& msg);
+  void receive(const DTLaneArray& msg);
+  void receive(const NodeArray& msg);
+  void receive(const LaneArray& msg);
+  void receive(const WayAreaArray& msg);
+  void receive(const RoadEdgeArray& msg);
+  void receive(const GutterArray& msg);
+  void receive(const CurbArray& msg);
+  void receive(const WhiteLineArray& msg);
+  void receive(const StopLineArray& msg);
+  void receive(const ZebraZoneArray& msg);
+  void receive(const CrossWalkArray& msg);
+  void receive(const RoadMarkArray& msg);
+  void receive(const RoadPoleArray& msg);
+  void receive(const RoadSignArray& msg);
+  void receive(const SignalArray& msg);
+  void receive(const StreetLightArray& msg);
+  void receive(const UtilityPoleArray& msg);
+  void receive(const GuardRailArray& msg);
+  void receive(const SideWalkArray& msg);
+  void receive(const DriveOnPortionArray& msg);
+  void receive(const CrossRoadArray& msg);
+  void receive(const SideStripArray& msg);
+  void receive(const CurveMirrorArray& msg);
+  void receive(const WallArray& msg);
+  void receive(const FenceArray& msg);
+  void receive(const RailCrossingArray& msg);
+
   void registerCallback(const Callback<PointArray>& cb);
   void registerCallback(const Callback<VectorArray>& cb);
   void registerCallback(const Callback<LineArray>& cb);
@@ -498,6 +1307,10 @@ geometry_msgs::Point convertPointToGeomPoint(const Point& point);
 Point convertGeomPointToPoint(const geometry_msgs::Point& geom_point);
 geometry_msgs::Quaternion convertVectorToGeomQuaternion(const Vector& vector);
 Vector convertGeomQuaternionToVector(const geometry_msgs::Quaternion& geom_quaternion);
+
+// Tiles of the categories of vmap for the tiled transport, (topic, chunk) and the index listing them
+void createTileChunks(const VectorMap& vmap, category_t category, double tile_size, bool compress, TileIndex& index,
+                      std::vector<std::pair<std::string, std_msgs::UInt8MultiArray>>& chunks);
 }  // namespace vector_map
 
 std::ostream& operator<<(std::ostream& os, const vector_map::Point& obj);
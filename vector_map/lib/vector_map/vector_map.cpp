@@ -17,6 +17,10 @@
 #include <tf/transform_datatypes.h>
 #include <vector_map/vector_map.h>
 
+#include <algorithm>
+#include <cfloat>
+#include <climits>
+#include <cmath>
 #include <map>
 #include <string>
 #include <vector>
@@ -25,356 +29,420 @@ namespace vector_map
 {
 namespace
 {
-void updatePoint(std::map<Key<Point>, Point>& map, const PointArray& msg)
+template <class S>
+void updatePoint(S& storage, const PointArray& msg)
 {
-  map = std::map<Key<Point>, Point>();
+  storage.clear(msg.data.size());
   for (const auto& item : msg.data)
   {
     if (item.pid == 0)
       continue;
-    map.insert(std::make_pair(Key<Point>(item.pid), item));
+    storage.insert(Key<Point>(item.pid), item);
   }
+  storage.build();
 }
 
-void updateVector(std::map<Key<Vector>, Vector>& map, const VectorArray& msg)
+template <class S>
+void updateVector(S& storage, const VectorArray& msg)
 {
-  map = std::map<Key<Vector>, Vector>();
+  storage.clear(msg.data.size());
   for (const auto& item : msg.data)
   {
     if (item.vid == 0)
       continue;
-    map.insert(std::make_pair(Key<Vector>(item.vid), item));
+    storage.insert(Key<Vector>(item.vid), item);
   }
+  storage.build();
 }
 
-void updateLine(std::map<Key<Line>, Line>& map, const LineArray& msg)
+template <class S>
+void updateLine(S& storage, const LineArray& msg)
 {
-  map = std::map<Key<Line>, Line>();
+  storage.clear(msg.data.size());
   for (const auto& item : msg.data)
   {
     if (item.lid == 0)
       continue;
-    map.insert(std::make_pair(Key<Line>(item.lid), item));
+    storage.insert(Key<Line>(item.lid), item);
   }
+  storage.build();
 }
 
-void updateArea(std::map<Key<Area>, Area>& map, const AreaArray& msg)
+template <class S>
+void updateArea(S& storage, const AreaArray& msg)
 {
-  map = std::map<Key<Area>, Area>();
+  storage.clear(msg.data.size());
   for (const auto& item : msg.data)
   {
     if (item.aid == 0)
       continue;
-    map.insert(std::make_pair(Key<Area>(item.aid), item));
+    storage.insert(Key<Area>(item.aid), item);
   }
+  storage.build();
 }
 
-void updatePole(std::map<Key<Pole>, Pole>& map, const PoleArray& msg)
+template <class S>
+void updatePole(S& storage, const PoleArray& msg)
 {
-  map = std::map<Key<Pole>, Pole>();
+  storage.clear(msg.data.size());
   for (const auto& item : msg.data)
   {
     if (item.plid == 0)
       continue;
-    map.insert(std::make_pair(Key<Pole>(item.plid), item));
+    storage.insert(Key<Pole>(item.plid), item);
   }
+  storage.build();
 }
 
-void updateBox(std::map<Key<Box>, Box>& map, const BoxArray& msg)
+template <class S>
+void updateBox(S& storage, const BoxArray& msg)
 {
-  map = std::map<Key<Box>, Box>();
+  storage.clear(msg.data.size());
   for (const auto& item : msg.data)
   {
     if (item.bid == 0)
       continue;
-    map.insert(std::make_pair(Key<Box>(item.bid), item));
+    storage.insert(Key<Box>(item.bid), item);
   }
+  storage.build();
 }
 
-void updateDTLane(std::map<Key<DTLane>, DTLane>& map, const DTLaneArray& msg)
+template <class S>
+void updateDTLane(S& storage, const DTLaneArray& msg)
 {
-  map = std::map<Key<DTLane>, DTLane>();
+  storage.clear(msg.data.size());
   for (const auto& item : msg.data)
   {
     if (item.did == 0)
       continue;
-    map.insert(std::make_pair(Key<DTLane>(item.did), item));
+    storage.insert(Key<DTLane>(item.did), item);
   }
+  storage.build();
 }
 
-void updateNode(std::map<Key<Node>, Node>& map, const NodeArray& msg)
+template <class S>
+void updateNode(S& storage, const NodeArray& msg)
 {
-  map = std::map<Key<Node>, Node>();
+  storage.clear(msg.data.size());
   for (const auto& item : msg.data)
   {
     if (item.nid == 0)
       continue;
-    map.insert(std::make_pair(Key<Node>(item.nid), item));
+    storage.insert(Key<Node>(item.nid), item);
   }
+  storage.build();
 }
 
-void updateLane(std::map<Key<Lane>, Lane>& map, const LaneArray& msg)
+template <class S>
+void updateLane(S& storage, const LaneArray& msg)
 {
-  map = std::map<Key<Lane>, Lane>();
+  storage.clear(msg.data.size());
   for (const auto& item : msg.data)
   {
     if (item.lnid == 0)
       continue;
-    map.insert(std::make_pair(Key<Lane>(item.lnid), item));
+    storage.insert(Key<Lane>(item.lnid), item);
   }
+  storage.build();
 }
 
-void updateWayArea(std::map<Key<WayArea>, WayArea>& map, const WayAreaArray& msg)
+template <class S>
+void updateWayArea(S& storage, const WayAreaArray& msg)
 {
-  map = std::map<Key<WayArea>, WayArea>();
+  storage.clear(msg.data.size());
   for (const auto& item : msg.data)
   {
     if (item.waid == 0)
       continue;
-    map.insert(std::make_pair(Key<WayArea>(item.waid), item));
+    storage.insert(Key<WayArea>(item.waid), item);
   }
+  storage.build();
 }
 
-void updateRoadEdge(std::map<Key<RoadEdge>, RoadEdge>& map, const RoadEdgeArray& msg)
+template <class S>
+void updateRoadEdge(S& storage, const RoadEdgeArray& msg)
 {
-  map = std::map<Key<RoadEdge>, RoadEdge>();
+  storage.clear(msg.data.size());
   for (const auto& item : msg.data)
   {
     if (item.id == 0)
       continue;
-    map.insert(std::make_pair(Key<RoadEdge>(item.id), item));
+    storage.insert(Key<RoadEdge>(item.id), item);
   }
+  storage.build();
 }
 
-void updateGutter(std::map<Key<Gutter>, Gutter>& map, const GutterArray& msg)
+template <class S>
+void updateGutter(S& storage, const GutterArray& msg)
 {
-  map = std::map<Key<Gutter>, Gutter>();
+  storage.clear(msg.data.size());
   for (const auto& item : msg.data)
   {
     if (item.id == 0)
       continue;
-    map.insert(std::make_pair(Key<Gutter>(item.id), item));
+    storage.insert(Key<Gutter>(item.id), item);
   }
+  storage.build();
 }
 
-void updateCurb(std::map<Key<Curb>, Curb>& map, const CurbArray& msg)
+template <class S>
+void updateCurb(S& storage, const CurbArray& msg)
 {
-  map = std::map<Key<Curb>, Curb>();
+  storage.clear(msg.data.size());
   for (const auto& item : msg.data)
   {
     if (item.id == 0)
       continue;
-    map.insert(std::make_pair(Key<Curb>(item.id), item));
+    storage.insert(Key<Curb>(item.id), item);
   }
+  storage.build();
 }
 
-void updateWhiteLine(std::map<Key<WhiteLine>, WhiteLine>& map, const WhiteLineArray& msg)
+template <class S>
+void updateWhiteLine(S& storage, const WhiteLineArray& msg)
 {
-  map = std::map<Key<WhiteLine>, WhiteLine>();
+  storage.clear(msg.data.size());
   for (const auto& item : msg.data)
   {
     if (item.id == 0)
       continue;
-    map.insert(std::make_pair(Key<WhiteLine>(item.id), item));
+    storage.insert(Key<WhiteLine>(item.id), item);
   }
+  storage.build();
 }
 
-void updateStopLine(std::map<Key<StopLine>, StopLine>& map, const StopLineArray& msg)
+template <class S>
+void updateStopLine(S& storage, const StopLineArray& msg)
 {
-  map = std::map<Key<StopLine>, StopLine>();
+  storage.clear(msg.data.size());
   for (const auto& item : msg.data)
   {
     if (item.id == 0)
       continue;
-    map.insert(std::make_pair(Key<StopLine>(item.id), item));
+    storage.insert(Key<StopLine>(item.id), item);
   }
+  storage.build();
 }
 
-void updateZebraZone(std::map<Key<ZebraZone>, ZebraZone>& map, const ZebraZoneArray& msg)
+template <class S>
+void updateZebraZone(S& storage, const ZebraZoneArray& msg)
 {
-  map = std::map<Key<ZebraZone>, ZebraZone>();
+  storage.clear(msg.data.size());
   for (const auto& item : msg.data)
   {
     if (item.id == 0)
       continue;
-    map.insert(std::make_pair(Key<ZebraZone>(item.id), item));
+    storage.insert(Key<ZebraZone>(item.id), item);
   }
+  storage.build();
 }
 
-void updateCrossWalk(std::map<Key<CrossWalk>, CrossWalk>& map, const CrossWalkArray& msg)
+template <class S>
+void updateCrossWalk(S& storage, const CrossWalkArray& msg)
 {
-  map = std::map<Key<CrossWalk>, CrossWalk>();
+  storage.clear(msg.data.size());
   for (const auto& item : msg.data)
   {
     if (item.id == 0)
       continue;
-    map.insert(std::make_pair(Key<CrossWalk>(item.id), item));
+    storage.insert(Key<CrossWalk>(item.id), item);
   }
+  storage.build();
 }
 
-void updateRoadMark(std::map<Key<RoadMark>, RoadMark>& map, const RoadMarkArray& msg)
+template <class S>
+void updateRoadMark(S& storage, const RoadMarkArray& msg)
 {
-  map = std::map<Key<RoadMark>, RoadMark>();
+  storage.clear(msg.data.size());
   for (const auto& item : msg.data)
   {
     if (item.id == 0)
       continue;
-    map.insert(std::make_pair(Key<RoadMark>(item.id), item));
+    storage.insert(Key<RoadMark>(item.id), item);
   }
+  storage.build();
 }
 
-void updateRoadPole(std::map<Key<RoadPole>, RoadPole>& map, const RoadPoleArray& msg)
+template <class S>
+void updateRoadPole(S& storage, const RoadPoleArray& msg)
 {
-  map = std::map<Key<RoadPole>, RoadPole>();
+  storage.clear(msg.data.size());
   for (const auto& item : msg.data)
   {
     if (item.id == 0)
       continue;
-    map.insert(std::make_pair(Key<RoadPole>(item.id), item));
+    storage.insert(Key<RoadPole>(item.id), item);
   }
+  storage.build();
 }
 
-void updateRoadSign(std::map<Key<RoadSign>, RoadSign>& map, const RoadSignArray& msg)
+template <class S>
+void updateRoadSign(S& storage, const RoadSignArray& msg)
 {
-  map = std::map<Key<RoadSign>, RoadSign>();
+  storage.clear(msg.data.size());
   for (const auto& item : msg.data)
   {
     if (item.id == 0)
       continue;
-    map.insert(std::make_pair(Key<RoadSign>(item.id), item));
+    storage.insert(Key<RoadSign>(item.id), item);
   }
+  storage.build();
 }
 
-void updateSignal(std::map<Key<Signal>, Signal>& map, const SignalArray& msg)
+template <class S>
+void updateSignal(S& storage, const SignalArray& msg)
 {
-  map = std::map<Key<Signal>, Signal>();
+  storage.clear(msg.data.size());
   for (const auto& item : msg.data)
   {
     if (item.id == 0)
       continue;
-    map.insert(std::make_pair(Key<Signal>(item.id), item));
+    storage.insert(Key<Signal>(item.id), item);
   }
+  storage.build();
 }
 
-void updateStreetLight(std::map<Key<StreetLight>, StreetLight>& map, const StreetLightArray& msg)
+template <class S>
+void updateStreetLight(S& storage, const StreetLightArray& msg)
 {
-  map = std::map<Key<StreetLight>, StreetLight>();
+  storage.clear(msg.data.size());
   for (const auto& item : msg.data)
   {
     if (item.id == 0)
       continue;
-    map.insert(std::make_pair(Key<StreetLight>(item.id), item));
+    storage.insert(Key<StreetLight>(item.id), item);
   }
+  storage.build();
 }
 
-void updateUtilityPole(std::map<Key<UtilityPole>, UtilityPole>& map, const UtilityPoleArray& msg)
+template <class S>
+void updateUtilityPole(S& storage, const UtilityPoleArray& msg)
 {
-  map = std::map<Key<UtilityPole>, UtilityPole>();
+  storage.clear(msg.data.size());
   for (const auto& item : msg.data)
   {
     if (item.id == 0)
       continue;
-    map.insert(std::make_pair(Key<UtilityPole>(item.id), item));
+    storage.insert(Key<UtilityPole>(item.id), item);
   }
+  storage.build();
 }
 
-void updateGuardRail(std::map<Key<GuardRail>, GuardRail>& map, const GuardRailArray& msg)
+template <class S>
+void updateGuardRail(S& storage, const GuardRailArray& msg)
 {
-  map = std::map<Key<GuardRail>, GuardRail>();
+  storage.clear(msg.data.size());
   for (const auto& item : msg.data)
   {
     if (item.id == 0)
       continue;
-    map.insert(std::make_pair(Key<GuardRail>(item.id), item));
+    storage.insert(Key<GuardRail>(item.id), item);
   }
+  storage.build();
 }
 
-void updateSideWalk(std::map<Key<SideWalk>, SideWalk>& map, const SideWalkArray& msg)
+template <class S>
+void updateSideWalk(S& storage, const SideWalkArray& msg)
 {
-  map = std::map<Key<SideWalk>, SideWalk>();
+  storage.clear(msg.data.size());
   for (const auto& item : msg.data)
   {
     if (item.id == 0)
       continue;
-    map.insert(std::make_pair(Key<SideWalk>(item.id), item));
+    storage.insert(Key<SideWalk>(item.id), item);
   }
+  storage.build();
 }
 
-void updateDriveOnPortion(std::map<Key<DriveOnPortion>, DriveOnPortion>& map, const DriveOnPortionArray& msg)
+template <class S>
+void updateDriveOnPortion(S& storage, const DriveOnPortionArray& msg)
 {
-  map = std::map<Key<DriveOnPortion>, DriveOnPortion>();
+  storage.clear(msg.data.size());
   for (const auto& item : msg.data)
   {
     if (item.id == 0)
       continue;
-    map.insert(std::make_pair(Key<DriveOnPortion>(item.id), item));
+    storage.insert(Key<DriveOnPortion>(item.id), item);
   }
+  storage.build();
 }
 
-void updateCrossRoad(std::map<Key<CrossRoad>, CrossRoad>& map, const CrossRoadArray& msg)
+template <class S>
+void updateCrossRoad(S& storage, const CrossRoadArray& msg)
 {
-  map = std::map<Key<CrossRoad>, CrossRoad>();
+  storage.clear(msg.data.size());
   for (const auto& item : msg.data)
   {
     if (item.id == 0)
       continue;
-    map.insert(std::make_pair(Key<CrossRoad>(item.id), item));
+    storage.insert(Key<CrossRoad>(item.id), item);
   }
+  storage.build();
 }
 
-void updateSideStrip(std::map<Key<SideStrip>, SideStrip>& map, const SideStripArray& msg)
+template <class S>
+void updateSideStrip(S& storage, const SideStripArray& msg)
 {
-  map = std::map<Key<SideStrip>, SideStrip>();
+  storage.clear(msg.data.size());
   for (const auto& item : msg.data)
   {
     if (item.id == 0)
       continue;
-    map.insert(std::make_pair(Key<SideStrip>(item.id), item));
+    storage.insert(Key<SideStrip>(item.id), item);
   }
+  storage.build();
 }
 
-void updateCurveMirror(std::map<Key<CurveMirror>, CurveMirror>& map, const CurveMirrorArray& msg)
+template <class S>
+void updateCurveMirror(S& storage, const CurveMirrorArray& msg)
 {
-  map = std::map<Key<CurveMirror>, CurveMirror>();
+  storage.clear(msg.data.size());
   for (const auto& item : msg.data)
   {
     if (item.id == 0)
       continue;
-    map.insert(std::make_pair(Key<CurveMirror>(item.id), item));
+    storage.insert(Key<CurveMirror>(item.id), item);
   }
+  storage.build();
 }
 
-void updateWall(std::map<Key<Wall>, Wall>& map, const WallArray& msg)
+template <class S>
+void updateWall(S& storage, const WallArray& msg)
 {
-  map = std::map<Key<Wall>, Wall>();
+  storage.clear(msg.data.size());
   for (const auto& item : msg.data)
   {
     if (item.id == 0)
       continue;
-    map.insert(std::make_pair(Key<Wall>(item.id), item));
+    storage.insert(Key<Wall>(item.id), item);
   }
+  storage.build();
 }
 
-void updateFence(std::map<Key<Fence>, Fence>& map, const FenceArray& msg)
+template <class S>
+void updateFence(S& storage, const FenceArray& msg)
 {
-  map = std::map<Key<Fence>, Fence>();
+  storage.clear(msg.data.size());
   for (const auto& item : msg.data)
   {
     if (item.id == 0)
       continue;
-    map.insert(std::make_pair(Key<Fence>(item.id), item));
+    storage.insert(Key<Fence>(item.id), item);
   }
+  storage.build();
 }
 
-void updateRailCrossing(std::map<Key<RailCrossing>, RailCrossing>& map, const RailCrossingArray& msg)
+template <class S>
+void updateRailCrossing(S& storage, const RailCrossingArray& msg)
 {
-  map = std::map<Key<RailCrossing>, RailCrossing>();
+  storage.clear(msg.data.size());
   for (const auto& item : msg.data)
   {
     if (item.id == 0)
       continue;
-    map.insert(std::make_pair(Key<RailCrossing>(item.id), item));
+    storage.insert(Key<RailCrossing>(item.id), item);
   }
+  storage.build();
 }
 }  // namespace
 
@@ -543,172 +611,543 @@ bool VectorMap::hasSubscribed(category_t category) const
   return true;
 }
 
-void VectorMap::registerSubscriber(ros::NodeHandle& nh, category_t category)
+void VectorMap::registerSubscriber(ros::NodeHandle& nh, category_t category, bool async)
 {
   if (category & POINT)
   {
-    point_.registerSubscriber(nh, "/vector_map_info/point");
-    point_.registerUpdater(updatePoint);
+    point_.registerSubscriber(nh, "/vector_map_info/point", getAsyncNotifier(async, POINT));
+    point_.registerUpdater(updatePoint<FlatStorage<Point>>);
   }
   if (category & VECTOR)
   {
-    vector_.registerSubscriber(nh, "/vector_map_info/vector");
-    vector_.registerUpdater(updateVector);
+    vector_.registerSubscriber(nh, "/vector_map_info/vector", getAsyncNotifier(async, VECTOR));
+    vector_.registerUpdater(updateVector<FlatStorage<Vector>>);
   }
   if (category & LINE)
   {
-    line_.registerSubscriber(nh, "/vector_map_info/line");
-    line_.registerUpdater(updateLine);
+    line_.registerSubscriber(nh, "/vector_map_info/line", getAsyncNotifier(async, LINE));
+    line_.registerUpdater(updateLine<FlatStorage<Line>>);
   }
   if (category & AREA)
   {
-    area_.registerSubscriber(nh, "/vector_map_info/area");
-    area_.registerUpdater(updateArea);
+    area_.registerSubscriber(nh, "/vector_map_info/area", getAsyncNotifier(async, AREA));
+    area_.registerUpdater(updateArea<FlatStorage<Area>>);
   }
   if (category & POLE)
   {
-    pole_.registerSubscriber(nh, "/vector_map_info/pole");
-    pole_.registerUpdater(updatePole);
+    pole_.registerSubscriber(nh, "/vector_map_info/pole", getAsyncNotifier(async, POLE));
+    pole_.registerUpdater(updatePole<FlatStorage<Pole>>);
   }
   if (category & BOX)
   {
-    box_.registerSubscriber(nh, "/vector_map_info/box");
-    box_.registerUpdater(updateBox);
+    box_.registerSubscriber(nh, "/vector_map_info/box", getAsyncNotifier(async, BOX));
+    box_.registerUpdater(updateBox<FlatStorage<Box>>);
   }
   if (category & DTLANE)
   {
-    dtlane_.registerSubscriber(nh, "/vector_map_info/dtlane");
-    dtlane_.registerUpdater(updateDTLane);
+    dtlane_.registerSubscriber(nh, "/vector_map_info/dtlane", getAsyncNotifier(async, DTLANE));
+    dtlane_.registerUpdater(updateDTLane<FlatStorage<DTLane>>);
   }
   if (category & NODE)
   {
-    node_.registerSubscriber(nh, "/vector_map_info/node");
-    node_.registerUpdater(updateNode);
+    node_.registerSubscriber(nh, "/vector_map_info/node", getAsyncNotifier(async, NODE));
+    node_.registerUpdater(updateNode<FlatStorage<Node>>);
   }
   if (category & LANE)
   {
-    lane_.registerSubscriber(nh, "/vector_map_info/lane");
-    lane_.registerUpdater(updateLane);
+    lane_.registerSubscriber(nh, "/vector_map_info/lane", getAsyncNotifier(async, LANE));
+    lane_.registerUpdater(updateLane<FlatStorage<Lane>>);
   }
   if (category & WAY_AREA)
   {
-    way_area_.registerSubscriber(nh, "/vector_map_info/way_area");
-    way_area_.registerUpdater(updateWayArea);
+    way_area_.registerSubscriber(nh, "/vector_map_info/way_area", getAsyncNotifier(async, WAY_AREA));
+    way_area_.registerUpdater(updateWayArea<FlatStorage<WayArea>>);
   }
   if (category & ROAD_EDGE)
   {
-    road_edge_.registerSubscriber(nh, "/vector_map_info/road_edge");
-    road_edge_.registerUpdater(updateRoadEdge);
+    road_edge_.registerSubscriber(nh, "/vector_map_info/road_edge", getAsyncNotifier(async, ROAD_EDGE));
+    road_edge_.registerUpdater(updateRoadEdge<FlatStorage<RoadEdge>>);
   }
   if (category & GUTTER)
   {
-    gutter_.registerSubscriber(nh, "/vector_map_info/gutter");
-    gutter_.registerUpdater(updateGutter);
+    gutter_.registerSubscriber(nh, "/vector_map_info/gutter", getAsyncNotifier(async, GUTTER));
+    gutter_.registerUpdater(updateGutter<FlatStorage<Gutter>>);
   }
   if (category & CURB)
   {
-    curb_.registerSubscriber(nh, "/vector_map_info/curb");
-    curb_.registerUpdater(updateCurb);
+    curb_.registerSubscriber(nh, "/vector_map_info/curb", getAsyncNotifier(async, CURB));
+    curb_.registerUpdater(updateCurb<FlatStorage<Curb>>);
   }
   if (category & WHITE_LINE)
   {
-    white_line_.registerSubscriber(nh, "/vector_map_info/white_line");
-    white_line_.registerUpdater(updateWhiteLine);
+    white_line_.registerSubscriber(nh, "/vector_map_info/white_line", getAsyncNotifier(async, WHITE_LINE));
+    white_line_.registerUpdater(updateWhiteLine<FlatStorage<WhiteLine>>);
   }
   if (category & STOP_LINE)
   {
-    stop_line_.registerSubscriber(nh, "/vector_map_info/stop_line");
-    stop_line_.registerUpdater(updateStopLine);
+    stop_line_.registerSubscriber(nh, "/vector_map_info/stop_line", getAsyncNotifier(async, STOP_LINE));
+    stop_line_.registerUpdater(updateStopLine<FlatStorage<StopLine>>);
   }
   if (category & ZEBRA_ZONE)
   {
-    zebra_zone_.registerSubscriber(nh, "/vector_map_info/zebra_zone");
-    zebra_zone_.registerUpdater(updateZebraZone);
+    zebra_zone_.registerSubscriber(nh, "/vector_map_info/zebra_zone", getAsyncNotifier(async, ZEBRA_ZONE));
+    zebra_zone_.registerUpdater(updateZebraZone<FlatStorage<ZebraZone>>);
   }
   if (category & CROSS_WALK)
   {
-    cross_walk_.registerSubscriber(nh, "/vector_map_info/cross_walk");
-    cross_walk_.registerUpdater(updateCrossWalk);
+    cross_walk_.registerSubscriber(nh, "/vector_map_info/cross_walk", getAsyncNotifier(async, CROSS_WALK));
+    cross_walk_.registerUpdater(updateCrossWalk<FlatStorage<CrossWalk>>);
   }
   if (category & ROAD_MARK)
   {
-    road_mark_.registerSubscriber(nh, "/vector_map_info/road_mark");
-    road_mark_.registerUpdater(updateRoadMark);
+    road_mark_.registerSubscriber(nh, "/vector_map_info/road_mark", getAsyncNotifier(async, ROAD_MARK));
+    road_mark_.registerUpdater(updateRoadMark<FlatStorage<RoadMark>>);
   }
   if (category & ROAD_POLE)
   {
-    road_pole_.registerSubscriber(nh, "/vector_map_info/road_pole");
-    road_pole_.registerUpdater(updateRoadPole);
+    road_pole_.registerSubscriber(nh, "/vector_map_info/road_pole", getAsyncNotifier(async, ROAD_POLE));
+    road_pole_.registerUpdater(updateRoadPole<FlatStorage<RoadPole>>);
   }
   if (category & ROAD_SIGN)
   {
-    road_sign_.registerSubscriber(nh, "/vector_map_info/road_sign");
-    road_sign_.registerUpdater(updateRoadSign);
+    road_sign_.registerSubscriber(nh, "/vector_map_info/road_sign", getAsyncNotifier(async, ROAD_SIGN));
+    road_sign_.registerUpdater(updateRoadSign<FlatStorage<RoadSign>>);
   }
   if (category & SIGNAL)
   {
-    signal_.registerSubscriber(nh, "/vector_map_info/signal");
-    signal_.registerUpdater(updateSignal);
+    signal_.registerSubscriber(nh, "/vector_map_info/signal", getAsyncNotifier(async, SIGNAL));
+    signal_.registerUpdater(updateSignal<FlatStorage<Signal>>);
   }
   if (category & STREET_LIGHT)
   {
-    street_light_.registerSubscriber(nh, "/vector_map_info/street_light");
-    street_light_.registerUpdater(updateStreetLight);
+    street_light_.registerSubscriber(nh, "/vector_map_info/street_light", getAsyncNotifier(async, STREET_LIGHT));
+    street_light_.registerUpdater(updateStreetLight<FlatStorage<StreetLight>>);
   }
   if (category & UTILITY_POLE)
   {
-    utility_pole_.registerSubscriber(nh, "/vector_map_info/utility_pole");
-    utility_pole_.registerUpdater(updateUtilityPole);
+    utility_pole_.registerSubscriber(nh, "/vector_map_info/utility_pole", getAsyncNotifier(async, UTILITY_POLE));
+    utility_pole_.registerUpdater(updateUtilityPole<FlatStorage<UtilityPole>>);
   }
   if (category & GUARD_RAIL)
   {
-    guard_rail_.registerSubscriber(nh, "/vector_map_info/guard_rail");
-    guard_rail_.registerUpdater(updateGuardRail);
+    guard_rail_.registerSubscriber(nh, "/vector_map_info/guard_rail", getAsyncNotifier(async, GUARD_RAIL));
+    guard_rail_.registerUpdater(updateGuardRail<FlatStorage<GuardRail>>);
   }
   if (category & SIDE_WALK)
   {
-    side_walk_.registerSubscriber(nh, "/vector_map_info/side_walk");
-    side_walk_.registerUpdater(updateSideWalk);
+    side_walk_.registerSubscriber(nh, "/vector_map_info/side_walk", getAsyncNotifier(async, SIDE_WALK));
+    side_walk_.registerUpdater(updateSideWalk<FlatStorage<SideWalk>>);
   }
   if (category & DRIVE_ON_PORTION)
   {
-    drive_on_portion_.registerSubscriber(nh, "/vector_map_info/drive_on_portion");
-    drive_on_portion_.registerUpdater(updateDriveOnPortion);
+    drive_on_portion_.registerSubscriber(nh, "/vector_map_info/drive_on_portion",
+                                         getAsyncNotifier(async, DRIVE_ON_PORTION));
+    drive_on_portion_.registerUpdater(updateDriveOnPortion<FlatStorage<DriveOnPortion>>);
   }
   if (category & CROSS_ROAD)
   {
-    cross_road_.registerSubscriber(nh, "/vector_map_info/cross_road");
-    cross_road_.registerUpdater(updateCrossRoad);
+    cross_road_.registerSubscriber(nh, "/vector_map_info/cross_road", getAsyncNotifier(async, CROSS_ROAD));
+    cross_road_.registerUpdater(updateCrossRoad<FlatStorage<CrossRoad>>);
   }
   if (category & SIDE_STRIP)
   {
-    side_strip_.registerSubscriber(nh, "/vector_map_info/side_strip");
-    side_strip_.registerUpdater(updateSideStrip);
+    side_strip_.registerSubscriber(nh, "/vector_map_info/side_strip", getAsyncNotifier(async, SIDE_STRIP));
+    side_strip_.registerUpdater(updateSideStrip<FlatStorage<SideStrip>>);
   }
   if (category & CURVE_MIRROR)
   {
-    curve_mirror_.registerSubscriber(nh, "/vector_map_info/curve_mirror");
-    curve_mirror_.registerUpdater(updateCurveMirror);
+    curve_mirror_.registerSubscriber(nh, "/vector_map_info/curve_mirror", getAsyncNotifier(async, CURVE_MIRROR));
+    curve_mirror_.registerUpdater(updateCurveMirror<FlatStorage<CurveMirror>>);
   }
   if (category & WALL)
   {
-    wall_.registerSubscriber(nh, "/vector_map_info/wall");
-    wall_.registerUpdater(updateWall);
+    wall_.registerSubscriber(nh, "/vector_map_info/wall", getAsyncNotifier(async, WALL));
+    wall_.registerUpdater(updateWall<FlatStorage<Wall>>);
   }
   if (category & FENCE)
   {
-    fence_.registerSubscriber(nh, "/vector_map_info/fence");
-    fence_.registerUpdater(updateFence);
+    fence_.registerSubscriber(nh, "/vector_map_info/fence", getAsyncNotifier(async, FENCE));
+    fence_.registerUpdater(updateFence<FlatStorage<Fence>>);
   }
   if (category & RAIL_CROSSING)
   {
-    rail_crossing_.registerSubscriber(nh, "/vector_map_info/rail_crossing");
-    rail_crossing_.registerUpdater(updateRailCrossing);
+    rail_crossing_.registerSubscriber(nh, "/vector_map_info/rail_crossing", getAsyncNotifier(async, RAIL_CROSSING));
+    rail_crossing_.registerUpdater(updateRailCrossing<FlatStorage<RailCrossing>>);
   }
 }
 
+void VectorMap::registerTileSubscriber(category_t category, const std::string& topic)
+{
+  if (category == POINT)
+  {
+    point_.registerTileSubscriber(*tile_nh_, topic);
+    point_.registerUpdater(updatePoint<FlatStorage<Point>>);
+  }
+  else if (category == VECTOR)
+  {
+    vector_.registerTileSubscriber(*tile_nh_, topic);
+    vector_.registerUpdater(updateVector<FlatStorage<Vector>>);
+  }
+  else if (category == LINE)
+  {
+    line_.registerTileSubscriber(*tile_nh_, topic);
+    line_.registerUpdater(updateLine<FlatStorage<Line>>);
+  }
+  else if (category == AREA)
+  {
+    area_.registerTileSubscriber(*tile_nh_, topic);
+    area_.registerUpdater(updateArea<FlatStorage<Area>>);
+  }
+  else if (category == POLE)
+  {
+    pole_.registerTileSubscriber(*tile_nh_, topic);
+    pole_.registerUpdater(updatePole<FlatStorage<Pole>>);
+  }
+  else if (category == BOX)
+  {
+    box_.registerTileSubscriber(*tile_nh_, topic);
+    box_.registerUpdater(updateBox<FlatStorage<Box>>);
+  }
+  else if (category == DTLANE)
+  {
+    dtlane_.registerTileSubscriber(*tile_nh_, topic);
+    dtlane_.registerUpdater(updateDTLane<FlatStorage<DTLane>>);
+  }
+  else if (category == NODE)
+  {
+    node_.registerTileSubscriber(*tile_nh_, topic);
+    node_.registerUpdater(updateNode<FlatStorage<Node>>);
+  }
+  else if (category == LANE)
+  {
+    lane_.registerTileSubscriber(*tile_nh_, topic);
+    lane_.registerUpdater(updateLane<FlatStorage<Lane>>);
+  }
+  else if (category == WAY_AREA)
+  {
+    way_area_.registerTileSubscriber(*tile_nh_, topic);
+    way_area_.registerUpdater(updateWayArea<FlatStorage<WayArea>>);
+  }
+  else if (category == ROAD_EDGE)
+  {
+    road_edge_.registerTileSubscriber(*tile_nh_, topic);
+    road_edge_.registerUpdater(updateRoadEdge<FlatStorage<RoadEdge>>);
+  }
+  else if (category == GUTTER)
+  {
+    gutter_.registerTileSubscriber(*tile_nh_, topic);
+    gutter_.registerUpdater(updateGutter<FlatStorage<Gutter>>);
+  }
+  else if (category == CURB)
+  {
+    curb_.registerTileSubscriber(*tile_nh_, topic);
+    curb_.registerUpdater(updateCurb<FlatStorage<Curb>>);
+  }
+  else if (category == WHITE_LINE)
+  {
+    white_line_.registerTileSubscriber(*tile_nh_, topic);
+    white_line_.registerUpdater(updateWhiteLine<FlatStorage<WhiteLine>>);
+  }
+  else if (category == STOP_LINE)
+  {
+    stop_line_.registerTileSubscriber(*tile_nh_, topic);
+    stop_line_.registerUpdater(updateStopLine<FlatStorage<StopLine>>);
+  }
+  else if (category == ZEBRA_ZONE)
+  {
+    zebra_zone_.registerTileSubscriber(*tile_nh_, topic);
+    zebra_zone_.registerUpdater(updateZebraZone<FlatStorage<ZebraZone>>);
+  }
+  else if (category == CROSS_WALK)
+  {
+    cross_walk_.registerTileSubscriber(*tile_nh_, topic);
+    cross_walk_.registerUpdater(updateCrossWalk<FlatStorage<CrossWalk>>);
+  }
+  else if (category == ROAD_MARK)
+  {
+    road_mark_.registerTileSubscriber(*tile_nh_, topic);
+    road_mark_.registerUpdater(updateRoadMark<FlatStorage<RoadMark>>);
+  }
+  else if (category == ROAD_POLE)
+  {
+    road_pole_.registerTileSubscriber(*tile_nh_, topic);
+    road_pole_.registerUpdater(updateRoadPole<FlatStorage<RoadPole>>);
+  }
+  else if (category == ROAD_SIGN)
+  {
+    road_sign_.registerTileSubscriber(*tile_nh_, topic);
+    road_sign_.registerUpdater(updateRoadSign<FlatStorage<RoadSign>>);
+  }
+  else if (category == SIGNAL)
+  {
+    signal_.registerTileSubscriber(*tile_nh_, topic);
+    signal_.registerUpdater(updateSignal<FlatStorage<Signal>>);
+  }
+  else if (category == STREET_LIGHT)
+  {
+    street_light_.registerTileSubscriber(*tile_nh_, topic);
+    street_light_.registerUpdater(updateStreetLight<FlatStorage<StreetLight>>);
+  }
+  else if (category == UTILITY_POLE)
+  {
+    utility_pole_.registerTileSubscriber(*tile_nh_, topic);
+    utility_pole_.registerUpdater(updateUtilityPole<FlatStorage<UtilityPole>>);
+  }
+  else if (category == GUARD_RAIL)
+  {
+    guard_rail_.registerTileSubscriber(*tile_nh_, topic);
+    guard_rail_.registerUpdater(updateGuardRail<FlatStorage<GuardRail>>);
+  }
+  else if (category == SIDE_WALK)
+  {
+    side_walk_.registerTileSubscriber(*tile_nh_, topic);
+    side_walk_.registerUpdater(updateSideWalk<FlatStorage<SideWalk>>);
+  }
+  else if (category == DRIVE_ON_PORTION)
+  {
+    drive_on_portion_.registerTileSubscriber(*tile_nh_, topic);
+    drive_on_portion_.registerUpdater(updateDriveOnPortion<FlatStorage<DriveOnPortion>>);
+  }
+  else if (category == CROSS_ROAD)
+  {
+    cross_road_.registerTileSubscriber(*tile_nh_, topic);
+    cross_road_.registerUpdater(updateCrossRoad<FlatStorage<CrossRoad>>);
+  }
+  else if (category == SIDE_STRIP)
+  {
+    side_strip_.registerTileSubscriber(*tile_nh_, topic);
+    side_strip_.registerUpdater(updateSideStrip<FlatStorage<SideStrip>>);
+  }
+  else if (category == CURVE_MIRROR)
+  {
+    curve_mirror_.registerTileSubscriber(*tile_nh_, topic);
+    curve_mirror_.registerUpdater(updateCurveMirror<FlatStorage<CurveMirror>>);
+  }
+  else if (category == WALL)
+  {
+    wall_.registerTileSubscriber(*tile_nh_, topic);
+    wall_.registerUpdater(updateWall<FlatStorage<Wall>>);
+  }
+  else if (category == FENCE)
+  {
+    fence_.registerTileSubscriber(*tile_nh_, topic);
+    fence_.registerUpdater(updateFence<FlatStorage<Fence>>);
+  }
+  else if (category == RAIL_CROSSING)
+  {
+    rail_crossing_.registerTileSubscriber(*tile_nh_, topic);
+    rail_crossing_.registerUpdater(updateRailCrossing<FlatStorage<RailCrossing>>);
+  }
+}
+
+bool VectorMap::hasTile(category_t category, const std::string& topic) const
+{
+  if (category == POINT)
+    return point_.hasTile(topic);
+  else if (category == VECTOR)
+    return vector_.hasTile(topic);
+  else if (category == LINE)
+    return line_.hasTile(topic);
+  else if (category == AREA)
+    return area_.hasTile(topic);
+  else if (category == POLE)
+    return pole_.hasTile(topic);
+  else if (category == BOX)
+    return box_.hasTile(topic);
+  else if (category == DTLANE)
+    return dtlane_.hasTile(topic);
+  else if (category == NODE)
+    return node_.hasTile(topic);
+  else if (category == LANE)
+    return lane_.hasTile(topic);
+  else if (category == WAY_AREA)
+    return way_area_.hasTile(topic);
+  else if (category == ROAD_EDGE)
+    return road_edge_.hasTile(topic);
+  else if (category == GUTTER)
+    return gutter_.hasTile(topic);
+  else if (category == CURB)
+    return curb_.hasTile(topic);
+  else if (category == WHITE_LINE)
+    return white_line_.hasTile(topic);
+  else if (category == STOP_LINE)
+    return stop_line_.hasTile(topic);
+  else if (category == ZEBRA_ZONE)
+    return zebra_zone_.hasTile(topic);
+  else if (category == CROSS_WALK)
+    return cross_walk_.hasTile(topic);
+  else if (category == ROAD_MARK)
+    return road_mark_.hasTile(topic);
+  else if (category == ROAD_POLE)
+    return road_pole_.hasTile(topic);
+  else if (category == ROAD_SIGN)
+    return road_sign_.hasTile(topic);
+  else if (category == SIGNAL)
+    return signal_.hasTile(topic);
+  else if (category == STREET_LIGHT)
+    return street_light_.hasTile(topic);
+  else if (category == UTILITY_POLE)
+    return utility_pole_.hasTile(topic);
+  else if (category == GUARD_RAIL)
+    return guard_rail_.hasTile(topic);
+  else if (category == SIDE_WALK)
+    return side_walk_.hasTile(topic);
+  else if (category == DRIVE_ON_PORTION)
+    return drive_on_portion_.hasTile(topic);
+  else if (category == CROSS_ROAD)
+    return cross_road_.hasTile(topic);
+  else if (category == SIDE_STRIP)
+    return side_strip_.hasTile(topic);
+  else if (category == CURVE_MIRROR)
+    return curve_mirror_.hasTile(topic);
+  else if (category == WALL)
+    return wall_.hasTile(topic);
+  else if (category == FENCE)
+    return fence_.hasTile(topic);
+  else if (category == RAIL_CROSSING)
+    return rail_crossing_.hasTile(topic);
+  return false;
+}
+
+GridIndex::GridIndex(double cell_size)
+{
+  clear(cell_size);
+}
+
+void GridIndex::clear(double cell_size)
+{
+  cell_size_ = cell_size;
+  cells_.clear();
+  min_x_ = DBL_MAX;
+  min_y_ = DBL_MAX;
+  max_x_ = -DBL_MAX;
+  max_y_ = -DBL_MAX;
+}
+
+int GridIndex::getCell(double v) const
+{
+  return static_cast<int>(std::floor(v / cell_size_));
+}
+
+int64_t GridIndex::getCellKey(int ix, int iy)
+{
+  return (static_cast<int64_t>(ix) << 32) | static_cast<uint32_t>(iy);
+}
+
+void GridIndex::insert(int id, double min_x, double min_y, double max_x, double max_y)
+{
+  min_x_ = std::min(min_x_, min_x);
+  min_y_ = std::min(min_y_, min_y);
+  max_x_ = std::max(max_x_, max_x);
+  max_y_ = std::max(max_y_, max_y);
+  for (int ix = getCell(min_x); ix <= getCell(max_x); ++ix)
+  {
+    for (int iy = getCell(min_y); iy <= getCell(max_y); ++iy)
+      cells_.emplace_back(getCellKey(ix, iy), id);
+  }
+}
+
+void GridIndex::build()
+{
+  std::sort(cells_.begin(), cells_.end());
+}
+
+void GridIndex::findInBox(double min_x, double min_y, double max_x, double max_y, std::vector<int>& ids) const
+{
+  ids.clear();
+  // nothing lies outside the bounds, so large queries do not walk empty cells
+  min_x = std::max(min_x, min_x_);
+  min_y = std::max(min_y, min_y_);
+  max_x = std::min(max_x, max_x_);
+  max_y = std::min(max_y, max_y_);
+  if (cells_.empty() || min_x > max_x || min_y > max_y)
+    return;
+
+  for (int ix = getCell(min_x); ix <= getCell(max_x); ++ix)
+  {
+    for (int iy = getCell(min_y); iy <= getCell(max_y); ++iy)
+    {
+      int64_t key = getCellKey(ix, iy);
+      auto it = std::lower_bound(cells_.begin(), cells_.end(), std::make_pair(key, INT_MIN));
+      for (; it != cells_.end() && it->first == key; ++it)
+        ids.push_back(it->second);
+    }
+  }
+  std::sort(ids.begin(), ids.end());
+  ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+}
+
+bool GridIndex::empty() const
+{
+  return cells_.empty();
+}
+
+double GridIndex::getMaxDistance(double x, double y) const
+{
+  if (cells_.empty())
+    return 0;
+  return std::hypot(std::max(std::fabs(x - min_x_), std::fabs(x - max_x_)),
+                    std::max(std::fabs(y - min_y_), std::fabs(y - max_y_)));
+}
+
+double GridIndex::getCellSize() const
+{
+  return cell_size_;
+}
+
 VectorMap::VectorMap()
 {
+  node_pid_index_ = node_.addIndex([](const Node& node) { return node.pid; });
+  lane_bnid_index_ = lane_.addIndex([](const Lane& lane) { return lane.bnid; });
+  lane_fnid_index_ = lane_.addIndex([](const Lane& lane) { return lane.fnid; });
+  road_edge_.addIndex([](const RoadEdge& item) { return item.linkid; });
+  gutter_.addIndex([](const Gutter& item) { return item.linkid; });
+  curb_.addIndex([](const Curb& item) { return item.linkid; });
+  white_line_.addIndex([](const WhiteLine& item) { return item.linkid; });
+  stop_line_.addIndex([](const StopLine& item) { return item.linkid; });
+  zebra_zone_.addIndex([](const ZebraZone& item) { return item.linkid; });
+  cross_walk_.addIndex([](const CrossWalk& item) { return item.linkid; });
+  road_mark_.addIndex([](const RoadMark& item) { return item.linkid; });
+  road_pole_.addIndex([](const RoadPole& item) { return item.linkid; });
+  road_sign_.addIndex([](const RoadSign& item) { return item.linkid; });
+  signal_.addIndex([](const Signal& item) { return item.linkid; });
+  street_light_.addIndex([](const StreetLight& item) { return item.linkid; });
+  utility_pole_.addIndex([](const UtilityPole& item) { return item.linkid; });
+  guard_rail_.addIndex([](const GuardRail& item) { return item.linkid; });
+  side_walk_.addIndex([](const SideWalk& item) { return item.linkid; });
+  drive_on_portion_.addIndex([](const DriveOnPortion& item) { return item.linkid; });
+  cross_road_.addIndex([](const CrossRoad& item) { return item.linkid; });
+  side_strip_.addIndex([](const SideStrip& item) { return item.linkid; });
+  curve_mirror_.addIndex([](const CurveMirror& item) { return item.linkid; });
+  wall_.addIndex([](const Wall& item) { return item.linkid; });
+  fence_.addIndex([](const Fence& item) { return item.linkid; });
+  rail_crossing_.addIndex([](const RailCrossing& item) { return item.linkid; });
+
+  point_.setUpdateMutex(&spatial_mutex_);
+  node_.setUpdateMutex(&spatial_mutex_);
+  lane_.setUpdateMutex(&spatial_mutex_);
+  async_received_ = NONE;
+
+  has_tile_index_ = false;
+  tile_category_ = NONE;
+
+  spatial_cell_size_ = 0;
+  loading_snapshot_ = false;
+  point_.registerCallback([this](const PointArray& msg) {
+    if (hasSpatialIndex() && !loading_snapshot_)
+    {
+      buildPointGrid();
+      buildLaneGrid();
+    }
+  });
+  node_.registerCallback([this](const NodeArray& msg) {
+    if (hasSpatialIndex() && !loading_snapshot_)
+      buildLaneGrid();
+  });
+  lane_.registerCallback([this](const LaneArray& msg) {
+    if (hasSpatialIndex() && !loading_snapshot_)
+      buildLaneGrid();
+  });
 }
 
 void VectorMap::subscribe(ros::NodeHandle& nh, category_t category)
@@ -746,6 +1185,169 @@ void VectorMap::subscribe(ros::NodeHandle& nh, category_t category, const size_t
   }
 }
 
+std::shared_future<void> VectorMap::subscribeAsync(ros::NodeHandle& nh, category_t category,
+                                                   const std::function<void()>& ready_cb, int nthreads)
+{
+  AsyncSubscription subscription;
+  subscription.category = category;
+  subscription.ready_cb = ready_cb;
+  std::shared_future<void> future = subscription.ready.get_future().share();
+  {
+    std::lock_guard<std::mutex> lock(async_mutex_);
+    async_subscriptions_.push_back(std::move(subscription));
+  }
+
+  ros::NodeHandle async_nh(nh);
+  async_nh.setCallbackQueue(&async_queue_);
+  registerSubscriber(async_nh, category, true);
+  if (!async_spinner_)
+  {
+    async_spinner_.reset(new ros::AsyncSpinner(nthreads, &async_queue_));
+    async_spinner_->start();
+  }
+
+  // nothing to wait for
+  onAsyncUpdate(NONE);
+  return future;
+}
+
+std::function<void()> VectorMap::getAsyncNotifier(bool async, category_t category)
+{
+  if (!async)
+    return std::function<void()>();
+  return [this, category]() { onAsyncUpdate(category); };
+}
+
+void VectorMap::onAsyncUpdate(category_t category)
+{
+  std::vector<AsyncSubscription> done;
+  {
+    std::lock_guard<std::mutex> lock(async_mutex_);
+    async_received_ |= category;
+    for (auto it = async_subscriptions_.begin(); it != async_subscriptions_.end();)
+    {
+      if ((it->category & async_received_) == it->category)
+      {
+        done.push_back(std::move(*it));
+        it = async_subscriptions_.erase(it);
+      }
+      else
+      {
+        ++it;
+      }
+    }
+  }
+
+  // outside the lock, a ready callback may subscribe again
+  for (auto& subscription : done)
+  {
+    if (subscription.ready_cb)
+      subscription.ready_cb();
+    subscription.ready.set_value();
+  }
+}
+
+void VectorMap::subscribeTiles(ros::NodeHandle& nh, category_t category, double min_x, double min_y, double max_x,
+                               double max_y)
+{
+  if (!tile_nh_)
+  {
+    tile_nh_.reset(new ros::NodeHandle(nh));
+    tile_index_sub_ = nh.subscribe(TILE_INDEX_TOPIC, 1, &VectorMap::subscribeTileIndex, this);
+  }
+  tile_category_ |= category;
+  addTileRegion(min_x, min_y, max_x, max_y);
+  ros::Rate rate(1);
+  while (ros::ok() && !hasSubscribedTiles())
+  {
+    ros::spinOnce();
+    rate.sleep();
+  }
+}
+
+void VectorMap::subscribeTiles(ros::NodeHandle& nh, category_t category, double min_x, double min_y, double max_x,
+                               double max_y, const ros::Duration& timeout)
+{
+  if (!tile_nh_)
+  {
+    tile_nh_.reset(new ros::NodeHandle(nh));
+    tile_index_sub_ = nh.subscribe(TILE_INDEX_TOPIC, 1, &VectorMap::subscribeTileIndex, this);
+  }
+  tile_category_ |= category;
+  addTileRegion(min_x, min_y, max_x, max_y);
+  ros::Rate rate(1);
+  ros::Time end = ros::Time::now() + timeout;
+  while (ros::ok() && !hasSubscribedTiles() && ros::Time::now() < end)
+  {
+    ros::spinOnce();
+    rate.sleep();
+  }
+}
+
+void VectorMap::addTileRegion(double min_x, double min_y, double max_x, double max_y)
+{
+  tile_regions_.push_back({ min_x, min_y, max_x, max_y });
+  if (has_tile_index_)
+    registerTileSubscribers();
+}
+
+bool VectorMap::hasSubscribedTiles() const
+{
+  if (!has_tile_index_)
+    return false;
+  for (const auto& tile_topic : tile_topics_)
+  {
+    if (!hasTile(tile_topic.first, tile_topic.second))
+      return false;
+  }
+  return true;
+}
+
+void VectorMap::subscribeTileIndex(const std_msgs::UInt8MultiArray& msg)
+{
+  TileIndex index;
+  if (!decodeTileIndex(msg, index))
+  {
+    ROS_ERROR_STREAM("invalid vector map tile index on " << TILE_INDEX_TOPIC);
+    return;
+  }
+  tile_index_ = index;
+  has_tile_index_ = true;
+  registerTileSubscribers();
+}
+
+bool VectorMap::isInTileRegions(const TileId& tile) const
+{
+  if (tile.x == NO_TILE)
+    return true;
+  for (const auto& region : tile_regions_)
+  {
+    TileId min_tile = getTileId(region[0], region[1], tile_index_.tile_size);
+    TileId max_tile = getTileId(region[2], region[3], tile_index_.tile_size);
+    if (tile.x >= min_tile.x && tile.x <= max_tile.x && tile.y >= min_tile.y && tile.y <= max_tile.y)
+      return true;
+  }
+  return false;
+}
+
+void VectorMap::registerTileSubscribers()
+{
+  for (const auto& entry : tile_index_.entries)
+  {
+    if (!(entry.category & tile_category_) || !isInTileRegions(entry.tile))
+      continue;
+
+    std::string topic = getTileTopic(entry.category, entry.tile);
+    bool registered = false;
+    for (const auto& tile_topic : tile_topics_)
+      registered = registered || tile_topic.second == topic;
+    if (registered)
+      continue;
+    tile_topics_.emplace_back(entry.category, topic);
+    registerTileSubscriber(entry.category, topic);
+  }
+}
+
 Point VectorMap::findByKey(const Key<Point>& key) const
 {
   return point_.findByKey(key);
@@ -1066,6 +1668,815 @@ std::vector<RailCrossing> VectorMap::findByFilter(const Filter<RailCrossing>& fi
   return rail_crossing_.findByFilter(filter);
 }
 
+const Point* VectorMap::findPtrByKey(const Key<Point>& key) const
+{
+  return point_.findPtrByKey(key);
+}
+
+const Vector* VectorMap::findPtrByKey(const Key<Vector>& key) const
+{
+  return vector_.findPtrByKey(key);
+}
+
+const Line* VectorMap::findPtrByKey(const Key<Line>& key) const
+{
+  return line_.findPtrByKey(key);
+}
+
+const Area* VectorMap::findPtrByKey(const Key<Area>& key) const
+{
+  return area_.findPtrByKey(key);
+}
+
+const Pole* VectorMap::findPtrByKey(const Key<Pole>& key) const
+{
+  return pole_.findPtrByKey(key);
+}
+
+const Box* VectorMap::findPtrByKey(const Key<Box>& key) const
+{
+  return box_.findPtrByKey(key);
+}
+
+const DTLane* VectorMap::findPtrByKey(const Key<DTLane>& key) const
+{
+  return dtlane_.findPtrByKey(key);
+}
+
+const Node* VectorMap::findPtrByKey(const Key<Node>& key) const
+{
+  return node_.findPtrByKey(key);
+}
+
+const Lane* VectorMap::findPtrByKey(const Key<Lane>& key) const
+{
+  return lane_.findPtrByKey(key);
+}
+
+const WayArea* VectorMap::findPtrByKey(const Key<WayArea>& key) const
+{
+  return way_area_.findPtrByKey(key);
+}
+
+const RoadEdge* VectorMap::findPtrByKey(const Key<RoadEdge>& key) const
+{
+  return road_edge_.findPtrByKey(key);
+}
+
+const Gutter* VectorMap::findPtrByKey(const Key<Gutter>& key) const
+{
+  return gutter_.findPtrByKey(key);
+}
+
+const Curb* VectorMap::findPtrByKey(const Key<Curb>& key) const
+{
+  return curb_.findPtrByKey(key);
+}
+
+const WhiteLine* VectorMap::findPtrByKey(const Key<WhiteLine>& key) const
+{
+  return white_line_.findPtrByKey(key);
+}
+
+const StopLine* VectorMap::findPtrByKey(const Key<StopLine>& key) const
+{
+  return stop_line_.findPtrByKey(key);
+}
+
+const ZebraZone* VectorMap::findPtrByKey(const Key<ZebraZone>& key) const
+{
+  return zebra_zone_.findPtrByKey(key);
+}
+
+const CrossWalk* VectorMap::findPtrByKey(const Key<CrossWalk>& key) const
+{
+  return cross_walk_.findPtrByKey(key);
+}
+
+const RoadMark* VectorMap::findPtrByKey(const Key<RoadMark>& key) const
+{
+  return road_mark_.findPtrByKey(key);
+}
+
+const RoadPole* VectorMap::findPtrByKey(const Key<RoadPole>& key) const
+{
+  return road_pole_.findPtrByKey(key);
+}
+
+const RoadSign* VectorMap::findPtrByKey(const Key<RoadSign>& key) const
+{
+  return road_sign_.findPtrByKey(key);
+}
+
+const Signal* VectorMap::findPtrByKey(const Key<Signal>& key) const
+{
+  return signal_.findPtrByKey(key);
+}
+
+const StreetLight* VectorMap::findPtrByKey(const Key<StreetLight>& key) const
+{
+  return street_light_.findPtrByKey(key);
+}
+
+const UtilityPole* VectorMap::findPtrByKey(const Key<UtilityPole>& key) const
+{
+  return utility_pole_.findPtrByKey(key);
+}
+
+const GuardRail* VectorMap::findPtrByKey(const Key<GuardRail>& key) const
+{
+  return guard_rail_.findPtrByKey(key);
+}
+
+const SideWalk* VectorMap::findPtrByKey(const Key<SideWalk>& key) const
+{
+  return side_walk_.findPtrByKey(key);
+}
+
+const DriveOnPortion* VectorMap::findPtrByKey(const Key<DriveOnPortion>& key) const
+{
+  return drive_on_portion_.findPtrByKey(key);
+}
+
+const CrossRoad* VectorMap::findPtrByKey(const Key<CrossRoad>& key) const
+{
+  return cross_road_.findPtrByKey(key);
+}
+
+const SideStrip* VectorMap::findPtrByKey(const Key<SideStrip>& key) const
+{
+  return side_strip_.findPtrByKey(key);
+}
+
+const CurveMirror* VectorMap::findPtrByKey(const Key<CurveMirror>& key) const
+{
+  return curve_mirror_.findPtrByKey(key);
+}
+
+const Wall* VectorMap::findPtrByKey(const Key<Wall>& key) const
+{
+  return wall_.findPtrByKey(key);
+}
+
+const Fence* VectorMap::findPtrByKey(const Key<Fence>& key) const
+{
+  return fence_.findPtrByKey(key);
+}
+
+const RailCrossing* VectorMap::findPtrByKey(const Key<RailCrossing>& key) const
+{
+  return rail_crossing_.findPtrByKey(key);
+}
+
+void VectorMap::forEach(const Filter<Point>& filter, const Callback<Point>& fn) const
+{
+  point_.forEach(filter, fn);
+}
+
+void VectorMap::forEach(const Filter<Vector>& filter, const Callback<Vector>& fn) const
+{
+  vector_.forEach(filter, fn);
+}
+
+void VectorMap::forEach(const Filter<Line>& filter, const Callback<Line>& fn) const
+{
+  line_.forEach(filter, fn);
+}
+
+void VectorMap::forEach(const Filter<Area>& filter, const Callback<Area>& fn) const
+{
+  area_.forEach(filter, fn);
+}
+
+void VectorMap::forEach(const Filter<Pole>& filter, const Callback<Pole>& fn) const
+{
+  pole_.forEach(filter, fn);
+}
+
+void VectorMap::forEach(const Filter<Box>& filter, const Callback<Box>& fn) const
+{
+  box_.forEach(filter, fn);
+}
+
+void VectorMap::forEach(const Filter<DTLane>& filter, const Callback<DTLane>& fn) const
+{
+  dtlane_.forEach(filter, fn);
+}
+
+void VectorMap::forEach(const Filter<Node>& filter, const Callback<Node>& fn) const
+{
+  node_.forEach(filter, fn);
+}
+
+void VectorMap::forEach(const Filter<Lane>& filter, const Callback<Lane>& fn) const
+{
+  lane_.forEach(filter, fn);
+}
+
+void VectorMap::forEach(const Filter<WayArea>& filter, const Callback<WayArea>& fn) const
+{
+  way_area_.forEach(filter, fn);
+}
+
+void VectorMap::forEach(const Filter<RoadEdge>& filter, const Callback<RoadEdge>& fn) const
+{
+  road_edge_.forEach(filter, fn);
+}
+
+void VectorMap::forEach(const Filter<Gutter>& filter, const Callback<Gutter>& fn) const
+{
+  gutter_.forEach(filter, fn);
+}
+
+void VectorMap::forEach(const Filter<Curb>& filter, const Callback<Curb>& fn) const
+{
+  curb_.forEach(filter, fn);
+}
+
+void VectorMap::forEach(const Filter<WhiteLine>& filter, const Callback<WhiteLine>& fn) const
+{
+  white_line_.forEach(filter, fn);
+}
+
+void VectorMap::forEach(const Filter<StopLine>& filter, const Callback<StopLine>& fn) const
+{
+  stop_line_.forEach(filter, fn);
+}
+
+void VectorMap::forEach(const Filter<ZebraZone>& filter, const Callback<ZebraZone>& fn) const
+{
+  zebra_zone_.forEach(filter, fn);
+}
+
+void VectorMap::forEach(const Filter<CrossWalk>& filter, const Callback<CrossWalk>& fn) const
+{
+  cross_walk_.forEach(filter, fn);
+}
+
+void VectorMap::forEach(const Filter<RoadMark>& filter, const Callback<RoadMark>& fn) const
+{
+  road_mark_.forEach(filter, fn);
+}
+
+void VectorMap::forEach(const Filter<RoadPole>& filter, const Callback<RoadPole>& fn) const
+{
+  road_pole_.forEach(filter, fn);
+}
+
+void VectorMap::forEach(const Filter<RoadSign>& filter, const Callback<RoadSign>& fn) const
+{
+  road_sign_.forEach(filter, fn);
+}
+
+void VectorMap::forEach(const Filter<Signal>& filter, const Callback<Signal>& fn) const
+{
+  signal_.forEach(filter, fn);
+}
+
+void VectorMap::forEach(const Filter<StreetLight>& filter, const Callback<StreetLight>& fn) const
+{
+  street_light_.forEach(filter, fn);
+}
+
+void VectorMap::forEach(const Filter<UtilityPole>& filter, const Callback<UtilityPole>& fn) const
+{
+  utility_pole_.forEach(filter, fn);
+}
+
+void VectorMap::forEach(const Filter<GuardRail>& filter, const Callback<GuardRail>& fn) const
+{
+  guard_rail_.forEach(filter, fn);
+}
+
+void VectorMap::forEach(const Filter<SideWalk>& filter, const Callback<SideWalk>& fn) const
+{
+  side_walk_.forEach(filter, fn);
+}
+
+void VectorMap::forEach(const Filter<DriveOnPortion>& filter, const Callback<DriveOnPortion>& fn) const
+{
+  drive_on_portion_.forEach(filter, fn);
+}
+
+void VectorMap::forEach(const Filter<CrossRoad>& filter, const Callback<CrossRoad>& fn) const
+{
+  cross_road_.forEach(filter, fn);
+}
+
+void VectorMap::forEach(const Filter<SideStrip>& filter, const Callback<SideStrip>& fn) const
+{
+  side_strip_.forEach(filter, fn);
+}
+
+void VectorMap::forEach(const Filter<CurveMirror>& filter, const Callback<CurveMirror>& fn) const
+{
+  curve_mirror_.forEach(filter, fn);
+}
+
+void VectorMap::forEach(const Filter<Wall>& filter, const Callback<Wall>& fn) const
+{
+  wall_.forEach(filter, fn);
+}
+
+void VectorMap::forEach(const Filter<Fence>& filter, const Callback<Fence>& fn) const
+{
+  fence_.forEach(filter, fn);
+}
+
+void VectorMap::forEach(const Filter<RailCrossing>& filter, const Callback<RailCrossing>& fn) const
+{
+  rail_crossing_.forEach(filter, fn);
+}
+
+std::vector<Node> VectorMap::findNodesAt(const Point& point) const
+{
+  std::vector<Node> nodes;
+  node_.forEachByIndex(node_pid_index_, point.pid, [&nodes](const Node& node) { nodes.push_back(node); });
+  return nodes;
+}
+
+std::vector<Lane> VectorMap::findLanesStartingAt(const Node& node) const
+{
+  std::vector<Lane> lanes;
+  lane_.forEachByIndex(lane_bnid_index_, node.nid, [&lanes](const Lane& lane) { lanes.push_back(lane); });
+  return lanes;
+}
+
+std::vector<Lane> VectorMap::findLanesEndingAt(const Node& node) const
+{
+  std::vector<Lane> lanes;
+  lane_.forEachByIndex(lane_fnid_index_, node.nid, [&lanes](const Lane& lane) { lanes.push_back(lane); });
+  return lanes;
+}
+
+void VectorMap::forEachLinkedTo(const Lane& lane, const Callback<RoadEdge>& fn) const
+{
+  road_edge_.forEachByIndex(LINK_INDEX, lane.lnid, fn);
+}
+
+void VectorMap::forEachLinkedTo(const Lane& lane, const Callback<Gutter>& fn) const
+{
+  gutter_.forEachByIndex(LINK_INDEX, lane.lnid, fn);
+}
+
+void VectorMap::forEachLinkedTo(const Lane& lane, const Callback<Curb>& fn) const
+{
+  curb_.forEachByIndex(LINK_INDEX, lane.lnid, fn);
+}
+
+void VectorMap::forEachLinkedTo(const Lane& lane, const Callback<WhiteLine>& fn) const
+{
+  white_line_.forEachByIndex(LINK_INDEX, lane.lnid, fn);
+}
+
+void VectorMap::forEachLinkedTo(const Lane& lane, const Callback<StopLine>& fn) const
+{
+  stop_line_.forEachByIndex(LINK_INDEX, lane.lnid, fn);
+}
+
+void VectorMap::forEachLinkedTo(const Lane& lane, const Callback<ZebraZone>& fn) const
+{
+  zebra_zone_.forEachByIndex(LINK_INDEX, lane.lnid, fn);
+}
+
+void VectorMap::forEachLinkedTo(const Lane& lane, const Callback<CrossWalk>& fn) const
+{
+  cross_walk_.forEachByIndex(LINK_INDEX, lane.lnid, fn);
+}
+
+void VectorMap::forEachLinkedTo(const Lane& lane, const Callback<RoadMark>& fn) const
+{
+  road_mark_.forEachByIndex(LINK_INDEX, lane.lnid, fn);
+}
+
+void VectorMap::forEachLinkedTo(const Lane& lane, const Callback<RoadPole>& fn) const
+{
+  road_pole_.forEachByIndex(LINK_INDEX, lane.lnid, fn);
+}
+
+void VectorMap::forEachLinkedTo(const Lane& lane, const Callback<RoadSign>& fn) const
+{
+  road_sign_.forEachByIndex(LINK_INDEX, lane.lnid, fn);
+}
+
+void VectorMap::forEachLinkedTo(const Lane& lane, const Callback<Signal>& fn) const
+{
+  signal_.forEachByIndex(LINK_INDEX, lane.lnid, fn);
+}
+
+void VectorMap::forEachLinkedTo(const Lane& lane, const Callback<StreetLight>& fn) const
+{
+  street_light_.forEachByIndex(LINK_INDEX, lane.lnid, fn);
+}
+
+void VectorMap::forEachLinkedTo(const Lane& lane, const Callback<UtilityPole>& fn) const
+{
+  utility_pole_.forEachByIndex(LINK_INDEX, lane.lnid, fn);
+}
+
+void VectorMap::forEachLinkedTo(const Lane& lane, const Callback<GuardRail>& fn) const
+{
+  guard_rail_.forEachByIndex(LINK_INDEX, lane.lnid, fn);
+}
+
+void VectorMap::forEachLinkedTo(const Lane& lane, const Callback<SideWalk>& fn) const
+{
+  side_walk_.forEachByIndex(LINK_INDEX, lane.lnid, fn);
+}
+
+void VectorMap::forEachLinkedTo(const Lane& lane, const Callback<DriveOnPortion>& fn) const
+{
+  drive_on_portion_.forEachByIndex(LINK_INDEX, lane.lnid, fn);
+}
+
+void VectorMap::forEachLinkedTo(const Lane& lane, const Callback<CrossRoad>& fn) const
+{
+  cross_road_.forEachByIndex(LINK_INDEX, lane.lnid, fn);
+}
+
+void VectorMap::forEachLinkedTo(const Lane& lane, const Callback<SideStrip>& fn) const
+{
+  side_strip_.forEachByIndex(LINK_INDEX, lane.lnid, fn);
+}
+
+void VectorMap::forEachLinkedTo(const Lane& lane, const Callback<CurveMirror>& fn) const
+{
+  curve_mirror_.forEachByIndex(LINK_INDEX, lane.lnid, fn);
+}
+
+void VectorMap::forEachLinkedTo(const Lane& lane, const Callback<Wall>& fn) const
+{
+  wall_.forEachByIndex(LINK_INDEX, lane.lnid, fn);
+}
+
+void VectorMap::forEachLinkedTo(const Lane& lane, const Callback<Fence>& fn) const
+{
+  fence_.forEachByIndex(LINK_INDEX, lane.lnid, fn);
+}
+
+void VectorMap::forEachLinkedTo(const Lane& lane, const Callback<RailCrossing>& fn) const
+{
+  rail_crossing_.forEachByIndex(LINK_INDEX, lane.lnid, fn);
+}
+
+void VectorMap::enableSpatialIndex(double cell_size)
+{
+  spatial_cell_size_ = cell_size > 0 ? cell_size : 10.0;
+  buildPointGrid();
+  buildLaneGrid();
+}
+
+bool VectorMap::hasSpatialIndex() const
+{
+  return spatial_cell_size_ > 0;
+}
+
+void VectorMap::buildPointGrid()
+{
+  point_grid_.clear(spatial_cell_size_);
+  point_.forEach([](const Point& point) { return true; },
+                 [this](const Point& point) { point_grid_.insert(point.pid, point.bx, point.ly, point.bx, point.ly); });
+  point_grid_.build();
+}
+
+void VectorMap::buildLaneGrid()
+{
+  lane_grid_.clear(spatial_cell_size_);
+  lane_.forEach([](const Lane& lane) { return true; }, [this](const Lane& lane) {
+    const Point* start_point;
+    const Point* end_point;
+    if (!findLaneSegment(lane, start_point, end_point))
+      return;
+    lane_grid_.insert(lane.lnid, std::min(start_point->bx, end_point->bx), std::min(start_point->ly, end_point->ly),
+                      std::max(start_point->bx, end_point->bx), std::max(start_point->ly, end_point->ly));
+  });
+  lane_grid_.build();
+}
+
+bool VectorMap::findLaneSegment(const Lane& lane, const Point*& start_point, const Point*& end_point) const
+{
+  const Node* start_node = node_.findPtrByKey(Key<Node>(lane.bnid));
+  const Node* end_node = node_.findPtrByKey(Key<Node>(lane.fnid));
+  if (start_node == nullptr || end_node == nullptr)
+    return false;
+  start_point = point_.findPtrByKey(Key<Point>(start_node->pid));
+  end_point = point_.findPtrByKey(Key<Point>(end_node->pid));
+  return start_point != nullptr && end_point != nullptr;
+}
+
+double VectorMap::computeLaneDistance(const Lane& lane, const Point& point) const
+{
+  const Point* start_point;
+  const Point* end_point;
+  if (!findLaneSegment(lane, start_point, end_point))
+    return DBL_MAX;
+
+  double dx = end_point->bx - start_point->bx;
+  double dy = end_point->ly - start_point->ly;
+  double length2 = dx * dx + dy * dy;
+  double t = 0;
+  if (length2 > 0)
+    t = std::max(0.0, std::min(1.0, ((point.bx - start_point->bx) * dx + (point.ly - start_point->ly) * dy) / length2));
+  return std::hypot(point.bx - (start_point->bx + t * dx), point.ly - (start_point->ly + t * dy));
+}
+
+std::vector<Point> VectorMap::findPointsWithinRadius(const Point& center, double radius) const
+{
+  std::vector<Point> points;
+  Filter<Point> is_near = [&center, radius](const Point& point) {
+    return std::hypot(point.bx - center.bx, point.ly - center.ly) <= radius;
+  };
+  if (!hasSpatialIndex())
+  {
+    point_.forEach(is_near, [&points](const Point& point) { points.push_back(point); });
+    return points;
+  }
+
+  std::vector<int> ids;
+  point_grid_.findInBox(center.bx - radius, center.ly - radius, center.bx + radius, center.ly + radius, ids);
+  for (int id : ids)
+  {
+    const Point* point = point_.findPtrByKey(Key<Point>(id));
+    if (point != nullptr && is_near(*point))
+      points.push_back(*point);
+  }
+  return points;
+}
+
+Point VectorMap::findNearestPoint(const Point& base_point) const
+{
+  Point nearest_point;
+  double min_distance = DBL_MAX;
+  Callback<Point> update_nearest = [&](const Point& point) {
+    double distance = std::hypot(point.bx - base_point.bx, point.ly - base_point.ly);
+    if (distance < min_distance)
+    {
+      nearest_point = point;
+      min_distance = distance;
+    }
+  };
+  if (!hasSpatialIndex())
+  {
+    point_.forEach([](const Point& point) { return true; }, update_nearest);
+    return nearest_point;
+  }
+
+  // grow the search radius until a point is inside it, the nearest one is then inside it too
+  double max_radius = point_grid_.getMaxDistance(base_point.bx, base_point.ly);
+  for (double radius = spatial_cell_size_; !point_grid_.empty(); radius *= 2)
+  {
+    for (const auto& point : findPointsWithinRadius(base_point, radius))
+      update_nearest(point);
+    if (min_distance != DBL_MAX || radius >= max_radius)
+      break;
+  }
+  return nearest_point;
+}
+
+std::vector<Lane> VectorMap::findLanesWithinRadius(const Point& center, double radius) const
+{
+  std::vector<Lane> lanes;
+  Filter<Lane> is_near = [this, &center, radius](const Lane& lane) {
+    return computeLaneDistance(lane, center) <= radius;
+  };
+  if (!hasSpatialIndex())
+  {
+    lane_.forEach(is_near, [&lanes](const Lane& lane) { lanes.push_back(lane); });
+    return lanes;
+  }
+
+  std::vector<int> ids;
+  lane_grid_.findInBox(center.bx - radius, center.ly - radius, center.bx + radius, center.ly + radius, ids);
+  for (int id : ids)
+  {
+    const Lane* lane = lane_.findPtrByKey(Key<Lane>(id));
+    if (lane != nullptr && is_near(*lane))
+      lanes.push_back(*lane);
+  }
+  return lanes;
+}
+
+Lane VectorMap::findNearestLane(const Point& base_point) const
+{
+  Lane nearest_lane;
+  double min_distance = DBL_MAX;
+  Callback<Lane> update_nearest = [&](const Lane& lane) {
+    double distance = computeLaneDistance(lane, base_point);
+    if (distance < min_distance)
+    {
+      nearest_lane = lane;
+      min_distance = distance;
+    }
+  };
+  if (!hasSpatialIndex())
+  {
+    lane_.forEach([](const Lane& lane) { return true; }, update_nearest);
+    return nearest_lane;
+  }
+
+  double max_radius = lane_grid_.getMaxDistance(base_point.bx, base_point.ly);
+  for (double radius = spatial_cell_size_; !lane_grid_.empty(); radius *= 2)
+  {
+    for (const auto& lane : findLanesWithinRadius(base_point, radius))
+      update_nearest(lane);
+    if (min_distance != DBL_MAX || radius >= max_radius)
+      break;
+  }
+  return nearest_lane;
+}
+
+void VectorMap::receive(const PointArray& msg)
+{
+  point_.registerUpdater(updatePoint<FlatStorage<Point>>);
+  point_.receive(msg);
+}
+
+void VectorMap::receive(const VectorArray& msg)
+{
+  vector_.registerUpdater(updateVector<FlatStorage<Vector>>);
+  vector_.receive(msg);
+}
+
+void VectorMap::receive(const LineArray& msg)
+{
+  line_.registerUpdater(updateLine<FlatStorage<Line>>);
+  line_.receive(msg);
+}
+
+void VectorMap::receive(const AreaArray& msg)
+{
+  area_.registerUpdater(updateArea<FlatStorage<Area>>);
+  area_.receive(msg);
+}
+
+void VectorMap::receive(const PoleArray& msg)
+{
+  pole_.registerUpdater(updatePole<FlatStorage<Pole>>);
+  pole_.receive(msg);
+}
+
+void VectorMap::receive(const BoxArray& msg)
+{
+  box_.registerUpdater(updateBox<FlatStorage<Box>>);
+  box_.receive(msg);
+}
+
+void VectorMap::receive(const DTLaneArray& msg)
+{
+  dtlane_.registerUpdater(updateDTLane<FlatStorage<DTLane>>);
+  dtlane_.receive(msg);
+}
+
+void VectorMap::receive(const NodeArray& msg)
+{
+  node_.registerUpdater(updateNode<FlatStorage<Node>>);
+  node_.receive(msg);
+}
+
+void VectorMap::receive(const LaneArray& msg)
+{
+  lane_.registerUpdater(updateLane<FlatStorage<Lane>>);
+  lane_.receive(msg);
+}
+
+void VectorMap::receive(const WayAreaArray& msg)
+{
+  way_area_.registerUpdater(updateWayArea<FlatStorage<WayArea>>);
+  way_area_.receive(msg);
+}
+
+void VectorMap::receive(const RoadEdgeArray& msg)
+{
+  road_edge_.registerUpdater(updateRoadEdge<FlatStorage<RoadEdge>>);
+  road_edge_.receive(msg);
+}
+
+void VectorMap::receive(const GutterArray& msg)
+{
+  gutter_.registerUpdater(updateGutter<FlatStorage<Gutter>>);
+  gutter_.receive(msg);
+}
+
+void VectorMap::receive(const CurbArray& msg)
+{
+  curb_.registerUpdater(updateCurb<FlatStorage<Curb>>);
+  curb_.receive(msg);
+}
+
+void VectorMap::receive(const WhiteLineArray& msg)
+{
+  white_line_.registerUpdater(updateWhiteLine<FlatStorage<WhiteLine>>);
+  white_line_.receive(msg);
+}
+
+void VectorMap::receive(const StopLineArray& msg)
+{
+  stop_line_.registerUpdater(updateStopLine<FlatStorage<StopLine>>);
+  stop_line_.receive(msg);
+}
+
+void VectorMap::receive(const ZebraZoneArray& msg)
+{
+  zebra_zone_.registerUpdater(updateZebraZone<FlatStorage<ZebraZone>>);
+  zebra_zone_.receive(msg);
+}
+
+void VectorMap::receive(const CrossWalkArray& msg)
+{
+  cross_walk_.registerUpdater(updateCrossWalk<FlatStorage<CrossWalk>>);
+  cross_walk_.receive(msg);
+}
+
+void VectorMap::receive(const RoadMarkArray& msg)
+{
+  road_mark_.registerUpdater(updateRoadMark<FlatStorage<RoadMark>>);
+  road_mark_.receive(msg);
+}
+
+void VectorMap::receive(const RoadPoleArray& msg)
+{
+  road_pole_.registerUpdater(updateRoadPole<FlatStorage<RoadPole>>);
+  road_pole_.receive(msg);
+}
+
+void VectorMap::receive(const RoadSignArray& msg)
+{
+  road_sign_.registerUpdater(updateRoadSign<FlatStorage<RoadSign>>);
+  road_sign_.receive(msg);
+}
+
+void VectorMap::receive(const SignalArray& msg)
+{
+  signal_.registerUpdater(updateSignal<FlatStorage<Signal>>);
+  signal_.receive(msg);
+}
+
+void VectorMap::receive(const StreetLightArray& msg)
+{
+  street_light_.registerUpdater(updateStreetLight<FlatStorage<StreetLight>>);
+  street_light_.receive(msg);
+}
+
+void VectorMap::receive(const UtilityPoleArray& msg)
+{
+  utility_pole_.registerUpdater(updateUtilityPole<FlatStorage<UtilityPole>>);
+  utility_pole_.receive(msg);
+}
+
+void VectorMap::receive(const GuardRailArray& msg)
+{
+  guard_rail_.registerUpdater(updateGuardRail<FlatStorage<GuardRail>>);
+  guard_rail_.receive(msg);
+}
+
+void VectorMap::receive(const SideWalkArray& msg)
+{
+  side_walk_.registerUpdater(updateSideWalk<FlatStorage<SideWalk>>);
+  side_walk_.receive(msg);
+}
+
+void VectorMap::receive(const DriveOnPortionArray& msg)
+{
+  drive_on_portion_.registerUpdater(updateDriveOnPortion<FlatStorage<DriveOnPortion>>);
+  drive_on_portion_.receive(msg);
+}
+
+void VectorMap::receive(const CrossRoadArray& msg)
+{
+  cross_road_.registerUpdater(updateCrossRoad<FlatStorage<CrossRoad>>);
+  cross_road_.receive(msg);
+}
+
+void VectorMap::receive(const SideStripArray& msg)
+{
+  side_strip_.registerUpdater(updateSideStrip<FlatStorage<SideStrip>>);
+  side_strip_.receive(msg);
+}
+
+void VectorMap::receive(const CurveMirrorArray& msg)
+{
+  curve_mirror_.registerUpdater(updateCurveMirror<FlatStorage<CurveMirror>>);
+  curve_mirror_.receive(msg);
+}
+
+void VectorMap::receive(const WallArray& msg)
+{
+  wall_.registerUpdater(updateWall<FlatStorage<Wall>>);
+  wall_.receive(msg);
+}
+
+void VectorMap::receive(const FenceArray& msg)
+{
+  fence_.registerUpdater(updateFence<FlatStorage<Fence>>);
+  fence_.receive(msg);
+}
+
+void VectorMap::receive(const RailCrossingArray& msg)
+{
+  rail_crossing_.registerUpdater(updateRailCrossing<FlatStorage<RailCrossing>>);
+  rail_crossing_.receive(msg);
+}
+
 void VectorMap::registerCallback(const Callback<PointArray>& cb)
 {
   point_.registerCallback(cb);
@@ -0,0 +1,523 @@
+/*
+ * Copyright 2015-2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector_map/vector_map.h>
+
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace vector_map
+{
+namespace
+{
+constexpr uint32_t SNAPSHOT_MAGIC = 0x53534d56;  // "VMSS"
+constexpr uint32_t BYTE_ORDER_MARK = 0x01020304;
+constexpr uint32_t SECTION_ITEMS = 1;
+constexpr uint32_t SECTION_GRID = 2;
+constexpr uint64_t SECTION_ALIGNMENT = 8;
+
+// file layout: header, section table, then the data of the sections at offsets aligned to SECTION_ALIGNMENT
+struct SnapshotHeader
+{
+  uint32_t magic;
+  uint32_t version;
+  uint32_t byte_order;
+  uint32_t section_count;
+  uint64_t file_size;
+};
+
+struct SnapshotSection
+{
+  uint32_t kind;
+  category_t category;  // of the items, POINT or LANE for the grids
+  uint64_t count;  // items or cells
+  uint32_t item_size;  // sizeof the items stored in place, 0 when they are serialized one after the other
+  uint32_t index_count;  // secondary indexes of count entries each
+  uint64_t ids_offset;
+  uint64_t data_offset;  // items, or a SnapshotGrid and its cells
+  uint64_t data_size;
+  uint64_t index_offset;
+};
+
+struct SnapshotGrid
+{
+  double cell_size;
+  double min_x;
+  double min_y;
+  double max_x;
+  double max_y;
+};
+
+struct SnapshotCell
+{
+  int64_t key;
+  int32_t id;
+  int32_t reserved;
+};
+
+// the simple messages of ROS are serialized as their memory, their serialized array is an array of them
+template <class T>
+bool isStoredInPlace()
+{
+  return ros::message_traits::IsSimple<T>::value && ros::serialization::serializationLength(T()) == sizeof(T);
+}
+
+class SnapshotWriter
+{
+public:
+  std::vector<SnapshotSection> sections;
+  std::vector<std::vector<uint8_t>> blobs;  // data of the sections, in the order of their offsets
+
+  // number of the blob, replaced by its file offset once all the sections are added
+  size_t addBlob(std::vector<uint8_t>&& blob)
+  {
+    blobs.push_back(std::move(blob));
+    return blobs.size() - 1;
+  }
+};
+
+template <class T>
+void appendBytes(std::vector<uint8_t>& blob, const T* values, size_t count)
+{
+  const uint8_t* bytes = reinterpret_cast<const uint8_t*>(values);
+  blob.insert(blob.end(), bytes, bytes + count * sizeof(T));
+}
+
+template <class T, class U>
+void addItemsSection(category_t category, const Handle<T, U>& handle, SnapshotWriter& writer)
+{
+  const FlatStorage<T>& storage = handle.getStorage();
+  if (storage.empty())
+    return;
+
+  SnapshotSection section = {};
+  section.kind = SECTION_ITEMS;
+  section.category = category;
+  section.count = storage.size();
+  section.item_size = isStoredInPlace<T>() ? sizeof(T) : 0;
+  section.index_count = handle.getIndexCount();
+
+  std::vector<uint8_t> ids;
+  appendBytes(ids, storage.ids(), storage.size());
+  section.ids_offset = writer.addBlob(std::move(ids));
+
+  size_t size = 0;
+  storage.forEach([&size](const T& item) { size += ros::serialization::serializationLength(item); });
+  std::vector<uint8_t> items(size);
+  ros::serialization::OStream stream(items.data(), items.size());
+  storage.forEach([&stream](const T& item) { ros::serialization::serialize(stream, item); });
+  section.data_size = size;
+  section.data_offset = writer.addBlob(std::move(items));
+
+  std::vector<uint8_t> indexes;
+  indexes.reserve(section.index_count * storage.size() * sizeof(SnapshotIndexEntry));
+  for (size_t i = 0; i < handle.getIndexCount(); ++i)
+  {
+    for (const auto& entry : handle.getIndex(i))
+    {
+      SnapshotIndexEntry index_entry = { entry.first, static_cast<uint32_t>(entry.second - storage.at(0)) };
+      appendBytes(indexes, &index_entry, 1);
+    }
+  }
+  section.index_offset = writer.addBlob(std::move(indexes));
+  writer.sections.push_back(section);
+}
+
+class SnapshotMapping
+{
+public:
+  std::shared_ptr<const void> data;
+  uint64_t size = 0;
+
+  bool contains(uint64_t offset, uint64_t size) const
+  {
+    return offset <= this->size && size <= this->size - offset;
+  }
+
+  const uint8_t* at(uint64_t offset) const
+  {
+    return static_cast<const uint8_t*>(data.get()) + offset;
+  }
+};
+
+template <class T, class U>
+bool loadItemsSection(Handle<T, U>& handle, const SnapshotMapping& mapping, const SnapshotSection& section)
+{
+  uint64_t count = section.count;
+  if (count > UINT32_MAX || section.data_size > UINT32_MAX ||
+      !mapping.contains(section.ids_offset, count * sizeof(int)) ||
+      !mapping.contains(section.data_offset, section.data_size) ||
+      !mapping.contains(section.index_offset, section.index_count * count * sizeof(SnapshotIndexEntry)))
+    return false;
+
+  const int* ids = reinterpret_cast<const int*>(mapping.at(section.ids_offset));
+  for (uint64_t i = 1; i < count; ++i)
+  {
+    if (ids[i - 1] >= ids[i])
+      return false;
+  }
+
+  std::vector<std::pair<const SnapshotIndexEntry*, size_t>> indexes;
+  const SnapshotIndexEntry* entries = reinterpret_cast<const SnapshotIndexEntry*>(mapping.at(section.index_offset));
+  for (uint32_t i = 0; i < section.index_count; ++i)
+    indexes.emplace_back(entries + i * count, count);
+
+  if (section.item_size == sizeof(T) && isStoredInPlace<T>() && section.data_size == count * sizeof(T) &&
+      section.data_offset % alignof(T) == 0)
+  {
+    const T* items = reinterpret_cast<const T*>(mapping.at(section.data_offset));
+    handle.load([&](FlatStorage<T>& storage) { storage.attach(mapping.data, ids, items, count); }, indexes);
+    return true;
+  }
+
+  // serialized items, the mapping is only read
+  std::vector<T> items(count);
+  try
+  {
+    ros::serialization::IStream stream(const_cast<uint8_t*>(mapping.at(section.data_offset)), section.data_size);
+    for (auto& item : items)
+      ros::serialization::deserialize(stream, item);
+  }
+  catch (const ros::serialization::StreamOverrunException&)
+  {
+    return false;
+  }
+  handle.load(
+      [&](FlatStorage<T>& storage) {
+        storage.clear(count);
+        for (uint64_t i = 0; i < count; ++i)
+          storage.insert(Key<T>(ids[i]), items[i]);
+        storage.build();
+      },
+      indexes);
+  return true;
+}
+
+bool mapSnapshot(const std::string& file_name, SnapshotMapping& mapping)
+{
+  int fd = open(file_name.c_str(), O_RDONLY);
+  if (fd < 0)
+    return false;
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(SnapshotHeader)))
+  {
+    close(fd);
+    return false;
+  }
+  size_t size = st.st_size;
+  void* data = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED)
+    return false;
+  mapping.data = std::shared_ptr<const void>(data, [size](const void* p) { munmap(const_cast<void*>(p), size); });
+  mapping.size = size;
+  return true;
+}
+}  // namespace
+
+bool VectorMap::saveSnapshot(const std::string& file_name, category_t category) const
+{
+  SnapshotWriter writer;
+  if (category & POINT)
+    addItemsSection(POINT, point_, writer);
+  if (category & VECTOR)
+    addItemsSection(VECTOR, vector_, writer);
+  if (category & LINE)
+    addItemsSection(LINE, line_, writer);
+  if (category & AREA)
+    addItemsSection(AREA, area_, writer);
+  if (category & POLE)
+    addItemsSection(POLE, pole_, writer);
+  if (category & BOX)
+    addItemsSection(BOX, box_, writer);
+  if (category & DTLANE)
+    addItemsSection(DTLANE, dtlane_, writer);
+  if (category & NODE)
+    addItemsSection(NODE, node_, writer);
+  if (category & LANE)
+    addItemsSection(LANE, lane_, writer);
+  if (category & WAY_AREA)
+    addItemsSection(WAY_AREA, way_area_, writer);
+  if (category & ROAD_EDGE)
+    addItemsSection(ROAD_EDGE, road_edge_, writer);
+  if (category & GUTTER)
+    addItemsSection(GUTTER, gutter_, writer);
+  if (category & CURB)
+    addItemsSection(CURB, curb_, writer);
+  if (category & WHITE_LINE)
+    addItemsSection(WHITE_LINE, white_line_, writer);
+  if (category & STOP_LINE)
+    addItemsSection(STOP_LINE, stop_line_, writer);
+  if (category & ZEBRA_ZONE)
+    addItemsSection(ZEBRA_ZONE, zebra_zone_, writer);
+  if (category & CROSS_WALK)
+    addItemsSection(CROSS_WALK, cross_walk_, writer);
+  if (category & ROAD_MARK)
+    addItemsSection(ROAD_MARK, road_mark_, writer);
+  if (category & ROAD_POLE)
+    addItemsSection(ROAD_POLE, road_pole_, writer);
+  if (category & ROAD_SIGN)
+    addItemsSection(ROAD_SIGN, road_sign_, writer);
+  if (category & SIGNAL)
+    addItemsSection(SIGNAL, signal_, writer);
+  if (category & STREET_LIGHT)
+    addItemsSection(STREET_LIGHT, street_light_, writer);
+  if (category & UTILITY_POLE)
+    addItemsSection(UTILITY_POLE, utility_pole_, writer);
+  if (category & GUARD_RAIL)
+    addItemsSection(GUARD_RAIL, guard_rail_, writer);
+  if (category & SIDE_WALK)
+    addItemsSection(SIDE_WALK, side_walk_, writer);
+  if (category & DRIVE_ON_PORTION)
+    addItemsSection(DRIVE_ON_PORTION, drive_on_portion_, writer);
+  if (category & CROSS_ROAD)
+    addItemsSection(CROSS_ROAD, cross_road_, writer);
+  if (category & SIDE_STRIP)
+    addItemsSection(SIDE_STRIP, side_strip_, writer);
+  if (category & CURVE_MIRROR)
+    addItemsSection(CURVE_MIRROR, curve_mirror_, writer);
+  if (category & WALL)
+    addItemsSection(WALL, wall_, writer);
+  if (category & FENCE)
+    addItemsSection(FENCE, fence_, writer);
+  if (category & RAIL_CROSSING)
+    addItemsSection(RAIL_CROSSING, rail_crossing_, writer);
+
+  if (hasSpatialIndex())
+  {
+    const std::pair<category_t, const GridIndex*> grids[] = { { POINT, &point_grid_ }, { LANE, &lane_grid_ } };
+    for (const auto& grid : grids)
+    {
+      const GridIndex& index = *grid.second;
+      SnapshotSection section = {};
+      section.kind = SECTION_GRID;
+      section.category = grid.first;
+      section.count = index.cells_.size();
+      SnapshotGrid bounds = { index.cell_size_, index.min_x_, index.min_y_, index.max_x_, index.max_y_ };
+      std::vector<uint8_t> data;
+      appendBytes(data, &bounds, 1);
+      for (const auto& cell : index.cells_)
+      {
+        SnapshotCell snapshot_cell = { cell.first, cell.second, 0 };
+        appendBytes(data, &snapshot_cell, 1);
+      }
+      section.data_size = data.size();
+      section.data_offset = writer.addBlob(std::move(data));
+      writer.sections.push_back(section);
+    }
+  }
+
+  // the blob numbers of the sections become file offsets
+  std::vector<uint64_t> offsets(writer.blobs.size());
+  uint64_t offset = sizeof(SnapshotHeader) + writer.sections.size() * sizeof(SnapshotSection);
+  for (size_t i = 0; i < writer.blobs.size(); ++i)
+  {
+    offset = (offset + SECTION_ALIGNMENT - 1) / SECTION_ALIGNMENT * SECTION_ALIGNMENT;
+    offsets[i] = offset;
+    offset += writer.blobs[i].size();
+  }
+  for (auto& section : writer.sections)
+  {
+    if (section.kind == SECTION_ITEMS)
+    {
+      section.ids_offset = offsets[section.ids_offset];
+      section.index_offset = offsets[section.index_offset];
+    }
+    section.data_offset = offsets[section.data_offset];
+  }
+
+  SnapshotHeader header = { SNAPSHOT_MAGIC, SNAPSHOT_VERSION, BYTE_ORDER_MARK,
+                            static_cast<uint32_t>(writer.sections.size()), offset };
+  std::string tmp_name = file_name + ".tmp";
+  std::ofstream ofs(tmp_name.c_str(), std::ios::binary | std::ios::trunc);
+  ofs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  ofs.write(reinterpret_cast<const char*>(writer.sections.data()), writer.sections.size() * sizeof(SnapshotSection));
+  uint64_t position = sizeof(SnapshotHeader) + writer.sections.size() * sizeof(SnapshotSection);
+  const char padding[SECTION_ALIGNMENT] = {};
+  for (size_t i = 0; i < writer.blobs.size(); ++i)
+  {
+    ofs.write(padding, offsets[i] - position);
+    ofs.write(reinterpret_cast<const char*>(writer.blobs[i].data()), writer.blobs[i].size());
+    position = offsets[i] + writer.blobs[i].size();
+  }
+  ofs.close();
+  if (!ofs)
+  {
+    std::remove(tmp_name.c_str());
+    return false;
+  }
+  return std::rename(tmp_name.c_str(), file_name.c_str()) == 0;
+}
+
+bool VectorMap::loadSnapshot(const std::string& file_name, category_t category)
+{
+  SnapshotMapping mapping;
+  if (!mapSnapshot(file_name, mapping))
+    return false;
+
+  SnapshotHeader header;
+  std::memcpy(&header, mapping.at(0), sizeof(header));
+  if (header.magic != SNAPSHOT_MAGIC || header.version != SNAPSHOT_VERSION || header.byte_order != BYTE_ORDER_MARK ||
+      header.file_size != mapping.size ||
+      !mapping.contains(sizeof(header), static_cast<uint64_t>(header.section_count) * sizeof(SnapshotSection)))
+    return false;
+  const SnapshotSection* sections = reinterpret_cast<const SnapshotSection*>(mapping.at(sizeof(header)));
+
+  {
+    std::lock_guard<std::mutex> lock(spatial_mutex_);
+    loading_snapshot_ = true;
+  }
+
+  category_t loaded_categories = NONE;
+  bool valid = true;
+  std::vector<const SnapshotSection*> grid_sections;
+  for (uint32_t i = 0; i < header.section_count; ++i)
+  {
+    const SnapshotSection& section = sections[i];
+    if (section.kind == SECTION_GRID)
+    {
+      grid_sections.push_back(&section);
+      continue;
+    }
+    if (section.kind != SECTION_ITEMS || !(section.category & category))
+      continue;
+
+    bool loaded = false;
+    if (section.category == POINT)
+      loaded = loadItemsSection(point_, mapping, section);
+    else if (section.category == VECTOR)
+      loaded = loadItemsSection(vector_, mapping, section);
+    else if (section.category == LINE)
+      loaded = loadItemsSection(line_, mapping, section);
+    else if (section.category == AREA)
+      loaded = loadItemsSection(area_, mapping, section);
+    else if (section.category == POLE)
+      loaded = loadItemsSection(pole_, mapping, section);
+    else if (section.category == BOX)
+      loaded = loadItemsSection(box_, mapping, section);
+    else if (section.category == DTLANE)
+      loaded = loadItemsSection(dtlane_, mapping, section);
+    else if (section.category == NODE)
+      loaded = loadItemsSection(node_, mapping, section);
+    else if (section.category == LANE)
+      loaded = loadItemsSection(lane_, mapping, section);
+    else if (section.category == WAY_AREA)
+      loaded = loadItemsSection(way_area_, mapping, section);
+    else if (section.category == ROAD_EDGE)
+      loaded = loadItemsSection(road_edge_, mapping, section);
+    else if (section.category == GUTTER)
+      loaded = loadItemsSection(gutter_, mapping, section);
+    else if (section.category == CURB)
+      loaded = loadItemsSection(curb_, mapping, section);
+    else if (section.category == WHITE_LINE)
+      loaded = loadItemsSection(white_line_, mapping, section);
+    else if (section.category == STOP_LINE)
+      loaded = loadItemsSection(stop_line_, mapping, section);
+    else if (section.category == ZEBRA_ZONE)
+      loaded = loadItemsSection(zebra_zone_, mapping, section);
+    else if (section.category == CROSS_WALK)
+      loaded = loadItemsSection(cross_walk_, mapping, section);
+    else if (section.category == ROAD_MARK)
+      loaded = loadItemsSection(road_mark_, mapping, section);
+    else if (section.category == ROAD_POLE)
+      loaded = loadItemsSection(road_pole_, mapping, section);
+    else if (section.category == ROAD_SIGN)
+      loaded = loadItemsSection(road_sign_, mapping, section);
+    else if (section.category == SIGNAL)
+      loaded = loadItemsSection(signal_, mapping, section);
+    else if (section.category == STREET_LIGHT)
+      loaded = loadItemsSection(street_light_, mapping, section);
+    else if (section.category == UTILITY_POLE)
+      loaded = loadItemsSection(utility_pole_, mapping, section);
+    else if (section.category == GUARD_RAIL)
+      loaded = loadItemsSection(guard_rail_, mapping, section);
+    else if (section.category == SIDE_WALK)
+      loaded = loadItemsSection(side_walk_, mapping, section);
+    else if (section.category == DRIVE_ON_PORTION)
+      loaded = loadItemsSection(drive_on_portion_, mapping, section);
+    else if (section.category == CROSS_ROAD)
+      loaded = loadItemsSection(cross_road_, mapping, section);
+    else if (section.category == SIDE_STRIP)
+      loaded = loadItemsSection(side_strip_, mapping, section);
+    else if (section.category == CURVE_MIRROR)
+      loaded = loadItemsSection(curve_mirror_, mapping, section);
+    else if (section.category == WALL)
+      loaded = loadItemsSection(wall_, mapping, section);
+    else if (section.category == FENCE)
+      loaded = loadItemsSection(fence_, mapping, section);
+    else if (section.category == RAIL_CROSSING)
+      loaded = loadItemsSection(rail_crossing_, mapping, section);
+    if (!loaded)
+    {
+      ROS_ERROR_STREAM("invalid " << getCategoryName(section.category) << " in vector map snapshot " << file_name);
+      valid = false;
+      continue;
+    }
+    loaded_categories |= section.category;
+  }
+
+  // a grid of the snapshot is kept only when the categories it is built from were all loaded with it
+  std::lock_guard<std::mutex> lock(spatial_mutex_);
+  loading_snapshot_ = false;
+  if (hasSpatialIndex())
+  {
+    bool point_grid_loaded = false;
+    bool lane_grid_loaded = false;
+    for (const SnapshotSection* section : grid_sections)
+    {
+      GridIndex& index = section->category == POINT ? point_grid_ : lane_grid_;
+      category_t sources = section->category == POINT ? POINT : POINT | NODE | LANE;
+      SnapshotGrid bounds;
+      if ((section->category != POINT && section->category != LANE) || (loaded_categories & sources) != sources ||
+          section->count > (UINT64_MAX - sizeof(bounds)) / sizeof(SnapshotCell) ||
+          section->data_size != sizeof(bounds) + section->count * sizeof(SnapshotCell) ||
+          !mapping.contains(section->data_offset, section->data_size))
+        continue;
+      std::memcpy(&bounds, mapping.at(section->data_offset), sizeof(bounds));
+      if (bounds.cell_size != spatial_cell_size_)
+        continue;
+
+      const SnapshotCell* cells =
+          reinterpret_cast<const SnapshotCell*>(mapping.at(section->data_offset + sizeof(bounds)));
+      index.clear(bounds.cell_size);
+      index.min_x_ = bounds.min_x;
+      index.min_y_ = bounds.min_y;
+      index.max_x_ = bounds.max_x;
+      index.max_y_ = bounds.max_y;
+      index.cells_.reserve(section->count);
+      for (uint64_t i = 0; i < section->count; ++i)
+        index.cells_.emplace_back(cells[i].key, cells[i].id);
+      if (section->category == POINT)
+        point_grid_loaded = true;
+      else
+        lane_grid_loaded = true;
+    }
+    if ((loaded_categories & POINT) && !point_grid_loaded)
+      buildPointGrid();
+    if ((loaded_categories & (POINT | NODE | LANE)) && !lane_grid_loaded)
+      buildLaneGrid();
+  }
+  return valid;
+}
+}  // namespace vector_map
@@ -0,0 +1,536 @@
+/*
+ * Copyright 2015-2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <lz4.h>
+#include <vector_map/vector_map.h>
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace vector_map
+{
+namespace
+{
+constexpr uint32_t CHUNK_MAGIC = 0x43544d56;  // "VMTC"
+constexpr uint32_t INDEX_MAGIC = 0x49544d56;  // "VMTI"
+constexpr uint32_t TILE_VERSION = 1;
+constexpr uint32_t FLAG_LZ4 = 1;
+
+const std::vector<std::pair<category_t, std::string>> CATEGORY_NAMES = {
+  { POINT, "point" },
+  { VECTOR, "vector" },
+  { LINE, "line" },
+  { AREA, "area" },
+  { POLE, "pole" },
+  { BOX, "box" },
+  { DTLANE, "dtlane" },
+  { NODE, "node" },
+  { LANE, "lane" },
+  { WAY_AREA, "way_area" },
+  { ROAD_EDGE, "road_edge" },
+  { GUTTER, "gutter" },
+  { CURB, "curb" },
+  { WHITE_LINE, "white_line" },
+  { STOP_LINE, "stop_line" },
+  { ZEBRA_ZONE, "zebra_zone" },
+  { CROSS_WALK, "cross_walk" },
+  { ROAD_MARK, "road_mark" },
+  { ROAD_POLE, "road_pole" },
+  { ROAD_SIGN, "road_sign" },
+  { SIGNAL, "signal" },
+  { STREET_LIGHT, "street_light" },
+  { UTILITY_POLE, "utility_pole" },
+  { GUARD_RAIL, "guard_rail" },
+  { SIDE_WALK, "side_walk" },
+  { DRIVE_ON_PORTION, "drive_on_portion" },
+  { CROSS_ROAD, "cross_road" },
+  { SIDE_STRIP, "side_strip" },
+  { CURVE_MIRROR, "curve_mirror" },
+  { WALL, "wall" },
+  { FENCE, "fence" },
+  { RAIL_CROSSING, "rail_crossing" },
+};
+
+template <class T>
+void append(std::vector<uint8_t>& buf, const T& value)
+{
+  const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+  buf.insert(buf.end(), bytes, bytes + sizeof(value));
+}
+
+class Reader
+{
+private:
+  const uint8_t* pos_;
+  const uint8_t* end_;
+
+public:
+  Reader(const uint8_t* begin, size_t size) : pos_(begin), end_(begin + size)
+  {
+  }
+
+  template <class T>
+  bool read(T& value)
+  {
+    if (static_cast<size_t>(end_ - pos_) < sizeof(value))
+      return false;
+    std::memcpy(&value, pos_, sizeof(value));
+    pos_ += sizeof(value);
+    return true;
+  }
+
+  const uint8_t* pos() const
+  {
+    return pos_;
+  }
+
+  size_t left() const
+  {
+    return end_ - pos_;
+  }
+};
+
+std::string formatTileNumber(int32_t v)
+{
+  if (v < 0)
+    return "n" + std::to_string(-static_cast<int64_t>(v));
+  return std::to_string(v);
+}
+
+// first point of an item, false when one of the items on the way is missing
+bool locatePoint(const VectorMap& vmap, int pid, Point& point)
+{
+  point = vmap.findByKey(Key<Point>(pid));
+  return point.pid != 0;
+}
+
+bool locateVector(const VectorMap& vmap, int vid, Point& point)
+{
+  Vector vector = vmap.findByKey(Key<Vector>(vid));
+  return vector.vid != 0 && locatePoint(vmap, vector.pid, point);
+}
+
+bool locateLine(const VectorMap& vmap, int lid, Point& point)
+{
+  Line line = vmap.findByKey(Key<Line>(lid));
+  return line.lid != 0 && locatePoint(vmap, line.bpid, point);
+}
+
+bool locateArea(const VectorMap& vmap, int aid, Point& point)
+{
+  Area area = vmap.findByKey(Key<Area>(aid));
+  return area.aid != 0 && locateLine(vmap, area.slid, point);
+}
+
+bool locatePole(const VectorMap& vmap, int plid, Point& point)
+{
+  Pole pole = vmap.findByKey(Key<Pole>(plid));
+  return pole.plid != 0 && locateVector(vmap, pole.vid, point);
+}
+
+bool locateNode(const VectorMap& vmap, int nid, Point& point)
+{
+  Node node = vmap.findByKey(Key<Node>(nid));
+  return node.nid != 0 && locatePoint(vmap, node.pid, point);
+}
+
+bool locate(const VectorMap& vmap, const Point& item, Point& point)
+{
+  point = item;
+  return true;
+}
+
+bool locate(const VectorMap& vmap, const Vector& item, Point& point)
+{
+  return locatePoint(vmap, item.pid, point);
+}
+
+bool locate(const VectorMap& vmap, const Line& item, Point& point)
+{
+  return locatePoint(vmap, item.bpid, point);
+}
+
+bool locate(const VectorMap& vmap, const Area& item, Point& point)
+{
+  return locateLine(vmap, item.slid, point);
+}
+
+bool locate(const VectorMap& vmap, const Pole& item, Point& point)
+{
+  return locateVector(vmap, item.vid, point);
+}
+
+bool locate(const VectorMap& vmap, const Box& item, Point& point)
+{
+  return locatePoint(vmap, item.pid1, point);
+}
+
+bool locate(const VectorMap& vmap, const DTLane& item, Point& point)
+{
+  return locatePoint(vmap, item.pid, point);
+}
+
+bool locate(const VectorMap& vmap, const Node& item, Point& point)
+{
+  return locatePoint(vmap, item.pid, point);
+}
+
+bool locate(const VectorMap& vmap, const Lane& item, Point& point)
+{
+  return locateNode(vmap, item.bnid, point);
+}
+
+bool locate(const VectorMap& vmap, const WayArea& item, Point& point)
+{
+  return locateArea(vmap, item.aid, point);
+}
+
+bool locate(const VectorMap& vmap, const RoadEdge& item, Point& point)
+{
+  return locateLine(vmap, item.lid, point);
+}
+
+bool locate(const VectorMap& vmap, const Gutter& item, Point& point)
+{
+  return locateArea(vmap, item.aid, point);
+}
+
+bool locate(const VectorMap& vmap, const Curb& item, Point& point)
+{
+  return locateLine(vmap, item.lid, point);
+}
+
+bool locate(const VectorMap& vmap, const WhiteLine& item, Point& point)
+{
+  return locateLine(vmap, item.lid, point);
+}
+
+bool locate(const VectorMap& vmap, const StopLine& item, Point& point)
+{
+  return locateLine(vmap, item.lid, point);
+}
+
+bool locate(const VectorMap& vmap, const ZebraZone& item, Point& point)
+{
+  return locateArea(vmap, item.aid, point);
+}
+
+bool locate(const VectorMap& vmap, const CrossWalk& item, Point& point)
+{
+  return locateArea(vmap, item.aid, point);
+}
+
+bool locate(const VectorMap& vmap, const RoadMark& item, Point& point)
+{
+  return locateArea(vmap, item.aid, point);
+}
+
+bool locate(const VectorMap& vmap, const RoadPole& item, Point& point)
+{
+  return locatePole(vmap, item.plid, point);
+}
+
+bool locate(const VectorMap& vmap, const RoadSign& item, Point& point)
+{
+  return locateVector(vmap, item.vid, point);
+}
+
+bool locate(const VectorMap& vmap, const Signal& item, Point& point)
+{
+  return locateVector(vmap, item.vid, point);
+}
+
+bool locate(const VectorMap& vmap, const StreetLight& item, Point& point)
+{
+  return locateLine(vmap, item.lid, point);
+}
+
+bool locate(const VectorMap& vmap, const UtilityPole& item, Point& point)
+{
+  return locatePole(vmap, item.plid, point);
+}
+
+bool locate(const VectorMap& vmap, const GuardRail& item, Point& point)
+{
+  return locateArea(vmap, item.aid, point);
+}
+
+bool locate(const VectorMap& vmap, const SideWalk& item, Point& point)
+{
+  return locateArea(vmap, item.aid, point);
+}
+
+bool locate(const VectorMap& vmap, const DriveOnPortion& item, Point& point)
+{
+  return locateArea(vmap, item.aid, point);
+}
+
+bool locate(const VectorMap& vmap, const CrossRoad& item, Point& point)
+{
+  return locateArea(vmap, item.aid, point);
+}
+
+bool locate(const VectorMap& vmap, const SideStrip& item, Point& point)
+{
+  return locateLine(vmap, item.lid, point);
+}
+
+bool locate(const VectorMap& vmap, const CurveMirror& item, Point& point)
+{
+  return locateVector(vmap, item.vid, point);
+}
+
+bool locate(const VectorMap& vmap, const Wall& item, Point& point)
+{
+  return locateArea(vmap, item.aid, point);
+}
+
+bool locate(const VectorMap& vmap, const Fence& item, Point& point)
+{
+  return locateArea(vmap, item.aid, point);
+}
+
+bool locate(const VectorMap& vmap, const RailCrossing& item, Point& point)
+{
+  return locateArea(vmap, item.aid, point);
+}
+
+template <class T, class U>
+void createCategoryTileChunks(const VectorMap& vmap, category_t category, double tile_size, bool compress,
+                              TileIndex& index, std::vector<std::pair<std::string, std_msgs::UInt8MultiArray>>& chunks)
+{
+  std::map<std::pair<int32_t, int32_t>, U> tiles;
+  for (const auto& item : vmap.findByFilter([](const T& item) { return true; }))
+  {
+    Point point;
+    TileId tile = { NO_TILE, NO_TILE };
+    if (locate(vmap, item, point))
+      tile = getTileId(point.bx, point.ly, tile_size);
+    tiles[std::make_pair(tile.x, tile.y)].data.push_back(item);
+  }
+
+  for (auto& pair : tiles)
+  {
+    TileId tile = { pair.first.first, pair.first.second };
+    pair.second.header.frame_id = "map";
+    index.entries.push_back({ category, tile, static_cast<uint32_t>(pair.second.data.size()) });
+    chunks.emplace_back(getTileTopic(category, tile), std_msgs::UInt8MultiArray());
+    encodeTileChunk(category, tile, serializeArray(pair.second), compress, chunks.back().second);
+  }
+}
+}  // namespace
+
+std::string getCategoryName(category_t category)
+{
+  for (const auto& pair : CATEGORY_NAMES)
+  {
+    if (pair.first == category)
+      return pair.second;
+  }
+  return std::string();
+}
+
+TileId getTileId(double x, double y, double tile_size)
+{
+  TileId tile;
+  tile.x = static_cast<int32_t>(std::floor(x / tile_size));
+  tile.y = static_cast<int32_t>(std::floor(y / tile_size));
+  return tile;
+}
+
+std::string getTileTopic(category_t category, const TileId& tile)
+{
+  std::string topic = "/vector_map_info/" + getCategoryName(category) + "/tile_";
+  if (tile.x == NO_TILE)
+    return topic + "none";
+  return topic + formatTileNumber(tile.x) + "_" + formatTileNumber(tile.y);
+}
+
+void encodeTileIndex(const TileIndex& index, std_msgs::UInt8MultiArray& msg)
+{
+  msg.data.clear();
+  append(msg.data, INDEX_MAGIC);
+  append(msg.data, TILE_VERSION);
+  append(msg.data, index.tile_size);
+  append(msg.data, static_cast<uint32_t>(index.entries.size()));
+  for (const auto& entry : index.entries)
+  {
+    append(msg.data, entry.category);
+    append(msg.data, entry.tile.x);
+    append(msg.data, entry.tile.y);
+    append(msg.data, entry.size);
+  }
+}
+
+bool decodeTileIndex(const std_msgs::UInt8MultiArray& msg, TileIndex& index)
+{
+  Reader reader(msg.data.data(), msg.data.size());
+  uint32_t magic, version, count;
+  if (!reader.read(magic) || !reader.read(version) || magic != INDEX_MAGIC || version != TILE_VERSION)
+    return false;
+  if (!reader.read(index.tile_size) || !reader.read(count) || !(index.tile_size > 0))
+    return false;
+
+  index.entries.clear();
+  for (uint32_t i = 0; i < count; ++i)
+  {
+    TileIndexEntry entry;
+    if (!reader.read(entry.category) || !reader.read(entry.tile.x) || !reader.read(entry.tile.y) ||
+        !reader.read(entry.size))
+      return false;
+    index.entries.push_back(entry);
+  }
+  return true;
+}
+
+void encodeTileChunk(category_t category, const TileId& tile, const std::vector<uint8_t>& data, bool compress,
+                     std_msgs::UInt8MultiArray& msg)
+{
+  std::vector<uint8_t> payload;
+  uint32_t flags = 0;
+  if (compress && !data.empty() && data.size() <= LZ4_MAX_INPUT_SIZE)
+  {
+    payload.resize(LZ4_compressBound(data.size()));
+    int size = LZ4_compress_default(reinterpret_cast<const char*>(data.data()), reinterpret_cast<char*>(&payload[0]),
+                                    data.size(), payload.size());
+    // kept only when it saves something, small tiles of few items hardly compress
+    if (size > 0 && static_cast<size_t>(size) < data.size())
+    {
+      payload.resize(size);
+      flags |= FLAG_LZ4;
+    }
+  }
+
+  msg.data.clear();
+  append(msg.data, CHUNK_MAGIC);
+  append(msg.data, TILE_VERSION);
+  append(msg.data, flags);
+  append(msg.data, category);
+  append(msg.data, tile.x);
+  append(msg.data, tile.y);
+  append(msg.data, static_cast<uint64_t>(data.size()));
+  if (flags & FLAG_LZ4)
+    msg.data.insert(msg.data.end(), payload.begin(), payload.end());
+  else
+    msg.data.insert(msg.data.end(), data.begin(), data.end());
+}
+
+bool decodeTileChunk(const std_msgs::UInt8MultiArray& msg, category_t& category, TileId& tile,
+                     std::vector<uint8_t>& data)
+{
+  Reader reader(msg.data.data(), msg.data.size());
+  uint32_t magic, version, flags;
+  uint64_t raw_size;
+  if (!reader.read(magic) || !reader.read(version) || magic != CHUNK_MAGIC || version != TILE_VERSION)
+    return false;
+  if (!reader.read(flags) || !reader.read(category) || !reader.read(tile.x) || !reader.read(tile.y) ||
+      !reader.read(raw_size))
+    return false;
+
+  if (flags & FLAG_LZ4)
+  {
+    if (raw_size > LZ4_MAX_INPUT_SIZE || reader.left() > LZ4_MAX_INPUT_SIZE)
+      return false;
+    data.resize(raw_size);
+    int size = LZ4_decompress_safe(reinterpret_cast<const char*>(reader.pos()), reinterpret_cast<char*>(data.data()),
+                                   reader.left(), raw_size);
+    return size >= 0 && static_cast<uint64_t>(size) == raw_size;
+  }
+
+  if (reader.left() != raw_size)
+    return false;
+  data.assign(reader.pos(), reader.pos() + raw_size);
+  return true;
+}
+
+void createTileChunks(const VectorMap& vmap, category_t category, double tile_size, bool compress, TileIndex& index,
+                      std::vector<std::pair<std::string, std_msgs::UInt8MultiArray>>& chunks)
+{
+  index.tile_size = tile_size;
+  index.entries.clear();
+  chunks.clear();
+  if (category & POINT)
+    createCategoryTileChunks<Point, PointArray>(vmap, POINT, tile_size, compress, index, chunks);
+  if (category & VECTOR)
+    createCategoryTileChunks<Vector, VectorArray>(vmap, VECTOR, tile_size, compress, index, chunks);
+  if (category & LINE)
+    createCategoryTileChunks<Line, LineArray>(vmap, LINE, tile_size, compress, index, chunks);
+  if (category & AREA)
+    createCategoryTileChunks<Area, AreaArray>(vmap, AREA, tile_size, compress, index, chunks);
+  if (category & POLE)
+    createCategoryTileChunks<Pole, PoleArray>(vmap, POLE, tile_size, compress, index, chunks);
+  if (category & BOX)
+    createCategoryTileChunks<Box, BoxArray>(vmap, BOX, tile_size, compress, index, chunks);
+  if (category & DTLANE)
+    createCategoryTileChunks<DTLane, DTLaneArray>(vmap, DTLANE, tile_size, compress, index, chunks);
+  if (category & NODE)
+    createCategoryTileChunks<Node, NodeArray>(vmap, NODE, tile_size, compress, index, chunks);
+  if (category & LANE)
+    createCategoryTileChunks<Lane, LaneArray>(vmap, LANE, tile_size, compress, index, chunks);
+  if (category & WAY_AREA)
+    createCategoryTileChunks<WayArea, WayAreaArray>(vmap, WAY_AREA, tile_size, compress, index, chunks);
+  if (category & ROAD_EDGE)
+    createCategoryTileChunks<RoadEdge, RoadEdgeArray>(vmap, ROAD_EDGE, tile_size, compress, index, chunks);
+  if (category & GUTTER)
+    createCategoryTileChunks<Gutter, GutterArray>(vmap, GUTTER, tile_size, compress, index, chunks);
+  if (category & CURB)
+    createCategoryTileChunks<Curb, CurbArray>(vmap, CURB, tile_size, compress, index, chunks);
+  if (category & WHITE_LINE)
+    createCategoryTileChunks<WhiteLine, WhiteLineArray>(vmap, WHITE_LINE, tile_size, compress, index, chunks);
+  if (category & STOP_LINE)
+    createCategoryTileChunks<StopLine, StopLineArray>(vmap, STOP_LINE, tile_size, compress, index, chunks);
+  if (category & ZEBRA_ZONE)
+    createCategoryTileChunks<ZebraZone, ZebraZoneArray>(vmap, ZEBRA_ZONE, tile_size, compress, index, chunks);
+  if (category & CROSS_WALK)
+    createCategoryTileChunks<CrossWalk, CrossWalkArray>(vmap, CROSS_WALK, tile_size, compress, index, chunks);
+  if (category & ROAD_MARK)
+    createCategoryTileChunks<RoadMark, RoadMarkArray>(vmap, ROAD_MARK, tile_size, compress, index, chunks);
+  if (category & ROAD_POLE)
+    createCategoryTileChunks<RoadPole, RoadPoleArray>(vmap, ROAD_POLE, tile_size, compress, index, chunks);
+  if (category & ROAD_SIGN)
+    createCategoryTileChunks<RoadSign, RoadSignArray>(vmap, ROAD_SIGN, tile_size, compress, index, chunks);
+  if (category & SIGNAL)
+    createCategoryTileChunks<Signal, SignalArray>(vmap, SIGNAL, tile_size, compress, index, chunks);
+  if (category & STREET_LIGHT)
+    createCategoryTileChunks<StreetLight, StreetLightArray>(vmap, STREET_LIGHT, tile_size, compress, index, chunks);
+  if (category & UTILITY_POLE)
+    createCategoryTileChunks<UtilityPole, UtilityPoleArray>(vmap, UTILITY_POLE, tile_size, compress, index, chunks);
+  if (category & GUARD_RAIL)
+    createCategoryTileChunks<GuardRail, GuardRailArray>(vmap, GUARD_RAIL, tile_size, compress, index, chunks);
+  if (category & SIDE_WALK)
+    createCategoryTileChunks<SideWalk, SideWalkArray>(vmap, SIDE_WALK, tile_size, compress, index, chunks);
+  if (category & DRIVE_ON_PORTION)
+    createCategoryTileChunks<DriveOnPortion, DriveOnPortionArray>(vmap, DRIVE_ON_PORTION, tile_size, compress, index,
+                                                                  chunks);
+  if (category & CROSS_ROAD)
+    createCategoryTileChunks<CrossRoad, CrossRoadArray>(vmap, CROSS_ROAD, tile_size, compress, index, chunks);
+  if (category & SIDE_STRIP)
+    createCategoryTileChunks<SideStrip, SideStripArray>(vmap, SIDE_STRIP, tile_size, compress, index, chunks);
+  if (category & CURVE_MIRROR)
+    createCategoryTileChunks<CurveMirror, CurveMirrorArray>(vmap, CURVE_MIRROR, tile_size, compress, index, chunks);
+  if (category & WALL)
+    createCategoryTileChunks<Wall, WallArray>(vmap, WALL, tile_size, compress, index, chunks);
+  if (category & FENCE)
+    createCategoryTileChunks<Fence, FenceArray>(vmap, FENCE, tile_size, compress, index, chunks);
+  if (category & RAIL_CROSSING)
+    createCategoryTileChunks<RailCrossing, RailCrossingArray>(vmap, RAIL_CROSSING, tile_size, compress, index, chunks);
+}
+}  // namespace vector_map
@@ -0,0 +1,266 @@
+/*
+ * Copyright 2015-2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Query paths of VectorMap on a synthetic map filled through receive(), no ROS master needed.
+// Results are written as JSON to stdout or to the output file:
+// {"benchmark": ..., "map": {...}, "repeats": n, "results": [{"name", "operations", "best_ms", "mean_ms",
+// "ns_per_operation", "items"}]}, best and mean over the repeats, items is a count of what was found
+
+#include <vector_map/vector_map.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using vector_map::Key;
+using vector_map::Lane;
+using vector_map::Node;
+using vector_map::Point;
+using vector_map::StopLine;
+
+namespace
+{
+struct Result
+{
+  std::string name;
+  size_t operations;
+  double best_ms;
+  double mean_ms;
+  size_t items;
+};
+
+struct SyntheticMap
+{
+  vector_map::PointArray points;
+  vector_map::NodeArray nodes;
+  vector_map::LaneArray lanes;
+  vector_map::StopLineArray stop_lines;
+};
+
+// roads parallel lanes 3.5 m apart, each of lanes_per_road lanes of 1 m, a stop line every 50 lanes
+SyntheticMap createGridMap(const int roads, const int lanes_per_road)
+{
+  SyntheticMap map;
+  int id = 1;
+  for (int r = 0; r < roads; r++)
+  {
+    for (int i = 0; i <= lanes_per_road; i++, id++)
+    {
+      Point point;
+      point.pid = id;
+      point.bx = r * 3.5;
+      point.ly = i * 1.0;
+      map.points.data.push_back(point);
+
+      Node node;
+      node.nid = id;
+      node.pid = id;
+      map.nodes.data.push_back(node);
+
+      if (i == lanes_per_road)
+        continue;
+      Lane lane;
+      lane.lnid = id;
+      lane.bnid = id;
+      lane.fnid = id + 1;
+      lane.blid = (i == 0) ? 0 : id - 1;
+      lane.flid = (i == lanes_per_road - 1) ? 0 : id + 1;
+      map.lanes.data.push_back(lane);
+
+      if (i % 50 == 49)
+      {
+        StopLine stop_line;
+        stop_line.id = static_cast<int>(map.stop_lines.data.size()) + 1;
+        stop_line.linkid = id;
+        map.stop_lines.data.push_back(stop_line);
+      }
+    }
+  }
+  return map;
+}
+
+Result measure(const std::string& name, const int repeats, const size_t operations,
+               const std::function<size_t()>& f)
+{
+  Result result{ name, operations, 0.0, 0.0, 0 };
+  std::vector<double> times;
+  for (int i = 0; i < repeats; i++)
+  {
+    auto start = std::chrono::steady_clock::now();
+    result.items = f();
+    auto end = std::chrono::steady_clock::now();
+    times.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+  }
+  result.best_ms = *std::min_element(times.begin(), times.end());
+  double sum = 0;
+  for (const auto t : times)
+    sum += t;
+  result.mean_ms = sum / repeats;
+  return result;
+}
+
+void writeJson(std::ostream& os, const SyntheticMap& map, const int repeats, const std::vector<Result>& results)
+{
+  os << "{\n"
+     << "  \"benchmark\": \"vector_map_query\",\n"
+     << "  \"map\": {\"points\": " << map.points.data.size() << ", \"nodes\": " << map.nodes.data.size()
+     << ", \"lanes\": " << map.lanes.data.size() << ", \"stop_lines\": " << map.stop_lines.data.size() << "},\n"
+     << "  \"repeats\": " << repeats << ",\n"
+     << "  \"results\": [\n";
+  for (size_t i = 0; i < results.size(); i++)
+  {
+    const Result& r = results[i];
+    os << "    {\"name\": \"" << r.name << "\", \"operations\": " << r.operations << ", \"best_ms\": " << r.best_ms
+       << ", \"mean_ms\": " << r.mean_ms << ", \"ns_per_operation\": " << r.best_ms * 1e6 / r.operations
+       << ", \"items\": " << r.items << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+  }
+  os << "  ]\n"
+     << "}\n";
+}
+}  // namespace
+
+int main(int argc, char** argv)
+{
+  const int roads = (argc > 1) ? std::atoi(argv[1]) : 200;
+  const int lanes_per_road = (argc > 2) ? std::atoi(argv[2]) : 500;
+  const int repeats = (argc > 3) ? std::atoi(argv[3]) : 10;
+  const std::string output_file = (argc > 4) ? argv[4] : "";
+  if (roads <= 0 || lanes_per_road <= 0 || repeats <= 0)
+  {
+    std::printf("usage: %s [roads] [lanes_per_road] [repeats] [output.json]\n", argv[0]);
+    return 1;
+  }
+
+  const SyntheticMap map = createGridMap(roads, lanes_per_road);
+  const size_t lookups = 100000;
+  std::mt19937 generator(0);
+  std::uniform_int_distribution<int> pid_distribution(1, static_cast<int>(map.points.data.size()));
+  std::uniform_int_distribution<size_t> lane_distribution(0, map.lanes.data.size() - 1);
+  std::vector<int> pids(lookups);
+  for (auto& pid : pids)
+    pid = pid_distribution(generator);
+  std::vector<Lane> query_lanes(1000);
+  for (auto& lane : query_lanes)
+    lane = map.lanes.data[lane_distribution(generator)];
+
+  std::vector<Result> results;
+  vector_map::VectorMap vmap;
+
+  // what a subscriber does for each message: storage, indexes and callbacks
+  results.push_back(measure("VectorMap::receive(PointArray)", repeats, 1, [&]() {
+    vmap.receive(map.points);
+    return map.points.data.size();
+  }));
+  results.push_back(measure("VectorMap::receive(NodeArray)", repeats, 1, [&]() {
+    vmap.receive(map.nodes);
+    return map.nodes.data.size();
+  }));
+  results.push_back(measure("VectorMap::receive(LaneArray)", repeats, 1, [&]() {
+    vmap.receive(map.lanes);
+    return map.lanes.data.size();
+  }));
+  vmap.receive(map.stop_lines);
+
+  results.push_back(measure("VectorMap::findByKey(Point)", repeats, lookups, [&]() {
+    size_t found = 0;
+    for (const int pid : pids)
+      found += (vmap.findByKey(Key<Point>(pid)).pid == pid) ? 1 : 0;
+    return found;
+  }));
+  results.push_back(measure("VectorMap::findPtrByKey(Point)", repeats, lookups, [&]() {
+    size_t found = 0;
+    for (const int pid : pids)
+      found += (vmap.findPtrByKey(Key<Point>(pid)) != nullptr) ? 1 : 0;
+    return found;
+  }));
+  results.push_back(measure("VectorMap::findByKey(Lane)", repeats, lookups, [&]() {
+    size_t found = 0;
+    for (const int pid : pids)
+      found += (vmap.findByKey(Key<Lane>(pid)).lnid == pid) ? 1 : 0;
+    return found;
+  }));
+
+  // following lanes, by a filter scan and by the bnid index
+  results.push_back(measure("VectorMap::findByFilter(Lane bnid)", repeats, 10, [&]() {
+    size_t found = 0;
+    for (size_t i = 0; i < 10; i++)
+    {
+      const int fnid = query_lanes[i].fnid;
+      found += vmap.findByFilter([fnid](const Lane& lane) { return lane.bnid == fnid; }).size();
+    }
+    return found;
+  }));
+  results.push_back(measure("VectorMap::findLanesStartingAt", repeats, query_lanes.size(), [&]() {
+    size_t found = 0;
+    for (const auto& lane : query_lanes)
+      found += vmap.findLanesStartingAt(vmap.findByKey(Key<Node>(lane.fnid))).size();
+    return found;
+  }));
+  results.push_back(measure("VectorMap::forEachLinkedTo(StopLine)", repeats, query_lanes.size(), [&]() {
+    size_t found = 0;
+    for (const auto& lane : query_lanes)
+      vmap.forEachLinkedTo(lane, [&found](const StopLine& stop_line) { found++; });
+    return found;
+  }));
+
+  // nearest lane, by a scan and by the spatial grid
+  std::vector<Point> query_points(100);
+  for (size_t i = 0; i < query_points.size(); i++)
+    query_points[i] = map.points.data[pids[i] - 1];
+  results.push_back(measure("VectorMap::findNearestLane (scan)", repeats, query_points.size(), [&]() {
+    size_t found = 0;
+    for (const auto& point : query_points)
+      found += (vmap.findNearestLane(point).lnid != 0) ? 1 : 0;
+    return found;
+  }));
+  results.push_back(measure("VectorMap::enableSpatialIndex", repeats, 1, [&]() {
+    vmap.enableSpatialIndex(10.0);
+    return static_cast<size_t>(vmap.hasSpatialIndex());
+  }));
+  results.push_back(measure("VectorMap::findNearestLane (grid)", repeats, query_points.size(), [&]() {
+    size_t found = 0;
+    for (const auto& point : query_points)
+      found += (vmap.findNearestLane(point).lnid != 0) ? 1 : 0;
+    return found;
+  }));
+  results.push_back(measure("VectorMap::findLanesWithinRadius (grid)", repeats, query_points.size(), [&]() {
+    size_t found = 0;
+    for (const auto& point : query_points)
+      found += vmap.findLanesWithinRadius(point, 20.0).size();
+    return found;
+  }));
+
+  if (output_file.empty())
+  {
+    writeJson(std::cout, map, repeats, results);
+    return 0;
+  }
+  std::ofstream ofs(output_file);
+  writeJson(ofs, map, repeats, results);
+  if (!ofs)
+  {
+    std::fprintf(stderr, "failed to write %s\n", output_file.c_str());
+    return 1;
+  }
+  return 0;
+}
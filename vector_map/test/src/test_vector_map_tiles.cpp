@@ -0,0 +1,340 @@
+/*
+ * Copyright 2015-2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <vector_map/vector_map.h>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+using vector_map::Key;
+using vector_map::Lane;
+using vector_map::Node;
+using vector_map::Point;
+using vector_map::TileId;
+using vector_map::TileIndex;
+
+namespace
+{
+// a row of lanes along x, one point and node per meter
+void createRowMap(const int n, vector_map::PointArray& points, vector_map::NodeArray& nodes,
+                  vector_map::LaneArray& lanes)
+{
+  for (int i = 1; i <= n + 1; i++)
+  {
+    Point point;
+    point.pid = i;
+    point.bx = i - 0.5;
+    point.ly = (i % 3) * 7.0 - 7.0;
+    point.ref = i % 4;
+    points.data.push_back(point);
+
+    Node node;
+    node.nid = i;
+    node.pid = i;
+    nodes.data.push_back(node);
+
+    if (i == n + 1)
+      continue;
+    Lane lane;
+    lane.lnid = i;
+    lane.bnid = i;
+    lane.fnid = i + 1;
+    lanes.data.push_back(lane);
+  }
+}
+
+void updatePoints(vector_map::FlatStorage<Point>& storage, const vector_map::PointArray& msg)
+{
+  storage.clear(msg.data.size());
+  for (const auto& item : msg.data)
+    storage.insert(Key<Point>(item.pid), item);
+  storage.build();
+}
+
+template <class U>
+bool decodeTile(const std_msgs::UInt8MultiArray& chunk, vector_map::category_t& category, TileId& tile, U& array)
+{
+  std::vector<uint8_t> data;
+  return vector_map::decodeTileChunk(chunk, category, tile, data) && vector_map::deserializeArray(data, array);
+}
+
+std::vector<std::pair<int, int>> collectIndex(const vector_map::Handle<Point, vector_map::PointArray>& handle,
+                                              size_t index)
+{
+  std::vector<std::pair<int, int>> entries;
+  for (int ref = 0; ref < 4; ref++)
+    handle.forEachByIndex(index, ref, [&](const Point& point) { entries.emplace_back(ref, point.pid); });
+  return entries;
+}
+}  // namespace
+
+TEST(TestVectorMapTiles, TileIndexRoundTrip)
+{
+  TileIndex index;
+  index.tile_size = 25.0;
+  index.entries.push_back({ vector_map::POINT, { -3, 7 }, 12 });
+  index.entries.push_back({ vector_map::LANE, { vector_map::NO_TILE, vector_map::NO_TILE }, 1 });
+  index.entries.push_back({ vector_map::SIGNAL, { 0, -1 }, 0 });
+
+  std_msgs::UInt8MultiArray msg;
+  vector_map::encodeTileIndex(index, msg);
+  TileIndex decoded;
+  ASSERT_TRUE(vector_map::decodeTileIndex(msg, decoded));
+  EXPECT_EQ(decoded.tile_size, index.tile_size);
+  ASSERT_EQ(decoded.entries.size(), index.entries.size());
+  for (size_t i = 0; i < index.entries.size(); i++)
+  {
+    EXPECT_EQ(decoded.entries[i].category, index.entries[i].category);
+    EXPECT_EQ(decoded.entries[i].tile.x, index.entries[i].tile.x);
+    EXPECT_EQ(decoded.entries[i].tile.y, index.entries[i].tile.y);
+    EXPECT_EQ(decoded.entries[i].size, index.entries[i].size);
+  }
+
+  std_msgs::UInt8MultiArray truncated = msg;
+  truncated.data.pop_back();
+  EXPECT_FALSE(vector_map::decodeTileIndex(truncated, decoded));
+  std_msgs::UInt8MultiArray bad_magic = msg;
+  bad_magic.data[0] ^= 1;
+  EXPECT_FALSE(vector_map::decodeTileIndex(bad_magic, decoded));
+
+  index.tile_size = 0;
+  vector_map::encodeTileIndex(index, msg);
+  EXPECT_FALSE(vector_map::decodeTileIndex(msg, decoded));
+}
+
+TEST(TestVectorMapTiles, TileChunkRoundTrip)
+{
+  // repeated bytes compress, the small random-looking payload does not
+  std::vector<std::vector<uint8_t>> payloads(3);
+  payloads[0].assign(4096, 7);
+  for (int i = 0; i < 24; i++)
+    payloads[1].push_back(static_cast<uint8_t>(i * 37 + 11));
+
+  for (const auto& payload : payloads)
+  {
+    for (bool compress : { false, true })
+    {
+      std_msgs::UInt8MultiArray msg;
+      vector_map::encodeTileChunk(vector_map::DTLANE, { 5, -2 }, payload, compress, msg);
+
+      vector_map::category_t category;
+      TileId tile;
+      std::vector<uint8_t> data;
+      ASSERT_TRUE(vector_map::decodeTileChunk(msg, category, tile, data));
+      EXPECT_EQ(category, vector_map::DTLANE);
+      EXPECT_EQ(tile.x, 5);
+      EXPECT_EQ(tile.y, -2);
+      EXPECT_EQ(data, payload);
+
+      std_msgs::UInt8MultiArray truncated = msg;
+      truncated.data.resize(truncated.data.size() - 1);
+      EXPECT_FALSE(vector_map::decodeTileChunk(truncated, category, tile, data));
+      std_msgs::UInt8MultiArray bad_magic = msg;
+      bad_magic.data[3] ^= 1;
+      EXPECT_FALSE(vector_map::decodeTileChunk(bad_magic, category, tile, data));
+    }
+  }
+
+  std_msgs::UInt8MultiArray plain;
+  std_msgs::UInt8MultiArray compressed;
+  vector_map::encodeTileChunk(vector_map::POINT, { 0, 0 }, payloads[0], false, plain);
+  vector_map::encodeTileChunk(vector_map::POINT, { 0, 0 }, payloads[0], true, compressed);
+  EXPECT_LT(compressed.data.size(), plain.data.size());
+}
+
+TEST(TestVectorMapTiles, TileTopics)
+{
+  EXPECT_EQ(vector_map::getTileTopic(vector_map::POINT, { 3, 4 }), "/vector_map_info/point/tile_3_4");
+  EXPECT_EQ(vector_map::getTileTopic(vector_map::WAY_AREA, { -1, -20 }), "/vector_map_info/way_area/tile_n1_n20");
+  EXPECT_EQ(vector_map::getTileTopic(vector_map::LANE, { vector_map::NO_TILE, vector_map::NO_TILE }),
+            "/vector_map_info/lane/tile_none");
+
+  TileId tile = vector_map::getTileId(-0.5, 10.0, 10.0);
+  EXPECT_EQ(tile.x, -1);
+  EXPECT_EQ(tile.y, 1);
+}
+
+TEST(TestVectorMapTiles, TileChunksHoldTheWholeMap)
+{
+  vector_map::PointArray points;
+  vector_map::NodeArray nodes;
+  vector_map::LaneArray lanes;
+  createRowMap(60, points, nodes, lanes);
+  // a lane whose node is missing has no point, it is in the tile_none topic
+  Lane orphan;
+  orphan.lnid = 1000;
+  orphan.bnid = 999;
+  lanes.data.push_back(orphan);
+
+  vector_map::VectorMap vmap;
+  vmap.receive(points);
+  vmap.receive(nodes);
+  vmap.receive(lanes);
+
+  const double tile_size = 10.0;
+  for (bool compress : { false, true })
+  {
+    TileIndex index;
+    std::vector<std::pair<std::string, std_msgs::UInt8MultiArray>> chunks;
+    vector_map::createTileChunks(vmap, vector_map::POINT | vector_map::LANE, tile_size, compress, index, chunks);
+    EXPECT_EQ(index.tile_size, tile_size);
+    ASSERT_EQ(index.entries.size(), chunks.size());
+
+    std::map<int, Point> received_points;
+    std::map<int, Lane> received_lanes;
+    for (size_t i = 0; i < chunks.size(); i++)
+    {
+      const auto& entry = index.entries[i];
+      EXPECT_EQ(chunks[i].first, vector_map::getTileTopic(entry.category, entry.tile));
+
+      vector_map::category_t category;
+      TileId tile;
+      if (entry.category == vector_map::POINT)
+      {
+        vector_map::PointArray array;
+        ASSERT_TRUE(decodeTile(chunks[i].second, category, tile, array));
+        EXPECT_EQ(array.data.size(), entry.size);
+        for (const auto& point : array.data)
+        {
+          TileId expected = vector_map::getTileId(point.bx, point.ly, tile_size);
+          EXPECT_EQ(tile.x, expected.x);
+          EXPECT_EQ(tile.y, expected.y);
+          EXPECT_TRUE(received_points.emplace(point.pid, point).second);
+        }
+      }
+      else
+      {
+        ASSERT_EQ(entry.category, vector_map::LANE);
+        vector_map::LaneArray array;
+        ASSERT_TRUE(decodeTile(chunks[i].second, category, tile, array));
+        EXPECT_EQ(array.data.size(), entry.size);
+        for (const auto& lane : array.data)
+        {
+          if (lane.lnid == orphan.lnid)
+          {
+            EXPECT_EQ(tile.x, vector_map::NO_TILE);
+          }
+          else
+          {
+            Point point = vmap.findByKey(Key<Point>(vmap.findByKey(Key<Node>(lane.bnid)).pid));
+            TileId expected = vector_map::getTileId(point.bx, point.ly, tile_size);
+            EXPECT_EQ(tile.x, expected.x);
+            EXPECT_EQ(tile.y, expected.y);
+          }
+          EXPECT_TRUE(received_lanes.emplace(lane.lnid, lane).second);
+        }
+      }
+      EXPECT_EQ(category, entry.category);
+    }
+
+    ASSERT_EQ(received_points.size(), points.data.size());
+    for (const auto& point : points.data)
+    {
+      EXPECT_EQ(received_points[point.pid].bx, point.bx);
+      EXPECT_EQ(received_points[point.pid].ly, point.ly);
+    }
+    ASSERT_EQ(received_lanes.size(), lanes.data.size());
+    for (const auto& lane : lanes.data)
+      EXPECT_EQ(received_lanes[lane.lnid].fnid, lane.fnid);
+  }
+}
+
+TEST(TestVectorMapTiles, TilesMergeIntoTheStorage)
+{
+  vector_map::PointArray points;
+  vector_map::NodeArray nodes;
+  vector_map::LaneArray lanes;
+  createRowMap(80, points, nodes, lanes);
+  vector_map::VectorMap vmap;
+  vmap.receive(points);
+
+  TileIndex index;
+  std::vector<std::pair<std::string, std_msgs::UInt8MultiArray>> chunks;
+  vector_map::createTileChunks(vmap, vector_map::POINT, 10.0, true, index, chunks);
+  ASSERT_GT(chunks.size(), 3u);
+
+  vector_map::Handle<Point, vector_map::PointArray> full;
+  full.registerUpdater(updatePoints);
+  size_t full_index = full.addIndex([](const Point& point) { return point.ref; });
+  full.receive(points);
+
+  // tiles out of id order, the callbacks get the items of each tile
+  vector_map::Handle<Point, vector_map::PointArray> tiled;
+  tiled.registerUpdater(updatePoints);
+  size_t tiled_index = tiled.addIndex([](const Point& point) { return point.ref; });
+  size_t received = 0;
+  tiled.registerCallback([&](const vector_map::PointArray& msg) { received += msg.data.size(); });
+  for (size_t i = chunks.size(); i-- > 0;)
+  {
+    EXPECT_FALSE(tiled.hasTile(chunks[i].first));
+    tiled.receiveTile(chunks[i].first, chunks[i].second);
+    EXPECT_TRUE(tiled.hasTile(chunks[i].first));
+  }
+  EXPECT_EQ(received, points.data.size());
+
+  auto expectSame = [&]() {
+    ASSERT_EQ(tiled.getStorage().size(), full.getStorage().size());
+    for (const auto& point : points.data)
+    {
+      const Point* a = full.findPtrByKey(Key<Point>(point.pid));
+      const Point* b = tiled.findPtrByKey(Key<Point>(point.pid));
+      ASSERT_NE(b, nullptr);
+      EXPECT_EQ(b->bx, a->bx);
+      EXPECT_EQ(b->ref, a->ref);
+    }
+    EXPECT_EQ(collectIndex(tiled, tiled_index), collectIndex(full, full_index));
+    std::vector<int> order;
+    tiled.forEach([](const Point&) { return true; }, [&](const Point& point) { order.push_back(point.pid); });
+    EXPECT_TRUE(std::is_sorted(order.begin(), order.end()));
+  };
+  expectSame();
+
+  // a tile sent again with other items replaces only its own items
+  vector_map::category_t category;
+  TileId tile;
+  vector_map::PointArray array;
+  ASSERT_TRUE(decodeTile(chunks[1].second, category, tile, array));
+  ASSERT_GT(array.data.size(), 1u);
+  int dropped = array.data.back().pid;
+  array.data.pop_back();
+  array.data.front().ref = 3;
+  std_msgs::UInt8MultiArray chunk;
+  vector_map::encodeTileChunk(vector_map::POINT, tile, vector_map::serializeArray(array), false, chunk);
+  tiled.receiveTile(chunks[1].first, chunk);
+
+  for (auto& point : points.data)
+  {
+    if (point.pid == array.data.front().pid)
+      point.ref = 3;
+  }
+  points.data.erase(std::remove_if(points.data.begin(), points.data.end(),
+                                   [&](const Point& point) { return point.pid == dropped; }),
+                    points.data.end());
+  full.receive(points);
+  EXPECT_EQ(tiled.findPtrByKey(Key<Point>(dropped)), nullptr);
+  expectSame();
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
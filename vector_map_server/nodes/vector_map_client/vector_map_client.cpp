@@ -19,10 +19,7 @@
 #include <visualization_msgs/MarkerArray.h>
 #include <vector_map/vector_map.h>
 
-#include "vector_map_server/GetWhiteLine.h"
-#include "vector_map_server/GetStopLine.h"
-#include "vector_map_server/GetCrossWalk.h"
-#include "vector_map_server/GetSignal.h"
+#include "vector_map_server/GetRouteObjects.h"
 
 using vector_map::VectorMap;
 using vector_map::Category;
@@ -95,14 +92,8 @@ int main(int argc, char **argv)
   ros::Subscriber waypoints_sub = nh.subscribe("final_waypoints", 1, &VectorMapClient::setWaypoints, &vmc);
 
   visualization_msgs::MarkerArray marker_array;
-  ros::ServiceClient white_line_cli =
-    nh.serviceClient<vector_map_server::GetWhiteLine>("vector_map_server/get_white_line");
-  ros::ServiceClient stop_line_cli =
-    nh.serviceClient<vector_map_server::GetStopLine>("vector_map_server/get_stop_line");
-  ros::ServiceClient cross_walk_cli =
-    nh.serviceClient<vector_map_server::GetCrossWalk>("vector_map_server/get_cross_walk");
-  ros::ServiceClient signal_cli =
-    nh.serviceClient<vector_map_server::GetSignal>("vector_map_server/get_signal");
+  ros::ServiceClient route_objects_cli =
+    nh.serviceClient<vector_map_server::GetRouteObjects>("vector_map_server/get_route_objects");
   ros::Rate rate(1);
   while (ros::ok())
   {
@@ -111,12 +102,14 @@ int main(int argc, char **argv)
     visualization_msgs::MarkerArray marker_array_buffer;
     int id = 0;
 
-    vector_map_server::GetWhiteLine white_line_srv;
-    white_line_srv.request.pose = vmc.getPose();
-    white_line_srv.request.waypoints = vmc.getWaypoints();
-    if (white_line_cli.call(white_line_srv))
+    vector_map_server::GetRouteObjects route_objects_srv;
+    route_objects_srv.request.pose = vmc.getPose();
+    route_objects_srv.request.waypoints = vmc.getWaypoints();
+    route_objects_srv.request.categories =
+      Category::WHITE_LINE | Category::STOP_LINE | Category::CROSS_WALK | Category::SIGNAL;
+    if (route_objects_cli.call(route_objects_srv))
     {
-      for (const auto& white_line : white_line_srv.response.objects.data)
+      for (const auto& white_line : route_objects_srv.response.white_lines.data)
       {
         if (white_line.lid == 0)
           continue;
@@ -133,14 +126,8 @@ int main(int argc, char **argv)
           marker_array_buffer.markers.push_back(marker);
         }
       }
-    }
 
-    vector_map_server::GetStopLine stop_line_srv;
-    stop_line_srv.request.pose = vmc.getPose();
-    stop_line_srv.request.waypoints = vmc.getWaypoints();
-    if (stop_line_cli.call(stop_line_srv))
-    {
-      for (const auto& stop_line : stop_line_srv.response.objects.data)
+      for (const auto& stop_line : route_objects_srv.response.stop_lines.data)
       {
         if (stop_line.lid == 0)
           continue;
@@ -157,14 +144,8 @@ int main(int argc, char **argv)
           marker_array_buffer.markers.push_back(marker);
         }
       }
-    }
 
-    vector_map_server::GetCrossWalk cross_walk_srv;
-    cross_walk_srv.request.pose = vmc.getPose();
-    cross_walk_srv.request.waypoints = vmc.getWaypoints();
-    if (cross_walk_cli.call(cross_walk_srv))
-    {
-      for (const auto& cross_walk : cross_walk_srv.response.objects.data)
+      for (const auto& cross_walk : route_objects_srv.response.cross_walks.data)
       {
         if (cross_walk.aid == 0)
           continue;
@@ -181,14 +162,8 @@ int main(int argc, char **argv)
           marker_array_buffer.markers.push_back(marker);
         }
       }
-    }
 
-    vector_map_server::GetSignal signal_srv;
-    signal_srv.request.pose = vmc.getPose();
-    signal_srv.request.waypoints = vmc.getWaypoints();
-    if (signal_cli.call(signal_srv))
-    {
-      for (const auto& signal : signal_srv.response.objects.data)
+      for (const auto& signal : route_objects_srv.response.signals.data)
       {
         if (signal.vid == 0)
           continue;
@@ -14,6 +14,9 @@
  * limitations under the License.
  */
 
+#include <ros/callback_queue.h>
+#include <ros/spinner.h>
+#include <boost/function.hpp>
 #include <geometry_msgs/PoseStamped.h>
 #include <autoware_msgs/Lane.h>
 #include <visualization_msgs/MarkerArray.h>
@@ -46,11 +49,21 @@
 #include "vector_map_server/GetFence.h"
 #include "vector_map_server/GetRailCrossing.h"
 #include "vector_map_server/PositionState.h"
-
+#include "vector_map_server/GetRouteObjects.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 using vector_map::VectorMap;
 using vector_map::Category;
+using vector_map::Callback;
 using vector_map::Color;
 using vector_map::Filter;
 using vector_map::Key;
@@ -88,6 +101,14 @@ using vector_map::Wall;
 using vector_map::Fence;
 using vector_map::RailCrossing;
 
+using vector_map::PointArray;
+using vector_map::LineArray;
+using vector_map::AreaArray;
+using vector_map::DTLaneArray;
+using vector_map::NodeArray;
+using vector_map::LaneArray;
+using vector_map::WayAreaArray;
+
 using vector_map::isValidMarker;
 using vector_map::convertPointToGeomPoint;
 using vector_map::convertGeomPointToPoint;
@@ -116,31 +137,37 @@ double computeAngle(const Point& p1, const Point& p2)
   return std::atan2(p2.ly - p1.ly, p2.bx - p1.bx);  // XXX: don't consider z axis
 }
 
-double computeScore(const Point& bp1, const Point& bp2, const Point& p1, const Point& p2, double radius)
+// angle is the direction at p1
+double computeScore(const Point& bp1, const Point& bp2, const Point& p1, double angle, double radius)
 {
   double distance_score = computeDistance(bp1, p1);
   distance_score = 50 * (radius - distance_score) / radius;
-  double angle_score = computeAngle(p1, p2) - computeAngle(bp1, bp2);
+  double angle_score = angle - computeAngle(bp1, bp2);
   angle_score = 50 * (M_PI - std::fabs(angle_score)) / M_PI;
   return distance_score + angle_score;
 }
 
+double computeScore(const Point& bp1, const Point& bp2, const Point& p1, const Point& p2, double radius)
+{
+  return computeScore(bp1, bp2, p1, computeAngle(p1, p2), radius);
+}
+
 Point findStartPoint(const VectorMap& vmap, const Lane& lane)
 {
   Point start_point;
-  Node node = vmap.findByKey(Key<Node>(lane.bnid));
-  if (node.nid == 0)
+  const Node* node = vmap.findPtrByKey(Key<Node>(lane.bnid));
+  if (node == nullptr)
     return start_point;
-  return vmap.findByKey(Key<Point>(node.pid));
+  return vmap.findByKey(Key<Point>(node->pid));
 }
 
 Point findEndPoint(const VectorMap& vmap, const Lane& lane)
 {
   Point end_point;
-  Node node = vmap.findByKey(Key<Node>(lane.fnid));
-  if (node.nid == 0)
+  const Node* node = vmap.findPtrByKey(Key<Node>(lane.fnid));
+  if (node == nullptr)
     return end_point;
-  return vmap.findByKey(Key<Point>(node.pid));
+  return vmap.findByKey(Key<Point>(node->pid));
 }
 
 Point createMedianPoint(const Point& p1, const Point& p2)
@@ -152,37 +179,59 @@ Point createMedianPoint(const Point& p1, const Point& p2)
   return point;
 }
 
-std::vector<Point> findStartPoints(const VectorMap& vmap)
+// What the matching needs of a lane, resolved once per map instead of Lane -> Node -> Point for every candidate
+struct LaneGeometry
+{
+  Lane lane;
+  Point start_point;
+  Point end_point;
+  Point median_point;
+  double heading;  // start to end point
+  double length;  // start to end point, 2D
+  bool branching;
+  bool merging;
+};
+
+// lanes whose start or end point is missing are left out
+class LaneGeometryCache
 {
-  std::vector<Point> start_points;
-  for (const auto& lane : vmap.findByFilter([](const Lane& lane){return true;}))
+private:
+  std::unordered_map<int, LaneGeometry> geometries_;
+
+public:
+  void build(const VectorMap& vmap)
   {
-    Node node = vmap.findByKey(Key<Node>(lane.bnid));
-    if (node.nid == 0)
-      continue;
-    Point point = vmap.findByKey(Key<Point>(node.pid));
-    if (point.pid == 0)
-      continue;
-    start_points.push_back(point);
+    geometries_.clear();
+    for (const auto& lane : vmap.findByFilter([](const Lane& lane) { return true; }))
+    {
+      LaneGeometry geometry;
+      geometry.lane = lane;
+      geometry.start_point = findStartPoint(vmap, lane);
+      geometry.end_point = findEndPoint(vmap, lane);
+      if (geometry.start_point.pid == 0 || geometry.end_point.pid == 0)
+        continue;
+      geometry.median_point = createMedianPoint(geometry.start_point, geometry.end_point);
+      geometry.heading = computeAngle(geometry.start_point, geometry.end_point);
+      geometry.length = computeDistance(geometry.start_point, geometry.end_point);
+      geometry.branching = isBranchingLane(lane);
+      geometry.merging = isMergingLane(lane);
+      geometries_.emplace(lane.lnid, geometry);
+    }
   }
-  return start_points;
-}
 
-std::vector<Point> findEndPoints(const VectorMap& vmap)
-{
-  std::vector<Point> end_points;
-  for (const auto& lane : vmap.findByFilter([](const Lane& lane){return true;}))
+  const LaneGeometry* find(int lnid) const
   {
-    Node node = vmap.findByKey(Key<Node>(lane.fnid));
-    if (node.nid == 0)
-      continue;
-    Point point = vmap.findByKey(Key<Point>(node.pid));
-    if (point.pid == 0)
-      continue;
-    end_points.push_back(point);
+    auto it = geometries_.find(lnid);
+    if (it == geometries_.end())
+      return nullptr;
+    return &it->second;
   }
-  return end_points;
-}
+
+  bool empty() const
+  {
+    return geometries_.empty();
+  }
+};
 
 Point findNearestPoint(const std::vector<Point>& points, const Point& base_point)
 {
@@ -200,40 +249,8 @@ Point findNearestPoint(const std::vector<Point>& points, const Point& base_point
   return nearest_point;
 }
 
-std::vector<Point> findNearPoints(const std::vector<Point>& points, const Point& base_point, double radius)
-{
-  std::vector<Point> near_points;
-  for (const auto& point : points)
-  {
-    if (computeDistance(base_point, point) <= radius)
-      near_points.push_back(point);
-  }
-  return near_points;
-}
-
-std::vector<Lane> findLanesByStartPoint(const VectorMap& vmap, const Point& start_point)
-{
-  std::vector<Lane> lanes;
-  for (const auto& node : vmap.findByFilter([&start_point](const Node& node){return node.pid == start_point.pid;}))
-  {
-    for (const auto& lane : vmap.findByFilter([&node](const Lane& lane){return lane.bnid == node.nid;}))
-      lanes.push_back(lane);
-  }
-  return lanes;
-}
-
-std::vector<Lane> findLanesByEndPoint(const VectorMap& vmap, const Point& end_point)
-{
-  std::vector<Lane> lanes;
-  for (const auto& node : vmap.findByFilter([&end_point](const Node& node){return node.pid == end_point.pid;}))
-  {
-    for (const auto& lane : vmap.findByFilter([&node](const Lane& lane){return lane.fnid == node.nid;}))
-      lanes.push_back(lane);
-  }
-  return lanes;
-}
-
-Lane findStartLane(const VectorMap& vmap, const std::vector<Point>& points, double radius)
+Lane findStartLane(const VectorMap& vmap, const LaneGeometryCache& geometries, const std::vector<Point>& points,
+                   double radius)
 {
   Lane start_lane;
   if (points.size() < 2)
@@ -242,27 +259,24 @@ Lane findStartLane(const VectorMap& vmap, const std::vector<Point>& points, doub
   Point bp1 = points[0];
   Point bp2 = points[1];
   double max_score = -DBL_MAX;
-  for (const auto& p1 : findNearPoints(findStartPoints(vmap), bp1, radius))
+  // a lane whose start point is within radius has its whole segment within radius too
+  for (const auto& lane : vmap.findLanesWithinRadius(bp1, radius))
   {
-    for (const auto& lane : findLanesByStartPoint(vmap, p1))
+    const LaneGeometry* geometry = geometries.find(lane.lnid);
+    if (geometry == nullptr || computeDistance(bp1, geometry->start_point) > radius)
+      continue;
+    double score = computeScore(bp1, bp2, geometry->start_point, geometry->heading, radius);
+    if (score >= max_score)
     {
-      if (lane.lnid == 0)
-        continue;
-      Point p2 = findEndPoint(vmap, lane);
-      if (p2.pid == 0)
-        continue;
-      double score = computeScore(bp1, bp2, p1, p2, radius);
-      if (score >= max_score)
-      {
-        start_lane = lane;
-        max_score = score;
-      }
+      start_lane = geometry->lane;
+      max_score = score;
     }
   }
   return start_lane;
 }
 
-Lane findEndLane(const VectorMap& vmap, const std::vector<Point>& points, double radius)
+Lane findEndLane(const VectorMap& vmap, const LaneGeometryCache& geometries, const std::vector<Point>& points,
+                 double radius)
 {
   Lane end_lane;
   if (points.size() < 2)
@@ -271,40 +285,31 @@ Lane findEndLane(const VectorMap& vmap, const std::vector<Point>& points, double
   Point bp1 = points[points.size() - 2];
   Point bp2 = points[points.size() - 1];
   double max_score = -DBL_MAX;
-  for (const auto& p2 : findNearPoints(findEndPoints(vmap), bp2, radius))
+  for (const auto& lane : vmap.findLanesWithinRadius(bp2, radius))
   {
-    for (const auto& lane : findLanesByEndPoint(vmap, p2))
+    const LaneGeometry* geometry = geometries.find(lane.lnid);
+    if (geometry == nullptr || computeDistance(bp2, geometry->end_point) > radius)
+      continue;
+    double score = computeScore(bp2, bp1, geometry->end_point, geometry->start_point, radius);
+    if (score >= max_score)
     {
-      if (lane.lnid == 0)
-        continue;
-      Point p1 = findStartPoint(vmap, lane);
-      if (p1.pid == 0)
-        continue;
-      double score = computeScore(bp2, bp1, p2, p1, radius);
-      if (score >= max_score)
-      {
-        end_lane = lane;
-        max_score = score;
-      }
+      end_lane = geometry->lane;
+      max_score = score;
     }
   }
   return end_lane;
 }
 
-Lane findNearestLane(const VectorMap& vmap, const std::vector<Lane>& lanes, const Point& base_point)
+Lane findNearestLane(const LaneGeometryCache& geometries, const std::vector<Lane>& lanes, const Point& base_point)
 {
   Lane nearest_lane;
   double min_distance = DBL_MAX;
   for (const auto& lane : lanes)
   {
-    Point start_point = findStartPoint(vmap, lane);
-    if (start_point.pid == 0)
-      continue;
-    Point end_point = findEndPoint(vmap, lane);
-    if (end_point.pid == 0)
+    const LaneGeometry* geometry = geometries.find(lane.lnid);
+    if (geometry == nullptr)
       continue;
-    Point median_point = createMedianPoint(start_point, end_point);
-    double distance = computeDistance(base_point, median_point);
+    double distance = computeDistance(base_point, geometry->median_point);
     if (distance <= min_distance)
     {
       nearest_lane = lane;
@@ -314,27 +319,23 @@ Lane findNearestLane(const VectorMap& vmap, const std::vector<Lane>& lanes, cons
   return nearest_lane;
 }
 
-std::vector<Lane> findNearLanes(const VectorMap& vmap, const std::vector<Lane>& lanes, const Point& base_point,
-                                double radius)
+std::vector<Lane> findNearLanes(const LaneGeometryCache& geometries, const std::vector<Lane>& lanes,
+                                const Point& base_point, double radius)
 {
   std::vector<Lane> near_lanes;
   for (const auto& lane : lanes)
   {
-    Point start_point = findStartPoint(vmap, lane);
-    if (start_point.pid == 0)
+    const LaneGeometry* geometry = geometries.find(lane.lnid);
+    if (geometry == nullptr)
       continue;
-    Point end_point = findEndPoint(vmap, lane);
-    if (end_point.pid == 0)
-      continue;
-    Point median_point = createMedianPoint(start_point, end_point);
-    if (computeDistance(base_point, median_point) <= radius)
+    if (computeDistance(base_point, geometry->median_point) <= radius)
       near_lanes.push_back(lane);
   }
   return near_lanes;
 }
 
-std::vector<Lane> createFineLanes(const VectorMap& vmap, const autoware_msgs::Lane& waypoints, double radius,
-                                  int loops)
+std::vector<Lane> createFineLanes(const VectorMap& vmap, const LaneGeometryCache& geometries,
+                                  const autoware_msgs::Lane& waypoints, double radius, int loops)
 {
   std::vector<Lane> null_lanes;
 
@@ -342,11 +343,11 @@ std::vector<Lane> createFineLanes(const VectorMap& vmap, const autoware_msgs::La
   for (const auto& waypoint : waypoints.waypoints)
     coarse_points.push_back(convertGeomPointToPoint(waypoint.pose.pose.position));
 
-  Lane start_lane = findStartLane(vmap, coarse_points, radius);
+  Lane start_lane = findStartLane(vmap, geometries, coarse_points, radius);
   if (start_lane.lnid == 0)
     return null_lanes;
 
-  Lane end_lane = findEndLane(vmap, coarse_points, radius);
+  Lane end_lane = findEndLane(vmap, geometries, coarse_points, radius);
   if (end_lane.lnid == 0)
     return null_lanes;
 
@@ -358,11 +359,10 @@ std::vector<Lane> createFineLanes(const VectorMap& vmap, const autoware_msgs::La
     if (current_lane.lnid == end_lane.lnid)
       return fine_lanes;
 
-    if (isBranchingLane(current_lane))
+    const LaneGeometry* current_geometry = geometries.find(current_lane.lnid);
+    if (current_geometry != nullptr && current_geometry->branching)
     {
-      Point fine_p1 = findEndPoint(vmap, current_lane);
-      if (fine_p1.pid == 0)
-        return null_lanes;
+      Point fine_p1 = current_geometry->end_point;
 
       Point coarse_p1 = findNearestPoint(coarse_points, fine_p1);  // certainly succeed
 
@@ -387,41 +387,44 @@ std::vector<Lane> createFineLanes(const VectorMap& vmap, const autoware_msgs::La
       if (distance <= 0)
         return null_lanes;
 
+      // the following lanes in id order, as a scan of the lanes would visit them
+      std::vector<int> next_lnids = { current_lane.flid, current_lane.flid2, current_lane.flid3, current_lane.flid4 };
+      std::sort(next_lnids.begin(), next_lnids.end());
+      next_lnids.erase(std::unique(next_lnids.begin(), next_lnids.end()), next_lnids.end());
+
       double max_score = -DBL_MAX;
-      Filter<Lane> is_next_lane = [&current_lane](const Lane& lane)
-        {
-          return lane.lnid == current_lane.flid || lane.lnid == current_lane.flid2 ||
-                 lane.lnid == current_lane.flid3 || lane.lnid == current_lane.flid4;
-        };
-      for (const auto& lane : vmap.findByFilter(is_next_lane))
+      for (int next_lnid : next_lnids)
       {
-        Lane next_lane = lane;
-        Point next_point = findEndPoint(vmap, next_lane);
-        if (next_point.pid == 0)
+        const LaneGeometry* next_geometry = geometries.find(next_lnid);
+        if (next_geometry == nullptr)
           continue;
-        Point fine_p2 = next_point;
-        while (computeDistance(fine_p2, fine_p1) <= radius && !isBranchingLane(next_lane) && next_lane.flid != 0)
+        Point fine_p2 = next_geometry->end_point;
+        const LaneGeometry* geometry = next_geometry;
+        while (computeDistance(fine_p2, fine_p1) <= radius && !geometry->branching && geometry->lane.flid != 0)
         {
-          next_lane = vmap.findByKey(Key<Lane>(next_lane.flid));;
-          if (next_lane.lnid == 0)
-            break;
-          next_point = findEndPoint(vmap, next_lane);
-          if (next_point.pid == 0)
+          geometry = geometries.find(geometry->lane.flid);
+          if (geometry == nullptr)
             break;
-          fine_p2 = next_point;
+          fine_p2 = geometry->end_point;
         }
         double score = computeScore(fine_p1, fine_p2, coarse_p1, coarse_p2, radius);
         if (score >= max_score)
         {
-          current_lane = lane;
+          current_lane = next_geometry->lane;
           max_score = score;
         }
       }
       if (max_score == -DBL_MAX)
         return null_lanes;
     }
+    else if (current_geometry == nullptr && isBranchingLane(current_lane))
+    {
+      return null_lanes;
+    }
     else
-      current_lane = vmap.findByKey(Key<Lane>(current_lane.flid));;
+    {
+      current_lane = vmap.findByKey(Key<Lane>(current_lane.flid));
+    }
     if (current_lane.lnid == 0)
       return null_lanes;
   }
@@ -477,62 +480,286 @@ Polygon createPolygon(const VectorMap& vmap, const Area& area)
   return polygon;
 }
 
-bool isWinding(const Polygon& polygon, const geometry_msgs::Point& geom_point, size_t i)
+// Polygon with its bounding box and edge table, the edges are bucketed in horizontal bands of the box so the winding
+// number of a point (Winding Number Algorithm) only visits the edges crossing its band
+class PreparedPolygon
 {
-  double variation_x = polygon[i + 1].x - polygon[i].x;
-  variation_x *= (geom_point.y - polygon[i].y) / (polygon[i + 1].y - polygon[i].y);
-  return geom_point.x < polygon[i].x + variation_x;
-}
+private:
+  struct Edge
+  {
+    double x;
+    double y;
+    double dx;
+    double dy;
+  };
+
+  std::vector<Edge> edges_;
+  std::vector<uint32_t> band_offsets_;  // edges of band i are band_edges_[band_offsets_[i], band_offsets_[i + 1])
+  std::vector<uint32_t> band_edges_;
+  int bands_ = 0;
+  double band_height_ = 1;
+
+  int getBand(double y) const
+  {
+    int band = static_cast<int>((y - min_y) / band_height_);
+    return std::min(std::max(band, 0), bands_ - 1);
+  }
 
-bool isInPolygon(const Polygon& polygon, const geometry_msgs::Point& geom_point)
+public:
+  double min_x = DBL_MAX;
+  double min_y = DBL_MAX;
+  double max_x = -DBL_MAX;
+  double max_y = -DBL_MAX;
+
+  explicit PreparedPolygon(const Polygon& polygon)
+  {
+    if (!isValidPolygon(polygon))
+      return;
+    for (const auto& point : polygon)
+    {
+      min_x = std::min(min_x, point.x);
+      min_y = std::min(min_y, point.y);
+      max_x = std::max(max_x, point.x);
+      max_y = std::max(max_y, point.y);
+    }
+    for (size_t i = 0; i < polygon.size() - 1; ++i)
+    {
+      // horizontal edges never change the winding number
+      if (polygon[i].y == polygon[i + 1].y)
+        continue;
+      edges_.push_back(
+          { polygon[i].x, polygon[i].y, polygon[i + 1].x - polygon[i].x, polygon[i + 1].y - polygon[i].y });
+    }
+
+    bands_ = std::max(1, std::min(static_cast<int>(edges_.size()), 64));
+    if (max_y > min_y)
+      band_height_ = (max_y - min_y) / bands_;
+    std::vector<std::vector<uint32_t>> band_lists(bands_);
+    for (size_t i = 0; i < edges_.size(); ++i)
+    {
+      const Edge& edge = edges_[i];
+      int last = getBand(std::max(edge.y, edge.y + edge.dy));
+      for (int band = getBand(std::min(edge.y, edge.y + edge.dy)); band <= last; ++band)
+        band_lists[band].push_back(static_cast<uint32_t>(i));
+    }
+    band_offsets_.push_back(0);
+    for (const auto& band_list : band_lists)
+    {
+      band_edges_.insert(band_edges_.end(), band_list.begin(), band_list.end());
+      band_offsets_.push_back(static_cast<uint32_t>(band_edges_.size()));
+    }
+  }
+
+  bool contains(const geometry_msgs::Point& geom_point) const
+  {
+    if (band_offsets_.empty() || geom_point.x < min_x || geom_point.x > max_x || geom_point.y < min_y ||
+        geom_point.y > max_y)
+      return false;
+
+    int winding_number = 0;
+    int band = getBand(geom_point.y);
+    for (uint32_t i = band_offsets_[band]; i < band_offsets_[band + 1]; ++i)
+    {
+      const Edge& edge = edges_[band_edges_[i]];
+      bool upward = edge.y <= geom_point.y && edge.y + edge.dy > geom_point.y;
+      bool downward = edge.y > geom_point.y && edge.y + edge.dy <= geom_point.y;
+      if (!upward && !downward)
+        continue;
+      if (geom_point.x < edge.x + edge.dx * ((geom_point.y - edge.y) / edge.dy))
+        winding_number += upward ? 1 : -1;
+    }
+    return winding_number != 0;
+  }
+};
+
+// Polygons of the way areas built once per map, a grid over their bounding boxes gives the candidates of a point
+class WayAreaPolygons
 {
-  if (!isValidPolygon(polygon))
-    return false;
+private:
+  std::vector<PreparedPolygon> polygons_;
+  vector_map::GridIndex grid_;
 
-  // Winding Number Algorithm
-  int winding_number = 0;
-  for (size_t i = 0; i < polygon.size() - 1; ++i)
+public:
+  void build(const VectorMap& vmap, double cell_size)
   {
-    if (polygon[i].y <= geom_point.y && polygon[i + 1].y > geom_point.y)
+    polygons_.clear();
+    grid_.clear(cell_size);
+    for (const auto& way_area : vmap.findByFilter([](const WayArea& way_area){return true;}))
     {
-      if (isWinding(polygon, geom_point, i))
-        ++winding_number;
+      Area area = vmap.findByKey(Key<Area>(way_area.aid));
+      if (area.aid == 0)
+        continue;
+      PreparedPolygon polygon(createPolygon(vmap, area));
+      if (polygon.min_x > polygon.max_x)
+        continue;
+      grid_.insert(static_cast<int>(polygons_.size()), polygon.min_x, polygon.min_y, polygon.max_x, polygon.max_y);
+      polygons_.push_back(polygon);
     }
-    else if (polygon[i].y > geom_point.y && polygon[i + 1].y <= geom_point.y)
+    grid_.build();
+  }
+
+  bool contains(const geometry_msgs::Point& geom_point) const
+  {
+    std::vector<int> candidates;
+    grid_.findInBox(geom_point.x, geom_point.y, geom_point.x, geom_point.y, candidates);
+    for (int i : candidates)
     {
-      if (isWinding(polygon, geom_point, i))
-        --winding_number;
+      if (polygons_[i].contains(geom_point))
+        return true;
     }
+    return false;
   }
+};
 
-  return winding_number != 0;
+uint64_t hashWaypoints(const autoware_msgs::Lane& waypoints)
+{
+  // FNV-1a over the positions, clients often leave the header stamp at zero
+  uint64_t hash = 14695981039346656037ULL;
+  auto combine = [&hash](double value) {
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    hash = (hash ^ bits) * 1099511628211ULL;
+  };
+  for (const auto& waypoint : waypoints.waypoints)
+  {
+    combine(waypoint.pose.pose.position.x);
+    combine(waypoint.pose.pose.position.y);
+    combine(waypoint.pose.pose.position.z);
+  }
+  return hash;
 }
 
+struct TravelingRoute
+{
+  int64_t x;  // pose rounded to the cache resolution
+  int64_t y;
+  int64_t z;
+  uint64_t waypoints_hash;
+  uint64_t last_used;
+  std::vector<Lane> lanes;
+};
+
+// Calls and durations of a service since the last report
+struct ServiceLatency
+{
+  std::mutex mutex;
+  uint64_t count = 0;
+  double total_ms = 0;
+  double max_ms = 0;
+};
+
 class VectorMapServer
 {
 private:
+  // The services run on the threads of service_queue_ under a shared lock of map_mutex_, the map messages are handled
+  // under an exclusive lock, so the map and what is derived from it do not change during a request
+  std::shared_timed_mutex map_mutex_;
+  ros::CallbackQueue service_queue_;
+  std::map<std::string, ServiceLatency> latencies_;  // filled before the services are served
+
+  std::mutex cache_mutex_;  // route_cache_ and its counters
+  std::mutex derived_mutex_;  // rebuild of lane_geometries_ and way_areas_
+  std::mutex marker_mutex_;  // marker_array_
+
   VectorMap vmap_;
+  LaneGeometryCache lane_geometries_;
+  bool lane_geometries_dirty_ = true;  // rebuilt before the next route once the points, nodes or lanes change
+  WayAreaPolygons way_areas_;
+  bool way_areas_dirty_ = true;  // rebuilt before the next query once the points, lines, areas or way areas change
+  double way_area_cell_size_;
   double radius_;
   int loops_;
 
+  // Clients ask for several categories with the same pose and waypoints in one cycle,
+  // the last cache_size_ routes are kept until the points, nodes or lanes change
+  int cache_size_;
+  double cache_resolution_;
+  std::vector<TravelingRoute> route_cache_;
+  uint64_t cache_tick_ = 0;
+  uint64_t cache_hits_ = 0;
+  uint64_t cache_misses_ = 0;
+
   bool debug_;
   visualization_msgs::MarkerArray marker_array_;
   ros::Publisher marker_array_pub_;
 
+  void clearRouteCache()
+  {
+    route_cache_.clear();
+    lane_geometries_dirty_ = true;
+    way_areas_dirty_ = true;
+  }
+
   std::vector<Lane> createTravelingRoute(const geometry_msgs::PoseStamped& pose,
                                          const autoware_msgs::Lane& waypoints)
+  {
+    if (cache_size_ <= 0)
+      return computeTravelingRoute(pose, waypoints);
+
+    TravelingRoute route;
+    route.x = std::llround(pose.pose.position.x / cache_resolution_);
+    route.y = std::llround(pose.pose.position.y / cache_resolution_);
+    route.z = std::llround(pose.pose.position.z / cache_resolution_);
+    route.waypoints_hash = hashWaypoints(waypoints);
+    {
+      std::lock_guard<std::mutex> lock(cache_mutex_);
+      route.last_used = ++cache_tick_;
+      for (auto& cached_route : route_cache_)
+      {
+        if (cached_route.x == route.x && cached_route.y == route.y && cached_route.z == route.z &&
+            cached_route.waypoints_hash == route.waypoints_hash)
+        {
+          cached_route.last_used = route.last_used;
+          ++cache_hits_;
+          ROS_DEBUG_THROTTLE(10, "traveling route cache: %lu hits, %lu misses", cache_hits_, cache_misses_);
+          return cached_route.lanes;
+        }
+      }
+      ++cache_misses_;
+      ROS_DEBUG_THROTTLE(10, "traveling route cache: %lu hits, %lu misses", cache_hits_, cache_misses_);
+    }
+
+    // computed without the lock, concurrent requests for other routes do not wait for this one
+    route.lanes = computeTravelingRoute(pose, waypoints);
+    std::lock_guard<std::mutex> lock(cache_mutex_);
+    if (route_cache_.size() < static_cast<size_t>(cache_size_))
+    {
+      route_cache_.push_back(route);
+    }
+    else
+    {
+      auto oldest_route = std::min_element(route_cache_.begin(), route_cache_.end(),
+                                           [](const TravelingRoute& a, const TravelingRoute& b) {
+                                             return a.last_used < b.last_used;
+                                           });
+      *oldest_route = route;
+    }
+    return route.lanes;
+  }
+
+  std::vector<Lane> computeTravelingRoute(const geometry_msgs::PoseStamped& pose,
+                                          const autoware_msgs::Lane& waypoints)
   {
     std::vector<Lane> null_lanes;
 
+    {
+      std::lock_guard<std::mutex> lock(derived_mutex_);
+      if (lane_geometries_dirty_)
+      {
+        lane_geometries_.build(vmap_);
+        lane_geometries_dirty_ = false;
+      }
+    }
+
     std::vector<Lane> fine_lanes;
     if (waypoints.waypoints.empty())
       fine_lanes = vmap_.findByFilter([](const Lane& lane){return true;});
     else
-      fine_lanes = createFineLanes(vmap_, waypoints, radius_, loops_);
+      fine_lanes = createFineLanes(vmap_, lane_geometries_, waypoints, radius_, loops_);
     if (fine_lanes.empty())
       return null_lanes;
 
-    Lane nearest_lane = findNearestLane(vmap_, fine_lanes, convertGeomPointToPoint(pose.pose.position));
+    Lane nearest_lane = findNearestLane(lane_geometries_, fine_lanes, convertGeomPointToPoint(pose.pose.position));
     if (nearest_lane.lnid == 0)
       return null_lanes;
 
@@ -553,24 +780,21 @@ private:
 
     if (debug_)
     {
+      std::lock_guard<std::mutex> lock(marker_mutex_);
       visualization_msgs::MarkerArray marker_array_buffer;
       int id = 0;
       for (const auto& lane : traveling_route)
       {
-        Point start_point = findStartPoint(vmap_, lane);
-        if (start_point.pid != 0)
-        {
-          visualization_msgs::Marker marker = createPointMarker("traveling_route", id++, Color::YELLOW, start_point);
-          if (isValidMarker(marker))
-            marker_array_buffer.markers.push_back(marker);
-        }
-        Point end_point = findEndPoint(vmap_, lane);
-        if (end_point.pid != 0)
-        {
-          visualization_msgs::Marker marker = createPointMarker("traveling_route", id++, Color::YELLOW, end_point);
-          if (isValidMarker(marker))
-            marker_array_buffer.markers.push_back(marker);
-        }
+        const LaneGeometry* geometry = lane_geometries_.find(lane.lnid);
+        if (geometry == nullptr)
+          continue;
+        visualization_msgs::Marker marker =
+            createPointMarker("traveling_route", id++, Color::YELLOW, geometry->start_point);
+        if (isValidMarker(marker))
+          marker_array_buffer.markers.push_back(marker);
+        marker = createPointMarker("traveling_route", id++, Color::YELLOW, geometry->end_point);
+        if (isValidMarker(marker))
+          marker_array_buffer.markers.push_back(marker);
       }
       if (!marker_array_.markers.empty())
       {
@@ -585,12 +809,92 @@ private:
     return traveling_route;
   }
 
+  bool findDTLanes(const std::vector<Lane>& traveling_route, DTLaneArray& objects) const
+  {
+    objects.header.frame_id = "map";
+    for (const auto& lane : traveling_route)
+    {
+      DTLane dtlane = vmap_.findByKey(Key<DTLane>(lane.did));
+      if (dtlane.did == 0)
+        return false;
+      objects.data.push_back(dtlane);
+    }
+    return true;
+  }
+
+  bool findNodes(const std::vector<Lane>& traveling_route, NodeArray& objects) const
+  {
+    objects.header.frame_id = "map";
+    for (const auto& lane : traveling_route)
+    {
+      Node node = vmap_.findByKey(Key<Node>(lane.bnid));
+      if (node.nid == 0)
+        return false;
+      objects.data.push_back(node);
+    }
+    Lane end_lane = traveling_route[traveling_route.size() - 1];
+    Node end_node = vmap_.findByKey(Key<Node>(end_lane.fnid));
+    if (end_node.nid == 0)
+      return false;
+    objects.data.push_back(end_node);
+    return true;
+  }
+
+  void findLanes(const std::vector<Lane>& traveling_route, LaneArray& objects) const
+  {
+    objects.header.frame_id = "map";
+    for (const auto& lane : traveling_route)
+      objects.data.push_back(lane);
+  }
+
+  bool findWayAreas(const std::vector<Lane>& traveling_route, WayAreaArray& objects) const
+  {
+    objects.header.frame_id = "map";
+    for (const auto& lane : traveling_route)
+    {
+      WayArea way_area = vmap_.findByKey(Key<WayArea>(lane.linkwaid));
+      if (way_area.waid == 0)
+        return false;
+      objects.data.push_back(way_area);
+    }
+    return true;
+  }
+
+  // objects of the categories joined to the lanes with linkid
+  template <class U>
+  void findLinkedObjects(const std::vector<Lane>& traveling_route, U& objects) const
+  {
+    using T = typename U::_data_type::value_type;
+    objects.header.frame_id = "map";
+    for (const auto& lane : traveling_route)
+      vmap_.forEachLinkedTo(lane, Callback<T>([&objects](const T& object) { objects.data.push_back(object); }));
+  }
+
 public:
   explicit VectorMapServer(ros::NodeHandle& nh)
   {
+    vmap_.enableSpatialIndex();
+    vmap_.registerCallback([this](const PointArray& msg) { clearRouteCache(); });
+    vmap_.registerCallback([this](const NodeArray& msg) { clearRouteCache(); });
+    vmap_.registerCallback([this](const LaneArray& msg) { clearRouteCache(); });
+    vmap_.registerCallback([this](const LineArray& msg) { way_areas_dirty_ = true; });
+    vmap_.registerCallback([this](const AreaArray& msg) { way_areas_dirty_ = true; });
+    vmap_.registerCallback([this](const WayAreaArray& msg) { way_areas_dirty_ = true; });
+    // the services answer from the snapshot until the map messages replace it
+    std::string snapshot_file;
+    nh.param<std::string>("vector_map_server/snapshot_file", snapshot_file, "");
+    if (!snapshot_file.empty() && !vmap_.loadSnapshot(snapshot_file))
+      ROS_WARN_STREAM("failed to load vector map snapshot " << snapshot_file);
     vmap_.subscribe(nh, Category::ALL, ros::Duration(0));
     nh.param<double>("vector_map_server/radius", radius_, 10);
     nh.param<int>("vector_map_server/loops", loops_, 10000);
+    nh.param<int>("vector_map_server/cache_size", cache_size_, 8);
+    nh.param<double>("vector_map_server/cache_resolution", cache_resolution_, 0.01);
+    if (cache_resolution_ <= 0)
+      cache_resolution_ = 0.01;
+    nh.param<double>("vector_map_server/way_area_cell_size", way_area_cell_size_, 20);
+    if (way_area_cell_size_ <= 0)
+      way_area_cell_size_ = 20;
     nh.param<bool>("vector_map_server/debug", debug_, false);
     if (debug_)
       marker_array_pub_ = nh.advertise<visualization_msgs::MarkerArray>("vector_map_server", 10, true);
@@ -602,15 +906,7 @@ public:
     std::vector<Lane> traveling_route = createTravelingRoute(request.pose, request.waypoints);
     if (traveling_route.empty())
       return false;
-    response.objects.header.frame_id = "map";
-    for (const auto& lane : traveling_route)
-    {
-      DTLane dtlane = vmap_.findByKey(Key<DTLane>(lane.did));
-      if (dtlane.did == 0)
-        return false;
-      response.objects.data.push_back(dtlane);
-    }
-    return true;
+    return findDTLanes(traveling_route, response.objects);
   }
 
   bool getNode(vector_map_server::GetNode::Request& request,
@@ -619,20 +915,7 @@ public:
     std::vector<Lane> traveling_route = createTravelingRoute(request.pose, request.waypoints);
     if (traveling_route.empty())
       return false;
-    response.objects.header.frame_id = "map";
-    for (const auto& lane : traveling_route)
-    {
-      Node node = vmap_.findByKey(Key<Node>(lane.bnid));
-      if (node.nid == 0)
-        return false;
-      response.objects.data.push_back(node);
-    }
-    Lane end_lane = traveling_route[traveling_route.size() - 1];
-    Node end_node = vmap_.findByKey(Key<Node>(end_lane.fnid));
-    if (end_node.nid == 0)
-      return false;
-    response.objects.data.push_back(end_node);
-    return true;
+    return findNodes(traveling_route, response.objects);
   }
 
   bool getLane(vector_map_server::GetLane::Request& request,
@@ -641,9 +924,7 @@ public:
     std::vector<Lane> traveling_route = createTravelingRoute(request.pose, request.waypoints);
     if (traveling_route.empty())
       return false;
-    response.objects.header.frame_id = "map";
-    for (const auto& lane : traveling_route)
-      response.objects.data.push_back(lane);
+    findLanes(traveling_route, response.objects);
     return true;
   }
 
@@ -653,15 +934,7 @@ public:
     std::vector<Lane> traveling_route = createTravelingRoute(request.pose, request.waypoints);
     if (traveling_route.empty())
       return false;
-    response.objects.header.frame_id = "map";
-    for (const auto& lane : traveling_route)
-    {
-      WayArea way_area = vmap_.findByKey(Key<WayArea>(lane.linkwaid));
-      if (way_area.waid == 0)
-        return false;
-      response.objects.data.push_back(way_area);
-    }
-    return true;
+    return findWayAreas(traveling_route, response.objects);
   }
 
   bool getRoadEdge(vector_map_server::GetRoadEdge::Request& request,
@@ -670,13 +943,7 @@ public:
     std::vector<Lane> traveling_route = createTravelingRoute(request.pose, request.waypoints);
     if (traveling_route.empty())
       return false;
-    response.objects.header.frame_id = "map";
-    for (const auto& lane : traveling_route)
-    {
-      for (const auto& road_edge : vmap_.findByFilter(
-           [&lane](const RoadEdge& road_edge){return road_edge.linkid == lane.lnid;}))
-        response.objects.data.push_back(road_edge);
-    }
+    findLinkedObjects(traveling_route, response.objects);
     return true;
   }
 
@@ -686,13 +953,7 @@ public:
     std::vector<Lane> traveling_route = createTravelingRoute(request.pose, request.waypoints);
     if (traveling_route.empty())
       return false;
-    response.objects.header.frame_id = "map";
-    for (const auto& lane : traveling_route)
-    {
-      for (const auto& gutter : vmap_.findByFilter(
-           [&lane](const Gutter& gutter){return gutter.linkid == lane.lnid;}))
-        response.objects.data.push_back(gutter);
-    }
+    findLinkedObjects(traveling_route, response.objects);
     return true;
   }
 
@@ -702,13 +963,7 @@ public:
     std::vector<Lane> traveling_route = createTravelingRoute(request.pose, request.waypoints);
     if (traveling_route.empty())
       return false;
-    response.objects.header.frame_id = "map";
-    for (const auto& lane : traveling_route)
-    {
-      for (const auto& curb : vmap_.findByFilter(
-           [&lane](const Curb& curb){return curb.linkid == lane.lnid;}))
-        response.objects.data.push_back(curb);
-    }
+    findLinkedObjects(traveling_route, response.objects);
     return true;
   }
 
@@ -718,13 +973,7 @@ public:
     std::vector<Lane> traveling_route = createTravelingRoute(request.pose, request.waypoints);
     if (traveling_route.empty())
       return false;
-    response.objects.header.frame_id = "map";
-    for (const auto& lane : traveling_route)
-    {
-      for (const auto& white_line : vmap_.findByFilter(
-           [&lane](const WhiteLine& white_line){return white_line.linkid == lane.lnid;}))
-        response.objects.data.push_back(white_line);
-    }
+    findLinkedObjects(traveling_route, response.objects);
     return true;
   }
 
@@ -734,13 +983,7 @@ public:
     std::vector<Lane> traveling_route = createTravelingRoute(request.pose, request.waypoints);
     if (traveling_route.empty())
       return false;
-    response.objects.header.frame_id = "map";
-    for (const auto& lane : traveling_route)
-    {
-      for (const auto& stop_line : vmap_.findByFilter(
-           [&lane](const StopLine& stop_line){return stop_line.linkid == lane.lnid;}))
-        response.objects.data.push_back(stop_line);
-    }
+    findLinkedObjects(traveling_route, response.objects);
     return true;
   }
 
@@ -750,13 +993,7 @@ public:
     std::vector<Lane> traveling_route = createTravelingRoute(request.pose, request.waypoints);
     if (traveling_route.empty())
       return false;
-    response.objects.header.frame_id = "map";
-    for (const auto& lane : traveling_route)
-    {
-      for (const auto& zebra_zone : vmap_.findByFilter(
-           [&lane](const ZebraZone& zebra_zone){return zebra_zone.linkid == lane.lnid;}))
-        response.objects.data.push_back(zebra_zone);
-    }
+    findLinkedObjects(traveling_route, response.objects);
     return true;
   }
 
@@ -766,13 +1003,7 @@ public:
     std::vector<Lane> traveling_route = createTravelingRoute(request.pose, request.waypoints);
     if (traveling_route.empty())
       return false;
-    response.objects.header.frame_id = "map";
-    for (const auto& lane : traveling_route)
-    {
-      for (const auto& cross_walk : vmap_.findByFilter(
-           [&lane](const CrossWalk& cross_walk){return cross_walk.linkid == lane.lnid;}))
-        response.objects.data.push_back(cross_walk);
-    }
+    findLinkedObjects(traveling_route, response.objects);
     return true;
   }
 
@@ -782,13 +1013,7 @@ public:
     std::vector<Lane> traveling_route = createTravelingRoute(request.pose, request.waypoints);
     if (traveling_route.empty())
       return false;
-    response.objects.header.frame_id = "map";
-    for (const auto& lane : traveling_route)
-    {
-      for (const auto& road_mark : vmap_.findByFilter(
-           [&lane](const RoadMark& road_mark){return road_mark.linkid == lane.lnid;}))
-        response.objects.data.push_back(road_mark);
-    }
+    findLinkedObjects(traveling_route, response.objects);
     return true;
   }
 
@@ -798,13 +1023,7 @@ public:
     std::vector<Lane> traveling_route = createTravelingRoute(request.pose, request.waypoints);
     if (traveling_route.empty())
       return false;
-    response.objects.header.frame_id = "map";
-    for (const auto& lane : traveling_route)
-    {
-      for (const auto& road_pole : vmap_.findByFilter(
-           [&lane](const RoadPole& road_pole){return road_pole.linkid == lane.lnid;}))
-        response.objects.data.push_back(road_pole);
-    }
+    findLinkedObjects(traveling_route, response.objects);
     return true;
   }
 
@@ -814,13 +1033,7 @@ public:
     std::vector<Lane> traveling_route = createTravelingRoute(request.pose, request.waypoints);
     if (traveling_route.empty())
       return false;
-    response.objects.header.frame_id = "map";
-    for (const auto& lane : traveling_route)
-    {
-      for (const auto& road_sign : vmap_.findByFilter(
-           [&lane](const RoadSign& road_sign){return road_sign.linkid == lane.lnid;}))
-        response.objects.data.push_back(road_sign);
-    }
+    findLinkedObjects(traveling_route, response.objects);
     return true;
   }
 
@@ -830,13 +1043,7 @@ public:
     std::vector<Lane> traveling_route = createTravelingRoute(request.pose, request.waypoints);
     if (traveling_route.empty())
       return false;
-    response.objects.header.frame_id = "map";
-    for (const auto& lane : traveling_route)
-    {
-      for (const auto& signal : vmap_.findByFilter(
-           [&lane](const Signal& signal){return signal.linkid == lane.lnid;}))
-        response.objects.data.push_back(signal);
-    }
+    findLinkedObjects(traveling_route, response.objects);
     return true;
   }
 
@@ -846,13 +1053,7 @@ public:
     std::vector<Lane> traveling_route = createTravelingRoute(request.pose, request.waypoints);
     if (traveling_route.empty())
       return false;
-    response.objects.header.frame_id = "map";
-    for (const auto& lane : traveling_route)
-    {
-      for (const auto& street_light : vmap_.findByFilter(
-           [&lane](const StreetLight& street_light){return street_light.linkid == lane.lnid;}))
-        response.objects.data.push_back(street_light);
-    }
+    findLinkedObjects(traveling_route, response.objects);
     return true;
   }
 
@@ -862,13 +1063,7 @@ public:
     std::vector<Lane> traveling_route = createTravelingRoute(request.pose, request.waypoints);
     if (traveling_route.empty())
       return false;
-    response.objects.header.frame_id = "map";
-    for (const auto& lane : traveling_route)
-    {
-      for (const auto& utility_pole : vmap_.findByFilter(
-           [&lane](const UtilityPole& utility_pole){return utility_pole.linkid == lane.lnid;}))
-        response.objects.data.push_back(utility_pole);
-    }
+    findLinkedObjects(traveling_route, response.objects);
     return true;
   }
 
@@ -878,13 +1073,7 @@ public:
     std::vector<Lane> traveling_route = createTravelingRoute(request.pose, request.waypoints);
     if (traveling_route.empty())
       return false;
-    response.objects.header.frame_id = "map";
-    for (const auto& lane : traveling_route)
-    {
-      for (const auto& guard_rail : vmap_.findByFilter(
-           [&lane](const GuardRail& guard_rail){return guard_rail.linkid == lane.lnid;}))
-        response.objects.data.push_back(guard_rail);
-    }
+    findLinkedObjects(traveling_route, response.objects);
     return true;
   }
 
@@ -894,13 +1083,7 @@ public:
     std::vector<Lane> traveling_route = createTravelingRoute(request.pose, request.waypoints);
     if (traveling_route.empty())
       return false;
-    response.objects.header.frame_id = "map";
-    for (const auto& lane : traveling_route)
-    {
-      for (const auto& side_walk : vmap_.findByFilter(
-           [&lane](const SideWalk& side_walk){return side_walk.linkid == lane.lnid;}))
-        response.objects.data.push_back(side_walk);
-    }
+    findLinkedObjects(traveling_route, response.objects);
     return true;
   }
 
@@ -910,13 +1093,7 @@ public:
     std::vector<Lane> traveling_route = createTravelingRoute(request.pose, request.waypoints);
     if (traveling_route.empty())
       return false;
-    response.objects.header.frame_id = "map";
-    for (const auto& lane : traveling_route)
-    {
-      for (const auto& drive_on_portion : vmap_.findByFilter(
-           [&lane](const DriveOnPortion& drive_on_portion){return drive_on_portion.linkid == lane.lnid;}))
-        response.objects.data.push_back(drive_on_portion);
-    }
+    findLinkedObjects(traveling_route, response.objects);
     return true;
   }
 
@@ -926,13 +1103,7 @@ public:
     std::vector<Lane> traveling_route = createTravelingRoute(request.pose, request.waypoints);
     if (traveling_route.empty())
       return false;
-    response.objects.header.frame_id = "map";
-    for (const auto& lane : traveling_route)
-    {
-      for (const auto& cross_road : vmap_.findByFilter(
-           [&lane](const CrossRoad& cross_road){return cross_road.linkid == lane.lnid;}))
-        response.objects.data.push_back(cross_road);
-    }
+    findLinkedObjects(traveling_route, response.objects);
     return true;
   }
 
@@ -942,13 +1113,7 @@ public:
     std::vector<Lane> traveling_route = createTravelingRoute(request.pose, request.waypoints);
     if (traveling_route.empty())
       return false;
-    response.objects.header.frame_id = "map";
-    for (const auto& lane : traveling_route)
-    {
-      for (const auto& side_strip : vmap_.findByFilter(
-           [&lane](const SideStrip& side_strip){return side_strip.linkid == lane.lnid;}))
-        response.objects.data.push_back(side_strip);
-    }
+    findLinkedObjects(traveling_route, response.objects);
     return true;
   }
 
@@ -958,13 +1123,7 @@ public:
     std::vector<Lane> traveling_route = createTravelingRoute(request.pose, request.waypoints);
     if (traveling_route.empty())
       return false;
-    response.objects.header.frame_id = "map";
-    for (const auto& lane : traveling_route)
-    {
-      for (const auto& curve_mirror : vmap_.findByFilter(
-           [&lane](const CurveMirror& curve_mirror){return curve_mirror.linkid == lane.lnid;}))
-        response.objects.data.push_back(curve_mirror);
-    }
+    findLinkedObjects(traveling_route, response.objects);
     return true;
   }
 
@@ -974,13 +1133,7 @@ public:
     std::vector<Lane> traveling_route = createTravelingRoute(request.pose, request.waypoints);
     if (traveling_route.empty())
       return false;
-    response.objects.header.frame_id = "map";
-    for (const auto& lane : traveling_route)
-    {
-      for (const auto& wall : vmap_.findByFilter(
-           [&lane](const Wall& wall){return wall.linkid == lane.lnid;}))
-        response.objects.data.push_back(wall);
-    }
+    findLinkedObjects(traveling_route, response.objects);
     return true;
   }
 
@@ -990,13 +1143,7 @@ public:
     std::vector<Lane> traveling_route = createTravelingRoute(request.pose, request.waypoints);
     if (traveling_route.empty())
       return false;
-    response.objects.header.frame_id = "map";
-    for (const auto& lane : traveling_route)
-    {
-      for (const auto& fence : vmap_.findByFilter(
-           [&lane](const Fence& fence){return fence.linkid == lane.lnid;}))
-        response.objects.data.push_back(fence);
-    }
+    findLinkedObjects(traveling_route, response.objects);
     return true;
   }
 
@@ -1006,34 +1153,153 @@ public:
     std::vector<Lane> traveling_route = createTravelingRoute(request.pose, request.waypoints);
     if (traveling_route.empty())
       return false;
-    response.objects.header.frame_id = "map";
-    for (const auto& lane : traveling_route)
-    {
-      for (const auto& rail_crossing : vmap_.findByFilter(
-           [&lane](const RailCrossing& rail_crossing){return rail_crossing.linkid == lane.lnid;}))
-        response.objects.data.push_back(rail_crossing);
-    }
+    findLinkedObjects(traveling_route, response.objects);
+    return true;
+  }
+
+  bool getRouteObjects(vector_map_server::GetRouteObjects::Request& request,
+                       vector_map_server::GetRouteObjects::Response& response)
+  {
+    std::vector<Lane> traveling_route = createTravelingRoute(request.pose, request.waypoints);
+    if (traveling_route.empty())
+      return false;
+    // fails like the service of the category would
+    if ((request.categories & Category::DTLANE) && !findDTLanes(traveling_route, response.dtlanes))
+      return false;
+    if ((request.categories & Category::NODE) && !findNodes(traveling_route, response.nodes))
+      return false;
+    if (request.categories & Category::LANE)
+      findLanes(traveling_route, response.lanes);
+    if ((request.categories & Category::WAY_AREA) && !findWayAreas(traveling_route, response.way_areas))
+      return false;
+    if (request.categories & Category::ROAD_EDGE)
+      findLinkedObjects(traveling_route, response.road_edges);
+    if (request.categories & Category::GUTTER)
+      findLinkedObjects(traveling_route, response.gutters);
+    if (request.categories & Category::CURB)
+      findLinkedObjects(traveling_route, response.curbs);
+    if (request.categories & Category::WHITE_LINE)
+      findLinkedObjects(traveling_route, response.white_lines);
+    if (request.categories & Category::STOP_LINE)
+      findLinkedObjects(traveling_route, response.stop_lines);
+    if (request.categories & Category::ZEBRA_ZONE)
+      findLinkedObjects(traveling_route, response.zebra_zones);
+    if (request.categories & Category::CROSS_WALK)
+      findLinkedObjects(traveling_route, response.cross_walks);
+    if (request.categories & Category::ROAD_MARK)
+      findLinkedObjects(traveling_route, response.road_marks);
+    if (request.categories & Category::ROAD_POLE)
+      findLinkedObjects(traveling_route, response.road_poles);
+    if (request.categories & Category::ROAD_SIGN)
+      findLinkedObjects(traveling_route, response.road_signs);
+    if (request.categories & Category::SIGNAL)
+      findLinkedObjects(traveling_route, response.signals);
+    if (request.categories & Category::STREET_LIGHT)
+      findLinkedObjects(traveling_route, response.street_lights);
+    if (request.categories & Category::UTILITY_POLE)
+      findLinkedObjects(traveling_route, response.utility_poles);
+    if (request.categories & Category::GUARD_RAIL)
+      findLinkedObjects(traveling_route, response.guard_rails);
+    if (request.categories & Category::SIDE_WALK)
+      findLinkedObjects(traveling_route, response.side_walks);
+    if (request.categories & Category::DRIVE_ON_PORTION)
+      findLinkedObjects(traveling_route, response.drive_on_portions);
+    if (request.categories & Category::CROSS_ROAD)
+      findLinkedObjects(traveling_route, response.cross_roads);
+    if (request.categories & Category::SIDE_STRIP)
+      findLinkedObjects(traveling_route, response.side_strips);
+    if (request.categories & Category::CURVE_MIRROR)
+      findLinkedObjects(traveling_route, response.curve_mirrors);
+    if (request.categories & Category::WALL)
+      findLinkedObjects(traveling_route, response.walls);
+    if (request.categories & Category::FENCE)
+      findLinkedObjects(traveling_route, response.fences);
+    if (request.categories & Category::RAIL_CROSSING)
+      findLinkedObjects(traveling_route, response.rail_crossings);
     return true;
   }
 
   bool isWayArea(vector_map_server::PositionState::Request& request,
                  vector_map_server::PositionState::Response& response)
   {
-    response.state = false;
-    for (const auto& way_area : vmap_.findByFilter([](const WayArea& way_area){return true;}))
     {
-      Area area = vmap_.findByKey(Key<Area>(way_area.aid));
-      if (area.aid == 0)
-        continue;
-      Polygon polygon = createPolygon(vmap_, area);
-      if (isInPolygon(polygon, request.position))
+      std::lock_guard<std::mutex> lock(derived_mutex_);
+      if (way_areas_dirty_)
       {
-        response.state = true;
-        break;
+        way_areas_.build(vmap_, way_area_cell_size_);
+        way_areas_dirty_ = false;
       }
     }
+    response.state = way_areas_.contains(request.position);
     return true;
   }
+
+  // handler is served on the service threads under the shared map lock, its durations are reported by spin
+  template <class Req, class Res>
+  ros::ServiceServer advertiseService(ros::NodeHandle& nh, const std::string& name,
+                                      bool (VectorMapServer::*handler)(Req&, Res&))
+  {
+    ServiceLatency* latency = &latencies_[name];
+    ros::NodeHandle service_nh(nh);
+    service_nh.setCallbackQueue(&service_queue_);
+    return service_nh.advertiseService<Req, Res>(name, boost::function<bool(Req&, Res&)>(
+        [this, handler, latency](Req& request, Res& response) {
+          ros::WallTime start = ros::WallTime::now();
+          bool result;
+          {
+            std::shared_lock<std::shared_timed_mutex> lock(map_mutex_);
+            result = (this->*handler)(request, response);
+          }
+          double ms = (ros::WallTime::now() - start).toSec() * 1000;
+          std::lock_guard<std::mutex> lock(latency->mutex);
+          ++latency->count;
+          latency->total_ms += ms;
+          latency->max_ms = std::max(latency->max_ms, ms);
+          return result;
+        }));
+  }
+
+  void reportLatencies()
+  {
+    for (auto& pair : latencies_)
+    {
+      ServiceLatency& latency = pair.second;
+      std::lock_guard<std::mutex> lock(latency.mutex);
+      if (latency.count == 0)
+        continue;
+      ROS_INFO("%s: %lu calls, %.3f ms mean, %.3f ms max", pair.first.c_str(), latency.count,
+               latency.total_ms / latency.count, latency.max_ms);
+      latency.count = 0;
+      latency.total_ms = 0;
+      latency.max_ms = 0;
+    }
+  }
+
+  // Serves the services on nthreads threads (0 for one per core) and handles the map messages of the global queue
+  // on the calling thread until shutdown. The latencies are reported every stats_period seconds, never when 0
+  void spin(int nthreads, double stats_period)
+  {
+    ros::AsyncSpinner spinner(nthreads, &service_queue_);
+    spinner.start();
+
+    ros::CallbackQueue* map_queue = ros::getGlobalCallbackQueue();
+    ros::WallTime next_report = ros::WallTime::now() + ros::WallDuration(stats_period);
+    while (ros::ok())
+    {
+      if (!map_queue->isEmpty())
+      {
+        std::unique_lock<std::shared_timed_mutex> lock(map_mutex_);
+        map_queue->callAvailable();
+      }
+      if (stats_period > 0 && ros::WallTime::now() >= next_report)
+      {
+        reportLatencies();
+        next_report = ros::WallTime::now() + ros::WallDuration(stats_period);
+      }
+      ros::WallDuration(0.1).sleep();
+    }
+    spinner.stop();
+  }
 };
 }  // namespace
 
@@ -1044,62 +1310,68 @@ int main(int argc, char **argv)
   ros::NodeHandle nh;
   VectorMapServer vms(nh);
 
-  ros::ServiceServer get_dtlane_srv = nh.advertiseService("vector_map_server/get_dtlane",
-                                                          &VectorMapServer::getDTLane, &vms);
-  ros::ServiceServer get_node_srv = nh.advertiseService("vector_map_server/get_node",
-                                                        &VectorMapServer::getNode, &vms);
-  ros::ServiceServer get_lane_srv = nh.advertiseService("vector_map_server/get_lane",
-                                                        &VectorMapServer::getLane, &vms);
-  ros::ServiceServer get_way_area_srv = nh.advertiseService("vector_map_server/get_way_area",
-                                                            &VectorMapServer::getWayArea, &vms);
-  ros::ServiceServer get_road_edge_srv = nh.advertiseService("vector_map_server/get_road_edge",
-                                                             &VectorMapServer::getRoadEdge, &vms);
-  ros::ServiceServer get_gutter_srv = nh.advertiseService("vector_map_server/get_gutter",
-                                                          &VectorMapServer::getGutter, &vms);
-  ros::ServiceServer get_curb_srv = nh.advertiseService("vector_map_server/get_curb",
-                                                        &VectorMapServer::getCurb, &vms);
-  ros::ServiceServer get_white_line_srv = nh.advertiseService("vector_map_server/get_white_line",
-                                                              &VectorMapServer::getWhiteLine, &vms);
-  ros::ServiceServer get_stop_line_srv = nh.advertiseService("vector_map_server/get_stop_line",
-                                                             &VectorMapServer::getStopLine, &vms);
-  ros::ServiceServer get_zebra_zone_srv = nh.advertiseService("vector_map_server/get_zebra_zone",
-                                                              &VectorMapServer::getZebraZone, &vms);
-  ros::ServiceServer get_cross_walk_srv = nh.advertiseService("vector_map_server/get_cross_walk",
-                                                              &VectorMapServer::getCrossWalk, &vms);
-  ros::ServiceServer get_road_mark_srv = nh.advertiseService("vector_map_server/get_road_mark",
-                                                             &VectorMapServer::getRoadMark, &vms);
-  ros::ServiceServer get_road_pole_srv = nh.advertiseService("vector_map_server/get_road_pole",
-                                                             &VectorMapServer::getRoadPole, &vms);
-  ros::ServiceServer get_road_sign_srv = nh.advertiseService("vector_map_server/get_road_sign",
-                                                             &VectorMapServer::getRoadSign, &vms);
-  ros::ServiceServer get_signal_srv = nh.advertiseService("vector_map_server/get_signal",
-                                                          &VectorMapServer::getSignal, &vms);
-  ros::ServiceServer get_street_light_srv = nh.advertiseService("vector_map_server/get_street_light",
-                                                                &VectorMapServer::getStreetLight, &vms);
-  ros::ServiceServer get_utility_pole_srv = nh.advertiseService("vector_map_server/get_utility_pole",
-                                                                &VectorMapServer::getUtilityPole, &vms);
-  ros::ServiceServer get_guard_rail_srv = nh.advertiseService("vector_map_server/get_guard_rail",
-                                                              &VectorMapServer::getGuardRail, &vms);
-  ros::ServiceServer get_side_walk_srv = nh.advertiseService("vector_map_server/get_side_walk",
-                                                             &VectorMapServer::getSideWalk, &vms);
-  ros::ServiceServer get_drive_on_portion_srv = nh.advertiseService("vector_map_server/get_drive_on_portion",
-                                                                    &VectorMapServer::getDriveOnPortion, &vms);
-  ros::ServiceServer get_cross_road_srv = nh.advertiseService("vector_map_server/get_cross_road",
-                                                              &VectorMapServer::getCrossRoad, &vms);
-  ros::ServiceServer get_side_strip_srv = nh.advertiseService("vector_map_server/get_side_strip",
-                                                              &VectorMapServer::getSideStrip, &vms);
-  ros::ServiceServer get_curve_mirror_srv = nh.advertiseService("vector_map_server/get_curve_mirror",
-                                                                &VectorMapServer::getCurveMirror, &vms);
-  ros::ServiceServer get_wall_srv = nh.advertiseService("vector_map_server/get_wall",
-                                                        &VectorMapServer::getWall, &vms);
-  ros::ServiceServer get_fence_srv = nh.advertiseService("vector_map_server/get_fence",
-                                                         &VectorMapServer::getFence, &vms);
-  ros::ServiceServer get_rail_crossing_srv = nh.advertiseService("vector_map_server/get_rail_crossing",
-                                                                 &VectorMapServer::getRailCrossing, &vms);
-  ros::ServiceServer is_way_area_srv = nh.advertiseService("vector_map_server/is_way_area",
-                                                           &VectorMapServer::isWayArea, &vms);
-
-  ros::spin();
+  ros::ServiceServer get_dtlane_srv = vms.advertiseService(nh, "vector_map_server/get_dtlane",
+                                                          &VectorMapServer::getDTLane);
+  ros::ServiceServer get_node_srv = vms.advertiseService(nh, "vector_map_server/get_node",
+                                                          &VectorMapServer::getNode);
+  ros::ServiceServer get_lane_srv = vms.advertiseService(nh, "vector_map_server/get_lane",
+                                                          &VectorMapServer::getLane);
+  ros::ServiceServer get_way_area_srv = vms.advertiseService(nh, "vector_map_server/get_way_area",
+                                                          &VectorMapServer::getWayArea);
+  ros::ServiceServer get_road_edge_srv = vms.advertiseService(nh, "vector_map_server/get_road_edge",
+                                                          &VectorMapServer::getRoadEdge);
+  ros::ServiceServer get_gutter_srv = vms.advertiseService(nh, "vector_map_server/get_gutter",
+                                                          &VectorMapServer::getGutter);
+  ros::ServiceServer get_curb_srv = vms.advertiseService(nh, "vector_map_server/get_curb",
+                                                          &VectorMapServer::getCurb);
+  ros::ServiceServer get_white_line_srv = vms.advertiseService(nh, "vector_map_server/get_white_line",
+                                                          &VectorMapServer::getWhiteLine);
+  ros::ServiceServer get_stop_line_srv = vms.advertiseService(nh, "vector_map_server/get_stop_line",
+                                                          &VectorMapServer::getStopLine);
+  ros::ServiceServer get_zebra_zone_srv = vms.advertiseService(nh, "vector_map_server/get_zebra_zone",
+                                                          &VectorMapServer::getZebraZone);
+  ros::ServiceServer get_cross_walk_srv = vms.advertiseService(nh, "vector_map_server/get_cross_walk",
+                                                          &VectorMapServer::getCrossWalk);
+  ros::ServiceServer get_road_mark_srv = vms.advertiseService(nh, "vector_map_server/get_road_mark",
+                                                          &VectorMapServer::getRoadMark);
+  ros::ServiceServer get_road_pole_srv = vms.advertiseService(nh, "vector_map_server/get_road_pole",
+                                                          &VectorMapServer::getRoadPole);
+  ros::ServiceServer get_road_sign_srv = vms.advertiseService(nh, "vector_map_server/get_road_sign",
+                                                          &VectorMapServer::getRoadSign);
+  ros::ServiceServer get_signal_srv = vms.advertiseService(nh, "vector_map_server/get_signal",
+                                                          &VectorMapServer::getSignal);
+  ros::ServiceServer get_street_light_srv = vms.advertiseService(nh, "vector_map_server/get_street_light",
+                                                          &VectorMapServer::getStreetLight);
+  ros::ServiceServer get_utility_pole_srv = vms.advertiseService(nh, "vector_map_server/get_utility_pole",
+                                                          &VectorMapServer::getUtilityPole);
+  ros::ServiceServer get_guard_rail_srv = vms.advertiseService(nh, "vector_map_server/get_guard_rail",
+                                                          &VectorMapServer::getGuardRail);
+  ros::ServiceServer get_side_walk_srv = vms.advertiseService(nh, "vector_map_server/get_side_walk",
+                                                          &VectorMapServer::getSideWalk);
+  ros::ServiceServer get_drive_on_portion_srv = vms.advertiseService(nh, "vector_map_server/get_drive_on_portion",
+                                                          &VectorMapServer::getDriveOnPortion);
+  ros::ServiceServer get_cross_road_srv = vms.advertiseService(nh, "vector_map_server/get_cross_road",
+                                                          &VectorMapServer::getCrossRoad);
+  ros::ServiceServer get_side_strip_srv = vms.advertiseService(nh, "vector_map_server/get_side_strip",
+                                                          &VectorMapServer::getSideStrip);
+  ros::ServiceServer get_curve_mirror_srv = vms.advertiseService(nh, "vector_map_server/get_curve_mirror",
+                                                          &VectorMapServer::getCurveMirror);
+  ros::ServiceServer get_wall_srv = vms.advertiseService(nh, "vector_map_server/get_wall",
+                                                          &VectorMapServer::getWall);
+  ros::ServiceServer get_fence_srv = vms.advertiseService(nh, "vector_map_server/get_fence",
+                                                          &VectorMapServer::getFence);
+  ros::ServiceServer get_rail_crossing_srv = vms.advertiseService(nh, "vector_map_server/get_rail_crossing",
+                                                          &VectorMapServer::getRailCrossing);
+  ros::ServiceServer is_way_area_srv = vms.advertiseService(nh, "vector_map_server/is_way_area",
+                                                          &VectorMapServer::isWayArea);
+  ros::ServiceServer get_route_objects_srv = vms.advertiseService(nh, "vector_map_server/get_route_objects",
+                                                          &VectorMapServer::getRouteObjects);
+
+  int threads;
+  nh.param<int>("vector_map_server/threads", threads, 4);
+  double stats_period;
+  nh.param<double>("vector_map_server/stats_period", stats_period, 60);
+  vms.spin(threads, stats_period);
 
   return EXIT_SUCCESS;
 }
@@ -0,0 +1,437 @@
+/*
+ * Copyright 2018-2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file vehicle_model_batch.h
+ * @brief batch simulation of independent vehicles of one model, for rollouts and fleet simulation
+ */
+
+#ifndef VEHICLE_SIM_MODEL_VEHICLE_MODEL_BATCH_H
+#define VEHICLE_SIM_MODEL_VEHICLE_MODEL_BATCH_H
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include <eigen3/Eigen/Core>
+
+/**
+ * @class worker threads of VehicleModelBatch
+ * @brief runs task(i) for i in [0, n) on the workers and the calling thread, one loop at a time
+ */
+class VehicleModelBatchWorkers
+{
+public:
+  /**
+   * @brief constructor
+   * @param [in] num_threads number of threads including the caller, 0 for the hardware concurrency
+   */
+  explicit VehicleModelBatchWorkers(int num_threads);
+
+  /**
+   * @brief destructor, joins the workers
+   */
+  ~VehicleModelBatchWorkers();
+
+  VehicleModelBatchWorkers(const VehicleModelBatchWorkers&) = delete;
+  VehicleModelBatchWorkers& operator=(const VehicleModelBatchWorkers&) = delete;
+
+  /**
+   * @brief get number of threads including the caller
+   */
+  int getNumThreads() const;
+
+  /**
+   * @brief run task(i) for i in [0, n), the first exception of a task is thrown again once all are done
+   */
+  void run(int n, const std::function<void(int)>& task);
+
+private:
+  std::vector<std::thread> workers_;
+  std::mutex mutex_;
+  std::condition_variable start_cv_;
+  std::condition_variable done_cv_;
+  const std::function<void(int)>* task_;
+  int num_tasks_;
+  int next_task_;
+  int busy_workers_;
+  unsigned long generation_;
+  bool stop_;
+  std::exception_ptr exception_;
+
+  void workerLoop();
+  void runTasks();
+};
+
+/*
+ * Models of VehicleModelBatch. Each one has the equations of the VehicleModelInterface model of the same name,
+ * computed on the arrays of a block of vehicles, one row per vehicle.
+ */
+
+/**
+ * @class batch model of VehicleModelIdealTwist
+ */
+class VehicleBatchModelIdealTwist
+{
+public:
+  static constexpr int DIM_X = 3;  //!< @brief x, y, yaw
+  static constexpr int DIM_U = 2;  //!< @brief vx_des, wz_des
+
+  std::array<int, DIM_U> getDelaySteps(const double& /* dt */) const
+  {
+    return { { 0, 0 } };
+  }
+
+  template <class State, class Input, class DState>
+  void calcModel(const State& state, const Input& input, DState& d_state) const
+  {
+    d_state.col(0) = input.col(0) * state.col(2).cos();
+    d_state.col(1) = input.col(0) * state.col(2).sin();
+    d_state.col(2) = input.col(1);
+  }
+};
+
+/**
+ * @class batch model of VehicleModelIdealSteer
+ */
+class VehicleBatchModelIdealSteer
+{
+public:
+  static constexpr int DIM_X = 3;  //!< @brief x, y, yaw
+  static constexpr int DIM_U = 2;  //!< @brief vx_des, steer_des
+
+  explicit VehicleBatchModelIdealSteer(double wheelbase) : wheelbase_(wheelbase) {}
+
+  std::array<int, DIM_U> getDelaySteps(const double& /* dt */) const
+  {
+    return { { 0, 0 } };
+  }
+
+  template <class State, class Input, class DState>
+  void calcModel(const State& state, const Input& input, DState& d_state) const
+  {
+    d_state.col(0) = input.col(0) * state.col(2).cos();
+    d_state.col(1) = input.col(0) * state.col(2).sin();
+    d_state.col(2) = input.col(0) * input.col(1).tan() / wheelbase_;
+  }
+
+private:
+  const double wheelbase_;  //!< @brief vehicle wheelbase length [m]
+};
+
+/**
+ * @class batch model of VehicleModelConstantAccelTwist
+ */
+class VehicleBatchModelConstantAccelTwist
+{
+public:
+  static constexpr int DIM_X = 5;  //!< @brief x, y, yaw, vx, wz
+  static constexpr int DIM_U = 2;  //!< @brief vx_des, wz_des
+
+  VehicleBatchModelConstantAccelTwist(double vx_lim, double wz_lim, double vx_rate, double wz_rate)
+    : vx_lim_(vx_lim), wz_lim_(wz_lim), vx_rate_(vx_rate), wz_rate_(wz_rate)
+  {
+  }
+
+  std::array<int, DIM_U> getDelaySteps(const double& /* dt */) const
+  {
+    return { { 0, 0 } };
+  }
+
+  template <class State, class Input, class DState>
+  void calcModel(const State& state, const Input& input, DState& d_state) const
+  {
+    const auto vx_des = input.col(0).min(vx_lim_).max(-vx_lim_);
+    const auto wz_des = input.col(1).min(wz_lim_).max(-wz_lim_);
+    d_state.col(0) = state.col(3) * state.col(2).cos();
+    d_state.col(1) = state.col(3) * state.col(2).sin();
+    d_state.col(2) = state.col(4);
+    // vx_rate_ towards vx_des, zero once it is reached
+    d_state.col(3) = vx_rate_ * ((vx_des > state.col(3)).template cast<double>() -
+                                 (vx_des < state.col(3)).template cast<double>());
+    d_state.col(4) = wz_rate_ * ((wz_des > state.col(4)).template cast<double>() -
+                                 (wz_des < state.col(4)).template cast<double>());
+  }
+
+private:
+  const double vx_lim_;   //!< @brief velocity limit [m/s]
+  const double wz_lim_;   //!< @brief angular velocity limit [rad/s]
+  const double vx_rate_;  //!< @brief acceleration [m/ss]
+  const double wz_rate_;  //!< @brief angular acceleration [rad/ss]
+};
+
+/**
+ * @class batch model of VehicleModelTimeDelayTwist
+ */
+class VehicleBatchModelTimeDelayTwist
+{
+public:
+  static constexpr int DIM_X = 5;  //!< @brief x, y, yaw, vx, wz
+  static constexpr int DIM_U = 2;  //!< @brief vx_des, wz_des
+
+  /**
+   * @brief constructor, the time constants below 0.03 s are replaced by 0.03 s as in VehicleModelTimeDelayTwist
+   */
+  VehicleBatchModelTimeDelayTwist(double vx_lim, double wz_lim, double vx_rate_lim, double wz_rate_lim,
+                                  double vx_delay, double vx_time_constant, double wz_delay, double wz_time_constant)
+    : vx_lim_(vx_lim)
+    , vx_rate_lim_(vx_rate_lim)
+    , wz_lim_(wz_lim)
+    , wz_rate_lim_(wz_rate_lim)
+    , vx_delay_(vx_delay)
+    , vx_time_constant_(std::max(vx_time_constant, 0.03))
+    , wz_delay_(wz_delay)
+    , wz_time_constant_(std::max(wz_time_constant, 0.03))
+  {
+  }
+
+  std::array<int, DIM_U> getDelaySteps(const double& dt) const
+  {
+    return { { static_cast<int>(std::round(vx_delay_ / dt)), static_cast<int>(std::round(wz_delay_ / dt)) } };
+  }
+
+  template <class State, class Input, class DState>
+  void calcModel(const State& state, const Input& input, DState& d_state) const
+  {
+    const auto vx_des = input.col(0).min(vx_lim_).max(-vx_lim_);
+    const auto wz_des = input.col(1).min(wz_lim_).max(-wz_lim_);
+    d_state.col(0) = state.col(3) * state.col(2).cos();
+    d_state.col(1) = state.col(3) * state.col(2).sin();
+    d_state.col(2) = state.col(4);
+    d_state.col(3) = (-(state.col(3) - vx_des) / vx_time_constant_).max(-vx_rate_lim_).min(vx_rate_lim_);
+    d_state.col(4) = (-(state.col(4) - wz_des) / wz_time_constant_).max(-wz_rate_lim_).min(wz_rate_lim_);
+  }
+
+private:
+  const double vx_lim_;            //!< @brief velocity limit [m/s]
+  const double vx_rate_lim_;       //!< @brief acceleration limit [m/ss]
+  const double wz_lim_;            //!< @brief angular velocity limit [rad/s]
+  const double wz_rate_lim_;       //!< @brief angular acceleration limit [rad/ss]
+  const double vx_delay_;          //!< @brief time delay for velocity command [s]
+  const double vx_time_constant_;  //!< @brief time constant for 1D model of velocity dynamics
+  const double wz_delay_;          //!< @brief time delay for angular-velocity command [s]
+  const double wz_time_constant_;  //!< @brief time constant for 1D model of angular-velocity dynamics
+};
+
+/**
+ * @class batch model of VehicleModelTimeDelaySteer
+ */
+class VehicleBatchModelTimeDelaySteer
+{
+public:
+  static constexpr int DIM_X = 5;  //!< @brief x, y, yaw, vx, steer
+  static constexpr int DIM_U = 2;  //!< @brief vx_des, steer_des
+
+  /**
+   * @brief constructor, the time constants below 0.03 s are replaced by 0.03 s as in VehicleModelTimeDelaySteer
+   */
+  VehicleBatchModelTimeDelaySteer(double vx_lim, double steer_lim, double vx_rate_lim, double steer_rate_lim,
+                                  double wheelbase, double vx_delay, double vx_time_constant, double steer_delay,
+                                  double steer_time_constant)
+    : vx_lim_(vx_lim)
+    , vx_rate_lim_(vx_rate_lim)
+    , steer_lim_(steer_lim)
+    , steer_rate_lim_(steer_rate_lim)
+    , wheelbase_(wheelbase)
+    , vx_delay_(vx_delay)
+    , vx_time_constant_(std::max(vx_time_constant, 0.03))
+    , steer_delay_(steer_delay)
+    , steer_time_constant_(std::max(steer_time_constant, 0.03))
+  {
+  }
+
+  std::array<int, DIM_U> getDelaySteps(const double& dt) const
+  {
+    return { { static_cast<int>(std::round(vx_delay_ / dt)), static_cast<int>(std::round(steer_delay_ / dt)) } };
+  }
+
+  template <class State, class Input, class DState>
+  void calcModel(const State& state, const Input& input, DState& d_state) const
+  {
+    const auto vx_des = input.col(0).min(vx_lim_).max(-vx_lim_);
+    const auto steer_des = input.col(1).min(steer_lim_).max(-steer_lim_);
+    d_state.col(0) = state.col(3) * state.col(2).cos();
+    d_state.col(1) = state.col(3) * state.col(2).sin();
+    d_state.col(2) = state.col(3) * state.col(4).tan() / wheelbase_;
+    d_state.col(3) = (-(state.col(3) - vx_des) / vx_time_constant_).max(-vx_rate_lim_).min(vx_rate_lim_);
+    d_state.col(4) = (-(state.col(4) - steer_des) / steer_time_constant_).max(-steer_rate_lim_).min(steer_rate_lim_);
+  }
+
+private:
+  const double vx_lim_;               //!< @brief velocity limit [m/s]
+  const double vx_rate_lim_;          //!< @brief acceleration limit [m/ss]
+  const double steer_lim_;            //!< @brief steering limit [rad]
+  const double steer_rate_lim_;       //!< @brief steering angular velocity limit [rad/s]
+  const double wheelbase_;            //!< @brief vehicle wheelbase length [m]
+  const double vx_delay_;             //!< @brief time delay for velocity command [s]
+  const double vx_time_constant_;     //!< @brief time constant for 1D model of velocity dynamics
+  const double steer_delay_;          //!< @brief time delay for steering command [s]
+  const double steer_time_constant_;  //!< @brief time constant for 1D model of steering dynamics
+};
+
+/**
+ * @class batch of vehicles
+ * @brief steps num_vehicles independent vehicles of one Model with the Runge-Kutta method, as update() of the
+ * VehicleModelInterface model for each vehicle. The states and inputs are stored as one column per variable and
+ * one row per vehicle, the vehicles are stepped by blocks of fixed maximum size on the worker threads.
+ */
+template <class Model>
+class VehicleModelBatch
+{
+public:
+  static constexpr int DIM_X = Model::DIM_X;  //!< @brief dimension of state x
+  static constexpr int DIM_U = Model::DIM_U;  //!< @brief dimension of input u
+  static constexpr int BLOCK_SIZE = 64;       //!< @brief number of vehicles stepped together
+
+  using StateArray = Eigen::Array<double, Eigen::Dynamic, DIM_X>;  //!< @brief state of each vehicle
+  using InputArray = Eigen::Array<double, Eigen::Dynamic, DIM_U>;  //!< @brief input of each vehicle
+
+  /**
+   * @brief constructor, all states and inputs are zero
+   * @param [in] model model of the vehicles
+   * @param [in] num_vehicles number of vehicles
+   * @param [in] dt delta time information to set input buffer for delay
+   * @param [in] num_threads number of threads including the caller, 0 for the hardware concurrency
+   */
+  VehicleModelBatch(const Model& model, int num_vehicles, double dt, int num_threads = 0)
+    : model_(model)
+    , state_(StateArray::Zero(num_vehicles, DIM_X))
+    , input_(InputArray::Zero(num_vehicles, DIM_U))
+    , delay_steps_(model.getDelaySteps(dt))
+    , workers_(num_threads)
+  {
+    for (int i = 0; i < DIM_U; ++i)
+    {
+      input_queue_[i] = Eigen::ArrayXXd::Zero(num_vehicles, delay_steps_[i]);
+      input_queue_head_[i] = 0;
+    }
+  }
+
+  int getNumVehicles() const
+  {
+    return static_cast<int>(state_.rows());
+  }
+
+  const StateArray& getState() const
+  {
+    return state_;
+  }
+
+  const InputArray& getInput() const
+  {
+    return input_;
+  }
+
+  /**
+   * @brief set state of all vehicles
+   * @param [in] state getNumVehicles() x DIM_X array
+   */
+  void setState(const StateArray& state)
+  {
+    checkRows(state.rows());
+    state_ = state;
+  }
+
+  /**
+   * @brief set input of all vehicles, used by the next update
+   * @param [in] input getNumVehicles() x DIM_U array
+   */
+  void setInput(const InputArray& input)
+  {
+    checkRows(input.rows());
+    input_ = input;
+  }
+
+  /**
+   * @brief update states of all vehicles with the input delayed by the model
+   * @param [in] dt delta time [s]
+   */
+  void update(const double& dt)
+  {
+    const int num_blocks = (getNumVehicles() + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    workers_.run(num_blocks, [this, &dt](int block) { updateBlock(block * BLOCK_SIZE, dt); });
+    for (int i = 0; i < DIM_U; ++i)
+    {
+      if (delay_steps_[i] > 0)
+      {
+        input_queue_head_[i] = (input_queue_head_[i] + 1) % delay_steps_[i];
+      }
+    }
+  }
+
+private:
+  template <int DIM>
+  using Block = Eigen::Array<double, Eigen::Dynamic, DIM, Eigen::ColMajor, BLOCK_SIZE, DIM>;
+
+  const Model model_;
+  StateArray state_;
+  InputArray input_;
+  const std::array<int, DIM_U> delay_steps_;
+  std::array<Eigen::ArrayXXd, DIM_U> input_queue_;  //!< @brief delayed inputs, one column per step
+  std::array<int, DIM_U> input_queue_head_;         //!< @brief column of the oldest input
+  VehicleModelBatchWorkers workers_;
+
+  void checkRows(Eigen::Index rows) const
+  {
+    if (rows != state_.rows())
+    {
+      throw std::invalid_argument("VehicleModelBatch: one row per vehicle is expected");
+    }
+  }
+
+  void updateBlock(const int begin, const double& dt)
+  {
+    const int size = std::min(BLOCK_SIZE, getNumVehicles() - begin);
+    Block<DIM_U> input(size, DIM_U);
+    for (int i = 0; i < DIM_U; ++i)
+    {
+      if (delay_steps_[i] > 0)
+      {
+        auto queued = input_queue_[i].col(input_queue_head_[i]).segment(begin, size);
+        input.col(i) = queued;
+        queued = input_.col(i).segment(begin, size);
+      }
+      else
+      {
+        input.col(i) = input_.col(i).segment(begin, size);
+      }
+    }
+
+    // same operations as VehicleModelInterface::updateRungeKutta
+    Block<DIM_X> state = state_.middleRows(begin, size);
+    Block<DIM_X> k1(size, DIM_X), k2(size, DIM_X), k3(size, DIM_X), k4(size, DIM_X);
+    model_.calcModel(state, input, k1);
+    model_.calcModel(Block<DIM_X>(state + k1 * 0.5 * dt), input, k2);
+    model_.calcModel(Block<DIM_X>(state + k2 * 0.5 * dt), input, k3);
+    model_.calcModel(Block<DIM_X>(state + k3 * dt), input, k4);
+    state_.middleRows(begin, size) = state + 1.0 / 6.0 * (k1 + 2.0 * k2 + 2.0 * k3 + k4) * dt;
+  }
+};
+
+template <class Model>
+constexpr int VehicleModelBatch<Model>::DIM_X;
+template <class Model>
+constexpr int VehicleModelBatch<Model>::DIM_U;
+template <class Model>
+constexpr int VehicleModelBatch<Model>::BLOCK_SIZE;
+
+#endif  // VEHICLE_SIM_MODEL_VEHICLE_MODEL_BATCH_H
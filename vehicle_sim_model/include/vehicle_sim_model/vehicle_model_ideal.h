@@ -97,6 +97,17 @@ private:
    * @param [in] input input vector to model
    */
   Eigen::VectorXd calcModel(const Eigen::VectorXd& state, const Eigen::VectorXd& input) override;
+  /**
+   * @brief calculate derivative of states and its jacobians with ideal twist model
+   * @param [in] state current model state
+   * @param [in] input input vector to model
+   * @param [out] d_state derivative of states
+   * @param [out] jac_x jacobian of d_state by state
+   * @param [out] jac_u jacobian of d_state by input
+   */
+  bool calcModelJacobian(const Eigen::Ref<const Eigen::VectorXd>& state,
+                         const Eigen::Ref<const Eigen::VectorXd>& input, StateVector* d_state, StateMatrix* jac_x,
+                         InputMatrix* jac_u) const override;
 };
 
 /**
@@ -169,6 +180,17 @@ private:
    * @param [in] input input vector to model
    */
   Eigen::VectorXd calcModel(const Eigen::VectorXd& state, const Eigen::VectorXd& input) override;
+  /**
+   * @brief calculate derivative of states and its jacobians with ideal steering model
+   * @param [in] state current model state
+   * @param [in] input input vector to model
+   * @param [out] d_state derivative of states
+   * @param [out] jac_x jacobian of d_state by state
+   * @param [out] jac_u jacobian of d_state by input
+   */
+  bool calcModelJacobian(const Eigen::Ref<const Eigen::VectorXd>& state,
+                         const Eigen::Ref<const Eigen::VectorXd>& input, StateVector* d_state, StateMatrix* jac_x,
+                         InputMatrix* jac_u) const override;
 };
 
 #endif  // VEHICLE_SIM_MODEL_VEHICLE_MODEL_IDEAL_H
@@ -32,6 +32,17 @@
  */
 class VehicleModelInterface
 {
+public:
+  static constexpr int MAX_DIM_X = 5;  //!< @brief largest dimension of state x of the models
+  static constexpr int MAX_DIM_U = 2;  //!< @brief largest dimension of input u of the models
+
+  /** @brief dim_x x dim_x matrix, with a fixed capacity so resizing it never allocates */
+  using StateMatrix = Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::ColMajor, MAX_DIM_X, MAX_DIM_X>;
+  /** @brief dim_x x dim_u matrix, with a fixed capacity so resizing it never allocates */
+  using InputMatrix = Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::ColMajor, MAX_DIM_X, MAX_DIM_U>;
+  /** @brief dim_x vector, with a fixed capacity so resizing it never allocates */
+  using StateVector = Eigen::Matrix<double, Eigen::Dynamic, 1, Eigen::ColMajor, MAX_DIM_X, 1>;
+
 protected:
   const int dim_x_;        //!< @brief dimension of state x
   const int dim_u_;        //!< @brief dimension of input u
@@ -124,6 +135,48 @@ public:
    * @param [in] input input vector to model
    */
   virtual Eigen::VectorXd calcModel(const Eigen::VectorXd& state, const Eigen::VectorXd& input) = 0;
+
+  /**
+   * @brief calculate derivative of states and its jacobians with vehicle model, without allocation
+   * @param [in] state current model state
+   * @param [in] input input vector to model, the delayed input for the models with time delay
+   * @param [out] d_state derivative of states, same as calcModel
+   * @param [out] jac_x jacobian of d_state by state
+   * @param [out] jac_u jacobian of d_state by input
+   * @return false if the model has no analytic jacobian, the outputs are then not set
+   * @note a saturated limit has a zero derivative
+   */
+  virtual bool calcModelJacobian(const Eigen::Ref<const Eigen::VectorXd>& state,
+                                 const Eigen::Ref<const Eigen::VectorXd>& input, StateVector* d_state,
+                                 StateMatrix* jac_x, InputMatrix* jac_u) const;
+
+  /**
+   * @brief linearize the Euler update x_{k+1} = x_k + calcModel(x_k, u_k) * dt around (state, input),
+   *        x_{k+1} = Ad * x_k + Bd * u_k + Wd, with the analytic jacobian of the model or finite differences
+   *        when it has none
+   * @param [in] dt delta time [s]
+   * @param [in] state linearization state
+   * @param [in] input linearization input
+   * @param [out] Ad discrete state matrix
+   * @param [out] Bd discrete input matrix
+   * @param [out] Wd discrete offset, x_{k+1} is exact at (state, input)
+   */
+  void calcLinearizedModel(const double& dt, const Eigen::Ref<const Eigen::VectorXd>& state,
+                           const Eigen::Ref<const Eigen::VectorXd>& input, StateMatrix* Ad, InputMatrix* Bd,
+                           StateVector* Wd);
+
+  /**
+   * @brief same as calcLinearizedModel with central finite differences of calcModel, 2 * (dim_x + dim_u) + 1 calls
+   * @param [in] dt delta time [s]
+   * @param [in] state linearization state
+   * @param [in] input linearization input
+   * @param [out] Ad discrete state matrix
+   * @param [out] Bd discrete input matrix
+   * @param [out] Wd discrete offset
+   */
+  void calcLinearizedModelNumerical(const double& dt, const Eigen::Ref<const Eigen::VectorXd>& state,
+                                    const Eigen::Ref<const Eigen::VectorXd>& input, StateMatrix* Ad,
+                                    InputMatrix* Bd, StateVector* Wd);
 };
 
 #endif  // VEHICLE_SIM_MODEL_VEHICLE_MODEL_INTERFACE_H
@@ -27,11 +27,43 @@
 #include "vehicle_sim_model/vehicle_model_interface.h"
 
 #include <iostream>
-#include <queue>
-#include <deque>
+#include <vector>
 #include <eigen3/Eigen/Core>
 #include <eigen3/Eigen/LU>
 
+/**
+ * @class input delay buffer
+ * @brief fixed-size ring of the past commands of one input, gives back the command of a time delay ago
+ */
+class InputDelayBuffer
+{
+public:
+  /**
+   * @brief constructor, without delay
+   */
+  InputDelayBuffer();
+
+  /**
+   * @brief allocate the buffer for the delay, the past commands are zero
+   * @param [in] delay time delay [s]
+   * @param [in] dt delta time of each update [s]
+   * @param [in] interpolate a delay between two updates interpolates their commands, else it is rounded to an update
+   */
+  void initialize(const double& delay, const double& dt, const bool interpolate);
+
+  /**
+   * @brief push the current command
+   * @param [in] input current command
+   * @return command delayed
+   */
+  double update(const double& input);
+
+private:
+  std::vector<double> buffer_;  //!< @brief past commands, the oldest at head_
+  size_t head_;                 //!< @brief index of the oldest command
+  double oldest_weight_;        //!< @brief interpolation weight of the oldest command
+};
+
 /**
  * @class vehicle time delay twist model
  * @brief calculate time delay twist dynamics
@@ -50,9 +82,11 @@ public:
    * @param [in] vx_time_constant time constant for 1D model of velocity dynamics
    * @param [in] wx_delay time delay for angular-velocity command [s]
    * @param [in] wz_time_constant time constant for 1D model of angular-velocity dynamics
+   * @param [in] interpolate_delay interpolate the commands of a delay between two updates, else round it to dt
    */
   VehicleModelTimeDelayTwist(double vx_lim, double angvel_lim, double vx_rate_lim, double wz_rate_lim, double dt,
-                           double vx_delay, double vx_time_constant, double wz_delay, double wz_time_constant);
+                           double vx_delay, double vx_time_constant, double wz_delay, double wz_time_constant,
+                           bool interpolate_delay = false);
 
 private:
   const double MIN_TIME_CONSTANT;  //!< @brief minimum time constant
@@ -76,18 +110,19 @@ private:
   const double wz_lim_;       //!< @brief angular velocity limit
   const double wz_rate_lim_;  //!< @brief angular acceleration limit
 
-  std::deque<double> vx_input_queue_;  //!< @brief buffer for velocity command
-  std::deque<double> wz_input_queue_;  //!< @brief buffer for angular velocity command
-  const double vx_delay_;              //!< @brief time delay for velocity command [s]
-  const double vx_time_constant_;      //!< @brief time constant for 1D model of velocity dynamics
-  const double wz_delay_;              //!< @brief time delay for angular-velocity command [s]
-  const double wz_time_constant_;      //!< @brief time constant for 1D model of angular-velocity dynamics
+  InputDelayBuffer vx_input_buffer_;  //!< @brief buffer for velocity command
+  InputDelayBuffer wz_input_buffer_;  //!< @brief buffer for angular velocity command
+  const double vx_delay_;             //!< @brief time delay for velocity command [s]
+  const double vx_time_constant_;     //!< @brief time constant for 1D model of velocity dynamics
+  const double wz_delay_;             //!< @brief time delay for angular-velocity command [s]
+  const double wz_time_constant_;     //!< @brief time constant for 1D model of angular-velocity dynamics
 
   /**
    * @brief set queue buffer for input command
    * @param [in] dt delta time
+   * @param [in] interpolate_delay interpolate the commands of a delay between two updates
    */
-  void initializeInputQueue(const double& dt);
+  void initializeInputQueue(const double& dt, const bool interpolate_delay);
 
   /**
    * @brief get vehicle position x
@@ -131,6 +166,17 @@ private:
    * @param [in] input input vector to model
    */
   Eigen::VectorXd calcModel(const Eigen::VectorXd& state, const Eigen::VectorXd& input) override;
+  /**
+   * @brief calculate derivative of states and its jacobians with time delay twist model
+   * @param [in] state current model state
+   * @param [in] input input vector to model
+   * @param [out] d_state derivative of states
+   * @param [out] jac_x jacobian of d_state by state
+   * @param [out] jac_u jacobian of d_state by input
+   */
+  bool calcModelJacobian(const Eigen::Ref<const Eigen::VectorXd>& state,
+                         const Eigen::Ref<const Eigen::VectorXd>& input, StateVector* d_state, StateMatrix* jac_x,
+                         InputMatrix* jac_u) const override;
 };
 
 class VehicleModelTimeDelaySteer : public VehicleModelInterface
@@ -148,11 +194,12 @@ public:
    * @param [in] vx_time_constant time constant for 1D model of velocity dynamics
    * @param [in] steer_delay time delay for steering command [s]
    * @param [in] steer_time_constant time constant for 1D model of steering dynamics
+   * @param [in] interpolate_delay interpolate the commands of a delay between two updates, else round it to dt
    */
   VehicleModelTimeDelaySteer(
     double vx_lim, double steer_lim, double vx_rate_lim, double steer_rate_lim, double wheelbase,
     double dt, double vx_delay, double vx_time_constant, double steer_delay,
-    double steer_time_constant);
+    double steer_time_constant, bool interpolate_delay = false);
 
   /**
    * @brief default destructor
@@ -182,18 +229,19 @@ private:
   const double steer_rate_lim_;  //!< @brief steering angular velocity limit [rad/s]
   const double wheelbase_;       //!< @brief vehicle wheelbase length [m]
 
-  std::deque<double> vx_input_queue_;     //!< @brief buffer for velocity command
-  std::deque<double> steer_input_queue_;  //!< @brief buffer for steering command
-  const double vx_delay_;                 //!< @brief time delay for velocity command [s]
-  const double vx_time_constant_;         //!< @brief time constant for 1D model of velocity dynamics
-  const double steer_delay_;              //!< @brief time delay for steering command [s]
-  const double steer_time_constant_;      //!< @brief time constant for 1D model of steering dynamics
+  InputDelayBuffer vx_input_buffer_;     //!< @brief buffer for velocity command
+  InputDelayBuffer steer_input_buffer_;  //!< @brief buffer for steering command
+  const double vx_delay_;                //!< @brief time delay for velocity command [s]
+  const double vx_time_constant_;        //!< @brief time constant for 1D model of velocity dynamics
+  const double steer_delay_;             //!< @brief time delay for steering command [s]
+  const double steer_time_constant_;     //!< @brief time constant for 1D model of steering dynamics
 
   /**
    * @brief set queue buffer for input command
    * @param [in] dt delta time
+   * @param [in] interpolate_delay interpolate the commands of a delay between two updates
    */
-  void initializeInputQueue(const double& dt);
+  void initializeInputQueue(const double& dt, const bool interpolate_delay);
 
   /**
    * @brief get vehicle position x
@@ -237,6 +285,17 @@ private:
    * @param [in] input input vector to model
    */
   Eigen::VectorXd calcModel(const Eigen::VectorXd& state, const Eigen::VectorXd& input) override;
+  /**
+   * @brief calculate derivative of states and its jacobians with time delay steering model
+   * @param [in] state current model state
+   * @param [in] input input vector to model
+   * @param [out] d_state derivative of states
+   * @param [out] jac_x jacobian of d_state by state
+   * @param [out] jac_u jacobian of d_state by input
+   */
+  bool calcModelJacobian(const Eigen::Ref<const Eigen::VectorXd>& state,
+                         const Eigen::Ref<const Eigen::VectorXd>& input, StateVector* d_state, StateMatrix* jac_x,
+                         InputMatrix* jac_u) const override;
 };
 
 #endif  // VEHICLE_SIM_MODEL_VEHICLE_MODEL_TIME_DELAY_H
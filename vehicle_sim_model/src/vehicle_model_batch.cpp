@@ -0,0 +1,144 @@
+/*
+ * Copyright 2018-2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "vehicle_sim_model/vehicle_model_batch.h"
+
+constexpr int VehicleBatchModelIdealTwist::DIM_X;
+constexpr int VehicleBatchModelIdealTwist::DIM_U;
+constexpr int VehicleBatchModelIdealSteer::DIM_X;
+constexpr int VehicleBatchModelIdealSteer::DIM_U;
+constexpr int VehicleBatchModelConstantAccelTwist::DIM_X;
+constexpr int VehicleBatchModelConstantAccelTwist::DIM_U;
+constexpr int VehicleBatchModelTimeDelayTwist::DIM_X;
+constexpr int VehicleBatchModelTimeDelayTwist::DIM_U;
+constexpr int VehicleBatchModelTimeDelaySteer::DIM_X;
+constexpr int VehicleBatchModelTimeDelaySteer::DIM_U;
+
+VehicleModelBatchWorkers::VehicleModelBatchWorkers(int num_threads)
+  : task_(nullptr), num_tasks_(0), next_task_(0), busy_workers_(0), generation_(0), stop_(false)
+{
+  if (num_threads <= 0)
+  {
+    num_threads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+  }
+  for (int i = 1; i < num_threads; ++i)
+  {
+    workers_.emplace_back(&VehicleModelBatchWorkers::workerLoop, this);
+  }
+}
+
+VehicleModelBatchWorkers::~VehicleModelBatchWorkers()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  start_cv_.notify_all();
+  for (auto& worker : workers_)
+  {
+    worker.join();
+  }
+}
+
+int VehicleModelBatchWorkers::getNumThreads() const
+{
+  return static_cast<int>(workers_.size()) + 1;
+}
+
+void VehicleModelBatchWorkers::run(int n, const std::function<void(int)>& task)
+{
+  if (workers_.empty() || n <= 1)
+  {
+    for (int i = 0; i < n; ++i)
+    {
+      task(i);
+    }
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    task_ = &task;
+    num_tasks_ = n;
+    next_task_ = 0;
+    busy_workers_ = static_cast<int>(workers_.size());
+    exception_ = nullptr;
+    ++generation_;
+  }
+  start_cv_.notify_all();
+  runTasks();
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  done_cv_.wait(lock, [this]() { return busy_workers_ == 0; });
+  task_ = nullptr;
+  if (exception_)
+  {
+    std::exception_ptr exception = exception_;
+    exception_ = nullptr;
+    std::rethrow_exception(exception);
+  }
+}
+
+void VehicleModelBatchWorkers::workerLoop()
+{
+  unsigned long generation = 0;
+  while (true)
+  {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      start_cv_.wait(lock, [this, &generation]() { return stop_ || generation_ != generation; });
+      if (stop_)
+      {
+        return;
+      }
+      generation = generation_;
+    }
+    runTasks();
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      --busy_workers_;
+    }
+    done_cv_.notify_one();
+  }
+}
+
+void VehicleModelBatchWorkers::runTasks()
+{
+  while (true)
+  {
+    int i;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (next_task_ >= num_tasks_)
+      {
+        return;
+      }
+      i = next_task_++;
+    }
+    try
+    {
+      (*task_)(i);
+    }
+    catch (...)
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (!exception_)
+      {
+        exception_ = std::current_exception();
+      }
+    }
+  }
+}
@@ -0,0 +1,146 @@
+/*
+ * Copyright 2018-2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file vehicle_model_batch_benchmark.cpp
+ * @brief throughput of each vehicle model, one VehicleModelInterface per vehicle against VehicleModelBatch
+ *
+ * vehicle_model_batch_benchmark [num_vehicles] [steps] [num_threads]
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "vehicle_sim_model/vehicle_model_batch.h"
+#include "vehicle_sim_model/vehicle_model_constant_acceleration.h"
+#include "vehicle_sim_model/vehicle_model_ideal.h"
+#include "vehicle_sim_model/vehicle_model_time_delay.h"
+
+namespace
+{
+const double DT = 0.03;
+
+double elapsedSec(const std::chrono::steady_clock::time_point& start)
+{
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+template <class Model, class MakeVehicle>
+void benchmark(const std::string& name, const Model& model, const MakeVehicle& make_vehicle, int num_vehicles,
+               int steps, int num_threads)
+{
+  using Batch = VehicleModelBatch<Model>;
+  typename Batch::InputArray input(num_vehicles, Batch::DIM_U);
+  for (int i = 0; i < num_vehicles; ++i)
+  {
+    input(i, 0) = 1.0 + 9.0 * i / num_vehicles;
+    input(i, 1) = 0.3 * (2.0 * i / num_vehicles - 1.0);
+  }
+
+  std::vector<std::shared_ptr<VehicleModelInterface>> vehicles;
+  for (int i = 0; i < num_vehicles; ++i)
+  {
+    vehicles.emplace_back(make_vehicle());
+    Eigen::VectorXd vehicle_input(2);
+    vehicle_input << input(i, 0), input(i, 1);
+    vehicles.back()->setInput(vehicle_input);
+  }
+  auto start = std::chrono::steady_clock::now();
+  for (int step = 0; step < steps; ++step)
+  {
+    for (auto& vehicle : vehicles)
+    {
+      vehicle->update(DT);
+    }
+  }
+  const double single_sec = elapsedSec(start);
+
+  double batch_sec[2];
+  double max_diff = 0.0;
+  const int threads[2] = { 1, num_threads };
+  for (int k = 0; k < 2; ++k)
+  {
+    Batch batch(model, num_vehicles, DT, threads[k]);
+    batch.setInput(input);
+    start = std::chrono::steady_clock::now();
+    for (int step = 0; step < steps; ++step)
+    {
+      batch.update(DT);
+    }
+    batch_sec[k] = elapsedSec(start);
+    for (int i = 0; i < num_vehicles; ++i)
+    {
+      max_diff = std::max(max_diff, (batch.getState().row(i).matrix().transpose() - vehicles[i]->getState())
+                                        .cwiseAbs().maxCoeff());
+    }
+  }
+
+  const double vehicle_steps = static_cast<double>(num_vehicles) * steps;
+  std::printf("%-28s %12.2f %12.2f %12.2f %10g\n", name.c_str(), vehicle_steps / single_sec * 1e-6,
+              vehicle_steps / batch_sec[0] * 1e-6, vehicle_steps / batch_sec[1] * 1e-6, max_diff);
+}
+}  // namespace
+
+int main(int argc, char** argv)
+{
+  const int num_vehicles = (argc > 1) ? std::atoi(argv[1]) : 4096;
+  const int steps = (argc > 2) ? std::atoi(argv[2]) : 100;
+  const int num_threads = (argc > 3) ? std::atoi(argv[3]) : 0;
+  if (num_vehicles <= 0 || steps <= 0 || num_threads < 0)
+  {
+    std::printf("usage: %s [num_vehicles] [steps] [num_threads]\n", argv[0]);
+    return 1;
+  }
+
+  const double wheelbase = 2.7, vx_lim = 10.0, wz_lim = 3.0, steer_lim = 1.0, vx_rate = 1.0, wz_rate = 1.0,
+               steer_rate_lim = 0.3, vx_delay = 0.25, vx_time_constant = 0.6, wz_delay = 0.2,
+               wz_time_constant = 0.5, steer_delay = 0.24, steer_time_constant = 0.27;
+
+  std::printf("%d vehicles, %d steps of %g s, %d threads\n", num_vehicles, steps, DT,
+              VehicleModelBatchWorkers(num_threads).getNumThreads());
+  std::printf("%-28s %12s %12s %12s %10s\n", "million vehicle steps / s", "single", "batch", "threads",
+              "max diff");
+  benchmark("IdealTwist", VehicleBatchModelIdealTwist(),
+            []() { return std::make_shared<VehicleModelIdealTwist>(); }, num_vehicles, steps, num_threads);
+  benchmark("IdealSteer", VehicleBatchModelIdealSteer(wheelbase),
+            [&]() { return std::make_shared<VehicleModelIdealSteer>(wheelbase); }, num_vehicles, steps,
+            num_threads);
+  benchmark("ConstantAccelTwist", VehicleBatchModelConstantAccelTwist(vx_lim, wz_lim, vx_rate, wz_rate),
+            [&]() { return std::make_shared<VehicleModelConstantAccelTwist>(vx_lim, wz_lim, vx_rate, wz_rate); },
+            num_vehicles, steps, num_threads);
+  benchmark("TimeDelayTwist",
+            VehicleBatchModelTimeDelayTwist(vx_lim, wz_lim, vx_rate, wz_rate, vx_delay, vx_time_constant, wz_delay,
+                                            wz_time_constant),
+            [&]() {
+              return std::make_shared<VehicleModelTimeDelayTwist>(vx_lim, wz_lim, vx_rate, wz_rate, DT, vx_delay,
+                                                                  vx_time_constant, wz_delay, wz_time_constant);
+            },
+            num_vehicles, steps, num_threads);
+  benchmark("TimeDelaySteer",
+            VehicleBatchModelTimeDelaySteer(vx_lim, steer_lim, vx_rate, steer_rate_lim, wheelbase, vx_delay,
+                                            vx_time_constant, steer_delay, steer_time_constant),
+            [&]() {
+              return std::make_shared<VehicleModelTimeDelaySteer>(vx_lim, steer_lim, vx_rate, steer_rate_lim,
+                                                                  wheelbase, DT, vx_delay, vx_time_constant,
+                                                                  steer_delay, steer_time_constant);
+            },
+            num_vehicles, steps, num_threads);
+  return 0;
+}
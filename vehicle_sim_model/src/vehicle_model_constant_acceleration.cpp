@@ -17,6 +17,7 @@
 
 #include "vehicle_sim_model/vehicle_model_constant_acceleration.h"
 #include <algorithm>
+#include <cmath>
 
 VehicleModelConstantAccelTwist::VehicleModelConstantAccelTwist(
   double vx_lim, double wz_lim, double vx_rate, double wz_rate)
@@ -90,3 +91,39 @@ Eigen::VectorXd VehicleModelConstantAccelTwist::calcModel(const Eigen::VectorXd&
 
   return d_state;
 }
+bool VehicleModelConstantAccelTwist::calcModelJacobian(const Eigen::Ref<const Eigen::VectorXd>& state,
+                                                       const Eigen::Ref<const Eigen::VectorXd>& input,
+                                                       StateVector* d_state, StateMatrix* jac_x,
+                                                       InputMatrix* jac_u) const
+{
+  const double vel = state(static_cast<Eigen::Index>(IDX::VX));
+  const double angvel = state(static_cast<Eigen::Index>(IDX::WZ));
+  const double yaw = state(static_cast<Eigen::Index>(IDX::YAW));
+  const double vx_des = std::max(std::min(input(static_cast<Eigen::Index>(IDX_U::VX_DES)), vx_lim_), -vx_lim_);
+  const double wz_des = std::max(std::min(input(static_cast<Eigen::Index>(IDX_U::WZ_DES)), wz_lim_), -wz_lim_);
+  const double cos_yaw = std::cos(yaw);
+  const double sin_yaw = std::sin(yaw);
+  const Eigen::Index x = static_cast<Eigen::Index>(IDX::X);
+  const Eigen::Index y = static_cast<Eigen::Index>(IDX::Y);
+  const Eigen::Index th = static_cast<Eigen::Index>(IDX::YAW);
+  const Eigen::Index vx = static_cast<Eigen::Index>(IDX::VX);
+  const Eigen::Index wz = static_cast<Eigen::Index>(IDX::WZ);
+
+  d_state->resize(dim_x_);
+  (*d_state)(x) = vel * cos_yaw;
+  (*d_state)(y) = vel * sin_yaw;
+  (*d_state)(th) = angvel;
+  (*d_state)(vx) = (vx_des > vel) ? vx_rate_ : ((vx_des < vel) ? -vx_rate_ : 0.0);
+  (*d_state)(wz) = (wz_des > angvel) ? wz_rate_ : ((wz_des < angvel) ? -wz_rate_ : 0.0);
+
+  // the accelerations are constant apart from their switches, they do not depend on the state or the input
+  jac_x->setZero(dim_x_, dim_x_);
+  (*jac_x)(x, th) = -vel * sin_yaw;
+  (*jac_x)(x, vx) = cos_yaw;
+  (*jac_x)(y, th) = vel * cos_yaw;
+  (*jac_x)(y, vx) = sin_yaw;
+  (*jac_x)(th, wz) = 1.0;
+
+  jac_u->setZero(dim_x_, dim_u_);
+  return true;
+}
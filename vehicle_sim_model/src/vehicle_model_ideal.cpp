@@ -16,6 +16,7 @@
  */
 
 #include "vehicle_sim_model/vehicle_model_ideal.h"
+#include <cmath>
 
 VehicleModelIdealTwist::VehicleModelIdealTwist() : VehicleModelInterface(3 /* dim x */, 2 /* dim u */) {}
 
@@ -60,6 +61,34 @@ Eigen::VectorXd VehicleModelIdealTwist::calcModel(const Eigen::VectorXd& state,
 
   return d_state;
 }
+bool VehicleModelIdealTwist::calcModelJacobian(const Eigen::Ref<const Eigen::VectorXd>& state,
+                                               const Eigen::Ref<const Eigen::VectorXd>& input, StateVector* d_state,
+                                               StateMatrix* jac_x, InputMatrix* jac_u) const
+{
+  const double yaw = state(static_cast<Eigen::Index>(IDX::YAW));
+  const double vx = input(static_cast<Eigen::Index>(IDX_U::VX_DES));
+  const double wz = input(static_cast<Eigen::Index>(IDX_U::WZ_DES));
+  const double cos_yaw = std::cos(yaw);
+  const double sin_yaw = std::sin(yaw);
+  const Eigen::Index x = static_cast<Eigen::Index>(IDX::X);
+  const Eigen::Index y = static_cast<Eigen::Index>(IDX::Y);
+  const Eigen::Index th = static_cast<Eigen::Index>(IDX::YAW);
+
+  d_state->resize(dim_x_);
+  (*d_state)(x) = vx * cos_yaw;
+  (*d_state)(y) = vx * sin_yaw;
+  (*d_state)(th) = wz;
+
+  jac_x->setZero(dim_x_, dim_x_);
+  (*jac_x)(x, th) = -vx * sin_yaw;
+  (*jac_x)(y, th) = vx * cos_yaw;
+
+  jac_u->setZero(dim_x_, dim_u_);
+  (*jac_u)(x, static_cast<Eigen::Index>(IDX_U::VX_DES)) = cos_yaw;
+  (*jac_u)(y, static_cast<Eigen::Index>(IDX_U::VX_DES)) = sin_yaw;
+  (*jac_u)(th, static_cast<Eigen::Index>(IDX_U::WZ_DES)) = 1.0;
+  return true;
+}
 
 VehicleModelIdealSteer::VehicleModelIdealSteer(double wheelbase)
   : VehicleModelInterface(3 /* dim x */, 2 /* dim u */), wheelbase_(wheelbase) {}
@@ -106,3 +135,33 @@ Eigen::VectorXd VehicleModelIdealSteer::calcModel(const Eigen::VectorXd& state,
 
   return d_state;
 }
+bool VehicleModelIdealSteer::calcModelJacobian(const Eigen::Ref<const Eigen::VectorXd>& state,
+                                               const Eigen::Ref<const Eigen::VectorXd>& input, StateVector* d_state,
+                                               StateMatrix* jac_x, InputMatrix* jac_u) const
+{
+  const double yaw = state(static_cast<Eigen::Index>(IDX::YAW));
+  const double vx = input(static_cast<Eigen::Index>(IDX_U::VX_DES));
+  const double steer = input(static_cast<Eigen::Index>(IDX_U::STEER_DES));
+  const double cos_yaw = std::cos(yaw);
+  const double sin_yaw = std::sin(yaw);
+  const double cos_steer = std::cos(steer);
+  const Eigen::Index x = static_cast<Eigen::Index>(IDX::X);
+  const Eigen::Index y = static_cast<Eigen::Index>(IDX::Y);
+  const Eigen::Index th = static_cast<Eigen::Index>(IDX::YAW);
+
+  d_state->resize(dim_x_);
+  (*d_state)(x) = vx * cos_yaw;
+  (*d_state)(y) = vx * sin_yaw;
+  (*d_state)(th) = vx * std::tan(steer) / wheelbase_;
+
+  jac_x->setZero(dim_x_, dim_x_);
+  (*jac_x)(x, th) = -vx * sin_yaw;
+  (*jac_x)(y, th) = vx * cos_yaw;
+
+  jac_u->setZero(dim_x_, dim_u_);
+  (*jac_u)(x, static_cast<Eigen::Index>(IDX_U::VX_DES)) = cos_yaw;
+  (*jac_u)(y, static_cast<Eigen::Index>(IDX_U::VX_DES)) = sin_yaw;
+  (*jac_u)(th, static_cast<Eigen::Index>(IDX_U::VX_DES)) = std::tan(steer) / wheelbase_;
+  (*jac_u)(th, static_cast<Eigen::Index>(IDX_U::STEER_DES)) = vx / (wheelbase_ * cos_steer * cos_steer);
+  return true;
+}
@@ -16,6 +16,9 @@
 
 #include "vehicle_sim_model/vehicle_model_interface.h"
 
+#include <algorithm>
+#include <cmath>
+
 VehicleModelInterface::VehicleModelInterface(int dim_x, int dim_u) : dim_x_(dim_x), dim_u_(dim_u)
 {
   state_ = Eigen::VectorXd::Zero(dim_x_);
@@ -51,3 +54,58 @@ void VehicleModelInterface::setInput(const Eigen::VectorXd& input)
 {
   input_ = input;
 }
+bool VehicleModelInterface::calcModelJacobian(const Eigen::Ref<const Eigen::VectorXd>& /* state */,
+                                              const Eigen::Ref<const Eigen::VectorXd>& /* input */,
+                                              StateVector* /* d_state */, StateMatrix* /* jac_x */,
+                                              InputMatrix* /* jac_u */) const
+{
+  return false;
+}
+void VehicleModelInterface::calcLinearizedModel(const double& dt, const Eigen::Ref<const Eigen::VectorXd>& state,
+                                                const Eigen::Ref<const Eigen::VectorXd>& input, StateMatrix* Ad,
+                                                InputMatrix* Bd, StateVector* Wd)
+{
+  StateVector d_state;
+  if (!calcModelJacobian(state, input, &d_state, Ad, Bd))
+  {
+    calcLinearizedModelNumerical(dt, state, input, Ad, Bd, Wd);
+    return;
+  }
+
+  // x_{k+1} = x_k + (d_state + jac_x * (x_k - state) + jac_u * (u_k - input)) * dt
+  *Wd = (d_state - (*Ad) * state - (*Bd) * input) * dt;
+  *Ad *= dt;
+  *Bd *= dt;
+  Ad->diagonal().array() += 1.0;
+}
+void VehicleModelInterface::calcLinearizedModelNumerical(const double& dt,
+                                                         const Eigen::Ref<const Eigen::VectorXd>& state,
+                                                         const Eigen::Ref<const Eigen::VectorXd>& input,
+                                                         StateMatrix* Ad, InputMatrix* Bd, StateVector* Wd)
+{
+  const double eps = 1e-6;
+  Ad->resize(dim_x_, dim_x_);
+  Bd->resize(dim_x_, dim_u_);
+  Eigen::VectorXd x = state;
+  Eigen::VectorXd u = input;
+  for (int i = 0; i < dim_x_; ++i)
+  {
+    const double h = eps * std::max(1.0, std::fabs(x(i)));
+    x(i) = state(i) + h;
+    const Eigen::VectorXd d_plus = calcModel(x, u);
+    x(i) = state(i) - h;
+    Ad->col(i) = (d_plus - calcModel(x, u)) * (dt / (2.0 * h));
+    x(i) = state(i);
+  }
+  for (int i = 0; i < dim_u_; ++i)
+  {
+    const double h = eps * std::max(1.0, std::fabs(u(i)));
+    u(i) = input(i) + h;
+    const Eigen::VectorXd d_plus = calcModel(x, u);
+    u(i) = input(i) - h;
+    Bd->col(i) = (d_plus - calcModel(x, u)) * (dt / (2.0 * h));
+    u(i) = input(i);
+  }
+  Ad->diagonal().array() += 1.0;
+  *Wd = state + calcModel(x, u) * dt - (*Ad) * state - (*Bd) * input;
+}
@@ -0,0 +1,133 @@
+/*
+ * Copyright 2018-2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file vehicle_model_linearization_benchmark.cpp
+ * @brief throughput of the discrete-time linearization of each vehicle model, analytic against finite differences
+ *
+ * vehicle_model_linearization_benchmark [horizon] [repeats]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "vehicle_sim_model/vehicle_model_constant_acceleration.h"
+#include "vehicle_sim_model/vehicle_model_ideal.h"
+#include "vehicle_sim_model/vehicle_model_time_delay.h"
+
+namespace
+{
+const double DT = 0.1;
+
+double elapsedSec(const std::chrono::steady_clock::time_point& start)
+{
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void benchmark(const std::string& name, VehicleModelInterface* model, int horizon, int repeats)
+{
+  // a horizon of a curved trajectory as a MPC linearizes it at each control cycle
+  const int dim_x = model->getState().size();
+  std::vector<Eigen::VectorXd> states, inputs;
+  for (int i = 0; i < horizon; ++i)
+  {
+    const double s = static_cast<double>(i) / horizon;
+    Eigen::VectorXd state = Eigen::VectorXd::Zero(dim_x);
+    state.head(3) << 20.0 * s, 5.0 * s * s, 0.5 * s;
+    if (dim_x == 5)
+    {
+      state.tail(2) << 3.0 + 2.0 * s, 0.1 - 0.2 * s;
+    }
+    Eigen::VectorXd input(2);
+    input << 3.3 + 2.7 * s, 0.13 - 0.31 * s;
+    states.push_back(state);
+    inputs.push_back(input);
+  }
+
+  std::vector<VehicleModelInterface::StateMatrix> Ad(horizon), Ad_num(horizon);
+  std::vector<VehicleModelInterface::InputMatrix> Bd(horizon), Bd_num(horizon);
+  std::vector<VehicleModelInterface::StateVector> Wd(horizon), Wd_num(horizon);
+  auto start = std::chrono::steady_clock::now();
+  for (int r = 0; r < repeats; ++r)
+  {
+    for (int i = 0; i < horizon; ++i)
+    {
+      model->calcLinearizedModel(DT, states[i], inputs[i], &Ad[i], &Bd[i], &Wd[i]);
+    }
+  }
+  const double analytic_sec = elapsedSec(start);
+
+  start = std::chrono::steady_clock::now();
+  for (int r = 0; r < repeats; ++r)
+  {
+    for (int i = 0; i < horizon; ++i)
+    {
+      model->calcLinearizedModelNumerical(DT, states[i], inputs[i], &Ad_num[i], &Bd_num[i], &Wd_num[i]);
+    }
+  }
+  const double numerical_sec = elapsedSec(start);
+
+  double max_diff = 0.0;
+  for (int i = 0; i < horizon; ++i)
+  {
+    max_diff = std::max(max_diff, (Ad[i] - Ad_num[i]).cwiseAbs().maxCoeff());
+    max_diff = std::max(max_diff, (Bd[i] - Bd_num[i]).cwiseAbs().maxCoeff());
+    max_diff = std::max(max_diff, (Wd[i] - Wd_num[i]).cwiseAbs().maxCoeff());
+  }
+
+  const double linearizations = static_cast<double>(horizon) * repeats;
+  std::printf("%-28s %12.2f %12.2f %9.1fx %10g\n", name.c_str(), linearizations / analytic_sec * 1e-6,
+              linearizations / numerical_sec * 1e-6, numerical_sec / analytic_sec, max_diff);
+}
+}  // namespace
+
+int main(int argc, char** argv)
+{
+  const int horizon = (argc > 1) ? std::atoi(argv[1]) : 50;
+  const int repeats = (argc > 2) ? std::atoi(argv[2]) : 20000;
+  if (horizon <= 0 || repeats <= 0)
+  {
+    std::printf("usage: %s [horizon] [repeats]\n", argv[0]);
+    return 1;
+  }
+
+  const double wheelbase = 2.7, vx_lim = 10.0, wz_lim = 3.0, steer_lim = 1.0, vx_rate = 1.0, wz_rate = 1.0,
+               steer_rate_lim = 0.3, vx_delay = 0.25, vx_time_constant = 0.6, wz_delay = 0.2,
+               wz_time_constant = 0.5, steer_delay = 0.24, steer_time_constant = 0.27;
+
+  std::printf("horizon of %d steps of %g s, %d times\n", horizon, DT, repeats);
+  std::printf("%-28s %12s %12s %10s %10s\n", "million linearizations / s", "analytic", "numerical", "speedup",
+              "max diff");
+  VehicleModelIdealTwist ideal_twist;
+  benchmark("IdealTwist", &ideal_twist, horizon, repeats);
+  VehicleModelIdealSteer ideal_steer(wheelbase);
+  benchmark("IdealSteer", &ideal_steer, horizon, repeats);
+  VehicleModelConstantAccelTwist const_accel_twist(vx_lim, wz_lim, vx_rate, wz_rate);
+  benchmark("ConstantAccelTwist", &const_accel_twist, horizon, repeats);
+  VehicleModelTimeDelayTwist delay_twist(vx_lim, wz_lim, vx_rate, wz_rate, DT, vx_delay, vx_time_constant, wz_delay,
+                                         wz_time_constant);
+  benchmark("TimeDelayTwist", &delay_twist, horizon, repeats);
+  VehicleModelTimeDelaySteer delay_steer(vx_lim, steer_lim, vx_rate, steer_rate_lim, wheelbase, DT, vx_delay,
+                                         vx_time_constant, steer_delay, steer_time_constant);
+  benchmark("TimeDelaySteer", &delay_steer, horizon, repeats);
+  return 0;
+}
@@ -17,6 +17,72 @@
 
 #include "vehicle_sim_model/vehicle_model_time_delay.h"
 #include <algorithm>
+#include <cmath>
+
+namespace
+{
+/**
+ * @brief derivatives of the 1D model rate = clamp(-(state - clamp(input, +-input_lim)) / time_constant, +-rate_lim)
+ * @param [in] state current state of the 1D model
+ * @param [in] input command of the 1D model
+ * @param [in] input_lim limit of the command
+ * @param [in] rate_lim limit of the rate
+ * @param [in] time_constant time constant of the 1D model
+ * @param [out] rate d state / dt
+ * @param [out] d_rate_d_state d rate / d state, zero when the rate is saturated
+ * @param [out] d_rate_d_input d rate / d input, zero when the command or the rate is saturated
+ */
+void calcFirstOrderRate(const double state, const double input, const double input_lim, const double rate_lim,
+                        const double time_constant, double* rate, double* d_rate_d_state, double* d_rate_d_input)
+{
+  const double input_des = std::max(std::min(input, input_lim), -input_lim);
+  const double raw_rate = -(state - input_des) / time_constant;
+  *rate = std::min(rate_lim, std::max(-rate_lim, raw_rate));
+  const bool rate_free = std::fabs(raw_rate) < rate_lim;
+  *d_rate_d_state = rate_free ? -1.0 / time_constant : 0.0;
+  *d_rate_d_input = (rate_free && std::fabs(input) < input_lim) ? 1.0 / time_constant : 0.0;
+}
+}  // namespace
+
+/*
+ *
+ * InputDelayBuffer
+ *
+ */
+
+InputDelayBuffer::InputDelayBuffer() : head_(0), oldest_weight_(0.0) {}
+
+void InputDelayBuffer::initialize(const double& delay, const double& dt, const bool interpolate)
+{
+  double steps = std::round(delay / dt);
+  // a delay of whole updates up to rounding errors is not interpolated
+  if (interpolate && std::fabs(delay / dt - steps) > 1e-9)
+  {
+    steps = delay / dt;
+  }
+  // between the commands of floor(steps) and floor(steps) + 1 updates ago
+  oldest_weight_ = steps - std::floor(steps);
+  buffer_.assign(static_cast<size_t>(std::ceil(steps)), 0.0);
+  head_ = 0;
+}
+
+double InputDelayBuffer::update(const double& input)
+{
+  if (buffer_.empty())
+  {
+    return input;
+  }
+  double delayed = buffer_[head_];
+  if (oldest_weight_ > 0.0)
+  {
+    const size_t next = (head_ + 1) % buffer_.size();
+    const double newer = (next == head_) ? input : buffer_[next];
+    delayed = oldest_weight_ * delayed + (1.0 - oldest_weight_) * newer;
+  }
+  buffer_[head_] = input;
+  head_ = (head_ + 1) % buffer_.size();
+  return delayed;
+}
 
 /*
  *
@@ -27,7 +93,7 @@
 VehicleModelTimeDelayTwist::VehicleModelTimeDelayTwist(
   double vx_lim, double wz_lim, double vx_rate_lim, double wz_rate_lim,
   double dt, double vx_delay, double vx_time_constant, double wz_delay,
-  double wz_time_constant)
+  double wz_time_constant, bool interpolate_delay)
   : VehicleModelInterface(5 /* dim x */, 2 /* dim u */)
   , MIN_TIME_CONSTANT(0.03)
   , vx_lim_(vx_lim)
@@ -49,7 +115,7 @@ VehicleModelTimeDelayTwist::VehicleModelTimeDelayTwist(
     std::cerr << "Settings wz_time_constant is too small, replace it by "
       << MIN_TIME_CONSTANT << std::endl;
   }
-  initializeInputQueue(dt);
+  initializeInputQueue(dt, interpolate_delay);
 }
 
 const double VehicleModelTimeDelayTwist::getX() const
@@ -80,27 +146,17 @@ void VehicleModelTimeDelayTwist::update(const double& dt)
 {
   Eigen::VectorXd delayed_input = Eigen::VectorXd::Zero(dim_u_);
 
-  vx_input_queue_.push_back(input_(static_cast<Eigen::Index>(IDX_U::VX_DES)));
-  delayed_input(static_cast<Eigen::Index>(IDX_U::VX_DES)) = vx_input_queue_.front();
-  vx_input_queue_.pop_front();
-  wz_input_queue_.push_back(input_(static_cast<Eigen::Index>(IDX_U::WZ_DES)));
-  delayed_input(static_cast<Eigen::Index>(IDX_U::WZ_DES)) = wz_input_queue_.front();
-  wz_input_queue_.pop_front();
+  delayed_input(static_cast<Eigen::Index>(IDX_U::VX_DES)) =
+    vx_input_buffer_.update(input_(static_cast<Eigen::Index>(IDX_U::VX_DES)));
+  delayed_input(static_cast<Eigen::Index>(IDX_U::WZ_DES)) =
+    wz_input_buffer_.update(input_(static_cast<Eigen::Index>(IDX_U::WZ_DES)));
 
   updateRungeKutta(dt, delayed_input);
 }
-void VehicleModelTimeDelayTwist::initializeInputQueue(const double& dt)
+void VehicleModelTimeDelayTwist::initializeInputQueue(const double& dt, const bool interpolate_delay)
 {
-  size_t vx_input_queue_size = static_cast<size_t>(round(vx_delay_ / dt));
-  for (size_t i = 0; i < vx_input_queue_size; i++)
-  {
-    vx_input_queue_.push_back(0.0);
-  }
-  size_t wz_input_queue_size = static_cast<size_t>(round(wz_delay_ / dt));
-  for (size_t i = 0; i < wz_input_queue_size; i++)
-  {
-    wz_input_queue_.push_back(0.0);
-  }
+  vx_input_buffer_.initialize(vx_delay_, dt, interpolate_delay);
+  wz_input_buffer_.initialize(wz_delay_, dt, interpolate_delay);
 }
 
 Eigen::VectorXd VehicleModelTimeDelayTwist::calcModel(const Eigen::VectorXd& state, const Eigen::VectorXd& input)
@@ -127,6 +183,42 @@ Eigen::VectorXd VehicleModelTimeDelayTwist::calcModel(const Eigen::VectorXd& sta
   return d_state;
 };
 
+bool VehicleModelTimeDelayTwist::calcModelJacobian(const Eigen::Ref<const Eigen::VectorXd>& state,
+                                                   const Eigen::Ref<const Eigen::VectorXd>& input,
+                                                   StateVector* d_state, StateMatrix* jac_x,
+                                                   InputMatrix* jac_u) const
+{
+  const Eigen::Index x = static_cast<Eigen::Index>(IDX::X);
+  const Eigen::Index y = static_cast<Eigen::Index>(IDX::Y);
+  const Eigen::Index th = static_cast<Eigen::Index>(IDX::YAW);
+  const Eigen::Index vx = static_cast<Eigen::Index>(IDX::VX);
+  const Eigen::Index wz = static_cast<Eigen::Index>(IDX::WZ);
+  const Eigen::Index vx_des = static_cast<Eigen::Index>(IDX_U::VX_DES);
+  const Eigen::Index wz_des = static_cast<Eigen::Index>(IDX_U::WZ_DES);
+  const double vel = state(vx);
+  const double yaw = state(th);
+  const double cos_yaw = std::cos(yaw);
+  const double sin_yaw = std::sin(yaw);
+
+  d_state->resize(dim_x_);
+  jac_x->setZero(dim_x_, dim_x_);
+  jac_u->setZero(dim_x_, dim_u_);
+  (*d_state)(x) = vel * cos_yaw;
+  (*d_state)(y) = vel * sin_yaw;
+  (*d_state)(th) = state(wz);
+  calcFirstOrderRate(vel, input(vx_des), vx_lim_, vx_rate_lim_, vx_time_constant_, &(*d_state)(vx),
+                     &(*jac_x)(vx, vx), &(*jac_u)(vx, vx_des));
+  calcFirstOrderRate(state(wz), input(wz_des), wz_lim_, wz_rate_lim_, wz_time_constant_, &(*d_state)(wz),
+                     &(*jac_x)(wz, wz), &(*jac_u)(wz, wz_des));
+
+  (*jac_x)(x, th) = -vel * sin_yaw;
+  (*jac_x)(x, vx) = cos_yaw;
+  (*jac_x)(y, th) = vel * cos_yaw;
+  (*jac_x)(y, vx) = sin_yaw;
+  (*jac_x)(th, wz) = 1.0;
+  return true;
+}
+
 /*
  *
  * VehicleModelTimeDelaySteer
@@ -136,7 +228,7 @@ VehicleModelTimeDelaySteer::VehicleModelTimeDelaySteer(
   double vx_lim, double steer_lim, double vx_rate_lim,
   double steer_rate_lim, double wheelbase, double dt, double vx_delay,
   double vx_time_constant, double steer_delay,
-  double steer_time_constant)
+  double steer_time_constant, bool interpolate_delay)
   : VehicleModelInterface(5 /* dim x */, 2 /* dim u */)
   , MIN_TIME_CONSTANT(0.03)
   , vx_lim_(vx_lim)
@@ -160,7 +252,7 @@ VehicleModelTimeDelaySteer::VehicleModelTimeDelaySteer(
       << MIN_TIME_CONSTANT << std::endl;
   }
 
-  initializeInputQueue(dt);
+  initializeInputQueue(dt, interpolate_delay);
 }
 
 const double VehicleModelTimeDelaySteer::getX() const
@@ -192,27 +284,17 @@ void VehicleModelTimeDelaySteer::update(const double& dt)
 {
   Eigen::VectorXd delayed_input = Eigen::VectorXd::Zero(dim_u_);
 
-  vx_input_queue_.push_back(input_(static_cast<Eigen::Index>(IDX_U::VX_DES)));
-  delayed_input(static_cast<Eigen::Index>(IDX_U::VX_DES)) = vx_input_queue_.front();
-  vx_input_queue_.pop_front();
-  steer_input_queue_.push_back(input_(static_cast<Eigen::Index>(IDX_U::STEER_DES)));
-  delayed_input(static_cast<Eigen::Index>(IDX_U::STEER_DES)) = steer_input_queue_.front();
-  steer_input_queue_.pop_front();
+  delayed_input(static_cast<Eigen::Index>(IDX_U::VX_DES)) =
+    vx_input_buffer_.update(input_(static_cast<Eigen::Index>(IDX_U::VX_DES)));
+  delayed_input(static_cast<Eigen::Index>(IDX_U::STEER_DES)) =
+    steer_input_buffer_.update(input_(static_cast<Eigen::Index>(IDX_U::STEER_DES)));
 
   updateRungeKutta(dt, delayed_input);
 }
-void VehicleModelTimeDelaySteer::initializeInputQueue(const double& dt)
+void VehicleModelTimeDelaySteer::initializeInputQueue(const double& dt, const bool interpolate_delay)
 {
-  size_t vx_input_queue_size = static_cast<size_t>(round(vx_delay_ / dt));
-  for (size_t i = 0; i < vx_input_queue_size; i++)
-  {
-    vx_input_queue_.push_back(0.0);
-  }
-  size_t steer_input_queue_size = static_cast<size_t>(round(steer_delay_ / dt));
-  for (size_t i = 0; i < steer_input_queue_size; i++)
-  {
-    steer_input_queue_.push_back(0.0);
-  }
+  vx_input_buffer_.initialize(vx_delay_, dt, interpolate_delay);
+  steer_input_buffer_.initialize(steer_delay_, dt, interpolate_delay);
 }
 
 Eigen::VectorXd VehicleModelTimeDelaySteer::calcModel(const Eigen::VectorXd& state, const Eigen::VectorXd& input)
@@ -238,3 +320,42 @@ Eigen::VectorXd VehicleModelTimeDelaySteer::calcModel(const Eigen::VectorXd& sta
 
   return d_state;
 }
+bool VehicleModelTimeDelaySteer::calcModelJacobian(const Eigen::Ref<const Eigen::VectorXd>& state,
+                                                   const Eigen::Ref<const Eigen::VectorXd>& input,
+                                                   StateVector* d_state, StateMatrix* jac_x,
+                                                   InputMatrix* jac_u) const
+{
+  const Eigen::Index x = static_cast<Eigen::Index>(IDX::X);
+  const Eigen::Index y = static_cast<Eigen::Index>(IDX::Y);
+  const Eigen::Index th = static_cast<Eigen::Index>(IDX::YAW);
+  const Eigen::Index vx = static_cast<Eigen::Index>(IDX::VX);
+  const Eigen::Index st = static_cast<Eigen::Index>(IDX::STEER);
+  const Eigen::Index vx_des = static_cast<Eigen::Index>(IDX_U::VX_DES);
+  const Eigen::Index steer_des = static_cast<Eigen::Index>(IDX_U::STEER_DES);
+  const double vel = state(vx);
+  const double yaw = state(th);
+  const double steer = state(st);
+  const double cos_yaw = std::cos(yaw);
+  const double sin_yaw = std::sin(yaw);
+  const double cos_steer = std::cos(steer);
+  const double tan_steer = std::tan(steer);
+
+  d_state->resize(dim_x_);
+  jac_x->setZero(dim_x_, dim_x_);
+  jac_u->setZero(dim_x_, dim_u_);
+  (*d_state)(x) = vel * cos_yaw;
+  (*d_state)(y) = vel * sin_yaw;
+  (*d_state)(th) = vel * tan_steer / wheelbase_;
+  calcFirstOrderRate(vel, input(vx_des), vx_lim_, vx_rate_lim_, vx_time_constant_, &(*d_state)(vx),
+                     &(*jac_x)(vx, vx), &(*jac_u)(vx, vx_des));
+  calcFirstOrderRate(steer, input(steer_des), steer_lim_, steer_rate_lim_, steer_time_constant_, &(*d_state)(st),
+                     &(*jac_x)(st, st), &(*jac_u)(st, steer_des));
+
+  (*jac_x)(x, th) = -vel * sin_yaw;
+  (*jac_x)(x, vx) = cos_yaw;
+  (*jac_x)(y, th) = vel * cos_yaw;
+  (*jac_x)(y, vx) = sin_yaw;
+  (*jac_x)(th, vx) = tan_steer / wheelbase_;
+  (*jac_x)(th, st) = vel / (wheelbase_ * cos_steer * cos_steer);
+  return true;
+}
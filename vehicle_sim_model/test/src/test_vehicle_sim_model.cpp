@@ -15,12 +15,15 @@
  */
 
 #include <cmath>
+#include <deque>
 #include <gtest/gtest.h>
 #include <iostream>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "vehicle_sim_model/vehicle_model_interface.h"
+#include "vehicle_sim_model/vehicle_model_batch.h"
 #include "vehicle_sim_model/vehicle_model_ideal.h"
 #include "vehicle_sim_model/vehicle_model_time_delay.h"
 #include "vehicle_sim_model/vehicle_model_constant_acceleration.h"
@@ -209,6 +212,117 @@ public:
     checkTurn(y_threshold);
   }
 
+  template <class Model>
+  void testBatch(const Model& model)
+  {
+    // vehicles of different inputs, more than one block, on the caller and a worker thread
+    const int num_vehicles = 150;
+    VehicleModelBatch<Model> batch(model, num_vehicles, dt_, 2);
+    typename VehicleModelBatch<Model>::InputArray input(num_vehicles, 2);
+    std::vector<std::shared_ptr<VehicleModelInterface>> vehicles;
+    for (int i = 0; i < num_vehicles; ++i)
+    {
+      input(i, 0) = -3.0 + 6.0 * i / num_vehicles;
+      input(i, 1) = 0.2 - 0.4 * i / num_vehicles;
+      resetVehicleModel();
+      vehicles.push_back(vehicle_model_ptr_);
+    }
+
+    for (int step = 0; step < 150; ++step)
+    {
+      // the input changes to check the delay buffers
+      if (step == 50)
+      {
+        input.col(0) *= -1.0;
+      }
+      batch.setInput(input);
+      batch.update(dt_);
+      for (int i = 0; i < num_vehicles; ++i)
+      {
+        Eigen::VectorXd vehicle_input(2);
+        vehicle_input << input(i, 0), input(i, 1);
+        vehicles[i]->setInput(vehicle_input);
+        vehicles[i]->update(dt_);
+      }
+    }
+
+    for (int i = 0; i < num_vehicles; ++i)
+    {
+      const Eigen::VectorXd& state = vehicles[i]->getState();
+      ASSERT_EQ(state.size(), batch.getState().cols());
+      for (int j = 0; j < state.size(); ++j)
+      {
+        ASSERT_DOUBLE_EQ(state(j), batch.getState()(i, j)) << "vehicle " << i << ", state " << j;
+      }
+    }
+  }
+
+  void checkLinearization(const Eigen::VectorXd& state, const Eigen::VectorXd& input)
+  {
+    VehicleModelInterface::StateMatrix Ad;
+    VehicleModelInterface::InputMatrix Bd;
+    VehicleModelInterface::StateVector Wd;
+    vehicle_model_ptr_->calcLinearizedModel(dt_, state, input, &Ad, &Bd, &Wd);
+    ASSERT_EQ(state.size(), Ad.rows());
+    ASSERT_EQ(state.size(), Ad.cols());
+    ASSERT_EQ(state.size(), Bd.rows());
+    ASSERT_EQ(input.size(), Bd.cols());
+
+    // central differences of the Euler update
+    const double h = 1e-6;
+    const Eigen::VectorXd next = state + vehicle_model_ptr_->calcModel(state, input) * dt_;
+    for (int i = 0; i < state.size(); ++i)
+    {
+      Eigen::VectorXd plus = state, minus = state;
+      plus(i) += h;
+      minus(i) -= h;
+      const Eigen::VectorXd column = (vehicle_model_ptr_->calcModel(plus, input) -
+                                      vehicle_model_ptr_->calcModel(minus, input)) * dt_ / (2.0 * h);
+      for (int j = 0; j < state.size(); ++j)
+      {
+        ASSERT_NEAR(column(j) + (i == j ? 1.0 : 0.0), Ad(j, i), 1e-7) << "Ad(" << j << ", " << i << ")";
+      }
+    }
+    for (int i = 0; i < input.size(); ++i)
+    {
+      Eigen::VectorXd plus = input, minus = input;
+      plus(i) += h;
+      minus(i) -= h;
+      const Eigen::VectorXd column = (vehicle_model_ptr_->calcModel(state, plus) -
+                                      vehicle_model_ptr_->calcModel(state, minus)) * dt_ / (2.0 * h);
+      for (int j = 0; j < state.size(); ++j)
+      {
+        ASSERT_NEAR(column(j), Bd(j, i), 1e-7) << "Bd(" << j << ", " << i << ")";
+      }
+    }
+
+    // exact at the linearization point
+    const Eigen::VectorXd linear_next = Ad * state + Bd * input + Wd;
+    for (int j = 0; j < state.size(); ++j)
+    {
+      ASSERT_NEAR(next(j), linear_next(j), 1e-12) << "state " << j;
+    }
+  }
+
+  void testLinearization()
+  {
+    resetVehicleModel();
+    const int dim_x = vehicle_model_ptr_->getState().size();
+    Eigen::VectorXd state(dim_x);
+    Eigen::VectorXd input(2);
+    for (int k = 0; k < 20; ++k)
+    {
+      // away from the switches of the limits, inside and beyond them
+      state.head(3) << 0.3 * k - 2.0, 1.0 - 0.2 * k, -3.0 + 0.31 * k;
+      if (dim_x == 5)
+      {
+        state.tail(2) << 4.0 - 0.47 * k, 0.2 - 0.033 * k;
+      }
+      input << -12.0 + 1.37 * k, 0.9 - 0.11 * k;
+      checkLinearization(state, input);
+    }
+  }
+
   void testAllMotion()
   {
     testGoStraightForward();
@@ -248,6 +362,88 @@ TEST_F(TestSuite, TestConstAccelTwist)
   testAllMotion();
 }
 
+TEST_F(TestSuite, TestBatch)
+{
+  vehicle_model_type_ = VehicleModelType::IDEAL_TWIST;
+  testBatch(VehicleBatchModelIdealTwist());
+  vehicle_model_type_ = VehicleModelType::IDEAL_STEER;
+  testBatch(VehicleBatchModelIdealSteer(wheelbase_));
+  vehicle_model_type_ = VehicleModelType::DELAY_TWIST;
+  testBatch(VehicleBatchModelTimeDelayTwist(vel_lim_, angvel_lim_, accel_rate_, angvel_rate_, vel_time_delay_,
+                                            vel_time_constant_, angvel_time_delay_, angvel_time_constant_));
+  vehicle_model_type_ = VehicleModelType::DELAY_STEER;
+  testBatch(VehicleBatchModelTimeDelaySteer(vel_lim_, steer_lim_, accel_rate_, steer_rate_lim_, wheelbase_,
+                                            vel_time_delay_, vel_time_constant_, steer_time_delay_,
+                                            steer_time_constant_));
+  vehicle_model_type_ = VehicleModelType::CONST_ACCEL_TWIST;
+  testBatch(VehicleBatchModelConstantAccelTwist(vel_lim_, angvel_lim_, accel_rate_, angvel_rate_));
+}
+
+TEST_F(TestSuite, TestLinearization)
+{
+  const VehicleModelType types[] = { VehicleModelType::IDEAL_TWIST, VehicleModelType::IDEAL_STEER,
+                                     VehicleModelType::DELAY_TWIST, VehicleModelType::DELAY_STEER,
+                                     VehicleModelType::CONST_ACCEL_TWIST };
+  for (const VehicleModelType type : types)
+  {
+    vehicle_model_type_ = type;
+    testLinearization();
+  }
+
+  // same as the finite differences used for the models without analytic jacobian
+  vehicle_model_type_ = VehicleModelType::DELAY_STEER;
+  resetVehicleModel();
+  Eigen::VectorXd state(5), input(2);
+  state << 1.0, 2.0, 0.5, 3.0, 0.1;
+  input << 4.0, 0.2;
+  VehicleModelInterface::StateMatrix Ad, Ad_num;
+  VehicleModelInterface::InputMatrix Bd, Bd_num;
+  VehicleModelInterface::StateVector Wd, Wd_num;
+  vehicle_model_ptr_->calcLinearizedModel(dt_, state, input, &Ad, &Bd, &Wd);
+  vehicle_model_ptr_->calcLinearizedModelNumerical(dt_, state, input, &Ad_num, &Bd_num, &Wd_num);
+  ASSERT_LT((Ad - Ad_num).cwiseAbs().maxCoeff(), 1e-7);
+  ASSERT_LT((Bd - Bd_num).cwiseAbs().maxCoeff(), 1e-7);
+  ASSERT_LT((Wd - Wd_num).cwiseAbs().maxCoeff(), 1e-7);
+}
+
+TEST(TestInputDelayBuffer, WholeSteps)
+{
+  // same commands as the push_back / front / pop_front of a deque of round(delay / dt) zeros
+  InputDelayBuffer buffer;
+  buffer.initialize(0.24, 0.02, false);
+  std::deque<double> queue(12, 0.0);
+  for (int i = 0; i < 100; ++i)
+  {
+    const double input = std::sin(0.1 * i);
+    queue.push_back(input);
+    ASSERT_EQ(queue.front(), buffer.update(input));
+    queue.pop_front();
+  }
+
+  InputDelayBuffer no_delay;
+  no_delay.initialize(0.0, 0.02, true);
+  ASSERT_EQ(1.5, no_delay.update(1.5));
+}
+
+TEST(TestInputDelayBuffer, Interpolated)
+{
+  // 2.25 updates
+  InputDelayBuffer buffer;
+  buffer.initialize(0.045, 0.02, true);
+  const double inputs[] = { 4.0, 8.0, 12.0, 16.0, 20.0 };
+  const double expected[] = { 0.0, 0.0, 3.0, 7.0, 11.0 };
+  for (int i = 0; i < 5; ++i)
+  {
+    ASSERT_DOUBLE_EQ(expected[i], buffer.update(inputs[i])) << "update " << i;
+  }
+
+  // below one update, between the current and the previous commands
+  InputDelayBuffer short_buffer;
+  short_buffer.initialize(0.005, 0.02, true);
+  ASSERT_DOUBLE_EQ(3.0, short_buffer.update(4.0));
+  ASSERT_DOUBLE_EQ(7.0, short_buffer.update(8.0));
+}
+
 int main(int argc, char** argv)
 {
   testing::InitGoogleTest(&argc, argv);